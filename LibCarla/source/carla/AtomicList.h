@@ -7,9 +7,11 @@
 #pragma once
  
 #include "carla/AtomicSharedPtr.h"
+#include "carla/EpochReclaimer.h"
 #include "carla/NonCopyable.h"
  
 #include <algorithm>
+#include <atomic>
 #include <mutex>
 #include <vector>
  
@@ -19,45 +21,64 @@ namespace detail {
  
   /// 持有一个指向列表的原子指针。
   ///
-  /// @warning 仅 Load 方法是原子的，对列表的修改由互斥量锁定。
+  /// 修改时复制整个列表并替换指针，被替换的列表交给 EpochReclaimer，在所有正在
+  /// 遍历它的读者离开之后才释放。ForEach 不加锁也不增加引用计数，适合读多写少的
+  /// 热路径；Load 返回共享指针，适合需要在临界区之外持有列表的调用者。
+  ///
+  /// @warning 仅读取是无锁的，对列表的修改由互斥量锁定。
   template <typename T>
   class AtomicList : private NonCopyable {
     using ListT = std::vector<T>;// 列表类型定义为 std::vector<T>，存储元素 T
   public:
  
-    AtomicList() : _list(std::make_shared<ListT>()) {}// 初始化列表为一个空的共享指针
+    AtomicList() : _list(std::make_shared<ListT>()) {// 初始化列表为一个空的共享指针
+      _current.store(_list.load().get());
+    }
  
     template <typename ValueT>
     void Push(ValueT &&value) {
-      std::lock_guard<std::mutex> lock(_mutex);// 锁定互斥量以保证线程安全
-      auto new_list = std::make_shared<ListT>(*Load());// 复制当前列表并创建一个新列表
-      new_list->emplace_back(std::forward<ValueT>(value)); // 将新值添加到新列表的末尾
-      _list = new_list;// 更新原子指针指向新列表
+      Modify([&](ListT &list) {
+        list.emplace_back(std::forward<ValueT>(value)); // 将新值添加到新列表的末尾
+      });
     }
  
     void DeleteByIndex(size_t index) {
-      std::lock_guard<std::mutex> lock(_mutex);// 锁定互斥量以保证线程安全
-      auto new_list = std::make_shared<ListT>(*Load());// 复制当前列表并创建一个新列表
-      auto begin = new_list->begin();// 获取列表的起始迭代器
-      std::advance(begin, index);
-      new_list->erase(begin);
-      _list = new_list;// 更新原子指针指向新列表
+      Modify([index](ListT &list) {
+        auto begin = list.begin();// 获取列表的起始迭代器
+        std::advance(begin, index);
+        list.erase(begin);
+      });
     }
     // DeleteByValue方法，根据值删除列表中的元素
     template <typename ValueT>
     void DeleteByValue(const ValueT &value) {
-      // 锁定互斥量以保证线程安全
-      std::lock_guard<std::mutex> lock(_mutex);
-      // 复制当前列表并创建一个新列表
-      auto new_list = std::make_shared<ListT>(*Load());  // 使用 std::remove 移动所有等于 value 的元素到列表末尾，然后调用 erase 删除这些元素
-      new_list->erase(std::remove(new_list->begin(), new_list->end(), value), new_list->end());
-      // 更新原子指针指向新列表
-      _list = new_list;
+      Modify([&value](ListT &list) {
+        // 使用 std::remove 移动所有等于 value 的元素到列表末尾，然后调用 erase 删除这些元素
+        list.erase(std::remove(list.begin(), list.end(), value), list.end());
+      });
     }
  
     void Clear() {
-      std::lock_guard<std::mutex> lock(_mutex);// 使用std::lock_guard自动管理互斥锁的锁定和解锁。
-      _list = std::make_shared<ListT>(); // 将_list重置为一个新的共享列表，清空所有之前的内容。
+      std::shared_ptr<const ListT> old_list;
+      {
+        std::lock_guard<std::mutex> lock(_mutex);// 使用std::lock_guard自动管理互斥锁的锁定和解锁。
+        old_list = Replace(std::make_shared<ListT>()); // 换成一个新的空列表
+      }
+      Retire(std::move(old_list));
+    }
+ 
+    /// 在同一份副本上执行 modify(list) 做的所有修改，然后一次替换列表。
+    /// 批量修改时只复制一次列表，读者看不到中间状态。
+    template <typename FuncT>
+    void Modify(FuncT &&modify) {
+      std::shared_ptr<const ListT> old_list;
+      {
+        std::lock_guard<std::mutex> lock(_mutex);// 锁定互斥量以保证线程安全
+        auto new_list = std::make_shared<ListT>(*_list.load());// 复制当前列表并创建一个新列表
+        modify(*new_list);
+        old_list = Replace(std::move(new_list));
+      }
+      Retire(std::move(old_list));
     }
  
       /// 返回指向列表的指针。
@@ -65,11 +86,39 @@ namespace detail {
       return _list.load();
     }
  
+    /// 对当前列表中的每个元素调用 func(item)。不加锁也不增加引用计数；func 中
+    /// 修改列表不影响正在进行的遍历。
+    template <typename FuncT>
+    void ForEach(FuncT &&func) const {
+      EpochReclaimer::Guard guard;
+      for (const T &item : *_current.load()) {
+        func(item);
+      }
+    }
+ 
   private:
  
+    /// 替换当前列表，返回旧列表。调用时必须持有 _mutex。
+    std::shared_ptr<const ListT> Replace(std::shared_ptr<const ListT> new_list) {
+      auto old_list = _list.load();
+      _current.store(new_list.get());
+      _list.store(std::move(new_list));
+      return old_list;
+    }
+ 
+    /// 旧列表可能仍在被 ForEach 遍历，在读者离开之后释放。
+    static void Retire(std::shared_ptr<const ListT> old_list) {
+      EpochReclaimer::Retire([old_list = std::move(old_list)]() mutable {
+        old_list.reset();
+      });
+    }
+ 
     std::mutex _mutex;// 互斥量，用于保护对列表的修改
  
-    AtomicSharedPtr<const ListT> _list;// 原子共享指针，指向当前列表
+    AtomicSharedPtr<const ListT> _list;// 原子共享指针，指向当前列表，持有列表的所有权
+ 
+    /// 与 _list 指向同一个列表，ForEach 的无锁读取使用
+    std::atomic<const ListT *> _current{nullptr};
   };
  
 } // namespace detail
@@ -4,6 +4,8 @@
 
 namespace carla {
 
+  constexpr Buffer::size_type Buffer::INLINE_CAPACITY;
+
   void Buffer::ReuseThisBuffer() {  // 定义 Buffer 类的 ReuseThisBuffer 方法
     auto pool = _parent_pool.lock();  // 尝试锁定指向父池的弱指针
     if (pool != nullptr) {   // 检查池是否有效（非空）
@@ -17,8 +17,10 @@
 #include <boost/asio/buffer.hpp>
 // 包含Boost.Asio的缓冲区相关的头文件，用于处理缓冲区操作
 
+#include <cstddef>
 #include <cstdint>
 // 包含标准整数类型头文件，用于定义固定宽度的整数类型
+#include <cstring>
 #include <limits>
 // 包含数值极限相关的头文件，用于获取数据类型的极限值
 #include <memory>
@@ -48,6 +50,9 @@ namespace carla {
   /// 这是一个仅可移动的类型，设计为按值传递时成本较低。如果缓冲区
   /// 从BufferPool中检索，则在销毁时内存会自动推回到池中。
 
+  /// 不超过 INLINE_CAPACITY 字节的数据直接存放在对象内部，不分配内存，也不经过
+  /// BufferPool。移动这样的缓冲区会复制数据，data() 返回的指针随之改变。
+
   /// @warning创建一个大于max_size() 的缓冲区是未定义的。
   class Buffer {
 
@@ -66,6 +71,10 @@ namespace carla {
     // 定义迭代器类型为指向值类型的指针，用于遍历缓冲区内容
     using const_iterator = const value_type *;
     // 定义常量迭代器类型为指向常量值类型的指针，用于常量遍历缓冲区内容
+
+    /// 存放在对象内部的数据的最大字节数，足以容纳传感器消息头和 IMU、GNSS 等
+    /// 小型传感器的数据。
+    static constexpr size_type INLINE_CAPACITY = 64u;
     /// @}
     // =========================================================================
     /// @name 构造与析构
@@ -79,13 +88,11 @@ namespace carla {
     // 使用默认构造函数创建一个空的Buffer对象，默认初始化成员变量
 
     /// 创建一个分配了 @a size字节的缓冲区。
-    explicit Buffer(size_type size)
-      : _size(size),
-        _capacity(size),
-        _data(std::make_unique<value_type[]>(size)) {}
+    explicit Buffer(size_type size) {
+      reset(size);
+    }
     // 显式构造函数，接受一个size_type类型的参数size
-    // 初始化_size和_capacity为size，表示缓冲区的大小和容量
-    // 使用std::make_unique动态分配一块大小为size的value_type类型的数组，并将指针赋给_data
+    // 小数据使用对象内部的存储，否则动态分配一块大小为size的内存
 
     /// @copydoc Buffer(size_type)
     explicit Buffer(uint64_t size)
@@ -129,21 +136,19 @@ namespace carla {
     // 禁用拷贝构造函数，表明此对象不支持拷贝构造
 
     Buffer(Buffer &&rhs) noexcept
-      : _parent_pool(std::move(rhs._parent_pool)),
-        _size(rhs._size),
-        _capacity(rhs._capacity),
-        _data(rhs.pop()) {}
+      : _parent_pool(std::move(rhs._parent_pool)) {
+      MoveFrom(rhs);
+    }
     // 移动构造函数，接受一个右值引用rhs
     // 将rhs的_parent_pool通过std::move移动给当前对象的_parent_pool
-    // 将rhs的_size和_capacity赋值给当前对象的_size和_capacity
-    // 调用rhs的pop函数获取rhs中的数据指针并赋给当前对象的_data
+    // 接管rhs的内存，数据在对象内部时复制数据
 
     ~Buffer() {
-      if (_capacity > 0u) {
+      if (_data != nullptr) {
         ReuseThisBuffer();
       }
     }
-    // 析构函数，当_capacity大于0时调用ReuseThisBuffer函数进行缓冲区资源的处理
+    // 析构函数，持有动态分配的内存时调用ReuseThisBuffer函数进行缓冲区资源的处理
 
     /// @}
     // =========================================================================
@@ -158,15 +163,12 @@ namespace carla {
 
     Buffer &operator=(Buffer &&rhs) noexcept {
       _parent_pool = std::move(rhs._parent_pool);
-      _size = rhs._size;
-      _capacity = rhs._capacity;
-      _data = rhs.pop();
+      MoveFrom(rhs);
       return *this;
     }
     // 移动赋值运算符，接受一个右值引用rhs
     // 将rhs的_parent_pool通过std::move移动给当前对象的_parent_pool
-    // 将rhs的_size和_capacity赋值给当前对象的_size和_capacity
-    // 调用rhs的pop函数获取rhs中的数据指针并赋给当前对象的_data
+    // 接管rhs的内存，数据在对象内部时复制数据
     // 返回当前对象的引用
 
     /// @}
@@ -179,28 +181,28 @@ namespace carla {
 
     /// 访问位置 @a i处的字节
     const value_type &operator[](size_t i) const {
-      return _data[i];
+      return data()[i];
     }
     // 重载常量下标运算符，返回位置i处的常量字节引用
 
     /// Access the byte at position @a i.
     value_type &operator[](size_t i) {
-      return _data[i];
+      return data()[i];
     }
     // 重载下标运算符，返回位置i处的字节引用
 
     /// 直接访问分配的内存，如果没有分配内存则返回 nullptr。
     const value_type *data() const noexcept {
-      return _data.get();
+      return _data != nullptr ? _data.get() : (_capacity > 0u ? _inline : nullptr);
     }
-    // 返回常量的指向分配内存的指针，如果_data为空则返回nullptr
+    // 返回常量的指向数据的指针，动态分配的内存或对象内部的存储，都没有则返回nullptr
 
     /// Direct access to the allocated memory or nullptr if no memory is
     /// allocated.
     value_type *data() noexcept {
-      return _data.get();
+      return _data != nullptr ? _data.get() : (_capacity > 0u ? _inline : nullptr);
     }
-    // 返回指向分配内存的指针，如果_data为空则返回nullptr
+    // 返回指向数据的指针，动态分配的内存或对象内部的存储，都没有则返回nullptr
 
     /// 从这个缓冲区创建一个boost::asio::buffer。
     /// @warning Boost.Asio缓冲区不拥有数据的所有权。调用者必须确保使用Asio缓冲区时不能删除此缓冲区所持有的内存。
@@ -258,9 +260,9 @@ namespace carla {
   public:
 
     const_iterator cbegin() const noexcept {
-      return _data.get();
+      return data();
     }
-    // 返回常量迭代器的起始位置，即_data指向的内存起始位置
+    // 返回常量迭代器的起始位置，即数据的起始位置
 
     const_iterator begin() const noexcept {
       return cbegin();
@@ -268,9 +270,9 @@ namespace carla {
     // 返回常量迭代器的起始位置，调用cbegin函数
 
     iterator begin() noexcept {
-      return _data.get();
+      return data();
     }
-    // 返回迭代器的起始位置，即_data指向的内存起始位置
+    // 返回迭代器的起始位置，即数据的起始位置
 
     const_iterator cend() const noexcept {
       return cbegin() + size();
@@ -299,15 +301,19 @@ namespace carla {
     /// allocated.
     void reset(size_type size) {
       if (_capacity < size) {
-        log_debug("allocating buffer of", size, "bytes");
-        _data = std::make_unique<value_type[]>(size);
-        _capacity = size;
+        if (size <= INLINE_CAPACITY) {
+          // 只有没有动态内存的缓冲区容量才会小于 INLINE_CAPACITY
+          _capacity = INLINE_CAPACITY;
+        } else {
+          log_debug("allocating buffer of", size, "bytes");
+          _data = std::make_unique<value_type[]>(size);
+          _capacity = size;
+        }
       }
       _size = size;
     }
     // 如果传入的size大于当前容量_capacity
-    // 则打印调试信息，表示正在分配指定大小的缓冲区
-    // 然后重新分配一块大小为size的内存，更新_capacity为size
+    // 小数据改用对象内部的存储，否则重新分配一块大小为size的内存，更新_capacity
     // 最后将_size设置为size，表示缓冲区的新大小
 
     /// @copydoc reset(size_type)
@@ -324,22 +330,31 @@ namespace carla {
     /// 调整缓冲区的大小。如果容量不足，将分配一个新的大小为 @a size的内存块，并复制数据。
     void resize(uint64_t size) {
       if (_capacity < size) {
-        std::unique_ptr<value_type[]> data = std::move(_data);
-        uint64_t old_size = size;
-        reset(size);
-        copy_from(data.get(), static_cast<size_type>(old_size));
+        const size_type old_size = _size;
+        if (size <= INLINE_CAPACITY) {
+          _capacity = INLINE_CAPACITY;
+        } else {
+          auto data = std::make_unique<value_type[]>(size);
+          if (old_size > 0u) {
+            std::memcpy(data.get(), this->data(), old_size);
+          }
+          _data = std::move(data);
+          _capacity = static_cast<size_type>(size);
+        }
       }
       _size = static_cast<size_type>(size);
     }
     // 如果传入的size大于当前容量_capacity
-    // 则先将当前_data保存到临时变量data中
-    // 记录旧的size
-    // 调用reset函数重新分配一块大小为size的内存
-    // 然后调用copy_from函数将旧数据复制到新的缓冲区中
+    // 则分配足够的内存（小数据使用对象内部的存储），并将原有的数据复制过去
     // 最后将_size设置为转换后的size
 
     /// 释放此缓冲区的内容，并将其大小和容量设置为零。
-    std::unique_ptr<value_type[]> pop() noexcept {
+    /// 数据在对象内部时返回它的一份动态分配的副本。
+    std::unique_ptr<value_type[]> pop() {
+      if (_data == nullptr && _capacity > 0u) {
+        _data = std::make_unique<value_type[]>(_capacity);
+        std::memcpy(_data.get(), _inline, _size);
+      }
       _size = 0u;
       _capacity = 0u;
       return std::move(_data);
@@ -350,9 +365,11 @@ namespace carla {
     /// 清除此缓冲区的内容，并将其大小和容量设置为零。
     /// 删除已分配的内存。
     void clear() noexcept {
-      pop();
+      _size = 0u;
+      _capacity = 0u;
+      _data = nullptr;
     }
-    // 调用pop函数清除缓冲区内容，释放内存并设置大小和容量为0
+    // 清除缓冲区内容，释放内存并设置大小和容量为0
 
     /// @}
     // =========================================================================
@@ -440,6 +457,18 @@ namespace carla {
     void ReuseThisBuffer();
     // 私有函数，用于重新使用此缓冲区资源，具体实现未给出
 
+    /// 接管 @a rhs 的内容，不处理 _parent_pool。
+    void MoveFrom(Buffer &rhs) noexcept {
+      _size = rhs._size;
+      _capacity = rhs._capacity;
+      _data = std::move(rhs._data);
+      if (_data == nullptr && _size > 0u) {
+        std::memcpy(_inline, rhs._inline, _size);
+      }
+      rhs._size = 0u;
+      rhs._capacity = 0u;
+    }
+
 
     friend class BufferPool;
 // 声明BufferPool类为友元类，这意味着BufferPool类可以访问Buffer类的私有和保护成员
@@ -461,6 +490,9 @@ std::unique_ptr<value_type[]> _data = nullptr;
 // 定义一个独占智能指针 _data，指向一个value_type类型（前面定义为unsigned char）的数组。
 // 初始化为nullptr，表示当前没有分配用于存储数据的内存块。
 // 这个指针将用于存储缓冲区中的实际数据内容
+
+/// 不超过 INLINE_CAPACITY 字节的数据存放在这里，此时 _data 为空
+alignas(std::max_align_t) value_type _inline[INLINE_CAPACITY];
 };
 
 } // namespace carla
@@ -0,0 +1,135 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/BufferPool.h"
+
+#include <algorithm>
+
+namespace carla {
+
+  constexpr size_t BufferPool::DEFAULT_MAX_IDLE_BUFFERS;
+  constexpr size_t BufferPool::DEFAULT_MAX_IDLE_BYTES;
+
+  size_t BufferPool::GetSizeClass(size_t capacity) {
+    size_t bits = 0u;
+    while (capacity > 1u) {
+      capacity >>= 1u;
+      ++bits;
+    }
+    if (bits <= MIN_SIZE_CLASS_BITS) {
+      return 0u;
+    }
+    return std::min(bits - MIN_SIZE_CLASS_BITS, NUMBER_OF_SIZE_CLASSES - 1u);
+  }
+
+  Buffer BufferPool::Pop() {
+    Buffer item;
+    // 同一个池通常服务于同一个流，最近归还的缓冲区的大小最可能合适
+    if (TryPop(_last_size_class, 0u, item)) {
+      return Adopt(std::move(item), true);
+    }
+    for (size_t size_class = 0u; size_class < NUMBER_OF_SIZE_CLASSES; ++size_class) {
+      if (TryPop(size_class, 0u, item)) {
+        return Adopt(std::move(item), true);
+      }
+    }
+    return Adopt(std::move(item), false);
+  }
+
+  Buffer BufferPool::Pop(const size_t size) {
+    Buffer item;
+    if (size <= Buffer::INLINE_CAPACITY) {
+      // 数据存放在缓冲区内部，不需要经过池
+      item.reset(static_cast<Buffer::size_type>(size));
+      return item;
+    }
+    // 同一类别中的缓冲区可能比 size 小，更大一级类别中的缓冲区总是足够大
+    const size_t size_class = GetSizeClass(size);
+    if (TryPop(size_class, size, item) ||
+        ((size_class + 1u < NUMBER_OF_SIZE_CLASSES) && TryPop(size_class + 1u, size, item))) {
+      return Adopt(std::move(item), true);
+    }
+    item.reset(static_cast<Buffer::size_type>(size));
+    return Adopt(std::move(item), false);
+  }
+
+  bool BufferPool::TryPop(const size_t size_class, const size_t min_capacity, Buffer &item) {
+    SizeClass &bucket = _classes[size_class];
+    if (!bucket.queue.try_dequeue(item)) {
+      return false;
+    }
+    const size_t idle = --bucket.idle;
+    _idle_bytes -= item.capacity();
+    // 记录整个整理周期内最少的空闲数量
+    size_t low_water = bucket.low_water.load();
+    while ((idle < low_water) && !bucket.low_water.compare_exchange_weak(low_water, idle)) {}
+    if (item.capacity() < min_capacity) {
+      Enqueue(size_class, std::move(item));
+      item = Buffer();
+      return false;
+    }
+    return true;
+  }
+
+  void BufferPool::Enqueue(const size_t size_class, Buffer &&item) {
+    SizeClass &bucket = _classes[size_class];
+    _idle_bytes += item.capacity();
+    ++bucket.idle;
+    bucket.queue.enqueue(std::move(item));
+  }
+
+  Buffer BufferPool::Adopt(Buffer &&item, const bool hit) {
+    ++(hit ? _hits : _misses);
+    if (++_pop_count % TRIM_INTERVAL == 0u) {
+      Trim();
+    }
+#if __cplusplus >= 201703L // 检查是否支持 C++17
+    item._parent_pool = weak_from_this();  // 设置父池为弱引用
+#else
+    item._parent_pool = shared_from_this();  // 设置父池为共享引用
+#endif
+    return std::move(item);
+  }
+
+  void BufferPool::Push(Buffer &&buffer) {
+    const size_t size_class = GetSizeClass(buffer.capacity());
+    if ((_classes[size_class].idle >= _max_idle_buffers) ||
+        (_idle_bytes + buffer.capacity() > _max_idle_bytes)) {
+      // 不移动缓冲区，其内存随调用方的析构一起释放
+      ++_discarded;
+      return;
+    }
+    Enqueue(size_class, std::move(buffer));
+    _last_size_class = size_class;
+  }
+
+  void BufferPool::Trim() {
+    for (SizeClass &bucket : _classes) {
+      size_t unused = bucket.low_water.exchange(0u);
+      Buffer item;
+      while ((unused > 0u) && bucket.queue.try_dequeue(item)) {
+        --bucket.idle;
+        _idle_bytes -= item.capacity();
+        // 断开与池的关联，使缓冲区析构时释放内存而不是再次归还
+        item._parent_pool.reset();
+        item = Buffer();
+        ++_trimmed;
+        --unused;
+      }
+      // 现在空闲的缓冲区要在下一个周期内都没有被用到才会被释放
+      bucket.low_water = bucket.idle.load();
+    }
+  }
+
+  BufferPool::Stats BufferPool::GetStats() const {
+    size_t idle_buffers = 0u;
+    for (const SizeClass &bucket : _classes) {
+      idle_buffers += bucket.idle;
+    }
+    return {_hits, _misses, _discarded, _trimmed, idle_buffers, _idle_bytes};
+  }
+
+} // namespace carla
@@ -17,43 +17,117 @@
 #  pragma clang diagnostic pop  // 恢复之前保存的编译警告状态
 #endif
 
+#include <array>  // 包含固定大小数组的头文件
+#include <atomic>  // 包含原子操作相关的头文件
 #include <memory>  // 包含内存管理相关的头文件
 
 namespace carla {
 
   /// 一个缓冲区池。 从这个池中弹出的缓冲区在销毁时会自动返回到池中，
-  /// 这样分配的内存可以被重用。
+  /// 这样分配的内存可以被重用。数据存放在缓冲区内部的小缓冲区不会返回到池中。
+  ///
+  /// 空闲的缓冲区按容量分为以2的幂为界的大小类别，每个类别分别排队，
+  /// 使大缓冲区不会混入小数据的流中。每个类别保留的空闲缓冲区数量和所有空闲缓冲区的总容量都有上限，
+  /// 超出上限时归还的缓冲区直接释放。每隔一段时间，整个期间都没有被用到的空闲缓冲区也会被释放。
   /// @warning 缓冲区仅通过增长来调整其大小，除非明确地清除它们，否则不会缩小。
-  /// 分配的内存在此池被销毁时才会被删除。
 
   class BufferPool : public std::enable_shared_from_this<BufferPool> {  // 定义 BufferPool 类，支持共享指针
   public:
 
+    /// 缓冲区池的统计信息。
+    struct Stats {
+      size_t hits;          ///< 从池中取到了缓冲区的弹出次数
+      size_t misses;        ///< 池中没有合适的缓冲区、返回新缓冲区的弹出次数
+      size_t discarded;     ///< 归还时因超出上限而释放的缓冲区数量
+      size_t trimmed;       ///< 因长期空闲而释放的缓冲区数量
+      size_t idle_buffers;  ///< 当前空闲的缓冲区数量
+      size_t idle_bytes;    ///< 当前空闲的缓冲区的总容量
+    };
+
+    /// 每个大小类别默认最多保留的空闲缓冲区数量。
+    static constexpr size_t DEFAULT_MAX_IDLE_BUFFERS = 16u;
+
+    /// 默认的所有空闲缓冲区的总容量上限。
+    static constexpr size_t DEFAULT_MAX_IDLE_BYTES = 256u * 1024u * 1024u;
+
     BufferPool() = default;  // 默认构造函数
 
-    explicit BufferPool(size_t estimated_size) : _queue(estimated_size) {}  // 带参数的构造函数，初始化队列大小
+    /// @a max_idle_buffers 为每个大小类别最多保留的空闲缓冲区数量。
+    explicit BufferPool(size_t max_idle_buffers) : _max_idle_buffers(max_idle_buffers) {}
 
-  /// 从队列中弹出一个缓冲区，如果队列为空，则创建一个新的缓冲区。
-    Buffer Pop() {
-      Buffer item; // 创建一个 Buffer 实例
-      _queue.try_dequeue(item); // 尝试从队列中弹出，失败则不处理
-#if __cplusplus >= 201703L // 检查是否支持 C++17
-      item._parent_pool = weak_from_this();  // 设置父池为弱引用
-#else
-      item._parent_pool = shared_from_this();  // 设置父池为共享引用
-#endif
-      return item;  // 返回弹出的 Buffer
+    /// 从池中弹出一个缓冲区，如果池为空，则创建一个新的缓冲区。
+    /// 大小未知时优先返回最近归还的大小类别中的缓冲区。
+    Buffer Pop();
+
+    /// 从池中弹出一个容量至少为 @a size 的缓冲区，如果没有则创建一个新的缓冲区。
+    /// 返回的缓冲区的大小未定，使用前需要调用 reset。不超过
+    /// Buffer::INLINE_CAPACITY 的缓冲区不分配内存，不经过池，也不计入统计。
+    Buffer Pop(size_t size);
+
+    /// 设置每个大小类别最多保留的空闲缓冲区数量和所有空闲缓冲区的总容量上限。
+    void SetLimits(size_t max_idle_buffers, size_t max_idle_bytes) {
+      _max_idle_buffers = max_idle_buffers;
+      _max_idle_bytes = max_idle_bytes;
     }
 
+    /// 释放自上次调用以来一直空闲的缓冲区。弹出缓冲区时会定期自动调用。
+    void Trim();
+
+    Stats GetStats() const;
+
   private:
 
     friend class Buffer;  // 允许 Buffer 类访问私有成员
 
-    void Push(Buffer &&buffer) {  // 定义 Push 方法，接受一个右值引用的 Buffer
-      _queue.enqueue(std::move(buffer));  // 将 Buffer 移动到队列中
-    }
+    /// 最小的大小类别包含容量小于 2^(MIN_SIZE_CLASS_BITS + 1) 的缓冲区。
+    static constexpr size_t MIN_SIZE_CLASS_BITS = 10u;
+
+    static constexpr size_t NUMBER_OF_SIZE_CLASSES = 22u;
+
+    /// 每弹出这么多次缓冲区整理一次空闲缓冲区。
+    static constexpr size_t TRIM_INTERVAL = 1024u;
+
+    struct SizeClass {
+      moodycamel::ConcurrentQueue<Buffer> queue;  // 定义并发队列用于存储 Buffer
+      std::atomic_size_t idle{0u};
+      /// 自上次整理以来最少的空闲缓冲区数量，这些缓冲区整个期间都没有被用到。
+      std::atomic_size_t low_water{0u};
+    };
+
+    /// 容量为 @a capacity 的缓冲区所属的大小类别，类别中缓冲区的容量不小于该类别的下界。
+    static size_t GetSizeClass(size_t capacity);
+
+    void Push(Buffer &&buffer);  // 定义 Push 方法，接受一个右值引用的 Buffer
+
+    /// 从 @a size_class 中取出容量至少为 @a min_capacity 的缓冲区。
+    bool TryPop(size_t size_class, size_t min_capacity, Buffer &item);
+
+    /// 把 @a item 放回大小类别，不检查上限。
+    void Enqueue(size_t size_class, Buffer &&item);
+
+    /// 设置缓冲区的父池并统计弹出次数。
+    Buffer Adopt(Buffer &&item, bool hit);
+
+    std::array<SizeClass, NUMBER_OF_SIZE_CLASSES> _classes;
+
+    std::atomic_size_t _max_idle_buffers{DEFAULT_MAX_IDLE_BUFFERS};
+
+    std::atomic_size_t _max_idle_bytes{DEFAULT_MAX_IDLE_BYTES};
+
+    /// 最近归还的缓冲区所属的大小类别。
+    std::atomic_size_t _last_size_class{0u};
+
+    std::atomic_size_t _idle_bytes{0u};
+
+    std::atomic_size_t _pop_count{0u};
+
+    std::atomic_size_t _hits{0u};
+
+    std::atomic_size_t _misses{0u};
+
+    std::atomic_size_t _discarded{0u};
 
-    moodycamel::ConcurrentQueue<Buffer> _queue;  // 定义并发队列用于存储 Buffer
+    std::atomic_size_t _trimmed{0u};
   };
 
 } // namespace carla
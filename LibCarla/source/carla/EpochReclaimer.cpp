@@ -0,0 +1,163 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/EpochReclaimer.h"
+
+#include "carla/Debug.h"
+#include "carla/Exception.h"
+
+#include <boost/align/aligned_alloc.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <new>
+#include <vector>
+
+namespace carla {
+
+namespace {
+
+  /// 每个线程的纪元记录，对齐到缓存行以免不同线程的读者互相干扰。线程退出后
+  /// 记录留给之后的线程重用，从不释放。C++14 的 new 不保证这样的对齐，
+  /// 见 Domain::Acquire。
+  struct alignas(64) Record {
+    /// 读者进入临界区时看到的全局纪元，不在临界区时为零
+    std::atomic<uint64_t> epoch{0u};
+    std::atomic<bool> in_use{true};
+    /// 嵌套深度，只由拥有记录的线程访问
+    unsigned depth = 0u;
+    Record *next = nullptr;
+  };
+
+  struct RetiredItem {
+    uint64_t epoch;
+    std::function<void()> deleter;
+  };
+
+  class Domain {
+  public:
+
+    /// 从 1 开始，零表示记录不在临界区中
+    std::atomic<uint64_t> global_epoch{1u};
+
+    /// 只增不减的记录链表，插入是无锁的
+    std::atomic<Record *> records{nullptr};
+
+    std::mutex mutex;
+
+    std::vector<RetiredItem> retired;
+
+    Record *Acquire() {
+      for (Record *record = records.load(); record != nullptr; record = record->next) {
+        bool expected = false;
+        if (record->in_use.compare_exchange_strong(expected, true)) {
+          return record;
+        }
+      }
+      // 按缓存行对齐分配。记录从不释放，所以不需要对应的 aligned_free
+      void *memory = boost::alignment::aligned_alloc(alignof(Record), sizeof(Record));
+      if (memory == nullptr) {
+        throw_exception(std::bad_alloc());
+      }
+      auto *record = new (memory) Record;
+      record->next = records.load();
+      while (!records.compare_exchange_weak(record->next, record));
+      return record;
+    }
+
+    /// 所有处于临界区的读者中最小的纪元
+    uint64_t MinActiveEpoch() const {
+      uint64_t min = std::numeric_limits<uint64_t>::max();
+      for (Record *record = records.load(); record != nullptr; record = record->next) {
+        const uint64_t epoch = record->epoch.load();
+        if (epoch != 0u && epoch < min) {
+          min = epoch;
+        }
+      }
+      return min;
+    }
+  };
+
+  /// 不在进程退出时销毁，其他静态对象析构时可能仍会退休对象。
+  Domain &GetDomain() {
+    static Domain *domain = new Domain;
+    return *domain;
+  }
+
+  /// 线程退出时归还记录。
+  struct ThreadRecord {
+    Record *record = nullptr;
+
+    ~ThreadRecord() {
+      if (record != nullptr) {
+        record->depth = 0u;
+        record->epoch.store(0u);
+        record->in_use.store(false);
+      }
+    }
+  };
+
+  static thread_local ThreadRecord THREAD_RECORD;
+
+} // namespace
+
+  EpochReclaimer::Guard::Guard() {
+    Record *record = THREAD_RECORD.record;
+    if (record == nullptr) {
+      record = THREAD_RECORD.record = GetDomain().Acquire();
+    }
+    if (record->depth++ == 0u) {
+      // 顺序一致的写入：写者在读取记录之前发布的新指针，或者写者能看到这个纪元
+      record->epoch.store(GetDomain().global_epoch.load());
+    }
+  }
+
+  EpochReclaimer::Guard::~Guard() {
+    Record *record = THREAD_RECORD.record;
+    DEBUG_ASSERT(record != nullptr && record->depth > 0u);
+    if (--record->depth == 0u) {
+      record->epoch.store(0u);
+    }
+  }
+
+  void EpochReclaimer::Retire(std::function<void()> deleter) {
+    Domain &domain = GetDomain();
+    {
+      std::lock_guard<std::mutex> lock(domain.mutex);
+      // 纪元大于等于它的读者可能仍持有对象；之后进入的读者纪元更大，看不到它
+      domain.retired.push_back(RetiredItem{domain.global_epoch.fetch_add(1u), std::move(deleter)});
+    }
+    Collect();
+  }
+
+  size_t EpochReclaimer::Collect() {
+    Domain &domain = GetDomain();
+    std::vector<RetiredItem> reclaimable;
+    size_t pending;
+    {
+      std::lock_guard<std::mutex> lock(domain.mutex);
+      const uint64_t min_epoch = domain.MinActiveEpoch();
+      auto it = domain.retired.begin();
+      while (it != domain.retired.end()) {
+        if (it->epoch < min_epoch) {
+          reclaimable.emplace_back(std::move(*it));
+          it = domain.retired.erase(it);
+        } else {
+          ++it;
+        }
+      }
+      pending = domain.retired.size();
+    }
+    // 在锁外执行，deleter 可能再次退休对象
+    for (auto &item : reclaimable) {
+      item.deleter();
+    }
+    return pending;
+  }
+
+} // namespace carla
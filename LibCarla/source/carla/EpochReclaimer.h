@@ -0,0 +1,42 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/NonCopyable.h"
+
+#include <cstddef>
+#include <functional>
+
+namespace carla {
+
+  /// 基于纪元（epoch）的延迟回收。
+  ///
+  /// 读者在 Guard 的生存期内可以不加锁、不增加引用计数地访问共享对象；写者替换
+  /// 对象后把旧对象交给 Retire，旧对象在所有可能看到它的读者离开之后才被释放。
+  /// 读者的开销是对本线程记录的两次原子写入，写者承担回收的全部开销。
+  class EpochReclaimer {
+  public:
+
+    /// 读者的临界区，可以嵌套。在临界区内加载的指针在 Guard 析构之前一直有效。
+    class Guard : private NonCopyable {
+    public:
+
+      Guard();
+
+      ~Guard();
+    };
+
+    /// 在所有当前处于临界区的读者离开之后调用 @a deleter。可能在调用线程中
+    /// 立即执行 @a deleter 以及之前退休的其他对象的 deleter，因此调用时不要持有
+    /// deleter 可能需要的锁。
+    static void Retire(std::function<void()> deleter);
+
+    /// 释放所有已经没有读者的退休对象，返回仍在等待的数量。
+    static size_t Collect();
+  };
+
+} // namespace carla
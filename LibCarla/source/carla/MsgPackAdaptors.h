@@ -127,46 +127,37 @@ namespace adaptor {
       }
       // 获取索引
       const auto index = o.via.array.ptr[0].as<uint64_t>();
+      if (index >= sizeof...(Ts)) {
+        ::carla::throw_exception(clmdep_msgpack::type_error());
+      }
       copy_to_variant(index, o, v, std::make_index_sequence<sizeof...(Ts)>());
       return o;
     }
 
   private:
 
-    // 从对象中复制到变体的实现
+    using copy_function = void (*)(const clmdep_msgpack::object &, boost::variant2::variant<Ts...> &);
+
+    // 在变体中就地构造第 I 个类型并解码，只构造实际的类型，不产生临时对象
     template <uint64_t I>
     static void copy_to_variant_impl(
         const clmdep_msgpack::object &o,
         boost::variant2::variant<Ts...> &v) {
-      /// @todo 找到类型的工作环绕。
-      auto dummy = std::get<I>(std::tuple<Ts...>{});
-      using T = decltype(dummy);
-      v = o.via.array.ptr[1].as<T>();// 从对象中获取并赋值给变体
+      o.via.array.ptr[1].convert(v.template emplace<I>());
     }
-    // 复制到变体的主函数
+
+    // 按索引在编译期生成的函数表中直接跳转，而不是逐个比较所有的类型
     template <uint64_t... Is>
-// 函数名为 `copy_to_variant`，它是一个静态成员函数，意味着可以通过类名直接调用，而不需要实例化类对象
-// 该函数的作用从参数来看可能是将某个 `clmdep_msgpack::object` 类型的数据根据索引复制到 `boost::variant2::variant<Ts...>` 类型的变量中
-// 这里的 `Ts...` 同样是可变参数模板参数，代表一系列的类型（具体由调用时传入的类型决定）
     static void copy_to_variant(
-// `index` 参数，类型为 `uint64_t`，可能用于指定要操作的索引位置，用于在下面的逻辑中判断和选择合适的处理分支
         const uint64_t index,
-// `o` 参数，类型为 `clmdep_msgpack::object`，应该是要被复制的数据来源对象
         const clmdep_msgpack::object &o,
-// `v` 参数，类型为 `boost::variant2::variant<Ts...>`，是目标变量，也就是要将数据复制到其中的变量
         boost::variant2::variant<Ts...> &v,
-// `std::index_sequence<Is...>` 是一个编译期的索引序列，用于辅助实现一些编译期的循环或者按索引展开等操作（常配合可变参数模板使用）
         std::index_sequence<Is...>) {
-    // 使用初始化列表语法，初始化列表中的元素表达式通过逗号分隔
-    // 这里的表达式 `(index == Is? copy_to_variant_impl<Is>(o, v), 0 : 0)...` 是一个展开式，会针对每个 `Is` 值进行展开
-    // 意思是如果当前的 `index` 值等于某个 `Is` 值，就调用 `copy_to_variant_impl<Is>(o, v)` 函数（具体功能由该函数定义决定，这里应该是真正执行复制数据到变体类型变量 `v` 的操作），并且整个表达式返回值为 `0`（这里的 `0` 只是为了满足初始化列表元素语法要求，并无实际业务含义）；如果 `index` 不等于 `Is`，就直接返回 `0`
-      std::initializer_list<int> ({
-        (index == Is ? copy_to_variant_impl<Is>(o, v), 0 : 0)...
-      });
+      static constexpr copy_function table[] = {&copy_to_variant_impl<Is>...};
+      table[index](o, v);
     }
   };
-// 定义一个模板结构体 `pack`，针对 `boost::variant2::variant<Ts...>` 类型进行特化（这里 `Ts...` 同样是可变参数模板参数，表示一系列类型）
-// 这个结构体可能用于对 `boost::variant2::variant` 类型进行一些打包或者序列化相关的操作（结合后面的函数重载推测）
+
   template<typename... Ts>
   struct pack<boost::variant2::variant<Ts...>> {
     // 定义一个函数重载操作符 `()`，使得该结构体的对象可以像函数一样被调用
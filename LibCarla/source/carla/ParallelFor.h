@@ -0,0 +1,28 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/TaskScheduler.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace carla {
+
+  /// 把 [0, size) 分成连续的块，在共享的 TaskScheduler 中分别调用
+  /// function(begin, end)。每块至少包含 @a min_chunk_size 个元素，数量较少时
+  /// 直接在当前线程中执行。异常在所有块结束后重新抛出。嵌套调用同样分块执行，
+  /// 等待的线程自己执行尚未开始的块，不会因为工作线程都在等待而死锁。
+  template <typename FuncT>
+  void ParallelForChunks(
+      size_t size,
+      FuncT &&function,
+      size_t min_chunk_size = 256u) {
+    TaskScheduler::Get().ParallelForChunks(size, std::forward<FuncT>(function), min_chunk_size);
+  }
+
+} // namespace carla
@@ -74,6 +74,11 @@ namespace carla {
     };
     // 用于保存GIL状态的成员变量
     /// 释放Python的全局解释器锁，在执行阻塞I/O操作时使用它。
+    class ReleaseGIL : private NonCopyable {
+    public:
+
+      ReleaseGIL() : _state(PyEval_SaveThread()) {}
+
       ~ReleaseGIL() {
         PyEval_RestoreThread(_state);
       }
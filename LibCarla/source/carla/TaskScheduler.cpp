@@ -0,0 +1,325 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/TaskScheduler.h"
+
+#include "carla/Debug.h"
+#include "carla/Exception.h"
+#include "carla/Logging.h"
+
+#include <stdexcept>
+#include <thread>
+
+namespace carla {
+
+  /// 当前线程所属的调度器和它在其中的队列编号，非工作线程为 nullptr。
+  static thread_local TaskScheduler *CURRENT_SCHEDULER = nullptr;
+  static thread_local size_t CURRENT_WORKER = 0u;
+
+  // ===========================================================================
+  // -- ChunkedJob -------------------------------------------------------------
+  // ===========================================================================
+
+namespace detail {
+
+  ChunkedJob::ChunkedJob(
+      const size_t size,
+      const size_t chunk_size,
+      std::function<void(size_t, size_t)> function)
+    : _size(size),
+      _chunk_size(chunk_size),
+      _number_of_chunks((size + chunk_size - 1u) / chunk_size),
+      _function(std::move(function)) {}
+
+  void ChunkedJob::Run() {
+    while (true) {
+      const size_t chunk = _next_chunk.fetch_add(1u);
+      if (chunk >= _number_of_chunks) {
+        return;
+      }
+      const size_t begin = chunk * _chunk_size;
+      const size_t end = std::min(_size, begin + _chunk_size);
+      std::exception_ptr exception;
+      try {
+        _function(begin, end);
+      } catch (...) {
+        exception = std::current_exception();
+      }
+      std::lock_guard<std::mutex> lock(_mutex);
+      if (exception && !_exception) {
+        _exception = exception;
+      }
+      if (++_finished_chunks == _number_of_chunks) {
+        _done.notify_all();
+      }
+    }
+  }
+
+  void ChunkedJob::Wait() {
+    std::exception_ptr exception;
+    {
+      std::unique_lock<std::mutex> lock(_mutex);
+      _done.wait(lock, [this]() { return _finished_chunks == _number_of_chunks; });
+      exception = _exception;
+    }
+    if (exception) {
+      std::rethrow_exception(exception);
+    }
+  }
+
+} // namespace detail
+
+  // ===========================================================================
+  // -- TaskScheduler ----------------------------------------------------------
+  // ===========================================================================
+
+  TaskScheduler &TaskScheduler::Get() {
+    // 不在进程退出时销毁：静态对象析构时其他模块可能仍在使用，在 Windows 上
+    // 动态库卸载时等待线程结束也会死锁。
+    static TaskScheduler *scheduler = new TaskScheduler(
+        std::max(1u, std::thread::hardware_concurrency()) - 1u);
+    return *scheduler;
+  }
+
+  TaskScheduler::TaskScheduler(const size_t number_of_workers) {
+    _queues.reserve(number_of_workers);
+    for (size_t i = 0u; i < number_of_workers; ++i) {
+      _queues.emplace_back(std::make_unique<WorkQueue>());
+    }
+    for (size_t i = 0u; i < number_of_workers; ++i) {
+      _workers.CreateThread([this, i]() { WorkerLoop(i); });
+    }
+  }
+
+  TaskScheduler::~TaskScheduler() {
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _stop = true;
+    }
+    _wake.notify_all();
+    _workers.JoinAll();
+  }
+
+  void TaskScheduler::Spawn(std::function<void()> task) {
+    if (_queues.empty()) {
+      Execute(task);
+      return;
+    }
+    // 工作线程提交的任务放在自己的队列中，最先被自己执行，缓存中的数据仍然有效
+    WorkQueue &queue = CURRENT_SCHEDULER == this ? *_queues[CURRENT_WORKER] : _injection_queue;
+    {
+      std::lock_guard<std::mutex> lock(queue.mutex);
+      queue.tasks.emplace_back(std::move(task));
+    }
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      ++_queued;
+    }
+    _wake.notify_one();
+  }
+
+  void TaskScheduler::WorkerLoop(const size_t index) {
+    CURRENT_SCHEDULER = this;
+    CURRENT_WORKER = index;
+    std::function<void()> task;
+    while (true) {
+      if (TryPop(index, task)) {
+        Execute(task);
+        task = nullptr;
+        continue;
+      }
+      std::unique_lock<std::mutex> lock(_mutex);
+      _wake.wait(lock, [this]() { return _stop || _queued > 0u; });
+      if (_stop) {
+        return;
+      }
+    }
+  }
+
+  bool TaskScheduler::TryPop(const size_t index, std::function<void()> &task) {
+    bool found = PopBack(*_queues[index], task) || PopFront(_injection_queue, task);
+    for (size_t i = 1u; !found && i < _queues.size(); ++i) {
+      found = PopFront(*_queues[(index + i) % _queues.size()], task);
+    }
+    if (found) {
+      std::lock_guard<std::mutex> lock(_mutex);
+      --_queued;
+    }
+    return found;
+  }
+
+  bool TaskScheduler::PopBack(WorkQueue &queue, std::function<void()> &task) {
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.tasks.empty()) {
+      return false;
+    }
+    task = std::move(queue.tasks.back());
+    queue.tasks.pop_back();
+    return true;
+  }
+
+  bool TaskScheduler::PopFront(WorkQueue &queue, std::function<void()> &task) {
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.tasks.empty()) {
+      return false;
+    }
+    task = std::move(queue.tasks.front());
+    queue.tasks.pop_front();
+    return true;
+  }
+
+  void TaskScheduler::Execute(std::function<void()> &task) {
+    try {
+      task();
+    } catch (const std::exception &e) {
+      log_error("exception thrown in task:", e.what());
+    } catch (...) {
+      log_error("unknown exception thrown in task");
+    }
+  }
+
+  // ===========================================================================
+  // -- TaskGroup --------------------------------------------------------------
+  // ===========================================================================
+
+  struct TaskGroup::State {
+
+    struct Item {
+      std::function<void()> task;
+      std::atomic<bool> claimed{false};
+    };
+
+    std::mutex mutex;
+
+    std::condition_variable done;
+
+    std::vector<std::shared_ptr<Item>> items;
+
+    size_t unfinished = 0u;
+
+    std::exception_ptr exception;
+
+    /// 执行 @a item，除非它已被其他线程领取。
+    void TryExecute(Item &item) {
+      if (item.claimed.exchange(true)) {
+        return;
+      }
+      std::exception_ptr error;
+      try {
+        item.task();
+      } catch (...) {
+        error = std::current_exception();
+      }
+      item.task = nullptr;
+      std::lock_guard<std::mutex> lock(mutex);
+      if (error && !exception) {
+        exception = error;
+      }
+      if (--unfinished == 0u) {
+        done.notify_all();
+      }
+    }
+  };
+
+  TaskGroup::TaskGroup(TaskScheduler &scheduler)
+    : _scheduler(scheduler),
+      _state(std::make_shared<State>()) {}
+
+  TaskGroup::~TaskGroup() {
+    try {
+      Wait();
+    } catch (const std::exception &e) {
+      log_error("exception thrown in task group:", e.what());
+    } catch (...) {
+      log_error("unknown exception thrown in task group");
+    }
+  }
+
+  void TaskGroup::Run(std::function<void()> task) {
+    auto item = std::make_shared<State::Item>();
+    item->task = std::move(task);
+    {
+      std::lock_guard<std::mutex> lock(_state->mutex);
+      _state->items.emplace_back(item);
+      ++_state->unfinished;
+    }
+    auto state = _state;
+    _scheduler.Spawn([state, item]() { state->TryExecute(*item); });
+  }
+
+  void TaskGroup::Wait() {
+    // 先执行还没有被领取的任务，执行中加入的任务也包括在内
+    for (size_t i = 0u; ; ++i) {
+      std::shared_ptr<State::Item> item;
+      {
+        std::lock_guard<std::mutex> lock(_state->mutex);
+        if (i >= _state->items.size()) {
+          break;
+        }
+        item = _state->items[i];
+      }
+      _state->TryExecute(*item);
+    }
+    std::exception_ptr exception;
+    {
+      std::unique_lock<std::mutex> lock(_state->mutex);
+      _state->done.wait(lock, [this]() { return _state->unfinished == 0u; });
+      _state->items.clear();
+      exception = _state->exception;
+      _state->exception = nullptr;
+    }
+    if (exception) {
+      std::rethrow_exception(exception);
+    }
+  }
+
+  // ===========================================================================
+  // -- TaskGraph --------------------------------------------------------------
+  // ===========================================================================
+
+  TaskGraph::NodeId TaskGraph::Add(std::function<void()> task) {
+    _nodes.emplace_back();
+    _nodes.back().task = std::move(task);
+    return _nodes.size() - 1u;
+  }
+
+  void TaskGraph::Precede(const NodeId before, const NodeId after) {
+    DEBUG_ASSERT(before < _nodes.size());
+    DEBUG_ASSERT(after < _nodes.size());
+    _nodes[before].successors.push_back(after);
+    ++_nodes[after].number_of_predecessors;
+  }
+
+  void TaskGraph::Run(TaskScheduler &scheduler) {
+    std::unique_ptr<std::atomic<size_t>[]> pending(new std::atomic<size_t>[_nodes.size()]);
+    for (size_t i = 0u; i < _nodes.size(); ++i) {
+      pending[i].store(_nodes[i].number_of_predecessors);
+    }
+    std::atomic<size_t> executed{0u};
+    TaskGroup group(scheduler);
+    std::function<void(NodeId)> schedule = [&](const NodeId id) {
+      group.Run([&, id]() {
+        _nodes[id].task();
+        ++executed;
+        for (const NodeId successor : _nodes[id].successors) {
+          if (--pending[successor] == 0u) {
+            schedule(successor);
+          }
+        }
+      });
+    };
+    for (size_t i = 0u; i < _nodes.size(); ++i) {
+      if (_nodes[i].number_of_predecessors == 0u) {
+        schedule(i);
+      }
+    }
+    group.Wait();
+    if (executed.load() != _nodes.size()) {
+      throw_exception(std::logic_error("task graph contains a cycle"));
+    }
+  }
+
+} // namespace carla
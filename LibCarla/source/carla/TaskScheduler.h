@@ -0,0 +1,245 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/NonCopyable.h"
+#include "carla/ThreadGroup.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace carla {
+
+namespace detail {
+
+  /// ParallelForChunks 的一次调用。各线程通过原子计数器领取下一个未处理的块，
+  /// 调用线程只等待已被领取的块，不等待尚未开始的任务。
+  class ChunkedJob : private NonCopyable {
+  public:
+
+    ChunkedJob(
+        size_t size,
+        size_t chunk_size,
+        std::function<void(size_t, size_t)> function);
+
+    size_t GetNumberOfChunks() const {
+      return _number_of_chunks;
+    }
+
+    /// 领取并执行块，直到所有块都已被领取。
+    void Run();
+
+    /// 等待所有块执行完毕，重新抛出第一个异常。
+    void Wait();
+
+  private:
+
+    const size_t _size;
+
+    const size_t _chunk_size;
+
+    const size_t _number_of_chunks;
+
+    const std::function<void(size_t, size_t)> _function;
+
+    std::atomic<size_t> _next_chunk{0u};
+
+    std::mutex _mutex;
+
+    std::condition_variable _done;
+
+    size_t _finished_chunks = 0u;
+
+    std::exception_ptr _exception;
+  };
+
+} // namespace detail
+
+  /// 计算任务的工作窃取调度器。
+  ///
+  /// 每个工作线程有自己的任务队列，从队尾取出自己提交的任务，空闲时从其他线程的
+  /// 队首窃取任务；其他线程提交的任务放入共享的注入队列。与 ThreadPool 不同，
+  /// 提交任务不分配 future，等待的线程自己执行尚未开始的工作，因此嵌套的并行调用
+  /// 不会因为所有工作线程都在等待而死锁。
+  ///
+  /// 交通管理器的阶段、地图的批量查询、导航的人群更新等都共用 Get() 返回的实例，
+  /// 不再各自创建线程。
+  class TaskScheduler : private NonCopyable {
+  public:
+
+    /// 进程内共享的调度器，第一次使用时创建。调用线程也参与计算，
+    /// 因此工作线程数为硬件线程数减一。
+    static TaskScheduler &Get();
+
+    explicit TaskScheduler(size_t number_of_workers);
+
+    ~TaskScheduler();
+
+    size_t GetNumberOfWorkers() const {
+      return _queues.size();
+    }
+
+    /// 提交一个任务。任务抛出的异常只记录在日志中，需要结果时使用 TaskGroup。
+    void Spawn(std::function<void()> task);
+
+    /// 把 [0, size) 分成连续的块，在调用线程和工作线程中分别调用
+    /// function(begin, end)，返回时所有块都已执行完毕。每块至少包含
+    /// @a min_chunk_size 个元素；@a max_concurrency 不为零时限制同时执行的线程数
+    /// （包括调用线程）。异常在所有块结束后重新抛出。
+    template <typename FuncT>
+    void ParallelForChunks(
+        size_t size,
+        FuncT &&function,
+        size_t min_chunk_size = 1u,
+        size_t max_concurrency = 0u);
+
+    /// 与 ParallelForChunks 相同，对每个索引调用 function(index)。
+    template <typename FuncT>
+    void ParallelFor(
+        size_t size,
+        FuncT &&function,
+        size_t min_chunk_size = 1u,
+        size_t max_concurrency = 0u) {
+      ParallelForChunks(size, [&function](size_t begin, size_t end) {
+        for (size_t index = begin; index < end; ++index) {
+          function(index);
+        }
+      }, min_chunk_size, max_concurrency);
+    }
+
+  private:
+
+    /// 每个线程平均分到的块数，空闲的线程接手剩余的块以平衡负载
+    static constexpr size_t CHUNKS_PER_THREAD = 4u;
+
+    struct WorkQueue {
+      std::mutex mutex;
+      std::deque<std::function<void()>> tasks;
+    };
+
+    void WorkerLoop(size_t index);
+
+    bool TryPop(size_t index, std::function<void()> &task);
+
+    static bool PopBack(WorkQueue &queue, std::function<void()> &task);
+
+    static bool PopFront(WorkQueue &queue, std::function<void()> &task);
+
+    static void Execute(std::function<void()> &task);
+
+    std::vector<std::unique_ptr<WorkQueue>> _queues;
+
+    /// 非工作线程提交的任务
+    WorkQueue _injection_queue;
+
+    std::mutex _mutex;
+
+    std::condition_variable _wake;
+
+    /// 所有队列中的任务数
+    size_t _queued = 0u;
+
+    bool _stop = false;
+
+    ThreadGroup _workers;
+  };
+
+  template <typename FuncT>
+  void TaskScheduler::ParallelForChunks(
+      const size_t size,
+      FuncT &&function,
+      size_t min_chunk_size,
+      const size_t max_concurrency) {
+    if (size == 0u) {
+      return;
+    }
+    min_chunk_size = std::max<size_t>(1u, min_chunk_size);
+    size_t concurrency = GetNumberOfWorkers() + 1u;
+    if (max_concurrency > 0u) {
+      concurrency = std::min(concurrency, max_concurrency);
+    }
+    if (concurrency <= 1u || size <= min_chunk_size) {
+      function(size_t(0u), size);
+      return;
+    }
+    const size_t number_of_chunks = concurrency * CHUNKS_PER_THREAD;
+    const size_t chunk_size = std::max(min_chunk_size, (size + number_of_chunks - 1u) / number_of_chunks);
+    auto job = std::make_shared<detail::ChunkedJob>(
+        size,
+        chunk_size,
+        [&function](size_t begin, size_t end) { function(begin, end); });
+    const size_t helpers = std::min(concurrency, job->GetNumberOfChunks()) - 1u;
+    for (size_t i = 0u; i < helpers; ++i) {
+      Spawn([job]() { job->Run(); });
+    }
+    job->Run();
+    job->Wait();
+  }
+
+  /// 一组任务。Wait 时调用线程执行组中尚未开始的任务，然后等待正在执行的任务，
+  /// 组中的任务也可以向组中加入新任务。
+  class TaskGroup : private NonCopyable {
+  public:
+
+    explicit TaskGroup(TaskScheduler &scheduler = TaskScheduler::Get());
+
+    /// 等待所有任务结束，忽略异常。
+    ~TaskGroup();
+
+    void Run(std::function<void()> task);
+
+    /// 等待所有任务结束，重新抛出第一个异常。
+    void Wait();
+
+  private:
+
+    struct State;
+
+    TaskScheduler &_scheduler;
+
+    std::shared_ptr<State> _state;
+  };
+
+  /// 有依赖关系的任务图，每个任务在它的所有前驱结束后执行。可以多次运行。
+  class TaskGraph : private NonCopyable {
+  public:
+
+    using NodeId = size_t;
+
+    NodeId Add(std::function<void()> task);
+
+    /// 任务 @a after 在任务 @a before 结束后执行。
+    void Precede(NodeId before, NodeId after);
+
+    size_t Size() const {
+      return _nodes.size();
+    }
+
+    /// 运行所有任务并等待结束。任务抛出异常时它的后继不再执行，异常在结束后
+    /// 重新抛出；图中有环时抛出 std::logic_error。
+    void Run(TaskScheduler &scheduler = TaskScheduler::Get());
+
+  private:
+
+    struct Node {
+      std::function<void()> task;
+      std::vector<NodeId> successors;
+      size_t number_of_predecessors = 0u;
+    };
+
+    std::vector<Node> _nodes;
+  };
+
+} // namespace carla
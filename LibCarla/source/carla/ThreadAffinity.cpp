@@ -0,0 +1,103 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/ThreadAffinity.h"
+
+#include "carla/Logging.h"
+
+#include <algorithm>
+#include <cctype>
+#include <exception>
+
+#ifdef _WIN32
+#  include <windows.h>
+#elif defined(__linux__)
+#  include <pthread.h>
+#  include <sched.h>
+#endif // _WIN32
+
+namespace carla {
+
+  /// 处理器编号的上限，避免格式错误的范围展开成巨大的列表。
+  static constexpr size_t MAX_CPU_COUNT = 4096u;
+
+  static bool IsNumber(const std::string &text) {
+    return !text.empty() && std::all_of(text.begin(), text.end(), [](const char c) {
+      return std::isdigit(static_cast<unsigned char>(c)) != 0;
+    });
+  }
+
+  bool SetCurrentThreadAffinity(const std::vector<size_t> &cpus) {
+    if (cpus.empty()) {
+      return true;
+    }
+#ifdef _WIN32
+    DWORD_PTR mask = 0u;
+    for (const size_t cpu : cpus) {
+      if (cpu >= sizeof(mask) * 8u) {
+        log_warning("thread affinity: cpu", cpu, "out of range");
+        return false;
+      }
+      mask |= DWORD_PTR(1) << cpu;
+    }
+    return SetThreadAffinityMask(GetCurrentThread(), mask) != 0;
+#elif defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (const size_t cpu : cpus) {
+      if (cpu >= CPU_SETSIZE) {
+        log_warning("thread affinity: cpu", cpu, "out of range");
+        return false;
+      }
+      CPU_SET(cpu, &set);
+    }
+    const int result = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    if (result != 0) {
+      log_warning("thread affinity: unable to set affinity, error", result);
+    }
+    return result == 0;
+#else
+    log_warning("thread affinity: not supported on this platform");
+    return false;
+#endif // _WIN32
+  }
+
+  std::vector<size_t> ParseCpuList(const std::string &text) {
+    std::vector<size_t> cpus;
+    size_t begin = 0u;
+    while (begin < text.size()) {
+      size_t end = text.find(',', begin);
+      if (end == std::string::npos) {
+        end = text.size();
+      }
+      const std::string item = text.substr(begin, end - begin);
+      const size_t separator = item.find('-');
+      const std::string first_text = item.substr(0u, separator);
+      const std::string last_text =
+          (separator == std::string::npos) ? first_text : item.substr(separator + 1u);
+      if (!IsNumber(first_text) || !IsNumber(last_text)) {
+        return {};
+      }
+      try {
+        const size_t first = std::stoul(first_text);
+        const size_t last = std::stoul(last_text);
+        if (last < first || last >= MAX_CPU_COUNT) {
+          return {};
+        }
+        for (size_t cpu = first; cpu <= last; ++cpu) {
+          cpus.emplace_back(cpu);
+        }
+      } catch (const std::exception &) {
+        return {};
+      }
+      begin = end + 1u;
+    }
+    std::sort(cpus.begin(), cpus.end());
+    cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+    return cpus;
+  }
+
+} // namespace carla
@@ -0,0 +1,22 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace carla {
+
+  /// 把当前线程绑定到 @a cpus 中的处理器上。@a cpus 为空时不做任何修改。
+  ///
+  /// 平台不支持或处理器编号无效时返回false，线程保持原有的调度方式。
+  bool SetCurrentThreadAffinity(const std::vector<size_t> &cpus);
+
+  /// 解析形如"0-3,8,10-11"的处理器列表，格式错误时返回空列表。
+  std::vector<size_t> ParseCpuList(const std::string &text);
+
+} // namespace carla
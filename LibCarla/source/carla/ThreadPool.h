@@ -8,6 +8,7 @@
 
 #include "carla/MoveHandler.h"   // 引入 MoveHandler，用于在 Boost.Asio 中包装任务
 #include "carla/NonCopyable.h"   // 引入 NonCopyable 类，确保 ThreadPool 不可拷贝
+#include "carla/ThreadAffinity.h" // 引入 SetCurrentThreadAffinity，用于绑定工作线程的处理器
 #include "carla/ThreadGroup.h"   // 引入 ThreadGroup，用于管理工作线程
 #include "carla/Time.h"          // 引入 Time 类，用于时间相关操作
 
@@ -17,6 +18,7 @@
 #include <future>    // 引入 future，用于支持异步任务的结果获取
 #include <thread>    // 引入 thread，用于获取硬件并发线程数
 #include <type_traits>   // 引入 type_traits，用于类型推断和 SFINAE
+#include <vector>
 
 namespace carla {
 
@@ -73,7 +75,20 @@ namespace carla {
   
   // 当CreateThreads方法被调用时，它会启动指定数量的线程，并且每个线程都会执行提供的lambda表达式，
   // 进而调用Run方法。这样，Run方法就会在多个线程中异步地执行。
-   // 调用 AsyncRun 函数，不指定线程数量，默认使用硬件并发线程数
+   // 启动 worker_threads 个工作线程，每个线程先把自己绑定到 cpus 中的处理器上再开始运行任务，
+  // cpus 为空时与不绑定处理器的版本相同。绑定失败时线程照常运行。
+    void AsyncRun(size_t worker_threads, std::vector<size_t> cpus) {
+      if (cpus.empty()) {
+        AsyncRun(worker_threads);
+        return;
+      }
+      _workers.CreateThreads(worker_threads, [this, cpus]() {
+        SetCurrentThreadAffinity(cpus);
+        Run();
+      });
+    }
+
+  // 调用 AsyncRun 函数，不指定线程数量，默认使用硬件并发线程数
     void AsyncRun() {
  // 定义一个无参成员函数AsyncRun。
 // 这个函数的目的是启动异步操作，但不需要调用者指定线程数量。
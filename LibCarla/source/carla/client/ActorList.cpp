@@ -9,19 +9,67 @@
 #include "carla/StringUtil.h" // 引入字符串工具类的头文件
 #include "carla/client/detail/ActorFactory.h" // 引入参与者工厂类的头文件
 
+#include <algorithm>
 #include <iterator> // 引入迭代器相关的标准库
+#include <mutex>
+#include <stdexcept>
+#include <unordered_map>
 
 namespace carla {
 namespace client {
 
+  /// 缓存的过滤结果超过此数量时清空缓存
+  static constexpr size_t MAX_CACHED_FILTERS = 64u;
+
+  /// 原列表及其所有过滤结果共享的参与者、类型索引和过滤结果的缓存。
+  struct ActorList::Storage {
+    std::vector<detail::ActorVariant> actors;
+
+    std::mutex mutex;
+
+    /// 每种类型的参与者的下标，按下标升序，第一次过滤时建立
+    std::unordered_map<std::string, IndexList> by_type;
+
+    bool has_type_index = false;
+
+    std::unordered_map<std::string, SharedPtr<const IndexList>> filter_cache;
+  };
+
   ActorList::ActorList( // 参与者列表构造函数
       detail::EpisodeProxy episode, // 传入的场景代理对象
-      std::vector<rpc::Actor> actors) // 传入的参与者列表
+      std::vector<SharedPtr<const rpc::Actor>> actors) // 传入的参与者列表
     : _episode(std::move(episode)), // 移动语义传递场景代理
-      _actors(std::make_move_iterator(actors.begin()), std::make_move_iterator(actors.end())) {} // 使用移动迭代器初始化参与者列表
+      _storage(MakeShared<Storage>()) {
+    // 使用移动迭代器初始化参与者列表
+    _storage->actors.assign(std::make_move_iterator(actors.begin()), std::make_move_iterator(actors.end()));
+  }
+
+  ActorList::ActorList(
+      detail::EpisodeProxy episode,
+      SharedPtr<Storage> storage,
+      SharedPtr<const IndexList> indices)
+    : _episode(std::move(episode)),
+      _storage(std::move(storage)),
+      _indices(std::move(indices)) {}
+
+  const detail::ActorVariant &ActorList::GetVariant(const size_t pos) const {
+    return _storage->actors[_indices != nullptr ? (*_indices)[pos] : pos];
+  }
+
+  SharedPtr<Actor> ActorList::at(const size_t pos) const {
+    if (pos >= size()) {
+      throw_exception(std::out_of_range("index out of range"));
+    }
+    return operator[](pos);
+  }
+
+  size_t ActorList::size() const {
+    return _indices != nullptr ? _indices->size() : _storage->actors.size();
+  }
 
   SharedPtr<Actor> ActorList::Find(const ActorId actor_id) const { // 查找指定ID的参与者
-    for (auto &actor : _actors) { // 遍历所有参与者
+    for (size_t i = 0u; i < size(); ++i) { // 遍历所有参与者
+      const auto &actor = GetVariant(i);
       if (actor_id == actor.GetId()) { // 如果找到匹配的ID
         return actor.Get(_episode); // 返回参与者的共享指针
       }
@@ -30,15 +78,53 @@ namespace client {
   }
 
   SharedPtr<ActorList> ActorList::Filter(const std::string &wildcard_pattern) const { // 根据通配符模式过滤参与者
-    SharedPtr<ActorList> filtered (new ActorList(_episode, {})); // 创建一个新的参与者列表用于存放过滤后的参与者
-    for (auto &&actor : _actors) { // 遍历所有参与者
-      if (StringUtil::Match(actor.GetTypeId(), wildcard_pattern)) { // 如果参与者类型与通配符匹配
-        filtered->_actors.push_back(actor); // 将匹配的参与者加入到过滤后的列表中
+    auto &storage = *_storage;
+    SharedPtr<const IndexList> matches;
+    {
+      std::lock_guard<std::mutex> lock(storage.mutex);
+      auto it = storage.filter_cache.find(wildcard_pattern);
+      if (it != storage.filter_cache.end()) {
+        matches = it->second;
+      } else {
+        if (!storage.has_type_index) {
+          for (size_t i = 0u; i < storage.actors.size(); ++i) {
+            storage.by_type[storage.actors[i].GetTypeId()].push_back(i);
+          }
+          storage.has_type_index = true;
+        }
+        // 参与者的类型远少于参与者，每种类型只匹配一次
+        std::vector<bool> matched(storage.actors.size(), false);
+        for (const auto &pair : storage.by_type) {
+          if (StringUtil::Match(pair.first, wildcard_pattern)) { // 如果参与者类型与通配符匹配
+            for (auto index : pair.second) {
+              matched[index] = true;
+            }
+          }
+        }
+        auto result = MakeShared<IndexList>();
+        for (size_t i = 0u; i < matched.size(); ++i) {
+          if (matched[i]) {
+            result->push_back(i);
+          }
+        }
+        if (storage.filter_cache.size() >= MAX_CACHED_FILTERS) {
+          storage.filter_cache.clear();
+        }
+        storage.filter_cache.emplace(wildcard_pattern, result);
+        matches = std::move(result);
       }
     }
-    return filtered; // 返回过滤后的参与者列表
+    if (_indices != nullptr) {
+      // 过滤结果的过滤，两个列表都按下标升序
+      auto result = MakeShared<IndexList>();
+      std::set_intersection(
+          _indices->begin(), _indices->end(),
+          matches->begin(), matches->end(),
+          std::back_inserter(*result));
+      matches = std::move(result);
+    }
+    return SharedPtr<ActorList>{new ActorList(_episode, _storage, std::move(matches))}; // 返回过滤后的参与者列表
   }
 
 } // namespace client
 } // namespace carla
-
@@ -7,80 +7,200 @@
 #include "carla/client/BlueprintLibrary.h" // 引入Carla客户端库中的BlueprintLibrary头文件，该文件包含了与Carla模拟器交互所需的蓝图相关功能。
 
 #include "carla/Exception.h" // 引入Carla异常处理相关的头文件，这个头文件包含了Carla模拟器中可能抛出的异常类，方便进行错误处理。
+#include "carla/StringUtil.h"
 
 #include <algorithm> // 引入标准库中的算法功能，该头文件包含了各种常见的算法，如排序、查找等，可以在容器中使用。
 #include <iterator> // 引入标准库中的迭代器相关功能，该头文件定义了用于遍历容器的迭代器功能，例如 std::begin 和 std::end。
+#include <mutex>
+#include <unordered_map>
 
 namespace carla {
 namespace client {
-//构造函数：使用给定的蓝图列表初始化 BlueprintLibary
+
+  /// 缓存的过滤结果超过此数量时清空缓存，以免模式不断变化时无限增长
+  static constexpr size_t MAX_CACHED_FILTERS = 256u;
+
+  /// 所有视图共享的蓝图、索引和过滤结果的缓存。
+  struct BlueprintLibrary::Storage {
+    /// 按 id 排序的蓝图
+    std::vector<ActorBlueprint> blueprints;
+
+    /// 每个标签对应的蓝图，按下标升序
+    std::unordered_map<std::string, IndexList> by_tag;
+
+    std::mutex mutex;
+
+    /// 整个蓝图库的过滤结果，按模式缓存
+    std::unordered_map<std::string, SharedPtr<const IndexList>> filter_cache;
+
+    /// 返回 @a key 对应的过滤结果，没有缓存时调用 @a compute 计算。
+    template <typename FuncT>
+    SharedPtr<const IndexList> GetFilter(const std::string &key, FuncT &&compute) {
+      std::lock_guard<std::mutex> lock(mutex);
+      auto it = filter_cache.find(key);
+      if (it != filter_cache.end()) {
+        return it->second;
+      }
+      if (filter_cache.size() >= MAX_CACHED_FILTERS) {
+        filter_cache.clear();
+      }
+      SharedPtr<const IndexList> result = compute();
+      filter_cache.emplace(key, result);
+      return result;
+    }
+  };
+
+namespace {
+
+  /// 通配符之前的字面前缀，匹配的 id 必须以此开头。Windows 上的匹配不区分
+  /// 大小写，不能按前缀查找，返回空字符串。
+  std::string GetLiteralPrefix(const std::string &wildcard_pattern) {
+#ifdef _WIN32
+    (void) wildcard_pattern;
+    return {};
+#else
+    return wildcard_pattern.substr(0u, wildcard_pattern.find_first_of("*?[\\"));
+#endif // _WIN32
+  }
+
+  bool ContainsValue(const ActorBlueprint &blueprint, const std::string &name, const std::string &value) {
+    if (!blueprint.ContainsAttribute(name)) {
+      return false; // 如果蓝图不包含指定的属性，则跳过
+    }
+    const ActorAttribute &attribute = blueprint.GetAttribute(name);
+    const std::vector<std::string> &values = attribute.GetRecommendedValues();
+    if (values.empty()) {
+      // 如果没有推荐值，检查当前属性值
+      return value == attribute.GetValue();
+    }
+    return std::find(values.begin(), values.end(), value) != values.end();
+  }
+
+} // namespace
+
+  //构造函数：使用给定的蓝图列表初始化 BlueprintLibary，建立标签的索引
   BlueprintLibrary::BlueprintLibrary(
-      const std::vector<rpc::ActorDefinition> &blueprints) {
-    _blueprints.reserve(blueprints.size()); //为存储蓝图预留空间
+      const std::vector<rpc::ActorDefinition> &blueprints)
+    : _storage(MakeShared<Storage>()) {
+    auto &storage = *_storage;
+    storage.blueprints.reserve(blueprints.size()); //为存储蓝图预留空间
     for (auto &definition : blueprints) {
-      _blueprints.emplace(definition.id, ActorBlueprint{definition});
-      //将每个蓝图按其 ID 添加到映射中
+      storage.blueprints.emplace_back(definition);
+    }
+    auto by_id = [](const ActorBlueprint &lhs, const ActorBlueprint &rhs) { return lhs.GetId() < rhs.GetId(); };
+    // id 重复时保留第一个定义
+    std::stable_sort(storage.blueprints.begin(), storage.blueprints.end(), by_id);
+    storage.blueprints.erase(
+        std::unique(storage.blueprints.begin(), storage.blueprints.end(), [](const auto &lhs, const auto &rhs) {
+          return lhs.GetId() == rhs.GetId();
+        }),
+        storage.blueprints.end());
+    for (size_t i = 0u; i < storage.blueprints.size(); ++i) {
+      for (const auto &tag : storage.blueprints[i].GetTags()) {
+        storage.by_tag[tag].push_back(i);
+      }
+    }
+  }
+
+  const ActorBlueprint &BlueprintLibrary::GetBlueprint(const size_t index) const {
+    DEBUG_ASSERT(index < _storage->blueprints.size());
+    return _storage->blueprints[index];
+  }
+
+  BlueprintLibrary::size_type BlueprintLibrary::size() const {
+    return _indices != nullptr ? _indices->size() : _storage->blueprints.size();
+  }
+
+  SharedPtr<BlueprintLibrary> BlueprintLibrary::MakeView(SharedPtr<const IndexList> matches) const {
+    if (_indices == nullptr) {
+      return SharedPtr<BlueprintLibrary>{new BlueprintLibrary(_storage, std::move(matches))};
     }
+    // 两个列表都按下标升序
+    auto result = MakeShared<IndexList>();
+    std::set_intersection(
+        _indices->begin(), _indices->end(),
+        matches->begin(), matches->end(),
+        std::back_inserter(*result));
+    return SharedPtr<BlueprintLibrary>{new BlueprintLibrary(_storage, std::move(result))};
   }
+
 //根据通配符模式过滤蓝图，返回匹配的 BlueprintLibrary 对象
   SharedPtr<BlueprintLibrary> BlueprintLibrary::Filter(
       const std::string &wildcard_pattern) const {
-    map_type result; //用于存储过滤后的蓝图映射
-    for (auto &pair : _blueprints) {
-      if (pair.second.MatchTags(wildcard_pattern)) { //检查蓝图是否匹配通配符模式
-        result.emplace(pair); // 如果蓝图匹配通配符模式，则添加到结果中
+    const auto &storage = *_storage;
+    return MakeView(_storage->GetFilter(wildcard_pattern, [&]() {
+      const auto &blueprints = storage.blueprints;
+      std::vector<bool> matched(blueprints.size(), false);
+      // 只有以字面前缀开头的 id 才可能匹配，在排序的 id 中二分查找这一段
+      const std::string prefix = GetLiteralPrefix(wildcard_pattern);
+      auto it = std::lower_bound(blueprints.begin(), blueprints.end(), prefix, [](const ActorBlueprint &blueprint, const std::string &value) {
+        return blueprint.GetId() < value;
+      });
+      for (; (it != blueprints.end()) && (it->GetId().compare(0u, prefix.size(), prefix) == 0); ++it) {
+        if (StringUtil::Match(it->GetId(), wildcard_pattern)) {
+          matched[static_cast<size_t>(it - blueprints.begin())] = true;
+        }
       }
-    }
-    return SharedPtr<BlueprintLibrary>{new BlueprintLibrary(result)};
-    // 返回过滤后的 BlueprintLibrary 对象
+      // 不同的标签很少，每个标签只匹配一次
+      for (const auto &pair : storage.by_tag) {
+        if (StringUtil::Match(pair.first, wildcard_pattern)) {
+          for (auto index : pair.second) {
+            matched[index] = true;
+          }
+        }
+      }
+      auto result = MakeShared<IndexList>();
+      for (size_t i = 0u; i < matched.size(); ++i) {
+        if (matched[i]) {
+          result->push_back(i);
+        }
+      }
+      return result;
+    }));
   }
+
 //根据属性名称和值过滤蓝图，返回匹配的 BlueprintLibrary 对象
   SharedPtr<BlueprintLibrary> BlueprintLibrary::FilterByAttribute(
       const std::string &name, const std::string& value) const {
-    map_type result; //用于存储过滤后的蓝图映射
-
-    for (auto &pair : _blueprints) {
-      if (!pair.second.ContainsAttribute(name))
-        continue; //如果蓝图不包含指定的属性，则跳过
-      const ActorAttribute &Attribute = pair.second.GetAttribute(name); //获取指定的属性
-      const std::vector<std::string> &Values = Attribute.GetRecommendedValues();//获取推荐值
-      if (Values.empty()) // 如果没有推荐值，检查当前属性值
-      {
-        const std::string &AttributeValue = Attribute.GetValue(); //获取属性当前值
-        if (value == AttributeValue) 
-          result.emplace(pair); // 如果属性值匹配，则添加到结果中
-      }
-      else
-      {
-        for (const std::string &Value : Values) // 遍历推荐值列表
-        {
-          if (Value == value) 
-          {
-            result.emplace(pair); // 如果找到匹配值，添加到结果中
-            break; //找到匹配后退出循环
-          }
+    const auto &blueprints = _storage->blueprints;
+    // 属性过滤与通配符过滤共用缓存，键以 '\0' 开头，不会与任何模式相同
+    const std::string key = std::string(1u, '\0') + name + '\0' + value;
+    return MakeView(_storage->GetFilter(key, [&]() {
+      auto result = MakeShared<IndexList>();
+      for (size_t i = 0u; i < blueprints.size(); ++i) {
+        if (ContainsValue(blueprints[i], name, value)) {
+          result->push_back(i);
         }
       }
-
-    }
-    return SharedPtr<BlueprintLibrary>{new BlueprintLibrary(result)};  // 返回过滤后的 BlueprintLibrary 对象
+      return result;
+    }));
   }
 
   // 查找并返回与给定键匹配的蓝图，如果未找到返回 nullptr
   BlueprintLibrary::const_pointer BlueprintLibrary::Find(const std::string &key) const {
-    auto it = _blueprints.find(key); // 在 _blueprints 字典中查找给定的键
-    return it != _blueprints.end() ? &it->second : nullptr;
-    // 如果找到对应键，返回其值的指针，否则返回 nullptr
+    const auto &blueprints = _storage->blueprints;
+    auto it = std::lower_bound(blueprints.begin(), blueprints.end(), key, [](const ActorBlueprint &blueprint, const std::string &value) {
+      return blueprint.GetId() < value;
+    });
+    if ((it == blueprints.end()) || (it->GetId() != key)) {
+      return nullptr;
+    }
+    const size_t index = static_cast<size_t>(it - blueprints.begin());
+    // 视图只包含部分蓝图
+    if ((_indices != nullptr) && !std::binary_search(_indices->begin(), _indices->end(), index)) {
+      return nullptr;
+    }
+    return &*it;
   }
 
   // 根据指定的键返回蓝图的常量引用，如果未找到键则抛出异常
   BlueprintLibrary::const_reference BlueprintLibrary::at(const std::string &key) const {
-    auto it = _blueprints.find(key); // 在 _blueprints 字典中查找给定的键
-    if (it == _blueprints.end()) {
+    auto blueprint = Find(key);
+    if (blueprint == nullptr) {
       using namespace std::string_literals;
       throw_exception(std::out_of_range("blueprint '"s + key + "' not found"));
     } //如果未找到对应的键，抛出 std::out_of_range 异常
-    return it->second;//如果找到对应的键，则返回对应键的蓝图的常量引用
+    return *blueprint;
   }
 
   // 根据指定位置返回蓝图的常量引用，如果位置超出范围则抛出异常
@@ -7,30 +7,46 @@
 #pragma once
 
 #include "carla/Debug.h"
-#include "carla/Iterator.h"
 #include "carla/Memory.h"
 #include "carla/NonCopyable.h"
 #include "carla/client/ActorBlueprint.h"
 
-#include <type_traits>
-#include <unordered_map>
+#include <boost/iterator/counting_iterator.hpp>
+#include <boost/iterator/transform_iterator.hpp>
+
+#include <string>
 #include <vector>
 
 namespace carla {
 namespace client {
 
-  /// @todo 看起来像列表，但实际上是地图。我们应该评估用例并重新考虑此实现。
+  /// 蓝图的列表，同时可以按 id 查找。
+  ///
+  /// 所有蓝图按 id 排序保存在一份共享的数据中，过滤得到的蓝图库只是引用其中
+  /// 部分蓝图的视图，不复制蓝图。标签的索引在构造时建立，过滤结果按模式缓存，
+  /// 同一个蓝图库及其过滤结果重复使用同一模式过滤时不再逐个匹配。
   class BlueprintLibrary
     : public EnableSharedFromThis<BlueprintLibrary>,
       private MovableNonCopyable {
-    using map_type = std::unordered_map<std::string, ActorBlueprint>;
+
+    using IndexList = std::vector<size_t>;
+
+    struct Storage;
+
+    struct GetBlueprintFn {
+      const BlueprintLibrary *self;
+      const ActorBlueprint &operator()(size_t pos) const {
+        return (*self)[pos];
+      }
+    };
+
   public:
 
     // 这里我们强制使用一些 typedef 来使这个类看起来像一个列表。
-    using key_type = map_type::key_type;
-    using value_type = map_type::mapped_type;
-    using size_type = map_type::size_type;
-    using const_iterator = decltype(carla::iterator::make_map_values_const_iterator<map_type::const_iterator>(map_type::const_iterator{}));
+    using key_type = std::string;
+    using value_type = ActorBlueprint;
+    using size_type = size_t;
+    using const_iterator = boost::transform_iterator<GetBlueprintFn, boost::counting_iterator<size_type>>;
     using const_reference = const value_type &;
     using const_pointer = const value_type *;
 
@@ -43,43 +59,48 @@ namespace client {
     SharedPtr<BlueprintLibrary> Filter(const std::string &wildcard_pattern) const;
     SharedPtr<BlueprintLibrary> FilterByAttribute(const std::string &name, const std::string& value) const;
 
+    /// 对数复杂度。
     const_pointer Find(const std::string &key) const;
 
     /// @throw 如果不存在这些元素，则抛出 std::out_of_range 异常。
     const_reference at(const std::string &key) const;
 
-    /// @warning 线性复杂度。
     const_reference operator[](size_type pos) const {
-      using diff_t = std::iterator_traits<const_iterator>::difference_type;
-      return std::next(_blueprints.begin(), static_cast<diff_t>(pos))->second;
+      return GetBlueprint(_indices != nullptr ? (*_indices)[pos] : pos);
     }
 
-    /// @warning 线性复杂度。
     /// @throw std::out_of_range if !(pos < size()).
     const_reference at(size_type pos) const;
-    // 返回一个指向容器中第一个元素的常量迭代器，该迭代器只能读取值。
+    // 返回一个指向容器中第一个元素的常量迭代器，蓝图按 id 排序。
     const_iterator begin() const /*noexcept*/ {
-      return iterator::make_map_values_const_iterator(_blueprints.begin());
+      return boost::make_transform_iterator(boost::counting_iterator<size_type>(0u), GetBlueprintFn{this});
     }
     // 返回一个指向容器末尾的常量迭代器，该迭代器只能读取值。
     const_iterator end() const /*noexcept*/ {
-      return iterator::make_map_values_const_iterator(_blueprints.end());
+      return boost::make_transform_iterator(boost::counting_iterator<size_type>(size()), GetBlueprintFn{this});
     }
     // 检查容器是否为空，如果没有任何元素则返回true。
     bool empty() const /*noexcept*/ {
-      return _blueprints.empty();
+      return size() == 0u;
     }
     // 返回容器中元素的数量。
-    size_type size() const /*noexcept*/ {
-      return _blueprints.size();
-    }
+    size_type size() const /*noexcept*/;
 
   private:
 
-    BlueprintLibrary(map_type blueprints)
-      : _blueprints(std::move(blueprints)) {}
+    /// 只包含 @a storage 中 @a indices 所指蓝图的视图，@a indices 为空指针时包含全部蓝图。
+    BlueprintLibrary(SharedPtr<Storage> storage, SharedPtr<const IndexList> indices)
+      : _storage(std::move(storage)),
+        _indices(std::move(indices)) {}
+
+    const ActorBlueprint &GetBlueprint(size_t index) const;
+
+    /// 把整个蓝图库的过滤结果 @a matches 限制到本视图中的蓝图。
+    SharedPtr<BlueprintLibrary> MakeView(SharedPtr<const IndexList> matches) const;
+
+    SharedPtr<Storage> _storage;
 
-    map_type _blueprints;
+    SharedPtr<const IndexList> _indices;
   };
 
 } // namespace client
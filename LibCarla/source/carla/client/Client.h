@@ -42,6 +42,20 @@ namespace client {
       return _simulator->GetNetworkingTimeout();
     }
 
+    /// 限制之后监听的每个传感器最多有 @a credits 条尚未在回调中处理完的数据，服务器在
+    /// 回调跟不上时跳过数据，而不是在客户端堆积。为0时不限制；记录器等无损订阅不受影响。
+    /// 只对通过多路复用连接接收的传感器有效，见 SetSensorMultiplexing。
+    void SetSensorCredits(uint32_t credits) {
+      _simulator->SetSensorCredits(credits);
+    }
+
+    /// 启用后，之后监听的传感器共用到每个服务器的一个连接，默认每个传感器一个连接。
+    /// 多路复用连接上的数据总是通过TCP发送，不使用组播；服务器不支持多路复用时自动
+    /// 改用每个传感器一个连接。
+    void SetSensorMultiplexing(bool enable) {
+      _simulator->SetSensorMultiplexing(enable);
+    }
+
     /// 返回此客户端 API 版本的字符串。
     std::string GetClientVersion() const {
       return _simulator->GetClientVersion();
@@ -56,6 +70,12 @@ namespace client {
     std::vector<std::string> GetAvailableMaps() const {
       return _simulator->GetAvailableMaps();
     }
+
+    /// 多GPU模式下每个次级服务器的状态和耗时统计，用于找出拖慢同步模式
+    /// 的次级服务器。不是多GPU模式时为空。
+    std::vector<rpc::SecondaryTelemetry> GetSecondaryTelemetry() const {
+      return _simulator->GetSecondaryTelemetry();
+    }
     /// 设置文件系统的基路径（文件夹）。 
     /// 用于设置模拟器读取文件的路径。
     /// 返回操作是否成功。
@@ -90,6 +110,13 @@ namespace client {
       return World{_simulator->LoadEpisode(std::move(map_name), reset_settings, map_layers)};
     }
 
+    /// 在服务器后台加载地图 @a map_name 的资源，不中断当前场景，之后
+    /// LoadWorld 加载这张地图时不需要再从磁盘读取这些资源。找不到地图时
+    /// 返回 false。
+    bool PreloadMap(std::string map_name) const {
+      return _simulator->PreloadMap(std::move(map_name));
+    }
+
     /// 如果当前地图与请求地图不同，则加载新地图。
     void LoadWorldIfDifferent(
         std::string map_name,
@@ -140,6 +167,23 @@ namespace client {
       return _simulator->StartRecorder(name, additional_data);
     }
 
+    // 启动录像功能，只记录过滤器选中的参与者和数据包。
+    std::string StartRecorder(
+        std::string name,
+        bool additional_data,
+        const rpc::RecorderFilter &filter) {
+      return _simulator->StartRecorder(name, additional_data, filter);
+    }
+
+    // 启动录像功能，数据不写入服务器上的文件，而是通过流媒体服务器按顺序交给
+    // callback，拼接起来与录制文件的内容相同。停止录制时等待最后的数据。
+    void StartRecorderStream(
+        std::function<void(Buffer)> callback,
+        bool additional_data = false,
+        const rpc::RecorderFilter &filter = rpc::RecorderFilter()) {
+      _simulator->StartRecorderStream(std::move(callback), additional_data, filter);
+    }
+
     // 停止记录并保存日志数据。
     void StopRecorder(void) {
       _simulator->StopRecorder();
@@ -175,6 +219,13 @@ namespace client {
       return _simulator->ReplayFile(name, start, duration, follow_id, replay_sensors);
     }
 
+    // 以最快速度回放整个文件，返回每秒回放的帧数、每种数据包的处理时间，
+    // 以及回放的位置与录制的位置的差异。需要先加载录制时的地图。
+    /// @param tolerance 位置差异的容许值，单位为厘米。
+    std::string BenchmarkReplayer(std::string name, double tolerance = 1.0) {
+      return _simulator->BenchmarkReplayer(name, tolerance);
+    }
+
     // 停止当前的重放过程。
     void StopReplayer(bool keep_actors) {
       _simulator->StopReplayer(keep_actors);
@@ -215,6 +266,20 @@ namespace client {
       return responses;  // 返回所有命令的响应列表。
     }
 
+    // 把命令列表交给服务器分多帧执行，每帧最多用 time_budget 秒，适合一次生成
+    // 大量参与者。同一批中位置重合的车辆和行人直接以碰撞失败。返回用于
+    // GetSpawnBatchStatus 的编号。
+    uint64_t SpawnBatch(
+        std::vector<rpc::Command> commands,
+        double time_budget = 0.005) const {
+      return _simulator->SpawnBatch(std::move(commands), time_budget);
+    }
+
+    // 查询 SpawnBatch 的进度；全部执行完后返回每个命令的结果，之后该编号失效。
+    rpc::SpawnBatchStatus GetSpawnBatchStatus(uint64_t ticket) const {
+      return _simulator->GetSpawnBatchStatus(ticket);
+    }
+
   private:
   
     // 当前仿真器实例的智能指针，用于管理仿真器的生命周期。
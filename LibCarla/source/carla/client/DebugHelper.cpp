@@ -145,5 +145,45 @@ namespace client {
     DrawShape(_episode, string, color, life_time, persistent_lines); // 调用绘制形状
   }
 
+  void DebugHelper::DrawBatch(
+      uint64_t id,
+      const std::vector<std::pair<geom::Location, geom::Location>> &lines,
+      const std::vector<geom::Location> &points,
+      const std::vector<std::pair<geom::BoundingBox, geom::Rotation>> &boxes,
+      float thickness,
+      float point_size,
+      sensor::data::Color color) {
+    rpc::DebugShapeBatch batch;
+    batch.id = id;
+    batch.color = color;
+    batch.lines.reserve(lines.size());
+    for (const auto &line : lines) {
+      batch.lines.push_back(Shape::Line{line.first, line.second, thickness});
+    }
+    batch.points.reserve(points.size());
+    for (const auto &point : points) {
+      batch.points.push_back(Shape::Point{point, point_size});
+    }
+    batch.boxes.reserve(boxes.size());
+    for (const auto &box : boxes) {
+      batch.boxes.push_back(Shape::Box{box.first, box.second, thickness});
+    }
+    _episode.Lock()->DrawDebugShapeBatches({std::move(batch)});
+  }
+
+  void DebugHelper::DrawBatches(const std::vector<rpc::DebugShapeBatch> &batches) {
+    _episode.Lock()->DrawDebugShapeBatches(batches);
+  }
+
+  void DebugHelper::ClearBatch(uint64_t id) {
+    rpc::DebugShapeBatch batch;
+    batch.id = id;
+    _episode.Lock()->DrawDebugShapeBatches({std::move(batch)});
+  }
+
+  void DebugHelper::ClearAllBatches() {
+    _episode.Lock()->ClearDebugShapeBatches();
+  }
+
 } // namespace client
 } // namespace carla
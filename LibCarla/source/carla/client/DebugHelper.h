@@ -11,6 +11,10 @@
 #include "carla/geom/Location.h"                 // 包含 Location 的头文件
 #include "carla/geom/Rotation.h"                 // 包含 Rotation 的头文件
 #include "carla/sensor/data/Color.h"             // 包含 Color 数据类型的头文件
+#include "carla/rpc/DebugShape.h"                // 包含 DebugShapeBatch 的头文件
+
+#include <utility>
+#include <vector>
 
 namespace carla {
 namespace client {
@@ -105,6 +109,26 @@ namespace client {
         float life_time = -1.0f,          // 字符串的生命周期，默认值为无限
         bool persistent_lines = true);     // 是否绘制持久线
 
+    /// 用一次调用绘制一组持久的线、点和方框，替换这个客户端之前用相同 @a id
+    /// 绘制的形状。形状一直保留到被替换或清除，不需要每帧重新绘制。
+    void DrawBatch(
+        uint64_t id,
+        const std::vector<std::pair<geom::Location, geom::Location>> &lines,
+        const std::vector<geom::Location> &points = {},
+        const std::vector<std::pair<geom::BoundingBox, geom::Rotation>> &boxes = {},
+        float thickness = 0.1f,
+        float point_size = 0.1f,
+        Color color = Color{255u, 0u, 0u});
+
+    /// 一次调用替换多个 id 的形状，没有形状的 id 被删除。
+    void DrawBatches(const std::vector<rpc::DebugShapeBatch> &batches);
+
+    /// 删除 @a id 的形状。
+    void ClearBatch(uint64_t id);
+
+    /// 删除这个客户端绘制的所有持久形状。
+    void ClearAllBatches();
+
   private:
 
     detail::EpisodeProxy _episode;  // 存储 EpisodeProxy 对象
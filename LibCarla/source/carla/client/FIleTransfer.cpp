@@ -5,8 +5,17 @@
 // For a copy, see <https://opensource.org/licenses/MIT>.
 
 #include "FileTransfer.h" // 引入FileTransfer.h头文件，该文件包含文件传输功能的声明
+#include "carla/Exception.h"
 #include "carla/Version.h" // 引入carla版本信息头文件，用于获取当前Carla的版本
 
+#include <boost/interprocess/sync/file_lock.hpp>
+#include <boost/interprocess/sync/scoped_lock.hpp>
+
+#include <cstdio>
+#include <deque>
+#include <sstream>
+#include <stdexcept>
+
 namespace carla {
 namespace client {
 
@@ -36,28 +45,26 @@ namespace client {
     return _filesBaseFolder;
   }
 
-  // 检查指定的文件是否存在
-  bool FileTransfer::FileExists(std::string file) {
-    // 构建文件的完整路径
-    struct stat buffer;
+  // 构建文件的完整路径，缓存按Carla版本号分目录
+  std::string FileTransfer::GetFullPath(const std::string &path) {
     std::string fullpath = _filesBaseFolder;
     fullpath += "/";
     fullpath += ::carla::version(); // 加入当前的Carla版本号
     fullpath += "/";
-    fullpath += file; // 添加目标文件名
+    fullpath += path; // 添加目标文件名
+    return fullpath;
+  }
 
+  // 检查指定的文件是否存在
+  bool FileTransfer::FileExists(std::string file) {
+    struct stat buffer;
     // 使用 stat 函数检查文件是否存在
-    return (stat(fullpath.c_str(), &buffer) == 0);
+    return (stat(GetFullPath(file).c_str(), &buffer) == 0);
   }
 
   // 将内容写入指定路径的文件
   bool FileTransfer::WriteFile(std::string path, std::vector<uint8_t> content) {
-    // 构建文件的完整路径
-    std::string writePath = _filesBaseFolder;
-    writePath += "/";
-    writePath += ::carla::version(); // 加入当前的Carla版本号
-    writePath += "/";
-    writePath += path; // 添加目标文件的路径
+    std::string writePath = GetFullPath(path);
 
     // 验证文件路径并创建所需的目录
     carla::FileSystem::ValidateFilePath(writePath);
@@ -67,9 +74,7 @@ namespace client {
     if(!out.good()) return false;
 
     // 将内容写入文件
-    for(auto file : content) {
-          out << file;
-    }
+    out.write(reinterpret_cast<const char *>(content.data()), content.size());
     out.close();
 
     return true;
@@ -77,17 +82,173 @@ namespace client {
 
   // 读取指定路径的文件内容，并返回一个字节向量
   std::vector<uint8_t> FileTransfer::ReadFile(std::string path) {
-    // 构建文件的完整路径
-    std::string fullpath = _filesBaseFolder;
-    fullpath += "/";
-    fullpath += ::carla::version(); // 加入当前的Carla版本号
-    fullpath += "/";
-    fullpath += path; // 添加目标文件路径
     // 从文件中读取内容并返回字节向量
-    std::ifstream file(fullpath, std::ios::binary);
+    std::ifstream file(GetFullPath(path), std::ios::binary);
     std::vector<uint8_t> content(std::istreambuf_iterator<char>(file), {});
     return content;
   }
 
+namespace {
+
+  std::string ReadText(const std::string &path) {
+    std::ifstream file(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(file), {});
+  }
+
+  bool WriteText(const std::string &path, const std::string &text) {
+    std::ofstream file(path, std::ios::trunc | std::ios::binary);
+    file << text;
+    return file.good();
+  }
+
+  bool GetFileSize(const std::string &path, uint64_t &size) {
+    struct stat buffer;
+    if (stat(path.c_str(), &buffer) != 0) {
+      return false;
+    }
+    size = static_cast<uint64_t>(buffer.st_size);
+    return true;
+  }
+
+  /// .part.state 的内容：文件哈希、分块大小和每一块是否已完成（'0' 或 '1'），各占一行。
+  std::string MakeDownloadState(const rpc::FileInfo &info, const std::string &done) {
+    return info.hash + "\n" + std::to_string(info.chunk_size) + "\n" + done + "\n";
+  }
+
+  /// 读取与 @a info 对应的未完成的下载，没有或不匹配时返回空字符串。
+  std::string ReadDownloadState(
+      const std::string &state_path,
+      const std::string &part_path,
+      const rpc::FileInfo &info) {
+    uint64_t part_size = 0u;
+    if (!GetFileSize(part_path, part_size) || (part_size != info.size)) {
+      return {};
+    }
+    std::istringstream state(ReadText(state_path));
+    std::string hash, chunk_size, done;
+    std::getline(state, hash);
+    std::getline(state, chunk_size);
+    std::getline(state, done);
+    if ((hash != info.hash) ||
+        (chunk_size != std::to_string(info.chunk_size)) ||
+        (done.size() != info.GetNumberOfChunks()) ||
+        (done.find_first_not_of("01") != std::string::npos)) {
+      return {};
+    }
+    return done;
+  }
+
+} // namespace
+
+  bool FileTransfer::IsUpToDate(const std::string &path, const rpc::FileInfo &info) {
+    const std::string fullpath = GetFullPath(path);
+    uint64_t size = 0u;
+    if (!GetFileSize(fullpath, size) || (size != info.size)) {
+      return false;
+    }
+    const std::string hash_path = fullpath + ".hash";
+    if (ReadText(hash_path) == info.hash) {
+      return true;
+    }
+    // 没有记录哈希的旧缓存，计算一次
+    const auto content = ReadFile(path);
+    const auto local = rpc::FileInfo::Make(content.data(), content.size(), info.chunk_size);
+    if (local.hash != info.hash) {
+      return false;
+    }
+    WriteText(hash_path, local.hash);
+    return true;
+  }
+
+  void FileTransfer::DownloadFile(
+      const std::string &path,
+      const rpc::FileInfo &info,
+      const ChunkRequest &request,
+      const size_t max_pending_chunks) {
+    std::string fullpath = GetFullPath(path);
+    carla::FileSystem::ValidateFilePath(fullpath);
+
+    // 文件锁在进程退出时由操作系统释放，不会留下失效的锁
+    const std::string lock_path = fullpath + ".lock";
+    std::ofstream(lock_path, std::ios::app | std::ios::binary);
+    boost::interprocess::file_lock file_lock(lock_path.c_str());
+    boost::interprocess::scoped_lock<boost::interprocess::file_lock> lock(file_lock);
+    if (IsUpToDate(path, info)) {
+      // 另一个进程已经下载完成
+      return;
+    }
+
+    const std::string part_path = fullpath + ".part";
+    const std::string state_path = fullpath + ".part.state";
+    std::string done = ReadDownloadState(state_path, part_path, info);
+    if (done.empty() && (info.GetNumberOfChunks() > 0u)) {
+      std::ofstream part(part_path, std::ios::trunc | std::ios::binary);
+      if (info.size > 0u) {
+        part.seekp(static_cast<std::streamoff>(info.size - 1u));
+        part.put('\0');
+      }
+      if (!part.good()) {
+        throw_exception(std::runtime_error("unable to write " + part_path));
+      }
+      done.assign(info.GetNumberOfChunks(), '0');
+      WriteText(state_path, MakeDownloadState(info, done));
+    } else if (info.GetNumberOfChunks() == 0u) {
+      std::ofstream part(part_path, std::ios::trunc | std::ios::binary);
+    }
+
+    std::fstream part(part_path, std::ios::in | std::ios::out | std::ios::binary);
+    if (!part.good()) {
+      throw_exception(std::runtime_error("unable to open " + part_path));
+    }
+
+    // 保持最多 max_pending_chunks 个请求在路上，按完成顺序写入
+    std::deque<std::pair<size_t, std::future<std::vector<uint8_t>>>> pending;
+    size_t next = 0u;
+    auto request_more = [&]() {
+      while (pending.size() < std::max<size_t>(1u, max_pending_chunks)) {
+        next = done.find('0', next);
+        if (next == std::string::npos) {
+          next = done.size();
+          return;
+        }
+        pending.emplace_back(next, request(info.GetChunkOffset(next), info.GetChunkLength(next)));
+        ++next;
+      }
+    };
+    request_more();
+    while (!pending.empty()) {
+      const size_t chunk = pending.front().first;
+      // 超时等错误直接抛出，已完成的块留在 .part 中，下次调用时继续
+      const auto data = pending.front().second.get();
+      pending.pop_front();
+      if ((data.size() != info.GetChunkLength(chunk)) ||
+          (rpc::CachedContent::ComputeHash(data) != info.chunk_hashes[chunk])) {
+        throw_exception(std::runtime_error(
+            "corrupted chunk " + std::to_string(chunk) + " of " + path));
+      }
+      part.seekp(static_cast<std::streamoff>(info.GetChunkOffset(chunk)));
+      part.write(reinterpret_cast<const char *>(data.data()), static_cast<std::streamsize>(data.size()));
+      part.flush();
+      if (!part.good()) {
+        throw_exception(std::runtime_error("unable to write " + part_path));
+      }
+      // 数据写入之后才记录完成
+      done[chunk] = '1';
+      WriteText(state_path, MakeDownloadState(info, done));
+      request_more();
+    }
+    part.close();
+
+    // POSIX 上 rename 原子地替换目标文件，Windows 上需要先删除
+    if (std::rename(part_path.c_str(), fullpath.c_str()) != 0) {
+      std::remove(fullpath.c_str());
+      if (std::rename(part_path.c_str(), fullpath.c_str()) != 0) {
+        throw_exception(std::runtime_error("unable to write " + fullpath));
+      }
+    }
+    WriteText(fullpath + ".hash", info.hash);
+    std::remove(state_path.c_str());
+  }
+
 } // namespace client
 } // namespace carla
@@ -7,12 +7,16 @@
 #pragma once
 
 #include "carla/FileSystem.h"   // 引入CARLA客户端传感器的头文件
+#include "carla/rpc/FileInfo.h"
 
 #include <fstream>  // 引入文件流库
+#include <functional>
+#include <future>
 #include <iostream>  // 引入输入输出流库
 #include <string>  // 引入字符串库
 #include <sys/stat.h>  // 引入用于文件状态的系统调用库
 #include <cstdint>   // 引入标准整数类型库
+#include <vector>
 
 namespace carla {    // 定义carla命名空间
 namespace client {   // 定义client命名空间
@@ -34,8 +38,33 @@ namespace client {   // 定义client命名空间
 
     static std::vector<uint8_t> ReadFile(std::string path);   // 读取文件内容，返回字节向量
 
+    /// 请求文件中从 offset 开始的 length 个字节，返回的future在数据到达时就绪。
+    using ChunkRequest = std::function<std::future<std::vector<uint8_t>>(uint64_t offset, uint32_t length)>;
+
+    /// 缓存中的文件是否与 @a info 描述的内容相同。没有记录哈希的旧文件按块
+    /// 计算一次哈希并记录下来。
+    static bool IsUpToDate(const std::string &path, const rpc::FileInfo &info);
+
+    /// @brief 分块下载文件到缓存中。
+    ///
+    /// 同时最多请求 @a max_pending_chunks 块，每一块按 @a info 中的哈希校验后
+    /// 写入 .part 文件，已完成的块记录在 .part.state 中，下载中断后再次调用只
+    /// 请求缺少的块。全部完成后 .part 文件原子地替换目标文件，读取缓存的进程
+    /// 不会看到写了一半的文件。多个进程同时下载同一文件时由文件锁串行化，
+    /// 后得到锁的进程发现文件已是最新时直接返回。
+    ///
+    /// @throw std::runtime_error 如果块的数据与哈希不符或无法写入文件。
+    static void DownloadFile(
+        const std::string &path,
+        const rpc::FileInfo &info,
+        const ChunkRequest &request,
+        size_t max_pending_chunks = 4u);
+
   private:
 
+    /// 缓存中 @a path 的完整路径。
+    static std::string GetFullPath(const std::string &path);
+
     static std::string _filesBaseFolder;   // 存储文件基础目录的静态变量
 
   };
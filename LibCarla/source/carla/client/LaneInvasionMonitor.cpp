@@ -0,0 +1,151 @@
+// Copyright (c) 2019 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/client/LaneInvasionMonitor.h"
+
+#include "carla/Debug.h"
+#include "carla/ParallelFor.h"
+#include "carla/client/Map.h"
+#include "carla/client/WorldSnapshot.h"
+#include "carla/geom/Math.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace carla {
+namespace client {
+
+  using road::element::LaneCrossingCalculator;
+
+  // 根据给定的偏航角旋转位置
+  static geom::Location Rotate(float yaw, const geom::Location &location) {
+    // 将偏航角从度转换为弧度
+    yaw *= geom::Math::Pi<float>() / 180.0f;
+    const float c = std::cos(yaw);
+    const float s = std::sin(yaw);
+    return {
+        c * location.x - s * location.y,
+        s * location.x + c * location.y,
+        location.z};
+  }
+
+  // 车辆包围盒在地面上的四个角
+  static std::array<geom::Location, 4u> MakeCorners(
+      const geom::BoundingBox &box,
+      const geom::Transform &transform) {
+    const auto location = transform.location + box.location;
+    const auto yaw = transform.rotation.yaw;
+    return {
+        location + Rotate(yaw, geom::Location( box.extent.x,  box.extent.y, 0.0f)),
+        location + Rotate(yaw, geom::Location(-box.extent.x,  box.extent.y, 0.0f)),
+        location + Rotate(yaw, geom::Location( box.extent.x, -box.extent.y, 0.0f)),
+        location + Rotate(yaw, geom::Location(-box.extent.x, -box.extent.y, 0.0f))};
+  }
+
+  LaneInvasionMonitor::LaneInvasionMonitor(SharedPtr<const Map> map)
+    : _map(std::move(map)) {
+    DEBUG_ASSERT(_map != nullptr);
+  }
+
+  void LaneInvasionMonitor::AddVehicle(ActorId vehicle, const geom::BoundingBox &bounding_box) {
+    RemoveVehicle(vehicle);
+    _vehicles.emplace_back();
+    _vehicles.back().id = vehicle;
+    _vehicles.back().bounding_box = bounding_box;
+  }
+
+  void LaneInvasionMonitor::RemoveVehicle(ActorId vehicle) {
+    _vehicles.erase(
+        std::remove_if(_vehicles.begin(), _vehicles.end(), [vehicle](const VehicleState &state) {
+          return state.id == vehicle;
+        }),
+        _vehicles.end());
+  }
+
+  bool LaneInvasionMonitor::TickVehicle(
+      VehicleState &vehicle,
+      const size_t frame,
+      const geom::Transform &transform,
+      Invasion &invasion) const {
+    const auto &map = _map->GetMap();
+    const auto next = MakeCorners(vehicle.bounding_box, transform);
+
+    // 第一帧只记录各个角所在的车道。
+    if (!vehicle.has_corners) {
+      for (auto i = 0u; i < 4u; ++i) {
+        LaneCrossingCalculator::Calculate(map, vehicle.contexts[i], next[i]);
+      }
+      vehicle.corners = next;
+      vehicle.frame = frame;
+      vehicle.has_corners = true;
+      return false;
+    }
+
+    // 确保当前帧是最新的。
+    if (vehicle.frame >= frame) {
+      return false;
+    }
+
+    // 确保距离足够长。
+    constexpr float distance_threshold = 10.0f * std::numeric_limits<float>::epsilon();
+    for (auto i = 0u; i < 4u; ++i) {
+      if ((next[i] - vehicle.corners[i]).Length() < distance_threshold) {
+        return false;
+      }
+    }
+
+    invasion.crossed_lane_markings.clear();
+    for (auto i = 0u; i < 4u; ++i) {
+      const auto lanes = LaneCrossingCalculator::Calculate(map, vehicle.contexts[i], next[i]);
+      invasion.crossed_lane_markings.insert(
+          invasion.crossed_lane_markings.end(), lanes.begin(), lanes.end());
+    }
+    vehicle.corners = next;
+    vehicle.frame = frame;
+
+    if (invasion.crossed_lane_markings.empty()) {
+      return false;
+    }
+    invasion.vehicle = vehicle.id;
+    invasion.transform = transform;
+    return true;
+  }
+
+  std::vector<LaneInvasionMonitor::Invasion> LaneInvasionMonitor::Tick(
+      const WorldSnapshot &snapshot) {
+    const size_t frame = snapshot.GetFrame();
+
+    // 先在当前线程中从快照里取出所有车辆的位置，不在快照中的车辆跳过。
+    std::vector<boost::optional<geom::Transform>> transforms(_vehicles.size());
+    for (auto i = 0u; i < _vehicles.size(); ++i) {
+      auto actor = snapshot.Find(_vehicles[i].id);
+      if (actor.has_value()) {
+        transforms[i] = actor->transform;
+      }
+    }
+
+    std::vector<Invasion> invasions(_vehicles.size());
+    std::vector<char> invaded(_vehicles.size(), 0);
+    ParallelForChunks(_vehicles.size(), [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i) {
+        if (transforms[i].has_value()) {
+          invaded[i] = TickVehicle(_vehicles[i], frame, *transforms[i], invasions[i]);
+        }
+      }
+    }, 16u);
+
+    std::vector<Invasion> result;
+    for (auto i = 0u; i < invasions.size(); ++i) {
+      if (invaded[i]) {
+        result.emplace_back(std::move(invasions[i]));
+      }
+    }
+    return result;
+  }
+
+} // namespace client
+} // namespace carla
@@ -0,0 +1,79 @@
+// Copyright (c) 2019 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/Memory.h"
+#include "carla/NonCopyable.h"
+#include "carla/geom/BoundingBox.h"
+#include "carla/geom/Transform.h"
+#include "carla/road/element/LaneCrossingCalculator.h"
+#include "carla/road/element/LaneMarking.h"
+#include "carla/rpc/ActorId.h"
+
+#include <array>
+#include <vector>
+
+namespace carla {
+namespace client {
+
+  class Map;
+  class WorldSnapshot;
+
+  /// 在客户端同时监测多辆车的压线。
+  ///
+  /// 每辆车的包围盒四个角各自缓存所在的车道，角仍在同一条车道内时不需要
+  /// 在地图中查找路点；车辆较多时在多个线程中分块计算。不是线程安全的，
+  /// 同一时间只能在一个线程中调用。
+  class LaneInvasionMonitor : private NonCopyable {
+  public:
+
+    struct Invasion {
+      ActorId vehicle;
+      geom::Transform transform;
+      std::vector<road::element::LaneMarking> crossed_lane_markings;
+    };
+
+    explicit LaneInvasionMonitor(SharedPtr<const Map> map);
+
+    /// 开始监测车辆 @a vehicle，@a bounding_box 是它的包围盒。
+    void AddVehicle(ActorId vehicle, const geom::BoundingBox &bounding_box);
+
+    void RemoveVehicle(ActorId vehicle);
+
+    size_t GetNumberOfVehicles() const {
+      return _vehicles.size();
+    }
+
+    /// 用 @a snapshot 中的车辆位置更新，返回在这一帧压线的车辆。
+    /// 不比上一次更新更新的帧会被忽略。
+    std::vector<Invasion> Tick(const WorldSnapshot &snapshot);
+
+  private:
+
+    struct VehicleState {
+      ActorId id;
+      geom::BoundingBox bounding_box;
+      size_t frame = 0u;
+      bool has_corners = false;
+      std::array<geom::Location, 4u> corners;
+      std::array<road::element::LaneCrossingContext, 4u> contexts;
+    };
+
+    /// 更新一辆车，有压线时返回 true 并填写 @a invasion。
+    bool TickVehicle(
+        VehicleState &vehicle,
+        size_t frame,
+        const geom::Transform &transform,
+        Invasion &invasion) const;
+
+    SharedPtr<const Map> _map;
+
+    std::vector<VehicleState> _vehicles;
+  };
+
+} // namespace client
+} // namespace carla
@@ -304,13 +304,15 @@ const LightState& LightManager::RetrieveLightState(LightId id) const {
 
 void LightManager::QueryLightsStateToServer() {
   std::lock_guard<std::mutex> lock(_mutex);
-  // 发送 blocking 查询到服务器以获取灯光状态
-  std::vector<rpc::LightState> lights_snapshot = _episode.Lock()->QueryLightsStateToServer();
+  // 发送 blocking 查询到服务器，只获取上次查询之后改变的灯光状态
+  rpc::LightStateChanges changes =
+      _episode.Lock()->QueryLightsStateChangesToServer(_lights_version);
+  _lights_version = changes.version;
 
   // 更新本地灯光状态
   SharedPtr<LightManager> lm = _episode.Lock()->GetLightManager();
 
-  for(const auto& it : lights_snapshot) {
+  for(const auto& it : changes.lights) {
     _lights_state[it._id] = LightState(
         it._intensity,
         Color(it._color.r, it._color.g, it._color.b),
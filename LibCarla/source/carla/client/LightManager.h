@@ -41,6 +41,7 @@ public:
     _on_tick_register_id = other._on_tick_register_id; // 拷贝tick注册ID
     _on_light_update_register_id = other._on_light_update_register_id; // 拷贝灯光更新注册ID
     _dirty = other._dirty; // 拷贝脏标志
+    _lights_version = other._lights_version; // 拷贝灯光状态版本
   }
 
   void SetEpisode(detail::WeakEpisodeProxy episode); // 设置当前Episode
@@ -107,6 +108,7 @@ private:
   size_t _on_tick_register_id = 0; // tick注册ID
   size_t _on_light_update_register_id = 0; // 灯光更新注册ID
   bool _dirty = false; // 脏标志
+  uint64_t _lights_version = 0u; // 已从服务器获取的灯光状态版本
 };
 
 } // namespace client
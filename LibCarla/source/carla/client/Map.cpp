@@ -11,9 +11,12 @@
 #include "carla/opendrive/OpenDriveParser.h"
 #include "carla/road/Map.h"
 #include "carla/road/RoadTypes.h"
+#include "carla/rpc/CachedContent.h"
 #include "carla/trafficmanager/InMemoryMap.h"
 
+#include <mutex>
 #include <sstream>
+#include <unordered_map>
 // 命名空间 carla
 namespace carla {
 // 命名空间 client
@@ -29,12 +32,51 @@ static auto MakeMap(const std::string &opendrive_contents) {
       throw_exception(std::runtime_error("failed to generate map"));
     }
 // 移动 map 的值
-    return std::move(*map);
+    return std::make_shared<const road::Map>(std::move(*map));
   }
- // Map 类的构造函数，接受 rpc::MapInfo 和 xodr 内容
+
+  // 按OpenDRIVE内容的哈希和长度共享已经解析的地图，所有使用者释放后地图随之销毁。
+  // 同一进程中多次获取同一张地图（例如多个 World::GetMap 调用）时不再重新解析XML。
+  static std::shared_ptr<const road::Map> GetOrMakeMap(const std::string &opendrive_contents) {
+    static std::mutex mutex;
+    static std::unordered_map<std::string, std::weak_ptr<const road::Map>> cache;
+    const auto key = rpc::CachedContent::ComputeHash(
+        reinterpret_cast<const uint8_t *>(opendrive_contents.data()),
+        opendrive_contents.size()) + ":" + std::to_string(opendrive_contents.size());
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      auto it = cache.find(key);
+      if (it != cache.end()) {
+        auto map = it->second.lock();
+        if (map != nullptr) {
+          return map;
+        }
+      }
+    }
+    // 在锁外解析，两个线程同时解析同一张地图时保留先完成的那一个
+    auto map = MakeMap(opendrive_contents);
+    std::lock_guard<std::mutex> lock(mutex);
+    auto &entry = cache[key];
+    auto existing = entry.lock();
+    if (existing != nullptr) {
+      return existing;
+    }
+    entry = map;
+    // 顺便清理已经销毁的地图
+    for (auto it = cache.begin(); it != cache.end();) {
+      if (it->second.expired()) {
+        it = cache.erase(it);
+      } else {
+        ++it;
+      }
+    }
+    return map;
+  }
+
+// Map 类的构造函数，接受 rpc::MapInfo 和 xodr 内容
   Map::Map(rpc::MapInfo description, std::string xodr_content)
     : _description(std::move(description)),
-      _map(MakeMap(xodr_content)){
+      _map(GetOrMakeMap(xodr_content)){
 // 存储 xodr 内容
     open_drive_file = xodr_content;
   }
@@ -56,15 +98,24 @@ static auto MakeMap(const std::string &opendrive_contents) {
     boost::optional<road::element::Waypoint> waypoint;
 // 根据是否投影到道路选择不同的获取方式
     if (project_to_road) {
-      waypoint = _map.GetClosestWaypointOnRoad(location, lane_type);
+      waypoint = _map->GetClosestWaypointOnRoad(location, lane_type);
     } else {
-      waypoint = _map.GetWaypoint(location, lane_type);
+      waypoint = _map->GetWaypoint(location, lane_type);
     }
  // 如果存在 waypoint，创建一个新的 Waypoint 并返回，否则返回 nullptr
     return waypoint.has_value() ?
     SharedPtr<Waypoint>(new Waypoint{shared_from_this(), *waypoint}) :
     nullptr;
   }
+// 批量获取 Waypoint 的函数，直接返回道路层的路点
+  std::vector<boost::optional<road::element::Waypoint>> Map::GetWaypoints(
+      const std::vector<geom::Location> &locations,
+      bool project_to_road,
+      int32_t lane_type) const {
+    return project_to_road ?
+        _map->GetClosestWaypointsOnRoad(locations, lane_type) :
+        _map->GetWaypoints(locations, lane_type);
+  }
 // 根据道路 ID、车道 ID 和 s 坐标获取 Waypoint 的函数
   SharedPtr<Waypoint> Map::GetWaypointXODR(
       carla::road::RoadId road_id,
@@ -73,12 +124,31 @@ static auto MakeMap(const std::string &opendrive_contents) {
  // 定义一个可选的 road::element::Waypoint 变量
     boost::optional<road::element::Waypoint> waypoint;
 // 调用 _map 的 GetWaypoint 函数获取 waypoint
-    waypoint = _map.GetWaypoint(road_id, lane_id, s);
+    waypoint = _map->GetWaypoint(road_id, lane_id, s);
  // 如果存在 waypoint，创建一个新的 Waypoint 并返回，否则返回 nullptr
     return waypoint.has_value() ?
         SharedPtr<Waypoint>(new Waypoint{shared_from_this(), *waypoint}) :
         nullptr;
   }
+// 批量计算路线的函数
+  std::vector<std::vector<SharedPtr<Waypoint>>> Map::ComputeRoutes(
+      const std::vector<std::pair<geom::Location, geom::Location>> &queries) const {
+    std::call_once(_route_planner_flag, [this]() {
+      _route_planner = std::make_unique<road::RoutePlanner>(*_map);
+    });
+    const auto routes = _route_planner->ComputeRoutes(queries);
+    std::vector<std::vector<SharedPtr<Waypoint>>> result;
+    result.reserve(routes.size());
+    for (const auto &route : routes) {
+      std::vector<SharedPtr<Waypoint>> waypoints;
+      waypoints.reserve(route.waypoints.size());
+      for (const auto &waypoint : route.waypoints) {
+        waypoints.emplace_back(new Waypoint{shared_from_this(), waypoint});
+      }
+      result.emplace_back(std::move(waypoints));
+    }
+    return result;
+  }
 // 获取地图拓扑结构的函数
   Map::TopologyList Map::GetTopology() const {
 // 为简洁使用 re 作为 carla::road::element 的别名
@@ -98,7 +168,7 @@ static auto MakeMap(const std::string &opendrive_contents) {
  // 存储拓扑结构的列表
     TopologyList result;
  // 生成拓扑结构
-    auto topology = _map.GenerateTopology();
+    auto topology = _map->GenerateTopology();
  // 为结果预留空间
     result.reserve(topology.size());
  // 遍历拓扑结构中的元素，创建 Waypoint 并添加到结果中
@@ -114,7 +184,7 @@ static auto MakeMap(const std::string &opendrive_contents) {
  // 存储结果的 Waypoint 向量
     std::vector<SharedPtr<Waypoint>> result;
 // 生成 Waypoint 列表
-    const auto waypoints = _map.GenerateWaypoints(distance);
+    const auto waypoints = _map->GenerateWaypoints(distance);
 // 为结果预留空间
     result.reserve(waypoints.size());
  // 遍历生成的 Waypoint，创建并添加到结果中
@@ -128,17 +198,17 @@ static auto MakeMap(const std::string &opendrive_contents) {
   const geom::Location &origin,
   const geom::Location &destination) const {
  // 调用 _map 的 CalculateCrossedLanes 函数
-    return _map.CalculateCrossedLanes(origin, destination);
+    return _map->CalculateCrossedLanes(origin, destination);
   }
  // 获取地理参考的函数
   const geom::GeoLocation &Map::GetGeoReference() const {
 // 调用 _map 的 GetGeoReference 函数
-    return _map.GetGeoReference();
+    return _map->GetGeoReference();
   }
  // 获取所有人行横道区域的函数
   std::vector<geom::Location> Map::GetAllCrosswalkZones() const {
 // 调用 _map 的 GetAllCrosswalkZones 函数
-    return _map.GetAllCrosswalkZones();
+    return _map->GetAllCrosswalkZones();
   }
 // 获取与给定 Waypoint 相关的 Junction 的函数
   SharedPtr<Junction> Map::GetJunction(const Waypoint &waypoint) const {
@@ -169,7 +239,7 @@ static auto MakeMap(const std::string &opendrive_contents) {
  // 存储结果的向量
     std::vector<SharedPtr<Landmark>> result;
  // 获取所有信号引用
-    auto signal_references = _map.GetAllSignalReferences();
+    auto signal_references = _map->GetAllSignalReferences();
 // 遍历信号引用，创建新的 Landmark 并添加到结果中
     for(auto* signal_reference : signal_references) {
       result.emplace_back(
@@ -182,7 +252,7 @@ static auto MakeMap(const std::string &opendrive_contents) {
 // 存储结果的向量
     std::vector<SharedPtr<Landmark>> result;
  // 获取所有信号引用
-    auto signal_references = _map.GetAllSignalReferences();
+    auto signal_references = _map->GetAllSignalReferences();
 // 遍历信号引用，找到符合 ID 的创建新的 Landmark 并添加到结果中
     for(auto* signal_reference : signal_references) {
       if(signal_reference->GetSignalId() == id) {
@@ -197,7 +267,7 @@ static auto MakeMap(const std::string &opendrive_contents) {
  // 存储结果的向量
     std::vector<SharedPtr<Landmark>> result;
  // 获取所有信号引用
-    auto signal_references = _map.GetAllSignalReferences();
+    auto signal_references = _map->GetAllSignalReferences();
  // 遍历信号引用，找到符合类型的创建新的 Landmark 并添加到结果中
     for(auto* signal_reference : signal_references) {
       if(signal_reference->GetSignal()->GetType() == type) {
@@ -216,9 +286,9 @@ static auto MakeMap(const std::string &opendrive_contents) {
     auto &controllers = landmark._signal->GetSignal()->GetControllers();
 // 遍历控制器和控制器中的信号，添加新的 Landmark 到结果中
     for (auto& controller_id : controllers) {
-      const auto &controller = _map.GetControllers().at(controller_id);
+      const auto &controller = _map->GetControllers().at(controller_id);
       for(auto& signal_id : controller->GetSignals()) {
-        auto& signal = _map.GetSignals().at(signal_id);
+        auto& signal = _map->GetSignals().at(signal_id);
         auto new_landmarks = GetLandmarksFromId(signal->GetSignalId());
         result.insert(result.end(), new_landmarks.begin(), new_landmarks.end());
       }
@@ -19,11 +19,14 @@
 #include "carla/road/Map.h"
 // 包含CARLA道路类型（RoadTypes）的头文件
 #include "carla/road/RoadTypes.h"
+#include "carla/road/RoutePlanner.h"
 // 包含CARLA RPC地图信息（MapInfo）的头文件
 #include "carla/rpc/MapInfo.h"
 // 包含地标（Landmark）的头文件
 #include "Landmark.h"
 
+#include <memory>
+#include <mutex>
 #include <string>
 /**
  * @namespace carla::client
@@ -89,7 +92,7 @@ namespace client {
          * @return 返回道路地图的常量引用。
          */
     const road::Map &GetMap() const {  
-      return _map;
+      return *_map;
     }
     /**
          * @brief 获取OpenDRIVE文件内容。
@@ -119,6 +122,17 @@ namespace client {
         const geom::Location &location,
         bool project_to_road = true,
         int32_t lane_type = static_cast<uint32_t>(road::Lane::LaneType::Driving)) const;
+    /**
+         * @brief 批量获取路点，参数与 GetWaypoint 相同。
+         *
+         * 不为每个结果创建 Waypoint 对象，位置较多时在多个线程中并行查询。
+         *
+         * @return 与 @a locations 一一对应的路点，找不到时为空。
+         */
+    std::vector<boost::optional<road::element::Waypoint>> GetWaypoints(
+        const std::vector<geom::Location> &locations,
+        bool project_to_road = true,
+        int32_t lane_type = static_cast<uint32_t>(road::Lane::LaneType::Driving)) const;
     /**
          * @brief 根据OpenDRIVE ID获取路点。
          *
@@ -131,6 +145,16 @@ namespace client {
       carla::road::RoadId road_id,
       carla::road::LaneId lane_id,
       float s) const;
+    /**
+         * @brief 批量计算路线。
+         *
+         * 第一次调用时为地图构建一次车道图，之后的查询使用A*并在多个线程中并行执行。
+         *
+         * @param queries 起点和终点位置对，位置会先投影到最近的行驶车道上。
+         * @return 与 @a queries 一一对应的路线，依次为起点、途经各车道的入口以及终点，无法到达时为空。
+         */
+    std::vector<std::vector<SharedPtr<Waypoint>>> ComputeRoutes(
+        const std::vector<std::pair<geom::Location, geom::Location>> &queries) const;
     /**
          * @brief 拓扑结构列表的类型定义。
          */
@@ -232,7 +256,13 @@ namespace client {
 
     const rpc::MapInfo _description; // 描述地图信息的RPC对象
 
-    const road::Map _map; // 道路地图的内部表示
+    /// 道路地图的内部表示。内容相同的OpenDRIVE在进程内只解析一次，
+    /// 由所有仍然存在的 Map 实例共享。
+    const std::shared_ptr<const road::Map> _map;
+
+    mutable std::once_flag _route_planner_flag; // 保证路径规划器只构建一次
+
+    mutable std::unique_ptr<road::RoutePlanner> _route_planner; // 第一次计算路线时构建
   };
 
 } // namespace client
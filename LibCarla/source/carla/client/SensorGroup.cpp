@@ -0,0 +1,179 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/client/SensorGroup.h"
+
+#include "carla/Exception.h"
+#include "carla/Logging.h"
+#include "carla/sensor/SensorData.h"
+
+#include <chrono>
+#include <deque>
+#include <exception>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+
+namespace carla {
+namespace client {
+
+  // ===========================================================================
+  // -- SensorGroup::Assembler -------------------------------------------------
+  // ===========================================================================
+
+  /// 各传感器的回调可能在不同的线程上同时执行，所有状态都由互斥锁保护。
+  class SensorGroup::Assembler {
+  public:
+
+    using clock = std::chrono::steady_clock;
+
+    Assembler(size_t number_of_sensors, time_duration timeout, CallbackFunctionType callback)
+      : _number_of_sensors(number_of_sensors),
+        _timeout(timeout.to_chrono()),
+        _callback(std::move(callback)) {}
+
+    void Push(size_t index, SharedPtr<sensor::SensorData> data) {
+      const auto now = clock::now();
+      const size_t frame = data->GetFrame();
+      std::unique_lock<std::mutex> lock(_mutex);
+      if (_has_delivered && (frame <= _last_delivered_frame)) {
+        // 所属的帧已经交付
+        log_debug("sensor group: discarding late data of frame", frame);
+        return;
+      }
+      auto &bundle = _pending[frame];
+      if (bundle.data.empty()) {
+        bundle.data.resize(_number_of_sensors);
+        bundle.first_arrival = now;
+      }
+      if (bundle.data[index] == nullptr) {
+        ++bundle.received;
+      }
+      bundle.data[index] = std::move(data);
+
+      // 每个传感器的数据按帧号顺序到达，某一帧收齐后更早的帧不会再收齐
+      if (bundle.received == _number_of_sensors) {
+        auto end = _pending.upper_bound(frame);
+        for (auto it = _pending.begin(); it != end; ++it) {
+          _ready.emplace_back(std::move(it->second.data));
+        }
+        _pending.erase(_pending.begin(), end);
+        _last_delivered_frame = frame;
+        _has_delivered = true;
+      }
+      // 超时的帧不完整地交付
+      while (!_pending.empty() && (now - _pending.begin()->second.first_arrival >= _timeout)) {
+        log_debug("sensor group: frame", _pending.begin()->first, "timed out");
+        _last_delivered_frame = _pending.begin()->first;
+        _has_delivered = true;
+        _ready.emplace_back(std::move(_pending.begin()->second.data));
+        _pending.erase(_pending.begin());
+      }
+      Deliver(lock);
+    }
+
+  private:
+
+    struct Bundle {
+      DataList data;
+      size_t received = 0u;
+      clock::time_point first_arrival;
+    };
+
+    /// 依次执行已组装好的帧的回调。已有线程在执行回调时由该线程继续执行，保证顺序。
+    void Deliver(std::unique_lock<std::mutex> &lock) {
+      if (_is_delivering) {
+        return;
+      }
+      _is_delivering = true;
+      while (!_ready.empty()) {
+        DataList data = std::move(_ready.front());
+        _ready.pop_front();
+        lock.unlock();
+        try {
+          _callback(std::move(data));
+        } catch (const std::exception &e) {
+          log_error("sensor group: exception in callback:", e.what());
+        }
+        lock.lock();
+      }
+      _is_delivering = false;
+    }
+
+    const size_t _number_of_sensors;
+
+    const clock::duration _timeout;
+
+    const CallbackFunctionType _callback;
+
+    std::mutex _mutex;
+
+    /// 按帧号排序的尚未收齐的帧。
+    std::map<size_t, Bundle> _pending;
+
+    /// 等待交付的帧。
+    std::deque<DataList> _ready;
+
+    bool _is_delivering = false;
+
+    bool _has_delivered = false;
+
+    size_t _last_delivered_frame = 0u;
+  };
+
+  // ===========================================================================
+  // -- SensorGroup ------------------------------------------------------------
+  // ===========================================================================
+
+  SensorGroup::SensorGroup(std::vector<SharedPtr<Sensor>> sensors, time_duration timeout)
+    : _sensors(std::move(sensors)),
+      _timeout(timeout) {
+    if (_sensors.empty()) {
+      throw_exception(std::invalid_argument("sensor group must contain at least one sensor"));
+    }
+    for (const auto &sensor : _sensors) {
+      if (sensor == nullptr) {
+        throw_exception(std::invalid_argument("sensor group cannot contain null sensors"));
+      }
+    }
+  }
+
+  SensorGroup::~SensorGroup() {
+    if (IsListening()) {
+      try {
+        Stop();
+      } catch (const std::exception &e) {
+        log_error("exception trying to stop sensor group:", e.what());
+      }
+    }
+  }
+
+  void SensorGroup::Listen(CallbackFunctionType callback) {
+    if (IsListening()) {
+      Stop();
+    }
+    auto assembler = std::make_shared<Assembler>(_sensors.size(), _timeout, std::move(callback));
+    for (size_t index = 0u; index < _sensors.size(); ++index) {
+      _sensors[index]->Listen([assembler, index](SharedPtr<sensor::SensorData> data) {
+        if (data != nullptr) {
+          assembler->Push(index, std::move(data));
+        }
+      });
+    }
+    _assembler = std::move(assembler);
+  }
+
+  void SensorGroup::Stop() {
+    for (const auto &sensor : _sensors) {
+      if (sensor->IsListening()) {
+        sensor->Stop();
+      }
+    }
+    _assembler = nullptr;
+  }
+
+} // namespace client
+} // namespace carla
@@ -0,0 +1,73 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/Memory.h"
+#include "carla/NonCopyable.h"
+#include "carla/Time.h"
+#include "carla/client/Sensor.h"
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace carla {
+namespace client {
+
+  /**
+   * @class SensorGroup
+   * @brief 按帧号把一组传感器的数据组装在一起，每帧只调用一次回调。
+   *
+   * 同步模式下各传感器的数据分别到达，SensorGroup按传感器数据头中的帧号收集，
+   * 一帧的数据全部到达后按传感器的顺序交给回调。某一帧超过 @a timeout 仍未收齐，
+   * 或者之后的帧已经收齐时，该帧以不完整的形式交付，缺失的数据为空指针。
+   * 回调按帧号递增的顺序依次执行，不会并发执行。
+   *
+   * @note 组中的传感器应在每一帧都产生数据，例如不设置不同的 sensor_tick。
+   */
+  class SensorGroup : private NonCopyable {
+  public:
+
+    using DataList = std::vector<SharedPtr<sensor::SensorData>>;
+
+    using CallbackFunctionType = std::function<void(DataList)>;
+
+    SensorGroup(std::vector<SharedPtr<Sensor>> sensors, time_duration timeout);
+
+    ~SensorGroup();
+
+    const std::vector<SharedPtr<Sensor>> &GetSensors() const {
+      return _sensors;
+    }
+
+    time_duration GetTimeout() const {
+      return _timeout;
+    }
+
+    /// 开始监听组中所有的传感器，替换各传感器原有的回调。
+    void Listen(CallbackFunctionType callback);
+
+    /// 停止监听组中所有的传感器，丢弃尚未收齐的帧。
+    void Stop();
+
+    bool IsListening() const {
+      return _assembler != nullptr;
+    }
+
+  private:
+
+    class Assembler;
+
+    const std::vector<SharedPtr<Sensor>> _sensors;
+
+    const time_duration _timeout;
+
+    std::shared_ptr<Assembler> _assembler;
+  };
+
+} // namespace client
+} // namespace carla
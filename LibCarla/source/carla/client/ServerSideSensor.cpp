@@ -35,6 +35,8 @@ namespace client {
           if (listening_mask.test(i)) // 检查是否正在监听
             StopGBuffer(i - 1); // 停止该纹理的监听
         }
+        if (IsListeningGBuffers())
+          StopGBuffers();
         Stop(); // 停止传感器监听
       } catch (const std::exception &e) {
         // 如果发生异常，记录错误信息
@@ -51,6 +53,12 @@ namespace client {
     listening_mask.set(0); // 将监听标志的第0位置为true，表示传感器开始监听
   }
 
+  void ServerSideSensor::ListenLazy(LazyCallbackFunctionType callback) {
+    log_debug(GetDisplayId(), ": subscribing to stream (lazy)");
+    GetEpisode().Lock()->SubscribeToSensorLazy(*this, std::move(callback));
+    listening_mask.set(0);
+  }
+
   // stop函数：停止监听传感器数据流
   void ServerSideSensor::Stop() {
     log_debug("calling sensor Stop() ", GetDisplayId()); // 打印调试信息，表示调用了Stop方法
@@ -117,6 +125,32 @@ namespace client {
     listening_mask.reset(GBufferId + 1); 
   }
 
+  // ListenToGBuffers函数：开始监听打包的GBuffer纹理流
+  void ServerSideSensor::ListenToGBuffers(uint64_t TextureMask, CallbackFunctionType callback) {
+    log_debug(GetDisplayId(), ": subscribing to multipart gbuffer stream");
+    RELEASE_ASSERT(TextureMask != 0u && (TextureMask >> GBufferTextureCount) == 0u);
+    if (GetActorDescription().description.id != "sensor.camera.rgb")
+    {
+      log_warning("GBuffer methods are not supported on non-RGB sensors (sensor.camera.rgb).");
+      return;
+    }
+    GetEpisode().Lock()->SubscribeToGBuffers(*this, TextureMask, std::move(callback));
+    listening_mask.set(0);
+    listening_mask.set(MultipartGBufferBit);
+  }
+
+  // StopGBuffers函数：停止监听打包的GBuffer纹理流
+  void ServerSideSensor::StopGBuffers() {
+    log_debug(GetDisplayId(), ": unsubscribing from multipart gbuffer stream");
+    if (GetActorDescription().description.id != "sensor.camera.rgb")
+    {
+      log_warning("GBuffer methods are not supported on non-RGB sensors (sensor.camera.rgb).");
+      return;
+    }
+    GetEpisode().Lock()->UnSubscribeFromGBuffers(*this);
+    listening_mask.reset(MultipartGBufferBit);
+  }
+
   // EnableForROS函数：使传感器支持ROS通信
   void ServerSideSensor::EnableForROS() {
     // 通过Episode对象启用传感器的ROS支持
@@ -7,6 +7,7 @@
 #pragma once
 
 #include "carla/client/Sensor.h"
+#include "carla/sensor/LazySensorData.h"
 #include <bitset>
 
 namespace carla {
@@ -17,6 +18,8 @@ namespace client {
 
     using Sensor::Sensor;
 
+    using LazyCallbackFunctionType = std::function<void(SharedPtr<sensor::LazySensorData>)>;
+
     ~ServerSideSensor();
 
     /// 注册一个 @a 回调，每次收到新的测量值时执行。
@@ -25,6 +28,10 @@ namespace client {
     /// 请注意，多个传感器实例（即使在不同的进程中）可能指向模拟器中的同一传感器。
     void Listen(CallbackFunctionType callback) override;
 
+    /// 与 Listen 相同，但回调收到的是尚未反序列化的消息，只在需要时调用
+    /// LazySensorData::Get 创建 SensorData。适合只处理部分数据的回调。
+    void ListenLazy(LazyCallbackFunctionType callback);
+
     /// 停止监听新的测量结果。
     void Stop() override;
 
@@ -43,6 +50,17 @@ namespace client {
       return listening_mask.test(id + 1);
     }
 
+    /// 监听打包在一条消息中的多个 gbuffer 纹理，@a TextureMask 的第 i 位
+    /// 对应ID为 i 的纹理。与逐个监听相比，每帧只发送一条消息。
+    void ListenToGBuffers(uint64_t TextureMask, CallbackFunctionType callback);
+
+    /// 停止监听打包的 gbuffer 纹理。
+    void StopGBuffers();
+
+    inline bool IsListeningGBuffers() const {
+      return listening_mask.test(MultipartGBufferBit);
+    }
+
     /// 启用此传感器以进行 ROS2 发布
     void EnableForROS();
 
@@ -62,6 +80,9 @@ namespace client {
 
   private:
 
+    /// 第0位是传感器本身，之后每个 gbuffer 纹理一位，最后是打包的 gbuffer。
+    static constexpr size_t MultipartGBufferBit = 14u;
+
     std::bitset<16> listening_mask;
   };
 
@@ -21,7 +21,26 @@ namespace client {
 
   // 方法 Start: 启动控制器时调用，注册该 AI 控制器到模拟环境，并将行人添加到导航系统中。
   // 在 Recast & Detour 导航系统中为行人创建路径，并禁用物理与碰撞计算。
+  // 控制器的 simulate_on_server 属性为 true 时，行人由服务器上的人群模拟，
+  // 客户端只发送开始、停止和目标等请求
+  bool WalkerAIController::IsSimulatedOnServer() const {
+    for (auto &&attribute : GetAttributes()) {
+      if (attribute.GetId() == "simulate_on_server") {
+        return attribute.As<bool>();
+      }
+    }
+    return false;
+  }
+
   void WalkerAIController::Start() {
+    if (IsSimulatedOnServer()) {
+      auto walker = GetParent();
+      if (walker != nullptr) {
+        GetEpisode().Lock()->StartServerWalker(walker->GetId());
+      }
+      return;
+    }
+
     // 注册 AI 控制器以启用模拟中的控制功能
     GetEpisode().Lock()->RegisterAIController(*this);
 
@@ -45,6 +64,14 @@ namespace client {
   // 方法 Stop: 停止控制器的工作，取消注册并从导航系统中移除行人。
   // 此方法用于关闭控制器，解除对行人对象的管理。
   void WalkerAIController::Stop() {
+    if (IsSimulatedOnServer()) {
+      auto walker = GetParent();
+      if (walker != nullptr) {
+        GetEpisode().Lock()->StopServerWalker(walker->GetId());
+      }
+      return;
+    }
+
     // 取消注册该 AI 控制器
     GetEpisode().Lock()->UnregisterAIController(*this);
 
@@ -64,6 +91,9 @@ namespace client {
   // 返回值是一个可选的地点（如果导航系统可用），通常用于设置行人的随机目标位置。
   boost::optional<geom::Location> WalkerAIController::GetRandomLocation() {
       //GetRandomLocation()方法返回一个随机的位置，通常用于让AI行人随机选择一个目标位置。
+    if (IsSimulatedOnServer()) {
+      return GetEpisode().Lock()->GetServerWalkerRandomLocation();
+    }
     auto nav = GetEpisode().Lock()->GetNavigation(); // 获取当前模拟环境的导航系统
     if (nav != nullptr) {
       // 从导航系统中获取一个随机的可行走位置
@@ -75,6 +105,15 @@ namespace client {
   // 方法 GoToLocation: 使 AI 行人朝着指定的目标位置前进。
   // 行人将根据导航系统规划的路径向目标位置移动。
   void WalkerAIController::GoToLocation(const carla::geom::Location &destination) {
+    if (IsSimulatedOnServer()) {
+      auto walker = GetParent();
+      if (walker == nullptr) {
+        log_warning("NAV: Failed to set request to go to ", destination.x, destination.y, destination.z, "(parent does not exist)");
+      } else if (!GetEpisode().Lock()->SetServerWalkerTarget(walker->GetId(), destination)) {
+        log_warning("NAV: Failed to set request to go to ", destination.x, destination.y, destination.z);
+      }
+      return;
+    }
     // 获取当前模拟环境的导航系统
     auto nav = GetEpisode().Lock()->GetNavigation();
     if (nav != nullptr) {
@@ -95,6 +134,15 @@ namespace client {
   // 方法 SetMaxSpeed: 设置行人的最大速度，控制行人移动的速度限制。
   // 行人速度的最大值将影响其在导航中的运动表现。
   void WalkerAIController::SetMaxSpeed(const float max_speed) {
+    if (IsSimulatedOnServer()) {
+      auto walker = GetParent();
+      if (walker == nullptr) {
+        log_warning("NAV: failed to set max speed (parent does not exist)");
+      } else if (!GetEpisode().Lock()->SetServerWalkerMaxSpeed(walker->GetId(), max_speed)) {
+        log_warning("NAV: failed to set max speed");
+      }
+      return;
+    }
     // 获取当前模拟环境的导航系统
     auto nav = GetEpisode().Lock()->GetNavigation();
     if (nav != nullptr) {
@@ -30,6 +30,11 @@ namespace client {    // 开始 client 命名空间
 
 
     void SetMaxSpeed(const float max_speed);     // 设置最大速度的成员函数
+
+  private:
+
+    /// 行人是否由服务器上的人群模拟（蓝图属性 simulate_on_server）。
+    bool IsSimulatedOnServer() const;
   };
 
 } // namespace client
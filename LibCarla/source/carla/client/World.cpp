@@ -53,6 +53,14 @@ namespace client {
     return _episode.Lock()->GetEpisodeSettings();  // 返回当前剧集设置
   }
 
+  void World::SetEpisodeInterest(const rpc::EpisodeInterest &interest) {
+    _episode.Lock()->SetEpisodeInterest(interest);
+  }
+
+  void World::ClearEpisodeInterest() {
+    _episode.Lock()->ClearEpisodeInterest();
+  }
+
   uint64_t World::ApplySettings(const rpc::EpisodeSettings &settings, time_duration timeout) {  // 应用设置的方法
     rpc::EpisodeSettings new_settings = settings;  // 复制新的设置
     uint64_t id = _episode.Lock()->SetEpisodeSettings(settings);  // 设置新的剧集设置并返回ID
@@ -123,6 +131,21 @@ namespace client {
                                   _episode.Lock()->GetActorsById(actor_ids)}};  // 根据ID获取参与者列表
   }
 
+  std::shared_future<SharedPtr<ActorList>> World::GetActorsAsync(const std::vector<ActorId> &actor_ids) const {
+    auto pending = _episode.Lock()->GetActorsByIdAsync(actor_ids);
+    return std::async(
+        std::launch::deferred,
+        [episode=_episode, pending=std::move(pending)]() mutable {
+      return SharedPtr<ActorList>{new ActorList{episode, pending.get()}};
+    }).share();
+  }
+
+  rpc::ActorQueryResult World::QueryActors(
+      const std::vector<ActorId> &actor_ids,
+      const std::vector<std::string> &fields) const {
+    return _episode.Lock()->QueryActors(actor_ids, fields);
+  }
+
  SharedPtr<Actor> World::SpawnActor(
       const ActorBlueprint &blueprint, // 参与者蓝图
       const geom::Transform &transform, // 变换信息
@@ -168,6 +191,11 @@ namespace client {
     return _episode.Lock()->Tick(local_timeout); // 执行tick并返回结果
   }
 
+  std::shared_future<uint64_t> World::TickAsync(
+      std::function<void(const std::shared_future<uint64_t> &)> callback) {
+    return _episode.Lock()->TickAsync(std::move(callback));
+  }
+
   void World::SetPedestriansCrossFactor(float percentage) { // 设置行人过街因子
     _episode.Lock()->SetPedestriansCrossFactor(percentage); // 更新因子
   }
@@ -235,6 +263,46 @@ namespace client {
     _episode.Lock()->FreezeAllTrafficLights(frozen); // 调用冻结方法
   }
 
+  void World::ApplyTrafficLightPlans(
+      const std::vector<rpc::TrafficLightGroupPlan> &plans) { // 批量应用交通灯组的配时方案
+    _episode.Lock()->ApplyTrafficLightPlans(plans);
+  }
+
+  std::vector<rpc::SignTriggerEvent> World::GetSignTriggerEvents() const { // 上一帧的交通标志触发框事件
+    return _episode.Lock()->GetSignTriggerEvents();
+  }
+
+  std::vector<rpc::ActorId> World::SetWalkersBonesTransform(
+      const rpc::WalkerBonePoses &poses) { // 批量设置行人的骨骼姿态
+    return _episode.Lock()->SetWalkersBonesTransform(poses);
+  }
+
+  rpc::WalkerBonePoses World::GetWalkersBonesTransform(
+      const std::vector<rpc::ActorId> &walkers,
+      const std::vector<std::string> &bone_names) const { // 批量获取行人的骨骼姿态
+    return _episode.Lock()->GetWalkersBonesTransform(walkers, bone_names);
+  }
+
+  void World::SetActorPoolSize(uint32_t size) { // 设置参与者池的大小
+    _episode.Lock()->SetActorPoolSize(size);
+  }
+
+  uint64_t World::SaveSnapshot() { // 保存快照
+    return _episode.Lock()->SaveSnapshot();
+  }
+
+  void World::RestoreSnapshot(uint64_t snapshot_id) { // 恢复快照
+    _episode.Lock()->RestoreSnapshot(snapshot_id);
+  }
+
+  bool World::RemoveSnapshot(uint64_t snapshot_id) { // 释放快照
+    return _episode.Lock()->RemoveSnapshot(snapshot_id);
+  }
+
+  rpc::ServerProfile World::GetServerProfile(bool reset) const { // 服务器每帧的耗时统计
+    return _episode.Lock()->GetServerProfile(reset);
+  }
+
   std::vector<geom::BoundingBox> World::GetLevelBBs(uint8_t queried_tag) const { // 获取级别边界框
     return _episode.Lock()->GetLevelBBs(queried_tag); // 返回边界框列表
   }
@@ -20,17 +20,24 @@
 #include "carla/client/detail/EpisodeProxy.h"  // 包含EpisodeProxy相关的头文件
 #include "carla/geom/Transform.h"  // 包含变换矩阵相关的头文件
 #include "carla/rpc/Actor.h"  // 包含演员（对象）相关的头文件
+#include "carla/rpc/ActorQuery.h"  // 包含按列查询参与者属性相关的头文件
 #include "carla/rpc/AttachmentType.h"  // 包含附加物类型相关的头文件
 #include "carla/rpc/EpisodeSettings.h"  // 包含剧集设置相关的头文件
+#include "carla/rpc/EpisodeInterest.h"  // 包含剧集兴趣集合相关的头文件
 #include "carla/rpc/EnvironmentObject.h"  // 包含环境对象相关的头文件
 #include "carla/rpc/LabelledPoint.h"  // 包含带标签点的头文件
 #include "carla/rpc/MapLayer.h"  // 包含地图图层相关的头文件
+#include "carla/rpc/ServerProfile.h"  // 包含服务器性能统计相关的头文件
+#include "carla/rpc/SignTriggerEvent.h"  // 包含交通标志触发框事件的头文件
+#include "carla/rpc/TrafficLightPlan.h"  // 包含交通灯组配时方案相关的头文件
 #include "carla/rpc/VehiclePhysicsControl.h"  // 包含车辆物理控制相关的头文件
+#include "carla/rpc/WalkerBonePoses.h"  // 包含批量行人骨骼姿态相关的头文件
 #include "carla/rpc/WeatherParameters.h"  // 包含天气参数相关的头文件
 #include "carla/rpc/VehicleLightStateList.h"  // 包含车辆灯光状态列表相关的头文件
 #include "carla/rpc/Texture.h"  // 包含纹理相关的头文件
 #include "carla/rpc/MaterialParameter.h"  // 包含材质参数相关的头文件
 
+#include <future>  // 包含future相关的头文件
 #include <string>  // 包含字符串处理相关的头文件
 #include <boost/optional.hpp>
   //引入了一些必要的头文件，包括内存管理、时间控制、调试工具、地图层信息、车辆和环境对象的RPC接口等。这些模块共同支持CARLA模拟环境的创建和控制。
@@ -92,6 +99,12 @@ namespace client {
     /// @return 应用设置时的帧id.
     uint64_t ApplySettings(const rpc::EpisodeSettings &settings, time_duration timeout);
 
+    /// 之后的世界快照只包含 @a interest 中的参与者，服务器只为本客户端发送这些参与者的状态.
+    void SetEpisodeInterest(const rpc::EpisodeInterest &interest);
+
+    /// 恢复接收所有参与者的状态.
+    void ClearEpisodeInterest();
+
     /// 检索当前世界上活动的天气参数.
     rpc::WeatherParameters GetWeather() const;
 
@@ -116,6 +129,16 @@ namespace client {
     /// 返回一个包含ActorId请求的参与者(actor)的列表.
     SharedPtr<ActorList> GetActors(const std::vector<ActorId> &actor_ids) const;
 
+    /// 与GetActors相同但不等待服务器的响应，可以先发出多个请求再依次取回结果，
+    /// 每个请求不再各自等待一次往返.
+    std::shared_future<SharedPtr<ActorList>> GetActorsAsync(const std::vector<ActorId> &actor_ids) const;
+
+    /// 用一次调用获取 @a actor_ids 中各参与者的 @a fields 属性，
+    /// 结果按列紧密排列，支持的字段见 rpc::ActorQueryResult.
+    rpc::ActorQueryResult QueryActors(
+        const std::vector<ActorId> &actor_ids,
+        const std::vector<std::string> &fields) const;
+
     /// 根据 @a 转换中提供的 @a 蓝图，在世界中生成一个参与者(actor).
     /// 如果提供了 @a 父类，则参与者(actor)被附加到 @a 父类.
     SharedPtr<Actor> SpawnActor(
@@ -149,6 +172,12 @@ namespace client {
     /// @return 这个调用开始的帧的id.
     uint64_t Tick(time_duration timeout);
 
+    /// 与Tick相同但不阻塞调用线程，可以在服务器计算该帧的同时进行其他计算.
+    ///
+    /// 返回的future在收到该帧时兑现为帧号，之后在流的回调线程中以它调用 @a callback.
+    std::shared_future<uint64_t> TickAsync(
+        std::function<void(const std::shared_future<uint64_t> &)> callback = {});
+
     /// 设置一个代理表示在它的路径中穿过道路的概率.
     /// 0.0f表示行人不得过马路
     /// 0.5f表示50%的行人可以过马路
@@ -180,6 +209,44 @@ namespace client {
 
     void FreezeAllTrafficLights(bool frozen);
 
+    /// 一次调用设置多个交通灯组的配时、相位偏移和冻结状态。所有方案在同一帧
+    /// 开始前一起应用，任一方案引用的参与者无效时抛出异常且不应用任何方案。
+    void ApplyTrafficLightPlans(const std::vector<rpc::TrafficLightGroupPlan> &plans);
+
+    /// 一次调用设置多个行人的骨骼在父骨骼空间中的姿态，在服务器的同一次遍历中应用。
+    /// 返回没有应用姿态的参与者（不存在或不是行人）。
+    std::vector<rpc::ActorId> SetWalkersBonesTransform(const rpc::WalkerBonePoses &poses);
+
+    /// 一次调用获取多个行人的骨骼在父骨骼空间中的姿态。@a bone_names 为空时返回
+    /// 第一个行人的所有骨骼；不存在或不是行人的参与者的姿态为空。
+    rpc::WalkerBonePoses GetWalkersBonesTransform(
+        const std::vector<rpc::ActorId> &walkers,
+        const std::vector<std::string> &bone_names = {}) const;
+
+    /// 上一帧车辆进入和离开交通标志（包括交通灯）触发框的事件。服务器每帧
+    /// 只保留一帧的事件，异步模式下两次调用之间的事件可能丢失。
+    std::vector<rpc::SignTriggerEvent> GetSignTriggerEvents() const;
+
+    /// 设置参与者池的大小。销毁的车辆和行人在池中休眠，之后生成相同蓝图和
+    /// 属性的参与者时直接重用；为0时不使用参与者池。加载地图后恢复为服务器
+    /// 启动时的设置。
+    void SetActorPoolSize(uint32_t size);
+
+    /// 在服务器上保存当前的动态状态：所有参与者及其位置和速度，交通灯和车灯的
+    /// 状态。返回用于 RestoreSnapshot 的编号，快照在加载地图后失效。
+    uint64_t SaveSnapshot();
+
+    /// 不重新加载地图，在一帧内恢复快照：销毁之后生成的参与者，以原来的 id
+    /// 重新生成被销毁的参与者（传感器除外），恢复位置、速度和状态。
+    void RestoreSnapshot(uint64_t snapshot_id);
+
+    /// 释放快照，快照不存在时返回 false。
+    bool RemoveSnapshot(uint64_t snapshot_id);
+
+    /// 服务器游戏线程每帧各阶段的耗时统计，一直在统计，开销很小。@a reset
+    /// 为真时返回后重新开始统计。
+    rpc::ServerProfile GetServerProfile(bool reset = false) const;
+
     /// 返回该等级中所有元素的BBs.
     std::vector<geom::BoundingBox> GetLevelBBs(uint8_t queried_tag) const;
 
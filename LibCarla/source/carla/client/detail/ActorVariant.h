@@ -32,13 +32,19 @@ namespace detail {
   public:
 
     ActorVariant(rpc::Actor actor)
-      : _value(actor) {}
+      : _value(SharedPtr<const rpc::Actor>(MakeShared<rpc::Actor>(std::move(actor)))) {}
+
+    /// 共享缓存中的描述，直到需要创建client::Actor时才复制。
+    ActorVariant(SharedPtr<const rpc::Actor> actor)
+      : _value(std::move(actor)) {
+      DEBUG_ASSERT(boost::variant2::get<0>(_value) != nullptr);
+    }
 
     ActorVariant(SharedPtr<client::Actor> actor)
       : _value(actor) {}
 
     ActorVariant &operator=(rpc::Actor actor) {
-      _value = actor;
+      _value = SharedPtr<const rpc::Actor>(MakeShared<rpc::Actor>(std::move(actor)));
       return *this;
     }
 // 重载赋值运算符，接受指向client::Actor的智能指针（SharedPtr），将传入的智能指针赋值给内部的_value变量，
@@ -85,8 +91,8 @@ namespace detail {
   private:// 定义一个访问者结构体（Visitor），用于在访问variant类型的_value时，根据其实际存储的类型进行相应的操作
 
     struct Visitor {// 如果_value中存储的是rpc::Actor类型，直接返回该rpc::Actor对象
-      const rpc::Actor &operator()(const rpc::Actor &actor) const {
-        return actor;
+      const rpc::Actor &operator()(const SharedPtr<const rpc::Actor> &actor) const {
+        return *actor;
       }// 如果_value中存储的是指向client::Actor的智能指针类型，
         // 则调用该智能指针所指向的client::Actor对象的Serialize函数来返回对应的rpc::Actor对象
       const rpc::Actor &operator()(const SharedPtr<const client::Actor> &actor) const {
@@ -98,7 +104,7 @@ namespace detail {
     void MakeActor(EpisodeProxy episode) const;
 // 使用Boost的variant2::variant类型来存储不同形式的Actor，可以是rpc::Actor类型或者是指向client::Actor的智能指针类型，
     // 并且使用mutable关键字修饰，意味着即使在const成员函数中也可以修改它的值（例如在Get函数中可能会根据情况修改它）
-    mutable boost::variant2::variant<rpc::Actor, SharedPtr<client::Actor>> _value;
+    mutable boost::variant2::variant<SharedPtr<const rpc::Actor>, SharedPtr<client::Actor>> _value;
   };
 
 } // namespace detail
@@ -6,14 +6,16 @@
 
 #pragma once
 
+#include "carla/Memory.h"
 #include "carla/NonCopyable.h"
 #include "carla/rpc/Actor.h"
 
-#include <boost/iterator/transform_iterator.hpp>
-
-#include <algorithm>
+#include <array>
 #include <iterator>
 #include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+#include <vector>
 
 namespace carla {
 namespace client {
@@ -25,10 +27,15 @@ namespace detail {
 
   /// 保留参与者描述列表，以避免每次都向服务器请求描述。
   ///
+  /// 描述插入后不再修改，以共享指针返回，查询时不复制描述中的字符串。
+  /// 按参与者ID分片，每个分片有自己的读写锁，多个线程同时查询时互不阻塞。
+  ///
   /// @todo Dead actors are never removed from the list.
   class CachedActorList : private MovableNonCopyable {
   public:
 
+    using ActorRecord = SharedPtr<const rpc::Actor>;
+
     /// 将参与者插入到列表中。
     void Insert(rpc::Actor actor);
 
@@ -40,73 +47,93 @@ namespace detail {
     template <typename RangeT>
     std::vector<ActorId> GetMissingIds(const RangeT &range) const;
 
-    /// 检索与 @a id 匹配的参与者，如果参与者未被缓存，则为空（可选）。
-    boost::optional<rpc::Actor> GetActorById(ActorId id) const;
+    /// 检索与 @a id 匹配的参与者，如果参与者未被缓存，则返回nullptr。
+    ActorRecord GetActorById(ActorId id) const;
 
     /// 检索与 @a 范围内的 ID 匹配的参与者。
     template <typename RangeT>
-    std::vector<rpc::Actor> GetActorsById(const RangeT &range) const;
+    std::vector<ActorRecord> GetActorsById(const RangeT &range) const;
 
     void Clear();
 
   private:
 
-    mutable std::mutex _mutex;
+    static constexpr size_t SHARD_COUNT = 16u;
+
+    struct Shard {
+      mutable std::shared_timed_mutex mutex;
+      std::unordered_map<ActorId, ActorRecord> actors;
+    };
+
+    /// 参与者ID是连续分配的，取模即可均匀分布。
+    Shard &GetShard(ActorId id) {
+      return _shards[id % SHARD_COUNT];
+    }
+
+    const Shard &GetShard(ActorId id) const {
+      return _shards[id % SHARD_COUNT];
+    }
+
+    void InsertRecord(ActorRecord actor);
 
-    std::unordered_map<ActorId, rpc::Actor> _actors;
+    std::array<Shard, SHARD_COUNT> _shards;
   };
 
   // ===========================================================================
   // -- 缓冲的参与者列表 CachedActorList implementation 实现 ---------------------
   // ===========================================================================
 
+  inline void CachedActorList::InsertRecord(ActorRecord actor) {
+    auto &shard = GetShard(actor->id);
+    std::lock_guard<std::shared_timed_mutex> lock(shard.mutex);
+    auto id = actor->id;
+    shard.actors.emplace(id, std::move(actor));
+  }
+
   inline void CachedActorList::Insert(rpc::Actor actor) {
-    std::lock_guard<std::mutex> lock(_mutex);
-    auto id = actor.id;
-    _actors.emplace(id, std::move(actor));
+    InsertRecord(MakeShared<rpc::Actor>(std::move(actor)));
   }
 
   template <typename RangeT>
   inline void CachedActorList::InsertRange(RangeT range) {
-    auto make_a_pair = [](rpc::Actor actor) {
-      auto id = actor.id;
-      return std::make_pair(id, std::move(actor));
-    };
-    auto make_iterator = [&make_a_pair](auto it) {
-      return boost::make_transform_iterator(std::make_move_iterator(it), make_a_pair);
-    };
-    std::lock_guard<std::mutex> lock(_mutex);
-    _actors.insert(make_iterator(std::begin(range)), make_iterator(std::end(range)));
+    for (auto &&actor : range) {
+      Insert(std::move(actor));
+    }
   }
 
   template <typename RangeT>
   inline std::vector<ActorId> CachedActorList::GetMissingIds(const RangeT &range) const {
     std::vector<ActorId> result;
     result.reserve(range.size());
-    std::lock_guard<std::mutex> lock(_mutex);
-    std::copy_if(std::begin(range), std::end(range), std::back_inserter(result), [this](auto id) {
-      return _actors.find(id) == _actors.end();
-    });
+    for (auto &&id : range) {
+      const auto &shard = GetShard(id);
+      std::shared_lock<std::shared_timed_mutex> lock(shard.mutex);
+      if (shard.actors.find(id) == shard.actors.end()) {
+        result.emplace_back(id);
+      }
+    }
     return result;
   }
 
-  inline boost::optional<rpc::Actor> CachedActorList::GetActorById(ActorId id) const {
-    std::lock_guard<std::mutex> lock(_mutex);
-    auto it = _actors.find(id);
-    if (it != _actors.end()) {
+  inline CachedActorList::ActorRecord CachedActorList::GetActorById(ActorId id) const {
+    const auto &shard = GetShard(id);
+    std::shared_lock<std::shared_timed_mutex> lock(shard.mutex);
+    auto it = shard.actors.find(id);
+    if (it != shard.actors.end()) {
       return it->second;
     }
-    return boost::none;
+    return nullptr;
   }
 
   template <typename RangeT>
-  inline std::vector<rpc::Actor> CachedActorList::GetActorsById(const RangeT &range) const {
-    std::vector<rpc::Actor> result;
+  inline std::vector<CachedActorList::ActorRecord> CachedActorList::GetActorsById(const RangeT &range) const {
+    std::vector<ActorRecord> result;
     result.reserve(range.size());
-    std::lock_guard<std::mutex> lock(_mutex);
     for (auto &&id : range) {
-      auto it = _actors.find(id);
-      if (it != _actors.end()) {
+      const auto &shard = GetShard(id);
+      std::shared_lock<std::shared_timed_mutex> lock(shard.mutex);
+      auto it = shard.actors.find(id);
+      if (it != shard.actors.end()) {
         result.emplace_back(it->second);
       }
     }
@@ -114,8 +141,10 @@ namespace detail {
   }
 
   inline void CachedActorList::Clear() {
-    std::lock_guard<std::mutex> lock(_mutex);
-    _actors.clear();
+    for (auto &shard : _shards) {
+      std::lock_guard<std::shared_timed_mutex> lock(shard.mutex);
+      shard.actors.clear();
+    }
   }
 
 } // namespace detail
@@ -25,11 +25,12 @@ namespace detail {
     using CallbackType = std::function<void(InputsT...)>;
 // 定义Call函数，它用于依次调用存储在列表中的所有回调函数（CallbackType类型的函数对象）
     // 并将可变参数args传递给每个回调函数，const表示该函数不会修改类的成员变量
-    void Call(InputsT... args) const { // 通过原子加载操作获取当前的列表（_list是一个AtomicList类型，用于保证在多线程环境下对列表操作的原子性）
-      auto list = _list.Load(); // 遍历列表中的每一个元素（每个元素是一个Item结构体，包含一个唯一标识id和一个回调函数callback）
-      for (auto &item : *list) { // 调用当前元素对应的回调函数，并传递参数args
+    // 遍历不加锁也不增加引用计数，回调中可以安全地加入或移除回调（包括自己），
+    // 这些修改从下一次调用开始生效
+    void Call(InputsT... args) const {
+      _list.ForEach([&](const Item &item) { // 调用当前元素对应的回调函数，并传递参数args
         item.callback(args...);
-      }
+      });
     }
 // 定义Push函数，用于向回调函数列表中添加一个新的回调函数
     // 它接受一个右值引用类型的回调函数（CallbackType &&callback），这样可以避免不必要的拷贝，提高效率
@@ -7,25 +7,30 @@
 #include "carla/client/detail/Client.h"
 
 #include "carla/Exception.h"
+#include "carla/MsgPack.h"
 #include "carla/Version.h"
 #include "carla/client/FileTransfer.h"
 #include "carla/client/TimeoutException.h"
 #include "carla/rpc/AckermannControllerSettings.h"
 #include "carla/rpc/ActorDescription.h"
 #include "carla/rpc/BoneTransformDataIn.h"
+#include "carla/rpc/CachedContent.h"
 #include "carla/rpc/Client.h"
 #include "carla/rpc/DebugShape.h"
+#include "carla/rpc/FileInfo.h"
 #include "carla/rpc/Response.h"
 #include "carla/rpc/VehicleAckermannControl.h"
 #include "carla/rpc/VehicleControl.h"
 #include "carla/rpc/VehicleLightState.h"
 #include "carla/rpc/WalkerBoneControlIn.h"
 #include "carla/rpc/WalkerBoneControlOut.h"
+#include "carla/rpc/WalkerBonePoses.h"
 #include "carla/rpc/WalkerControl.h"
 #include "carla/streaming/Client.h"
 
 #include <rpc/rpc_error.h>
 
+#include <future>
 #include <thread>
 
 namespace carla {
@@ -41,6 +46,13 @@ namespace detail {
     return true;
   }
 
+  template <typename T>
+  static T GetResult(carla::rpc::Response<T> &response) {
+    return response.Get();
+  }
+
+  static void GetResult(carla::rpc::Response<void> &) {}
+
   // ===========================================================================
   // -- Client::Pimpl ----------------------------------------------------------
   // ===========================================================================
@@ -53,8 +65,10 @@ namespace detail {
         rpc_client(host, port),
         streaming_client(host) {
       rpc_client.set_timeout(5000u);
-      streaming_client.AsyncRun(
-          worker_threads > 0u ? worker_threads : std::thread::hardware_concurrency());
+      const size_t threads = worker_threads > 0u ? worker_threads : std::thread::hardware_concurrency();
+      // 传感器回调在独立的线程池上按流依次执行，耗时的回调不会阻塞其他传感器的数据
+      streaming_client.SetCallbackExecutor(threads);
+      streaming_client.AsyncRun(threads);
     }
 
     template <typename ... Args>
@@ -77,6 +91,55 @@ namespace detail {
       return Get(response);
     }
 
+    /// 发起调用但不等待响应，返回的future在get()时才解析响应，
+    /// 超时或服务器报错时抛出异常，与CallAndWait相同。
+    template <typename T, typename ... Args>
+    std::future<T> PipelinedCall(const std::string &function, Args && ... args) {
+      auto pending = rpc_client.pipelined_call(function, std::forward<Args>(args) ...);
+      return std::async(
+          std::launch::deferred,
+          [pending=std::move(pending), endpoint=endpoint, timeout=GetTimeout()]() mutable -> T {
+        if (pending.wait_for(timeout.to_chrono()) != std::future_status::ready) {
+          throw_exception(TimeoutException(endpoint, timeout));
+        }
+        auto object = pending.get();
+        using R = typename carla::rpc::Response<T>;
+        auto response = object.template as<R>();
+        if (response.HasError()) {
+          throw_exception(std::runtime_error(response.GetError().What()));
+        }
+        return GetResult(response);
+      });
+    }
+
+    /// 以本地缓存内容的哈希调用 @a function ，内容未变化时服务器不重新发送。
+    ///
+    /// 内容以其哈希为文件名保存在文件缓存的 ContentCache/ 目录中，
+    /// @a key 对应的索引文件记录最近一次得到的哈希。
+    std::vector<uint8_t> FetchIfNoneMatch(const std::string &function, const std::string &key) {
+      const std::string index = "ContentCache/index/" + key;
+      const auto cached_hash_bytes = FileTransfer::ReadFile(index);
+      std::string cached_hash(cached_hash_bytes.begin(), cached_hash_bytes.end());
+      std::vector<uint8_t> cached;
+      if (!cached_hash.empty()) {
+        cached = FileTransfer::ReadFile("ContentCache/" + cached_hash);
+        // 文件损坏或只写了一部分时当作没有缓存
+        if (rpc::CachedContent::ComputeHash(cached) != cached_hash) {
+          cached_hash.clear();
+          cached.clear();
+        }
+      }
+      auto result = CallAndWait<rpc::CachedContent>(function, cached_hash);
+      if (result.not_modified) {
+        return cached;
+      }
+      // 缓存写入失败不影响本次结果
+      if (FileTransfer::WriteFile("ContentCache/" + result.hash, result.content)) {
+        FileTransfer::WriteFile(index, std::vector<uint8_t>(result.hash.begin(), result.hash.end()));
+      }
+      return std::move(result.content);
+    }
+
     template <typename ... Args>
     void AsyncCall(const std::string &function, Args && ... args) {
       // Discard returned future.
@@ -132,6 +195,14 @@ namespace detail {
     return _pimpl->GetTimeout();
   }
 
+  void Client::SetSensorCredits(uint32_t credits) {
+    _pimpl->streaming_client.SetStreamCredits(credits);
+  }
+
+  void Client::SetSensorMultiplexing(bool enable) {
+    _pimpl->streaming_client.SetMultiplexing(enable);
+  }
+
   const std::string Client::GetEndpoint() const {
     return _pimpl->endpoint;
   }
@@ -149,6 +220,10 @@ namespace detail {
     _pimpl->CallAndWait<void>("load_new_episode", std::move(map_name), reset_settings, map_layer);
   }
 
+  bool Client::PreloadMap(std::string map_name) {
+    return _pimpl->CallAndWait<bool>("preload_map", std::move(map_name));
+  }
+
   void Client::LoadLevelLayer(rpc::MapLayer map_layer) const {
     // 等待响应，我们需要确定这一点。
     _pimpl->CallAndWait<void>("load_map_layer", map_layer);
@@ -186,6 +261,10 @@ namespace detail {
     return _pimpl->CallAndWait<rpc::EpisodeInfo>("get_episode_info");
   }
 
+  streaming::Token Client::GetEpisodeInterestToken(const rpc::EpisodeInterest &interest) {
+    return _pimpl->CallAndWait<streaming::Token>("get_episode_interest_token", interest);
+  }
+
   rpc::MapInfo Client::GetMapInfo() {
     return _pimpl->CallAndWait<rpc::MapInfo>("get_map_info");
   }
@@ -194,6 +273,11 @@ namespace detail {
     return _pimpl->CallAndWait<std::string>("get_map_data");
   }
 
+  std::string Client::GetMapDataCached(const std::string &map_name) const {
+    const auto content = _pimpl->FetchIfNoneMatch("get_map_data_if_none_match", "maps/" + map_name);
+    return std::string(content.begin(), content.end());
+  }
+
   std::vector<uint8_t> Client::GetNavigationMesh() const {
     return _pimpl->CallAndWait<std::vector<uint8_t>>("get_navigation_mesh");
   }
@@ -208,11 +292,20 @@ namespace detail {
 
     if (download) {
 
-      // 对于每个所需文件，检查它是否存在，否则请求它
-      for (auto requiredFile : requiredFiles) {
-        if (!FileTransfer::FileExists(requiredFile)) {
-          RequestFile(requiredFile);
+      // 一次性请求所有文件的信息，不必逐个等待往返
+      std::vector<std::future<rpc::FileInfo>> infos;
+      infos.reserve(requiredFiles.size());
+      for (const auto &requiredFile : requiredFiles) {
+        infos.emplace_back(_pimpl->PipelinedCall<rpc::FileInfo>("get_file_info", requiredFile));
+      }
+
+      // 对于每个所需文件，检查缓存是否与服务器上的相同，否则下载它
+      for (size_t i = 0u; i < requiredFiles.size(); ++i) {
+        const auto &requiredFile = requiredFiles[i];
+        const auto info = infos[i].get();
+        if (!FileTransfer::IsUpToDate(requiredFile, info)) {
           log_info("Could not find the required file in cache, downloading... ", requiredFile);
+          DownloadFile(requiredFile, info);
         } else {
           log_info("Found the required file in cache! ", requiredFile);
         }
@@ -222,9 +315,14 @@ namespace detail {
   }
 
   void Client::RequestFile(const std::string &name) const {
-    // 从服务器下载文件的二进制内容并写入客户端
-    auto content = _pimpl->CallAndWait<std::vector<uint8_t>>("request_file", name);
-    FileTransfer::WriteFile(name, content);
+    // 按块从服务器下载文件，中断后再次调用时从已完成的块继续
+    DownloadFile(name, _pimpl->CallAndWait<rpc::FileInfo>("get_file_info", name));
+  }
+
+  void Client::DownloadFile(const std::string &name, const rpc::FileInfo &info) const {
+    FileTransfer::DownloadFile(name, info, [&](uint64_t offset, uint32_t length) {
+      return _pimpl->PipelinedCall<std::vector<uint8_t>>("request_file_chunk", name, offset, length);
+    });
   }
 
   std::vector<uint8_t> Client::GetCacheFile(const std::string &name, const bool request_otherwise) const {
@@ -243,10 +341,20 @@ namespace detail {
     return _pimpl->CallAndWait<std::vector<std::string>>("get_available_maps");
   }
 
+  std::vector<rpc::SecondaryTelemetry> Client::GetSecondaryTelemetry() {
+    return _pimpl->CallAndWait<std::vector<rpc::SecondaryTelemetry>>("get_secondary_telemetry");
+  }
+
   std::vector<rpc::ActorDefinition> Client::GetActorDefinitions() {
     return _pimpl->CallAndWait<std::vector<rpc::ActorDefinition>>("get_actor_definitions");
   }
 
+  std::vector<rpc::ActorDefinition> Client::GetActorDefinitionsCached() {
+    using return_t = std::vector<rpc::ActorDefinition>;
+    const auto content = _pimpl->FetchIfNoneMatch("get_actor_definitions_if_none_match", "actor_definitions");
+    return MsgPack::UnPack<return_t>(content.data(), content.size());
+  }
+
   rpc::Actor Client::GetSpectator() {
     return _pimpl->CallAndWait<carla::rpc::Actor>("get_spectator");
   }
@@ -281,6 +389,18 @@ namespace detail {
     return _pimpl->CallAndWait<return_t>("get_actors_by_id", ids);
   }
 
+  std::future<std::vector<rpc::Actor>> Client::GetActorsByIdAsync(
+      const std::vector<ActorId> &ids) {
+    using return_t = std::vector<rpc::Actor>;
+    return _pimpl->PipelinedCall<return_t>("get_actors_by_id", ids);
+  }
+
+  rpc::ActorQueryResult Client::QueryActors(
+      const std::vector<ActorId> &ids,
+      const std::vector<std::string> &fields) {
+    return _pimpl->CallAndWait<rpc::ActorQueryResult>("query_actors", ids, fields);
+  }
+
   rpc::VehiclePhysicsControl Client::GetVehiclePhysicsControl(
       rpc::ActorId vehicle) const {
     return _pimpl->CallAndWait<carla::rpc::VehiclePhysicsControl>("get_physics_control", vehicle);
@@ -473,6 +593,35 @@ namespace detail {
     _pimpl->AsyncCall("set_actor_dead", actor);
   }
 
+  void Client::StartServerWalker(rpc::ActorId walker) {
+    _pimpl->CallAndWait<void>("start_server_walker", walker);
+  }
+
+  void Client::StopServerWalker(rpc::ActorId walker) {
+    _pimpl->CallAndWait<void>("stop_server_walker", walker);
+  }
+
+  bool Client::SetServerWalkerTarget(rpc::ActorId walker, const geom::Location &target) {
+    return _pimpl->CallAndWait<bool>("set_server_walker_target", walker, target);
+  }
+
+  bool Client::SetServerWalkerMaxSpeed(rpc::ActorId walker, float max_speed) {
+    return _pimpl->CallAndWait<bool>("set_server_walker_max_speed", walker, max_speed);
+  }
+
+  boost::optional<geom::Location> Client::GetServerWalkerRandomLocation() {
+    using return_t = std::pair<bool, geom::Location>;
+    auto result = _pimpl->CallAndWait<return_t>("get_server_walker_random_location");
+    if (!result.first) {
+      return {};
+    }
+    return result.second;
+  }
+
+  void Client::SetServerPedestriansCrossFactor(float percentage) {
+    _pimpl->CallAndWait<void>("set_server_pedestrians_cross_factor", percentage);
+  }
+
   void Client::SetActorEnableGravity(rpc::ActorId actor, const bool enabled) {
     _pimpl->AsyncCall("set_actor_enable_gravity", actor, enabled);
   }
@@ -558,6 +707,17 @@ namespace detail {
     _pimpl->AsyncCall("get_pose_from_animation", walker);
   }
 
+  std::vector<rpc::ActorId> Client::SetWalkersBonesTransform(const rpc::WalkerBonePoses &poses) {
+    using return_t = std::vector<rpc::ActorId>;
+    return _pimpl->CallAndWait<return_t>("set_walkers_bones_transform", poses);
+  }
+
+  rpc::WalkerBonePoses Client::GetWalkersBonesTransform(
+      const std::vector<rpc::ActorId> &walkers,
+      const std::vector<std::string> &bone_names) {
+    return _pimpl->CallAndWait<rpc::WalkerBonePoses>("get_walkers_bones_transform", walkers, bone_names);
+  }
+
   void Client::SetTrafficLightState(
       rpc::ActorId traffic_light,
       const rpc::TrafficLightState traffic_light_state) {
@@ -592,6 +752,16 @@ namespace detail {
     _pimpl->AsyncCall("freeze_all_traffic_lights", frozen);
   }
 
+  void Client::ApplyTrafficLightPlans(
+      const std::vector<rpc::TrafficLightGroupPlan> &plans) {
+    _pimpl->CallAndWait<void>("apply_traffic_light_plans", plans);
+  }
+
+  std::vector<rpc::SignTriggerEvent> Client::GetSignTriggerEvents() const {
+    using return_t = std::vector<rpc::SignTriggerEvent>;
+    return _pimpl->CallAndWait<return_t>("get_sign_trigger_events");
+  }
+
   std::vector<geom::BoundingBox> Client::GetLightBoxes(rpc::ActorId traffic_light) const {
     using return_t = std::vector<geom::BoundingBox>;
     return _pimpl->CallAndWait<return_t>("get_light_boxes", traffic_light);
@@ -610,6 +780,19 @@ namespace detail {
     return _pimpl->CallAndWait<std::string>("start_recorder", name, additional_data);
   }
 
+  std::string Client::StartRecorder(
+      std::string name,
+      bool additional_data,
+      const rpc::RecorderFilter &filter) {
+    return _pimpl->CallAndWait<std::string>("start_recorder_with_filter", name, additional_data, filter);
+  }
+
+  streaming::Token Client::StartRecorderStream(
+      bool additional_data,
+      const rpc::RecorderFilter &filter) {
+    return _pimpl->CallAndWait<streaming::Token>("start_recorder_stream", additional_data, filter);
+  }
+
   void Client::StopRecorder() {
     return _pimpl->AsyncCall("stop_recorder");
   }
@@ -632,6 +815,10 @@ namespace detail {
         follow_id, replay_sensors);
   }
 
+  std::string Client::BenchmarkReplayer(std::string name, double tolerance) {
+    return _pimpl->CallAndWait<std::string>("benchmark_replayer", name, tolerance);
+  }
+
   void Client::StopReplayer(bool keep_actors) {
     _pimpl->AsyncCall("stop_replayer", keep_actors);
   }
@@ -652,8 +839,22 @@ namespace detail {
       const streaming::Token &token,
       std::function<void(Buffer)> callback) {
     carla::streaming::detail::token_type thisToken(token);
-    streaming::Token receivedToken = _pimpl->CallAndWait<streaming::Token>("get_sensor_token", thisToken.get_stream_id());
-    _pimpl->streaming_client.Subscribe(receivedToken, std::move(callback));
+    const auto stream_id = thisToken.get_stream_id();
+    streaming::Token receivedToken = _pimpl->CallAndWait<streaming::Token>("get_sensor_token", stream_id);
+    // 传感器所在的次级服务器重启后令牌会改变，连接失败时重新向服务器请求令牌。
+    // streaming_client 在 rpc_client 之前销毁，这里可以直接使用指针
+    auto *pimpl = _pimpl.get();
+    _pimpl->streaming_client.Subscribe(receivedToken, std::move(callback), false,
+        [pimpl, stream_id](streaming::Token &token) {
+          token = pimpl->CallAndWait<streaming::Token>("get_sensor_token", stream_id);
+          return true;
+        });
+  }
+
+  void Client::SubscribeToRecorderStream(
+      const streaming::Token &token,
+      std::function<void(Buffer)> callback) {
+    _pimpl->streaming_client.Subscribe(token, std::move(callback), true);
   }
 
   void Client::UnSubscribeFromStream(const streaming::Token &token) {
@@ -700,10 +901,38 @@ namespace detail {
     _pimpl->streaming_client.UnSubscribe(token);
   }
 
+  void Client::SubscribeToGBuffers(
+      rpc::ActorId ActorId,
+      uint64_t TextureMask,
+      std::function<void(Buffer)> callback)
+  {
+    std::vector<unsigned char> token_data = _pimpl->CallAndWait<std::vector<unsigned char>>("get_gbuffer_multipart_token", ActorId, TextureMask);
+    streaming::Token token;
+    std::memcpy(&token.data[0u], token_data.data(), token_data.size());
+    _pimpl->streaming_client.Subscribe(token, std::move(callback));
+  }
+
+  void Client::UnSubscribeFromGBuffers(rpc::ActorId ActorId)
+  {
+    // 掩码为0时服务器停止打包纹理
+    std::vector<unsigned char> token_data = _pimpl->CallAndWait<std::vector<unsigned char>>("get_gbuffer_multipart_token", ActorId, uint64_t(0u));
+    streaming::Token token;
+    std::memcpy(&token.data[0u], token_data.data(), token_data.size());
+    _pimpl->streaming_client.UnSubscribe(token);
+  }
+
   void Client::DrawDebugShape(const rpc::DebugShape &shape) {
     _pimpl->AsyncCall("draw_debug_shape", shape);
   }
 
+  void Client::DrawDebugShapeBatches(const std::vector<rpc::DebugShapeBatch> &batches) {
+    _pimpl->AsyncCall("draw_debug_shape_batches", _pimpl->endpoint, batches);
+  }
+
+  void Client::ClearDebugShapeBatches() {
+    _pimpl->AsyncCall("clear_debug_shape_batches", _pimpl->endpoint);
+  }
+
   void Client::ApplyBatch(std::vector<rpc::Command> commands, bool do_tick_cue) {
     _pimpl->AsyncCall("apply_batch", std::move(commands), do_tick_cue);
   }
@@ -715,15 +944,52 @@ namespace detail {
     return result.as<std::vector<rpc::CommandResponse>>();
   }
 
+  uint64_t Client::SpawnBatch(std::vector<rpc::Command> commands, double time_budget) {
+    return _pimpl->CallAndWait<uint64_t>("spawn_batch", std::move(commands), time_budget);
+  }
+
+  rpc::SpawnBatchStatus Client::GetSpawnBatchStatus(uint64_t ticket) {
+    return _pimpl->CallAndWait<rpc::SpawnBatchStatus>("get_spawn_batch_status", ticket);
+  }
+
+  void Client::SetActorPoolSize(uint32_t size) {
+    _pimpl->CallAndWait<void>("set_actor_pool_size", size);
+  }
+
+  uint64_t Client::SaveSnapshot() {
+    return _pimpl->CallAndWait<uint64_t>("save_snapshot");
+  }
+
+  void Client::RestoreSnapshot(uint64_t snapshot_id) {
+    _pimpl->CallAndWait<void>("restore_snapshot", snapshot_id);
+  }
+
+  bool Client::RemoveSnapshot(uint64_t snapshot_id) {
+    return _pimpl->CallAndWait<bool>("remove_snapshot", snapshot_id);
+  }
+
+  rpc::ServerProfile Client::GetServerProfile(bool reset) {
+    return _pimpl->CallAndWait<rpc::ServerProfile>("get_server_profile", reset);
+  }
+
   uint64_t Client::SendTickCue() {
     return _pimpl->CallAndWait<uint64_t>("tick_cue");
   }
 
+  std::future<uint64_t> Client::SendTickCueAsync() {
+    return _pimpl->PipelinedCall<uint64_t>("tick_cue");
+  }
+
   std::vector<rpc::LightState> Client::QueryLightsStateToServer() const {
     using return_t = std::vector<rpc::LightState>;
     return _pimpl->CallAndWait<return_t>("query_lights_state", _pimpl->endpoint);
   }
 
+  rpc::LightStateChanges Client::QueryLightsStateChangesToServer(uint64_t since_version) const {
+    using return_t = rpc::LightStateChanges;
+    return _pimpl->CallAndWait<return_t>("query_lights_state_changes", _pimpl->endpoint, since_version);
+  }
+
   void Client::UpdateServerLightsState(std::vector<rpc::LightState>& lights, bool discard_client) const {
     _pimpl->AsyncCall("update_lights_state", _pimpl->endpoint, std::move(lights), discard_client);
   }
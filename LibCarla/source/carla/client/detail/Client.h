@@ -13,17 +13,25 @@
 #include "carla/geom/Location.h"
 #include "carla/rpc/Actor.h"
 #include "carla/rpc/ActorDefinition.h"
+#include "carla/rpc/ActorQuery.h"
 #include "carla/rpc/AttachmentType.h"
 #include "carla/rpc/Command.h"
 #include "carla/rpc/CommandResponse.h"
 #include "carla/rpc/EnvironmentObject.h"
 #include "carla/rpc/EpisodeInfo.h"
+#include "carla/rpc/EpisodeInterest.h"
 #include "carla/rpc/EpisodeSettings.h"
 #include "carla/rpc/LabelledPoint.h"
 #include "carla/rpc/LightState.h"
 #include "carla/rpc/MapInfo.h"
 #include "carla/rpc/MapLayer.h"
 #include "carla/rpc/OpendriveGenerationParameters.h"
+#include "carla/rpc/RecorderFilter.h"
+#include "carla/rpc/SecondaryTelemetry.h"
+#include "carla/rpc/ServerProfile.h"
+#include "carla/rpc/SignTriggerEvent.h"
+#include "carla/rpc/SpawnBatchStatus.h"
+#include "carla/rpc/TrafficLightPlan.h"
 #include "carla/rpc/TrafficLightState.h"
 #include "carla/rpc/VehicleDoor.h"
 #include "carla/rpc/VehicleLightStateList.h"
@@ -35,7 +43,10 @@
 #include "carla/rpc/Texture.h"
 #include "carla/rpc/MaterialParameter.h"
 
+#include <boost/optional.hpp>
+
 #include <functional>
+#include <future>
 #include <memory>
 #include <string>
 #include <vector>
@@ -49,11 +60,14 @@ namespace rpc {
   class AckermannControllerSettings;
   class ActorDescription;
   class DebugShape;
+  class DebugShapeBatch;
+  class FileInfo;
   class VehicleAckermannControl;
   class VehicleControl;
   class WalkerControl;
   class WalkerBoneControlIn;
   class WalkerBoneControlOut;
+  class WalkerBonePoses;
 }
 namespace sensor {
   class SensorData;
@@ -94,6 +108,12 @@ namespace detail {
 
     time_duration GetTimeout() const;
 
+    /// 见 streaming::Client::SetStreamCredits。
+    void SetSensorCredits(uint32_t credits);
+
+    /// 见 streaming::Client::SetMultiplexing。
+    void SetSensorMultiplexing(bool enable);
+
     const std::string GetEndpoint() const;
 
     std::string GetClientVersion();
@@ -102,6 +122,8 @@ namespace detail {
 
     void LoadEpisode(std::string map_name, bool reset_settings = true, rpc::MapLayer map_layer = rpc::MapLayer::All);
 
+    bool PreloadMap(std::string map_name);
+
     void LoadLevelLayer(rpc::MapLayer map_layer) const;
 
     void UnloadLevelLayer(rpc::MapLayer map_layer) const;
@@ -123,6 +145,9 @@ namespace detail {
 
     rpc::EpisodeInfo GetEpisodeInfo();
 
+    /// 返回只包含 @a interest 中参与者的剧集状态流的令牌。
+    streaming::Token GetEpisodeInterestToken(const rpc::EpisodeInterest &interest);
+
     rpc::MapInfo GetMapInfo();
 
     std::vector<uint8_t> GetNavigationMesh() const;
@@ -133,14 +158,22 @@ namespace detail {
 
     std::string GetMapData() const;
 
+    /// 与GetMapData相同，但使用本地文件缓存，内容未变化时服务器不重新发送。
+    std::string GetMapDataCached(const std::string &map_name) const;
+
     void RequestFile(const std::string &name) const;
 
     std::vector<uint8_t> GetCacheFile(const std::string &name, const bool request_otherwise = true) const;
 
     std::vector<std::string> GetAvailableMaps();
 
+    std::vector<rpc::SecondaryTelemetry> GetSecondaryTelemetry();
+
     std::vector<rpc::ActorDefinition> GetActorDefinitions();
 
+    /// 与GetActorDefinitions相同，但使用本地文件缓存，内容未变化时服务器不重新发送。
+    std::vector<rpc::ActorDefinition> GetActorDefinitionsCached();
+
     rpc::Actor GetSpectator();
 
     rpc::EpisodeSettings GetEpisodeSettings();
@@ -157,6 +190,14 @@ namespace detail {
 
     std::vector<rpc::Actor> GetActorsById(const std::vector<ActorId> &ids);
 
+    /// 与GetActorsById相同，但不等待响应。多个这样的调用可以同时在途，
+    /// 响应在future的get()时解析。
+    std::future<std::vector<rpc::Actor>> GetActorsByIdAsync(const std::vector<ActorId> &ids);
+
+    rpc::ActorQueryResult QueryActors(
+        const std::vector<ActorId> &ids,
+        const std::vector<std::string> &fields);
+
     rpc::VehiclePhysicsControl GetVehiclePhysicsControl(rpc::ActorId vehicle) const;
 
     rpc::VehicleLightState GetVehicleLightState(rpc::ActorId vehicle) const;
@@ -279,6 +320,25 @@ namespace detail {
     void SetActorDead(
         rpc::ActorId actor);
 
+    /// 服务器上模拟的行人，见 WalkerAIController。
+    void StartServerWalker(
+        rpc::ActorId walker);
+
+    void StopServerWalker(
+        rpc::ActorId walker);
+
+    bool SetServerWalkerTarget(
+        rpc::ActorId walker,
+        const geom::Location &target);
+
+    bool SetServerWalkerMaxSpeed(
+        rpc::ActorId walker,
+        float max_speed);
+
+    boost::optional<geom::Location> GetServerWalkerRandomLocation();
+
+    void SetServerPedestriansCrossFactor(float percentage);
+
     void SetActorEnableGravity(
         rpc::ActorId actor,
         bool enabled);
@@ -355,6 +415,13 @@ namespace detail {
     void GetPoseFromAnimation(
         rpc::ActorId walker);
 
+    std::vector<rpc::ActorId> SetWalkersBonesTransform(
+        const rpc::WalkerBonePoses &poses);
+
+    rpc::WalkerBonePoses GetWalkersBonesTransform(
+        const std::vector<rpc::ActorId> &walkers,
+        const std::vector<std::string> &bone_names);
+
     void SetTrafficLightState(
         rpc::ActorId traffic_light,
         const rpc::TrafficLightState trafficLightState);
@@ -382,6 +449,11 @@ namespace detail {
 
     void FreezeAllTrafficLights(bool frozen);
 
+    void ApplyTrafficLightPlans(
+        const std::vector<rpc::TrafficLightGroupPlan> &plans);
+
+    std::vector<rpc::SignTriggerEvent> GetSignTriggerEvents() const;
+
     std::vector<geom::BoundingBox> GetLightBoxes(
         rpc::ActorId traffic_light) const;
 
@@ -393,6 +465,16 @@ namespace detail {
 
     std::string StartRecorder(std::string name, bool additional_data);
 
+    std::string StartRecorder(
+        std::string name,
+        bool additional_data,
+        const rpc::RecorderFilter &filter);
+
+    /// 开始录制到流媒体服务器的流，返回流的token。
+    streaming::Token StartRecorderStream(
+        bool additional_data,
+        const rpc::RecorderFilter &filter);
+
     void StopRecorder();
 
     std::string ShowRecorderFileInfo(std::string name, bool show_all);
@@ -404,6 +486,8 @@ namespace detail {
     std::string ReplayFile(std::string name, double start, double duration,
         uint32_t follow_id, bool replay_sensors);
 
+    std::string BenchmarkReplayer(std::string name, double tolerance);
+
     void SetReplayerTimeFactor(double time_factor);
 
     void SetReplayerIgnoreHero(bool ignore_hero);
@@ -416,6 +500,11 @@ namespace detail {
         const streaming::Token &token,
         std::function<void(Buffer)> callback);
 
+    /// 订阅录制流，回调线程池的队列满时也不丢弃消息。
+    void SubscribeToRecorderStream(
+        const streaming::Token &token,
+        std::function<void(Buffer)> callback);
+
     void SubscribeToGBuffer(
         rpc::ActorId ActorId,
         uint32_t GBufferId,
@@ -433,10 +522,21 @@ namespace detail {
         rpc::ActorId ActorId,
         uint32_t GBufferId);
 
+    void SubscribeToGBuffers(
+        rpc::ActorId ActorId,
+        uint64_t TextureMask,
+        std::function<void(Buffer)> callback);
+
+    void UnSubscribeFromGBuffers(rpc::ActorId ActorId);
+
     void Send(rpc::ActorId ActorId, std::string message);
 
     void DrawDebugShape(const rpc::DebugShape &shape);
 
+    void DrawDebugShapeBatches(const std::vector<rpc::DebugShapeBatch> &batches);
+
+    void ClearDebugShapeBatches();
+
     void ApplyBatch(
         std::vector<rpc::Command> commands,
         bool do_tick_cue);
@@ -445,10 +545,32 @@ namespace detail {
         std::vector<rpc::Command> commands,
         bool do_tick_cue);
 
+    uint64_t SpawnBatch(
+        std::vector<rpc::Command> commands,
+        double time_budget);
+
+    rpc::SpawnBatchStatus GetSpawnBatchStatus(uint64_t ticket);
+
+    void SetActorPoolSize(uint32_t size);
+
+    uint64_t SaveSnapshot();
+
+    void RestoreSnapshot(uint64_t snapshot_id);
+
+    bool RemoveSnapshot(uint64_t snapshot_id);
+
+    rpc::ServerProfile GetServerProfile(bool reset);
+
     uint64_t SendTickCue();
 
+    /// 与SendTickCue相同，但不等待响应，future的get()返回该节拍的帧号。
+    std::future<uint64_t> SendTickCueAsync();
+
     std::vector<rpc::LightState> QueryLightsStateToServer() const;
 
+    /// 查询 @a since_version 之后改变的灯光状态。
+    rpc::LightStateChanges QueryLightsStateChangesToServer(uint64_t since_version) const;
+
     void UpdateServerLightsState(
         std::vector<rpc::LightState>& lights,
         bool discard_client = false) const;
@@ -472,6 +594,9 @@ namespace detail {
 
   private:
 
+    /// 按 @a info 分块下载文件 @a name 到文件缓存中。
+    void DownloadFile(const std::string &name, const rpc::FileInfo &info) const;
+
     class Pimpl;
     const std::unique_ptr<Pimpl> _pimpl;
   };
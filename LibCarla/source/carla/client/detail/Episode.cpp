@@ -49,7 +49,7 @@ using namespace std::chrono_literals;
 // 析构函数，尝试取消订阅流并处理可能的异常
   Episode::~Episode() {
     try {
-      _client.UnSubscribeFromStream(_token);
+      _client.UnSubscribeFromStream(GetStreamToken());
     } catch (const std::exception &e) {
       log_error("exception trying to disconnect from episode:", e.what());
     }
@@ -57,12 +57,31 @@ using namespace std::chrono_literals;
 // 开始监听流数据的函数
   void Episode::Listen() {
     std::weak_ptr<Episode> weak = shared_from_this();
-    _client.SubscribeToStream(_token, [weak](auto buffer) {
+    // 每次订阅各自记住最近的关键帧，切换流之后不会用旧流的关键帧还原新流的增量帧
+    auto last_keyframe = std::make_shared<std::shared_ptr<const EpisodeState>>();
+    _client.SubscribeToStream(GetStreamToken(), [weak, last_keyframe](auto buffer) {
       auto self = weak.lock();
       if (self != nullptr) {
         // 反序列化数据
         auto data = sensor::Deserializer::Deserialize(std::move(buffer));
-        auto next = std::make_shared<const EpisodeState>(CastData(*data));
+        const auto &raw_state = CastData(*data);
+        std::shared_ptr<const EpisodeState> next;
+        if (raw_state.IsDeltaEncoded()) {
+          // 增量帧基于最近的关键帧，缺少关键帧时等待下一个关键帧
+          if (*last_keyframe != nullptr) {
+            next = EpisodeState::MakeFromDelta(raw_state, **last_keyframe);
+          }
+          if (next == nullptr) {
+            log_debug("episode state: skipping delta frame", raw_state.GetFrame());
+            return;
+          }
+        } else {
+          // 剧集状态直接引用收到的消息，不复制参与者的状态
+          next = std::make_shared<const EpisodeState>(
+              boost::static_pointer_cast<const sensor::data::RawEpisodeState>(data));
+          // 流的回调按顺序执行，无需同步
+          *last_keyframe = next;
+        }
         auto prev = self->GetState();
 
         // TODO: 更新地图变化的检测方式
@@ -109,7 +128,7 @@ using namespace std::chrono_literals;
 
           // 通知等待的线程并执行回调。
           self->_snapshot.SetValue(next);
-/ 通知等待的线程并执行回调，通过调用_snapshot的SetValue函数，传入下一个状态数据，
+// 通知等待的线程并执行回调，通过调用_snapshot的SetValue函数，传入下一个状态数据，
                     // 这样其他等待该状态数据的部分（可能是其他线程或者模块）就可以获取到最新的状态并进行相应操作。
                     // 同时调用_on_tick_callbacks的Call函数，传入下一个状态数据，执行用户注册的每帧回调函数。
 
@@ -118,31 +137,60 @@ using namespace std::chrono_literals;
       }
     });
   }
+
+  void Episode::SetStreamToken(const streaming::Token &token) {
+    {
+      std::lock_guard<std::mutex> lock(_token_mutex);
+      if (token.data == _token.data) {
+        return;
+      }
+      _client.UnSubscribeFromStream(_token);
+      _token = token;
+    }
+    Listen();
+  }
 // Episode类的成员函数GetActorById，用于根据给定的参与者ID获取单个参与者信息。
     // 首先尝试从缓存的参与者列表_actors中获取对应的参与者信息（通过调用GetActorById函数），如果获取不到（返回的结果没有值），
     // 则从客户端获取该ID对应的参与者信息列表（通过调用_client的GetActorsById函数传入单个ID的列表），
     // 如果获取到的列表不为空，则取出第一个参与者信息（假设ID是唯一对应的），并插入到缓存列表_actors中，最后返回获取到的参与者信息（如果有的话）
   boost::optional<rpc::Actor> Episode::GetActorById(ActorId id) {
     auto actor = _actors.GetActorById(id);
-    if (!actor.has_value()) {
-      auto actor_list = _client.GetActorsById({id});
-      if (!actor_list.empty()) {
-        actor = std::move(actor_list.front());
-        _actors.Insert(*actor);
-      }
+    if (actor != nullptr) {
+      return *actor;
     }
-    return actor;
+    auto actor_list = _client.GetActorsById({id});
+    if (actor_list.empty()) {
+      return boost::none;
+    }
+    _actors.Insert(actor_list.front());
+    return std::move(actor_list.front());
   }
 // Episode类的成员函数GetActorsById，用于根据给定的参与者ID列表获取对应的参与者列表。
     // 它调用了前面定义的模板函数GetActorsById_Impl，传入客户端对象、缓存的参与者列表对象以及给定的参与者ID列表，
     // 通过模板函数内部的逻辑来获取并返回对应的参与者列表（如果有的话），可能涉及从缓存中获取或者从客户端获取缺失的参与者信息等操作。
-  std::vector<rpc::Actor> Episode::GetActorsById(const std::vector<ActorId> &actor_ids) {
+  std::vector<SharedPtr<const rpc::Actor>> Episode::GetActorsById(const std::vector<ActorId> &actor_ids) {
     return GetActorsById_Impl(_client, _actors, actor_ids);
   }
+
+  std::future<std::vector<SharedPtr<const rpc::Actor>>> Episode::GetActorsByIdAsync(const std::vector<ActorId> &actor_ids) {
+    auto missing_ids = _actors.GetMissingIds(actor_ids);
+    if (missing_ids.empty()) {
+      std::promise<std::vector<SharedPtr<const rpc::Actor>>> result;
+      result.set_value(_actors.GetActorsById(actor_ids));
+      return result.get_future();
+    }
+    auto pending = _client.GetActorsByIdAsync(missing_ids);
+    return std::async(
+        std::launch::deferred,
+        [self=shared_from_this(), pending=std::move(pending), actor_ids]() mutable {
+      self->_actors.InsertRange(pending.get());
+      return self->_actors.GetActorsById(actor_ids);
+    });
+  }
 // Episode类的成员函数GetActors，用于获取所有的参与者列表。
     // 它同样调用了模板函数GetActorsById_Impl，不过传入的参与者ID范围是通过调用GetState函数获取当前模拟场景状态中的所有参与者ID列表，
     // 以此来获取并返回整个模拟场景中的所有参与者信息列表（如果有的话）。
-  std::vector<rpc::Actor> Episode::GetActors() {
+  std::vector<SharedPtr<const rpc::Actor>> Episode::GetActors() {
     return GetActorsById_Impl(_client, _actors, GetState()->GetActorIds());
   }
 // Episode类的成员函数OnEpisodeStarted，用于在模拟场景（Episode）开始时执行一些初始化和清理操作。
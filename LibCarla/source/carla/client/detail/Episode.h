@@ -17,6 +17,8 @@
 #include "carla/client/detail/EpisodeProxy.h" // 引入剧集代理
 #include "carla/rpc/EpisodeInfo.h" // 引入剧集信息
 
+#include <future> // 引入future
+#include <mutex> // 引入互斥锁
 #include <vector> // 引入向量类
 
 namespace carla {
@@ -41,6 +43,14 @@ namespace detail {
 
     void Listen(); // 监听事件
 
+    /// 改为订阅令牌为 @a token 的剧集状态流，例如只包含客户端关心的参与者的流。
+    void SetStreamToken(const streaming::Token &token);
+
+    streaming::Token GetStreamToken() const {
+      std::lock_guard<std::mutex> lock(_token_mutex);
+      return _token;
+    }
+
     auto GetId() const { // 获取剧集 ID
       return GetState()->GetEpisodeId();
     }
@@ -49,15 +59,20 @@ namespace detail {
       return _state.load();
     }
 
-    void RegisterParticipant(rpc::Actor actor) { // 注册参与者
+    void RegisterActor(rpc::Actor actor) { // 注册参与者
       _actors.Insert(std::move(actor));
     }
 
-    boost::optional<rpc::Actor> GetParticipantById(ActorId id); // 根据 ID 获取参与者
+    boost::optional<rpc::Actor> GetActorById(ActorId id); // 根据 ID 获取参与者
 
-    std::vector<rpc::Actor> GetParticipantsById(const std::vector<ActorId> &actor_ids); // 根据 ID 列表获取参与者
+    /// 根据 ID 列表获取参与者，返回缓存中共享的描述
+    std::vector<SharedPtr<const rpc::Actor>> GetActorsById(const std::vector<ActorId> &actor_ids);
 
-    std::vector<rpc::Actor> GetParticipants(); // 获取所有参与者
+    /// 与GetActorsById相同，但缓存中没有的参与者通过不等待响应的调用获取，
+    /// 结果在future的get()时插入缓存。
+    std::future<std::vector<SharedPtr<const rpc::Actor>>> GetActorsByIdAsync(const std::vector<ActorId> &actor_ids);
+
+    std::vector<SharedPtr<const rpc::Actor>> GetActors(); // 获取所有参与者
 
     boost::optional<WorldSnapshot> WaitForState(time_duration timeout) { // 等待状态变化
       return _snapshot.WaitFor(timeout);
@@ -112,6 +127,7 @@ namespace detail {
 
     AtomicSharedPtr<const EpisodeState> _state; // 原子共享指针指向剧集状态
 
+
     std::string _pending_exceptions_msg; // 待处理异常消息
 
     CachedActorList _actors; // 缓存的参与者列表
@@ -126,7 +142,9 @@ namespace detail {
 
     AtomicSharedPtr<WalkerNavigation> _walker_navigation; // 原子共享指针指向 WalkerNavigation
 
-    const streaming::Token _token; // 令牌
+    mutable std::mutex _token_mutex; // 保护 _token
+
+    streaming::Token _token; // 当前订阅的剧集状态流的令牌
 
     bool _pending_exceptions = false; // 是否有待处理异常
 
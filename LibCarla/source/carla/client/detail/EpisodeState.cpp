@@ -6,14 +6,15 @@
 // 引入必要的头文件
 #include "carla/client/detail/EpisodeState.h"
 
+#include "carla/Logging.h"
+
+#include <algorithm>
+
 namespace carla {
 namespace client {
 namespace detail {
 
-// EpisodeState类的构造函数，用于初始化一个EpisodeState对象
-  // 参数：state - 一个const引用，指向sensor::data::RawEpisodeState类型的数据，包含了当前模拟场景的状态信息
-  EpisodeState::EpisodeState(const sensor::data::RawEpisodeState &state)
- // 使用传入的RawEpisodeState对象中的数据来初始化EpisodeState对象的成员变量
+  EpisodeState::EpisodeState(HeaderOnly, const sensor::data::RawEpisodeState &state)
     : _episode_id(state.GetEpisodeId()),// 初始化_episode_id，表示当前模拟场景的ID
       _timestamp(// 初始化_timestamp，包含帧信息、游戏时间戳、时间差、平台时间戳
           state.GetFrame(),
@@ -21,28 +22,109 @@ namespace detail {
           state.GetDeltaSeconds(),
           state.GetPlatformTimeStamp()),
       _map_origin(state.GetMapOrigin()),// 初始化_map_origin，表示地图的原点
-      _simulation_state(state.GetSimulationState()) {// 初始化_simulation_state，表示当前的模拟状态
-    // 预留空间以存储所有的Actor快照
-    _actors.reserve(state.size());
-// 遍历RawEpisodeState中的所有Actor，并为每个Actor创建一个ActorSnapshot对象
-    for (auto &&actor : state) {
- // 使用emplace方法将ActorSnapshot对象插入到_actors映射中
-      // 键是Actor的ID，值是ActorSnapshot对象
-      // DEBUG_ONLY(auto result = ) 这部分代码用于调试，用于检查插入操作是否成功
-      DEBUG_ONLY(auto result = )
-      _actors.emplace(
-          actor.id,
-          ActorSnapshot{// 初始化ActorSnapshot对象
-              actor.id,         // Actor的ID
-              actor.actor_state, // Actor的状态
-              actor.transform,// Actor的变换（位置和方向）
-              actor.velocity,// Actor的速度
-              actor.angular_velocity,// Actor的角速度
-              actor.acceleration,// Actor的加速度
-              actor.state});// Actor的附加状态信息
-      DEBUG_ASSERT(result.second);
- // DEBUG_ASSERT(result.second); 这部分代码用于调试，确保emplace操作成功，即没有重复键
+      _simulation_state(static_cast<SimulationState>(
+          state.GetSimulationState() & ~SimulationState::DeltaEncoded)),// 初始化_simulation_state，表示当前的模拟状态
+      _has_extensions(state.HasExtensions()),
+      _extensions(state.GetExtensions()) {
+    auto by_id = [](const ActorExtensionState &lhs, const ActorExtensionState &rhs) { return lhs.id < rhs.id; };
+    if (!std::is_sorted(_extensions.begin(), _extensions.end(), by_id)) {
+      std::sort(_extensions.begin(), _extensions.end(), by_id);
+    }
+  }
+
+// EpisodeState类的构造函数，用于初始化一个EpisodeState对象
+  // 参数：state - 指向sensor::data::RawEpisodeState类型的数据，包含了当前模拟场景的状态信息
+  EpisodeState::EpisodeState(SharedPtr<const sensor::data::RawEpisodeState> state)
+    : EpisodeState(HeaderOnly{}, *state) {
+    DEBUG_ASSERT(!state->IsDeltaEncoded());
+    // 只建立索引，参与者的状态留在收到的消息中
+    _index.reserve(state->size());
+    for (const auto &actor : *state) {
+      _index.push_back(IndexEntry{actor.id, &actor});
+    }
+    auto by_id = [](const IndexEntry &lhs, const IndexEntry &rhs) { return lhs.id < rhs.id; };
+    // 服务器通常按ID顺序发送，已排序时无需排序
+    if (!std::is_sorted(_index.begin(), _index.end(), by_id)) {
+      std::sort(_index.begin(), _index.end(), by_id);
+    }
+    _storage = std::move(state);
+  }
+
+  const EpisodeState::ActorDynamicState *EpisodeState::Find(const ActorId id) const {
+    auto it = std::lower_bound(
+        _index.begin(),
+        _index.end(),
+        id,
+        [](const IndexEntry &entry, ActorId value) { return entry.id < value; });
+    return ((it != _index.end()) && (it->id == id)) ? it->actor : nullptr;
+  }
+
+  const EpisodeState::ActorExtensionState *EpisodeState::GetActorExtension(const ActorId id) const {
+    auto it = std::lower_bound(
+        _extensions.begin(),
+        _extensions.end(),
+        id,
+        [](const ActorExtensionState &extension, ActorId value) { return extension.id < value; });
+    return ((it != _extensions.end()) && (it->id == id)) ? &*it : nullptr;
+  }
+
+  std::shared_ptr<const EpisodeState> EpisodeState::MakeFromDelta(
+      const sensor::data::RawEpisodeState &delta,
+      const EpisodeState &keyframe) {
+    using ChangedActor = sensor::s11n::episode_state_delta::ChangedActor;
+    uint64_t keyframe_number;
+    std::vector<ActorId> removed;
+    std::vector<ChangedActor> changed;
+    if (!delta.DecodeDelta(keyframe_number, removed, changed)) {
+      log_warning("episode state: corrupted delta frame", delta.GetFrame());
+      return nullptr;
+    }
+    if ((keyframe_number != keyframe.GetFrame()) || (delta.GetEpisodeId() != keyframe.GetEpisodeId())) {
+      // 没有收到增量所基于的关键帧，例如刚刚订阅
+      return nullptr;
+    }
+    std::sort(removed.begin(), removed.end());
+    std::sort(changed.begin(), changed.end(), [](const ChangedActor &lhs, const ChangedActor &rhs) {
+      return lhs.state.id < rhs.state.id;
+    });
+
+    // 按ID顺序合并关键帧与增量，结果仍按ID排序
+    auto actors = MakeShared<std::vector<ActorDynamicState>>();
+    actors->reserve(keyframe.size() + changed.size());
+    auto key_it = keyframe._index.begin();
+    auto changed_it = changed.begin();
+    while ((key_it != keyframe._index.end()) || (changed_it != changed.end())) {
+      const bool take_key = (changed_it == changed.end()) ||
+          ((key_it != keyframe._index.end()) && (key_it->id < changed_it->state.id));
+      if (take_key) {
+        if (!std::binary_search(removed.begin(), removed.end(), key_it->id)) {
+          actors->push_back(*key_it->actor);
+        }
+        ++key_it;
+        continue;
+      }
+      ActorDynamicState actor = changed_it->state;
+      if (!changed_it->has_type_dependent_state) {
+        if ((key_it == keyframe._index.end()) || (key_it->id != actor.id)) {
+          log_warning("episode state: delta frame", delta.GetFrame(), "misses actor", actor.id);
+          return nullptr;
+        }
+        actor.state = key_it->actor->state;
+      }
+      if ((key_it != keyframe._index.end()) && (key_it->id == actor.id)) {
+        ++key_it;
+      }
+      actors->push_back(actor);
+      ++changed_it;
+    }
+
+    std::shared_ptr<EpisodeState> state(new EpisodeState(HeaderOnly{}, delta));
+    state->_index.reserve(actors->size());
+    for (const auto &actor : *actors) {
+      state->_index.push_back(IndexEntry{actor.id, &actor});
     }
+    state->_storage = std::move(actors);
+    return state;
   }
 
 } // namespace detail
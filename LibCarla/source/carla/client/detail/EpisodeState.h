@@ -6,18 +6,19 @@
 
 #pragma once // 防止头文件被重复包含
 
-#include "carla/Iterator.h" // 引入迭代器头文件
 #include "carla/ListView.h" // 引入列表视图头文件
+#include "carla/Memory.h" // 引入共享指针头文件
 #include "carla/NonCopyable.h" // 引入不可复制类的头文件
 #include "carla/client/ActorSnapshot.h" // 引入参与者快照头文件
 #include "carla/client/Timestamp.h" // 引入时间戳头文件
 #include "carla/geom/Vector3DInt.h" // 引入三维整数向量头文件
 #include "carla/sensor/data/RawEpisodeState.h" // 引入原始剧集状态数据头文件
 
+#include <boost/iterator/transform_iterator.hpp> // 引入Boost转换迭代器头文件
 #include <boost/optional.hpp> // 引入Boost可选类型头文件
 
 #include <memory> // 引入智能指针头文件
-#include <unordered_map> // 引入无序映射头文件
+#include <vector> // 引入向量头文件
 
 namespace carla { // 定义carla命名空间
 namespace client { // 定义client子命名空间
@@ -30,13 +31,42 @@ namespace detail { // 定义detail子命名空间
 
       using SimulationState = sensor::s11n::EpisodeStateSerializer::SimulationState; // 定义模拟状态类型
 
+      using ActorDynamicState = sensor::data::ActorDynamicState;
+
+      using ActorExtensionState = sensor::data::ActorExtensionState;
+
+      /// 按参与者ID排序的索引项，指向参与者在消息中的状态。
+      struct IndexEntry {
+        ActorId id;
+        const ActorDynamicState *actor;
+      };
+
+      struct GetIdFn {
+        ActorId operator()(const IndexEntry &entry) const {
+          return entry.id;
+        }
+      };
+
+      struct MakeSnapshotFn {
+        ActorSnapshot operator()(const IndexEntry &entry) const {
+          return MakeActorSnapshot(*entry.actor);
+        }
+      };
+
   public:
 
     // 构造函数，接受剧集ID
     explicit EpisodeState(uint64_t episode_id) : _episode_id(episode_id) {}
 
-    // 构造函数，接受原始剧集状态
-    explicit EpisodeState(const sensor::data::RawEpisodeState &state);
+    /// 构造函数，接受原始剧集状态。不复制参与者的状态，只建立按ID排序的索引，
+    /// 访问时才解码为ActorSnapshot，@a state 在本对象销毁之前保持有效。
+    explicit EpisodeState(SharedPtr<const sensor::data::RawEpisodeState> state);
+
+    /// 把增量帧 @a delta 应用到关键帧 @a keyframe 上得到完整的状态。
+    /// 增量不是基于该关键帧或数据损坏时返回nullptr。
+    static std::shared_ptr<const EpisodeState> MakeFromDelta(
+        const sensor::data::RawEpisodeState &delta,
+        const EpisodeState &keyframe);
 
     // 获取剧集ID
     auto GetEpisodeId() const {
@@ -70,56 +100,75 @@ namespace detail { // 定义detail子命名空间
 
     // 检查是否包含指定的参与者快照
     bool ContainsActorSnapshot(ActorId actor_id) const {
-      return _actors.find(actor_id) != _actors.end();
+      return Find(actor_id) != nullptr;
     }
 
-    // 获取指定参与者的快照
+    // 获取指定参与者的快照，不存在时返回默认值
     ActorSnapshot GetActorSnapshot(ActorId id) const {
-      ActorSnapshot state; // 创建参与者快照对象
-      CopyActorSnapshotIfPresent(id, state); // 复制快照（如果存在）
-      return state; // 返回快照
+      const auto *actor = Find(id);
+      return actor != nullptr ? MakeActorSnapshot(*actor) : ActorSnapshot{};
     }
 
     // 获取指定参与者的快照（如果存在）
     boost::optional<ActorSnapshot> GetActorSnapshotIfPresent(ActorId id) const {
-      boost::optional<ActorSnapshot> state; // 创建可选快照
-      CopyActorSnapshotIfPresent(id, state); // 复制快照（如果存在）
-      return state; // 返回可选快照
+      const auto *actor = Find(id);
+      if (actor == nullptr) {
+        return boost::none;
+      }
+      return MakeActorSnapshot(*actor);
     }
 
-    // 获取所有参与者ID
+    // 获取所有参与者ID，按ID升序排列
     auto GetActorIds() const {
-      return MakeListView( // 创建列表视图
-          iterator::make_map_keys_const_iterator(_actors.begin()), // 获取参与者ID迭代器
-          iterator::make_map_keys_const_iterator(_actors.end())); // 获取参与者ID迭代器
+      return MakeListView(
+          boost::make_transform_iterator(_index.begin(), GetIdFn{}),
+          boost::make_transform_iterator(_index.end(), GetIdFn{}));
+    }
+
+    /// 是否包含参与者的扩展数据，即客户端在兴趣集合中请求了扩展。
+    bool HasExtensions() const {
+      return _has_extensions;
     }
 
+    /// 获取指定参与者的扩展数据，没有扩展数据或参与者不在其中时返回nullptr。
+    const ActorExtensionState *GetActorExtension(ActorId id) const;
+
     // 获取参与者数量
     size_t size() const {
-      return _actors.size(); // 返回参与者数量
+      return _index.size(); // 返回参与者数量
     }
 
-    // 返回参与者快照的开始迭代器
+    // 返回参与者快照的开始迭代器，解引用时解码快照
     auto begin() const {
-      return iterator::make_map_values_const_iterator(_actors.begin()); // 返回参与者快照值的开始迭代器
+      return boost::make_transform_iterator(_index.begin(), MakeSnapshotFn{});
     }
 
     // 返回参与者快照的结束迭代器
     auto end() const {
-      return iterator::make_map_values_const_iterator(_actors.end()); // 返回参与者快照值的结束迭代器
+      return boost::make_transform_iterator(_index.end(), MakeSnapshotFn{});
     }
 
   private:
 
-    // 复制指定参与者的快照（如果存在）
-    template <typename T>
-    void CopyActorSnapshotIfPresent(ActorId id, T &value) const {
-      auto it = _actors.find(id); // 查找参与者
-      if (it != _actors.end()) { // 如果找到了
-        value = it->second; // 复制快照
-      }
+    struct HeaderOnly {};
+
+    // 只读取消息头，不读取参与者
+    EpisodeState(HeaderOnly, const sensor::data::RawEpisodeState &state);
+
+    static ActorSnapshot MakeActorSnapshot(const ActorDynamicState &actor) {
+      return ActorSnapshot{
+          actor.id,
+          actor.actor_state,
+          actor.transform,
+          actor.velocity,
+          actor.angular_velocity,
+          actor.acceleration,
+          actor.state};
     }
 
+    // 在索引中二分查找参与者，不存在时返回nullptr
+    const ActorDynamicState *Find(ActorId id) const;
+
     const uint64_t _episode_id; // 存储剧集ID
 
     const Timestamp _timestamp; // 存储时间戳
@@ -128,7 +177,16 @@ namespace detail { // 定义detail子命名空间
 
     SimulationState _simulation_state; // 存储模拟状态
 
-    std::unordered_map<ActorId, ActorSnapshot> _actors; // 存储参与者快照的无序映射
+    /// 保持参与者状态所在的内存有效：完整帧为收到的消息，增量帧为还原后的数组。
+    SharedPtr<const void> _storage;
+
+    /// 按ID排序的索引，每帧唯一的一次分配。
+    std::vector<IndexEntry> _index;
+
+    bool _has_extensions = false;
+
+    /// 按ID排序的参与者扩展数据，只有车辆，从消息中复制。
+    std::vector<ActorExtensionState> _extensions;
   };
 
 } // namespace detail
@@ -18,10 +18,16 @@
 #include "carla/client/WalkerAIController.h"
 #include "carla/client/detail/ActorFactory.h"
 #include "carla/client/detail/WalkerNavigation.h"
+#include "carla/sensor/LazySensorData.h"
 #include "carla/trafficmanager/TrafficManager.h"
 #include "carla/sensor/Deserializer.h"
 
+#include <algorithm>
+#include <cstring>
 #include <exception>
+#include <future>
+#include <memory>
+#include <mutex>
 #include <thread>
 
 using namespace std::string_literals;
@@ -182,7 +188,7 @@ EpisodeProxy Simulator::GetCurrentEpisode() {
       std::reverse(map_base_path.begin(), map_base_path.end());
       std::string XODRFolder = map_base_path + "/OpenDrive/" + map_name + ".xodr";
       if (FileTransfer::FileExists(XODRFolder) == false) _client.GetRequiredFiles();
-      _open_drive_file = _client.GetMapData();
+      _open_drive_file = _client.GetMapDataCached(map_info.name);
       _cached_map = MakeShared<Map>(map_info, _open_drive_file);
     }
 
@@ -244,13 +250,96 @@ EpisodeProxy Simulator::GetCurrentEpisode() {
     return frame;
   }
 
+  std::shared_future<uint64_t> Simulator::TickAsync(
+      std::function<void(const std::shared_future<uint64_t> &)> callback) {
+    DEBUG_ASSERT(_episode != nullptr);
+
+    // 发出行人导航节拍
+    NavigationTick();
+
+    struct PendingTick {
+      std::mutex mutex;
+      boost::optional<uint64_t> frame;
+      uint64_t latest_frame = 0u;
+      bool done = false;
+      size_t callback_id = 0u;
+      std::weak_ptr<Episode> episode;
+      std::promise<uint64_t> promise;
+      std::shared_future<uint64_t> result;
+      std::function<void(const std::shared_future<uint64_t> &)> callback;
+
+      /// 在持有 mutex 时调用，结束等待并注销节拍回调。
+      void Finish(uint64_t value, std::exception_ptr error) {
+        done = true;
+        if (error == nullptr) {
+          carla::traffic_manager::TrafficManager::Tick();
+          promise.set_value(value);
+        } else {
+          promise.set_exception(error);
+        }
+        if (callback) {
+          callback(result);
+        }
+        auto locked = episode.lock();
+        if (locked != nullptr) {
+          locked->RemoveOnTickEvent(callback_id);
+        }
+      }
+    };
+    auto pending = std::make_shared<PendingTick>();
+    pending->callback = std::move(callback);
+    pending->episode = _episode;
+    pending->result = pending->promise.get_future().share();
+
+    // 先注册回调再发送节拍命令，否则该帧可能在注册之前就已到达。
+    // 回调只记录收到的帧，不等待节拍命令的响应。
+    {
+      std::lock_guard<std::mutex> lock(pending->mutex);
+      pending->callback_id = _episode->RegisterOnTickEvent([pending](WorldSnapshot snapshot) {
+        std::lock_guard<std::mutex> lock(pending->mutex);
+        if (pending->done) {
+          return;
+        }
+        pending->latest_frame = std::max(pending->latest_frame, snapshot.GetFrame());
+        if (pending->frame.has_value() && pending->latest_frame >= *pending->frame) {
+          pending->Finish(*pending->frame, nullptr);
+        }
+      });
+    }
+
+    // 节拍命令失败（超时或服务器报错）时不会有新帧到达，由单独的线程等待
+    // 响应并把异常交给 promise，否则返回的 future 永远不会就绪。
+    std::thread([pending, response=_client.SendTickCueAsync()]() mutable {
+      boost::optional<uint64_t> frame;
+      std::exception_ptr error;
+      try {
+        frame = response.get();
+      } catch (...) {
+        error = std::current_exception();
+      }
+      std::lock_guard<std::mutex> lock(pending->mutex);
+      if (pending->done) {
+        return;
+      }
+      if (error != nullptr) {
+        pending->Finish(0u, error);
+        return;
+      }
+      pending->frame = frame;
+      if (pending->latest_frame >= *frame) {
+        pending->Finish(*frame, nullptr);
+      }
+    }).detach();
+    return pending->result;
+  }
+
   // ===========================================================================
   // -- 在场景中访问全局对象 -----------------------------------------------------
   // ===========================================================================
   // 获取蓝图库对象
   SharedPtr<BlueprintLibrary> Simulator::GetBlueprintLibrary() {
-      // 获取 Actor 定义的列表
-    auto defs = _client.GetActorDefinitions();
+      // 获取 Actor 定义的列表，未变化时使用本地缓存
+    auto defs = _client.GetActorDefinitionsCached();
     // 返回一个智能指针，指向 BlueprintLibrary 对象，构造时传入定义的列表
     return MakeShared<BlueprintLibrary>(std::move(defs));
   }
@@ -290,6 +379,13 @@ EpisodeProxy Simulator::GetCurrentEpisode() {
             "Be very careful about that, the time deltas are not guaranteed.");
       }
     }
+    // 帧的时间间隔超过物理的最长时间时，物理模拟的时间比仿真时间短
+    if (settings.fixed_delta_seconds &&
+        settings.fixed_delta_seconds.get() > settings.max_physics_delta_time) {
+      log_warning(
+          "fixed_delta_seconds is greater than max_physics_delta_time. "
+          "Physics will only simulate max_physics_delta_time seconds each frame.");
+    }
     // 调用 _client 的 SetEpisodeSettings 方法，设置仿真环境的配置
     const auto frame = _client.SetEpisodeSettings(settings);
     // 同步当前帧与目标帧
@@ -348,6 +444,8 @@ EpisodeProxy Simulator::GetCurrentEpisode() {
     DEBUG_ASSERT(_episode != nullptr);
     auto nav = _episode->CreateNavigationIfMissing();
     nav->SetPedestriansCrossFactor(percentage);// 设置行人穿越系数
+    // 服务器上模拟的行人使用相同的系数
+    _client.SetServerPedestriansCrossFactor(percentage);
   }
 
   void Simulator::SetPedestriansSeed(unsigned int seed) {
@@ -432,6 +530,71 @@ EpisodeProxy Simulator::GetCurrentEpisode() {
           cb(std::move(data));
         });
   }
+
+  void Simulator::SubscribeToSensorLazy(
+      const Sensor &sensor,
+      std::function<void(SharedPtr<sensor::LazySensorData>)> callback) {
+    DEBUG_ASSERT(_episode != nullptr);
+    _client.SubscribeToStream(
+        sensor.GetActorDescription().GetStreamToken(),
+        [cb=std::move(callback), ep=WeakEpisodeProxy{shared_from_this()}](auto buffer) {
+          cb(MakeShared<sensor::LazySensorData>(std::move(buffer), ep));
+        });
+  }
+  // 录制流的接收状态，由订阅的回调和 Simulator 共享
+  struct Simulator::RecorderStream {
+    streaming::Token token;
+    std::function<void(Buffer)> callback;
+    // 下一条消息的数据在录制中应有的位置
+    uint64_t offset = 0u;
+    bool finished = false;
+    std::promise<void> end;
+  };
+
+  void Simulator::StartRecorderStream(
+      std::function<void(Buffer)> callback,
+      bool additional_data,
+      const rpc::RecorderFilter &filter) {
+    auto stream = std::make_shared<RecorderStream>();
+    stream->callback = std::move(callback);
+    stream->token = _client.StartRecorderStream(additional_data, filter);
+    // 服务器开始新的录制时已经停止了之前的录制
+    FinishRecorderStream();
+    // 每条消息以这条消息的数据在录制中的位置 (uint64) 开头，只有位置的消息表示录制结束
+    _client.SubscribeToRecorderStream(stream->token, [stream](Buffer message) {
+      uint64_t offset = 0u;
+      if (stream->finished || message.size() < sizeof(offset)) {
+        return;
+      }
+      std::memcpy(&offset, message.data(), sizeof(offset));
+      const auto size = message.size() - sizeof(offset);
+      if (size == 0u) {
+        stream->finished = true;
+        stream->end.set_value();
+        return;
+      }
+      if (offset != stream->offset) {
+        log_error("recorder stream: lost", offset - stream->offset, "bytes at offset", stream->offset);
+      }
+      stream->offset = offset + size;
+      stream->callback(Buffer(message.data() + sizeof(offset), size));
+    });
+    _recorder_stream = std::move(stream);
+  }
+
+  void Simulator::FinishRecorderStream() {
+    if (_recorder_stream == nullptr) {
+      return;
+    }
+    auto stream = std::move(_recorder_stream);
+    _recorder_stream = nullptr;
+    auto end = stream->end.get_future();
+    if (end.wait_for(_client.GetTimeout().to_chrono()) != std::future_status::ready) {
+      log_warning("recorder stream: the end of the recording was not received");
+    }
+    _client.UnSubscribeFromStream(stream->token);
+  }
+
   // 取消订阅传感器的数据
   void Simulator::UnSubscribeFromSensor(Actor &sensor) {
     _client.UnSubscribeFromStream(sensor.GetActorDescription().GetStreamToken());
@@ -466,6 +629,23 @@ EpisodeProxy Simulator::GetCurrentEpisode() {
     _client.UnSubscribeFromGBuffer(actor.GetId(), gbuffer_id);
   }
 
+  // 订阅打包的GBuffer纹理
+  void Simulator::SubscribeToGBuffers(
+      Actor &actor,
+      uint64_t texture_mask,
+      std::function<void(SharedPtr<sensor::SensorData>)> callback) {
+    _client.SubscribeToGBuffers(actor.GetId(), texture_mask,
+        [cb=std::move(callback), ep=WeakEpisodeProxy{shared_from_this()}](auto buffer) {
+          auto data = sensor::Deserializer::Deserialize(std::move(buffer));
+          data->_episode = ep.TryLock();
+          cb(std::move(data));
+        });
+  }
+  // 取消订阅打包的GBuffer纹理
+  void Simulator::UnSubscribeFromGBuffers(Actor &actor) {
+    _client.UnSubscribeFromGBuffers(actor.GetId());
+  }
+
   // 冻结或解冻所有交通信号灯
   void Simulator::FreezeAllTrafficLights(bool frozen) {
     _client.FreezeAllTrafficLights(frozen);// 传递冻结状态给客户端
@@ -22,7 +22,10 @@
 #include "carla/client/detail/Episode.h"
 #include "carla/client/detail/EpisodeProxy.h"
 #include "carla/profiler/LifetimeProfiled.h"
+#include "carla/rpc/SignTriggerEvent.h"
+#include "carla/rpc/TrafficLightPlan.h"
 #include "carla/rpc/TrafficLightState.h"
+#include "carla/rpc/WalkerBonePoses.h"
 #include "carla/rpc/VehicleLightStateList.h"
 #include "carla/rpc/LabelledPoint.h"
 #include "carla/rpc/VehicleWheels.h"
@@ -34,6 +37,9 @@
 #include <memory>
 
 namespace carla {
+namespace sensor {
+  class LazySensorData;
+} // namespace sensor
 namespace client {
 
   class ActorBlueprint;
@@ -75,6 +81,10 @@ namespace detail {
 
     // 根据地图名和可选的重置设置以及地图层来加载一个场景
     EpisodeProxy LoadEpisode(std::string map_name, bool reset_settings = true, rpc::MapLayer map_layers = rpc::MapLayer::All);
+    // 在服务器后台预加载地图的资源，之后加载这张地图时更快
+    bool PreloadMap(std::string map_name) {
+      return _client.PreloadMap(std::move(map_name));
+    }
     // 加载指定的地图层
     void LoadLevelLayer(rpc::MapLayer map_layers) const {
       _client.LoadLevelLayer(map_layers);
@@ -147,6 +157,11 @@ namespace detail {
       return _client.GetAvailableMaps();
     }
 
+    // 获取多GPU模式下每个次级服务器的状态和耗时统计
+    std::vector<rpc::SecondaryTelemetry> GetSecondaryTelemetry() {
+      return _client.GetSecondaryTelemetry();
+    }
+
     /// @}
     // =========================================================================
     /// @name 所需文件相关的方法
@@ -189,6 +204,15 @@ namespace detail {
     time_duration GetNetworkingTimeout() {
       return _client.GetTimeout();// 获取客户端的超时时间
     }
+
+    // 设置之后订阅的传感器流的信用
+    void SetSensorCredits(uint32_t credits) {
+      _client.SetSensorCredits(credits);
+    }
+    // 设置之后订阅的传感器流是否共用到每个服务器的一个连接
+    void SetSensorMultiplexing(bool enable) {
+      _client.SetSensorMultiplexing(enable);
+    }
     // 获取客户端版本
     std::string GetClientVersion() {
       return _client.GetClientVersion();// 从客户端获取版本信息
@@ -219,6 +243,14 @@ namespace detail {
     // 执行一个节拍（模拟时间步），返回该时间步的模拟时间（通常以微秒为单位）
     uint64_t Tick(time_duration timeout);
 
+    /// 发送节拍命令后立即返回，不阻塞调用线程。
+    ///
+    /// 收到该帧的剧集状态时返回的future兑现为帧号，发送失败时保存相应的异常。
+    /// 之后在流的回调线程中以该future调用 @a callback （可以为空）。
+    /// 在此之前切换剧集时不调用 @a callback，future抛出 std::future_error。
+    std::shared_future<uint64_t> TickAsync(
+        std::function<void(const std::shared_future<uint64_t> &)> callback = {});
+
     /// @}
     // =========================================================================
     /// @name 访问场景中的全局对象
@@ -268,6 +300,18 @@ namespace detail {
       return _client.GetEpisodeSettings();
     }
 
+    /// 之后只接收 @a interest 中参与者的状态，世界快照中不再包含其他参与者。
+    void SetEpisodeInterest(const rpc::EpisodeInterest &interest) {
+      GetReadyCurrentEpisode();
+      _episode->SetStreamToken(_client.GetEpisodeInterestToken(interest));
+    }
+
+    /// 恢复接收所有参与者的状态。
+    void ClearEpisodeInterest() {
+      GetReadyCurrentEpisode();
+      _episode->SetStreamToken(_client.GetEpisodeInfo().token);
+    }
+
     uint64_t SetEpisodeSettings(const rpc::EpisodeSettings &settings);
 
     rpc::WeatherParameters GetWeatherParameters() {
@@ -296,8 +340,15 @@ namespace detail {
         // 调用客户端的GetVehiclePhysicsControl方法，传入车辆的ID，返回车辆的物理控制状态
       return _client.GetVehiclePhysicsControl(vehicle.GetId());
     }
-    // 获取指定车辆的灯光状态
+    // 获取指定车辆的灯光状态，剧集状态中有该车辆的扩展数据时不再请求服务器
     rpc::VehicleLightState GetVehicleLightState(const Vehicle &vehicle) const {
+      if (_episode != nullptr) {
+        const auto state = _episode->GetState();
+        const auto *extension = state->GetActorExtension(vehicle.GetId());
+        if (extension != nullptr) {
+          return rpc::VehicleLightState(extension->vehicle_light_state);
+        }
+      }
       return _client.GetVehicleLightState(vehicle.GetId());
     }
 
@@ -351,6 +402,27 @@ namespace detail {
     // 设置行人行为的随机种子，可能影响行人生成或路径选择的随机性
     void SetPedestriansSeed(unsigned int seed);
 
+    // 服务器上模拟的行人（AI 控制器的 simulate_on_server 属性为 true）
+    void StartServerWalker(ActorId walker) {
+      _client.StartServerWalker(walker);
+    }
+
+    void StopServerWalker(ActorId walker) {
+      _client.StopServerWalker(walker);
+    }
+
+    bool SetServerWalkerTarget(ActorId walker, const geom::Location &target) {
+      return _client.SetServerWalkerTarget(walker, target);
+    }
+
+    bool SetServerWalkerMaxSpeed(ActorId walker, float max_speed) {
+      return _client.SetServerWalkerMaxSpeed(walker, max_speed);
+    }
+
+    boost::optional<geom::Location> GetServerWalkerRandomLocation() {
+      return _client.GetServerWalkerRandomLocation();
+    }
+
     /// @}
     // =========================================================================
     /// @name 参与者的一般操作
@@ -363,12 +435,24 @@ namespace detail {
       return _episode->GetActorById(id);
     }
     /// 根据一组演员ID获取对应的演员信息
-    std::vector<rpc::Actor> GetActorsById(const std::vector<ActorId> &actor_ids) const {
+    std::vector<SharedPtr<const rpc::Actor>> GetActorsById(const std::vector<ActorId> &actor_ids) const {
       DEBUG_ASSERT(_episode != nullptr);
       return _episode->GetActorsById(actor_ids);
     }
+
+    std::future<std::vector<SharedPtr<const rpc::Actor>>> GetActorsByIdAsync(const std::vector<ActorId> &actor_ids) const {
+      DEBUG_ASSERT(_episode != nullptr);
+      return _episode->GetActorsByIdAsync(actor_ids);
+    }
+
+    /// 一次调用按列获取多个参与者的属性
+    rpc::ActorQueryResult QueryActors(
+        const std::vector<ActorId> &actor_ids,
+        const std::vector<std::string> &fields) {
+      return _client.QueryActors(actor_ids, fields);
+    }
     /// 获取当前 episode 中所有的演员信息
-    std::vector<rpc::Actor> GetAllTheActorsInTheEpisode() const {
+    std::vector<SharedPtr<const rpc::Actor>> GetAllTheActorsInTheEpisode() const {
       DEBUG_ASSERT(_episode != nullptr);
       return _episode->GetActors();
     }
@@ -608,6 +692,16 @@ namespace detail {
     void GetPoseFromAnimation(Walker &walker) {
       return _client.GetPoseFromAnimation(walker.GetId());
     }
+    // 一次调用设置多个Walker的骨骼姿态
+    std::vector<rpc::ActorId> SetWalkersBonesTransform(const rpc::WalkerBonePoses &poses) {
+      return _client.SetWalkersBonesTransform(poses);
+    }
+    // 一次调用获取多个Walker的骨骼姿态
+    rpc::WalkerBonePoses GetWalkersBonesTransform(
+        const std::vector<rpc::ActorId> &walkers,
+        const std::vector<std::string> &bone_names) {
+      return _client.GetWalkersBonesTransform(walkers, bone_names);
+    }
     // 应用物理控制到指定车辆
     void ApplyPhysicsControlToVehicle(Vehicle &vehicle, const rpc::VehiclePhysicsControl &physicsControl) {
       _client.ApplyPhysicsControlToVehicle(vehicle.GetId(), physicsControl);
@@ -628,8 +722,16 @@ namespace detail {
     void SetWheelSteerDirection(Vehicle &vehicle, rpc::VehicleWheelLocation wheel_location, float angle_in_deg) {
       _client.SetWheelSteerDirection(vehicle.GetId(), wheel_location, angle_in_deg);
     }
-    // 获取指定车辆的车轮当前转向角度
+    // 获取指定车辆的车轮当前转向角度，剧集状态中有该车辆的扩展数据时不再请求服务器
     float GetWheelSteerAngle(Vehicle &vehicle, rpc::VehicleWheelLocation wheel_location) {
+      const auto wheel = static_cast<size_t>(wheel_location);
+      if ((_episode != nullptr) && (wheel < 4u)) {
+        const auto state = _episode->GetState();
+        const auto *extension = state->GetActorExtension(vehicle.GetId());
+        if (extension != nullptr) {
+          return extension->wheel_steer_angles[wheel];
+        }
+      }
       return _client.GetWheelSteerAngle(vehicle.GetId(), wheel_location);
     }
    // 车辆物理仿真与车辆部件操作
@@ -673,11 +775,32 @@ namespace detail {
      // _client对象调用StartRecorder方法来启动录制。
     // additional_data: 是否记录额外的数据，控制录制的详细程度。
     // 使用std::move()转移name的所有权，提高效率。
-      return _client.StartRecorder(std::move(name), additional_data);
+      auto result = _client.StartRecorder(std::move(name), additional_data);
+      FinishRecorderStream();
+      return result;
     }
+
+    // 启动录制器，只录制过滤器选中的参与者和数据包
+    std::string StartRecorder(
+        std::string name,
+        bool additional_data,
+        const rpc::RecorderFilter &filter) {
+      auto result = _client.StartRecorder(std::move(name), additional_data, filter);
+      FinishRecorderStream();
+      return result;
+    }
+
+    // 启动录制器，录制的数据不写入服务器上的文件，而是按顺序交给 callback，
+    // 拼接起来与录制文件的内容相同
+    void StartRecorderStream(
+        std::function<void(Buffer)> callback,
+        bool additional_data,
+        const rpc::RecorderFilter &filter);
+
     // 停止录制器
     void StopRecorder(void) {
       _client.StopRecorder();
+      FinishRecorderStream();
     }
     // 显示录制文件的相关信息
     std::string ShowRecorderFileInfo(std::string name, bool show_all) {
@@ -697,6 +820,10 @@ namespace detail {
         uint32_t follow_id, bool replay_sensors) {
       return _client.ReplayFile(std::move(name), start, duration, follow_id, replay_sensors);
     }
+    // 以最快速度回放文件，返回性能统计和位置校验结果
+    std::string BenchmarkReplayer(std::string name, double tolerance) {
+      return _client.BenchmarkReplayer(std::move(name), tolerance);
+    }
     // 设置回放器的时间比例因子
     void SetReplayerTimeFactor(double time_factor) {
         // time_factor: 时间比例因子，控制回放速度。
@@ -728,6 +855,11 @@ namespace detail {
     // callback: 回调函数，当传感器数据更新时会被调用，传入数据指针。
     // SharedPtr是智能指针，用于共享传感器数据的所有权，防止内存泄漏。
 
+    // 订阅传感器数据，消息在回调调用 LazySensorData::Get 时才反序列化
+    void SubscribeToSensorLazy(
+        const Sensor &sensor,
+        std::function<void(SharedPtr<sensor::LazySensorData>)> callback);
+
     // 取消订阅传感器数据
     void UnSubscribeFromSensor(Actor &sensor);
 
@@ -751,6 +883,15 @@ namespace detail {
         Actor & sensor,
         uint32_t gbuffer_id);
 
+    // 订阅打包在一条消息中的多个GBuffer纹理，texture_mask 的第 i 位对应ID为 i 的纹理
+    void SubscribeToGBuffers(
+        Actor & sensor,
+        uint64_t texture_mask,
+        std::function<void(SharedPtr<sensor::SensorData>)> callback);
+
+    // 取消订阅打包的GBuffer纹理
+    void UnSubscribeFromGBuffers(Actor & sensor);
+
     // 向传感器发送消息
     void Send(const Sensor &sensor, std::string message);        
 
@@ -808,6 +949,15 @@ namespace detail {
       _client.DrawDebugShape(shape);
     }
 
+    /// 按 id 替换这个客户端之前绘制的持久调试形状
+    void DrawDebugShapeBatches(const std::vector<rpc::DebugShapeBatch> &batches) {
+      _client.DrawDebugShapeBatches(batches);
+    }
+
+    void ClearDebugShapeBatches() {
+      _client.ClearDebugShapeBatches();
+    }
+
     /// @}
     // =========================================================================
     /// @name Apply commands in batch
@@ -824,6 +974,34 @@ namespace detail {
       return _client.ApplyBatchSync(std::move(commands), do_tick_cue);
     }
 
+    uint64_t SpawnBatch(std::vector<rpc::Command> commands, double time_budget) {
+      return _client.SpawnBatch(std::move(commands), time_budget);
+    }
+
+    rpc::SpawnBatchStatus GetSpawnBatchStatus(uint64_t ticket) {
+      return _client.GetSpawnBatchStatus(ticket);
+    }
+
+    void SetActorPoolSize(uint32_t size) {
+      _client.SetActorPoolSize(size);
+    }
+
+    uint64_t SaveSnapshot() {
+      return _client.SaveSnapshot();
+    }
+
+    void RestoreSnapshot(uint64_t snapshot_id) {
+      _client.RestoreSnapshot(snapshot_id);
+    }
+
+    bool RemoveSnapshot(uint64_t snapshot_id) {
+      return _client.RemoveSnapshot(snapshot_id);
+    }
+
+    rpc::ServerProfile GetServerProfile(bool reset) {
+      return _client.GetServerProfile(reset);
+    }
+
     /// @}
     // =========================================================================
     /// @name 操作灯
@@ -841,6 +1019,11 @@ namespace detail {
       // 向服务器查询当前所有灯光的状态并返回
     }
 
+    rpc::LightStateChanges QueryLightsStateChangesToServer(uint64_t since_version) const {
+      // 只查询 since_version 之后改变的灯光
+      return _client.QueryLightsStateChangesToServer(since_version);
+    }
+
     // 更新服务器上的灯光状态
     void UpdateServerLightsState(
         std::vector<rpc::LightState>& lights,
@@ -866,6 +1049,16 @@ namespace detail {
     // 冻结或解冻所有交通灯
     void FreezeAllTrafficLights(bool frozen);
 
+    // 在同一帧开始前应用多个交通灯组的配时方案
+    void ApplyTrafficLightPlans(const std::vector<rpc::TrafficLightGroupPlan> &plans) {
+      _client.ApplyTrafficLightPlans(plans);
+    }
+
+    // 上一帧车辆进入和离开交通标志触发框的事件
+    std::vector<rpc::SignTriggerEvent> GetSignTriggerEvents() const {
+      return _client.GetSignTriggerEvents();
+    }
+
     /// @}
     // =========================================================================
     /// @name 纹理更新操作
@@ -893,6 +1086,11 @@ namespace detail {
       // 判断是否需要更新地图
     bool ShouldUpdateMap(rpc::MapInfo& map_info);
 
+    struct RecorderStream;
+
+    // 等待录制流的最后一条消息（服务器停止录制后发送），然后取消订阅
+    void FinishRecorderStream();
+
     // 客户端对象，负责与服务器交互
     Client _client;
 
@@ -910,6 +1108,9 @@ namespace detail {
 
     // 存储打开的道路文件
     std::string _open_drive_file;
+
+    // 正在接收的录制流，没有时为nullptr
+    std::shared_ptr<RecorderStream> _recorder_stream;
   };
 
 } // namespace detail
@@ -110,11 +110,11 @@ namespace detail {
     // 获取情节中的所有车辆
     for (auto &&actor : episode->GetActors()) {
       // 仅限车辆
-      if (actor.description.id.rfind("vehicle.", 0) == 0) {
+      if (actor->description.id.rfind("vehicle.", 0) == 0) {
         // 获取快照
-        ActorSnapshot snapshot = state->GetActorSnapshot(actor.id);
+        ActorSnapshot snapshot = state->GetActorSnapshot(actor->id);
         // 添加到向量
-        vehicles.emplace_back(carla::nav::VehicleCollisionInfo{actor.id, snapshot.transform, actor.bounding_box});
+        vehicles.emplace_back(carla::nav::VehicleCollisionInfo{actor->id, snapshot.transform, actor->bounding_box});
       }
     }
 
@@ -123,65 +123,67 @@ namespace detail {
 
     // 可选的调试信息
     if (show_debug) {
-      if (_nav.GetCrowd() == nullptr) return;
-
-      // 绘制边界框以进行调试
-      for (int i = 0; i < _nav.GetCrowd()->getAgentCount(); ++i) {
-        // 获取代理
-        const dtCrowdAgent *agent = _nav.GetCrowd()->getAgent(i);
-        if (agent && agent->params.useObb) {
-          // 为了调试进行绘制
-          carla::geom::Location p1, p2, p3, p4;
-          p1.x = agent->params.obb[0];
-          p1.z = agent->params.obb[1];
-          p1.y = agent->params.obb[2];
-          p2.x = agent->params.obb[3];
-          p2.z = agent->params.obb[4];
-          p2.y = agent->params.obb[5];
-          p3.x = agent->params.obb[6];
-          p3.z = agent->params.obb[7];
-          p3.y = agent->params.obb[8];
-          p4.x = agent->params.obb[9];
-          p4.z = agent->params.obb[10];
-          p4.y = agent->params.obb[11];
-          carla::rpc::DebugShape line1;
-          line1.life_time = 0.01f;
-          line1.persistent_lines = false;
-          // line 1
-          line1.primitive = carla::rpc::DebugShape::Line {p1, p2, 0.2f};
-          line1.color = { 0, 255, 0 };
-          _simulator.lock()->DrawDebugShape(line1);
-          // line 2
-          line1.primitive = carla::rpc::DebugShape::Line {p2, p3, 0.2f};
-          line1.color = { 255, 0, 0 };
-          _simulator.lock()->DrawDebugShape(line1);
-          // line 3
-          line1.primitive = carla::rpc::DebugShape::Line {p3, p4, 0.2f};
-          line1.color = { 0, 0, 255 };
-          _simulator.lock()->DrawDebugShape(line1);
-          // line 4
-          line1.primitive = carla::rpc::DebugShape::Line {p4, p1, 0.2f};
-          line1.color = { 255, 255, 0 };
-          _simulator.lock()->DrawDebugShape(line1);
+      for (size_t group = 0; group < _nav.GetCrowdCount(); ++group) {
+        dtCrowd *crowd = _nav.GetCrowd(group);
+
+        // 绘制边界框以进行调试
+        for (int i = 0; i < crowd->getAgentCount(); ++i) {
+          // 获取代理
+          const dtCrowdAgent *agent = crowd->getAgent(i);
+          if (agent && agent->params.useObb) {
+            // 为了调试进行绘制
+            carla::geom::Location p1, p2, p3, p4;
+            p1.x = agent->params.obb[0];
+            p1.z = agent->params.obb[1];
+            p1.y = agent->params.obb[2];
+            p2.x = agent->params.obb[3];
+            p2.z = agent->params.obb[4];
+            p2.y = agent->params.obb[5];
+            p3.x = agent->params.obb[6];
+            p3.z = agent->params.obb[7];
+            p3.y = agent->params.obb[8];
+            p4.x = agent->params.obb[9];
+            p4.z = agent->params.obb[10];
+            p4.y = agent->params.obb[11];
+            carla::rpc::DebugShape line1;
+            line1.life_time = 0.01f;
+            line1.persistent_lines = false;
+            // line 1
+            line1.primitive = carla::rpc::DebugShape::Line {p1, p2, 0.2f};
+            line1.color = { 0, 255, 0 };
+            _simulator.lock()->DrawDebugShape(line1);
+            // line 2
+            line1.primitive = carla::rpc::DebugShape::Line {p2, p3, 0.2f};
+            line1.color = { 255, 0, 0 };
+            _simulator.lock()->DrawDebugShape(line1);
+            // line 3
+            line1.primitive = carla::rpc::DebugShape::Line {p3, p4, 0.2f};
+            line1.color = { 0, 0, 255 };
+            _simulator.lock()->DrawDebugShape(line1);
+            // line 4
+            line1.primitive = carla::rpc::DebugShape::Line {p4, p1, 0.2f};
+            line1.color = { 255, 255, 0 };
+            _simulator.lock()->DrawDebugShape(line1);
+          }
         }
-      }
 
-      // 为了调试绘制一些文本
-      for (int i = 0; i < _nav.GetCrowd()->getAgentCount(); ++i) {
-        // 获得智能体
-        const dtCrowdAgent *agent = _nav.GetCrowd()->getAgent(i);
-        if (agent) {
-          // 为了调试进行绘制
-          carla::geom::Location p1(agent->npos[0], agent->npos[2], agent->npos[1] + 1);
-          if (agent->params.userData) {
-            std::ostringstream out;
-            out << *(reinterpret_cast<const float *>(agent->params.userData));
-            carla::rpc::DebugShape text;
-            text.life_time = 0.01f;
-            text.persistent_lines = false;
-            text.primitive = carla::rpc::DebugShape::String {p1, out.str(), false};
-            text.color = { 0, 255, 0 };
-            _simulator.lock()->DrawDebugShape(text);
+        // 为了调试绘制一些文本
+        for (int i = 0; i < crowd->getAgentCount(); ++i) {
+          // 获得智能体
+          const dtCrowdAgent *agent = crowd->getAgent(i);
+          if (agent) {
+            // 为了调试进行绘制
+            carla::geom::Location p1(agent->npos[0], agent->npos[2], agent->npos[1] + 1);
+            if (agent->params.userData) {
+              std::ostringstream out;
+              out << *(reinterpret_cast<const float *>(agent->params.userData));
+              carla::rpc::DebugShape text;
+              text.life_time = 0.01f;
+              text.persistent_lines = false;
+              text.primitive = carla::rpc::DebugShape::String {p1, out.str(), false};
+              text.color = { 0, 255, 0 };
+              _simulator.lock()->DrawDebugShape(text);
+            }
           }
         }
       }
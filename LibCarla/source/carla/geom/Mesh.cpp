@@ -12,8 +12,17 @@
 #include <iostream>
 #include <fstream>
 
+#include <carla/Exception.h>
 #include <carla/geom/Math.h>
 
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <unordered_map>
+
 namespace carla {
 namespace geom {
 
@@ -196,5 +205,361 @@ namespace geom {
 
     return out.str();
   }
+  // ===========================================================================
+  // -- 优化 -------------------------------------------------------------------
+  // ===========================================================================
+
+  namespace {
+
+    // 顶点的合并键：位置、纹理坐标和法线的位表示（或量化后的值）
+    struct WeldKey {
+      std::array<uint32_t, 8u> values;
+
+      bool operator==(const WeldKey &rhs) const {
+        return values == rhs.values;
+      }
+    };
+
+    struct WeldKeyHash {
+      size_t operator()(const WeldKey &key) const {
+        uint64_t hash = 14695981039346656037ull;
+        for (auto value : key.values) {
+          hash ^= value;
+          hash *= 1099511628211ull;
+        }
+        return static_cast<size_t>(hash);
+      }
+    };
+
+    uint32_t FloatKey(float value, float tolerance) {
+      if (tolerance > 0.0f) {
+        return static_cast<uint32_t>(static_cast<int32_t>(std::lround(value / tolerance)));
+      }
+      if (value == 0.0f) {
+        value = 0.0f; // 把 -0.0 和 0.0 视为相同
+      }
+      uint32_t bits;
+      std::memcpy(&bits, &value, sizeof(bits));
+      return bits;
+    }
+
+    // Forsyth线性时间顶点缓存优化使用的参数
+    constexpr int FORSYTH_CACHE_SIZE = 32;
+    constexpr float FORSYTH_CACHE_DECAY_POWER = 1.5f;
+    constexpr float FORSYTH_LAST_TRI_SCORE = 0.75f;
+    constexpr float FORSYTH_VALENCE_BOOST_SCALE = 2.0f;
+    constexpr float FORSYTH_VALENCE_BOOST_POWER = 0.5f;
+
+    float ForsythVertexScore(int cache_position, int remaining_valence) {
+      if (remaining_valence <= 0) {
+        return -1.0f; // 不再被任何三角形使用
+      }
+      float score = 0.0f;
+      if (cache_position >= 0) {
+        if (cache_position < 3) {
+          score = FORSYTH_LAST_TRI_SCORE; // 刚刚使用过的三个顶点得分固定
+        } else {
+          const float scaler = 1.0f / (FORSYTH_CACHE_SIZE - 3);
+          score = std::pow(1.0f - (cache_position - 3) * scaler, FORSYTH_CACHE_DECAY_POWER);
+        }
+      }
+      score += FORSYTH_VALENCE_BOOST_SCALE *
+          std::pow(static_cast<float>(remaining_valence), -FORSYTH_VALENCE_BOOST_POWER);
+      return score;
+    }
+
+    // 对 indexes[begin, end) 中的三角形重新排序，索引值为从1开始的顶点编号
+    void ForsythOptimize(std::vector<Mesh::index_type> &indexes, size_t begin, size_t end) {
+      const size_t triangle_count = (end - begin) / 3u;
+      if (triangle_count < 2u) {
+        return;
+      }
+      // 把范围内用到的顶点映射为局部编号
+      std::unordered_map<Mesh::index_type, uint32_t> local_ids;
+      std::vector<uint32_t> triangles(3u * triangle_count);
+      for (size_t i = 0u; i < triangles.size(); ++i) {
+        const auto result = local_ids.emplace(indexes[begin + i], static_cast<uint32_t>(local_ids.size()));
+        triangles[i] = result.first->second;
+      }
+      const size_t vertex_count = local_ids.size();
+      std::vector<Mesh::index_type> global_ids(vertex_count);
+      for (const auto &pair : local_ids) {
+        global_ids[pair.second] = pair.first;
+      }
+
+      // 每个顶点相邻的三角形（CSR格式），剩余的相邻三角形放在每段的前面
+      std::vector<int> valence(vertex_count, 0);
+      for (const auto vertex : triangles) {
+        ++valence[vertex];
+      }
+      std::vector<uint32_t> offsets(vertex_count + 1u, 0u);
+      for (size_t v = 0u; v < vertex_count; ++v) {
+        offsets[v + 1u] = offsets[v] + static_cast<uint32_t>(valence[v]);
+      }
+      std::vector<uint32_t> adjacency(offsets.back());
+      {
+        std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+        for (uint32_t t = 0u; t < triangle_count; ++t) {
+          for (size_t k = 0u; k < 3u; ++k) {
+            adjacency[fill[triangles[3u * t + k]]++] = t;
+          }
+        }
+      }
+
+      std::vector<int> cache_position(vertex_count, -1);
+      std::vector<float> vertex_score(vertex_count);
+      for (size_t v = 0u; v < vertex_count; ++v) {
+        vertex_score[v] = ForsythVertexScore(-1, valence[v]);
+      }
+      std::vector<float> triangle_score(triangle_count);
+      for (size_t t = 0u; t < triangle_count; ++t) {
+        triangle_score[t] =
+            vertex_score[triangles[3u * t]] +
+            vertex_score[triangles[3u * t + 1u]] +
+            vertex_score[triangles[3u * t + 2u]];
+      }
+      std::vector<bool> emitted(triangle_count, false);
+
+      std::vector<uint32_t> cache;
+      cache.reserve(FORSYTH_CACHE_SIZE + 3);
+      std::vector<uint32_t> new_cache;
+      new_cache.reserve(FORSYTH_CACHE_SIZE + 3);
+
+      std::vector<Mesh::index_type> output;
+      output.reserve(end - begin);
+      size_t cursor = 0u;
+      int64_t best = 0;
+      for (size_t emitted_count = 0u; emitted_count < triangle_count; ++emitted_count) {
+        if (best < 0) {
+          // 缓存中的顶点没有剩余三角形，取下一个未输出的三角形
+          while (emitted[cursor]) {
+            ++cursor;
+          }
+          best = static_cast<int64_t>(cursor);
+        }
+        const auto t = static_cast<uint32_t>(best);
+        emitted[t] = true;
+
+        // 输出三角形并把它从相邻列表中移除
+        new_cache.clear();
+        for (size_t k = 0u; k < 3u; ++k) {
+          const auto v = triangles[3u * t + k];
+          output.push_back(global_ids[v]);
+          new_cache.push_back(v);
+          auto *list = &adjacency[offsets[v]];
+          const auto count = static_cast<size_t>(valence[v]);
+          for (size_t j = 0u; j < count; ++j) {
+            if (list[j] == t) {
+              std::swap(list[j], list[count - 1u]);
+              break;
+            }
+          }
+          --valence[v];
+        }
+
+        // 更新模拟的顶点缓存
+        for (const auto v : cache) {
+          if (v != new_cache[0u] && v != new_cache[1u] && v != new_cache[2u]) {
+            new_cache.push_back(v);
+          }
+        }
+        for (size_t i = 0u; i < new_cache.size(); ++i) {
+          cache_position[new_cache[i]] = i < FORSYTH_CACHE_SIZE ? static_cast<int>(i) : -1;
+        }
+
+        // 重新计算受影响的顶点和三角形得分，同时找出下一个最佳三角形
+        best = -1;
+        float best_score = -1.0f;
+        for (const auto v : new_cache) {
+          const float score = ForsythVertexScore(cache_position[v], valence[v]);
+          const float delta = score - vertex_score[v];
+          vertex_score[v] = score;
+          const auto *list = &adjacency[offsets[v]];
+          for (int j = 0; j < valence[v]; ++j) {
+            const auto other = list[j];
+            triangle_score[other] += delta;
+            if (triangle_score[other] > best_score) {
+              best_score = triangle_score[other];
+              best = other;
+            }
+          }
+        }
+        if (new_cache.size() > FORSYTH_CACHE_SIZE) {
+          new_cache.resize(FORSYTH_CACHE_SIZE);
+        }
+        std::swap(cache, new_cache);
+      }
+      std::copy(output.begin(), output.end(), indexes.begin() + static_cast<std::ptrdiff_t>(begin));
+    }
+
+  } // namespace
+
+  size_t Mesh::WeldVertices(const float tolerance) {
+    const size_t vertex_count = _vertices.size();
+    const bool has_uvs = _uvs.size() == vertex_count;
+    const bool has_normals = _normals.size() == vertex_count;
+
+    std::unordered_map<WeldKey, index_type, WeldKeyHash> unique;
+    unique.reserve(vertex_count);
+    std::vector<index_type> remap(vertex_count);
+    std::vector<vertex_type> vertices;
+    std::vector<uv_type> uvs;
+    std::vector<normal_type> normals;
+    vertices.reserve(vertex_count);
+    for (size_t i = 0u; i < vertex_count; ++i) {
+      WeldKey key{};
+      key.values[0u] = FloatKey(_vertices[i].x, tolerance);
+      key.values[1u] = FloatKey(_vertices[i].y, tolerance);
+      key.values[2u] = FloatKey(_vertices[i].z, tolerance);
+      if (has_uvs) {
+        key.values[3u] = FloatKey(_uvs[i].x, 0.0f);
+        key.values[4u] = FloatKey(_uvs[i].y, 0.0f);
+      }
+      if (has_normals) {
+        key.values[5u] = FloatKey(_normals[i].x, 0.0f);
+        key.values[6u] = FloatKey(_normals[i].y, 0.0f);
+        key.values[7u] = FloatKey(_normals[i].z, 0.0f);
+      }
+      const auto result = unique.emplace(key, vertices.size());
+      if (result.second) {
+        vertices.push_back(_vertices[i]);
+        if (has_uvs) {
+          uvs.push_back(_uvs[i]);
+        }
+        if (has_normals) {
+          normals.push_back(_normals[i]);
+        }
+      }
+      remap[i] = result.first->second;
+    }
+    const size_t removed = vertex_count - vertices.size();
+    if (removed == 0u) {
+      return 0u;
+    }
+
+    // 重新映射索引（从1开始）并删除退化的三角形，同时调整材质的索引范围
+    std::vector<index_type> kept_before(_indexes.size() + 1u, 0u);
+    std::vector<index_type> indexes;
+    indexes.reserve(_indexes.size());
+    for (size_t i = 0u; i + 2u < _indexes.size(); i += 3u) {
+      const auto a = remap[_indexes[i] - 1u] + 1u;
+      const auto b = remap[_indexes[i + 1u] - 1u] + 1u;
+      const auto c = remap[_indexes[i + 2u] - 1u] + 1u;
+      for (size_t k = 0u; k < 3u; ++k) {
+        kept_before[i + k] = indexes.size();
+      }
+      if (a != b && b != c && a != c) {
+        indexes.push_back(a);
+        indexes.push_back(b);
+        indexes.push_back(c);
+      }
+    }
+    kept_before[_indexes.size()] = indexes.size();
+    for (auto &material : _materials) {
+      material.index_start = kept_before[std::min(material.index_start, _indexes.size())];
+      if (material.index_end != 0u) {
+        material.index_end = kept_before[std::min(material.index_end, _indexes.size())];
+      }
+    }
+
+    _vertices = std::move(vertices);
+    _indexes = std::move(indexes);
+    if (has_uvs) {
+      _uvs = std::move(uvs);
+    }
+    if (has_normals) {
+      _normals = std::move(normals);
+    }
+    return removed;
+  }
+
+  void Mesh::OptimizeTriangleOrder() {
+    const size_t index_count = _indexes.size() - _indexes.size() % 3u;
+    if (_materials.empty()) {
+      ForsythOptimize(_indexes, 0u, index_count);
+      return;
+    }
+    // 材质之间以及材质之外的三角形各自排序，保持材质的范围不变
+    size_t position = 0u;
+    for (const auto &material : _materials) {
+      const size_t start = std::min(material.index_start, index_count);
+      const size_t end = material.index_end == 0u ? index_count : std::min(material.index_end, index_count);
+      if (position < start) {
+        ForsythOptimize(_indexes, position, start);
+      }
+      if (start < end) {
+        ForsythOptimize(_indexes, start, end);
+      }
+      position = std::max(position, end);
+    }
+    if (position < index_count) {
+      ForsythOptimize(_indexes, position, index_count);
+    }
+  }
+
+  void Mesh::OptimizeVertexOrder() {
+    const size_t vertex_count = _vertices.size();
+    const bool has_uvs = _uvs.size() == vertex_count;
+    const bool has_normals = _normals.size() == vertex_count;
+    constexpr auto unassigned = std::numeric_limits<index_type>::max();
+    std::vector<index_type> remap(vertex_count, unassigned);
+    std::vector<vertex_type> vertices;
+    std::vector<uv_type> uvs;
+    std::vector<normal_type> normals;
+    vertices.reserve(vertex_count);
+    for (auto &index : _indexes) {
+      auto &target = remap[index - 1u];
+      if (target == unassigned) {
+        target = vertices.size();
+        vertices.push_back(_vertices[index - 1u]);
+        if (has_uvs) {
+          uvs.push_back(_uvs[index - 1u]);
+        }
+        if (has_normals) {
+          normals.push_back(_normals[index - 1u]);
+        }
+      }
+      index = target + 1u;
+    }
+    _vertices = std::move(vertices);
+    if (has_uvs) {
+      _uvs = std::move(uvs);
+    }
+    if (has_normals) {
+      _normals = std::move(normals);
+    }
+  }
+
+  void Mesh::Optimize(const float weld_tolerance) {
+    WeldVertices(weld_tolerance);
+    OptimizeTriangleOrder();
+    OptimizeVertexOrder();
+  }
+
+  bool Mesh::FitsIn16BitIndexes() const {
+    return _vertices.size() <= std::numeric_limits<uint16_t>::max() + 1u;
+  }
+
+  std::vector<uint16_t> Mesh::GetIndexes16() const {
+    if (!FitsIn16BitIndexes()) {
+      throw_exception(std::out_of_range("mesh has too many vertices for 16-bit indexes"));
+    }
+    std::vector<uint16_t> result;
+    result.reserve(_indexes.size());
+    for (const auto index : _indexes) {
+      result.push_back(static_cast<uint16_t>(index - 1u));
+    }
+    return result;
+  }
+
+  std::vector<uint32_t> Mesh::GetIndexes32() const {
+    std::vector<uint32_t> result;
+    result.reserve(_indexes.size());
+    for (const auto index : _indexes) {
+      result.push_back(static_cast<uint32_t>(index - 1u));
+    }
+    return result;
+  }
+
 } // namespace geom
 } // namespace carla
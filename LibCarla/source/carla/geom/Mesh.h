@@ -6,6 +6,8 @@
 
 #pragma once
 
+#include <cstdint>
+#include <string>
 #include <vector>
 
 #include <carla/geom/Vector3D.h>
@@ -103,6 +105,31 @@ namespace geom {
     /// 停止将材质应用到新添加的三角形。
     void EndMaterial();
 
+    // -- 优化 -----------------------------------------------------------------
+
+    /// 合并位置、纹理坐标和法线都相同的重复顶点，并删除因此退化的三角形。
+    /// @a tolerance 大于0时位置按该精度量化后比较。返回删除的顶点数量。
+    size_t WeldVertices(float tolerance = 0.0f);
+
+    /// 在每个材质的索引范围内重新排列三角形以提高GPU顶点缓存命中率
+    ///（Forsyth线性时间算法），不改变网格的形状和材质范围。
+    void OptimizeTriangleOrder();
+
+    /// 按在索引中第一次出现的顺序重新排列顶点，并删除未被引用的顶点。
+    void OptimizeVertexOrder();
+
+    /// 依次执行 WeldVertices、OptimizeTriangleOrder 和 OptimizeVertexOrder。
+    void Optimize(float weld_tolerance = 0.0f);
+
+    /// 所有索引是否都可以用16位表示。
+    bool FitsIn16BitIndexes() const;
+
+    /// 从0开始的16位索引，顶点数量超过65536时抛出异常。
+    std::vector<uint16_t> GetIndexes16() const;
+
+    /// 从0开始的32位索引。
+    std::vector<uint32_t> GetIndexes32() const;
+
     // =========================================================================
     // -- 导出方法 --------------------------------------------------------------
     // =========================================================================
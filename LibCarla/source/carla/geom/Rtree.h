@@ -29,11 +29,19 @@ namespace geom {
 
   /// PointCloudRtree 类用于处理 3D 点云。
   ///将类型 T 的元素与 3D 点关联，用于快速 k-NN 搜索。
-  /// 
-  template <typename T, size_t Dimension = 3> // 定义模板类 PointCloudRtree，用于处理点云，T 是元素类型，默认维度为 3。
+  ///
+  /// @a Parameters 为 Boost R-tree 的节点分裂算法和节点容量，默认 linear<16>；
+  /// 传入 dynamic_linear/dynamic_rstar 等运行时参数时，可以在构造时指定节点容量。
+  template <
+      typename T,
+      size_t Dimension = 3,
+      typename Parameters = boost::geometry::index::linear<16>> // 定义模板类 PointCloudRtree，用于处理点云，T 是元素类型，默认维度为 3。
   class PointCloudRtree {
   public:
 
+    explicit PointCloudRtree(const Parameters &parameters = Parameters())
+      : _rtree(parameters) {}
+
     typedef boost::geometry::model::point<float, Dimension, boost::geometry::cs::cartesian> BPoint; // 定义类型别名 BPoint，表示 Boost 几何库中的点。
     typedef std::pair<BPoint, T> TreeElement;  // 定义类型别名 TreeElement，表示 R-tree 中的元素，包含一个点和一个关联元素。
 
@@ -46,7 +54,12 @@ namespace geom {
     } // 成员函数，将一个 TreeElement 插入 R-tree。
 
     void InsertElements(const std::vector<TreeElement> &elements) {
-      _rtree.insert(elements.begin(), elements.end());
+      if (_rtree.empty()) {
+        // 空树时使用打包算法一次性构建，比逐个插入快得多，查询性能也更好
+        _rtree = rtree_type(elements.begin(), elements.end(), _rtree.parameters());
+      } else {
+        _rtree.insert(elements.begin(), elements.end());
+      }
     } // 成员函数，批量插入多个 TreeElement 到 R-tree。
 
     /// 返回最近邻元素，可以应用用户定义的过滤器。
@@ -79,17 +92,26 @@ namespace geom {
 
   private:
 
-    boost::geometry::index::rtree<TreeElement, boost::geometry::index::linear<16>> _rtree;
+    using rtree_type = boost::geometry::index::rtree<TreeElement, Parameters>;
+
+    rtree_type _rtree;
     // 私有成员变量，R-tree 数据结构实例。
   };
 
   /// SegmentCloudRtree 类用于处理 3D 线段云
   /// 将类型 T 的元素与线段的两个端点关联，用于快速 k-NN 搜索。
-  /// 
-  template <typename T, size_t Dimension = 3>
+  ///
+  /// @a Parameters 与 PointCloudRtree 相同。
+  template <
+      typename T,
+      size_t Dimension = 3,
+      typename Parameters = boost::geometry::index::linear<16>>
   class SegmentCloudRtree {
   public:// 定义模板类 SegmentCloudRtree，用于处理线段云，T 是元素类型，默认维度为 3。
 
+    explicit SegmentCloudRtree(const Parameters &parameters = Parameters())
+      : _rtree(parameters) {}
+
     typedef boost::geometry::model::point<float, Dimension, boost::geometry::cs::cartesian> BPoint;
     typedef boost::geometry::model::segment<BPoint> BSegment;
     typedef std::pair<BSegment, std::pair<T, T>> TreeElement;
@@ -103,7 +125,12 @@ namespace geom {
     }// 成员函数，将一个 TreeElement 插入 R-tree。
 
     void InsertElements(const std::vector<TreeElement> &elements) {
-      _rtree.insert(elements.begin(), elements.end());
+      if (_rtree.empty()) {
+        // 空树时使用打包算法一次性构建，比逐个插入快得多，查询性能也更好
+        _rtree = rtree_type(elements.begin(), elements.end(), _rtree.parameters());
+      } else {
+        _rtree.insert(elements.begin(), elements.end());
+      }
     }// 成员函数，批量插入多个 TreeElement 到 R-tree。
 
     /// 返回带有用户定义过滤器的最近邻元素。
@@ -124,6 +151,20 @@ namespace geom {
       return query_result;
     } // 成员函数模板，返回最近邻元素，可以应用用户定义的过滤器。
 
+    /// 与上面相同，但把结果写入 @a query_result ，批量查询时可以复用同一块内存。
+    template <typename Geometry, typename Filter>
+    void GetNearestNeighboursWithFilter(
+        const Geometry &geometry,
+        Filter filter,
+        std::vector<TreeElement> &query_result,
+        size_t number_neighbours = 1) const {
+      query_result.clear();
+      _rtree.query(
+          boost::geometry::index::nearest(geometry, static_cast<unsigned int>(number_neighbours)) &&
+              boost::geometry::index::satisfies(filter),
+          std::back_inserter(query_result));
+    }
+
     template<typename Geometry>
     std::vector<TreeElement> GetNearestNeighbours(const Geometry &geometry, size_t number_neighbours = 1) const {
       std::vector<TreeElement> query_result;
@@ -150,7 +191,9 @@ namespace geom {
 
   private:
 
-    boost::geometry::index::rtree<TreeElement, boost::geometry::index::linear<16>> _rtree;
+    using rtree_type = boost::geometry::index::rtree<TreeElement, Parameters>;
+
+    rtree_type _rtree;
     // 私有成员变量，R-tree 数据结构实例。
   };
 
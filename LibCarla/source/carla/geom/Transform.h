@@ -100,6 +100,46 @@ namespace geom {
             in_point = out_point;
         }
 
+        /// 将此变换应用于 @a number_of_points 个点，结果与逐点调用
+        /// TransformPoint 一致。每个点的 x、y、z 连续存放，相邻两点相差 @a stride
+        /// 个元素，因此可以直接处理带有其他字段的点（例如激光雷达的 x、y、z、强度）。
+        /// 旋转矩阵只计算一次，不再逐点计算三角函数，循环可以被编译器向量化。
+        template <typename T>
+        void TransformPoints(T *points, size_t number_of_points, size_t stride = 3u) const {
+            const auto m = GetMatrix();
+            for (size_t i = 0u; i < number_of_points; ++i) {
+                T *point = points + i * stride;
+                const T x = point[0u], y = point[1u], z = point[2u];
+                point[0u] = x * m[0u] + y * m[1u] + z * m[2u] + m[3u];
+                point[1u] = x * m[4u] + y * m[5u] + z * m[6u] + m[7u];
+                point[2u] = x * m[8u] + y * m[9u] + z * m[10u] + m[11u];
+            }
+        }
+
+        void TransformPoints(Vector3D *points, size_t number_of_points) const {
+            static_assert(sizeof(Vector3D) == 3u * sizeof(float), "Invalid Vector3D layout");
+            TransformPoints(&points->x, number_of_points);
+        }
+
+        /// 将此变换的逆运算应用于 @a number_of_points 个点，参数与 TransformPoints 相同。
+        template <typename T>
+        void InverseTransformPoints(T *points, size_t number_of_points, size_t stride = 3u) const {
+            // 逆旋转矩阵是旋转矩阵的转置
+            const auto m = GetMatrix();
+            for (size_t i = 0u; i < number_of_points; ++i) {
+                T *point = points + i * stride;
+                const T x = point[0u] - m[3u], y = point[1u] - m[7u], z = point[2u] - m[11u];
+                point[0u] = x * m[0u] + y * m[4u] + z * m[8u];
+                point[1u] = x * m[1u] + y * m[5u] + z * m[9u];
+                point[2u] = x * m[2u] + y * m[6u] + z * m[10u];
+            }
+        }
+
+        void InverseTransformPoints(Vector3D *points, size_t number_of_points) const {
+            static_assert(sizeof(Vector3D) == 3u * sizeof(float), "Invalid Vector3D layout");
+            InverseTransformPoints(&points->x, number_of_points);
+        }
+
         /// 计算变换的 4 矩阵形式
         /// 通过当前的旋转角度（偏航、俯仰、翻滚）以及位置信息，按照特定的数学变换规则计算出一个 4x4 的变换矩阵，用于更通用的线性变换操作表示
         std::array<float, 16> GetMatrix() const {
@@ -0,0 +1,424 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/headless/HeadlessServer.h"
+
+#include "carla/Exception.h"
+#include "carla/Logging.h"
+#include "carla/MsgPack.h"
+#include "carla/Version.h"
+#include "carla/opendrive/OpenDriveParser.h"
+#include "carla/rpc/CachedContent.h"
+#include "carla/rpc/EpisodeInfo.h"
+#include "carla/rpc/LightState.h"
+#include "carla/rpc/MapInfo.h"
+#include "carla/sensor/SensorRegistry.h"
+#include "carla/sensor/s11n/SensorHeaderSerializer.h"
+
+#include <array>
+#include <chrono>
+#include <stdexcept>
+
+namespace carla {
+namespace headless {
+
+  namespace cr = carla::rpc;
+
+  template <typename T>
+  using R = cr::Response<T>;
+
+namespace {
+
+  /// 剧集的 ID，地图不会更换，所以只有一个剧集。
+  constexpr uint64_t EPISODE_ID = 1u;
+
+  /// 没有 fixed_delta_seconds 时同步模式每帧推进的时间，以及异步模式两帧之间的最短真实时间。
+  constexpr double DEFAULT_DELTA_SECONDS = 0.05;
+
+  road::Map LoadMap(const std::string &opendrive) {
+    auto map = opendrive::OpenDriveParser::Load(opendrive);
+    if (!map.has_value()) {
+      throw_exception(std::invalid_argument("headless: invalid OpenDRIVE content"));
+    }
+    return std::move(*map);
+  }
+
+  double GetPlatformSeconds() {
+    using namespace std::chrono;
+    return duration<double>(steady_clock::now().time_since_epoch()).count();
+  }
+
+} // namespace
+
+  HeadlessServer::HeadlessServer(
+      std::string map_name,
+      std::string opendrive,
+      uint16_t port,
+      std::vector<VehicleBlueprint> blueprints)
+    : _map_name(std::move(map_name)),
+      _opendrive(std::move(opendrive)),
+      _port(port),
+      _world(LoadMap(_opendrive), std::move(blueprints)),
+      _server(port),
+      _streaming_server(static_cast<uint16_t>(port + 1u)),
+      _episode_stream(_streaming_server.MakeStream()) {
+    const auto packed = MsgPack::Pack(_world.GetActorDefinitions());
+    _packed_actor_definitions.assign(
+        reinterpret_cast<const uint8_t *>(packed.data()),
+        reinterpret_cast<const uint8_t *>(packed.data()) + packed.size());
+    _actor_definitions_hash = cr::CachedContent::ComputeHash(_packed_actor_definitions);
+    _opendrive_hash = cr::CachedContent::ComputeHash(
+        reinterpret_cast<const uint8_t *>(_opendrive.data()),
+        _opendrive.size());
+    BindActions();
+  }
+
+  HeadlessServer::~HeadlessServer() {
+    Stop();
+  }
+
+  // ===========================================================================
+  // -- 运行 --------------------------------------------------------------------
+  // ===========================================================================
+
+  void HeadlessServer::Run(size_t worker_threads) {
+    _running = true;
+    _server.AsyncRun(worker_threads);
+    _streaming_server.AsyncRun(worker_threads);
+    log_info("headless: serving map", _map_name, "on port", _port);
+
+    auto last_tick = GetPlatformSeconds();
+    while (_running) {
+      // 复制一份设置，处理 RPC 时 set_episode_settings 可能修改它们
+      const auto settings = _world.GetSettings();
+      if (settings.synchronous_mode) {
+        // 与 Unreal 服务器相同，同步模式下等到客户端发送 tick_cue 才推进
+        if (_pending_tick_cues == 0u) {
+          _server.SyncWaitFor(time_duration::milliseconds(10u));
+          continue;
+        }
+        --_pending_tick_cues;
+        last_tick = GetPlatformSeconds();
+        Tick(settings.fixed_delta_seconds.value_or(DEFAULT_DELTA_SECONDS));
+      } else if (settings.fixed_delta_seconds.has_value()) {
+        // 没有待处理的请求时立即返回，仿真尽快推进
+        _server.SyncRunFor(time_duration::milliseconds(1u));
+        // 刚处理的请求可能改变了模式或去掉了固定步长，这时按新的设置重新开始循环
+        const auto &current = _world.GetSettings();
+        if (current.synchronous_mode || !current.fixed_delta_seconds.has_value()) {
+          continue;
+        }
+        last_tick = GetPlatformSeconds();
+        Tick(*current.fixed_delta_seconds);
+      } else {
+        const auto now = GetPlatformSeconds();
+        const auto elapsed = now - last_tick;
+        if (elapsed < DEFAULT_DELTA_SECONDS) {
+          const auto remaining = static_cast<size_t>(1e3 * (DEFAULT_DELTA_SECONDS - elapsed));
+          _server.SyncWaitFor(time_duration::milliseconds(std::max<size_t>(remaining, 1u)));
+          continue;
+        }
+        last_tick = now;
+        Tick(elapsed);
+      }
+    }
+  }
+
+  void HeadlessServer::AsyncRun(size_t worker_threads) {
+    DEBUG_ASSERT(!_thread.joinable());
+    _running = true;
+    _thread = std::thread([this, worker_threads]() { Run(worker_threads); });
+  }
+
+  void HeadlessServer::Stop() {
+    _running = false;
+    _server.SyncWake();
+    if (_thread.joinable()) {
+      _thread.join();
+    }
+    _server.Stop();
+  }
+
+  void HeadlessServer::Tick(double delta_seconds) {
+    _world.Tick(delta_seconds);
+    BroadcastState(delta_seconds);
+  }
+
+  void HeadlessServer::BroadcastState(double delta_seconds) {
+    if (!_episode_stream.AreClientsListening()) {
+      return;
+    }
+    _world.GetActorStates(_states);
+
+    sensor::s11n::EpisodeStateSerializer::Header header;
+    header.episode_id = EPISODE_ID;
+    header.platform_timestamp = GetPlatformSeconds();
+    header.delta_seconds = static_cast<float>(delta_seconds);
+    header.map_origin = geom::Vector3DInt{0, 0, 0};
+    header.simulation_state = sensor::s11n::EpisodeStateSerializer::SimulationState::None;
+
+    // 与 FWorldObserver 发送的消息相同：传感器消息头之后是剧集状态
+    auto message_header = sensor::s11n::SensorHeaderSerializer::Serialize(
+        sensor::SensorRegistry::get<FWorldObserver *>::index,
+        _world.GetFrame(),
+        _world.GetElapsedSeconds(),
+        cr::Transform{});
+    auto payload = _episode_stream.MakeBuffer();
+    _encoder.Encode(_world.GetFrame(), header, _states, payload);
+    _episode_stream.Write(std::move(message_header), std::move(payload));
+  }
+
+  // ===========================================================================
+  // -- RPC ---------------------------------------------------------------------
+  // ===========================================================================
+
+  void HeadlessServer::BindActions() {
+    namespace cg = carla::geom;
+    using ActorId = cr::ActorId;
+
+    // ~~ 剧集 ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+    _server.BindAsync("version", []() -> R<std::string> {
+      return carla::version();
+    });
+
+    _server.BindSync("tick_cue", [this]() -> R<uint64_t> {
+      ++_pending_tick_cues;
+      return _world.GetFrame() + 1u;
+    });
+
+    _server.BindSync("get_episode_info", [this]() -> R<cr::EpisodeInfo> {
+      return cr::EpisodeInfo{EPISODE_ID, _episode_stream.token()};
+    });
+
+    _server.BindSync("get_map_info", [this]() -> R<cr::MapInfo> {
+      return cr::MapInfo{_map_name, _world.GetSpawnPoints()};
+    });
+
+    _server.BindSync("get_map_data", [this]() -> R<std::string> {
+      return _opendrive;
+    });
+
+    _server.BindSync("get_map_data_if_none_match", [this](const std::string &hash) -> R<cr::CachedContent> {
+      cr::CachedContent result;
+      result.hash = _opendrive_hash;
+      result.not_modified = (result.hash == hash);
+      if (!result.not_modified) {
+        result.content.assign(_opendrive.begin(), _opendrive.end());
+      }
+      return result;
+    });
+
+    // 地图只有 OpenDRIVE，没有需要下载的文件
+    _server.BindSync("get_required_files", [](std::string) -> R<std::vector<std::string>> {
+      return std::vector<std::string>{};
+    });
+
+    _server.BindSync("get_actor_definitions", [this]() -> R<std::vector<cr::ActorDefinition>> {
+      return _world.GetActorDefinitions();
+    });
+
+    _server.BindSync("get_actor_definitions_if_none_match", [this](const std::string &hash) -> R<cr::CachedContent> {
+      cr::CachedContent result;
+      result.hash = _actor_definitions_hash;
+      result.not_modified = (result.hash == hash);
+      if (!result.not_modified) {
+        result.content = _packed_actor_definitions;
+      }
+      return result;
+    });
+
+    _server.BindSync("get_spectator", [this]() -> R<cr::Actor> {
+      return _world.GetSpectator();
+    });
+
+    _server.BindSync("get_episode_settings", [this]() -> R<cr::EpisodeSettings> {
+      return _world.GetSettings();
+    });
+
+    _server.BindSync("set_episode_settings", [this](const cr::EpisodeSettings &settings) -> R<uint64_t> {
+      _world.SetSettings(settings);
+      _streaming_server.SetSynchronousMode(settings.synchronous_mode);
+      return _world.GetFrame();
+    });
+
+    _server.BindSync("get_weather_parameters", [this]() -> R<cr::WeatherParameters> {
+      return _world.GetWeather();
+    });
+
+    _server.BindSync("set_weather_parameters", [this](const cr::WeatherParameters &weather) -> R<void> {
+      _world.SetWeather(weather);
+      return R<void>::Success();
+    });
+
+    // 没有灯光子系统，客户端的 LightManager 得到空的灯光列表
+    _server.BindSync("query_lights_state", [](std::string) -> R<std::vector<cr::LightState>> {
+      return std::vector<cr::LightState>{};
+    });
+
+    // ~~ 交通管理器 ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+    _server.BindSync("is_traffic_manager_running", [this](uint16_t port) -> R<bool> {
+      return _traffic_managers.find(port) != _traffic_managers.end();
+    });
+
+    _server.BindSync("get_traffic_manager_running", [this](uint16_t port) -> R<std::pair<std::string, uint16_t>> {
+      auto it = _traffic_managers.find(port);
+      if (it != _traffic_managers.end()) {
+        return std::pair<std::string, uint16_t>(it->second, it->first);
+      }
+      return std::pair<std::string, uint16_t>("", 0u);
+    });
+
+    _server.BindSync("add_traffic_manager_running", [this](std::pair<std::string, uint16_t> info) -> R<bool> {
+      return _traffic_managers.emplace(info.second, info.first).second;
+    });
+
+    _server.BindSync("destroy_traffic_manager", [this](uint16_t port) -> R<bool> {
+      return _traffic_managers.erase(port) > 0u;
+    });
+
+    // ~~ 参与者 ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+    _server.BindSync("get_actors_by_id", [this](const std::vector<ActorId> &ids) -> R<std::vector<cr::Actor>> {
+      std::vector<cr::Actor> result;
+      result.reserve(ids.size());
+      for (auto id : ids) {
+        auto actor = _world.GetActor(id);
+        if (actor.has_value()) {
+          result.emplace_back(std::move(*actor));
+        }
+      }
+      return result;
+    });
+
+    _server.BindSync("spawn_actor", [this](cr::ActorDescription description, const cg::Transform &transform) -> R<cr::Actor> {
+      return _world.SpawnActor(description, transform);
+    });
+
+    _server.BindSync("destroy_actor", [this](ActorId id) -> R<bool> {
+      return _world.DestroyActor(id);
+    });
+
+    _server.BindSync("set_actor_location", [this](ActorId id, cg::Location location) -> R<void> {
+      return _world.SetActorLocation(id, location);
+    });
+
+    _server.BindSync("set_actor_transform", [this](ActorId id, cg::Transform transform) -> R<void> {
+      return _world.SetActorTransform(id, transform);
+    });
+
+    _server.BindSync("set_actor_target_velocity", [this](ActorId id, cg::Vector3D velocity) -> R<void> {
+      return _world.SetActorTargetVelocity(id, velocity);
+    });
+
+    _server.BindSync("set_actor_simulate_physics", [this](ActorId id, bool enabled) -> R<void> {
+      return _world.SetActorSimulatePhysics(id, enabled);
+    });
+
+    _server.BindSync("set_vehicle_kinematic_target", [this](ActorId id, cg::Transform transform, cg::Vector3D velocity) -> R<void> {
+      return _world.SetVehicleKinematicTarget(id, transform, velocity);
+    });
+
+    // 自动驾驶由交通管理器在客户端完成
+    _server.BindSync("set_actor_autopilot", [this](ActorId id, bool) -> R<void> {
+      if (!_world.GetActor(id).has_value()) {
+        return cr::ResponseError("unable to find actor " + std::to_string(id));
+      }
+      return R<void>::Success();
+    });
+
+    _server.BindSync("apply_control_to_vehicle", [this](ActorId id, cr::VehicleControl control) -> R<void> {
+      return _world.ApplyControlToVehicle(id, control);
+    });
+
+    _server.BindSync("set_vehicle_light_state", [this](ActorId id, cr::VehicleLightState light_state) -> R<void> {
+      return _world.SetVehicleLightState(id, light_state.GetLightStateAsValue());
+    });
+
+    _server.BindSync("get_vehicle_light_state", [this](ActorId id) -> R<cr::VehicleLightState> {
+      auto result = _world.GetVehicleLightState(id);
+      if (result.HasError()) {
+        return result.GetError();
+      }
+      return cr::VehicleLightState(result.Get());
+    });
+
+    _server.BindSync("get_vehicle_light_states", [this]() -> R<cr::VehicleLightStateList> {
+      return _world.GetVehiclesLightStates();
+    });
+
+    // ~~ 交通信号灯 ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+    auto light_result = [](ActorId id, bool found) -> R<void> {
+      if (!found) {
+        return cr::ResponseError("actor " + std::to_string(id) + " is not a traffic light");
+      }
+      return R<void>::Success();
+    };
+
+    _server.BindSync("set_traffic_light_state", [this, light_result](ActorId id, cr::TrafficLightState state) -> R<void> {
+      return light_result(id, _world.GetTrafficSignals().SetState(id, state));
+    });
+
+    _server.BindSync("set_traffic_light_green_time", [this, light_result](ActorId id, float time) -> R<void> {
+      return light_result(id, _world.GetTrafficSignals().SetStageTime(id, cr::TrafficLightState::Green, time));
+    });
+
+    _server.BindSync("set_traffic_light_yellow_time", [this, light_result](ActorId id, float time) -> R<void> {
+      return light_result(id, _world.GetTrafficSignals().SetStageTime(id, cr::TrafficLightState::Yellow, time));
+    });
+
+    _server.BindSync("set_traffic_light_red_time", [this, light_result](ActorId id, float time) -> R<void> {
+      return light_result(id, _world.GetTrafficSignals().SetStageTime(id, cr::TrafficLightState::Red, time));
+    });
+
+    _server.BindSync("freeze_traffic_light", [this, light_result](ActorId id, bool freeze) -> R<void> {
+      return light_result(id, _world.GetTrafficSignals().Freeze(id, freeze));
+    });
+
+    _server.BindSync("reset_traffic_light_group", [this, light_result](ActorId id) -> R<void> {
+      return light_result(id, _world.GetTrafficSignals().ResetGroup(id));
+    });
+
+    _server.BindSync("reset_all_traffic_lights", [this]() -> R<void> {
+      _world.GetTrafficSignals().ResetAllGroups();
+      return R<void>::Success();
+    });
+
+    _server.BindSync("freeze_all_traffic_lights", [this](bool frozen) -> R<void> {
+      _world.GetTrafficSignals().FreezeAll(frozen);
+      return R<void>::Success();
+    });
+
+    _server.BindSync("get_group_traffic_lights", [this](ActorId id) -> R<std::vector<ActorId>> {
+      return _world.GetTrafficSignals().GetGroup(id);
+    });
+
+    // ~~ 批量命令 ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+    _server.BindSync("apply_batch", [this](const std::vector<cr::Command> &commands, bool do_tick_cue) -> std::vector<cr::CommandResponse> {
+      std::vector<cr::CommandResponse> result;
+      // 客户端用 apply_batch 而非 apply_batch_sync 时不需要响应
+      if (cr::Server::IsResponseIgnored()) {
+        for (const auto &command : commands) {
+          _world.ApplyCommand(command);
+        }
+      } else {
+        result.reserve(commands.size());
+        for (const auto &command : commands) {
+          result.emplace_back(_world.ApplyCommand(command));
+        }
+      }
+      if (do_tick_cue) {
+        ++_pending_tick_cues;
+      }
+      return result;
+    });
+  }
+
+} // namespace headless
+} // namespace carla
@@ -0,0 +1,105 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/NonCopyable.h"
+#include "carla/headless/KinematicWorld.h"
+#include "carla/rpc/Server.h"
+#include "carla/sensor/s11n/EpisodeStateDelta.h"
+#include "carla/streaming/Server.h"
+#include "carla/streaming/Stream.h"
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace carla {
+namespace headless {
+
+  /// @brief 不需要 Unreal 的仿真服务器，在 KinematicWorld 上实现客户端和交通管理器
+  /// 使用的那部分 RPC 与剧集状态流。
+  ///
+  /// 客户端和交通管理器不需要任何修改：它们像连接 Unreal 服务器一样连接
+  /// @a port，流端口为 @a port + 1。只支持车辆；行人、传感器、重新加载地图等
+  /// 其他 RPC 没有绑定，调用时客户端收到 rpclib 的错误。
+  ///
+  /// 同步模式下每收到一个 tick_cue 推进一帧，没有 fixed_delta_seconds 时按
+  /// 0.05 秒推进；异步模式下按真实时间推进，设置了 fixed_delta_seconds 时尽快推进。
+  class HeadlessServer : private NonCopyable {
+  public:
+
+    /// 解析 OpenDRIVE 内容 @a opendrive 并在 @a port 上监听，解析失败时抛出异常。
+    /// @a map_name 是客户端看到的地图名。
+    HeadlessServer(
+        std::string map_name,
+        std::string opendrive,
+        uint16_t port = 2000u,
+        std::vector<VehicleBlueprint> blueprints = KinematicWorld::GetDefaultBlueprints());
+
+    ~HeadlessServer();
+
+    uint16_t GetPort() const {
+      return _port;
+    }
+
+    /// 在当前线程中运行仿真，直到另一个线程调用 Stop。
+    void Run(size_t worker_threads = 2u);
+
+    /// 在后台线程中运行仿真。
+    void AsyncRun(size_t worker_threads = 2u);
+
+    void Stop();
+
+  private:
+
+    void BindActions();
+
+    void Tick(double delta_seconds);
+
+    void BroadcastState(double delta_seconds);
+
+    const std::string _map_name;
+
+    const std::string _opendrive;
+
+    const uint16_t _port;
+
+    KinematicWorld _world;
+
+    rpc::Server _server;
+
+    streaming::Server _streaming_server;
+
+    streaming::Stream _episode_stream;
+
+    sensor::s11n::episode_state_delta::Encoder _encoder;
+
+    std::vector<sensor::data::ActorDynamicState> _states;
+
+    /// 蓝图库打包后的内容和哈希，见 get_actor_definitions_if_none_match。
+    std::vector<uint8_t> _packed_actor_definitions;
+
+    std::string _actor_definitions_hash;
+
+    std::string _opendrive_hash;
+
+    /// 已注册的交通管理器，端口到地址，与 Unreal 服务器的语义相同。
+    std::map<uint16_t, std::string> _traffic_managers;
+
+    /// 同步模式下收到但尚未处理的 tick_cue 的数量。
+    std::atomic_size_t _pending_tick_cues{0u};
+
+    std::atomic_bool _running{false};
+
+    std::thread _thread;
+  };
+
+} // namespace headless
+} // namespace carla
@@ -0,0 +1,558 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/headless/KinematicWorld.h"
+
+#include "carla/Functional.h"
+#include "carla/ParallelFor.h"
+#include "carla/StringUtil.h"
+#include "carla/geom/Math.h"
+#include "carla/rpc/ActorAttributeType.h"
+#include "carla/rpc/ActorState.h"
+#include "carla/rpc/ObjectLabel.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace carla {
+namespace headless {
+
+  using Math = geom::Math;
+
+namespace {
+
+  /// 推荐的生成点之间的距离，单位为米。
+  constexpr double SPAWN_POINT_DISTANCE = 30.0;
+
+  /// 生成点高出路面的距离，与 Unreal 中地图的生成点相近。
+  constexpr float SPAWN_POINT_HEIGHT = 0.5f;
+
+  /// 不踩油门时的滚动阻力产生的减速度，单位为 m/s^2。
+  constexpr float ROLLING_DECELERATION = 0.3f;
+
+  /// 每个任务至少积分的车辆数。
+  constexpr size_t MIN_VEHICLES_PER_TASK = 64u;
+
+  rpc::ActorAttribute MakeAttribute(
+      std::string id,
+      rpc::ActorAttributeType type,
+      std::string value,
+      bool is_modifiable = false) {
+    rpc::ActorAttribute attribute;
+    attribute.id = std::move(id);
+    attribute.type = type;
+    attribute.value = value;
+    attribute.is_modifiable = is_modifiable;
+    if (is_modifiable) {
+      attribute.recommended_values.emplace_back(std::move(value));
+    }
+    return attribute;
+  }
+
+  uint8_t GetSemanticTag(const std::string &base_type) {
+    if (base_type == "truck") {
+      return static_cast<uint8_t>(rpc::CityObjectLabel::Truck);
+    } else if (base_type == "bus") {
+      return static_cast<uint8_t>(rpc::CityObjectLabel::Bus);
+    } else if (base_type == "motorcycle") {
+      return static_cast<uint8_t>(rpc::CityObjectLabel::Motorcycle);
+    } else if (base_type == "bicycle") {
+      return static_cast<uint8_t>(rpc::CityObjectLabel::Bicycle);
+    }
+    return static_cast<uint8_t>(rpc::CityObjectLabel::Car);
+  }
+
+  /// 把角度规范到 [-180, 180)。
+  float NormalizeAngle(float degrees) {
+    degrees = std::fmod(degrees + 180.0f, 360.0f);
+    return (degrees < 0.0f ? degrees + 360.0f : degrees) - 180.0f;
+  }
+
+  /// 沿最短的方向从 @a from 转向 @a to 的 @a alpha 部分。
+  float InterpolateAngle(float from, float to, float alpha) {
+    return NormalizeAngle(from + alpha * NormalizeAngle(to - from));
+  }
+
+  rpc::ResponseError ActorNotFound(rpc::ActorId id) {
+    return rpc::ResponseError("unable to find actor " + std::to_string(id));
+  }
+
+  rpc::ResponseError NotAVehicle(rpc::ActorId id) {
+    return rpc::ResponseError("actor " + std::to_string(id) + " is not a vehicle");
+  }
+
+} // namespace
+
+  // ===========================================================================
+  // -- 构造 --------------------------------------------------------------------
+  // ===========================================================================
+
+  std::vector<VehicleBlueprint> KinematicWorld::GetDefaultBlueprints() {
+    VehicleBlueprint car;
+    car.id = "vehicle.headless.car";
+
+    VehicleBlueprint truck;
+    truck.id = "vehicle.headless.truck";
+    truck.base_type = "truck";
+    truck.extent = {4.5f, 1.3f, 1.7f};
+    truck.wheelbase = 5.5f;
+    truck.max_steer_angle = 55.0f;
+    truck.max_acceleration = 2.0f;
+    truck.max_deceleration = 6.0f;
+    truck.max_speed = 33.0f;
+
+    VehicleBlueprint motorcycle;
+    motorcycle.id = "vehicle.headless.motorcycle";
+    motorcycle.base_type = "motorcycle";
+    motorcycle.number_of_wheels = 2;
+    motorcycle.extent = {1.1f, 0.45f, 0.8f};
+    motorcycle.wheelbase = 1.5f;
+    motorcycle.max_steer_angle = 45.0f;
+    motorcycle.max_acceleration = 5.0f;
+    motorcycle.max_speed = 45.0f;
+
+    return {car, truck, motorcycle};
+  }
+
+  KinematicWorld::KinematicWorld(road::Map map, std::vector<VehicleBlueprint> blueprints)
+    : _map(std::move(map)),
+      _blueprints(std::move(blueprints)),
+      // 1 为观察者，之后是交通信号灯
+      _signals(_map, 2u) {
+    _spectator.id = 1u;
+    _spectator.description.id = "spectator";
+    _next_id = 2u + static_cast<rpc::ActorId>(_signals.GetTrafficLights().size());
+
+    for (size_t i = 0u; i < _blueprints.size(); ++i) {
+      const auto &blueprint = _blueprints[i];
+      DEBUG_ASSERT(StringUtil::StartsWith(blueprint.id, "vehicle."));
+      rpc::ActorDefinition definition;
+      definition.uid = static_cast<rpc::ActorId>(i + 1u);
+      definition.id = blueprint.id;
+      definition.tags = "vehicle,headless," + blueprint.base_type;
+      definition.attributes = {
+          MakeAttribute("number_of_wheels", rpc::ActorAttributeType::Int, std::to_string(blueprint.number_of_wheels)),
+          MakeAttribute("base_type", rpc::ActorAttributeType::String, blueprint.base_type),
+          MakeAttribute("generation", rpc::ActorAttributeType::Int, "2"),
+          MakeAttribute("role_name", rpc::ActorAttributeType::String, "autopilot", true)};
+      _definitions.emplace_back(std::move(definition));
+    }
+
+    for (const auto &waypoint : _map.GenerateWaypoints(SPAWN_POINT_DISTANCE)) {
+      if (_map.IsJunction(waypoint.road_id) ||
+          _map.GetLane(waypoint).GetType() != road::Lane::LaneType::Driving) {
+        continue;
+      }
+      auto transform = _map.ComputeTransform(waypoint);
+      transform.location.z += SPAWN_POINT_HEIGHT;
+      _spawn_points.emplace_back(transform);
+    }
+  }
+
+  // ===========================================================================
+  // -- 参与者 ------------------------------------------------------------------
+  // ===========================================================================
+
+  KinematicWorld::Vehicle *KinematicWorld::FindVehicle(rpc::ActorId id) {
+    auto it = _vehicle_index.find(id);
+    return it == _vehicle_index.end() ? nullptr : &_vehicles[it->second];
+  }
+
+  const KinematicWorld::Vehicle *KinematicWorld::FindVehicle(rpc::ActorId id) const {
+    auto it = _vehicle_index.find(id);
+    return it == _vehicle_index.end() ? nullptr : &_vehicles[it->second];
+  }
+
+  OrientedBox KinematicWorld::GetBox(const Vehicle &vehicle) const {
+    return {vehicle.transform, vehicle.actor.bounding_box.location, vehicle.actor.bounding_box.extent};
+  }
+
+  rpc::Actor KinematicWorld::GetSpectator() const {
+    return _spectator;
+  }
+
+  boost::optional<rpc::Actor> KinematicWorld::GetActor(rpc::ActorId id) const {
+    if (id == _spectator.id) {
+      return _spectator;
+    }
+    if (const auto *light = _signals.GetTrafficLight(id)) {
+      rpc::Actor actor;
+      actor.id = light->id;
+      actor.description.id = "traffic.traffic_light";
+      actor.description.attributes.emplace_back(
+          MakeAttribute("sign_id", rpc::ActorAttributeType::String, light->sign_id));
+      actor.semantic_tags = {static_cast<uint8_t>(rpc::CityObjectLabel::TrafficLight)};
+      return actor;
+    }
+    if (const auto *vehicle = FindVehicle(id)) {
+      return vehicle->actor;
+    }
+    return boost::none;
+  }
+
+  rpc::Response<rpc::Actor> KinematicWorld::SpawnActor(
+      const rpc::ActorDescription &description,
+      const geom::Transform &transform) {
+    auto blueprint = std::find_if(_blueprints.begin(), _blueprints.end(), [&](const auto &item) {
+      return item.id == description.id;
+    });
+    if (blueprint == _blueprints.end()) {
+      return rpc::ResponseError("headless world can only spawn vehicles, unknown blueprint " + description.id);
+    }
+
+    Vehicle vehicle;
+    vehicle.blueprint = static_cast<size_t>(blueprint - _blueprints.begin());
+    vehicle.transform = transform;
+    vehicle.actor.description = description;
+    vehicle.actor.bounding_box = geom::BoundingBox(
+        geom::Location{0.0f, 0.0f, blueprint->extent.z},
+        blueprint->extent);
+    vehicle.actor.semantic_tags = {GetSemanticTag(blueprint->base_type)};
+
+    const auto box = GetBox(vehicle);
+    for (const auto &other : _vehicles) {
+      if (GetBox(other).Overlaps(box)) {
+        return rpc::ResponseError("Spawn failed because of collision at spawn position");
+      }
+    }
+
+    vehicle.actor.id = _next_id++;
+    SnapToRoad(vehicle);
+    UpdateTriggers(vehicle);
+    _vehicle_index.emplace(vehicle.actor.id, _vehicles.size());
+    _vehicles.emplace_back(std::move(vehicle));
+    return _vehicles.back().actor;
+  }
+
+  rpc::Response<bool> KinematicWorld::DestroyActor(rpc::ActorId id) {
+    auto it = _vehicle_index.find(id);
+    if (it == _vehicle_index.end()) {
+      if (id == _spectator.id || _signals.GetTrafficLight(id) != nullptr) {
+        return rpc::ResponseError("actor " + std::to_string(id) + " cannot be destroyed");
+      }
+      return ActorNotFound(id);
+    }
+    // 把最后一辆车移到被删除的位置
+    const size_t index = it->second;
+    _vehicle_index.erase(it);
+    if (index + 1u != _vehicles.size()) {
+      _vehicles[index] = std::move(_vehicles.back());
+      _vehicle_index[_vehicles[index].actor.id] = index;
+    }
+    _vehicles.pop_back();
+    return true;
+  }
+
+  rpc::Response<void> KinematicWorld::SetActorLocation(rpc::ActorId id, const geom::Location &location) {
+    geom::Transform transform;
+    if (id == _spectator.id) {
+      transform = _spectator_transform;
+    } else if (const auto *vehicle = FindVehicle(id)) {
+      transform = vehicle->transform;
+    } else {
+      return ActorNotFound(id);
+    }
+    transform.location = location;
+    return SetActorTransform(id, transform);
+  }
+
+  rpc::Response<void> KinematicWorld::SetActorTransform(rpc::ActorId id, const geom::Transform &transform) {
+    if (id == _spectator.id) {
+      _spectator_transform = transform;
+      return rpc::Response<void>::Success();
+    }
+    auto *vehicle = FindVehicle(id);
+    if (vehicle == nullptr) {
+      return ActorNotFound(id);
+    }
+    // 与 Unreal 中相同，瞬移保持速度，运动学目标也移到新的位置
+    vehicle->transform = transform;
+    vehicle->target = transform;
+    return rpc::Response<void>::Success();
+  }
+
+  rpc::Response<void> KinematicWorld::SetActorTargetVelocity(rpc::ActorId id, const geom::Vector3D &velocity) {
+    auto *vehicle = FindVehicle(id);
+    if (vehicle == nullptr) {
+      return ActorNotFound(id);
+    }
+    vehicle->velocity = velocity;
+    // 模拟物理时只保留沿车头方向的分量，车辆没有侧滑
+    const auto forward = vehicle->transform.GetForwardVector();
+    vehicle->speed = velocity.x * forward.x + velocity.y * forward.y + velocity.z * forward.z;
+    return rpc::Response<void>::Success();
+  }
+
+  rpc::Response<void> KinematicWorld::SetActorSimulatePhysics(rpc::ActorId id, bool enabled) {
+    auto *vehicle = FindVehicle(id);
+    if (vehicle == nullptr) {
+      return ActorNotFound(id);
+    }
+    vehicle->simulate_physics = enabled;
+    if (enabled) {
+      // 与 FKinematicVehicles 相同，重新模拟物理的车辆不再向运动学目标移动
+      vehicle->has_kinematic_target = false;
+      vehicle->speed = 0.0f;
+    }
+    return rpc::Response<void>::Success();
+  }
+
+  rpc::Response<void> KinematicWorld::SetVehicleKinematicTarget(
+      rpc::ActorId id,
+      const geom::Transform &transform,
+      const geom::Vector3D &velocity) {
+    auto *vehicle = FindVehicle(id);
+    if (vehicle == nullptr) {
+      return _signals.GetTrafficLight(id) != nullptr || id == _spectator.id ? NotAVehicle(id) : ActorNotFound(id);
+    }
+    if (!vehicle->has_kinematic_target) {
+      vehicle->simulate_physics = false;
+      vehicle->has_kinematic_target = true;
+    }
+    vehicle->target = transform;
+    vehicle->target_speed = velocity.Length();
+    return rpc::Response<void>::Success();
+  }
+
+  rpc::Response<void> KinematicWorld::ApplyControlToVehicle(rpc::ActorId id, const rpc::VehicleControl &control) {
+    auto *vehicle = FindVehicle(id);
+    if (vehicle == nullptr) {
+      return _signals.GetTrafficLight(id) != nullptr || id == _spectator.id ? NotAVehicle(id) : ActorNotFound(id);
+    }
+    vehicle->control = control;
+    return rpc::Response<void>::Success();
+  }
+
+  rpc::Response<void> KinematicWorld::SetVehicleLightState(
+      rpc::ActorId id,
+      rpc::VehicleLightState::flag_type light_state) {
+    auto *vehicle = FindVehicle(id);
+    if (vehicle == nullptr) {
+      return ActorNotFound(id);
+    }
+    vehicle->light_state = light_state;
+    return rpc::Response<void>::Success();
+  }
+
+  rpc::Response<rpc::VehicleLightState::flag_type> KinematicWorld::GetVehicleLightState(rpc::ActorId id) const {
+    const auto *vehicle = FindVehicle(id);
+    if (vehicle == nullptr) {
+      return ActorNotFound(id);
+    }
+    return vehicle->light_state;
+  }
+
+  rpc::VehicleLightStateList KinematicWorld::GetVehiclesLightStates() const {
+    rpc::VehicleLightStateList result;
+    result.reserve(_vehicles.size());
+    for (const auto &vehicle : _vehicles) {
+      result.emplace_back(vehicle.actor.id, vehicle.light_state);
+    }
+    return result;
+  }
+
+  rpc::CommandResponse KinematicWorld::ApplyCommand(const rpc::Command &command) {
+    using C = rpc::Command;
+    using CR = rpc::CommandResponse;
+
+    auto parse_result = [](rpc::ActorId id, const auto &response) {
+      return response.HasError() ? CR{response.GetError()} : CR{id};
+    };
+
+    auto command_visitor = Functional::MakeRecursiveOverload(
+        [&](auto self, const C::SpawnActor &c) -> CR {
+          if (c.parent.has_value()) {
+            return rpc::ResponseError("headless world does not support attached actors");
+          }
+          auto result = SpawnActor(c.description, c.transform);
+          if (result.HasError()) {
+            return result.GetError();
+          }
+          const rpc::ActorId id = result.Get().id;
+          auto set_id = Functional::MakeOverload(
+              [](C::SpawnActor &) {},
+              [](C::ConsoleCommand &) {},
+              [id](auto &s) { s.actor = id; });
+          for (auto next : c.do_after) {
+            boost::variant2::visit(set_id, next.command);
+            boost::variant2::visit(self, next.command);
+          }
+          return id;
+        },
+        [&](auto, const C::DestroyActor &c) -> CR { return parse_result(c.actor, DestroyActor(c.actor)); },
+        [&](auto, const C::ApplyVehicleControl &c) -> CR { return parse_result(c.actor, ApplyControlToVehicle(c.actor, c.control)); },
+        [&](auto, const C::ApplyTransform &c) -> CR { return parse_result(c.actor, SetActorTransform(c.actor, c.transform)); },
+        [&](auto, const C::ApplyLocation &c) -> CR { return parse_result(c.actor, SetActorLocation(c.actor, c.location)); },
+        [&](auto, const C::ApplyTargetVelocity &c) -> CR { return parse_result(c.actor, SetActorTargetVelocity(c.actor, c.velocity)); },
+        [&](auto, const C::ApplyKinematicTarget &c) -> CR { return parse_result(c.actor, SetVehicleKinematicTarget(c.actor, c.transform, c.velocity)); },
+        [&](auto, const C::SetSimulatePhysics &c) -> CR { return parse_result(c.actor, SetActorSimulatePhysics(c.actor, c.enabled)); },
+        [&](auto, const C::SetVehicleLightState &c) -> CR { return parse_result(c.actor, SetVehicleLightState(c.actor, c.light_state)); },
+        [&](auto, const C::SetTrafficLightState &c) -> CR {
+          return _signals.SetState(c.actor, c.traffic_light_state) ? CR{c.actor} : CR{ActorNotFound(c.actor)};
+        },
+        // 自动驾驶由交通管理器在客户端完成，服务器只需确认车辆存在
+        [&](auto, const C::SetAutopilot &c) -> CR { return FindVehicle(c.actor) != nullptr ? CR{c.actor} : CR{ActorNotFound(c.actor)}; },
+        [&](auto, const C::SetEnableGravity &c) -> CR { return FindVehicle(c.actor) != nullptr ? CR{c.actor} : CR{ActorNotFound(c.actor)}; },
+        [&](auto, const C::ShowDebugTelemetry &c) -> CR { return FindVehicle(c.actor) != nullptr ? CR{c.actor} : CR{ActorNotFound(c.actor)}; },
+        [&](auto, const C::ConsoleCommand &) -> CR { return rpc::ResponseError("headless world does not support console commands"); },
+        [&](auto, const auto &) -> CR { return rpc::ResponseError("command not supported by the headless world"); });
+
+    return boost::variant2::visit(command_visitor, command.command);
+  }
+
+  // ===========================================================================
+  // -- 仿真 --------------------------------------------------------------------
+  // ===========================================================================
+
+  void KinematicWorld::Integrate(Vehicle &vehicle, const float dt) const {
+    const auto &blueprint = _blueprints[vehicle.blueprint];
+    const auto &control = vehicle.control;
+    const float throttle = std::min(std::max(control.throttle, 0.0f), 1.0f);
+    const float brake = std::min(std::max(control.brake, 0.0f), 1.0f);
+    const float steer = std::min(std::max(control.steer, -1.0f), 1.0f);
+
+    // 纵向：油门加速，二次的阻力使全油门时的速度趋近 max_speed；刹车只减小速度的大小
+    const float direction = control.reverse ? -1.0f : 1.0f;
+    const float drag = blueprint.max_acceleration / (blueprint.max_speed * blueprint.max_speed);
+    float speed = vehicle.speed +
+        (direction * throttle * blueprint.max_acceleration - drag * vehicle.speed * std::abs(vehicle.speed)) * dt;
+    float deceleration = control.hand_brake ? blueprint.max_deceleration : brake * blueprint.max_deceleration;
+    if (throttle <= 0.0f) {
+      deceleration += ROLLING_DECELERATION;
+    }
+    const float decrement = deceleration * dt;
+    speed = std::abs(speed) <= decrement ? 0.0f : speed - std::copysign(decrement, speed);
+
+    // 横向：自行车模型，质心在轴距的中点；Unreal 的坐标系中偏航角增大是向右转
+    const float steer_angle = Math::ToRadians(steer * blueprint.max_steer_angle);
+    const float slip = std::atan(0.5f * std::tan(steer_angle));
+    const float average_speed = 0.5f * (vehicle.speed + speed);
+    const float yaw_rate = average_speed * std::cos(slip) * std::tan(steer_angle) / blueprint.wheelbase;
+    const float yaw = Math::ToRadians(vehicle.transform.rotation.yaw);
+    const float heading = yaw + slip + 0.5f * yaw_rate * dt;
+    vehicle.transform.location.x += average_speed * std::cos(heading) * dt;
+    vehicle.transform.location.y += average_speed * std::sin(heading) * dt;
+    vehicle.transform.rotation.yaw = NormalizeAngle(Math::ToDegrees(yaw + yaw_rate * dt));
+
+    const float new_heading = Math::ToRadians(vehicle.transform.rotation.yaw) + slip;
+    vehicle.speed = speed;
+    vehicle.velocity = {speed * std::cos(new_heading), speed * std::sin(new_heading), 0.0f};
+    vehicle.angular_velocity = {0.0f, 0.0f, Math::ToDegrees(yaw_rate)};
+  }
+
+  void KinematicWorld::MoveToTarget(Vehicle &vehicle, const float dt) const {
+    // 与 FKinematicVehicles::Integrate 相同：以给定的速率向目标移动，到达后停在目标处
+    const auto to_target = vehicle.target.location - vehicle.transform.location;
+    const float distance = to_target.Length();
+    const float step = vehicle.target_speed * dt;
+    const float alpha = distance <= step ? 1.0f : step / distance;
+    const auto displacement = alpha * to_target;
+    vehicle.transform.location += displacement;
+    auto &rotation = vehicle.transform.rotation;
+    const float previous_yaw = rotation.yaw;
+    rotation.pitch = InterpolateAngle(rotation.pitch, vehicle.target.rotation.pitch, alpha);
+    rotation.yaw = InterpolateAngle(rotation.yaw, vehicle.target.rotation.yaw, alpha);
+    rotation.roll = InterpolateAngle(rotation.roll, vehicle.target.rotation.roll, alpha);
+    vehicle.velocity = displacement * (1.0f / dt);
+    vehicle.angular_velocity = {0.0f, 0.0f, NormalizeAngle(rotation.yaw - previous_yaw) / dt};
+    const auto forward = vehicle.transform.GetForwardVector();
+    vehicle.speed = vehicle.velocity.x * forward.x + vehicle.velocity.y * forward.y + vehicle.velocity.z * forward.z;
+  }
+
+  void KinematicWorld::SnapToRoad(Vehicle &vehicle) const {
+    auto &location = vehicle.transform.location;
+    const auto waypoint = _map.GetClosestWaypointOnRoad(location);
+    if (!waypoint) {
+      return;
+    }
+    const auto road = _map.ComputeTransform(*waypoint);
+    // 离开道路的车辆保持原来的高度，避免贴到附近其他高度的道路上
+    const float dx = road.location.x - location.x;
+    const float dy = road.location.y - location.y;
+    const float lane_width = static_cast<float>(_map.GetLaneWidth(*waypoint));
+    if (dx * dx + dy * dy <= lane_width * lane_width) {
+      location.z = road.location.z;
+    }
+  }
+
+  void KinematicWorld::UpdateTriggers(Vehicle &vehicle) const {
+    // 与 Unreal 中相同：进入限速标志的触发区域后一直使用它的限速，
+    // 信号灯只在车辆处于它的触发区域中时有效
+    const auto triggers = _signals.FindTriggers(GetBox(vehicle));
+    if (triggers.speed_limit.has_value()) {
+      vehicle.speed_limit = *triggers.speed_limit;
+    }
+    vehicle.traffic_light = triggers.traffic_light != nullptr ? triggers.traffic_light->id : 0u;
+  }
+
+  void KinematicWorld::Tick(const double delta_seconds) {
+    ++_frame;
+    _elapsed_seconds += delta_seconds;
+    const float dt = static_cast<float>(delta_seconds);
+    _signals.Tick(dt);
+    if (dt <= 0.0f) {
+      return;
+    }
+    // 每辆车只修改自己的状态，可以并行
+    ParallelForChunks(_vehicles.size(), [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i) {
+        auto &vehicle = _vehicles[i];
+        const auto previous_velocity = vehicle.velocity;
+        if (vehicle.has_kinematic_target) {
+          MoveToTarget(vehicle, dt);
+        } else if (vehicle.simulate_physics) {
+          Integrate(vehicle, dt);
+          SnapToRoad(vehicle);
+        }
+        vehicle.acceleration = (vehicle.velocity - previous_velocity) * (1.0f / dt);
+        UpdateTriggers(vehicle);
+      }
+    }, MIN_VEHICLES_PER_TASK);
+  }
+
+  void KinematicWorld::GetActorStates(std::vector<sensor::data::ActorDynamicState> &states) const {
+    const auto &lights = _signals.GetTrafficLights();
+    states.clear();
+    states.resize(1u + lights.size() + _vehicles.size());
+
+    auto &spectator = states[0u];
+    spectator = sensor::data::ActorDynamicState{};
+    spectator.id = _spectator.id;
+    spectator.actor_state = rpc::ActorState::Active;
+    spectator.transform = _spectator_transform;
+
+    for (size_t i = 0u; i < lights.size(); ++i) {
+      auto &state = states[1u + i];
+      state = sensor::data::ActorDynamicState{};
+      state.id = lights[i].id;
+      state.actor_state = rpc::ActorState::Active;
+      state.transform = lights[i].transform;
+      _signals.GetState(lights[i], state);
+    }
+
+    for (size_t i = 0u; i < _vehicles.size(); ++i) {
+      const auto &vehicle = _vehicles[i];
+      auto &state = states[1u + lights.size() + i];
+      state = sensor::data::ActorDynamicState{};
+      state.id = vehicle.actor.id;
+      state.actor_state = rpc::ActorState::Active;
+      state.transform = vehicle.transform;
+      state.velocity = vehicle.velocity;
+      state.angular_velocity = vehicle.angular_velocity;
+      state.acceleration = vehicle.acceleration;
+      auto &data = state.state.vehicle_data;
+      data.control = vehicle.control;
+      data.speed_limit = vehicle.speed_limit;
+      const auto *light = _signals.GetTrafficLight(vehicle.traffic_light);
+      data.has_traffic_light = light != nullptr;
+      data.traffic_light_id = vehicle.traffic_light;
+      data.traffic_light_state = light != nullptr ? light->state : rpc::TrafficLightState::Green;
+      data.failure_state = rpc::VehicleFailureState::None;
+    }
+  }
+
+} // namespace headless
+} // namespace carla
@@ -0,0 +1,262 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/NonCopyable.h"
+#include "carla/headless/TrafficSignals.h"
+#include "carla/road/Map.h"
+#include "carla/rpc/Actor.h"
+#include "carla/rpc/ActorDefinition.h"
+#include "carla/rpc/Command.h"
+#include "carla/rpc/CommandResponse.h"
+#include "carla/rpc/EpisodeSettings.h"
+#include "carla/rpc/Response.h"
+#include "carla/rpc/VehicleControl.h"
+#include "carla/rpc/VehicleLightState.h"
+#include "carla/rpc/VehicleLightStateList.h"
+#include "carla/rpc/WeatherParameters.h"
+#include "carla/sensor/data/ActorDynamicState.h"
+
+#include <boost/optional.hpp>
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace carla {
+namespace headless {
+
+  /// 无头世界中一种车辆的尺寸和运动参数。
+  struct VehicleBlueprint {
+    /// 蓝图的 ID，必须以 "vehicle." 开头。
+    std::string id;
+
+    std::string base_type = "car";
+
+    int number_of_wheels = 4;
+
+    /// 包围盒的半尺寸，单位为米，包围盒的中心在车辆的原点上方 extent.z 处。
+    geom::Vector3D extent = {2.4f, 1.0f, 0.75f};
+
+    /// 轴距，单位为米。
+    float wheelbase = 2.9f;
+
+    /// 前轮的最大转角，单位为度；转向 1.0 对应这个角度。
+    float max_steer_angle = 70.0f;
+
+    /// 全油门时的最大加速度，单位为 m/s^2。
+    float max_acceleration = 4.0f;
+
+    /// 全刹车时的减速度，单位为 m/s^2。
+    float max_deceleration = 8.0f;
+
+    /// 全油门时的极限速度，单位为 m/s。
+    float max_speed = 50.0f;
+  };
+
+  /// @brief 只做运动学积分的仿真世界，实现交通管理器需要的那部分服务器功能。
+  ///
+  /// 车辆按自行车模型由 VehicleControl 积分位置，也支持交通管理器的混合物理模式
+  /// 使用的 ApplyTransform、ApplyKinematicTarget 和 SetSimulatePhysics；车辆之间
+  /// 不做碰撞。交通信号灯和限速标志由 TrafficSignals 生成，与 Unreal 中相同地
+  /// 影响车辆在 ActorDynamicState 中的限速和信号灯。
+  ///
+  /// 除 ApplyCommand 以外的函数都不是线程安全的，由 HeadlessServer 在同一线程中调用。
+  class KinematicWorld : private NonCopyable {
+  public:
+
+    /// 未进入限速标志触发区域的车辆的限速，单位为 km/h，与 Unreal 中相同。
+    static constexpr float DEFAULT_SPEED_LIMIT = 30.0f;
+
+    static std::vector<VehicleBlueprint> GetDefaultBlueprints();
+
+    KinematicWorld(road::Map map, std::vector<VehicleBlueprint> blueprints = GetDefaultBlueprints());
+
+    const road::Map &GetMap() const {
+      return _map;
+    }
+
+    uint64_t GetFrame() const {
+      return _frame;
+    }
+
+    double GetElapsedSeconds() const {
+      return _elapsed_seconds;
+    }
+
+    /// 道路上每隔一段距离的行车道位置，作为推荐的生成点。
+    const std::vector<geom::Transform> &GetSpawnPoints() const {
+      return _spawn_points;
+    }
+
+    const std::vector<rpc::ActorDefinition> &GetActorDefinitions() const {
+      return _definitions;
+    }
+
+    const rpc::EpisodeSettings &GetSettings() const {
+      return _settings;
+    }
+
+    void SetSettings(const rpc::EpisodeSettings &settings) {
+      _settings = settings;
+    }
+
+    const rpc::WeatherParameters &GetWeather() const {
+      return _weather;
+    }
+
+    void SetWeather(const rpc::WeatherParameters &weather) {
+      _weather = weather;
+    }
+
+    TrafficSignals &GetTrafficSignals() {
+      return _signals;
+    }
+
+    const TrafficSignals &GetTrafficSignals() const {
+      return _signals;
+    }
+
+    // =========================================================================
+    // -- 参与者 ---------------------------------------------------------------
+    // =========================================================================
+
+    rpc::Actor GetSpectator() const;
+
+    /// ID 不存在时返回空。
+    boost::optional<rpc::Actor> GetActor(rpc::ActorId id) const;
+
+    size_t GetNumberOfVehicles() const {
+      return _vehicles.size();
+    }
+
+    rpc::Response<rpc::Actor> SpawnActor(
+        const rpc::ActorDescription &description,
+        const geom::Transform &transform);
+
+    rpc::Response<bool> DestroyActor(rpc::ActorId id);
+
+    rpc::Response<void> SetActorLocation(rpc::ActorId id, const geom::Location &location);
+
+    rpc::Response<void> SetActorTransform(rpc::ActorId id, const geom::Transform &transform);
+
+    rpc::Response<void> SetActorTargetVelocity(rpc::ActorId id, const geom::Vector3D &velocity);
+
+    rpc::Response<void> SetActorSimulatePhysics(rpc::ActorId id, bool enabled);
+
+    rpc::Response<void> SetVehicleKinematicTarget(
+        rpc::ActorId id,
+        const geom::Transform &transform,
+        const geom::Vector3D &velocity);
+
+    rpc::Response<void> ApplyControlToVehicle(rpc::ActorId id, const rpc::VehicleControl &control);
+
+    rpc::Response<void> SetVehicleLightState(rpc::ActorId id, rpc::VehicleLightState::flag_type light_state);
+
+    rpc::Response<rpc::VehicleLightState::flag_type> GetVehicleLightState(rpc::ActorId id) const;
+
+    rpc::VehicleLightStateList GetVehiclesLightStates() const;
+
+    /// 执行一条批量命令，不支持的命令返回错误。
+    rpc::CommandResponse ApplyCommand(const rpc::Command &command);
+
+    // =========================================================================
+    // -- 仿真 -----------------------------------------------------------------
+    // =========================================================================
+
+    /// 推进 @a delta_seconds 秒：推进信号灯，积分所有车辆，更新车辆的触发区域。
+    void Tick(double delta_seconds);
+
+    /// 所有参与者的状态，顺序与 ID 无关但每帧相同时保持不变。
+    void GetActorStates(std::vector<sensor::data::ActorDynamicState> &states) const;
+
+  private:
+
+    struct Vehicle {
+      rpc::Actor actor;
+
+      size_t blueprint = 0u;
+
+      geom::Transform transform;
+
+      geom::Vector3D velocity;
+
+      geom::Vector3D angular_velocity;
+
+      geom::Vector3D acceleration;
+
+      /// 沿车头方向的速度，倒车时为负。
+      float speed = 0.0f;
+
+      rpc::VehicleControl control;
+
+      bool simulate_physics = true;
+
+      /// 为 true 时向 target 移动，见 SetVehicleKinematicTarget。
+      bool has_kinematic_target = false;
+
+      geom::Transform target;
+
+      float target_speed = 0.0f;
+
+      float speed_limit = DEFAULT_SPEED_LIMIT;
+
+      rpc::ActorId traffic_light = 0u;
+
+      rpc::VehicleLightState::flag_type light_state = 0u;
+    };
+
+    Vehicle *FindVehicle(rpc::ActorId id);
+
+    const Vehicle *FindVehicle(rpc::ActorId id) const;
+
+    OrientedBox GetBox(const Vehicle &vehicle) const;
+
+    /// 按控制积分车辆的运动。
+    void Integrate(Vehicle &vehicle, float delta_seconds) const;
+
+    /// 向运动学目标移动。
+    void MoveToTarget(Vehicle &vehicle, float delta_seconds) const;
+
+    /// 把车辆的高度放到最近的车道上。
+    void SnapToRoad(Vehicle &vehicle) const;
+
+    void UpdateTriggers(Vehicle &vehicle) const;
+
+    road::Map _map;
+
+    std::vector<VehicleBlueprint> _blueprints;
+
+    std::vector<rpc::ActorDefinition> _definitions;
+
+    std::vector<geom::Transform> _spawn_points;
+
+    rpc::Actor _spectator;
+
+    geom::Transform _spectator_transform;
+
+    TrafficSignals _signals;
+
+    std::vector<Vehicle> _vehicles;
+
+    /// 车辆 ID 到 _vehicles 中索引的映射。
+    std::unordered_map<rpc::ActorId, size_t> _vehicle_index;
+
+    rpc::ActorId _next_id;
+
+    uint64_t _frame = 0u;
+
+    double _elapsed_seconds = 0.0;
+
+    rpc::EpisodeSettings _settings;
+
+    rpc::WeatherParameters _weather;
+  };
+
+} // namespace headless
+} // namespace carla
@@ -0,0 +1,85 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/geom/Math.h"
+#include "carla/geom/Transform.h"
+#include "carla/geom/Vector3D.h"
+
+#include <cmath>
+
+namespace carla {
+namespace headless {
+
+  /// 只绕竖直轴旋转的盒子，用于车辆与触发区域的相交测试。
+  ///
+  /// 车辆和道路上的盒子的俯仰和横滚都很小，忽略它们后在水平面上用分离轴定理测试，
+  /// 竖直方向只比较高度区间。
+  class OrientedBox {
+  public:
+
+    OrientedBox() = default;
+
+    OrientedBox(const geom::Location &in_center, float yaw_degrees, const geom::Vector3D &in_extent)
+      : center(in_center),
+        extent(in_extent),
+        cos_yaw(std::cos(geom::Math::ToRadians(yaw_degrees))),
+        sin_yaw(std::sin(geom::Math::ToRadians(yaw_degrees))) {}
+
+    /// 由变换 @a transform 下中心在 @a local_center 处的盒子构造。
+    OrientedBox(
+        const geom::Transform &transform,
+        geom::Location local_center,
+        const geom::Vector3D &in_extent)
+      : OrientedBox(geom::Location{}, transform.rotation.yaw, in_extent) {
+      transform.TransformPoint(local_center);
+      center = local_center;
+    }
+
+    /// 外接圆在水平面上的半径。
+    float Radius() const {
+      return std::sqrt(extent.x * extent.x + extent.y * extent.y);
+    }
+
+    bool Overlaps(const OrientedBox &rhs) const {
+      if (std::abs(rhs.center.z - center.z) > extent.z + rhs.extent.z) {
+        return false;
+      }
+      const float dx = rhs.center.x - center.x;
+      const float dy = rhs.center.y - center.y;
+      // 两个盒子各自的两条边的方向就是全部的分离轴
+      const float axes[4u][2u] = {
+        {cos_yaw, sin_yaw}, {-sin_yaw, cos_yaw},
+        {rhs.cos_yaw, rhs.sin_yaw}, {-rhs.sin_yaw, rhs.cos_yaw}};
+      for (const auto &axis : axes) {
+        const float distance = std::abs(dx * axis[0u] + dy * axis[1u]);
+        if (distance > ProjectedRadius(axis) + rhs.ProjectedRadius(axis)) {
+          return false;
+        }
+      }
+      return true;
+    }
+
+    geom::Location center;
+
+    geom::Vector3D extent;
+
+  private:
+
+    float ProjectedRadius(const float (&axis)[2u]) const {
+      return
+          extent.x * std::abs(cos_yaw * axis[0u] + sin_yaw * axis[1u]) +
+          extent.y * std::abs(-sin_yaw * axis[0u] + cos_yaw * axis[1u]);
+    }
+
+    float cos_yaw = 1.0f;
+
+    float sin_yaw = 0.0f;
+  };
+
+} // namespace headless
+} // namespace carla
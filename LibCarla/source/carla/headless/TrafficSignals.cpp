@@ -0,0 +1,402 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/headless/TrafficSignals.h"
+
+#include "carla/Logging.h"
+#include "carla/geom/Math.h"
+#include "carla/road/SignalType.h"
+#include "carla/road/element/RoadInfoSignal.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <map>
+#include <set>
+
+namespace carla {
+namespace headless {
+
+namespace {
+
+  /// 触发区域网格的格子边长，单位为米。
+  constexpr float GRID_CELL_SIZE = 10.0f;
+
+  int32_t ToCell(float coordinate) {
+    return static_cast<int32_t>(std::floor(coordinate / GRID_CELL_SIZE));
+  }
+
+  uint64_t CellKey(int32_t x, int32_t y) {
+    return (static_cast<uint64_t>(static_cast<uint32_t>(x)) << 32u) | static_cast<uint32_t>(y);
+  }
+
+  /// 对盒子的水平外接正方形覆盖的每个格子调用 @a functor。
+  template <typename F>
+  void ForEachCell(const OrientedBox &box, F &&functor) {
+    const float radius = box.Radius();
+    const int32_t min_x = ToCell(box.center.x - radius);
+    const int32_t max_x = ToCell(box.center.x + radius);
+    const int32_t min_y = ToCell(box.center.y - radius);
+    const int32_t max_y = ToCell(box.center.y + radius);
+    for (int32_t x = min_x; x <= max_x; ++x) {
+      for (int32_t y = min_y; y <= max_y; ++y) {
+        functor(CellKey(x, y));
+      }
+    }
+  }
+
+} // namespace
+
+  // ===========================================================================
+  // -- 构造 --------------------------------------------------------------------
+  // ===========================================================================
+
+  TrafficSignals::TrafficSignals(const road::Map &map, rpc::ActorId first_id)
+    : _first_id(first_id) {
+    const auto &signals = map.GetSignals();
+    const auto &controllers = map.GetControllers();
+
+    // 与 ATrafficLightManager::SpawnTrafficLights 生成相同的信号灯；按 ID 排序使结果不依赖于哈希表的顺序
+    std::set<road::SignId> lights_to_spawn;
+    for (const auto &pair : controllers) {
+      for (const auto &sign_id : pair.second->GetSignals()) {
+        auto it = signals.find(sign_id);
+        if (it == signals.end()) {
+          log_warning("headless: possible OpenDRIVE error, reference to nonexistent signal id:", sign_id);
+          continue;
+        }
+        if (road::SignalType::IsTrafficLight(it->second->GetType())) {
+          lights_to_spawn.insert(sign_id);
+        }
+      }
+    }
+    for (const auto &pair : signals) {
+      const auto &signal = *pair.second;
+      if (signal.GetControllers().empty() &&
+          !map.IsJunction(signal.GetRoadId()) &&
+          road::SignalType::IsTrafficLight(signal.GetType())) {
+        lights_to_spawn.insert(pair.first);
+      }
+    }
+
+    // 与 ATrafficLightManager::RegisterLightComponentFromOpenDRIVE 相同地分组：
+    // 同一交叉口的控制器在一组，没有控制器的信号灯各自成组
+    std::map<road::JuncId, size_t> junction_groups;
+    std::map<road::ContId, size_t> controller_indices;
+    for (const auto &sign_id : lights_to_spawn) {
+      const auto &signal = *signals.at(sign_id);
+      size_t controller_index = 0u;
+      if (!signal.GetControllers().empty()) {
+        const auto &controller_id = *signal.GetControllers().begin();
+        const auto &junctions = controllers.at(controller_id)->GetJunctions();
+        if (junctions.empty()) {
+          log_error("headless: no junctions in traffic light controller", controller_id);
+          continue;
+        }
+        auto group = junction_groups.find(*junctions.begin());
+        if (group == junction_groups.end()) {
+          group = junction_groups.emplace(*junctions.begin(), _groups.size()).first;
+          _groups.emplace_back();
+        }
+        auto controller = controller_indices.find(controller_id);
+        if (controller == controller_indices.end()) {
+          controller = controller_indices.emplace(controller_id, _controllers.size()).first;
+          _controllers.emplace_back();
+          _controllers.back().group = group->second;
+          _groups[group->second].controllers.emplace_back(controller->second);
+        }
+        controller_index = controller->second;
+      } else {
+        controller_index = _controllers.size();
+        _controllers.emplace_back();
+        _controllers.back().group = _groups.size();
+        // 红灯的时长比默认的 2 秒长
+        _controllers.back().stages.back().time = 10.0f;
+        _groups.emplace_back();
+        _groups.back().controllers.emplace_back(controller_index);
+      }
+
+      auto &controller = _controllers[controller_index];
+      TrafficLight light;
+      light.id = _first_id + static_cast<rpc::ActorId>(_lights.size());
+      light.sign_id = sign_id;
+      light.transform = signal.GetTransform();
+      light.controller = controller_index;
+      light.group = controller.group;
+      light.pole_index = static_cast<uint32_t>(controller.lights.size());
+      controller.lights.emplace_back(_lights.size());
+      _lights.emplace_back(std::move(light));
+      AddTriggers(map, sign_id, true, _lights.size() - 1u, 0.0f);
+    }
+    ResetAllGroups();
+
+    // 限速标志只有触发区域
+    for (const auto &pair : signals) {
+      if (pair.second->GetType() == road::SignalType::MaximumSpeed()) {
+        AddTriggers(map, pair.first, false, 0u, static_cast<float>(pair.second->GetValue()));
+      }
+    }
+    log_info(
+        "headless:", _lights.size(), "traffic lights in", _groups.size(), "groups,",
+        _triggers.size(), "trigger volumes");
+  }
+
+  void TrafficSignals::AddTriggers(
+      const road::Map &map,
+      const road::SignId &sign_id,
+      const bool is_traffic_light,
+      const size_t light,
+      const float speed_limit) {
+    constexpr double epsilon = 0.00001;
+    for (const auto *reference : map.GetAllSignalReferences()) {
+      if (reference->GetSignalId() != sign_id) {
+        continue;
+      }
+      const auto road_id = reference->GetRoadId();
+      for (const auto &validity : reference->GetValidities()) {
+        for (const auto lane : geom::Math::GenerateRange(validity._from_lane, validity._to_lane)) {
+          if (lane == 0) {
+            continue;
+          }
+          auto waypoint = map.GetWaypoint(road_id, lane, reference->GetS());
+          if (!waypoint) {
+            continue;
+          }
+          // 与 UTrafficLightComponent 相同，不把信号灯的触发区域放在交叉口内
+          if (is_traffic_light && map.IsJunction(road_id)) {
+            auto predecessors = map.GetPredecessors(*waypoint);
+            if (predecessors.size() == 1u && !map.IsJunction(predecessors.front().road_id)) {
+              waypoint = predecessors.front();
+            }
+          }
+          const auto &lane_info = map.GetLane(*waypoint);
+          if (lane_info.GetType() != road::Lane::LaneType::Driving) {
+            continue;
+          }
+          const float lane_width = static_cast<float>(map.GetLaneWidth(*waypoint));
+          geom::Vector3D extent;
+          double offset = 0.0;
+          if (is_traffic_light) {
+            constexpr float box_length = 1.5f;
+            constexpr float additional_distance = 1.5f;
+            extent = {box_length, std::max(0.01f, 0.25f * lane_width), 1.0f};
+            offset = box_length + additional_distance;
+          } else {
+            const float box_size = std::max(0.01f, 0.35f * lane_width);
+            extent = {box_size, box_size, box_size};
+            offset = box_size;
+          }
+          const double distance = lane_info.GetDistance();
+          const double length = lane_info.GetLength();
+          const double s = lane < 0 ? waypoint->s - offset : waypoint->s + offset;
+          waypoint->s = std::min(std::max(s, distance + epsilon), distance + length - epsilon);
+          const auto transform = map.ComputeTransform(*waypoint);
+          AddTrigger(Trigger{
+              OrientedBox{transform.location, transform.rotation.yaw, extent},
+              light,
+              speed_limit,
+              is_traffic_light});
+        }
+      }
+    }
+  }
+
+  void TrafficSignals::AddTrigger(Trigger trigger) {
+    const size_t index = _triggers.size();
+    ForEachCell(trigger.box, [&](uint64_t key) { _grid[key].emplace_back(index); });
+    _triggers.emplace_back(std::move(trigger));
+  }
+
+  // ===========================================================================
+  // -- 信号灯的循环 ------------------------------------------------------------
+  // ===========================================================================
+
+  void TrafficSignals::SetControllerStage(Controller &controller, size_t stage) {
+    controller.current_stage = stage;
+    const auto state = controller.stages[stage].state;
+    for (auto light : controller.lights) {
+      _lights[light].state = state;
+    }
+  }
+
+  void TrafficSignals::StartCycle(Controller &controller) {
+    controller.elapsed = 0.0f;
+    SetControllerStage(controller, 0u);
+  }
+
+  void TrafficSignals::ResetController(Controller &controller) {
+    SetControllerStage(controller, controller.stages.size() - 1u);
+    controller.elapsed = 0.0f;
+  }
+
+  bool TrafficSignals::AdvanceController(Controller &controller, float delta_seconds) {
+    controller.elapsed += delta_seconds;
+    if (controller.elapsed > controller.stages[controller.current_stage].time) {
+      controller.elapsed = 0.0f;
+      if (controller.current_stage == controller.stages.size() - 1u) {
+        return true;
+      }
+      SetControllerStage(controller, controller.current_stage + 1u);
+    }
+    return false;
+  }
+
+  void TrafficSignals::ResetGroup(Group &group) {
+    for (auto controller : group.controllers) {
+      ResetController(_controllers[controller]);
+    }
+    group.current_controller = 0u;
+    StartCycle(_controllers[group.controllers[0u]]);
+  }
+
+  void TrafficSignals::Tick(float delta_seconds) {
+    for (auto &group : _groups) {
+      if (group.frozen) {
+        continue;
+      }
+      auto &controller = _controllers[group.controllers[group.current_controller]];
+      if (AdvanceController(controller, delta_seconds)) {
+        group.current_controller = (group.current_controller + 1u) % group.controllers.size();
+        StartCycle(_controllers[group.controllers[group.current_controller]]);
+      }
+    }
+  }
+
+  void TrafficSignals::ResetAllGroups() {
+    for (auto &group : _groups) {
+      ResetGroup(group);
+    }
+  }
+
+  void TrafficSignals::FreezeAll(bool frozen) {
+    for (auto &group : _groups) {
+      group.frozen = frozen;
+    }
+  }
+
+  // ===========================================================================
+  // -- 单个信号灯 --------------------------------------------------------------
+  // ===========================================================================
+
+  const TrafficLight *TrafficSignals::FindLight(rpc::ActorId id) const {
+    if (id < _first_id || id - _first_id >= _lights.size()) {
+      return nullptr;
+    }
+    return &_lights[id - _first_id];
+  }
+
+  const TrafficLight *TrafficSignals::GetTrafficLight(rpc::ActorId id) const {
+    return FindLight(id);
+  }
+
+  bool TrafficSignals::SetState(rpc::ActorId id, rpc::TrafficLightState state) {
+    const auto *light = FindLight(id);
+    if (light == nullptr) {
+      return false;
+    }
+    _lights[id - _first_id].state = state;
+    return true;
+  }
+
+  bool TrafficSignals::SetStageTime(rpc::ActorId id, rpc::TrafficLightState state, float seconds) {
+    const auto *light = FindLight(id);
+    if (light == nullptr) {
+      return false;
+    }
+    for (auto &stage : _controllers[light->controller].stages) {
+      if (stage.state == state) {
+        stage.time = seconds;
+      }
+    }
+    return true;
+  }
+
+  bool TrafficSignals::Freeze(rpc::ActorId id, bool frozen) {
+    const auto *light = FindLight(id);
+    if (light == nullptr) {
+      return false;
+    }
+    _groups[light->group].frozen = frozen;
+    return true;
+  }
+
+  bool TrafficSignals::ResetGroup(rpc::ActorId id) {
+    const auto *light = FindLight(id);
+    if (light == nullptr) {
+      return false;
+    }
+    ResetGroup(_groups[light->group]);
+    return true;
+  }
+
+  std::vector<rpc::ActorId> TrafficSignals::GetGroup(rpc::ActorId id) const {
+    std::vector<rpc::ActorId> result;
+    const auto *light = FindLight(id);
+    if (light != nullptr) {
+      for (auto controller : _groups[light->group].controllers) {
+        for (auto index : _controllers[controller].lights) {
+          result.emplace_back(_lights[index].id);
+        }
+      }
+    }
+    return result;
+  }
+
+  void TrafficSignals::GetState(
+      const TrafficLight &light,
+      sensor::data::ActorDynamicState &state) const {
+    const auto &controller = _controllers[light.controller];
+    auto &data = state.state.traffic_light_data;
+    std::memset(data.sign_id, 0, sizeof(data.sign_id));
+    std::strncpy(data.sign_id, light.sign_id.c_str(), sizeof(data.sign_id) - 1u);
+    data.green_time = data.yellow_time = data.red_time = 0.0f;
+    for (const auto &stage : controller.stages) {
+      switch (stage.state) {
+        case rpc::TrafficLightState::Green:  data.green_time = stage.time;  break;
+        case rpc::TrafficLightState::Yellow: data.yellow_time = stage.time; break;
+        case rpc::TrafficLightState::Red:    data.red_time = stage.time;    break;
+        default: break;
+      }
+    }
+    data.elapsed_time = controller.elapsed;
+    data.pole_index = light.pole_index;
+    data.time_is_frozen = _groups[light.group].frozen;
+    data.state = light.state;
+  }
+
+  // ===========================================================================
+  // -- 触发区域 ----------------------------------------------------------------
+  // ===========================================================================
+
+  TriggerResult TrafficSignals::FindTriggers(const OrientedBox &box) const {
+    TriggerResult result;
+    // 一个触发区域可能在多个格子中，取索引最小的相交区域使结果与遍历顺序无关
+    size_t light_trigger = _triggers.size();
+    size_t speed_trigger = _triggers.size();
+    ForEachCell(box, [&](uint64_t key) {
+      auto cell = _grid.find(key);
+      if (cell == _grid.end()) {
+        return;
+      }
+      for (auto index : cell->second) {
+        const auto &trigger = _triggers[index];
+        size_t &found = trigger.is_traffic_light ? light_trigger : speed_trigger;
+        if (index < found && trigger.box.Overlaps(box)) {
+          found = index;
+        }
+      }
+    });
+    if (light_trigger < _triggers.size()) {
+      result.traffic_light = &_lights[_triggers[light_trigger].light];
+    }
+    if (speed_trigger < _triggers.size()) {
+      result.speed_limit = _triggers[speed_trigger].speed_limit;
+    }
+    return result;
+  }
+
+} // namespace headless
+} // namespace carla
@@ -0,0 +1,169 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/NonCopyable.h"
+#include "carla/headless/OrientedBox.h"
+#include "carla/road/Map.h"
+#include "carla/rpc/ActorId.h"
+#include "carla/rpc/TrafficLightState.h"
+#include "carla/sensor/data/ActorDynamicState.h"
+
+#include <boost/optional.hpp>
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace carla {
+namespace headless {
+
+  /// 地图中的一个交通信号灯，ID 连续分配。
+  struct TrafficLight {
+    rpc::ActorId id = 0u;
+
+    road::SignId sign_id;
+
+    geom::Transform transform;
+
+    /// 所属的控制器和信号灯组在 TrafficSignals 中的索引。
+    size_t controller = 0u;
+
+    size_t group = 0u;
+
+    /// 在控制器中的序号。
+    uint32_t pole_index = 0u;
+
+    rpc::TrafficLightState state = rpc::TrafficLightState::Red;
+  };
+
+  /// 车辆在一帧中所在的触发区域。
+  struct TriggerResult {
+    /// 车辆所在触发区域的交通信号灯，不在任何触发区域中时为空。
+    const TrafficLight *traffic_light = nullptr;
+
+    /// 车辆所在限速标志触发区域的限速，单位为 km/h。
+    boost::optional<float> speed_limit;
+  };
+
+  /// @brief 由 OpenDRIVE 地图生成的交通信号灯和限速标志。
+  ///
+  /// 信号灯的分组、各阶段的时长、循环的方式和触发区域的大小都与 Unreal 中的
+  /// ATrafficLightManager、UTrafficLightController、UTrafficLightGroup、
+  /// UTrafficLightComponent 和 USpeedLimitComponent 相同，使交通管理器得到
+  /// 与在 Unreal 中运行时相同的信号灯状态。
+  class TrafficSignals : private NonCopyable {
+  public:
+
+    /// 为地图中的交通信号灯分配从 @a first_id 开始的连续 ID。
+    TrafficSignals(const road::Map &map, rpc::ActorId first_id);
+
+    const std::vector<TrafficLight> &GetTrafficLights() const {
+      return _lights;
+    }
+
+    /// ID 不是交通信号灯时返回空指针。
+    const TrafficLight *GetTrafficLight(rpc::ActorId id) const;
+
+    /// 推进所有未冻结的信号灯组。
+    void Tick(float delta_seconds);
+
+    void ResetAllGroups();
+
+    void FreezeAll(bool frozen);
+
+    /// 以下函数的 ID 不是交通信号灯时返回 false。
+
+    bool SetState(rpc::ActorId id, rpc::TrafficLightState state);
+
+    /// 设置信号灯所在控制器中 @a state 阶段的时长。
+    bool SetStageTime(rpc::ActorId id, rpc::TrafficLightState state, float seconds);
+
+    bool Freeze(rpc::ActorId id, bool frozen);
+
+    bool ResetGroup(rpc::ActorId id);
+
+    /// 与信号灯在同一组中的所有信号灯，包括它自己。
+    std::vector<rpc::ActorId> GetGroup(rpc::ActorId id) const;
+
+    /// 填写信号灯在 ActorDynamicState 中的数据。
+    void GetState(const TrafficLight &light, sensor::data::ActorDynamicState &state) const;
+
+    /// 找到与车辆的盒子 @a box 相交的触发区域，可以在多个线程中同时调用。
+    TriggerResult FindTriggers(const OrientedBox &box) const;
+
+  private:
+
+    struct Stage {
+      rpc::TrafficLightState state;
+      float time;
+    };
+
+    struct Controller {
+      std::vector<size_t> lights;
+      /// 绿灯、黄灯、红灯，与 UTrafficLightController 的默认值相同。
+      std::vector<Stage> stages = {
+          {rpc::TrafficLightState::Green, 10.0f},
+          {rpc::TrafficLightState::Yellow, 3.0f},
+          {rpc::TrafficLightState::Red, 2.0f}};
+      size_t current_stage = 0u;
+      float elapsed = 0.0f;
+      size_t group = 0u;
+    };
+
+    struct Group {
+      std::vector<size_t> controllers;
+      size_t current_controller = 0u;
+      bool frozen = false;
+    };
+
+    struct Trigger {
+      OrientedBox box;
+      /// 交通信号灯的索引，或限速标志的限速。
+      size_t light;
+      float speed_limit;
+      bool is_traffic_light;
+    };
+
+    const TrafficLight *FindLight(rpc::ActorId id) const;
+
+    void AddTriggers(
+        const road::Map &map,
+        const road::SignId &sign_id,
+        bool is_traffic_light,
+        size_t light,
+        float speed_limit);
+
+    void AddTrigger(Trigger trigger);
+
+    void SetControllerStage(Controller &controller, size_t stage);
+
+    void StartCycle(Controller &controller);
+
+    void ResetController(Controller &controller);
+
+    bool AdvanceController(Controller &controller, float delta_seconds);
+
+    void ResetGroup(Group &group);
+
+    const rpc::ActorId _first_id;
+
+    std::vector<TrafficLight> _lights;
+
+    std::vector<Controller> _controllers;
+
+    std::vector<Group> _groups;
+
+    std::vector<Trigger> _triggers;
+
+    /// 水平面上的网格，每个格子中是与它相交的触发区域的索引。
+    std::unordered_map<uint64_t, std::vector<size_t>> _grid;
+  };
+
+} // namespace headless
+} // namespace carla
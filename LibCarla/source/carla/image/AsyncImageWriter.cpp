@@ -0,0 +1,139 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/image/AsyncImageWriter.h"
+
+#include "carla/Logging.h"
+
+#include <algorithm>
+#include <exception>
+#include <thread>
+
+namespace carla {
+namespace image {
+
+  static std::mutex SHARED_WRITER_MUTEX;
+
+  static std::shared_ptr<AsyncImageWriter> SHARED_WRITER;
+
+  std::shared_ptr<AsyncImageWriter> AsyncImageWriter::Get() {
+    std::lock_guard<std::mutex> lock(SHARED_WRITER_MUTEX);
+    if (SHARED_WRITER == nullptr) {
+      // 编码主要受 CPU 限制，占用一半的硬件线程，最多四个，以免和模拟争抢 CPU。
+      const size_t workers = std::min(4u, std::max(1u, std::thread::hardware_concurrency() / 2u));
+      SHARED_WRITER = std::make_shared<AsyncImageWriter>(workers, 4u * workers);
+    }
+    return SHARED_WRITER;
+  }
+
+  void AsyncImageWriter::Shutdown() {
+    std::shared_ptr<AsyncImageWriter> writer;
+    {
+      std::lock_guard<std::mutex> lock(SHARED_WRITER_MUTEX);
+      std::swap(writer, SHARED_WRITER);
+    }
+    if (writer == nullptr) {
+      return;
+    }
+    // 等待正在 Push 的线程放开实例，保证析构在这里进行。交换之后的 Get()
+    // 得到新的实例，不会再增加这个实例的引用
+    while (writer.use_count() > 1) {
+      std::this_thread::yield();
+    }
+    // 析构函数等待剩余的任务，不持有锁，回调中仍然可以调用 Get()
+    writer.reset();
+  }
+
+  AsyncImageWriter::AsyncImageWriter(const size_t number_of_workers, const size_t queue_capacity)
+    : _number_of_workers(std::max<size_t>(1u, number_of_workers)),
+      _queue_capacity(std::max<size_t>(1u, queue_capacity)) {
+    for (size_t i = 0u; i < _number_of_workers; ++i) {
+      _workers.CreateThread([this]() { WorkerLoop(); });
+    }
+  }
+
+  AsyncImageWriter::~AsyncImageWriter() {
+    Wait();
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _stop = true;
+    }
+    _work.notify_all();
+    _workers.JoinAll();
+  }
+
+  void AsyncImageWriter::Push(WriteFunctionType write, CallbackFunctionType callback) {
+    {
+      std::unique_lock<std::mutex> lock(_mutex);
+      _progress.wait(lock, [this]() { return _queue.size() < _queue_capacity; });
+      _queue.push_back(Item{std::move(write), std::move(callback)});
+      ++_pending;
+    }
+    _work.notify_one();
+  }
+
+  void AsyncImageWriter::Wait() {
+    std::unique_lock<std::mutex> lock(_mutex);
+    _progress.wait(lock, [this]() { return _pending == 0u; });
+  }
+
+  size_t AsyncImageWriter::GetNumberOfPendingWrites() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _pending;
+  }
+
+  void AsyncImageWriter::WorkerLoop() {
+    while (true) {
+      Item item;
+      {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _work.wait(lock, [this]() { return _stop || !_queue.empty(); });
+        if (_queue.empty()) {
+          return;
+        }
+        item = std::move(_queue.front());
+        _queue.pop_front();
+      }
+      // 队列有了空位
+      _progress.notify_all();
+      Execute(item);
+      // 在计数减少之前释放任务持有的资源，Wait 返回后图像数据不再被引用
+      item = Item{};
+      {
+        std::lock_guard<std::mutex> lock(_mutex);
+        --_pending;
+      }
+      _progress.notify_all();
+    }
+  }
+
+  void AsyncImageWriter::Execute(Item &item) {
+    std::string path;
+    std::string error;
+    try {
+      path = item.write();
+    } catch (const std::exception &e) {
+      error = e.what();
+    } catch (...) {
+      error = "unknown error";
+    }
+    if (!item.callback) {
+      if (!error.empty()) {
+        log_error("failed to write image:", error);
+      }
+      return;
+    }
+    try {
+      item.callback(path, error);
+    } catch (const std::exception &e) {
+      log_error("exception thrown in image writer callback:", e.what());
+    } catch (...) {
+      log_error("unknown exception thrown in image writer callback");
+    }
+  }
+
+} // namespace image
+} // namespace carla
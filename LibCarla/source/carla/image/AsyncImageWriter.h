@@ -0,0 +1,105 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/NonCopyable.h"
+#include "carla/ThreadGroup.h"
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace carla {
+namespace image {
+
+  /// 在后台线程中编码并写入图像。
+  ///
+  /// 图像的编码（特别是 PNG 的压缩）通常比传感器产生图像慢，同步写入会阻塞
+  /// 调用线程。写入任务由固定数量的工作线程执行；队列长度有上限，队列已满时
+  /// Push 阻塞调用线程，生产速度持续高于写入速度时内存不会无限增长。
+  class AsyncImageWriter : private NonCopyable {
+  public:
+
+    /// 写入任务，在工作线程中执行，返回写入的文件路径。
+    using WriteFunctionType = std::function<std::string()>;
+
+    /// 写入结束后在工作线程中调用，参数为文件路径和错误信息（成功时为空）。
+    /// 写入失败时文件路径为空。
+    using CallbackFunctionType = std::function<void(const std::string &, const std::string &)>;
+
+    /// 进程内共享的实例，第一次使用时创建，由 Shutdown() 销毁。返回的指针
+    /// 只应在一次调用期间持有，不要长期保存。
+    static std::shared_ptr<AsyncImageWriter> Get();
+
+    /// 等待共享实例中的所有任务及其回调执行完毕并结束其工作线程。回调依赖的
+    /// 环境（例如 Python 解释器）被销毁之前调用。
+    ///
+    /// 其他线程可能刚通过 Get() 取得实例、正在调用 Push()（例如传感器回调
+    /// 线程中的 save_to_disk）；Shutdown() 会等这些调用放开实例后再销毁它，
+    /// 它们加入的任务和回调也在 Shutdown() 返回之前执行完毕。Shutdown()
+    /// 之后的 Get() 会创建新的实例，不再受这次 Shutdown() 的保护，需要调用方
+    /// 自己避免，Python 绑定在解释器退出后改为同步写入。
+    static void Shutdown();
+
+    AsyncImageWriter(size_t number_of_workers, size_t queue_capacity);
+
+    /// 等待队列中的所有任务执行完毕。
+    ~AsyncImageWriter();
+
+    size_t GetNumberOfWorkers() const {
+      return _number_of_workers;
+    }
+
+    /// 加入一个写入任务，队列已满时阻塞直到有空位。不能在回调中调用，否则
+    /// 所有工作线程都可能在等待自己。
+    void Push(WriteFunctionType write, CallbackFunctionType callback = nullptr);
+
+    /// 等待已加入的所有任务及其回调执行完毕。
+    void Wait();
+
+    /// 已加入但还没有执行完毕的任务数。
+    size_t GetNumberOfPendingWrites() const;
+
+  private:
+
+    struct Item {
+      WriteFunctionType write;
+      CallbackFunctionType callback;
+    };
+
+    void WorkerLoop();
+
+    static void Execute(Item &item);
+
+    const size_t _number_of_workers;
+
+    const size_t _queue_capacity;
+
+    mutable std::mutex _mutex;
+
+    /// 队列非空或停止时通知工作线程
+    std::condition_variable _work;
+
+    /// 队列有空位或任务完成时通知等待的线程
+    std::condition_variable _progress;
+
+    std::deque<Item> _queue;
+
+    /// 已加入但还没有执行完毕的任务数，包括正在执行的任务
+    size_t _pending = 0u;
+
+    bool _stop = false;
+
+    ThreadGroup _workers;
+  };
+
+} // namespace image
+} // namespace carla
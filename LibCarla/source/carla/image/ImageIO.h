@@ -26,6 +26,17 @@ namespace image {  // 定义命名空间 image
       IO::write_view(out_filename, image_view);  // 调用 IO 类的 write_view 方法写入图像视图
       return out_filename;  // 返回输出文件名
     }
+
+    // 与上面相同，使用 options 中的编码参数
+    template <typename ViewT, typename IO = io::any>
+    static std::string WriteView(
+        std::string out_filename,
+        const ViewT &image_view,
+        const io::write_options &options,
+        IO = IO()) {
+      IO::write_view(out_filename, image_view, options);
+      return out_filename;
+    }
   };
 
 } // namespace image
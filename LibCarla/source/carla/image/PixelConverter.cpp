@@ -0,0 +1,127 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/image/PixelConverter.h"
+
+#include "carla/TaskScheduler.h"
+#include "carla/image/CityScapesPalette.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace carla {
+namespace image {
+
+  constexpr float PixelConverter::DEPTH_FAR_PLANE;
+
+namespace {
+
+  /// 每个并行任务至少处理的像素数，更小的图像由调用线程直接转换
+  constexpr size_t MIN_PIXELS_PER_TASK = 64u * 1024u;
+
+  /// BGRA8 像素中各通道的字节偏移
+  constexpr size_t B = 0u, G = 1u, R = 2u, A = 3u;
+
+  /// 在块的循环中先把指针复制到局部变量：通过 uint8_t 指针的写入可能修改
+  /// lambda 捕获的成员，编译器否则每次迭代都要重新读取指针，无法向量化。
+  template <typename FuncT>
+  void ForEachChunk(size_t number_of_pixels, FuncT &&function) {
+    TaskScheduler::Get().ParallelForChunks(number_of_pixels, function, MIN_PIXELS_PER_TASK);
+  }
+
+  /// 归一化的深度，计算顺序与 ColorConverter::Depth 相同以保证结果一致
+  inline float NormalizedDepth(const uint8_t *pixel) {
+    const float depth = static_cast<float>(pixel[R] + (pixel[G] * 256) + (pixel[B] * 256 * 256));
+    return depth / static_cast<float>(256 * 256 * 256 - 1);
+  }
+
+  /// 与 Boost.GIL 的 float 到 uint8 通道转换相同
+  inline uint8_t ToChannel(float value) {
+    return static_cast<uint8_t>(value * 255.0f + 0.5f);
+  }
+
+  inline void WriteGray(uint8_t *pixel, uint8_t value) {
+    pixel[B] = value;
+    pixel[G] = value;
+    pixel[R] = value;
+    pixel[A] = 255u;
+  }
+
+} // namespace
+
+  void PixelConverter::DepthInPlace(uint8_t *bgra, const size_t number_of_pixels) {
+    ForEachChunk(number_of_pixels, [bgra](size_t begin, size_t end) {
+      uint8_t *pixels = bgra;
+      for (size_t i = begin; i < end; ++i) {
+        uint8_t *pixel = pixels + 4u * i;
+        WriteGray(pixel, ToChannel(NormalizedDepth(pixel)));
+      }
+    });
+  }
+
+  void PixelConverter::LogarithmicDepthInPlace(uint8_t *bgra, const size_t number_of_pixels) {
+    ForEachChunk(number_of_pixels, [bgra](size_t begin, size_t end) {
+      uint8_t *pixels = bgra;
+      for (size_t i = begin; i < end; ++i) {
+        uint8_t *pixel = pixels + 4u * i;
+        // 与 ColorConverter::LogarithmicLinear 相同
+        const float value = 1.0f + std::log(NormalizedDepth(pixel)) / 5.70378f;
+        const float clamped = std::max(std::min(value, 1.0f), 0.005f);
+        WriteGray(pixel, ToChannel(clamped));
+      }
+    });
+  }
+
+  void PixelConverter::CityScapesPaletteInPlace(uint8_t *bgra, const size_t number_of_pixels) {
+    // 标签只有 256 种，预先算出每个标签对应的 BGRA 像素
+    static const auto table = []() {
+      struct { uint8_t pixels[256u][4u]; } result;
+      for (size_t tag = 0u; tag < 256u; ++tag) {
+        const auto color = CityScapesPalette::GetColor(static_cast<uint8_t>(tag));
+        result.pixels[tag][B] = color[2u];
+        result.pixels[tag][G] = color[1u];
+        result.pixels[tag][R] = color[0u];
+        result.pixels[tag][A] = 255u;
+      }
+      return result;
+    }();
+    ForEachChunk(number_of_pixels, [bgra](size_t begin, size_t end) {
+      uint8_t *pixels = bgra;
+      for (size_t i = begin; i < end; ++i) {
+        uint8_t *pixel = pixels + 4u * i;
+        std::copy_n(table.pixels[pixel[R]], 4u, pixel);
+      }
+    });
+  }
+
+  void PixelConverter::DepthToMeters(
+      const uint8_t *bgra,
+      const size_t number_of_pixels,
+      float *out) {
+    ForEachChunk(number_of_pixels, [bgra, out](size_t begin, size_t end) {
+      const uint8_t *pixels = bgra;
+      float *result = out;
+      for (size_t i = begin; i < end; ++i) {
+        result[i] = NormalizedDepth(pixels + 4u * i) * DEPTH_FAR_PLANE;
+      }
+    });
+  }
+
+  void PixelConverter::ExtractLabels(
+      const uint8_t *bgra,
+      const size_t number_of_pixels,
+      uint8_t *out) {
+    ForEachChunk(number_of_pixels, [bgra, out](size_t begin, size_t end) {
+      const uint8_t *pixels = bgra;
+      uint8_t *result = out;
+      for (size_t i = begin; i < end; ++i) {
+        result[i] = pixels[4u * i + R];
+      }
+    });
+  }
+
+} // namespace image
+} // namespace carla
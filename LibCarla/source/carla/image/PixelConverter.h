@@ -0,0 +1,44 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace carla {
+namespace image {
+
+  /// 直接在传感器图像的 BGRA8 像素缓冲区上执行的颜色转换。
+  ///
+  /// 原地转换的结果与 ImageConverter::ConvertInPlace 使用 ColorConverter 在
+  /// Boost.GIL 视图上得到的结果逐字节相同，但每个转换都是对连续内存的简单循环，
+  /// 编译器可以将其向量化，不再逐像素调用转换函数；较大的图像分块在
+  /// TaskScheduler 中并行处理。
+  class PixelConverter {
+  public:
+
+    /// 深度相机的远裁剪面（米），归一化深度 1 对应的距离。
+    static constexpr float DEPTH_FAR_PLANE = 1000.0f;
+
+    /// 与 ColorConverter::Depth 相同，写入线性灰度。
+    static void DepthInPlace(uint8_t *bgra, size_t number_of_pixels);
+
+    /// 与 ColorConverter::LogarithmicDepth 相同，写入对数灰度。
+    static void LogarithmicDepthInPlace(uint8_t *bgra, size_t number_of_pixels);
+
+    /// 与 ColorConverter::CityScapesPalette 相同，按红色通道中的标签写入颜色。
+    static void CityScapesPaletteInPlace(uint8_t *bgra, size_t number_of_pixels);
+
+    /// 将编码在深度图像中的深度解码为米，写入 @a out 的 @a number_of_pixels 个元素。
+    static void DepthToMeters(const uint8_t *bgra, size_t number_of_pixels, float *out);
+
+    /// 将语义分割图像的标签（红色通道）写入 @a out 的 @a number_of_pixels 个元素。
+    static void ExtractLabels(const uint8_t *bgra, size_t number_of_pixels, uint8_t *out);
+  };
+
+} // namespace image
+} // namespace carla
@@ -18,14 +18,44 @@ enum MultiGPUCommand : uint32_t {
   ENABLE_ROS,  // 启用ROS（Robot Operating System）集成，ROS是一个用于机器人开发的灵活框架
   DISABLE_ROS, // 禁用ROS集成
   IS_ENABLED_ROS, // 查询ROS集成是否启用
-  YOU_ALIVE // 一种心跳或存活检查命令，用于确认接收方是否在线或响应
+  YOU_ALIVE, // 一种心跳或存活检查命令，用于确认接收方是否在线或响应
+  GET_LOAD, // 查询次级服务器的负载，回答为 SecondaryLoad
+  FRAME_DONE, // 次级服务器处理完一帧后主动发送，数据为 FrameDone
+  SHARED_MEMORY, // 主服务器提供共享内存环形缓冲区，数据为其名称；回答为1字节，1表示已打开
+  SHARED_MEMORY_DATA, // 命令在共享内存中，数据为 SharedMemoryRing::Descriptor
+  MAP_STATUS // 次级服务器加载地图的进度，收到 LOAD_MAP 和加载完成时主动发送，数据为 MapStatus
 };
 // 定义一个结构体CommandHeader，用于表示命令的头部信息  
-// 头部信息通常包括命令的标识符和后续数据的大小
+// 头部信息通常包括命令的标识符和后续数据的大小。
+// 次级服务器的回答也以它开头，id 为所回答的命令，以便与 FRAME_DONE 区分
 struct CommandHeader {
   MultiGPUCommand id; // 命令的标识符，从MultiGPUCommand枚举中选择
   uint32_t size; // 跟随此头部之后的数据的大小（以字节为单位
 };
 
+// 次级服务器上一帧的耗时，路由器据此放置新的传感器
+struct SecondaryLoad {
+  float frame_time; // 游戏线程和渲染线程中较长的一个，单位为毫秒
+  float gpu_time;   // GPU 的帧时间，单位为毫秒
+};
+
+enum MapLoadStage : uint32_t {
+  MAP_LOAD_STARTED = 0, // 收到 LOAD_MAP，开始加载
+  MAP_LOAD_DONE         // 地图已加载，可以处理新地图的帧数据
+};
+
+struct MapStatus {
+  MapLoadStage stage;
+  float elapsed;      // 从收到 LOAD_MAP 到这个阶段的时间，单位为毫秒
+};
+
+struct FrameDone {
+  uint64_t frame;     // 处理完的帧号
+  float apply_time;   // 应用帧数据的时间，单位为毫秒
+  float render_time;  // 渲染线程和 GPU 中较长的帧时间，单位为毫秒
+  float busy_time;    // 从收到帧数据到发送 FRAME_DONE 的时间，单位为毫秒
+  float reserved;
+};
+
 }  // namespace multigpu 结束multigpu命名空间的定义
 } // namespace carla 结束carla命名空间的定义
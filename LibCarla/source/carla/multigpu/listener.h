@@ -62,6 +62,16 @@ namespace multigpu {
 
     void Stop(); // 停止监听TCP连接
 
+    /// 设置同一主机上的次级服务器经共享内存接收命令时每个会话的环形缓冲区容量，
+    /// 为0时只使用TCP，仅对新建立的会话有效
+    void SetSharedMemoryCapacity(uint64_t capacity) {
+      _shared_memory_capacity = capacity;
+    }
+
+    uint64_t GetSharedMemoryCapacity() const {
+      return _shared_memory_capacity;
+    }
+
   private:
 
     void OpenSession(
@@ -76,6 +86,8 @@ namespace multigpu {
     boost::asio::io_context         &_io_context; // 引用io_context
     boost::asio::ip::tcp::acceptor  _acceptor; // TCP acceptor对象，用于接受新的TCP连接
     std::atomic<time_duration>      _timeout; // 原子变量，用于存储会话超时时间
+
+    std::atomic<uint64_t>           _shared_memory_capacity{0u}; // 共享内存环形缓冲区的容量，为0时不启用
   };
 
 } // namespace multigpu
@@ -12,6 +12,8 @@
 #include "carla/Logging.h"///< 包含CARLA的日志记录功能，可能定义了日志记录器、日志级别和日志消息格式等。
 #include "carla/multigpu/incomingMessage.h"///< 包含CARLA多GPU支持中接收消息的相关类和函数。
 #include "carla/multigpu/listener.h"///< 包含CARLA多GPU支持中监听网络通信的相关类和函数。
+#include "carla/multigpu/commands.h"///< 包含CARLA多GPU支持中的命令定义。
+#include "carla/ListView.h"///< 包含CARLA的列表视图，用于跳过消息中的大小字段。
 /// @brief 包含Boost.Asio库的头文件，用于网络编程和异步I/O操作。 
 #include <boost/asio/read.hpp>///< Boost.Asio库中的读操作函数，用于从网络套接字读取数据。
 #include <boost/asio/write.hpp> ///< Boost.Asio库中的写操作函数，用于向网络套接字写入数据。 
@@ -19,6 +21,7 @@
 #include <boost/asio/post.hpp> ///< Boost.Asio库中的post函数，用于将任务异步地发布到执行器上执行。
 /// @brief 包含C++标准库的头文件，用于多线程编程和原子操作。  
 #include <atomic>///< C++标准库中的原子操作类，用于实现线程安全的计数器、标志位等。
+#include <cstring>///< C++标准库中的内存操作函数，用于解析命令头。
 #include <thread>///< C++标准库中的线程类和相关函数，用于创建和管理线程。
 
 namespace carla {
@@ -34,6 +37,20 @@ namespace multigpu {
   * 这是一个线程安全的计数器，用于为每个新的Primary会话实例分配一个唯一的会话ID。
   */
   static std::atomic_size_t SESSION_COUNTER{0u};
+
+#pragma pack(push, 1)
+
+  // 命令在共享内存中时经TCP发送的消息，格式与普通消息相同
+  struct SharedMemoryNotification {
+    carla::streaming::detail::message_size_type size =
+        sizeof(CommandHeader) + sizeof(carla::streaming::detail::tcp::SharedMemoryRing::Descriptor);
+    CommandHeader header {
+        MultiGPUCommand::SHARED_MEMORY_DATA,
+        sizeof(carla::streaming::detail::tcp::SharedMemoryRing::Descriptor)};
+    carla::streaming::detail::tcp::SharedMemoryRing::Descriptor descriptor;
+  };
+
+#pragma pack(pop)
   /**
    * @class Primary
    * @brief 管理TCP会话的类，用于CARLA的多GPU通信。
@@ -88,6 +105,8 @@ namespace multigpu {
     // 保存回调函数的引用。
     _on_closed = std::move(on_closed);
     _on_response = std::move(on_response);
+    // 在其他命令之前提供共享内存
+    OfferSharedMemory();
     // 调用`on_opened`回调，传入当前`Primary`对象的共享指针。 
     on_opened(shared_from_this());
     // 开始读取数据
@@ -109,6 +128,9 @@ namespace multigpu {
       if (!self->_socket.is_open()) {
         return;// 如果套接字已关闭，则不执行写入操作。
       }
+      if (self->_shared_memory_enabled && self->WriteSharedMemory(message)) {
+        return;
+      }
       // 定义一个回调函数来处理写入完成后的结果。 
       auto handle_sent = [weak, message](const boost::system::error_code &ec, size_t DEBUG_ONLY(bytes)) {
           // 尝试获取当前`Primary`对象的强引用。  
@@ -198,7 +220,10 @@ namespace multigpu {
           DEBUG_ASSERT_EQ(bytes, message->size());
           DEBUG_ASSERT_NE(bytes, 0u);
           // 将缓冲区中的数据移交给回调函数，并开始读取下一块数据。 
-          self->_on_response(self, message->pop());
+          Buffer data = message->pop();
+          if (!self->HandleSharedMemoryReply(data)) {
+            self->_on_response(self, std::move(data));
+          }
           std::cout << "Getting data on listener\n";
           self->ReadData(); // 递归调用以继续读取数据。 
         } else {
@@ -290,6 +315,99 @@ namespace multigpu {
       });
     }
   }
+
+  boost::asio::ip::tcp::endpoint Primary::GetRemoteEndpoint() const {
+    boost::system::error_code ec;
+    const auto endpoint = _socket.remote_endpoint(ec);
+    return ec ? boost::asio::ip::tcp::endpoint() : endpoint;
+  }
+
+  boost::asio::ip::tcp::endpoint Primary::GetLocalEndpoint() const {
+    boost::system::error_code ec;
+    const auto endpoint = _socket.local_endpoint(ec);
+    return ec ? boost::asio::ip::tcp::endpoint() : endpoint;
+  }
+
+  void Primary::OfferSharedMemory() {
+    const uint64_t capacity = _server.GetSharedMemoryCapacity();
+    if (capacity == 0u) {
+      return;
+    }
+    // 只有次级服务器与主服务器在同一主机上时才能共享内存
+    boost::system::error_code ec;
+    const auto local = _socket.local_endpoint(ec);
+    const auto remote = _socket.remote_endpoint(ec);
+    if (ec || !(remote.address().is_loopback() || (remote.address() == local.address()))) {
+      return;
+    }
+    const std::string name = "carla_multigpu_" + std::to_string(local.port()) +
+        "_" + std::to_string(_session_id);
+    try {
+      _shared_memory = carla::streaming::detail::tcp::SharedMemoryRing::Create(name, capacity);
+    } catch (const std::exception &e) {
+      log_info("session ", _session_id, ": failed to create shared memory, using TCP: ", e.what());
+      return;
+    }
+
+    CommandHeader header;
+    header.id = MultiGPUCommand::SHARED_MEMORY;
+    header.size = static_cast<uint32_t>(name.size());
+    Buffer buf_header((uint8_t *) &header, sizeof(header));
+    Buffer buf_name(reinterpret_cast<const unsigned char *>(name.data()), name.size());
+    Write(
+        carla::BufferView::CreateFrom(std::move(buf_header)),
+        carla::BufferView::CreateFrom(std::move(buf_name)));
+  }
+
+  bool Primary::HandleSharedMemoryReply(const Buffer &buffer) {
+    CommandHeader header;
+    if (buffer.size() < sizeof(header)) {
+      return false;
+    }
+    std::memcpy(&header, buffer.data(), sizeof(header));
+    if (header.id != MultiGPUCommand::SHARED_MEMORY) {
+      return false;
+    }
+    _shared_memory_enabled =
+        (_shared_memory != nullptr) &&
+        (buffer.size() > sizeof(header)) &&
+        (buffer.data()[sizeof(header)] == 1u);
+    if (_shared_memory_enabled) {
+      log_info("session ", _session_id, ": sending commands through shared memory ", _shared_memory->GetName());
+    } else {
+      // 次级服务器不能打开，例如位于另一个容器中
+      log_info("session ", _session_id, ": shared memory refused, using TCP");
+      _shared_memory.reset();
+    }
+    return true;
+  }
+
+  bool Primary::WriteSharedMemory(std::shared_ptr<const carla::streaming::detail::tcp::Message> message) {
+    auto notification = std::make_shared<SharedMemoryNotification>();
+    // 第一个缓冲区是消息的大小，只复制其后的数据
+    const auto sequence = message->GetBufferSequence();
+    const auto payload = MakeListView(sequence.begin() + 1u, sequence.end());
+    if (!_shared_memory->TryWrite(payload, message->size(), notification->descriptor)) {
+      // 次级服务器还没有读出之前的命令，这条命令经TCP发送，顺序不变
+      return false;
+    }
+
+    std::weak_ptr<Primary> weak = shared_from_this();
+    auto handle_sent = [weak, notification](const boost::system::error_code &ec, size_t) {
+      auto self = weak.lock();
+      if (!self) return;
+      if (ec) {
+        log_error("session ", self->_session_id, ": error sending data: ", ec.message());
+        self->CloseNow(ec);
+      }
+    };
+    _deadline.expires_from_now(_timeout);
+    boost::asio::async_write(
+        _socket,
+        boost::asio::buffer(notification.get(), sizeof(SharedMemoryNotification)),
+        boost::asio::bind_executor(_strand, handle_sent));
+    return true;
+  }
   /// \brief 立即关闭连接并处理相关资源。  
 ///  
 /// 此方法用于在接收到关闭指令或错误时，立即取消任何挂起的操作，关闭套接字，  
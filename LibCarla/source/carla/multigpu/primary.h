@@ -12,6 +12,7 @@
 #include "carla/profiler/LifetimeProfiled.h"  // 引入生命周期分析的定义
 #include "carla/streaming/detail/Types.h"  // 引入流相关的类型定义
 #include "carla/streaming/detail/tcp/Message.h"  // 引入 TCP 消息的定义
+#include "carla/streaming/detail/tcp/SharedMemoryRing.h"  // 引入共享内存环形缓冲区的定义
 #include "carla/multigpu/listener.h"  // 引入监听器的定义
 
 #include <boost/asio/deadline_timer.hpp>  // 引入 Boost.Asio 的截止时间定时器
@@ -76,11 +77,26 @@ namespace multigpu {
     /// 发布工作以关闭会话。
     void Close();  // 关闭会话
 
+    /// 次级服务器的地址，连接已断开时返回空的端点。
+    boost::asio::ip::tcp::endpoint GetRemoteEndpoint() const;
+
+    /// 本端的地址，连接已断开时返回空的端点。
+    boost::asio::ip::tcp::endpoint GetLocalEndpoint() const;
+
   private:
 
     // 开启计时器
     void StartTimer();  // 启动定时器
 
+    // 次级服务器在同一主机上时创建环形缓冲区，并把名称发送给次级服务器
+    void OfferSharedMemory();
+
+    // 处理次级服务器对 SHARED_MEMORY 的回答，不是该回答时返回 false
+    bool HandleSharedMemoryReply(const Buffer &buffer);
+
+    // 把消息写入环形缓冲区并只发送描述符，空间不足时返回 false，由调用者经TCP发送
+    bool WriteSharedMemory(std::shared_ptr<const carla::streaming::detail::tcp::Message> message);
+
     // 立即关闭
     void CloseNow(boost::system::error_code ec = boost::system::error_code());  // 立即关闭会话
 
@@ -105,6 +121,10 @@ namespace multigpu {
     std::shared_ptr<BufferPool> _buffer_pool;  // 缓冲池的共享指针
 
     bool _is_writing = false;  // 写入状态标志
+
+    std::unique_ptr<carla::streaming::detail::tcp::SharedMemoryRing> _shared_memory;  // 同一主机上的命令通道
+
+    bool _shared_memory_enabled = false;  // 次级服务器已打开环形缓冲区
   };
 
 } // namespace multigpu
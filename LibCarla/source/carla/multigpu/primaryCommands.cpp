@@ -18,6 +18,10 @@
 namespace carla {
 namespace multigpu {
 
+// 查询辅助服务器负载的超时时间，以及两次查询的最小间隔
+static constexpr std::chrono::milliseconds LoadTimeout{500};
+static constexpr std::chrono::milliseconds LoadUpdateInterval{1000};
+
 // PrimaryCommands类的默认构造函数，目前为空实现，可能后续用于对象的默认初始化等情况
 PrimaryCommands::PrimaryCommands() {
 }
@@ -37,7 +41,8 @@ void PrimaryCommands::set_router(std::shared_ptr<Router> router) {
 // 向所有辅助服务器广播帧数据的函数
 // 参数buffer: 包含帧数据的carla::Buffer类型对象，会将此数据通过路由器发送给所有辅助服务器
 // 实现方式是调用_router的Write方法，传递对应的命令类型（MultiGPUCommand::SEND_FRAME）和要发送的数据（移动语义传递buffer）
-void PrimaryCommands::SendFrameData(carla::Buffer buffer) {
+void PrimaryCommands::SendFrameData(carla::Buffer buffer, uint64_t frame) {
+  _router->OnFrameSent(frame);
   _router->Write(MultiGPUCommand::SEND_FRAME, std::move(buffer));
   // log_info("sending frame command");  // 此处原代码有日志输出，可能用于调试等记录发送帧命令的操作，当前被注释掉了
 }
@@ -46,6 +51,7 @@ void PrimaryCommands::SendFrameData(carla::Buffer buffer) {
 // 参数map: 表示地图名称的字符串，先将其转换为carla::Buffer类型，再通过路由器发送给所有辅助服务器
 // 转换为Buffer时，会包含字符串内容以及结尾的'\0'字符（通过 + 1 来保证包含结尾字符），然后调用_router的Write方法发送，命令类型为MultiGPUCommand::LOAD_MAP
 void PrimaryCommands::SendLoadMap(std::string map) {
+  _router->OnMapLoadRequested();
   carla::Buffer buf((unsigned char *) map.c_str(), (size_t) map.size() + 1);
   // 使用 _router->Write() 方法将地图加载命令广播给所有辅助服务器，命令类型为 MultiGPUCommand::LOAD_MAP
   _router->Write(MultiGPUCommand::LOAD_MAP, std::move(buf));
@@ -55,18 +61,28 @@ void PrimaryCommands::SendLoadMap(std::string map) {
 // 参数sensor_id: 传感器的ID，用于标识请求令牌对应的传感器
 // 函数先记录请求令牌的日志信息（log_info），然后将sensor_id放入carla::Buffer中，通过路由器的WriteToNext方法异步发送请求（命令类型为MultiGPUCommand::GET_TOKEN）
 // 接着等待异步操作完成（fut.get()）获取响应，从响应中解析出新的令牌（token_type），并记录获取到的令牌信息，最后返回该令牌
-token_type PrimaryCommands::SendGetToken(stream_id sensor_id) {
+token_type PrimaryCommands::SendGetToken(std::weak_ptr<Primary> server, stream_id sensor_id) {
     // 记录请求令牌的日志信息
   log_info("asking for a token");
    // 将 sensor_id 放入 carla::Buffer 中
   carla::Buffer buf((carla::Buffer::value_type *) &sensor_id,
                     (size_t) sizeof(stream_id));
-   // 使用 _router->WriteToNext() 异步向下游发送请求，命令类型为 MultiGPUCommand::GET_TOKEN
-  auto fut = _router->WriteToNext(MultiGPUCommand::GET_TOKEN, std::move(buf));
+   // 向选定的辅助服务器发送请求，命令类型为 MultiGPUCommand::GET_TOKEN
+  auto fut = _router->WriteToOne(server, MultiGPUCommand::GET_TOKEN, std::move(buf));
 // 阻塞当前线程，等待异步响应完成
   auto response = fut.get();
   // 记录令牌信息
   token_type new_token(*reinterpret_cast<carla::streaming::detail::token_data *>(response.buffer.data()));
+  // 次级服务器的令牌不带地址，客户端会连接到主服务器的地址。次级服务器在
+  // 另一台主机上时填入它的地址，客户端直接从次级服务器接收传感器数据
+  auto session = server.lock();
+  if (session != nullptr && !new_token.has_address()) {
+    const auto remote = session->GetRemoteEndpoint().address();
+    const auto local = session->GetLocalEndpoint().address();
+    if (!remote.is_unspecified() && !remote.is_loopback() && remote != local) {
+      new_token.set_address(remote);
+    }
+  }
   log_info("got a token: ", new_token.get_stream_id(), ", ", new_token.get_port());
   return new_token;
 }
@@ -157,12 +173,19 @@ bool PrimaryCommands::SendIsEnabledForROS(stream_id sensor_id) {
 // 参数sensor_id: 传感器的ID，首先在已记录的令牌列表（_tokens）中查找该传感器是否已有对应的令牌，如果有：
 //   - 直接返回已有的令牌（从记录中获取并返回，同时记录日志信息表明使用已激活传感器的令牌）
 // 如果没有找到对应的令牌，则执行以下操作：
-//   - 通过路由器获取下一个可用的服务器（_router->GetNextServer()）
+//   - 查询辅助服务器的负载，按传感器的估计开销选择服务器（_router->GetServerForCost()）
 //   - 调用SendGetToken函数向该服务器请求获取令牌
 //   - 将获取到的令牌添加到令牌列表（_tokens）和服务器列表（_servers）中，记录日志信息表明使用新激活传感器的令牌，最后返回该令牌
-token_type PrimaryCommands::GetToken(stream_id sensor_id) {
+token_type PrimaryCommands::GetToken(stream_id sensor_id, float cost, uint64_t group) {
   // 搜索传感器是否已在任何辅助服务器中激活
   auto it = _tokens.find(sensor_id);
+  if (it != _tokens.end() && !_router->IsConnected(_servers[sensor_id])) {
+    // 次级服务器已断开（例如重启），在其他服务器上重新激活传感器
+    log_info("secondary server of sensor ", sensor_id, " is gone, activating it again");
+    _tokens.erase(it);
+    _servers.erase(sensor_id);
+    it = _tokens.end();
+  }
   if (it!= _tokens.end()) {
     // 返回已经激活的传感器令牌
     log_debug("Using token from already activated sensor: ", it->second.get_stream_id(), ", ", it->second.get_port());
@@ -170,9 +193,21 @@ token_type PrimaryCommands::GetToken(stream_id sensor_id) {
   }
   else {
     // 在一台辅助服务器上启用传感器
-    auto server = _router->GetNextServer();
+    // 同一组的传感器放在同一台服务器上，该服务器已断开时重新选择
+    std::weak_ptr<Primary> server;
+    auto grouped = (group != 0u) ? _groups.find(group) : _groups.end();
+    if (grouped != _groups.end() && _router->AddCost(grouped->second, cost)) {
+      server = grouped->second;
+      log_info("placing sensor", sensor_id, "with the other sensors of group", group);
+    } else {
+      _router->UpdateLoads(LoadTimeout, LoadUpdateInterval);
+      server = _router->GetServerForCost(cost);
+      if (group != 0u) {
+        _groups[group] = server;
+      }
+    }
      //  向该服务器请求获取令牌
-    auto token = SendGetToken(sensor_id);
+    auto token = SendGetToken(server, sensor_id);
     // add to the maps
     // 将获取到的令牌和服务器添加到令牌列表（_tokens）和服务器列表（_servers）中
     _tokens[sensor_id] = token;
@@ -13,6 +13,10 @@
 #include "carla/streaming/detail/tcp/Message.h" // 包含流媒体相关的令牌（Token）定义的头文件，Token可能用于标识不同的流媒体会话、资源等，方便进行相关管理和操作
 #include "carla/streaming/detail/Token.h" // 包含流媒体相关的类型定义的头文件，里面定义了在流媒体处理过程中用到的各种自定义类型，便于统一类型管理和代码的清晰性
 #include "carla/streaming/detail/Types.h"
+
+#include <memory>
+#include <unordered_map>
+
 // 定义在carla命名空间下的multigpu命名空间中，用于组织和限定多GPU相关代码的作用域，避免命名冲突
 namespace carla {
 namespace multigpu {
@@ -34,7 +38,8 @@ class PrimaryCommands {
     void set_router(std::shared_ptr<Router> router);
 
     // 向所有辅助服务器广播帧数据
-    void SendFrameData(carla::Buffer buffer);
+    // @a frame 为主服务器的帧号，用于统计次级服务器的延迟
+    void SendFrameData(carla::Buffer buffer, uint64_t frame);
 
     // 向所有辅助服务器广播要加载的地图
     void SendLoadMap(std::string map);
@@ -42,7 +47,12 @@ class PrimaryCommands {
     // 发送以了解连接是否处于活动状态
     void SendIsAlive();
 
-    token_type GetToken(stream_id sensor_id);
+    // 返回传感器的令牌。传感器第一次使用时，按负载选择一个辅助服务器，
+    // cost 是传感器的估计开销（见 Router::GetServerForCost）。group 不为 0 时，
+    // 同一组的传感器放在同一台辅助服务器上，例如同一辆英雄车上的传感器，
+    // 或大地图中同一个图块里的传感器，这样每台辅助服务器只需要加载它的
+    // 传感器周围的图块
+    token_type GetToken(stream_id sensor_id, float cost = 1.0f, uint64_t group = 0u);
 
     void EnableForROS(stream_id sensor_id);
 
@@ -53,7 +63,7 @@ class PrimaryCommands {
   private:
 
     // 发送到一个辅助节点以获取传感器的令牌
-    token_type SendGetToken(carla::streaming::detail::stream_id_type sensor_id);
+    token_type SendGetToken(std::weak_ptr<Primary> server, carla::streaming::detail::stream_id_type sensor_id);
 
     // 管理 ROS 传感器的启用/禁用
     void SendEnableForROS(stream_id sensor_id); // 与SendEnableForROS函数类似，用于向相关节点发送禁用ROS传感器的消息，是DisableForROS函数的底层实现逻辑的一部分，实现关闭ROS相关功能的具体网络通信操作
@@ -64,6 +74,7 @@ class PrimaryCommands {
     std::shared_ptr<Router> _router;
     std::unordered_map<stream_id, token_type> _tokens;// 成员变量，使用无序映射（unordered_map）存储传感器流标识（stream_id）与指向Primary类的弱智能指针（std::weak_ptr<Primary>）之间的映射关系，用于关联传感器流和对应的主节点相关信息，弱智能指针可以避免循环引用等问题
     std::unordered_map<stream_id, std::weak_ptr<Primary>> _servers;
+    std::unordered_map<uint64_t, std::weak_ptr<Primary>> _groups; // 每组传感器所在的次级服务器
 };
 
 } // namespace multigpu
@@ -8,6 +8,9 @@
 #include "carla/multigpu/listener.h"
 #include "carla/streaming/EndPoint.h"
 
+#include <algorithm>
+#include <cstring>
+
 namespace carla {
 namespace multigpu {
 
@@ -75,14 +78,29 @@ void Router::SetCallbacks() {
     [=](std::shared_ptr<carla::multigpu::Primary> session, carla::Buffer buffer) {
       auto self = weak.lock();
       if (!self) return;
+      if (buffer.size() < sizeof(CommandHeader)) {
+        log_error("invalid message from secondary:", buffer.size(), "bytes");
+        return;
+      }
+      CommandHeader header;
+      std::memcpy(&header, buffer.data(), sizeof(header));
+      Buffer data(buffer.data() + sizeof(header), buffer.size() - sizeof(header));
+      if (header.id == MultiGPUCommand::FRAME_DONE) {
+        self->OnFrameDone(session.get(), data);
+        return;
+      }
+      if (header.id == MultiGPUCommand::MAP_STATUS) {
+        self->OnMapStatus(session.get(), data);
+        return;
+      }
       std::lock_guard<std::mutex> lock(self->_mutex);
       auto prom =self-> _promises.find(session.get());
       if (prom!= self->_promises.end()) {
-        log_info("Got data from secondary (with promise): ", buffer.size());
-        prom->second->set_value({session, std::move(buffer)});
+        log_info("Got data from secondary (with promise): ", data.size());
+        prom->second->set_value({session, std::move(data)});
         self->_promises.erase(prom);
       } else {
-        log_info("Got data from secondary (without promise): ", buffer.size());
+        log_info("Got data from secondary (without promise): ", data.size());
       }
     };
 
@@ -101,6 +119,10 @@ void Router::SetNewConnectionCallback(std::function<void(void)> func)
 
 // 异步运行路由器（Router）相关操作的函数，启动线程池以异步处理相关任务
 // 参数worker_threads: 指定线程池中的工作线程数量，用于控制并发处理能力
+void Router::EnableSharedMemory(uint64_t capacity) {
+  _listener->SetSharedMemoryCapacity(capacity);
+}
+
 void Router::AsyncRun(size_t worker_threads) {
   _pool.AsyncRun(worker_threads);
 }
@@ -118,6 +140,9 @@ boost::asio::ip::tcp::endpoint Router::GetLocalEndpoint() const {
 void Router::ConnectSession(std::shared_ptr<Primary> session) {
   DEBUG_ASSERT(session!= nullptr);
   std::lock_guard<std::mutex> lock(_mutex);
+  std::ostringstream address;
+  address << session->GetRemoteEndpoint();
+  _states[session.get()].telemetry.address = address.str();
   _sessions.emplace_back(std::move(session));
   log_info("Connected secondary servers:", _sessions.size());
   // 对新连接运行外部回调
@@ -137,7 +162,10 @@ void Router::DisconnectSession(std::shared_ptr<Primary> session) {
   _sessions.erase(
       std::remove(_sessions.begin(), _sessions.end(), session),
       _sessions.end());
+  _states.erase(session.get());
   log_info("Connected secondary servers:", _sessions.size());
+  _frame_done.notify_all();
+  _map_loaded.notify_all();
 }
 
 // 清除所有活动会话的函数，通过互斥锁（_mutex）保护共享资源（_sessions列表），直接清空_sessions列表，
@@ -145,7 +173,10 @@ void Router::DisconnectSession(std::shared_ptr<Primary> session) {
 void Router::ClearSessions() {
   std::lock_guard<std::mutex> lock(_mutex);
   _sessions.clear();
+  _states.clear();
   log_info("Disconnecting all secondary servers");
+  _frame_done.notify_all();
+  _map_loaded.notify_all();
 }
 
 // 向所有活动会话（辅助服务器）广播写入消息的函数，消息包含命令头和数据缓冲区两部分内容
@@ -273,5 +304,233 @@ std::weak_ptr<Primary> Router::GetNextServer() {
   }
 }
 
+void Router::UpdateLoads(
+    std::chrono::milliseconds timeout,
+    std::chrono::milliseconds min_interval) {
+  std::vector<std::shared_ptr<Primary>> sessions;
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    const auto now = std::chrono::steady_clock::now();
+    if (now - _last_load_update < min_interval) {
+      return;
+    }
+    _last_load_update = now;
+    sessions = _sessions;
+  }
+
+  // 先向所有服务器发送请求，再逐个等待回答
+  std::vector<std::future<SessionInfo>> responses;
+  responses.reserve(sessions.size());
+  for (auto &session : sessions) {
+    responses.emplace_back(WriteToOne(session, MultiGPUCommand::GET_LOAD, Buffer()));
+  }
+
+  const auto deadline = std::chrono::steady_clock::now() + timeout;
+  for (size_t i = 0u; i < sessions.size(); ++i) {
+    if (responses[i].wait_until(deadline) != std::future_status::ready) {
+      // 不再等待这个回答，以免它被当作下一个请求的回答
+      std::lock_guard<std::mutex> lock(_mutex);
+      _promises.erase(sessions[i].get());
+      log_warning("secondary server did not report its load in time");
+      continue;
+    }
+    auto response = responses[i].get();
+    if (response.buffer.size() != sizeof(SecondaryLoad)) {
+      log_warning("invalid load report from secondary server:", response.buffer.size(), "bytes");
+      continue;
+    }
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto &state = _states[sessions[i].get()];
+    state.load = *reinterpret_cast<const SecondaryLoad *>(response.buffer.data());
+    state.has_load = true;
+  }
+}
+
+bool Router::IsConnected(std::weak_ptr<Primary> server) {
+  auto session = server.lock();
+  if (session == nullptr) {
+    return false;
+  }
+  std::lock_guard<std::mutex> lock(_mutex);
+  return std::find(_sessions.begin(), _sessions.end(), session) != _sessions.end();
+}
+
+void Router::OnFrameSent(uint64_t frame) {
+  std::lock_guard<std::mutex> lock(_mutex);
+  _frames_sent.emplace_back(frame, clock::now());
+  while (_frames_sent.size() > MAX_FRAMES_SENT) {
+    _frames_sent.pop_front();
+  }
+}
+
+std::vector<rpc::SecondaryTelemetry> Router::GetTelemetry() {
+  std::lock_guard<std::mutex> lock(_mutex);
+  const uint64_t last_sent = _frames_sent.empty() ? 0u : _frames_sent.back().first;
+  std::vector<rpc::SecondaryTelemetry> result;
+  result.reserve(_sessions.size());
+  for (auto &session : _sessions) {
+    auto telemetry = _states[session.get()].telemetry;
+    telemetry.frames_behind = last_sent > telemetry.last_frame ? last_sent - telemetry.last_frame : 0u;
+    result.emplace_back(std::move(telemetry));
+  }
+  return result;
+}
+
+std::weak_ptr<Primary> Router::GetServerForCost(float cost) {
+  std::lock_guard<std::mutex> lock(_mutex);
+  if (_sessions.empty()) {
+    return std::weak_ptr<Primary>();
+  }
+
+  // GPU 和 CPU 中较慢的一方决定帧时间
+  auto frame_time = [](const SecondaryLoad &load) {
+    return std::max(load.frame_time, load.gpu_time);
+  };
+
+  float total_time = 0.0f;
+  size_t loads = 0u;
+  for (auto &session : _sessions) {
+    const auto &state = _states[session.get()];
+    if (state.has_load) {
+      total_time += frame_time(state.load);
+      ++loads;
+    }
+  }
+  const bool use_load = (loads == _sessions.size()) && (total_time > 0.0f);
+  const float mean_time = use_load ? (total_time / static_cast<float>(loads)) : 1.0f;
+
+  size_t best = 0u;
+  float best_score = 0.0f;
+  for (size_t i = 0u; i < _sessions.size(); ++i) {
+    const auto &state = _states[_sessions[i].get()];
+    const float slowdown = use_load ? (frame_time(state.load) / mean_time) : 1.0f;
+    const float score = (state.cost + cost) * slowdown;
+    if ((i == 0u) || (score < best_score)) {
+      best = i;
+      best_score = score;
+    }
+  }
+
+  _states[_sessions[best].get()].cost += cost;
+  log_info("placing sensor with cost", cost, "in secondary server", best,
+      "( total cost", _states[_sessions[best].get()].cost, ")");
+  return std::weak_ptr<Primary>(_sessions[best]);
+}
+
+bool Router::AddCost(std::weak_ptr<Primary> server, float cost) {
+  auto session = server.lock();
+  std::lock_guard<std::mutex> lock(_mutex);
+  if (session == nullptr ||
+      std::find(_sessions.begin(), _sessions.end(), session) == _sessions.end()) {
+    return false;
+  }
+  _states[session.get()].cost += cost;
+  return true;
+}
+
+void Router::OnFrameDone(Primary *session, const Buffer &data) {
+  if (data.size() != sizeof(FrameDone)) {
+    log_warning("invalid frame acknowledgement from secondary server:", data.size(), "bytes");
+    return;
+  }
+  const auto now = clock::now();
+  FrameDone done;
+  std::memcpy(&done, data.data(), sizeof(done));
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    const bool connected = std::any_of(_sessions.begin(), _sessions.end(),
+        [session](const std::shared_ptr<Primary> &s) { return s.get() == session; });
+    if (!connected) return;
+    auto &state = _states[session];
+    state.frame_done = done.frame;
+    state.has_frame_done = true;
+
+    auto &telemetry = state.telemetry;
+    telemetry.last_frame = done.frame;
+    telemetry.apply_time.Add(done.apply_time);
+    telemetry.render_time.Add(done.render_time);
+    auto sent = std::find_if(_frames_sent.begin(), _frames_sent.end(),
+        [&](const std::pair<uint64_t, clock::time_point> &item) { return item.first == done.frame; });
+    if (sent != _frames_sent.end()) {
+      const float latency = std::chrono::duration<float, std::milli>(now - sent->second).count();
+      telemetry.frame_latency.Add(latency);
+      telemetry.network_latency.Add(latency - done.busy_time);
+    }
+  }
+  _frame_done.notify_all();
+}
+
+void Router::OnMapLoadRequested() {
+  std::lock_guard<std::mutex> lock(_mutex);
+  _map_requested = clock::now();
+  for (auto &session : _sessions) {
+    auto &state = _states[session.get()];
+    state.map_pending = true;
+    state.map_started = 0.0f;
+    state.map_loaded = 0.0f;
+  }
+}
+
+void Router::OnMapStatus(Primary *session, const Buffer &data) {
+  if (data.size() != sizeof(MapStatus)) {
+    log_warning("invalid map status from secondary server:", data.size(), "bytes");
+    return;
+  }
+  MapStatus status;
+  std::memcpy(&status, data.data(), sizeof(status));
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto it = _states.find(session);
+    if (it == _states.end() || !it->second.map_pending) return;
+    auto &state = it->second;
+    if (status.stage == MAP_LOAD_STARTED) {
+      // 到达时间减去次级服务器上的耗时，即 LOAD_MAP 在网络和队列中的时间
+      const float since_request = std::chrono::duration<float, std::milli>(clock::now() - _map_requested).count();
+      state.map_started = std::max(since_request - status.elapsed, 0.0f);
+    } else if (status.stage == MAP_LOAD_DONE) {
+      state.map_loaded = status.elapsed;
+      state.map_pending = false;
+      log_info("secondary server", state.telemetry.address, "loaded the map in", status.elapsed,
+          "ms ( started after", state.map_started, "ms )");
+    }
+  }
+  _map_loaded.notify_all();
+}
+
+bool Router::WaitForMapLoaded(std::chrono::milliseconds timeout) {
+  std::unique_lock<std::mutex> lock(_mutex);
+  const bool loaded = _map_loaded.wait_for(lock, timeout, [&]() {
+    for (auto &session : _sessions) {
+      auto it = _states.find(session.get());
+      if (it != _states.end() && it->second.map_pending) {
+        return false;
+      }
+    }
+    return true;
+  });
+  const float total = std::chrono::duration<float, std::milli>(clock::now() - _map_requested).count();
+  for (auto &session : _sessions) {
+    const auto &state = _states[session.get()];
+    if (state.map_pending) {
+      log_warning("secondary server", state.telemetry.address, "has not loaded the map after", total, "ms");
+    }
+  }
+  log_info("map loaded in", _sessions.size(), "secondary servers after", total, "ms");
+  return loaded;
+}
+
+bool Router::WaitForFrame(uint64_t frame, std::chrono::milliseconds timeout) {
+  std::unique_lock<std::mutex> lock(_mutex);
+  return _frame_done.wait_for(lock, timeout, [&]() {
+    for (auto &session : _sessions) {
+      auto it = _states.find(session.get());
+      if (it != _states.end() && it->second.has_frame_done && it->second.frame_done < frame) {
+        return false;
+      }
+    }
+    return true;
+  });
+}
+
 } // 名称空间 multigpu
 } // 名称空间 carla
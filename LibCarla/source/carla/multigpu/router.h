@@ -12,10 +12,14 @@
 #include "carla/multigpu/primary.h" // 包含用于多GPU处理的主要组件的头文件
 #include "carla/multigpu/primaryCommands.h" 
 #include "carla/multigpu/commands.h"
+#include "carla/rpc/SecondaryTelemetry.h"
 
 #include <boost/asio/io_context.hpp>
 #include <boost/asio/ip/tcp.hpp>
 
+#include <chrono>
+#include <condition_variable>
+#include <deque>
 #include <mutex> // 包含互斥锁的头文件
 #include <vector> // 包含动态数组的头文件
 #include <sstream> // 包含字符串流的头文件
@@ -47,6 +51,9 @@ namespace multigpu {
     void SetCallbacks(); // 设置回调函数
     void SetNewConnectionCallback(std::function<void(void)>); // 设置新连接的回调函数
 
+    // 同一主机上的次级服务器经共享内存接收命令，只对之后连接的次级服务器有效
+    void EnableSharedMemory(uint64_t capacity);
+
     void AsyncRun(size_t worker_threads); // 异步运行，指定工作线程的数量
 
     boost::asio::ip::tcp::endpoint GetLocalEndpoint() const;
@@ -61,11 +68,65 @@ namespace multigpu {
 
     std::weak_ptr<Primary> GetNextServer();  // 获取下一个服务器的弱引用
 
+    /// 向所有次级服务器查询负载（GET_LOAD）。距上次查询不到 @a min_interval
+    /// 时不再查询；在 @a timeout 内没有回答的服务器保留上次的负载。
+    void UpdateLoads(
+        std::chrono::milliseconds timeout,
+        std::chrono::milliseconds min_interval);
+
+    /// 选择放置一个估计开销为 @a cost 的传感器的服务器，并把开销计入该服务器。
+    /// 得分为（已放置的开销 + cost）乘以该服务器的帧时间与平均帧时间之比，
+    /// 没有负载信息时比值为 1，即只按开销平衡。
+    std::weak_ptr<Primary> GetServerForCost(float cost);
+
+    /// 把一个估计开销为 @a cost 的传感器放在指定的服务器上，服务器已断开时返回 false。
+    bool AddCost(std::weak_ptr<Primary> server, float cost);
+
+    // 发送 LOAD_MAP 前调用：当前连接的次级服务器都需要回报加载完成
+    void OnMapLoadRequested();
+
+    // 等待所有次级服务器加载完地图，超时返回 false。记录每台服务器各阶段的耗时
+    bool WaitForMapLoaded(std::chrono::milliseconds timeout);
+
+    // 等待所有次级服务器处理完 frame 及之前的帧，超时返回 false。
+    // 还没有回报过帧的服务器（例如刚连接的）不参与等待
+    bool WaitForFrame(uint64_t frame, std::chrono::milliseconds timeout);
+
+    // 该次级服务器是否仍然连接着
+    bool IsConnected(std::weak_ptr<Primary> server);
+
+    // 记录帧数据的发送时间，收到 FRAME_DONE 时据此计算延迟
+    void OnFrameSent(uint64_t frame);
+
+    // 每个次级服务器的状态和耗时统计
+    std::vector<rpc::SecondaryTelemetry> GetTelemetry();
+
   private:
     void ConnectSession(std::shared_ptr<Primary> session); // 连接会话
     void DisconnectSession(std::shared_ptr<Primary> session); // 断开会话
     void ClearSessions(); // 清除会话
 
+    struct SecondaryState {
+      float cost = 0.0f;        // 已放置的传感器的估计开销之和
+      SecondaryLoad load {};    // 最近一次报告的负载
+      bool has_load = false;
+      uint64_t frame_done = 0u;  // 最近一次 FRAME_DONE 的帧号
+      bool has_frame_done = false;
+      rpc::SecondaryTelemetry telemetry;
+      bool map_pending = false;  // 还没有回报加载完最近请求的地图
+      float map_started = 0.0f;  // 从发送 LOAD_MAP 到次级服务器开始加载的时间，单位为毫秒
+      float map_loaded = 0.0f;   // 次级服务器加载地图的时间，单位为毫秒
+    };
+
+    using clock = std::chrono::steady_clock;
+
+    // 最多记录的已发送帧数
+    static constexpr size_t MAX_FRAMES_SENT = 256u;
+
+    void OnFrameDone(Primary *session, const Buffer &data);
+
+    void OnMapStatus(Primary *session, const Buffer &data);
+
     // 互斥锁和线程池必须放在开始位置，以确保最后被销毁
     std::mutex                              _mutex; // 互斥锁
     ThreadPool                              _pool; // 线程池
@@ -76,6 +137,12 @@ namespace multigpu {
     std::unordered_map<Primary *, std::shared_ptr<std::promise<SessionInfo>>> _promises;  // 用于异步操作的承诺映射
     PrimaryCommands                         _commander; // 命令对象
     std::function<void(void)>               _callback; // 回调函数
+    std::unordered_map<Primary *, SecondaryState> _states; // 每个次级服务器的开销和负载
+    std::chrono::steady_clock::time_point   _last_load_update; // 上次查询负载的时间
+    std::condition_variable                 _frame_done; // 收到 FRAME_DONE 或会话断开时通知
+    std::deque<std::pair<uint64_t, clock::time_point>> _frames_sent; // 最近发送的帧和发送时间
+    std::condition_variable                 _map_loaded; // 收到 MAP_STATUS 或会话断开时通知
+    clock::time_point                       _map_requested; // 最近一次发送 LOAD_MAP 的时间
   };
 
 } // namespace multigpu
@@ -19,6 +19,7 @@
 #include <boost/asio/post.hpp>               // 包含异步操作的Boost.Asio头文件
 #include <boost/asio/bind_executor.hpp>      // 包含绑定执行器的Boost.Asio头文件
 
+#include <cstring>                           // 包含内存操作函数的头文件
 #include <exception>                         // 包含标准异常处理头文件
 
 namespace carla {
@@ -75,6 +76,9 @@ namespace multigpu {
         self->_socket.close();              // 关闭套接字
       }
 
+      // 新的会话会重新提供共享内存
+      self->_shared_memory.reset();
+
       auto handle_connect = [weak](boost::system::error_code ec) { // 处理连接结果的回调
         auto self = weak.lock();            // 锁定弱指针
         if (!self) return;                  // 如果对象已被销毁，返回
@@ -191,6 +195,17 @@ namespace multigpu {
     });
   }
 
+  void Secondary::Write(MultiGPUCommand id, Buffer buffer) {
+    CommandHeader header;
+    header.id = id;
+    header.size = buffer.size();
+    Buffer buf_header((uint8_t *) &header, sizeof(header));
+
+    auto view_header = carla::BufferView::CreateFrom(std::move(buf_header));
+    auto view_data = carla::BufferView::CreateFrom(std::move(buffer));
+    Write(Secondary::MakeMessage(view_header, view_data));
+  }
+
   void Secondary::Write(std::string text) {
     std::weak_ptr<Secondary> weak = shared_from_this(); // 创建弱指针以避免循环引用
     boost::asio::post(_strand, [=]() {
@@ -225,6 +240,57 @@ namespace multigpu {
     });
   }
 
+  void Secondary::ProcessMessage(Buffer buffer) {
+    CommandHeader header;
+    if (buffer.size() < sizeof(header)) {
+      log_error("secondary server: invalid command of", buffer.size(), "bytes");
+      return;
+    }
+    std::memcpy(&header, buffer.data(), sizeof(header));
+    switch (header.id) {
+      case MultiGPUCommand::SHARED_MEMORY:
+      {
+        Buffer name(buffer.data() + sizeof(header), buffer.size() - sizeof(header));
+        OpenSharedMemory(name);
+        break;
+      }
+      case MultiGPUCommand::SHARED_MEMORY_DATA:
+      {
+        carla::streaming::detail::tcp::SharedMemoryRing::Descriptor descriptor;
+        if ((_shared_memory == nullptr) || (buffer.size() != sizeof(header) + sizeof(descriptor))) {
+          log_error("secondary server: unexpected shared memory command");
+          return;
+        }
+        std::memcpy(&descriptor, buffer.data() + sizeof(header), sizeof(descriptor));
+        Buffer command = _buffer_pool->Pop();
+        if (!_shared_memory->Read(descriptor, command)) {
+          log_error("secondary server: invalid shared memory descriptor");
+          return;
+        }
+        _commander.process_command(std::move(command));
+        break;
+      }
+      default:
+        _commander.process_command(std::move(buffer));
+        break;
+    }
+  }
+
+  void Secondary::OpenSharedMemory(const Buffer &name) {
+    const std::string ring_name(reinterpret_cast<const char *>(name.data()), name.size());
+    uint8_t result = 0u;
+    try {
+      _shared_memory = carla::streaming::detail::tcp::SharedMemoryRing::Open(ring_name);
+      result = 1u;
+      log_info("secondary server: receiving commands through shared memory", ring_name);
+    } catch (const std::exception &e) {
+      // 与主服务器不在同一个共享内存命名空间中，例如位于不同的容器中
+      log_info("secondary server: failed to open shared memory, using TCP:", e.what());
+      _shared_memory.reset();
+    }
+    Write(MultiGPUCommand::SHARED_MEMORY, Buffer(&result, sizeof(result)));
+  }
+
   // 读取数据的处理函数
   void Secondary::ReadData() {
     std::weak_ptr<Secondary> weak = shared_from_this();// 创建弱指针以避免循环引用
@@ -245,7 +311,7 @@ namespace multigpu {
           DEBUG_ASSERT_EQ(bytes, message->size());// 确保字节数匹配
           DEBUG_ASSERT_NE(bytes, 0u);
           // 移动缓冲区到回调函数并开始读取下一部分数据
-          self->GetCommander().process_command(message->pop());
+          self->ProcessMessage(message->pop());
           self->ReadData();// 继续读取数据
         } else {
           // 如果发生错误，从最顶部重新开始
@@ -12,6 +12,7 @@
 #include "carla/profiler/LifetimeProfiled.h"  // 引入生命周期分析相关头文件
 #include "carla/multigpu/secondaryCommands.h"  // 引入多 GPU 次级命令的头文件
 #include "carla/streaming/detail/tcp/Message.h"  // 引入 TCP 消息的详细实现头文件
+#include "carla/streaming/detail/tcp/SharedMemoryRing.h"  // 引入共享内存环形缓冲区的头文件
 #include "carla/streaming/detail/Token.h"  // 引入 Token 的详细实现头文件
 #include "carla/streaming/detail/Types.h"  // 引入流相关类型的头文件
 #include "carla/ThreadPool.h"  // 引入线程池的头文件
@@ -55,6 +56,7 @@ namespace multigpu {  // 定义 multigpu 命名空间
     void Write(std::shared_ptr<const carla::streaming::detail::tcp::Message> message);  // 写入消息
     void Write(Buffer buffer);  // 写入 Buffer
     void Write(std::string text);  // 写入字符串
+    void Write(MultiGPUCommand id, Buffer buffer);  // 写入带命令头的回答
 
     SecondaryCommands &GetCommander() {  // 获取命令器的引用
       return _commander;
@@ -75,6 +77,12 @@ namespace multigpu {  // 定义 multigpu 命名空间
 
     void ReadData();  // 读取数据
 
+    // 处理收到的消息：共享内存的命令先从环形缓冲区中取出
+    void ProcessMessage(Buffer buffer);
+
+    // 打开主服务器提供的环形缓冲区并回答是否成功
+    void OpenSharedMemory(const Buffer &name);
+
     ThreadPool                        _pool;  // 线程池
     boost::asio::ip::tcp::socket      _socket;  // TCP socket
     boost::asio::ip::tcp::endpoint    _endpoint;  // TCP 端点
@@ -83,6 +91,7 @@ namespace multigpu {  // 定义 multigpu 命名空间
     std::shared_ptr<BufferPool>       _buffer_pool;  // Buffer 池的智能指针
     std::atomic_bool                  _done {false};  // 原子布尔值，表示是否完成
     SecondaryCommands                 _commander;  // 次级命令处理器
+    std::unique_ptr<carla::streaming::detail::tcp::SharedMemoryRing> _shared_memory;  // 同一主机上的命令通道
   };
 
 } // namespace multigpu
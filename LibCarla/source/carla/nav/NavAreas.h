@@ -0,0 +1,48 @@
+// Copyright (c) 2019 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+// 导航网格的区域和多边形标志，由 RecastBuilder 写入导航文件，客户端的
+// Navigation 和服务器的行人人群都使用它们
+
+namespace carla {
+namespace nav {
+
+  // 导航区域
+  // 参考：https://openhutb.github.io/carla_doc/tuto_M_generate_pedestrian_navigation/
+  enum NavAreas {
+    CARLA_AREA_BLOCK = 0,
+    CARLA_AREA_SIDEWALK,  // 人行道
+    CARLA_AREA_CROSSWALK, // 人行横道：如果找不到地面，行人将在这些网格上行走作为第二种选择。
+    CARLA_AREA_ROAD,      // 马路：行人只能通过这些网格过马路。
+    CARLA_AREA_GRASS      // 草地：行人不会在此网格上行走，除非您指定一定比例的行人这样做。
+  };
+
+  enum SamplePolyFlags
+// 定义一个枚举类型SamplePolyFlags，用于表示导航网格中多边形（Poly）的不同类型或属性
+  {
+    CARLA_TYPE_NONE       = 0x01,
+ // 没有任何特殊类型的标志，可能表示一个默认或未知的类型
+    CARLA_TYPE_SIDEWALK   = 0x02,
+// 表示人行道，通常用于行人行走的区域
+    CARLA_TYPE_CROSSWALK  = 0x04,
+// 表示斑马线，是行人过马路时专用的区域
+    CARLA_TYPE_ROAD       = 0x08,
+// 表示道路，通常用于车辆行驶
+    CARLA_TYPE_GRASS      = 0x10,
+// 表示草地，可能允许行人行走，但通常不允许车辆进入
+    CARLA_TYPE_ALL        = 0xffff,
+// 一个特殊的标志，表示上述所有类型的组合，常用于需要匹配所有类型的情况
+// 0xffff即二进制的1111 1111 1111 1111，代表所有位都被设置为1
+
+    CARLA_TYPE_WALKABLE   = CARLA_TYPE_SIDEWALK | CARLA_TYPE_CROSSWALK | CARLA_TYPE_GRASS | CARLA_TYPE_ROAD,
+ // 一个方便的组合标志，表示所有可通行的类型，包括人行道、斑马线、草地和道路
+ // 但不包括没有任何特殊类型的标志（CARLA_TYPE_NONE）
+  };
+
+} // namespace nav
+} // namespace carla
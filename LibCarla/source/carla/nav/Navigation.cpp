@@ -9,10 +9,12 @@
 #include <cmath>
 
 #include "carla/Logging.h"
+#include "carla/ParallelFor.h"
 #include "carla/nav/Navigation.h"
 #include "carla/nav/WalkerManager.h"
 #include "carla/geom/Math.h"
 
+#include <algorithm>
 #include <iterator>
 #include <fstream>
 #include <mutex>
@@ -39,14 +41,63 @@ namespace nav {
   static const float AGENT_UNBLOCK_DISTANCE_SQUARED = AGENT_UNBLOCK_DISTANCE * AGENT_UNBLOCK_DISTANCE; // 定义代理解堵距离的平方，用于计算距离时避免开方操作，提高效率
   static const float AGENT_UNBLOCK_TIME = 4.0f; // 定义代理解堵时间为4秒，即代理在被阻挡后等待的时间
 
+  static const float CROWD_GROUP_SIZE = 200.0f; // 每组行人负责的正方形区域的边长（米）
+  static const float CROWD_GROUP_MARGIN = 10.0f; // 行人离开所在区域超过这个距离才换组，避免在边界上来回切换
+  static const float CROWD_VEHICLE_RANGE = 20.0f; // 车辆加入所有区域（加上 CROWD_GROUP_MARGIN）在这个距离内的组
+
   static const float AREA_GRASS_COST =  1.0f; // 定义草地区域的成本为1.0，用于路径规划时的权重计算
   static const float AREA_ROAD_COST  = 10.0f; // 定义道路区域的成本为10.0，用于路径规划时的权重计算，通常道路的成本高于草地
 
+  static const size_t PATH_CACHE_SIZE = 1024u; // 路径走廊缓存的最大条目数
+  static const size_t PATH_QUERY_CHUNK = 16u; // 批量路径查询中每个线程至少处理的查询数
+
+  // 默认的路径过滤器，可以在所有可行走的区域上行走。
+  // 所有过滤器的区域成本相同，所以路径缓存只以过滤器的标志区分
+  static dtQueryFilter DefaultFilter() {
+    dtQueryFilter filter;
+    filter.setAreaCost(CARLA_AREA_ROAD, AREA_ROAD_COST); // 设置道路区域的成本
+    filter.setAreaCost(CARLA_AREA_GRASS, AREA_GRASS_COST); // 设置草地区域的成本
+    filter.setIncludeFlags(CARLA_TYPE_WALKABLE);  // 设置包含的标志（可通行区域）
+    filter.setExcludeFlags(CARLA_TYPE_NONE);    // 设置排除的标志（无不可通行区域）
+    return filter;
+  }
+
   // 返回一个随机的浮点数 float
   static float frand() {
     return static_cast<float>(rand()) / static_cast<float>(RAND_MAX);
   }
 
+  // 代理编号由组号和组内索引组成
+  static int AgentHandle(int group, int index) {
+    return group * MAX_AGENTS + index;
+  }
+
+  static int AgentGroup(int agent) {
+    return agent / MAX_AGENTS;
+  }
+
+  static int AgentIndex(int agent) {
+    return agent % MAX_AGENTS;
+  }
+
+  static int32_t CrowdCell(float value) {
+    return static_cast<int32_t>(std::floor(value / CROWD_GROUP_SIZE));
+  }
+
+  static int64_t CrowdCellKey(int32_t x, int32_t y) {
+    return (static_cast<int64_t>(x) << 32) | static_cast<uint32_t>(y);
+  }
+
+  // 把车辆边界框的 4 个角从虚幻坐标写入 Recast 坐标的 obb
+  // 数据: [x][y][z] [x][y][z] [x][y][z] [x][y][z]
+  static void SetVehicleObb(float *obb, const carla::geom::Vector3D (&corners)[4]) {
+    for (int i = 0; i < 4; ++i) {
+      obb[i * 3 + 0] = corners[i].x;
+      obb[i * 3 + 1] = corners[i].z;
+      obb[i * 3 + 2] = corners[i].y;
+    }
+  }
+
   Navigation::Navigation() {
     // 指定行人管理器
     _walker_manager.SetNav(this);
@@ -60,10 +111,13 @@ namespace nav {
     _mapped_by_index.clear(); // 清空_mapped_by_index列表，该列表可能存储了按索引映射的对象
     _walkers_blocked_position.clear(); // 清空_walkers_blocked_position列表，该列表存储了被阻塞步行者的位置
     _yaw_walkers.clear(); // 清空_yaw_walkers列表，该列表可能存储了步行者的朝向信息
-    _binary_mesh.clear(); // 清空_binary_mesh，该变量可能存储了二进制网格数据
-    dtFreeCrowd(_crowd); // 释放_crowd资源，_crowd是用于人群模拟的动态组件
+    FreeCrowds(); // 释放所有组的人群
+    FreeQueryPool(); // 释放路径查询对象池
+    ClearPathCache();
     dtFreeNavMeshQuery(_nav_query); // 释放_nav_query资源，_nav_query是用于路径查询的组件
     dtFreeNavMesh(_nav_mesh); // 释放_nav_mesh资源，_nav_mesh是用于路径规划的导航网格
+    // 瓦片数据直接引用_binary_mesh，要在导航网格之后释放
+    _binary_mesh.clear();
   }
 
   // 参考模拟器访问API函数
@@ -84,17 +138,19 @@ namespace nav {
 
   // 加载导航数据
   bool Navigation::Load(const std::string &filename) {
-    std::ifstream f; // 创建一个输入文件流对象
-    std::istream_iterator<uint8_t> start(f), end; // 创建两个迭代器，用于读取文件内容
-
-    // 读取整个文件
-    // 以二进制模式打开文件
-    f.open(filename, std::ios::binary);
+    // 以二进制模式打开文件，定位到末尾得到文件大小
+    std::ifstream f(filename, std::ios::binary | std::ios::ate);
      // 如果文件打开失败，则返回false
     if (!f.is_open()) {
       return false;
     }
-    std::vector<uint8_t> content(start, end);
+    // 一次读取整个文件；逐字节的流迭代器既慢又会跳过空白字符的字节
+    std::vector<uint8_t> content(static_cast<size_t>(f.tellg()));
+    f.seekg(0, std::ios::beg);
+    f.read(reinterpret_cast<char *>(content.data()), static_cast<std::streamsize>(content.size()));
+    if (!f) {
+      return false;
+    }
     f.close();
 
     // 解析内容
@@ -156,48 +212,61 @@ namespace nav {
       return false;
     }
 
+    // 瓦片数据对齐时直接使用 content 中的数据，不再为每个瓦片复制一份；
+    // content 之后保存在 _binary_mesh 中，和导航网格的生命周期相同
+    constexpr size_t TILE_ALIGNMENT = std::max(alignof(dtPolyRef), alignof(float));
+
     // 读取瓦片数据
     for (int i = 0; i < header.num_tiles; ++i) {
       NavMeshTileHeader tile_header;
 
       // 读取瓦片头
-      memcpy(&tile_header, &content[pos], sizeof(tile_header));
-      pos += sizeof(tile_header);
-      if (pos >= content.size()) {
+      if (pos + sizeof(tile_header) >= content.size()) {
           // 如果读取瓦片头后位置超出内容大小，释放网格并返回false
         dtFreeNavMesh(mesh);
         return false;
       }
+      memcpy(&tile_header, &content[pos], sizeof(tile_header));
+      pos += sizeof(tile_header);
 
       // 检查瓦片的有效性
-      if (!tile_header.tile_ref || !tile_header.data_size) {
+      if (!tile_header.tile_ref || tile_header.data_size <= 0) {
          // 如果瓦片无效，跳出循环
         break;
       }
 
-      // 分配缓冲区内存
-      char *data = static_cast<char *>(dtAlloc(static_cast<size_t>(tile_header.data_size), DT_ALLOC_PERM));
-      if (!data) {
-         // 如果内存分配失败，跳出循环
-        break;
-      }
-
-      // 读取瓦片
-      memcpy(data, &content[pos], static_cast<size_t>(tile_header.data_size));
-      pos += static_cast<unsigned long>(tile_header.data_size);
-      if (pos > content.size()) {
-         // 如果读取瓦片数据后位置超出内容大小，释放数据和网格并返回false
-        dtFree(data);
+      if (pos + static_cast<size_t>(tile_header.data_size) > content.size()) {
+         // 如果瓦片数据超出内容大小，释放网格并返回false
         dtFreeNavMesh(mesh);
         return false;
       }
 
+      unsigned char *data = &content[pos];
+      int flags = 0;
+      if (reinterpret_cast<uintptr_t>(data) % TILE_ALIGNMENT != 0u) {
+        // 分配对齐的缓冲区并复制瓦片
+        data = static_cast<unsigned char *>(dtAlloc(static_cast<size_t>(tile_header.data_size), DT_ALLOC_PERM));
+        if (!data) {
+           // 如果内存分配失败，跳出循环
+          break;
+        }
+        memcpy(data, &content[pos], static_cast<size_t>(tile_header.data_size));
+        flags = DT_TILE_FREE_DATA;
+      }
+      pos += static_cast<unsigned long>(tile_header.data_size);
+
       // 添加瓦片数据
-      mesh->addTile(reinterpret_cast<unsigned char *>(data), tile_header.data_size, DT_TILE_FREE_DATA,
-      tile_header.tile_ref, 0);
+      if (dtStatusFailed(mesh->addTile(data, tile_header.data_size, flags, tile_header.tile_ref, 0)) &&
+          (flags & DT_TILE_FREE_DATA)) {
+        dtFree(data);
+      }
     }
 
-    // 交换
+    // 旧网格的查询对象和多边形编号不再有效
+    FreeQueryPool();
+    ClearPathCache();
+
+    // 交换，旧网格引用旧的 _binary_mesh，先释放网格
     dtFreeNavMesh(_nav_mesh);
     _nav_mesh = mesh;
 
@@ -210,69 +279,64 @@ namespace nav {
     _binary_mesh = std::move(content);
     _ready = true; // 标记为准备就绪
 
-    // 创建并初始化人群管理器
-    CreateCrowd();
+    // 各组的人群在第一个行人进入该组的区域时才创建
 
     return true;// 表示成功加载和初始化导航网格
   }
 
-// 创建并初始化人群管理器
-  void Navigation::CreateCrowd(void) {
+// 创建并初始化一组行人的人群管理器
+  dtCrowd *Navigation::CreateCrowd() {
 
-    // 检查是否一切就绪
-    if (!_ready) {
-      return;
-    }
-
-    DEBUG_ASSERT(_crowd == nullptr);// 断言_crowd成员变量为nullptr，确保未重复初始化
+    DEBUG_ASSERT(_nav_mesh != nullptr);
 
     // 创建并初始化
-    _crowd = dtAllocCrowd();
+    dtCrowd *crowd = dtAllocCrowd();
     // 这些半径应该是车辆的最大尺寸 (CarlaCola for Carla)
     const float max_agent_radius = AGENT_RADIUS * 20;
-    if (!_crowd->init(MAX_AGENTS, max_agent_radius, _nav_mesh)) {
+    if (!crowd->init(MAX_AGENTS, max_agent_radius, _nav_mesh)) {
        // 如果初始化失败，记录日志并返回
       logging::log("Nav: failed to create crowd");
-      return;
+      dtFreeCrowd(crowd);
+      return nullptr;
     }
 
     // 设置不同的过滤器
     // 过滤器 0 不能在道路上行走
-    _crowd->getEditableFilter(0)->setIncludeFlags(CARLA_TYPE_WALKABLE);
-    _crowd->getEditableFilter(0)->setExcludeFlags(CARLA_TYPE_ROAD);
-    _crowd->getEditableFilter(0)->setAreaCost(CARLA_AREA_ROAD, AREA_ROAD_COST);
-    _crowd->getEditableFilter(0)->setAreaCost(CARLA_AREA_GRASS, AREA_GRASS_COST);
+    crowd->getEditableFilter(0)->setIncludeFlags(CARLA_TYPE_WALKABLE);
+    crowd->getEditableFilter(0)->setExcludeFlags(CARLA_TYPE_ROAD);
+    crowd->getEditableFilter(0)->setAreaCost(CARLA_AREA_ROAD, AREA_ROAD_COST);
+    crowd->getEditableFilter(0)->setAreaCost(CARLA_AREA_GRASS, AREA_GRASS_COST);
     // 过滤器 1 可以在道路上行走
-    _crowd->getEditableFilter(1)->setIncludeFlags(CARLA_TYPE_WALKABLE);
-    _crowd->getEditableFilter(1)->setExcludeFlags(CARLA_TYPE_NONE);
-    _crowd->getEditableFilter(1)->setAreaCost(CARLA_AREA_ROAD, AREA_ROAD_COST);
-    _crowd->getEditableFilter(1)->setAreaCost(CARLA_AREA_GRASS, AREA_GRASS_COST);
+    crowd->getEditableFilter(1)->setIncludeFlags(CARLA_TYPE_WALKABLE);
+    crowd->getEditableFilter(1)->setExcludeFlags(CARLA_TYPE_NONE);
+    crowd->getEditableFilter(1)->setAreaCost(CARLA_AREA_ROAD, AREA_ROAD_COST);
+    crowd->getEditableFilter(1)->setAreaCost(CARLA_AREA_GRASS, AREA_GRASS_COST);
 
     // 设置不同品质的局部避让参数。
     dtObstacleAvoidanceParams params;
     // 主要使用默认设置，从 dtCrowd 复制。
-    memcpy(&params, _crowd->getObstacleAvoidanceParams(0), sizeof(dtObstacleAvoidanceParams));
+    memcpy(&params, crowd->getObstacleAvoidanceParams(0), sizeof(dtObstacleAvoidanceParams));
 
     // Low (11)
     params.velBias = 0.5f;
     params.adaptiveDivs = 5;
     params.adaptiveRings = 2;
     params.adaptiveDepth = 1;
-    _crowd->setObstacleAvoidanceParams(0, &params);
+    crowd->setObstacleAvoidanceParams(0, &params);
 
     // Medium (22)
     params.velBias = 0.5f;
     params.adaptiveDivs = 5;
     params.adaptiveRings = 2;
     params.adaptiveDepth = 2;
-    _crowd->setObstacleAvoidanceParams(1, &params);
+    crowd->setObstacleAvoidanceParams(1, &params);
 
     // Good (45)
     params.velBias = 0.5f;
     params.adaptiveDivs = 7;
     params.adaptiveRings = 2;
     params.adaptiveDepth = 3;
-    _crowd->setObstacleAvoidanceParams(2, &params);
+    crowd->setObstacleAvoidanceParams(2, &params);
 
     // High (66)
     params.velBias = 0.5f;
@@ -280,223 +344,326 @@ namespace nav {
     params.adaptiveRings = 3;
     params.adaptiveDepth = 3;
 
-    _crowd->setObstacleAvoidanceParams(3, &params);
+    crowd->setObstacleAvoidanceParams(3, &params);
+
+    return crowd;
   }
 
-  // 返回从一个位置到另一个位置的路径点
-  bool Navigation::GetPath(carla::geom::Location from, // 起始位置
-                           carla::geom::Location to,   // 目标位置
-                           dtQueryFilter * filter,    // 用于路径查询的过滤器，可以筛选路径通过的区域类型
-                           std::vector<carla::geom::Location> &path, // 用于存储计算出的路径点的向量
-                           std::vector<unsigned char> &area) {  // 用于存储路径点所属区域类型的向量
+  // 释放所有组的人群
+  void Navigation::FreeCrowds() {
+    for (auto &&group : _crowds) {
+      dtFreeCrowd(group.crowd);
+    }
+    _crowds.clear();
+    _crowd_by_cell.clear();
+  }
+
+  // 返回负责这个位置的组
+  int Navigation::GetCrowdGroup(float x, float y, bool create) {
+    const int32_t cell_x = CrowdCell(x);
+    const int32_t cell_y = CrowdCell(y);
+    const int64_t key = CrowdCellKey(cell_x, cell_y);
+    auto it = _crowd_by_cell.find(key);
+    if (it != _crowd_by_cell.end()) {
+      return it->second;
+    }
+    if (!create) {
+      return -1;
+    }
+
+    dtCrowd *crowd = CreateCrowd();
+    if (crowd == nullptr) {
+      return -1;
+    }
+    CrowdGroup group;
+    group.crowd = crowd;
+    group.x = cell_x;
+    group.y = cell_y;
+    _crowds.emplace_back(group);
+    const int index = static_cast<int>(_crowds.size()) - 1;
+    _crowd_by_cell.emplace(key, index);
+
+    // 附近的车辆需要加入新的组
+    _update_all_vehicles = true;
+
+    return index;
+  }
+
+  // 返回代理
+  dtCrowdAgent *Navigation::GetAgent(int agent) {
+    return _crowds[AgentGroup(agent)].crowd->getEditableAgent(AgentIndex(agent));
+  }
+
+  // 查找参与者（行人或者车辆）的代理
+  bool Navigation::FindAgent(ActorId id, int &agent) const {
+    auto it = _mapped_walkers_id.find(id);
+    if (it != _mapped_walkers_id.end()) {
+      agent = it->second;
+      return true;
+    }
+    auto vehicle = _mapped_vehicles_id.find(id);
+    if (vehicle != _mapped_vehicles_id.end() && !vehicle->second.agents.empty()) {
+      agent = vehicle->second.agents.front();
+      return true;
+    }
+    return false;
+  }
+
+  // 从池中取出一个查询对象，池为空时创建新的
+  Navigation::QueryPtr Navigation::AcquireQuery() {
+    dtNavMeshQuery *query = nullptr;
+    {
+      std::lock_guard<std::mutex> lock(_query_pool_mutex);
+      if (!_query_pool.empty()) {
+        query = _query_pool.back();
+        _query_pool.pop_back();
+      }
+    }
+    if (query == nullptr) {
+      query = dtAllocNavMeshQuery();
+      if (query == nullptr) {
+        return QueryPtr(nullptr, dtFreeNavMeshQuery);
+      }
+      if (dtStatusFailed(query->init(_nav_mesh, MAX_QUERY_SEARCH_NODES))) {
+        dtFreeNavMeshQuery(query);
+        return QueryPtr(nullptr, dtFreeNavMeshQuery);
+      }
+    }
+    return QueryPtr(query, [this](dtNavMeshQuery *released) {
+      std::lock_guard<std::mutex> lock(_query_pool_mutex);
+      _query_pool.push_back(released);
+    });
+  }
+
+  // 释放池中所有的查询对象
+  void Navigation::FreeQueryPool() {
+    std::lock_guard<std::mutex> lock(_query_pool_mutex);
+    for (dtNavMeshQuery *query : _query_pool) {
+      dtFreeNavMeshQuery(query);
+    }
+    _query_pool.clear();
+  }
+
+  // 查找缓存的路径走廊，找到时把它移到最近使用的位置
+  bool Navigation::FindCachedPath(const PathCacheKey &key, dtPolyRef *polys, int &num_polys) {
+    std::lock_guard<std::mutex> lock(_path_cache_mutex);
+    auto it = _path_cache.find(key);
+    if (it == _path_cache.end()) {
+      return false;
+    }
+    _path_cache_list.splice(_path_cache_list.begin(), _path_cache_list, it->second);
+    const std::vector<dtPolyRef> &cached = it->second->second;
+    std::copy(cached.begin(), cached.end(), polys);
+    num_polys = static_cast<int>(cached.size());
+    return true;
+  }
+
+  // 缓存路径走廊，超过容量时丢弃最久未使用的
+  void Navigation::AddCachedPath(const PathCacheKey &key, const dtPolyRef *polys, int num_polys) {
+    std::lock_guard<std::mutex> lock(_path_cache_mutex);
+    if (_path_cache.find(key) != _path_cache.end()) {
+      // 其它线程同时计算了相同的路径
+      return;
+    }
+    _path_cache_list.emplace_front(key, std::vector<dtPolyRef>(polys, polys + num_polys));
+    _path_cache.emplace(key, _path_cache_list.begin());
+    if (_path_cache_list.size() > PATH_CACHE_SIZE) {
+      _path_cache.erase(_path_cache_list.back().first);
+      _path_cache_list.pop_back();
+    }
+  }
+
+  void Navigation::ClearPathCache() {
+    std::lock_guard<std::mutex> lock(_path_cache_mutex);
+    _path_cache.clear();
+    _path_cache_list.clear();
+  }
+
+  // 用给定的查询对象计算从一个位置到另一个位置的路径点
+  bool Navigation::ComputePath(dtNavMeshQuery &query, const dtQueryFilter &filter,
+                               carla::geom::Location from, carla::geom::Location to,
+                               std::vector<carla::geom::Location> &path,
+                               std::vector<unsigned char> &area) {
     // 找到路径
     float straight_path[MAX_POLYS * 3];
     unsigned char straight_path_flags[MAX_POLYS];
     dtPolyRef straight_path_polys[MAX_POLYS];
-    int num_straight_path;   // 直线路径中的点数量
+    int num_straight_path = 0;   // 直线路径中的点数量
     int straight_path_options = DT_STRAIGHTPATH_AREA_CROSSINGS;  // 直线路径查询的选项
 
     // 路径中的多边形
     dtPolyRef polys[MAX_POLYS];
-    int num_polys; // 路径中的多边形数量
-
-    // 检查是否一切就绪
-    if (!_ready) {
-      return false;
-    }
-
-     // 确保导航查询对象不为空
-    DEBUG_ASSERT(_nav_query != nullptr);
+    int num_polys = 0; // 路径中的多边形数量
 
     // 点的延伸
-    float poly_pick_ext[3];
-    poly_pick_ext[0] = 2;
-    poly_pick_ext[1] = 4;
-    poly_pick_ext[2] = 2;
-
-    // 筛选
-    dtQueryFilter filter2;
-    if (filter == nullptr) {
-      filter2.setAreaCost(CARLA_AREA_ROAD, AREA_ROAD_COST); // 设置道路区域的成本
-      filter2.setAreaCost(CARLA_AREA_GRASS, AREA_GRASS_COST); // 设置草地区域的成本
-      filter2.setIncludeFlags(CARLA_TYPE_WALKABLE);  // 设置包含的标志（可通行区域）
-      filter2.setExcludeFlags(CARLA_TYPE_NONE);    // 设置排除的标志（无不可通行区域）
-      filter = &filter2;   // 使用默认过滤器
-    }
+    float poly_pick_ext[3] = { 2, 4, 2 };
 
     // 设置点
     dtPolyRef start_ref = 0;
     dtPolyRef end_ref = 0;
     float start_pos[3] = { from.x, from.z, from.y };  // 转换为Detour库的坐标顺序（x, z, y）
     float end_pos[3] = { to.x, to.z, to.y };
-    {
-      // 关键部分，强制单线程运行这里
-      std::lock_guard<std::mutex> lock(_mutex);
-      _nav_query->findNearestPoly(start_pos, poly_pick_ext, filter, &start_ref, 0);
-      _nav_query->findNearestPoly(end_pos, poly_pick_ext, filter, &end_ref, 0);
-    }
+    query.findNearestPoly(start_pos, poly_pick_ext, &filter, &start_ref, 0);
+    query.findNearestPoly(end_pos, poly_pick_ext, &filter, &end_ref, 0);
     // 如果未找到起始或目标多边形，则返回失败
     if (!start_ref || !end_ref) {
       return false;
     }
 
-    {
-      // 关键部分，强制单线程运行这里
-      std::lock_guard<std::mutex> lock(_mutex);
-      // 获取节点的路径
-      _nav_query->findPath(start_ref, end_ref, start_pos, end_pos, filter, polys, &num_polys, MAX_POLYS);
-    }
-
-    // 获得点的路径
-    num_straight_path = 0;
-    if (num_polys == 0) {
-      return false;
+    // 获取节点的路径，起止多边形相同的路径走廊相同，优先使用缓存
+    const PathCacheKey key { start_ref, end_ref, filter.getIncludeFlags(), filter.getExcludeFlags() };
+    if (!FindCachedPath(key, polys, num_polys)) {
+      query.findPath(start_ref, end_ref, start_pos, end_pos, &filter, polys, &num_polys, MAX_POLYS);
+      if (num_polys == 0) {
+        return false;
+      }
+      AddCachedPath(key, polys, num_polys);
     }
 
     // 如果是部分路径，请确保终点与最后一个多边形相接
     float end_pos2[3];
     dtVcopy(end_pos2, end_pos);
     if (polys[num_polys - 1] != end_ref) {
-      // 关键部分，强制单线程运行这里
-      std::lock_guard<std::mutex> lock(_mutex);
-      _nav_query->closestPointOnPoly(polys[num_polys - 1], end_pos, end_pos2, 0);
+      query.closestPointOnPoly(polys[num_polys - 1], end_pos, end_pos2, 0);
     }
 
     // 获得点
-    {
-      // 关键部分，强制单线程运行这里
-      std::lock_guard<std::mutex> lock(_mutex);
-      _nav_query->findStraightPath(start_pos, end_pos2, polys, num_polys,
-      straight_path, straight_path_flags,
-      straight_path_polys, &num_straight_path, MAX_POLYS, straight_path_options);
-    }
+    query.findStraightPath(start_pos, end_pos2, polys, num_polys,
+        straight_path, straight_path_flags,
+        straight_path_polys, &num_straight_path, MAX_POLYS, straight_path_options);
 
     // 将路径复制到输出缓冲区
     path.clear();
+    area.clear();
     path.reserve(static_cast<unsigned long>(num_straight_path));
+    area.reserve(static_cast<unsigned long>(num_straight_path));
     unsigned char area_type;
     for (int i = 0, j = 0; j < num_straight_path; i += 3, ++j) {
       // 保存虚幻轴的坐标（x，z，y）
       path.emplace_back(straight_path[i], straight_path[i + 2], straight_path[i + 1]);
-      // 保存区域类型
-      {
-        // 关键部分，强制单线程运行这里
-        std::lock_guard<std::mutex> lock(_mutex);
-        _nav_mesh->getPolyArea(straight_path_polys[j], &area_type);// 获取路径点所属的多边形的区域类型
-      }
+      // 保存区域类型，网格在查询期间不会改变，可以并行读取
+      _nav_mesh->getPolyArea(straight_path_polys[j], &area_type);
       area.emplace_back(area_type);
     }
 
-    return true;// 成功找到路径
+    return true;
   }
 
-  bool Navigation::GetAgentRoute(ActorId id, carla::geom::Location from, carla::geom::Location to,
-  std::vector<carla::geom::Location> &path, std::vector<unsigned char> &area) {
-    // 找到路径
-    float straight_path[MAX_POLYS * 3];
-    unsigned char straight_path_flags[MAX_POLYS];
-    dtPolyRef straight_path_polys[MAX_POLYS];
-    int num_straight_path = 0;
-    int straight_path_options = DT_STRAIGHTPATH_AREA_CROSSINGS;
-
-    // 路径中的多边形
-    dtPolyRef polys[MAX_POLYS];
-    int num_polys;
-
+  // 返回从一个位置到另一个位置的路径点
+  bool Navigation::GetPath(carla::geom::Location from, // 起始位置
+                           carla::geom::Location to,   // 目标位置
+                           dtQueryFilter * filter,    // 用于路径查询的过滤器，可以筛选路径通过的区域类型
+                           std::vector<carla::geom::Location> &path, // 用于存储计算出的路径点的向量
+                           std::vector<unsigned char> &area) {  // 用于存储路径点所属区域类型的向量
     // 检查是否一切就绪
     if (!_ready) {
       return false;
     }
 
-    DEBUG_ASSERT(_nav_query != nullptr);
-
-    // 点的扩展
-    float poly_pick_ext[3] = {2,4,2};
+    // 筛选，未指定时使用默认过滤器
+    const dtQueryFilter filter2 = DefaultFilter();
+    const dtQueryFilter &used_filter = (filter == nullptr) ? filter2 : *filter;
 
-    // 从代理获取当前过滤器
-    auto it = _mapped_walkers_id.find(id);
-    if (it == _mapped_walkers_id.end())
+    QueryPtr query = AcquireQuery();
+    if (query == nullptr) {
       return false;
-
-    
-// 定义一个指向查询过滤器的指针，用于后续的路径查询。
-    const dtQueryFilter *filter;
-    {
-      // 关键部分，强制单线程运行这里
-      std::lock_guard<std::mutex> lock(_mutex);
-       // 根据代理的参数获取对应的过滤器。
-      filter = _crowd->getFilter(_crowd->getAgent(it->second)->params.queryFilterType);
     }
+    return ComputePath(*query, used_filter, from, to, path, area);
+  }
 
-    // 设置点
-    dtPolyRef start_ref = 0;
-    dtPolyRef end_ref = 0;
-    // 定义起点和终点的位置数组，注意这里z和y的顺序被交换了，这取决于导航网格的坐标系
-    float start_pos[3] = { from.x, from.z, from.y };
-    float end_pos[3] = { to.x, to.z, to.y };
-    {
-      // 关键部分，强制单线程运行这里
-      std::lock_guard<std::mutex> lock(_mutex);
-      // 查询离起点最近的多边形。
-      _nav_query->findNearestPoly(start_pos, poly_pick_ext, filter, &start_ref, 0);
-       // 查询离终点最近的多边形。
-      _nav_query->findNearestPoly(end_pos, poly_pick_ext, filter, &end_ref, 0);
-    }
-    if (!start_ref || !end_ref) {
+  bool Navigation::GetAgentRoute(ActorId id, carla::geom::Location from, carla::geom::Location to,
+  std::vector<carla::geom::Location> &path, std::vector<unsigned char> &area) {
+    // 检查是否一切就绪
+    if (!_ready) {
       return false;
     }
 
-    // 获取点的路径
+    // 从代理获取当前过滤器的副本，人群更新时也可以使用
+    dtQueryFilter filter;
     {
       // 关键部分，强制单线程运行这里
       std::lock_guard<std::mutex> lock(_mutex);
-      // 使用导航查询对象查询路径。
-      _nav_query->findPath(start_ref, end_ref, start_pos, end_pos, filter, polys, &num_polys, MAX_POLYS);
+      auto it = _mapped_walkers_id.find(id);
+      if (it == _mapped_walkers_id.end())
+        return false;
+      // 根据代理的参数获取对应的过滤器。
+      dtCrowd *crowd = _crowds[AgentGroup(it->second)].crowd;
+      filter = *crowd->getFilter(GetAgent(it->second)->params.queryFilterType);
     }
 
-    // 获取点的路径
-    if (num_polys == 0) {
+    QueryPtr query = AcquireQuery();
+    if (query == nullptr) {
       return false;
     }
+    return ComputePath(*query, filter, from, to, path, area);
+  }
 
-    // 如果是部分路径，请确保终点与最后一个多边形相接
-    float end_pos2[3];
-    dtVcopy(end_pos2, end_pos);  // 先复制终点位置
-    if (polys[num_polys - 1] != end_ref) {
-      // 关键部分，强制单线程运行这里
-      std::lock_guard<std::mutex> lock(_mutex);
-      // 在最后一个多边形上找到最接近终点的点
-      _nav_query->closestPointOnPoly(polys[num_polys - 1], end_pos, end_pos2, 0);
+  // 并行计算多条路径
+  std::vector<Navigation::PathResult> Navigation::GetPaths(
+      const std::vector<PathQuery> &queries,
+      dtQueryFilter * filter) {
+    std::vector<PathResult> results(queries.size());
+    if (!_ready || queries.empty()) {
+      return results;
+    }
+
+    const dtQueryFilter filter2 = DefaultFilter();
+    const dtQueryFilter &used_filter = (filter == nullptr) ? filter2 : *filter;
+
+    // 每个线程使用自己的查询对象
+    ParallelForChunks(queries.size(), [&](size_t begin, size_t end) {
+      QueryPtr query = AcquireQuery();
+      if (query == nullptr) {
+        return;
+      }
+      for (size_t i = begin; i < end; ++i) {
+        results[i].found = ComputePath(*query, used_filter,
+            queries[i].from, queries[i].to, results[i].path, results[i].area);
+      }
+    }, PATH_QUERY_CHUNK);
+
+    return results;
+  }
+
+  // 并行计算多个行人的路线
+  std::vector<Navigation::PathResult> Navigation::GetAgentRoutes(const std::vector<PathQuery> &queries) {
+    std::vector<PathResult> results(queries.size());
+    if (!_ready || queries.empty()) {
+      return results;
     }
 
-    // 获取点
+    // 一次复制所有代理的过滤器，未知的行人不计算路径
+    std::vector<dtQueryFilter> filters(queries.size());
+    std::vector<char> valid(queries.size(), 0);
     {
       // 关键部分，强制单线程运行这里
-       // 锁定互斥锁，确保直线路径查询是单线程执行的。
       std::lock_guard<std::mutex> lock(_mutex);
-      // 使用导航查询对象获取直线路径。
-      _nav_query->findStraightPath(start_pos, end_pos2, polys, num_polys,
-      straight_path, straight_path_flags,
-      straight_path_polys, &num_straight_path, MAX_POLYS, straight_path_options);
+      for (size_t i = 0; i < queries.size(); ++i) {
+        auto it = _mapped_walkers_id.find(queries[i].id);
+        if (it == _mapped_walkers_id.end()) {
+          continue;
+        }
+        dtCrowd *crowd = _crowds[AgentGroup(it->second)].crowd;
+        filters[i] = *crowd->getFilter(GetAgent(it->second)->params.queryFilterType);
+        valid[i] = 1;
+      }
     }
 
-    // 将路径复制到输出缓冲区
-    path.clear();
-    path.reserve(static_cast<unsigned long>(num_straight_path));
-    unsigned char area_type;
-    for (int i = 0, j = 0; j < num_straight_path; i += 3, ++j) {
-      // 保存虚幻轴的坐标（x，z，y）
-      path.emplace_back(straight_path[i], straight_path[i + 2], straight_path[i + 1]);
-      // 保存面积类型
-      {
-        // 关键部分，强制单线程运行这里
-        std::lock_guard<std::mutex> lock(_mutex);
-        _nav_mesh->getPolyArea(straight_path_polys[j], &area_type);
+    // 每个线程使用自己的查询对象
+    ParallelForChunks(queries.size(), [&](size_t begin, size_t end) {
+      QueryPtr query = AcquireQuery();
+      if (query == nullptr) {
+        return;
       }
-      area.emplace_back(area_type);
-    }
+      for (size_t i = begin; i < end; ++i) {
+        if (valid[i]) {
+          results[i].found = ComputePath(*query, filters[i],
+              queries[i].from, queries[i].to, results[i].path, results[i].area);
+        }
+      }
+    }, PATH_QUERY_CHUNK);
 
-    return true;
+    return results;
   }
 
   // 在人群中创造新的行人
@@ -508,8 +675,6 @@ namespace nav {
       return false;
     }
 
-    DEBUG_ASSERT(_crowd != nullptr);
-
     // 设置参数
     memset(&params, 0, sizeof(params));
     params.radius = AGENT_RADIUS;
@@ -535,15 +700,20 @@ namespace nav {
 
     // 来自虚幻坐标（减去一半高度以将枢轴从中心（虚幻）移动到底部（recast））
     float point_from[3] = { from.x, from.z - (AGENT_HEIGHT / 2.0f), from.y };
-    // 添加行人
+    // 添加到负责这个位置的组
     int index;
     {
       // 关键部分，强制单线程运行这里
       std::lock_guard<std::mutex> lock(_mutex);
-      index = _crowd->addAgent(point_from, &params);
+      const int group = GetCrowdGroup(from.x, from.y, true);
+      if (group == -1) {
+        return false;
+      }
+      index = _crowds[group].crowd->addAgent(point_from, &params);
       if (index == -1) {
         return false;
       }
+      index = AgentHandle(group, index);
     }
 
     // 保存 id
@@ -569,65 +739,85 @@ namespace nav {
       return false;
     }
 
-    DEBUG_ASSERT(_crowd != nullptr);
+    // 车辆没有移动时不需要重新计算边界框和所在的组，只恢复人群更新中
+    // 可能被其他代理推开的位置
+    auto it = _mapped_vehicles_id.find(vehicle.id);
+    if (it != _mapped_vehicles_id.end() && !_update_all_vehicles) {
+      const cg::Transform &previous = it->second.transform;
+      if ((vehicle.transform.location - previous.location).SquaredLength() < 0.0001f &&
+          std::abs(vehicle.transform.rotation.yaw - previous.rotation.yaw) < 0.01f) {
+        // 关键部分，强制单线程运行这里
+        std::lock_guard<std::mutex> lock(_mutex);
+        for (int agent_index : it->second.agents) {
+          dtCrowdAgent *agent = GetAgent(agent_index);
+          if (agent) {
+            agent->npos[0] = previous.location.x;
+            agent->npos[1] = previous.location.z;
+            agent->npos[2] = previous.location.y;
+          }
+        }
+        return true;
+      }
+    }
+    VehicleAgents &entry = _mapped_vehicles_id[vehicle.id];
+    entry.transform = vehicle.transform;
 
     // 获取边界框扩展以及周围的一些空间
     float marge = 0.8f;
     float hx = vehicle.bounding.extent.x + marge;
     float hy = vehicle.bounding.extent.y + marge;
     // 定义边界框的 4 个角
-    cg::Vector3D box_corner1 {-hx, -hy, 0};
-    cg::Vector3D box_corner2 { hx + 0.2f, -hy, 0};
-    cg::Vector3D box_corner3 { hx + 0.2f,  hy, 0};
-    cg::Vector3D box_corner4 {-hx,  hy, 0};
-    // 旋转点
+    cg::Vector3D box_corners[4] {
+      {-hx, -hy, 0},
+      { hx + 0.2f, -hy, 0},
+      { hx + 0.2f,  hy, 0},
+      {-hx,  hy, 0}
+    };
+    // 旋转点并转换为世界位置
     float angle = cg::Math::ToRadians(vehicle.transform.rotation.yaw);
-    box_corner1 = cg::Math::RotatePointOnOrigin2D(box_corner1, angle);
-    box_corner2 = cg::Math::RotatePointOnOrigin2D(box_corner2, angle);
-    box_corner3 = cg::Math::RotatePointOnOrigin2D(box_corner3, angle);
-    box_corner4 = cg::Math::RotatePointOnOrigin2D(box_corner4, angle);
-    // 转换为世界位置
-    box_corner1 += vehicle.transform.location;
-    box_corner2 += vehicle.transform.location;
-    box_corner3 += vehicle.transform.location;
-    box_corner4 += vehicle.transform.location;
-
-    // 检查该参与者是否存在
-    auto it = _mapped_vehicles_id.find(vehicle.id);
-    if (it != _mapped_vehicles_id.end()) {
-      // 获得找到的索引
-      int index = it->second;
-      if (index != -1) {
-        // 获得智能体
-        dtCrowdAgent *agent;
-        {
-          // 关键部分，强制单线程运行这里
-          std::lock_guard<std::mutex> lock(_mutex);
-          agent = _crowd->getEditableAgent(index);
-        }
-        if (agent) {
-          // 更新它的位置
-          agent->npos[0] = vehicle.transform.location.x;
-          agent->npos[1] = vehicle.transform.location.z;
-          agent->npos[2] = vehicle.transform.location.y;
-          // 更新其朝向的边界框
-          agent->params.obb[0]  = box_corner1.x;
-          agent->params.obb[1]  = box_corner1.z;
-          agent->params.obb[2]  = box_corner1.y;
-          agent->params.obb[3]  = box_corner2.x;
-          agent->params.obb[4]  = box_corner2.z;
-          agent->params.obb[5]  = box_corner2.y;
-          agent->params.obb[6]  = box_corner3.x;
-          agent->params.obb[7]  = box_corner3.z;
-          agent->params.obb[8]  = box_corner3.y;
-          agent->params.obb[9]  = box_corner4.x;
-          agent->params.obb[10] = box_corner4.z;
-          agent->params.obb[11] = box_corner4.y;
+    for (auto &corner : box_corners) {
+      corner = cg::Math::RotatePointOnOrigin2D(corner, angle);
+      corner += vehicle.transform.location;
+    }
+
+    // 车辆附近的所有组，组中的行人最多离开所在区域 CROWD_GROUP_MARGIN
+    const float range = CROWD_GROUP_MARGIN + CROWD_VEHICLE_RANGE;
+    const cg::Location &location = vehicle.transform.location;
+    std::vector<int> groups;
+    for (int32_t x = CrowdCell(location.x - range); x <= CrowdCell(location.x + range); ++x) {
+      for (int32_t y = CrowdCell(location.y - range); y <= CrowdCell(location.y + range); ++y) {
+        auto group = _crowd_by_cell.find(CrowdCellKey(x, y));
+        if (group != _crowd_by_cell.end()) {
+          groups.emplace_back(group->second);
         }
-        return true;
       }
     }
 
+    // 关键部分，强制单线程运行这里
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    // 更新已有的代理，移除不在附近的组中的代理
+    std::vector<int> agents;
+    for (int agent_index : entry.agents) {
+      auto group = std::find(groups.begin(), groups.end(), AgentGroup(agent_index));
+      if (group == groups.end()) {
+        _crowds[AgentGroup(agent_index)].crowd->removeAgent(AgentIndex(agent_index));
+        _mapped_by_index.erase(agent_index);
+        continue;
+      }
+      groups.erase(group);
+      dtCrowdAgent *agent = GetAgent(agent_index);
+      if (agent) {
+        // 更新它的位置
+        agent->npos[0] = location.x;
+        agent->npos[1] = location.z;
+        agent->npos[2] = location.y;
+        // 更新其朝向的边界框
+        SetVehicleObb(agent->params.obb, box_corners);
+      }
+      agents.emplace_back(agent_index);
+    }
+
     // 设置参数
     memset(&params, 0, sizeof(params));
     params.radius = 2;
@@ -643,49 +833,36 @@ namespace nav {
     params.updateFlags |= DT_CROWD_SEPARATION;
 
     // 更新其朝向的边界框
-    // 数据: [x][y][z] [x][y][z] [x][y][z] [x][y][z]
     params.useObb = true;
-    params.obb[0]  = box_corner1.x;
-    params.obb[1]  = box_corner1.z;
-    params.obb[2]  = box_corner1.y;
-    params.obb[3]  = box_corner2.x;
-    params.obb[4]  = box_corner2.z;
-    params.obb[5]  = box_corner2.y;
-    params.obb[6]  = box_corner3.x;
-    params.obb[7]  = box_corner3.z;
-    params.obb[8]  = box_corner3.y;
-    params.obb[9]  = box_corner4.x;
-    params.obb[10] = box_corner4.z;
-    params.obb[11] = box_corner4.y;
+    SetVehicleObb(params.obb, box_corners);
 
     // 从虚幻坐标（垂直为 Z）到 Recast 坐标（垂直为 Y，右手坐标系）
-    float point_from[3] = { vehicle.transform.location.x,
-                            vehicle.transform.location.z,
-                            vehicle.transform.location.y };
+    float point_from[3] = { location.x, location.z, location.y };
 
-    // 添加行人
-    int index;
-    {
-      // 关键部分，强制单线程运行这里
-      std::lock_guard<std::mutex> lock(_mutex); // 锁定互斥量，确保代码块在多线程环境下是安全的
-      index = _crowd->addAgent(point_from, &params);  // 向人群添加代理，并返回代理的索引
+    // 在新进入的组中添加车辆
+    bool result = true;
+    for (int group : groups) {
+      int index = _crowds[group].crowd->addAgent(point_from, &params);  // 向人群添加代理，并返回代理的索引
       if (index == -1) {
         logging::log("Vehicle agent not added to the crowd by some problem!");
-        return false;
+        result = false;
+        continue;
       }
 
       // 标记为有效
-      dtCrowdAgent *agent = _crowd->getEditableAgent(index);  // 获取代理对象
+      dtCrowdAgent *agent = _crowds[group].crowd->getEditableAgent(index);  // 获取代理对象
       if (agent) {
         agent->state = DT_CROWDAGENT_STATE_WALKING;   // 将代理的状态设为“行走”
       }
-    }
 
-    // 保存 id
-    _mapped_vehicles_id[vehicle.id] = index;  // 将车辆 ID 映射到代理的索引
-    _mapped_by_index[index] = vehicle.id; // 将代理索引映射到车辆 ID
+      // 保存 id
+      index = AgentHandle(group, index);
+      agents.emplace_back(index);
+      _mapped_by_index[index] = vehicle.id; // 将代理编号映射到车辆 ID
+    }
+    entry.agents = std::move(agents);
 
-    return true;
+    return result;
   }
 
   // 移除代理
@@ -696,37 +873,39 @@ namespace nav {
       return false;
     }
 
-    DEBUG_ASSERT(_crowd != nullptr);  // 确保 _crowd 非空
-
     // 获取内部行人索引
     auto it = _mapped_walkers_id.find(id);  // 在映射表中查找行人 ID
     if (it != _mapped_walkers_id.end()) {
+      const int agent = it->second;
       // 从人群中移除
       {
         // 关键部分，强制单线程运行这里
         std::lock_guard<std::mutex> lock(_mutex);
-        _crowd->removeAgent(it->second); // 从人群中移除对应的代理
+        _crowds[AgentGroup(agent)].crowd->removeAgent(AgentIndex(agent)); // 从人群中移除对应的代理
       }
       _walker_manager.RemoveWalker(id);  // 从其他管理系统中移除行人
       // remove from mapping
       _mapped_walkers_id.erase(it);
-      _mapped_by_index.erase(it->second);
+      _mapped_by_index.erase(agent);
+      _walkers_blocked_position.erase(agent);
 
       return true;
     }
 
     // get the internal vehicle index
-    it = _mapped_vehicles_id.find(id);  // 查找车辆 ID
-    if (it != _mapped_vehicles_id.end()) {
-      // 从人群中移除
+    auto vehicle = _mapped_vehicles_id.find(id);  // 查找车辆 ID
+    if (vehicle != _mapped_vehicles_id.end()) {
+      // 从所有组的人群中移除
       {
         // 关键部分，强制单线程运行这里
         std::lock_guard<std::mutex> lock(_mutex); // 锁定互斥量
-        _crowd->removeAgent(it->second);  // 从人群中移除对应的代理
-      }  
+        for (int agent : vehicle->second.agents) {
+          _crowds[AgentGroup(agent)].crowd->removeAgent(AgentIndex(agent));  // 从人群中移除对应的代理
+          _mapped_by_index.erase(agent);
+        }
+      }
       // 从映射中移除
-      _mapped_vehicles_id.erase(it);
-      _mapped_by_index.erase(it->second);
+      _mapped_vehicles_id.erase(vehicle);
 
       return true;
     }
@@ -756,6 +935,7 @@ namespace nav {
       // 删除未更新的代理
       RemoveAgent(entry);
     }
+    _update_all_vehicles = false;
 
     return true;
   }
@@ -768,8 +948,6 @@ namespace nav {
       return false;
     }
 
-    DEBUG_ASSERT(_crowd != nullptr);
-
     // 获取内部索引
     auto it = _mapped_walkers_id.find(id);
     if (it == _mapped_walkers_id.end()) {
@@ -780,7 +958,7 @@ namespace nav {
     {
       // 关键部分，强制单线程运行这里
       std::lock_guard<std::mutex> lock(_mutex); // 锁定互斥量，确保单线程安全
-      dtCrowdAgent *agent = _crowd->getEditableAgent(it->second); // 获取代理
+      dtCrowdAgent *agent = GetAgent(it->second); // 获取代理
       if (agent) {
         agent->params.maxSpeed = max_speed;  // 设置最大速度
         return true;
@@ -832,7 +1010,6 @@ namespace nav {
       return false;
     }
 
-    DEBUG_ASSERT(_crowd != nullptr);
     DEBUG_ASSERT(_nav_query != nullptr);
 
     if (index == -1) {
@@ -846,14 +1023,15 @@ namespace nav {
     {
       // 关键部分，强制单线程运行这里
       std::lock_guard<std::mutex> lock(_mutex);
-      const dtQueryFilter *filter = _crowd->getFilter(0);
+      dtCrowd *crowd = _crowds[AgentGroup(index)].crowd;
+      const dtQueryFilter *filter = crowd->getFilter(0);
       dtPolyRef target_ref;
-      _nav_query->findNearestPoly(point_to, _crowd->getQueryHalfExtents(), filter, &target_ref, nearest);
+      _nav_query->findNearestPoly(point_to, crowd->getQueryHalfExtents(), filter, &target_ref, nearest);
       if (!target_ref) {
         return false;
       }
 
-      res = _crowd->requestMoveTarget(index, target_ref, point_to);
+      res = crowd->requestMoveTarget(AgentIndex(index), target_ref, point_to);
     }
 
     return res;
@@ -867,16 +1045,22 @@ namespace nav {
       return;
     }
 
-    DEBUG_ASSERT(_crowd != nullptr);
-
-    // 更新人群代理
+    // 更新人群代理，各组互不影响，在多个线程中同时更新
     _delta_seconds = state.GetTimestamp().delta_seconds;
     {
       // 关键部分，强制单线程运行这里
       std::lock_guard<std::mutex> lock(_mutex);
-      _crowd->update(static_cast<float>(_delta_seconds), nullptr);
+      const float delta_seconds = static_cast<float>(_delta_seconds);
+      ParallelForChunks(_crowds.size(), [this, delta_seconds](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+          _crowds[i].crowd->update(delta_seconds, nullptr);
+        }
+      }, 1u);
     }
 
+    // 离开所在区域的行人换到新区域的组
+    UpdateWalkerGroups();
+
     // 更新行人路线
     _walker_manager.Update(_delta_seconds);
 
@@ -885,18 +1069,13 @@ namespace nav {
 
     // 查看所有活跃代理
     int total_unblocked = 0;
-    int total_agents;
-    {
-      // 关键部分，强制单线程运行这里
-      std::lock_guard<std::mutex> lock(_mutex);
-      total_agents = _crowd->getAgentCount();
-    }
+    const int total_agents = static_cast<int>(_crowds.size()) * MAX_AGENTS;
     const dtCrowdAgent *ag;
     for (int i = 0; i < total_agents; ++i) {
       {
         // 关键部分，强制单线程运行这里
         std::lock_guard<std::mutex> lock(_mutex);
-        ag = _crowd->getAgent(i);
+        ag = GetAgent(i);
       }
 
       if (!ag->active || ag->paused || ag->dead) {
@@ -948,6 +1127,81 @@ namespace nav {
     }
   }
 
+  // 把离开所在区域的行人移到新区域的组中
+  void Navigation::UpdateWalkerGroups() {
+    std::vector<ActorId> moved;
+    {
+      // 关键部分，强制单线程运行这里
+      std::lock_guard<std::mutex> lock(_mutex);
+      for (auto &&entry : _mapped_walkers_id) {
+        const dtCrowdAgent *agent = GetAgent(entry.second);
+        if (!agent->active || agent->dead) {
+          continue;
+        }
+        const CrowdGroup &group = _crowds[AgentGroup(entry.second)];
+        const float min_x = group.x * CROWD_GROUP_SIZE - CROWD_GROUP_MARGIN;
+        const float min_y = group.y * CROWD_GROUP_SIZE - CROWD_GROUP_MARGIN;
+        const float max_size = CROWD_GROUP_SIZE + 2.0f * CROWD_GROUP_MARGIN;
+        if (agent->npos[0] < min_x || agent->npos[0] > min_x + max_size ||
+            agent->npos[2] < min_y || agent->npos[2] > min_y + max_size) {
+          moved.emplace_back(entry.first);
+        }
+      }
+    }
+
+    for (auto id : moved) {
+      MoveWalkerToGroup(id);
+    }
+  }
+
+  // 把行人移到负责它当前位置的组中，保持它的速度和目标
+  bool Navigation::MoveWalkerToGroup(ActorId id) {
+    auto it = _mapped_walkers_id.find(id);
+    if (it == _mapped_walkers_id.end()) {
+      return false;
+    }
+    const int from = it->second;
+    int to;
+    {
+      // 关键部分，强制单线程运行这里
+      std::lock_guard<std::mutex> lock(_mutex);
+      const dtCrowdAgent *agent = GetAgent(from);
+      const int group = GetCrowdGroup(agent->npos[0], agent->npos[2], true);
+      if (group == -1) {
+        return false;
+      }
+      dtCrowd *crowd = _crowds[group].crowd;
+      const int index = crowd->addAgent(agent->npos, &agent->params);
+      if (index == -1) {
+        // 新的组已满，行人暂时留在原来的组中
+        return false;
+      }
+      dtCrowdAgent *moved = crowd->getEditableAgent(index);
+      dtVcopy(moved->vel, agent->vel);
+      dtVcopy(moved->dvel, agent->dvel);
+      dtVcopy(moved->nvel, agent->nvel);
+      moved->paused = agent->paused;
+      if (agent->targetState != DT_CROWDAGENT_TARGET_NONE && agent->targetRef != 0) {
+        crowd->requestMoveTarget(index, agent->targetRef, agent->targetPos);
+      }
+      _crowds[AgentGroup(from)].crowd->removeAgent(AgentIndex(from));
+      to = AgentHandle(group, index);
+    }
+
+    // 更新映射
+    it->second = to;
+    _mapped_by_index.erase(from);
+    _mapped_by_index[to] = id;
+    auto blocked = _walkers_blocked_position.find(from);
+    if (blocked != _walkers_blocked_position.end()) {
+      const carla::geom::Vector3D position = blocked->second;
+      _walkers_blocked_position.erase(blocked);
+      _walkers_blocked_position[to] = position;
+    }
+
+    return true;
+  }
+
   // 获取行人当前变换
   bool Navigation::GetWalkerTransform(ActorId id, carla::geom::Transform &trans) {
 
@@ -956,8 +1210,6 @@ namespace nav {
       return false;
     }
 
-    DEBUG_ASSERT(_crowd != nullptr);
-
     // 获取内部索引
     auto it = _mapped_walkers_id.find(id);
     if (it == _mapped_walkers_id.end()) {
@@ -975,7 +1227,7 @@ namespace nav {
     {
       // 关键部分，强制单线程运行这里
       std::lock_guard<std::mutex> lock(_mutex);
-      agent = _crowd->getAgent(index);
+      agent = GetAgent(index);
     }
 
     if (!agent->active) {
@@ -1020,8 +1272,6 @@ namespace nav {
       return false;
     }
 
-    DEBUG_ASSERT(_crowd != nullptr);
-
     // 获取内部索引
     auto it = _mapped_walkers_id.find(id);
     if (it == _mapped_walkers_id.end()) {
@@ -1039,7 +1289,7 @@ namespace nav {
     {
       // 关键部分，强制单线程运行这里
       std::lock_guard<std::mutex> lock(_mutex);
-      agent = _crowd->getAgent(index);
+      agent = GetAgent(index);
     }
 
     if (!agent->active) {
@@ -1061,8 +1311,6 @@ namespace nav {
       return 0.0f;
     }
 
-    DEBUG_ASSERT(_crowd != nullptr);
-
     // 获取内部索引
     auto it = _mapped_walkers_id.find(id);
     if (it == _mapped_walkers_id.end()) {
@@ -1080,7 +1328,7 @@ namespace nav {
     {
       // 关键部分，强制单线程运行这里
       std::lock_guard<std::mutex> lock(_mutex);
-      agent = _crowd->getAgent(index);
+      agent = GetAgent(index);
     }
 
     return sqrt(agent->vel[0] * agent->vel[0] + agent->vel[1] * agent->vel[1] + agent->vel[2] *
@@ -1136,7 +1384,7 @@ namespace nav {
     {
       // 关键部分，强制单线程运行这里
       std::lock_guard<std::mutex> lock(_mutex);
-      agent = _crowd->getEditableAgent(agent_index);
+      agent = GetAgent(agent_index);
     }
     agent->params.queryFilterType = static_cast<unsigned char>(filter_index);
   }
@@ -1156,8 +1404,6 @@ namespace nav {
       return;
     }
 
-    DEBUG_ASSERT(_crowd != nullptr);
-
     // 获取内部索引
     auto it = _mapped_walkers_id.find(id);
     if (it == _mapped_walkers_id.end()) {
@@ -1175,7 +1421,7 @@ namespace nav {
     {
       // 关键部分，强制单线程运行这里
       std::lock_guard<std::mutex> lock(_mutex);
-      agent = _crowd->getEditableAgent(index);
+      agent = GetAgent(index);
     }
 
     // 标记为暂停
@@ -1184,12 +1430,9 @@ namespace nav {
 
   bool Navigation::HasVehicleNear(ActorId id, float distance, carla::geom::Location direction) {
     // 获取内部索引（行人或者车辆）
-    auto it = _mapped_walkers_id.find(id);
-    if (it == _mapped_walkers_id.end()) {
-      it = _mapped_vehicles_id.find(id);
-      if (it == _mapped_vehicles_id.end()) {
-        return false;
-      }
+    int agent;
+    if (!FindAgent(id, agent)) {
+      return false;
     }
 
     float dir[3] = { direction.x, direction.z, direction.y };
@@ -1197,7 +1440,7 @@ namespace nav {
     {
       // 关键部分，强制单线程运行这里
       std::lock_guard<std::mutex> lock(_mutex);
-      result = _crowd->hasVehicleNear(it->second, distance * distance, dir, false);
+      result = _crowds[AgentGroup(agent)].crowd->hasVehicleNear(AgentIndex(agent), distance * distance, dir, false);
     }
     return result;
   }
@@ -1205,19 +1448,16 @@ namespace nav {
   /// 让代理查看某个位置
   bool Navigation::SetWalkerLookAt(ActorId id, carla::geom::Location location) {
     // 获取内部索引（行人或车辆）
-    auto it = _mapped_walkers_id.find(id);
-    if (it == _mapped_walkers_id.end()) {
-      it = _mapped_vehicles_id.find(id);
-      if (it == _mapped_vehicles_id.end()) {
-        return false;
-      }
+    int agent_index;
+    if (!FindAgent(id, agent_index)) {
+      return false;
     }
 
     dtCrowdAgent *agent;
     {
       // 关键部分，强制单线程运行这里
       std::lock_guard<std::mutex> lock(_mutex);
-      agent = _crowd->getEditableAgent(it->second);
+      agent = GetAgent(agent_index);
     }
 
     // 获取位置
@@ -1245,8 +1485,6 @@ namespace nav {
       return false;
     }
 
-    DEBUG_ASSERT(_crowd != nullptr);
-
     // 获取内部索引
     auto it = _mapped_walkers_id.find(id);
     if (it == _mapped_walkers_id.end()) {
@@ -1264,7 +1502,7 @@ namespace nav {
     {
       // 关键部分，强制单线程运行这里
       std::lock_guard<std::mutex> lock(_mutex);
-      agent = _crowd->getAgent(index);
+      agent = GetAgent(index);
     }
 
     // 标记
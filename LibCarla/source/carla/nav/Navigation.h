@@ -13,6 +13,7 @@
 // 使用几何库相关功能
 #include "carla/geom/Location.h"
 #include "carla/geom/Transform.h"
+#include "carla/nav/NavAreas.h"
 #include "carla/nav/WalkerManager.h" 
 
 // 使用远程过程调用相关功能
@@ -33,6 +34,14 @@
 #include <recast/DetourCommon.h>
 // 可能包含Recast/Detour库中使用的通用定义、枚举和数据结构
 
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
 namespace carla {
 // 定义命名空间carla，它是CARLA自动驾驶仿真平台的命名空间
 namespace nav {
@@ -41,38 +50,6 @@ namespace nav {
 // 例如，您可能会实现一个函数来加载高度图并生成导航网格
 // 或者实现一个类来管理导航网格的查询和路径规划
 
-  // 导航区域
-  // 参考：https://openhutb.github.io/carla_doc/tuto_M_generate_pedestrian_navigation/
-  enum NavAreas {
-    CARLA_AREA_BLOCK = 0,
-    CARLA_AREA_SIDEWALK,  // 人行道
-    CARLA_AREA_CROSSWALK, // 人行横道：如果找不到地面，行人将在这些网格上行走作为第二种选择。
-    CARLA_AREA_ROAD,      // 马路：行人只能通过这些网格过马路。
-    CARLA_AREA_GRASS      // 草地：行人不会在此网格上行走，除非您指定一定比例的行人这样做。
-  };
-
-  enum SamplePolyFlags
-// 定义一个枚举类型SamplePolyFlags，用于表示导航网格中多边形（Poly）的不同类型或属性
-  {
-    CARLA_TYPE_NONE       = 0x01,
- // 没有任何特殊类型的标志，可能表示一个默认或未知的类型
-    CARLA_TYPE_SIDEWALK   = 0x02,
-// 表示人行道，通常用于行人行走的区域
-    CARLA_TYPE_CROSSWALK  = 0x04,
-// 表示斑马线，是行人过马路时专用的区域
-    CARLA_TYPE_ROAD       = 0x08,
-// 表示道路，通常用于车辆行驶
-    CARLA_TYPE_GRASS      = 0x10,
-// 表示草地，可能允许行人行走，但通常不允许车辆进入
-    CARLA_TYPE_ALL        = 0xffff,
-// 一个特殊的标志，表示上述所有类型的组合，常用于需要匹配所有类型的情况
-// 0xffff即二进制的1111 1111 1111 1111，代表所有位都被设置为1
-
-    CARLA_TYPE_WALKABLE   = CARLA_TYPE_SIDEWALK | CARLA_TYPE_CROSSWALK | CARLA_TYPE_GRASS | CARLA_TYPE_ROAD,
- // 一个方便的组合标志，表示所有可通行的类型，包括人行道、斑马线、草地和道路
- // 但不包括没有任何特殊类型的标志（CARLA_TYPE_NONE）
-  };
-
   /// 向人群发送有关车辆的信息的结构体
   struct VehicleCollisionInfo {
     carla::rpc::ActorId id;
@@ -136,12 +113,29 @@ namespace nav {
 //   - 在实际使用中，这些函数可能会依赖于CARLA仿真平台中的导航系统和地图数据来执行查询。
     std::vector<carla::geom::Location> &path, std::vector<unsigned char> &area);
 
+    /// 批量路径查询的一项
+    struct PathQuery {
+      ActorId id { 0u };
+      carla::geom::Location from;
+      carla::geom::Location to;
+    };
+
+    /// 批量路径查询的结果，与 GetPath 的输出相同
+    struct PathResult {
+      bool found { false };
+      std::vector<carla::geom::Location> path;
+      std::vector<unsigned char> area;
+    };
+
+    /// 并行计算多条路径，所有查询使用同一个过滤器（为空时使用默认过滤器），忽略 PathQuery::id
+    std::vector<PathResult> GetPaths(const std::vector<PathQuery> &queries, dtQueryFilter * filter = nullptr);
+    /// 并行计算多个行人的路线，每个查询使用 PathQuery::id 对应的代理的过滤器
+    std::vector<PathResult> GetAgentRoutes(const std::vector<PathQuery> &queries);
+
     /// 引用模拟器来访问API函数
     void SetSimulator(std::weak_ptr<carla::client::detail::Simulator> simulator);
     /// 设置随机数种子
     void SetSeed(unsigned int seed);
-    /// 创建人群对象
-    void CreateCrowd(void);
     /// 创建新的行人
     bool AddWalker(ActorId id, carla::geom::Location from);
     /// 在人群中创造一辆新的车辆，让行人避开
@@ -156,6 +150,7 @@ namespace nav {
     bool SetWalkerTarget(ActorId id, carla::geom::Location to);
     // 设置新的目标点，直接前往没有事件发生的地方
     bool SetWalkerDirectTarget(ActorId id, carla::geom::Location to);
+    /// @a index 是 AddWalker 分配的代理编号（组号和组内索引）
     bool SetWalkerDirectTargetIndex(int index, carla::geom::Location to);
     /// 获取步行人当前变换
     bool GetWalkerTransform(ActorId id, carla::geom::Transform &trans);
@@ -178,7 +173,11 @@ namespace nav {
     /// 如果行人代理被车辆撞死，则返回
     bool IsWalkerAlive(ActorId id, bool &alive);
 
-    dtCrowd *GetCrowd() { return _crowd; };
+    /// 返回行人分组的数量，每组由一个独立的人群模拟
+    size_t GetCrowdCount() const { return _crowds.size(); };
+
+    /// 返回第 @a group 组的人群
+    dtCrowd *GetCrowd(size_t group) { return _crowds[group].crowd; };
 
     /// 返回最后增量秒数
     double GetDeltaSeconds() { return _delta_seconds; };
@@ -191,11 +190,30 @@ namespace nav {
     /// 网格
     dtNavMesh *_nav_mesh { nullptr };
     dtNavMeshQuery *_nav_query { nullptr };
+    /// 按空间划分的一组行人。行人只和同一组中的代理互相避让，所以各组的人群
+    /// 互不影响，可以在不同的线程中同时更新
+    struct CrowdGroup {
+      dtCrowd *crowd { nullptr };
+      /// 该组负责的区域（网格坐标）
+      int32_t x { 0 };
+      int32_t y { 0 };
+    };
+
+    /// 车辆在附近各组人群中的代理
+    struct VehicleAgents {
+      /// 上次更新代理时车辆的变换
+      carla::geom::Transform transform;
+      std::vector<int> agents;
+    };
+
     /// crowd
-    dtCrowd *_crowd { nullptr };
-    /// mapping Id
+    std::vector<CrowdGroup> _crowds;
+    std::unordered_map<int64_t, int> _crowd_by_cell;
+    /// 有新的组时需要更新所有车辆，包括没有移动的车辆
+    bool _update_all_vehicles { false };
+    /// mapping Id，代理编号为 组号 * MAX_AGENTS + 组内索引
     std::unordered_map<ActorId, int> _mapped_walkers_id;
-    std::unordered_map<ActorId, int> _mapped_vehicles_id;
+    std::unordered_map<ActorId, VehicleAgents> _mapped_vehicles_id;
     // 也可以通过索引进行映射
     std::unordered_map<int, ActorId> _mapped_by_index;
     /// 存储上一个节拍的行人偏航角
@@ -213,8 +231,64 @@ namespace nav {
 
     float _probability_crossing { 0.0f };
 
+    /// 路径查询对象池，每个线程同时使用自己的查询对象，不需要锁住 _mutex
+    using QueryPtr = std::unique_ptr<dtNavMeshQuery, std::function<void(dtNavMeshQuery *)>>;
+    std::vector<dtNavMeshQuery *> _query_pool;
+    std::mutex _query_pool_mutex;
+
+    /// 最近使用的路径走廊（多边形序列）的 LRU 缓存，以起止多边形和过滤器的标志为键
+    struct PathCacheKey {
+      dtPolyRef start;
+      dtPolyRef end;
+      unsigned short include_flags;
+      unsigned short exclude_flags;
+
+      bool operator==(const PathCacheKey &rhs) const {
+        return start == rhs.start && end == rhs.end &&
+            include_flags == rhs.include_flags && exclude_flags == rhs.exclude_flags;
+      }
+    };
+
+    struct PathCacheKeyHash {
+      size_t operator()(const PathCacheKey &key) const {
+        size_t seed = std::hash<uint64_t>()(static_cast<uint64_t>(key.start));
+        seed ^= std::hash<uint64_t>()(static_cast<uint64_t>(key.end)) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+        seed ^= (static_cast<size_t>(key.include_flags) << 16) | key.exclude_flags;
+        return seed;
+      }
+    };
+
+    using PathCacheList = std::list<std::pair<PathCacheKey, std::vector<dtPolyRef>>>;
+    PathCacheList _path_cache_list;
+    std::unordered_map<PathCacheKey, PathCacheList::iterator, PathCacheKeyHash> _path_cache;
+    std::mutex _path_cache_mutex;
+
     /// 为代理分配过滤索引
     void SetAgentFilter(int agent_index, int filter_index);
+    /// 创建一组行人使用的人群对象
+    dtCrowd *CreateCrowd();
+    /// 释放所有组的人群
+    void FreeCrowds();
+    /// 返回负责位置 (@a x, @a y) 的组，没有时根据 @a create 创建新的组或返回 -1
+    int GetCrowdGroup(float x, float y, bool create);
+    /// 返回编号为 @a agent 的代理
+    dtCrowdAgent *GetAgent(int agent);
+    /// 查找参与者的代理，车辆返回它的第一个代理
+    bool FindAgent(ActorId id, int &agent) const;
+    /// 把离开所在区域的行人移到新区域的组中
+    void UpdateWalkerGroups();
+    bool MoveWalkerToGroup(ActorId id);
+
+    /// 从池中取出一个查询对象，离开作用域时放回池中
+    QueryPtr AcquireQuery();
+    void FreeQueryPool();
+    /// 用 @a query 计算一条路径，供 GetPath、GetAgentRoute 和批量查询共用
+    bool ComputePath(dtNavMeshQuery &query, const dtQueryFilter &filter,
+        carla::geom::Location from, carla::geom::Location to,
+        std::vector<carla::geom::Location> &path, std::vector<unsigned char> &area);
+    bool FindCachedPath(const PathCacheKey &key, dtPolyRef *polys, int &num_polys);
+    void AddCachedPath(const PathCacheKey &key, const dtPolyRef *polys, int num_polys);
+    void ClearPathCache();
   };
 
 } // namespace nav
@@ -0,0 +1,40 @@
+// Copyright (c) 2019 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+// 服务器端使用的 Detour 和 DetourCrowd。
+//
+// 虚幻引擎的 Navmesh 模块自带一份 Detour，符号名与 CARLA 的 recastnavigation
+// 分支相同，但数据结构不同（CARLA 的分支增加了车辆的 OBB 代理和行人死亡状态）。
+// 为了不与引擎的符号冲突，服务器库把 CARLA 分支的 Detour 源码编译在
+// carla::nav::recast 命名空间中（见 LibCarla/cmake/server/CMakeLists.txt），
+// 服务器代码只能通过这个头文件使用它们。同一个编译单元中不能再包含引擎的
+// Detour 头文件，两者的头文件保护宏相同。
+
+// Detour 用到的系统头文件必须在命名空间之外包含
+#include <assert.h>
+#include <float.h>
+#include <math.h>
+#include <new>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+namespace carla {
+namespace nav {
+namespace recast {
+
+#include <recast/DetourAlloc.h>
+#include <recast/DetourCommon.h>
+#include <recast/DetourNavMesh.h>
+#include <recast/DetourNavMeshQuery.h>
+#include <recast/DetourCrowd.h>
+
+} // namespace recast
+} // namespace nav
+} // namespace carla
@@ -53,6 +53,10 @@ namespace nav {
         if (it == _walkers.end())
             return false;// 如果未找到行人，返回 false
         _walkers.erase(it);// 移除行人
+        {
+            std::lock_guard<std::mutex> lock(_pending_mutex);
+            _pending_routes.erase(id);
+        }
 
         return true;
     }
@@ -60,6 +64,9 @@ namespace nav {
 	// 更新所有行人路线
     bool WalkerManager::Update(double delta) {
 
+        // 先计算上一帧排队的路线
+        UpdatePendingRoutes();
+
         // 检查所有行人
         for (auto &it : _walkers) {
 
@@ -135,20 +142,56 @@ namespace nav {
         if (it == _walkers.end())
             return false;
 
-        // 获取行人信息
-        WalkerInfo &info = it->second;
-        std::vector<carla::geom::Location> path;
-        std::vector<unsigned char> area;// 存储区域信息
+        // 场景开始时成千上万的行人同时选择目标，路线排队后在下一次 Update 中
+        // 通过 Navigation::GetAgentRoutes 并行计算；同一行人只保留最后的目标
+        std::lock_guard<std::mutex> lock(_pending_mutex);
+        _pending_routes[id] = to;
+        return true;
+    }
+
+    // 批量计算排队的路线
+    void WalkerManager::UpdatePendingRoutes() {
+        if (_nav == nullptr)
+            return;
+
+        // 取出排队的路线，计算过程中找不到路径的行人会重新排队
+        std::unordered_map<ActorId, carla::geom::Location> pending;
+        {
+            std::lock_guard<std::mutex> lock(_pending_mutex);
+            pending.swap(_pending_routes);
+        }
+        if (pending.empty())
+            return;
 
         // 保存起点和终点
-        _nav->GetWalkerPosition(id, info.from);
-        info.to = to;
-        info.currentIndex = 0;
-        info.state = WALKER_IDLE;// 初始化状态为闲置
+        std::vector<Navigation::PathQuery> queries;
+        queries.reserve(pending.size());
+        for (auto &item : pending) {
+            auto it = _walkers.find(item.first);
+            if (it == _walkers.end())
+                continue;
+            WalkerInfo &info = it->second;
+            _nav->GetWalkerPosition(item.first, info.from);
+            info.to = item.second;
+            queries.push_back({ item.first, info.from, info.to });
+        }
+
+        // 从导航中获取所有路径
+        std::vector<Navigation::PathResult> results = _nav->GetAgentRoutes(queries);
 
-        // 从导航中获取路径
-        _nav->GetAgentRoute(id, info.from, to, path, area);
+        for (size_t i = 0; i < queries.size(); ++i) {
+            WalkerInfo &info = _walkers[queries[i].id];
+            info.currentIndex = 0;
+            info.state = WALKER_IDLE;// 初始化状态为闲置
+            BuildRoute(info, results[i].path, results[i].area);
+            // 分配下一个要走的点
+            SetWalkerNextPoint(queries[i].id);
+        }
+    }
 
+    // 创建路线的每个路径点
+    void WalkerManager::BuildRoute(WalkerInfo &info, std::vector<carla::geom::Location> &path,
+        const std::vector<unsigned char> &area) {
         // 创建每个路径点
         info.route.clear();// 清空现有路线
         info.route.reserve(path.size());// 预留空间
@@ -174,10 +217,6 @@ namespace nav {
             }
             previous_area = area[i];
         }
-
-        // 分配下一个要走的点
-        SetWalkerNextPoint(id);
-        return true;
     }
 
     // 设置路线中的下一个点
@@ -283,14 +322,14 @@ namespace nav {
         carla::client::World world = _simulator.lock()->GetWorld();
 
         _traffic_lights.clear();
-        std::vector<carla::rpc::Actor> actors = _simulator.lock()->GetAllTheActorsInTheEpisode();
-        for (auto actor : actors) {
-            carla::client::ActorSnapshot snapshot = _simulator.lock()->GetActorSnapshot(actor.id);
+        auto actors = _simulator.lock()->GetAllTheActorsInTheEpisode();
+        for (const auto &actor : actors) {
+            carla::client::ActorSnapshot snapshot = _simulator.lock()->GetActorSnapshot(actor->id);
             // 仅检查交通灯
-            if (actor.description.id == "traffic.traffic_light") {
+            if (actor->description.id == "traffic.traffic_light") {
                 // 获取交通灯对象
                 SharedPtr<carla::client::TrafficLight> tl =
-                    boost::static_pointer_cast<carla::client::TrafficLight>(world.GetActor(actor.id));
+                    boost::static_pointer_cast<carla::client::TrafficLight>(world.GetActor(actor->id));
                 // 获取交通灯影响的路标
                 std::vector<SharedPtr<carla::client::Waypoint>> list = tl->GetStopWaypoints();
                 for (auto &way : list) {
@@ -15,6 +15,10 @@
 #include "carla/nav/WalkerEvent.h"// 包含Carla项目中远程过程调用（RPC）相关的演员（Actor）标识符（ActorId）头文件，用于唯一标识虚拟世界中的各种实体（如行人、车辆等）
 #include "carla/rpc/ActorId.h"// 包含Carla项目中远程过程调用（RPC）相关的交通信号灯状态（TrafficLightState）头文件，用于表示交通信号灯的不同状态（如红灯、绿灯等）
 #include "carla/rpc/TrafficLightState.h"
+
+#include <mutex>
+#include <unordered_map>
+#include <vector>
 // 定义在Carla项目的nav命名空间下，表明这些类、结构体和函数是与导航相关功能实现的一部分，特别是针对行人导航方面
 namespace carla {
 namespace nav {
@@ -135,6 +139,13 @@ namespace nav {
         // 函数会根据行人当前遇到的事件以及相关状态，执行相应的处理逻辑，比如等待交通灯、通过路口等操作，返回处理结果（EventResult类型，具体类型定义可能在别处）
   
     EventResult ExecuteEvent(ActorId id, WalkerInfo &info, double delta);
+
+    // 一起计算 SetWalkerRoute 排队的所有路线
+    void UpdatePendingRoutes();
+
+    // 根据导航返回的路径点和区域类型创建行人的路线
+    void BuildRoute(WalkerInfo &info, std::vector<carla::geom::Location> &path,
+        const std::vector<unsigned char> &area);
 // 使用无序映射（unordered_map）数据结构来存储每个行人（以ActorId作为键）对应的行人信息（WalkerInfo结构体），
         // 方便快速查找、添加、删除和更新每个行人的相关信息
     std::unordered_map<ActorId, WalkerInfo> _walkers;// 使用向量（vector）数据结构来存储交通灯相关的信息，每个元素是一个包含交通灯共享指针（SharedPtr<carla::client::TrafficLight>）
@@ -143,6 +154,9 @@ namespace nav {
     Navigation *_nav { nullptr };// 使用弱引用（weak_ptr）来存储指向模拟器（Simulator）对象的指针，避免强引用可能导致的循环引用问题，
         // 同时又能通过该弱引用在需要时访问模拟器相关的API函数
     std::weak_ptr<carla::client::detail::Simulator> _simulator;
+    // 等待计算路线的行人及其目标点，在下一次 Update 中批量计算
+    std::unordered_map<ActorId, carla::geom::Location> _pending_routes;
+    std::mutex _pending_mutex;
   };
 
 } // namespace nav
@@ -8,10 +8,15 @@
 
 #include "carla/opendrive/parser/GeometryParser.h"
 
+#include "carla/ParallelFor.h"
 #include "carla/road/MapBuilder.h"
+#include "carla/road/element/Geometry.h"
 
 #include <pugixml/pugixml.hpp>
 
+#include <memory>
+#include <vector>
+
 namespace carla {
 namespace opendrive {
 namespace parser {
@@ -72,6 +77,42 @@ namespace parser {
     GeometryParamPoly3 param_poly3;
   };
 
+  // 根据解析出的参数构造对应的几何对象，未知类型返回空指针
+  static std::unique_ptr<road::element::Geometry> MakeGeometry(const Geometry &geo) {
+    const geom::Location location(static_cast<float>(geo.x), static_cast<float>(geo.y), 0.0f);
+    if (geo.type == "line") {
+      return std::make_unique<road::element::GeometryLine>(geo.s, geo.length, geo.hdg, location);
+    } else if (geo.type == "arc") {
+      return std::make_unique<road::element::GeometryArc>(
+          geo.s, geo.length, geo.hdg, location, geo.arc.curvature);
+    } else if (geo.type == "spiral") {
+      return std::make_unique<road::element::GeometrySpiral>(
+          geo.s, geo.length, geo.hdg, location,
+          geo.spiral.curvStart,
+          geo.spiral.curvEnd);
+    } else if (geo.type == "poly3") {
+      return std::make_unique<road::element::GeometryPoly3>(
+          geo.s, geo.length, geo.hdg, location,
+          geo.poly3.a,
+          geo.poly3.b,
+          geo.poly3.c,
+          geo.poly3.d);
+    } else if (geo.type == "paramPoly3") {
+      return std::make_unique<road::element::GeometryParamPoly3>(
+          geo.s, geo.length, geo.hdg, location,
+          geo.param_poly3.aU,
+          geo.param_poly3.bU,
+          geo.param_poly3.cU,
+          geo.param_poly3.dU,
+          geo.param_poly3.aV,
+          geo.param_poly3.bV,
+          geo.param_poly3.cV,
+          geo.param_poly3.dV,
+          geo.param_poly3.p_range == "arcLength");
+    }
+    return nullptr;
+  }
+
   // 几何构造解析器
   void GeometryParser::Parse(
       const pugi::xml_document &xml,
@@ -130,48 +171,19 @@ namespace parser {
     }
 
     // map_builder calls
-    for (auto const geo : geometry) {
-      carla::road::Road *road = map_builder.GetRoad(geo.road_id);
-      if (geo.type == "line") {
-        map_builder.AddRoadGeometryLine(road, geo.s, geo.x, geo.y, geo.hdg, geo.length);
-      } else if (geo.type == "arc") {
-        map_builder.AddRoadGeometryArc(road, geo.s, geo.x, geo.y, geo.hdg, geo.length, geo.arc.curvature);
-      } else if (geo.type == "spiral") {
-        map_builder.AddRoadGeometrySpiral(road,
-            geo.s,
-            geo.x,
-            geo.y,
-            geo.hdg,
-            geo.length,
-            geo.spiral.curvStart,
-            geo.spiral.curvEnd);
-      } else if (geo.type == "poly3") {
-        map_builder.AddRoadGeometryPoly3(road,
-            geo.s,
-            geo.x,
-            geo.y,
-            geo.hdg,
-            geo.length,
-            geo.poly3.a,
-            geo.poly3.b,
-            geo.poly3.c,
-            geo.poly3.d);
-      } else if (geo.type == "paramPoly3") {
-        map_builder.AddRoadGeometryParamPoly3(road,
-            geo.s,
-            geo.x,
-            geo.y,
-            geo.hdg,
-            geo.length,
-            geo.param_poly3.aU,
-            geo.param_poly3.bU,
-            geo.param_poly3.cU,
-            geo.param_poly3.dU,
-            geo.param_poly3.aV,
-            geo.param_poly3.bV,
-            geo.param_poly3.cV,
-            geo.param_poly3.dV,
-            geo.param_poly3.p_range);
+    // 螺旋线和三次曲线在构造时需要预计算采样点，各几何之间互不依赖，在多个线程中构造
+    std::vector<std::unique_ptr<road::element::Geometry>> built(geometry.size());
+    ParallelForChunks(geometry.size(), [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i) {
+        built[i] = MakeGeometry(geometry[i]);
+      }
+    }, 32u);
+
+    // 按原顺序添加到地图构建器中
+    for (size_t i = 0u; i < geometry.size(); ++i) {
+      if (built[i] != nullptr) {
+        carla::road::Road *road = map_builder.GetRoad(geometry[i].road_id);
+        map_builder.AddRoadGeometry(road, geometry[i].s, std::move(built[i]));
       }
     }
   }
@@ -0,0 +1,174 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/pointcloud/PointCloudIO.h"
+
+#include "carla/Exception.h"
+#include "carla/Logging.h"
+#include "carla/ThreadGroup.h"
+
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+
+namespace carla {
+namespace pointcloud {
+
+namespace {
+
+  /// 写入点云文件的后台线程，第一次使用时创建。
+  class BackgroundWriter {
+  public:
+
+    /// 不在进程退出时销毁，避免在静态对象析构时等待线程。
+    static BackgroundWriter &Get() {
+      static BackgroundWriter *writer = new BackgroundWriter;
+      return *writer;
+    }
+
+    void Push(std::string path, std::string data) {
+      {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _queue.emplace_back(std::move(path), std::move(data));
+        ++_pending;
+      }
+      _wake.notify_all();
+    }
+
+    void Wait() {
+      std::unique_lock<std::mutex> lock(_mutex);
+      _wake.wait(lock, [this]() { return _pending == 0u; });
+    }
+
+  private:
+
+    BackgroundWriter() {
+      _thread.CreateThread([this]() { Run(); });
+    }
+
+    void Run() {
+      while (true) {
+        std::pair<std::string, std::string> item;
+        {
+          std::unique_lock<std::mutex> lock(_mutex);
+          _wake.wait(lock, [this]() { return !_queue.empty(); });
+          item = std::move(_queue.front());
+          _queue.pop_front();
+        }
+        std::ofstream out(item.first, std::ios::binary);
+        out.write(item.second.data(), static_cast<std::streamsize>(item.second.size()));
+        out.close();
+        if (!out) {
+          log_error("failed to write point cloud:", item.first);
+        }
+        {
+          std::lock_guard<std::mutex> lock(_mutex);
+          --_pending;
+        }
+        _wake.notify_all();
+      }
+    }
+
+    std::mutex _mutex;
+
+    std::condition_variable _wake;
+
+    std::deque<std::pair<std::string, std::string>> _queue;
+
+    /// 已加入队列但还没有写完的文件数
+    size_t _pending = 0u;
+
+    ThreadGroup _thread;
+  };
+
+  bool IsLittleEndian() {
+    const uint16_t value = 1u;
+    uint8_t first_byte;
+    std::memcpy(&first_byte, &value, 1u);
+    return first_byte == 1u;
+  }
+
+  /// PLY 的属性类型对应的 NumPy 类型
+  const char *GetNpyType(const std::string &ply_type) {
+    if (ply_type == "float32" || ply_type == "float") return "<f4";
+    if (ply_type == "float64" || ply_type == "double") return "<f8";
+    if (ply_type == "uint32" || ply_type == "uint") return "<u4";
+    if (ply_type == "int32" || ply_type == "int") return "<i4";
+    if (ply_type == "uint16" || ply_type == "ushort") return "<u2";
+    if (ply_type == "int16" || ply_type == "short") return "<i2";
+    if (ply_type == "uint8" || ply_type == "uchar") return "|u1";
+    if (ply_type == "int8" || ply_type == "char") return "|i1";
+    throw_exception(std::invalid_argument("unsupported point property type: " + ply_type));
+    return nullptr;
+  }
+
+  std::string MakeNpyHeader(const size_t count, const std::string &properties) {
+    std::string descr;
+    std::istringstream lines(properties);
+    std::string keyword, type, name;
+    while (lines >> keyword >> type >> name) {
+      descr += "('" + name + "', '" + GetNpyType(type) + "'), ";
+    }
+    std::string dict =
+        "{'descr': [" + descr + "], 'fortran_order': False, 'shape': (" +
+        std::to_string(count) + ",), }";
+    // 魔数、版本和长度共 10 字节，文件头以换行结束并用空格补齐到 64 字节的倍数
+    const size_t unpadded = 10u + dict.size() + 1u;
+    dict.append((64u - unpadded % 64u) % 64u, ' ');
+    dict += '\n';
+    const auto length = static_cast<uint16_t>(dict.size());
+    std::string header("\x93NUMPY\x01\x00", 8u);
+    header += static_cast<char>(length & 0xFFu);
+    header += static_cast<char>(length >> 8u);
+    return header + dict;
+  }
+
+} // namespace
+
+  void PointCloudIO::WaitForPendingWrites() {
+    BackgroundWriter::Get().Wait();
+  }
+
+  const char *PointCloudIO::GetDefaultExtension(const Format format) {
+    switch (format) {
+      case Format::Npy: return ".npy";
+      case Format::Raw: return ".bin";
+      default: return ".ply";
+    }
+  }
+
+  std::string PointCloudIO::MakeHeader(
+      const Format format,
+      const size_t count,
+      const std::string &properties) {
+    // 点以内存中的字节序写入
+    if (!IsLittleEndian()) {
+      throw_exception(std::runtime_error("binary point clouds require a little-endian host"));
+    }
+    switch (format) {
+      case Format::PlyBinary:
+        return "ply\nformat binary_little_endian 1.0\nelement vertex " +
+            std::to_string(count) + "\n" + properties + "\nend_header\n";
+      case Format::Npy:
+        return MakeNpyHeader(count, properties);
+      case Format::Raw:
+        return {};
+      default:
+        throw_exception(std::invalid_argument("not a binary point cloud format"));
+        return {};
+    }
+  }
+
+  void PointCloudIO::WriteInBackground(std::string path, std::string data) {
+    BackgroundWriter::Get().Push(std::move(path), std::move(data));
+  }
+
+} // namespace pointcloud
+} // namespace carla
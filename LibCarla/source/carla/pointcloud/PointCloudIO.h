@@ -8,14 +8,19 @@
 #pragma once
 
 //包含Carla文件系统头文件
+#include "carla/Debug.h"
 #include "carla/FileSystem.h"
 
 //包含fstream头文件，用于文件流操作
+#include <cstdint>
 #include <fstream>
 //包含iterator头文件，用于迭代器操作
 #include <iterator>
 //包含iostream头文件，用于输入输出操作
 #include <iomanip>
+#include <sstream>
+#include <string>
+#include <type_traits>
 
 namespace carla {// 定义命名空间carla，用于组织相关的代码和数据
 namespace pointcloud {// 定义命名空间pointcloud，进一步组织特定于点云处理的代码
@@ -24,6 +29,15 @@ namespace pointcloud {// 定义命名空间pointcloud，进一步组织特定于
 //类的具体实现代码
 
   public:
+
+    /// 点云文件的格式。
+    enum class Format : uint8_t {
+      PlyAscii,   ///< 文本 PLY，每个点一行
+      PlyBinary,  ///< binary_little_endian PLY
+      Npy,        ///< NumPy 的 .npy 文件，每个点是结构化数组的一个元素
+      Raw         ///< 没有文件头，只有点的原始字节
+    };
+
   // 模板函数Dump，用于将点云数据写入到输出流中，PointIt是点迭代器类型，用于遍历点云数据，out是输出流对象，begin和end分别是点云数据的起始和结束迭代器
     template <typename PointIt>
     static void Dump(std::ostream &out, PointIt begin, PointIt end) {
@@ -48,7 +62,68 @@ namespace pointcloud {// 定义命名空间pointcloud，进一步组织特定于
       return path;
     }
 
+    /// 以二进制格式把点写入 @a out。点在内存中的布局与文件中的记录相同，
+    /// 所有点通过一次写入完成。
+    template <typename PointT>
+    static void DumpBinary(std::ostream &out, Format format, const PointT *begin, const PointT *end) {
+      const std::string header = MakeHeader<PointT>(format, begin, end);
+      out.write(header.data(), static_cast<std::streamsize>(header.size()));
+      out.write(
+          reinterpret_cast<const char *>(begin),
+          static_cast<std::streamsize>(sizeof(PointT) * static_cast<size_t>(end - begin)));
+    }
+
+    /// 以 @a format 格式保存点云。扩展名为空时使用格式的默认扩展名。
+    /// @a asynchronous 为 true 时点被复制到内存中，由后台线程写入文件，函数立即
+    /// 返回；写入失败时只记录错误。WaitForPendingWrites 等待所有后台写入完成。
+    template <typename PointT>
+    static std::string SaveToDisk(
+        std::string path,
+        const PointT *begin,
+        const PointT *end,
+        Format format,
+        bool asynchronous = false) {
+      if (format == Format::PlyAscii && !asynchronous) {
+        return SaveToDisk(std::move(path), begin, end);
+      }
+      FileSystem::ValidateFilePath(path, GetDefaultExtension(format));
+      if (!asynchronous) {
+        std::ofstream out(path, std::ios::binary);
+        DumpBinary(out, format, begin, end);
+        return path;
+      }
+      std::ostringstream out;
+      if (format == Format::PlyAscii) {
+        Dump(out, begin, end);
+      } else {
+        DumpBinary(out, format, begin, end);
+      }
+      WriteInBackground(path, out.str());
+      return path;
+    }
+
+    /// 等待所有后台写入完成。
+    static void WaitForPendingWrites();
+
   private:
+
+    static const char *GetDefaultExtension(Format format);
+
+    /// 根据 WritePlyHeaderInfo 写出的属性生成文件头，@a properties 的每一行为
+    /// "property <类型> <名称>"。
+    static std::string MakeHeader(Format format, size_t count, const std::string &properties);
+
+    template <typename PointT>
+    static std::string MakeHeader(Format format, const PointT *begin, const PointT *end) {
+      static_assert(std::is_trivially_copyable<PointT>::value, "points are written as raw bytes");
+      DEBUG_ASSERT(end >= begin);
+      std::ostringstream properties;
+      PointT().WritePlyHeaderInfo(properties);
+      return MakeHeader(format, static_cast<size_t>(end - begin), properties.str());
+    }
+
+    static void WriteInBackground(std::string path, std::string data);
+
     template <typename PointIt> static void WriteHeader(std::ostream &out, PointIt begin, PointIt end) {
       // 断言确保点云数据的数量非负
       DEBUG_ASSERT(std::distance(begin, end) >= 0);
@@ -12,6 +12,11 @@
 #include <torchcluster/cluster.h>
 #include <torch/csrc/jit/passes/tensorexpr_fuser.h>
 #include <c10/cuda/CUDACachingAllocator.h>
+#include <c10/cuda/CUDAGuard.h>
+#include <c10/cuda/CUDAStream.h>
+#include <c10/util/Optional.h>
+#include <algorithm>
+#include <cstring>
 #include <string>
 #include <vector>
 #include <ostream>
@@ -70,11 +75,21 @@ namespace learning {
          wheel_oritentation_tensor, wheel_linear_velocity_tensor, wheel_angular_velocity_tensor};
     return torch::ivalue::Tuple::create(Tuple);// 使用torch::ivalue::Tuple::create方法将IValue向量打包成一个IValue元组，并返回
   }
-// 定义一个函数，用于从粒子力和轮力张量中提取信息，并填充到一个WheelOutput结构体中
-  WheelOutput GetWheelTensorOutput(
+  // 把粒子力复制到 result，复用上一帧已分配的容量。particle_forces 必须是连续的
+  static void CopyParticleForces(const at::Tensor &particle_forces, WheelOutput &result) {
+    const size_t count = static_cast<size_t>(particle_forces.numel());
+    result._particle_forces.resize(count);
+    if (count > 0) {
+      std::memcpy(result._particle_forces.data(),
+          particle_forces.data_ptr<float>(), count * sizeof(float));
+    }
+  }
+
+  // 从粒子力和轮力张量中提取车轮的力、扭矩和粒子受力，写入 result
+  void GetWheelTensorOutput(
       const at::Tensor &particle_forces, // 输入参数：粒子力的张量
-      const at::Tensor &wheel_forces ) {// 输入参数：轮力的张量
-    WheelOutput result;
+      const at::Tensor &wheel_forces, // 输入参数：轮力的张量
+      WheelOutput &result) {
     // 获取轮力张量的数据指针，并假定数据类型为float
     const float* wheel_forces_data = wheel_forces.data_ptr<float>();
     // 从轮力张量中提取x, y, z方向的轮力和轮扭矩，并存储到result结构体中
@@ -84,49 +99,19 @@ namespace learning {
     result.wheel_torque_x = wheel_forces_data[3];
     result.wheel_torque_y = wheel_forces_data[4];
     result.wheel_torque_z = wheel_forces_data[5];
-    // 获取粒子力张量的数据指针，并假定数据类型为float 
-    const float* particle_forces_data = particle_forces.data_ptr<float>();
-    // 定义粒子力的维度数量（假设为3D空间，即x, y, z三个方向）
-    int num_dimensions = 3;
-    // 获取粒子力张量中粒子的数量
-    int num_particles = particle_forces.sizes()[0];
-    // 为存储粒子力的向量预留空间，大小为粒子数量乘以每个粒子的维度数量
-    result._particle_forces.reserve(num_particles*num_dimensions);
-    // 遍历每个粒子，将其x, y, z方向的力添加到result结构体中的粒子力向量中
-    for (int i = 0; i < num_particles; i++) {
-      result._particle_forces.emplace_back(
-          particle_forces_data[i*num_dimensions + 0]);
-      result._particle_forces.emplace_back(
-          particle_forces_data[i*num_dimensions + 1]);
-      result._particle_forces.emplace_back(
-          particle_forces_data[i*num_dimensions + 2]);
-    }
-    return result;
+    CopyParticleForces(particle_forces, result);
   }
-// 该函数接收两个常量引用类型的at::Tensor参数，并返回一个WheelOutput 类型的结果
-  WheelOutput GetWheelTensorOutputDynamic(
+// 与 GetWheelTensorOutput 相同，但动态模型只输出车轮的力
+  void GetWheelTensorOutputDynamic(
       const at::Tensor &particle_forces, 
-      const at::Tensor &wheel_forces) {
-    WheelOutput result;
+      const at::Tensor &wheel_forces,
+      WheelOutput &result) {
     const float* wheel_forces_data = wheel_forces.data_ptr<float>();
     // 从wheel_forces中提取轮子X Y Z方向的力
     result.wheel_forces_x = wheel_forces_data[0];
     result.wheel_forces_y = wheel_forces_data[1];
     result.wheel_forces_z = wheel_forces_data[2];
-    // 从 particle_forces中提取每个粒子的力
-    const float* particle_forces_data = particle_forces.data_ptr<float>();
-    int num_dimensions = 3;
-    int num_particles = particle_forces.sizes()[0];
-    result._particle_forces.reserve(num_particles*num_dimensions);
-    for (int i = 0; i < num_particles; i++) {
-      result._particle_forces.emplace_back(
-          particle_forces_data[i*num_dimensions + 0]);
-      result._particle_forces.emplace_back(
-          particle_forces_data[i*num_dimensions + 1]);
-      result._particle_forces.emplace_back(
-          particle_forces_data[i*num_dimensions + 2]);
-    }
-    return result;
+    CopyParticleForces(particle_forces, result);
   }
 
   // 定义一个名为NeuralModelImpl的结构体，它封装了与神经网络模型相关的数据和操作
@@ -136,54 +121,109 @@ namespace learning {
     // 成员变量：一个PyTorch JIT编译的脚本模块，用于加载和执行神经网络
     torch::jit::script::Module module;
     ~NeuralModelImpl(){}
-    // 成员变量：一个存储粒子位置张量的向量，每个张量代表一组粒子的位置信息 
-    std::vector<at::Tensor> particles_position_tensors;
-    // 成员变量：一个存储粒子速度张量的向量，每个张量代表一组粒子的速度信息
-    std::vector<at::Tensor> particles_velocity_tensors;
-    // 成员函数：获取与指定车轮相关的输入张量，这些张量将作为神经网络的输入  
-    // 参数：  
-    //   - wheel：一个引用传递的WheelInput结构体，包含了车轮的输入信息  
-    //   - wheel_idx：指定车轮的索引，用于从可能的多组车轮输入中选择一组  
-    // 返回值：  
-    //   - 一个torch::jit::IValue对象，它封装了神经网络所需的输入张量（或张量的组合）  
-    //       这个返回值可以直接被传递给torch::jit::script::Module的forward方法
+
+    // 一个车轮在锁页内存和设备上的输入缓冲区，跨帧复用，粒子数超过容量时才重新分配
+    struct WheelBuffers {
+      int64_t capacity = 0;
+      at::Tensor host_positions;
+      at::Tensor host_velocities;
+      at::Tensor device_positions;
+      at::Tensor device_velocities;
+      // 车轮位置(3)、方向(4)、线速度(3)和角速度(3)
+      at::Tensor host_wheel;
+      at::Tensor device_wheel;
+    };
+
+    int device = 0;
+    WheelBuffers wheel_buffers[4];
+    // 转向、油门和刹车
+    at::Tensor host_driver;
+    at::Tensor device_driver;
+    // 输出复制回主机使用的锁页缓冲区，每个输出张量一个
+    std::vector<at::Tensor> host_outputs;
+    // 可选的专用 CUDA 流，模型不再与默认流上的其它工作串行执行
+    c10::optional<c10::cuda::CUDAStream> stream;
+
+    void Reserve(WheelBuffers &buffers, int64_t num_particles);
+
+    // 成员函数：把车轮的输入复制到锁页缓冲区，再异步复制到设备上，返回神经网络的输入元组
     torch::jit::IValue GetWheelTensorInputsCUDA(WheelInput& wheel, int wheel_idx);
+
+    // 把设备上的输出异步复制到第 slot 个锁页缓冲区，返回主机上的张量。
+    // 读取前需要同步当前流
+    at::Tensor ToHost(const at::Tensor &tensor, size_t slot);
   };
+
+  void NeuralModelImpl::Reserve(WheelBuffers &buffers, int64_t num_particles)
+  {
+    auto host_options = torch::TensorOptions().dtype(torch::kFloat32).pinned_memory(true);
+    auto device_options = torch::TensorOptions().dtype(torch::kFloat32).device(torch::kCUDA, device);
+    if (!buffers.host_wheel.defined()) {
+      buffers.host_wheel = torch::empty({13}, host_options);
+      buffers.device_wheel = torch::empty({13}, device_options);
+    }
+    if (buffers.host_positions.defined() && num_particles <= buffers.capacity) {
+      return;
+    }
+    // 按 1.5 倍增长，避免粒子数缓慢增加时每帧都重新分配
+    const int64_t capacity = std::max<int64_t>(
+        std::max<int64_t>(num_particles, 1), buffers.capacity * 3 / 2);
+    buffers.host_positions = torch::empty({capacity, 3}, host_options);
+    buffers.host_velocities = torch::empty({capacity, 3}, host_options);
+    buffers.device_positions = torch::empty({capacity, 3}, device_options);
+    buffers.device_velocities = torch::empty({capacity, 3}, device_options);
+    buffers.capacity = capacity;
+  }
+
   torch::jit::IValue NeuralModelImpl::GetWheelTensorInputsCUDA(WheelInput& wheel, int wheel_idx)
-  {// 从WheelInput结构体中的粒子位置数组创建一个张量
-    at::Tensor particles_position_tensor = 
-        torch::from_blob(wheel.particles_positions, // 指向数据的指针
-            {wheel.num_particles, 3}, torch::kFloat32);// 张量的形状
- // 从WheelInput结构体中的粒子速度数组创建一个张量，过程与位置张量类似
-    at::Tensor particles_velocity_tensor = 
-        torch::from_blob(wheel.particles_velocities, 
-            {wheel.num_particles, 3}, torch::kFloat32);
-// 创建轮子位置张量
-    at::Tensor wheel_positions_tensor = 
-        torch::from_blob(wheel.wheel_positions, // 原始数据，表示轮子的位置
-            {3}, torch::kFloat32);// 张量的维度为3
-// 创建轮子方向张量
-    at::Tensor wheel_oritentation_tensor = 
-        torch::from_blob(wheel.wheel_oritentation, // 原始数据，表示轮子的方向
-            {4}, torch::kFloat32);// 表示张量维度为4
-// 创建轮子线性速度张量
-    at::Tensor wheel_linear_velocity_tensor = 
-        torch::from_blob(wheel.wheel_linear_velocity, // 原始数据，表示轮子的线性速度
-            {3}, torch::kFloat32);// 表示张量的维度为3
-// 创建轮子角速度张量
-    at::Tensor wheel_angular_velocity_tensor = 
-        torch::from_blob(wheel.wheel_angular_velocity, // 原始数据，表示轮子的角速度
-            {3}, torch::kFloat32);// 表示张量的维度为3
-// 将所有准备好的张量以及粒子数量（作为一个标量张量或直接作为整数）放入一个向量中
+  {
+    WheelBuffers &buffers = wheel_buffers[wheel_idx];
+    const int64_t num_particles = wheel.num_particles;
+    Reserve(buffers, num_particles);
+
+    // 复制到锁页内存，设备上的复制才能异步进行
+    const size_t particles_bytes = static_cast<size_t>(num_particles) * 3 * sizeof(float);
+    if (particles_bytes > 0) {
+      std::memcpy(buffers.host_positions.data_ptr<float>(), wheel.particles_positions, particles_bytes);
+      std::memcpy(buffers.host_velocities.data_ptr<float>(), wheel.particles_velocities, particles_bytes);
+    }
+    float* wheel_data = buffers.host_wheel.data_ptr<float>();
+    std::memcpy(wheel_data, wheel.wheel_positions, 3 * sizeof(float));
+    std::memcpy(wheel_data + 3, wheel.wheel_oritentation, 4 * sizeof(float));
+    std::memcpy(wheel_data + 7, wheel.wheel_linear_velocity, 3 * sizeof(float));
+    std::memcpy(wheel_data + 10, wheel.wheel_angular_velocity, 3 * sizeof(float));
+
+    at::Tensor particles_position_tensor = buffers.device_positions.narrow(0, 0, num_particles);
+    at::Tensor particles_velocity_tensor = buffers.device_velocities.narrow(0, 0, num_particles);
+    particles_position_tensor.copy_(buffers.host_positions.narrow(0, 0, num_particles), true);
+    particles_velocity_tensor.copy_(buffers.host_velocities.narrow(0, 0, num_particles), true);
+    buffers.device_wheel.copy_(buffers.host_wheel, true);
+
     std::vector<torch::jit::IValue> Tuple 
-        {particles_position_tensor.cuda(), particles_velocity_tensor.cuda(), wheel_positions_tensor.cuda(), 
-        // 修正了变量名以匹配之前的声明
-         wheel_oritentation_tensor.cuda(), wheel_linear_velocity_tensor.cuda(), wheel_angular_velocity_tensor.cuda(),
+        {particles_position_tensor, particles_velocity_tensor,
+         buffers.device_wheel.narrow(0, 0, 3), buffers.device_wheel.narrow(0, 3, 4),
+         buffers.device_wheel.narrow(0, 7, 3), buffers.device_wheel.narrow(0, 10, 3),
          wheel.num_particles};// 直接作为整数传递，而不是张量  
-    };  
     return torch::ivalue::Tuple::create(Tuple);
   }
 
+  at::Tensor NeuralModelImpl::ToHost(const at::Tensor &tensor, size_t slot)
+  {
+    if (!tensor.is_cuda()) {
+      return tensor.contiguous();
+    }
+    if (host_outputs.size() <= slot) {
+      host_outputs.resize(slot + 1);
+    }
+    at::Tensor &host = host_outputs[slot];
+    if (!host.defined() || host.numel() < tensor.numel()) {
+      host = torch::empty({std::max<int64_t>(tensor.numel(), host.defined() ? host.numel() * 3 / 2 : 0)},
+          torch::TensorOptions().dtype(torch::kFloat32).pinned_memory(true));
+    }
+    at::Tensor result = host.narrow(0, 0, tensor.numel()).view(tensor.sizes());
+    result.copy_(tensor, true);
+    return result;
+  }
   NeuralModel::NeuralModel() {
     // 使用std::make_unique初始化Model成员变量，它是一个指向NeuralModelImpl类型的unique_ptr
     Model = std::make_unique<NeuralModelImpl>();
@@ -200,6 +240,7 @@ namespace learning {
       Model->module = torch::jit::load(filename_str);
       // 构造CUDA设备字符串，格式为"cuda:X"，其中X是传入的设备ID
       std::string cuda_str = "cuda:" + std::to_string(device);
+      Model->device = device;
       // 将模型移动到指定的CUDA设备上执行
       // std::cout << "Using CUDA device " << cuda_str << std::endl;
       // Model->module.to(at::Device(cuda_str));
@@ -246,14 +287,14 @@ namespace learning {
 // 将模型的输出转换为元组，并提取其中的Tensor
     std::vector<torch::jit::IValue> Tensors =  Output.toTuple()->elements();
      // 对每个轮子的输出Tensor进行处理，并更新输出结构体中的相应字段
-    _output.wheel0 = GetWheelTensorOutput(
-        Tensors[0].toTensor().cpu(), Tensors[4].toTensor().cpu() );
-    _output.wheel1 = GetWheelTensorOutput(
-        Tensors[1].toTensor().cpu(), Tensors[5].toTensor().cpu() );
-    _output.wheel2 = GetWheelTensorOutput(
-        Tensors[2].toTensor().cpu(), Tensors[6].toTensor().cpu() );
-    _output.wheel3 = GetWheelTensorOutput(
-        Tensors[3].toTensor().cpu(), Tensors[7].toTensor().cpu() );
+    GetWheelTensorOutput(
+        Tensors[0].toTensor().cpu(), Tensors[4].toTensor().cpu(), _output.wheel0);
+    GetWheelTensorOutput(
+        Tensors[1].toTensor().cpu(), Tensors[5].toTensor().cpu(), _output.wheel1);
+    GetWheelTensorOutput(
+        Tensors[2].toTensor().cpu(), Tensors[6].toTensor().cpu(), _output.wheel2);
+    GetWheelTensorOutput(
+        Tensors[3].toTensor().cpu(), Tensors[7].toTensor().cpu(), _output.wheel3);
 
   }
   void NeuralModel::ForwardDynamic() {
@@ -285,17 +326,17 @@ namespace learning {
 
       std::vector<torch::jit::IValue> Tensors =  Output.toTuple()->elements();
       // 获取车轮0的输出动态张量
-      _output.wheel0 = GetWheelTensorOutputDynamic(
-          Tensors[0].toTensor().cpu(), Tensors[4].toTensor().cpu());
+      GetWheelTensorOutputDynamic(
+          Tensors[0].toTensor().cpu(), Tensors[4].toTensor().cpu(), _output.wheel0);
       // 获取车轮1的输出动态张量
-      _output.wheel1 = GetWheelTensorOutputDynamic(
-          Tensors[1].toTensor().cpu(), Tensors[5].toTensor().cpu());
+      GetWheelTensorOutputDynamic(
+          Tensors[1].toTensor().cpu(), Tensors[5].toTensor().cpu(), _output.wheel1);
       // 获取车轮2的输出动态张量
-      _output.wheel2 = GetWheelTensorOutputDynamic(
-          Tensors[2].toTensor().cpu(), Tensors[6].toTensor().cpu());
+      GetWheelTensorOutputDynamic(
+          Tensors[2].toTensor().cpu(), Tensors[6].toTensor().cpu(), _output.wheel2);
       // 获取车轮3的输出动态张量
-      _output.wheel3 = GetWheelTensorOutputDynamic(
-          Tensors[3].toTensor().cpu(), Tensors[7].toTensor().cpu());
+      GetWheelTensorOutputDynamic(
+          Tensors[3].toTensor().cpu(), Tensors[7].toTensor().cpu(), _output.wheel3);
 
     }
 
@@ -305,20 +346,33 @@ namespace learning {
 // NeuralModel类的ForwardDynamic成员函数，用于执行模型的动态前向传播 
   void NeuralModel::ForwardCUDATensors()
   {
-    // 创建一个用于存储模型输入数据的向量TorchInputs
+    // 在专用流（如果启用）上执行复制和前向传播
+    c10::optional<c10::cuda::CUDAStreamGuard> stream_guard;
+    if (Model->stream) {
+      stream_guard.emplace(*Model->stream);
+    }
+    // 创建一个用于存储模型输入数据的向量TorchInputs，输入复制到跨帧复用的缓冲区中
     std::vector<torch::jit::IValue> TorchInputs;
-    // 将四个轮子的输入数据（可能是传感器数据）转换为PyTorch张量，并添加到TorchInputs中
+    TorchInputs.reserve(7);
     TorchInputs.push_back(Model->GetWheelTensorInputsCUDA(_input.wheel0, 0));
     TorchInputs.push_back(Model->GetWheelTensorInputsCUDA(_input.wheel1, 1));
     TorchInputs.push_back(Model->GetWheelTensorInputsCUDA(_input.wheel2, 2));
     TorchInputs.push_back(Model->GetWheelTensorInputsCUDA(_input.wheel3, 3));
-    // 将驾驶控制输入（方向盘转角、油门、刹车）组合成一个PyTorch张量，并添加到TorchInputs中
-    auto drv_inputs = torch::tensor(
-        {_input.steering, _input.throttle, _input.braking}, torch::kFloat32); //steer, throtle, brake
-    TorchInputs.push_back(drv_inputs.cuda());
+    // 驾驶控制输入（方向盘转角、油门、刹车）
+    if (!Model->host_driver.defined()) {
+      Model->host_driver = torch::empty({3},
+          torch::TensorOptions().dtype(torch::kFloat32).pinned_memory(true));
+      Model->device_driver = torch::empty({3},
+          torch::TensorOptions().dtype(torch::kFloat32).device(torch::kCUDA, Model->device));
+    }
+    float* driver_data = Model->host_driver.data_ptr<float>();
+    driver_data[0] = _input.steering;
+    driver_data[1] = _input.throttle;
+    driver_data[2] = _input.braking;
+    Model->device_driver.copy_(Model->host_driver, true);
+    TorchInputs.push_back(Model->device_driver);
     // 如果地形类型有效（非负值），则将其作为标量添加到TorchInputs中 
     if (_input.terrain_type >= 0) {
-      // 将verbose标志（可能用于控制模型输出的详细程度）添加到TorchInputs中
       TorchInputs.push_back(_input.terrain_type);
     }
     TorchInputs.push_back(_input.verbose);
@@ -329,18 +383,27 @@ namespace learning {
       Output = Model->module.forward(TorchInputs);
     } catch (const c10::Error& e) {
       std::cout << "Error running model: " << e.msg() << std::endl;
+      return;
     }
-// 将Output转换为包含多个元素的元组，并提取其中的张量数据
+    // 所有输出先异步复制到锁页内存，只同步一次
     std::vector<torch::jit::IValue> Tensors =  Output.toTuple()->elements();
-    // 对每个轮子的输出数据，调用GetWheelTensorOutputDynamic函数进行处理（可能是提取特定的输出值或进行格式转换）
-    _output.wheel0 = GetWheelTensorOutput(
-        Tensors[0].toTensor().cpu(), Tensors[4].toTensor().cpu() );
-    _output.wheel1 = GetWheelTensorOutput(
-        Tensors[1].toTensor().cpu(), Tensors[5].toTensor().cpu() );
-    _output.wheel2 = GetWheelTensorOutput(
-        Tensors[2].toTensor().cpu(), Tensors[6].toTensor().cpu() );
-    _output.wheel3 = GetWheelTensorOutput(
-        Tensors[3].toTensor().cpu(), Tensors[7].toTensor().cpu() );
+    at::Tensor HostTensors[8];
+    for (size_t i = 0; i < 8; ++i) {
+      HostTensors[i] = Model->ToHost(Tensors[i].toTensor(), i);
+    }
+    c10::cuda::getCurrentCUDAStream(Model->device).synchronize();
+    GetWheelTensorOutput(HostTensors[0], HostTensors[4], _output.wheel0);
+    GetWheelTensorOutput(HostTensors[1], HostTensors[5], _output.wheel1);
+    GetWheelTensorOutput(HostTensors[2], HostTensors[6], _output.wheel2);
+    GetWheelTensorOutput(HostTensors[3], HostTensors[7], _output.wheel3);
+  }
+
+  void NeuralModel::SetAsyncCUDAStream(bool enabled) {
+    if (enabled) {
+      Model->stream = c10::cuda::getStreamFromPool(false, Model->device);
+    } else {
+      Model->stream = c10::nullopt;
+    }
   }
   
   Outputs& NeuralModel::GetOutputs() {
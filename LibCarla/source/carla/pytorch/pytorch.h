@@ -67,7 +67,8 @@ namespace learning {
     void SetInputs(Inputs input); // 设置输入数据
     void Forward(); // 执行前向传播
     void ForwardDynamic(); // 执行动态前向传播
-    void ForwardCUDATensors(); // 使用CUDA张量执行前向传播
+    void ForwardCUDATensors(); // 使用CUDA张量执行前向传播，输入和输出缓冲区跨帧复用
+    void SetAsyncCUDAStream(bool enabled); // 在专用的CUDA流上执行ForwardCUDATensors
     Outputs& GetOutputs(); // 获取输出数据
 
     ~NeuralModel();  // 析构函数
@@ -0,0 +1,438 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/recorder/RecorderReader.h"
+
+#include "carla/Exception.h"
+
+#include <zlib.h>
+
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+namespace carla {
+namespace recorder {
+
+  // 与 CarlaRecorderPacketId 的顺序一致
+  enum class PacketId : uint8_t {
+    FrameStart = 0,
+    FrameEnd,
+    EventAdd,
+    EventDel,
+    EventParent,
+    Collision,
+    Position,
+    State,
+    AnimVehicle,
+    AnimWalker,
+    VehicleLight
+  };
+
+  // 压缩文件的格式见 CarlaRecorderFile.cpp
+  static constexpr char CompressedMagic[8] = {'C', 'A', 'R', 'L', 'A', 'Z', '0', '1'};
+  static constexpr size_t BlockHeaderSize = 3u * sizeof(uint32_t);
+  static constexpr size_t BlockTableEntrySize = sizeof(uint64_t) + 2u * sizeof(uint32_t);
+  static constexpr size_t CompressedFooterSize = sizeof(uint64_t) + sizeof(uint32_t) + sizeof(CompressedMagic);
+
+  /// 在一段内存中按录制文件的格式（小端、紧密排列）顺序读取，越界时返回 false。
+  class Cursor {
+  public:
+
+    Cursor(const char *begin, const char *end) : _pos(begin), _end(end) {}
+
+    template <typename T>
+    bool Read(T &value) {
+      if (Remaining() < sizeof(T)) {
+        return false;
+      }
+      std::memcpy(&value, _pos, sizeof(T));
+      _pos += sizeof(T);
+      return true;
+    }
+
+    bool ReadString(std::string &value) {
+      uint16_t length = 0u;
+      if (!Read(length) || Remaining() < length) {
+        return false;
+      }
+      value.assign(_pos, length);
+      _pos += length;
+      return true;
+    }
+
+    bool Skip(size_t size) {
+      if (Remaining() < size) {
+        return false;
+      }
+      _pos += size;
+      return true;
+    }
+
+    const char *Position() const {
+      return _pos;
+    }
+
+    size_t Remaining() const {
+      return static_cast<size_t>(_end - _pos);
+    }
+
+  private:
+
+    const char *_pos;
+
+    const char *_end;
+  };
+
+  struct Vector3 {
+    float x, y, z;
+  };
+
+  const RecorderColumn *RecorderTable::Find(const std::string &field) const {
+    for (const auto &column : columns) {
+      if (column.field == field) {
+        return &column;
+      }
+    }
+    return nullptr;
+  }
+
+  const RecorderTable *RecorderData::Find(const std::string &table_name) const {
+    for (const auto &table : tables) {
+      if (table.name == table_name) {
+        return &table;
+      }
+    }
+    return nullptr;
+  }
+
+  // ===========================================================================
+  // -- 文件内容 ---------------------------------------------------------------
+  // ===========================================================================
+
+  template <typename T>
+  static T ReadAt(const std::vector<char> &raw, size_t offset) {
+    T value;
+    std::memcpy(&value, raw.data() + offset, sizeof(T));
+    return value;
+  }
+
+  // 压缩文件中每一块的位置、解压后的大小和压缩后的大小
+  struct Block {
+    uint64_t physical;
+    uint32_t size;
+    uint32_t compressed;
+  };
+
+  static std::vector<Block> FindBlocks(const std::vector<char> &raw) {
+    std::vector<Block> blocks;
+    const size_t magic_size = sizeof(CompressedMagic);
+
+    // 优先使用文件末尾的块表
+    if (raw.size() >= magic_size + CompressedFooterSize) {
+      const size_t footer = raw.size() - CompressedFooterSize;
+      const auto table = ReadAt<uint64_t>(raw, footer);
+      const auto total = ReadAt<uint32_t>(raw, footer + sizeof(uint64_t));
+      if (std::memcmp(raw.data() + footer + sizeof(uint64_t) + sizeof(uint32_t), CompressedMagic, magic_size) == 0 &&
+          table + static_cast<uint64_t>(total) * BlockTableEntrySize == footer) {
+        blocks.reserve(total);
+        for (uint32_t i = 0u; i < total; ++i) {
+          const size_t entry = static_cast<size_t>(table) + i * BlockTableEntrySize;
+          blocks.push_back(Block{
+              ReadAt<uint64_t>(raw, entry),
+              ReadAt<uint32_t>(raw, entry + sizeof(uint64_t)),
+              ReadAt<uint32_t>(raw, entry + sizeof(uint64_t) + sizeof(uint32_t))});
+        }
+        return blocks;
+      }
+    }
+
+    // 没有块表（录制时崩溃）时按顺序扫描，用 CRC32 排除不完整的块
+    size_t physical = magic_size;
+    while (physical + BlockHeaderSize <= raw.size()) {
+      const auto size = ReadAt<uint32_t>(raw, physical);
+      const auto compressed = ReadAt<uint32_t>(raw, physical + sizeof(uint32_t));
+      const auto crc = ReadAt<uint32_t>(raw, physical + 2u * sizeof(uint32_t));
+      const size_t stored = compressed > 0u ? compressed : size;
+      const size_t start = physical + BlockHeaderSize;
+      if (size == 0u || start + stored > raw.size()) {
+        break;
+      }
+      const auto *bytes = reinterpret_cast<const Bytef *>(raw.data() + start);
+      if (crc32(0u, bytes, static_cast<uInt>(stored)) != crc) {
+        break;
+      }
+      blocks.push_back(Block{start, size, compressed});
+      physical = start + stored;
+    }
+    return blocks;
+  }
+
+  static std::vector<char> Decompress(const std::vector<char> &raw) {
+    const auto blocks = FindBlocks(raw);
+    size_t total = 0u;
+    for (const auto &block : blocks) {
+      total += block.size;
+    }
+    std::vector<char> data(total);
+    size_t offset = 0u;
+    for (const auto &block : blocks) {
+      const size_t stored = block.compressed > 0u ? block.compressed : block.size;
+      if (block.physical + stored > raw.size()) {
+        break;
+      }
+      const char *source = raw.data() + block.physical;
+      if (block.compressed == 0u) {
+        std::memcpy(data.data() + offset, source, block.size);
+      } else {
+        uLongf size = block.size;
+        if (uncompress(
+                reinterpret_cast<Bytef *>(data.data() + offset),
+                &size,
+                reinterpret_cast<const Bytef *>(source),
+                block.compressed) != Z_OK || size != block.size) {
+          // 损坏的块之后的数据无法使用
+          break;
+        }
+      }
+      offset += block.size;
+    }
+    data.resize(offset);
+    return data;
+  }
+
+  // ===========================================================================
+  // -- 解码 -------------------------------------------------------------------
+  // ===========================================================================
+
+  static RecorderTable &AddTable(
+      RecorderData &result,
+      std::string name,
+      std::vector<RecorderColumn> columns) {
+    RecorderTable table(std::move(name));
+    table.columns.emplace_back("frame", 'u', sizeof(uint64_t), 1u);
+    for (auto &column : columns) {
+      table.columns.push_back(std::move(column));
+    }
+    result.tables.push_back(std::move(table));
+    return result.tables.back();
+  }
+
+  RecorderData ReadRecorderFile(const std::string &filename) {
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+      throw_exception(std::runtime_error(filename + ": no such file"));
+    }
+    std::vector<char> raw{std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+    file.close();
+
+    RecorderData result;
+    result.compressed = raw.size() >= sizeof(CompressedMagic) &&
+        std::memcmp(raw.data(), CompressedMagic, sizeof(CompressedMagic)) == 0;
+    const std::vector<char> data = result.compressed ? Decompress(raw) : std::move(raw);
+
+    Cursor cursor(data.data(), data.data() + data.size());
+    std::string magic;
+    if (!cursor.Read(result.version) ||
+        !cursor.ReadString(magic) ||
+        magic != "CARLA_RECORDER" ||
+        !cursor.Read(result.date) ||
+        !cursor.ReadString(result.map)) {
+      throw_exception(std::runtime_error(filename + ": not a CARLA recorder file"));
+    }
+
+    // 预先创建所有的表，之后 tables 不再改变大小，引用保持有效
+    result.tables.reserve(8u);
+    auto &frames = AddTable(result, "frames", {
+        {"elapsed", 'f', sizeof(double), 1u},
+        {"delta", 'f', sizeof(double), 1u}});
+    auto &actors = AddTable(result, "actors", {
+        {"id", 'u', sizeof(uint32_t), 1u},
+        {"type", 'u', sizeof(uint8_t), 1u},
+        {"uid", 'u', sizeof(uint32_t), 1u},
+        {"location", 'f', sizeof(float), 3u},
+        {"rotation", 'f', sizeof(float), 3u}});
+    auto &destroyed = AddTable(result, "destroyed", {
+        {"id", 'u', sizeof(uint32_t), 1u}});
+    auto &parents = AddTable(result, "parents", {
+        {"id", 'u', sizeof(uint32_t), 1u},
+        {"parent", 'u', sizeof(uint32_t), 1u}});
+    auto &positions = AddTable(result, "positions", {
+        {"id", 'u', sizeof(uint32_t), 1u},
+        {"location", 'f', sizeof(float), 3u},
+        {"rotation", 'f', sizeof(float), 3u}});
+    auto &collisions = AddTable(result, "collisions", {
+        {"id", 'u', sizeof(uint32_t), 2u},
+        {"hero", 'u', sizeof(uint8_t), 2u}});
+    auto &traffic_lights = AddTable(result, "traffic_lights", {
+        {"id", 'u', sizeof(uint32_t), 1u},
+        {"state", 'u', sizeof(uint8_t), 1u},
+        {"frozen", 'u', sizeof(uint8_t), 1u},
+        {"elapsed", 'f', sizeof(float), 1u}});
+    auto &vehicle_lights = AddTable(result, "vehicle_lights", {
+        {"id", 'u', sizeof(uint32_t), 1u},
+        {"state", 'u', sizeof(uint32_t), 1u}});
+
+    uint64_t frame = 0u;
+
+    while (cursor.Remaining() > 0u) {
+      uint8_t id = 0u;
+      uint32_t size = 0u;
+      if (!cursor.Read(id) || !cursor.Read(size) || cursor.Remaining() < size) {
+        // 录制中断时最后一个数据包不完整
+        break;
+      }
+      Cursor packet(cursor.Position(), cursor.Position() + size);
+      cursor.Skip(size);
+
+      // 除帧以外的数据包都以 uint16 的元素数量开头，每个元素完整读取后才加入表中
+      uint16_t total = 0u;
+      switch (static_cast<PacketId>(id)) {
+        case PacketId::FrameStart: {
+          double delta = 0.0;
+          double elapsed = 0.0;
+          if (packet.Read(frame) && packet.Read(delta) && packet.Read(elapsed)) {
+            frames.columns[0].Append(frame);
+            frames.columns[1].Append(elapsed);
+            frames.columns[2].Append(delta);
+          }
+          break;
+        }
+
+        case PacketId::EventAdd:
+          packet.Read(total);
+          for (uint16_t i = 0u; i < total; ++i) {
+            uint32_t actor_id = 0u;
+            uint8_t type = 0u;
+            Vector3 location, rotation;
+            uint32_t uid = 0u;
+            std::string type_id;
+            uint16_t attributes = 0u;
+            if (!packet.Read(actor_id) || !packet.Read(type) ||
+                !packet.Read(location) || !packet.Read(rotation) ||
+                !packet.Read(uid) || !packet.ReadString(type_id) ||
+                !packet.Read(attributes)) {
+              break;
+            }
+            // 蓝图属性：类型、id 和值，这里不需要
+            bool valid = true;
+            for (uint16_t j = 0u; j < attributes && valid; ++j) {
+              std::string ignored;
+              valid = packet.Skip(sizeof(uint8_t)) && packet.ReadString(ignored) && packet.ReadString(ignored);
+            }
+            if (!valid) {
+              break;
+            }
+            actors.columns[0].Append(frame);
+            actors.columns[1].Append(actor_id);
+            actors.columns[2].Append(type);
+            actors.columns[3].Append(uid);
+            actors.columns[4].Append(location);
+            actors.columns[5].Append(rotation);
+            result.actor_type_ids.push_back(std::move(type_id));
+          }
+          break;
+
+        case PacketId::EventDel:
+          packet.Read(total);
+          for (uint16_t i = 0u; i < total; ++i) {
+            uint32_t actor_id = 0u;
+            if (!packet.Read(actor_id)) {
+              break;
+            }
+            destroyed.columns[0].Append(frame);
+            destroyed.columns[1].Append(actor_id);
+          }
+          break;
+
+        case PacketId::EventParent:
+          packet.Read(total);
+          for (uint16_t i = 0u; i < total; ++i) {
+            uint32_t actor_id = 0u;
+            uint32_t parent = 0u;
+            if (!packet.Read(actor_id) || !packet.Read(parent)) {
+              break;
+            }
+            parents.columns[0].Append(frame);
+            parents.columns[1].Append(actor_id);
+            parents.columns[2].Append(parent);
+          }
+          break;
+
+        case PacketId::Collision:
+          packet.Read(total);
+          for (uint16_t i = 0u; i < total; ++i) {
+            uint32_t collision_id = 0u;
+            uint32_t ids[2] = {0u, 0u};
+            uint8_t hero[2] = {0u, 0u};
+            if (!packet.Read(collision_id) || !packet.Read(ids) || !packet.Read(hero)) {
+              break;
+            }
+            collisions.columns[0].Append(frame);
+            collisions.columns[1].Append(ids);
+            collisions.columns[2].Append(hero);
+          }
+          break;
+
+        case PacketId::Position:
+          packet.Read(total);
+          for (uint16_t i = 0u; i < total; ++i) {
+            uint32_t actor_id = 0u;
+            Vector3 location, rotation;
+            if (!packet.Read(actor_id) || !packet.Read(location) || !packet.Read(rotation)) {
+              break;
+            }
+            positions.columns[0].Append(frame);
+            positions.columns[1].Append(actor_id);
+            positions.columns[2].Append(location);
+            positions.columns[3].Append(rotation);
+          }
+          break;
+
+        case PacketId::State:
+          packet.Read(total);
+          for (uint16_t i = 0u; i < total; ++i) {
+            uint32_t actor_id = 0u;
+            uint8_t frozen = 0u;
+            float elapsed = 0.0f;
+            uint8_t state = 0u;
+            if (!packet.Read(actor_id) || !packet.Read(frozen) || !packet.Read(elapsed) || !packet.Read(state)) {
+              break;
+            }
+            traffic_lights.columns[0].Append(frame);
+            traffic_lights.columns[1].Append(actor_id);
+            traffic_lights.columns[2].Append(state);
+            traffic_lights.columns[3].Append(frozen);
+            traffic_lights.columns[4].Append(elapsed);
+          }
+          break;
+
+        case PacketId::VehicleLight:
+          packet.Read(total);
+          for (uint16_t i = 0u; i < total; ++i) {
+            uint32_t actor_id = 0u;
+            uint32_t state = 0u;
+            if (!packet.Read(actor_id) || !packet.Read(state)) {
+              break;
+            }
+            vehicle_lights.columns[0].Append(frame);
+            vehicle_lights.columns[1].Append(actor_id);
+            vehicle_lights.columns[2].Append(state);
+          }
+          break;
+
+        default:
+          // 其他数据包（动画、物理控制、关键帧、帧索引等）不需要解码
+          break;
+      }
+    }
+
+    return result;
+  }
+
+} // namespace recorder
+} // namespace carla
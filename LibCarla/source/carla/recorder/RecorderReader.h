@@ -0,0 +1,112 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace carla {
+namespace recorder {
+
+  /// @brief 录制文件解码后的一列数据。
+  ///
+  /// 与 rpc::ActorQueryColumn 的布局相同：每行由 @a width 个大小为
+  /// @a element_size 字节的元素组成，所有行紧密排列在 @a data 中。
+  class RecorderColumn {
+  public:
+
+    RecorderColumn() = default;
+
+    RecorderColumn(std::string in_field, char in_kind, uint8_t in_element_size, uint32_t in_width)
+      : field(std::move(in_field)),
+        kind(static_cast<uint8_t>(in_kind)),
+        element_size(in_element_size),
+        width(in_width) {}
+
+    std::string field;
+
+    /// 元素的类型，与numpy的类型字符一致：'f' 为浮点数，'u' 为无符号整数。
+    uint8_t kind = 0u;
+
+    uint8_t element_size = 0u;
+
+    uint32_t width = 0u;
+
+    std::vector<unsigned char> data;
+
+    size_t size() const {
+      const size_t row_size = element_size * width;
+      return row_size == 0u ? 0u : data.size() / row_size;
+    }
+
+    template <typename T>
+    void Append(const T &value) {
+      const auto *begin = reinterpret_cast<const unsigned char *>(&value);
+      data.insert(data.end(), begin, begin + sizeof(T));
+    }
+  };
+
+  /// @brief 同一类数据包解码后的表，第一列总是 "frame"（帧号）。
+  class RecorderTable {
+  public:
+
+    RecorderTable() = default;
+
+    explicit RecorderTable(std::string in_name) : name(std::move(in_name)) {}
+
+    std::string name;
+
+    std::vector<RecorderColumn> columns;
+
+    size_t size() const {
+      return columns.empty() ? 0u : columns.front().size();
+    }
+
+    /// 返回名为 @a field 的列，不存在时返回nullptr。
+    const RecorderColumn *Find(const std::string &field) const;
+  };
+
+  /// @brief 整个录制文件按列解码的结果。
+  ///
+  /// 包含以下表，位置为厘米、角度为度，与录制文件中的单位一致：
+  ///   - "frames"：frame, elapsed, delta（秒）；
+  ///   - "actors"：frame, id, type, uid, location, rotation，
+  ///     每行的蓝图 id 在 @a actor_type_ids 中；
+  ///   - "destroyed"：frame, id；
+  ///   - "parents"：frame, id, parent；
+  ///   - "positions"：frame, id, location, rotation；
+  ///   - "collisions"：frame, id (2), hero (2)；
+  ///   - "traffic_lights"：frame, id, state, frozen, elapsed；
+  ///   - "vehicle_lights"：frame, id, state。
+  class RecorderData {
+  public:
+
+    uint16_t version = 0u;
+
+    std::string map;
+
+    int64_t date = 0;
+
+    /// 文件是否使用 zlib 分块压缩。
+    bool compressed = false;
+
+    std::vector<RecorderTable> tables;
+
+    std::vector<std::string> actor_type_ids;
+
+    /// 返回名为 @a name 的表，不存在时返回nullptr。
+    const RecorderTable *Find(const std::string &name) const;
+  };
+
+  /// 在不启动模拟器的情况下读取并解码录制文件（普通文件或压缩文件）。
+  /// 文件不存在或不是录制文件时抛出 std::runtime_error；录制中断导致
+  /// 文件末尾不完整时，只返回完整的数据包。
+  RecorderData ReadRecorderFile(const std::string &filename);
+
+} // namespace recorder
+} // namespace carla
@@ -6,6 +6,7 @@
 
 #include "carla/road/Map.h" // 导入地图相关的头文件
 #include "carla/Exception.h" // 导入异常处理的头文件
+#include "carla/ParallelFor.h" // 导入多线程分块执行的头文件
 #include "carla/geom/Math.h" // 导入数学计算相关的头文件
 #include "carla/geom/Vector3D.h" // 导入三维向量相关的头文件
 #include "carla/road/MeshFactory.h" // 导入网格工厂的头文件
@@ -22,6 +23,7 @@
 
 #include "marchingcube/MeshReconstruction.h" // 导入网格重建的头文件
 
+#include <algorithm> // 导入算法库
 #include <vector> // 导入向量库
 #include <unordered_map> // 导入无序映射库
 #include <stdexcept> // 导入标准异常库
@@ -29,6 +31,8 @@
 #include <thread> // 导入线程相关库
 #include <iomanip> // 导入格式化输入输出库
 #include <cmath> // 导入数学库
+#include <exception> // 导入异常指针相关库
+#include <iterator> // 导入迭代器库
 
 namespace carla {
 namespace road {
@@ -168,12 +172,20 @@ static bool IsLanePresent(const MapData &data, Waypoint waypoint) {
 boost::optional<Waypoint> Map::GetClosestWaypointOnRoad(
     const geom::Location &pos,
     int32_t lane_type) const {
-    std::vector<Rtree::TreeElement> query_result =
-        _rtree.GetNearestNeighboursWithFilter(Rtree::BPoint(pos.x, pos.y, pos.z), // 获取与位置最近的邻居节点
+    std::vector<Rtree::TreeElement> query_result;
+    return GetClosestWaypointOnRoad(pos, lane_type, query_result);
+}
+
+boost::optional<Waypoint> Map::GetClosestWaypointOnRoad(
+    const geom::Location &pos,
+    int32_t lane_type,
+    std::vector<Rtree::TreeElement> &query_result) const {
+    _rtree.GetNearestNeighboursWithFilter(Rtree::BPoint(pos.x, pos.y, pos.z), // 获取与位置最近的邻居节点
         [&](Rtree::TreeElement const &element) {
             const Lane &lane = GetLane(element.second.first); // 获取车道
             return (lane_type & static_cast<int32_t>(lane.GetType())) > 0; // 检查车道类型是否匹配
-        });
+        },
+        query_result);
 
     if (query_result.size() == 0) { // 如果没有找到结果
         return boost::optional<Waypoint>{}; // 返回空的航点
@@ -215,8 +227,12 @@ boost::optional<Waypoint> Map::GetClosestWaypointOnRoad(
 boost::optional<Waypoint> Map::GetWaypoint(
     const geom::Location &pos,
     int32_t lane_type) const {
-    boost::optional<Waypoint> w = GetClosestWaypointOnRoad(pos, lane_type); // 获取最近的航点
+    return FilterWaypointInLane(pos, GetClosestWaypointOnRoad(pos, lane_type)); // 获取最近的航点
+}
 
+boost::optional<Waypoint> Map::FilterWaypointInLane(
+    const geom::Location &pos,
+    boost::optional<Waypoint> w) const {
     if (!w.has_value()) { // 如果没有找到航点
         return w; // 返回空
     }
@@ -233,6 +249,34 @@ boost::optional<Waypoint> Map::GetWaypoint(
     return boost::optional<Waypoint>{}; // 否则返回空
 }
 
+std::vector<boost::optional<Waypoint>> Map::GetClosestWaypointsOnRoad(
+    const std::vector<geom::Location> &locations,
+    int32_t lane_type) const {
+    std::vector<boost::optional<Waypoint>> result(locations.size());
+    ParallelForChunks(locations.size(), [&](size_t begin, size_t end) {
+        std::vector<Rtree::TreeElement> query_result; // 本块内所有查询共用的缓冲区
+        for (size_t i = begin; i < end; ++i) {
+            result[i] = GetClosestWaypointOnRoad(locations[i], lane_type, query_result);
+        }
+    });
+    return result;
+}
+
+std::vector<boost::optional<Waypoint>> Map::GetWaypoints(
+    const std::vector<geom::Location> &locations,
+    int32_t lane_type) const {
+    std::vector<boost::optional<Waypoint>> result(locations.size());
+    ParallelForChunks(locations.size(), [&](size_t begin, size_t end) {
+        std::vector<Rtree::TreeElement> query_result; // 本块内所有查询共用的缓冲区
+        for (size_t i = begin; i < end; ++i) {
+            result[i] = FilterWaypointInLane(
+                locations[i],
+                GetClosestWaypointOnRoad(locations[i], lane_type, query_result));
+        }
+    });
+    return result;
+}
+
 boost::optional<Waypoint> Map::GetWaypoint(
     RoadId road_id,
     LaneId lane_id,
@@ -334,109 +378,102 @@ std::pair<const RoadInfoMarkRecord *, const RoadInfoMarkRecord *>
 // 获取指定距离内的信号
 std::vector<Map::SignalSearchData> Map::GetSignalsInDistance(
     Waypoint waypoint, double distance, bool stop_at_junction) const {
+  std::vector<SignalSearchData> result; // 存储结果信号数据的向量
+  std::vector<Waypoint> next_buffer;
+  AppendSignalsInDistance(waypoint, distance, stop_at_junction, 0.0, result, next_buffer);
+  return result; // 返回结果
+}
+
+std::vector<std::vector<Map::SignalSearchData>> Map::GetSignalsInDistance(
+    const std::vector<Waypoint> &waypoints, double distance, bool stop_at_junction) const {
+  std::vector<std::vector<SignalSearchData>> result(waypoints.size());
+  ParallelForChunks(waypoints.size(), [&](size_t begin, size_t end) {
+    std::vector<Waypoint> next_buffer; // 本块内所有查询共用的缓冲区
+    for (size_t i = begin; i < end; ++i) {
+      AppendSignalsInDistance(waypoints[i], distance, stop_at_junction, 0.0, result[i], next_buffer);
+    }
+  }, 64u);
+  return result;
+}
+
+void Map::AppendSignalsInDistance(
+    Waypoint waypoint,
+    const double distance,
+    const bool stop_at_junction,
+    const double accumulated_s,
+    std::vector<SignalSearchData> &result,
+    std::vector<Waypoint> &next_buffer) const {
 
-  const auto &lane = GetLane(waypoint); // 获取Waypoint对应的车道
+  const auto *links = FindLaneLinks(waypoint);
+  const auto &lane = links != nullptr ? *links->lane : GetLane(waypoint); // 获取Waypoint对应的车道
   const bool forward = (waypoint.lane_id <= 0); // 判断移动方向
-  const double signed_distance = forward ? distance : -distance; // 根据方向设置带符号的距离
   const double relative_s = waypoint.s - lane.GetDistance(); // 计算相对s
   const double remaining_lane_length = forward ? lane.GetLength() - relative_s : relative_s; // 计算剩余车道长度
   DEBUG_ASSERT(remaining_lane_length >= 0.0); // 确保剩余长度非负
 
-  auto &road =_data.GetRoad(waypoint.road_id); // 获取对应的道路
-  std::vector<SignalSearchData> result; // 存储结果信号数据的向量
-
-  // 如果减去距离后仍在同一车道，则返回同一Waypoint和额外距离
-  if (distance <= remaining_lane_length) {
-    auto signals = road.GetInfosInRange<RoadInfoSignal>(
-        waypoint.s, waypoint.s + signed_distance); // 在指定范围内获取信号信息
-    for(auto* signal : signals){ // 遍历所有信号
-      double distance_to_signal = 0;
-      if (waypoint.lane_id < 0){ // 判断车道方向
-        distance_to_signal = signal->GetDistance() - waypoint.s; // 计算信号与Waypoint的距离
+  // 在车道的信号索引中二分查找本车道内的搜索范围，沿行驶方向依次添加
+  const double length_in_lane = std::min(distance, remaining_lane_length);
+  auto lane_signals = _lane_signals.find(LaneKey{waypoint.road_id, waypoint.section_id, waypoint.lane_id});
+  if (lane_signals != _lane_signals.end()) {
+    const auto &signals = lane_signals->second;
+    const double min_s = forward ? waypoint.s : waypoint.s - length_in_lane;
+    const double max_s = forward ? waypoint.s + length_in_lane : waypoint.s;
+    auto first = std::lower_bound(signals.begin(), signals.end(), min_s,
+        [](const RoadInfoSignal *signal, double s) { return signal->GetDistance() < s; });
+    auto last = std::upper_bound(first, signals.end(), max_s,
+        [](double s, const RoadInfoSignal *signal) { return s < signal->GetDistance(); });
+    auto add_signal = [&](const RoadInfoSignal *signal) {
+      const double distance_to_signal = forward ?
+          signal->GetDistance() - waypoint.s :
+          waypoint.s - signal->GetDistance(); // 计算信号与Waypoint的距离
+      if (distance_to_signal == 0) { // 如果信号与Waypoint的距离为0
+        result.emplace_back(SignalSearchData{signal, waypoint, accumulated_s});
       } else {
-        distance_to_signal = waypoint.s - signal->GetDistance(); // 计算信号与Waypoint的距离
-      }
-      // 检查信号是否影响Waypoint
-      bool is_valid = false; // 初始化有效性标志为false
-      for (auto &validity : signal->GetValidities()) { // 遍历信号的有效性范围
-        if (waypoint.lane_id >= validity._from_lane && // 检查Waypoint的lane_id是否在有效范围内
-            waypoint.lane_id <= validity._to_lane) {
-          is_valid = true; // 有效性标志设为true
-          break; // 结束循环
-        }
+        GetNext(waypoint, distance_to_signal, next_buffer); // 获取信号处的Waypoint
+        result.emplace_back(SignalSearchData{signal, next_buffer.front(), accumulated_s + distance_to_signal});
       }
- if(!is_valid){ // 如果信号不有效
-    continue; // 跳过当前循环，继续下一个信号
-}
-if (distance_to_signal == 0) { // 如果信号与Waypoint的距离为0
-    result.emplace_back(SignalSearchData // 添加信号数据到结果中
-        {signal, waypoint, // 将信号和Waypoint放入SignalSearchData结构中
-        distance_to_signal}); // 记录距离为0
-} else {
-    result.emplace_back(SignalSearchData // 添加信号数据到结果中
-        {signal, GetNext(waypoint, distance_to_signal).front(), // 获取下一个Waypoint并存储
-        distance_to_signal}); // 记录与信号的距离
-}
-
-}
-return result; // 返回结果
-
-const double signed_remaining_length = forward ? remaining_lane_length : -remaining_lane_length; // 根据方向设置带符号的剩余长度
-
-//result = road.GetInfosInRange<RoadInfoSignal>(waypoint.s, waypoint.s + signed_remaining_length); // 注释掉的代码：获取信号信息
-
-auto signals = road.GetInfosInRange<RoadInfoSignal>( // 在指定范围内获取信号信息
-    waypoint.s, waypoint.s + signed_remaining_length);
-for(auto* signal : signals){ // 遍历所有信号
-    double distance_to_signal = 0; // 初始化信号与Waypoint的距离
-    if (waypoint.lane_id < 0){ // 判断车道方向
-        distance_to_signal = signal->GetDistance() - waypoint.s; // 计算信号与Waypoint的距离
-    } else {
-        distance_to_signal = waypoint.s - signal->GetDistance(); // 计算信号与Waypoint的距离
-    }
-    // 检查信号是否影响Waypoint
-    bool is_valid = false; // 初始化有效性标志为false
-    for (auto &validity : signal->GetValidities()) { // 遍历信号的有效性范围
-        if (waypoint.lane_id >= validity._from_lane && // 检查Waypoint的lane_id是否在有效范围内
-            waypoint.lane_id <= validity._to_lane) {
-            is_valid = true; // 有效性标志设为true
-            break; // 结束循环
-        }
-    }
-    if(!is_valid){ // 如果信号无效
-        continue; // 跳过当前信号
-    }
-    if (distance_to_signal == 0) { // 如果信号与Waypoint的距离为0
-        result.emplace_back(SignalSearchData // 添加信号数据到结果中
-            {signal, waypoint, // 将信号和Waypoint放入SignalSearchData结构中
-            distance_to_signal}); // 记录距离为0
+    };
+    if (forward) {
+      std::for_each(first, last, add_signal);
     } else {
-        result.emplace_back(SignalSearchData // 添加信号数据到结果中
-            {signal, GetNext(waypoint, distance_to_signal).front(), // 获取下一个Waypoint并存储
-            distance_to_signal}); // 记录与信号的距离
+      std::for_each(std::make_reverse_iterator(last), std::make_reverse_iterator(first), add_signal);
     }
-}
+  }
+
+  // 如果距离在同一车道内结束，则不需要查看后继
+  if (distance <= remaining_lane_length) {
+    return;
+  }
 
-// 如果剩余车道长度用尽，必须查看后继
-for (auto &successor : GetSuccessors(waypoint)) { // 遍历Waypoint的后继节点
-    if(_data.GetRoad(successor.road_id).IsJunction() && stop_at_junction){ // 如果后继是交叉口并且需要停止
-        continue; // 跳过此后继
+  // 如果剩余车道长度用尽，必须查看后继
+  auto visit = [&](Waypoint successor) {
+    if (_data.GetRoad(successor.road_id).IsJunction() && stop_at_junction) { // 如果后继是交叉口并且需要停止
+      return; // 跳过此后继
     }
-    auto& sucessor_lane = _data.GetRoad(successor.road_id). // 获取后继车道
+    auto &sucessor_lane = _data.GetRoad(successor.road_id). // 获取后继车道
         GetLaneByDistance(successor.s, successor.lane_id);
     if (successor.lane_id < 0) { // 如果后继车道ID为负
-        successor.s = sucessor_lane.GetDistance(); // 设置后继s为车道的起始距离
+      successor.s = sucessor_lane.GetDistance(); // 设置后继s为车道的起始距离
     } else {
-        successor.s = sucessor_lane.GetDistance() + sucessor_lane.GetLength(); // 设置后继s为车道的结束距离
-    }
-    auto sucessor_signals = GetSignalsInDistance( // 获取后继信号在指定距离内的信号
-        successor, distance - remaining_lane_length, stop_at_junction);
-    for(auto& signal : sucessor_signals){ // 遍历后继信号
-        signal.accumulated_s += remaining_lane_length; // 更新累积的s值
+      successor.s = sucessor_lane.GetDistance() + sucessor_lane.GetLength(); // 设置后继s为车道的结束距离
+    }
+    AppendSignalsInDistance(
+        successor,
+        distance - remaining_lane_length,
+        stop_at_junction,
+        accumulated_s + remaining_lane_length,
+        result,
+        next_buffer);
+  };
+  if (links != nullptr) {
+    for (const auto &successor : links->successors) { // 遍历Waypoint的后继节点
+      visit(successor);
+    }
+  } else {
+    for (const auto &successor : GetSuccessors(waypoint)) {
+      visit(successor);
     }
-    result = ConcatVectors(result, sucessor_signals); // 合并结果信号和后继信号
-}
-return result; // 返回结果
+  }
 }
 
 std::vector<const element::RoadInfoSignal*> // 获取所有信号引用
@@ -518,7 +555,32 @@ std::vector<geom::Location> Map::GetAllCrosswalkZones() const {
 // -- Map: 航点生成 ---------------------------------------------------------
 // ===========================================================================
 
+// 车道 @a lanes 中每条车道的路点，连接关系不完整时返回空
+template <typename DistanceFuncT>
+static boost::optional<std::vector<Waypoint>> LanesToWaypoints(
+    const std::vector<Lane *> &lanes,
+    DistanceFuncT &&get_distance) {
+    std::vector<Waypoint> result; // 存储结果
+    result.reserve(lanes.size()); // 预留空间
+    for (auto *lane : lanes) {
+        if (lane == nullptr || lane->GetId() == 0 ||
+            lane->GetLaneSection() == nullptr || lane->GetRoad() == nullptr) {
+            return boost::none;
+        }
+        result.emplace_back(Waypoint{
+            lane->GetRoad()->GetId(),
+            lane->GetLaneSection()->GetId(),
+            lane->GetId(),
+            get_distance(*lane)});
+    }
+    return result;
+}
+
 std::vector<Waypoint> Map::GetSuccessors(const Waypoint waypoint) const {
+    const auto *links = FindLaneLinks(waypoint); // 先查车道连接表
+    if (links != nullptr) {
+        return links->successors;
+    }
     const auto &next_lanes = GetLane(waypoint).GetNextLanes(); // 获取下一个车道
     std::vector<Waypoint> result; // 存储结果
     result.reserve(next_lanes.size()); // 预留空间
@@ -537,6 +599,10 @@ std::vector<Waypoint> Map::GetSuccessors(const Waypoint waypoint) const {
 }
 
 std::vector<Waypoint> Map::GetPredecessors(const Waypoint waypoint) const {
+    const auto *links = FindLaneLinks(waypoint); // 先查车道连接表
+    if (links != nullptr) {
+        return links->predecessors;
+    }
     const auto &prev_lanes = GetLane(waypoint).GetPreviousLanes(); // 获取前一个车道
     std::vector<Waypoint> result; // 存储结果
     result.reserve(prev_lanes.size()); // 预留空间
@@ -557,11 +623,46 @@ std::vector<Waypoint> Map::GetPredecessors(const Waypoint waypoint) const {
 std::vector<Waypoint> Map::GetNext(
       const Waypoint waypoint,
       const double distance) const {
+    std::vector<Waypoint> result;
+    GetNext(waypoint, distance, result);
+    return result;
+  }
+
+  void Map::GetNext(
+      const Waypoint waypoint,
+      const double distance,
+      std::vector<Waypoint> &result) const {
+    result.clear();
+    AppendNext(waypoint, distance, result);
+  }
+
+  std::vector<Waypoint> Map::GetPrevious(
+      const Waypoint waypoint,
+      const double distance) const {
+    std::vector<Waypoint> result;
+    GetPrevious(waypoint, distance, result);
+    return result;
+  }
+
+  void Map::GetPrevious(
+      const Waypoint waypoint,
+      const double distance,
+      std::vector<Waypoint> &result) const {
+    result.clear();
+    AppendPrevious(waypoint, distance, result);
+  }
+
+  void Map::AppendNext(
+      const Waypoint waypoint,
+      const double distance,
+      std::vector<Waypoint> &result) const {
     RELEASE_ASSERT(distance > 0.0); // 确保距离大于0
     if (distance <= EPSILON) { // 如果距离很小（近似为0）
-      return {waypoint}; // 返回当前的waypoint
+      result.emplace_back(waypoint); // 返回当前的waypoint
+      return;
     }
-    const auto &lane = GetLane(waypoint); // 获取当前waypoint所在的车道
+    const auto *links = FindLaneLinks(waypoint);
+    const auto &lane = links != nullptr ? *links->lane : GetLane(waypoint); // 获取当前waypoint所在的车道
     const bool forward = (waypoint.lane_id <= 0); // 判断移动方向（正向或反向）
     const double signed_distance = forward ? distance : -distance; // 根据方向确定带符号的距离
     const double relative_s = waypoint.s - lane.GetDistance(); // 计算相对位置s
@@ -570,33 +671,44 @@ std::vector<Waypoint> Map::GetNext(
 
     // 如果在同一车道内，返回增加了距离的waypoint
     if (distance <= remaining_lane_length) {
-      Waypoint result = waypoint; // 创建结果waypoint
-      result.s += signed_distance; // 更新s值
-      result.s += forward ? -EPSILON : EPSILON; // 调整s值以避免浮点数精度问题
-      RELEASE_ASSERT(result.s > 0.0); // 确保s值大于0
-      return { result }; // 返回结果
+      Waypoint next = waypoint; // 创建结果waypoint
+      next.s += signed_distance; // 更新s值
+      next.s += forward ? -EPSILON : EPSILON; // 调整s值以避免浮点数精度问题
+      RELEASE_ASSERT(next.s > 0.0); // 确保s值大于0
+      result.emplace_back(next); // 返回结果
+      return;
     }
 
     // 如果没有剩余车道长度，则需要转到后继节点
-    std::vector<Waypoint> result; // 存储结果的vector
-    for (const auto &successor : GetSuccessors(waypoint)) { // 遍历所有后继waypoints
+    auto visit = [&](const Waypoint &successor) {
       DEBUG_ASSERT(
           successor.road_id != waypoint.road_id || // 确保不在同一路段
           successor.section_id != waypoint.section_id || // 确保不在同一部分
           successor.lane_id != waypoint.lane_id); // 确保不在同一车道
-      result = ConcatVectors(result, GetNext(successor, distance - remaining_lane_length)); // 递归获取下一个waypoint
+      AppendNext(successor, distance - remaining_lane_length, result); // 递归获取下一个waypoint
+    };
+    if (links != nullptr) {
+      for (const auto &successor : links->successors) { // 遍历所有后继waypoints
+        visit(successor);
+      }
+    } else {
+      for (const auto &successor : GetSuccessors(waypoint)) {
+        visit(successor);
+      }
     }
-    return result; // 返回所有找到的waypoints
   }
 
-  std::vector<Waypoint> Map::GetPrevious(
+  void Map::AppendPrevious(
       const Waypoint waypoint,
-      const double distance) const {
+      const double distance,
+      std::vector<Waypoint> &result) const {
     RELEASE_ASSERT(distance > 0.0); // 确保距离大于0
     if (distance <= EPSILON) { // 如果距离很小（近似为0）
-      return {waypoint}; // 返回当前的waypoint
+      result.emplace_back(waypoint); // 返回当前的waypoint
+      return;
     }
-    const auto &lane = GetLane(waypoint); // 获取当前waypoint所在的车道
+    const auto *links = FindLaneLinks(waypoint);
+    const auto &lane = links != nullptr ? *links->lane : GetLane(waypoint); // 获取当前waypoint所在的车道
     const bool forward = !(waypoint.lane_id <= 0); // 判断移动方向（正向或反向）
     const double signed_distance = forward ? distance : -distance; // 根据方向确定带符号的距离
     const double relative_s = waypoint.s - lane.GetDistance(); // 计算相对位置s
@@ -605,23 +717,31 @@ std::vector<Waypoint> Map::GetNext(
 
     // 如果在同一车道内，返回增加了距离的waypoint
     if (distance <= remaining_lane_length) {
-      Waypoint result = waypoint; // 创建结果waypoint
-      result.s += signed_distance; // 更新s值
-      result.s += forward ? -EPSILON : EPSILON; // 调整s值以避免浮点数精度问题
-      RELEASE_ASSERT(result.s > 0.0); // 确保s值大于0
-      return { result }; // 返回结果
+      Waypoint previous = waypoint; // 创建结果waypoint
+      previous.s += signed_distance; // 更新s值
+      previous.s += forward ? -EPSILON : EPSILON; // 调整s值以避免浮点数精度问题
+      RELEASE_ASSERT(previous.s > 0.0); // 确保s值大于0
+      result.emplace_back(previous); // 返回结果
+      return;
     }
 
     // 如果没有剩余车道长度，则需要转到前驱节点
-    std::vector<Waypoint> result; // 存储结果的vector
-    for (const auto &successor : GetPredecessors(waypoint)) { // 遍历所有前驱waypoints
+    auto visit = [&](const Waypoint &predecessor) {
       DEBUG_ASSERT(
-          successor.road_id != waypoint.road_id || // 确保不在同一路段
-          successor.section_id != waypoint.section_id || // 确保不在同一部分
-          successor.lane_id != waypoint.lane_id); // 确保不在同一车道
-      result = ConcatVectors(result, GetPrevious(successor, distance - remaining_lane_length)); // 递归获取前一个waypoint
+          predecessor.road_id != waypoint.road_id || // 确保不在同一路段
+          predecessor.section_id != waypoint.section_id || // 确保不在同一部分
+          predecessor.lane_id != waypoint.lane_id); // 确保不在同一车道
+      AppendPrevious(predecessor, distance - remaining_lane_length, result); // 递归获取前一个waypoint
+    };
+    if (links != nullptr) {
+      for (const auto &predecessor : links->predecessors) { // 遍历所有前驱waypoints
+        visit(predecessor);
+      }
+    } else {
+      for (const auto &predecessor : GetPredecessors(waypoint)) {
+        visit(predecessor);
+      }
     }
-    return result; // 返回所有找到的waypoints
   }
 
   boost::optional<Waypoint> Map::GetRight(Waypoint waypoint) const {
@@ -834,6 +954,11 @@ const Lane &Map::GetLane(Waypoint waypoint) const {
     return _data.GetRoad(waypoint.road_id).GetLaneById(waypoint.section_id, waypoint.lane_id);
 }
 
+const Map::LaneLinks *Map::FindLaneLinks(Waypoint waypoint) const {
+    auto it = _lane_links.find(LaneKey{waypoint.road_id, waypoint.section_id, waypoint.lane_id});
+    return it != _lane_links.end() ? &it->second : nullptr;
+}
+
 // ===========================================================================
 // -- Map: Private functions -------------------------------------------------
 // ===========================================================================
@@ -889,6 +1014,67 @@ double GetRemainingLength(const Lane &lane, double current_s) {
     }
 }
 
+// 创建车道连接表，连接关系不完整的车道不放入表中，查询时仍按原来的方式处理
+void Map::CreateLaneLinks() {
+    for (const auto &pair : _data.GetRoads()) {
+        const auto &road = pair.second;
+        for (const auto &section : road.GetLaneSections()) {
+            for (const auto &lane_pair : section.GetLanes()) {
+                const auto &lane = lane_pair.second;
+                if (lane.GetId() == 0) {
+                    continue;
+                }
+                auto successors = LanesToWaypoints(lane.GetNextLanes(), GetDistanceAtStartOfLane);
+                auto predecessors = LanesToWaypoints(lane.GetPreviousLanes(), GetDistanceAtEndOfLane);
+                if (!successors.has_value() || !predecessors.has_value()) {
+                    continue;
+                }
+                LaneLinks links;
+                links.lane = &lane;
+                links.successors = std::move(*successors);
+                links.predecessors = std::move(*predecessors);
+                _lane_links.emplace(LaneKey{road.GetId(), section.GetId(), lane.GetId()}, std::move(links));
+            }
+        }
+    }
+}
+
+// 创建车道信号索引，每条车道保存车道段范围内对其有效的信号
+void Map::CreateLaneSignals() {
+    for (const auto &pair : _data.GetRoads()) {
+        const auto &road = pair.second;
+        const auto signals = road.GetInfos<RoadInfoSignal>(); // 按s递增排列
+        if (signals.empty()) {
+            continue;
+        }
+        for (const auto &section : road.GetLaneSections()) {
+            const double section_start = section.GetDistance();
+            const double section_end = section_start + section.GetLength();
+            for (const auto &lane_pair : section.GetLanes()) {
+                const LaneId lane_id = lane_pair.first;
+                if (lane_id == 0) {
+                    continue;
+                }
+                std::vector<const RoadInfoSignal *> lane_signals;
+                for (const auto *signal : signals) {
+                    if (signal->GetDistance() < section_start || signal->GetDistance() > section_end) {
+                        continue;
+                    }
+                    for (const auto &validity : signal->GetValidities()) { // 检查信号是否影响该车道
+                        if (lane_id >= validity._from_lane && lane_id <= validity._to_lane) {
+                            lane_signals.push_back(signal);
+                            break;
+                        }
+                    }
+                }
+                if (!lane_signals.empty()) {
+                    _lane_signals.emplace(LaneKey{road.GetId(), section.GetId(), lane_id}, std::move(lane_signals));
+                }
+            }
+        }
+    }
+}
+
 // 创建R树
 void Map::CreateRtree() {
     const double epsilon = 0.000001; // 设置一个小的增量以防止数值误差
@@ -910,95 +1096,108 @@ void Map::CreateRtree() {
             }
         });
     }
-}
 
-// 段和路点的容器
-std::vector<Rtree::TreeElement> rtree_elements;
+    // 各条车道的线段互不依赖，分块在多个线程中生成，每条车道写入各自的容器
+    std::vector<std::vector<Rtree::TreeElement>> lane_elements(topology.size());
+    ParallelForChunks(topology.size(), [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            // 段和路点的容器
+            std::vector<Rtree::TreeElement> &rtree_elements = lane_elements[i];
+            auto &lane_start_waypoint = topology[i]; // 车道起始路点
 
-// 遍历所有车道
-for (auto &waypoint : topology) {
-    auto &lane_start_waypoint = waypoint; // 车道起始路点
+            auto current_waypoint = lane_start_waypoint; // 当前路点
 
-    auto current_waypoint = lane_start_waypoint; // 当前路点
+            const Lane &lane = GetLane(current_waypoint); // 获取当前路点所在的车道
 
-    const Lane &lane = GetLane(current_waypoint); // 获取当前路点所在的车道
+            geom::Transform current_transform = ComputeTransform(current_waypoint); // 计算当前路点的变换
 
-    geom::Transform current_transform = ComputeTransform(current_waypoint); // 计算当前路点的变换
+            // 在直线段中节省计算时间
+            if (lane.IsStraight()) { // 如果车道是直的
+                double delta_s = min_delta_s; // 初始化增量距离
+                double remaining_length = GetRemainingLength(lane, current_waypoint.s); // 获取剩余长度
+                remaining_length -= epsilon; // 减去一个小值以避免数值问题
+                delta_s = remaining_length; // 更新增量距离
+                if (delta_s < epsilon) { // 如果增量距离小于阈值
+                    continue; // 跳过此轮
+                }
+                auto next = GetNext(current_waypoint, delta_s); // 获取下一个路点
 
-    // 在直线段中节省计算时间
-    if (lane.IsStraight()) { // 如果车道是直的
-        double delta_s = min_delta_s; // 初始化增量距离
-        double remaining_length = GetRemainingLength(lane, current_waypoint.s); // 获取剩余长度
-        remaining_length -= epsilon; // 减去一个小值以避免数值问题
-        delta_s = remaining_length; // 更新增量距离
-        if (delta_s < epsilon) { // 如果增量距离小于阈值
-            continue; // 跳过此轮
-        }
-        auto next = GetNext(current_waypoint, delta_s); // 获取下一个路点
-
-        RELEASE_ASSERT(next.size() == 1); // 确保下一个路点只有一个
-        RELEASE_ASSERT(next.front().road_id == current_waypoint.road_id); // 确保下一个路点在同一路段
-        auto next_waypoint = next.front(); // 下一个路点
-
-        AddElementToRtreeAndUpdateTransforms( // 添加元素到R树并更新变换
-            rtree_elements,
-            current_transform,
-            current_waypoint,
-            next_waypoint);
-        // 到达车道末尾
-    } else {
-        auto next_waypoint = current_waypoint; // 初始化下一个路点
-
-        // 循环直到车道末尾
-        // 按小的s增量前进
-        while (true) {
-            double delta_s = min_delta_s; // 初始化增量距离
-            double remaining_length = GetRemainingLength(lane, next_waypoint.s); // 获取剩余长度
-            remaining_length -= epsilon; // 减去一个小值以避免数值问题
-            delta_s = std::min(delta_s, remaining_length); // 更新增量距离
-
-            if (delta_s < epsilon) { // 如果增量距离小于阈值
-                AddElementToRtreeAndUpdateTransforms( // 添加当前路点和下一个路点到R树
-                    rtree_elements,
-                    current_transform,
-                    current_waypoint,
-                    next_waypoint);
-                break; // 退出循环
-            }
+                RELEASE_ASSERT(next.size() == 1); // 确保下一个路点只有一个
+                RELEASE_ASSERT(next.front().road_id == current_waypoint.road_id); // 确保下一个路点在同一路段
+                auto next_waypoint = next.front(); // 下一个路点
 
-            auto next = GetNext(next_waypoint, delta_s); // 获取下一个路点
-            if (next.size() != 1 || // 如果下一个路点不止一个或在不同的区段
-                current_waypoint.section_id != next.front().section_id) {
-                AddElementToRtreeAndUpdateTransforms( // 添加当前和下一个路点到R树
+                AddElementToRtreeAndUpdateTransforms( // 添加元素到R树并更新变换
                     rtree_elements,
                     current_transform,
                     current_waypoint,
                     next_waypoint);
-                break; // 退出循环
-            }
+                // 到达车道末尾
+            } else {
+                auto next_waypoint = current_waypoint; // 初始化下一个路点
+
+                // 循环直到车道末尾
+                // 按小的s增量前进
+                while (true) {
+                    double delta_s = min_delta_s; // 初始化增量距离
+                    double remaining_length = GetRemainingLength(lane, next_waypoint.s); // 获取剩余长度
+                    remaining_length -= epsilon; // 减去一个小值以避免数值问题
+                    delta_s = std::min(delta_s, remaining_length); // 更新增量距离
+
+                    if (delta_s < epsilon) { // 如果增量距离小于阈值
+                        AddElementToRtreeAndUpdateTransforms( // 添加当前路点和下一个路点到R树
+                            rtree_elements,
+                            current_transform,
+                            current_waypoint,
+                            next_waypoint);
+                        break; // 退出循环
+                    }
 
-            next_waypoint = next.front(); // 更新下一个路点
-            geom::Transform next_transform = ComputeTransform(next_waypoint); // 计算下一个路点的变换
-            double angle = geom::Math::GetVectorAngle( // 获取当前和下一个路点的角度
-                current_transform.GetForwardVector(), next_transform.GetForwardVector());
+                    auto next = GetNext(next_waypoint, delta_s); // 获取下一个路点
+                    if (next.size() != 1 || // 如果下一个路点不止一个或在不同的区段
+                        current_waypoint.section_id != next.front().section_id) {
+                        AddElementToRtreeAndUpdateTransforms( // 添加当前和下一个路点到R树
+                            rtree_elements,
+                            current_transform,
+                            current_waypoint,
+                            next_waypoint);
+                        break; // 退出循环
+                    }
 
-            if (std::abs(angle) > angle_threshold || // 如果角度超过阈值
-                std::abs(current_waypoint.s - next_waypoint.s) > max_segment_length) { // 或者距离超过最大段长度
-                AddElementToRtree( // 将当前和下一个路点的变换添加到R树
-                    rtree_elements,
-                    current_transform,
-                    next_transform,
-                    current_waypoint,
-                    next_waypoint);
-                current_waypoint = next_waypoint; // 更新当前路点
-                current_transform = next_transform; // 更新当前变换
+                    next_waypoint = next.front(); // 更新下一个路点
+                    geom::Transform next_transform = ComputeTransform(next_waypoint); // 计算下一个路点的变换
+                    double angle = geom::Math::GetVectorAngle( // 获取当前和下一个路点的角度
+                        current_transform.GetForwardVector(), next_transform.GetForwardVector());
+
+                    if (std::abs(angle) > angle_threshold || // 如果角度超过阈值
+                        std::abs(current_waypoint.s - next_waypoint.s) > max_segment_length) { // 或者距离超过最大段长度
+                        AddElementToRtree( // 将当前和下一个路点的变换添加到R树
+                            rtree_elements,
+                            current_transform,
+                            next_transform,
+                            current_waypoint,
+                            next_waypoint);
+                        current_waypoint = next_waypoint; // 更新当前路点
+                        current_transform = next_transform; // 更新当前变换
+                    }
+                }
             }
         }
+    });
+
+    // 按原来的顺序合并，保证R树的内容与单线程构建时相同
+    size_t total_size = 0u;
+    for (const auto &elements : lane_elements) {
+        total_size += elements.size();
+    }
+    std::vector<Rtree::TreeElement> rtree_elements;
+    rtree_elements.reserve(total_size);
+    for (auto &elements : lane_elements) {
+        std::move(elements.begin(), elements.end(), std::back_inserter(rtree_elements));
     }
-}
 
-// 将段添加到R树
-_rtree.InsertElements(rtree_elements);
+    // 将段添加到R树
+    _rtree.InsertElements(rtree_elements);
+}
 
 Junction* Map::GetJunction(JuncId id) { // 获取交叉口
     return _data.GetJunction(id); // 返回指定ID的交叉口
@@ -1064,62 +1263,94 @@ geom::Mesh Map::GenerateMesh(
   }
 
 
+// 把 @a src 中各车道类型的网格按顺序移动到 @a dst 对应列表的末尾
+static void AppendOrderedMeshes(
+    std::map<road::Lane::LaneType, std::vector<std::unique_ptr<geom::Mesh>>> &dst,
+    std::map<road::Lane::LaneType, std::vector<std::unique_ptr<geom::Mesh>>> &src) {
+    for (auto &&pair : src) {
+      auto &list = dst[pair.first];
+      list.insert(list.end(),
+          std::make_move_iterator(pair.second.begin()),
+          std::make_move_iterator(pair.second.end()));
+    }
+    src.clear();
+}
+
 std::vector<std::unique_ptr<geom::Mesh>> Map::GenerateChunkedMesh(
       const rpc::OpendriveGenerationParameters& params) const {
     geom::MeshFactory mesh_factory(params); // 创建一个网格工厂，用于生成网格
     std::vector<std::unique_ptr<geom::Mesh>> out_mesh_list; // 定义输出网格列表
 
-    std::unordered_map<JuncId, geom::Mesh> junction_map; // 定义用于存储交叉口网格的哈希映射
+    // 每条道路和每个交叉口的网格互不依赖，在多个线程中分别生成，
+    // 最后按固定的顺序合并，结果与线程数无关
+    std::vector<const Road *> roads; // 非交叉口道路
     for (auto &&pair : _data.GetRoads()) { // 遍历所有道路
-      const auto &road = pair.second; // 获取当前道路
-      if (!road.IsJunction()) { // 如果该道路不是交叉口
-        std::vector<std::unique_ptr<geom::Mesh>> road_mesh_list =
-            mesh_factory.GenerateAllWithMaxLen(road); // 生成道路的所有网格
-
-        // 将生成的道路网格添加到输出网格列表中
-        out_mesh_list.insert(
-            out_mesh_list.end(),
-            std::make_move_iterator(road_mesh_list.begin()),
-            std::make_move_iterator(road_mesh_list.end()));
+      if (!pair.second.IsJunction()) { // 如果该道路不是交叉口
+        roads.push_back(&pair.second);
       }
     }
+    std::vector<std::vector<std::unique_ptr<geom::Mesh>>> road_meshes(roads.size());
+    ParallelForChunks(roads.size(), [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i) {
+        road_meshes[i] = mesh_factory.GenerateAllWithMaxLen(*roads[i]); // 生成道路的所有网格
+      }
+    }, 4u);
+    for (auto &road_mesh_list : road_meshes) {
+      // 将生成的道路网格添加到输出网格列表中
+      out_mesh_list.insert(
+          out_mesh_list.end(),
+          std::make_move_iterator(road_mesh_list.begin()),
+          std::make_move_iterator(road_mesh_list.end()));
+    }
 
     // 生成交叉口内的道路并进行光滑处理
+    std::vector<const Junction *> junctions;
     for (const auto &junc_pair : _data.GetJunctions()) { // 遍历所有交叉口
-      const auto &junction = junc_pair.second; // 获取当前交叉口
-      std::vector<std::unique_ptr<geom::Mesh>> lane_meshes; // 存储车道网格
-      std::vector<std::unique_ptr<geom::Mesh>> sidewalk_lane_meshes; // 存储人行道网格
-      for(const auto &connection_pair : junction.GetConnections()) { // 遍历交叉口的连接
-        const auto &connection = connection_pair.second; // 获取连接信息
-        const auto &road = _data.GetRoads().at(connection.connecting_road); // 获取连接的道路
-        for (auto &&lane_section : road.GetLaneSections()) { // 遍历道路的车道段
-          for (auto &&lane_pair : lane_section.GetLanes()) { // 遍历车道
-            const auto &lane = lane_pair.second; // 获取当前车道
-            if (lane.GetType() != road::Lane::LaneType::Sidewalk) { // 如果车道不是人行道
-              lane_meshes.push_back(mesh_factory.Generate(lane)); // 生成车道网格并添加
-            } else {
-              sidewalk_lane_meshes.push_back(mesh_factory.Generate(lane)); // 生成人行道网格并添加
+      junctions.push_back(&junc_pair.second);
+    }
+    std::vector<std::unique_ptr<geom::Mesh>> junction_meshes(junctions.size());
+    ParallelForChunks(junctions.size(), [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i) {
+        const auto &junction = *junctions[i]; // 获取当前交叉口
+        std::vector<std::unique_ptr<geom::Mesh>> lane_meshes; // 存储车道网格
+        std::vector<std::unique_ptr<geom::Mesh>> sidewalk_lane_meshes; // 存储人行道网格
+        for(const auto &connection_pair : junction.GetConnections()) { // 遍历交叉口的连接
+          const auto &connection = connection_pair.second; // 获取连接信息
+          const auto &road = _data.GetRoads().at(connection.connecting_road); // 获取连接的道路
+          for (auto &&lane_section : road.GetLaneSections()) { // 遍历道路的车道段
+            for (auto &&lane_pair : lane_section.GetLanes()) { // 遍历车道
+              const auto &lane = lane_pair.second; // 获取当前车道
+              if (lane.GetType() != road::Lane::LaneType::Sidewalk) { // 如果车道不是人行道
+                lane_meshes.push_back(mesh_factory.Generate(lane)); // 生成车道网格并添加
+              } else {
+                sidewalk_lane_meshes.push_back(mesh_factory.Generate(lane)); // 生成人行道网格并添加
+              }
             }
           }
         }
-      }
-      if(params.smooth_junctions) { // 如果需要光滑处理交叉口
-        auto merged_mesh = mesh_factory.MergeAndSmooth(lane_meshes); // 合并并光滑车道网格
-        for(auto& lane : sidewalk_lane_meshes) { // 遍历人行道网格
-          *merged_mesh += *lane; // 将人行道网格添加到合并网格中
-        }
-        out_mesh_list.push_back(std::move(merged_mesh)); // 将合并后的网格添加到输出列表
-      } else {
-        std::unique_ptr<geom::Mesh> junction_mesh = std::make_unique<geom::Mesh>(); // 创建新的交叉口网格
-        for(auto& lane : lane_meshes) { // 遍历车道网格
-          *junction_mesh += *lane; // 将车道网格添加到交叉口网格中
-        }
-        for(auto& lane : sidewalk_lane_meshes) { // 遍历人行道网格
-          *junction_mesh += *lane; // 将人行道网格添加到交叉口网格中
+        if(params.smooth_junctions) { // 如果需要光滑处理交叉口
+          auto merged_mesh = mesh_factory.MergeAndSmooth(lane_meshes); // 合并并光滑车道网格
+          for(auto& lane : sidewalk_lane_meshes) { // 遍历人行道网格
+            *merged_mesh += *lane; // 将人行道网格添加到合并网格中
+          }
+          junction_meshes[i] = std::move(merged_mesh);
+        } else {
+          std::unique_ptr<geom::Mesh> junction_mesh = std::make_unique<geom::Mesh>(); // 创建新的交叉口网格
+          for(auto& lane : lane_meshes) { // 遍历车道网格
+            *junction_mesh += *lane; // 将车道网格添加到交叉口网格中
+          }
+          for(auto& lane : sidewalk_lane_meshes) { // 遍历人行道网格
+            *junction_mesh += *lane; // 将人行道网格添加到交叉口网格中
+          }
+          junction_meshes[i] = std::move(junction_mesh);
         }
-        out_mesh_list.push_back(std::move(junction_mesh)); // 将交叉口网格添加到输出列表
       }
-    }
+    }, 1u);
+    // 将交叉口网格添加到输出列表
+    out_mesh_list.insert(
+        out_mesh_list.end(),
+        std::make_move_iterator(junction_meshes.begin()),
+        std::make_move_iterator(junction_meshes.end()));
 
     // 找到输出网格的最小和最大位置
     auto min_pos = geom::Vector2D(
@@ -1147,6 +1378,13 @@ std::vector<std::unique_ptr<geom::Mesh>> Map::GenerateChunkedMesh(
       *(result[x_pos + mesh_amount_x*y_pos]) += *mesh; // 将当前网格添加到对应的结果网格中
     }
 
+    // 合并三角形带中重复的顶点并按顶点缓存重新排序，减少上传到UE的数据量
+    ParallelForChunks(result.size(), [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i) {
+        result[i]->Optimize();
+      }
+    }, 1u);
+
     return result; // 返回生成的结果网格列表
   }
 
@@ -1159,67 +1397,28 @@ Map::GenerateOrderedChunkedMeshInLocations(const rpc::OpendriveGenerationParamet
     std::map<road::Lane::LaneType, std::vector<std::unique_ptr<geom::Mesh>>> road_out_mesh_list; // 存储道路类型对应的网格列表
     std::map<road::Lane::LaneType, std::vector<std::unique_ptr<geom::Mesh>>> junction_out_mesh_list; // 存储交叉口类型对应的网格列表
 
-    // 创建一个线程来生成交叉口的网格
-    std::thread junction_thread(&Map::GenerateJunctions, this, mesh_factory, params,
-                                 minpos, maxpos, &junction_out_mesh_list);
-
     // 根据位置过滤需要生成的道路ID
     const std::vector<RoadId> RoadsIDToGenerate = FilterRoadsByPosition(minpos, maxpos);
 
     size_t num_roads = RoadsIDToGenerate.size(); // 获取需要生成的道路数量
-    size_t num_roads_per_thread = 30; // 每个线程处理的道路数量
-    size_t num_threads = (num_roads / num_roads_per_thread) + 1; // 计算所需线程数
-    num_threads = num_threads > 1 ? num_threads : 1; // 确保至少有一个线程
-    std::vector<std::thread> workers; // 存储工作线程
-    std::mutex write_mutex; // 互斥量，用于保护写操作
     std::cout << "Generating " << std::to_string(num_roads) << " roads" << std::endl; // 输出生成道路数量
 
-    for (size_t i = 0; i < num_threads; ++i) { // 为每个线程创建工作任务
-        std::thread new_worker(
-            [this, &write_mutex, &mesh_factory, &RoadsIDToGenerate, &road_out_mesh_list, i, num_roads_per_thread]() {
-                // 生成当前线程的道路网格
-                std::map<road::Lane::LaneType, std::vector<std::unique_ptr<geom::Mesh>>> Current =
-                    std::move(GenerateRoadsMultithreaded(mesh_factory, RoadsIDToGenerate, i, num_roads_per_thread));
-                
-                std::lock_guard<std::mutex> guard(write_mutex); // 锁住互斥量以进行安全写入
-                
-                for (auto&& pair : Current) { // 遍历当前线程生成的网格
-                    if (road_out_mesh_list.find(pair.first) != road_out_mesh_list.end()) { // 检查类型是否已存在
-                        // 如果已存在，合并网格
-                        road_out_mesh_list[pair.first].insert(road_out_mesh_list[pair.first].end(),
-                                                              std::make_move_iterator(pair.second.begin()),
-                                                              std::make_move_iterator(pair.second.end()));
-                    } else {
-                        // 如果不存在，直接添加
-                        road_out_mesh_list[pair.first] = std::move(pair.second);
-                    }
-                }
-            });
-        workers.push_back(std::move(new_worker)); // 将新线程添加到工作线程列表中
-    }
-
-    for (size_t i = 0; i < workers.size(); ++i) { // 等待所有工作线程完成
-        workers[i].join(); // 加入线程
-    }
-    workers.clear(); // 清空工作线程列表
-    for (size_t i = 0; i < workers.size(); ++i) { // 再次检查线程并确保它们已加入
-        if (workers[i].joinable()) {
-            workers[i].join(); // 如果可加入则加入
+    // 每条道路写入各自的结果，全部完成后按道路顺序合并，结果与线程数无关
+    std::vector<std::map<road::Lane::LaneType, std::vector<std::unique_ptr<geom::Mesh>>>> road_meshes(num_roads);
+    ParallelForChunks(num_roads, [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i) {
+        const auto& road = _data.GetRoads().at(RoadsIDToGenerate[i]); // 获取当前道路对象
+        if (!road.IsJunction()) { // 如果当前道路不是交叉口
+          mesh_factory.GenerateAllOrderedWithMaxLen(road, road_meshes[i]); // 生成该道路的所有网格
         }
+      }
+    }, 4u);
+    for (auto &meshes : road_meshes) {
+      AppendOrderedMeshes(road_out_mesh_list, meshes);
     }
 
-    junction_thread.join(); // 等待交叉口生成线程完成
-    for (auto&& pair : junction_out_mesh_list) { // 遍历交叉口生成的网格
-        if (road_out_mesh_list.find(pair.first) != road_out_mesh_list.end()) { // 检查类型是否已存在
-            // 如果已存在，合并交叉口网格
-            road_out_mesh_list[pair.first].insert(road_out_mesh_list[pair.first].end(),
-                                                  std::make_move_iterator(pair.second.begin()),
-                                                  std::make_move_iterator(pair.second.end()));
-        } else {
-            // 如果不存在，直接添加
-            road_out_mesh_list[pair.first] = std::move(pair.second);
-        }
-    }
+    GenerateJunctions(mesh_factory, params, minpos, maxpos, &junction_out_mesh_list); // 生成交叉口的网格
+    AppendOrderedMeshes(road_out_mesh_list, junction_out_mesh_list);
     std::cout << "Generated " << std::to_string(num_roads) << " roads" << std::endl; // 输出生成完成的信息
 
     return road_out_mesh_list; // 返回生成的道路网格列表
@@ -1325,11 +1524,24 @@ std::vector<std::unique_ptr<geom::Mesh>> Map::GenerateLineMarkings(
 
     // 根据位置筛选要生成的道路ID
     const std::vector<RoadId> RoadsIDToGenerate = FilterRoadsByPosition(minpos, maxpos);
-    for ( RoadId id : RoadsIDToGenerate ) { // 遍历每条道路ID
-        const auto& road = _data.GetRoads().at(id); // 获取道路对象
-        if (!road.IsJunction()) { // 如果不是交叉口
-            mesh_factory.GenerateLaneMarkForRoad(road, LineMarks, outinfo); // 生成道路的线标
+    // 每条道路的线标和信息写入各自的列表，全部完成后按道路顺序合并
+    std::vector<std::vector<std::unique_ptr<geom::Mesh>>> road_marks(RoadsIDToGenerate.size());
+    std::vector<std::vector<std::string>> road_info(RoadsIDToGenerate.size());
+    ParallelForChunks(RoadsIDToGenerate.size(), [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            const auto& road = _data.GetRoads().at(RoadsIDToGenerate[i]); // 获取道路对象
+            if (!road.IsJunction()) { // 如果不是交叉口
+                mesh_factory.GenerateLaneMarkForRoad(road, road_marks[i], road_info[i]); // 生成道路的线标
+            }
         }
+    }, 4u);
+    for (size_t i = 0u; i < RoadsIDToGenerate.size(); ++i) {
+        LineMarks.insert(LineMarks.end(),
+            std::make_move_iterator(road_marks[i].begin()),
+            std::make_move_iterator(road_marks[i].end()));
+        outinfo.insert(outinfo.end(),
+            std::make_move_iterator(road_info[i].begin()),
+            std::make_move_iterator(road_info[i].end()));
     }
 
     return std::move(LineMarks); // 移动并返回生成的线标网格
@@ -1384,57 +1596,18 @@ std::vector<std::unique_ptr<geom::Mesh>> Map::GenerateLineMarkings(
     std::vector<JuncId> JunctionsToGenerate = FilterJunctionsByPosition(minpos, maxpos); // 根据位置过滤交叉口
     size_t num_junctions = JunctionsToGenerate.size(); // 交叉口数量
     std::cout << "Generating " << std::to_string(num_junctions) << " junctions" << std::endl; // 输出生成的交叉口数
-    size_t junctionindex = 0; // 交叉口索引初始化
-    size_t num_junctions_per_thread = 5; // 每个线程处理的交叉口数量
-    size_t num_threads = (num_junctions / num_junctions_per_thread) + 1; // 计算线程数
-    num_threads = num_threads > 1 ? num_threads : 1; // 至少一个线程
-    std::vector<std::thread> workers; // 线程列表
-    std::mutex write_mutex; // 互斥锁用于保护共享资源
-
-    for ( size_t i = 0; i < num_threads; ++i ) { // 创建并启动多个线程
-      std::thread neworker(
-        [this, &write_mutex, &mesh_factory, &junction_out_mesh_list, JunctionsToGenerate, i, num_junctions_per_thread, num_junctions]() {
-        std::map<road::Lane::LaneType, // 本线程内的交叉口列表
-          std::vector<std::unique_ptr<geom::Mesh>>> junctionsofthisthread;
-
-        size_t minimum = 0; // 初始化最小值
-        if( (i + 1) * num_junctions_per_thread < num_junctions ){ // 如果还有交叉口需要处理
-          minimum = (i + 1) * num_junctions_per_thread; // 更新最小值
-        }else{
-          minimum = num_junctions; // 否则设置为总数量
-        }
-        std::cout << "Generating Junctions between  " << std::to_string(i * num_junctions_per_thread) << " and " << std::to_string(minimum) << std::endl; // 输出当前线程处理的交叉口范围
 
-        for ( size_t junctionindex = i * num_junctions_per_thread; // 遍历本线程处理的交叉口
-                        junctionindex < minimum;
-                        ++junctionindex )
-        {
-          GenerateSingleJunction(mesh_factory, JunctionsToGenerate[junctionindex], &junctionsofthisthread); // 生成单个交叉口
-        }
-        std::cout << "Generated Junctions between  " << std::to_string(i * num_junctions_per_thread) << " and " << std::to_string(minimum) << std::endl; // 输出完成的交叉口范围
-        std::lock_guard<std::mutex> guard(write_mutex); // 保护对共享数据的写操作
-        for ( auto&& pair : junctionsofthisthread ) { // 遍历本线程生成的交叉口
-          if ((*junction_out_mesh_list).find(pair.first) != (*junction_out_mesh_list).end()) { // 如果该类型的交叉口已存在
-            (*junction_out_mesh_list)[pair.first].insert((*junction_out_mesh_list)[pair.first].end(),
-              std::make_move_iterator(pair.second.begin()), // 插入新的交叉口网格
-              std::make_move_iterator(pair.second.end()));
-          } else {
-            (*junction_out_mesh_list)[pair.first] = std::move(pair.second); // 否则直接移动到输出列表
-          }
-        }
-      });
-      workers.push_back(std::move(neworker)); // 将新线程添加到线程列表
-    }
-
-    for (size_t i = 0; i < workers.size(); ++i) { // 等待所有线程完成
-      workers[i].join();
-    }
-    workers.clear(); // 清空线程列表
-    for (size_t i = 0; i < workers.size(); ++i) { // 检查并确保所有线程已加入
-      if (workers[i].joinable()) {
-        workers[i].join();
+    // 每个交叉口写入各自的结果，全部完成后按交叉口顺序合并
+    std::vector<std::map<road::Lane::LaneType, std::vector<std::unique_ptr<geom::Mesh>>>> junction_meshes(num_junctions);
+    ParallelForChunks(num_junctions, [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i) {
+        GenerateSingleJunction(mesh_factory, JunctionsToGenerate[i], &junction_meshes[i]); // 生成单个交叉口
       }
+    }, 1u);
+    for (auto &meshes : junction_meshes) {
+      AppendOrderedMeshes(*junction_out_mesh_list, meshes);
     }
+    std::cout << "Generated " << std::to_string(num_junctions) << " junctions" << std::endl; // 输出完成的交叉口数
   }
 
   std::vector<JuncId> Map::FilterJunctionsByPosition( const geom::Vector3D& minpos, // 根据位置过滤交叉口的函数
@@ -1478,7 +1651,8 @@ std::vector<RoadId> Map::FilterRoadsByPosition( const geom::Vector3D& minpos, //
 
 std::unique_ptr<geom::Mesh> Map::SDFToMesh(const road::Junction& jinput, // 定义函数，输入为交叉口和SDF点，以及每个维度的网格单元数
     const std::vector<geom::Vector3D>& sdfinput,
-    int grid_cells_per_dim) const {
+    int grid_cells_per_dim,
+    double coarse_distance) const {
 
     int junctionid = jinput.GetId(); // 获取交叉口ID
     float box_extraextension_factor = 1.2f; // 定义盒子扩展因子
@@ -1512,44 +1686,151 @@ std::unique_ptr<geom::Mesh> Map::SDFToMesh(const road::Junction& jinput, // 定
       return Distance.Length() * -1.0; // 返回距离的负值
     };
 
-    double gridsizeindouble = grid_cells_per_dim;  // 网格大小，单位为双精度浮点数
     MeshReconstruction::Rect3 domain;  // 定义一个矩形区域
     domain.min = { MinOffset.x, MinOffset.y, MinOffset.z };  // 设置区域的最小值
     domain.size = { bb.extent.x * box_extraextension_factor * 2, bb.extent.y * box_extraextension_factor * 2, 0.4 };  // 设置区域的大小
-
     MeshReconstruction::Vec3 cubeSize{ CubeSize, CubeSize, 0.2 };  // 定义立方体大小
-    auto mesh = MeshReconstruction::MarchCube(junctionsdf, domain, cubeSize );  // 使用Marching Cubes算法生成网格
-    carla::geom::Rotation inverse = bb.rotation;  // 获取物体的旋转信息
-    carla::geom::Vector3D trasltation = bb.location;  // 获取物体的位置
-    geom::Mesh out_mesh;  // 创建一个输出网格
 
-    for (auto& cv : mesh.vertices) {  // 遍历生成的网格顶点
-      geom::Vector3D newvertex;  // 新顶点
-      newvertex.x = cv.x;  // 设置新顶点的x坐标
-      newvertex.y = cv.y;  // 设置新顶点的y坐标
-      newvertex.z = cv.z;  // 设置新顶点的z坐标
-      out_mesh.AddVertex(newvertex);  // 将新顶点添加到输出网格
-    }
+    // 与 MeshReconstruction::MarchCube 相同的立方体划分，但SDF只在格点上计算一次并缓存，
+    // 而不是每个立方体计算8个角点，相邻立方体共享的角点不再重复计算
+    const int NumX = static_cast<int>(std::ceil(domain.size.x / cubeSize.x));
+    const int NumY = static_cast<int>(std::ceil(domain.size.y / cubeSize.y));
+    const int NumZ = static_cast<int>(std::ceil(domain.size.z / cubeSize.z));
+    const size_t PointsX = static_cast<size_t>(NumX) + 1u;
+    const size_t PointsY = static_cast<size_t>(NumY) + 1u;
+    const size_t PointsZ = static_cast<size_t>(NumZ) + 1u;
+    auto grid_index = [=](size_t ix, size_t iy, size_t iz) {
+      return (ix * PointsY + iy) * PointsZ + iz;
+    };
+    auto grid_position = [&](size_t ix, size_t iy, size_t iz) {
+      return domain.min + MeshReconstruction::Vec3{
+          static_cast<double>(ix) * cubeSize.x,
+          static_cast<double>(iy) * cubeSize.y,
+          static_cast<double>(iz) * cubeSize.z};
+    };
+    std::vector<double> grid(PointsX * PointsY * PointsZ);
 
-    auto finalvertices = out_mesh.GetVertices();  // 获取输出网格的所有顶点
-    for (auto ct : mesh.triangles) {  // 遍历生成的网格三角形
-      out_mesh.AddIndex(ct[1] + 1);  // 添加三角形的第二个顶点索引
-      out_mesh.AddIndex(ct[0] + 1);  // 添加三角形的第一个顶点索引
-      out_mesh.AddIndex(ct[2] + 1);  // 添加三角形的第三个顶点索引
+    // 使用低分辨率时，先计算x、y坐标都为偶数的格点，其余格点所在的粗网格单元
+    // 如果四个角都离路面超过 coarse_distance，就用双线性插值代替计算
+    const bool use_coarse = coarse_distance > 0.0;
+    auto is_coarse = [=](size_t i, size_t points) {
+      return i % 2u == 0u || i + 1u == points;
+    };
+    auto coarse_bounds = [](size_t i, size_t points, size_t &lower, size_t &upper) {
+      lower = i - i % 2u;
+      upper = std::min(lower + 2u, points - 1u);
+    };
+    auto sample_rows = [&](bool coarse_pass) {
+      ParallelForChunks(PointsX, [&](size_t begin, size_t end) {
+        for (size_t ix = begin; ix < end; ++ix) {
+          for (size_t iy = 0u; iy < PointsY; ++iy) {
+            const bool coarse_point = is_coarse(ix, PointsX) && is_coarse(iy, PointsY);
+            if (use_coarse && coarse_point != coarse_pass) {
+              continue;
+            }
+            for (size_t iz = 0u; iz < PointsZ; ++iz) {
+              if (use_coarse && !coarse_point) {
+                size_t x0, x1, y0, y1;
+                coarse_bounds(ix, PointsX, x0, x1);
+                coarse_bounds(iy, PointsY, y0, y1);
+                const double v00 = grid[grid_index(x0, y0, iz)];
+                const double v10 = grid[grid_index(x1, y0, iz)];
+                const double v01 = grid[grid_index(x0, y1, iz)];
+                const double v11 = grid[grid_index(x1, y1, iz)];
+                if (std::max({v00, v10, v01, v11}) < -coarse_distance) {
+                  const double tx = x1 > x0 ? static_cast<double>(ix - x0) / static_cast<double>(x1 - x0) : 0.0;
+                  const double ty = y1 > y0 ? static_cast<double>(iy - y0) / static_cast<double>(y1 - y0) : 0.0;
+                  grid[grid_index(ix, iy, iz)] =
+                      (v00 * (1.0 - tx) + v10 * tx) * (1.0 - ty) +
+                      (v01 * (1.0 - tx) + v11 * tx) * ty;
+                  continue;
+                }
+              }
+              grid[grid_index(ix, iy, iz)] = junctionsdf(grid_position(ix, iy, iz));
+            }
+          }
+        }
+      }, 4u);
+    };
+    sample_rows(true);
+    if (use_coarse) {
+      sample_rows(false);
     }
 
-    for (auto& cv : out_mesh.GetVertices() ) {  // 遍历输出网格的顶点
-      boost::optional<element::Waypoint> CheckingWaypoint = GetWaypoint(geom::Location(cv), 0x1 << 1);  // 检查当前顶点是否为路点
-      if (!CheckingWaypoint) {  // 如果不是路点
-        boost::optional<element::Waypoint> InRoadWaypoint = GetClosestWaypointOnRoad(geom::Location(cv), 0x1 << 1);  // 获取离当前顶点最近的路点
-        geom::Transform InRoadWPTransform = ComputeTransform(*InRoadWaypoint);  // 计算路点的变换
+    // Cube 通过SDF读取角点的值，这里按位置换算回格点下标读取缓存
+    const MeshReconstruction::Fun3s cached_sdf = [&](MeshReconstruction::Vec3 const& pos) {
+      const auto ix = static_cast<size_t>(std::lround((pos.x - domain.min.x) / cubeSize.x));
+      const auto iy = static_cast<size_t>(std::lround((pos.y - domain.min.y) / cubeSize.y));
+      const auto iz = static_cast<size_t>(std::lround((pos.z - domain.min.z) / cubeSize.z));
+      return grid[grid_index(ix, iy, iz)];
+    };
+    // 输出网格不使用法线，不需要用数值梯度计算
+    const MeshReconstruction::Fun3v constant_gradient = [](MeshReconstruction::Vec3 const&) {
+      return MeshReconstruction::Vec3{0.0, 0.0, 1.0};
+    };
+
+    // 按x方向分块并行生成三角形，每块写入各自的结果，最后按顺序合并
+    const double HalfCubeDiag = cubeSize.Norm() / 2.0;
+    const auto HalfCubeSize = cubeSize * 0.5;
+    std::vector<MeshReconstruction::Mesh> slabs(static_cast<size_t>(NumX));
+    ParallelForChunks(slabs.size(), [&](size_t begin, size_t end) {
+      for (size_t ix = begin; ix < end; ++ix) {
+        for (size_t iy = 0u; iy < static_cast<size_t>(NumY); ++iy) {
+          for (size_t iz = 0u; iz < static_cast<size_t>(NumZ); ++iz) {
+            const auto min = grid_position(ix, iy, iz);
+            MeshReconstruction::Cube cube({min, cubeSize}, cached_sdf);
+            const auto intersect = cube.Intersect(0.0);
+            if (intersect.signConfig == 0 || intersect.signConfig == 255) {
+              continue;
+            }
+            // 与 MarchCube 相同，只保留中心位于表面附近窄带内的立方体
+            if (std::abs(junctionsdf(min + HalfCubeSize)) > HalfCubeDiag) {
+              continue;
+            }
+            MeshReconstruction::Triangulate(intersect, constant_gradient, slabs[ix]);
+          }
+        }
+      }
+    }, 4u);
+
+    carla::geom::Rotation inverse = bb.rotation;  // 获取物体的旋转信息
+    carla::geom::Vector3D trasltation = bb.location;  // 获取物体的位置
+    geom::Mesh out_mesh;  // 创建一个输出网格
 
-        geom::Vector3D director = geom::Location(cv) - (InRoadWPTransform.location);  // 计算指向路点的方向
-        geom::Vector3D laneborder = InRoadWPTransform.location + geom::Location(director.MakeUnitVector() * GetLaneWidth(*InRoadWaypoint) * 0.5f);  // 计算车道边界位置
-        cv = laneborder;  // 更新顶点位置为车道边界
+    for (const auto &slab : slabs) {
+      const size_t offset = out_mesh.GetVerticesNum();
+      for (auto& cv : slab.vertices) {  // 遍历生成的网格顶点
+        geom::Vector3D newvertex;  // 新顶点
+        newvertex.x = cv.x;  // 设置新顶点的x坐标
+        newvertex.y = cv.y;  // 设置新顶点的y坐标
+        newvertex.z = cv.z;  // 设置新顶点的z坐标
+        out_mesh.AddVertex(newvertex);  // 将新顶点添加到输出网格
+      }
+      for (auto ct : slab.triangles) {  // 遍历生成的网格三角形
+        out_mesh.AddIndex(offset + ct[1] + 1);  // 添加三角形的第二个顶点索引
+        out_mesh.AddIndex(offset + ct[0] + 1);  // 添加三角形的第一个顶点索引
+        out_mesh.AddIndex(offset + ct[2] + 1);  // 添加三角形的第三个顶点索引
       }
     }
-    return std::make_unique<geom::Mesh>(out_mesh);  // 返回生成的网格
+
+    // 每个三角形都有自己的三个顶点，先合并相同的顶点，再把路面以外的顶点移到车道边界上
+    out_mesh.WeldVertices();
+    auto &vertices = out_mesh.GetVertices();
+    ParallelForChunks(vertices.size(), [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i) {  // 遍历输出网格的顶点
+        auto &cv = vertices[i];
+        boost::optional<element::Waypoint> CheckingWaypoint = GetWaypoint(geom::Location(cv), 0x1 << 1);  // 检查当前顶点是否为路点
+        if (!CheckingWaypoint) {  // 如果不是路点
+          boost::optional<element::Waypoint> InRoadWaypoint = GetClosestWaypointOnRoad(geom::Location(cv), 0x1 << 1);  // 获取离当前顶点最近的路点
+          geom::Transform InRoadWPTransform = ComputeTransform(*InRoadWaypoint);  // 计算路点的变换
+
+          geom::Vector3D director = geom::Location(cv) - (InRoadWPTransform.location);  // 计算指向路点的方向
+          geom::Vector3D laneborder = InRoadWPTransform.location + geom::Location(director.MakeUnitVector() * GetLaneWidth(*InRoadWaypoint) * 0.5f);  // 计算车道边界位置
+          cv = laneborder;  // 更新顶点位置为车道边界
+        }
+      }
+    }, 64u);
+    return std::make_unique<geom::Mesh>(std::move(out_mesh));  // 返回生成的网格
   }
 
   void Map::GenerateSingleJunction(const carla::geom::MeshFactory& mesh_factory,  // 生成单个交叉口
@@ -21,6 +21,7 @@
 
 #include <boost/optional.hpp> // 包含可选类型的定义
 
+#include <unordered_map> // 包含无序映射的定义
 #include <vector> // 包含向量类的定义
 
 namespace carla {
@@ -37,6 +38,8 @@ namespace road {
 
     Map(MapData m) : _data(std::move(m)) { // 构造函数，初始化_map数据
       CreateRtree(); // 创建R树
+      CreateLaneLinks(); // 创建车道连接表
+      CreateLaneSignals(); // 创建车道信号索引
     }
 
     /// ========================================================================
@@ -59,6 +62,17 @@ namespace road {
         const geom::Location &location, // 输入位置
         int32_t lane_type = static_cast<int32_t>(Lane::LaneType::Driving)) const; // 默认车道类型为驾驶车道
 
+    /// 批量获取多个位置在道路上最近的路径点，结果与 @a locations 一一对应。
+    /// 位置较多时分块在多个线程中并行查询R树，每块复用同一个查询缓冲区。
+    std::vector<boost::optional<element::Waypoint>> GetClosestWaypointsOnRoad(
+        const std::vector<geom::Location> &locations,
+        int32_t lane_type = static_cast<int32_t>(Lane::LaneType::Driving)) const;
+
+    /// 与 GetClosestWaypointsOnRoad 相同，但与 GetWaypoint 一样丢弃不在车道内的位置。
+    std::vector<boost::optional<element::Waypoint>> GetWaypoints(
+        const std::vector<geom::Location> &locations,
+        int32_t lane_type = static_cast<int32_t>(Lane::LaneType::Driving)) const;
+
     boost::optional<element::Waypoint> GetWaypoint( // 根据道路ID和车道ID获取路径点
         RoadId road_id, // 道路ID
         LaneId lane_id, // 车道ID
@@ -102,6 +116,10 @@ namespace road {
     std::vector<SignalSearchData> GetSignalsInDistance(
         Waypoint waypoint, double distance, bool stop_at_junction = false) const; // 获取指定距离内的信号
 
+    /// 批量搜索信号，结果与 @a waypoints 一一对应，路点较多时分块在多个线程中执行。
+    std::vector<std::vector<SignalSearchData>> GetSignalsInDistance(
+        const std::vector<Waypoint> &waypoints, double distance, bool stop_at_junction = false) const;
+
     /// 返回地图中的所有 RoadInfoSignal
     std::vector<const element::RoadInfoSignal*>
         GetAllSignalReferences() const; // 获取所有信号的引用
@@ -122,6 +140,12 @@ namespace road {
     /// 使得车辆可以反向驶向这些路点。
     std::vector<Waypoint> GetPrevious(Waypoint waypoint, double distance) const; // 获取上一个路点
 
+    /// 与上面的 GetNext 相同，但结果写入调用者提供的 @a result，
+    /// 重复调用时可以复用同一个缓冲区，避免每次分配内存。
+    void GetNext(Waypoint waypoint, double distance, std::vector<Waypoint> &result) const;
+    /// 与上面的 GetPrevious 相同，但结果写入调用者提供的 @a result。
+    void GetPrevious(Waypoint waypoint, double distance, std::vector<Waypoint> &result) const;
+
     /// 返回 @a waypoint 右侧车道的路点。
     boost::optional<Waypoint> GetRight(Waypoint waypoint) const; // 获取右侧路点
 
@@ -211,6 +235,71 @@ private:
 
     void CreateRtree();  // 创建R树
 
+    /// 每条车道的后继和前驱路点，在构造时计算一次，
+    /// GetNext 和 GetPrevious 不必每次都重新查找道路和车道段
+    struct LaneLinks {
+      const Lane *lane = nullptr;
+      std::vector<Waypoint> successors;
+      std::vector<Waypoint> predecessors;
+    };
+
+    struct LaneKey {
+      RoadId road_id;
+      SectionId section_id;
+      LaneId lane_id;
+
+      bool operator==(const LaneKey &rhs) const {
+        return road_id == rhs.road_id && section_id == rhs.section_id && lane_id == rhs.lane_id;
+      }
+    };
+
+    struct LaneKeyHash {
+      size_t operator()(const LaneKey &key) const {
+        uint64_t seed = key.road_id;
+        seed = seed * 31u + key.section_id;
+        seed = seed * 31u + static_cast<uint32_t>(key.lane_id);
+        return std::hash<uint64_t>()(seed);
+      }
+    };
+
+    std::unordered_map<LaneKey, LaneLinks, LaneKeyHash> _lane_links;
+
+    void CreateLaneLinks();  // 创建车道连接表
+
+    // 车道不在表中时（例如连接关系不完整的车道）返回空指针
+    const LaneLinks *FindLaneLinks(Waypoint waypoint) const;
+
+    /// 每条车道上对其有效的信号，按s递增排列，在构造时计算一次，
+    /// GetSignalsInDistance 只需二分查找而不必遍历道路上的所有信息
+    std::unordered_map<LaneKey, std::vector<const element::RoadInfoSignal *>, LaneKeyHash> _lane_signals;
+
+    void CreateLaneSignals();  // 创建车道信号索引
+
+    // 把从 @a waypoint 开始 @a distance 以内的信号添加到 @a result，
+    // 信号的累计距离加上 @a accumulated_s，@a next_buffer 用于复用 GetNext 的结果
+    void AppendSignalsInDistance(
+        Waypoint waypoint,
+        double distance,
+        bool stop_at_junction,
+        double accumulated_s,
+        std::vector<SignalSearchData> &result,
+        std::vector<Waypoint> &next_buffer) const;
+
+    void AppendNext(Waypoint waypoint, double distance, std::vector<Waypoint> &result) const;
+
+    void AppendPrevious(Waypoint waypoint, double distance, std::vector<Waypoint> &result) const;
+
+    // 与公开的版本相同，但查询结果写入 @a query_result 以便复用
+    boost::optional<element::Waypoint> GetClosestWaypointOnRoad(
+        const geom::Location &location,
+        int32_t lane_type,
+        std::vector<Rtree::TreeElement> &query_result) const;
+
+    // 位置不在路径点所在车道的宽度内时返回空
+    boost::optional<element::Waypoint> FilterWaypointInLane(
+        const geom::Location &location,
+        boost::optional<element::Waypoint> waypoint) const;
+
     // 辅助函数，用于构造R树元素列表
     void AddElementToRtree(  // 将元素添加到R树
         std::vector<Rtree::TreeElement> &rtree_elements,  // R树元素列表
@@ -256,7 +345,14 @@ public:
       const geom::Vector3D& minpos,  // 最小位置
       const geom::Vector3D& maxpos ) const;  // 最大位置
 
-    std::unique_ptr<geom::Mesh> SDFToMesh(const road::Junction& jinput, const std::vector<geom::Vector3D>& sdfinput, int grid_cells_per_dim) const;  // 将SDF转换为网格
+    /// 将交叉口的SDF转换为网格。SDF在格点上并行计算一次，再分块并行执行 Marching Cubes。
+    /// @param coarse_distance 大于0时，离路面超过该距离的区域只计算一半分辨率的格点，
+    ///        其余格点插值得到。应大于粗网格单元的对角线长度（约1.5米），为0时全部精确计算。
+    std::unique_ptr<geom::Mesh> SDFToMesh(
+        const road::Junction& jinput,
+        const std::vector<geom::Vector3D>& sdfinput,
+        int grid_cells_per_dim,
+        double coarse_distance = 0.0) const;  // 将SDF转换为网格
   };
 
 } // namespace road
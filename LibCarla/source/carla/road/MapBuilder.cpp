@@ -507,6 +507,17 @@ void MapBuilder::AddRoadGeometrySpiral(
         std::move(spiral_geometry))));
   }
 
+// 添加已经构造好的道路几何信息
+void MapBuilder::AddRoadGeometry(
+      Road *road,
+      const double s,
+      std::unique_ptr<Geometry> geometry) {
+    DEBUG_ASSERT(road != nullptr); // 确保道路不为空
+    DEBUG_ASSERT(geometry != nullptr); // 确保几何对象不为空
+    _temp_road_info_container[road].emplace_back(std::unique_ptr<RoadInfo>(new RoadInfoGeometry(s,
+        std::move(geometry))));
+  }
+
 // 添加道路几何三次多项式信息
 void MapBuilder::AddRoadGeometryPoly3(
       Road * road,
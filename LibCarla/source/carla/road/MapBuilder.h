@@ -9,10 +9,12 @@
 #include "carla/road/Map.h" // 引入地图模块
 #include "carla/road/element/RoadInfoCrosswalk.h" // 引入人行横道信息模块
 #include "carla/road/element/RoadInfoSignal.h" // 引入交通信号信息模块
+#include "carla/road/element/Geometry.h" // 引入道路几何模块
 
 #include <boost/optional.hpp> // 引入可选类型模块
 
 #include <map> // 引入映射容器模块
+#include <memory> // 引入智能指针模块
 
 namespace carla {
 namespace road {
@@ -101,6 +103,12 @@ namespace road {
         const double dV, // 多项式系数d (V方向)
         const std::string p_range); // 参数范围字符串
 
+    // 添加已经构造好的几何对象，几何解析器在多个线程中构造几何后按原顺序调用
+    void AddRoadGeometry(
+        carla::road::Road *road, // 指向道路的指针
+        const double s, // 位置参数
+        std::unique_ptr<element::Geometry> geometry); // 几何对象
+
     // 从轮廓解析器调用
     void AddRoadElevationProfile(
         Road *road, // 指向道路的指针
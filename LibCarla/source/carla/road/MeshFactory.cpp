@@ -1102,19 +1102,24 @@ void MeshFactory::GenerateLaneMarksForNotCenterLine(
     // 构建R树以进行邻域查询
     using Rtree = geom::PointCloudRtree<VertexInfo>;  // R树类型
     using Point = Rtree::BPoint;  // 点类型
-    Rtree rtree;  // 创建R树实例
+    // 先收集所有顶点再一次性打包构建R树，比逐个插入快得多
+    std::vector<Rtree::TreeElement> elements;
+    size_t number_of_vertices = 0u;
+    for (auto &mesh : lane_meshes) {
+      number_of_vertices += mesh->GetVerticesNum();
+    }
+    elements.reserve(number_of_vertices);
     for (size_t lane_mesh_idx = 0; lane_mesh_idx < lane_meshes.size(); ++lane_mesh_idx) {  // 遍历每个车道网格
       auto& mesh = lane_meshes[lane_mesh_idx];   // 获取当前网格
       for(size_t i = 0; i < mesh->GetVerticesNum(); ++i) {  // 遍历每个顶点
         auto& vertex = mesh->GetVertices()[i];  // 获取当前顶点
         Point point(vertex.x, vertex.y, vertex.z);  // 创建点对象
-        if (i < 2 || i >= mesh->GetVerticesNum() - 2) {  // 判断顶点是否为边界顶点
-          rtree.InsertElement({point, {&vertex, lane_mesh_idx, true}});  // 插入边界顶点到R树
-        } else {
-          rtree.InsertElement({point, {&vertex, lane_mesh_idx, false}});  // 插入非边界顶点到R树
-        }
+        const bool is_static = (i < 2 || i >= mesh->GetVerticesNum() - 2);  // 判断顶点是否为边界顶点
+        elements.push_back({point, {&vertex, lane_mesh_idx, is_static}});
       }
     }
+    Rtree rtree;  // 创建R树实例
+    rtree.InsertElements(elements);
 
   // 查找每个顶点的邻居并计算它们的权重
   std::vector<VertexNeighbors> vertices_neighborhoods;  // 顶点邻域集合
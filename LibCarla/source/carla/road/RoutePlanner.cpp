@@ -0,0 +1,214 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/road/RoutePlanner.h"
+
+#include "carla/ParallelFor.h"
+#include "carla/geom/Math.h"
+
+#include <algorithm>
+#include <limits>
+#include <queue>
+
+namespace carla {
+namespace road {
+
+  using element::Waypoint;
+
+  static constexpr uint32_t INVALID_NODE = std::numeric_limits<uint32_t>::max();
+
+  // 车道端点稍微向内偏移，避免落在相邻车道段上
+  static constexpr double LANE_END_OFFSET = 1e-6;
+
+  // 车道沿行驶方向的终点
+  static Waypoint GetLaneExit(const Lane &lane, Waypoint waypoint) {
+    if (waypoint.lane_id <= 0) {
+      waypoint.s = lane.GetDistance() + lane.GetLength() - LANE_END_OFFSET;
+    } else {
+      waypoint.s = lane.GetDistance() + LANE_END_OFFSET;
+    }
+    return waypoint;
+  }
+
+  RoutePlanner::RoutePlanner(const Map &map, const double lane_change_cost)
+    : _map(map) {
+    const auto entries = _map.GenerateWaypointsOnRoadEntries(Lane::LaneType::Driving);
+    _nodes.reserve(entries.size());
+    for (const auto &entry : entries) {
+      const auto &lane = _map.GetLane(entry);
+      const auto exit = GetLaneExit(lane, entry);
+      _node_index.emplace(MakeKey(entry), static_cast<uint32_t>(_nodes.size()));
+      _nodes.push_back(Node{entry, _map.ComputeTransform(exit).location, lane.GetLength()});
+    }
+
+    // 按节点顺序生成出边
+    _edge_offsets.reserve(_nodes.size() + 1u);
+    _edge_offsets.push_back(0u);
+    for (const auto &node : _nodes) {
+      for (const auto &successor : _map.GetSuccessors(node.entry)) {
+        uint32_t to;
+        if (FindNode(successor, to)) {
+          _edges.push_back(Edge{to, _nodes[to].length});
+        }
+      }
+      // 变道到同方向的相邻行驶车道，代价不小于两条车道终点之间的距离以保证启发函数可采纳
+      for (const auto &side : {_map.GetLeft(node.entry), _map.GetRight(node.entry)}) {
+        uint32_t to;
+        if (side.has_value() &&
+            (side->lane_id < 0) == (node.entry.lane_id < 0) &&
+            FindNode(*side, to)) {
+          const double distance = static_cast<double>(geom::Math::Distance(node.end, _nodes[to].end));
+          _edges.push_back(Edge{to, lane_change_cost + distance});
+        }
+      }
+      _edge_offsets.push_back(static_cast<uint32_t>(_edges.size()));
+    }
+  }
+
+  bool RoutePlanner::FindNode(const Waypoint &waypoint, uint32_t &index) const {
+    auto it = _node_index.find(MakeKey(waypoint));
+    if (it == _node_index.end()) {
+      return false;
+    }
+    index = it->second;
+    return true;
+  }
+
+  double RoutePlanner::RemainingLength(const uint32_t node, const Waypoint &waypoint) const {
+    const auto &lane = _map.GetLane(_nodes[node].entry);
+    const double remaining = waypoint.lane_id <= 0 ?
+        lane.GetDistance() + lane.GetLength() - waypoint.s :
+        waypoint.s - lane.GetDistance();
+    return geom::Math::Clamp(remaining, 0.0, lane.GetLength());
+  }
+
+  RoutePlanner::Route RoutePlanner::ComputeRoute(
+      const geom::Location &origin,
+      const geom::Location &destination) const {
+    auto start = _map.GetClosestWaypointOnRoad(origin);
+    auto goal = _map.GetClosestWaypointOnRoad(destination);
+    if (!start.has_value() || !goal.has_value()) {
+      return Route{};
+    }
+    return ComputeRoute(*start, *goal);
+  }
+
+  RoutePlanner::Route RoutePlanner::ComputeRoute(
+      const Waypoint &origin,
+      const Waypoint &destination) const {
+    uint32_t start;
+    uint32_t goal;
+    if (!FindNode(origin, start) || !FindNode(destination, goal)) {
+      return Route{};
+    }
+    const double start_remaining = RemainingLength(start, origin);
+    const double goal_remaining = RemainingLength(goal, destination);
+
+    // 终点在同一车道的前方时直接到达
+    if (start == goal && start_remaining >= goal_remaining) {
+      Route route;
+      route.waypoints = {origin, destination};
+      route.length = start_remaining - goal_remaining;
+      return route;
+    }
+
+    // g 是到达车道终点的代价，起点车道本身不作为已到达的节点，
+    // 这样终点在同一车道后方时路线可以绕一圈回来
+    const auto infinity = std::numeric_limits<double>::infinity();
+    std::vector<double> cost(_nodes.size(), infinity);
+    std::vector<uint32_t> parent(_nodes.size(), INVALID_NODE);
+    std::vector<bool> closed(_nodes.size(), false);
+
+    const geom::Location &target = _nodes[goal].end;
+    auto heuristic = [&](uint32_t node) {
+      return static_cast<double>(geom::Math::Distance(_nodes[node].end, target));
+    };
+
+    using Entry = std::pair<double, uint32_t>;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> open;
+
+    auto relax = [&](uint32_t from, double from_cost) {
+      for (auto i = _edge_offsets[from]; i < _edge_offsets[from + 1u]; ++i) {
+        const auto &edge = _edges[i];
+        const double new_cost = from_cost + edge.cost;
+        if (!closed[edge.to] && new_cost < cost[edge.to]) {
+          cost[edge.to] = new_cost;
+          parent[edge.to] = from;
+          open.emplace(new_cost + heuristic(edge.to), edge.to);
+        }
+      }
+    };
+
+    relax(start, start_remaining);
+    while (!open.empty()) {
+      const auto node = open.top().second;
+      open.pop();
+      if (closed[node]) {
+        continue;
+      }
+      closed[node] = true;
+      if (node == goal) {
+        break;
+      }
+      relax(node, cost[node]);
+    }
+
+    if (!closed[goal]) {
+      return Route{};
+    }
+
+    // 从终点沿父节点回溯到起点；第一次回到起点车道时停止
+    std::vector<uint32_t> path;
+    auto current = goal;
+    do {
+      path.push_back(current);
+      current = parent[current];
+    } while (current != start);
+    std::reverse(path.begin(), path.end());
+
+    Route route;
+    route.length = cost[goal] - goal_remaining;
+    route.waypoints.reserve(path.size() + 2u);
+    route.waypoints.push_back(origin);
+    auto previous = start;
+    for (const auto node : path) {
+      const auto &entry = _nodes[node].entry;
+      const bool is_lane_change =
+          entry.road_id == _nodes[previous].entry.road_id &&
+          entry.section_id == _nodes[previous].entry.section_id;
+      // 变道发生在前一条车道的终点附近，使用目标车道上对应的位置
+      route.waypoints.push_back(is_lane_change ? GetLaneExit(_map.GetLane(entry), entry) : entry);
+      previous = node;
+    }
+    route.waypoints.push_back(destination);
+    return route;
+  }
+
+  std::vector<RoutePlanner::Route> RoutePlanner::ComputeRoutes(
+      const std::vector<std::pair<geom::Location, geom::Location>> &queries) const {
+    std::vector<geom::Location> locations;
+    locations.reserve(2u * queries.size());
+    for (const auto &query : queries) {
+      locations.push_back(query.first);
+      locations.push_back(query.second);
+    }
+    const auto waypoints = _map.GetClosestWaypointsOnRoad(locations);
+
+    std::vector<Route> result(queries.size());
+    ParallelForChunks(queries.size(), [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i) {
+        const auto &start = waypoints[2u * i];
+        const auto &goal = waypoints[2u * i + 1u];
+        if (start.has_value() && goal.has_value()) {
+          result[i] = ComputeRoute(*start, *goal);
+        }
+      }
+    }, 16u);
+    return result;
+  }
+
+} // namespace road
+} // namespace carla
@@ -0,0 +1,96 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/NonCopyable.h"
+#include "carla/geom/Location.h"
+#include "carla/road/Map.h"
+#include "carla/road/element/Waypoint.h"
+
+#include <cstdint>
+#include <map>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace carla {
+namespace road {
+
+  /// 基于 road::Map 车道拓扑的路径规划器。
+  ///
+  /// 构造时把所有行驶车道预处理成一张紧凑的车道图（CSR格式）：节点是车道，
+  /// 边是车道的后继以及同方向相邻行驶车道之间的变道。查询使用A*，
+  /// 启发函数是到目标车道终点的直线距离。构造完成后规划器是只读的，
+  /// 可以在多个线程中同时查询。
+  class RoutePlanner : private NonCopyable {
+  public:
+
+    using Waypoint = element::Waypoint;
+
+    struct Route {
+      /// 起点、途经的每条车道的入口以及终点，无法到达时为空。
+      std::vector<Waypoint> waypoints;
+
+      /// 路线的长度（米），包括变道的代价。
+      double length = 0.0;
+    };
+
+    /// @param lane_change_cost 每次变道额外增加的代价（米）。
+    explicit RoutePlanner(const Map &map, double lane_change_cost = 10.0);
+
+    /// 计算从 @a origin 到 @a destination 的路线，两个位置会先投影到最近的行驶车道上。
+    Route ComputeRoute(const geom::Location &origin, const geom::Location &destination) const;
+
+    /// 计算两个车道上的路点之间的路线。
+    Route ComputeRoute(const Waypoint &origin, const Waypoint &destination) const;
+
+    /// 批量计算路线，结果与 @a queries 一一对应，查询较多时分块在多个线程中执行。
+    std::vector<Route> ComputeRoutes(
+        const std::vector<std::pair<geom::Location, geom::Location>> &queries) const;
+
+    size_t GetNumberOfLanes() const {
+      return _nodes.size();
+    }
+
+  private:
+
+    struct Node {
+      Waypoint entry;       // 车道入口处的路点
+      geom::Location end;   // 车道终点的位置
+      double length;        // 车道长度
+    };
+
+    struct Edge {
+      uint32_t to;
+      double cost;
+    };
+
+    using LaneKey = std::tuple<RoadId, SectionId, LaneId>;
+
+    static LaneKey MakeKey(const Waypoint &waypoint) {
+      return LaneKey{waypoint.road_id, waypoint.section_id, waypoint.lane_id};
+    }
+
+    bool FindNode(const Waypoint &waypoint, uint32_t &index) const;
+
+    /// 从 @a waypoint 沿行驶方向到车道终点的距离。
+    double RemainingLength(uint32_t node, const Waypoint &waypoint) const;
+
+    const Map &_map;
+
+    std::vector<Node> _nodes;
+
+    /// 节点 i 的出边为 _edges[_edge_offsets[i]] 到 _edges[_edge_offsets[i + 1]]。
+    std::vector<uint32_t> _edge_offsets;
+
+    std::vector<Edge> _edges;
+
+    std::map<LaneKey, uint32_t> _node_index;
+  };
+
+} // namespace road
+} // namespace carla
@@ -116,7 +116,7 @@ geom::Vector2D RotatebyAngle(double angle, double x, double y) {
 
 // 函数：GeometrySpiral类的成员函数，根据距离获取位置点
 // dist: 距离
-DirectedPoint GeometrySpiral::PosFromDist(double dist) const {
+DirectedPoint GeometrySpiral::ComputePosFromDist(double dist) const {
     // 将距离限制在0.0到_length之间
     dist = geom::Math::Clamp(dist, 0.0, _length);
     // 调试断言，确保_length大于0.0
@@ -167,6 +167,63 @@ DirectedPoint GeometrySpiral::PosFromDist(double dist) const {
     return p;
 }
 
+// 短于此长度（单位：米）的螺旋线当作一个点，采样间隔为零时无法插值
+static constexpr double MIN_SPIRAL_LENGTH = 1e-6;
+
+// 函数：GeometrySpiral类的成员函数，按弧长等间距预计算采样点
+void GeometrySpiral::PreComputeSpline() {
+    // 长度为零（或几乎为零）的螺旋线不采样，PosFromDist直接返回起点
+    if (_length < MIN_SPIRAL_LENGTH) {
+        return;
+    }
+    // 采样间隔（单位：米），三次Hermite插值在此间隔下的位置误差远小于1毫米
+    constexpr double interval_size = 0.5;
+    const size_t number_intervals =
+        std::max(static_cast<size_t>(std::ceil(_length / interval_size)), size_t(1));
+    _sample_step = _length / static_cast<double>(number_intervals);
+    _samples.reserve(number_intervals + 1u);
+    for (size_t i = 0; i <= number_intervals; ++i) {
+        const DirectedPoint p = ComputePosFromDist(static_cast<double>(i) * _sample_step);
+        _samples.push_back(Sample{
+            static_cast<double>(p.location.x) - _start_position.x,
+            static_cast<double>(p.location.y) - _start_position.y,
+            p.tangent});
+    }
+}
+
+// 函数：GeometrySpiral类的成员函数，根据距离获取位置点
+// 在相邻的两个采样点之间做三次Hermite插值，曲线在采样点处的导数就是单位切线
+DirectedPoint GeometrySpiral::PosFromDist(double dist) const {
+    if (_samples.empty()) {
+        return DirectedPoint(_start_position, _heading);
+    }
+    dist = geom::Math::Clamp(dist, 0.0, _length);
+    DEBUG_ASSERT(_samples.size() >= 2u);
+    const size_t i = std::min(
+        static_cast<size_t>(dist / _sample_step),
+        _samples.size() - 2u);
+    const Sample &p0 = _samples[i];
+    const Sample &p1 = _samples[i + 1u];
+    const double h = _sample_step;
+    const double r = dist / h - static_cast<double>(i);
+    const double r2 = r * r;
+    const double r3 = r2 * r;
+    const double h00 = 2.0 * r3 - 3.0 * r2 + 1.0;
+    const double h10 = r3 - 2.0 * r2 + r;
+    const double h01 = -2.0 * r3 + 3.0 * r2;
+    const double h11 = r3 - r2;
+    const double x = h00 * p0.x + h10 * h * std::cos(p0.t) + h01 * p1.x + h11 * h * std::cos(p1.t);
+    const double y = h00 * p0.y + h10 * h * std::sin(p0.t) + h01 * p1.y + h11 * h * std::sin(p1.t);
+
+    DirectedPoint p(_start_position, _heading);
+    p.location.x += static_cast<float>(x);
+    p.location.y += static_cast<float>(y);
+    // 螺旋线的曲率随弧长线性变化，切线角是弧长的二次函数，可以直接精确计算
+    const double curve_dot = (_curve_end - _curve_start) / _length;
+    p.tangent = _heading + _curve_start * dist + 0.5 * curve_dot * dist * dist;
+    return p;
+}
+
 // 函数：GeometrySpiral类的成员函数，计算到给定位置的距离（未完全实现）
 // location: 给定的位置
 std::pair<float, float> GeometrySpiral::DistanceTo(const geom::Location &location) const {
@@ -175,16 +232,26 @@ std::pair<float, float> GeometrySpiral::DistanceTo(const geom::Location &locatio
     return {location.x - _start_position.x, location.y - _start_position.y};
 }
 
+// 在按s递增排列的采样点中二分查找包含 dist 的区间，返回区间起点的下标。
+// 超出范围时返回首尾的区间，与之前在R树中查找最近区间的结果相同。
+template <typename SampleT>
+static size_t FindSampleInterval(const std::vector<SampleT> &samples, double dist) {
+    DEBUG_ASSERT(samples.size() >= 2u);
+    auto it = std::upper_bound(
+        samples.begin() + 1, samples.end() - 1, dist,
+        [](double value, const SampleT &sample) { return value < sample.s; });
+    return static_cast<size_t>(it - samples.begin()) - 1u;
+}
+
 // 函数：GeometryPoly3类的成员函数，根据距离获取位置点
 // dist: 距离
 DirectedPoint GeometryPoly3::PosFromDist(double dist) const {
-    // 使用rtree获取最近邻元素
-    auto result = _rtree.GetNearestNeighbours(
-        Rtree::BPoint(static_cast<float>(dist))).front();
+    // 二分查找dist所在的区间
+    const size_t index = FindSampleInterval(_samples, dist);
 
-    // 获取最近邻元素中的两个值的引用
-    auto &val1 = result.second.first;
-    auto &val2 = result.second.second;
+    // 获取区间两端采样点的引用
+    auto &val1 = _samples[index];
+    auto &val2 = _samples[index + 1u];
 
     // 计算插值比例
     double rate = (val2.s - dist) / (val2.s - val1.s);
@@ -226,9 +293,8 @@ void GeometryPoly3::PreComputeSpline() {
     double last_u = 0;
     // 计算初始的v值
     double last_v = _poly.Evaluate(current_u);
-    double last_s = 0;
-    // 创建一个RtreeValue对象，存储上次的值
-    RtreeValue last_val{last_u, last_v, last_s, _poly.Tangent(current_u)};
+    // 存储第一个采样点
+    _samples.push_back(Sample{last_u, last_v, 0.0, _poly.Tangent(current_u)});
     // 循环，直到current_s大于_length加上delta_u
     while (current_s < _length + delta_u) {
         // 更新u值
@@ -245,20 +311,12 @@ void GeometryPoly3::PreComputeSpline() {
         current_s += ds;
         // 计算当前的切线值
         double current_t = _poly.Tangent(current_u);
-        // 创建一个当前的RtreeValue对象
-        RtreeValue current_val{current_u, current_v, current_s, current_t};
-
-        // 创建两个Rtree的点对象
-        Rtree::BPoint p1(static_cast<float>(last_s));
-        Rtree::BPoint p2(static_cast<float>(current_s));
-        // 在rtree中插入元素
-        _rtree.InsertElement(Rtree::BSegment(p1, p2), last_val, current_val);
+        // 存储当前的采样点
+        _samples.push_back(Sample{current_u, current_v, current_s, current_t});
 
         // 更新上次的值
         last_u = current_u;
         last_v = current_v;
-        last_s = current_s;
-        last_val = current_val;
 
     }
 }
@@ -266,13 +324,12 @@ void GeometryPoly3::PreComputeSpline() {
 // 函数：GeometryParamPoly3类的成员函数，根据距离获取位置点
 // dist: 距离
 DirectedPoint GeometryParamPoly3::PosFromDist(double dist) const {
-    // 使用rtree获取最近邻元素
-    auto result = _rtree.GetNearestNeighbours(
-        Rtree::BPoint(static_cast<float>(dist))).front();
+    // 二分查找dist所在的区间
+    const size_t index = FindSampleInterval(_samples, dist);
 
-    // 获取最近邻元素中的两个值的引用
-    auto &val1 = result.second.first;
-    auto &val2 = result.second.second;
+    // 获取区间两端采样点的引用
+    auto &val1 = _samples[index];
+    auto &val2 = _samples[index + 1u];
     // 计算插值比例
     double rate = (val2.s - dist) / (val2.s - val1.s);
     // 根据插值比例计算u值
@@ -322,14 +379,13 @@ void GeometryParamPoly3::PreComputeSpline() {
     double current_s = 0;
     double last_u = _polyU.Evaluate(param_p);
     double last_v = _polyV.Evaluate(param_p);
-    double last_s = 0;
-    // 创建一个RtreeValue对象，存储上次的值
-    RtreeValue last_val{
+    // 存储第一个采样点
+    _samples.push_back(Sample{
         last_u,
         last_v,
-        last_s,
+        0.0,
         _polyU.Tangent(param_p),
-        _polyV.Tangent(param_p) };
+        _polyV.Tangent(param_p)});
     // 循环number_intervals次
     for(size_t i = 0; i < number_intervals; ++i) {
         // 更新param_p
@@ -350,32 +406,18 @@ void GeometryParamPoly3::PreComputeSpline() {
         double current_t_u = _polyU.Tangent(param_p);
         // 计算当前的v方向切线值
         double current_t_v = _polyV.Tangent(param_p);
-        // 创建一个当前的RtreeValue对象
-        RtreeValue current_val{
+        // 存储当前的采样点
+        _samples.push_back(Sample{
             current_u,
             current_v,
             current_s,
             current_t_u,
-            current_t_v };
-
-       // 创建一个Rtree中的BPoint类型对象p1，将last_s转换为float类型后作为构造函数的参数
-      // BPoint可能是Rtree中表示点的数据结构，这里是使用last_s的值来初始化这个点
-       Rtree::BPoint p1(static_cast<float>(last_s));
-      // 创建一个Rtree中的BPoint类型对象p2，将current_s转换为float类型后作为构造函数的参数
-      // 同样，这里是使用current_s的值来初始化这个点
-       Rtree::BPoint p2(static_cast<float>(current_s));
-      // 调用_rtree对象的InsertElement函数，将由p1和p2组成的线段（BSegment）以及相关的值last_val和current_val插入到_rtree中
-     // 这里的_rtree可能是某种数据结构（例如空间索引结构），用于存储和管理这些元素
-      _rtree.InsertElement(Rtree::BSegment(p1, p2), last_val, current_val);
+            current_t_v});
 
      // 将当前的u值赋给last_u，用于记录上一次的u值，可能是为了后续的计算或者数据更新
       last_u = current_u;
      // 将当前的v值赋给last_v，用于记录上一次的v值
       last_v = current_v;
-    // 将当前的s值赋给last_s，用于记录上一次的s值
-      last_s = current_s;
-    // 将当前的val值赋给last_val，用于记录上一次的val值，这里的val可能是包含多个属性值的数据结构
-      last_val = current_val;
 
    // 如果当前的s值大于_length（这里_length可能是预先定义的某个长度限制或者阈值）
       if (current_s > _length) {
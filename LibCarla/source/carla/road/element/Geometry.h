@@ -12,8 +12,8 @@
 #include "carla/geom/Math.h"
 // 包含carla/geom/CubicPolynomial.h头文件
 #include "carla/geom/CubicPolynomial.h"
-// 包含carla/geom/Rtree.h头文件
-#include "carla/geom/Rtree.h"
+
+#include <vector>
 
 // 定义命名空间carla，在这个命名空间下包含road和其他相关的定义
 namespace carla {
@@ -217,7 +217,9 @@ namespace element {
      // 初始化本类中的_curve_start成员变量，将传入的curv_s赋值给它，表示曲线起始曲率
            _curve_start(curv_s),
      // 初始化本类中的_curve_end成员变量，将传入的curv_e赋值给它，表示曲线结束曲率
-           _curve_end(curv_e) {}
+           _curve_end(curv_e) {
+        PreComputeSpline();
+    }
 
         // 获取曲线起始曲率的函数
         double GetCurveStart() {
@@ -240,6 +242,21 @@ namespace element {
         double _curve_start;
         // 曲线结束曲率
         double _curve_end;
+
+        // 按弧长等间距的采样点，位置相对于起点，方向为切线角
+        struct Sample {
+            double x = 0;
+            double y = 0;
+            double t = 0;
+        };
+        std::vector<Sample> _samples;
+        // 相邻采样点之间的弧长
+        double _sample_step = 0;
+
+        // 用菲涅耳积分精确计算，只在预计算采样点时使用
+        DirectedPoint ComputePosFromDist(double dist) const;
+        // 预计算采样点，PosFromDist在相邻的两个采样点之间做三次Hermite插值
+        void PreComputeSpline();
     };
 
     // 定义表示三次多项式曲线的几何形状类，继承自Geometry类
@@ -314,20 +331,15 @@ namespace element {
         double _c;
         double _d;
 
-        // 定义用于R - tree的值结构体
-        struct RtreeValue {
+        // 预计算的采样点，按弧长s递增排列
+        struct Sample {
             double u = 0;
             double v = 0;
             double s = 0;
             double t = 0;
         };
-        // 定义R - tree类型
-        using Rtree = geom::SegmentCloudRtree<RtreeValue, 1>;
-        // 定义R - tree元素类型
-        using TreeElement = Rtree::TreeElement;
-        // R - tree对象
-        Rtree _rtree;
-        // 预计算样条函数，函数体未实现
+        std::vector<Sample> _samples;
+        // 预计算采样点，PosFromDist二分查找所在的区间并线性插值
         void PreComputeSpline();
     };
 
@@ -427,21 +439,16 @@ namespace element {
         // 是否为弧长相关的标志
         bool _arcLength;
 
-        // 定义用于R - tree的值结构体
-        struct RtreeValue {
+        // 预计算的采样点，按弧长s递增排列
+        struct Sample {
             double u = 0;
             double v = 0;
             double s = 0;
             double t_u = 0;
             double t_v = 0;
         };
-        // 定义R - tree类型
-        using Rtree = geom::SegmentCloudRtree<RtreeValue, 1>;
-        // 定义R - tree元素类型
-        using TreeElement = Rtree::TreeElement;
-        // R - tree对象
-        Rtree _rtree;
-        // 预计算样条函数，函数体未实现
+        std::vector<Sample> _samples;
+        // 预计算采样点，PosFromDist二分查找所在的区间并线性插值
         void PreComputeSpline();
     };
 
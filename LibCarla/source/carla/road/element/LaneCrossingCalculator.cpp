@@ -8,8 +8,12 @@
 #include "carla/road/element/LaneMarking.h" // 导入车道标记头文件
 
 #include "carla/geom/Location.h" // 导入位置相关头文件
+#include "carla/geom/Math.h"
 #include "carla/road/Map.h" // 导入地图相关头文件
 
+#include <cmath>
+#include <limits>
+
 namespace carla {
 namespace road {
 namespace element {
@@ -54,13 +58,50 @@ namespace element {
     return !map.GetWaypoint(location, FLAGS).has_value(); // 判断位置是否在路外
   }
 
-  std::vector<LaneMarking> LaneCrossingCalculator::Calculate(
-      const Map &map, // 地图引用
-      const geom::Location &origin, // 起始位置
-      const geom::Location &destination) { // 目标位置
-    auto w0 = map.GetClosestWaypointOnRoad(origin, FLAGS); // 获取起始位置的最近航路点
-    auto w1 = map.GetClosestWaypointOnRoad(destination, FLAGS); // 获取目标位置的最近航路点
+  /// 点离车道边界至少这么远（米）时，才认为它仍在同一条车道内。
+  static constexpr double LANE_BOUNDARY_MARGIN = 0.2;
+
+  /// 如果 @a location 在 @a waypoint 所在车道段的同一条车道内，并且离车道边界
+  /// 足够远，把 @a waypoint 移动到 @a location 的投影处并返回 true。
+  /// 只计算车道中心线上的变换，比在整个地图中查找最近的路点便宜得多。
+  static bool StaysInLane(const Map &map, Waypoint &waypoint, const geom::Location &location) {
+    const auto &lane = map.GetLane(waypoint);
+    const double s_min = lane.GetDistance();
+    const double s_max = lane.GetDistance() + lane.GetLength();
+    // 车道 id 为正时，车道的前向与 s 增加的方向相反
+    const double direction = waypoint.lane_id > 0 ? -1.0 : 1.0;
+
+    // 沿中心线把 s 移动到点的投影处，两次迭代足以修正曲率带来的误差
+    Waypoint projected = waypoint;
+    for (int i = 0; i < 2; ++i) {
+      const auto transform = map.ComputeTransform(projected);
+      const double along = geom::Math::Dot2D(location - transform.location, transform.GetForwardVector());
+      projected.s += direction * along;
+      if (projected.s <= s_min || projected.s >= s_max) {
+        return false;
+      }
+    }
 
+    const auto transform = map.ComputeTransform(projected);
+    const geom::Vector3D offset = location - transform.location;
+    // 剩余的纵向误差也计入，保证判断是保守的
+    const double along = std::abs(geom::Math::Dot2D(offset, transform.GetForwardVector()));
+    const double lateral = std::abs(geom::Math::Dot2D(offset, transform.GetRightVector()));
+    if (lateral + along + LANE_BOUNDARY_MARGIN >= 0.5 * map.GetLaneWidth(projected)) {
+      return false;
+    }
+    waypoint = projected;
+    return true;
+  }
+
+  static std::vector<LaneMarking> CalculateFromWaypoints(
+      const Map &map,
+      const geom::Location &origin,
+      const geom::Location &destination,
+      const boost::optional<Waypoint> &w0,
+      const boost::optional<Waypoint> &w1,
+      const bool w0_is_offroad,
+      const bool w1_is_offroad) {
     if (!w0.has_value() || !w1.has_value()) { // 如果任一航路点无效
       return {}; // 返回空向量
     }
@@ -74,9 +115,6 @@ namespace element {
       return {}; // 返回空向量
     }
 
-    const auto w0_is_offroad = IsOffRoad(map, origin); // 检查起始位置是否在路外
-    const auto w1_is_offroad = IsOffRoad(map, destination); // 检查目标位置是否在路外
-
     if (w0_is_offroad && w1_is_offroad) { // 如果两者都在路外
       // outside the road
       return {}; // 返回空向量
@@ -103,6 +141,60 @@ namespace element {
         dest_is_at_right);
   }
 
+  std::vector<LaneMarking> LaneCrossingCalculator::Calculate(
+      const Map &map, // 地图引用
+      const geom::Location &origin, // 起始位置
+      const geom::Location &destination) { // 目标位置
+    const auto w0 = map.GetClosestWaypointOnRoad(origin, FLAGS); // 获取起始位置的最近航路点
+    const auto w1 = map.GetClosestWaypointOnRoad(destination, FLAGS); // 获取目标位置的最近航路点
+    if (!w0.has_value() || !w1.has_value()) {
+      return {};
+    }
+    return CalculateFromWaypoints(
+        map,
+        origin,
+        destination,
+        w0,
+        w1,
+        IsOffRoad(map, origin), // 检查起始位置是否在路外
+        IsOffRoad(map, destination)); // 检查目标位置是否在路外
+  }
+
+  std::vector<LaneMarking> LaneCrossingCalculator::Calculate(
+      const Map &map,
+      LaneCrossingContext &context,
+      const geom::Location &destination) {
+    const auto origin = context.location;
+    const bool has_origin = context.is_valid;
+    context.location = destination;
+    context.is_valid = true;
+
+    // 仍在同一条车道内时不会跨越任何车道标记
+    if (has_origin &&
+        !context.is_offroad &&
+        context.waypoint.has_value() &&
+        StaysInLane(map, *context.waypoint, destination)) {
+      return {};
+    }
+
+    auto w1 = map.GetClosestWaypointOnRoad(destination, FLAGS);
+    const bool w1_is_offroad = IsOffRoad(map, destination);
+    std::vector<LaneMarking> result;
+    if (has_origin) {
+      result = CalculateFromWaypoints(
+          map,
+          origin,
+          destination,
+          context.waypoint,
+          w1,
+          context.is_offroad,
+          w1_is_offroad);
+    }
+    context.waypoint = std::move(w1);
+    context.is_offroad = w1_is_offroad;
+    return result;
+  }
+
 } // namespace element
 } // namespace road
 } // namespace carla
@@ -6,18 +6,35 @@
 
 #pragma once // 指示编译器只包含一次这个头文件，防止重复包含
 
+#include "carla/geom/Location.h" // Location类用于表示二维或三维空间中的一个点。
 #include "carla/road/element/LaneMarking.h" // 包含LaneMarking类的定义,这个类包含了车道标记的相关信息。
+#include "carla/road/element/Waypoint.h"
+
+#include <boost/optional.hpp>
 
 #include <vector> // 包含标准模板库中的vector容器，这是一个动态数组，用于存储可变长度的元素序列。
 
 namespace carla {
-namespace geom { class Location; } // Location类用于表示二维或三维空间中的一个点。
 namespace road {
 
   class Map; // Map类可能用于表示道路的地图信息，包括道路、车道、交通标志等。
 
 namespace element { // element命名空间用于封装与道路元素相关的类和函数。
 
+  /// 连续跟踪同一个点（例如车辆包围盒的一个角）时缓存的车道信息。
+  /// 点仍在上一次所在车道段的同一条车道内、并且离车道边界足够远时，
+  /// 不需要再在地图中查找最近的路点。
+  struct LaneCrossingContext {
+    /// 上一次的位置。
+    geom::Location location;
+    /// 上一次位置最近的路点，没有时为空。
+    boost::optional<Waypoint> waypoint;
+    /// 上一次的位置是否在道路外。
+    bool is_offroad = true;
+    /// 是否已经有上一次的位置。
+    bool is_valid = false;
+  };
+
   class LaneCrossingCalculator { // LaneCrossingCalculator类是一个用于计算车道穿越的静态工具类。
   public:
 
@@ -25,6 +42,15 @@ namespace element { // element命名空间用于封装与道路元素相关的
         const Map &map, // 地图对象的引用
         const geom::Location &origin,  // 起点位置
         const geom::Location &destination);  // 终点位置
+
+    /// 计算从 @a context 中上一次的位置到 @a destination 跨越的车道标记，
+    /// 并把 @a destination 记录到 @a context 中。第一次调用只记录位置，返回空。
+    /// 除了车道相互重叠的路口内会保持原来的车道外，结果与
+    /// Calculate(map, context.location, destination) 相同。
+    static std::vector<LaneMarking> Calculate(
+        const Map &map,
+        LaneCrossingContext &context,
+        const geom::Location &destination);
   };
 
 } // namespace element
@@ -70,11 +70,24 @@ enum ESensors { // 定义传感器枚举
   CameraGBufferFloat // 相机G缓冲区（浮点数）
 };
 
+// 发布队列的工作线程数和最多等待的任务数
+static const size_t PUBLISH_WORKERS = 2u;
+static const size_t PUBLISH_QUEUE_CAPACITY = 64u;
+
 void ROS2::Enable(bool enable) { // 启用或禁用ROS2
   _enabled = enable; // 设置启用状态
   log_info("ROS2 enabled: ", _enabled); // 记录启用状态
+  if (_enabled) {
+    // 传感器数据在工作线程中发布，不再阻塞产生数据的线程
+    _publish_queue.Start(PUBLISH_WORKERS, PUBLISH_QUEUE_CAPACITY);
+  }
   _clock_publisher = std::make_shared<CarlaClockPublisher>("clock", ""); // 创建时钟发布者
   _clock_publisher->Init(); // 初始化时钟发布者
+  // 所有传感器的变换合并到这个发布者，不再为每个传感器创建域参与者
+  _tf_publisher = std::make_shared<CarlaTransformPublisher>("tf", "");
+  if (!_tf_publisher->Init()) {
+    _tf_publisher.reset();
+  }
 }
 
 void ROS2::SetFrame(uint64_t frame) { // 设置帧
@@ -104,6 +117,7 @@ void ROS2::SetTimestamp(double timestamp) { // 设置时间戳
   _nanoseconds = static_cast<uint32_t>(fractional * multiplier); // 更新纳秒数
   _clock_publisher->SetData(_seconds, _nanoseconds); // 设置时钟数据
   _clock_publisher->Publish(); // 发布时钟数据
+  PublishTransforms(); // 发布上一帧的变换
    //log_info("ROS2 new timestamp: ", _timestamp); // 记录新时间戳
 }
 
@@ -123,6 +137,7 @@ void ROS2::AddActorParentRosName(void *actor, void* parent) { // 添加操作者
 void ROS2::RemoveActorRosName(void *actor) { // 移除操作者的ROS名称
   _actor_ros_name.erase(actor); // 移除ROS名称
   _actor_parent_ros_name.erase(actor); // 移除父ROS名称
+  _actor_ros_qos.erase(actor); // 移除传输和QoS
 
   _publishers.erase(actor); // 移除发布者
   _transforms.erase(actor); // 移除变换数据
@@ -144,6 +159,19 @@ std::string ROS2::GetActorRosName(void *actor) { // 获取操作者的ROS名称
   }
 }
 
+void ROS2::AddActorRosQos(void *actor, ROS2QosProfile qos) { // 设置操作者的传输和QoS
+  _actor_ros_qos[actor] = qos;
+}
+
+ROS2QosProfile ROS2::GetActorRosQos(void *actor) { // 获取操作者的传输和QoS
+  auto it = _actor_ros_qos.find(actor);
+  if (it != _actor_ros_qos.end()) {
+    return it->second;
+  } else {
+    return ROS2QosProfile(); // 没有设置时使用 Fast-DDS 的默认值
+  }
+}
+
 std::string ROS2::GetActorParentRosName(void *actor) {
   auto it = _actor_parent_ros_name.find(actor);// 查找操作者的父节点ROS名称
   if (it != _actor_parent_ros_name.end())
@@ -199,6 +227,9 @@ std::pair<std::shared_ptr<CarlaPublisher>, std::shared_ptr<CarlaTransformPublish
     const std::string string_id = std::to_string(id);// 将ID转换为字符串
     std::string ros_name = GetActorRosName(actor);// 获取操作者的ROS名称
     std::string parent_ros_name = GetActorParentRosName(actor);// 获取操作者的父节点ROS名称
+    // "auto" 时碰撞和压线事件使用可靠的 QoS，其它传感器数据使用尽力而为、只保留最新样本
+    const bool sensor_data = (type != ESensors::CollisionSensor && type != ESensors::LaneInvasionSensor);
+    const ROS2QosProfile qos = GetActorRosQos(actor).Resolve(sensor_data);
     switch(type) {
       case ESensors::CollisionSensor: {// 碰撞传感器
         if (ros_name == "collision__") {
@@ -208,15 +239,14 @@ std::pair<std::shared_ptr<CarlaPublisher>, std::shared_ptr<CarlaTransformPublish
           UpdateActorRosName(actor, ros_name);// 更新操作者的ROS名称
         }
         std::shared_ptr<CarlaCollisionPublisher> new_publisher = std::make_shared<CarlaCollisionPublisher>(ros_name.c_str(), parent_ros_name.c_str());// 创建新的碰撞发布者
+        new_publisher->qos(qos);
         if (new_publisher->Init()) {// 初始化发布者
           _publishers.insert({actor, new_publisher});// 插入到发布者列表
           publisher = new_publisher; // 设置当前发布者
         }
         std::shared_ptr<CarlaTransformPublisher> new_transform = std::make_shared<CarlaTransformPublisher>(ros_name.c_str(), parent_ros_name.c_str());// 创建新的变换发布者
-        if (new_transform->Init()) {// 初始化变换发布者
-          _transforms.insert({actor, new_transform});// 插入到变换发布者列表
-          transform = new_transform;// 设置当前变换发布者
-        }
+        _transforms.insert({actor, new_transform});// 插入到变换发布者列表
+        transform = new_transform;// 设置当前变换发布者
       } break;
       case ESensors::DepthCamera: {// 深度相机
         if (ros_name == "depth__") {
@@ -227,15 +257,14 @@ std::pair<std::shared_ptr<CarlaPublisher>, std::shared_ptr<CarlaTransformPublish
         }
         std::shared_ptr<CarlaDepthCameraPublisher> new_publisher = std::make_shared<CarlaDepthCameraPublisher>(ros_name.c_str(),
 parent_ros_name.c_str());// 创建新的深度相机发布者
+        new_publisher->qos(qos);
         if (new_publisher->Init()) {// 初始化发布者
           _publishers.insert({actor, new_publisher});// 插入到发布者列表
           publisher = new_publisher;// 设置当前发布者
         }
         std::shared_ptr<CarlaTransformPublisher> new_transform = std::make_shared<CarlaTransformPublisher>(ros_name.c_str(), parent_ros_name.c_str());// 创建新的变换发布者
-        if (new_transform->Init()) {// 初始化变换发布者
-          _transforms.insert({actor, new_transform});// 插入到变换发布者列表
-          transform = new_transform; // 设置当前变换发布者
-        }
+        _transforms.insert({actor, new_transform});// 插入到变换发布者列表
+        transform = new_transform; // 设置当前变换发布者
       } break;
       case ESensors::NormalsCamera: { // 法线相机
         if (ros_name == "normals__") {
@@ -245,15 +274,14 @@ parent_ros_name.c_str());// 创建新的深度相机发布者
           UpdateActorRosName(actor, ros_name);// 更新操作者的ROS名称
         }
         std::shared_ptr<CarlaNormalsCameraPublisher> new_publisher = std::make_shared<CarlaNormalsCameraPublisher>(ros_name.c_str(), parent_ros_name.c_str());// 创建一个新的法线相机发布者
+        new_publisher->qos(qos);
         if (new_publisher->Init()) {// 初始化发布者
           _publishers.insert({actor, new_publisher});// 将发布者插入到发布者集合中
           publisher = new_publisher;// 更新当前发布者
         }
         std::shared_ptr<CarlaTransformPublisher> new_transform = std::make_shared<CarlaTransformPublisher>(ros_name.c_str(), parent_ros_name.c_str()); // 创建一个新的变换发布者
-        if (new_transform->Init()) {// 初始化变换发布者
-          _transforms.insert({actor, new_transform});// 将变换发布者插入到变换集合中
-          transform = new_transform;// 更新当前变换
-        }
+        _transforms.insert({actor, new_transform});// 将变换发布者插入到变换集合中
+        transform = new_transform;// 更新当前变换
       } break;
       case ESensors::DVSCamera: {// DVS相机的处理
         if (ros_name == "dvs__") {// 检查ROS名称是否为"dvs__"
@@ -263,15 +291,14 @@ parent_ros_name.c_str());// 创建新的深度相机发布者
           UpdateActorRosName(actor, ros_name);// 更新操作者的ROS名称
         }
         std::shared_ptr<CarlaDVSCameraPublisher> new_publisher = std::make_shared<CarlaDVSCameraPublisher>(ros_name.c_str(), parent_ros_name.c_str());// 创建新的DVS相机发布者
+        new_publisher->qos(qos);
         if (new_publisher->Init()) {// 初始化DVS发布者
           _publishers.insert({actor, new_publisher});// 将DVS发布者插入到发布者集合中
           publisher = new_publisher;// 更新当前发布者
         }
         std::shared_ptr<CarlaTransformPublisher> new_transform = std::make_shared<CarlaTransformPublisher>(ros_name.c_str(), parent_ros_name.c_str());// 创建新的变换发布者
-        if (new_transform->Init()) {// 初始化变换发布者
-          _transforms.insert({actor, new_transform});// 将变换发布者插入到变换集合中
-          transform = new_transform;// 更新当前变换
-        }
+        _transforms.insert({actor, new_transform});// 将变换发布者插入到变换集合中
+        transform = new_transform;// 更新当前变换
       } break;
       case ESensors::GnssSensor: {// GNSS传感器的处理
         if (ros_name == "gnss__") {// 检查ROS名称是否为"gnss__"
@@ -281,15 +308,14 @@ parent_ros_name.c_str());// 创建新的深度相机发布者
           UpdateActorRosName(actor, ros_name);// 更新操作者的ROS名称
         }
         std::shared_ptr<CarlaGNSSPublisher> new_publisher = std::make_shared<CarlaGNSSPublisher>(ros_name.c_str(), parent_ros_name.c_str()); // 创建新的GNSS发布者      
+        new_publisher->qos(qos);
         if (new_publisher->Init()) {// 初始化GNSS发布者
           _publishers.insert({actor, new_publisher});// 将GNSS发布者插入到发布者集合中
           publisher = new_publisher;// 更新当前发布者
         }
         std::shared_ptr<CarlaTransformPublisher> new_transform = std::make_shared<CarlaTransformPublisher>(ros_name.c_str(), parent_ros_name.c_str());// 创建新的变换发布者
-        if (new_transform->Init()) {// 初始化变换发布者
-          _transforms.insert({actor, new_transform});// 将变换发布者插入到变换集合中
-          transform = new_transform;// 更新当前变换
-        }
+        _transforms.insert({actor, new_transform});// 将变换发布者插入到变换集合中
+        transform = new_transform;// 更新当前变换
       } break;
       case ESensors::InertialMeasurementUnit: {// 惯性测量单元的处理
         if (ros_name == "imu__") {// 检查ROS名称是否为"imu__"
@@ -299,15 +325,14 @@ parent_ros_name.c_str());// 创建新的深度相机发布者
           UpdateActorRosName(actor, ros_name); // 更新操作者的ROS名称
         }
         std::shared_ptr<CarlaIMUPublisher> new_publisher = std::make_shared<CarlaIMUPublisher>(ros_name.c_str(), parent_ros_name.c_str());// 创建新的IMU发布者
+        new_publisher->qos(qos);
         if (new_publisher->Init()) {// 初始化IMU发布者
           _publishers.insert({actor, new_publisher});// 将IMU发布者插入到发布者集合中
           publisher = new_publisher;// 更新当前发布者
         }
         std::shared_ptr<CarlaTransformPublisher> new_transform = std::make_shared<CarlaTransformPublisher>(ros_name.c_str(), parent_ros_name.c_str());// 创建新的变换发布者
-        if (new_transform->Init()) {// 初始化变换发布者
-          _transforms.insert({actor, new_transform});// 将变换发布者插入到变换集合中
-          transform = new_transform;// 更新当前变换
-        }
+        _transforms.insert({actor, new_transform});// 将变换发布者插入到变换集合中
+        transform = new_transform;// 更新当前变换
       } break;
       case ESensors::LaneInvasionSensor: {// 车道侵入传感器的处理
         if (ros_name == "lane_invasion__") {// 检查ROS名称是否为"lane_invasion__"
@@ -317,15 +342,14 @@ parent_ros_name.c_str());// 创建新的深度相机发布者
           UpdateActorRosName(actor, ros_name);// 更新操作者的ROS名称
         }
         std::shared_ptr<CarlaLineInvasionPublisher> new_publisher = std::make_shared<CarlaLineInvasionPublisher>(ros_name.c_str(), parent_ros_name.c_str());// 创建新的压线发布者
+        new_publisher->qos(qos);
         if (new_publisher->Init()) {// 初始化压线发布者
           _publishers.insert({actor, new_publisher});// 将压线发布者插入到发布者集合中
           publisher = new_publisher;// 更新当前发布者
         }
         std::shared_ptr<CarlaTransformPublisher> new_transform = std::make_shared<CarlaTransformPublisher>(ros_name.c_str(), parent_ros_name.c_str());// 创建新的变换发布者
-        if (new_transform->Init()) {// 初始化变换发布者
-          _transforms.insert({actor, new_transform});// 将变换发布者插入到变换集合中
-          transform = new_transform;// 更新当前变换
-        }
+        _transforms.insert({actor, new_transform});// 将变换发布者插入到变换集合中
+        transform = new_transform;// 更新当前变换
       } break;
       case ESensors::ObstacleDetectionSensor: {// 遇到障碍物检测传感器
         std::cerr << "Obstacle detection sensor does not have an available publisher" << std::endl;// 遇到障碍物检测传感器没有可用的发布者
@@ -338,15 +362,14 @@ parent_ros_name.c_str());// 创建新的深度相机发布者
           UpdateActorRosName(actor, ros_name);// 更新操作者的ros名称
         }
         std::shared_ptr<CarlaOpticalFlowCameraPublisher> new_publisher = std::make_shared<CarlaOpticalFlowCameraPublisher>(ros_name.c_str(), parent_ros_name.c_str());// 创建新的光流相机发布者
+        new_publisher->qos(qos);
         if (new_publisher->Init()) {// 初始化发布者
           _publishers.insert({actor, new_publisher});// 将新发布者插入到发布者集合中
           publisher = new_publisher;// 更新当前发布者
         }
         std::shared_ptr<CarlaTransformPublisher> new_transform = std::make_shared<CarlaTransformPublisher>(ros_name.c_str(), parent_ros_name.c_str());// 创建新的变换发布者
-        if (new_transform->Init()) {// 初始化变换发布者
-          _transforms.insert({actor, new_transform});// 将新变换发布者插入到变换集合中
-          transform = new_transform;// 更新当前变换发布者
-        }
+        _transforms.insert({actor, new_transform});// 将新变换发布者插入到变换集合中
+        transform = new_transform;// 更新当前变换发布者
       } break;
       case ESensors::Radar: {// 雷达传感器
         if (ros_name == "radar__") {// 如果ros_name是雷达
@@ -356,15 +379,14 @@ parent_ros_name.c_str());// 创建新的深度相机发布者
           UpdateActorRosName(actor, ros_name);// 更新操作者的ros名称
         }
         std::shared_ptr<CarlaRadarPublisher> new_publisher = std::make_shared<CarlaRadarPublisher>(ros_name.c_str(), parent_ros_name.c_str());// 创建新的雷达发布者
+        new_publisher->qos(qos);
         if (new_publisher->Init()) {// 初始化发布者
           _publishers.insert({actor, new_publisher});// 将新发布者插入到发布者集合中
           publisher = new_publisher;// 更新当前发布者
         }
         std::shared_ptr<CarlaTransformPublisher> new_transform = std::make_shared<CarlaTransformPublisher>(ros_name.c_str(), parent_ros_name.c_str());// 创建新的变换发布者
-        if (new_transform->Init()) {// 初始化变换发布者
-          _transforms.insert({actor, new_transform});// 将新变换发布者插入到变换集合中
-          transform = new_transform;// 更新当前变换发布者
-        }
+        _transforms.insert({actor, new_transform});// 将新变换发布者插入到变换集合中
+        transform = new_transform;// 更新当前变换发布者
       } break;
       case ESensors::RayCastSemanticLidar: {// 射线投射语义激光雷达
         if (ros_name == "ray_cast_semantic__") { // 如果ros_name是射线投射语义
@@ -374,15 +396,14 @@ parent_ros_name.c_str());// 创建新的深度相机发布者
           UpdateActorRosName(actor, ros_name);// 更新操作者的ros名称
         }
         std::shared_ptr<CarlaSemanticLidarPublisher> new_publisher = std::make_shared<CarlaSemanticLidarPublisher>(ros_name.c_str(), parent_ros_name.c_str());// 创建新的语义激光雷达发布者
+        new_publisher->qos(qos);
         if (new_publisher->Init()) {// 初始化发布者
           _publishers.insert({actor, new_publisher});// 将新发布者插入到发布者集合中
           publisher = new_publisher;// 更新当前发布者
         }
         std::shared_ptr<CarlaTransformPublisher> new_transform = std::make_shared<CarlaTransformPublisher>(ros_name.c_str(), parent_ros_name.c_str());// 创建新的变换发布者
-        if (new_transform->Init()) {// 初始化变换发布者
-          _transforms.insert({actor, new_transform});// 将新变换发布者插入到变换集合中
-          transform = new_transform;// 更新当前变换发布者
-        }
+        _transforms.insert({actor, new_transform});// 将新变换发布者插入到变换集合中
+        transform = new_transform;// 更新当前变换发布者
       } break;
       case ESensors::RayCastLidar: {// 射线投射激光雷达
         if (ros_name == "ray_cast__") {// 如果ros_name是射线投射
@@ -392,15 +413,14 @@ parent_ros_name.c_str());// 创建新的深度相机发布者
           UpdateActorRosName(actor, ros_name);// 更新操作者的ros名称
         }
         std::shared_ptr<CarlaLidarPublisher> new_publisher = std::make_shared<CarlaLidarPublisher>(ros_name.c_str(), parent_ros_name.c_str());// 创建新的激光雷达发布者
+        new_publisher->qos(qos);
         if (new_publisher->Init()) {// 初始化发布者
           _publishers.insert({actor, new_publisher});// 将新发布者插入到发布者集合中
           publisher = new_publisher;// 更新当前发布者
         }
         std::shared_ptr<CarlaTransformPublisher> new_transform = std::make_shared<CarlaTransformPublisher>(ros_name.c_str(), parent_ros_name.c_str());// 创建新的变换发布者
-        if (new_transform->Init()) {// 初始化变换发布者
-          _transforms.insert({actor, new_transform});// 将新变换发布者插入到变换集合中
-          transform = new_transform;// 更新当前变换发布者
-        }
+        _transforms.insert({actor, new_transform});// 将新变换发布者插入到变换集合中
+        transform = new_transform;// 更新当前变换发布者
       } break;
       case ESensors::RssSensor: {// RSS传感器
         std::cerr << "RSS sensor does not have an available publisher" << std::endl;// RSS传感器没有可用的发布者
@@ -413,15 +433,14 @@ parent_ros_name.c_str());// 创建新的深度相机发布者
           UpdateActorRosName(actor, ros_name);// 更新操作者的ros名称
         }
         std::shared_ptr<CarlaRGBCameraPublisher> new_publisher = std::make_shared<CarlaRGBCameraPublisher>(ros_name.c_str(), parent_ros_name.c_str());// 创建新的RGB相机发布者
+        new_publisher->qos(qos);
         if (new_publisher->Init()) { // 初始化发布者
           _publishers.insert({actor, new_publisher});// 将新发布者插入到发布者集合中
           publisher = new_publisher; // 更新当前发布者
         }
         std::shared_ptr<CarlaTransformPublisher> new_transform = std::make_shared<CarlaTransformPublisher>(ros_name.c_str(), parent_ros_name.c_str());// 创建新的变换发布者
-        if (new_transform->Init()) { // 初始化变换发布者
-          _transforms.insert({actor, new_transform});// 将新变换发布者插入到变换集合中
-          transform = new_transform; // 更新当前变换发布者
-        }
+        _transforms.insert({actor, new_transform});// 将新变换发布者插入到变换集合中
+        transform = new_transform; // 更新当前变换发布者
       } break;
       case ESensors::SemanticSegmentationCamera: {// 如果传感器是语义分割相机
         if (ros_name == "semantic_segmentation__") {// 检查ROS名称是否为语义分割相机
@@ -431,15 +450,14 @@ parent_ros_name.c_str());// 创建新的深度相机发布者
           UpdateActorRosName(actor, ros_name);// 更新操作者的ROS名称
         }
         std::shared_ptr<CarlaSSCameraPublisher> new_publisher = std::make_shared<CarlaSSCameraPublisher>(ros_name.c_str(), parent_ros_name.c_str()); // 创建新的语义分割相机发布者
+        new_publisher->qos(qos);
         if (new_publisher->Init()) {// 初始化发布者
           _publishers.insert({actor, new_publisher});// 将新发布者插入到发布者集合中
           publisher = new_publisher; // 更新当前发布者
         }
         std::shared_ptr<CarlaTransformPublisher> new_transform = std::make_shared<CarlaTransformPublisher>(ros_name.c_str(), parent_ros_name.c_str());// 创建新的变换发布者
-        if (new_transform->Init()) {// 初始化变换发布者
-          _transforms.insert({actor, new_transform});// 将新变换发布者插入到变换集合中
-          transform = new_transform;// 更新当前变换发布者
-        }
+        _transforms.insert({actor, new_transform});// 将新变换发布者插入到变换集合中
+        transform = new_transform;// 更新当前变换发布者
       } break;
       case ESensors::InstanceSegmentationCamera: {// 如果传感器是实例分割相机
         if (ros_name == "instance_segmentation__") {// 检查ROS名称是否为实例分割相机
@@ -449,15 +467,14 @@ parent_ros_name.c_str());// 创建新的深度相机发布者
           UpdateActorRosName(actor, ros_name); // 更新操作者的ROS名称
         }
         std::shared_ptr<CarlaISCameraPublisher> new_publisher = std::make_shared<CarlaISCameraPublisher>(ros_name.c_str(), parent_ros_name.c_str());// 创建新的实例分割相机发布者
+        new_publisher->qos(qos);
         if (new_publisher->Init()) {// 初始化发布者
           _publishers.insert({actor, new_publisher});// 将新发布者插入到发布者集合中
           publisher = new_publisher;// 更新当前发布者
         }
         std::shared_ptr<CarlaTransformPublisher> new_transform = std::make_shared<CarlaTransformPublisher>(ros_name.c_str(), parent_ros_name.c_str());// 创建新的变换发布者
-        if (new_transform->Init()) {// 初始化变换发布者
-          _transforms.insert({actor, new_transform});// 将新变换发布者插入到变换集合中
-          transform = new_transform; // 更新当前变换发布者
-        }
+        _transforms.insert({actor, new_transform});// 将新变换发布者插入到变换集合中
+        transform = new_transform; // 更新当前变换发布者
       } break;
       case ESensors::WorldObserver: {// 如果传感器是世界观察者
         std::cerr << "World obserser does not have an available publisher" << std::endl;// 输出错误信息：世界观察者没有可用的发布者
@@ -483,6 +500,8 @@ void ROS2::ProcessDataFromCamera(
     int W, int H, float Fov, // 宽度、高度、视场角
     const carla::SharedBufferView buffer,// 数据缓冲区
     void *actor) { // 操作者
+  const int32_t seconds = _seconds; // 发布任务使用调用时的时间戳
+  const uint32_t nanoseconds = _nanoseconds;
 
   switch (sensor_type) { // 根据传感器类型进行处理
     case ESensors::CollisionSensor:// 碰撞传感器
@@ -500,14 +519,15 @@ void ROS2::ProcessDataFromCamera(
             return;// 返回
           if (!publisher->HasBeenInitialized())// 如果发布者未初始化
             publisher->InitInfoData(0, 0, H, W, Fov, true); // 初始化信息数据
-          publisher->SetImageData(_seconds, _nanoseconds, header->height, header->width, (const uint8_t*) (buffer->data() + carla::sensor::s11n::ImageSerializer::header_offset));// 设置图像数据
-          publisher->SetCameraInfoData(_seconds, _nanoseconds);// 设置相机信息数据
-          publisher->Publish();// 发布数据
+          _publish_queue.Push(*publisher, true, [=]() {
+            publisher->SetImageData(seconds, nanoseconds, header->height, header->width, (const uint8_t*) (buffer->data() + carla::sensor::s11n::ImageSerializer::header_offset));// 设置图像数据
+            publisher->SetCameraInfoData(seconds, nanoseconds);// 设置相机信息数据
+            publisher->Publish();// 发布数据
+          });
         }
         if (sensors.second) {// 如果存在第二个传感器
           std::shared_ptr<CarlaTransformPublisher> publisher = std::dynamic_pointer_cast<CarlaTransformPublisher>(sensors.second); // 转换为变换发布者
-          publisher->SetData(_seconds, _nanoseconds, (const float*)&sensor_transform.location, (const float*)&sensor_transform.rotation);// 设置位置信息和旋转信息
-          publisher->Publish();// 发布数据
+          QueueTransform(publisher, seconds, nanoseconds, sensor_transform); // 在下一帧与其它变换一起发布
         }
       }
       break;
@@ -523,14 +543,15 @@ void ROS2::ProcessDataFromCamera(
             return;// 返回
           if (!publisher->HasBeenInitialized())// 如果发布者未初始化
             publisher->InitInfoData(0, 0, H, W, Fov, true);// 初始化信息数据
-          publisher->SetImageData(_seconds, _nanoseconds, header->height, header->width, (const uint8_t*) (buffer->data() + carla::sensor::s11n::ImageSerializer::header_offset));// 设置图像数据
-          publisher->SetCameraInfoData(_seconds, _nanoseconds);// 设置相机信息数据
-          publisher->Publish();// 发布数据
+          _publish_queue.Push(*publisher, true, [=]() {
+            publisher->SetImageData(seconds, nanoseconds, header->height, header->width, (const uint8_t*) (buffer->data() + carla::sensor::s11n::ImageSerializer::header_offset));// 设置图像数据
+            publisher->SetCameraInfoData(seconds, nanoseconds);// 设置相机信息数据
+            publisher->Publish();// 发布数据
+          });
         }
         if (sensors.second) {// 如果存在第二个传感器
           std::shared_ptr<CarlaTransformPublisher> publisher = std::dynamic_pointer_cast<CarlaTransformPublisher>(sensors.second); // 转换为变换发布者
-          publisher->SetData(_seconds, _nanoseconds, (const float*)&sensor_transform.location, (const float*)&sensor_transform.rotation);// 设置位置信息和旋转信息
-          publisher->Publish(); // 发布数据
+          QueueTransform(publisher, seconds, nanoseconds, sensor_transform); // 在下一帧与其它变换一起发布
         }
       }
       break;
@@ -540,13 +561,14 @@ void ROS2::ProcessDataFromCamera(
         auto sensors = GetOrCreateSensor(ESensors::LaneInvasionSensor, stream_id, actor);// 获取或创建压线传感器
         if (sensors.first) {// 如果第一个传感器存在
           std::shared_ptr<CarlaLineInvasionPublisher> publisher = std::dynamic_pointer_cast<CarlaLineInvasionPublisher>(sensors.first); // 转换为压线发布者
-          publisher->SetData(_seconds, _nanoseconds, (const int32_t*) buffer->data());// 设置数据
-          publisher->Publish();// 发布数据
+          _publish_queue.Push(*publisher, false, [=]() {
+            publisher->SetData(seconds, nanoseconds, (const int32_t*) buffer->data());// 设置数据
+            publisher->Publish();// 发布数据
+          });
         }
         if (sensors.second) {// 如果第二个传感器存在
           std::shared_ptr<CarlaTransformPublisher> publisher = std::dynamic_pointer_cast<CarlaTransformPublisher>(sensors.second);// 转换为变换发布者
-          publisher->SetData(_seconds, _nanoseconds, (const float*)&sensor_transform.location, (const float*)&sensor_transform.rotation);// 设置位置信息和旋转信息
-          publisher->Publish();// 发布数据
+          QueueTransform(publisher, seconds, nanoseconds, sensor_transform); // 在下一帧与其它变换一起发布
         }
       }
       break;
@@ -562,14 +584,24 @@ void ROS2::ProcessDataFromCamera(
             return;
           if (!publisher->HasBeenInitialized())// 如果发布者尚未初始化
             publisher->InitInfoData(0, 0, H, W, Fov, true);// 初始化信息数据
-          publisher->SetImageData(_seconds, _nanoseconds, header->height, header->width, (const float*) (buffer->data() + carla::sensor::s11n::OpticalFlowImageSerializer::header_offset));// 设置图像数据
-          publisher->SetCameraInfoData(_seconds, _nanoseconds);
-          publisher->Publish();// 发布数据
+          _publish_queue.Push(*publisher, true, [=]() {
+            using Serializer = carla::sensor::s11n::OpticalFlowImageSerializer;
+            const float *flow = (const float*) (buffer->data() + Serializer::header_offset);
+            // 半精度格式先解码为32位浮点数
+            std::vector<float> decoded;
+            if (Serializer::IsHalfPrecision(*header, buffer->size() - Serializer::header_offset)) {
+              decoded.resize(2u * size_t(header->width) * header->height);
+              Serializer::DecodeHalfPrecision(buffer->data() + Serializer::header_offset, decoded.size(), decoded.data());
+              flow = decoded.data();
+            }
+            publisher->SetImageData(seconds, nanoseconds, header->height, header->width, flow);// 设置图像数据
+            publisher->SetCameraInfoData(seconds, nanoseconds);
+            publisher->Publish();// 发布数据
+          });
         }
         if (sensors.second) {// 如果第二个传感器存在
           std::shared_ptr<CarlaTransformPublisher> publisher = std::dynamic_pointer_cast<CarlaTransformPublisher>(sensors.second);// 转换为变换发布者
-          publisher->SetData(_seconds, _nanoseconds, (const float*)&sensor_transform.location, (const float*)&sensor_transform.rotation);// 设置位置信息和旋转信息
-          publisher->Publish();// 发布数据
+          QueueTransform(publisher, seconds, nanoseconds, sensor_transform); // 在下一帧与其它变换一起发布
         }
       }
       break;
@@ -589,14 +621,15 @@ void ROS2::ProcessDataFromCamera(
             return;
           if (!publisher->HasBeenInitialized())// 如果发布者尚未初始化
             publisher->InitInfoData(0, 0, H, W, Fov, true);// 初始化信息数据
-          publisher->SetImageData(_seconds, _nanoseconds, header->height, header->width, (const uint8_t*) (buffer->data() + carla::sensor::s11n::ImageSerializer::header_offset));// 设置图像数据
-          publisher->SetCameraInfoData(_seconds, _nanoseconds);
-          publisher->Publish();// 发布数据
+          _publish_queue.Push(*publisher, true, [=]() {
+            publisher->SetImageData(seconds, nanoseconds, header->height, header->width, (const uint8_t*) (buffer->data() + carla::sensor::s11n::ImageSerializer::header_offset));// 设置图像数据
+            publisher->SetCameraInfoData(seconds, nanoseconds);
+            publisher->Publish();// 发布数据
+          });
         }
         if (sensors.second) {// 如果第二个传感器存在
           std::shared_ptr<CarlaTransformPublisher> publisher = std::dynamic_pointer_cast<CarlaTransformPublisher>(sensors.second);// 转换为变换发布者
-          publisher->SetData(_seconds, _nanoseconds, (const float*)&sensor_transform.location, (const float*)&sensor_transform.rotation); // 设置位置信息和旋转信息
-          publisher->Publish();// 发布数据
+          QueueTransform(publisher, seconds, nanoseconds, sensor_transform); // 在下一帧与其它变换一起发布
         }
       }
       break;
@@ -613,14 +646,15 @@ void ROS2::ProcessDataFromCamera(
             return;// 返回
           if (!publisher->HasBeenInitialized())// 如果发布者尚未初始化
             publisher->InitInfoData(0, 0, H, W, Fov, true);// 初始化信息数据
-          publisher->SetImageData(_seconds, _nanoseconds, header->height, header->width, (const uint8_t*) (buffer->data() + carla::sensor::s11n::ImageSerializer::header_offset));// 设置图像数据
-          publisher->SetCameraInfoData(_seconds, _nanoseconds); // 设置相机信息数据
-          publisher->Publish();// 发布数据
+          _publish_queue.Push(*publisher, true, [=]() {
+            publisher->SetImageData(seconds, nanoseconds, header->height, header->width, (const uint8_t*) (buffer->data() + carla::sensor::s11n::ImageSerializer::header_offset));// 设置图像数据
+            publisher->SetCameraInfoData(seconds, nanoseconds); // 设置相机信息数据
+            publisher->Publish();// 发布数据
+          });
         }
         if (sensors.second) {// 如果第二个传感器存在
           std::shared_ptr<CarlaTransformPublisher> publisher = std::dynamic_pointer_cast<CarlaTransformPublisher>(sensors.second);// 转换为变换发布者
-          publisher->SetData(_seconds, _nanoseconds, (const float*)&sensor_transform.location, (const float*)&sensor_transform.rotation);// 设置位置信息和旋转信息
-          publisher->Publish();// 发布数据
+          QueueTransform(publisher, seconds, nanoseconds, sensor_transform); // 在下一帧与其它变换一起发布
         }
       }
       break;// 结束该case
@@ -636,14 +670,15 @@ void ROS2::ProcessDataFromCamera(
             return;// 返回
           if (!publisher->HasBeenInitialized())// 如果发布者尚未初始化
             publisher->InitInfoData(0, 0, H, W, Fov, true);// 初始化信息数据
-          publisher->SetImageData(_seconds, _nanoseconds, header->height, header->width, (const uint8_t*) (buffer->data() + carla::sensor::s11n::ImageSerializer::header_offset));// 设置图像数据
-          publisher->SetCameraInfoData(_seconds, _nanoseconds);// 设置相机信息数据
-          publisher->Publish();// 发布数据
+          _publish_queue.Push(*publisher, true, [=]() {
+            publisher->SetImageData(seconds, nanoseconds, header->height, header->width, (const uint8_t*) (buffer->data() + carla::sensor::s11n::ImageSerializer::header_offset));// 设置图像数据
+            publisher->SetCameraInfoData(seconds, nanoseconds);// 设置相机信息数据
+            publisher->Publish();// 发布数据
+          });
         }
         if (sensors.second) { // 如果第二个传感器存在
           std::shared_ptr<CarlaTransformPublisher> publisher = std::dynamic_pointer_cast<CarlaTransformPublisher>(sensors.second);// 转换为变换发布者
-          publisher->SetData(_seconds, _nanoseconds, (const float*)&sensor_transform.location, (const float*)&sensor_transform.rotation);// 设置位置信息和旋转信息
-          publisher->Publish();// 发布数据
+          QueueTransform(publisher, seconds, nanoseconds, sensor_transform); // 在下一帧与其它变换一起发布
         }
       }
       break;// 结束该case
@@ -667,17 +702,20 @@ void ROS2::ProcessDataFromGNSS(
     const carla::geom::Transform sensor_transform,// 传感器变换
     const carla::geom::GeoLocation &data, // 地理位置数据
     void *actor) {// 操作者
+  const int32_t seconds = _seconds; // 发布任务使用调用时的时间戳
+  const uint32_t nanoseconds = _nanoseconds;
   log_info("Sensor GnssSensor to ROS data: frame.", _frame, "sensor.", sensor_type, "stream.", stream_id, "geo.", data.latitude, data.longitude, data.altitude);// 记录GNSS传感器数据
   auto sensors = GetOrCreateSensor(ESensors::GnssSensor, stream_id, actor);// 获取或创建传感器
   if (sensors.first) { // 如果存在第一个传感器
     std::shared_ptr<CarlaGNSSPublisher> publisher = std::dynamic_pointer_cast<CarlaGNSSPublisher>(sensors.first); // 将传感器转换为GNSS发布者
-    publisher->SetData(_seconds, _nanoseconds, reinterpret_cast<const double*>(&data)); // 设置数据
-    publisher->Publish(); // 发布数据
+    _publish_queue.Push(*publisher, true, [=]() {
+      publisher->SetData(seconds, nanoseconds, reinterpret_cast<const double*>(&data)); // 设置数据
+      publisher->Publish(); // 发布数据
+    });
   }
   if (sensors.second) { // 如果存在第二个传感器
     std::shared_ptr<CarlaTransformPublisher> publisher = std::dynamic_pointer_cast<CarlaTransformPublisher>(sensors.second);// 将传感器转换为变换发布者
-    publisher->SetData(_seconds, _nanoseconds, (const float*)&sensor_transform.location, (const float*)&sensor_transform.rotation);// 设置变换数据
-    publisher->Publish();// 发布变换数据
+    QueueTransform(publisher, seconds, nanoseconds, sensor_transform); // 在下一帧与其它变换一起发布
   }
 }
 
@@ -689,17 +727,20 @@ void ROS2::ProcessDataFromIMU(
     carla::geom::Vector3D gyroscope,// 陀螺仪数据
     float compass, // 指南针数据
     void *actor) { // 操作者
+  const int32_t seconds = _seconds; // 发布任务使用调用时的时间戳
+  const uint32_t nanoseconds = _nanoseconds;
   log_info("Sensor InertialMeasurementUnit to ROS data: frame.", _frame, "sensor.", sensor_type, "stream.", stream_id, "imu.", accelerometer.x, gyroscope.x, compass);// 记录IMU传感器数据
   auto sensors = GetOrCreateSensor(ESensors::InertialMeasurementUnit, stream_id, actor);// 获取或创建传感器
   if (sensors.first) {// 如果存在第一个传感器
     std::shared_ptr<CarlaIMUPublisher> publisher = std::dynamic_pointer_cast<CarlaIMUPublisher>(sensors.first);// 将传感器转换为IMU发布者
-    publisher->SetData(_seconds, _nanoseconds, reinterpret_cast<float*>(&accelerometer), reinterpret_cast<float*>(&gyroscope), compass);// 设置数据
-    publisher->Publish(); // 发布数据
+    _publish_queue.Push(*publisher, true, [=]() {
+      publisher->SetData(seconds, nanoseconds, reinterpret_cast<float*>(&accelerometer), reinterpret_cast<float*>(&gyroscope), compass);// 设置数据
+      publisher->Publish(); // 发布数据
+    });
   }
   if (sensors.second) {// 如果存在第二个传感器
     std::shared_ptr<CarlaTransformPublisher> publisher = std::dynamic_pointer_cast<CarlaTransformPublisher>(sensors.second);// 将传感器转换为变换发布者
-    publisher->SetData(_seconds, _nanoseconds, (const float*)&sensor_transform.location, (const float*)&sensor_transform.rotation);// 设置变换数据
-    publisher->Publish();// 发布变换数据
+    QueueTransform(publisher, seconds, nanoseconds, sensor_transform); // 在下一帧与其它变换一起发布
   }
 }
 
@@ -710,6 +751,8 @@ void ROS2::ProcessDataFromDVS(
     const carla::SharedBufferView buffer,// 缓冲区视图
     int W, int H, float Fov, // 宽度、高度、视场角
     void *actor) { // 操作者
+  const int32_t seconds = _seconds; // 发布任务使用调用时的时间戳
+  const uint32_t nanoseconds = _nanoseconds;
   log_info("Sensor DVS to ROS data: frame.", _frame, "sensor.", sensor_type, "stream.", stream_id);// 记录DVS传感器数据
   auto sensors = GetOrCreateSensor(ESensors::DVSCamera, stream_id, actor);// 获取或创建传感器
   if (sensors.first) { // 如果存在第一个传感器
@@ -721,15 +764,16 @@ void ROS2::ProcessDataFromDVS(
     if (!publisher->HasBeenInitialized())  // 如果发布者尚未初始化
       publisher->InitInfoData(0, 0, H, W, Fov, true);// 初始化信息数据
     size_t elements = (buffer->size() - carla::sensor::s11n::ImageSerializer::header_offset) / sizeof(carla::sensor::data::DVSEvent);// 计算元素数量
-    publisher->SetImageData(_seconds, _nanoseconds, elements, header->height, header->width, (const uint8_t*) (buffer->data() + carla::sensor::s11n::ImageSerializer::header_offset));// 设置图像数据
-    publisher->SetCameraInfoData(_seconds, _nanoseconds);// 设置相机信息数据
-    publisher->SetPointCloudData(1, elements * sizeof(carla::sensor::data::DVSEvent), elements, (const uint8_t*) (buffer->data() + carla::sensor::s11n::ImageSerializer::header_offset));// 设置点云数据
-    publisher->Publish();// 发布数据
+    _publish_queue.Push(*publisher, true, [=]() {
+      publisher->SetImageData(seconds, nanoseconds, elements, header->height, header->width, (const uint8_t*) (buffer->data() + carla::sensor::s11n::ImageSerializer::header_offset));// 设置图像数据
+      publisher->SetCameraInfoData(seconds, nanoseconds);// 设置相机信息数据
+      publisher->SetPointCloudData(1, elements * sizeof(carla::sensor::data::DVSEvent), elements, (const uint8_t*) (buffer->data() + carla::sensor::s11n::ImageSerializer::header_offset));// 设置点云数据
+      publisher->Publish();// 发布数据
+    });
   }
   if (sensors.second) { // 如果存在第二个传感器
     std::shared_ptr<CarlaTransformPublisher> publisher = std::dynamic_pointer_cast<CarlaTransformPublisher>(sensors.second);// 将传感器转换为变换发布者
-    publisher->SetData(_seconds, _nanoseconds, (const float*)&sensor_transform.location, (const float*)&sensor_transform.rotation);// 设置变换数据
-    publisher->Publish();// 发布变换数据
+    QueueTransform(publisher, seconds, nanoseconds, sensor_transform); // 在下一帧与其它变换一起发布
   }
 }
 
@@ -739,19 +783,24 @@ void ROS2::ProcessDataFromLidar(
     const carla::geom::Transform sensor_transform, // 传感器变换
     carla::sensor::data::LidarData &data, // 激光雷达数据
     void *actor) {// 操作者
+  const int32_t seconds = _seconds; // 发布任务使用调用时的时间戳
+  const uint32_t nanoseconds = _nanoseconds;
   log_info("Sensor Lidar to ROS data: frame.", _frame, "sensor.", sensor_type, "stream.", stream_id, "points.", data._points.size());// 记录激光雷达传感器数据
   auto sensors = GetOrCreateSensor(ESensors::RayCastLidar, stream_id, actor);// 获取或创建传感器
   if (sensors.first) {// 如果存在第一个传感器
     std::shared_ptr<CarlaLidarPublisher> publisher = std::dynamic_pointer_cast<CarlaLidarPublisher>(sensors.first);// 将传感器转换为激光雷达发布者
     size_t width = data._points.size();// 获取点云宽度
     size_t height = 1;// 设置高度为1
-    publisher->SetData(_seconds, _nanoseconds, height, width, (float*)data._points.data());// 设置数据
-    publisher->Publish();// 发布数据
+    // 传感器每帧复用自己的数据，SetData 还会修改数据，所以发布任务使用一份拷贝
+    std::vector<float> points(data._points);
+    _publish_queue.Push(*publisher, true, [=, points = std::move(points)]() mutable {
+      publisher->SetData(seconds, nanoseconds, height, width, points.data());// 设置数据
+      publisher->Publish();// 发布数据
+    });
   }
   if (sensors.second) {// 如果存在第二个传感器
     std::shared_ptr<CarlaTransformPublisher> publisher = std::dynamic_pointer_cast<CarlaTransformPublisher>(sensors.second);// 将传感器转换为变换发布者
-    publisher->SetData(_seconds, _nanoseconds, (const float*)&sensor_transform.location, (const float*)&sensor_transform.rotation);// 设置变换数据
-    publisher->Publish();// 发布变换数据
+    QueueTransform(publisher, seconds, nanoseconds, sensor_transform); // 在下一帧与其它变换一起发布
   }
 }
 
@@ -761,6 +810,8 @@ void ROS2::ProcessDataFromSemanticLidar(
     const carla::geom::Transform sensor_transform,// 传感器变换
     carla::sensor::data::SemanticLidarData &data,// 语义激光雷达数据
     void *actor) {// 操作者
+  const int32_t seconds = _seconds; // 发布任务使用调用时的时间戳
+  const uint32_t nanoseconds = _nanoseconds;
   static_assert(sizeof(float) == sizeof(uint32_t), "Invalid float size");// 确保float和uint32_t大小一致
   log_info("Sensor SemanticLidar to ROS data: frame.", _frame, "sensor.", sensor_type, "stream.", stream_id, "points.", data._ser_points.size());// 记录日志：传感器语义激光雷达到ROS数据
   auto sensors = GetOrCreateSensor(ESensors::RayCastSemanticLidar, stream_id, actor);// 获取或创建传感器
@@ -768,13 +819,16 @@ void ROS2::ProcessDataFromSemanticLidar(
     std::shared_ptr<CarlaSemanticLidarPublisher> publisher = std::dynamic_pointer_cast<CarlaSemanticLidarPublisher>(sensors.first);// 动态转换到CarlaSemanticLidarPublisher
     size_t width = data._ser_points.size();// 点的数量
     size_t height = 1; // 高度设为1
-    publisher->SetData(_seconds, _nanoseconds, 6, height, width, (float*)data._ser_points.data());// 设置数据
-    publisher->Publish();// 发布数据
+    // 发布任务使用数据的拷贝
+    std::vector<carla::sensor::data::SemanticLidarDetection> points(data._ser_points);
+    _publish_queue.Push(*publisher, true, [=, points = std::move(points)]() mutable {
+      publisher->SetData(seconds, nanoseconds, 6, height, width, (float*)points.data());// 设置数据
+      publisher->Publish();// 发布数据
+    });
   }
   if (sensors.second) {// 如果第二个传感器存在
     std::shared_ptr<CarlaTransformPublisher> publisher = std::dynamic_pointer_cast<CarlaTransformPublisher>(sensors.second);// 动态转换到CarlaTransformPublisher
-    publisher->SetData(_seconds, _nanoseconds, (const float*)&sensor_transform.location, (const float*)&sensor_transform.rotation); // 设置变换数据
-    publisher->Publish();// 发布变换数据
+    QueueTransform(publisher, seconds, nanoseconds, sensor_transform); // 在下一帧与其它变换一起发布
   }
 }
 
@@ -784,6 +838,8 @@ void ROS2::ProcessDataFromRadar(
     const carla::geom::Transform sensor_transform,// 传感器变换
     const carla::sensor::data::RadarData &data,// 雷达数据
     void *actor) {// 操作者
+  const int32_t seconds = _seconds; // 发布任务使用调用时的时间戳
+  const uint32_t nanoseconds = _nanoseconds;
   log_info("Sensor Radar to ROS data: frame.", _frame, "sensor.", sensor_type, "stream.", stream_id, "points.", data._detections.size());// 记录日志：传感器雷达到ROS数据
   auto sensors = GetOrCreateSensor(ESensors::Radar, stream_id, actor); // 获取或创建传感器
   if (sensors.first) {// 如果传感器存在
@@ -791,13 +847,16 @@ void ROS2::ProcessDataFromRadar(
     size_t elements = data.GetDetectionCount();// 获取检测数量
     size_t width = elements * sizeof(carla::sensor::data::RadarDetection); // 计算宽度
     size_t height = 1;// 高度设为1
-    publisher->SetData(_seconds, _nanoseconds, height, width, elements, (const uint8_t*)data._detections.data()); // 设置数据
-    publisher->Publish();// 发布数据
+    // 发布任务使用检测数据的拷贝
+    std::vector<carla::sensor::data::RadarDetection> detections(data._detections);
+    _publish_queue.Push(*publisher, true, [=, detections = std::move(detections)]() {
+      publisher->SetData(seconds, nanoseconds, height, width, elements, (const uint8_t*)detections.data()); // 设置数据
+      publisher->Publish();// 发布数据
+    });
   }
   if (sensors.second) { // 如果第二个传感器存在
     std::shared_ptr<CarlaTransformPublisher> publisher = std::dynamic_pointer_cast<CarlaTransformPublisher>(sensors.second);// 动态转换到CarlaTransformPublisher
-    publisher->SetData(_seconds, _nanoseconds, (const float*)&sensor_transform.location, (const float*)&sensor_transform.rotation);// 设置变换数据
-    publisher->Publish(); // 发布变换数据
+    QueueTransform(publisher, seconds, nanoseconds, sensor_transform); // 在下一帧与其它变换一起发布
   }
 }
 
@@ -819,26 +878,80 @@ void ROS2::ProcessDataFromCollisionSensor(
     uint32_t other_actor,// 其他操作者
     carla::geom::Vector3D impulse, // 冲击力
     void* actor) { // 操作者
+  const int32_t seconds = _seconds; // 发布任务使用调用时的时间戳
+  const uint32_t nanoseconds = _nanoseconds;
   auto sensors = GetOrCreateSensor(ESensors::CollisionSensor, stream_id, actor); // 获取或创建传感器
   if (sensors.first) {// 如果传感器存在
     std::shared_ptr<CarlaCollisionPublisher> publisher = std::dynamic_pointer_cast<CarlaCollisionPublisher>(sensors.first);// 动态转换到CarlaCollisionPublisher
-    publisher->SetData(_seconds, _nanoseconds, other_actor, impulse.x, impulse.y, impulse.z);// 设置碰撞数据
-    publisher->Publish();
+    _publish_queue.Push(*publisher, false, [=]() {
+      publisher->SetData(seconds, nanoseconds, other_actor, impulse.x, impulse.y, impulse.z);// 设置碰撞数据
+      publisher->Publish();
+    });
   }
   if (sensors.second) {// 如果第二个传感器存在
     std::shared_ptr<CarlaTransformPublisher> publisher = std::dynamic_pointer_cast<CarlaTransformPublisher>(sensors.second);// 动态转换到CarlaTransformPublisher
-    publisher->SetData(_seconds, _nanoseconds, (const float*)&sensor_transform.location, (const float*)&sensor_transform.rotation);// 设置变换数据
-    publisher->Publish();// 发布变换数据
+    QueueTransform(publisher, seconds, nanoseconds, sensor_transform); // 在下一帧与其它变换一起发布
+  }
+}
+
+void ROS2::QueueTransform(
+    std::shared_ptr<CarlaTransformPublisher> transform,
+    int32_t seconds,
+    uint32_t nanoseconds,
+    const carla::geom::Transform &sensor_transform) {
+  std::lock_guard<std::mutex> lock(_tf_mutex);
+  // 同一帧内多次更新时只发布最新的变换
+  _tf_pending[transform.get()] = PendingTransform{std::move(transform), seconds, nanoseconds, sensor_transform};
+}
+
+void ROS2::PublishTransforms() {
+  std::vector<PendingTransform> pending;
+  {
+    std::lock_guard<std::mutex> lock(_tf_mutex);
+    if (_tf_pending.empty()) {
+      return;
+    }
+    pending.reserve(_tf_pending.size());
+    for (auto &item : _tf_pending) {
+      pending.emplace_back(std::move(item.second));
+    }
+    _tf_pending.clear();
+  }
+  if (!_tf_publisher) {
+    return;
   }
+  auto tf_publisher = _tf_publisher;
+  // 不可丢弃：每个任务包含不同传感器的变换，替换会丢失其它传感器的变换
+  _publish_queue.Push(*tf_publisher, false, [tf_publisher, pending]() {
+    tf_publisher->ClearTransforms();
+    for (const auto &item : pending) {
+      // 各变换保留自己的时间戳，四元数的缓存在各自的变换中
+      item.transform->SetData(item.seconds, item.nanoseconds,
+          (const float*)&item.sensor_transform.location, (const float*)&item.sensor_transform.rotation);
+      tf_publisher->AddTransforms(*item.transform);
+    }
+    tf_publisher->Publish();
+  });
 }
 
 void ROS2::Shutdown() {// 关闭
+  // 先发布完等待的消息，再释放发布者
+  _publish_queue.Stop();
+  for (const auto &stats : _publish_queue.GetStats()) {
+    log_info("ROS2 publisher", stats.name, "published", stats.published, "dropped", stats.dropped,
+        "latency mean", stats.latency.GetMean(), "ms p99", stats.latency.GetPercentile(0.99f), "ms");
+  }
   for (auto& element : _publishers) {// 遍历发布者
     element.second.reset();// 重置发布者
   }
   for (auto& element : _transforms) {// 遍历变换
     element.second.reset();// 重置变换
   }
+  {
+    std::lock_guard<std::mutex> lock(_tf_mutex);
+    _tf_pending.clear();
+  }
+  _tf_publisher.reset();// 重置合并的变换发布者
   _clock_publisher.reset();// 重置时钟发布者
   _controller.reset();// 重置控制器
   _enabled = false;// 禁用
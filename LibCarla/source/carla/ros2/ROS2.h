@@ -10,11 +10,14 @@
 #include "carla/BufferView.h" // 引入 Carla 缓冲区视图头文件
 #include "carla/geom/Transform.h" // 引入 Carla 变换几何头文件
 #include "carla/ros2/ROS2CallbackData.h" // 引入 ROS2 回调数据头文件
+#include "carla/ros2/ROS2PublishQueue.h" // 引入异步发布队列头文件
+#include "carla/ros2/ROS2QosProfile.h" // 引入传输和 QoS 配置头文件
 #include "carla/streaming/detail/Types.h" // 引入 Carla 流媒体类型头文件
 
 #include <unordered_set> // 引入无序集合头文件
 #include <unordered_map> // 引入无序映射头文件
 #include <memory> // 引入智能指针头文件
+#include <mutex> // 引入互斥锁头文件
 #include <vector> // 引入向量头文件
 
 // 前置声明
@@ -68,6 +71,8 @@ class ROS2
   void UpdateActorRosName(void *actor, std::string ros_name); // 更新 Actor 的 ROS 名称
   std::string GetActorRosName(void *actor); // 获取 Actor 的 ROS 名称
   std::string GetActorParentRosName(void *actor); // 获取 Actor 的父级 ROS 名称
+  void AddActorRosQos(void *actor, ROS2QosProfile qos); // 设置 Actor 发布者的传输和 QoS，需要在第一次发布前调用
+  ROS2QosProfile GetActorRosQos(void *actor); // 获取 Actor 发布者的传输和 QoS
 
   // 回调函数
   void AddActorCallback(void* actor, std::string ros_name, ActorCallback callback); // 添加 Actor 回调函数
@@ -78,6 +83,9 @@ class ROS2
   bool IsStreamEnabled(carla::streaming::detail::stream_id_type id) { return _publish_stream.count(id) > 0; } // 检查流是否启用
   void ResetStreams() { _publish_stream.clear(); } // 重置流
 
+  // 每个发布者在发布队列中的统计（发布数、丢弃数和延迟）
+  std::vector<ROS2PublishQueue::TopicStats> GetPublishStats() const { return _publish_queue.GetStats(); }
+
   // 接收要发布的数据
   void ProcessDataFromCamera(
       uint64_t sensor_type,
@@ -143,6 +151,16 @@ class ROS2
 
  private: // 私有成员
  std::pair<std::shared_ptr<CarlaPublisher>, std::shared_ptr<CarlaTransformPublisher>> GetOrCreateSensor(int type, carla::streaming::detail::stream_id_type id, void* actor); // 获取或创建传感器
+ void QueueTransform(std::shared_ptr<CarlaTransformPublisher> transform, int32_t seconds, uint32_t nanoseconds, const carla::geom::Transform &sensor_transform); // 记录传感器的变换，下一帧合并发布
+ void PublishTransforms(); // 把上一帧记录的所有变换合并成一个 TFMessage 发布
+
+ // 等待合并发布的变换
+ struct PendingTransform {
+   std::shared_ptr<CarlaTransformPublisher> transform;
+   int32_t seconds;
+   uint32_t nanoseconds;
+   carla::geom::Transform sensor_transform;
+ };
 
 // 单例
 ROS2() {}; // 构造函数
@@ -155,12 +173,17 @@ int32_t _seconds { 0 }; // 秒数
 uint32_t _nanoseconds { 0 }; // 纳秒数
 std::unordered_map<void *, std::string> _actor_ros_name; // Actor 的 ROS 名称映射
 std::unordered_map<void *, std::vector<void*> > _actor_parent_ros_name; // Actor 的父级 ROS 名称映射
+std::unordered_map<void *, ROS2QosProfile> _actor_ros_qos; // Actor 的传输和 QoS 映射
 std::shared_ptr<CarlaEgoVehicleControlSubscriber> _controller; // 控制器实例
 std::shared_ptr<CarlaClockPublisher> _clock_publisher; // 时钟发布者实例
 std::unordered_map<void *, std::shared_ptr<CarlaPublisher>> _publishers; // 发布者映射
-std::unordered_map<void *, std::shared_ptr<CarlaTransformPublisher>> _transforms; // 变换发布者映射
+std::unordered_map<void *, std::shared_ptr<CarlaTransformPublisher>> _transforms; // 变换映射，只生成变换，不单独发布
+std::shared_ptr<CarlaTransformPublisher> _tf_publisher; // 每帧发布一次所有变换的 rt/tf 发布者
+std::mutex _tf_mutex; // 保护 _tf_pending，传感器数据来自不同的线程
+std::unordered_map<CarlaTransformPublisher *, PendingTransform> _tf_pending; // 每个变换只保留最新的一个
 std::unordered_set<carla::streaming::detail::stream_id_type> _publish_stream; // 发布流集合
 std::unordered_map<void *, ActorCallback> _actor_callbacks; // Actor 回调映射
+ROS2PublishQueue _publish_queue; // 在工作线程中填充并发布传感器消息
 };
 
 } // namespace ros2
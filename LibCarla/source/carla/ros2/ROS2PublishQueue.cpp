@@ -0,0 +1,144 @@
+// Copyright (c) 2023 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/ros2/ROS2PublishQueue.h"
+
+#include "carla/Logging.h"
+#include "carla/ros2/publishers/CarlaPublisher.h"
+
+#include <algorithm>
+#include <exception>
+
+namespace carla {
+namespace ros2 {
+
+  void ROS2PublishQueue::Start(size_t workers, size_t capacity) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_running) {
+      return;
+    }
+    _capacity = std::max<size_t>(1u, capacity);
+    _stopping = false;
+    _running = true;
+    _workers.CreateThreads(std::max<size_t>(1u, workers), [this]() { WorkerLoop(); });
+  }
+
+  void ROS2PublishQueue::Stop() {
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      if (!_running) {
+        return;
+      }
+      _stopping = true;
+    }
+    _work_cv.notify_all();
+    _workers.JoinAll();
+    std::lock_guard<std::mutex> lock(_mutex);
+    _running = false;
+    _stopping = false;
+    _space_cv.notify_all();
+  }
+
+  void ROS2PublishQueue::Push(
+      const CarlaPublisher &publisher,
+      bool droppable,
+      std::function<void()> task) {
+    std::unique_lock<std::mutex> lock(_mutex);
+    if (!_running || _stopping) {
+      lock.unlock();
+      task();
+      return;
+    }
+
+    const void *key = &publisher;
+    Topic &topic = _topics[key];
+    if (topic.stats.name.empty()) {
+      topic.stats.name = publisher.name() + " (" + publisher.type() + ")";
+    }
+
+    if (droppable) {
+      // 只保留每个发布者最新的样本，替换的任务保持原来在队列中的位置
+      for (auto &queued : _tasks) {
+        if (queued.topic == key) {
+          queued.function = std::move(task);
+          queued.queued = clock::now();
+          ++topic.stats.dropped;
+          return;
+        }
+      }
+    }
+
+    while (_tasks.size() >= _capacity) {
+      auto oldest = std::find_if(_tasks.begin(), _tasks.end(), [](const Task &queued) {
+        return queued.droppable;
+      });
+      if (oldest != _tasks.end()) {
+        ++_topics[oldest->topic].stats.dropped;
+        _tasks.erase(oldest);
+        break;
+      }
+      _space_cv.wait(lock);
+      if (!_running) {
+        lock.unlock();
+        task();
+        return;
+      }
+    }
+
+    _tasks.push_back(Task{key, droppable, clock::now(), std::move(task)});
+    _work_cv.notify_one();
+  }
+
+  std::vector<ROS2PublishQueue::TopicStats> ROS2PublishQueue::GetStats() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    std::vector<TopicStats> result;
+    result.reserve(_topics.size());
+    for (auto &topic : _topics) {
+      result.emplace_back(topic.second.stats);
+    }
+    return result;
+  }
+
+  void ROS2PublishQueue::WorkerLoop() {
+    std::unique_lock<std::mutex> lock(_mutex);
+    for (;;) {
+      // 第一个发布者没有在其它线程中发布的任务
+      auto next = std::find_if(_tasks.begin(), _tasks.end(), [this](const Task &queued) {
+        return !_topics[queued.topic].busy;
+      });
+      if (next == _tasks.end()) {
+        if (_stopping && _tasks.empty()) {
+          return;
+        }
+        _work_cv.wait(lock);
+        continue;
+      }
+
+      Task task = std::move(*next);
+      _tasks.erase(next);
+      _topics[task.topic].busy = true;
+      _space_cv.notify_one();
+      lock.unlock();
+
+      try {
+        task.function();
+      } catch (const std::exception &e) {
+        log_error("ROS2 publish failed:", e.what());
+      }
+      const auto elapsed = std::chrono::duration<float, std::milli>(clock::now() - task.queued);
+
+      lock.lock();
+      Topic &topic = _topics[task.topic];
+      topic.busy = false;
+      ++topic.stats.published;
+      topic.stats.latency.Add(elapsed.count());
+      // 同一发布者的下一个任务可能在等待这个任务完成
+      _work_cv.notify_all();
+    }
+  }
+
+} // namespace ros2
+} // namespace carla
@@ -0,0 +1,108 @@
+// Copyright (c) 2023 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/NonCopyable.h"
+#include "carla/ThreadGroup.h"
+#include "carla/rpc/SecondaryTelemetry.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace carla {
+namespace ros2 {
+
+  class CarlaPublisher;
+
+  /// @brief 在工作线程中发布 ROS2 消息的有界队列。
+  ///
+  /// 产生数据的线程只把发布任务放入队列，填充消息、DDS 序列化和发送都在工作线程中进行。
+  /// 同一个发布者的任务按顺序执行，且不会在两个线程中同时执行（发布者复用自己的消息对象）。
+  ///
+  /// 可丢弃的任务（传感器数据）与发布者 KEEP_LAST 的历史一致：发布者已有等待的任务时，
+  /// 新的样本替换旧的样本；队列满时丢弃最早的可丢弃任务。不可丢弃的任务（碰撞、压线
+  /// 等事件）从不丢弃，队列满且没有可丢弃的任务时，放入任务的线程等待。
+  class ROS2PublishQueue : private NonCopyable {
+  public:
+
+    /// 每个发布者的统计
+    struct TopicStats {
+      std::string name;
+      /// 发布的消息数
+      uint64_t published = 0u;
+      /// 被更新的样本替换或队列满时丢弃的消息数
+      uint64_t dropped = 0u;
+      /// 从放入队列到发布完成的时间
+      rpc::LatencyHistogram latency;
+    };
+
+    ROS2PublishQueue() = default;
+
+    ~ROS2PublishQueue() {
+      Stop();
+    }
+
+    /// 启动 @a workers 个工作线程，最多 @a capacity 个等待的任务。
+    void Start(size_t workers, size_t capacity);
+
+    /// 执行完所有等待的任务后停止工作线程。
+    void Stop();
+
+    /// 放入 @a publisher 的发布任务。队列没有运行时直接在调用的线程中执行。
+    void Push(const CarlaPublisher &publisher, bool droppable, std::function<void()> task);
+
+    std::vector<TopicStats> GetStats() const;
+
+  private:
+
+    using clock = std::chrono::steady_clock;
+
+    struct Task {
+      const void *topic;
+      bool droppable;
+      clock::time_point queued;
+      std::function<void()> function;
+    };
+
+    struct Topic {
+      TopicStats stats;
+      /// 正在某个工作线程中发布
+      bool busy = false;
+    };
+
+    void WorkerLoop();
+
+    mutable std::mutex _mutex;
+
+    /// 有新的任务、话题空闲或停止
+    std::condition_variable _work_cv;
+
+    /// 队列有空位
+    std::condition_variable _space_cv;
+
+    std::deque<Task> _tasks;
+
+    std::unordered_map<const void *, Topic> _topics;
+
+    size_t _capacity = 0u;
+
+    bool _running = false;
+
+    bool _stopping = false;
+
+    ThreadGroup _workers;
+  };
+
+} // namespace ros2
+} // namespace carla
@@ -0,0 +1,72 @@
+// Copyright (c) 2023 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace carla {
+namespace ros2 {
+
+  /// 发布者的域参与者使用的传输。
+  enum class ROS2Transport : uint8_t {
+    /// Fast-DDS 的默认传输
+    Default,
+    /// 共享内存，段足够放下几帧高分辨率图像，同一台机器上的订阅者不再经过 UDP。
+    /// 保留 UDPv4 用于发现和其它机器上的订阅者
+    SharedMemory,
+    /// 只使用 UDPv4，增大套接字缓冲区并异步发送，适合其它机器上的订阅者
+    Udp
+  };
+
+  /// 数据写入器的可靠性和历史。
+  enum class ROS2Reliability : uint8_t {
+    /// Fast-DDS 的默认值（可靠，KEEP_LAST 1）
+    Default,
+    /// 按传感器类型选择：大数据量的传感器使用 SensorData，事件使用 Reliable
+    Auto,
+    /// 尽力而为，KEEP_LAST 1，与 ROS2 的 SensorDataQoS 兼容
+    SensorData,
+    /// 可靠，KEEP_LAST 10
+    Reliable
+  };
+
+  /// 参与者的 "ros_transport" 和 "ros_qos" 属性选择的发布配置。
+  struct ROS2QosProfile {
+    ROS2Transport transport = ROS2Transport::Default;
+    ROS2Reliability reliability = ROS2Reliability::Default;
+
+    /// 解析属性的值，无法识别的值使用默认值。
+    static ROS2QosProfile Parse(const std::string &transport, const std::string &qos) {
+      ROS2QosProfile profile;
+      if (transport == "shm") {
+        profile.transport = ROS2Transport::SharedMemory;
+      } else if (transport == "udp") {
+        profile.transport = ROS2Transport::Udp;
+      }
+      if (qos == "auto") {
+        profile.reliability = ROS2Reliability::Auto;
+      } else if (qos == "sensor_data") {
+        profile.reliability = ROS2Reliability::SensorData;
+      } else if (qos == "reliable") {
+        profile.reliability = ROS2Reliability::Reliable;
+      }
+      return profile;
+    }
+
+    /// 把 Auto 换成 @a sensor_data（传感器数据为 true，事件为 false）对应的预设。
+    ROS2QosProfile Resolve(bool sensor_data) const {
+      ROS2QosProfile profile = *this;
+      if (profile.reliability == ROS2Reliability::Auto) {
+        profile.reliability = sensor_data ? ROS2Reliability::SensorData : ROS2Reliability::Reliable;
+      }
+      return profile;
+    }
+  };
+
+} // namespace ros2
+} // namespace carla
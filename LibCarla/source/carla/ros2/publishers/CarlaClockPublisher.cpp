@@ -3,6 +3,7 @@
 /// @file CarlaClockPublisher.cpp
 /// @brief CarlaClockPublisher 类的实现文件，负责发布CARLA的时钟信息到ROS2系统。
 #include "CarlaClockPublisher.h"/// @brief 包含 CarlaClockPublisher 类的声明。
+#include "PublisherQos.h"
 
 #include <string>/// @brief 包含标准字符串库，用于处理字符串数据。
 // CARLA ROS2 类型支持
@@ -91,6 +92,7 @@ namespace ros2 {
     // 设置DomainParticipant的QoS策略为默认值，并设置其名称为_name，然后创建DomainParticipant
     efd::DomainParticipantQos pqos = efd::PARTICIPANT_QOS_DEFAULT;
     pqos.name(_name);
+    ApplyParticipantQos(pqos, _qos);
     auto factory = efd::DomainParticipantFactory::get_instance();
     _impl->_participant = factory->create_participant(0, pqos);
     if (_impl->_participant == nullptr) {
@@ -119,6 +121,7 @@ namespace ros2 {
     }
     // 设置DataWriter的QoS策略为默认值，获取对应的监听器，然后创建DataWriter
     efd::DataWriterQos wqos = efd::DATAWRITER_QOS_DEFAULT;
+    ApplyDataWriterQos(wqos, _qos);
     efd::DataWriterListener* listener = (efd::DataWriterListener*)_impl->_listener._impl.get();
     _impl->_datawriter = _impl->_publisher->create_datawriter(_impl->_topic, wqos, listener);
     if (_impl->_datawriter == nullptr) {
@@ -1,6 +1,7 @@
 #define _GLIBCXX_USE_CXX11_ABI 0
 
 #include "CarlaCollisionPublisher.h"// 包含Carla碰撞事件发布者类的声明
+#include "PublisherQos.h"
 
 #include <string>// 包含字符串处理相关的功能
 // 包含Carla ROS 2类型定义和监听器相关的头文件
@@ -102,6 +103,7 @@ namespace ros2 {
      */
     efd::DomainParticipantQos pqos = efd::PARTICIPANT_QOS_DEFAULT;
     pqos.name(_name);
+    ApplyParticipantQos(pqos, _qos);
     /**
      * @brief 创建域参与者
      * @details 使用DomainParticipantFactory创建域参与者，如果失败则打印错误信息并返回false。
@@ -159,6 +161,7 @@ namespace ros2 {
      * @details 使用默认的数据写入器QoS策略，并设置历史内存策略为预分配并允许重新分配。
      */
     efd::DataWriterQos wqos = efd::DATAWRITER_QOS_DEFAULT;
+    ApplyDataWriterQos(wqos, _qos);
     wqos.endpoint().history_memory_policy = eprosima::fastrtps::rtps::PREALLOCATED_WITH_REALLOC_MEMORY_MODE;
     /**
      * @brief 创建数据写入器
@@ -1,6 +1,7 @@
 #define _GLIBCXX_USE_CXX11_ABI 0
 
 #include "CarlaDVSCameraPublisher.h"// 引入CarlaDVS相机发布器的头文件
+#include "PublisherQos.h"
 
 #include <string>// 引入字符串处理功能
 // 引入CARLA传感器数据中的DVS事件类型
@@ -192,6 +193,7 @@ namespace ros2 {
 
     efd::DomainParticipantQos pqos = efd::PARTICIPANT_QOS_DEFAULT;
     pqos.name(_name);
+    ApplyParticipantQos(pqos, _qos);
     auto factory = efd::DomainParticipantFactory::get_instance();
     _impl->_participant = factory->create_participant(0, pqos);
     if (_impl->_participant == nullptr) {
@@ -222,6 +224,7 @@ namespace ros2 {
     }
 
     efd::DataWriterQos wqos = efd::DATAWRITER_QOS_DEFAULT;
+    ApplyDataWriterQos(wqos, _qos);
     wqos.endpoint().history_memory_policy = eprosima::fastrtps::rtps::PREALLOCATED_WITH_REALLOC_MEMORY_MODE;
     efd::DataWriterListener* listener = (efd::DataWriterListener*)_impl->_listener._impl.get();
     _impl->_datawriter = _impl->_publisher->create_datawriter(_impl->_topic, wqos, listener);
@@ -245,6 +248,7 @@ namespace ros2 {
     /// 设置DomainParticipant的QoS（Quality of Service）策略为默认值，并设置其名称
     efd::DomainParticipantQos pqos = efd::PARTICIPANT_QOS_DEFAULT;
     pqos.name(_name);
+    ApplyParticipantQos(pqos, _qos);
     /// 获取DomainParticipantFactory的实例
     auto factory = efd::DomainParticipantFactory::get_instance();
     _info->_participant = factory->create_participant(0, pqos);
@@ -284,6 +288,7 @@ namespace ros2 {
     }
     /// 设置DataWriter的QoS策略为默认值
     efd::DataWriterQos wqos = efd::DATAWRITER_QOS_DEFAULT;
+    ApplyDataWriterQos(wqos, _qos);
     /// 获取DataWriterListener的实例
     efd::DataWriterListener* listener = (efd::DataWriterListener*)_info->_listener._impl.get();
     /// 创建DataWriter
@@ -311,6 +316,7 @@ namespace ros2 {
     /// 设置DomainParticipant的QoS策略
     efd::DomainParticipantQos pqos = efd::PARTICIPANT_QOS_DEFAULT;
     pqos.name(_name);
+    ApplyParticipantQos(pqos, _qos);
     /// 获取DomainParticipantFactory的实例
     auto factory = efd::DomainParticipantFactory::get_instance();
     /// 创建DomainParticipant
@@ -344,6 +350,7 @@ namespace ros2 {
     }
     /// 设置DataWriter的QoS策略，并指定历史内存策略为预分配并允许重新分配
     efd::DataWriterQos wqos = efd::DATAWRITER_QOS_DEFAULT;
+    ApplyDataWriterQos(wqos, _qos);
     wqos.endpoint().history_memory_policy = eprosima::fastrtps::rtps::PREALLOCATED_WITH_REALLOC_MEMORY_MODE;
     efd::DataWriterListener* listener = (efd::DataWriterListener*)_point_cloud->_listener._impl.get();
     _point_cloud->_datawriter = _point_cloud->_publisher->create_datawriter(_point_cloud->_topic, wqos, listener);
@@ -671,10 +678,10 @@ namespace ros2 {
  */
   void CarlaDVSCameraPublisher::SetPointCloudData(size_t height, size_t width, size_t elements, const uint8_t* data) {
 
-    std::vector<uint8_t> vector_data;
+    // 复用点云消息中上一帧的缓冲区
+    std::vector<uint8_t> vector_data = std::move(_point_cloud->_pc.data());
     const size_t size = height * width;// 计算点云数据所需的总字节数
-    vector_data.resize(size);// 调整向量大小以适应点云数据
-    std::memcpy(&vector_data[0], &data[0], size);// 将原始数据复制到向量中
+    vector_data.assign(data, data + size);// 将原始数据复制到向量中
     // 配置点云描述符（即点的属性信息）
     sensor_msgs::msg::PointField descriptor1;
     descriptor1.name("x");
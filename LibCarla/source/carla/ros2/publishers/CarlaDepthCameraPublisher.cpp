@@ -1,6 +1,7 @@
 #define _GLIBCXX_USE_CXX11_ABI 0
 
 #include "CarlaDepthCameraPublisher.h"// 引入Carla深度相机发布者类的声明
+#include "PublisherQos.h"
 
 #include <string>// 引入字符串处理相关的功能
 // 引入CARLA ROS 2桥接器中定义的图像和相机信息类型支持
@@ -164,6 +165,7 @@ namespace ros2 {
     // 设置域参与者的QoS策略，并为其命名
     efd::DomainParticipantQos pqos = efd::PARTICIPANT_QOS_DEFAULT;
     pqos.name(_name);
+    ApplyParticipantQos(pqos, _qos);
     auto factory = efd::DomainParticipantFactory::get_instance();
     _impl->_participant = factory->create_participant(0, pqos);
     if (_impl->_participant == nullptr) {
@@ -195,6 +197,7 @@ namespace ros2 {
     }
     // 设置数据写入器的QoS策略，并创建数据写入器
     efd::DataWriterQos wqos = efd::DATAWRITER_QOS_DEFAULT;
+    ApplyDataWriterQos(wqos, _qos);
     wqos.endpoint().history_memory_policy = eprosima::fastrtps::rtps::PREALLOCATED_WITH_REALLOC_MEMORY_MODE;
     efd::DataWriterListener* listener = (efd::DataWriterListener*)_impl->_listener._impl.get();
     _impl->_datawriter = _impl->_publisher->create_datawriter(_impl->_topic, wqos, listener);
@@ -222,6 +225,7 @@ namespace ros2 {
     // 设置域参与者的QoS策略，并为其命名
     efd::DomainParticipantQos pqos = efd::PARTICIPANT_QOS_DEFAULT;
     pqos.name(_name);
+    ApplyParticipantQos(pqos, _qos);
     auto factory = efd::DomainParticipantFactory::get_instance();
     _impl_info->_participant = factory->create_participant(0, pqos);
     if (_impl_info->_participant == nullptr) {
@@ -253,6 +257,7 @@ namespace ros2 {
     }
     // 设置数据写入器的QoS策略（使用默认值），并创建数据写入器
     efd::DataWriterQos wqos = efd::DATAWRITER_QOS_DEFAULT;
+    ApplyDataWriterQos(wqos, _qos);
     efd::DataWriterListener* listener = (efd::DataWriterListener*)_impl_info->_listener._impl.get();
     _impl_info->_datawriter = _impl_info->_publisher->create_datawriter(_impl_info->_topic, wqos, listener);
     if (_impl_info->_datawriter == nullptr) {
@@ -461,10 +466,11 @@ namespace ros2 {
  * @param width 图像的宽度
  * @param data 指向图像数据的指针，数据格式为BGRA，每个像素4个字节
  */
-  void CarlaDepthCameraPublisher::SetImageData(int32_t seconds, uint32_t nanoseconds, size_t height, size_t width, const uint8_t* data) {    std::vector<uint8_t> vector_data;
+  void CarlaDepthCameraPublisher::SetImageData(int32_t seconds, uint32_t nanoseconds, size_t height, size_t width, const uint8_t* data) {
+    // 复用消息中上一帧的缓冲区，不再每帧分配并清零新的 vector
+    std::vector<uint8_t> vector_data = std::move(_impl->_image.data());
     const size_t size = height * width * 4;
-    vector_data.resize(size);
-    std::memcpy(&vector_data[0], &data[0], size);
+    vector_data.assign(data, data + size);
     SetData(seconds, nanoseconds,height, width, std::move(vector_data));
   }
   /**
@@ -1,6 +1,7 @@
 #define _GLIBCXX_USE_CXX11_ABI 0
 
 #include "CarlaGNSSPublisher.h"
+#include "PublisherQos.h"
 
 #include <string>
 
@@ -53,6 +54,7 @@ namespace ros2 {
 // 获取默认的域参与者QoS配置，并设置其名称为传入的_name
     efd::DomainParticipantQos pqos = efd::PARTICIPANT_QOS_DEFAULT;
     pqos.name(_name);
+    ApplyParticipantQos(pqos, _qos);
     // 获取域参与者工厂的单例实例
     auto factory = efd::DomainParticipantFactory::get_instance();
     // 通过工厂创建域参与者，指定域ID为0，并传入QoS配置，如果创建失败则输出错误信息并返回false
@@ -89,6 +91,7 @@ namespace ros2 {
     }
 // 获取默认的数据写入器QoS配置
     efd::DataWriterQos wqos = efd::DATAWRITER_QOS_DEFAULT;
+    ApplyDataWriterQos(wqos, _qos);
     // 设置数据写入器的历史内存策略为预分配可重分配模式
     wqos.endpoint().history_memory_policy = eprosima::fastrtps::rtps::PREALLOCATED_WITH_REALLOC_MEMORY_MODE;
     // 获取数据写入器监听器对象（从Carla监听器中获取其内部实现指针并进行类型转换）
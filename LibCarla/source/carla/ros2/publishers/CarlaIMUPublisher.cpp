@@ -1,6 +1,7 @@
 #define _GLIBCXX_USE_CXX11_ABI 0
 
 #include "CarlaIMUPublisher.h"
+#include "PublisherQos.h"
 
 #include <string>
 
@@ -57,6 +58,7 @@ namespace ros2 {
 // 获取默认的 DDS 领域参与者 QoS 配置，并赋值给 pqos 对象，后续可基于此进行个性化配置
     efd::DomainParticipantQos pqos = efd::PARTICIPANT_QOS_DEFAULT;// 获取默认的 DDS 领域参与者 QoS 配置，并赋值给 pqos 对象
     pqos.name(_name);// 设置领域参与者的名称为类成员变量 _name 存储的值
+    ApplyParticipantQos(pqos, _qos);
     // 获取 DDS 领域参与者工厂的单例实例，用于创建领域参与者对象
     auto factory = efd::DomainParticipantFactory::get_instance();
     // 使用工厂创建一个领域参与者对象，传入领域 ID（这里为 0）和配置好的 QoS 对象 pqos，若创建失败返回 nullptr
@@ -91,6 +93,7 @@ namespace ros2 {
     }
 
     efd::DataWriterQos wqos = efd::DATAWRITER_QOS_DEFAULT;
+    ApplyDataWriterQos(wqos, _qos);
      // 设置数据写入器的历史内存策略为预分配并可重新分配内存模式，用于管理数据写入的内存相关配置
     wqos.endpoint().history_memory_policy = eprosima::fastrtps::rtps::PREALLOCATED_WITH_REALLOC_MEMORY_MODE;
      // 获取 Carla 监听器内部实现对象的指针（进行了类型转换），用于传递给数据写入器
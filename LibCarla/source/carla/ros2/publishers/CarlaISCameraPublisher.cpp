@@ -1,6 +1,7 @@
 #define _GLIBCXX_USE_CXX11_ABI 0
 
 #include "CarlaISCameraPublisher.h"// 引入自定义的相机发布器头文件
+#include "PublisherQos.h"
 
 #include <string>// 引入字符串库
 
@@ -72,6 +73,7 @@ namespace ros2 {
     }
     efd::DomainParticipantQos pqos = efd::PARTICIPANT_QOS_DEFAULT; // 默认QOS设置
     pqos.name(_name);// 设置参与者名称 
+    ApplyParticipantQos(pqos, _qos);
     auto factory = efd::DomainParticipantFactory::get_instance(); // 获取参与者工厂实例
     _impl->_participant = factory->create_participant(0, pqos);// 创建DomainParticipant 
     if (_impl->_participant == nullptr) {
@@ -102,6 +104,7 @@ namespace ros2 {
     }
 
     efd::DataWriterQos wqos = efd::DATAWRITER_QOS_DEFAULT;// 默认DataWriter QOS设置
+    ApplyDataWriterQos(wqos, _qos);
     wqos.endpoint().history_memory_policy = eprosima::fastrtps::rtps::PREALLOCATED_WITH_REALLOC_MEMORY_MODE; // 设置内存策略 
     efd::DataWriterListener* listener = (efd::DataWriterListener*)_impl->_listener._impl.get();// 获取监听器
     _impl->_datawriter = _impl->_publisher->create_datawriter(_impl->_topic, wqos, listener);// 创建DataWriter 
@@ -121,6 +124,7 @@ namespace ros2 {
 
     efd::DomainParticipantQos pqos = efd::PARTICIPANT_QOS_DEFAULT;// 默认QOS设置
     pqos.name(_name);// 设置参与者名称
+    ApplyParticipantQos(pqos, _qos);
     auto factory = efd::DomainParticipantFactory::get_instance();// 获取参与者工厂实例
     _impl_info->_participant = factory->create_participant(0, pqos);// 创建DomainParticipant 
     if (_impl_info->_participant == nullptr) {
@@ -150,6 +154,7 @@ namespace ros2 {
         return false;//返回失败
     }
     efd::DataWriterQos wqos = efd::DATAWRITER_QOS_DEFAULT;// 默认DataWriter QOS设置
+    ApplyDataWriterQos(wqos, _qos);
     efd::DataWriterListener* listener = (efd::DataWriterListener*)_impl_info->_listener._impl.get();// 获取监听器
     _impl_info->_datawriter = _impl_info->_publisher->create_datawriter(_impl_info->_topic, wqos, listener);// 创建DataWriter 
     if (_impl_info->_datawriter == nullptr) {
@@ -292,10 +297,10 @@ namespace ros2 {
   }
 // 设置图像数据
   void CarlaISCameraPublisher::SetImageData(int32_t seconds, uint32_t nanoseconds, size_t height, size_t width, const uint8_t* data) {
-    std::vector<uint8_t> vector_data;// 创建数据向量
+    // 数据向量复用消息中上一帧的缓冲区，避免每帧重新分配
+    std::vector<uint8_t> vector_data = std::move(_impl->_image.data());
     const size_t size = height * width * 4;// 计算数据大小（假设为BGRA格式）
-    vector_data.resize(size);// 调整向量大小
-    std::memcpy(&vector_data[0], &data[0], size); // 复制数据
+    vector_data.assign(data, data + size); // 复制数据
     SetData(seconds, nanoseconds, height, width, std::move(vector_data));// 设置数据 
   }
 // 设置相机信息的感兴趣区域
@@ -1,6 +1,7 @@
 #define _GLIBCXX_USE_CXX11_ABI 0
 
 #include "CarlaLidarPublisher.h"// 包含 CarlaLidarPublisher 类的声明
+#include "PublisherQos.h"
 
 #include <string>// 包含字符串处理功能
 // 包含 CARLA ROS2 桥接所需的类型定义和监听器类
@@ -86,6 +87,7 @@ namespace ros2 {
     // 设置域参与者的QoS策略
     efd::DomainParticipantQos pqos = efd::PARTICIPANT_QOS_DEFAULT;
     pqos.name(_name);
+    ApplyParticipantQos(pqos, _qos);
     // 创建域参与者
     auto factory = efd::DomainParticipantFactory::get_instance();
     _impl->_participant = factory->create_participant(0, pqos);
@@ -116,6 +118,7 @@ namespace ros2 {
     }
     // 设置数据写入器的QoS策略
     efd::DataWriterQos wqos = efd::DATAWRITER_QOS_DEFAULT;
+    ApplyDataWriterQos(wqos, _qos);
     wqos.endpoint().history_memory_policy = eprosima::fastrtps::rtps::PREALLOCATED_WITH_REALLOC_MEMORY_MODE;
     // 创建数据写入器，并传入自定义的监听器
     efd::DataWriterListener* listener = (efd::DataWriterListener*)_impl->_listener._impl.get();
@@ -234,10 +237,11 @@ void CarlaLidarPublisher::SetData(int32_t seconds, uint32_t nanoseconds, size_t
     for (++it; it < end; it += 4) {
         *it *= -1.0f;// 将y值取反（假设data[1]是y值）
     }
-    std::vector<uint8_t> vector_data;
+    // 点云较大，复用消息中上一帧的缓冲区而不是每帧新建
+    std::vector<uint8_t> vector_data = std::move(_impl->_lidar.data());
     const size_t size = height * width * sizeof(float);
-    vector_data.resize(size);
-    std::memcpy(&vector_data[0], &data[0], size);// 将浮点数据复制到字节向量中
+    const uint8_t *bytes = reinterpret_cast<const uint8_t *>(data);
+    vector_data.assign(bytes, bytes + size);// 将浮点数据复制到字节向量中
     // 调用重载的SetData函数来设置处理后的数据
     SetData(seconds, nanoseconds, height, width, std::move(vector_data));
   }
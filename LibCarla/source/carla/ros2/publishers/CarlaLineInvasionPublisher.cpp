@@ -1,6 +1,7 @@
 #define _GLIBCXX_USE_CXX11_ABI 0
 
 #include "CarlaLineInvasionPublisher.h"
+#include "PublisherQos.h"
 
 #include <string>
 
@@ -50,6 +51,7 @@ namespace ros2 {
 // 获取默认的领域参与者服务质量配置对象，并通过调用其 name 函数设置名称为类中的 _name 成员变量（具体在构造函数中赋值）
     efd::DomainParticipantQos pqos = efd::PARTICIPANT_QOS_DEFAULT;
     pqos.name(_name);
+    ApplyParticipantQos(pqos, _qos);
     // 获取领域参与者工厂的单例实例，用于后续创建领域参与者对象
     auto factory = efd::DomainParticipantFactory::get_instance();
     // 使用工厂创建领域参与者对象，传入领域 ID（这里为 0）和服务质量配置对象，如果创建失败则输出错误信息并返回 false
@@ -84,6 +86,7 @@ namespace ros2 {
     }
 // 获取默认的数据写入器服务质量配置对象
     efd::DataWriterQos wqos = efd::DATAWRITER_QOS_DEFAULT;
+    ApplyDataWriterQos(wqos, _qos);
     wqos.endpoint().history_memory_policy = eprosima::fastrtps::rtps::PREALLOCATED_WITH_REALLOC_MEMORY_MODE;
     efd::DataWriterListener* listener = (efd::DataWriterListener*)_impl->_listener._impl.get();
     _impl->_datawriter = _impl->_publisher->create_datawriter(_impl->_topic, wqos, listener);
@@ -2,6 +2,7 @@
 // 定义了一个宏，用于设置C++标准库的ABI（应用程序二进制接口）版本为0，这可能与代码所依赖的库的编译设置相关。
 
 #include "CarlaMapSensorPublisher.h"
+#include "PublisherQos.h"
 #include <string>
 #include "carla/ros2/types/StringPubSubTypes.h"
 #include "carla/ros2/listeners/CarlaListener.h"
@@ -49,6 +50,7 @@ namespace ros2 {
 
         efd::DomainParticipantQos pqos = efd::PARTICIPANT_QOS_DEFAULT;
         pqos.name(_name);
+        ApplyParticipantQos(pqos, _qos);
         auto factory = efd::DomainParticipantFactory::get_instance();
         _impl->_participant = factory->create_participant(0, pqos);
         if (_impl->_participant == nullptr) {
@@ -83,6 +85,7 @@ namespace ros2 {
         // 如果创建失败则输出错误信息并返回false。
 
         efd::DataWriterQos wqos = efd::DATAWRITER_QOS_DEFAULT;
+        ApplyDataWriterQos(wqos, _qos);
         wqos.endpoint().history_memory_policy = eprosima::fastrtps::rtps::PREALLOCATED_WITH_REALLOC_MEMORY_MODE;
         efd::DataWriterListener* listener = (efd::DataWriterListener*)_impl->_listener._impl.get();
         _impl->_datawriter = _impl->_publisher->create_datawriter(_impl->_topic, wqos, listener);
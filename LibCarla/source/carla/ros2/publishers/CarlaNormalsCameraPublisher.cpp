@@ -1,6 +1,7 @@
 #define _GLIBCXX_USE_CXX11_ABI 0
 
 #include "CarlaNormalsCameraPublisher.h"// 包含CarlaNormalsCameraPublisher类的声明
+#include "PublisherQos.h"
 
 #include <string>// 包含字符串类
 // 包含Carla ROS2类型定义
@@ -157,6 +158,7 @@ namespace ros2 {
     // 设置DomainParticipant的QoS策略，并创建DomainParticipant
     efd::DomainParticipantQos pqos = efd::PARTICIPANT_QOS_DEFAULT;
     pqos.name(_name);// 设置DomainParticipant的名称
+    ApplyParticipantQos(pqos, _qos);
     auto factory = efd::DomainParticipantFactory::get_instance();
     _impl->_participant = factory->create_participant(0, pqos);// 创建DomainParticipant
     if (_impl->_participant == nullptr) {
@@ -187,6 +189,7 @@ namespace ros2 {
     }
     // 设置DataWriter的QoS策略，并创建DataWriter
     efd::DataWriterQos wqos = efd::DATAWRITER_QOS_DEFAULT;
+    ApplyDataWriterQos(wqos, _qos);
     wqos.endpoint().history_memory_policy = eprosima::fastrtps::rtps::PREALLOCATED_WITH_REALLOC_MEMORY_MODE;// 设置历史内存策略为预分配并允许重新分配
     efd::DataWriterListener* listener = (efd::DataWriterListener*)_impl->_listener._impl.get();// 获取DataWriter监听器
     _impl->_datawriter = _impl->_publisher->create_datawriter(_impl->_topic, wqos, listener);// 创建DataWriter
@@ -212,6 +215,7 @@ namespace ros2 {
     // 设置DomainParticipant的QoS策略，并创建DomainParticipant
     efd::DomainParticipantQos pqos = efd::PARTICIPANT_QOS_DEFAULT;
     pqos.name(_name);// 设置DomainParticipant的名称
+    ApplyParticipantQos(pqos, _qos);
     auto factory = efd::DomainParticipantFactory::get_instance();
     _impl_info->_participant = factory->create_participant(0, pqos);// 创建DomainParticipant
     if (_impl_info->_participant == nullptr) {
@@ -241,6 +245,7 @@ namespace ros2 {
         return false;// 返回false表示初始化失败
     }// 设置DataWriter的QoS策略，并创建DataWriter
     efd::DataWriterQos wqos = efd::DATAWRITER_QOS_DEFAULT;
+    ApplyDataWriterQos(wqos, _qos);
     efd::DataWriterListener* listener = (efd::DataWriterListener*)_impl_info->_listener._impl.get();// 获取DataWriter监听器
     _impl_info->_datawriter = _impl_info->_publisher->create_datawriter(_impl_info->_topic, wqos, listener);// 创建DataWriter
     if (_impl_info->_datawriter == nullptr) {
@@ -411,10 +416,11 @@ namespace ros2 {
  * @param width 图像的宽度
  * @param data 指向图像数据的指针
  */
-  void CarlaNormalsCameraPublisher::SetImageData(int32_t seconds, uint32_t nanoseconds, size_t height, size_t width, const uint8_t* data) {    std::vector<uint8_t> vector_data;
+  void CarlaNormalsCameraPublisher::SetImageData(int32_t seconds, uint32_t nanoseconds, size_t height, size_t width, const uint8_t* data) {
+    // 复用消息中上一帧的缓冲区，不再每帧分配并清零新的 vector
+    std::vector<uint8_t> vector_data = std::move(_impl->_image.data());
     const size_t size = height * width * 4;
-    vector_data.resize(size);
-    std::memcpy(&vector_data[0], &data[0], size);
+    vector_data.assign(data, data + size);
     SetData(seconds, nanoseconds,height, width, std::move(vector_data));
   }
   /**
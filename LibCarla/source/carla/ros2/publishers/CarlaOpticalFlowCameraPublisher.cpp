@@ -1,6 +1,7 @@
 #define _GLIBCXX_USE_CXX11_ABI 0
 
 #include "CarlaOpticalFlowCameraPublisher.h"// 引入Carla光流相机发布者的头文件
+#include "PublisherQos.h"
 
 #include <string>// 引入字符串处理的标准库
 #include <cmath>// 引入数学计算的标准库（可能用于图像处理或数据转换）
@@ -132,6 +133,7 @@ namespace ros2 {
     /// 设置DomainParticipant的QoS策略为默认值，并设置名称。
     efd::DomainParticipantQos pqos = efd::PARTICIPANT_QOS_DEFAULT;
     pqos.name(_name);
+    ApplyParticipantQos(pqos, _qos);
     /// 获取DomainParticipantFactory的实例。
     auto factory = efd::DomainParticipantFactory::get_instance();
     /// 创建DomainParticipant。
@@ -171,6 +173,7 @@ namespace ros2 {
     }
     /// 设置DataWriter的QoS策略为默认值，并修改历史内存策略。
     efd::DataWriterQos wqos = efd::DATAWRITER_QOS_DEFAULT;
+    ApplyDataWriterQos(wqos, _qos);
     wqos.endpoint().history_memory_policy = eprosima::fastrtps::rtps::PREALLOCATED_WITH_REALLOC_MEMORY_MODE;
     /// 获取DataWriter的监听器。
     efd::DataWriterListener* listener = (efd::DataWriterListener*)_impl->_listener._impl.get();
@@ -207,6 +210,7 @@ namespace ros2 {
      */
     efd::DomainParticipantQos pqos = efd::PARTICIPANT_QOS_DEFAULT;
     pqos.name(_name);
+    ApplyParticipantQos(pqos, _qos);
     auto factory = efd::DomainParticipantFactory::get_instance();
     _impl_info->_participant = factory->create_participant(0, pqos);
     /**
@@ -255,6 +259,7 @@ namespace ros2 {
      * 设置数据写入器的QoS策略，并创建一个数据写入器。
      */
     efd::DataWriterQos wqos = efd::DATAWRITER_QOS_DEFAULT;
+    ApplyDataWriterQos(wqos, _qos);
     efd::DataWriterListener* listener = (efd::DataWriterListener*)_impl_info->_listener._impl.get();
     _impl_info->_datawriter = _impl_info->_publisher->create_datawriter(_impl_info->_topic, wqos, listener);
     /**
@@ -476,9 +481,9 @@ namespace ros2 {
     constexpr float rad2ang = 360.0f/(2.0f*pi);
     // 计算最大索引值，即数据数组中的元素总数的一半（因为每个速度向量有两个分量）
     const size_t max_index = width * height * 2;
-    // 创建一个uint8_t类型的向量，用于存储最终的RGBA图像数据
-    std::vector<uint8_t> vector_data;
-    // 调整向量大小以匹配图像数据的总大小（每个像素4个字节，对应RGBA）
+    // 用于存储最终的RGBA图像数据的向量，复用消息中上一帧的缓冲区
+    std::vector<uint8_t> vector_data = std::move(_impl->_image.data());
+    // 调整向量大小以匹配图像数据的总大小（每个像素4个字节，对应RGBA），下面会写入每个字节
     vector_data.resize(height * width * 4);
     // 索引变量，用于遍历输入数据数组
     size_t data_index = 0;
@@ -7,6 +7,8 @@
 // 引入 C++ 标准字符串库，用于处理字符串相关操作
 #include <string>
 
+#include "carla/ros2/ROS2QosProfile.h"
+
 namespace carla {
 namespace ros2 {  
 // CarlaPublisher 类定义，作为发布者的基类，为具体类型发布者提供基础框架和通用接口
@@ -19,6 +21,9 @@ namespace ros2 {
       void frame_id(std::string&& frame_id) { _frame_id = std::move(frame_id); }  // 设置名称的函数，通过右值引用接受参数，使用 std::move 高效转移资源所有权，避免拷贝
       void name(std::string&& name) { _name = std::move(name); }   // 设置父级名称的函数，通过右值引用接受参数，使用 std::move 高效转移资源所有权，避免拷贝
       void parent(std::string&& parent) { _parent = std::move(parent); }  
+      // 传输和可靠性配置，需要在 Init() 之前设置
+      const ROS2QosProfile& qos() const { return _qos; }
+      void qos(const ROS2QosProfile& qos) { _qos = qos; }
     // 纯虚函数，用于获取发布者发布的数据类型，具体类型发布者必须实现此函数
       virtual const char* type() const = 0;
 
@@ -30,6 +35,7 @@ namespace ros2 {
       std::string _frame_id = "";//存储名称的字符串成员变量，初始化为空字符串
       std::string _name = "";   // 存储父级名称的字符串成员变量，初始化为空字符串
       std::string _parent = "";
+      ROS2QosProfile _qos;
   };
 }
 }
@@ -1,6 +1,7 @@
 #define _GLIBCXX_USE_CXX11_ABI 0
 // 包含Carla RGBCamera发布者相关的头文件，推测其中定义了CarlaRGBCameraPublisher类的声明等内容
 #include "CarlaRGBCameraPublisher.h"
+#include "PublisherQos.h"
 // 引入C++标准库中的字符串头文件，用于处理字符串相关操作
 #include <string>
 // 引入Carla项目中ROS2相关的图像发布/订阅类型定义头文件，用于在ROS2环境下处理图像数据的发布和订阅
@@ -89,6 +90,7 @@ namespace ros2 {
 
     efd::DomainParticipantQos pqos = efd::PARTICIPANT_QOS_DEFAULT;
     pqos.name(_name);
+    ApplyParticipantQos(pqos, _qos);
     auto factory = efd::DomainParticipantFactory::get_instance();
     _impl->_participant = factory->create_participant(0, pqos);
     if (_impl->_participant == nullptr) {
@@ -118,6 +120,7 @@ namespace ros2 {
         return false;
     }
     efd::DataWriterQos wqos = efd::DATAWRITER_QOS_DEFAULT;
+    ApplyDataWriterQos(wqos, _qos);
     wqos.endpoint().history_memory_policy = eprosima::fastrtps::rtps::PREALLOCATED_WITH_REALLOC_MEMORY_MODE;
     efd::DataWriterListener* listener = (efd::DataWriterListener*)_impl->_listener._impl.get();
     _impl->_datawriter = _impl->_publisher->create_datawriter(_impl->_topic, wqos, listener);
@@ -139,6 +142,7 @@ namespace ros2 {
 
     efd::DomainParticipantQos pqos = efd::PARTICIPANT_QOS_DEFAULT;
     pqos.name(_name);
+    ApplyParticipantQos(pqos, _qos);
     auto factory = efd::DomainParticipantFactory::get_instance();
     _impl_info->_participant = factory->create_participant(0, pqos);
     if (_impl_info->_participant == nullptr) {
@@ -168,6 +172,7 @@ namespace ros2 {
         return false;
     }
     efd::DataWriterQos wqos = efd::DATAWRITER_QOS_DEFAULT;
+    ApplyDataWriterQos(wqos, _qos);
     efd::DataWriterListener* listener = (efd::DataWriterListener*)_impl_info->_listener._impl.get();
     _impl_info->_datawriter = _impl_info->_publisher->create_datawriter(_impl_info->_topic, wqos, listener);
     if (_impl_info->_datawriter == nullptr) {
@@ -312,10 +317,10 @@ namespace ros2 {
   }
 
 void CarlaRGBCameraPublisher::SetImageData(int32_t seconds, uint32_t nanoseconds, uint32_t height, uint32_t width, const uint8_t* data) {
-    std::vector<uint8_t> vector_data;
+    // 复用消息中上一帧的缓冲区，不再每帧分配并清零新的 vector
+    std::vector<uint8_t> vector_data = std::move(_impl->_image.data());
     const size_t size = height * width * 4;
-    vector_data.resize(size);
-    std::memcpy(&vector_data[0], &data[0], size);
+    vector_data.assign(data, data + size);
     SetImageData(seconds, nanoseconds, height, width, std::move(vector_data));
   }
 
@@ -1,6 +1,7 @@
 #define _GLIBCXX_USE_CXX11_ABI 0
 
 #include "CarlaRadarPublisher.h"
+#include "PublisherQos.h"
 
 #include <string>
 
@@ -114,6 +115,7 @@ namespace ros2 {
    */
     efd::DomainParticipantQos pqos = efd::PARTICIPANT_QOS_DEFAULT;
     pqos.name(_name); // 设置域参与者的名称
+    ApplyParticipantQos(pqos, _qos);
     auto factory = efd::DomainParticipantFactory::get_instance();
     _impl->_participant = factory->create_participant(0, pqos);
     /**
@@ -169,6 +171,7 @@ namespace ros2 {
    * 设置数据写入器（DataWriter）的质量服务（Qos）参数，使用默认值，并设置历史内存策略为预分配并重新分配模式。
    */
     efd::DataWriterQos wqos = efd::DATAWRITER_QOS_DEFAULT;
+    ApplyDataWriterQos(wqos, _qos);
     wqos.endpoint().history_memory_policy = eprosima::fastrtps::rtps::PREALLOCATED_WITH_REALLOC_MEMORY_MODE;
     /**
   * 获取数据写入器监听器实例。
@@ -292,8 +295,8 @@ namespace ros2 {
  * @param data 指向雷达检测数据的指针，数据格式为carla::sensor::data::RadarDetection
  */
 void CarlaRadarPublisher::SetData(int32_t seconds, uint32_t nanoseconds, size_t height, size_t width, size_t elements, const uint8_t* data) {
-    // 创建一个用于存储转换后数据的向量
-    std::vector<uint8_t> vector_data;
+    // 创建一个用于存储转换后数据的向量，复用消息中上一帧的缓冲区
+    std::vector<uint8_t> vector_data = std::move(_impl->_radar.data());
     // 计算需要存储的数据大小
     const size_t size = elements * sizeof(RadarDetectionWithPosition);
     // 调整向量大小以适应数据
@@ -1,6 +1,7 @@
 #define _GLIBCXX_USE_CXX11_ABI 0
 
 #include "CarlaSSCameraPublisher.h"// 引入CarlaSSCameraPublisher类的声明
+#include "PublisherQos.h"
 
 #include <string>// 引入标准字符串库
 // 引入CARLA ROS2桥接器中定义的图像和相机信息类型的PubSubTypes
@@ -159,6 +160,7 @@ namespace ros2 {
     }
     efd::DomainParticipantQos pqos = efd::PARTICIPANT_QOS_DEFAULT;
     pqos.name(_name);
+    ApplyParticipantQos(pqos, _qos);
     auto factory = efd::DomainParticipantFactory::get_instance();
     _impl->_participant = factory->create_participant(0, pqos);
     if (_impl->_participant == nullptr) {
@@ -189,6 +191,7 @@ namespace ros2 {
     }
 
     efd::DataWriterQos wqos = efd::DATAWRITER_QOS_DEFAULT;
+    ApplyDataWriterQos(wqos, _qos);
     wqos.endpoint().history_memory_policy = eprosima::fastrtps::rtps::PREALLOCATED_WITH_REALLOC_MEMORY_MODE;
     efd::DataWriterListener* listener = (efd::DataWriterListener*)_impl->_listener._impl.get();
     _impl->_datawriter = _impl->_publisher->create_datawriter(_impl->_topic, wqos, listener);
@@ -220,6 +223,7 @@ namespace ros2 {
     */
     efd::DomainParticipantQos pqos = efd::PARTICIPANT_QOS_DEFAULT;
     pqos.name(_name);
+    ApplyParticipantQos(pqos, _qos);
     /**
     * 获取DomainParticipantFactory的实例，并创建一个DomainParticipant。
     */
@@ -274,6 +278,7 @@ namespace ros2 {
     * 设置DataWriter的QoS参数为默认值，并创建一个DataWriter。
     */
     efd::DataWriterQos wqos = efd::DATAWRITER_QOS_DEFAULT;
+    ApplyDataWriterQos(wqos, _qos);
     efd::DataWriterListener* listener = (efd::DataWriterListener*)_impl_info->_listener._impl.get();
     _impl_info->_datawriter = _impl_info->_publisher->create_datawriter(_impl_info->_topic, wqos, listener);
     /**
@@ -454,10 +459,10 @@ namespace ros2 {
  * @param data 图像数据的指针，假设为BGRA格式
  */
   void CarlaSSCameraPublisher::SetImageData(int32_t seconds, uint32_t nanoseconds, size_t height, size_t width, const uint8_t* data) {
-    std::vector<uint8_t> vector_data;
+    // 复用消息中上一帧的缓冲区，不再每帧分配并清零新的 vector
+    std::vector<uint8_t> vector_data = std::move(_impl->_image.data());
     const size_t size = height * width * 4;
-    vector_data.resize(size);
-    std::memcpy(&vector_data[0], &data[0], size);
+    vector_data.assign(data, data + size);
     SetData(seconds, nanoseconds, height, width, std::move(vector_data));
   }
   /**
@@ -1,6 +1,7 @@
 #define _GLIBCXX_USE_CXX11_ABI 0
 
 #include "CarlaSemanticLidarPublisher.h"// 引入Carla语义激光雷达发布者类的声明
+#include "PublisherQos.h"
 
 #include <string>// 引入字符串处理相关的标准库
 // 引入CARLA ROS2桥接库中的点云数据类型和监听器类
@@ -68,6 +69,7 @@ namespace ros2 {
     // 设置域参与者的QoS策略，并创建域参与者
     efd::DomainParticipantQos pqos = efd::PARTICIPANT_QOS_DEFAULT;
     pqos.name(_name);
+    ApplyParticipantQos(pqos, _qos);
     auto factory = efd::DomainParticipantFactory::get_instance();
     _impl->_participant = factory->create_participant(0, pqos);
     if (_impl->_participant == nullptr) {
@@ -97,6 +99,7 @@ namespace ros2 {
     }
     // 设置数据写入器的QoS策略，并创建数据写入器
     efd::DataWriterQos wqos = efd::DATAWRITER_QOS_DEFAULT;
+    ApplyDataWriterQos(wqos, _qos);
     wqos.endpoint().history_memory_policy = eprosima::fastrtps::rtps::PREALLOCATED_WITH_REALLOC_MEMORY_MODE;
     efd::DataWriterListener* listener = (efd::DataWriterListener*)_impl->_listener._impl.get();
     _impl->_datawriter = _impl->_publisher->create_datawriter(_impl->_topic, wqos, listener);
@@ -212,14 +215,13 @@ void CarlaSemanticLidarPublisher::SetData(int32_t seconds, uint32_t nanoseconds,
     for (++it; it < end; it += elements) {
         *it *= -1.0f;
     }
-    // 用于存储转换后的字节数据的向量
-    std::vector<uint8_t> vector_data;
+    // 用于存储转换后的字节数据的向量，复用消息中上一帧的缓冲区
+    std::vector<uint8_t> vector_data = std::move(_impl->_lidar.data());
     // 计算需要存储的字节数据的大小
     const size_t size = height * width * sizeof(float) * elements;
-    // 调整向量的大小以匹配数据大小
-    vector_data.resize(size);
     // 将浮点数据复制到字节数据向量中
-    std::memcpy(&vector_data[0], &data[0], size);
+    const uint8_t *bytes = reinterpret_cast<const uint8_t *>(data);
+    vector_data.assign(bytes, bytes + size);
     // 调用另一个重载的SetData函数来设置处理后的数据
     SetData(seconds, nanoseconds, height, width, std::move(vector_data));
 }
@@ -8,6 +8,7 @@
   * @brief 包含CARLA车速传感器的头文件。
   */
 #include "CarlaSpeedometerSensor.h"
+#include "PublisherQos.h"
   /**
    * @brief 包含标准字符串库。
    */
@@ -145,6 +146,7 @@ namespace ros2 {
      */
     efd::DomainParticipantQos pqos = efd::PARTICIPANT_QOS_DEFAULT;
     pqos.name(_name);
+    ApplyParticipantQos(pqos, _qos);
     auto factory = efd::DomainParticipantFactory::get_instance();
     _impl->_participant = factory->create_participant(0, pqos);
     if (_impl->_participant == nullptr) {
@@ -182,6 +184,7 @@ namespace ros2 {
      * @brief 设置DataWriter的QoS策略，并创建DataWriter。
      */
     efd::DataWriterQos wqos = efd::DATAWRITER_QOS_DEFAULT;
+    ApplyDataWriterQos(wqos, _qos);
     wqos.endpoint().history_memory_policy = eprosima::fastrtps::rtps::PREALLOCATED_WITH_REALLOC_MEMORY_MODE;
     efd::DataWriterListener* listener = (efd::DataWriterListener*)_impl->_listener._impl.get();
     _impl->_datawriter = _impl->_publisher->create_datawriter(_impl->_topic, wqos, listener);
@@ -1,6 +1,7 @@
 #define _GLIBCXX_USE_CXX11_ABI 0
 
 #include "CarlaTransformPublisher.h"// 包含CarlaTransformPublisher类的声明
+#include "PublisherQos.h"
 
 #include <string>// 包含字符串处理功能
 // 包含CARLA ROS2类型定义和监听器类
@@ -85,6 +86,7 @@ namespace ros2 {
      */
     efd::DomainParticipantQos pqos = efd::PARTICIPANT_QOS_DEFAULT;
     pqos.name(_name);
+    ApplyParticipantQos(pqos, _qos);
     auto factory = efd::DomainParticipantFactory::get_instance();
     _impl->_participant = factory->create_participant(0, pqos);
     /**
@@ -128,6 +130,7 @@ namespace ros2 {
      * 将history_memory_policy设置为PREALLOCATED_WITH_REALLOC_MEMORY_MODE。
      */
     efd::DataWriterQos wqos = efd::DATAWRITER_QOS_DEFAULT;
+    ApplyDataWriterQos(wqos, _qos);
     wqos.endpoint().history_memory_policy = eprosima::fastrtps::rtps::PREALLOCATED_WITH_REALLOC_MEMORY_MODE;
     efd::DataWriterListener* listener = (efd::DataWriterListener*)_impl->_listener._impl.get();
     _impl->_datawriter = _impl->_publisher->create_datawriter(_impl->_topic, wqos, listener);
@@ -306,6 +309,20 @@ namespace ros2 {
     // 更新内部存储的Transform集合
     _impl->_transform.transforms({ts});
   }
+
+  void CarlaTransformPublisher::AddTransforms(const CarlaTransformPublisher& other) {
+    const auto &transforms = other._impl->_transform.transforms();
+    _impl->_transform.transforms().insert(_impl->_transform.transforms().end(), transforms.begin(), transforms.end());
+  }
+
+  void CarlaTransformPublisher::ClearTransforms() {
+    // 保留容量，下一帧不再重新分配
+    _impl->_transform.transforms().clear();
+  }
+
+  size_t CarlaTransformPublisher::GetTransformCount() const {
+    return _impl->_transform.transforms().size();
+  }
   /**
  * @brief CarlaTransformPublisher 类的构造函数
  *
@@ -318,6 +335,8 @@ namespace ros2 {
   _impl(std::make_shared<CarlaTransformPublisherImpl>()) {
     _name = ros_name;
     _parent = parent;
+    // 只用于生成变换、不调用 Init() 的发布者也需要子帧ID
+    _frame_id = _name;
   }
   /**
  * @brief CarlaTransformPublisher 类的析构函数
@@ -80,6 +80,20 @@ namespace ros2 {
              * @param rotation 变换的旋转部分，数组包含roll, pitch, yaw三个分量。
              */
       void SetData(int32_t seconds, uint32_t nanoseconds, const float* translation, const float* rotation);
+      /**
+             * @brief 把 @a other 最近一次 SetData 生成的变换追加到要发布的消息中。
+             *
+             * 每帧所有传感器的变换合并到一个 TFMessage 中发布，@a other 不需要初始化 DDS。
+             */
+      void AddTransforms(const CarlaTransformPublisher& other);
+      /**
+             * @brief 清空要发布的消息中的变换。
+             */
+      void ClearTransforms();
+      /**
+             * @brief 要发布的消息中的变换数量。
+             */
+      size_t GetTransformCount() const;
       /**
              * @brief 重写type函数，返回当前对象的类型字符串。
              * @return 返回"transform"字符串，表示当前对象发布的消息类型为变换信息。
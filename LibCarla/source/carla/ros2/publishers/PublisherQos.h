@@ -0,0 +1,83 @@
+// Copyright (c) 2023 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/ros2/ROS2QosProfile.h"
+
+#include <fastdds/dds/domain/qos/DomainParticipantQos.hpp>
+#include <fastdds/dds/publisher/qos/DataWriterQos.hpp>
+#include <fastdds/rtps/transport/UDPv4TransportDescriptor.h>
+#include <fastdds/rtps/transport/shared_mem/SharedMemTransportDescriptor.h>
+
+#include <memory>
+
+namespace carla {
+namespace ros2 {
+
+  /// 共享内存段的大小，足够放下几帧 4K BGRA 图像
+  static constexpr uint32_t ROS2_SHM_SEGMENT_SIZE = 128u * 1024u * 1024u;
+
+  /// UDP 套接字的发送和接收缓冲区大小
+  static constexpr uint32_t ROS2_UDP_BUFFER_SIZE = 8u * 1024u * 1024u;
+
+  /// 按 @a profile 设置域参与者的传输。
+  inline void ApplyParticipantQos(
+      eprosima::fastdds::dds::DomainParticipantQos &pqos,
+      const ROS2QosProfile &profile) {
+    using namespace eprosima::fastdds::rtps;
+    switch (profile.transport) {
+      case ROS2Transport::SharedMemory: {
+        auto shm = std::make_shared<SharedMemTransportDescriptor>();
+        shm->segment_size(ROS2_SHM_SEGMENT_SIZE);
+        pqos.transport().use_builtin_transports = false;
+        pqos.transport().user_transports.push_back(shm);
+        pqos.transport().user_transports.push_back(std::make_shared<UDPv4TransportDescriptor>());
+        break;
+      }
+      case ROS2Transport::Udp: {
+        auto udp = std::make_shared<UDPv4TransportDescriptor>();
+        udp->sendBufferSize = ROS2_UDP_BUFFER_SIZE;
+        udp->receiveBufferSize = ROS2_UDP_BUFFER_SIZE;
+        pqos.transport().use_builtin_transports = false;
+        pqos.transport().user_transports.push_back(udp);
+        pqos.transport().send_socket_buffer_size = ROS2_UDP_BUFFER_SIZE;
+        pqos.transport().listen_socket_buffer_size = ROS2_UDP_BUFFER_SIZE;
+        break;
+      }
+      case ROS2Transport::Default:
+        break;
+    }
+  }
+
+  /// 按 @a profile 设置数据写入器的可靠性、历史和发送模式。
+  inline void ApplyDataWriterQos(
+      eprosima::fastdds::dds::DataWriterQos &wqos,
+      const ROS2QosProfile &profile) {
+    namespace efd = eprosima::fastdds::dds;
+    switch (profile.reliability) {
+      case ROS2Reliability::SensorData:
+        wqos.reliability().kind = efd::BEST_EFFORT_RELIABILITY_QOS;
+        wqos.history().kind = efd::KEEP_LAST_HISTORY_QOS;
+        wqos.history().depth = 1;
+        break;
+      case ROS2Reliability::Reliable:
+        wqos.reliability().kind = efd::RELIABLE_RELIABILITY_QOS;
+        wqos.history().kind = efd::KEEP_LAST_HISTORY_QOS;
+        wqos.history().depth = 10;
+        break;
+      case ROS2Reliability::Auto:
+      case ROS2Reliability::Default:
+        break;
+    }
+    if (profile.transport == ROS2Transport::Udp) {
+      // 大消息分片后在 Fast-DDS 的线程中发送，不阻塞 write()
+      wqos.publish_mode().kind = efd::ASYNCHRONOUS_PUBLISH_MODE;
+    }
+  }
+
+} // namespace ros2
+} // namespace carla
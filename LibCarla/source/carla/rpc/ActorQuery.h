@@ -0,0 +1,91 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/MsgPack.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace carla {
+namespace rpc {
+
+  /// @brief query_actors 返回的一列数据。
+  ///
+  /// 每个参与者占一行，每行由 @a width 个大小为 @a element_size 字节的元素组成，
+  /// 所有行紧密排列在 @a data 中，以msgpack的bin类型整块传输。
+  class ActorQueryColumn {
+  public:
+
+    ActorQueryColumn() = default;
+
+    ActorQueryColumn(std::string in_field, char in_kind, uint8_t in_element_size, uint32_t in_width)
+      : field(std::move(in_field)),
+        kind(static_cast<uint8_t>(in_kind)),
+        element_size(in_element_size),
+        width(in_width) {}
+
+    /// 字段名，例如 "transform"。
+    std::string field;
+
+    /// 元素的类型，与numpy的类型字符一致：'f' 为浮点数，'u' 为无符号整数。
+    uint8_t kind = 0u;
+
+    uint8_t element_size = 0u;
+
+    uint32_t width = 0u;
+
+    std::vector<unsigned char> data;
+
+    size_t size() const {
+      const size_t row_size = element_size * width;
+      return row_size == 0u ? 0u : data.size() / row_size;
+    }
+
+    template <typename T>
+    void Append(const T &value) {
+      const auto *begin = reinterpret_cast<const unsigned char *>(&value);
+      data.insert(data.end(), begin, begin + sizeof(T));
+    }
+
+    MSGPACK_DEFINE_ARRAY(field, kind, element_size, width, data);
+  };
+
+  /// @brief query_actors 的结果，按列存储多个参与者的属性。
+  ///
+  /// 第一列总是 "id"，不存在的参与者不出现在结果中。支持的字段及每行的内容：
+  ///   - "transform"：x, y, z, pitch, yaw, roll（米、度）；
+  ///   - "velocity"：x, y, z（米/秒）；
+  ///   - "angular_velocity"：x, y, z（度/秒）；
+  ///   - "bbox"：location x, y, z, extent x, y, z, pitch, yaw, roll（米、度）；
+  ///   - "light_state"：车辆的灯光状态标志位，不是车辆时为0。
+  class ActorQueryResult {
+  public:
+
+    std::vector<ActorQueryColumn> columns;
+
+    /// 行数，即找到的参与者的数量。
+    size_t size() const {
+      return columns.empty() ? 0u : columns.front().size();
+    }
+
+    /// 返回名为 @a field 的列，不存在时返回nullptr。
+    const ActorQueryColumn *Find(const std::string &field) const {
+      for (const auto &column : columns) {
+        if (column.field == field) {
+          return &column;
+        }
+      }
+      return nullptr;
+    }
+
+    MSGPACK_DEFINE_ARRAY(columns);
+  };
+
+} // namespace rpc
+} // namespace carla
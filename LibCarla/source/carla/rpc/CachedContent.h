@@ -0,0 +1,57 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/MsgPack.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace carla {
+namespace rpc {
+
+  /// @brief 按内容哈希有条件获取的数据，用于地图和蓝图库等较大且很少变化的数据。
+  ///
+  /// 客户端发送本地缓存内容的哈希，与服务器当前内容的哈希相同时
+  /// @a not_modified 为true且不传输 @a content，类似HTTP的If-None-Match。
+  class CachedContent {
+  public:
+
+    /// 内容的64位FNV-1a哈希，以16个小写十六进制字符表示。
+    static std::string ComputeHash(const uint8_t *data, size_t size) {
+      uint64_t hash = 14695981039346656037ull;
+      for (size_t i = 0u; i < size; ++i) {
+        hash ^= data[i];
+        hash *= 1099511628211ull;
+      }
+      static constexpr char digits[] = "0123456789abcdef";
+      std::string result(16u, '0');
+      for (size_t i = 16u; i > 0u; --i) {
+        result[i - 1u] = digits[hash & 0xFu];
+        hash >>= 4u;
+      }
+      return result;
+    }
+
+    static std::string ComputeHash(const std::vector<uint8_t> &data) {
+      return ComputeHash(data.data(), data.size());
+    }
+
+    /// 服务器当前内容的哈希。
+    std::string hash;
+
+    bool not_modified = false;
+
+    /// @a not_modified 为true时为空。
+    std::vector<uint8_t> content;
+
+    MSGPACK_DEFINE_ARRAY(hash, not_modified, content);
+  };
+
+} // namespace rpc
+} // namespace carla
@@ -69,6 +69,13 @@ namespace carla {
             void async_call(const std::string &function, Args &&... args) {
                 _client.async_call(function, Metadata::MakeAsync(), std::forward<Args>(args)...);
             }
+            // 发起一个需要响应的调用但不等待，返回响应的future。
+            // 请求与响应按ID匹配，同一个连接上可以同时有多个未完成的调用，
+            // 服务器会在游戏线程的同一轮处理中依次回答它们。
+            template <typename... Args>
+            auto pipelined_call(const std::string &function, Args &&... args) {
+                return _client.async_call(function, Metadata::MakeSync(), std::forward<Args>(args)...);
+            }
 
         private:
             // 定义了一个私有成员变量 _client，类型为 ::rpc::client，
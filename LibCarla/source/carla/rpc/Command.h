@@ -135,6 +135,20 @@ namespace rpc {	// 定义rpc命名空间，用于存放远程过程调用（RPC
       MSGPACK_DEFINE_ARRAY(actor, transform);// 使用MSGPACK_DEFINE_ARRAY宏定义如何对ApplyTransform结构体中的成员进行MsgPack序列化和反序列化
     };
 
+    /// 运动学车辆的目标：车辆不模拟物理，服务器每帧按 @a velocity 的速率把车辆移向
+    /// @a transform，到达后停在那里。车辆第一次收到目标时关闭物理，重新启用物理时恢复。
+    struct ApplyKinematicTarget : CommandBase<ApplyKinematicTarget> {
+      ApplyKinematicTarget() = default;
+      ApplyKinematicTarget(ActorId id, const geom::Transform &value, const geom::Vector3D &in_velocity)
+        : actor(id),
+          transform(value),
+          velocity(in_velocity) {}
+      ActorId actor;
+      geom::Transform transform;
+      geom::Vector3D velocity;
+      MSGPACK_DEFINE_ARRAY(actor, transform, velocity);
+    };
+
     struct ApplyLocation : CommandBase<ApplyLocation> {// 定义ApplyLocation结构体，表示应用位置信息到角色上的命令结构体，继承自CommandBase<ApplyLocation>
       ApplyLocation() = default; // 默认构造函数，创建一个默认初始化的ApplyLocation命令对象
       ApplyLocation(ActorId id, const geom::Location &value) // 构造函数，传入要应用位置的角色的ID以及具体的位置信息
@@ -314,7 +328,8 @@ namespace rpc {	// 定义rpc命名空间，用于存放远程过程调用（RPC
         SetVehicleLightState,
         ApplyLocation,
         ConsoleCommand,
-        SetTrafficLightState>;
+        SetTrafficLightState,
+        ApplyKinematicTarget>;
 
     CommandType command;// 定义一个CommandType类型的变量command，它可以存储上述各种不同命令类型中的任意一种实例。
 
@@ -13,6 +13,9 @@
 #include "carla/geom/Rotation.h"
 #include "carla/rpc/Color.h"
 
+#include <cstdint>
+#include <vector>
+
 #ifdef _MSC_VER
 #pragma warning(push)
 #pragma warning(disable:4583)
@@ -114,5 +117,27 @@ namespace rpc {
     MSGPACK_DEFINE_ARRAY(primitive, color, life_time, persistent_lines);
   };
 
+  /// 一组持久的调试形状。同一客户端用相同的 id 再次绘制时替换之前的形状，
+  /// 没有任何形状时删除该 id。形状一直保留到被替换或清除。
+  class DebugShapeBatch {
+  public:
+
+    uint64_t id = 0u;
+
+    std::vector<DebugShape::Line> lines;
+
+    std::vector<DebugShape::Point> points;
+
+    std::vector<DebugShape::Box> boxes;
+
+    Color color = {255u, 0u, 0u};
+
+    bool IsEmpty() const {
+      return lines.empty() && points.empty() && boxes.empty();
+    }
+
+    MSGPACK_DEFINE_ARRAY(id, lines, points, boxes, color);
+  };
+
 } // namespace rpc
 } // namespace carla
\ No newline at end of file
@@ -0,0 +1,83 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/MsgPack.h"
+#include "carla/rpc/ActorId.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace carla {
+namespace rpc {
+
+  /// @brief 客户端关心的参与者集合。
+  ///
+  /// 服务器为每个兴趣集合单独序列化剧集状态，只包含集合中的参与者。
+  /// 一个参与者满足以下任一条件即包含在内：
+  ///   - 在 @a actor_ids 中，或者是 @a center_actor；
+  ///   - 指定了 @a radius 或 @a actor_types
+  ///     时，距 @a center_actor 不超过 @a radius （未指定时不限距离）
+  ///     并且类型匹配 @a actor_types 中的任一通配符（未指定时不限类型）。
+  ///
+  /// @a extensions 中请求的扩展数据随剧集状态一起发送，只包含集合中的参与者。
+  class EpisodeInterest {
+  public:
+
+    /// 剧集状态中可选的扩展数据，可以按位组合。
+    enum Extension : uint32_t {
+      NoExtensions     = 0u,
+      /// 车辆的灯光状态和车轮转向角，见 sensor::data::ActorExtensionState。
+      VehicleExtension = (0x1u << 0)
+    };
+
+    /// 距离过滤的中心，为0时不按距离过滤。
+    ActorId center_actor = 0u;
+
+    /// 距离过滤的半径，单位为米，不大于0时不按距离过滤。
+    float radius = 0.0f;
+
+    /// 类型过滤的通配符，例如 "vehicle.*"，为空时不按类型过滤。
+    std::vector<std::string> actor_types;
+
+    /// 总是包含的参与者。
+    std::vector<ActorId> actor_ids;
+
+    /// 请求的扩展数据，Extension 的按位组合。
+    uint32_t extensions = NoExtensions;
+
+    bool HasExtension(Extension extension) const {
+      return (extensions & extension) != 0u;
+    }
+
+    bool HasRadiusFilter() const {
+      return (center_actor != 0u) && (radius > 0.0f);
+    }
+
+    bool HasTypeFilter() const {
+      return !actor_types.empty();
+    }
+
+    bool operator==(const EpisodeInterest &rhs) const {
+      return
+          (center_actor == rhs.center_actor) &&
+          (radius == rhs.radius) &&
+          (actor_types == rhs.actor_types) &&
+          (actor_ids == rhs.actor_ids) &&
+          (extensions == rhs.extensions);
+    }
+
+    bool operator!=(const EpisodeInterest &rhs) const {
+      return !(*this == rhs);
+    }
+
+    MSGPACK_DEFINE_ARRAY(center_actor, radius, actor_types, actor_ids, extensions);
+  };
+
+} // namespace rpc
+} // namespace carla
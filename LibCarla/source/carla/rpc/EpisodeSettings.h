@@ -60,10 +60,13 @@ namespace rpc {
     // 是否将观众视为自我，默认为 true
     bool spectator_as_ego = true;
 
+    // 一帧交给物理引擎的最长时间，更长的帧按这个时间模拟（物理比仿真时间慢）
+    double max_physics_delta_time = 1.0 / 3.0;
+
     // 使用 MSGPACK_DEFINE_ARRAY 宏将类的成员变量按顺序打包到 msgpack 中，用于序列化
     MSGPACK_DEFINE_ARRAY(synchronous_mode, no_rendering_mode, fixed_delta_seconds, substepping,
         max_substep_delta_time, max_substeps, max_culling_distance, deterministic_ragdolls,
-        tile_stream_distance, actor_active_distance, spectator_as_ego);
+        tile_stream_distance, actor_active_distance, spectator_as_ego, max_physics_delta_time);
 
     // =========================================================================
     // -- 构造函数 --------------------------------------------------------------
@@ -84,7 +87,8 @@ namespace rpc {
         bool deterministic_ragdolls = true,
         float tile_stream_distance = 3000.f,
         float actor_active_distance = 2000.f,
-        bool spectator_as_ego = true)
+        bool spectator_as_ego = true,
+        double max_physics_delta_time = 1.0 / 3.0)
       : synchronous_mode(synchronous_mode),
         no_rendering_mode(no_rendering_mode),
         fixed_delta_seconds(
@@ -96,7 +100,8 @@ namespace rpc {
         deterministic_ragdolls(deterministic_ragdolls),
         tile_stream_distance(tile_stream_distance),
         actor_active_distance(actor_active_distance),
-        spectator_as_ego(spectator_as_ego) {}
+        spectator_as_ego(spectator_as_ego),
+        max_physics_delta_time(max_physics_delta_time) {}
 
     // =========================================================================
     // -- 比较操作符 ------------------------------------------------------------
@@ -115,7 +120,8 @@ namespace rpc {
           (deterministic_ragdolls == rhs.deterministic_ragdolls) &&
           (tile_stream_distance == rhs.tile_stream_distance) &&
           (actor_active_distance == rhs.actor_active_distance) &&
-          (spectator_as_ego == rhs.spectator_as_ego);
+          (spectator_as_ego == rhs.spectator_as_ego) &&
+          (max_physics_delta_time == rhs.max_physics_delta_time);
     }
 
     // 重载!= 操作符，使用 == 操作符的结果取反
@@ -141,7 +147,8 @@ namespace rpc {
             Settings.bDeterministicRagdolls,
             Settings.TileStreamingDistance,
             Settings.ActorActiveDistance,
-            Settings.SpectatorAsEgo) {
+            Settings.SpectatorAsEgo,
+            Settings.MaxPhysicsDeltaTime) {
       constexpr float CMTOM = 1.f/100.f;
       tile_stream_distance = CMTOM * Settings.TileStreamingDistance;
       actor_active_distance = CMTOM * Settings.ActorActiveDistance;
@@ -164,6 +171,7 @@ namespace rpc {
       Settings.TileStreamingDistance = MTOCM * tile_stream_distance;
       Settings.ActorActiveDistance = MTOCM * actor_active_distance;
       Settings.SpectatorAsEgo = spectator_as_ego;
+      Settings.MaxPhysicsDeltaTime = max_physics_delta_time;
 
       return Settings;
     }
@@ -0,0 +1,75 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/MsgPack.h"
+#include "carla/rpc/CachedContent.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace carla {
+namespace rpc {
+
+  /// @brief 服务器上一个文件的大小和分块哈希，客户端据此分块并行下载文件，
+  /// 校验每一块，并在中断后只下载缺少的块。
+  class FileInfo {
+  public:
+
+    /// 默认的分块大小。
+    static constexpr uint32_t DEFAULT_CHUNK_SIZE = 4u * 1024u * 1024u;
+
+    /// 计算 @a data 的分块哈希。
+    static FileInfo Make(const uint8_t *data, uint64_t size, uint32_t chunk_size = DEFAULT_CHUNK_SIZE) {
+      FileInfo result;
+      result.size = size;
+      result.chunk_size = chunk_size;
+      for (uint64_t offset = 0u; offset < size; offset += chunk_size) {
+        const auto length = static_cast<size_t>(std::min<uint64_t>(chunk_size, size - offset));
+        result.chunk_hashes.emplace_back(CachedContent::ComputeHash(data + offset, length));
+      }
+      result.hash = ComputeFileHash(result.size, result.chunk_hashes);
+      return result;
+    }
+
+    /// 文件的哈希由大小和各块的哈希得到，不需要再读一遍文件。
+    static std::string ComputeFileHash(uint64_t size, const std::vector<std::string> &chunk_hashes) {
+      std::string text = std::to_string(size);
+      for (const auto &chunk_hash : chunk_hashes) {
+        text += chunk_hash;
+      }
+      return CachedContent::ComputeHash(reinterpret_cast<const uint8_t *>(text.data()), text.size());
+    }
+
+    size_t GetNumberOfChunks() const {
+      return chunk_hashes.size();
+    }
+
+    uint64_t GetChunkOffset(size_t chunk) const {
+      return static_cast<uint64_t>(chunk) * chunk_size;
+    }
+
+    uint32_t GetChunkLength(size_t chunk) const {
+      return static_cast<uint32_t>(std::min<uint64_t>(chunk_size, size - GetChunkOffset(chunk)));
+    }
+
+    uint64_t size = 0u;
+
+    uint32_t chunk_size = DEFAULT_CHUNK_SIZE;
+
+    /// 整个文件的哈希，见 ComputeFileHash。
+    std::string hash;
+
+    std::vector<std::string> chunk_hashes;
+
+    MSGPACK_DEFINE_ARRAY(size, chunk_size, hash, chunk_hashes);
+  };
+
+} // namespace rpc
+} // namespace carla
@@ -0,0 +1,88 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/MsgPack.h"
+#include "carla/geom/BoundingBox.h"
+#include "carla/rpc/ActorId.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace carla {
+namespace rpc {
+
+  /// 可以单独关闭的录制数据包，取值与录制文件中的数据包 id 相同。
+  enum class RecorderPacket : uint8_t {
+    Collision         = 5u,
+    Position          = 6u,
+    TrafficLightState = 7u,
+    VehicleAnimation  = 8u,
+    WalkerAnimation   = 9u,
+    VehicleLight      = 10u,
+    SceneLight        = 11u,
+    Kinematics        = 12u,
+    BoundingBox       = 13u,
+    PhysicsControl    = 15u,
+    TrafficLightTime  = 16u,
+    TriggerVolume     = 17u,
+    WalkerBones       = 19u,
+    VehicleDoor       = 21u,
+    VehicleWheels     = 22u,
+    BikerAnimation    = 23u
+  };
+
+  /// @brief 只录制一部分参与者和数据包。
+  ///
+  /// 在开始录制时设置。参与者满足以下全部条件时才会被录制：
+  ///   - 指定了 @a actor_types 或 @a actor_ids 时，类型匹配其中任一
+  ///     通配符，或者 id 在 @a actor_ids 中；
+  ///   - 指定了 @a region 时，这一帧的位置在区域内（只影响每帧的数据，
+  ///     生成、销毁等事件不受影响，回放时参与者离开区域后停在原地）。
+  /// 未录制的参与者的生成、销毁和父子关系事件也不会写入文件。
+  class RecorderFilter {
+  public:
+
+    /// 类型过滤的通配符，例如 "vehicle.*"。
+    std::vector<std::string> actor_types;
+
+    /// 总是录制的参与者。
+    std::vector<ActorId> actor_ids;
+
+    /// 是否按区域过滤。
+    bool use_region = false;
+
+    /// 录制的区域：中心位置、半尺寸和绕中心的朝向，世界坐标，单位为米。
+    geom::BoundingBox region;
+
+    /// 每一位对应一个 RecorderPacket，默认全部录制。
+    uint32_t packet_mask = 0xFFFFFFFFu;
+
+    bool HasActorFilter() const {
+      return !actor_types.empty() || !actor_ids.empty();
+    }
+
+    bool IsPacketEnabled(RecorderPacket packet) const {
+      return (packet_mask & (1u << static_cast<uint8_t>(packet))) != 0u;
+    }
+
+    void SetPacketEnabled(RecorderPacket packet, bool enabled) {
+      const uint32_t bit = 1u << static_cast<uint8_t>(packet);
+      packet_mask = enabled ? (packet_mask | bit) : (packet_mask & ~bit);
+    }
+
+    /// 没有任何过滤条件时与不使用过滤器相同。
+    bool IsEmpty() const {
+      return !HasActorFilter() && !use_region && (packet_mask == 0xFFFFFFFFu);
+    }
+
+    MSGPACK_DEFINE_ARRAY(actor_types, actor_ids, use_region, region, packet_mask);
+  };
+
+} // namespace rpc
+} // namespace carla
@@ -0,0 +1,131 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/MsgPack.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace carla {
+namespace rpc {
+
+  /// @brief 以毫秒为单位的耗时直方图。
+  ///
+  /// 桶的上界按2的幂增长：第 i 个桶的上界为 0.25 * 2^i 毫秒，最后一个桶
+  /// 没有上界。
+  class LatencyHistogram {
+  public:
+
+    static constexpr size_t BUCKETS = 14u;
+
+    /// 第 @a index 个桶的上界，单位为毫秒，最后一个桶返回负数。
+    static float GetUpperBound(size_t index) {
+      return (index + 1u < BUCKETS) ?
+          0.25f * static_cast<float>(1u << index) :
+          -1.0f;
+    }
+
+    void Add(float milliseconds) {
+      milliseconds = std::max(milliseconds, 0.0f);
+      if (counts.size() != BUCKETS) {
+        counts.assign(BUCKETS, 0u);
+      }
+      size_t index = 0u;
+      while ((index + 1u < BUCKETS) && (milliseconds > GetUpperBound(index))) {
+        ++index;
+      }
+      ++counts[index];
+      maximum = (count == 0u) ? milliseconds : std::max(maximum, milliseconds);
+      sum += milliseconds;
+      last = milliseconds;
+      ++count;
+    }
+
+    float GetMean() const {
+      return count > 0u ? static_cast<float>(sum / static_cast<double>(count)) : 0.0f;
+    }
+
+    /// 估计 @a fraction（0 到 1）分位数：返回该分位数所在桶的上界，
+    /// 落在最后一个桶时返回最大值。
+    float GetPercentile(float fraction) const {
+      if (count == 0u) {
+        return 0.0f;
+      }
+      // 第 rank 个样本（从1开始），减去一个小量避免 0.99f 这类浮点数的误差多算一个
+      const double fraction_clamped = std::min(std::max(fraction, 0.0f), 1.0f);
+      const uint64_t rank = std::max<uint64_t>(1u, static_cast<uint64_t>(
+          std::ceil(fraction_clamped * static_cast<double>(count) - 1e-4)));
+      uint64_t accumulated = 0u;
+      for (size_t i = 0u; i < counts.size(); ++i) {
+        accumulated += counts[i];
+        if (accumulated >= rank) {
+          const float bound = GetUpperBound(i);
+          return bound < 0.0f ? maximum : std::min(bound, maximum);
+        }
+      }
+      return maximum;
+    }
+
+    /// 每个桶中的样本数，还没有样本时为空。
+    std::vector<uint32_t> counts;
+
+    uint64_t count = 0u;
+
+    double sum = 0.0;
+
+    float maximum = 0.0f;
+
+    /// 最近一个样本。
+    float last = 0.0f;
+
+    MSGPACK_DEFINE_ARRAY(counts, count, sum, maximum, last);
+  };
+
+  /// @brief 多GPU模式下一台次级服务器的状态和耗时统计。
+  ///
+  /// 每个样本对应次级服务器处理完的一帧：
+  ///   - @a apply_time：把主服务器的帧数据应用到场景的时间；
+  ///   - @a render_time：该帧渲染线程和GPU中较长的耗时；
+  ///   - @a frame_latency：从主服务器发送帧数据到收到处理完成通知的时间；
+  ///   - @a network_latency：@a frame_latency 减去次级服务器上从收到帧数据到
+  ///     发送通知的时间，即两个方向的网络传输和排队时间。
+  class SecondaryTelemetry {
+  public:
+
+    /// 次级服务器的地址和端口。
+    std::string address;
+
+    /// 最近处理完的帧。
+    uint64_t last_frame = 0u;
+
+    /// 已发送但还没有处理完的帧数。
+    uint64_t frames_behind = 0u;
+
+    LatencyHistogram apply_time;
+
+    LatencyHistogram render_time;
+
+    LatencyHistogram frame_latency;
+
+    LatencyHistogram network_latency;
+
+    MSGPACK_DEFINE_ARRAY(
+        address,
+        last_frame,
+        frames_behind,
+        apply_time,
+        render_time,
+        frame_latency,
+        network_latency);
+  };
+
+} // namespace rpc
+} // namespace carla
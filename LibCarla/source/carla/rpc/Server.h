@@ -12,15 +12,24 @@
 #include "carla/rpc/Response.h" // 包含响应相关的头文件
 
 #include <boost/asio/io_context.hpp> // 包含Boost.Asio的io_context类
+#include <boost/asio/executor_work_guard.hpp> // 包含Boost.Asio的executor_work_guard类
 #include <boost/asio/post.hpp>        // 包含Boost.Asio的post函数
 
 #include <rpc/server.h>               // 包含RPC服务器的头文件
 
+#include <chrono>
 #include <future>                     // 包含future库，用于异步编程
 
 namespace carla {
 namespace rpc {
 
+namespace detail {
+
+  template <typename T>
+  struct FunctionWrapper;
+
+} // namespace detail
+
   // ===========================================================================
   // -- Server -----------------------------------------------------------------
   // ===========================================================================
@@ -62,11 +71,96 @@ namespace rpc {
       _sync_io_context.run_for(duration.to_chrono()); // 运行指定持续时间
     }
 
+    /// 在当前线程中等待同步工作，最多等待 @a duration。与`SyncRunFor`不同，没有
+    /// 工作时阻塞而不是立即返回；运行了一个绑定函数或者调用了`SyncWake`后，处理完
+    /// 已经到达的工作就返回。
+    void SyncWaitFor(time_duration duration) {
+      #ifdef LIBCARLA_INCLUDED_FROM_UE4
+      #include <compiler/enable-ue4-macros.h>
+      TRACE_CPUPROFILER_EVENT_SCOPE_STR(__FUNCTION__);
+      #include <compiler/disable-ue4-macros.h>
+      #endif // LIBCARLA_INCLUDED_FROM_UE4
+      _sync_io_context.reset();
+      auto work = boost::asio::make_work_guard(_sync_io_context);
+      if (_sync_io_context.run_one_for(duration.to_chrono()) > 0u) {
+        _sync_io_context.poll();
+      }
+    }
+
+    /// 唤醒在`SyncWaitFor`中等待的线程，可以从任意线程调用。
+    void SyncWake() {
+      boost::asio::post(_sync_io_context, [](){});
+    }
+
     /// @warning 不会停止游戏线程。
     void Stop() {
       _server.stop(); // 停止服务器
     }
 
+    /// 正在当前线程中执行的绑定函数的返回值是否会被丢弃，即客户端是异步调用的。
+    /// 绑定函数可以据此跳过构造只用于响应的数据。
+    static bool IsResponseIgnored() {
+      return CurrentCallIgnoresResponse();
+    }
+
+    /// 当前线程上次调用以来执行同步绑定函数的时间，单位为秒。游戏线程据此统计
+    /// 每帧处理 RPC 的时间。
+    static double TakeSyncCallTime() {
+      const double time = SyncCallTime();
+      SyncCallTime() = 0.0;
+      return time;
+    }
+
+  private:
+
+    static double &SyncCallTime() {
+      static thread_local double time = 0.0;
+      return time;
+    }
+
+    /// 把一次同步调用的时间加到 SyncCallTime()。
+    class ScopedSyncCallTimer {
+    public:
+
+      ScopedSyncCallTimer()
+        : _start(std::chrono::steady_clock::now()) {}
+
+      ~ScopedSyncCallTimer() {
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - _start;
+        SyncCallTime() += elapsed.count();
+      }
+
+    private:
+
+      const std::chrono::steady_clock::time_point _start;
+    };
+
+    static bool &CurrentCallIgnoresResponse() {
+      static thread_local bool ignored = false;
+      return ignored;
+    }
+
+    /// 在一次调用期间设置 CurrentCallIgnoresResponse()。
+    class ScopedCall {
+    public:
+
+      explicit ScopedCall(bool ignored)
+        : _previous(CurrentCallIgnoresResponse()) {
+        CurrentCallIgnoresResponse() = ignored;
+      }
+
+      ~ScopedCall() {
+        CurrentCallIgnoresResponse() = _previous;
+      }
+
+    private:
+
+      const bool _previous;
+    };
+
+    template <typename T>
+    friend struct detail::FunctionWrapper;
+
   private:
 
     boost::asio::io_context _sync_io_context; // 同步IO上下文
@@ -114,7 +208,10 @@ namespace detail {
     template <typename FuncT>
     static auto WrapSyncCall(boost::asio::io_context &io, FuncT &&functor) {
       return [&io, functor=std::forward<FuncT>(functor)](Metadata metadata, Args... args) -> R {
-        auto task = std::packaged_task<R()>([functor=std::move(functor), args...]() {
+        const bool ignored = metadata.IsResponseIgnored();
+        auto task = std::packaged_task<R()>([functor=std::move(functor), ignored, args...]() {
+          Server::ScopedCall call(ignored);
+          Server::ScopedSyncCallTimer timer;
           return functor(args...); // 调用传入的可调用对象
         });
         if (metadata.IsResponseIgnored()) { // 如果响应被忽略
@@ -136,6 +233,7 @@ namespace detail {
 template <typename FuncT>
 static auto WrapAsyncCall(FuncT &&functor) {
   return [functor=std::forward<FuncT>(functor)](::carla::rpc::Metadata metadata, Args... args) -> R {
+    Server::ScopedCall call(metadata.IsResponseIgnored());
     if (metadata.IsResponseIgnored()) { // 检查响应是否被忽略
       functor(args...); // 调用传入的可调用对象
       return R(); // 返回默认构造的R
@@ -0,0 +1,67 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/MsgPack.h"
+#include "carla/rpc/SecondaryTelemetry.h"
+
+#include <cstdint>
+
+namespace carla {
+namespace rpc {
+
+  /// @brief 服务器游戏线程每帧各阶段的耗时统计。
+  ///
+  /// 每个样本对应一帧，单位为毫秒：
+  ///   - @a frame_time：相邻两帧开始之间的时间；
+  ///   - @a tick_wait：同步模式下等待客户端节拍提示的时间，不含处理 RPC 的时间；
+  ///   - @a rpc：在游戏线程中执行同步 RPC（包括 apply_batch）的时间；
+  ///   - @a world_tick：引擎更新场景的时间，包括物理模拟和所有参与者的 Tick；
+  ///   - @a recorder：录制器的时间；
+  ///   - @a broadcast：生成并发送世界快照的时间；
+  ///   - @a sensors：传感器采集数据的时间。
+  class ServerProfile {
+  public:
+
+    /// 统计的帧数。
+    uint64_t frames = 0u;
+
+    /// apply_batch 执行的命令总数（例如交通管理器发送的控制命令）。
+    uint64_t batch_commands = 0u;
+
+    /// 一帧中 apply_batch 执行的最多命令数。
+    uint32_t max_batch_commands_per_frame = 0u;
+
+    LatencyHistogram frame_time;
+
+    LatencyHistogram tick_wait;
+
+    LatencyHistogram rpc;
+
+    LatencyHistogram world_tick;
+
+    LatencyHistogram recorder;
+
+    LatencyHistogram broadcast;
+
+    LatencyHistogram sensors;
+
+    MSGPACK_DEFINE_ARRAY(
+        frames,
+        batch_commands,
+        max_batch_commands_per_frame,
+        frame_time,
+        tick_wait,
+        rpc,
+        world_tick,
+        recorder,
+        broadcast,
+        sensors);
+  };
+
+} // namespace rpc
+} // namespace carla
@@ -0,0 +1,48 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/MsgPack.h"
+#include "carla/rpc/ActorId.h"
+
+#include <string>
+
+namespace carla {
+namespace rpc {
+
+  /// 车辆进入或离开交通标志（包括交通灯）的一个触发框。
+  class SignTriggerEvent {
+  public:
+
+    SignTriggerEvent() = default;
+
+    SignTriggerEvent(
+        ActorId in_vehicle,
+        ActorId in_sign,
+        std::string in_opendrive_id,
+        bool in_entered)
+      : vehicle(in_vehicle),
+        sign(in_sign),
+        opendrive_id(std::move(in_opendrive_id)),
+        entered(in_entered) {}
+
+    ActorId vehicle = 0u;
+
+    /// 标志所在的参与者，标志不是参与者时为 0。
+    ActorId sign = 0u;
+
+    /// 标志在 OpenDRIVE 中的 id。
+    std::string opendrive_id;
+
+    /// 为 true 时车辆进入触发框，否则离开。
+    bool entered = false;
+
+    MSGPACK_DEFINE_ARRAY(vehicle, sign, opendrive_id, entered);
+  };
+
+} // namespace rpc
+} // namespace carla
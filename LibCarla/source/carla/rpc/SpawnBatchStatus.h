@@ -0,0 +1,38 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/MsgPack.h"
+#include "carla/rpc/CommandResponse.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace carla {
+namespace rpc {
+
+  /// @brief 服务器分多帧执行的一批命令的进度。
+  class SpawnBatchStatus {
+  public:
+
+    /// 所有命令都已执行。
+    bool done = false;
+
+    /// 已经执行的命令数。
+    uint32_t processed = 0u;
+
+    /// 命令总数。
+    uint32_t total = 0u;
+
+    /// 每个命令的结果，与 apply_batch_sync 的结果相同，只在 @a done 时有值。
+    std::vector<CommandResponse> responses;
+
+    MSGPACK_DEFINE_ARRAY(done, processed, total, responses);
+  };
+
+} // namespace rpc
+} // namespace carla
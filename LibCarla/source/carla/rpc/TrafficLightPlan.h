@@ -0,0 +1,69 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/MsgPack.h"
+#include "carla/rpc/ActorId.h"
+
+#include <vector>
+
+namespace carla {
+namespace rpc {
+
+  /// 一个交通灯所在控制器的配时，单位为秒。同一控制器的交通灯共用配时。
+  class TrafficLightTiming {
+  public:
+
+    TrafficLightTiming() = default;
+
+    TrafficLightTiming(
+        ActorId in_traffic_light,
+        float in_green_time,
+        float in_yellow_time,
+        float in_red_time)
+      : traffic_light(in_traffic_light),
+        green_time(in_green_time),
+        yellow_time(in_yellow_time),
+        red_time(in_red_time) {}
+
+    ActorId traffic_light = 0u;
+
+    float green_time = 10.0f;
+
+    float yellow_time = 3.0f;
+
+    float red_time = 2.0f;
+
+    MSGPACK_DEFINE_ARRAY(traffic_light, green_time, yellow_time, red_time);
+  };
+
+  /// @brief 一个交通灯组（路口）的配时方案。
+  ///
+  /// 同一次调用中的所有方案在同一帧开始前一起应用，任一方案无效时都不应用。
+  class TrafficLightGroupPlan {
+  public:
+
+    /// 组中任一交通灯。
+    ActorId traffic_light = 0u;
+
+    /// 组中控制器的配时，未列出的控制器保持原来的配时。
+    std::vector<TrafficLightTiming> timings;
+
+    /// 从组的第一个控制器的绿灯开始新的循环。
+    bool restart = true;
+
+    /// 重新开始循环时快进的时间，用于协调相邻路口的相位（绿波）。
+    float offset = 0.0f;
+
+    /// 应用后组是否冻结。
+    bool frozen = false;
+
+    MSGPACK_DEFINE_ARRAY(traffic_light, timings, restart, offset, frozen);
+  };
+
+} // namespace rpc
+} // namespace carla
@@ -0,0 +1,79 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/MsgPack.h"
+#include "carla/rpc/ActorId.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace carla {
+namespace rpc {
+
+  /// 一个行人的骨骼姿态，骨骼的顺序与 WalkerBonePoses::bone_names 相同。
+  ///
+  /// 变换在父骨骼空间中，与 WalkerBoneControlIn 和 BoneTransformDataOut::relative 相同。
+  class WalkerBonePose {
+  public:
+
+    static constexpr size_t ROTATION_SIZE = 4u;
+
+    static constexpr size_t LOCATION_SIZE = 3u;
+
+    WalkerBonePose() = default;
+
+    WalkerBonePose(
+        ActorId in_walker,
+        std::vector<float> in_rotations,
+        std::vector<float> in_locations)
+      : walker(in_walker),
+        rotations(std::move(in_rotations)),
+        locations(std::move(in_locations)) {}
+
+    /// 骨骼的数量，两个数组的大小不一致时返回0。
+    size_t size() const {
+      const size_t count = rotations.size() / ROTATION_SIZE;
+      const bool valid =
+          rotations.size() == count * ROTATION_SIZE &&
+          locations.size() == count * LOCATION_SIZE;
+      return valid ? count : 0u;
+    }
+
+    ActorId walker = 0u;
+
+    /// 每个骨骼的旋转四元数 (x, y, z, w)，与 UE 的 FQuat 在同一坐标系中。
+    std::vector<float> rotations;
+
+    /// 每个骨骼的位置 (x, y, z)，单位为米。
+    std::vector<float> locations;
+
+    MSGPACK_DEFINE_ARRAY(walker, rotations, locations);
+  };
+
+  /// @brief 多个行人的骨骼姿态。
+  ///
+  /// 骨骼名只发送一次，所有行人共用；每个行人的姿态是连续的 float 数组，
+  /// 比每个骨骼一个 BoneTransformDataIn 小得多，序列化也快得多。
+  class WalkerBonePoses {
+  public:
+
+    WalkerBonePoses() = default;
+
+    explicit WalkerBonePoses(std::vector<std::string> in_bone_names)
+      : bone_names(std::move(in_bone_names)) {}
+
+    std::vector<std::string> bone_names;
+
+    std::vector<WalkerBonePose> poses;
+
+    MSGPACK_DEFINE_ARRAY(bone_names, poses);
+  };
+
+} // namespace rpc
+} // namespace carla
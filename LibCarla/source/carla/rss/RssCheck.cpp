@@ -41,6 +41,7 @@
 #include <chrono>
 #include <tuple>
 
+#include "carla/ParallelFor.h"
 #include "carla/client/Map.h"
 #include "carla/client/TrafficLight.h"
 #include "carla/client/Vehicle.h"
@@ -400,7 +401,11 @@ bool RssCheck::CheckObjects(carla::client::Timestamp const &timestamp,
 
     //允许车辆距离路线至少 2.0 米，以免丧失
     //与路线的接触
-    auto const ego_match_object = GetMatchObject(carla_ego_actor, ::ad::physics::Distance(2.0));
+    // 自车在其他自车的检查中也是交通参与者，匹配结果取自同一帧共享的缓存
+    auto const ego_match_object = RssMatchCache::Get().GetMatchObjects(
+        timestamp.frame, {carla_ego_actor}, [this](carla::SharedPtr<carla::client::Actor> const &actor) {
+          return GetMatchObject(actor, ::ad::physics::Distance(2.0));
+        }).front();
 
     if (::ad::map::point::isValid(_carla_rss_state.ego_match_object.enuPosition.centerPoint, false)) {
       // check for bigger position jumps of the ego vehicle
@@ -953,6 +958,51 @@ void RssCheck::UpdateDefaultRssDynamics(CarlaRssState &carla_rss_state) {
   return green_traffic_lights;
 }
 
+RssMatchCache &RssMatchCache::Get() {
+  static RssMatchCache cache;
+  return cache;
+}
+
+std::vector<::ad::map::match::Object> RssMatchCache::GetMatchObjects(
+    uint64_t const frame, std::vector<carla::SharedPtr<carla::client::Actor>> const &actors,
+    MatchFunctionType const &match) {
+  std::vector<::ad::map::match::Object> result(actors.size());
+  std::vector<size_t> missing;
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (frame != _frame) {
+      _frame = frame;
+      _objects.clear();
+    }
+    for (size_t i = 0u; i < actors.size(); ++i) {
+      auto const it = _objects.find(actors[i]->GetId());
+      if (it != _objects.end()) {
+        result[i] = it->second;
+      } else {
+        missing.push_back(i);
+      }
+    }
+  }
+
+  // 地图匹配是最耗时的部分，在锁外并行计算
+  carla::ParallelForChunks(missing.size(), [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+      result[missing[i]] = match(actors[missing[i]]);
+    }
+  }, 4u);
+
+  if (!missing.empty()) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    // 计算期间其他线程可能已经进入了新的帧，这时结果不再缓存
+    if (frame == _frame) {
+      for (auto const i : missing) {
+        _objects.emplace(actors[i]->GetId(), result[i]);
+      }
+    }
+  }
+  return result;
+}
+
 RssCheck::RssObjectChecker::RssObjectChecker(RssCheck const &rss_check,
                                              ::ad::rss::map::RssSceneCreation &scene_creation,
                                              carla::client::Vehicle const &carla_ego_vehicle,
@@ -965,10 +1015,9 @@ RssCheck::RssObjectChecker::RssObjectChecker(RssCheck const &rss_check,
     _green_traffic_lights(green_traffic_lights) {}
 
 void RssCheck::RssObjectChecker::operator()(
-    const carla::SharedPtr<carla::client::Actor> other_traffic_participant) const {
+    const carla::SharedPtr<carla::client::Actor> other_traffic_participant,
+    ::ad::map::match::Object const &other_match_object) const {
   try {
-    auto other_match_object = _rss_check.GetMatchObject(other_traffic_participant, ::ad::physics::Distance(2.0));
-
     _rss_check._logger->trace("OtherVehicleMapMatching: {} {}", other_traffic_participant->GetId(),
                               other_match_object.mapMatchedBoundingBox);
 
@@ -1039,14 +1088,31 @@ void RssCheck::CreateWorldModel(carla::client::Timestamp const &timestamp, carla
 
   ::ad::rss::map::RssSceneCreation scene_creation(timestamp.frame, carla_rss_state.default_ego_vehicle_dynamics);
 
+  // 所有交通参与者的地图匹配在同一帧内由所有 RssCheck 共享
+  auto const other_match_objects = RssMatchCache::Get().GetMatchObjects(
+      timestamp.frame, other_traffic_participants,
+      [this](carla::SharedPtr<carla::client::Actor> const &actor) {
+        try {
+          return GetMatchObject(actor, ::ad::physics::Distance(2.0));
+        } catch (...) {
+          // 返回无效的对象，下面会忽略这个交通参与者
+          _logger->error("Exception matching traffic participant {} -> Ignoring it", actor->GetId());
+          return ::ad::map::match::Object();
+        }
+      });
+
+  auto const checker = RssObjectChecker(*this, scene_creation, carla_ego_vehicle, carla_rss_state, green_traffic_lights);
 #ifdef RSS_USE_TBB
-  tbb::parallel_for_each(
-      other_traffic_participants.begin(), other_traffic_participants.end(),
-      RssObjectChecker(*this, scene_creation, carla_ego_vehicle, carla_rss_state, green_traffic_lights));
+  tbb::parallel_for(size_t(0u), other_traffic_participants.size(), [&](size_t i) {
+    if (::ad::map::point::isValid(other_match_objects[i].enuPosition.centerPoint, false)) {
+      checker(other_traffic_participants[i], other_match_objects[i]);
+    }
+  });
 #else
-  for (auto const traffic_participant : other_traffic_participants) {
-    auto checker = RssObjectChecker(*this, scene_creation, carla_ego_vehicle, carla_rss_state, green_traffic_lights);
-    checker(traffic_participant);
+  for (size_t i = 0u; i < other_traffic_participants.size(); ++i) {
+    if (::ad::map::point::isValid(other_match_objects[i].enuPosition.centerPoint, false)) {
+      checker(other_traffic_participants[i], other_match_objects[i]);
+    }
   }
 #endif
 
@@ -17,12 +17,15 @@
 #include <ad/rss/state/RssStateSnapshot.hpp>
 // 引入一系列与地图、RSS（Responsibility-Sensitive Safety，一种安全相关的概念）相关的自定义头文件，
 // 包含地标、地图匹配对象、完整路线、RSS检查核心、RSS场景创建、情况快照、合适响应、RSS状态快照等相关类型的定义
+#include <functional>
 #include <iostream>
 // 引入输入输出流相关的标准库头文件，用于后续进行控制台等输出操作
 #include <memory>
 // 引入内存管理相关的标准库头文件，用于智能指针等操作
 #include <mutex>
 // 引入互斥锁相关的标准库头文件，用于多线程环境下的资源保护等操作
+#include <unordered_map>
+#include <vector>
 #include "carla/client/ActorList.h"
 #include "carla/client/Vehicle.h"
 #include "carla/road/Map.h"
@@ -147,6 +150,32 @@ struct ActorConstellationData {
 // 以智能指针（SharedPtr）的形式指向carla::client::Actor类型的其他参与者对象，方便对其他参与者进行操作并管理其内存生命周期
 };
 
+/// @brief per-frame cache of the map matched objects
+///
+/// All RssCheck instances of the client share one cache, so every actor is
+/// map matched only once per frame, independent of the number of ego
+/// vehicles. Missing objects are matched in parallel.
+class RssMatchCache {
+public:
+  using MatchFunctionType =
+      std::function<::ad::map::match::Object(carla::SharedPtr<carla::client::Actor> const &)>;
+
+  /// @returns the cache shared by all RssCheck instances
+  static RssMatchCache &Get();
+
+  /// @returns the map matched objects of @a actors at @a frame, in the same
+  /// order; objects not yet in the cache are computed with @a match
+  std::vector<::ad::map::match::Object> GetMatchObjects(
+      uint64_t frame, std::vector<carla::SharedPtr<carla::client::Actor>> const &actors,
+      MatchFunctionType const &match);
+
+private:
+  std::mutex _mutex;
+  // 缓存所属的帧，进入新的帧时清空
+  uint64_t _frame{0u};
+  std::unordered_map<carla::ActorId, ::ad::map::match::Object> _objects;
+};
+
 /// @brief class implementing the actual RSS checks based on CARLA world
 /// description
 class RssCheck {
@@ -350,7 +379,8 @@ private:
         // 一个 ::ad::rss::map::RssSceneCreation 类型的引用（用于 RSS 场景创建相关操作）、一个 carla::client::Vehicle 类型的常量引用（代表自主车辆对象，用于获取车辆相关信息）、
         // 一个 CarlaRssState 类型的常量引用（提供当前 RSS 相关的状态信息）以及一个 ::ad::map::landmark::LandmarkIdSet 类型的常量引用（存储绿灯交通信号灯的地标集合信息，
         // 可能用于判断交通信号灯状态对 RSS 计算的影响等），通过这些参数来初始化该类对象，以便后续进行针对交通参与者的 RSS 相关检查操作
-    void operator()(const carla::SharedPtr<carla::client::Actor> other_traffic_participant) const;
+    void operator()(const carla::SharedPtr<carla::client::Actor> other_traffic_participant,
+                    ::ad::map::match::Object const &other_match_object) const;
 // 定义函数调用运算符重载函数，接受一个指向 carla::client::Actor 类型的智能指针参数（代表其他交通参与者对象），
         // 用于对传入的其他交通参与者执行具体的 RSS 相关检查操作，并且该函数声明为 const 类型，表示不会修改类的成员变量状态，是一个只读操作的函数
   private:
@@ -0,0 +1,26 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/sensor/LazySensorData.h"
+
+#include "carla/sensor/Deserializer.h"
+#include "carla/sensor/SensorData.h"
+
+namespace carla {
+namespace sensor {
+
+  SharedPtr<SensorData> LazySensorData::Get() {
+    if (_data == nullptr) {
+      _header = HeaderSerializer::Deserialize(_buffer);
+      auto data = Deserializer::Deserialize(std::move(_buffer));
+      data->_episode = _episode.TryLock();
+      _data = std::move(data);
+    }
+    return _data;
+  }
+
+} // namespace sensor
+} // namespace carla
@@ -0,0 +1,85 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/Buffer.h"
+#include "carla/Memory.h"
+#include "carla/NonCopyable.h"
+#include "carla/sensor/s11n/SensorHeaderSerializer.h"
+
+/// @todo 这个不应该暴露在这个命名空间中。
+#include "carla/client/detail/EpisodeProxy.h"
+
+#include <cstdint>
+
+namespace carla {
+namespace sensor {
+
+  class SensorData;
+
+  /// 一条尚未反序列化的传感器消息。
+  ///
+  /// 帧号、时间戳和传感器变换在访问时直接从消息头读取，完整的 SensorData 在第一次
+  /// 调用 Get 时才创建。只处理部分消息的回调（例如按帧采样）不需要为丢弃的消息
+  /// 付出反序列化的开销。
+  ///
+  /// @warning 不是线程安全的，同一个对象不能在多个线程中同时调用 Get。
+  class LazySensorData : private NonCopyable {
+    using HeaderSerializer = s11n::SensorHeaderSerializer;
+  public:
+
+    LazySensorData(Buffer &&buffer, client::detail::WeakEpisodeProxy episode)
+      : _buffer(std::move(buffer)),
+        _episode(std::move(episode)) {}
+
+    /// 生成数据的传感器的类型ID。
+    uint64_t GetSensorTypeId() const {
+      return GetHeader().sensor_type;
+    }
+
+    /// 生成数据时的帧计数。
+    uint64_t GetFrame() const {
+      return GetHeader().frame;
+    }
+
+    /// 生成数据时的时间戳。
+    double GetTimestamp() const {
+      return GetHeader().timestamp;
+    }
+
+    /// 生成数据时的传感器变换信息。
+    const rpc::Transform &GetSensorTransform() const {
+      return GetHeader().sensor_transform;
+    }
+
+    /// 是否已经反序列化。
+    bool IsMaterialized() const {
+      return _data != nullptr;
+    }
+
+    /// 反序列化消息，返回与普通监听模式相同的 SensorData。结果被缓存，
+    /// 之后消息的缓冲区归属于返回的对象。
+    SharedPtr<SensorData> Get();
+
+  private:
+
+    const HeaderSerializer::Header &GetHeader() const {
+      return _data == nullptr ? HeaderSerializer::Deserialize(_buffer) : _header;
+    }
+
+    Buffer _buffer;
+
+    client::detail::WeakEpisodeProxy _episode;
+
+    /// 反序列化之后消息头的副本
+    HeaderSerializer::Header _header;
+
+    SharedPtr<SensorData> _data;
+  };
+
+} // namespace sensor
+} // namespace carla
@@ -16,6 +16,8 @@
 namespace carla { // carla命名空间
 namespace sensor { // sensor命名空间
 
+namespace s11n { class OpticalFlowImageSerializer; }
+
   /// 包装一个传感器生成的原始数据以及一些有用的元信息。
   class RawData {
    using HeaderSerializer = s11n::SensorHeaderSerializer; // 定义HeaderSerializer为SensorHeaderSerializer的别名
@@ -89,6 +91,7 @@ namespace sensor { // sensor命名空间
     template <typename... Items>
     friend class CompositeSerializer; // 允许CompositeSerializer类访问私有成员
     friend class carla::ros2::ROS2; // 允许carla::ros2::ROS2类访问私有成员
+    friend class s11n::OpticalFlowImageSerializer; // 反序列化时需要把半精度光流展开到新的缓冲区
 
     // 构造函数，接受一个Buffer对象并移动它
     RawData(Buffer &&buffer) : _buffer(std::move(buffer)) {}
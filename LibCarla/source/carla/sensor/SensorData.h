@@ -62,6 +62,7 @@ namespace sensor {  // sensor 命名空间
 
     /// @todo 这个不应该暴露在这个命名空间中。
     friend class client::detail::Simulator;  // 声明 Simulator 类为友元
+    friend class LazySensorData;  // 延迟反序列化时设置剧集
     client::detail::WeakEpisodeProxy _episode;  // 剧集的弱引用代理
 
     const size_t _frame;  // 帧数
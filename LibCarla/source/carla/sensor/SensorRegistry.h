@@ -16,10 +16,12 @@
 
 // 1. Include the serializer here.
 #include "carla/sensor/s11n/CollisionEventSerializer.h"	// 包含各种传感器对应的序列化器头文件，这些序列化器用于将传感器相关数据进行序列化操作
+#include "carla/sensor/s11n/CompressedImageSerializer.h"
 #include "carla/sensor/s11n/DVSEventArraySerializer.h"
 #include "carla/sensor/s11n/EpisodeStateSerializer.h"
 #include "carla/sensor/s11n/GnssSerializer.h"
 #include "carla/sensor/s11n/ImageSerializer.h"
+#include "carla/sensor/s11n/InstanceSegmentationImageSerializer.h"
 #include "carla/sensor/s11n/NormalsImageSerializer.h"
 #include "carla/sensor/s11n/OpticalFlowImageSerializer.h"
 #include "carla/sensor/s11n/IMUSerializer.h"
@@ -30,10 +32,14 @@
 #include "carla/sensor/s11n/SemanticLidarSerializer.h"
 #include "carla/sensor/s11n/GBufferUint8Serializer.h"
 #include "carla/sensor/s11n/GBufferFloatSerializer.h"
+#include "carla/sensor/s11n/GBufferMultipartSerializer.h"
 #include "carla/sensor/s11n/V2XSerializer.h"
+#include "carla/sensor/s11n/VehicleTelemetrySerializer.h"
 
 // 2. Add a forward-declaration of the sensor here.	// 对各种传感器类进行前置声明，告知编译器这些类在后续会被定义，避免编译时找不到类型定义的错误
 class ACollisionSensor;	
+class ACompressedSceneCaptureCamera;
+class ADepthBufferLidar;
 class ADepthCamera;
 class ANormalsCamera;
 class ADVSCamera;
@@ -52,8 +58,10 @@ class ARssSensor;
 class FWorldObserver;
 struct FCameraGBufferUint8;
 struct FCameraGBufferFloat;
+struct FCameraGBufferMultipart;
 class AV2XSensor;
 class ACustomV2XSensor;
+class AVehicleTelemetrySensor;
 
 namespace carla {
 namespace sensor {
@@ -81,12 +89,16 @@ namespace sensor {
     std::pair<ARssSensor *, s11n::NoopSerializer>,
     std::pair<ASceneCaptureCamera *, s11n::ImageSerializer>,
     std::pair<ASemanticSegmentationCamera *, s11n::ImageSerializer>,
-    std::pair<AInstanceSegmentationCamera *, s11n::ImageSerializer>,
+    std::pair<AInstanceSegmentationCamera *, s11n::InstanceSegmentationImageSerializer>,
     std::pair<FWorldObserver *, s11n::EpisodeStateSerializer>,
     std::pair<FCameraGBufferUint8 *, s11n::GBufferUint8Serializer>,
     std::pair<FCameraGBufferFloat *, s11n::GBufferFloatSerializer>,
     std::pair<AV2XSensor *, s11n::CAMDataSerializer>,
-    std::pair<ACustomV2XSensor *, s11n::CustomV2XDataSerializer>
+    std::pair<ACustomV2XSensor *, s11n::CustomV2XDataSerializer>,
+    std::pair<ACompressedSceneCaptureCamera *, s11n::CompressedImageSerializer>,
+    std::pair<FCameraGBufferMultipart *, s11n::GBufferMultipartSerializer>,
+    std::pair<ADepthBufferLidar *, s11n::LidarSerializer>,
+    std::pair<AVehicleTelemetrySensor *, s11n::VehicleTelemetrySerializer>
     
 
   >;
@@ -100,6 +112,8 @@ namespace sensor {
 
 // 4. Include the sensor here.		// 包含实际的传感器类定义的头文件，这些头文件中定义了各种传感器类的具体实现等内容
 #include "Carla/Sensor/CollisionSensor.h"
+#include "Carla/Sensor/CompressedSceneCaptureCamera.h"
+#include "Carla/Sensor/DepthBufferLidar.h"
 #include "Carla/Sensor/DepthCamera.h"
 #include "Carla/Sensor/NormalsCamera.h"
 #include "Carla/Sensor/DVSCamera.h"
@@ -118,5 +132,6 @@ namespace sensor {
 #include "Carla/Sensor/WorldObserver.h"
 #include "Carla/Sensor/V2XSensor.h"
 #include "Carla/Sensor/CustomV2XSensor.h"
+#include "Carla/Sensor/VehicleTelemetrySensor.h"
 
 #endif // LIBCARLA_SENSOR_REGISTRY_WITH_SENSOR_INCLUDES
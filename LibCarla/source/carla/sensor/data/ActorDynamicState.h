@@ -150,6 +150,9 @@ namespace detail { // 定义命名空间 detail
     "comment this assert, but your platform may have compatibility issues "
     "connecting to other platforms."); // 如果大小不匹配，给出提示信息
 
+  /// 剧集状态、参与者快照等处使用的名称。
+  using ActorDynamicState = ParticipantDynamicState;
+
 } // namespace data
 } // namespace sensor
 } // namespace carla
\ No newline at end of file
@@ -0,0 +1,37 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/rpc/ActorId.h"
+
+#include <cstdint>
+
+namespace carla {
+namespace sensor {
+namespace data {
+
+#pragma pack(push, 1)
+
+  /// @brief 剧集状态中可选的参与者扩展数据。
+  ///
+  /// 只发送给在 rpc::EpisodeInterest::extensions 中请求了扩展的客户端，
+  /// 这些客户端读取其中的属性时不再需要向服务器发送请求。目前只有车辆有扩展数据。
+  struct ActorExtensionState {
+    ActorId id;
+
+    /// 车辆的灯光状态，取值与 rpc::VehicleLightState::flag_type 相同。
+    uint32_t vehicle_light_state;
+
+    /// 按 rpc::VehicleWheelLocation 索引的车轮转向角，单位为度。
+    float wheel_steer_angles[4u];
+  };
+
+#pragma pack(pop)
+
+} // namespace data
+} // namespace sensor
+} // namespace carla
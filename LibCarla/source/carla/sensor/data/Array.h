@@ -51,12 +51,12 @@ namespace data { // 定义命名空间 data
 
     // 返回迭代器的结束位置
     iterator end() { 
-      return reinterpret_cast<iterator>(_data.end()); // 返回结束迭代器
+      return reinterpret_cast<iterator>(_data.begin() + _end); // 返回结束迭代器
     }
 
     // 返回常量迭代器的结束位置
     const_iterator cend() const { 
-      return reinterpret_cast<const_iterator>(_data.end()); // 返回常量结束迭代器
+      return reinterpret_cast<const_iterator>(_data.begin() + _end); // 返回常量结束迭代器
     }
 
     // 返回常量迭代器的结束位置（重载）
@@ -146,11 +146,18 @@ namespace data { // 定义命名空间 data
     // 构造函数，接受原始数据和偏移量获取函数
     template <typename FuncT>
     explicit Array(RawData &&data, FuncT get_offset) 
+      : Array(std::move(data), get_offset, [](const RawData &d) { return d.size(); }) {}
+
+    /// 数组只占消息中的 [get_offset, get_end)，之后还有其他数据时使用
+    template <typename OffsetFuncT, typename EndFuncT>
+    explicit Array(RawData &&data, OffsetFuncT get_offset, EndFuncT get_end)
       : SensorData(data), // 初始化基类
         _data(std::move(data)), // 移动原始数据
-        _offset(get_offset(_data)) { // 获取偏移量
-      DEBUG_ASSERT(_data.size() >= _offset); // 确保偏移量不大于数据大小
-      DEBUG_ASSERT((_data.size() - _offset) % sizeof(T) == 0u); // 确保数据对齐
+        _offset(get_offset(_data)), // 获取偏移量
+        _end(get_end(_data)) { // 获取结束位置
+      DEBUG_ASSERT(_data.size() >= _end); // 确保结束位置不超出数据大小
+      DEBUG_ASSERT(_end >= _offset); // 确保偏移量不大于结束位置
+      DEBUG_ASSERT((_end - _offset) % sizeof(T) == 0u); // 确保数据对齐
       DEBUG_ASSERT(begin() <= end()); // 确保开始迭代器不大于结束迭代器
     }
 
@@ -168,6 +175,8 @@ namespace data { // 定义命名空间 data
     RawData _data; // 存储原始数据
 
     const size_t _offset; // 存储偏移量
+
+    const size_t _end; // 数组在原始数据中的结束位置
   };
 
 } // namespace data
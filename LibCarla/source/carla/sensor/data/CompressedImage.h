@@ -0,0 +1,63 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/sensor/data/Array.h"
+#include "carla/sensor/s11n/CompressedImageSerializer.h"
+
+#include <cstdint>
+
+namespace carla {
+namespace sensor {
+namespace data {
+
+  /// 服务器端压缩过的图像，元素是编码后的字节（例如一个完整的JPEG文件）。
+  class CompressedImage : public Array<uint8_t> {
+    using Super = Array<uint8_t>;
+  protected:
+
+    using Serializer = s11n::CompressedImageSerializer;
+
+    friend Serializer;
+
+    explicit CompressedImage(RawData &&data)
+      : Super(Serializer::header_offset, std::move(data)) {}
+
+  private:
+
+    const auto &GetHeader() const {
+      return Serializer::DeserializeHeader(Super::GetRawData());
+    }
+
+  public:
+
+    using Format = Serializer::Format;
+
+    /// 解码后图像的宽度（像素）。
+    auto GetWidth() const {
+      return GetHeader().width;
+    }
+
+    /// 解码后图像的高度（像素）。
+    auto GetHeight() const {
+      return GetHeader().height;
+    }
+
+    /// 水平视场角（度）。
+    auto GetFOVAngle() const {
+      return GetHeader().fov_angle;
+    }
+
+    /// 数据的编码格式。
+    Format GetFormat() const {
+      return GetHeader().format;
+    }
+  };
+
+} // namespace data
+} // namespace sensor
+} // namespace carla
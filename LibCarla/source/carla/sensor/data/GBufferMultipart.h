@@ -0,0 +1,95 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/sensor/data/Array.h"
+#include "carla/sensor/data/Color.h"
+#include "carla/sensor/s11n/GBufferMultipartSerializer.h"
+
+#include <cstdint>
+
+namespace carla {
+namespace sensor {
+namespace data {
+
+  /// 同一帧中一次发送的多个GBuffer纹理。元素是所有纹理的像素，
+  /// 按纹理ID从小到大依次排列，GetTexture 返回其中一个纹理的起始位置。
+  class GBufferMultipart : public Array<Color> {
+    using Super = Array<Color>;
+  protected:
+
+    using Serializer = s11n::GBufferMultipartSerializer;
+
+    friend Serializer;
+
+    explicit GBufferMultipart(RawData &&data)
+      : Super(Serializer::header_offset, std::move(data)) {
+      DEBUG_ASSERT(Super::size() == GetTextureCount() * GetTextureSize());
+    }
+
+  private:
+
+    const auto &GetHeader() const {
+      return Serializer::DeserializeHeader(Super::GetRawData());
+    }
+
+  public:
+
+    /// 每个纹理的宽度（像素）。
+    auto GetWidth() const {
+      return GetHeader().width;
+    }
+
+    /// 每个纹理的高度（像素）。
+    auto GetHeight() const {
+      return GetHeader().height;
+    }
+
+    /// 水平视场角（度）。
+    auto GetFOVAngle() const {
+      return GetHeader().fov_angle;
+    }
+
+    /// 第 i 位表示包含ID为 i 的纹理，ID与 GBufferTextureID 相同。
+    uint64_t GetTextureMask() const {
+      return GetHeader().texture_mask;
+    }
+
+    bool HasTexture(uint32_t id) const {
+      return id < 64u && (GetTextureMask() & (uint64_t(1) << id)) != 0u;
+    }
+
+    size_t GetTextureCount() const {
+      size_t count = 0u;
+      for (auto mask = GetTextureMask(); mask != 0u; mask &= mask - 1u) {
+        ++count;
+      }
+      return count;
+    }
+
+    /// 每个纹理的像素数。
+    size_t GetTextureSize() const {
+      return static_cast<size_t>(GetWidth()) * static_cast<size_t>(GetHeight());
+    }
+
+    /// ID为 @a id 的纹理的第一个像素，消息中没有该纹理时返回 nullptr。
+    const Color *GetTexture(uint32_t id) const {
+      if (!HasTexture(id)) {
+        return nullptr;
+      }
+      const uint64_t lower = GetTextureMask() & ((uint64_t(1) << id) - 1u);
+      size_t index = 0u;
+      for (auto mask = lower; mask != 0u; mask &= mask - 1u) {
+        ++index;
+      }
+      return Super::data() + index * GetTextureSize();
+    }
+  };
+
+} // namespace data
+} // namespace sensor
+} // namespace carla
@@ -23,6 +23,8 @@
 // 引入Carla项目中与ROS2（机器人操作系统2）相关的头文件，虽然在此处代码中未明确体现其具体使用方式，但可能在更广泛的项目集成中用于和ROS2进行交互、发布图像数据等操作
 #include "carla/ros2/ROS2.h"
 
+#include <algorithm>
+
 namespace carla {
 namespace sensor {
 namespace data {
@@ -57,12 +59,23 @@ namespace data {
     // 显式定义的模板类构造函数，接收一个右值引用类型的原始数据（RawData &&data），用于根据传入的原始图像数据初始化ImageTmpl对象的相关属性，创建一个有效的图像对象。
     explicit ImageTmpl(RawData &&data)
       // 调用父类（Array<PixelT>）的构造函数，传递序列化器的头部偏移量（Serializer::header_offset）以及移动后的原始数据（std::move(data)），完成父类部分的初始化工作，保证继承体系下的初始化顺序和完整性，同时利用父类的数组相关功能来管理图像数据
-      : Super(Serializer::header_offset, std::move(data)) {
+      : Super(
+            std::move(data),
+            [](const RawData &) { return Serializer::header_offset; },
+            [](const RawData &d) { return GetPixelsEnd(d); }) {
       // 使用DEBUG_ASSERT进行调试断言，检查图像的宽度乘以高度是否等于父类（Array<PixelT>）中存储的数据元素个数（即图像像素个数），确保图像数据的一致性和正确性，如果该条件不满足，在调试模式下会触发断言失败提示，便于排查问题
       DEBUG_ASSERT(GetWidth() * GetHeight() == Super::size());
     }
 
   private:
+    // 像素之后可能还有其他数据（见 InstanceSegmentationImageSerializer），数组只包含像素
+    static size_t GetPixelsEnd(const RawData &data) {
+      const auto &header = Serializer::DeserializeHeader(data);
+      const size_t end = Serializer::header_offset +
+          sizeof(PixelT) * static_cast<size_t>(header.width) * header.height;
+      return std::min(end, data.size());
+    }
+
     // 定义一个私有函数GetHeader，用于获取图像数据的头部信息，通过调用Serializer类的DeserializeHeader方法，从父类存储的原始数据（Super::GetRawData()）中反序列化出图像头部信息，并返回其常量引用，外部代码不能修改该头部信息，头部信息可能包含图像的尺寸、视角等关键元数据
     const auto &GetHeader() const {
       return Serializer::DeserializeHeader(Super::GetRawData());
@@ -0,0 +1,96 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/sensor/data/Image.h"
+#include "carla/sensor/data/InstanceTableEntry.h"
+#include "carla/sensor/s11n/InstanceSegmentationImageSerializer.h"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+namespace carla {
+namespace sensor {
+namespace data {
+
+  /// @brief 实例分割相机的图像。
+  ///
+  /// 像素的编码见 s11n::InstanceSegmentationImageSerializer。图像还带有
+  /// 这一帧的实例 id 到参与者 id 的映射表，不需要再向服务器查询。
+  class InstanceSegmentationImage : public Image {
+    using Super = Image;
+  protected:
+
+    using Serializer = s11n::InstanceSegmentationImageSerializer;
+
+    friend Serializer;
+
+    explicit InstanceSegmentationImage(RawData &&data)
+      : Super(std::move(data)) {}
+
+  public:
+
+    /// 像素的实例 id，0 表示没有实例。
+    static uint32_t GetInstanceId(const Color &pixel) {
+      return Serializer::DecodeInstanceId(pixel.r, pixel.g, pixel.b);
+    }
+
+    /// 像素的语义标签。
+    static uint8_t GetLabel(const Color &pixel) {
+      return Serializer::DecodeLabel(pixel.r);
+    }
+
+    /// 映射表中的条目数量。
+    size_t GetInstanceTableSize() const {
+      return Serializer::GetTableSize(GetRawData());
+    }
+
+    /// 复制映射表，条目按实例 id 升序排列。
+    std::vector<InstanceTableEntry> GetInstanceTable() const {
+      std::vector<InstanceTableEntry> result(GetInstanceTableSize());
+      if (!result.empty()) {
+        std::memcpy(
+            result.data(),
+            GetTableBegin(),
+            sizeof(InstanceTableEntry) * result.size());
+      }
+      return result;
+    }
+
+    /// 实例 id 对应的参与者 id，没有对应的参与者（例如地图中的静态物体）时返回 0。
+    ActorId GetActorId(uint32_t instance_id) const {
+      const size_t count = GetInstanceTableSize();
+      const unsigned char *table = GetTableBegin();
+      size_t first = 0u;
+      size_t last = count;
+      while (first < last) {
+        const size_t middle = first + (last - first) / 2u;
+        InstanceTableEntry entry;
+        std::memcpy(&entry, table + sizeof(InstanceTableEntry) * middle, sizeof(entry));
+        if (entry.instance_id == instance_id) {
+          return entry.actor_id;
+        } else if (entry.instance_id < instance_id) {
+          first = middle + 1u;
+        } else {
+          last = middle;
+        }
+      }
+      return 0u;
+    }
+
+  private:
+
+    const unsigned char *GetTableBegin() const {
+      const auto &raw_data = GetRawData();
+      return raw_data.begin() + Serializer::GetTableOffset(raw_data) + sizeof(Serializer::TableHeader);
+    }
+  };
+
+} // namespace data
+} // namespace sensor
+} // namespace carla
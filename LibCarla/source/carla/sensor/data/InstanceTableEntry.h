@@ -0,0 +1,34 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/rpc/ActorId.h"
+
+#include <cstdint>
+
+namespace carla {
+namespace sensor {
+namespace data {
+
+#pragma pack(push, 1)
+
+  /// @brief 实例分割图像中实例 id 与 CARLA 参与者 id 的对应关系。
+  ///
+  /// 实例 id 由服务器为每个带标签的参与者分配，并不等于参与者 id；只有
+  /// 在剧集中注册了的参与者才有对应的条目。
+  struct InstanceTableEntry {
+    uint32_t instance_id;
+    ActorId actor_id;
+  };
+
+#pragma pack(pop)
+
+  static_assert(sizeof(InstanceTableEntry) == 8u, "Invalid instance table entry size");
+
+} // namespace data
+} // namespace sensor
+} // namespace carla
@@ -8,9 +8,14 @@
 
 #include "carla/Debug.h"
 #include "carla/sensor/data/ActorDynamicState.h"
+#include "carla/sensor/data/ActorExtensionState.h"
 #include "carla/sensor/data/Array.h"
+#include "carla/sensor/s11n/EpisodeStateDelta.h"
 #include "carla/sensor/s11n/EpisodeStateSerializer.h"
 
+#include <cstring>
+#include <vector>
+
 // 定义在carla命名空间下的sensor命名空间，再嵌套一个data命名空间，用于对传感器相关数据结构等进行更细分的组织
 namespace carla {
 namespace sensor {
@@ -29,7 +34,7 @@ namespace data {
 
 // 显式构造函数，接受一个右值引用的RawData类型参数，用于初始化基类Array，通过调用Serializer的header_offset和移动传入的数据来完成初始化
     explicit RawEpisodeState(RawData &&data)
-      : Super(Serializer::header_offset, std::move(data)) {}
+      : Super(std::move(data), [](const RawData &d) { return Serializer::GetBodyOffset(d); }) {}
 
   private:
 
@@ -69,6 +74,47 @@ namespace data {
       return GetHeader().simulation_state;
     }
 
+    /// 是否是相对关键帧的增量。增量帧不能按数组访问参与者，需要用 DecodeDelta 解析。
+    bool IsDeltaEncoded() const {
+      return (GetSimulationState() & Serializer::DeltaEncoded) != 0;
+    }
+
+    /// 消息中是否包含参与者的扩展数据，只有在兴趣集合中请求了扩展时才包含。
+    bool HasExtensions() const {
+      return (GetSimulationState() & Serializer::HasExtensions) != 0;
+    }
+
+    /// 复制消息中的参与者扩展数据，没有扩展数据时返回空数组。
+    std::vector<ActorExtensionState> GetExtensions() const {
+      std::vector<ActorExtensionState> result;
+      if (!HasExtensions()) {
+        return result;
+      }
+      const auto &raw_data = Super::GetRawData();
+      const size_t offset = Serializer::header_offset + sizeof(Serializer::ExtensionHeader);
+      const size_t body_offset = Serializer::GetBodyOffset(raw_data);
+      if (body_offset > offset) {
+        result.resize((body_offset - offset) / sizeof(ActorExtensionState));
+        std::memcpy(result.data(), raw_data.begin() + offset, sizeof(ActorExtensionState) * result.size());
+      }
+      return result;
+    }
+
+    /// 解析增量帧，数据不完整时返回false。
+    bool DecodeDelta(
+        uint64_t &keyframe,
+        std::vector<ActorId> &removed,
+        std::vector<s11n::episode_state_delta::ChangedActor> &changed) const {
+      DEBUG_ASSERT(IsDeltaEncoded());
+      const auto &raw_data = Super::GetRawData();
+      return s11n::episode_state_delta::Decode(
+          raw_data.begin() + Serializer::GetBodyOffset(raw_data),
+          raw_data.end(),
+          keyframe,
+          removed,
+          changed);
+    }
+
   };
 
 } // namespace data
@@ -0,0 +1,47 @@
+// Copyright (c) 2024 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <cstdint>
+
+namespace carla {
+namespace sensor {
+namespace data {
+
+  /// 遥测传感器一帧数据中车辆的部分，位于各车轮之前。单位与 rpc::VehicleTelemetryData 相同。
+  struct VehicleTelemetryHeader {
+    float speed;       // m/s
+    float steer;
+    float throttle;
+    float brake;
+    float engine_rpm;
+    int32_t gear;
+    float drag;        // kg*m/s2
+    uint32_t wheel_count;
+  };
+
+  /// 一个车轮的遥测数据，单位与 rpc::WheelTelemetryData 相同。
+  struct WheelTelemetry {
+    float tire_friction;
+    float lat_slip;
+    float long_slip;
+    float omega;
+    float tire_load;
+    float normalized_tire_load;
+    float torque;
+    float long_force;
+    float lat_force;
+    float normalized_long_force;
+    float normalized_lat_force;
+  };
+
+  static_assert(sizeof(VehicleTelemetryHeader) == 8u * sizeof(uint32_t), "Invalid VehicleTelemetryHeader size");
+  static_assert(sizeof(WheelTelemetry) == 11u * sizeof(float), "Invalid WheelTelemetry size");
+
+} // namespace data
+} // namespace sensor
+} // namespace carla
@@ -0,0 +1,69 @@
+// Copyright (c) 2024 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/sensor/data/Array.h"
+#include "carla/sensor/data/VehicleTelemetry.h"
+#include "carla/sensor/s11n/VehicleTelemetrySerializer.h"
+
+namespace carla {
+namespace sensor {
+namespace data {
+
+  /// 车辆遥测传感器一帧的数据，数组的元素是各车轮的遥测数据。
+  class VehicleTelemetryMeasurement : public Array<data::WheelTelemetry> {
+    using Super = Array<data::WheelTelemetry>;
+  protected:
+
+    using Serializer = s11n::VehicleTelemetrySerializer;
+
+    friend Serializer;
+
+    explicit VehicleTelemetryMeasurement(RawData &&data)
+      : Super(std::move(data), [](const RawData &d) {
+          return Serializer::GetHeaderOffset(d);
+        }),
+        _header(Serializer::DeserializeHeader(Super::GetRawData())) {}
+
+  public:
+
+    float GetSpeed() const {
+      return _header.speed;
+    }
+
+    float GetSteer() const {
+      return _header.steer;
+    }
+
+    float GetThrottle() const {
+      return _header.throttle;
+    }
+
+    float GetBrake() const {
+      return _header.brake;
+    }
+
+    float GetEngineRPM() const {
+      return _header.engine_rpm;
+    }
+
+    int32_t GetGear() const {
+      return _header.gear;
+    }
+
+    float GetDrag() const {
+      return _header.drag;
+    }
+
+  private:
+
+    VehicleTelemetryHeader _header;
+  };
+
+} // namespace data
+} // namespace sensor
+} // namespace carla
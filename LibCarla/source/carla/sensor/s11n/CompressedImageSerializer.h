@@ -0,0 +1,68 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/Memory.h"
+#include "carla/sensor/RawData.h"
+
+#include <cstdint>
+#include <cstring>
+
+namespace carla {
+namespace sensor {
+
+  class SensorData;
+
+namespace s11n {
+
+  /// 序列化相机传感器在服务器端压缩过的图像，数据部分是编码后的字节流。
+  class CompressedImageSerializer {
+  public:
+
+    /// 数据部分的编码格式。
+    enum class Format : uint32_t {
+      JPEG = 0u
+    };
+
+#pragma pack(push, 1)
+    struct CompressedImageHeader {
+      uint32_t width;
+      uint32_t height;
+      float fov_angle;
+      Format format;
+    };
+#pragma pack(pop)
+
+    constexpr static auto header_offset = sizeof(CompressedImageHeader);
+
+    static const CompressedImageHeader &DeserializeHeader(const RawData &data) {
+      return *reinterpret_cast<const CompressedImageHeader *>(data.begin());
+    }
+
+    /// @a encoded 前面要预留 header_offset 个字节用来写入头部。
+    template <typename Sensor>
+    static Buffer Serialize(const Sensor &sensor, Buffer &&encoded);
+
+    static SharedPtr<SensorData> Deserialize(RawData &&data);
+  };
+
+  template <typename Sensor>
+  inline Buffer CompressedImageSerializer::Serialize(const Sensor &sensor, Buffer &&encoded) {
+    DEBUG_ASSERT(encoded.size() > sizeof(CompressedImageHeader));
+    CompressedImageHeader header = {
+      sensor.GetImageWidth(),
+      sensor.GetImageHeight(),
+      sensor.GetFOVAngle(),
+      Format::JPEG
+    };
+    std::memcpy(encoded.data(), reinterpret_cast<const void *>(&header), sizeof(header));
+    return std::move(encoded);
+  }
+
+} // namespace s11n
+} // namespace sensor
+} // namespace carla
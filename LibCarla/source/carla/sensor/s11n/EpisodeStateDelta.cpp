@@ -0,0 +1,282 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/sensor/s11n/EpisodeStateDelta.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <unordered_set>
+
+namespace carla {
+namespace sensor {
+namespace s11n {
+namespace episode_state_delta {
+
+  using ActorDynamicState = data::ActorDynamicState;
+  using ActorExtensionState = data::ActorExtensionState;
+  using SimulationState = EpisodeStateSerializer::SimulationState;
+
+  static constexpr double LOCATION_SCALE = 1000.0;                // 毫米
+  static constexpr double ROTATION_SCALE = 65536.0 / 360.0;       // 一圈对应int16的全部取值
+  static constexpr double VELOCITY_SCALE = 100.0;                 // 厘米每秒
+  static constexpr double ANGULAR_VELOCITY_SCALE = 10.0;          // 0.1度每秒
+  static constexpr double ACCELERATION_SCALE = 100.0;             // 厘米每二次方秒
+
+  template <typename T>
+  static T QuantizeValue(const double value, const double scale) {
+    const double scaled = std::round(value * scale);
+    if (!(scaled > std::numeric_limits<T>::lowest())) {
+      // 同时处理NaN
+      return std::numeric_limits<T>::lowest();
+    }
+    return static_cast<T>(std::min(scaled, static_cast<double>(std::numeric_limits<T>::max())));
+  }
+
+  static int16_t QuantizeAngle(const float degrees) {
+    // 角度按一圈取模，结果落在[-180, 180)内
+    const double turns = static_cast<double>(degrees) / 360.0;
+    const double wrapped = (turns - std::floor(turns + 0.5)) * 65536.0;
+    return QuantizeValue<int16_t>(wrapped, 1.0);
+  }
+
+  template <typename T, typename VectorT>
+  static void QuantizeVector(const VectorT &vector, const double scale, T (&result)[3u]) {
+    result[0u] = QuantizeValue<T>(vector.x, scale);
+    result[1u] = QuantizeValue<T>(vector.y, scale);
+    result[2u] = QuantizeValue<T>(vector.z, scale);
+  }
+
+  static size_t GetExtensionsSize(const std::vector<ActorExtensionState> *extensions) {
+    if (extensions == nullptr) {
+      return 0u;
+    }
+    return sizeof(EpisodeStateSerializer::ExtensionHeader) + sizeof(ActorExtensionState) * extensions->size();
+  }
+
+  /// 写入消息头及其后的扩展数据，返回正文开始的位置。
+  static unsigned char *WriteHeader(
+      EpisodeStateSerializer::Header header,
+      const std::vector<ActorExtensionState> *extensions,
+      unsigned char *cursor) {
+    if (extensions != nullptr) {
+      header.simulation_state = static_cast<SimulationState>(
+          header.simulation_state | EpisodeStateSerializer::HasExtensions);
+    }
+    std::memcpy(cursor, &header, sizeof(header));
+    cursor += sizeof(header);
+    if (extensions != nullptr) {
+      const EpisodeStateSerializer::ExtensionHeader extension_header{
+          static_cast<uint32_t>(extensions->size())};
+      std::memcpy(cursor, &extension_header, sizeof(extension_header));
+      cursor += sizeof(extension_header);
+      if (!extensions->empty()) {
+        std::memcpy(cursor, extensions->data(), sizeof(ActorExtensionState) * extensions->size());
+        cursor += sizeof(ActorExtensionState) * extensions->size();
+      }
+    }
+    return cursor;
+  }
+
+  template <typename T>
+  static geom::Vector3D DequantizeVector(const T (&value)[3u], const double scale) {
+    return {
+        static_cast<float>(value[0u] / scale),
+        static_cast<float>(value[1u] / scale),
+        static_cast<float>(value[2u] / scale)};
+  }
+
+  QuantizedActorState Quantize(const ActorDynamicState &state) {
+    QuantizedActorState result;
+    result.id = state.id;
+    result.flags = 0u;
+    result.actor_state = state.actor_state;
+    QuantizeVector(state.transform.location, LOCATION_SCALE, result.location);
+    result.rotation[0u] = QuantizeAngle(state.transform.rotation.pitch);
+    result.rotation[1u] = QuantizeAngle(state.transform.rotation.yaw);
+    result.rotation[2u] = QuantizeAngle(state.transform.rotation.roll);
+    QuantizeVector(state.velocity, VELOCITY_SCALE, result.velocity);
+    QuantizeVector(state.angular_velocity, ANGULAR_VELOCITY_SCALE, result.angular_velocity);
+    QuantizeVector(state.acceleration, ACCELERATION_SCALE, result.acceleration);
+    return result;
+  }
+
+  void Dequantize(const QuantizedActorState &quantized, ActorDynamicState &state) {
+    state.id = quantized.id;
+    state.actor_state = quantized.actor_state;
+    const auto location = DequantizeVector(quantized.location, LOCATION_SCALE);
+    state.transform.location = geom::Location{location.x, location.y, location.z};
+    state.transform.rotation.pitch = static_cast<float>(quantized.rotation[0u] / ROTATION_SCALE);
+    state.transform.rotation.yaw = static_cast<float>(quantized.rotation[1u] / ROTATION_SCALE);
+    state.transform.rotation.roll = static_cast<float>(quantized.rotation[2u] / ROTATION_SCALE);
+    state.velocity = DequantizeVector(quantized.velocity, VELOCITY_SCALE);
+    state.angular_velocity = DequantizeVector(quantized.angular_velocity, ANGULAR_VELOCITY_SCALE);
+    state.acceleration = DequantizeVector(quantized.acceleration, ACCELERATION_SCALE);
+  }
+
+  bool Decode(
+      const unsigned char *begin,
+      const unsigned char *end,
+      uint64_t &keyframe,
+      std::vector<ActorId> &removed,
+      std::vector<ChangedActor> &changed) {
+    auto read = [&begin, end](auto &value) {
+      if (static_cast<size_t>(end - begin) < sizeof(value)) {
+        return false;
+      }
+      std::memcpy(&value, begin, sizeof(value));
+      begin += sizeof(value);
+      return true;
+    };
+    DeltaHeader header;
+    if (!read(header)) {
+      return false;
+    }
+    // 数量来自网络数据，分配内存之前确认数据足够
+    const size_t remaining = static_cast<size_t>(end - begin);
+    if ((header.removed_count > remaining / sizeof(ActorId)) ||
+        (header.changed_count > remaining / sizeof(QuantizedActorState))) {
+      return false;
+    }
+    keyframe = header.keyframe;
+    removed.resize(header.removed_count);
+    for (auto &id : removed) {
+      if (!read(id)) {
+        return false;
+      }
+    }
+    changed.clear();
+    changed.reserve(header.changed_count);
+    for (uint32_t i = 0u; i < header.changed_count; ++i) {
+      QuantizedActorState quantized;
+      if (!read(quantized)) {
+        return false;
+      }
+      ChangedActor actor;
+      Dequantize(quantized, actor.state);
+      actor.has_type_dependent_state = (quantized.flags & TYPE_DEPENDENT_STATE) != 0u;
+      if (actor.has_type_dependent_state && !read(actor.state.state)) {
+        return false;
+      }
+      changed.emplace_back(actor);
+    }
+    return begin == end;
+  }
+
+  void Encoder::Encode(
+      const uint64_t frame,
+      Header header,
+      const std::vector<ActorDynamicState> &actors,
+      const std::vector<ActorExtensionState> *extensions,
+      Buffer &buffer) {
+    const bool needs_keyframe =
+        !IsEnabled() ||
+        !_has_keyframe ||
+        (header.episode_id != _keyframe_episode_id) ||
+        ((header.simulation_state & EpisodeStateSerializer::MapChange) != 0) ||
+        (++_frames_since_keyframe >= _keyframe_interval);
+    if (needs_keyframe) {
+      EncodeKeyframe(frame, header, actors, extensions, buffer);
+      return;
+    }
+
+    // 按最大可能的大小分配，写完后缩小
+    buffer.reset(static_cast<Buffer::size_type>(
+        sizeof(Header) +
+        GetExtensionsSize(extensions) +
+        sizeof(DeltaHeader) +
+        sizeof(ActorId) * _keyframe_actors.size() +
+        (sizeof(QuantizedActorState) + sizeof(ActorDynamicState::TypeDependentState)) * actors.size()));
+    header.simulation_state = static_cast<SimulationState>(
+        header.simulation_state | EpisodeStateSerializer::DeltaEncoded);
+    unsigned char *cursor = WriteHeader(header, extensions, buffer.data());
+    auto write = [&cursor](const auto &value) {
+      std::memcpy(cursor, &value, sizeof(value));
+      cursor += sizeof(value);
+    };
+
+    unsigned char *delta_header_position = cursor;
+    DeltaHeader delta_header{_keyframe, 0u, 0u};
+    write(delta_header);
+
+    std::unordered_set<ActorId> present;
+    present.reserve(actors.size());
+    for (const auto &actor : actors) {
+      present.insert(actor.id);
+    }
+    for (const auto &pair : _keyframe_actors) {
+      if (present.find(pair.first) == present.end()) {
+        write(pair.first);
+        ++delta_header.removed_count;
+      }
+    }
+
+    for (const auto &actor : actors) {
+      QuantizedActorState quantized = Quantize(actor);
+      auto it = _keyframe_actors.find(actor.id);
+      bool state_changed = true;
+      if (it != _keyframe_actors.end()) {
+        state_changed = std::memcmp(&it->second.state, &actor.state, sizeof(actor.state)) != 0;
+        const bool moved = std::memcmp(&it->second.quantized, &quantized, sizeof(quantized)) != 0;
+        if (!moved && !state_changed) {
+          // 与关键帧相同，客户端沿用关键帧中的值
+          continue;
+        }
+      }
+      if (state_changed) {
+        quantized.flags |= TYPE_DEPENDENT_STATE;
+      }
+      write(quantized);
+      if (state_changed) {
+        write(actor.state);
+      }
+      ++delta_header.changed_count;
+    }
+
+    std::memcpy(delta_header_position, &delta_header, sizeof(delta_header));
+    buffer.resize(static_cast<Buffer::size_type>(cursor - buffer.data()));
+  }
+
+  void Encoder::EncodeKeyframe(
+      const uint64_t frame,
+      const Header &header,
+      const std::vector<ActorDynamicState> &actors,
+      const std::vector<ActorExtensionState> *extensions,
+      Buffer &buffer) {
+    buffer.reset(static_cast<Buffer::size_type>(
+        sizeof(Header) +
+        GetExtensionsSize(extensions) +
+        sizeof(ActorDynamicState) * actors.size()));
+    unsigned char *cursor = WriteHeader(header, extensions, buffer.data());
+    if (!actors.empty()) {
+      std::memcpy(cursor, actors.data(), sizeof(ActorDynamicState) * actors.size());
+    }
+
+    if (!IsEnabled()) {
+      _has_keyframe = false;
+      _keyframe_actors.clear();
+      return;
+    }
+    _has_keyframe = true;
+    _keyframe = frame;
+    _keyframe_episode_id = header.episode_id;
+    _frames_since_keyframe = 0u;
+    _keyframe_actors.clear();
+    _keyframe_actors.reserve(actors.size());
+    for (const auto &actor : actors) {
+      // 比较时使用量化后的值，与关键帧的差别小于量化精度的参与者视为未移动
+      KeyframeActor keyframe_actor;
+      keyframe_actor.quantized = Quantize(actor);
+      std::memcpy(&keyframe_actor.state, &actor.state, sizeof(actor.state));
+      _keyframe_actors.emplace(actor.id, keyframe_actor);
+    }
+  }
+
+} // namespace episode_state_delta
+} // namespace s11n
+} // namespace sensor
+} // namespace carla
@@ -0,0 +1,156 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/Buffer.h"
+#include "carla/sensor/data/ActorDynamicState.h"
+#include "carla/sensor/data/ActorExtensionState.h"
+#include "carla/sensor/s11n/EpisodeStateSerializer.h"
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace carla {
+namespace sensor {
+namespace s11n {
+
+  /// @brief 剧集状态的增量编码。
+  ///
+  /// 关键帧与普通的剧集状态完全相同。两个关键帧之间的帧在消息头中置上
+  /// SimulationState::DeltaEncoded，正文依次为 DeltaHeader、自关键帧以来被销毁的参与者ID，
+  /// 以及自关键帧以来发生变化或新出现的参与者的量化状态。每个增量都只相对于关键帧，
+  /// 客户端丢失其间的任何一帧都不影响之后的帧。
+  ///
+  /// 参与者的扩展数据（见 EpisodeStateSerializer::ExtensionHeader）很小，
+  /// 每一帧都完整地放在消息头与正文之间，不参与增量编码。
+  namespace episode_state_delta {
+
+#pragma pack(push, 1)
+
+    struct DeltaHeader {
+      /// 增量所基于的关键帧的帧号。
+      uint64_t keyframe;
+      uint32_t removed_count;
+      uint32_t changed_count;
+    };
+
+    /// 量化后的参与者状态。位置精确到毫米，角度精确到约0.0055度，
+    /// 速度和加速度精确到厘米，角速度精确到0.1度每秒，超出范围的值被截断。
+    struct QuantizedActorState {
+      ActorId id;
+      /// 置上 TYPE_DEPENDENT_STATE 时其后紧跟 TypeDependentState，否则沿用关键帧中的值。
+      uint8_t flags;
+      rpc::ActorState actor_state;
+      int32_t location[3u];
+      int16_t rotation[3u];
+      int16_t velocity[3u];
+      int16_t angular_velocity[3u];
+      int16_t acceleration[3u];
+    };
+
+#pragma pack(pop)
+
+    constexpr uint8_t TYPE_DEPENDENT_STATE = 0x1 << 0;
+
+    QuantizedActorState Quantize(const data::ActorDynamicState &state);
+
+    /// 把 @a quantized 中的字段还原到 @a state 中，不修改 state.state。
+    void Dequantize(const QuantizedActorState &quantized, data::ActorDynamicState &state);
+
+    /// 增量中的一个参与者。
+    struct ChangedActor {
+      data::ActorDynamicState state;
+      /// 为false时 state.state 无效，应沿用关键帧中的值。
+      bool has_type_dependent_state;
+    };
+
+    /// 解析增量帧的正文（剧集状态消息头之后的部分），数据不完整时返回false。
+    bool Decode(
+        const unsigned char *begin,
+        const unsigned char *end,
+        uint64_t &keyframe,
+        std::vector<ActorId> &removed,
+        std::vector<ChangedActor> &changed);
+
+    /// @brief 服务器端的编码器，记住最近的关键帧，决定每一帧发送关键帧还是增量。
+    class Encoder {
+    public:
+
+      using Header = EpisodeStateSerializer::Header;
+
+      /// @a keyframe_interval 为两个关键帧之间的帧数，0或1表示每一帧都是关键帧。
+      explicit Encoder(uint32_t keyframe_interval = 0u)
+        : _keyframe_interval(keyframe_interval) {}
+
+      void SetKeyframeInterval(uint32_t keyframe_interval) {
+        _keyframe_interval = keyframe_interval;
+        Reset();
+      }
+
+      uint32_t GetKeyframeInterval() const {
+        return _keyframe_interval;
+      }
+
+      bool IsEnabled() const {
+        return _keyframe_interval > 1u;
+      }
+
+      /// 下一帧强制发送关键帧。
+      void Reset() {
+        _has_keyframe = false;
+      }
+
+      /// 把帧号为 @a frame 的剧集状态写入 @a buffer。@a extensions 不为空指针时
+      /// 在消息头之后写入参与者的扩展数据并置上 SimulationState::HasExtensions。
+      void Encode(
+          uint64_t frame,
+          Header header,
+          const std::vector<data::ActorDynamicState> &actors,
+          const std::vector<data::ActorExtensionState> *extensions,
+          Buffer &buffer);
+
+      void Encode(
+          uint64_t frame,
+          Header header,
+          const std::vector<data::ActorDynamicState> &actors,
+          Buffer &buffer) {
+        Encode(frame, header, actors, nullptr, buffer);
+      }
+
+    private:
+
+      struct KeyframeActor {
+        QuantizedActorState quantized;
+        data::ActorDynamicState::TypeDependentState state;
+      };
+
+      void EncodeKeyframe(
+          uint64_t frame,
+          const Header &header,
+          const std::vector<data::ActorDynamicState> &actors,
+          const std::vector<data::ActorExtensionState> *extensions,
+          Buffer &buffer);
+
+      uint32_t _keyframe_interval;
+
+      bool _has_keyframe = false;
+
+      uint64_t _keyframe = 0u;
+
+      uint64_t _keyframe_episode_id = 0u;
+
+      uint32_t _frames_since_keyframe = 0u;
+
+      std::unordered_map<ActorId, KeyframeActor> _keyframe_actors;
+    };
+
+  } // namespace episode_state_delta
+
+} // namespace s11n
+} // namespace sensor
+} // namespace carla
@@ -13,8 +13,10 @@
 #include "carla/geom/Vector3DInt.h"  // 包含整数三维向量定义
 #include "carla/sensor/RawData.h"// 包含传感器原始数据的相关定义
 #include "carla/sensor/data/ActorDynamicState.h"  // 包含动态对象状态的定义
+#include "carla/sensor/data/ActorExtensionState.h"
 
 #include <cstdint>// 标准库，用于固定宽度的整数类型
+#include <cstring>
 
 namespace carla {
 namespace sensor {
@@ -30,7 +32,9 @@ namespace s11n {
     enum SimulationState {  //枚举类，用于表示模拟状态的类型
       None               = (0x0 << 0),  // 默认状态，无特定更新
       MapChange          = (0x1 << 0),  // 表示地图变更的状态
-      PendingLightUpdate = (0x1 << 1)  // 表示待处理的交通信号灯更新
+      PendingLightUpdate = (0x1 << 1), // 表示待处理的交通信号灯更新
+      DeltaEncoded       = (0x1 << 2),  // 数据正文是相对关键帧的增量，见 EpisodeStateDelta.h
+      HasExtensions      = (0x1 << 3)   // 消息头之后是参与者的扩展数据，见 ExtensionHeader
     };
 
 #pragma pack(push, 1)
@@ -41,10 +45,35 @@ namespace s11n {
       geom::Vector3DInt map_origin;  // 地图的原点位置（三维整数坐标）
       SimulationState simulation_state = SimulationState::None;  // 当前的模拟状态
     };
+
+    /// 置上 HasExtensions 时紧跟在 Header 之后，其后是 @a count 个
+    /// data::ActorExtensionState，再之后才是数据正文。
+    struct ExtensionHeader {
+      uint32_t count;
+    };
 #pragma pack(pop)
 
     constexpr static auto header_offset = sizeof(Header);  // 数据头部的偏移量，用于快速定位数据正文
 
+    /// 扩展数据之后、数据正文开始的偏移量。扩展数据不完整时返回消息的大小。
+    static size_t GetBodyOffset(const RawData &message) {
+      const size_t size = message.size();
+      if ((size < header_offset) ||
+          ((DeserializeHeader(message).simulation_state & HasExtensions) == 0)) {
+        return header_offset;
+      }
+      if (size - header_offset < sizeof(ExtensionHeader)) {
+        return size;
+      }
+      ExtensionHeader extension_header;
+      std::memcpy(&extension_header, message.begin() + header_offset, sizeof(extension_header));
+      const size_t extensions_offset = header_offset + sizeof(ExtensionHeader);
+      if (extension_header.count > (size - extensions_offset) / sizeof(data::ActorExtensionState)) {
+        return size;
+      }
+      return extensions_offset + extension_header.count * sizeof(data::ActorExtensionState);
+    }
+
     //反序列化数据包头部
     static const Header &DeserializeHeader(const RawData &message) {  // 反序列化数据包头部
       return *reinterpret_cast<const Header *>(message.begin());  // 返回解析后的'Header'结构体的引用
@@ -0,0 +1,67 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/Memory.h"
+#include "carla/sensor/RawData.h"
+
+#include <cstdint>
+#include <cstring>
+
+namespace carla {
+namespace sensor {
+
+  class SensorData;
+
+namespace s11n {
+
+  /// 把同一帧中请求的多个GBuffer纹理序列化成一条消息。
+  ///
+  /// 头部之后按纹理ID从小到大依次存放每个纹理，每个纹理都是
+  /// width * height 个BGRA像素。
+  class GBufferMultipartSerializer {
+  public:
+
+#pragma pack(push, 1)
+    struct MultipartHeader {
+      uint32_t width;
+      uint32_t height;
+      float fov_angle;
+      uint64_t texture_mask; // 第 i 位表示消息中包含ID为 i 的纹理
+    };
+#pragma pack(pop)
+
+    constexpr static auto header_offset = sizeof(MultipartHeader);
+
+    static const MultipartHeader &DeserializeHeader(const RawData &data) {
+      return *reinterpret_cast<const MultipartHeader *>(data.begin());
+    }
+
+    template <typename Sensor>
+    static Buffer Serialize(const Sensor &sensor, Buffer &&textures,
+        uint32_t ImageWidth, uint32_t ImageHeight, float FovAngle, uint64_t TextureMask);
+
+    static SharedPtr<SensorData> Deserialize(RawData &&data);
+  };
+
+  template <typename Sensor>
+  inline Buffer GBufferMultipartSerializer::Serialize(const Sensor &/*sensor*/, Buffer &&textures,
+      uint32_t ImageWidth, uint32_t ImageHeight, float FovAngle, uint64_t TextureMask) {
+    DEBUG_ASSERT(textures.size() > sizeof(MultipartHeader));
+    MultipartHeader header = {
+      ImageWidth,
+      ImageHeight,
+      FovAngle,
+      TextureMask
+    };
+    std::memcpy(textures.data(), reinterpret_cast<const void *>(&header), sizeof(header));
+    return std::move(textures);
+  }
+
+} // namespace s11n
+} // namespace sensor
+} // namespace carla
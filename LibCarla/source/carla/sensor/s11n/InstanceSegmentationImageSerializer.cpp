@@ -0,0 +1,27 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/sensor/s11n/InstanceSegmentationImageSerializer.h"
+
+#include "carla/sensor/data/InstanceSegmentationImage.h"
+
+namespace carla {
+namespace sensor {
+namespace s11n {
+
+  SharedPtr<SensorData> InstanceSegmentationImageSerializer::Deserialize(RawData &&data) {
+    auto image = SharedPtr<data::InstanceSegmentationImage>(
+        new data::InstanceSegmentationImage{std::move(data)});
+    // 与 ImageSerializer 相同，将每个像素的 alpha 设为最大值，使其完全不透明
+    for (auto &pixel : *image) {
+      pixel.a = 255u;
+    }
+    return image;
+  }
+
+} // namespace s11n
+} // namespace sensor
+} // namespace carla
@@ -0,0 +1,119 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/Buffer.h"
+#include "carla/Debug.h"
+#include "carla/Memory.h"
+#include "carla/sensor/RawData.h"
+#include "carla/sensor/data/Color.h"
+#include "carla/sensor/data/InstanceTableEntry.h"
+#include "carla/sensor/s11n/ImageSerializer.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+namespace carla {
+namespace sensor {
+
+  class SensorData;
+
+namespace s11n {
+
+  /// @brief 序列化实例分割相机的图像。
+  ///
+  /// 像素与 ImageSerializer 相同，每个像素的 R 通道低 5 位是语义标签，
+  /// 高 3 位与 B、G 通道一起组成 19 位的实例 id（id 的第 16~18 位、
+  /// 第 8~15 位、第 0~7 位）；id 为 0 表示没有实例。像素之后是
+  /// TableHeader 和按实例 id 升序排列的 data::InstanceTableEntry，
+  /// 客户端用它把实例 id 换成参与者 id。
+  class InstanceSegmentationImageSerializer {
+  public:
+
+    using ImageHeader = ImageSerializer::ImageHeader;
+
+#pragma pack(push, 1)
+    struct TableHeader {
+      uint32_t count;
+    };
+#pragma pack(pop)
+
+    constexpr static auto header_offset = ImageSerializer::header_offset;
+
+    /// R 通道中语义标签占用的位数。
+    constexpr static uint32_t label_bits = 5u;
+
+    constexpr static uint8_t label_mask = (1u << label_bits) - 1u;
+
+    /// 能编码的最大实例 id。
+    constexpr static uint32_t max_instance_id = (1u << (16u + 8u - label_bits)) - 1u;
+
+    /// 从 BGRA 像素中解出实例 id。
+    static uint32_t DecodeInstanceId(uint8_t r, uint8_t g, uint8_t b) {
+      return (static_cast<uint32_t>(r >> label_bits) << 16u) |
+             (static_cast<uint32_t>(b) << 8u) |
+             static_cast<uint32_t>(g);
+    }
+
+    /// 从 BGRA 像素中解出语义标签。
+    static uint8_t DecodeLabel(uint8_t r) {
+      return r & label_mask;
+    }
+
+    /// 映射表在消息中的偏移量，即像素之后。消息不完整时返回消息的大小。
+    static size_t GetTableOffset(const RawData &data) {
+      if (data.size() < header_offset) {
+        return data.size();
+      }
+      const auto &header = ImageSerializer::DeserializeHeader(data);
+      const size_t pixels = static_cast<size_t>(header.width) * header.height;
+      return std::min(header_offset + sizeof(data::Color) * pixels, data.size());
+    }
+
+    /// 映射表中的条目数量，映射表不完整时返回 0。
+    static size_t GetTableSize(const RawData &data) {
+      const size_t offset = GetTableOffset(data);
+      if (data.size() - offset < sizeof(TableHeader)) {
+        return 0u;
+      }
+      TableHeader table_header;
+      std::memcpy(&table_header, data.begin() + offset, sizeof(table_header));
+      const size_t available = data.size() - offset - sizeof(TableHeader);
+      if (table_header.count > available / sizeof(data::InstanceTableEntry)) {
+        return 0u;
+      }
+      return table_header.count;
+    }
+
+    template <typename Sensor>
+    static Buffer Serialize(const Sensor &sensor, Buffer &&bitmap);
+
+    static SharedPtr<SensorData> Deserialize(RawData &&data);
+  };
+
+  /// @a sensor 需要提供 GetInstanceTable()，返回指向按实例 id 排序的
+  /// data::InstanceTableEntry 数组的共享指针，可以为空。
+  template <typename Sensor>
+  inline Buffer InstanceSegmentationImageSerializer::Serialize(const Sensor &sensor, Buffer &&bitmap) {
+    bitmap = ImageSerializer::Serialize(sensor, std::move(bitmap));
+    const auto table = sensor.GetInstanceTable();
+    const TableHeader table_header{table != nullptr ? static_cast<uint32_t>(table->size()) : 0u};
+    const size_t offset = bitmap.size();
+    const size_t table_size = sizeof(data::InstanceTableEntry) * table_header.count;
+    // 缓冲区来自池，容量通常已经足够，不需要重新分配
+    bitmap.resize(static_cast<uint64_t>(offset + sizeof(TableHeader) + table_size));
+    std::memcpy(bitmap.data() + offset, &table_header, sizeof(TableHeader));
+    if (table_size > 0u) {
+      std::memcpy(bitmap.data() + offset + sizeof(TableHeader), table->data(), table_size);
+    }
+    return std::move(bitmap);
+  }
+
+} // namespace s11n
+} // namespace sensor
+} // namespace carla
@@ -7,11 +7,25 @@
 
 #include "carla/sensor/data/Image.h"
 
+#include <vector>
+
 namespace carla {
   namespace sensor {
     namespace s11n {
 
       SharedPtr<SensorData> OpticalFlowImageSerializer::Deserialize(RawData &&data) {
+        // 半精度格式在客户端展开为每像素两个32位浮点数，OpticalFlowImage 的接口保持不变
+        const auto &header = DeserializeHeader(data);
+        if (IsHalfPrecision(header, data.size() - header_offset)) {
+          const size_t count = 2u * size_t(header.width) * header.height;
+          const size_t prefix = data._buffer.size() - data.size() + header_offset;
+          Buffer expanded(uint64_t(prefix + count * sizeof(float)));
+          std::memcpy(expanded.data(), data._buffer.data(), prefix);
+          std::vector<float> flow(count);
+          DecodeHalfPrecision(data.begin() + header_offset, count, flow.data());
+          std::memcpy(expanded.data() + prefix, flow.data(), count * sizeof(float));
+          data = RawData(std::move(expanded));
+        }
         auto image = SharedPtr<data::OpticalFlowImage>(new data::OpticalFlowImage{std::move(data)});
         return image;
       }
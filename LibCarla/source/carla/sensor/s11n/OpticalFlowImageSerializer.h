@@ -48,6 +48,54 @@ namespace carla {
 
         }
 
+        /// 半精度格式中每个像素的两个分量直接使用GPU输出的16位浮点数 v，
+        /// 光流为 (v - 0.5) * 4，与服务器端转换为32位浮点数时的公式相同。
+        static constexpr float half_precision_offset = 0.5f;
+        static constexpr float half_precision_scale = 4.0f;
+
+        /// 图像数据（不含头部）是否为每像素两个16位浮点数的半精度格式。
+        static bool IsHalfPrecision(const ImageHeader &header, size_t payload_size) {
+          return payload_size == size_t(header.width) * header.height * 2u * sizeof(uint16_t);
+        }
+
+        /// 把 @a count 个半精度分量解码为光流分量，@a source 不需要对齐。
+        static void DecodeHalfPrecision(const unsigned char *source, size_t count, float *destination) {
+          for (size_t i = 0u; i < count; ++i) {
+            uint16_t half;
+            std::memcpy(&half, source + i * sizeof(uint16_t), sizeof(half));
+            destination[i] = (HalfToFloat(half) - half_precision_offset) * half_precision_scale;
+          }
+        }
+
+        /// IEEE 754 半精度浮点数转换为单精度浮点数。
+        static float HalfToFloat(uint16_t half) {
+          const uint32_t sign = uint32_t(half & 0x8000u) << 16;
+          uint32_t exponent = (half >> 10) & 0x1Fu;
+          uint32_t mantissa = half & 0x3FFu;
+          uint32_t bits;
+          if (exponent == 0u) {
+            if (mantissa == 0u) {
+              bits = sign;
+            } else {
+              // 非规格化数，规格化后再转换
+              exponent = 127u - 15u + 1u;
+              while ((mantissa & 0x400u) == 0u) {
+                mantissa <<= 1;
+                --exponent;
+              }
+              bits = sign | (exponent << 23) | ((mantissa & 0x3FFu) << 13);
+            }
+          } else if (exponent == 0x1Fu) {
+            // 无穷大和NaN
+            bits = sign | 0x7F800000u | (mantissa << 13);
+          } else {
+            bits = sign | ((exponent + 127u - 15u) << 23) | (mantissa << 13);
+          }
+          float result;
+          std::memcpy(&result, &bits, sizeof(result));
+          return result;
+        }
+
         template <typename Sensor>
         static Buffer Serialize(const Sensor &sensor, Buffer &&bitmap);
 
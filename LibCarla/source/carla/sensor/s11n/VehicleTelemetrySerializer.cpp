@@ -0,0 +1,22 @@
+// Copyright (c) 2024 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/sensor/s11n/VehicleTelemetrySerializer.h"
+
+#include "carla/sensor/data/VehicleTelemetryMeasurement.h"
+
+namespace carla {
+namespace sensor {
+namespace s11n {
+
+  SharedPtr<SensorData> VehicleTelemetrySerializer::Deserialize(RawData &&data) {
+    return SharedPtr<data::VehicleTelemetryMeasurement>(
+        new data::VehicleTelemetryMeasurement{std::move(data)});
+  }
+
+} // namespace s11n
+} // namespace sensor
+} // namespace carla
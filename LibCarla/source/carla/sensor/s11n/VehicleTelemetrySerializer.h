@@ -0,0 +1,63 @@
+// Copyright (c) 2024 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/Buffer.h"
+#include "carla/Memory.h"
+#include "carla/sensor/RawData.h"
+#include "carla/sensor/data/VehicleTelemetry.h"
+
+#include <array>
+#include <vector>
+
+namespace carla {
+namespace sensor {
+
+  class SensorData;
+
+namespace s11n {
+
+  /// 车辆遥测传感器的序列化器。数据不经过 MsgPack，直接按内存布局写入：
+  /// 一个 data::VehicleTelemetryHeader 后面是 wheel_count 个 data::WheelTelemetry。
+  class VehicleTelemetrySerializer {
+  public:
+
+    static const data::VehicleTelemetryHeader &DeserializeHeader(const RawData &data) {
+      return *reinterpret_cast<const data::VehicleTelemetryHeader *>(data.begin());
+    }
+
+    static constexpr size_t GetHeaderOffset(const RawData &) {
+      return sizeof(data::VehicleTelemetryHeader);
+    }
+
+    template <typename Sensor>
+    static Buffer Serialize(
+        const Sensor &sensor,
+        const data::VehicleTelemetryHeader &header,
+        const std::vector<data::WheelTelemetry> &wheels,
+        Buffer &&output);
+
+    static SharedPtr<SensorData> Deserialize(RawData &&data);
+  };
+
+  template <typename Sensor>
+  inline Buffer VehicleTelemetrySerializer::Serialize(
+      const Sensor &,
+      const data::VehicleTelemetryHeader &header,
+      const std::vector<data::WheelTelemetry> &wheels,
+      Buffer &&output) {
+    DEBUG_ASSERT(header.wheel_count == wheels.size());
+    std::array<boost::asio::const_buffer, 2u> seq = {
+        boost::asio::buffer(&header, sizeof(header)),
+        boost::asio::buffer(wheels)};
+    output.copy_from(seq);
+    return std::move(output);
+  }
+
+} // namespace s11n
+} // namespace sensor
+} // namespace carla
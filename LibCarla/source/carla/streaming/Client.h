@@ -10,11 +10,16 @@
 #include "carla/ThreadPool.h"// 包含 carla 库中的线程池相关的头文件。
 #include "carla/streaming/Token.h"// 包含 carla 库中流处理相关的令牌（Token）头文件。
 
+#include "carla/streaming/detail/CallbackQueue.h"// 包含在回调线程池上按顺序执行回调的队列。
 #include "carla/streaming/detail/tcp/Client.h"// 包含 carla 库中流处理细节中 TCP 客户端相关的头文件。
 #include "carla/streaming/low_level/Client.h"// 包含 carla 库中流处理低层级客户端相关的头文件。
 
 #include <boost/asio/io_context.hpp>// 包含 Boost.Asio 库中的输入输出上下文（io_context）头文件。
 
+#include <functional>
+#include <memory>
+#include <unordered_map>
+
 namespace carla {
 namespace streaming {
 
@@ -34,37 +39,129 @@ public:
 
     ~Client() {
       _service.Stop();
+      _callback_service.Stop();
     }
-    // 析构函数，停止内部的线程池服务 _service。
+    // 析构函数，停止内部的线程池服务 _service 以及回调线程池 _callback_service。
 
     // 警告：不能对同一个流（即使是多流（MultiStream））订阅两次。
+    // @a lossless 为true时回调队列不丢弃消息，忽略 SetCallbackExecutor 的 max_pending。
+    // @a resolver 不为空时，连接持续失败后用它重新获取令牌，在网络线程上调用。
+    // 设置了 SetStreamCredits 且 @a lossless 为false时，每次回调返回后归还一个信用。
     template <typename Functor>
-    void Subscribe(const Token &token, Functor &&callback) {
-      _client.Subscribe(_service.io_context(), token, std::forward<Functor>(callback));
+    void Subscribe(
+        const Token &token,
+        Functor &&callback,
+        bool lossless = false,
+        std::function<bool(Token &)> resolver = {}) {
+      const uint32_t credits = (lossless || !_client.SupportsCredits(token)) ? 0u : _stream_credits;
+      if (credits == 0u) {
+        SubscribeImpl(token, std::forward<Functor>(callback), lossless, std::move(resolver), 0u);
+        return;
+      }
+      const auto stream_id = detail::token_type(token).get_stream_id();
+      std::function<void(Buffer)> user_callback = std::forward<Functor>(callback);
+      // 未处理的消息数已由信用限制，回调队列不需要再丢弃消息
+      SubscribeImpl(token, [this, stream_id, user_callback=std::move(user_callback)](Buffer message) {
+        try {
+          user_callback(std::move(message));
+        } catch (...) {
+          _client.GrantCredits(stream_id, 1u);
+          throw;
+        }
+        _client.GrantCredits(stream_id, 1u);
+      }, true, std::move(resolver), credits);
     }
     // 模板函数，用于订阅一个令牌（Token）对应的流，并传入一个回调函数（Functor），内部调用底层客户端的订阅方法，并传入线程池的输入输出上下文（io_context）、令牌和回调函数。
 
     void UnSubscribe(const Token &token) {
       _client.UnSubscribe(token);
+      auto it = _callback_queues.find(detail::token_type(token).get_stream_id());
+      if (it != _callback_queues.end()) {
+        it->second->Close();
+        _callback_queues.erase(it);
+      }
     }
     // 函数，用于取消订阅一个令牌（Token）对应的流，内部调用底层客户端的取消订阅方法。
 
+    /// 在 @a callback_threads 个独立的线程上执行之后订阅的流的回调，每个流的回调按顺序执行，
+    /// 一个流的回调很慢时不会阻塞读取其他流的网络线程。@a max_pending 不为0时，
+    /// 每个流最多缓存这么多条等待回调的消息，超出时丢弃最旧的消息。
+    ///
+    /// @a callback_threads 为0（默认）时回调直接在读取数据的网络线程上执行。
+    /// 必须在 AsyncRun 之前、订阅任何流之前调用。
+    void SetCallbackExecutor(size_t callback_threads, size_t max_pending = 0u) {
+      _callback_threads = callback_threads;
+      _max_pending_callbacks = max_pending;
+    }
+
+    /// 启用后之后订阅的流共用到同一服务器的一个连接，见 low_level::Client::SetMultiplexing。
+    void SetMultiplexing(bool enable) {
+      _client.SetMultiplexing(enable);
+    }
+
+    /// 之后订阅的流在多路复用连接上最多有 @a credits 条未处理完的消息，服务器在没有信用时
+    /// 跳过该流的消息，而不是在回调队列中堆积。为0（默认）时不限制。
+    /// 只对启用了 SetMultiplexing 的连接有效，必须在订阅任何流之前调用。
+    void SetStreamCredits(uint32_t credits) {
+      _stream_credits = credits;
+    }
+
+    /// 获取 @a token 对应的流的回调队列的统计数据，未使用回调线程池时全部为0。
+    detail::CallbackQueueStats GetCallbackStats(const Token &token) const {
+      auto it = _callback_queues.find(detail::token_type(token).get_stream_id());
+      return it != _callback_queues.end() ? it->second->GetStats() : detail::CallbackQueueStats{};
+    }
+
     void Run() {
+      _callback_service.AsyncRun(_callback_threads);
       _service.Run();
     }
     // 函数，启动线程池服务，以同步方式运行。
 
     void AsyncRun(size_t worker_threads) {
+      _callback_service.AsyncRun(_callback_threads);
       _service.AsyncRun(worker_threads);
     }
     // 函数，启动线程池服务，以异步方式运行，并指定工作线程数量。
 
 private:
 
+    template <typename Functor>
+    void SubscribeImpl(
+        const Token &token,
+        Functor &&callback,
+        bool lossless,
+        std::function<bool(Token &)> resolver,
+        uint32_t credits) {
+      if (_callback_threads == 0u) {
+        _client.Subscribe(_service.io_context(), token, std::forward<Functor>(callback), std::move(resolver), credits);
+        return;
+      }
+      // 网络线程只把消息放入该流的队列，回调在回调线程池上按顺序执行
+      auto queue = std::make_shared<detail::CallbackQueue>(
+          _callback_service.io_context(),
+          std::forward<Functor>(callback),
+          lossless ? 0u : _max_pending_callbacks);
+      _client.Subscribe(_service.io_context(), token, [queue](Buffer message) {
+        queue->Push(std::move(message));
+      }, std::move(resolver), credits);
+      _callback_queues[detail::token_type(token).get_stream_id()] = std::move(queue);
+    }
+
      // 注释：这两个参数的顺序非常重要。
 
     ThreadPool _service;// 定义一个线程池对象 _service。
 
+    ThreadPool _callback_service;// 执行流回调的线程池，_callback_threads 为0时不使用。
+
+    size_t _callback_threads = 0u;
+
+    size_t _max_pending_callbacks = 0u;
+
+    uint32_t _stream_credits = 0u;
+
+    std::unordered_map<detail::stream_id_type, std::shared_ptr<detail::CallbackQueue>> _callback_queues;
+
     underlying_client _client; // 定义一个底层客户端对象 _client。
 
 };
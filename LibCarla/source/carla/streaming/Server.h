@@ -67,10 +67,26 @@ namespace streaming {
     void AsyncRun(size_t worker_threads) {
       _pool.AsyncRun(worker_threads);
     }
+// 异步启动线程池，并把工作线程绑定到 cpus 中的处理器上，使其与游戏线程、渲染线程互不抢占。
+    void AsyncRun(size_t worker_threads, std::vector<size_t> cpus) {
+      _pool.AsyncRun(worker_threads, std::move(cpus));
+    }
 // 设置服务器为同步模式或异步模式。
     void SetSynchronousMode(bool is_synchro) {
       _server.SetSynchronousMode(is_synchro);
     }
+// 设置每个会话的发送队列。队列最多容纳 depth 条消息，满时在异步模式下按 policy 处理新消息，
+// 同步模式下总是等待；等待超过 timeout 后丢弃新消息，timeout 为0时一直等待。
+    void SetSendQueue(
+        size_t depth,
+        detail::tcp::SendQueuePolicy policy = detail::tcp::SendQueuePolicy::DropNewest,
+        time_duration timeout = time_duration()) {
+      _server.SetSendQueue(depth, policy, timeout);
+    }
+// 允许同一主机上的客户端经共享内存接收传感器数据，须在创建流之前调用。
+    void EnableSharedMemory(uint64_t capacity = detail::tcp::SharedMemoryRing::DEFAULT_CAPACITY) {
+      _server.EnableSharedMemory(capacity);
+    }
 // 获取指定流 ID 的令牌。
     token_type GetToken(stream_id sensor_id) {
       return _server.GetToken(sensor_id);
@@ -87,6 +103,15 @@ namespace streaming {
     bool IsEnabledForROS(stream_id sensor_id) {
       return _server.IsEnabledForROS(sensor_id);
     }
+// 设置指定流的数据在发送前使用的压缩方式，只对能够解压的客户端生效。
+    void SetStreamCodec(stream_id sensor_id, detail::StreamCodec codec) {
+      _server.SetStreamCodec(sensor_id, codec);
+    }
+
+// 设置指定流的数据发送到的组播组，只对能够接收组播的客户端生效；@a address 为空时停止组播。
+    void SetStreamMulticast(stream_id sensor_id, const std::string &address, uint16_t port) {
+      _server.SetStreamMulticast(sensor_id, address, port);
+    }
 
   private:
 
@@ -0,0 +1,98 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/streaming/detail/CallbackQueue.h"
+
+#include "carla/Logging.h"
+
+#include <boost/asio/post.hpp>
+
+#include <algorithm>
+#include <exception>
+
+namespace carla {
+namespace streaming {
+namespace detail {
+
+  void CallbackQueue::Push(Buffer message) {
+    // 被丢弃的消息在锁外交还给缓冲区池
+    Buffer dropped;
+    bool schedule = false;
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      if (_is_closed) {
+        return;
+      }
+      if ((_max_pending > 0u) && (_pending.size() >= _max_pending)) {
+        dropped = std::move(_pending.front());
+        _pending.pop_front();
+        if (++_stats.dropped == 1u) {
+          log_warning("streaming client: callback too slow, dropping messages");
+        }
+      }
+      _pending.emplace_back(std::move(message));
+      _stats.max_pending = std::max(_stats.max_pending, _pending.size());
+      if (!_is_scheduled) {
+        _is_scheduled = true;
+        schedule = true;
+      }
+    }
+    if (schedule) {
+      auto self = shared_from_this();
+      boost::asio::post(_io_context, [self]() { self->RunOne(); });
+    }
+  }
+
+  void CallbackQueue::Close() {
+    std::deque<Buffer> discarded;
+    std::lock_guard<std::mutex> lock(_mutex);
+    _is_closed = true;
+    discarded.swap(_pending);
+  }
+
+  CallbackQueueStats CallbackQueue::GetStats() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    CallbackQueueStats stats = _stats;
+    stats.pending = _pending.size();
+    return stats;
+  }
+
+  void CallbackQueue::RunOne() {
+    Buffer message;
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      if (_pending.empty()) {
+        _is_scheduled = false;
+        return;
+      }
+      message = std::move(_pending.front());
+      _pending.pop_front();
+    }
+    try {
+      _callback(std::move(message));
+    } catch (const std::exception &e) {
+      log_error("streaming client: exception in stream callback:", e.what());
+    }
+    bool schedule = false;
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      ++_stats.delivered;
+      if (_pending.empty() || _is_closed) {
+        _is_scheduled = false;
+      } else {
+        schedule = true;
+      }
+    }
+    if (schedule) {
+      // 重新排队而不是继续执行，让其他流的回调有机会运行
+      auto self = shared_from_this();
+      boost::asio::post(_io_context, [self]() { self->RunOne(); });
+    }
+  }
+
+} // namespace detail
+} // namespace streaming
+} // namespace carla
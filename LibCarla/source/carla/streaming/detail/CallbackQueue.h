@@ -0,0 +1,90 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/Buffer.h"
+#include "carla/NonCopyable.h"
+
+#include <boost/asio/io_context.hpp>
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+namespace carla {
+namespace streaming {
+namespace detail {
+
+  /// 一个流的回调队列的统计数据。
+  struct CallbackQueueStats {
+    /// 正在等待回调的消息数。
+    size_t pending = 0u;
+    /// 曾经同时等待回调的最大消息数。
+    size_t max_pending = 0u;
+    /// 已交给回调函数的消息数。
+    uint64_t delivered = 0u;
+    /// 队列已满时丢弃的消息数。
+    uint64_t dropped = 0u;
+  };
+
+  /// @brief 在共享的线程池上按顺序执行一个流的回调函数。
+  ///
+  /// 网络线程只把收到的消息放入队列，回调函数在回调线程池上执行，同一个流的回调
+  /// 不会并发执行也不会乱序。每次只执行一条消息的回调后重新排队，多个流轮流使用线程池，
+  /// 一个流的回调很慢时不会增加其他流的延迟。
+  class CallbackQueue
+    : public std::enable_shared_from_this<CallbackQueue>,
+      private NonCopyable {
+  public:
+
+    using callback_function_type = std::function<void (Buffer)>;
+
+    /// @a max_pending 为0时队列不限长度，否则队列已满时丢弃最旧的消息。
+    CallbackQueue(
+        boost::asio::io_context &io_context,
+        callback_function_type callback,
+        size_t max_pending = 0u)
+      : _io_context(io_context),
+        _callback(std::move(callback)),
+        _max_pending(max_pending) {}
+
+    /// 把收到的消息放入队列，可以在任意线程调用。
+    void Push(Buffer message);
+
+    /// 丢弃尚未回调的消息，之后收到的消息也不再回调。
+    void Close();
+
+    CallbackQueueStats GetStats() const;
+
+  private:
+
+    /// 执行队首消息的回调，队列不为空时再次排队。
+    void RunOne();
+
+    boost::asio::io_context &_io_context;
+
+    callback_function_type _callback;
+
+    const size_t _max_pending;
+
+    mutable std::mutex _mutex;
+
+    std::deque<Buffer> _pending;
+
+    /// 是否已在线程池中排队或正在执行回调。
+    bool _is_scheduled = false;
+
+    bool _is_closed = false;
+
+    CallbackQueueStats _stats;
+  };
+
+} // namespace detail
+} // namespace streaming
+} // namespace carla
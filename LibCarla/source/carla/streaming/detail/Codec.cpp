@@ -0,0 +1,255 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/streaming/detail/Codec.h"
+
+#include <algorithm>
+#include <array>
+
+namespace carla {
+namespace streaming {
+namespace detail {
+namespace codec {
+
+  // 压缩数据的格式：1字节压缩方式、4字节原数据大小，之后是压缩流。
+  //
+  // LZ压缩流由若干序列组成，每个序列依次为：1字节标记（高4位为字面量长度，
+  // 低4位为匹配长度减4，值为15时后接若干字节的扩展长度，每字节255表示继续）、
+  // 字面量、2字节的匹配偏移和匹配长度的扩展。最后一个序列只有字面量。
+
+  using byte_type = Buffer::value_type;
+
+  static constexpr size_t HEADER_SIZE = 1u + sizeof(uint32_t);
+
+  static constexpr size_t MIN_MATCH = 4u;
+
+  static constexpr size_t MAX_OFFSET = 0xFFFFu;
+
+  static constexpr size_t HASH_BITS = 14u;
+
+  /// 每个输入字节最多展开为255个输出字节（扩展长度的一个字节），
+  /// 声明的原数据大小超过这个比例的数据一定是损坏的。
+  static constexpr size_t MAX_EXPANSION = 255u;
+
+  static uint32_t ReadUInt32(const byte_type *source) {
+    uint32_t value;
+    std::memcpy(&value, source, sizeof(value));
+    return value;
+  }
+
+  static size_t Hash(const uint32_t value) {
+    return (value * 2654435761u) >> (32u - HASH_BITS);
+  }
+
+  /// 向输出写入数据，超出容量后不再写入并记录失败。
+  class Writer {
+  public:
+
+    Writer(byte_type *begin, size_t capacity) : _position(begin), _end(begin + capacity) {}
+
+    bool Put(const byte_type value) {
+      if (_position == _end) {
+        _failed = true;
+        return false;
+      }
+      *_position++ = value;
+      return true;
+    }
+
+    bool Put(const byte_type *source, const size_t size) {
+      if (static_cast<size_t>(_end - _position) < size) {
+        _failed = true;
+        return false;
+      }
+      std::memcpy(_position, source, size);
+      _position += size;
+      return true;
+    }
+
+    bool PutLength(size_t length) {
+      for (; length >= 255u; length -= 255u) {
+        if (!Put(255u)) {
+          return false;
+        }
+      }
+      return Put(static_cast<byte_type>(length));
+    }
+
+    bool failed() const {
+      return _failed;
+    }
+
+    byte_type *position() const {
+      return _position;
+    }
+
+  private:
+
+    byte_type *_position;
+
+    byte_type *const _end;
+
+    bool _failed = false;
+  };
+
+  static bool WriteSequence(
+      Writer &writer,
+      const byte_type *literals,
+      const size_t literal_length,
+      const size_t offset,
+      const size_t match_length) {
+    const size_t literal_token = std::min<size_t>(literal_length, 15u);
+    const size_t match_token = match_length > 0u ? std::min<size_t>(match_length - MIN_MATCH, 15u) : 0u;
+    if (!writer.Put(static_cast<byte_type>((literal_token << 4u) | match_token))) {
+      return false;
+    }
+    if ((literal_token == 15u) && !writer.PutLength(literal_length - 15u)) {
+      return false;
+    }
+    if (!writer.Put(literals, literal_length)) {
+      return false;
+    }
+    if (match_length == 0u) {
+      return true;
+    }
+    if (!writer.Put(static_cast<byte_type>(offset & 0xFFu)) ||
+        !writer.Put(static_cast<byte_type>(offset >> 8u))) {
+      return false;
+    }
+    return (match_token < 15u) || writer.PutLength(match_length - MIN_MATCH - 15u);
+  }
+
+  static bool CompressLZ(const byte_type *source, const size_t size, Writer &writer) {
+    // 哈希表记录最近一次出现每个4字节序列的位置，只做贪心匹配
+    std::array<uint32_t, 1u << HASH_BITS> table;
+    table.fill(0u);
+    size_t anchor = 0u;
+    size_t position = 0u;
+    while (position + MIN_MATCH <= size) {
+      const uint32_t sequence = ReadUInt32(source + position);
+      uint32_t &entry = table[Hash(sequence)];
+      const size_t candidate = entry;
+      entry = static_cast<uint32_t>(position);
+      if ((candidate < position) &&
+          (position - candidate <= MAX_OFFSET) &&
+          (ReadUInt32(source + candidate) == sequence)) {
+        size_t match_length = MIN_MATCH;
+        while ((position + match_length < size) &&
+               (source[candidate + match_length] == source[position + match_length])) {
+          ++match_length;
+        }
+        if (!WriteSequence(writer, source + anchor, position - anchor, position - candidate, match_length)) {
+          return false;
+        }
+        position += match_length;
+        anchor = position;
+      } else {
+        ++position;
+      }
+    }
+    return WriteSequence(writer, source + anchor, size - anchor, 0u, 0u);
+  }
+
+  bool Compress(const StreamCodec codec, const Buffer &input, Buffer &output) {
+    if ((codec != StreamCodec::LZ) || (input.size() <= HEADER_SIZE)) {
+      return false;
+    }
+    // 压缩结果不比原数据小时没有意义，输出的容量即为原数据的大小
+    output.reset(input.size());
+    Writer writer(output.data(), output.size());
+    const uint32_t raw_size = input.size();
+    writer.Put(static_cast<byte_type>(codec));
+    writer.Put(reinterpret_cast<const byte_type *>(&raw_size), sizeof(raw_size));
+    if (!CompressLZ(input.data(), input.size(), writer) || writer.failed()) {
+      return false;
+    }
+    output.reset(static_cast<Buffer::size_type>(writer.position() - output.data()));
+    return true;
+  }
+
+  static bool ReadLength(const byte_type *&source, const byte_type *end, size_t &length) {
+    byte_type value;
+    do {
+      if (source == end) {
+        return false;
+      }
+      value = *source++;
+      length += value;
+    } while (value == 255u);
+    return true;
+  }
+
+  static bool DecompressLZ(
+      const byte_type *source,
+      const byte_type *const end,
+      byte_type *const destination,
+      const size_t size) {
+    size_t position = 0u;
+    while (source != end) {
+      const byte_type token = *source++;
+      size_t literal_length = token >> 4u;
+      if ((literal_length == 15u) && !ReadLength(source, end, literal_length)) {
+        return false;
+      }
+      if ((static_cast<size_t>(end - source) < literal_length) || (size - position < literal_length)) {
+        return false;
+      }
+      std::memcpy(destination + position, source, literal_length);
+      source += literal_length;
+      position += literal_length;
+      if (source == end) {
+        break;
+      }
+
+      if (end - source < 2) {
+        return false;
+      }
+      const size_t offset = source[0u] | (static_cast<size_t>(source[1u]) << 8u);
+      source += 2u;
+      size_t match_length = token & 0x0Fu;
+      if ((match_length == 15u) && !ReadLength(source, end, match_length)) {
+        return false;
+      }
+      match_length += MIN_MATCH;
+      if ((offset == 0u) || (offset > position) || (size - position < match_length)) {
+        return false;
+      }
+      // 匹配可能与自身重叠，例如重复的像素，此时只能逐字节复制
+      const byte_type *match = destination + position - offset;
+      if (offset >= match_length) {
+        std::memcpy(destination + position, match, match_length);
+      } else {
+        for (size_t i = 0u; i < match_length; ++i) {
+          destination[position + i] = match[i];
+        }
+      }
+      position += match_length;
+    }
+    return position == size;
+  }
+
+  bool Decompress(const Buffer &input, Buffer &output) {
+    if (input.size() <= HEADER_SIZE) {
+      return false;
+    }
+    const auto codec = static_cast<StreamCodec>(input.data()[0u]);
+    if (codec != StreamCodec::LZ) {
+      return false;
+    }
+    uint32_t raw_size;
+    std::memcpy(&raw_size, input.data() + 1u, sizeof(raw_size));
+    // 大小来自网络，在分配内存前先检查是否可能由这么多压缩数据得到
+    if (raw_size > (input.size() - HEADER_SIZE) * MAX_EXPANSION) {
+      return false;
+    }
+    output.reset(raw_size);
+    return DecompressLZ(input.data() + HEADER_SIZE, input.data() + input.size(), output.data(), raw_size);
+  }
+
+} // namespace codec
+} // namespace detail
+} // namespace streaming
+} // namespace carla
@@ -0,0 +1,66 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/Buffer.h"
+#include "carla/streaming/detail/Types.h"
+
+#include <boost/asio/buffer.hpp>
+
+#include <cstdint>
+#include <cstring>
+
+namespace carla {
+namespace streaming {
+namespace detail {
+
+  /// 流的数据在发送前使用的压缩方式。
+  enum class StreamCodec : uint8_t {
+    None, ///< 不压缩
+    LZ    ///< 通用的LZ77字节压缩，适合深度图、语义分割图等大片重复的数据
+  };
+
+namespace codec {
+
+  /// 客户端在发送的流ID中置上该位，表示能够解压服务器发送的数据。
+  constexpr stream_id_type SUPPORT_FLAG = 1u << 30;
+
+  /// 服务器在消息大小中置上该位，表示消息的内容是压缩后的数据。
+  constexpr message_size_type COMPRESSED_FLAG = 1u << 31;
+
+  /// 用 @a codec 压缩 @a input，结果写入 @a output。
+  ///
+  /// 压缩后不比原数据小时返回false，此时应发送原数据。
+  bool Compress(StreamCodec codec, const Buffer &input, Buffer &output);
+
+  /// 把 @a buffers 依次复制到 @a input 后压缩，结果写入 @a output。
+  template <typename BufferSequence>
+  bool Compress(
+      StreamCodec codec,
+      const BufferSequence &buffers,
+      Buffer &input,
+      Buffer &output) {
+    size_t size = 0u;
+    for (const boost::asio::const_buffer &buffer : buffers) {
+      size += buffer.size();
+    }
+    input.reset(static_cast<Buffer::size_type>(size));
+    auto *destination = input.data();
+    for (const boost::asio::const_buffer &buffer : buffers) {
+      std::memcpy(destination, buffer.data(), buffer.size());
+      destination += buffer.size();
+    }
+    return Compress(codec, input, output);
+  }
+
+  /// 解压 @a input，结果写入 @a output。数据损坏时返回false。
+  bool Decompress(const Buffer &input, Buffer &output);
+
+} // namespace codec
+} // namespace detail
+} // namespace streaming
+} // namespace carla
@@ -8,6 +8,7 @@
 // 包含必要的头文件
 #include "carla/streaming/EndPoint.h"
 #include "carla/streaming/Stream.h"
+#include "carla/streaming/detail/Multicast.h"
 #include "carla/streaming/detail/Session.h"
 #include "carla/streaming/detail/Stream.h"
 #include "carla/streaming/detail/Token.h"
@@ -45,6 +46,11 @@ namespace detail {
     void DeregisterSession(std::shared_ptr<Session> session);
 // 获取指定传感器 ID 的令牌
     token_type GetToken(stream_id_type sensor_id);
+// 之后创建的流的令牌允许同一主机上的客户端请求共享内存传输
+    void EnableSharedMemory() {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _cached_token.enable_shared_memory();
+    }
 // 启用针对 ROS 的功能，通过传感器 ID 找到对应的流并调用其 EnableForROS 方法
     void EnableForROS(stream_id_type sensor_id) {
       auto search = _stream_map.find(sensor_id);
@@ -59,6 +65,20 @@ namespace detail {
         search->second->DisableForROS();
       }
     }
+// 设置指定流的数据在发送前使用的压缩方式，通过传感器 ID 找到对应的流并调用其 SetCodec 方法
+    void SetStreamCodec(stream_id_type sensor_id, StreamCodec codec) {
+      auto search = _stream_map.find(sensor_id);
+      if (search != _stream_map.end()) {
+        search->second->SetCodec(codec);
+      }
+    }
+// 设置指定流的数据发送到的组播组，通过传感器 ID 找到对应的流并调用其 SetMulticast 方法
+    void SetStreamMulticast(stream_id_type sensor_id, std::shared_ptr<multicast::Sender> multicast) {
+      auto search = _stream_map.find(sensor_id);
+      if (search != _stream_map.end()) {
+        search->second->SetMulticast(std::move(multicast));
+      }
+    }
 // 检查指定传感器 ID 的流是否针对 ROS 启用，通过传感器 ID 找到对应的流并调用其 IsEnabledForROS 方法
     bool IsEnabledForROS(stream_id_type sensor_id) {
       auto search = _stream_map.find(sensor_id);
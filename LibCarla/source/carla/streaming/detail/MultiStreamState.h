@@ -12,8 +12,10 @@
 // 用于日志记录
 #include "carla/streaming/detail/StreamStateBase.h"
 // 基类，可能提供了一些基本的流状态管理功能
+#include "carla/streaming/detail/Multicast.h"
 #include "carla/streaming/detail/tcp/Message.h"
 
+#include <array>
 #include <mutex>
 #include <vector>
 #include <atomic>
@@ -40,8 +42,28 @@ namespace detail {
       // try write single stream
       auto session = _session.load();
       if (session != nullptr) {
-		  // 创建消息并写入单个会话
-        auto message = Session::MakeMessage(buffers...);
+        if (!session->HasCredit()) {
+          // 客户端用完了信用，不再压缩和发送
+          return;
+        }
+        auto multicast = _multicast.load();
+        if ((multicast != nullptr) && session->ReceivesMulticast()) {
+          // 支持组播的客户端都能够解压
+          auto message = MakeCompressedMessage(buffers...);
+          if (message == nullptr) {
+            message = Session::MakeMessage(buffers...);
+          }
+          multicast->Send(std::move(message));
+          return;
+        }
+		  // 创建消息并写入单个会话，客户端能够解压时优先发送压缩后的数据
+        std::shared_ptr<const tcp::Message> message;
+        if (session->AcceptsCompression()) {
+          message = MakeCompressedMessage(buffers...);
+        }
+        if (message == nullptr) {
+          message = Session::MakeMessage(buffers...);
+        }
         session->Write(std::move(message));
         log_debug("sensor ", session->get_stream_id()," data sent");
         // Return here, _session is only valid if we have a
@@ -52,16 +74,50 @@ namespace detail {
       // try write multiple stream
       std::lock_guard<std::mutex> lock(_mutex);
       if (_sessions.size() > 0) {
-		  // 创建消息并写入多个会话
+		  // 创建消息并写入多个会话，压缩后的数据只生成一次
+        auto multicast = _multicast.load();
         auto message = Session::MakeMessage(buffers...);
+        std::shared_ptr<const tcp::Message> compressed;
+        bool compression_tried = false;
+        bool multicast_sent = false;
         for (auto &s : _sessions) {
-          if (s != nullptr) {
-            s->Write(message);
+          if ((s != nullptr) && s->HasCredit()) {
+            const bool uses_multicast = (multicast != nullptr) && s->ReceivesMulticast();
+            if ((uses_multicast || s->AcceptsCompression()) && !compression_tried) {
+              compression_tried = true;
+              compressed = MakeCompressedMessage(buffers...);
+            }
+            if (uses_multicast) {
+              // 所有组播的订阅者共享一次发送
+              if (!multicast_sent) {
+                multicast_sent = true;
+                multicast->Send(compressed != nullptr ? compressed : message);
+              }
+              continue;
+            }
+            s->Write((compressed != nullptr && s->AcceptsCompression()) ? compressed : message);
             log_debug("sensor ", s->get_stream_id()," data sent ");
          }
         }
       }
     }
+ // 设置流的数据在发送给能够解压的客户端之前使用的压缩方式
+    void SetCodec(StreamCodec codec) {
+      _codec = codec;
+    }
+ // 设置流的数据发送到的组播组，为空时恢复为通过各个会话发送。
+ // 已连接的、能够接收组播的客户端立即被通知组播组的地址
+    void SetMulticast(std::shared_ptr<multicast::Sender> multicast) {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _multicast.store(multicast);
+      if (multicast != nullptr) {
+        for (auto &s : _sessions) {
+          if ((s != nullptr) && s->AcceptsMulticast() && !s->ReceivesMulticast()) {
+            s->StartMulticast(multicast->GetAnnouncement());
+          }
+        }
+      }
+    }
  // 设置强制激活标志
     void ForceActive() {
       _force_active = true;
@@ -82,10 +138,31 @@ namespace detail {
     bool AreClientsListening() {
       return (_sessions.size() > 0 || _force_active || _enabled_for_ros);
     }
+ // 检查是否有客户端能够接收下一条消息，所有客户端都用完了信用时传感器可以跳过这一帧
+    bool HasCredit() {
+      if (_enabled_for_ros) {
+        return true;
+      }
+      std::lock_guard<std::mutex> lock(_mutex);
+      if (_sessions.empty()) {
+        return _force_active;
+      }
+      for (auto &s : _sessions) {
+        if ((s != nullptr) && s->HasCredit()) {
+          return true;
+        }
+      }
+      return false;
+    }
 // 连接一个新的会话
     void ConnectSession(std::shared_ptr<Session> session) final {
       DEBUG_ASSERT(session != nullptr);
       std::lock_guard<std::mutex> lock(_mutex);
+      // 在会话开始接收数据之前通知客户端组播组的地址
+      auto multicast = _multicast.load();
+      if ((multicast != nullptr) && session->AcceptsMulticast()) {
+        session->StartMulticast(multicast->GetAnnouncement());
+      }
 	  // 将新会话添加到会话列表中
       _sessions.emplace_back(std::move(session));
       log_debug("Connecting multistream sessions:", _sessions.size());
@@ -154,6 +231,24 @@ namespace detail {
 
   private:
 
+    // 压缩数据并构造压缩消息，未设置压缩方式或压缩后不比原数据小时返回空指针
+    template <typename... Buffers>
+    std::shared_ptr<const tcp::Message> MakeCompressedMessage(Buffers... buffers) {
+      const StreamCodec codec = _codec;
+      if (codec == StreamCodec::None) {
+        return nullptr;
+      }
+      const std::array<boost::asio::const_buffer, sizeof...(Buffers)> sequence{{buffers->cbuffer()...}};
+      Buffer input = MakeBuffer();
+      Buffer output = MakeBuffer();
+      if (!codec::Compress(codec, sequence, input, output)) {
+        return nullptr;
+      }
+      return std::make_shared<const tcp::Message>(
+          tcp::Message::Compressed{},
+          BufferView::CreateFrom(std::move(output)));
+    }
+
     std::mutex _mutex;
     // 私有成员变量
     // _mutex 是一个互斥锁，用于保护对 _sessions 容器的并发访问
@@ -167,6 +262,9 @@ namespace detail {
     bool _force_active {false};   // _force_active 是一个布尔变量，用于指示是否存在一个或多个会话被强制标记为活动状态
     // 如果为 true，则可能表示有会话需要被特别处理，即使按照正常逻辑它们可能不应该处于活动状态
     // 初始化为 false，表示默认没有会话被强制标记为活动状态
+    std::atomic<StreamCodec> _codec {StreamCodec::None};
+    // 设置后能够接收组播的客户端的数据只发送一次到组播组
+    AtomicSharedPtr<multicast::Sender> _multicast;
     bool _enabled_for_ros {false};    // _enabled_for_ros 是一个布尔变量，用于指示该类或其中的会话是否启用了对 ROS（Robot Operating System）的支持
     // 如果为 true，则可能表示该类或其中的会话能够与 ROS 系统进行交互，例如发送或接收消息
     // 类的其他成员变量、方法和构造函数应该在这里定义
@@ -0,0 +1,251 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/streaming/detail/Multicast.h"
+
+#include "carla/Exception.h"
+#include "carla/Logging.h"
+#include "carla/streaming/detail/Codec.h"
+
+#include <boost/asio/bind_executor.hpp>
+#include <boost/asio/ip/multicast.hpp>
+#include <boost/asio/post.hpp>
+
+#include <algorithm>
+#include <exception>
+#include <stdexcept>
+
+namespace carla {
+namespace streaming {
+namespace detail {
+namespace multicast {
+
+  /// 套接字缓冲区的大小，一帧图像的所有分片可能同时在途。
+  static constexpr int SOCKET_BUFFER_SIZE = 8 * 1024 * 1024;
+
+  std::string FormatGroup(const boost::asio::ip::udp::endpoint &group) {
+    return group.address().to_string() + ' ' + std::to_string(group.port());
+  }
+
+  bool ParseGroup(const Buffer &text, boost::asio::ip::udp::endpoint &group) {
+    const std::string str(reinterpret_cast<const char *>(text.data()), text.size());
+    const auto separator = str.find_last_of(' ');
+    if ((separator == std::string::npos) || (separator + 1u >= str.size())) {
+      return false;
+    }
+    boost::system::error_code ec;
+    const auto address = boost::asio::ip::make_address(str.substr(0u, separator), ec);
+    if (ec || !address.is_multicast()) {
+      return false;
+    }
+    try {
+      const auto port = std::stoul(str.substr(separator + 1u));
+      if (port == 0u || port > 0xFFFFu) {
+        return false;
+      }
+      group = {address, static_cast<unsigned short>(port)};
+      return true;
+    } catch (const std::exception &) {
+      return false;
+    }
+  }
+
+  // ===========================================================================
+  // -- Sender -----------------------------------------------------------------
+  // ===========================================================================
+
+  static SharedBufferView MakeAnnouncement(const boost::asio::ip::udp::endpoint &group) {
+    const std::string text = FormatGroup(group);
+    return BufferView::CreateFrom(Buffer(reinterpret_cast<const unsigned char *>(text.data()), text.size()));
+  }
+
+  static size_t GetFragmentSize(const size_t datagram_size) {
+    if (datagram_size <= sizeof(DatagramHeader)) {
+      throw_exception(std::invalid_argument("multicast datagram size too small"));
+    }
+    return datagram_size - sizeof(DatagramHeader);
+  }
+
+  static boost::asio::ip::udp::endpoint CheckGroup(boost::asio::ip::udp::endpoint group) {
+    if (!group.address().is_multicast()) {
+      throw_exception(std::invalid_argument(group.address().to_string() + " is not a multicast address"));
+    }
+    return group;
+  }
+
+  Sender::Sender(
+      boost::asio::io_context &io_context,
+      const stream_id_type stream_id,
+      endpoint group,
+      const size_t datagram_size)
+    : _stream_id(stream_id),
+      _group(CheckGroup(std::move(group))),
+      _fragment_size(GetFragmentSize(datagram_size)),
+      _announcement(MakeAnnouncement(_group)),
+      _strand(io_context),
+      _socket(io_context, _group.protocol()) {
+    boost::system::error_code ec;
+    // 缓冲区大小只是建议值，设置失败时使用系统的默认值
+    _socket.set_option(boost::asio::socket_base::send_buffer_size(SOCKET_BUFFER_SIZE), ec);
+    // 订阅者可能与服务器在同一台主机上
+    _socket.set_option(boost::asio::ip::multicast::enable_loopback(true), ec);
+  }
+
+  void Sender::Post(std::shared_ptr<Outgoing> outgoing) {
+    for (const auto &buffer : outgoing->payload) {
+      outgoing->size += buffer.size();
+    }
+    if (outgoing->size == 0u) {
+      return;
+    }
+    auto self = shared_from_this();
+    boost::asio::post(_strand, [this, self, outgoing]() mutable {
+      if (_sending != nullptr) {
+        // 网络跟不上时只保留最新的一条消息
+        _pending = std::move(outgoing);
+        return;
+      }
+      Start(std::move(outgoing));
+    });
+  }
+
+  void Sender::Start(std::shared_ptr<Outgoing> outgoing) {
+    _sending = std::move(outgoing);
+    auto &header = _sending->header;
+    header.stream_id = _stream_id;
+    header.sequence = ++_sequence;
+    header.fragment_count = static_cast<uint32_t>((_sending->size + _fragment_size - 1u) / _fragment_size);
+    SendFragment(0u);
+  }
+
+  void Sender::SendFragment(const uint32_t index) {
+    // 每个数据报由分片信息和消息的一段组成，一段可能跨越多个缓冲区
+    Outgoing &outgoing = *_sending;
+    auto &header = outgoing.header;
+    header.fragment_index = index;
+    header.offset = static_cast<uint32_t>(index * _fragment_size);
+    auto &datagram = outgoing.datagram;
+    datagram.clear();
+    datagram.emplace_back(&header, sizeof(header));
+    size_t remaining = std::min(_fragment_size, outgoing.size - header.offset);
+    while (remaining > 0u) {
+      const auto &buffer = outgoing.payload[outgoing.buffer_index];
+      const size_t length = std::min(remaining, buffer.size() - outgoing.buffer_offset);
+      datagram.emplace_back(static_cast<const unsigned char *>(buffer.data()) + outgoing.buffer_offset, length);
+      remaining -= length;
+      outgoing.buffer_offset += length;
+      if (outgoing.buffer_offset == buffer.size()) {
+        ++outgoing.buffer_index;
+        outgoing.buffer_offset = 0u;
+      }
+    }
+    auto self = shared_from_this();
+    _socket.async_send_to(datagram, _group, boost::asio::bind_executor(_strand,
+        [this, self, index](boost::system::error_code ec, size_t) {
+      if (ec) {
+        // 之后的分片已无法组成完整的消息
+        log_debug("multicast stream", _stream_id, ": error sending datagram :", ec.message());
+        Finish();
+      } else if (index + 1u < _sending->header.fragment_count) {
+        SendFragment(index + 1u);
+      } else {
+        Finish();
+      }
+    }));
+  }
+
+  void Sender::Finish() {
+    _sending.reset();
+    if (_pending != nullptr) {
+      Start(std::move(_pending));
+    }
+  }
+
+  // ===========================================================================
+  // -- Reassembler ------------------------------------------------------------
+  // ===========================================================================
+
+  bool Reassembler::Push(const unsigned char *datagram, const size_t size) {
+    DatagramHeader header;
+    if (size <= sizeof(header)) {
+      return false;
+    }
+    std::memcpy(&header, datagram, sizeof(header));
+    if (header.stream_id != _stream_id) {
+      // 组播组中的其他流
+      return false;
+    }
+    const size_t length = size - sizeof(header);
+    const size_t message_size = header.message_header & ~codec::COMPRESSED_FLAG;
+    if ((message_size == 0u) || (message_size > MAX_MESSAGE_SIZE) ||
+        (header.fragment_index >= header.fragment_count)) {
+      log_debug("multicast stream", _stream_id, ": invalid datagram");
+      return false;
+    }
+    // 除最后一个分片外每个分片的长度相同，由此检查分片的数量、位置和长度与消息大小一致
+    const bool is_last = (header.fragment_index + 1u == header.fragment_count);
+    const size_t fragment_size = !is_last ? length :
+        (header.fragment_index == 0u ? length : header.offset / header.fragment_index);
+    if ((fragment_size == 0u) ||
+        (static_cast<size_t>(header.offset) != header.fragment_index * fragment_size) ||
+        ((message_size + fragment_size - 1u) / fragment_size != header.fragment_count) ||
+        (header.offset >= message_size) ||
+        (length != std::min(fragment_size, message_size - header.offset))) {
+      log_debug("multicast stream", _stream_id, ": invalid datagram");
+      return false;
+    }
+
+    if (!_has_sequence || (header.sequence != _sequence)) {
+      // 序号按无符号差判断先后，允许回绕
+      if (_has_sequence && (static_cast<int32_t>(header.sequence - _sequence) < 0)) {
+        // 已丢弃或已收齐的消息迟到的分片
+        return false;
+      }
+      if (_is_assembling) {
+        log_debug("multicast stream", _stream_id, ": incomplete message", _sequence, "discarded");
+        // 交还给缓冲区池
+        Buffer incomplete = std::move(_message);
+      }
+      _has_sequence = true;
+      _is_assembling = true;
+      _sequence = header.sequence;
+      _message_header = header.message_header;
+      _fragment_size = fragment_size;
+      _received.assign(header.fragment_count, false);
+      _missing_fragments = header.fragment_count;
+      _message = _buffer_pool->Pop(message_size);
+      _message.reset(message_size);
+    } else if (!_is_assembling) {
+      // 已收齐的消息重复的分片
+      return false;
+    }
+
+    if ((header.message_header != _message_header) ||
+        (header.fragment_count != _received.size()) ||
+        (fragment_size != _fragment_size)) {
+      log_debug("multicast stream", _stream_id, ": inconsistent datagram");
+      return false;
+    }
+    if (_received[header.fragment_index]) {
+      return false;
+    }
+    _received[header.fragment_index] = true;
+    std::memcpy(_message.data() + header.offset, datagram + sizeof(header), length);
+    if (--_missing_fragments > 0u) {
+      return false;
+    }
+    _is_assembling = false;
+    return true;
+  }
+
+  bool Reassembler::is_compressed() const {
+    return (_message_header & codec::COMPRESSED_FLAG) != 0u;
+  }
+
+} // namespace multicast
+} // namespace detail
+} // namespace streaming
+} // namespace carla
@@ -0,0 +1,208 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/Buffer.h"
+#include "carla/BufferPool.h"
+#include "carla/BufferView.h"
+#include "carla/Debug.h"
+#include "carla/NonCopyable.h"
+#include "carla/streaming/detail/Types.h"
+
+#include <boost/asio/buffer.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/udp.hpp>
+#include <boost/asio/strand.hpp>
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace carla {
+namespace streaming {
+namespace detail {
+namespace multicast {
+
+  /// 客户端在发送的流ID中置上该位，表示能够从组播组接收数据。
+  constexpr stream_id_type SUPPORT_FLAG = 1u << 29;
+
+  /// 服务器在消息大小中置上该位，表示消息的内容是组播组的地址，
+  /// 之后该流的数据只发送到组播组。
+  constexpr message_size_type ANNOUNCEMENT_FLAG = 1u << 30;
+
+  /// 默认的数据报大小，以太网MTU减去IP和UDP报头，避免IP分片。
+  constexpr size_t DEFAULT_DATAGRAM_SIZE = 1472u;
+
+  /// 接收端接受的最大消息大小，远大于任何传感器的单帧数据。
+  /// 消息大小来自网络，超过该值的数据报被丢弃，避免按伪造的大小分配内存。
+  constexpr size_t MAX_MESSAGE_SIZE = 256u * 1024u * 1024u;
+
+#pragma pack(push, 1)
+
+  /// 每个数据报开头的分片信息。
+  struct DatagramHeader {
+    stream_id_type stream_id;
+    /// 消息的序号，每条消息加一。
+    uint32_t sequence;
+    /// 消息的大小及标志位，与TCP消息的消息头相同。
+    message_size_type message_header;
+    uint32_t offset;
+    uint32_t fragment_index;
+    uint32_t fragment_count;
+  };
+
+#pragma pack(pop)
+
+  /// 组播组的地址，以"<地址> <端口>"的文本形式发送给客户端。
+  std::string FormatGroup(const boost::asio::ip::udp::endpoint &group);
+
+  /// 解析FormatGroup的结果，格式错误时返回false。
+  bool ParseGroup(const Buffer &text, boost::asio::ip::udp::endpoint &group);
+
+  /// @brief 把一个流的消息分片后发送到组播组。
+  ///
+  /// 同一个局域网上订阅该流的所有客户端共享一次发送，服务器的出口流量不随订阅者的数量增长。
+  /// 组播不重传，丢失任何一个分片都会丢弃整条消息。
+  ///
+  /// 数据报在 @a io_context 中异步发送，写入传感器数据的线程不会被网络阻塞。
+  /// 同一时间只发送一条消息，发送期间到达的消息只保留最新的一条，网络跟不上时丢弃旧的消息。
+  /// 必须通过 std::make_shared 创建。
+  class Sender
+    : public std::enable_shared_from_this<Sender>,
+      private NonCopyable {
+  public:
+
+    using endpoint = boost::asio::ip::udp::endpoint;
+
+    Sender(
+        boost::asio::io_context &io_context,
+        stream_id_type stream_id,
+        endpoint group,
+        size_t datagram_size = DEFAULT_DATAGRAM_SIZE);
+
+    const endpoint &GetGroup() const {
+      return _group;
+    }
+
+    /// 通知客户端的消息内容，指向组播组的地址。
+    SharedBufferView GetAnnouncement() const {
+      return _announcement;
+    }
+
+    /// 发送一条TCP消息，消息的缓冲区序列中第一个缓冲区是消息头。
+    /// 发送完成之前一直持有 @a message。
+    template <typename MessagePtr>
+    void Send(MessagePtr message) {
+      const auto buffers = message->GetBufferSequence();
+      auto it = buffers.begin();
+      DEBUG_ASSERT(it != buffers.end());
+      DEBUG_ASSERT(it->size() == sizeof(message_size_type));
+      auto outgoing = std::make_shared<Outgoing>();
+      std::memcpy(&outgoing->header.message_header, it->data(), sizeof(message_size_type));
+      outgoing->payload.assign(++it, buffers.end());
+      outgoing->message = std::move(message);
+      Post(std::move(outgoing));
+    }
+
+  private:
+
+    /// 一条待发送的消息及其分片的进度。
+    struct Outgoing {
+      std::shared_ptr<const void> message;
+      std::vector<boost::asio::const_buffer> payload;
+      DatagramHeader header;
+      size_t size = 0u;
+      /// 下一个分片开始处所在的缓冲区及其中的偏移。
+      size_t buffer_index = 0u;
+      size_t buffer_offset = 0u;
+      /// 正在发送的数据报。
+      std::vector<boost::asio::const_buffer> datagram;
+    };
+
+    void Post(std::shared_ptr<Outgoing> outgoing);
+
+    /// 以下方法只在 _strand 中调用。
+    void Start(std::shared_ptr<Outgoing> outgoing);
+
+    void SendFragment(uint32_t index);
+
+    void Finish();
+
+    const stream_id_type _stream_id;
+
+    const endpoint _group;
+
+    const size_t _fragment_size;
+
+    const SharedBufferView _announcement;
+
+    boost::asio::io_context::strand _strand;
+
+    boost::asio::ip::udp::socket _socket;
+
+    /// 正在发送的消息，为空时没有正在进行的发送。
+    std::shared_ptr<Outgoing> _sending;
+
+    /// 发送期间到达的最新一条消息。
+    std::shared_ptr<Outgoing> _pending;
+
+    uint32_t _sequence = 0u;
+  };
+
+  /// @brief 把收到的数据报重新组装成消息。
+  ///
+  /// 同一时间只组装序号最新的一条消息，收到更新的消息的分片时丢弃尚未收齐的消息。
+  class Reassembler : private NonCopyable {
+  public:
+
+    Reassembler(stream_id_type stream_id, std::shared_ptr<BufferPool> buffer_pool)
+      : _stream_id(stream_id),
+        _buffer_pool(std::move(buffer_pool)) {}
+
+    /// 处理收到的一个数据报，收齐一条消息的所有分片时返回true，之后可以用 pop() 取出。
+    bool Push(const unsigned char *datagram, size_t size);
+
+    /// 取出收齐的消息（不包括消息头）。
+    Buffer pop() {
+      return std::move(_message);
+    }
+
+    /// 取出的消息的内容是否是压缩后的数据。
+    bool is_compressed() const;
+
+  private:
+
+    const stream_id_type _stream_id;
+
+    std::shared_ptr<BufferPool> _buffer_pool;
+
+    /// 是否已收到过数据报，此后 _sequence 为最新消息的序号。
+    bool _has_sequence = false;
+
+    /// 最新的消息是否尚未收齐。
+    bool _is_assembling = false;
+
+    uint32_t _sequence = 0u;
+
+    message_size_type _message_header = 0u;
+
+    /// 最新消息除最后一个分片外每个分片的长度。
+    size_t _fragment_size = 0u;
+
+    std::vector<bool> _received;
+
+    size_t _missing_fragments = 0u;
+
+    Buffer _message;
+  };
+
+} // namespace multicast
+} // namespace detail
+} // namespace streaming
+} // namespace carla
@@ -63,6 +63,11 @@ namespace detail {  // 定义 detail 子命名空间
       return _shared_state ? _shared_state->AreClientsListening() : false;  // 返回共享状态的监听状态
     }
 
+    /// 是否有客户端能够接收下一条消息，见 tcp::ServerSession::HasCredit。
+    bool HasCredit() {
+      return _shared_state ? _shared_state->HasCredit() : false;
+    }
+
   private:
 
     friend class detail::Dispatcher;  // 声明 Dispatcher 为友元类，允许其访问私有成员
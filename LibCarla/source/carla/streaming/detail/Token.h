@@ -49,7 +49,8 @@ namespace detail {
     enum class protocol : uint8_t {
       not_set,///< 未设置协议
       tcp,///< TCP协议
-      udp ///< UDP协议
+      udp,///< UDP协议
+      shared_memory ///< 通过TCP连接协商，同一主机上经共享内存传输数据
     } protocol = protocol::not_set;
     /**
     * @brief 地址类型枚举，指示IP地址的版本。
@@ -123,9 +124,18 @@ namespace detail {
     template <typename P>
     boost::asio::ip::basic_endpoint<P> get_endpoint() const {
       DEBUG_ASSERT(is_valid());// 假设is_valid()是一个检查令牌有效性的成员函数
-      DEBUG_ASSERT(get_protocol<P>() == _token.protocol);// 检查协议是否匹配
+      DEBUG_ASSERT(uses_protocol<P>());// 检查协议是否匹配
       return {get_address(), _token.port};// 返回端点，包含地址和端口
     }
+    /**
+    * @brief 检查令牌的端点是否使用协议P，共享内存传输的令牌使用TCP端点。
+    */
+    template <typename P>
+    bool uses_protocol() const {
+      return (get_protocol<P>() == _token.protocol) ||
+             (std::is_same<P, boost::asio::ip::tcp>::value &&
+              _token.protocol == token_data::protocol::shared_memory);
+    }
 
   public:
       /**
@@ -280,6 +290,16 @@ namespace detail {
       return _token.protocol == token_data::protocol::tcp;
     }
     /**
+ * @brief 检查协议是否为共享内存传输。
+ *
+ * 这类令牌的端点是TCP端点，同一主机上的客户端可在连接后请求经共享内存接收数据。
+ *
+ * @return 如果协议是共享内存传输，则返回true；否则返回false。
+ */
+    bool protocol_is_shared_memory() const {
+      return _token.protocol == token_data::protocol::shared_memory;
+    }
+    /**
  * @brief 检查是否具有相同的协议。
  *
  * 比较当前令牌的协议与给定端点的协议。
@@ -289,7 +309,7 @@ namespace detail {
  */
     template <typename Protocol>
     bool has_same_protocol(const boost::asio::ip::basic_endpoint<Protocol> &) const {
-      return _token.protocol == get_protocol<Protocol>();
+      return uses_protocol<Protocol>();
     }
     /**
  * @brief 将令牌转换为UDP端点。
@@ -304,7 +324,7 @@ namespace detail {
     /**
  * @brief 将令牌转换为TCP端点。
  *
- * 如果当前令牌的协议不是TCP，则行为未定义。
+ * 如果当前令牌的协议不是TCP或共享内存传输，则行为未定义。
  *
  * @return TCP端点。
  */
@@ -312,6 +332,14 @@ namespace detail {
       return get_endpoint<boost::asio::ip::tcp>();
     }
 
+    /**
+ * @brief 将TCP令牌标记为共享内存传输。
+ */
+    void enable_shared_memory() {
+      DEBUG_ASSERT(protocol_is_tcp() || protocol_is_shared_memory());
+      _token.protocol = token_data::protocol::shared_memory;
+    }
+
   private:
       /**
  * @brief 友元类，允许Dispatcher访问私有成员。
@@ -11,22 +11,41 @@
 #include "carla/Exception.h"
 #include "carla/Logging.h"
 #include "carla/Time.h"
+#include "carla/streaming/detail/Codec.h"
 
 // C++ Boost Asio是一个基于事件驱动的网络编程库，提供了异步的、非阻塞的网络编程接口。
 #include <boost/asio/connect.hpp>
+#include <boost/asio/ip/multicast.hpp>
 #include <boost/asio/read.hpp>
 #include <boost/asio/write.hpp>
 // 通过停止使用boost post，删除了ServerSession和Client中Write函数的并行化，
 // 这会导致客户机和服务器之间的不同步，并最终导致泄漏：https://github.com/carla-simulator/carla/pull/8130
 #include <boost/asio/bind_executor.hpp>
 
+#include <algorithm>
+#include <cstring>
 #include <exception>
+#include <string>
 
 namespace carla {
 namespace streaming {
 namespace detail {
 namespace tcp {
 
+  /// 组播数据报的最大长度。
+  static constexpr size_t MAX_DATAGRAM_SIZE = 65536u;
+
+  /// 加入组播组后在这段时间内没有收到任何数据报时改用TCP。
+  static const auto MULTICAST_TIMEOUT = time_duration::seconds(5u);
+
+  /// 组播失败后第一次重新尝试前等待的秒数，连续失败时加倍，最多等待 MULTICAST_MAX_RETRY_DELAY 秒。
+  static constexpr long MULTICAST_RETRY_DELAY = 30;
+
+  static constexpr long MULTICAST_MAX_RETRY_DELAY = 600;
+
+  /// 接收组播数据的套接字缓冲区大小，一帧图像的所有分片可能同时到达。
+  static constexpr int MULTICAST_RECEIVE_BUFFER_SIZE = 8 * 1024 * 1024;
+
   // ===========================================================================
   // -- 传入消息 IncomingMessage ------------------------------------------------
   // ===========================================================================
@@ -35,7 +54,8 @@ namespace tcp {
   class IncomingMessage {
   public:
 
-    explicit IncomingMessage(Buffer &&buffer) : _message(std::move(buffer)) {}
+    explicit IncomingMessage(std::shared_ptr<BufferPool> buffer_pool)
+      : _buffer_pool(std::move(buffer_pool)) {}
 
     // 获取缓冲区的大小
     boost::asio::mutable_buffer size_as_buffer() {
@@ -44,13 +64,26 @@ namespace tcp {
 
     // 获取消息的缓冲区
     boost::asio::mutable_buffer buffer() {
-      DEBUG_ASSERT(_size > 0u);
-      _message.reset(_size);
+      DEBUG_ASSERT(size() > 0u);
+      // 知道了消息的大小之后再从池中取出合适的缓冲区
+      _message = _buffer_pool->Pop(size());
+      _message.reset(size());
       return _message.buffer();
     }
 
-    auto size() const {
-      return _size;
+    // 消息的大小，不包括标志位
+    message_size_type size() const {
+      return _size & ~(codec::COMPRESSED_FLAG | multicast::ANNOUNCEMENT_FLAG);
+    }
+
+    // 消息的内容是否是压缩后的数据
+    bool is_compressed() const {
+      return (_size & codec::COMPRESSED_FLAG) != 0u;
+    }
+
+    // 消息的内容是否是组播组的地址
+    bool is_multicast_announcement() const {
+      return (_size & multicast::ANNOUNCEMENT_FLAG) != 0u;
     }
 
     auto pop() {
@@ -63,6 +96,8 @@ namespace tcp {
 
     message_size_type _size = 0u;
 
+    std::shared_ptr<BufferPool> _buffer_pool;
+
     Buffer _message;
   };
 
@@ -70,6 +105,8 @@ namespace tcp {
   // -- 客户端 ------------------------------------------------------------------
   // ===========================================================================
 
+  constexpr size_t Client::TOKEN_RESOLVE_ATTEMPTS;
+
   Client::Client(
       boost::asio::io_context &io_context,
       const token_type &token,
@@ -81,8 +118,12 @@ namespace tcp {
       _socket(io_context),
       _strand(io_context),
       _connection_timer(io_context),
-      _buffer_pool(std::make_shared<BufferPool>()) {
-    if (!_token.protocol_is_tcp()) {
+      _buffer_pool(std::make_shared<BufferPool>()),
+      _multicast_socket(io_context),
+      _multicast_timer(io_context),
+      _multicast_retry_delay(MULTICAST_RETRY_DELAY),
+      _multicast_retry_timer(io_context) {
+    if (!_token.protocol_is_tcp() && !_token.protocol_is_shared_memory()) {
       throw_exception(std::invalid_argument("invalid token, only TCP tokens supported"));
     }
   }
@@ -104,9 +145,18 @@ namespace tcp {
       }
 
       DEBUG_ASSERT(_token.is_valid());
-      DEBUG_ASSERT(_token.protocol_is_tcp());
+      DEBUG_ASSERT(_token.protocol_is_tcp() || _token.protocol_is_shared_memory());
       const auto ep = _token.to_tcp_endpoint();
 
+      // 重新连接后由新的会话决定是否使用共享内存传输和组播
+      _has_received_data = false;
+      _shared_memory.reset();
+      LeaveMulticast();
+      // 只有服务器在本机时才能共享内存
+      _awaiting_shared_memory_reply =
+          !_send_plain_stream_id &&
+          _token.protocol_is_shared_memory() && !_shared_memory_failed && ep.address().is_loopback();
+
       auto handle_connect = [this, self, ep](error_code ec) {
         if (!ec) {
           if (_done) {
@@ -125,9 +175,20 @@ namespace tcp {
           // 发送流id以订阅流。
           const auto &stream_id = _token.get_stream_id();
           log_debug("streaming client: sending stream id", stream_id);
+          if (_send_plain_stream_id) {
+            _requested_stream_id = stream_id;
+          } else {
+            // 表明本客户端能够解压数据
+            _requested_stream_id = stream_id | codec::SUPPORT_FLAG;
+            if (_awaiting_shared_memory_reply) {
+              _requested_stream_id |= SharedMemoryRing::REQUEST_FLAG;
+            } else if (!_multicast_failed) {
+              _requested_stream_id |= multicast::SUPPORT_FLAG;
+            }
+          }
           boost::asio::async_write(
               _socket,
-              boost::asio::buffer(&stream_id, sizeof(stream_id)),
+              boost::asio::buffer(&_requested_stream_id, sizeof(_requested_stream_id)),
               boost::asio::bind_executor(_strand, [=](error_code ec, size_t DEBUG_ONLY(bytes)) {
                 // 确保在连接停止后停止执行。
                 if (_done) {
@@ -157,11 +218,17 @@ namespace tcp {
   // 停止连接
   void Client::Stop() {
     _connection_timer.cancel();
+    _multicast_timer.cancel();
+    _multicast_retry_timer.cancel();
     auto self = shared_from_this();
       _done = true;
       if (_socket.is_open()) {
         _socket.close();
       }
+      if (_multicast_socket.is_open()) {
+        boost::system::error_code ec;
+        _multicast_socket.close(ec);
+      }
   }
 
 
@@ -169,13 +236,49 @@ namespace tcp {
   void Client::Reconnect() {
     auto self = shared_from_this();
     _connection_timer.expires_from_now(time_duration::seconds(1u));
+    ++_failed_connections;
     _connection_timer.async_wait([this, self](boost::system::error_code ec) {
       if (!ec) {
+        if (_token_resolver && (_failed_connections >= TOKEN_RESOLVE_ATTEMPTS)) {
+          ResolveToken();
+        }
         Connect();
       }
     });
   }
 
+  void Client::ConnectionLost() {
+    if (_has_received_data) {
+      Connect();
+    } else {
+      // 服务器接受连接后立即关闭，例如重启后还没有这个流，
+      // 或者是不认识能力位的旧版本服务器，下次换另一种流ID
+      _send_plain_stream_id = !_send_plain_stream_id;
+      Reconnect();
+    }
+  }
+
+  void Client::ResolveToken() {
+    _failed_connections = 0u;
+    token_type token = _token;
+    try {
+      if (!_token_resolver(token)) {
+        return;
+      }
+    } catch (const std::exception &e) {
+      log_info("streaming client: failed to resolve token:", e.what());
+      return;
+    }
+    if (token.get_stream_id() != _token.get_stream_id()) {
+      log_error("streaming client: resolved token belongs to another stream");
+      return;
+    }
+    if ((token.get_address() != _token.get_address()) || (token.get_port() != _token.get_port())) {
+      log_info("streaming client: stream", _token.get_stream_id(), "moved to", token.to_tcp_endpoint());
+    }
+    _token = token;
+  }
+
 
   // 读取数据
   void Client::ReadData() {
@@ -186,21 +289,48 @@ namespace tcp {
 
       // log_debug("streaming client: Client::ReadData");
 
-      auto message = std::make_shared<IncomingMessage>(_buffer_pool->Pop());
+      auto message = std::make_shared<IncomingMessage>(_buffer_pool);
 
       auto handle_read_data = [this, self, message](boost::system::error_code ec, size_t DEBUG_ONLY(bytes)) {
         DEBUG_ONLY(log_debug("streaming client: Client::ReadData.handle_read_data", bytes, "bytes"));
         if (!ec) {
           DEBUG_ASSERT_EQ(bytes, message->size());
           DEBUG_ASSERT_NE(bytes, 0u);
-          // 将缓冲区移动到回调函数并开始读取下一块数据。
-          // log_debug("streaming client: success reading data, calling the callback");
-          self->_callback(message->pop());
+          Buffer data = message->pop();
+          if (_awaiting_shared_memory_reply) {
+            // 连接后的第一条消息是服务器对共享内存传输请求的回复
+            _awaiting_shared_memory_reply = false;
+            if (!OpenSharedMemory(data)) {
+              Connect();
+              return;
+            }
+          } else if (message->is_multicast_announcement()) {
+            // 之后的数据从组播组接收，连接只用于维持订阅
+            if (!JoinMulticast(data)) {
+              Connect();
+              return;
+            }
+          } else if (_shared_memory != nullptr) {
+            // 消息只包含描述符，数据在环形缓冲区中
+            Buffer payload = _buffer_pool->Pop();
+            if (!ReadSharedMemory(data, payload)) {
+              log_info("streaming client: invalid shared memory descriptor");
+              Connect();
+              return;
+            }
+            if (!DeliverData(std::move(payload), message->is_compressed())) {
+              Connect();
+              return;
+            }
+          } else if (!DeliverData(std::move(data), message->is_compressed())) {
+            Connect();
+            return;
+          }
           ReadData();
         } else {
           // 像往常一样，如果出了什么问题，就从头再来。
           log_debug("streaming client: failed to read data:", ec.message());
-          Connect();
+          ConnectionLost();
         }
       };
 
@@ -222,7 +352,7 @@ namespace tcp {
           log_debug("streaming client: failed to read header:", ec.message());
           DEBUG_ONLY(log_debug("size  = ", message->size()));
           DEBUG_ONLY(log_debug("bytes = ", bytes));
-          Connect();
+          ConnectionLost();
         }
       };
 
@@ -233,6 +363,158 @@ namespace tcp {
           boost::asio::bind_executor(_strand, handle_read_header));
   }
 
+  bool Client::OpenSharedMemory(const Buffer &reply) {
+    if (reply.empty() || (reply.data()[0u] == 0u)) {
+      log_debug("streaming client: shared memory refused, using TCP");
+      return true;
+    }
+    const std::string name(reinterpret_cast<const char *>(reply.data()) + 1u, reply.size() - 1u);
+    try {
+      _shared_memory = SharedMemoryRing::Open(name);
+      log_debug("streaming client: receiving data through shared memory", name);
+      return true;
+    } catch (const std::exception &e) {
+      // 服务器与客户端不在同一个共享内存命名空间中，例如位于不同的容器中
+      log_info("streaming client: failed to open shared memory, using TCP:", e.what());
+      _shared_memory_failed = true;
+      return false;
+    }
+  }
+
+  bool Client::DeliverData(Buffer data, const bool is_compressed) {
+    _has_received_data = true;
+    _failed_connections = 0u;
+    if (!is_compressed) {
+      // 将缓冲区移动到回调函数
+      _callback(std::move(data));
+      return true;
+    }
+    Buffer decompressed = _buffer_pool->Pop();
+    if (!codec::Decompress(data, decompressed)) {
+      log_info("streaming client: failed to decompress data");
+      return false;
+    }
+    _callback(std::move(decompressed));
+    return true;
+  }
+
+  bool Client::JoinMulticast(const Buffer &announcement) {
+    boost::asio::ip::udp::endpoint group;
+    if (!multicast::ParseGroup(announcement, group)) {
+      log_info("streaming client: invalid multicast announcement, using TCP");
+      MulticastFailed();
+      return false;
+    }
+    LeaveMulticast();
+    try {
+      _multicast_socket.open(group.protocol());
+      _multicast_socket.set_option(boost::asio::ip::udp::socket::reuse_address(true));
+      // 同一台主机上的多个客户端可能订阅同一个组播组
+      _multicast_socket.bind(boost::asio::ip::udp::endpoint(group.protocol(), group.port()));
+      _multicast_socket.set_option(boost::asio::ip::multicast::join_group(group.address()));
+    } catch (const std::exception &e) {
+      log_info("streaming client: failed to join multicast group, using TCP:", e.what());
+      LeaveMulticast();
+      MulticastFailed();
+      return false;
+    }
+    boost::system::error_code ec;
+    // 缓冲区大小只是建议值，设置失败时使用系统的默认值
+    _multicast_socket.set_option(
+        boost::asio::socket_base::receive_buffer_size(MULTICAST_RECEIVE_BUFFER_SIZE), ec);
+    _multicast = std::make_unique<multicast::Reassembler>(_token.get_stream_id(), _buffer_pool);
+    _datagram.resize(MAX_DATAGRAM_SIZE);
+    _multicast_received = false;
+    log_debug("streaming client: receiving data from multicast group", group);
+    ReadMulticast(_multicast_generation);
+    WatchMulticast(_multicast_generation);
+    return true;
+  }
+
+  void Client::LeaveMulticast() {
+    ++_multicast_generation;
+    _multicast.reset();
+    _multicast_timer.cancel();
+    if (_multicast_socket.is_open()) {
+      boost::system::error_code ec;
+      _multicast_socket.close(ec);
+    }
+  }
+
+  void Client::ReadMulticast(const size_t generation) {
+    auto self = shared_from_this();
+    auto handle_receive = [this, self, generation](boost::system::error_code ec, size_t bytes) {
+      if (_done || (generation != _multicast_generation)) {
+        return;
+      }
+      if (ec) {
+        log_info("streaming client: failed to receive multicast data, using TCP:", ec.message());
+        MulticastFailed();
+        Connect();
+        return;
+      }
+      _multicast_received = true;
+      if (_multicast->Push(_datagram.data(), bytes)) {
+        // 组播没有重传，损坏的消息直接丢弃
+        DeliverData(_multicast->pop(), _multicast->is_compressed());
+      }
+      ReadMulticast(generation);
+    };
+    _multicast_socket.async_receive(
+        boost::asio::buffer(_datagram),
+        boost::asio::bind_executor(_strand, handle_receive));
+  }
+
+  void Client::WatchMulticast(const size_t generation) {
+    auto self = shared_from_this();
+    _multicast_timer.expires_from_now(MULTICAST_TIMEOUT);
+    _multicast_timer.async_wait(boost::asio::bind_executor(_strand,
+        [this, self, generation](boost::system::error_code ec) {
+      if (ec || _done || (generation != _multicast_generation)) {
+        return;
+      }
+      if (!_multicast_received) {
+        // 网络可能不转发组播，或者该流在这段时间内没有数据；改用TCP，稍后再重新尝试组播
+        log_info("streaming client: no multicast data received, using TCP");
+        MulticastFailed();
+        Connect();
+        return;
+      }
+      // 组播正常工作，下次失败时从最短的等待时间开始重新尝试
+      _multicast_retry_delay = MULTICAST_RETRY_DELAY;
+      _multicast_received = false;
+      WatchMulticast(generation);
+    }));
+  }
+
+  void Client::MulticastFailed() {
+    _multicast_failed = true;
+    auto self = shared_from_this();
+    _multicast_retry_timer.expires_from_now(time_duration::seconds(_multicast_retry_delay));
+    _multicast_retry_delay = std::min(2 * _multicast_retry_delay, MULTICAST_MAX_RETRY_DELAY);
+    _multicast_retry_timer.async_wait(boost::asio::bind_executor(_strand,
+        [this, self](boost::system::error_code ec) {
+      if (ec || _done) {
+        return;
+      }
+      _multicast_failed = false;
+      // 重新连接以再次表明能够接收组播；连接已经断开时由正在进行的重连完成
+      if (_socket.is_open() && (_multicast == nullptr)) {
+        log_debug("streaming client: retrying multicast");
+        Connect();
+      }
+    }));
+  }
+
+  bool Client::ReadSharedMemory(const Buffer &descriptor, Buffer &data) {
+    SharedMemoryRing::Descriptor parsed;
+    if (descriptor.size() != sizeof(parsed)) {
+      return false;
+    }
+    std::memcpy(&parsed, descriptor.data(), sizeof(parsed));
+    return _shared_memory->Read(parsed, data);
+  }
+
 } // namespace tcp
 } // namespace detail
 } // namespace streaming
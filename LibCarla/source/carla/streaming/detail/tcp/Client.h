@@ -10,17 +10,21 @@
 #include "carla/Buffer.h"/// \include 包含用于网络通信的缓冲区类定义。
 #include "carla/NonCopyable.h"/// \include 包含禁止对象复制和赋值的基类定义。
 #include "carla/profiler/LifetimeProfiled.h"/// \include 包含用于性能分析的生命周期跟踪类定义。
+#include "carla/streaming/detail/Multicast.h"/// \include 包含组播传输的数据报重组定义。
 #include "carla/streaming/detail/Token.h"/// \include 包含流处理中的令牌类定义。
 #include "carla/streaming/detail/Types.h"/// \include 包含流处理中使用的类型别名和常量定义。
+#include "carla/streaming/detail/tcp/SharedMemoryRing.h"/// \include 包含同一主机上传输数据的共享内存环形缓冲区定义。
 
 #include <boost/asio/deadline_timer.hpp>/// \include 包含Boost.Asio的定时器类定义，用于处理超时事件。
 #include <boost/asio/io_context.hpp>/// \include 包含Boost.Asio的I/O上下文类定义，是异步操作的核心。
 #include <boost/asio/ip/tcp.hpp> /// \include 包含Boost.Asio的TCP协议支持，用于网络通信。
+#include <boost/asio/ip/udp.hpp> /// \include 包含Boost.Asio的UDP协议支持，用于接收组播数据。
 #include <boost/asio/strand.hpp> /// \include 包含Boost.Asio的线程安全操作类定义，用于在多个线程间同步异步操作。
 
 #include <atomic>/// \include 包含C++标准库中的原子操作支持，用于实现线程安全的计数器等。
 #include <functional>/// \include 包含C++标准库中的函数对象支持，用于定义回调和可调用对象。
 #include <memory>/// \include 包含C++标准库中的智能指针支持，用于管理动态分配的内存。
+#include <vector>
 
 namespace carla {
     /// 缓冲区池类，用于管理缓冲区的分配和释放。
@@ -48,6 +52,11 @@ namespace tcp {
     /// @typedef callback_function_type
     /// @brief 回调函数类型，接收一个Buffer作为参数。
     using callback_function_type = std::function<void (Buffer)>;
+    /// @typedef token_resolver_type
+    /// @brief 重新获取流的令牌，失败时返回false。
+    using token_resolver_type = std::function<bool (token_type &)>;
+    /// @brief 连续连接失败这么多次后重新获取令牌。
+    static constexpr size_t TOKEN_RESOLVE_ATTEMPTS = 3u;
     /// @brief 构造函数。
    /// 
    /// @param io_context 引用boost::asio的I/O上下文对象，用于异步操作。
@@ -69,6 +78,13 @@ namespace tcp {
     }
     /// @brief 停止客户端。
     void Stop();
+    /// @brief 设置重新获取令牌的函数，必须在 Connect 之前调用。
+///
+/// 流所在的服务器重启或流被移到另一台服务器时，旧的令牌不再有效；
+/// 连续 TOKEN_RESOLVE_ATTEMPTS 次未能收到数据后用新的令牌连接。
+    void SetTokenResolver(token_resolver_type resolver) {
+      _token_resolver = std::move(resolver);
+    }
 
   private:
       /// @brief 重新连接流。
@@ -79,10 +95,45 @@ namespace tcp {
 ///
 /// 此方法从已连接的流中读取数据，并处理这些数据。
     void ReadData();
-    /// @brief 存储流的唯一标识令牌。
+    /// @brief 处理服务器对共享内存传输请求的回复。
+///
+/// 服务器接受时打开其创建的环形缓冲区。打开失败时返回false，之后的连接不再请求共享内存传输。
+    bool OpenSharedMemory(const Buffer &reply);
+    /// @brief 按服务器发送的描述符从环形缓冲区中读出数据。
+    bool ReadSharedMemory(const Buffer &descriptor, Buffer &data);
+    /// @brief 把收到的数据交给回调函数，压缩的数据先解压。数据损坏时返回false。
+    bool DeliverData(Buffer data, bool is_compressed);
+    /// @brief 按服务器通知的地址加入组播组，之后流的数据从组播组接收。
+///
+/// 加入失败时返回false，之后的连接不再表明能够接收组播。
+    bool JoinMulticast(const Buffer &announcement);
+    /// @brief 连接断开时调用，连接后还没有收到数据时视为一次连接失败。
+    void ConnectionLost();
+    /// @brief 调用 _token_resolver 更新令牌。
+    void ResolveToken();
+    /// @brief 离开组播组，丢弃尚未收齐的消息。
+    void LeaveMulticast();
+    /// @brief 从组播组接收下一个数据报。
+    void ReadMulticast(size_t generation);
+    /// @brief 定期检查是否收到了组播数据，网络不转发组播时改用TCP。
+    void WatchMulticast(size_t generation);
+    /// @brief 组播传输失败，改用TCP，并在一段时间后重新尝试组播。
+    void MulticastFailed();
+    /// @brief 存储流的令牌。
+///
+/// 流ID在客户端的整个生命周期内不变，地址和端口可能由 _token_resolver 更新。
+    token_type _token;
+    /// @brief 重新获取令牌的函数，可以为空。
+    token_resolver_type _token_resolver;
+    /// @brief 连续未能收到数据的连接次数。
+    size_t _failed_connections = 0u;
+    /// @brief 这次连接后是否收到了数据。
+    bool _has_received_data = false;
+    /// @brief 下次连接是否发送不带能力位的流ID。
 ///
-/// 这是一个常量，用于在客户端的整个生命周期内唯一标识流。
-    const token_type _token;
+/// 旧版本的服务器不认识带能力位的流ID，会立即关闭连接。连接在收到数据前断开时
+/// 交替使用两种流ID重试，收到数据后保持当时的方式。
+    bool _send_plain_stream_id = false;
     /// @brief 回调函数类型，用于处理读取的数据。
 ///
 /// 当从流中读取到数据时，将调用此回调函数，并将读取到的数据作为参数传递给它。
@@ -107,6 +158,32 @@ namespace tcp {
 ///
 /// 这是一个原子布尔值，用于在线程之间安全地表示客户端是否已完成其工作。初始值为false，表示客户端仍在运行。
     std::atomic_bool _done{false};
+    /// @brief 连接时发送的流ID，请求共享内存传输时置上请求位。
+    stream_id_type _requested_stream_id = 0u;
+    /// @brief 是否正在等待服务器对共享内存传输请求的回复。
+    bool _awaiting_shared_memory_reply = false;
+    /// @brief 共享内存传输失败后不再请求。
+    bool _shared_memory_failed = false;
+    /// @brief 共享内存传输使用的环形缓冲区，使用TCP传输数据时为空。
+    std::unique_ptr<SharedMemoryRing> _shared_memory;
+    /// @brief 接收组播数据的套接字。
+    boost::asio::ip::udp::socket _multicast_socket;
+    /// @brief 检查组播数据是否到达的定时器。
+    boost::asio::deadline_timer _multicast_timer;
+    /// @brief 把数据报组装成消息，未加入组播组时为空。
+    std::unique_ptr<multicast::Reassembler> _multicast;
+    /// @brief 每次加入组播组时加一，用于忽略之前的套接字和定时器的回调。
+    size_t _multicast_generation = 0u;
+    /// @brief 上一次检查之后是否收到了组播数据报。
+    bool _multicast_received = false;
+    /// @brief 组播传输失败后，在重新尝试之前不再表明能够接收组播。
+    bool _multicast_failed = false;
+    /// @brief 组播失败后等待多少秒再重新尝试，连续失败时加倍。
+    long _multicast_retry_delay;
+    /// @brief 重新尝试组播的定时器，不随组播组的离开而取消。
+    boost::asio::deadline_timer _multicast_retry_timer;
+    /// @brief 接收数据报的缓冲区。
+    std::vector<unsigned char> _datagram;
   };
 
 } // namespace tcp
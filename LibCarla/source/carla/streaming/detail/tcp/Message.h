@@ -15,6 +15,8 @@
 #include "carla/BufferView.h"/// @brief 包含 BufferView 类的声明，提供对 Buffer 中数据的只读视图。
 #include "carla/Debug.h"/// @brief 包含调试工具的声明，用于输出调试信息和进行断言检查。
 #include "carla/NonCopyable.h"/// @brief 包含 NonCopyable 类的声明，用于禁止类的拷贝操作。
+#include "carla/streaming/detail/Codec.h"/// @brief 包含流数据压缩相关的定义。
+#include "carla/streaming/detail/Multicast.h"/// @brief 包含组播传输相关的定义。
 #include "carla/streaming/detail/Types.h"/// @brief 包含网络流相关的类型定义。
 
 #include <boost/asio/buffer.hpp>/// @brief 包含 Boost.Asio 库中用于处理网络缓冲区的函数和类型。
@@ -82,8 +84,27 @@ namespace tcp {
     MessageTmpl(SharedBufferView buf, Buffers... buffers)
       : MessageTmpl(sizeof...(Buffers) + 1u, buf, buffers...) {
       static_assert(sizeof...(Buffers) < max_size(), "Too many buffers!");
-      // 设置第一个_buffer_view为_total_size的缓冲区
-      _buffer_views[0u] = boost::asio::buffer(&_total_size, sizeof(_total_size));
+      // 设置第一个_buffer_view为_header的缓冲区
+      _header = _total_size;
+      _buffer_views[0u] = boost::asio::buffer(&_header, sizeof(_header));
+    }
+
+    /// @brief 用于选择构造压缩消息的构造函数。
+    struct Compressed {};
+
+    /// @brief 构造内容为压缩数据的消息，发送的消息大小中带有压缩标志。
+    MessageTmpl(Compressed, SharedBufferView buf)
+      : MessageTmpl(buf) {
+      DEBUG_ASSERT((_total_size & codec::COMPRESSED_FLAG) == 0u);
+      _header |= codec::COMPRESSED_FLAG;
+    }
+    /// @brief 用于选择构造组播通知消息的构造函数。
+    struct MulticastAnnouncement {};
+    /// @brief 构造内容为组播组地址的消息，发送的消息大小中带有组播通知标志。
+    MessageTmpl(MulticastAnnouncement, SharedBufferView buf)
+      : MessageTmpl(buf) {
+      DEBUG_ASSERT((_total_size & multicast::ANNOUNCEMENT_FLAG) == 0u);
+      _header |= multicast::ANNOUNCEMENT_FLAG;
     }
 
     /// @brief 获取消息的大小（不包括头部。
@@ -92,6 +113,11 @@ namespace tcp {
     auto size() const noexcept {
       return _total_size;
     }
+
+    /// @brief 获取消息头中除消息大小以外的标志位。
+    auto header_flags() const noexcept {
+      return _header ^ _total_size;
+    }
     /// @brief 检查消息是否为空。
     ///
     /// @return 如果消息大小为0，则返回true；否则返回false。
@@ -113,6 +139,8 @@ namespace tcp {
     message_size_type _number_of_buffers = 0u;
     /// @brief 消息的总大小（以字节为单位，不包括头部）。
     message_size_type _total_size = 0u;
+    /// @brief 发送的消息头，即消息的总大小加上标志位。
+    message_size_type _header = 0u;
     /// @brief 存储所有传入的缓冲区对象的数组。
     std::array<SharedBufferView, MaxNumberOfBuffers> _buffers;
     /// @brief 存储所有缓冲区视图的数组，包括_total_size的缓冲区视图。
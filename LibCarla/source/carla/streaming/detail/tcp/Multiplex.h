@@ -0,0 +1,51 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/streaming/detail/Types.h"
+
+namespace carla {
+namespace streaming {
+namespace detail {
+namespace tcp {
+namespace multiplex {
+
+  /// 客户端在连接后发送的第一个流ID中置上该位，表示在这个连接上订阅多个流；同时可以置上
+  /// codec::SUPPORT_FLAG 表明能够解压数据。服务器接受时回复一条流ID为该值、大小为0的消息，
+  /// 不支持多路复用的服务器把它当作未知的流ID并关闭连接。
+  ///
+  /// 之后客户端每发送一个流ID订阅一个流，置上 UNSUBSCRIBE_FLAG 时取消订阅。
+  /// 服务器发送的每条消息前带有所属的流ID，消息大小为0表示服务器关闭了该流的会话。
+  constexpr stream_id_type REQUEST_FLAG = 1u << 28;
+
+  /// 客户端在订阅之后发送的流ID中置上该位以取消订阅。
+  constexpr stream_id_type UNSUBSCRIBE_FLAG = 1u << 31;
+
+  /// 客户端在订阅之后发送的流ID中置上该位为该流授予信用，之后的4字节是授予的消息数。
+  ///
+  /// 第一次授予信用后服务器只在该流有信用时发送消息，每条消息消耗一个信用，
+  /// 没有信用时跳过消息；从不授予信用的流不受限制。
+  constexpr stream_id_type CREDIT_FLAG = 1u << 30;
+
+#pragma pack(push, 1)
+
+  /// 多路复用连接上每条消息的消息头，之后是消息的数据。
+  struct FrameHeader {
+    stream_id_type stream_id = 0u;
+    /// 消息的大小及其标志位，与单个流的连接相同。
+    message_size_type size = 0u;
+  };
+
+#pragma pack(pop)
+
+  static_assert(sizeof(FrameHeader) == sizeof(stream_id_type) + sizeof(message_size_type), "Invalid frame header size!");
+
+} // namespace multiplex
+} // namespace tcp
+} // namespace detail
+} // namespace streaming
+} // namespace carla
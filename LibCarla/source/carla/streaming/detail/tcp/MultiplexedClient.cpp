@@ -0,0 +1,446 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/streaming/detail/tcp/MultiplexedClient.h"
+
+#include "carla/BufferPool.h"
+#include "carla/Debug.h"
+#include "carla/Logging.h"
+#include "carla/Time.h"
+#include "carla/streaming/detail/Codec.h"
+
+#include <boost/asio/bind_executor.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/read.hpp>
+#include <boost/asio/write.hpp>
+
+#include <algorithm>
+#include <exception>
+#include <string>
+
+namespace carla {
+namespace streaming {
+namespace detail {
+namespace tcp {
+
+  /// 连接失败或服务器关闭流的会话后等待这段时间再重试。
+  static const auto RETRY_INTERVAL = time_duration::seconds(1u);
+
+  MultiplexedClient::MultiplexedClient(boost::asio::io_context &io_context, endpoint ep)
+    : LIBCARLA_INITIALIZE_LIFETIME_PROFILER(
+          std::string("tcp multiplexed client ") + std::to_string(ep.port())),
+      _endpoint(std::move(ep)),
+      _socket(io_context),
+      _strand(io_context),
+      _connection_timer(io_context),
+      _buffer_pool(std::make_shared<BufferPool>()) {}
+
+  MultiplexedClient::~MultiplexedClient() = default;
+
+  void MultiplexedClient::Subscribe(
+      const token_type &token,
+      callback_function_type callback,
+      token_resolver_type resolver,
+      const uint32_t credits) {
+    DEBUG_ASSERT(token.to_tcp_endpoint() == _endpoint);
+    auto self = shared_from_this();
+    boost::asio::post(_strand, [this, self, token, credits, callback=std::move(callback), resolver=std::move(resolver)]() mutable {
+      if (_done) {
+        return;
+      }
+      const auto stream_id = token.get_stream_id();
+      if (_is_unsupported) {
+        Subscription subscription{token, std::move(callback), std::move(resolver)};
+        UseDedicatedClient(stream_id, subscription);
+        return;
+      }
+      auto &subscription = _subscriptions[stream_id];
+      subscription = Subscription{token, std::move(callback), std::move(resolver)};
+      subscription.credits = credits;
+      if (_is_connected) {
+        SendSubscription(stream_id, subscription);
+      } else if (_connection_generation == 0u) {
+        // 第一次订阅时开始连接，之后连接断开时总会重新连接并订阅所有的流
+        Connect();
+      }
+    });
+  }
+
+  void MultiplexedClient::GrantCredits(const stream_id_type stream_id, const uint32_t count) {
+    auto self = shared_from_this();
+    boost::asio::post(_strand, [this, self, stream_id, count]() {
+      auto it = _subscriptions.find(stream_id);
+      if (_done || (it == _subscriptions.end())) {
+        return;
+      }
+      ReturnCredits(stream_id, it->second, count);
+    });
+  }
+
+  void MultiplexedClient::ReturnCredits(
+      const stream_id_type stream_id,
+      Subscription &subscription,
+      const uint32_t count) {
+    if (subscription.credits == 0u) {
+      return;
+    }
+    subscription.returned_credits += count;
+    // 积累到一半的信用再发送，减少控制消息
+    if (_is_connected && (subscription.returned_credits >= std::max(subscription.credits / 2u, 1u))) {
+      _control_queue.emplace_back(stream_id | multiplex::CREDIT_FLAG);
+      _control_queue.emplace_back(subscription.returned_credits);
+      subscription.returned_credits = 0u;
+      if (!_is_writing) {
+        FlushControl();
+      }
+    }
+  }
+
+  void MultiplexedClient::UnSubscribe(const stream_id_type stream_id) {
+    auto self = shared_from_this();
+    boost::asio::post(_strand, [this, self, stream_id]() {
+      if ((_subscriptions.erase(stream_id) > 0u) && _is_connected && !_done) {
+        SendControl(stream_id | multiplex::UNSUBSCRIBE_FLAG);
+      }
+      std::shared_ptr<Client> client;
+      {
+        std::lock_guard<std::mutex> lock(_relocated_mutex);
+        auto it = _relocated.find(stream_id);
+        if (it != _relocated.end()) {
+          client = std::move(it->second);
+          _relocated.erase(it);
+        }
+      }
+      if (client != nullptr) {
+        client->Stop();
+      }
+    });
+  }
+
+  void MultiplexedClient::Stop() {
+    _connection_timer.cancel();
+    _done = true;
+    if (_socket.is_open()) {
+      boost::system::error_code ec;
+      _socket.close(ec);
+    }
+    std::unordered_map<stream_id_type, std::shared_ptr<Client>> relocated;
+    {
+      std::lock_guard<std::mutex> lock(_relocated_mutex);
+      relocated.swap(_relocated);
+    }
+    for (auto &pair : relocated) {
+      pair.second->Stop();
+    }
+  }
+
+  void MultiplexedClient::Connect() {
+    if (_done) {
+      return;
+    }
+    if (_socket.is_open()) {
+      boost::system::error_code ec;
+      _socket.close(ec);
+    }
+    // 之前的连接上尚未完成的操作在回调中被忽略
+    const size_t generation = ++_connection_generation;
+    _is_connected = false;
+    _is_accepted = false;
+    _has_received_data = false;
+    _is_writing = false;
+    _control_queue.clear();
+
+    auto self = shared_from_this();
+    auto handle_connect = [this, self, generation](boost::system::error_code ec) {
+      if (_done || (generation != _connection_generation)) {
+        return;
+      }
+      if (ec) {
+        log_info("streaming client: multiplexed connection failed:", ec.message());
+        Reconnect();
+        return;
+      }
+      // 与单个流的连接相同，不使用Nagle算法以降低延迟
+      _socket.set_option(boost::asio::ip::tcp::no_delay(true));
+      log_debug("streaming client: multiplexed connection to", _endpoint);
+      _is_connected = true;
+      // 表明本客户端能够解压数据，之后订阅所有的流
+      SendControl(multiplex::REQUEST_FLAG | codec::SUPPORT_FLAG);
+      for (auto &pair : _subscriptions) {
+        SendSubscription(pair.first, pair.second);
+      }
+      ReadFrame();
+    };
+
+    log_debug("streaming client: connecting to", _endpoint);
+    _socket.async_connect(_endpoint, boost::asio::bind_executor(_strand, handle_connect));
+  }
+
+  void MultiplexedClient::Reconnect() {
+    auto self = shared_from_this();
+    ++_failed_connections;
+    _connection_timer.expires_from_now(RETRY_INTERVAL);
+    _connection_timer.async_wait(boost::asio::bind_executor(_strand, [this, self](boost::system::error_code ec) {
+      if (ec || _done) {
+        return;
+      }
+      if (_failed_connections >= Client::TOKEN_RESOLVE_ATTEMPTS) {
+        // 服务器可能已经重启或者流移到了另一台服务器
+        _failed_connections = 0u;
+        std::vector<stream_id_type> stream_ids;
+        for (const auto &pair : _subscriptions) {
+          if (pair.second.resolver) {
+            stream_ids.emplace_back(pair.first);
+          }
+        }
+        for (const auto stream_id : stream_ids) {
+          ResolveToken(stream_id, _subscriptions.at(stream_id));
+        }
+      }
+      Connect();
+    }));
+  }
+
+  void MultiplexedClient::ConnectionLost() {
+    if (!_is_connected) {
+      // 读取和写入可能同时失败
+      return;
+    }
+    _is_connected = false;
+    if (!_is_accepted) {
+      // 不支持多路复用的服务器把请求当作未知的流ID并关闭连接
+      FallBack();
+      return;
+    }
+    if (_has_received_data) {
+      _failed_connections = 0u;
+      Connect();
+    } else {
+      Reconnect();
+    }
+  }
+
+  void MultiplexedClient::SendControl(const stream_id_type control_word) {
+    _control_queue.emplace_back(control_word);
+    if (!_is_writing) {
+      FlushControl();
+    }
+  }
+
+  void MultiplexedClient::SendSubscription(const stream_id_type stream_id, Subscription &subscription) {
+    _control_queue.emplace_back(stream_id);
+    if (subscription.credits > 0u) {
+      // 服务器为每次订阅创建新的会话，之前归还的信用已经没有意义
+      _control_queue.emplace_back(stream_id | multiplex::CREDIT_FLAG);
+      _control_queue.emplace_back(subscription.credits);
+      subscription.returned_credits = 0u;
+    }
+    if (!_is_writing) {
+      FlushControl();
+    }
+  }
+
+  void MultiplexedClient::FlushControl() {
+    if (_control_queue.empty()) {
+      _is_writing = false;
+      return;
+    }
+    _is_writing = true;
+    // 积累的流ID一次写入
+    auto words = std::make_shared<std::vector<stream_id_type>>();
+    words->swap(_control_queue);
+    const size_t generation = _connection_generation;
+    auto self = shared_from_this();
+    boost::asio::async_write(
+        _socket,
+        boost::asio::buffer(*words),
+        boost::asio::bind_executor(_strand, [this, self, words, generation](boost::system::error_code ec, size_t) {
+          if (_done || (generation != _connection_generation)) {
+            return;
+          }
+          if (ec) {
+            log_debug("streaming client: failed to send stream ids:", ec.message());
+            ConnectionLost();
+            return;
+          }
+          FlushControl();
+        }));
+  }
+
+  void MultiplexedClient::ReadFrame() {
+    const size_t generation = _connection_generation;
+    auto self = shared_from_this();
+
+    auto handle_read_header = [this, self, generation](boost::system::error_code ec, size_t) {
+      if (_done || (generation != _connection_generation)) {
+        return;
+      }
+      if (ec) {
+        log_debug("streaming client: failed to read header:", ec.message());
+        ConnectionLost();
+        return;
+      }
+      const stream_id_type stream_id = _frame.stream_id;
+      const bool is_compressed = (_frame.size & codec::COMPRESSED_FLAG) != 0u;
+      const message_size_type size = _frame.size & ~codec::COMPRESSED_FLAG;
+      if ((size == 0u) && (stream_id == multiplex::REQUEST_FLAG)) {
+        _is_accepted = true;
+        ReadFrame();
+        return;
+      }
+      if (size == 0u) {
+        SubscriptionClosed(stream_id);
+        ReadFrame();
+        return;
+      }
+      // 知道了消息的大小之后再从池中取出合适的缓冲区
+      auto data = std::make_shared<Buffer>(_buffer_pool->Pop(size));
+      data->reset(size);
+      boost::asio::async_read(
+          _socket,
+          data->buffer(),
+          boost::asio::bind_executor(_strand, [this, self, generation, stream_id, is_compressed, data](
+              boost::system::error_code ec,
+              size_t) {
+            if (_done || (generation != _connection_generation)) {
+              return;
+            }
+            if (ec) {
+              log_debug("streaming client: failed to read data:", ec.message());
+              ConnectionLost();
+              return;
+            }
+            DeliverData(stream_id, std::move(*data), is_compressed);
+            ReadFrame();
+          }));
+    };
+
+    boost::asio::async_read(
+        _socket,
+        boost::asio::buffer(&_frame, sizeof(_frame)),
+        boost::asio::bind_executor(_strand, handle_read_header));
+  }
+
+  void MultiplexedClient::SubscriptionClosed(const stream_id_type stream_id) {
+    auto it = _subscriptions.find(stream_id);
+    if (it == _subscriptions.end()) {
+      return;
+    }
+    log_debug("streaming client: stream", stream_id, "closed by the server");
+    ++it->second.failed_attempts;
+    // 服务器重启后可能还没有这个流，稍后重新订阅
+    auto timer = std::make_shared<boost::asio::deadline_timer>(_strand.context());
+    timer->expires_from_now(RETRY_INTERVAL);
+    const size_t generation = _connection_generation;
+    auto self = shared_from_this();
+    timer->async_wait(boost::asio::bind_executor(_strand, [this, self, timer, stream_id, generation](
+        boost::system::error_code ec) {
+      // 重新连接时已经订阅了所有的流
+      if (!ec && !_done && (generation == _connection_generation)) {
+        Resubscribe(stream_id);
+      }
+    }));
+  }
+
+  void MultiplexedClient::Resubscribe(const stream_id_type stream_id) {
+    auto it = _subscriptions.find(stream_id);
+    if (it == _subscriptions.end()) {
+      return;
+    }
+    if (it->second.resolver && (it->second.failed_attempts >= Client::TOKEN_RESOLVE_ATTEMPTS)) {
+      if (!ResolveToken(stream_id, it->second)) {
+        return;
+      }
+    }
+    if (_is_connected) {
+      SendSubscription(stream_id, it->second);
+    }
+  }
+
+  bool MultiplexedClient::ResolveToken(const stream_id_type stream_id, Subscription &subscription) {
+    subscription.failed_attempts = 0u;
+    token_type token = subscription.token;
+    try {
+      if (!subscription.resolver(token)) {
+        return true;
+      }
+    } catch (const std::exception &e) {
+      log_info("streaming client: failed to resolve token:", e.what());
+      return true;
+    }
+    if (token.get_stream_id() != stream_id) {
+      log_error("streaming client: resolved token belongs to another stream");
+      return true;
+    }
+    subscription.token = token;
+    if (token.to_tcp_endpoint() == _endpoint) {
+      return true;
+    }
+    // 这个连接只能订阅同一台服务器上的流
+    log_info("streaming client: stream", stream_id, "moved to", token.to_tcp_endpoint());
+    UseDedicatedClient(stream_id, subscription);
+    _subscriptions.erase(stream_id);
+    if (_is_connected) {
+      SendControl(stream_id | multiplex::UNSUBSCRIBE_FLAG);
+    }
+    return false;
+  }
+
+  void MultiplexedClient::UseDedicatedClient(const stream_id_type stream_id, Subscription &subscription) {
+    auto client = std::make_shared<Client>(_strand.context(), subscription.token, std::move(subscription.callback));
+    if (subscription.resolver) {
+      client->SetTokenResolver(std::move(subscription.resolver));
+    }
+    client->Connect();
+    std::lock_guard<std::mutex> lock(_relocated_mutex);
+    _relocated[stream_id] = std::move(client);
+  }
+
+  void MultiplexedClient::FallBack() {
+    log_info("streaming client: server", _endpoint, "does not support multiplexing, using one connection per stream");
+    _is_unsupported = true;
+    // 忽略这个连接上尚未完成的操作
+    ++_connection_generation;
+    if (_socket.is_open()) {
+      boost::system::error_code ec;
+      _socket.close(ec);
+    }
+    _control_queue.clear();
+    _is_writing = false;
+    std::unordered_map<stream_id_type, Subscription> subscriptions;
+    subscriptions.swap(_subscriptions);
+    for (auto &pair : subscriptions) {
+      UseDedicatedClient(pair.first, pair.second);
+    }
+  }
+
+  void MultiplexedClient::DeliverData(const stream_id_type stream_id, Buffer data, const bool is_compressed) {
+    auto it = _subscriptions.find(stream_id);
+    if (it == _subscriptions.end()) {
+      // 取消订阅之前服务器已经发出的数据
+      return;
+    }
+    _has_received_data = true;
+    _failed_connections = 0u;
+    it->second.failed_attempts = 0u;
+    if (!is_compressed) {
+      it->second.callback(std::move(data));
+      return;
+    }
+    Buffer decompressed = _buffer_pool->Pop();
+    if (!codec::Decompress(data, decompressed)) {
+      // 只丢弃这条消息，不影响连接上的其他流；回调不会归还这条消息的信用，在这里归还
+      log_info("streaming client: failed to decompress data of stream", stream_id);
+      ReturnCredits(stream_id, it->second, 1u);
+      return;
+    }
+    it->second.callback(std::move(decompressed));
+  }
+
+} // namespace tcp
+} // namespace detail
+} // namespace streaming
+} // namespace carla
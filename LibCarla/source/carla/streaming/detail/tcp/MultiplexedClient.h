@@ -0,0 +1,177 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/Buffer.h"
+#include "carla/NonCopyable.h"
+#include "carla/profiler/LifetimeProfiled.h"
+#include "carla/streaming/detail/Token.h"
+#include "carla/streaming/detail/Types.h"
+#include "carla/streaming/detail/tcp/Client.h"
+#include "carla/streaming/detail/tcp/Multiplex.h"
+
+#include <boost/asio/deadline_timer.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/strand.hpp>
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace carla {
+
+  class BufferPool;
+
+namespace streaming {
+namespace detail {
+namespace tcp {
+
+  /// @class MultiplexedClient
+  /// @brief 在到同一服务器的一个连接上订阅多个流的客户端。
+  ///
+  /// 每个流的数据带有流ID，由同一个读取循环分发给各自的回调函数；连接断开后重新连接并重新订阅
+  /// 所有的流。不使用共享内存传输和组播。令牌指向另一台服务器的流改用单独的 Client 连接。
+  ///
+  /// 服务器接受多路复用时先回复一个流ID为 multiplex::REQUEST_FLAG 的空消息；连接在收到
+  /// 回复之前断开时认为服务器不支持多路复用，之后所有的流都改用单独的 Client 连接。
+  ///
+  /// @warning 在释放共享指针之前，应该先停止这个客户端，否则它将不会被销毁。
+  class MultiplexedClient
+    : public std::enable_shared_from_this<MultiplexedClient>,
+      private profiler::LifetimeProfiled,
+      private NonCopyable {
+  public:
+
+    using endpoint = boost::asio::ip::tcp::endpoint;
+    using protocol_type = endpoint::protocol_type;
+    using callback_function_type = Client::callback_function_type;
+    using token_resolver_type = Client::token_resolver_type;
+
+    MultiplexedClient(boost::asio::io_context &io_context, endpoint ep);
+
+    ~MultiplexedClient();
+
+    /// @brief 订阅 @a token 的流，令牌的地址和端口须与连接的端点相同。
+    ///
+    /// @a resolver 可以为空，见 Client::SetTokenResolver。@a credits 不为0时服务器最多
+    /// 发送这么多条消息，之后每调用一次 GrantCredits 才发送更多的消息。
+    void Subscribe(
+        const token_type &token,
+        callback_function_type callback,
+        token_resolver_type resolver = {},
+        uint32_t credits = 0u);
+
+    /// @brief 归还 @a count 个已处理完的消息的信用，可以在任意线程调用。
+    void GrantCredits(stream_id_type stream_id, uint32_t count);
+
+    /// @brief 取消订阅，之后不再调用该流的回调函数。
+    void UnSubscribe(stream_id_type stream_id);
+
+    /// @brief 停止客户端。
+    void Stop();
+
+  private:
+
+    struct Subscription {
+      token_type token;
+      callback_function_type callback;
+      token_resolver_type resolver;
+      /// 连续未能收到数据的订阅次数。
+      size_t failed_attempts = 0u;
+      /// 每次订阅时授予的信用，为0时不限制。
+      uint32_t credits = 0u;
+      /// 已归还但还没有发送给服务器的信用。
+      uint32_t returned_credits = 0u;
+    };
+
+    /// @brief 连接到服务器并订阅所有的流。
+    void Connect();
+    /// @brief 等待一段时间后重新连接。
+    void Reconnect();
+    /// @brief 连接断开时调用。
+    void ConnectionLost();
+    /// @brief 在连接上发送订阅或取消订阅的流ID。
+    void SendControl(stream_id_type control_word);
+    /// @brief 归还 @a count 个信用，积累到一半时发送给服务器，只在 _strand 中调用。
+    void ReturnCredits(stream_id_type stream_id, Subscription &subscription, uint32_t count);
+    /// @brief 在连接上订阅流，使用信用时授予完整的信用。
+    void SendSubscription(stream_id_type stream_id, Subscription &subscription);
+    /// @brief 发送 _control_queue 中积累的流ID。
+    void FlushControl();
+    /// @brief 读取下一条消息。
+    void ReadFrame();
+    /// @brief 服务器关闭了流的会话，等待一段时间后重新订阅。
+    void SubscriptionClosed(stream_id_type stream_id);
+    /// @brief 重新订阅，连续失败 Client::TOKEN_RESOLVE_ATTEMPTS 次后先重新获取令牌。
+    void Resubscribe(stream_id_type stream_id);
+    /// @brief 重新获取令牌，流移到另一台服务器时改用单独的连接并返回false。
+    bool ResolveToken(stream_id_type stream_id, Subscription &subscription);
+    /// @brief 为 @a subscription 创建单独的 Client 连接，之后由它调用流的回调函数。
+    void UseDedicatedClient(stream_id_type stream_id, Subscription &subscription);
+    /// @brief 服务器不支持多路复用，所有的流改用单独的连接。
+    void FallBack();
+    /// @brief 把收到的数据交给流的回调函数，压缩的数据先解压。
+    void DeliverData(stream_id_type stream_id, Buffer data, bool is_compressed);
+
+    const endpoint _endpoint;
+
+    boost::asio::ip::tcp::socket _socket;
+
+    /// @brief 序列化对套接字和所有订阅的访问。
+    boost::asio::io_context::strand _strand;
+
+    boost::asio::deadline_timer _connection_timer;
+
+    std::shared_ptr<BufferPool> _buffer_pool;
+
+    std::atomic_bool _done{false};
+
+    /// @brief 订阅的流，只在 _strand 中访问。
+    std::unordered_map<stream_id_type, Subscription> _subscriptions;
+
+    /// @brief 保护 _relocated，Stop 可能在其他线程中调用。
+    std::mutex _relocated_mutex;
+
+    /// @brief 移到另一台服务器的流的单独连接。
+    std::unordered_map<stream_id_type, std::shared_ptr<Client>> _relocated;
+
+    /// @brief 是否已连接并发送了连接请求。
+    bool _is_connected = false;
+
+    /// @brief 服务器是否在这次连接上接受了多路复用。
+    bool _is_accepted = false;
+
+    /// @brief 服务器不支持多路复用，之后订阅的流直接使用单独的连接。
+    bool _is_unsupported = false;
+
+    /// @brief 这次连接后是否收到了数据。
+    bool _has_received_data = false;
+
+    /// @brief 连续未能收到数据的连接次数。
+    size_t _failed_connections = 0u;
+
+    /// @brief 每次连接时加一，用于忽略之前的连接上的回调。
+    size_t _connection_generation = 0u;
+
+    /// @brief 等待发送的流ID。
+    std::vector<stream_id_type> _control_queue;
+
+    /// @brief 是否正在发送流ID。
+    bool _is_writing = false;
+
+    /// @brief 正在读取的消息头。
+    multiplex::FrameHeader _frame;
+  };
+
+} // namespace tcp
+} // namespace detail
+} // namespace streaming
+} // namespace carla
@@ -14,6 +14,7 @@
 #include <boost/asio/ip/tcp.hpp> // 引入Boost库的asio模块中的ip/tcp协议支持类
 #include <boost/asio/post.hpp> // 引入Boost库的asio模块中的post函数，用于在io_context上安排函数执行
 
+#include <algorithm>
 #include <atomic> // 引入C++标准库中的原子操作模板，用于线程安全的共享变量操作
 
 namespace carla {
@@ -60,6 +61,37 @@ namespace tcp {
       return _synchronous;
     }
 
+    /// 设置同一主机上的客户端请求共享内存传输时每个会话的环形缓冲区容量，
+    /// 为0时不启用共享内存传输，仅对新创建的会话有效
+    void SetSharedMemoryCapacity(uint64_t capacity) {
+      _shared_memory_capacity = capacity;
+    }
+
+    uint64_t GetSharedMemoryCapacity() const {
+      return _shared_memory_capacity;
+    }
+
+    /// 设置每个会话的发送队列：最多容纳 @a depth 条正在发送和等待发送的消息，
+    /// 队列满时在异步模式下按 @a policy 处理新消息，同步模式下总是等待。
+    /// 等待超过 @a timeout 后丢弃新消息，为0时一直等待
+    void SetSendQueue(size_t depth, SendQueuePolicy policy, time_duration timeout) {
+      _send_queue_depth = std::max<size_t>(depth, 1u);
+      _send_queue_policy = policy;
+      _send_queue_timeout = timeout;
+    }
+
+    size_t GetSendQueueDepth() const {
+      return _send_queue_depth;
+    }
+
+    SendQueuePolicy GetSendQueuePolicy() const {
+      return _send_queue_policy;
+    }
+
+    time_duration GetSendQueueTimeout() const {
+      return _send_queue_timeout;
+    }
+
   private:
 
     void OpenSession( // 私有方法，用于打开新的会话
@@ -74,6 +106,14 @@ namespace tcp {
     std::atomic<time_duration> _timeout; // 原子操作的超时时间，用于线程安全的超时时间设置
 
     bool _synchronous; // 布尔值，表示服务器是否运行在同步模式
+
+    std::atomic<uint64_t> _shared_memory_capacity{0u}; // 共享内存环形缓冲区的容量，为0时不启用
+
+    std::atomic_size_t _send_queue_depth{2u}; // 每个会话的发送队列深度，包括正在发送的消息
+
+    std::atomic<SendQueuePolicy> _send_queue_policy{SendQueuePolicy::DropNewest}; // 异步模式下队列满时的处理策略
+
+    std::atomic<time_duration> _send_queue_timeout{time_duration()}; // 等待队列空间的超时，为0时一直等待
   };
 
 } // namespace tcp
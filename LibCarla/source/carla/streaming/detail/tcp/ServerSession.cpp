@@ -8,6 +8,7 @@
 #include "carla/streaming/detail/tcp/Server.h"
 
 #include "carla/Debug.h"
+#include "carla/ListView.h"
 #include "carla/Logging.h"
 
 #include <boost/asio/read.hpp>
@@ -15,8 +16,11 @@
 #include <boost/asio/bind_executor.hpp>
 #include <boost/asio/post.hpp>
 
+#include <algorithm>
 #include <atomic>
+#include <iterator>
 #include <thread>
+#include <vector>
 
 namespace carla {
 namespace streaming {
@@ -24,6 +28,20 @@ namespace detail {
 namespace tcp {
 // 用于统计服务器会话的数量
   static std::atomic_size_t SESSION_COUNTER{0u};
+
+  // 多路复用连接上通知客户端流的会话已关闭的消息大小
+  static const message_size_type CLOSED_STREAM_SIZE = 0u;
+
+#pragma pack(push, 1)
+
+  // 共享内存传输时代替消息数据发送的描述符，格式与普通消息相同
+  struct ServerSession::SharedMemoryNotification {
+    message_size_type size = sizeof(SharedMemoryRing::Descriptor);
+    SharedMemoryRing::Descriptor descriptor;
+  };
+
+#pragma pack(pop)
+
 // ServerSession类的构造函数
   // @param io_context boost::asio的I/O上下文对象
   // @param timeout 会话超时时间
@@ -66,10 +84,35 @@ namespace tcp {
         if (!ec) {
         	// 断言接收到的字节数等于流ID的大小
           DEBUG_ASSERT_EQ(bytes_received, sizeof(_stream_id));
+          if ((_stream_id & multiplex::REQUEST_FLAG) != 0u) {
+            // 多路复用连接不使用共享内存和组播，之后读取客户端订阅的流ID
+            _is_multiplexed = true;
+            _accepts_compression = (_stream_id & codec::SUPPORT_FLAG) != 0u;
+            _stream_id = 0u;
+            _on_opened = callback;
+            log_debug("session", _session_id, ": multiplexed connection started");
+            // 回复一个流ID为 REQUEST_FLAG 的空消息，表示接受多路复用
+            PendingWrite accepted;
+            accepted.stream_id = multiplex::REQUEST_FLAG;
+            Push(std::move(accepted));
+            ReadSubscription();
+            return;
+          }
+          // 同一主机上的客户端可能在流ID中请求共享内存传输
+          const bool shared_memory_requested = (_stream_id & SharedMemoryRing::REQUEST_FLAG) != 0u;
+          // 客户端能够解压时服务器可以发送压缩后的数据
+          _accepts_compression = (_stream_id & codec::SUPPORT_FLAG) != 0u;
+          // 使用共享内存传输的客户端不需要组播
+          _accepts_multicast = ((_stream_id & multicast::SUPPORT_FLAG) != 0u) && !shared_memory_requested;
+          _stream_id &= ~(SharedMemoryRing::REQUEST_FLAG | codec::SUPPORT_FLAG | multicast::SUPPORT_FLAG);
           // 打印调试信息，表示会话已启动
           log_debug("session", _session_id, "for stream", _stream_id, " started");
-          // 在strand的上下文环境中执行回调函数
-          boost::asio::post(_strand.context(), [=]() { callback(self); });
+          if (shared_memory_requested) {
+            OpenSharedMemory(callback);
+          } else {
+            // 在strand的上下文环境中执行回调函数
+            boost::asio::post(_strand.context(), [=]() { callback(self); });
+          }
         } else {
         	// 打印错误信息，表示获取流ID时出错
           log_error("session", _session_id, ": error retrieving stream id :", ec.message());
@@ -87,56 +130,411 @@ namespace tcp {
           boost::asio::bind_executor(_strand, handle_query));
     });
   }
-// 向客户端写入消息的函数
+// 通知客户端组播组的地址，之后流的数据不再通过本会话发送
+  void ServerSession::StartMulticast(SharedBufferView announcement) {
+    DEBUG_ASSERT(_accepts_multicast);
+    Write(std::make_shared<const Message>(Message::MulticastAnnouncement{}, std::move(announcement)));
+    _receives_multicast = true;
+    // 连接上不再有数据，客户端断开时读取出错
+    boost::asio::post(_strand, [this, self=shared_from_this()]() {
+      boost::asio::async_read(
+          _socket,
+          boost::asio::buffer(&_disconnect_probe, sizeof(_disconnect_probe)),
+          boost::asio::bind_executor(_strand, [this, self](const boost::system::error_code &ec, size_t) {
+            {
+              std::lock_guard<std::mutex> lock(_queue_mutex);
+              if (_is_closed || (ec == boost::asio::error::operation_aborted)) {
+                return;
+              }
+            }
+            log_debug("session", _session_id, ": multicast client disconnected");
+            CloseNow();
+          }));
+    });
+  }
+// 向客户端写入消息的函数，消息进入本会话的发送队列，由上一条消息发送完成的回调继续发送
   // @param message 要写入的消息指针
   void ServerSession::Write(std::shared_ptr<const Message> message) {
-  	// 断言消息不为空且消息内容不为空
+    // 断言消息不为空且消息内容不为空
     DEBUG_ASSERT(message != nullptr);
     DEBUG_ASSERT(!message->empty());
-    auto self = shared_from_this();
-      if (!_socket.is_open()) {
+    // 消耗的信用随消息进入发送队列，消息在发送之前被丢弃时归还
+    std::weak_ptr<ServerSession> credit;
+    if (_uses_credits) {
+      if (!TakeCredit()) {
+        // 客户端还没有处理完之前的消息
+        log_debug("session", _session_id, ": no credit: message skipped");
         return;
       }
-      if (_is_writing) {
-        if (_server.IsSynchronousMode()) {
-          // 等待上一条消息发送完毕
-          while (_is_writing) {
-            std::this_thread::yield();
-          }
-        } else {
-          // 忽略该消息
+      credit = shared_from_this();
+    }
+    if (_connection != nullptr) {
+      // 多路复用的流通过所属连接的发送队列发送
+      _connection->Enqueue(std::move(message), _stream_id, std::move(credit));
+    } else {
+      Enqueue(std::move(message), 0u, std::move(credit));
+    }
+  }
+// 归还丢弃的消息消耗的信用，否则客户端的信用窗口会逐渐缩小直到这个流不再发送数据
+  void ServerSession::RefundCredit(const std::weak_ptr<ServerSession> &credit) {
+    auto session = credit.lock();
+    if (session != nullptr) {
+      ++session->_credits;
+    }
+  }
+// 按发送队列的策略把消息加入发送队列
+  void ServerSession::Enqueue(
+      std::shared_ptr<const Message> message,
+      const stream_id_type stream_id,
+      std::weak_ptr<ServerSession> credit) {
+    if (!_socket.is_open()) {
+      RefundCredit(credit);
+      return;
+    }
+    // 同步模式下客户端必须收到每一帧数据，队列满时总是等待
+    const SendQueuePolicy policy = _server.IsSynchronousMode() ?
+        SendQueuePolicy::Block :
+        _server.GetSendQueuePolicy();
+    const auto deadline = std::chrono::steady_clock::now() + _server.GetSendQueueTimeout().to_chrono();
+
+    {
+      std::unique_lock<std::mutex> lock(_queue_mutex);
+      if (!HasQueueSpace()) {
+        // 多路复用连接上只丢弃同一个流的消息，流关闭的通知不能丢弃
+        auto oldest = std::find_if(_send_queue.begin(), _send_queue.end(), [stream_id](const PendingWrite &pending) {
+          return (pending.message != nullptr) && (pending.stream_id == stream_id);
+        });
+        if ((policy == SendQueuePolicy::DropOldest) && (oldest != _send_queue.end())) {
+          // 丢弃这个流最早的尚未开始发送的消息，队列中没有时丢弃新消息
+          RefundCredit(oldest->credit);
+          _send_queue.erase(oldest);
+          log_debug("session", _session_id, ": connection too slow: oldest message discarded");
+        } else if (policy != SendQueuePolicy::Block) {
           log_debug("session", _session_id, ": connection too slow: message discarded");
+          RefundCredit(credit);
+          return;
+        } else if (!WaitForQueueSpace(lock, deadline)) {
+          log_debug("session", _session_id, ": send queue full: message discarded");
+          RefundCredit(credit);
           return;
         }
       }
-      _is_writing = true;
-// 定义消息发送完成后的回调函数
-      auto handle_sent = [this, self, message](const boost::system::error_code &ec, size_t DEBUG_ONLY(bytes)) {
-        _is_writing = false;
-        if (ec) {
-        	// 如果发送出错，打印错误信息并立即关闭会话
-          log_info("session", _session_id, ": error sending data :", ec.message());
-          CloseNow(ec);
+    }
+
+    // 单个流的连接上只有本线程会向队列中添加消息，因此释放锁之后队列仍有空间；
+    // 多路复用连接上其他流的线程可能同时加入消息，队列最多超出每个流一条消息
+    PendingWrite pending{std::move(message), nullptr, stream_id, std::move(credit)};
+    if (_shared_memory != nullptr) {
+      pending.notification = WriteSharedMemory(*pending.message, policy == SendQueuePolicy::Block, deadline);
+      if (pending.notification == nullptr) {
+        RefundCredit(pending.credit);
+        return;
+      }
+    }
+    Push(std::move(pending));
+  }
+// 把消息加入发送队列，没有正在发送的消息时立即发送
+  void ServerSession::Push(PendingWrite pending) {
+    {
+      std::lock_guard<std::mutex> lock(_queue_mutex);
+      if (_is_closed) {
+        return;
+      }
+      if (_messages_in_flight > 0u) {
+        _send_queue.emplace_back(std::move(pending));
+        return;
+      }
+      _messages_in_flight = 1u;
+    }
+    StartWrite(std::make_shared<WriteBatch>(1u, std::move(pending)));
+  }
+// 发送队列中正在发送和等待发送的消息数是否小于队列深度，调用时须持有 _queue_mutex
+  bool ServerSession::HasQueueSpace() const {
+    const size_t queued = _send_queue.size() + _messages_in_flight;
+    // 多路复用连接上每个流各占一份队列深度
+    const size_t streams = std::max<size_t>(_number_of_subscriptions, 1u);
+    return queued < std::max<size_t>(_server.GetSendQueueDepth(), 1u) * streams;
+  }
+// 等待发送队列出现空间，超时为0时一直等待，超时或会话关闭时返回false
+  bool ServerSession::WaitForQueueSpace(
+      std::unique_lock<std::mutex> &lock,
+      const std::chrono::steady_clock::time_point deadline) {
+    auto ready = [this]() { return _is_closed || HasQueueSpace(); };
+    if (_server.GetSendQueueTimeout().milliseconds() == 0u) {
+      _queue_space.wait(lock, ready);
+    } else if (!_queue_space.wait_until(lock, deadline, ready)) {
+      return false;
+    }
+    return !_is_closed;
+  }
+// 开始发送一批消息，发送完成后把队列中积累的消息作为下一批继续发送
+  void ServerSession::StartWrite(std::shared_ptr<WriteBatch> batch) {
+    DEBUG_ASSERT(batch != nullptr && !batch->empty());
+    auto self = shared_from_this();
+
+    // 所有消息的缓冲区合并为一次聚集写入，格式与逐条发送相同
+    std::vector<boost::asio::const_buffer> buffers;
+    size_t expected_bytes = 0u;
+    for (const PendingWrite &pending : *batch) {
+      if (_is_multiplexed) {
+        // 多路复用连接上消息前带有流ID，写入完成前批次不会改变，可以直接引用其中的流ID
+        buffers.emplace_back(&pending.stream_id, sizeof(pending.stream_id));
+        expected_bytes += sizeof(pending.stream_id);
+      }
+      if (pending.message == nullptr) {
+        // 流的会话已关闭，只发送大小为0的消息头
+        buffers.emplace_back(&CLOSED_STREAM_SIZE, sizeof(CLOSED_STREAM_SIZE));
+        expected_bytes += sizeof(CLOSED_STREAM_SIZE);
+      } else if (pending.notification != nullptr) {
+        // 共享内存传输时只发送描述符
+        buffers.emplace_back(pending.notification.get(), sizeof(SharedMemoryNotification));
+        expected_bytes += sizeof(SharedMemoryNotification);
+      } else {
+        for (const boost::asio::const_buffer &buffer : pending.message->GetBufferSequence()) {
+          buffers.emplace_back(buffer);
+        }
+        expected_bytes += sizeof(message_size_type) + pending.message->size();
+      }
+    }
+
+    auto handle_sent = [this, self, batch, expected_bytes](
+        const boost::system::error_code &ec,
+        size_t DEBUG_ONLY(bytes)) {
+      if (ec) {
+        // 如果发送出错，打印错误信息并立即关闭会话
+        log_info("session", _session_id, ": error sending data :", ec.message());
+        CloseNow(ec);
+        return;
+      }
+      // 如果发送成功，打印调试信息（可选）并断言发送的字节数正确
+      DEBUG_ONLY(log_debug("session", _session_id, ": successfully sent", bytes, "bytes"));
+      DEBUG_ASSERT_EQ(bytes, expected_bytes);
+      std::shared_ptr<WriteBatch> next;
+      {
+        std::lock_guard<std::mutex> lock(_queue_mutex);
+        if (_send_queue.empty() || _is_closed) {
+          _messages_in_flight = 0u;
         } else {
-        	// 如果发送成功，打印调试信息（可选）并断言发送的字节数正确
-          DEBUG_ONLY(log_debug("session", _session_id, ": successfully sent", bytes, "bytes"));
-          DEBUG_ASSERT_EQ(bytes, sizeof(message_size_type) + message->size());
+          next = std::make_shared<WriteBatch>(
+              std::make_move_iterator(_send_queue.begin()),
+              std::make_move_iterator(_send_queue.end()));
+          _send_queue.clear();
+          _messages_in_flight = next->size();
         }
-      };
-// 打印调试信息，表示要发送的消息大小
-      log_debug("session", _session_id, ": sending message of", message->size(), "bytes");
-// 设置消息发送的截止时间
-      _deadline.expires_from_now(_timeout);
-      // 异步写入消息
-      boost::asio::async_write(_socket, message->GetBufferSequence(), 
+      }
+      _queue_space.notify_all();
+      if (next != nullptr) {
+        StartWrite(std::move(next));
+      }
+    };
+
+    // 打印调试信息，表示要发送的消息数和大小
+    log_debug("session", _session_id, ": sending", batch->size(), "messages of", expected_bytes, "bytes");
+    // 设置消息发送的截止时间
+    _deadline.expires_from_now(_timeout);
+    // 异步写入消息
+    boost::asio::async_write(
+        _socket,
+        buffers,
         boost::asio::bind_executor(_strand, handle_sent));
   }
+// 回复共享内存传输请求的函数，回复的消息内容为1字节的结果和环形缓冲区的名称
+  void ServerSession::OpenSharedMemory(callback_function_type on_opened) {
+    std::string name;
+    const uint64_t capacity = _server.GetSharedMemoryCapacity();
+    if (capacity > 0u) {
+      name = "carla_stream_" + std::to_string(_server.GetLocalEndpoint().port()) +
+          "_" + std::to_string(_session_id);
+      try {
+        _shared_memory = SharedMemoryRing::Create(name, capacity);
+      } catch (const std::exception &e) {
+        log_info("session", _session_id, ": failed to create shared memory, using TCP :", e.what());
+        name.clear();
+      }
+    }
+
+    auto reply = std::make_shared<std::string>();
+    const message_size_type size = static_cast<message_size_type>(1u + name.size());
+    reply->append(reinterpret_cast<const char *>(&size), sizeof(size));
+    reply->push_back(_shared_memory != nullptr ? '\1' : '\0');
+    reply->append(name);
+
+    auto handle_sent = [this, self=shared_from_this(), reply, callback=std::move(on_opened)](
+        const boost::system::error_code &ec,
+        size_t) {
+      if (!ec) {
+        log_debug("session", _session_id, ": shared memory", (_shared_memory != nullptr ? "enabled" : "refused"));
+        boost::asio::post(_strand.context(), [=]() { callback(self); });
+      } else {
+        log_info("session", _session_id, ": error replying shared memory request :", ec.message());
+        CloseNow(ec);
+      }
+    };
+
+    _deadline.expires_from_now(_timeout);
+    boost::asio::async_write(
+        _socket,
+        boost::asio::buffer(*reply),
+        boost::asio::bind_executor(_strand, handle_sent));
+  }
+// 把消息的数据写入环形缓冲区并返回其描述符，环形缓冲区已满且不等待或等待超时时返回空指针
+  std::shared_ptr<const ServerSession::SharedMemoryNotification> ServerSession::WriteSharedMemory(
+      const Message &message,
+      const bool block,
+      const std::chrono::steady_clock::time_point deadline) {
+    auto notification = std::make_shared<SharedMemoryNotification>();
+    // 描述符的消息头保留原消息的标志位，例如数据是否经过压缩
+    notification->size |= message.header_flags();
+    // 第一个缓冲区是消息的大小，只复制其后的数据
+    const auto sequence = message.GetBufferSequence();
+    const auto payload = MakeListView(sequence.begin() + 1u, sequence.end());
+    const bool wait_forever = _server.GetSendQueueTimeout().milliseconds() == 0u;
+    while (!_shared_memory->TryWrite(payload, message.size(), notification->descriptor)) {
+      if (!block || !_socket.is_open() ||
+          (!wait_forever && (std::chrono::steady_clock::now() >= deadline))) {
+        // 环形缓冲区的空间只能由客户端释放，无法丢弃更早的消息
+        log_debug("session", _session_id, ": shared memory full: message discarded");
+        return nullptr;
+      }
+      // 等待客户端读出之前的消息
+      std::this_thread::yield();
+    }
+    return notification;
+  }
+// 读取多路复用连接上客户端订阅或取消订阅的下一个流ID
+  void ServerSession::ReadSubscription() {
+    auto handle_read = [this, self=shared_from_this()](const boost::system::error_code &ec, size_t) {
+      if (ControlReadFailed(ec)) {
+        return;
+      }
+      _deadline.expires_from_now(_timeout);
+      const stream_id_type stream_id = _control_word & ~(multiplex::UNSUBSCRIBE_FLAG | multiplex::CREDIT_FLAG);
+      if ((_control_word & multiplex::CREDIT_FLAG) != 0u) {
+        ReadCredits(stream_id);
+        return;
+      }
+      if ((_control_word & multiplex::UNSUBSCRIBE_FLAG) != 0u) {
+        Unsubscribe(stream_id);
+      } else {
+        Subscribe(stream_id);
+      }
+      ReadSubscription();
+    };
+    boost::asio::async_read(
+        _socket,
+        boost::asio::buffer(&_control_word, sizeof(_control_word)),
+        boost::asio::bind_executor(_strand, handle_read));
+  }
+// 读取授予的信用后继续读取下一个流ID
+  void ServerSession::ReadCredits(const stream_id_type stream_id) {
+    auto handle_read = [this, self=shared_from_this(), stream_id](const boost::system::error_code &ec, size_t) {
+      if (ControlReadFailed(ec)) {
+        return;
+      }
+      std::shared_ptr<ServerSession> session;
+      {
+        std::lock_guard<std::mutex> lock(_subscriptions_mutex);
+        auto it = _subscriptions.find(stream_id);
+        if (it != _subscriptions.end()) {
+          session = it->second;
+        }
+      }
+      if (session != nullptr) {
+        session->_credits += _credit_word;
+        session->_uses_credits = true;
+      }
+      ReadSubscription();
+    };
+    boost::asio::async_read(
+        _socket,
+        boost::asio::buffer(&_credit_word, sizeof(_credit_word)),
+        boost::asio::bind_executor(_strand, handle_read));
+  }
+// 客户端断开时读取出错，关闭连接
+  bool ServerSession::ControlReadFailed(const boost::system::error_code &ec) {
+    if (!ec) {
+      return false;
+    }
+    {
+      std::lock_guard<std::mutex> lock(_queue_mutex);
+      if (_is_closed || (ec == boost::asio::error::operation_aborted)) {
+        return true;
+      }
+    }
+    log_debug("session", _session_id, ": multiplexed client disconnected :", ec.message());
+    CloseNow();
+    return true;
+  }
+// 消耗一个信用，多个线程可能同时写入同一个会话
+  bool ServerSession::TakeCredit() {
+    uint32_t credits = _credits;
+    while (credits > 0u) {
+      if (_credits.compare_exchange_weak(credits, credits - 1u)) {
+        return true;
+      }
+    }
+    return false;
+  }
+// 为订阅的流创建没有套接字的会话，由 _on_opened 注册到流
+  void ServerSession::Subscribe(const stream_id_type stream_id) {
+    auto session = std::make_shared<ServerSession>(_strand.context(), _timeout, _server);
+    session->_connection = shared_from_this();
+    session->_stream_id = stream_id;
+    session->_accepts_compression = _accepts_compression;
+    session->_on_closed = _on_closed;
+    {
+      std::lock_guard<std::mutex> lock(_subscriptions_mutex);
+      if (!_subscriptions.emplace(stream_id, session).second) {
+        log_debug("session", _session_id, ": stream", stream_id, "already subscribed");
+        return;
+      }
+      _number_of_subscriptions = _subscriptions.size();
+    }
+    log_debug("session", _session_id, ": stream", stream_id, "subscribed");
+    boost::asio::post(_strand.context(), [callback=_on_opened, session]() { callback(session); });
+  }
+// 关闭取消订阅的流的会话，客户端已经不再等待该流，不需要通知
+  void ServerSession::Unsubscribe(const stream_id_type stream_id) {
+    std::shared_ptr<ServerSession> session;
+    {
+      std::lock_guard<std::mutex> lock(_subscriptions_mutex);
+      auto it = _subscriptions.find(stream_id);
+      if (it == _subscriptions.end()) {
+        return;
+      }
+      session = std::move(it->second);
+      _subscriptions.erase(it);
+      _number_of_subscriptions = _subscriptions.size();
+    }
+    log_debug("session", _session_id, ": stream", stream_id, "unsubscribed");
+    session->Close();
+  }
+// 流的会话被服务器关闭时通知客户端，例如流已关闭或不存在，客户端稍后重新订阅
+  void ServerSession::SubscriptionClosed(const ServerSession &session) {
+    {
+      std::lock_guard<std::mutex> lock(_subscriptions_mutex);
+      auto it = _subscriptions.find(session._stream_id);
+      if ((it == _subscriptions.end()) || (it->second.get() != &session)) {
+        return;
+      }
+      _subscriptions.erase(it);
+      _number_of_subscriptions = _subscriptions.size();
+    }
+    PendingWrite pending;
+    pending.stream_id = session._stream_id;
+    Push(std::move(pending));
+  }
 // 关闭会话的函数
   void ServerSession::Close() {
     boost::asio::post(_strand, [self=shared_from_this()]() { self->CloseNow(); });
   }
  // 启动定时器的函数，如果定时器已过期则关闭会话，否则设置异步等待定时器到期的回调函数
   void ServerSession::StartTimer() {
+    if (_receives_multicast &&
+        (_deadline.expires_at() <= boost::asio::deadline_timer::traits_type::now())) {
+      // 数据发送到组播组时连接上没有流量，由断开检测关闭会话
+      _deadline.expires_from_now(_timeout);
+    }
     if (_deadline.expires_at() <= boost::asio::deadline_timer::traits_type::now()) {
       log_debug("session", _session_id, "timed out");
       Close();
@@ -153,6 +551,13 @@ namespace tcp {
 // 立即关闭会话的函数，取消定时器，关闭套接字并执行关闭回调函数
   void ServerSession::CloseNow(boost::system::error_code ec) {
     _deadline.cancel();
+    {
+      // 唤醒等待发送队列空间的线程，丢弃尚未发送的消息
+      std::lock_guard<std::mutex> lock(_queue_mutex);
+      _is_closed = true;
+      _send_queue.clear();
+    }
+    _queue_space.notify_all();
     if (!ec)
     {
       if (_socket.is_open()) {
@@ -161,7 +566,23 @@ namespace tcp {
         _socket.close();
       }
     }
-    _on_closed(shared_from_this());
+    if (_is_multiplexed) {
+      // 连接关闭时关闭其上所有流的会话
+      std::unordered_map<stream_id_type, std::shared_ptr<ServerSession>> subscriptions;
+      {
+        std::lock_guard<std::mutex> lock(_subscriptions_mutex);
+        subscriptions.swap(_subscriptions);
+        _number_of_subscriptions = 0u;
+      }
+      for (auto &pair : subscriptions) {
+        pair.second->Close();
+      }
+    } else {
+      _on_closed(shared_from_this());
+      if (_connection != nullptr) {
+        _connection->SubscriptionClosed(*this);
+      }
+    }
     log_debug("session", _session_id, "closed");
   }
 
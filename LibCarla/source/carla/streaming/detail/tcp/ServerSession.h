@@ -43,12 +43,16 @@
       * 此文件定义了流处理模块中使用的底层类型，如流ID和消息大小类型。
       */
 #include "carla/streaming/detail/Types.h"
+#include "carla/streaming/detail/Codec.h"
+#include "carla/streaming/detail/Multicast.h"
       /**
        * @brief 引入Carla流处理模块中TCP消息类的定义。
        *
        * 此类用于表示TCP通信中传输的消息，包括消息头和消息体。
        */
 #include "carla/streaming/detail/tcp/Message.h"
+#include "carla/streaming/detail/tcp/Multiplex.h"
+#include "carla/streaming/detail/tcp/SharedMemoryRing.h"
        /**
         * @brief Clang编译器的警告控制区域开始。
         *
@@ -95,6 +99,10 @@
               *
               * 该头文件提供了函数对象、函数包装器以及标准函数适配器等功能。
               */
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
 #include <functional>
               /**
                * @brief 引入C++标准库中的memory头文件。
@@ -102,6 +110,10 @@
                * 该头文件提供了智能指针、动态内存分配和对象生命周期管理等功能。
                */
 #include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
                /**
                 * @namespace carla::streaming::detail::tcp
                 * @brief 包含Carla流处理模块中TCP通信的详细实现。
@@ -118,12 +130,24 @@ namespace tcp {
  */
   class Server;
 
+  /// @brief 会话的发送队列已满时对新消息的处理策略。
+  ///
+  /// 同步模式下总是使用 Block。
+  enum class SendQueuePolicy : uint8_t {
+    DropOldest, ///< 丢弃队列中最早的尚未开始发送的消息
+    DropNewest, ///< 丢弃新消息
+    Block       ///< 等待队列出现空间，超时后丢弃新消息
+  };
+
   /**
  * @class ServerSession
  * @brief TCP服务器会话类。
  *
  * 当会话打开时，它会从套接字读取一个流ID对象，并将自身传递给回调函数。如果在指定的不活动超时后没有活动，会话将自行关闭。
  *
+ * 客户端请求多路复用时，这个会话代表整个连接，不传递给回调函数；客户端订阅的每个流各有一个
+ * 没有套接字的会话，传递给回调函数，其数据带上流ID后通过连接的发送队列发送。
+ *
  * 该类继承自std::enable_shared_from_this<ServerSession>，以便能够安全地生成自身的shared_ptr。同时，它私有继承自
  * profiler::LifetimeProfiled用于性能分析，以及NonCopyable类以防止复制。
  */
@@ -176,6 +200,42 @@ namespace tcp {
     stream_id_type get_stream_id() const {
       return _stream_id;
     }
+    /**
+     * @warning 此函数只能在会话打开后调用。
+     *
+     * @brief 客户端是否能够解压服务器发送的数据。
+     */
+    bool AcceptsCompression() const {
+      return _accepts_compression;
+    }
+    /**
+     * @warning 此函数只能在会话打开后调用。
+     *
+     * @brief 客户端是否能够从组播组接收数据。
+     */
+    bool AcceptsMulticast() const {
+      return _accepts_multicast;
+    }
+    /**
+     * @brief 客户端是否已被通知从组播组接收数据。
+     */
+    bool ReceivesMulticast() const {
+      return _receives_multicast;
+    }
+    /**
+     * @brief 客户端是否能够接收下一条消息。
+     *
+     * 多路复用连接上的客户端为流授予信用后，用完信用时返回false，之后的消息被跳过。
+     */
+    bool HasCredit() const {
+      return !_uses_credits || (_credits > 0u);
+    }
+    /**
+     * @brief 通知客户端组播组的地址，之后流的数据只发送到组播组。
+     *
+     * @param announcement 组播组的地址，见 multicast::Sender::GetAnnouncement。
+     */
+    void StartMulticast(SharedBufferView announcement);
     /**
      * @brief 创建消息。
      *
@@ -225,6 +285,66 @@ namespace tcp {
 /// 该函数用于立即关闭会话，可选地接受一个错误代码参数来表示关闭的原因。
 /// @param ec 关闭会话时的错误代码，默认为无错误。
     void CloseNow(boost::system::error_code ec = boost::system::error_code());
+    /// @brief 回复客户端的共享内存传输请求，回复发送完毕后调用 @a on_opened。
+    ///
+    /// 服务器启用共享内存传输时创建本会话的环形缓冲区并回复其名称，否则回复拒绝，会话继续使用TCP传输数据。
+    void OpenSharedMemory(callback_function_type on_opened);
+    /// @brief 从多路复用连接读取客户端订阅或取消订阅的下一个流ID。
+    void ReadSubscription();
+    /// @brief 为多路复用连接上订阅的流创建会话并传递给 _on_opened。
+    void Subscribe(stream_id_type stream_id);
+    /// @brief 关闭多路复用连接上取消订阅的流的会话。
+    void Unsubscribe(stream_id_type stream_id);
+    /// @brief 多路复用连接上的流的会话关闭时调用，客户端没有取消订阅时通知客户端。
+    void SubscriptionClosed(const ServerSession &session);
+    /// @brief 读取客户端为 @a stream_id 授予的信用。
+    void ReadCredits(stream_id_type stream_id);
+    /// @brief 从多路复用连接读取失败时关闭连接并返回true。
+    bool ControlReadFailed(const boost::system::error_code &ec);
+    /// @brief 消耗一个信用，没有信用时返回false。
+    bool TakeCredit();
+
+    struct SharedMemoryNotification;
+
+    /// @brief 发送队列中的一条消息，共享内存传输时数据已写入环形缓冲区，只发送其描述符。
+    ///
+    /// 多路复用连接上消息前带有 @a stream_id，@a message 为空时表示该流的会话已关闭。
+    struct PendingWrite {
+      std::shared_ptr<const Message> message;
+      std::shared_ptr<const SharedMemoryNotification> notification;
+      stream_id_type stream_id = 0u;
+      /// 发送这条消息消耗了信用的会话，不使用信用时为空。
+      std::weak_ptr<ServerSession> credit;
+    };
+
+    /// @brief 按发送队列的策略把消息加入本会话的发送队列，多路复用连接上带有 @a stream_id。
+    ///
+    /// 消息或为它腾出空间的消息被丢弃时，把它消耗的信用归还给 @a credit 的会话。
+    void Enqueue(
+        std::shared_ptr<const Message> message,
+        stream_id_type stream_id,
+        std::weak_ptr<ServerSession> credit);
+    /// @brief 归还 @a credit 的会话消耗的一个信用。
+    static void RefundCredit(const std::weak_ptr<ServerSession> &credit);
+    /// @brief 把 @a pending 加入发送队列，没有正在发送的消息时立即发送。
+    void Push(PendingWrite pending);
+
+    /// @brief 把消息的数据写入环形缓冲区并返回其描述符。
+    ///
+    /// 环形缓冲区已满时，@a block 为true则等待客户端释放空间直到 @a deadline，否则返回空指针。
+    std::shared_ptr<const SharedMemoryNotification> WriteSharedMemory(
+        const Message &message,
+        bool block,
+        std::chrono::steady_clock::time_point deadline);
+    /// @brief 发送队列是否还能容纳一条消息，调用时须持有 _queue_mutex。
+    bool HasQueueSpace() const;
+    /// @brief 等待发送队列出现空间，超时或会话关闭时返回false。
+    bool WaitForQueueSpace(
+        std::unique_lock<std::mutex> &lock,
+        std::chrono::steady_clock::time_point deadline);
+    using WriteBatch = std::vector<PendingWrite>;
+    /// @brief 以一次聚集写入发送 @a batch，完成后由回调把队列中积累的消息作为下一批发送。
+    void StartWrite(std::shared_ptr<WriteBatch> batch);
     /// @brief 允许 Server 类访问私有成员。
     friend class Server;
     /// @brief 对 Server 对象的引用。
@@ -233,6 +353,14 @@ namespace tcp {
     const size_t _session_id;
     /// @brief 流标识符，用于标识会话中传输的数据流。
     stream_id_type _stream_id = 0u;
+    /// @brief 客户端连接时是否表明能够解压数据。
+    bool _accepts_compression = false;
+    /// @brief 客户端连接时是否表明能够从组播组接收数据。
+    bool _accepts_multicast = false;
+    /// @brief 是否已通知客户端从组播组接收数据。
+    std::atomic_bool _receives_multicast{false};
+    /// @brief 接收组播的客户端断开时读取失败，客户端不会发送任何数据。
+    unsigned char _disconnect_probe = 0u;
     /// @brief 套接字类型，用于网络通信。
     socket_type _socket;
     /// @brief 会话超时时长，表示会话在多长时间内无活动将被关闭。
@@ -243,8 +371,40 @@ namespace tcp {
     boost::asio::io_context::strand _strand;
     /// @brief 会话关闭时的回调函数。
     callback_function_type _on_closed;
-    /// @brief 表示当前是否正在进行写入操作的标志。
-    bool _is_writing = false;
+    /// @brief 保护发送队列及其状态。
+    std::mutex _queue_mutex;
+    /// @brief 通知等待的写入线程发送队列出现了空间。
+    std::condition_variable _queue_space;
+    /// @brief 等待发送的消息，不包括正在发送的消息。
+    std::deque<PendingWrite> _send_queue;
+    /// @brief 正在发送的一批消息的数量，为0时没有写入操作。
+    size_t _messages_in_flight = 0u;
+    /// @brief 会话关闭后不再接受新消息。
+    bool _is_closed = false;
+    /// @brief 共享内存传输使用的环形缓冲区，使用TCP传输数据时为空。
+    ///
+    /// 会话销毁时才释放，保证并发的 Write 不会访问已解除的映射。
+    std::unique_ptr<SharedMemoryRing> _shared_memory;
+    /// @brief 本会话是否是多路复用的连接。
+    bool _is_multiplexed = false;
+    /// @brief 多路复用连接上的流的会话所属的连接，单个流的连接为空。
+    std::shared_ptr<ServerSession> _connection;
+    /// @brief 多路复用连接上订阅的流的会话打开时的回调函数。
+    callback_function_type _on_opened;
+    /// @brief 从多路复用连接读取的流ID。
+    stream_id_type _control_word = 0u;
+    /// @brief 保护 _subscriptions。
+    std::mutex _subscriptions_mutex;
+    /// @brief 多路复用连接上订阅的流的会话。
+    std::unordered_map<stream_id_type, std::shared_ptr<ServerSession>> _subscriptions;
+    /// @brief 订阅的流的数量，多路复用连接的发送队列深度按流的数量增加。
+    std::atomic_size_t _number_of_subscriptions{0u};
+    /// @brief 从多路复用连接读取的信用数。
+    uint32_t _credit_word = 0u;
+    /// @brief 客户端是否为本会话的流授予过信用。
+    std::atomic_bool _uses_credits{false};
+    /// @brief 剩余的信用，每发送一条消息消耗一个。
+    std::atomic<uint32_t> _credits{0u};
   };
 
 } // namespace tcp
@@ -0,0 +1,111 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/streaming/detail/tcp/SharedMemoryRing.h"
+
+#include "carla/Debug.h"
+#include "carla/Exception.h"
+
+#include <new>
+#include <stdexcept>
+
+namespace carla {
+namespace streaming {
+namespace detail {
+namespace tcp {
+
+  namespace ipc = boost::interprocess;
+
+  static constexpr uint64_t SHARED_MEMORY_MAGIC = 0x4341524C4153484Dull;
+
+  /// 位于共享内存起始处，之后紧跟数据区。
+  struct SharedMemoryRing::Header {
+    uint64_t magic;
+    uint64_t capacity;
+    /// 由客户端更新，此前的数据都已读出。
+    std::atomic<uint64_t> read_position;
+  };
+
+  static_assert(ATOMIC_LLONG_LOCK_FREE == 2, "shared memory ring requires lock-free 64-bit atomics");
+
+  constexpr stream_id_type SharedMemoryRing::REQUEST_FLAG;
+  constexpr uint64_t SharedMemoryRing::DEFAULT_CAPACITY;
+
+  std::unique_ptr<SharedMemoryRing> SharedMemoryRing::Create(
+      const std::string &name,
+      const uint64_t capacity) {
+    DEBUG_ASSERT(capacity > 0u);
+    // 移除上一次异常退出时残留的同名共享内存
+    ipc::shared_memory_object::remove(name.c_str());
+    ipc::shared_memory_object shared_memory(ipc::create_only, name.c_str(), ipc::read_write);
+    shared_memory.truncate(static_cast<ipc::offset_t>(sizeof(Header) + capacity));
+    std::unique_ptr<SharedMemoryRing> ring(
+        new SharedMemoryRing(name, std::move(shared_memory), true));
+    ring->_header = new (ring->_region.get_address()) Header{SHARED_MEMORY_MAGIC, capacity, {0u}};
+    ring->_data = static_cast<unsigned char *>(ring->_region.get_address()) + sizeof(Header);
+    ring->_capacity = capacity;
+    return ring;
+  }
+
+  std::unique_ptr<SharedMemoryRing> SharedMemoryRing::Open(const std::string &name) {
+    ipc::shared_memory_object shared_memory(ipc::open_only, name.c_str(), ipc::read_write);
+    std::unique_ptr<SharedMemoryRing> ring(
+        new SharedMemoryRing(name, std::move(shared_memory), false));
+    auto *header = static_cast<Header *>(ring->_region.get_address());
+    if ((ring->_region.get_size() < sizeof(Header)) ||
+        (header->magic != SHARED_MEMORY_MAGIC) ||
+        (header->capacity > ring->_region.get_size() - sizeof(Header))) {
+      throw_exception(std::runtime_error("invalid shared memory ring " + name));
+    }
+    ring->_header = header;
+    ring->_data = static_cast<unsigned char *>(ring->_region.get_address()) + sizeof(Header);
+    ring->_capacity = header->capacity;
+    return ring;
+  }
+
+  SharedMemoryRing::SharedMemoryRing(
+      std::string name,
+      ipc::shared_memory_object shared_memory,
+      const bool is_owner)
+    : _name(std::move(name)),
+      _is_owner(is_owner),
+      _shared_memory(std::move(shared_memory)),
+      _region(_shared_memory, ipc::read_write) {}
+
+  SharedMemoryRing::~SharedMemoryRing() {
+    if (_is_owner) {
+      // 已打开的映射在客户端解除映射之前仍然有效
+      ipc::shared_memory_object::remove(_name.c_str());
+    }
+  }
+
+  bool SharedMemoryRing::Reserve(const message_size_type size, uint64_t &position) const {
+    if (size > _capacity) {
+      return false;
+    }
+    position = _write_position;
+    const uint64_t offset = position % _capacity;
+    if (offset + size > _capacity) {
+      position += _capacity - offset;
+    }
+    const uint64_t read_position = _header->read_position.load(std::memory_order_acquire);
+    return position + size - read_position <= _capacity;
+  }
+
+  bool SharedMemoryRing::Read(const Descriptor &descriptor, Buffer &buffer) {
+    const uint64_t offset = descriptor.position % _capacity;
+    if ((descriptor.size == 0u) || (offset + descriptor.size > _capacity)) {
+      return false;
+    }
+    buffer.copy_from(_data + offset, descriptor.size);
+    _header->read_position.store(descriptor.position + descriptor.size, std::memory_order_release);
+    return true;
+  }
+
+} // namespace tcp
+} // namespace detail
+} // namespace streaming
+} // namespace carla
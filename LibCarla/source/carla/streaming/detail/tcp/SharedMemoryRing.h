@@ -0,0 +1,119 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/Buffer.h"
+#include "carla/NonCopyable.h"
+#include "carla/streaming/detail/Types.h"
+
+#include <boost/asio/buffer.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <boost/interprocess/shared_memory_object.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+
+namespace carla {
+namespace streaming {
+namespace detail {
+namespace tcp {
+
+  /// @class SharedMemoryRing
+  /// @brief 同一主机上服务器会话与客户端之间共享的单生产者单消费者环形缓冲区。
+  ///
+  /// 服务器会话把消息的数据写入环形缓冲区，再通过TCP连接发送一个描述符；
+  /// 客户端收到描述符后从环形缓冲区读出数据并释放相应的空间。
+  /// 读写位置单调递增，单条消息在物理上不会跨越缓冲区末尾。
+  class SharedMemoryRing : private NonCopyable {
+  public:
+
+    /// 客户端在发送的流ID中置上该位以请求共享内存传输。
+    static constexpr stream_id_type REQUEST_FLAG = 1u << 31;
+
+    /// 每个会话默认的环形缓冲区容量。
+    static constexpr uint64_t DEFAULT_CAPACITY = 32u * 1024u * 1024u;
+
+#pragma pack(push, 1)
+
+    /// 通过TCP连接发送的消息在环形缓冲区中的位置。
+    struct Descriptor {
+      uint64_t position;
+      message_size_type size;
+    };
+
+#pragma pack(pop)
+
+    /// 创建名为 @a name 的环形缓冲区，销毁时移除该共享内存。
+    static std::unique_ptr<SharedMemoryRing> Create(const std::string &name, uint64_t capacity);
+
+    /// 打开服务器创建的名为 @a name 的环形缓冲区。
+    static std::unique_ptr<SharedMemoryRing> Open(const std::string &name);
+
+    ~SharedMemoryRing();
+
+    const std::string &GetName() const {
+      return _name;
+    }
+
+    /// 把 @a buffers 依次复制到环形缓冲区中。剩余空间不足时返回false。
+    template <typename BufferSequence>
+    bool TryWrite(const BufferSequence &buffers, message_size_type size, Descriptor &descriptor) {
+      uint64_t position;
+      if (!Reserve(size, position)) {
+        return false;
+      }
+      unsigned char *destination = _data + position % _capacity;
+      for (const boost::asio::const_buffer &buffer : buffers) {
+        std::memcpy(destination, buffer.data(), buffer.size());
+        destination += buffer.size();
+      }
+      _write_position = position + size;
+      descriptor = {position, size};
+      return true;
+    }
+
+    /// 把 @a descriptor 描述的数据复制到 @a buffer 中并释放其空间。
+    /// 描述符与环形缓冲区不符时返回false。
+    bool Read(const Descriptor &descriptor, Buffer &buffer);
+
+  private:
+
+    struct Header;
+
+    SharedMemoryRing(
+        std::string name,
+        boost::interprocess::shared_memory_object shared_memory,
+        bool is_owner);
+
+    /// 为 @a size 字节的消息找到连续的空间，必要时跳过缓冲区末尾的剩余部分。
+    bool Reserve(message_size_type size, uint64_t &position) const;
+
+    const std::string _name;
+
+    const bool _is_owner;
+
+    boost::interprocess::shared_memory_object _shared_memory;
+
+    boost::interprocess::mapped_region _region;
+
+    Header *_header = nullptr;
+
+    unsigned char *_data = nullptr;
+
+    uint64_t _capacity = 0u;
+
+    /// 仅由服务器会话使用，下一条消息的起始位置。
+    uint64_t _write_position = 0u;
+  };
+
+} // namespace tcp
+} // namespace detail
+} // namespace streaming
+} // namespace carla
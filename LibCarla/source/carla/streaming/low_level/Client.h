@@ -8,10 +8,15 @@
 
 #include "carla/streaming/detail/Token.h"
 #include "carla/streaming/detail/tcp/Client.h"
+#include "carla/streaming/detail/tcp/MultiplexedClient.h"
 
 #include <boost/asio/io_context.hpp>
 
+#include <algorithm>
+#include <functional>
+#include <map>
 #include <memory>	// 引入C++标准库的内存管理头文件
+#include <mutex>
 #include <unordered_map>	// 引入C++标准库的无序映射容器头文件
 
 namespace carla {
@@ -44,23 +49,52 @@ namespace low_level {
       for (auto &pair : _clients) {
         pair.second->Stop();		// 析构函数，用于在对象销毁时清理资源，会遍历所有已订阅的客户端并调用它们的停止方法
       }
+      for (auto &pair : _connections) {
+        pair.second->Stop();
+      }
     }	
 
+    /// 启用后，之后订阅的流共用到同一服务器的一个多路复用连接，而不是每个流一个连接。
+    /// 默认不启用。同一主机上可以使用共享内存传输的流仍然使用单独的连接；多路复用连接上
+    /// 的流不使用组播，服务器不支持多路复用时改用单独的连接。
+    void SetMultiplexing(bool enable) {
+      _multiplexing = enable;
+    }
+
     /// @warning cannot subscribe twice to the same stream (even if it's a
     /// MultiStream).
+    /// @a resolver 不为空时，连接持续失败后用它重新获取令牌，例如流所在的次级服务器重启后。
+    /// @a credits 不为0时，多路复用连接上的服务器最多发送这么多条未处理的消息，见 GrantCredits。
     template <typename Functor>
     void Subscribe(
         boost::asio::io_context &io_context,
         token_type token,	// 订阅流的方法，接受io_context、令牌以及回调函数作为参数
-        Functor &&callback) {
+        Functor &&callback,
+        std::function<bool(Token &)> resolver = {},
+        uint32_t credits = 0u) {
       DEBUG_ASSERT_EQ(_clients.find(token.get_stream_id()), _clients.end());	// 断言确保当前要订阅的流ID在已订阅客户端的映射容器中不存在，即不能两次订阅同一个流
+      DEBUG_ASSERT_EQ(_multiplexed.find(token.get_stream_id()), _multiplexed.end());
       if (!token.has_address()) {
         token.set_address(_fallback_address);	// 如果传入的令牌没有地址，就将备用地址设置给令牌
       }
+      const auto ep = token.to_tcp_endpoint();
+      if (IsMultiplexed(token)) {
+        auto &connection = _connections[ep];
+        if (connection == nullptr) {
+          connection = std::make_shared<detail::tcp::MultiplexedClient>(io_context, ep);
+        }
+        connection->Subscribe(token, std::forward<Functor>(callback), MakeTokenResolver(std::move(resolver)), credits);
+        std::lock_guard<std::mutex> lock(_multiplexed_mutex);
+        _multiplexed.emplace(token.get_stream_id(), connection);
+        return;
+      }
       auto client = std::make_shared<underlying_client>(	// 创建一个底层客户端的智能指针，并通过底层客户端的构造函数进行初始化，传入io_context、令牌和回调函数
           io_context,
           token,
           std::forward<Functor>(callback));
+      if (resolver) {
+        client->SetTokenResolver(MakeTokenResolver(std::move(resolver)));
+      }
       client->Connect();	// 让客户端尝试连接到对应的流
       _clients.emplace(token.get_stream_id(), std::move(client));	// 将创建好的客户端智能指针以流ID为键存入到_clients映射容器中，以便后续管理和操作
     }
@@ -72,15 +106,102 @@ namespace low_level {
         it->second->Stop();
         _clients.erase(it);
       }
+      std::shared_ptr<detail::tcp::MultiplexedClient> connection;
+      bool in_use = false;
+      {
+        std::lock_guard<std::mutex> lock(_multiplexed_mutex);
+        auto multiplexed = _multiplexed.find(token.get_stream_id());
+        if (multiplexed != _multiplexed.end()) {
+          connection = std::move(multiplexed->second);
+          _multiplexed.erase(multiplexed);
+          // 连接上没有其他流时关闭连接
+          in_use = std::any_of(_multiplexed.begin(), _multiplexed.end(), [&](const auto &pair) {
+            return pair.second == connection;
+          });
+        }
+      }
+      if (connection != nullptr) {
+        connection->UnSubscribe(token.get_stream_id());
+        if (!in_use) {
+          connection->Stop();
+          for (auto it = _connections.begin(); it != _connections.end(); ++it) {
+            if (it->second == connection) {
+              _connections.erase(it);
+              break;
+            }
+          }
+        }
+      }
+    }
+
+    /// 订阅 @a token 的流时是否使用多路复用连接，只有这样的流支持信用。
+    bool SupportsCredits(token_type token) const {
+      if (!token.has_address()) {
+        token.set_address(_fallback_address);
+      }
+      return IsMultiplexed(token);
+    }
+
+    /// 归还 @a count 个已处理完的消息的信用，可以在回调函数的线程中调用；
+    /// 没有使用信用或不是通过多路复用连接订阅的流忽略。
+    void GrantCredits(detail::stream_id_type stream_id, uint32_t count) {
+      std::shared_ptr<detail::tcp::MultiplexedClient> connection;
+      {
+        std::lock_guard<std::mutex> lock(_multiplexed_mutex);
+        auto it = _multiplexed.find(stream_id);
+        if (it == _multiplexed.end()) {
+          return;
+        }
+        connection = it->second;
+      }
+      connection->GrantCredits(stream_id, count);
     }
 
   private:	
 
+    /// 同一主机上可以使用共享内存传输的流不使用多路复用连接，@a token 必须有地址。
+    bool IsMultiplexed(const token_type &token) const {
+      return _multiplexing && !(token.protocol_is_shared_memory() && token.to_tcp_endpoint().address().is_loopback());
+    }
+
+    /// 令牌中没有地址时使用备用地址，@a resolver 为空时返回空函数。
+    detail::tcp::Client::token_resolver_type MakeTokenResolver(std::function<bool(Token &)> resolver) const {
+      if (!resolver) {
+        return {};
+      }
+      return [resolver=std::move(resolver), fallback=_fallback_address](token_type &resolved) {
+        Token token;
+        if (!resolver(token)) {
+          return false;
+        }
+        resolved = token_type(token);
+        if (!resolved.has_address()) {
+          resolved.set_address(fallback);
+        }
+        return true;
+      };
+    }
+
     boost::asio::ip::address _fallback_address;	// 存储备用的IP地址，在构造函数中进行初始化，可能在流连接出现问题需要使用备用地址时发挥作用
 
     std::unordered_map<	// 一个无序映射容器，存储底层客户端的智能指针，用于管理和操作订阅的各个流对应的客户端
         detail::stream_id_type,
         std::shared_ptr<underlying_client>> _clients;
+
+    bool _multiplexing = false;
+
+    /// 每个服务器端点的多路复用连接。
+    std::map<
+        detail::tcp::MultiplexedClient::endpoint,
+        std::shared_ptr<detail::tcp::MultiplexedClient>> _connections;
+
+    /// 保护 _multiplexed，GrantCredits 在回调函数的线程中调用。
+    std::mutex _multiplexed_mutex;
+
+    /// 通过多路复用连接订阅的流。
+    std::unordered_map<
+        detail::stream_id_type,
+        std::shared_ptr<detail::tcp::MultiplexedClient>> _multiplexed;
   };
 
 } // namespace low_level
@@ -7,11 +7,15 @@
 #pragma once
 
 #include "carla/streaming/detail/Dispatcher.h" // 引入 Dispatcher 头文件
+#include "carla/streaming/detail/Multicast.h"  // 引入组播发送的定义
 #include "carla/streaming/detail/Types.h"      // 引入类型定义头文件
 #include "carla/streaming/Stream.h"            // 引入 Stream 头文件
 
 #include <boost/asio/io_context.hpp>           // 引入 Boost.Asio 的 IO 上下文头文件
 
+#include <memory>
+#include <string>
+
 namespace carla {
 namespace streaming {
 namespace low_level {
@@ -38,7 +42,8 @@ namespace low_level {
         boost::asio::io_context &io_context, // 输入 IO 上下文引用
         detail::EndPoint<protocol_type, InternalEPType> internal_ep, // 内部端点
         detail::EndPoint<protocol_type, ExternalEPType> external_ep) // 外部端点
-      : _server(io_context, std::move(internal_ep)), // 初始化底层服务器
+      : _io_context(io_context),
+        _server(io_context, std::move(internal_ep)), // 初始化底层服务器
         _dispatcher(std::move(external_ep)) { // 初始化调度器
       StartServer(); // 启动服务器
     }
@@ -48,7 +53,8 @@ namespace low_level {
     explicit Server(
         boost::asio::io_context &io_context, // 输入 IO 上下文引用
         detail::EndPoint<protocol_type, InternalEPType> internal_ep) // 内部端点
-      : _server(io_context, std::move(internal_ep)), // 初始化底层服务器
+      : _io_context(io_context),
+        _server(io_context, std::move(internal_ep)), // 初始化底层服务器
         _dispatcher(make_endpoint<protocol_type>(_server.GetLocalEndpoint().port())) { // 创建调度器
       StartServer(); // 启动服务器
     }
@@ -83,6 +89,18 @@ namespace low_level {
       _server.SetSynchronousMode(is_synchro); // 设置底层服务器的同步模式
     }
 
+    // 设置每个会话的发送队列深度、异步模式下队列满时的处理策略和等待队列空间的超时
+    void SetSendQueue(size_t depth, detail::tcp::SendQueuePolicy policy, time_duration timeout) {
+      _server.SetSendQueue(depth, policy, timeout);
+    }
+
+    // 允许同一主机上的客户端经共享内存接收数据，每个会话使用容量为 capacity 字节的环形缓冲区，
+    // 只对之后创建的流有效
+    void EnableSharedMemory(uint64_t capacity) {
+      _server.SetSharedMemoryCapacity(capacity);
+      _dispatcher.EnableSharedMemory();
+    }
+
     // 获取流的令牌
     token_type GetToken(stream_id sensor_id) {
       return _dispatcher.GetToken(sensor_id); // 从调度器获取流的令牌
@@ -98,6 +116,24 @@ namespace low_level {
       _dispatcher.DisableForROS(sensor_id); // 调用调度器禁用流
     }
 
+    // 设置指定流的数据在发送给能够解压的客户端之前使用的压缩方式
+    void SetStreamCodec(stream_id sensor_id, detail::StreamCodec codec) {
+      _dispatcher.SetStreamCodec(sensor_id, codec);
+    }
+
+    // 设置指定流的数据发送到的组播组，同一局域网上的所有订阅者共享一次发送。
+    // @a address 为空时停止组播，数据重新通过各个客户端的连接发送
+    void SetStreamMulticast(stream_id sensor_id, const std::string &address, uint16_t port) {
+      std::shared_ptr<detail::multicast::Sender> multicast;
+      if (!address.empty()) {
+        multicast = std::make_shared<detail::multicast::Sender>(
+            _io_context,
+            sensor_id,
+            boost::asio::ip::udp::endpoint(make_address(address), port));
+      }
+      _dispatcher.SetStreamMulticast(sensor_id, std::move(multicast));
+    }
+
     // 检查指定流是否为 ROS 启用
     bool IsEnabledForROS(stream_id sensor_id) {
       return _dispatcher.IsEnabledForROS(sensor_id); // 调用调度器检查流状态
@@ -121,6 +157,8 @@ namespace low_level {
       _server.Listen(on_session_opened, on_session_closed); // 开始监听会话
     }
 
+    boost::asio::io_context &_io_context; // 组播的数据报也在这里异步发送
+
     underlying_server _server; // 底层服务器实例
 
     detail::Dispatcher _dispatcher; // 调度器实例
@@ -28,7 +28,8 @@ ALSM::ALSM(
   CollisionStage &collision_stage,//碰撞检测模块
   TrafficLightStage &traffic_light_stage, //交通信号灯控制模块
   MotionPlanStage &motion_plan_stage, //运动规划模块
-  VehicleLightStage &vehicle_light_stage) //车辆灯光控制模块
+  VehicleLightStage &vehicle_light_stage, //车辆灯光控制模块
+  AgentPluginStage &agent_plugin_stage) //驾驶策略插件模块
   : registered_vehicles(registered_vehicles), //初始化已注册车辆
     buffer_map(buffer_map), //初始化路径缓存
     track_traffic(track_traffic), //初始化交通追踪器
@@ -41,7 +42,8 @@ ALSM::ALSM(
     collision_stage(collision_stage), //初始化碰撞检测模块
     traffic_light_stage(traffic_light_stage), //初始化交通信号灯控制模块
     motion_plan_stage(motion_plan_stage), //初始化运动规划模块
-    vehicle_light_stage(vehicle_light_stage) {} //初始化车辆灯光控制模块
+    vehicle_light_stage(vehicle_light_stage), //初始化车辆灯光控制模块
+    agent_plugin_stage(agent_plugin_stage) {} //初始化驾驶策略插件模块
 
 void ALSM::Update() {
   //获取是否启用混合物理模式参数
@@ -52,11 +54,13 @@ void ALSM::Update() {
   //存储待删除的未注册参与者的 ID 列表
   std::vector<ActorId> unregistered_list_to_be_deleted;
 
-  current_timestamp = world.GetSnapshot().GetTimestamp(); //获取当前时间截
-  ActorList world_actors = world.GetActors();//获取当前世界中的所有参与者列表
+  // 世界快照已在客户端缓存，只需与上一帧的参与者集合比较即可得知增删的参与者，
+  // 无需每一帧都构造完整的参与者列表
+  const cc::WorldSnapshot world_snapshot = world.GetSnapshot();
+  current_timestamp = world_snapshot.GetTimestamp(); //获取当前时间截
 
   // 找到已经销毁的参与者并进行清理
-  const ALSM::DestroyeddActors destroyed_actors = IdentifyDestroyedActors(world_actors);
+  const ALSM::DestroyeddActors destroyed_actors = IdentifyDestroyedActors(world_snapshot);
   
   //处理已注册的被销毁的参与者
   const ActorIdSet &destroyed_registered = destroyed_actors.first;
@@ -91,7 +95,7 @@ void ALSM::Update() {
   }
 
   // 扫描并识别新的未注册参与者
-  IdentifyNewActors(world_actors);
+  IdentifyNewActors(world_snapshot);
 
   // 更新所有已注册的车辆的动态状态和静态属性
   ALSM::IdleInfo max_idle_time = std::make_pair(0u, current_timestamp.elapsed_seconds);
@@ -123,8 +127,21 @@ void ALSM::Update() {
 }
 
 //识别新的参与者
-void ALSM::IdentifyNewActors(const ActorList &actor_list) {
-    //遍历传入的参与者列表
+void ALSM::IdentifyNewActors(const cc::WorldSnapshot &world_snapshot) {
+  // 找出上一帧之后才出现的参与者
+  std::vector<ActorId> new_actor_ids;
+  for (const cc::ActorSnapshot &actor_snapshot : world_snapshot) {
+    if (known_actors.insert(actor_snapshot.id).second) {
+      new_actor_ids.push_back(actor_snapshot.id);
+    }
+  }
+  if (new_actor_ids.empty()) {
+    return;
+  }
+
+  // 只获取新出现的参与者
+  const ActorList actor_list = world.GetActors(new_actor_ids);
+    //遍历新参与者列表
   for (auto iter = actor_list->begin(); iter != actor_list->end(); ++iter) {
     ActorPtr actor = *iter; //获取当前的参与者对象
     ActorId actor_id = actor->GetId(); //获取当前参与者的唯一标识符（ID）
@@ -142,8 +159,11 @@ void ALSM::IdentifyNewActors(const ActorList &actor_list) {
       }
     }
   }
-    //如果该参与者不在已注册车辆列表中，且不在未注册的参与者列表中
-    if (!registered_vehicles.Contains(actor_id)
+    //如果该参与者是车辆或行人，不在已注册车辆列表中，且不在未注册的参与者列表中
+    //其余参与者（静态道具、传感器等）不参与交通管理的计算，无需每一帧更新
+    const char type_initial = actor->GetTypeId().front();
+    if ((type_initial == 'v' || type_initial == 'w')
+        && !registered_vehicles.Contains(actor_id)
         && unregistered_actors.find(actor_id) == unregistered_actors.end()) {
       //将该参与者添加到未注册参与者中
       unregistered_actors.insert({actor_id, actor});
@@ -152,23 +172,26 @@ void ALSM::IdentifyNewActors(const ActorList &actor_list) {
 }
 
 //识别已销毁的参与者
-ALSM::DestroyeddActors ALSM::IdentifyDestroyedActors(const ActorList &actor_list) {
+ALSM::DestroyeddActors ALSM::IdentifyDestroyedActors(const cc::WorldSnapshot &world_snapshot) {
 
   ALSM::DestroyeddActors destroyed_actors; //用于存储销毁的参与者 ID
   ActorIdSet &deleted_registered = destroyed_actors.first; //存储已销毁的注册车辆的 ID
   ActorIdSet &deleted_unregistered = destroyed_actors.second; //存储已销毁的未注册参与者的 ID
 
-  //构建当前帧中存在的参与者的哈希集合
-  ActorIdSet current_actors;
-  for  (auto iter = actor_list->begin(); iter != actor_list->end(); ++iter) {
-    current_actors.insert((*iter)->GetId()); //将当前参与者的 ID 插入集合中
+  //忘记已经离开世界的参与者
+  for (auto iter = known_actors.begin(); iter != known_actors.end();) {
+    if (!world_snapshot.Contains(*iter)) {
+      iter = known_actors.erase(iter);
+    } else {
+      ++iter;
+    }
   }
 
   // 查找被销毁的已注册车辆
   std::vector<ActorId> registered_ids = registered_vehicles.GetIDList();
   for (const ActorId &actor_id : registered_ids) {
     //如果当前帧中不存在某个已注册车辆
-    if (current_actors.find(actor_id) == current_actors.end()) {
+    if (!world_snapshot.Contains(actor_id)) {
         //将该车辆的 ID 加入到已销毁的注册车辆列表中
       deleted_registered.insert(actor_id);
     }
@@ -178,7 +201,7 @@ ALSM::DestroyeddActors ALSM::IdentifyDestroyedActors(const ActorList &actor_list
   for (const auto &actor_info: unregistered_actors) {
     const ActorId &actor_id = actor_info.first;
     //如果当前帧中不存在某个未注册的参与者，或者该参与者已经注册为车辆
-     if (current_actors.find(actor_id) == current_actors.end()
+     if (!world_snapshot.Contains(actor_id)
          || registered_vehicles.Contains(actor_id)) {
       //将该参与者的 ID 加入到已销毁的未注册参与者列表中
       deleted_unregistered.insert(actor_id);
@@ -436,6 +459,7 @@ void ALSM::RemoveActor(const ActorId actor_id, const bool registered_actor) {
     traffic_light_stage.RemoveActor(actor_id);
     motion_plan_stage.RemoveActor(actor_id);
     vehicle_light_stage.RemoveActor(actor_id);
+    agent_plugin_stage.RemoveActor(actor_id);
   }
   else {
     // 如果参与者未注册，则从未注册参与者和英雄参与者集合中移除
@@ -443,6 +467,9 @@ void ALSM::RemoveActor(const ActorId actor_id, const bool registered_actor) {
     hero_actors.erase(actor_id);
   }
 
+  // 若参与者仍在世界中（例如被取消注册），下一帧会重新被识别为新参与者
+  known_actors.erase(actor_id);
+
   //从交通监控系统中删除参与者
   track_traffic.DeleteActor(actor_id);
   // 从仿真状态中移除参与者
@@ -453,11 +480,22 @@ void ALSM::RemoveActor(const ActorId actor_id, const bool registered_actor) {
 void ALSM::Reset() {
   // 清空未注册参与者、空闲时间、英雄参与者等数据
   unregistered_actors.clear();
+  known_actors.clear();
   idle_time.clear();
   hero_actors.clear();
   elapsed_last_actor_destruction = 0.0; // 重置上次参与者销毁的时间
   current_timestamp = world.GetSnapshot().GetTimestamp(); // 更新当前时间截
 }
 
+void ALSM::GetHeroLocations(std::vector<cg::Location> &locations) const {
+  locations.clear();
+  for (auto &hero_actor_info: hero_actors) {
+    // 刚生成的英雄车辆可能还没有状态条目
+    if (simulation_state.ContainsActor(hero_actor_info.first)) {
+      locations.push_back(simulation_state.GetLocation(hero_actor_info.first));
+    }
+  }
+}
+
 } // namespace traffic_manager
 } // namespace carla
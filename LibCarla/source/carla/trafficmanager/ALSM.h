@@ -6,8 +6,10 @@
 #include "carla/client/ActorList.h"
 #include "carla/client/Timestamp.h"
 #include "carla/client/World.h"
+#include "carla/client/WorldSnapshot.h"
 #include "carla/Memory.h"
 
+#include "carla/trafficmanager/AgentPluginStage.h"
 #include "carla/trafficmanager/AtomicActorSet.h"
 #include "carla/trafficmanager/CollisionStage.h"
 #include "carla/trafficmanager/DataStructures.h"
@@ -30,8 +32,8 @@ namespace chr = std::chrono;  // 引用时间相关的命名空间
 namespace cg = carla::geom;   // 引用几何相关的命名空间
 namespace cc = carla::client;  // 引用客户端相关的命名空间
 
-using ParticipantList = carla::SharedPtr<cc::ActorList>; // 定义参与者列表共享指针类型
-using ParticipantMap = std::unordered_map<ActorId, ActorPtr>; // 定义参与者映射表类型
+using ActorList = carla::SharedPtr<cc::ActorList>; // 定义参与者列表共享指针类型
+using ActorMap = std::unordered_map<ActorId, ActorPtr>; // 定义参与者映射表类型
 using IdleTimeMap = std::unordered_map<ActorId, double>; // 定义闲置时间映射表类型
 using LocalMapPtr = std::shared_ptr<InMemoryMap>; // 定义本地地图共享指针类型
 
@@ -42,10 +44,11 @@ class ALSM {
 
 private:
   AtomicActorSet &registered_vehicles; // 引用已注册参与者的原子集合
-  ParticipantMap unregistered_participants; // 存储未注册参与者的结构
+  ActorMap unregistered_actors; // 存储未注册参与者的结构
+  ActorIdSet known_actors; // 上一帧世界中已识别的全部参与者，用于逐帧比较参与者集合的变化
   BufferMap &buffer_map; // 引用缓冲区映射
   IdleTimeMap idle_time; // 存储参与者在位置上停留时间的结构
-  ParticipantMap hero_participants; // 存储角色名称为"hero"的参与者
+  ActorMap hero_actors; // 存储角色名称为"hero"的参与者
   TrackTraffic &track_traffic; // 引用交通跟踪对象
   std::vector<ActorId>& marked_for_removal; // 标记待移除参与者的数组
   const Parameters &parameters; // 引用参数对象
@@ -57,7 +60,8 @@ private:
   TrafficLightStage &traffic_light_stage; // 引用交通灯阶段对象
   MotionPlanStage &motion_plan_stage; // 引用运动规划阶段对象
   VehicleLightStage &vehicle_light_stage; // 引用车辆灯光阶段对象
-  double elapsed_last_participant_destruction {0.0}; // 记录自上次因闲置过久而销毁参与者的时间
+  AgentPluginStage &agent_plugin_stage; // 引用驾驶策略插件阶段对象
+  double elapsed_last_actor_destruction {0.0}; // 记录自上次因闲置过久而销毁参与者的时间
   cc::Timestamp current_timestamp; // 当前时间戳
   std::unordered_map<ActorId, bool> has_physics_enabled; // 存储每个参与者是否启用物理的映射
 
@@ -68,22 +72,22 @@ private:
   bool IsVehicleStuck(const ActorId& actor_id);
 
   // 确定自上次更新以来在仿真中新生成的参与者
-  void IdentifyNewParticipants(const ParticipantList &participant_list);
+  void IdentifyNewActors(const cc::WorldSnapshot &world_snapshot);
 
-  using DestroyeddParticipants = std::pair<ActorIdSet, ActorIdSet>; // 定义删除参与者的数据类型
+  using DestroyeddActors = std::pair<ActorIdSet, ActorIdSet>; // 定义删除参与者的数据类型
   // 确定在上一帧中删除的参与者
   // 返回已注册和未注册参与者的数组
-  DestroyeddParticipants IdentifyDestroyedParticipants(const ParticipantList &participant_list);
+  DestroyeddActors IdentifyDestroyedActors(const cc::WorldSnapshot &world_snapshot);
 
   using IdleInfo = std::pair<ActorId, double>; // 定义闲置信息的数据类型
-  void UpdateRegisteredParticipantsData(const bool hybrid_physics_mode, IdleInfo &max_idle_time);
+  void UpdateRegisteredActorsData(const bool hybrid_physics_mode, IdleInfo &max_idle_time);
 
   // 更新参与者数据
   void UpdateData(const bool hybrid_physics_mode, const Actor &vehicle,
                   const bool hero_actor_present, const float physics_radius_square);
 
   // 更新未注册参与者的数据
-  void UpdateUnregisteredParticipantsData();
+  void UpdateUnregisteredActorsData();
 
 public:
   // 构造函数
@@ -99,14 +103,20 @@ public:
        CollisionStage &collision_stage,
        TrafficLightStage &traffic_light_stage,
        MotionPlanStage &motion_plan_stage,
-       VehicleLightStage &vehicle_light_stage);
+       VehicleLightStage &vehicle_light_stage,
+       AgentPluginStage &agent_plugin_stage);
 
   // 更新方法
   void Update();
 
   // 从交通管理中移除参与者，并清理与该车辆相关的各种数据
-  void RemoveParticipant(const ActorId actor_id, const bool registered_actor);
+  void RemoveActor(const ActorId actor_id, const bool registered_actor);
 
   // 重置方法
   void Reset();
-};
\ No newline at end of file
+
+  // 将仍存在于仿真状态中的英雄车辆的位置写入 @a locations
+  void GetHeroLocations(std::vector<cg::Location> &locations) const;
+};
+} // namespace traffic_manager
+} // namespace carla
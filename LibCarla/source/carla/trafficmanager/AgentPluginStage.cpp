@@ -0,0 +1,199 @@
+// Copyright (c) 2026 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/trafficmanager/AgentPluginStage.h"
+
+#include "carla/Logging.h"
+
+#include <exception>
+
+#ifdef _WIN32
+#  include <windows.h>
+#else
+#  include <dlfcn.h>
+#endif // _WIN32
+
+namespace carla {
+namespace traffic_manager {
+
+namespace {
+
+  /// 打开共享库并取得注册函数，失败时记录警告并返回空指针
+  std::shared_ptr<void> OpenLibrary(const std::string &path, AgentPluginEntryFunction &entry) {
+#ifdef _WIN32
+    HMODULE handle = LoadLibraryA(path.c_str());
+    if (handle == nullptr) {
+      log_warning("traffic manager: unable to load agent plugin", path, "error", GetLastError());
+      return nullptr;
+    }
+    std::shared_ptr<void> library(handle, [](void *ptr) { FreeLibrary(static_cast<HMODULE>(ptr)); });
+    entry = reinterpret_cast<AgentPluginEntryFunction>(GetProcAddress(handle, CARLA_TM_AGENT_PLUGIN_ENTRY));
+#else
+    void *handle = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+    if (handle == nullptr) {
+      log_warning("traffic manager: unable to load agent plugin", path, ":", dlerror());
+      return nullptr;
+    }
+    std::shared_ptr<void> library(handle, [](void *ptr) { dlclose(ptr); });
+    entry = reinterpret_cast<AgentPluginEntryFunction>(dlsym(handle, CARLA_TM_AGENT_PLUGIN_ENTRY));
+#endif // _WIN32
+    if (entry == nullptr) {
+      log_warning("traffic manager: agent plugin", path, "does not export", CARLA_TM_AGENT_PLUGIN_ENTRY);
+      return nullptr;
+    }
+    return library;
+  }
+
+} // namespace
+
+AgentPluginStage::AgentPluginStage(
+  const std::vector<ActorId> &vehicle_id_list,
+  const SimulationState &simulation_state,
+  const BufferMap &buffer_map,
+  const LocalizationFrame &localization_frame,
+  const CollisionFrame &collision_frame,
+  const TLFrame &tl_frame,
+  ControlFrame &control_frame)
+  : vehicle_id_list(vehicle_id_list),
+    simulation_state(simulation_state),
+    buffer_map(buffer_map),
+    localization_frame(localization_frame),
+    collision_frame(collision_frame),
+    tl_frame(tl_frame),
+    control_frame(control_frame) {}
+
+AgentPluginStage::~AgentPluginStage() {
+  // 策略对象的代码在共享库中，须在卸载共享库之前销毁
+  step_assignments.clear();
+  assignments.clear();
+  policies.clear();
+  libraries.clear();
+}
+
+std::vector<std::string> AgentPluginStage::LoadPlugin(const std::string &path) {
+  AgentPluginEntryFunction entry = nullptr;
+  std::shared_ptr<void> library = OpenLibrary(path, entry);
+  if (library == nullptr) {
+    return {};
+  }
+  AgentPolicyRegistry registry;
+  try {
+    entry(registry);
+  } catch (const std::exception &e) {
+    log_warning("traffic manager: agent plugin", path, "failed to register policies:", e.what());
+    return {};
+  }
+
+  std::vector<std::string> names;
+  std::lock_guard<std::mutex> lock(mutex);
+  libraries.emplace_back(std::move(library));
+  for (auto &pair : registry.policies) {
+    if (pair.second != nullptr) {
+      names.emplace_back(pair.first);
+      policies[pair.first] = std::move(pair.second);
+    }
+  }
+  return names;
+}
+
+bool AgentPluginStage::SetPolicy(const ActorId actor_id, const std::string &policy) {
+  std::shared_ptr<AgentPolicy> previous;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::shared_ptr<AgentPolicy> next;
+    if (!policy.empty()) {
+      auto it = policies.find(policy);
+      if (it == policies.end()) {
+        log_warning("traffic manager: unknown agent policy", policy);
+        return false;
+      }
+      next = it->second;
+    }
+    auto assignment = assignments.find(actor_id);
+    if (assignment != assignments.end()) {
+      previous = std::move(assignment->second);
+      assignments.erase(assignment);
+    }
+    if (next != nullptr) {
+      assignments.emplace(actor_id, next);
+    }
+    if (previous == next) {
+      // 策略没有改变，不需要通知
+      previous = nullptr;
+    }
+    ++assignments_version;
+  }
+  // 与 RemoveActor 一样在锁外通知原来的策略，它可以释放这辆车的状态
+  if (previous != nullptr) {
+    previous->RemoveActor(actor_id);
+  }
+  return true;
+}
+
+void AgentPluginStage::PrepareStep() {
+  std::lock_guard<std::mutex> lock(mutex);
+  if (step_assignments_version != assignments_version) {
+    step_assignments = assignments;
+    step_assignments_version = assignments_version;
+  }
+}
+
+void AgentPluginStage::Update(const unsigned long index) {
+  const ActorId actor_id = vehicle_id_list.at(index);
+  auto it = step_assignments.find(actor_id);
+  auto buffer = buffer_map.find(actor_id);
+  if (it == step_assignments.end() || buffer == buffer_map.end()) {
+    return;
+  }
+  const AgentPolicyInput input{
+      actor_id,
+      index,
+      simulation_state,
+      localization_frame.at(index),
+      collision_frame.at(index),
+      tl_frame.at(index),
+      buffer->second};
+  rpc::Command command = control_frame.at(index);
+  try {
+    if (it->second->Update(input, command)) {
+      control_frame[index] = std::move(command);
+    }
+  } catch (const std::exception &e) {
+    // 策略出错时沿用交通管理器的命令，不影响其他车辆
+    log_warning("traffic manager: agent policy failed for actor", actor_id, ":", e.what());
+  }
+}
+
+void AgentPluginStage::RemoveActor(const ActorId actor_id) {
+  std::shared_ptr<AgentPolicy> policy;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = assignments.find(actor_id);
+    if (it != assignments.end()) {
+      policy = std::move(it->second);
+      assignments.erase(it);
+      ++assignments_version;
+    }
+  }
+  step_assignments.erase(actor_id);
+  if (policy != nullptr) {
+    policy->RemoveActor(actor_id);
+  }
+}
+
+void AgentPluginStage::Reset() {
+  std::unordered_map<std::string, std::shared_ptr<AgentPolicy>> all_policies;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    all_policies = policies;
+  }
+  for (auto &pair : all_policies) {
+    pair.second->Reset();
+  }
+}
+
+} // namespace traffic_manager
+} // namespace carla
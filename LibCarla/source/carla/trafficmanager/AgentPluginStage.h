@@ -0,0 +1,86 @@
+// Copyright (c) 2026 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "carla/trafficmanager/AgentPolicy.h"
+#include "carla/trafficmanager/DataStructures.h"
+#include "carla/trafficmanager/SimulationState.h"
+#include "carla/trafficmanager/Stage.h"
+
+namespace carla {
+namespace traffic_manager {
+
+/// AgentPluginStage类在交通管理器的工作线程中运行插件提供的驾驶策略
+///
+/// 插件是导出 CARLA_TM_AGENT_PLUGIN_ENTRY 函数的共享库，加载后注册的策略可以按车辆指定。
+/// 策略在运动规划阶段之后运行，读取本步的定位、碰撞和交通灯阶段的输出，
+/// 修改或替换该车在控制帧中的命令；没有指定策略的车辆不受影响。
+class AgentPluginStage: Stage {
+private:
+  const std::vector<ActorId> &vehicle_id_list; // 车辆ID列表的引用
+  const SimulationState &simulation_state; // 仿真状态的引用
+  const BufferMap &buffer_map; // 各车辆路径点缓冲区的引用
+  const LocalizationFrame &localization_frame; // 定位阶段输出的引用
+  const CollisionFrame &collision_frame; // 碰撞阶段输出的引用
+  const TLFrame &tl_frame; // 交通灯阶段输出的引用
+  ControlFrame &control_frame; // 控制帧的引用，策略的输出写入其中
+
+  /// 保护已加载的插件、策略和车辆的策略指定，它们可以在其他线程中修改
+  mutable std::mutex mutex;
+  /// 已加载的共享库的句柄，在析构时卸载
+  std::vector<std::shared_ptr<void>> libraries;
+  /// 已注册的策略
+  std::unordered_map<std::string, std::shared_ptr<AgentPolicy>> policies;
+  /// 各车辆指定的策略
+  std::unordered_map<ActorId, std::shared_ptr<AgentPolicy>> assignments;
+  /// assignments 修改后加一
+  uint64_t assignments_version = 0u;
+
+  /// 本步使用的策略指定，在 PrepareStep 中复制，Update 中不需要加锁
+  std::unordered_map<ActorId, std::shared_ptr<AgentPolicy>> step_assignments;
+  uint64_t step_assignments_version = 0u;
+
+public:
+  AgentPluginStage(const std::vector<ActorId> &vehicle_id_list,
+                   const SimulationState &simulation_state,
+                   const BufferMap &buffer_map,
+                   const LocalizationFrame &localization_frame,
+                   const CollisionFrame &collision_frame,
+                   const TLFrame &tl_frame,
+                   ControlFrame &control_frame);
+
+  ~AgentPluginStage();
+
+  /// 加载 @a path 处的插件，返回它注册的策略的名字；加载失败时记录警告并返回空列表
+  std::vector<std::string> LoadPlugin(const std::string &path);
+
+  /// 指定车辆使用名为 @a policy 的策略，为空时恢复由交通管理器控制；返回策略是否存在
+  bool SetPolicy(const ActorId actor_id, const std::string &policy);
+
+  /// 在每步运行策略之前调用，取得最新的策略指定
+  void PrepareStep();
+
+  /// 本步是否有车辆使用策略
+  bool HasPolicies() const {
+    return !step_assignments.empty();
+  }
+
+  void Update(const unsigned long index) override; // 对指定了策略的车辆运行策略
+
+  void RemoveActor(const ActorId actor_id) override; // 通知车辆的策略该车辆已被移除，并取消该车的策略指定
+
+  void Reset() override; // 重置所有策略中按车辆保存的状态，策略的指定保持不变
+};
+
+} // namespace traffic_manager
+} // namespace carla
@@ -0,0 +1,90 @@
+// Copyright (c) 2026 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include "carla/rpc/Command.h"
+#include "carla/trafficmanager/DataStructures.h"
+#include "carla/trafficmanager/SimulationState.h"
+
+/// 插件共享库导出的注册函数的名字，函数的签名为 AgentPluginEntryFunction
+#define CARLA_TM_AGENT_PLUGIN_ENTRY "carla_tm_register_agent_policies"
+
+#ifdef _WIN32
+#  define CARLA_TM_AGENT_PLUGIN_EXPORT extern "C" __declspec(dllexport)
+#else
+#  define CARLA_TM_AGENT_PLUGIN_EXPORT extern "C" __attribute__((visibility("default")))
+#endif // _WIN32
+
+namespace carla {
+namespace traffic_manager {
+
+/// 交通管理器在本步为一辆车计算出的状态，交给该车的驾驶策略
+struct AgentPolicyInput {
+  /// 车辆的ID
+  ActorId actor_id;
+  /// 车辆在本步各阶段通信帧中的索引
+  unsigned long index;
+  /// 本步所有参与者的状态
+  const SimulationState &simulation_state;
+  /// 定位阶段的输出
+  const LocalizationData &localization;
+  /// 碰撞阶段的输出
+  const CollisionHazardData &collision_hazard;
+  /// 交通灯阶段的输出，为true时车辆前方有红灯或停车标志
+  bool traffic_light_hazard;
+  /// 车辆前方的路径点
+  const Buffer &waypoint_buffer;
+};
+
+/// @brief 在交通管理器的工作线程中为每辆车计算控制命令的驾驶策略。
+///
+/// 一个策略对象服务于所有指定使用它的车辆，每步对每辆车调用一次 Update，
+/// 需要按车辆保存的状态由策略自己以 actor_id 为键保存。
+class AgentPolicy {
+public:
+
+  virtual ~AgentPolicy() = default;
+
+  /// 计算车辆本步的控制命令。@a command 中是交通管理器自己计算的命令，
+  /// 策略可以修改或替换它；返回false时丢弃修改，使用交通管理器的命令。
+  virtual bool Update(const AgentPolicyInput &input, rpc::Command &command) = 0;
+
+  /// 车辆不再由交通管理器控制或不再使用该策略
+  virtual void RemoveActor(const ActorId /*actor_id*/) {}
+
+  /// 交通管理器停止或重置
+  virtual void Reset() {}
+};
+
+/// 插件在其中注册驾驶策略
+class AgentPolicyRegistry {
+public:
+
+  /// 注册名为 @a name 的策略，同名的策略被替换
+  void Register(const std::string &name, std::shared_ptr<AgentPolicy> policy) {
+    policies[name] = std::move(policy);
+  }
+
+  std::unordered_map<std::string, std::shared_ptr<AgentPolicy>> policies;
+};
+
+/// 插件共享库导出的注册函数。插件须使用与交通管理器相同的编译器和 LibCarla 头文件编译，例如：
+///
+/// @code
+/// CARLA_TM_AGENT_PLUGIN_EXPORT void carla_tm_register_agent_policies(
+///     carla::traffic_manager::AgentPolicyRegistry &registry) {
+///   registry.Register("my_policy", std::make_shared<MyPolicy>());
+/// }
+/// @endcode
+using AgentPluginEntryFunction = void (*)(AgentPolicyRegistry &registry);
+
+} // namespace traffic_manager
+} // namespace carla
@@ -0,0 +1,86 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/trafficmanager/BatchSender.h"
+
+namespace carla {
+namespace traffic_manager {
+
+BatchSender::BatchSender(SendFunction send_function)
+  : _send_function(std::move(send_function)) {
+  _thread.CreateThread([this]() { SenderLoop(); });
+}
+
+BatchSender::~BatchSender() {
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _stop = true;
+  }
+  _batch_ready.notify_one();
+  _thread.JoinAll();
+}
+
+void BatchSender::Submit(Commands &commands) {
+  {
+    std::unique_lock<std::mutex> lock(_mutex);
+    _batch_done.wait(lock, [this]() { return !_busy; });
+    RethrowPendingException();
+    _pending.swap(commands);
+    _busy = true;
+  }
+  _batch_ready.notify_one();
+}
+
+void BatchSender::WaitIdle() {
+  std::unique_lock<std::mutex> lock(_mutex);
+  _batch_done.wait(lock, [this]() { return !_busy; });
+  RethrowPendingException();
+}
+
+void BatchSender::RethrowPendingException() {
+  if (_exception) {
+    std::exception_ptr exception = _exception;
+    _exception = nullptr;
+    std::rethrow_exception(exception);
+  }
+}
+
+void BatchSender::SenderLoop() {
+  Commands commands;
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(_mutex);
+      _batch_ready.wait(lock, [this]() { return _stop || _busy; });
+      if (!_busy) {
+        return;
+      }
+      // 取出待发送的批次，发送期间调用线程可以继续填充自己的缓冲区
+      commands.swap(_pending);
+    }
+
+    std::exception_ptr exception;
+    try {
+      _send_function(commands);
+    } catch (...) {
+      exception = std::current_exception();
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      // 已发送的缓冲区交还给下一次提交，保留其容量
+      commands.clear();
+      commands.swap(_pending);
+      if (exception && !_exception) {
+        _exception = exception;
+      }
+      _busy = false;
+    }
+    _batch_done.notify_one();
+  }
+}
+
+} // namespace traffic_manager
+} // namespace carla
@@ -0,0 +1,71 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+#include "carla/NonCopyable.h"
+#include "carla/ThreadGroup.h"
+#include "carla/rpc/Command.h"
+
+namespace carla {
+namespace traffic_manager {
+
+  /**
+   * @class BatchSender
+   * @brief 在独立线程上发送控制命令批次，使RPC往返与下一步的计算重叠。
+   *
+   * 同一时刻最多只有一个批次在发送中：提交新批次时若上一批次尚未发送完毕，
+   * 调用线程会等待，因此命令相对于计算最多延迟一步。
+   * 发送线程抛出的异常会在下一次 Submit 或 WaitIdle 时于调用线程重新抛出。
+   */
+  class BatchSender : private NonCopyable {
+  public:
+
+    using Commands = std::vector<carla::rpc::Command>;
+    using SendFunction = std::function<void(Commands &)>;
+
+    explicit BatchSender(SendFunction send_function);
+
+    ~BatchSender();
+
+    /// 等待上一批次发送完毕后提交 @a commands。
+    ///
+    /// 提交时与内部缓冲区交换内容而不复制，返回后 @a commands 中是一段可复用的旧缓冲区。
+    void Submit(Commands &commands);
+
+    /// 等待已提交的批次发送完毕。
+    void WaitIdle();
+
+  private:
+
+    void SenderLoop();
+
+    /// 调用时须持有 _mutex。
+    void RethrowPendingException();
+
+    SendFunction _send_function;
+
+    ThreadGroup _thread;
+
+    std::mutex _mutex;
+    /// 通知发送线程有新批次或需要退出。
+    std::condition_variable _batch_ready;
+    /// 通知调用线程当前批次已发送完毕。
+    std::condition_variable _batch_done;
+    bool _stop = false;
+    bool _busy = false;
+    Commands _pending;
+    std::exception_ptr _exception;
+  };
+
+} // namespace traffic_manager
+} // namespace carla
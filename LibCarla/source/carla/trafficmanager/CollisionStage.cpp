@@ -1,4 +1,7 @@
 
+#include <algorithm>
+#include <cmath>
+
 #include "carla/geom/Math.h"
 
 #include "carla/trafficmanager/Constants.h"
@@ -41,47 +44,19 @@ void CollisionStage::Update(const unsigned long index) {
   // 获取当前车辆的ID
   const ActorId ego_actor_id = vehicle_id_list.at(index);
   if (simulation_state.ContainsActor(ego_actor_id)) { // 检查仿真中是否包含此车辆
-    const cg::Location ego_location = simulation_state.GetLocation(ego_actor_id); // 获取车辆当前位置
+    // 本车在这一步的随机数流，候选车辆按确定的顺序检查，因此抽取结果可复现
+    RandomStream random_stream = random_device.GetStream(ego_actor_id, RandomStreamId::Collision);
     const Buffer &ego_buffer = buffer_map.at(ego_actor_id); // 获取车辆的路径缓存
     const unsigned long look_ahead_index = GetTargetWaypoint(ego_buffer, JUNCTION_LOOK_AHEAD).second; // 计算前瞻路径点索引
-    const float velocity = simulation_state.GetVelocity(ego_actor_id).Length(); // 获取车辆速度
-
-    // 获取与当前车辆路径重叠的其他车辆ID
-    ActorIdSet overlapping_actors = track_traffic.GetOverlappingVehicles(ego_actor_id);
-    std::vector<ActorId> collision_candidate_ids; // 碰撞候选车辆ID列表
-    // 根据速度和参数计算碰撞检测的最大半径平方
-    const float distance_to_leading = parameters.GetDistanceToLeadingVehicle(ego_actor_id); // 获取前车的安全距离
-    float collision_radius_square = SQUARE(COLLISION_RADIUS_RATE * velocity + COLLISION_RADIUS_MIN); // 碰撞半径平方
-    if (velocity < 2.0f) { // 如果车辆速度较低
-      const float length = simulation_state.GetDimensions(ego_actor_id).x; // 获取车辆长度
-      const float collision_radius_stop = COLLISION_RADIUS_STOP + length; // 设置静止时的碰撞半径
-      collision_radius_square = SQUARE(collision_radius_stop);
-    }
-    if (distance_to_leading > collision_radius_square) { // 如果前车距离更大
-        collision_radius_square = SQUARE(distance_to_leading);
-    }
 
-    // 遍历重叠路径上的其他车辆，筛选碰撞候选车辆
-    for (ActorId overlapping_actor_id : overlapping_actors) {
-      // 如果其他车辆在最大碰撞避免范围内，并且垂直方向有重叠
-      const cg::Location &overlapping_actor_location = simulation_state.GetLocation(overlapping_actor_id); // 获取重叠车辆的位置
-      if (overlapping_actor_id != ego_actor_id // 排除自身
-          && cg::Math::DistanceSquared(overlapping_actor_location, ego_location) < collision_radius_square  // 检测是否在碰撞半径范围内
-          && std::abs(ego_location.z - overlapping_actor_location.z) < VERTICAL_OVERLAP_THRESHOLD) { // 检测垂直方向的重叠
-        collision_candidate_ids.push_back(overlapping_actor_id); // 添加到碰撞候选列表
-      }
+    // 获取碰撞候选车辆，若已在并行阶段预先计算则直接使用
+    std::vector<ActorId> collision_candidate_ids;
+    if (candidates_prepared) {
+      collision_candidate_ids = std::move(collision_candidates.at(index));
+    } else {
+      collision_candidate_ids = GetCollisionCandidates(ego_actor_id);
     }
 
-    // 按与自车的距离对潜在碰撞对象进行升序排序
-    std::sort(collision_candidate_ids.begin(), collision_candidate_ids.end(),
-              [this, &ego_location](const ActorId &a_id_1, const ActorId &a_id_2) {
-                const cg::Location &e_loc = ego_location; // 自车位置
-                const cg::Location &loc_1 = simulation_state.GetLocation(a_id_1); // 对象1的位置
-                const cg::Location &loc_2 = simulation_state.GetLocation(a_id_2); // 对象2的位置
-                // 按距离平方排序，避免使用平方根计算，提升性能
-                return (cg::Math::DistanceSquared(e_loc, loc_1) < cg::Math::DistanceSquared(e_loc, loc_2));
-              });
-
     // 遍历排序后的对象，检查每个对象是否构成碰撞威胁
     for (auto iter = collision_candidate_ids.begin();
          iter != collision_candidate_ids.end() && !collision_hazard;
@@ -99,9 +74,9 @@ void CollisionStage::Update(const unsigned long index) {
         if (negotiation_result.first) { // 如果存在碰撞威胁
           // 根据对象类型和随机概率，决定是否忽略此威胁
           if ((other_actor_type == ActorType::Vehicle
-               && parameters.GetPercentageIgnoreVehicles(ego_actor_id) <= random_device.next())
+               && parameters.GetPercentageIgnoreVehicles(ego_actor_id) <= random_stream.next())
               || (other_actor_type == ActorType::Pedestrian
-                  && parameters.GetPercentageIgnoreWalkers(ego_actor_id) <= random_device.next())) {
+                  && parameters.GetPercentageIgnoreWalkers(ego_actor_id) <= random_stream.next())) {
             collision_hazard = true;      // 标记碰撞威胁
             obstacle_id = other_actor_id; // 记录威胁对象ID
             available_distance_margin = negotiation_result.second; // 记录距离裕度
@@ -118,14 +93,83 @@ void CollisionStage::Update(const unsigned long index) {
   output_element.available_distance_margin = available_distance_margin; // 距离裕度
 }
 
+std::vector<ActorId> CollisionStage::GetCollisionCandidates(const ActorId ego_actor_id) const {
+  // 直接读取状态表中按槽位对齐的列，避免对每个参与者重复进行哈希查找
+  const std::vector<cg::Location> &locations = simulation_state.GetLocations();
+  const size_t ego_slot = simulation_state.GetSlot(ego_actor_id);
+  const cg::Location ego_location = locations[ego_slot]; // 获取车辆当前位置
+  const float velocity = simulation_state.GetVelocities()[ego_slot].Length(); // 获取车辆速度
+
+  // 获取与当前车辆路径重叠的其他车辆ID
+  const std::vector<ActorId> overlapping_actors = track_traffic.GetOverlappingVehicles(ego_actor_id);
+  // 碰撞候选车辆与其到自车距离平方的列表
+  std::vector<std::pair<float, ActorId>> collision_candidates_by_distance;
+  // 根据速度和参数计算碰撞检测的最大半径平方
+  const float distance_to_leading = parameters.GetDistanceToLeadingVehicle(ego_actor_id); // 获取前车的安全距离
+  float collision_radius_square = SQUARE(COLLISION_RADIUS_RATE * velocity + COLLISION_RADIUS_MIN); // 碰撞半径平方
+  if (velocity < 2.0f) { // 如果车辆速度较低
+    const float length = simulation_state.GetAllDimensions()[ego_slot].x; // 获取车辆长度
+    const float collision_radius_stop = COLLISION_RADIUS_STOP + length; // 设置静止时的碰撞半径
+    collision_radius_square = SQUARE(collision_radius_stop);
+  }
+  if (distance_to_leading > collision_radius_square) { // 如果前车距离更大
+      collision_radius_square = SQUARE(distance_to_leading);
+  }
+
+  // 遍历重叠路径上的其他车辆，筛选碰撞候选车辆
+  for (ActorId overlapping_actor_id : overlapping_actors) {
+    // 如果其他车辆在最大碰撞避免范围内，并且垂直方向有重叠
+    const cg::Location &overlapping_actor_location = locations[simulation_state.GetSlot(overlapping_actor_id)]; // 获取重叠车辆的位置
+    const float distance_square = cg::Math::DistanceSquared(overlapping_actor_location, ego_location);
+    if (overlapping_actor_id != ego_actor_id // 排除自身
+        && distance_square < collision_radius_square  // 检测是否在碰撞半径范围内
+        && std::abs(ego_location.z - overlapping_actor_location.z) < VERTICAL_OVERLAP_THRESHOLD) { // 检测垂直方向的重叠
+      collision_candidates_by_distance.emplace_back(distance_square, overlapping_actor_id); // 添加到碰撞候选列表
+    }
+  }
+
+  // 按与自车的距离对潜在碰撞对象进行升序排序
+  // 距离平方已在筛选时计算，比较时无需再次查找位置
+  std::sort(collision_candidates_by_distance.begin(), collision_candidates_by_distance.end(),
+            [](const std::pair<float, ActorId> &a_1, const std::pair<float, ActorId> &a_2) {
+              return a_1.first < a_2.first;
+            });
+
+  std::vector<ActorId> collision_candidate_ids; // 碰撞候选车辆ID列表
+  collision_candidate_ids.reserve(collision_candidates_by_distance.size());
+  for (const auto &candidate : collision_candidates_by_distance) {
+    collision_candidate_ids.push_back(candidate.second);
+  }
+
+  return collision_candidate_ids;
+}
+
+void CollisionStage::PrepareCycle() {
+  // 每个索引拥有独立的槽位，并行写入时无需加锁
+  collision_candidates.clear();
+  collision_candidates.resize(vehicle_id_list.size());
+  candidates_prepared = true;
+}
+
+void CollisionStage::PrepareCandidates(const unsigned long index) {
+  const ActorId ego_actor_id = vehicle_id_list.at(index);
+  if (simulation_state.ContainsActor(ego_actor_id)) {
+    collision_candidates.at(index) = GetCollisionCandidates(ego_actor_id);
+  }
+}
+
 void CollisionStage::RemoveActor(const ActorId actor_id) {
   // 移除特定对象的碰撞锁定
   collision_locks.erase(actor_id);
+  // 该对象的几何比较结果会因版本号不匹配而失效，并在闲置后被清除
+  geodesic_boundary_map.erase(actor_id);
 }
 
 void CollisionStage::Reset() {
   // 清空所有碰撞锁定
   collision_locks.clear();
+  geodesic_boundary_map.clear();
+  geometry_cache.clear();
 }
 
 float CollisionStage::GetBoundingBoxExtention(const ActorId actor_id) {
@@ -179,19 +223,54 @@ LocationVector CollisionStage::GetBoundary(const ActorId actor_id) {
   return bbox_boundary; // 返回边界框
 }
 
-LocationVector CollisionStage::GetGeodesicBoundary(const ActorId actor_id) {
-  LocationVector geodesic_boundary;
+GeometrySignature CollisionStage::GetGeometrySignature(const ActorId actor_id) {
+  GeometrySignature signature{simulation_state.GetLocation(actor_id), simulation_state.GetHeading(actor_id), 0.0f, 0u, 0u};
+
+  if (buffer_map.find(actor_id) != buffer_map.end()) {
+    // 测地边界沿路径缓冲区延伸，长度取边界框扩展值与前车距离中的较大者
+    const float specific_lead_distance = parameters.GetDistanceToLeadingVehicle(actor_id);
+    signature.extension = std::max(specific_lead_distance, GetBoundingBoxExtention(actor_id));
+    const Buffer &waypoint_buffer = buffer_map.at(actor_id);
+    if (!waypoint_buffer.empty()) {
+      signature.buffer_front_id = waypoint_buffer.front()->GetId();
+      signature.buffer_back_id = waypoint_buffer.back()->GetId();
+    }
+  } else if (simulation_state.GetType(actor_id) == ActorType::Pedestrian) {
+    // 行人的边界框按速度向前扩展
+    signature.extension = simulation_state.GetVelocity(actor_id).Length() * WALKER_TIME_EXTENSION;
+  }
 
-  if (geodesic_boundary_map.find(actor_id) != geodesic_boundary_map.end()) {
-    // 如果地理边界已经缓存，则直接获取
-    geodesic_boundary = geodesic_boundary_map.at(actor_id);
-  } else {
+  return signature;
+}
+
+const GeodesicBoundaryEntry &CollisionStage::GetGeodesicBoundaryEntry(const ActorId actor_id) {
+  auto entry_it = geodesic_boundary_map.find(actor_id);
+  if (entry_it != geodesic_boundary_map.end() && entry_it->second.validated_cycle == current_cycle) {
+    // 当前更新周期内已确认有效，直接使用
+    return entry_it->second;
+  }
+
+  const GeometrySignature signature = GetGeometrySignature(actor_id);
+  if (entry_it != geodesic_boundary_map.end()) {
+    // 车辆状态的变化均未超过阈值时，沿用上一周期的边界
+    GeodesicBoundaryEntry &entry = entry_it->second;
+    const GeometrySignature &cached = entry.signature;
+    if (cached.buffer_front_id == signature.buffer_front_id
+        && cached.buffer_back_id == signature.buffer_back_id
+        && cg::Math::DistanceSquared(cached.location, signature.location) < SQUARE(GEOMETRY_CACHE_LOCATION_THRESHOLD)
+        && cg::Math::Dot(cached.heading, signature.heading) > GEOMETRY_CACHE_HEADING_THRESHOLD
+        && std::abs(cached.extension - signature.extension) < GEOMETRY_CACHE_EXTENSION_THRESHOLD) {
+      entry.validated_cycle = current_cycle;
+      return entry;
+    }
+  }
+
+  LocationVector geodesic_boundary;
+  {
     const LocationVector bbox = GetBoundary(actor_id); //获取边界框
 
     if (buffer_map.find(actor_id) != buffer_map.end()) {
-      float bbox_extension = GetBoundingBoxExtention(actor_id); // 获取边界框扩展值
-      const float specific_lead_distance = parameters.GetDistanceToLeadingVehicle(actor_id); // 获取特定的前车距离
-      bbox_extension = std::max(specific_lead_distance, bbox_extension); // 扩展边界框，使用更大的距离
+      const float bbox_extension = signature.extension; // 边界框扩展值，已在签名中与前车距离取较大者
       const float bbox_extension_square = SQUARE(bbox_extension); // 计算扩展距离的平方
 
       LocationVector left_boundary; // 左边界点集合
@@ -202,13 +281,13 @@ LocationVector CollisionStage::GetGeodesicBoundary(const ActorId actor_id) {
 
       const Buffer &waypoint_buffer = buffer_map.at(actor_id); // 获取路径缓冲区
       const TargetWPInfo target_wp_info = GetTargetWaypoint(waypoint_buffer, length); // 获取目标路径点和起点索引
-      const SimpleWaypointPtr boundary_start = target_wp_info.first; // 边界起始路径点
+      const SimpleWaypoint *boundary_start = target_wp_info.first; // 边界起始路径点
       const uint64_t boundary_start_index = target_wp_info.second; // 边界起始索引
 
       // 在无信号交叉口，我们扩展边界穿过交叉口
       // 在所有其他情况下，边界长度与速度相关
-      SimpleWaypointPtr boundary_end = nullptr;
-      SimpleWaypointPtr current_point = waypoint_buffer.at(boundary_start_index);
+      const SimpleWaypoint *boundary_end = nullptr;
+      SimpleWaypoint *current_point = waypoint_buffer.at(boundary_start_index);
       bool reached_distance = false;
       for (uint64_t j = boundary_start_index; !reached_distance && (j < waypoint_buffer.size()); ++j) {
         if (boundary_start->DistanceSquared(current_point) > bbox_extension_square || j == waypoint_buffer.size() - 1) {
@@ -246,11 +325,30 @@ LocationVector CollisionStage::GetGeodesicBoundary(const ActorId actor_id) {
 
       geodesic_boundary = bbox;
     }
+  }
 
-    geodesic_boundary_map.insert({actor_id, geodesic_boundary});
+  // 同时计算测地边界的包围盒，供宽相位剔除使用
+  BoundaryAABB aabb{std::numeric_limits<double>::max(), std::numeric_limits<double>::max(),
+                    std::numeric_limits<double>::lowest(), std::numeric_limits<double>::lowest()};
+  for (const cg::Location &location : geodesic_boundary) {
+    aabb.min_x = std::min(aabb.min_x, static_cast<double>(location.x));
+    aabb.min_y = std::min(aabb.min_y, static_cast<double>(location.y));
+    aabb.max_x = std::max(aabb.max_x, static_cast<double>(location.x));
+    aabb.max_y = std::max(aabb.max_y, static_cast<double>(location.y));
   }
 
-  return geodesic_boundary;
+  // 重新构造的边界分配新的版本号，使依赖旧边界的几何比较结果失效
+  GeodesicBoundaryEntry &entry = geodesic_boundary_map[actor_id];
+  entry.boundary = std::move(geodesic_boundary);
+  entry.aabb = aabb;
+  entry.signature = signature;
+  entry.revision = next_boundary_revision++;
+  entry.validated_cycle = current_cycle;
+  return entry;
+}
+
+const LocationVector &CollisionStage::GetGeodesicBoundary(const ActorId actor_id) {
+  return GetGeodesicBoundaryEntry(actor_id).boundary;
 }
 
 Polygon CollisionStage::GetPolygon(const LocationVector &boundary) {
@@ -285,22 +383,51 @@ GeometryComparison CollisionStage::GetGeometryBetweenActors(const ActorId refere
 
   GeometryComparison comparision_result{-1.0, -1.0, -1.0, -1.0}; // 默认比较结果，初始化为-1.0
 
-  if (geometry_cache.find(actor_id_key) != geometry_cache.end()) {
-    // 如果几何关系已缓存，则直接获取
-    comparision_result = geometry_cache.at(actor_id_key);
-    double mref_veh_other = comparision_result.reference_vehicle_to_other_geodesic;
-    // 交换参考车辆到其他车辆的距离和相反方向的距离
-    comparision_result.reference_vehicle_to_other_geodesic = comparision_result.other_vehicle_to_reference_geodesic;
-    comparision_result.other_vehicle_to_reference_geodesic = mref_veh_other;
+  // 先确认双方的测地边界，得到各自当前的版本号
+  const GeodesicBoundaryEntry &reference_entry = GetGeodesicBoundaryEntry(reference_vehicle_id);
+  const GeodesicBoundaryEntry &other_entry = GetGeodesicBoundaryEntry(other_actor_id);
+  const uint64_t first_revision = reference_vehicle_id < other_actor_id ? reference_entry.revision : other_entry.revision;
+  const uint64_t second_revision = reference_vehicle_id < other_actor_id ? other_entry.revision : reference_entry.revision;
+
+  auto cache_it = geometry_cache.find(actor_id_key);
+  if (cache_it != geometry_cache.end()
+      && cache_it->second.first_revision == first_revision
+      && cache_it->second.second_revision == second_revision) {
+    // 双方的测地边界均未重新构造，几何关系可直接沿用
+    cache_it->second.used_cycle = current_cycle;
+    comparision_result = cache_it->second.comparison;
+    if (reference_vehicle_id != key_parts.first) {
+      double mref_veh_other = comparision_result.reference_vehicle_to_other_geodesic;
+      // 交换参考车辆到其他车辆的距离和相反方向的距离
+      comparision_result.reference_vehicle_to_other_geodesic = comparision_result.other_vehicle_to_reference_geodesic;
+      comparision_result.other_vehicle_to_reference_geodesic = mref_veh_other;
+    }
   } else {
+    // 宽相位：先比较两条测地边界的包围盒。包围盒之间的间距是两个测地多边形之间距离的下界，
+    // 而车辆边界框位于各自的测地边界之内，因此它同样是其余三个距离的下界。
+    // 若间距已经超过重叠阈值，测地边界不可能接触，协商结果必然是无碰撞风险，
+    // 此时无需再进行开销较大的多边形距离计算。
+    const BoundaryAABB &reference_aabb = reference_entry.aabb;
+    const BoundaryAABB &other_aabb = other_entry.aabb;
+    const double gap_x = std::max({0.0, other_aabb.min_x - reference_aabb.max_x, reference_aabb.min_x - other_aabb.max_x});
+    const double gap_y = std::max({0.0, other_aabb.min_y - reference_aabb.max_y, reference_aabb.min_y - other_aabb.max_y});
+    const double aabb_gap_square = gap_x * gap_x + gap_y * gap_y;
+
+    if (aabb_gap_square > static_cast<double>(SQUARE(OVERLAP_THRESHOLD))) {
+      const double aabb_gap = std::sqrt(aabb_gap_square);
+      comparision_result = {aabb_gap, aabb_gap, aabb_gap, aabb_gap};
+      geometry_cache[actor_id_key] = {comparision_result, first_revision, second_revision, current_cycle};
+      return comparision_result;
+    }
+
     // 获取参考车辆的边界多边形
     const Polygon reference_polygon = GetPolygon(GetBoundary(reference_vehicle_id));
     // 获取其他实体的边界多边形
     const Polygon other_polygon = GetPolygon(GetBoundary(other_actor_id));
     // 获取参考车辆的地理边界多边形
-    const Polygon reference_geodesic_polygon = GetPolygon(GetGeodesicBoundary(reference_vehicle_id));
+    const Polygon reference_geodesic_polygon = GetPolygon(reference_entry.boundary);
     //获取其他实体的地理边界多边形
-    const Polygon other_geodesic_polygon = GetPolygon(GetGeodesicBoundary(other_actor_id));
+    const Polygon other_geodesic_polygon = GetPolygon(other_entry.boundary);
     // 计算参考车辆到其他实体地理边界的距离
     const double reference_vehicle_to_other_geodesic = bg::distance(reference_polygon, other_geodesic_polygon);
     // 计算其他实体到参考车辆地理边界的距离
@@ -314,8 +441,12 @@ GeometryComparison CollisionStage::GetGeometryBetweenActors(const ActorId refere
               other_vehicle_to_reference_geodesic,
               inter_geodesic_distance,
               inter_bbox_distance};
-    // 将结果缓存
-    geometry_cache.insert({actor_id_key, comparision_result});
+    // 将结果以ID较小的参与者为参考缓存
+    GeometryComparison cached_result = comparision_result;
+    if (reference_vehicle_id != key_parts.first) {
+      std::swap(cached_result.reference_vehicle_to_other_geodesic, cached_result.other_vehicle_to_reference_geodesic);
+    }
+    geometry_cache[actor_id_key] = {cached_result, first_revision, second_revision, current_cycle};
   }
 
   return comparision_result; // 返回几何比较结果
@@ -360,12 +491,12 @@ std::pair<bool, float> CollisionStage::NegotiateCollision(const ActorId referenc
   float reference_heading_to_other_dot = cg::Math::Dot(reference_heading, reference_to_other);
   bool other_vehicle_in_front = reference_heading_to_other_dot > 0;
   const Buffer &reference_vehicle_buffer = buffer_map.at(reference_vehicle_id);
-  SimpleWaypointPtr closest_point = reference_vehicle_buffer.front();
+  const SimpleWaypoint *closest_point = reference_vehicle_buffer.front();
   bool ego_inside_junction = closest_point->CheckJunction();
   TrafficLightState reference_tl_state = simulation_state.GetTLS(reference_vehicle_id);
   bool ego_at_traffic_light = reference_tl_state.at_traffic_light;
   bool ego_stopped_by_light = reference_tl_state.tl_state != TLS::Green && reference_tl_state.tl_state != TLS::Off;
-  SimpleWaypointPtr look_ahead_point = reference_vehicle_buffer.at(reference_junction_look_ahead_index);
+  const SimpleWaypoint *look_ahead_point = reference_vehicle_buffer.at(reference_junction_look_ahead_index);
   bool ego_at_junction_entrance = !closest_point->CheckJunction() && look_ahead_point->CheckJunction();
 
   // 考虑碰撞谈判的条件
@@ -439,8 +570,24 @@ std::pair<bool, float> CollisionStage::NegotiateCollision(const ActorId referenc
 }
 
 void CollisionStage::ClearCycleCache() {
-  geodesic_boundary_map.clear();
-  geometry_cache.clear();
+  // 测地边界与几何比较结果跨周期保留，仅清除长时间未被使用的条目
+  for (auto it = geodesic_boundary_map.begin(); it != geodesic_boundary_map.end();) {
+    if (current_cycle - it->second.validated_cycle > GEOMETRY_CACHE_MAX_IDLE_CYCLES) {
+      it = geodesic_boundary_map.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  for (auto it = geometry_cache.begin(); it != geometry_cache.end();) {
+    if (current_cycle - it->second.used_cycle > GEOMETRY_CACHE_MAX_IDLE_CYCLES) {
+      it = geometry_cache.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  ++current_cycle;
+  collision_candidates.clear();
+  candidates_prepared = false;
 }
 
 } // namespace traffic_manager
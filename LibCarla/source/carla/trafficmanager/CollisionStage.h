@@ -20,6 +20,7 @@
 #include "carla/trafficmanager/RandomGenerator.h" // 引入随机数生成器的定义
 #include "carla/trafficmanager/SimulationState.h" // 引入仿真状态的定义
 #include "carla/trafficmanager/Stage.h" // 引入阶段的定义
+#include "carla/trafficmanager/TrackTraffic.h" // 引入交通跟踪的定义
 
 namespace carla { // 定义 carla 命名空间
 namespace traffic_manager { // 定义 traffic_manager 命名空间
@@ -41,11 +42,41 @@ using CollisionLockMap = std::unordered_map<ActorId, CollisionLock>; // 定义
 namespace cc = carla::client; // 简化 carla::client 的命名空间
 namespace bg = boost::geometry; // 简化 boost::geometry 的命名空间
 
-using Buffer = std::deque<std::shared_ptr<SimpleWaypoint>>; // 定义 waypoint 缓冲区
+using Buffer = WaypointBuffer; // 定义 waypoint 缓冲区
 using BufferMap = std::unordered_map<carla::ActorId, Buffer>; // 定义缓冲区映射表
 using LocationVector = std::vector<cg::Location>; // 定义位置向量
-using GeodesicBoundaryMap = std::unordered_map<ActorId, LocationVector>; // 定义测地边界映射表
-using GeometryComparisonMap = std::unordered_map<uint64_t, GeometryComparison>; // 定义几何比较映射表
+
+struct BoundaryAABB { // 定义边界在水平面上的轴对齐包围盒
+  double min_x;
+  double min_y;
+  double max_x;
+  double max_y;
+};
+
+struct GeometrySignature { // 决定测地边界形状的车辆状态，用于判断缓存是否仍然有效
+  cg::Location location; // 车辆位置
+  cg::Vector3D heading; // 车辆朝向
+  float extension; // 边界框向前的扩展长度
+  uint64_t buffer_front_id; // 路径缓冲区首个路径点的ID
+  uint64_t buffer_back_id; // 路径缓冲区最后一个路径点的ID，用于察觉变道后路径的改变
+};
+
+struct GeodesicBoundaryEntry { // 跨更新周期缓存的测地边界
+  LocationVector boundary; // 测地边界
+  BoundaryAABB aabb; // 测地边界的包围盒，用于宽相位剔除
+  GeometrySignature signature; // 计算边界时的车辆状态
+  uint64_t revision; // 边界的版本号，每次重新计算都会分配新的版本号
+  uint64_t validated_cycle; // 最近一次确认边界有效的更新周期
+};
+using GeodesicBoundaryMap = std::unordered_map<ActorId, GeodesicBoundaryEntry>; // 定义测地边界映射表
+
+struct GeometryCacheEntry { // 跨更新周期缓存的几何比较结果
+  GeometryComparison comparison; // 以ID较小的参与者为参考的比较结果
+  uint64_t first_revision; // 计算时ID较小参与者的边界版本号
+  uint64_t second_revision; // 计算时ID较大参与者的边界版本号
+  uint64_t used_cycle; // 最近一次使用该结果的更新周期
+};
+using GeometryComparisonMap = std::unordered_map<uint64_t, GeometryCacheEntry>; // 定义几何比较映射表
 using Polygon = bg::model::polygon<bg::model::d2::point_xy<double>>; // 定义多边形类型
 
 /// 该类具有检测与附近演员潜在碰撞的功能。
@@ -58,9 +89,18 @@ private:
   const Parameters &parameters; // 参数
   CollisionFrame &output_array; // 输出数组
   CollisionLockMap collision_locks; // 存储阻塞的前方车辆信息
-  GeometryComparisonMap geometry_cache; // 存储车辆边界的几何比较结果
-  GeodesicBoundaryMap geodesic_boundary_map; // 存储车辆的测地边界
+  GeometryComparisonMap geometry_cache; // 存储车辆边界的几何比较结果，跨更新周期保留
+  GeodesicBoundaryMap geodesic_boundary_map; // 存储车辆的测地边界，跨更新周期保留
+  uint64_t current_cycle = 0u; // 当前更新周期的序号
+  uint64_t next_boundary_revision = 1u; // 下一个分配给测地边界的版本号
   RandomGenerator &random_device; // 随机数生成器
+  // 当前更新周期中按索引预先计算好的碰撞候选车辆列表
+  std::vector<std::vector<ActorId>> collision_candidates;
+  // 当前更新周期的候选列表是否已经预先计算
+  bool candidates_prepared = false;
+
+  // 方法：筛选与车辆路径重叠、且按距离升序排列的碰撞候选车辆
+  std::vector<ActorId> GetCollisionCandidates(const ActorId ego_actor_id) const;
 
   // 方法：确定车辆是否与另一辆车处于碰撞路径
   std::pair<bool, float> NegotiateCollision(const ActorId reference_vehicle_id,
@@ -73,12 +113,18 @@ private:
   // 方法：计算车辆边界的多边形点
   LocationVector GetBoundary(const ActorId actor_id);
 
+  // 方法：获取决定车辆测地边界形状的状态
+  GeometrySignature GetGeometrySignature(const ActorId actor_id);
+
+  // 方法：获取车辆路径边界的缓存条目，车辆状态变化超过阈值时重新构造边界
+  const GeodesicBoundaryEntry &GetGeodesicBoundaryEntry(const ActorId actor_id);
+
   // 方法：构造车辆路径边界的多边形点
-  LocationVector GetGeodesicBoundary(const ActorId actor_id);
+  const LocationVector &GetGeodesicBoundary(const ActorId actor_id);
 
   Polygon GetPolygon(const LocationVector &boundary); // 获取多边形对象
 
-  // 方法：比较路径边界、车辆的边界框，并缓存当前更新周期的结果
+  // 方法：比较路径边界、车辆的边界框，并缓存结果直到任一方的路径边界被重新构造
   GeometryComparison GetGeometryBetweenActors(const ActorId reference_vehicle_id,
                                               const ActorId other_actor_id);
 
@@ -95,13 +141,20 @@ public:
                  CollisionFrame &output_array,
                  RandomGenerator &random_device);
 
+  // 方法：为新的更新周期分配候选列表的存储空间，需在 PrepareCandidates 之前调用
+  void PrepareCycle();
+
+  // 方法：预先计算指定索引车辆的碰撞候选列表
+  // 该方法只读取共享状态并写入该索引自身的槽位，因此不同索引可以并行调用
+  void PrepareCandidates(const unsigned long index);
+
   void Update (const unsigned long index) override; // 更新方法
 
   void RemoveActor(const ActorId actor_id) override; // 移除参与者方法
 
   void Reset() override; // 重置方法
 
-  // 方法：清除当前更新周期的缓存
+  // 方法：结束当前更新周期，并清除长时间未使用的缓存条目
   void ClearCycleCache();
 };
 
@@ -5,6 +5,7 @@
 
 #pragma once
 
+#include <cstddef>
 #include <limits>
 #include <stdint.h>
 #include <iostream>
@@ -48,12 +49,16 @@ static const float MAX_START_DISTANCE = 20.0f; // 最大起始距离
 static const float MINIMUM_HORIZON_LENGTH = 15.0f; // 最小视野长度
 static const float HORIZON_RATE = 2.0f; // 视野更新率
 static const float HIGH_SPEED_HORIZON_RATE = 4.0f; // 高速视野更新率
+// 路径点缓冲区的初始容量（须为2的幂）。缓冲区最长约为 √2 倍视野长度，
+// 以180km/h计约为280米，按5米的地图分辨率约需60个路径点，其余留给交叉口内的路径点
+static const std::size_t WAYPOINT_BUFFER_CAPACITY = 128u;
 } // namespace PathBufferUpdate
 
 namespace WaypointSelection {
 static const float TARGET_WAYPOINT_TIME_HORIZON = 0.3f; // 目标路径点时间视野
 static const float MIN_TARGET_WAYPOINT_DISTANCE = 3.0f; // 最小目标路径点距离
 static const float JUNCTION_LOOK_AHEAD = 5.0f; // 交叉口前瞻距离
+static const unsigned JUNCTION_LOOK_AHEAD_MAX_HOPS = 8u; // 建图时缓存前瞻交叉口ID所搜索的最大路径点数
 static const float SAFE_DISTANCE_AFTER_JUNCTION = 4.0f; // 交叉口后安全距离
 static const float MIN_JUNCTION_LENGTH = 8.0f; // 最小交叉口长度
 static const float MIN_SAFE_INTERVAL_LENGTH = 0.5f * SAFE_DISTANCE_AFTER_JUNCTION; // 最小安全间隔长度
@@ -87,6 +92,10 @@ static const float EPSILON = 2.0f * std::numeric_limits<float>::epsilon(); // 
 static const float MIN_REFERENCE_DISTANCE = 0.5f; // 最小参考距离
 static const float MIN_VELOCITY_COLL_RADIUS = 2.0f; // 最小速度碰撞半径
 static const float VEL_EXT_FACTOR = 0.36f; // 速度扩展因子
+static const float GEOMETRY_CACHE_LOCATION_THRESHOLD = 0.05f; // 测地边界缓存失效的位移阈值
+static const float GEOMETRY_CACHE_HEADING_THRESHOLD = 0.9999f; // 测地边界缓存失效的朝向夹角余弦阈值
+static const float GEOMETRY_CACHE_EXTENSION_THRESHOLD = 0.05f; // 测地边界缓存失效的扩展长度变化阈值
+static const uint64_t GEOMETRY_CACHE_MAX_IDLE_CYCLES = 20u; // 缓存条目未被使用的最大更新周期数
 } // namespace Collision
 
 namespace FrameMemory {
@@ -94,6 +103,25 @@ static const uint64_t INITIAL_SIZE = 50u; // 初始大小
 static const uint64_t GROWTH_STEP_SIZE = 50u; // 增长步长
 static const float INV_GROWTH_STEP_SIZE = 1.0f / static_cast<float>(GROWTH_STEP_SIZE); // 增长步长的倒数
 } // namespace FrameMemory
+
+namespace StageExecution {
+static const unsigned DEFAULT_STAGE_THREADS = 1u; // 默认阶段线程数（1 表示串行执行）
+static const unsigned MAX_STAGE_THREADS = 64u; // 阶段线程数上限
+static const unsigned long MIN_PARALLEL_SIZE = 16u; // 低于此车辆数时直接串行执行
+} // namespace StageExecution
+
+namespace Profiling {
+static const std::size_t PROFILE_WINDOW_STEPS = 1000u; // 性能统计的滑动窗口步数
+static const float OUTLIER_COST_FACTOR = 3.0f; // 车辆耗时超过同步中位数的该倍数时记为离群
+static const float MIN_OUTLIER_COST = 0.05f; // 记为离群的最小车辆耗时（毫秒）
+static const std::size_t MAX_STORED_OUTLIERS = 1024u; // 保留的离群记录上限
+static const std::size_t MAX_REPORTED_OUTLIERS = 20u; // 每次报告的离群记录上限
+} // namespace Profiling
+
+namespace Sharding {
+// 车辆离开本区域超过该距离（米）后才移交给相邻区域，避免在边界附近来回移交
+static const float HANDOFF_MARGIN = 5.0f;
+} // namespace Sharding
 namespace Map {
 static const float INFINITE_DISTANCE = std::numeric_limits<float>::max(); // 无限距离
 static const float MAX_GEODESIC_GRID_LENGTH = 20.0f; // 最大地理网格长度
@@ -139,6 +167,7 @@ static const float SUN_ALTITUDE_DEGREES_JUST_BEFORE_SUNSET = 145.0f; // 日落
 static const float HEAVY_PRECIPITATION_THRESHOLD = 80.0f; // 大降水阈值
 static const float FOG_DENSITY_THRESHOLD = 20.0f; // 雾密度阈值
 static const float MAX_DISTANCE_LIGHT_CHECK = 225.0f; // 最大光照检测距离
+static const uint64_t LIGHT_STATE_REFRESH_INTERVAL = 20u; // 从服务器重新读取灯光状态的间隔步数
 } // namespace VehicleLight
 
 namespace PID {
@@ -0,0 +1,66 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <cstdint>
+#include <type_traits>
+
+namespace carla {
+namespace traffic_manager {
+namespace cooked_map {
+
+  /// 烹饪地图文件的二进制布局（第2版）。
+  ///
+  /// 文件由以下三部分依次组成，全部为定长、按自然边界对齐的小端数据，
+  /// 因此可以直接在内存映射或一次性读入的缓冲区上访问，无需逐字段解析：
+  ///
+  ///   1. Header
+  ///   2. Header::waypoint_count 条 WaypointRecord
+  ///   3. Header::link_count 个 uint32_t 索引，存放所有后继与前驱连接
+  ///
+  /// 连接与变道路径点均以记录在文件中的下标表示，加载时无需再建立ID到索引的映射。
+  /// 每条记录都保存路径点的位置，用于直接批量构建空间索引。
+  ///
+  /// 第1版文件（CachedSimpleWaypoint 序列）没有文件头，以路径点总数开头。
+
+  static constexpr char MAGIC[4] = {'C', 'T', 'M', 'M'};
+  static constexpr uint32_t VERSION = 2u;
+  static constexpr uint32_t INVALID_INDEX = 0xFFFFFFFFu;
+
+  struct Header {
+    char magic[4];
+    uint32_t version;
+    uint32_t waypoint_count;
+    uint32_t link_count;
+  };
+
+  struct WaypointRecord {
+    uint64_t waypoint_id;
+    float location[3];
+    float s;
+    uint32_t road_id;
+    uint32_t section_id;
+    int32_t lane_id;
+    int32_t geodesic_grid_id;
+    /// 后继连接在索引表中的起始位置，随后是 previous_count 个前驱连接。
+    uint32_t first_link;
+    uint16_t next_count;
+    uint16_t previous_count;
+    uint32_t left_index;
+    uint32_t right_index;
+    uint8_t is_junction;
+    uint8_t road_option;
+    uint8_t padding[6];
+  };
+
+  static_assert(sizeof(Header) == 16u, "Cooked map header layout changed");
+  static_assert(sizeof(WaypointRecord) == 64u, "Cooked map record layout changed");
+  static_assert(std::is_trivially_copyable<WaypointRecord>::value, "Cooked map records must be trivially copyable");
+
+} // namespace cooked_map
+} // namespace traffic_manager
+} // namespace carla
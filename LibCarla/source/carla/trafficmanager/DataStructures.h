@@ -16,6 +16,7 @@
 #include "carla/rpc/TrafficLightState.h"  // 引入交通灯状态类的定义
 
 #include "carla/trafficmanager/SimpleWaypoint.h"  // 引入简单路径点类的定义
+#include "carla/trafficmanager/WaypointBuffer.h"  // 引入路径点环形缓冲区的定义
 
 namespace carla {
 namespace traffic_manager {
@@ -29,7 +30,7 @@ using ActorPtr = carla::SharedPtr<cc::Actor>;  // 定义Actor的智能指针类
 using JunctionID = carla::road::JuncId;  // 使用交叉口ID类型
 using Junction = carla::SharedPtr<carla::client::Junction>;  // 定义交叉口的智能指针类型
 using SimpleWaypointPtr = std::shared_ptr<SimpleWaypoint>;  // 定义简单路径点的智能指针类型
-using Buffer = std::deque<SimpleWaypointPtr>;  // 定义一个缓冲区类型，用于存储路径点
+using Buffer = WaypointBuffer;  // 定义一个缓冲区类型，用于存储路径点
 using BufferMap = std::unordered_map<carla::ActorId, Buffer>;  // 定义一个哈希映射，键为ActorId，值为Buffer
 using TimeInstance = chr::time_point<chr::system_clock, chr::nanoseconds>;  // 定义时间实例类型
 using TLS = carla::rpc::TrafficLightState;  // 使用交通灯状态类型
@@ -4,9 +4,14 @@
 // This work is licensed under the terms of the MIT license.
 // For a copy, see <https://opensource.org/licenses/MIT>.
 
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+
 #include "carla/Logging.h"
 
 #include "carla/trafficmanager/Constants.h"
+#include "carla/trafficmanager/CookedMapFormat.h"
 #include "carla/trafficmanager/InMemoryMap.h"
 #include <boost/geometry/geometries/box.hpp>
 // 定义在carla命名空间下的traffic_manager命名空间
@@ -16,13 +21,17 @@ namespace traffic_manager {
   namespace cg = carla::geom;
  // 引入constants::Map命名空间内的元素到当前作用域
   using namespace constants::Map;
+  using constants::WaypointSelection::JUNCTION_LOOK_AHEAD;
+  using constants::WaypointSelection::JUNCTION_LOOK_AHEAD_MAX_HOPS;
 // 定义拓扑列表类型
   using TopologyList = std::vector<std::pair<WaypointPtr, WaypointPtr>>;
  // 定义原始节点列表类型
   using RawNodeList = std::vector<WaypointPtr>;
 // InMemoryMap类的构造函数，接受一个WorldMap类型的参数  
 // 用于初始化类中的_world_map变量
-  InMemoryMap::InMemoryMap(WorldMap world_map) : _world_map(world_map) {}
+  InMemoryMap::InMemoryMap(WorldMap world_map)
+    : _world_map(world_map),
+      waypoint_pool(std::make_shared<SimpleWaypointPool>()) {}
 // InMemoryMap类的析构函数
   InMemoryMap::~InMemoryMap() {}
 // 获取给定路点对应的路段ID
@@ -99,27 +108,186 @@ namespace traffic_manager {
       return;
     }
 
-    // 将所有记录的总数写入文件中
-    uint32_t total = static_cast<uint32_t>(dense_topology.size());
-    out_file.write(reinterpret_cast<const char *>(&total), sizeof(uint32_t));
+    // 路径点在文件中的下标即其在稠密拓扑中的位置
+    std::vector<uint32_t> file_index(waypoint_pool->Size(), cooked_map::INVALID_INDEX);
+    for (std::size_t i = 0u; i < dense_topology.size(); ++i) {
+      file_index[dense_topology[i]->GetIndex()] = static_cast<uint32_t>(i);
+    }
 
     // 创建或记录一些基本的导航点
+    std::vector<cooked_map::WaypointRecord> records;
+    std::vector<uint32_t> links;
+    records.reserve(dense_topology.size());
     std::unordered_set<uint64_t> used_ids;
     for (auto& wp: dense_topology) {
       if (used_ids.find(wp->GetId()) != used_ids.end()) {
         log_error("Could not generate the binary file. There are repeated waypoints");
       }
-      CachedSimpleWaypoint cached_wp(wp);
-      cached_wp.Write(out_file);
-
       used_ids.insert(wp->GetId());
+
+      cooked_map::WaypointRecord record{};
+      const WaypointPtr &waypoint = wp->GetWaypoint();
+      const cg::Location location = wp->GetLocation();
+      record.waypoint_id = wp->GetId();
+      record.location[0] = location.x;
+      record.location[1] = location.y;
+      record.location[2] = location.z;
+      record.s = static_cast<float>(waypoint->GetDistance());
+      record.road_id = waypoint->GetRoadId();
+      record.section_id = waypoint->GetSectionId();
+      record.lane_id = waypoint->GetLaneId();
+      record.geodesic_grid_id = wp->GetGeodesicGridId();
+      record.first_link = static_cast<uint32_t>(links.size());
+      record.next_count = static_cast<uint16_t>(wp->GetNextIndices().size());
+      record.previous_count = static_cast<uint16_t>(wp->GetPreviousIndices().size());
+      for (const WaypointIndex index : wp->GetNextIndices()) {
+        links.push_back(file_index[index]);
+      }
+      for (const WaypointIndex index : wp->GetPreviousIndices()) {
+        links.push_back(file_index[index]);
+      }
+      const SimpleWaypointPtr left_waypoint = wp->GetLeftWaypoint();
+      const SimpleWaypointPtr right_waypoint = wp->GetRightWaypoint();
+      record.left_index = left_waypoint ? file_index[left_waypoint->GetIndex()] : cooked_map::INVALID_INDEX;
+      record.right_index = right_waypoint ? file_index[right_waypoint->GetIndex()] : cooked_map::INVALID_INDEX;
+      record.is_junction = wp->CheckJunction() ? 1u : 0u;
+      record.road_option = static_cast<uint8_t>(wp->GetRoadOption());
+      records.push_back(record);
     }
 
+    cooked_map::Header header{};
+    std::copy(std::begin(cooked_map::MAGIC), std::end(cooked_map::MAGIC), header.magic);
+    header.version = cooked_map::VERSION;
+    header.waypoint_count = static_cast<uint32_t>(records.size());
+    header.link_count = static_cast<uint32_t>(links.size());
+
+    out_file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    out_file.write(reinterpret_cast<const char *>(records.data()),
+                   static_cast<std::streamsize>(records.size() * sizeof(cooked_map::WaypointRecord)));
+    out_file.write(reinterpret_cast<const char *>(links.data()),
+                   static_cast<std::streamsize>(links.size() * sizeof(uint32_t)));
+
     out_file.close();
     return;
   }
 
   bool InMemoryMap::Load(const std::vector<uint8_t>& content) {
+    if (IsCookedFormat(content.data(), content.size())) {
+      return LoadCooked(content.data(), content.size());
+    }
+    return LoadLegacy(content);
+  }
+
+  bool InMemoryMap::Load(const uint8_t *data, const std::size_t size) {
+    if (IsCookedFormat(data, size)) {
+      return LoadCooked(data, size);
+    }
+    return LoadLegacy(std::vector<uint8_t>(data, data + size));
+  }
+
+  bool InMemoryMap::IsCookedFormat(const uint8_t *data, const std::size_t size) {
+    return size >= sizeof(cooked_map::Header)
+        && std::equal(std::begin(cooked_map::MAGIC), std::end(cooked_map::MAGIC), reinterpret_cast<const char *>(data));
+  }
+
+  bool InMemoryMap::LoadCooked(const uint8_t *data, const std::size_t size) {
+    cooked_map::Header header;
+    memcpy(&header, data, sizeof(header));
+    if (header.version != cooked_map::VERSION) {
+      log_error("Unsupported InMemoryMap cache version", header.version);
+      return false;
+    }
+
+    const std::size_t records_offset = sizeof(cooked_map::Header);
+    const std::size_t links_offset = records_offset + header.waypoint_count * sizeof(cooked_map::WaypointRecord);
+    if (size < links_offset + header.link_count * sizeof(uint32_t)) {
+      log_error("Truncated InMemoryMap cache");
+      return false;
+    }
+
+    // 记录均为定长且按自然边界对齐，缓冲区对齐时直接就地访问，否则先复制一份
+    std::vector<cooked_map::WaypointRecord> record_copy;
+    const cooked_map::WaypointRecord *records = nullptr;
+    std::vector<uint32_t> link_copy;
+    const uint32_t *links = nullptr;
+    if (reinterpret_cast<std::uintptr_t>(data) % alignof(cooked_map::WaypointRecord) == 0u) {
+      records = reinterpret_cast<const cooked_map::WaypointRecord *>(data + records_offset);
+      links = reinterpret_cast<const uint32_t *>(data + links_offset);
+    } else {
+      record_copy.resize(header.waypoint_count);
+      memcpy(record_copy.data(), data + records_offset, header.waypoint_count * sizeof(cooked_map::WaypointRecord));
+      link_copy.resize(header.link_count);
+      memcpy(link_copy.data(), data + links_offset, header.link_count * sizeof(uint32_t));
+      records = record_copy.data();
+      links = link_copy.data();
+    }
+
+    // 先校验所有下标，避免在创建路径点之后才发现文件损坏
+    for (uint32_t i = 0u; i < header.waypoint_count; ++i) {
+      const cooked_map::WaypointRecord &record = records[i];
+      const uint64_t link_end = static_cast<uint64_t>(record.first_link) + record.next_count + record.previous_count;
+      if (link_end > header.link_count
+          || (record.left_index != cooked_map::INVALID_INDEX && record.left_index >= header.waypoint_count)
+          || (record.right_index != cooked_map::INVALID_INDEX && record.right_index >= header.waypoint_count)) {
+        log_error("Corrupted InMemoryMap cache");
+        return false;
+      }
+      for (uint64_t j = record.first_link; j < link_end; ++j) {
+        if (links[j] >= header.waypoint_count) {
+          log_error("Corrupted InMemoryMap cache");
+          return false;
+        }
+      }
+    }
+
+    // 创建路径点，同时按记录中的位置准备空间索引的条目
+    dense_topology.reserve(header.waypoint_count);
+    std::vector<SpatialTreeEntry> entries;
+    entries.reserve(header.waypoint_count);
+    for (uint32_t i = 0u; i < header.waypoint_count; ++i) {
+      const cooked_map::WaypointRecord &record = records[i];
+      WaypointPtr waypoint_ptr = _world_map->GetWaypointXODR(record.road_id, record.lane_id, record.s);
+      SimpleWaypointPtr wp = waypoint_pool->Create(waypoint_ptr);
+      wp->SetGeodesicGridId(record.geodesic_grid_id);
+      wp->SetIsJunction(record.is_junction != 0u);
+      wp->SetRoadOption(static_cast<RoadOption>(record.road_option));
+      dense_topology.push_back(wp);
+      entries.emplace_back(Point3D(record.location[0], record.location[1], record.location[2]), wp);
+    }
+
+    // 连接航点，文件中的下标可直接定位路径点
+    for (uint32_t i = 0u; i < header.waypoint_count; ++i) {
+      const cooked_map::WaypointRecord &record = records[i];
+      SimpleWaypointPtr &wp = dense_topology[i];
+
+      NodeList next_waypoints;
+      NodeList previous_waypoints;
+      const uint32_t *link = links + record.first_link;
+      for (uint16_t j = 0u; j < record.next_count; ++j) {
+        next_waypoints.push_back(dense_topology[*link++]);
+      }
+      for (uint16_t j = 0u; j < record.previous_count; ++j) {
+        previous_waypoints.push_back(dense_topology[*link++]);
+      }
+      wp->SetNextWaypoint(next_waypoints);
+      wp->SetPreviousWaypoint(previous_waypoints);
+      if (record.left_index != cooked_map::INVALID_INDEX) {
+        wp->SetLeftWaypoint(dense_topology[record.left_index]);
+      }
+      if (record.right_index != cooked_map::INVALID_INDEX) {
+        wp->SetRightWaypoint(dense_topology[record.right_index]);
+      }
+    }
+
+    // 以打包算法一次性构建空间树，避免逐个插入
+    rtree = Rtree(entries.begin(), entries.end());
+
+    SetUpJunctionLookAhead();
+
+    return true;
+  }
+
+  bool InMemoryMap::LoadLegacy(const std::vector<uint8_t>& content) {
     unsigned long pos = 0;
     std::vector<CachedSimpleWaypoint> cached_waypoints;
     std::unordered_map<uint64_t, uint32_t> id2index;
@@ -137,7 +305,7 @@ namespace traffic_manager {
       id2index.insert({cached_wp.waypoint_id, i});
 
       WaypointPtr waypoint_ptr = _world_map->GetWaypointXODR(cached_wp.road_id, cached_wp.lane_id, cached_wp.s);
-      SimpleWaypointPtr wp = std::make_shared<SimpleWaypoint>(waypoint_ptr);
+      SimpleWaypointPtr wp = waypoint_pool->Create(waypoint_ptr);
       wp->SetGeodesicGridId(cached_wp.geodesic_grid_id);
       wp->SetIsJunction(cached_wp.is_junction);
       wp->SetRoadOption(static_cast<RoadOption>(cached_wp.road_option));
@@ -170,6 +338,8 @@ namespace traffic_manager {
     // 创建空间树
     SetUpSpatialTree();
 
+    SetUpJunctionLookAhead();
+
     return true;
   }
 
@@ -243,7 +413,7 @@ namespace traffic_manager {
     for (auto &waypoint_ptr: raw_dense_topology) {
       if (waypoint_ptr->GetLaneWidth() > MIN_LANE_WIDTH){
         // 避免让车辆通过非常狭窄的车道
-        segment_map[GetSegmentId(waypoint_ptr)].emplace_back(std::make_shared<SimpleWaypoint>(waypoint_ptr));
+        segment_map[GetSegmentId(waypoint_ptr)].emplace_back(waypoint_pool->Create(waypoint_ptr));
       }
     }
 
@@ -290,7 +460,7 @@ namespace traffic_manager {
               if (next_waypoints.size() != 0) {
                 auto new_waypoint = next_waypoints.front();
                 i++;
-                segment_waypoints.insert(segment_waypoints.begin()+static_cast<int64_t>(i), std::make_shared<SimpleWaypoint>(new_waypoint));
+                segment_waypoints.insert(segment_waypoints.begin()+static_cast<int64_t>(i), waypoint_pool->Create(new_waypoint));
               } else {
                 // 到达路的尽头
                 break;
@@ -373,16 +543,73 @@ namespace traffic_manager {
 
     // 为每个 SimpleWaypoint 指定一个 RoadOption
     SetUpRoadOption();
+
+    SetUpJunctionLookAhead();
+  }
+
+  void InMemoryMap::SetUpJunctionLookAhead() {
+    // 与 GetTargetWaypoint 的选取方式一致：取沿路线与起点的直线距离首次达到前瞻距离的路径点。
+    // 缓存不写入地图文件，加载后重新计算
+    for (auto &swp : dense_topology) {
+      const cg::Location origin = swp->GetLocation();
+      const auto &next_indices = swp->GetNextIndices();
+      bool found = false;
+      GeoGridId junction_id = -1;
+      bool consistent = true;
+      if (next_indices.empty()) {
+        // 没有后继时前瞻点即为自身
+        found = true;
+        junction_id = swp->GetJunctionId();
+      }
+      for (const WaypointIndex next_index : next_indices) {
+        if (!FindLookAheadJunctionId(origin, next_index, 1u, found, junction_id)) {
+          consistent = false;
+          break;
+        }
+      }
+      if (consistent && found) {
+        swp->SetLookAheadJunctionId(junction_id);
+      }
+    }
+  }
+
+  bool InMemoryMap::FindLookAheadJunctionId(const cg::Location &origin, const WaypointIndex index,
+                                            const unsigned depth, bool &found, GeoGridId &junction_id) const {
+    const SimpleWaypoint &current = waypoint_pool->At(index);
+    const auto &next_indices = current.GetNextIndices();
+    if (current.DistanceSquared(origin) < JUNCTION_LOOK_AHEAD * JUNCTION_LOOK_AHEAD && !next_indices.empty()) {
+      if (depth >= JUNCTION_LOOK_AHEAD_MAX_HOPS) {
+        // 路径点过密，交由运行时沿缓冲区查找
+        return false;
+      }
+      for (const WaypointIndex next_index : next_indices) {
+        if (!FindLookAheadJunctionId(origin, next_index, depth + 1u, found, junction_id)) {
+          return false;
+        }
+      }
+      return true;
+    }
+
+    const GeoGridId current_junction_id = current.GetJunctionId();
+    if (!found) {
+      found = true;
+      junction_id = current_junction_id;
+    }
+    return junction_id == current_junction_id;
   }
 
   void InMemoryMap::SetUpSpatialTree() {
+    // 先收集所有航点，再用打包算法一次性构建 R 树，与 Load 中相同
+    std::vector<SpatialTreeEntry> entries;
+    entries.reserve(dense_topology.size());
     for (auto &simple_waypoint: dense_topology) {
       if (simple_waypoint != nullptr) {
         const cg::Location loc = simple_waypoint->GetLocation();
         Point3D point(loc.x, loc.y, loc.z);
-        rtree.insert(std::make_pair(point, simple_waypoint));
+        entries.emplace_back(point, simple_waypoint);
       }
     }
+    rtree = Rtree(entries.begin(), entries.end());
   }
 
   void InMemoryMap::SetUpRoadOption() {
@@ -31,6 +31,7 @@
 
 #include "carla/trafficmanager/RandomGenerator.h"  // 引入随机生成器定义
 #include "carla/trafficmanager/SimpleWaypoint.h"  // 引入简单路径点定义
+#include "carla/trafficmanager/SimpleWaypointPool.h"  // 引入路径点内存池定义
 #include "carla/trafficmanager/CachedSimpleWaypoint.h"  // 引入缓存的简单路径点定义
 
 namespace carla {
@@ -65,6 +66,8 @@ private:
 
     /// 保存构造函数接收的世界地图对象。
     WorldMap _world_map;
+    /// 存放所有自定义路径点对象的内存池，路径点之间以索引相连。
+    std::shared_ptr<SimpleWaypointPool> waypoint_pool;
     /// 存储所有自定义路径点对象的结构，经过稀疏拓扑插值处理。
     NodeList dense_topology;
     /// 用于索引和查询路径点的空间二维R树。
@@ -80,6 +83,9 @@ public:
     //bool Load(const std::string& filename);  // 加载地图的方法（未实现）
     bool Load(const std::vector<uint8_t>& content);  // 从字节内容加载地图的方法
 
+    /// 从一段连续内存（例如内存映射的文件）加载地图，内容必须在调用期间保持有效。
+    bool Load(const uint8_t *data, std::size_t size);
+
     /// 此方法以采样分辨率构建本地地图。
     void SetUp();
 
@@ -99,10 +105,23 @@ public:
 private:
     void Save(const std::string& path);  // 保存地图到指定路径
 
+    /// 判断缓存内容是否为带版本号的定长二进制布局。
+    static bool IsCookedFormat(const uint8_t *data, std::size_t size);
+    bool LoadCooked(const uint8_t *data, std::size_t size);  // 加载第2版定长二进制布局
+    bool LoadLegacy(const std::vector<uint8_t>& content);  // 加载第1版逐条记录的布局
+
     void SetUpDenseTopology();  // 设置稠密拓扑
     void SetUpSpatialTree();  // 设置空间树
     void SetUpRoadOption();  // 设置道路选项
 
+    /// 为每个路径点缓存前瞻距离处的交叉口ID，供交通信号灯阶段直接查询。
+    void SetUpJunctionLookAhead();
+
+    /// 沿 @a index 及其后继查找与 @a origin 的距离首次达到前瞻距离的路径点，
+    /// 所有分支得到的交叉口ID一致时返回true。
+    bool FindLookAheadJunctionId(const cg::Location &origin, WaypointIndex index,
+                                 unsigned depth, bool &found, GeoGridId &junction_id) const;
+
     /// 此方法用于查找和链接车道变更连接。
     void FindAndLinkLaneChange(SimpleWaypointPtr reference_waypoint);
 
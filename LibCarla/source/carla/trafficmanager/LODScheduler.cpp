@@ -0,0 +1,130 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include <algorithm>
+#include <limits>
+
+#include "carla/trafficmanager/Constants.h"
+
+#include "carla/trafficmanager/LODScheduler.h"
+
+namespace carla {
+namespace traffic_manager {
+
+using constants::HybridMode::HYBRID_MODE_DT_FL;
+
+LODScheduler::LODScheduler(const std::vector<ActorId> &vehicle_id_list,
+                           SimulationState &simulation_state,
+                           const Parameters &parameters)
+  : vehicle_id_list(vehicle_id_list),
+    simulation_state(simulation_state),
+    parameters(parameters) {}
+
+float LODScheduler::GetMinimumSquaredDistance(const cg::Location &location,
+                                              const std::vector<cg::Location> &hero_locations) {
+  float minimum_squared_distance = std::numeric_limits<float>::infinity();
+  for (const cg::Location &hero_location : hero_locations) {
+    minimum_squared_distance = std::min(minimum_squared_distance,
+                                        cg::Math::DistanceSquared(location, hero_location));
+  }
+  return minimum_squared_distance;
+}
+
+void LODScheduler::Update(const std::vector<cg::Location> &hero_locations) {
+  const unsigned long number_of_vehicles = vehicle_id_list.size();
+  const float update_radius = parameters.GetLODUpdateRadius();
+  const float collision_radius = parameters.GetLODCollisionRadius();
+  const unsigned update_interval = parameters.GetLODUpdateInterval();
+  reduce_updates = update_radius > 0.0f && update_interval > 1u && !hero_locations.empty();
+  const bool reduce_collisions = collision_radius > 0.0f && !hero_locations.empty();
+  ++step;
+
+  levels.assign(number_of_vehicles, UPDATED | COLLISION);
+  if (!reduce_updates) {
+    held_controls.clear();
+    if (!reduce_collisions) {
+      return;
+    }
+  }
+
+  // 已注销的车辆不会再被查询，数量明显多于当前车辆时一次性清理
+  if (held_controls.size() > 2u * number_of_vehicles) {
+    std::unordered_map<ActorId, HeldControl> retained;
+    for (const ActorId actor_id : vehicle_id_list) {
+      auto held_it = held_controls.find(actor_id);
+      if (held_it != held_controls.end()) {
+        retained.insert(*held_it);
+      }
+    }
+    held_controls.swap(retained);
+  }
+
+  const float update_radius_square = SQUARE(update_radius);
+  const float collision_radius_square = SQUARE(collision_radius);
+  for (unsigned long index = 0u; index < number_of_vehicles; ++index) {
+    const ActorId actor_id = vehicle_id_list[index];
+    const float squared_distance = GetMinimumSquaredDistance(simulation_state.GetLocation(actor_id),
+                                                             hero_locations);
+    uint8_t level = UPDATED;
+    if (!reduce_collisions || squared_distance <= collision_radius_square) {
+      level |= COLLISION;
+    }
+
+    if (reduce_updates
+        && squared_distance > update_radius_square
+        && (step + actor_id) % update_interval != 0u
+        && !simulation_state.IsDormant(actor_id)) {
+      // 只有上一次的命令与当前的物理状态相符时才能沿用
+      auto held_it = held_controls.find(actor_id);
+      if (held_it != held_controls.end()
+          && held_it->second.physics_enabled == simulation_state.IsPhysicsEnabled(actor_id)) {
+        level = 0u;
+      }
+    }
+    levels[index] = level;
+  }
+}
+
+void LODScheduler::HoldControl(const unsigned long index, ControlFrame &control_frame) {
+  const ActorId actor_id = vehicle_id_list[index];
+  const HeldControl &held_control = held_controls.at(actor_id);
+
+  if (held_control.physics_enabled) {
+    // 启用物理的车辆保持上一次的油门、刹车和转向
+    control_frame[index] = held_control.command;
+  } else {
+    // 被传送的车辆按上一步的速度继续前进
+    const cg::Location vehicle_location = simulation_state.GetLocation(actor_id);
+    const cg::Vector3D displacement = simulation_state.GetVelocity(actor_id) * HYBRID_MODE_DT_FL;
+    const cg::Transform teleportation_transform(vehicle_location + cg::Location(displacement),
+                                                simulation_state.GetRotation(actor_id));
+    control_frame[index] = carla::rpc::Command::ApplyKinematicTarget(actor_id, teleportation_transform,
+                                                                     simulation_state.GetVelocity(actor_id));
+    simulation_state.UpdateKinematicHybridEndLocation(actor_id, teleportation_transform.location);
+  }
+}
+
+void LODScheduler::RecordControl(const ControlFrame &control_frame) {
+  if (!reduce_updates) {
+    return;
+  }
+  for (unsigned long index = 0u; index < levels.size(); ++index) {
+    if (IsUpdated(index)) {
+      const ActorId actor_id = vehicle_id_list[index];
+      held_controls[actor_id] = {control_frame[index], simulation_state.IsPhysicsEnabled(actor_id)};
+    }
+  }
+}
+
+void LODScheduler::Reset() {
+  step = 0u;
+  reduce_updates = false;
+  levels.clear();
+  held_controls.clear();
+}
+
+} // namespace traffic_manager
+} // namespace carla
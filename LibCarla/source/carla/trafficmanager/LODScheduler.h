@@ -0,0 +1,91 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <unordered_map>
+#include <vector>
+
+#include "carla/NonCopyable.h"
+#include "carla/rpc/ActorId.h"
+#include "carla/rpc/Command.h"
+#include "carla/trafficmanager/DataStructures.h"
+#include "carla/trafficmanager/Parameters.h"
+#include "carla/trafficmanager/SimulationState.h"
+
+namespace carla {
+namespace traffic_manager {
+
+  /**
+   * @class LODScheduler
+   * @brief 按与英雄车辆的距离为每辆车决定本步需要运行的阶段。
+   *
+   * 距离所有英雄车辆都超过更新半径的车辆每隔若干步才完整运行一次各阶段，
+   * 其余步沿用上一次的控制命令：启用物理的车辆保持原有控制，
+   * 被传送的车辆按上一步的位移继续前进。不同车辆的更新步按ID错开，使每步的负载均匀。
+   * 距离所有英雄车辆都超过碰撞半径的车辆不参与碰撞协商。
+   * 没有英雄车辆或未设置半径时，所有车辆每步都完整更新。
+   */
+  class LODScheduler : private NonCopyable {
+  public:
+
+    LODScheduler(const std::vector<ActorId> &vehicle_id_list,
+                 SimulationState &simulation_state,
+                 const Parameters &parameters);
+
+    /// 根据英雄车辆的位置计算本步各车辆的细节层次，须在各阶段运行之前调用。
+    void Update(const std::vector<cg::Location> &hero_locations);
+
+    /// 索引为 @a index 的车辆本步是否完整运行各阶段。
+    bool IsUpdated(const unsigned long index) const {
+      return (levels[index] & UPDATED) != 0u;
+    }
+
+    /// 索引为 @a index 的车辆本步是否参与碰撞协商。
+    bool NeedsCollision(const unsigned long index) const {
+      return (levels[index] & COLLISION) != 0u;
+    }
+
+    /// 为本步未更新的车辆写入沿用的控制命令。
+    void HoldControl(const unsigned long index, ControlFrame &control_frame);
+
+    /// 记录本步完整更新的车辆的控制命令，供之后未更新的步沿用。
+    void RecordControl(const ControlFrame &control_frame);
+
+    void Reset();
+
+  private:
+
+    enum Level : uint8_t {
+      UPDATED = 1u << 0,
+      COLLISION = 1u << 1
+    };
+
+    /// 上一次完整更新时的控制命令。
+    struct HeldControl {
+      carla::rpc::Command command;
+      /// 记录时车辆是否启用物理，物理状态改变后命令不能再沿用。
+      bool physics_enabled;
+    };
+
+    /// 距离 @a location 最近的英雄车辆的距离平方。
+    static float GetMinimumSquaredDistance(const cg::Location &location,
+                                           const std::vector<cg::Location> &hero_locations);
+
+    const std::vector<ActorId> &vehicle_id_list;
+    SimulationState &simulation_state;
+    const Parameters &parameters;
+
+    uint64_t step = 0u;
+    /// 本步是否降低了远处车辆的更新频率。
+    bool reduce_updates = false;
+    /// 与 vehicle_id_list 按索引对齐的细节层次标志。
+    std::vector<uint8_t> levels;
+    std::unordered_map<ActorId, HeldControl> held_controls;
+  };
+
+} // namespace traffic_manager
+} // namespace carla
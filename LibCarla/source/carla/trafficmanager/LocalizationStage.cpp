@@ -40,6 +40,8 @@ void LocalizationStage::Update(const unsigned long index) {
 
     // 获取当前车辆的ID和相关信息
   const ActorId actor_id = vehicle_id_list.at(index);
+  // 本车在这一步的随机数流，抽取结果与其他车辆的处理顺序无关
+  RandomStream random_stream = random_device.GetStream(actor_id, RandomStreamId::Localization);
   const cg::Location vehicle_location = simulation_state.GetLocation(actor_id);
   const cg::Vector3D heading_vector = simulation_state.GetHeading(actor_id);
   const cg::Vector3D vehicle_velocity_vector = simulation_state.GetVelocity(actor_id);
@@ -85,8 +87,8 @@ void LocalizationStage::Update(const unsigned long index) {
 
     if (!waypoint_buffer.empty()) {
       // 确定车辆是否在交叉路口入口处
-      SimpleWaypointPtr look_ahead_point = GetTargetWaypoint(waypoint_buffer, JUNCTION_LOOK_AHEAD).first;
-      SimpleWaypointPtr front_waypoint = waypoint_buffer.front();
+      const SimpleWaypoint *look_ahead_point = GetTargetWaypoint(waypoint_buffer, JUNCTION_LOOK_AHEAD).first;
+      const SimpleWaypoint *front_waypoint = waypoint_buffer.front();
       bool front_waypoint_junction = front_waypoint->CheckJunction();
       is_at_junction_entrance = !front_waypoint_junction && look_ahead_point->CheckJunction();
       if (!is_at_junction_entrance) {
@@ -115,7 +117,7 @@ void LocalizationStage::Update(const unsigned long index) {
   // 如果缓冲区为空，则进行初始化
   if (waypoint_buffer.empty()) {
     SimpleWaypointPtr closest_waypoint = local_map->GetWaypoint(vehicle_location);
-    PushWaypoint(actor_id, track_traffic, waypoint_buffer, closest_waypoint);
+    PushWaypoint(actor_id, track_traffic, waypoint_buffer, closest_waypoint.get());
   }
 
   // 分配变道
@@ -128,9 +130,9 @@ void LocalizationStage::Update(const unsigned long index) {
     const float perc_keep_right = parameters.GetKeepRightPercentage(actor_id);
     const float perc_random_leftlanechange = parameters.GetRandomLeftLaneChangePercentage(actor_id);
     const float perc_random_rightlanechange = parameters.GetRandomRightLaneChangePercentage(actor_id);
-    const bool is_keep_right = perc_keep_right > random_device.next();
-    const bool is_random_left_change = perc_random_leftlanechange >= random_device.next();
-    const bool is_random_right_change = perc_random_rightlanechange >= random_device.next();
+    const bool is_keep_right = perc_keep_right > random_stream.next();
+    const bool is_random_left_change = perc_random_leftlanechange >= random_stream.next();
+    const bool is_random_right_change = perc_random_rightlanechange >= random_stream.next();
 
     //确定应应用的参数
     if (is_keep_right || is_random_right_change) {
@@ -143,12 +145,12 @@ void LocalizationStage::Update(const unsigned long index) {
         lane_change_direction = false;
       } else {
         // 左右车道变更都是强制性的。请在其中选择一个
-        lane_change_direction = FIFTYPERC > random_device.next();
+        lane_change_direction = FIFTYPERC > random_stream.next();
       }
     }
   }
 
-  const SimpleWaypointPtr front_waypoint = waypoint_buffer.front();
+  const SimpleWaypoint *front_waypoint = waypoint_buffer.front();
   const float lane_change_distance = SQUARE(std::max(10.0f * vehicle_speed, INTER_LANE_CHANGE_DISTANCE));
 
   bool recently_not_executed_lane_change = last_lane_change_swpt.find(actor_id) == last_lane_change_swpt.end();
@@ -178,7 +180,7 @@ void LocalizationStage::Update(const unsigned long index) {
       for (uint64_t j = 0u; j < number_of_pops; ++j) {
         PopWaypoint(actor_id, track_traffic, waypoint_buffer);
       }
-      PushWaypoint(actor_id, track_traffic, waypoint_buffer, change_over_point);
+      PushWaypoint(actor_id, track_traffic, waypoint_buffer, change_over_point.get());
     }
   }
 
@@ -198,12 +200,13 @@ void LocalizationStage::Update(const unsigned long index) {
   // 通过随机选择航点填充缓冲区
   else {
     while (waypoint_buffer.back()->DistanceSquared(waypoint_buffer.front()) <= horizon_square) {
-      SimpleWaypointPtr furthest_waypoint = waypoint_buffer.back();
-      std::vector<SimpleWaypointPtr> next_waypoints = furthest_waypoint->GetNextWaypoint();
+      // 直接按索引在内存池中取下一个路点，避免每个路点都增减内存池的引用计数
+      const SimpleWaypoint *furthest_waypoint = waypoint_buffer.back();
+      const std::vector<WaypointIndex> &next_waypoints = furthest_waypoint->GetNextIndices();
       uint64_t selection_index = 0u;
       // 伪随机路径选择，如果发现多个选择
       if (next_waypoints.size() > 1) {
-        double r_sample = random_device.next();
+        double r_sample = random_stream.next();
         selection_index = static_cast<uint64_t>(r_sample*next_waypoints.size()*0.01);
       } else if (next_waypoints.size() == 0) {
         if (!parameters.GetOSMMode()) {
@@ -212,7 +215,7 @@ void LocalizationStage::Update(const unsigned long index) {
         marked_for_removal.push_back(actor_id);
         break;
       }
-      SimpleWaypointPtr next_wp_selection = next_waypoints.at(selection_index);
+      SimpleWaypoint *next_wp_selection = furthest_waypoint->GetPooledWaypoint(next_waypoints.at(selection_index));
       PushWaypoint(actor_id, track_traffic, waypoint_buffer, next_wp_selection);
       if (next_wp_selection->GetId() == waypoint_buffer.front()->GetId()){
         // 发现了一个环，停止。不要使用零距离，因为可能有两个航点在同一位置
@@ -252,8 +255,8 @@ void LocalizationStage::ExtendAndFindSafeSpace(const ActorId actor_id,
     bool entered_junction = false;
     bool past_junction = false;
     bool safe_point_found = false;
-    SimpleWaypointPtr current_waypoint = nullptr;
-    SimpleWaypointPtr junction_begin_point = nullptr;
+    const SimpleWaypoint *current_waypoint = nullptr;
+    const SimpleWaypoint *junction_begin_point = nullptr;
     float safe_distance_squared = SQUARE(SAFE_DISTANCE_AFTER_JUNCTION);
 
     // 扫描现有缓冲点
@@ -265,49 +268,23 @@ void LocalizationStage::ExtendAndFindSafeSpace(const ActorId actor_id,
       }
       if (entered_junction && !past_junction && !current_waypoint->CheckJunction()) {
         past_junction = true;
-        junction_end_point = current_waypoint;
+        junction_end_point = current_waypoint->GetSharedPtr();
       }
       if (past_junction && junction_end_point->DistanceSquared(current_waypoint) > safe_distance_squared) {
         safe_point_found = true;
-        safe_point_after_junction = current_waypoint;
+        safe_point_after_junction = current_waypoint->GetSharedPtr();
       }
     }
 
     // 如果未找到安全点，则扩展缓冲区
     if (!safe_point_found) {
-      bool abort = false;
-
-      while (!past_junction && !abort) {
-        NodeList next_waypoints = current_waypoint->GetNextWaypoint();
-        if (!next_waypoints.empty()) {
-          current_waypoint = next_waypoints.front();
-          PushWaypoint(actor_id, track_traffic, waypoint_buffer, current_waypoint);
-          if (!current_waypoint->CheckJunction()) {
-            past_junction = true;
-            junction_end_point = current_waypoint;
-          }
-        } else {
-          abort = true;
-        }
-      }
-
-      while (!safe_point_found && !abort) {
-        std::vector<SimpleWaypointPtr> next_waypoints = current_waypoint->GetNextWaypoint();
-        if ((junction_end_point->DistanceSquared(current_waypoint) > safe_distance_squared)
-            || next_waypoints.size() > 1
-            || current_waypoint->CheckJunction()) {
-
-          safe_point_found = true;
-          safe_point_after_junction = current_waypoint;
-        } else {
-          if (!next_waypoints.empty()) {
-            current_waypoint = next_waypoints.front();
-            PushWaypoint(actor_id, track_traffic, waypoint_buffer, current_waypoint);
-          } else {
-            abort = true;
-          }
-        }
+      const SafeSpaceExtension &extension =
+          GetSafeSpaceExtension(current_waypoint->GetSharedPtr(), past_junction ? junction_end_point : nullptr);
+      for (const SimpleWaypointPtr &waypoint : extension.waypoints) {
+        PushWaypoint(actor_id, track_traffic, waypoint_buffer, waypoint.get());
       }
+      junction_end_point = extension.junction_end_point;
+      safe_point_after_junction = extension.safe_point;
     }
 
     if (junction_end_point != nullptr &&
@@ -335,6 +312,100 @@ void LocalizationStage::RemoveActor(ActorId actor_id) {
 void LocalizationStage::Reset() {
   last_lane_change_swpt.clear();
   vehicles_at_junction.clear();
+  ClearStepCache();
+}
+
+void LocalizationStage::ClearStepCache() {
+  change_over_chains.clear();
+  safe_space_extensions.clear();
+}
+
+SimpleWaypointPtr LocalizationStage::GetChangeOverPoint(const SimpleWaypointPtr &starting_point,
+                                                        const float change_over_distance) {
+
+  auto chain_it = change_over_chains.find(starting_point->GetId());
+  if (chain_it == change_over_chains.end()) {
+    // 一次走到最大变道距离或交叉口为止，之后任意不超过该距离的查询都可以在链上完成
+    NodeList chain = {starting_point};
+    SimpleWaypointPtr current_waypoint = starting_point;
+    while (current_waypoint->DistanceSquared(starting_point) < SQUARE(MAX_WPT_DISTANCE) &&
+           !current_waypoint->CheckJunction()) {
+      const NodeList next_waypoints = current_waypoint->GetNextWaypoint();
+      if (next_waypoints.empty()) {
+        break;
+      }
+      current_waypoint = next_waypoints.front();
+      chain.push_back(current_waypoint);
+    }
+    chain_it = change_over_chains.emplace(starting_point->GetId(), std::move(chain)).first;
+  }
+
+  // 与逐点前进相同：返回第一个距离起点足够远或位于交叉口内的路点
+  const NodeList &chain = chain_it->second;
+  for (const SimpleWaypointPtr &waypoint : chain) {
+    if (waypoint->DistanceSquared(starting_point) >= SQUARE(change_over_distance) ||
+        waypoint->CheckJunction()) {
+      return waypoint;
+    }
+  }
+  return chain.back();
+}
+
+const LocalizationStage::SafeSpaceExtension &LocalizationStage::GetSafeSpaceExtension(
+    const SimpleWaypointPtr &current_waypoint,
+    const SimpleWaypointPtr &junction_end_point) {
+
+  const bool past_junction_at_start = junction_end_point != nullptr;
+  const SafeSpaceKey key = std::make_tuple(current_waypoint->GetId(),
+                                           past_junction_at_start,
+                                           past_junction_at_start ? junction_end_point->GetId() : 0u);
+  auto extension_it = safe_space_extensions.find(key);
+  if (extension_it != safe_space_extensions.end()) {
+    return extension_it->second;
+  }
+
+  SafeSpaceExtension extension;
+  extension.junction_end_point = junction_end_point;
+  const float safe_distance_squared = SQUARE(SAFE_DISTANCE_AFTER_JUNCTION);
+  SimpleWaypointPtr waypoint = current_waypoint;
+  bool past_junction = past_junction_at_start;
+  bool abort = false;
+
+  // 沿首个后继路点驶出交叉口
+  while (!past_junction && !abort) {
+    NodeList next_waypoints = waypoint->GetNextWaypoint();
+    if (!next_waypoints.empty()) {
+      waypoint = next_waypoints.front();
+      extension.waypoints.push_back(waypoint);
+      if (!waypoint->CheckJunction()) {
+        past_junction = true;
+        extension.junction_end_point = waypoint;
+      }
+    } else {
+      abort = true;
+    }
+  }
+
+  // 继续前进，直到远离交叉口末端、遇到分岔或进入下一个交叉口
+  while (!extension.safe_point_found && !abort) {
+    NodeList next_waypoints = waypoint->GetNextWaypoint();
+    if ((extension.junction_end_point->DistanceSquared(waypoint) > safe_distance_squared)
+        || next_waypoints.size() > 1
+        || waypoint->CheckJunction()) {
+
+      extension.safe_point_found = true;
+      extension.safe_point = waypoint;
+    } else {
+      if (!next_waypoints.empty()) {
+        waypoint = next_waypoints.front();
+        extension.waypoints.push_back(waypoint);
+      } else {
+        abort = true;
+      }
+    }
+  }
+
+  return safe_space_extensions.emplace(key, std::move(extension)).first->second;
 }
 
 SimpleWaypointPtr LocalizationStage::AssignLaneChange(const ActorId actor_id,
@@ -352,7 +423,7 @@ SimpleWaypointPtr LocalizationStage::AssignLaneChange(const ActorId actor_id,
   // 检查缓冲区是否不为空
   if (!waypoint_buffer.empty()) {
     // 获取当前最近航点的左右航点
-    const SimpleWaypointPtr &current_waypoint = waypoint_buffer.front();
+    SimpleWaypoint *current_waypoint = waypoint_buffer.front();
     const SimpleWaypointPtr left_waypoint = current_waypoint->GetLeftWaypoint();
     const SimpleWaypointPtr right_waypoint = current_waypoint->GetRightWaypoint();
 
@@ -370,7 +441,7 @@ SimpleWaypointPtr LocalizationStage::AssignLaneChange(const ActorId actor_id,
       // 在缓冲区地图中查找车辆，并检查其缓冲区是否不为空
       if (buffer_map.find(other_actor_id) != buffer_map.end() && !buffer_map.at(other_actor_id).empty()) {
         const Buffer &other_buffer = buffer_map.at(other_actor_id);
-        const SimpleWaypointPtr &other_current_waypoint = other_buffer.front();
+        const SimpleWaypoint *other_current_waypoint = other_buffer.front();
         const cg::Location other_location = other_current_waypoint->GetLocation();
 
         const cg::Vector3D reference_heading = current_waypoint->GetForwardVector();
@@ -406,7 +477,7 @@ SimpleWaypointPtr LocalizationStage::AssignLaneChange(const ActorId actor_id,
     // 如果发现有效的即时障碍
     if (!obstacle_too_close && obstacle_actor_id != 0u && !force) {
       const Buffer &other_buffer = buffer_map.at(obstacle_actor_id);
-      const SimpleWaypointPtr &other_current_waypoint = other_buffer.front();
+      SimpleWaypoint *other_current_waypoint = other_buffer.front();
       const auto other_neighbouring_lanes = {other_current_waypoint->GetLeftWaypoint(),
                                              other_current_waypoint->GetRightWaypoint()};
 
@@ -418,7 +489,7 @@ SimpleWaypointPtr LocalizationStage::AssignLaneChange(const ActorId actor_id,
       bool left_right = true;
       for (auto &candidate_lane_wp : other_neighbouring_lanes) {
         if (candidate_lane_wp != nullptr &&
-            track_traffic.GetPassingVehicles(candidate_lane_wp->GetId()).size() == 0) {
+            !track_traffic.HasPassingVehicles(candidate_lane_wp->GetId())) {
 
           if (left_right)
             distant_left_lane_free = true;
@@ -431,10 +502,10 @@ SimpleWaypointPtr LocalizationStage::AssignLaneChange(const ActorId actor_id,
       //基于障碍物附近哪些车道是空闲的，
       // 找到没有车辆通过的变更点
       if (distant_right_lane_free && right_waypoint != nullptr
-          && track_traffic.GetPassingVehicles(right_waypoint->GetId()).size() == 0) {
+          && !track_traffic.HasPassingVehicles(right_waypoint->GetId())) {
         change_over_point = right_waypoint;
       } else if (distant_left_lane_free && left_waypoint != nullptr
-               && track_traffic.GetPassingVehicles(left_waypoint->GetId()).size() == 0) {
+               && !track_traffic.HasPassingVehicles(left_waypoint->GetId())) {
         change_over_point = left_waypoint;
       }
     } else if (force) {
@@ -447,11 +518,7 @@ SimpleWaypointPtr LocalizationStage::AssignLaneChange(const ActorId actor_id,
 
     if (change_over_point != nullptr) {
       const float change_over_distance = cg::Math::Clamp(1.5f * vehicle_speed, MIN_WPT_DISTANCE, MAX_WPT_DISTANCE);
-      const SimpleWaypointPtr starting_point = change_over_point;
-      while (change_over_point->DistanceSquared(starting_point) < SQUARE(change_over_distance) &&
-             !change_over_point->CheckJunction()) {
-        change_over_point = change_over_point->GetNextWaypoint().front();
-      }
+      change_over_point = GetChangeOverPoint(change_over_point, change_over_distance);
     }
   }
 
@@ -476,7 +543,7 @@ void LocalizationStage::ImportPath(Path &imported_path, Buffer &waypoint_buffer,
     //我们需要生成一条与TM航点兼容的路径
     while (!imported_path.empty() && waypoint_buffer.back()->DistanceSquared(waypoint_buffer.front()) <= horizon_square) {
       // 获取我们添加到列表中的最新点。如果从起点开始，这将是与车辆位置相关的点
-      SimpleWaypointPtr latest_waypoint = waypoint_buffer.back();
+      const SimpleWaypoint *latest_waypoint = waypoint_buffer.back();
 
       // 尝试将最新的航点与导入的航点进行关联
       std::vector<SimpleWaypointPtr> next_waypoints = latest_waypoint->GetNextWaypoint();
@@ -523,13 +590,13 @@ void LocalizationStage::ImportPath(Path &imported_path, Buffer &waypoint_buffer,
         std::vector<SimpleWaypointPtr> possible_waypoints = next_wp_selection->GetNextWaypoint();
         if (std::find(possible_waypoints.begin(), possible_waypoints.end(), imported) != possible_waypoints.end()) {
           //如果正在变道，只需推送新的路径点
-          PushWaypoint(actor_id, track_traffic, waypoint_buffer, next_wp_selection);
+          PushWaypoint(actor_id, track_traffic, waypoint_buffer, next_wp_selection.get());
         }
-        PushWaypoint(actor_id, track_traffic, waypoint_buffer, imported);
+        PushWaypoint(actor_id, track_traffic, waypoint_buffer, imported.get());
         latest_imported = imported_path.front();
         imported = local_map->GetWaypoint(latest_imported);
       } else {
-        PushWaypoint(actor_id, track_traffic, waypoint_buffer, next_wp_selection);
+        PushWaypoint(actor_id, track_traffic, waypoint_buffer, next_wp_selection.get());
       }
     }
     if (imported_path.empty()) {
@@ -555,7 +622,7 @@ void LocalizationStage::ImportRoute(Route &imported_actions, Buffer &waypoint_bu
     RoadOption next_road_option = static_cast<RoadOption>(imported_actions.front());
     while (!imported_actions.empty() && waypoint_buffer.back()->DistanceSquared(waypoint_buffer.front()) <= horizon_square) {
       // 获取我们添加到列表中的最新点。如果是起点，这将是与车辆位置相关的点
-      SimpleWaypointPtr latest_waypoint = waypoint_buffer.back();
+      SimpleWaypoint *latest_waypoint = waypoint_buffer.back();
       RoadOption latest_road_option = latest_waypoint->GetRoadOption();
       // 尝试将最新的航点与正确的下一个路线选项关联起来
       std::vector<SimpleWaypointPtr> next_waypoints = latest_waypoint->GetNextWaypoint();
@@ -580,7 +647,7 @@ void LocalizationStage::ImportRoute(Route &imported_actions, Buffer &waypoint_bu
       }
 
       SimpleWaypointPtr next_wp_selection = next_waypoints.at(selection_index);
-      PushWaypoint(actor_id, track_traffic, waypoint_buffer, next_wp_selection);
+      PushWaypoint(actor_id, track_traffic, waypoint_buffer, next_wp_selection.get());
 
       // 如果我们正在切换到新的道路选项，这意味着当前的道路选项已经完全导入
       if (latest_road_option != next_wp_selection->GetRoadOption() && next_road_option == next_wp_selection->GetRoadOption()) {
@@ -636,7 +703,7 @@ ActionBuffer LocalizationStage::ComputeActionBuffer(const ActorId& actor_id) {
   ActionBuffer action_buffer;
   Action lane_change;
   bool is_lane_change = false;
-  SimpleWaypointPtr buffer_front = waypoint_buffer.front();
+  SimpleWaypoint *buffer_front = waypoint_buffer.front();
   RoadOption last_road_opt = buffer_front->GetRoadOption();
   action_buffer.push_back(std::make_pair(last_road_opt, buffer_front->GetWaypoint()));
   if (last_lane_change_swpt.find(actor_id) != last_lane_change_swpt.end()) {
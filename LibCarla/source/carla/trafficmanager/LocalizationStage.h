@@ -1,7 +1,9 @@
 
 #pragma once
 
+#include <map>  // 引入有序映射头文件
 #include <memory>  // 引入智能指针头文件
+#include <tuple>  // 引入元组头文件
 
 #include "carla/trafficmanager/DataStructures.h"  // 引入数据结构定义
 #include "carla/trafficmanager/InMemoryMap.h"  // 引入内存地图相关定义
@@ -44,6 +46,31 @@ private:
   std::unordered_map<ActorId, SimpleWaypointPair> vehicles_at_junction_entrance;  // 存储在交叉口入口的车辆及路径点对
   RandomGenerator &random_device;  // 引用随机数生成器
 
+  /// 从交叉口缓冲区末端沿首个后继路点向前扩展的结果，只取决于地图
+  struct SafeSpaceExtension {
+    NodeList waypoints;  // 需要依次压入缓冲区的路点
+    SimpleWaypointPtr junction_end_point = nullptr;  // 驶出交叉口后的第一个路点
+    SimpleWaypointPtr safe_point = nullptr;  // 交叉口后的安全点
+    bool safe_point_found = false;  // 扩展是否找到了安全点
+  };
+  // 扩展的键：(起始路点ID, 是否已驶出交叉口, 交叉口末端路点ID)
+  using SafeSpaceKey = std::tuple<uint64_t, bool, uint64_t>;
+
+  // 以下缓存只在一步内有效，同一路段上的车辆共享沿路点图的搜索结果。
+  // 缓存的都是只取决于地图拓扑的结果，占用情况仍对每辆车实时查询，
+  // 因此命中与否不影响输出
+  // 变道时从相邻车道路点出发沿首个后继路点的链，长度不超过最大变道距离
+  std::unordered_map<uint64_t, NodeList> change_over_chains;
+  std::map<SafeSpaceKey, SafeSpaceExtension> safe_space_extensions;
+
+  // 返回从相邻车道路点 @a starting_point 前进 @a change_over_distance 后的变道目标点
+  SimpleWaypointPtr GetChangeOverPoint(const SimpleWaypointPtr &starting_point,
+                                       const float change_over_distance);
+
+  // 返回从 @a current_waypoint 出发扩展缓冲区直到交叉口后安全点的搜索结果
+  const SafeSpaceExtension &GetSafeSpaceExtension(const SimpleWaypointPtr &current_waypoint,
+                                                  const SimpleWaypointPtr &junction_end_point);
+
   // 分配车道变更路径点
   SimpleWaypointPtr AssignLaneChange(const ActorId actor_id,
                                      const cg::Location vehicle_location,
@@ -88,6 +115,9 @@ public:
   // 重置方法
   void Reset() override;
 
+  // 结束当前步，清除只在一步内有效的路径搜索缓存
+  void ClearStepCache();
+
   // 计算下一个动作
   Action ComputeNextAction(const ActorId &actor_id);
 
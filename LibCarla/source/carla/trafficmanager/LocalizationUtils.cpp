@@ -38,7 +38,7 @@ float DeviationDotProduct(const cg::Location &reference_location, // 参考位
 
 // 将一个航点添加到缓冲区并更新经过的车辆信息
 void PushWaypoint(ActorId actor_id, TrackTraffic &track_traffic, // 车辆ID和交通轨迹引用
-                  Buffer &buffer, SimpleWaypointPtr &waypoint) { // 缓冲区和航点指针
+                  Buffer &buffer, SimpleWaypoint *waypoint) { // 缓冲区和航点指针
   const uint64_t waypoint_id = waypoint->GetId(); // 获取航点ID
   buffer.push_back(waypoint); // 将航点添加到缓冲区
   track_traffic.UpdatePassingVehicle(waypoint_id, actor_id); // 更新经过该航点的车辆信息
@@ -47,7 +47,7 @@ void PushWaypoint(ActorId actor_id, TrackTraffic &track_traffic, // 车辆ID和
 // 从缓冲区中移除一个航点并更新经过的车辆信息
 void PopWaypoint(ActorId actor_id, TrackTraffic &track_traffic, // 车辆ID和交通轨迹引用
                  Buffer &buffer, bool front_or_back) { // 缓冲区和方向标志（前或后）
-  SimpleWaypointPtr removed_waypoint = front_or_back ? buffer.front() : buffer.back(); // 根据方向选择移除的航点
+  const SimpleWaypoint *removed_waypoint = front_or_back ? buffer.front() : buffer.back(); // 根据方向选择移除的航点
   const uint64_t removed_waypoint_id = removed_waypoint->GetId(); // 获取被移除航点的ID
   if (front_or_back) { // 如果是前方
     buffer.pop_front(); // 移除前方航点
@@ -59,8 +59,8 @@ void PopWaypoint(ActorId actor_id, TrackTraffic &track_traffic, // 车辆ID和
 
 // 获取目标航点及其索引
 TargetWPInfo GetTargetWaypoint(const Buffer &waypoint_buffer, const float &target_point_distance) { // 缓冲区和目标距离
-  SimpleWaypointPtr target_waypoint = waypoint_buffer.front(); // 初始化目标航点为缓冲区的第一个航点
-  const SimpleWaypointPtr &buffer_front = waypoint_buffer.front(); // 获取缓冲区的前端航点
+  SimpleWaypoint *target_waypoint = waypoint_buffer.front(); // 初始化目标航点为缓冲区的第一个航点
+  const SimpleWaypoint *buffer_front = waypoint_buffer.front(); // 获取缓冲区的前端航点
   uint64_t startPosn = static_cast<uint64_t>(std::fabs(target_point_distance * INV_MAP_RESOLUTION)); // 计算起始位置
   uint64_t index = startPosn; // 初始化索引为起始位置
   
@@ -27,7 +27,7 @@ namespace traffic_manager {
   using ActorId = carla::ActorId;  // 定义 ActorId 类型
   using ActorIdSet = std::unordered_set<ActorId>;  // 定义 ActorId 集合
   using SimpleWaypointPtr = std::shared_ptr<SimpleWaypoint>;  // 定义简单路点的智能指针类型
-  using Buffer = std::deque<SimpleWaypointPtr>;  // 定义缓冲区为简单路点的双端队列
+  using Buffer = WaypointBuffer;  // 定义缓冲区为简单路点的环形缓冲区
   using GeoGridId = carla::road::JuncId;  // 定义地理网格ID为道路交叉口ID
   using constants::Map::MAP_RESOLUTION;  // 引入地图分辨率常量
   using constants::Map::INV_MAP_RESOLUTION;  // 引入地图反分辨率常量
@@ -43,14 +43,14 @@ namespace traffic_manager {
 
   // 将一个路点添加到路径缓冲区并更新路点跟踪
   void PushWaypoint(ActorId actor_id, TrackTraffic& track_traffic,
-                    Buffer& buffer, SimpleWaypointPtr& waypoint);
+                    Buffer& buffer, SimpleWaypoint *waypoint);
 
   // 从路径缓冲区中移除一个路点并更新路点跟踪
   void PopWaypoint(ActorId actor_id, TrackTraffic& track_traffic,
                    Buffer& buffer, bool front_or_back=true);
 
   /// 根据目标点距离从路点缓冲区返回路点信息
-  using TargetWPInfo = std::pair<SimpleWaypointPtr, uint64_t>;  // 定义目标路点信息为简单路点指针和无符号整数对
+  using TargetWPInfo = std::pair<SimpleWaypoint *, uint64_t>;  // 定义目标路点信息为缓冲区中的路点指针和无符号整数对
   TargetWPInfo GetTargetWaypoint(const Buffer& waypoint_buffer, const float& target_point_distance);  // 获取目标路点函数
 
 } // namespace traffic_manager
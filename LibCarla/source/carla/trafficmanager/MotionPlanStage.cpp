@@ -63,22 +63,23 @@ MotionPlanStage::MotionPlanStage(
 // 参数 index：一个无符号长整型参数，可能用于在一些容器（比如存储车辆相关信息的数组或向量等）中定位特定车辆对应的索引位置，从而获取该车辆的相关信息进行后续处理
 void MotionPlanStage::Update(const unsigned long index) {    
   const ActorId actor_id = vehicle_id_list.at(index); // 根据传入的索引 index，从 vehicle_id_list 中获取对应的车辆 ID（ActorId 类型，可能是用于唯一标识模拟中的车辆等角色的类型）
-  const cg::Location vehicle_location = simulation_state.GetLocation(actor_id); // 通过 simulation_state 对象，根据获取到的车辆 ID（actor_id）获取车辆当前的位置信息（cg::Location 类型，可能包含了车辆在三维空间中的坐标等位置相关数据）
-    const cg::Location vehicle_location = simulation_state.GetLocation(actor_id);    // 同样通过 simulation_state 对象，依据车辆 ID 获取车辆当前的速度信息（cg::Vector3D 类型，以三维向量形式表示速度的大小和方向）
-  const cg::Vector3D vehicle_velocity = simulation_state.GetVelocity(actor_id); 
+  // 只进行一次哈希查找得到该车辆在状态表中的槽位，随后直接读取各列
+  const size_t slot = simulation_state.GetSlot(actor_id);
+  const cg::Location vehicle_location = simulation_state.GetLocations()[slot]; // 通过 simulation_state 对象，根据获取到的车辆 ID（actor_id）获取车辆当前的位置信息（cg::Location 类型，可能包含了车辆在三维空间中的坐标等位置相关数据）
+  const cg::Vector3D vehicle_velocity = simulation_state.GetVelocities()[slot]; 
 // 通过 simulation_state 对象，按照车辆 ID 获取车辆当前的旋转状态信息（cg::Rotation 类型，可能涉及车辆在空间中的朝向角度等旋转相关数据）
-  const cg::Rotation vehicle_rotation = simulation_state.GetRotation(actor_id);// 通过 simulation_state 对象，按照车辆 ID 获取车辆当前的旋转状态信息（cg::Rotation 类型，可能涉及车辆在空间中的朝向角度等旋转相关数据）
+  const cg::Rotation vehicle_rotation = simulation_state.GetRotations()[slot];// 通过 simulation_state 对象，按照车辆 ID 获取车辆当前的旋转状态信息（cg::Rotation 类型，可能涉及车辆在空间中的朝向角度等旋转相关数据）
   const float vehicle_speed = vehicle_velocity.Length();// 计算车辆当前的速度大小（标量值），通过调用 vehicle_velocity 的 Length 函数获取其长度（即速度大小），这里的速度单位可能根据具体模拟场景设定（比如米/秒等）
-  const cg::Vector3D vehicle_heading = simulation_state.GetHeading(actor_id);// 通过 simulation_state 对象，依据车辆 ID 获取车辆当前的行驶方向信息（cg::Vector3D 类型，以三维向量形式表示车辆车头的朝向方向）
-  const bool vehicle_physics_enabled = simulation_state.IsPhysicsEnabled(actor_id); // 通过 simulation_state 对象，根据车辆 ID 判断车辆的物理模拟是否启用（返回布尔值，例如在某些模拟场景中车辆可能处于暂停物理模拟或者只做轨迹演示等情况时物理模拟是关闭的）
-  const float vehicle_speed_limit = simulation_state.GetSpeedLimit(actor_id);    // 通过 simulation_state 对象，按照车辆 ID 获取车辆当前所在位置的速度限制信息（返回浮点数，例如该路段规定的最大行驶速度，单位可能根据模拟场景设定）
+  const cg::Vector3D vehicle_heading = simulation_state.GetHeadings()[slot];// 通过 simulation_state 对象，依据车辆 ID 获取车辆当前的行驶方向信息（cg::Vector3D 类型，以三维向量形式表示车辆车头的朝向方向）
+  const bool vehicle_physics_enabled = (simulation_state.GetFlags()[slot] & PHYSICS_ENABLED) != 0u; // 通过 simulation_state 对象，根据车辆 ID 判断车辆的物理模拟是否启用（返回布尔值，例如在某些模拟场景中车辆可能处于暂停物理模拟或者只做轨迹演示等情况时物理模拟是关闭的）
+  const float vehicle_speed_limit = simulation_state.GetSpeedLimits()[slot];    // 通过 simulation_state 对象，按照车辆 ID 获取车辆当前所在位置的速度限制信息（返回浮点数，例如该路段规定的最大行驶速度，单位可能根据模拟场景设定）
   const Buffer &waypoint_buffer = buffer_map.at(actor_id); // 根据车辆 ID，从 buffer_map 中获取对应的缓冲区数据（Buffer 类型，具体缓冲区的作用可能与车辆的路径规划、临时存储一些周边环境信息等相关，取决于具体实现）
   const LocalizationData &localization = localization_frame.at(index);    
   // 根据传入的索引 index，从 localization_frame 中获取对应的车辆定位数据（LocalizationData 类型，包含更详细的车辆定位相关信息，比如定位精度、定位方式等补充数据）
   const CollisionHazardData &collision_hazard = collision_frame.at(index);  // 根据传入的索引 index，从 collision_frame 中获取对应的车辆碰撞危险数据（CollisionHazardData 类型，包含车辆周围是否存在碰撞风险、碰撞危险程度等相关详细信息）
   const bool &tl_hazard = tl_frame.at(index);// 根据传入的索引 index，从 tl_frame 中获取对应的交通信号灯相关危险信息（返回布尔值，用于判断当前车辆是否面临因交通信号灯产生的危险情况，比如即将闯红灯等）
-  current_timestamp = world.GetSnapshot().GetTimestamp();  // 获取当前世界的时间戳信息，通过 world 对象调用 GetSnapshot 函数获取世界的一个快照（可能包含了当前世界的各种状态信息），再从快照中获取时间戳（用于记录当前操作或者决策所处的时间点）
-  StateEntry current_state;// 这里声明了一个 StateEntry 类型的变量 current_state，但后续代码缺失，不清楚具体用途，可能用于记录当前车辆或者整个模拟系统的某种状态信息，等待进一步赋值和使用
+  // 本车的结果槽位，需要修改共享状态的部分记录在这里，由 CommitStep 完成
+  PlanEntry &plan = plan_entries.at(index);
 
   // 实例化传送变换为当前载具变换
   cg::Transform teleportation_transform = cg::Transform(vehicle_location, vehicle_rotation);
@@ -88,48 +89,8 @@ void MotionPlanStage::Update(const unsigned long index) {
   bool is_hero_alive = hero_location != cg::Location(0, 0, 0);
 
   if (simulation_state.IsDormant(actor_id) && parameters.GetRespawnDormantVehicles() && is_hero_alive) {
-    // 冲洗车辆的控制器状态
-    current_state = {current_timestamp,
-                    0.0f, 0.0f,
-                    0.0f};
-
-    // 如果表中不存在，则将条目添加到传送持续时间时钟表中
-    if (teleportation_instance.find(actor_id) == teleportation_instance.end()) {
-      teleportation_instance.insert({actor_id, current_timestamp});
-    }
-
-    // 获取传送载具的下限和上限
-    float lower_bound = parameters.GetLowerBoundaryRespawnDormantVehicles();
-    float upper_bound = parameters.GetUpperBoundaryRespawnDormantVehicles();
-    float dilate_factor = (upper_bound-lower_bound)/100.0f;
-
-    // 测量车辆自上次传送以来所经过的时间
-    double elapsed_time = current_timestamp.elapsed_seconds - teleportation_instance.at(actor_id).elapsed_seconds;
-
-    if (parameters.GetSynchronousMode() || elapsed_time > HYBRID_MODE_DT) {
-      float random_sample = (static_cast<float>(random_device.next())*dilate_factor) + lower_bound;
-      NodeList teleport_waypoint_list = local_map->GetWaypointsInDelta(hero_location, ATTEMPTS_TO_TELEPORT, random_sample);
-      if (!teleport_waypoint_list.empty()) {
-        for (auto &teleport_waypoint : teleport_waypoint_list) {
-          GeoGridId geogrid_id = teleport_waypoint->GetGeodesicGridId();
-          if (track_traffic.IsGeoGridFree(geogrid_id)) {
-            teleportation_transform = teleport_waypoint->GetTransform();
-            teleportation_transform.location.z += 0.5f;
-            track_traffic.AddTakenGrid(geogrid_id, actor_id);
-            break;
-          }
-        }
-      }
-    }
-    output_array.at(index) = carla::rpc::Command::ApplyTransform(actor_id, teleportation_transform);
-
-    // 在传送车辆后，使用新的变换更新模拟状态
-    KinematicState kinematic_state{teleportation_transform.location,
-                                   teleportation_transform.rotation,
-                                   vehicle_velocity, vehicle_speed_limit,
-                                   vehicle_physics_enabled, simulation_state.IsDormant(actor_id),
-                                   teleportation_transform.location};
-    simulation_state.UpdateKinematicState(actor_id, kinematic_state);
+    // 重生需要占用共享的地理网格，推迟到 CommitStep 中按索引顺序执行
+    plan.kind = PlanKind::Respawn;
   }
 
   else {
@@ -157,11 +118,10 @@ void MotionPlanStage::Update(const unsigned long index) {
     bool emergency_stop = tl_hazard || collision_emergency_stop || !safe_after_junction;
 
     if (vehicle_physics_enabled && !simulation_state.IsDormant(actor_id)) {// 判断车辆的物理模拟是否启用（vehicle_physics_enabled为true表示启用），并且车辆是否处于休眠状态（!simulation_state.IsDormant(actor_id)表示非休眠状态）
-      ActuationSignal actuation_signal{0.0f, 0.0f, 0.0f};// 创建一个ActuationSignal类型的结构体（或类）对象actuation_signal，并初始化为{0.0f, 0.0f, 0.0f}
 
       const float target_point_distance = std::max(vehicle_speed * TARGET_WAYPOINT_TIME_HORIZON,
                                                   MIN_TARGET_WAYPOINT_DISTANCE);// 计算目标点距离，取车辆速度乘以TARGET_WAYPOINT_TIME_HORIZON（目标路点时间范围，可能表示预测的未来某个时间段）
-      const SimpleWaypointPtr &target_waypoint = GetTargetWaypoint(waypoint_buffer, target_point_distance).first;// 调用GetTargetWaypoint函数，传入路点缓冲区（waypoint_buffer）和刚计算出的目标点距离（target_point_distance），
+      SimpleWaypoint *target_waypoint = GetTargetWaypoint(waypoint_buffer, target_point_distance).first;// 调用GetTargetWaypoint函数，传入路点缓冲区（waypoint_buffer）和刚计算出的目标点距离（target_point_distance），
       cg::Location target_location = target_waypoint->GetLocation();    // 获取目标路点的位置信息（cg::Location类型，可能包含三维坐标等位置相关数据），赋值给target_location变量
 
       float offset = parameters.GetLaneOffset(actor_id); // 获取车辆在车道上的偏移量，通过parameters对象调用GetLaneOffset函数，传入车辆ID（actor_id）获取对应的车道偏移量，
@@ -181,75 +141,33 @@ void MotionPlanStage::Update(const unsigned long index) {
       const float angular_deviation = dot_product; // 将处理后的点积值赋值给angular_deviation变量，从变量名推测它表示车辆与目标位置之间的角度偏差
       const float velocity_deviation = (dynamic_target_velocity - vehicle_speed) / dynamic_target_velocity; 
 // 计算速度偏差，用动态目标速度（dynamic_target_velocity，可能是根据路况、规划等因素设定的车辆期望达到的目标速度）减去车辆当前速度（vehicle_speed）
-      // 如果未找到车辆的上一个状态，则初始化状态条目
-      if (pid_state_map.find(actor_id) == pid_state_map.end()) {
-        const auto initial_state = StateEntry{current_timestamp, 0.0f, 0.0f, 0.0f};
-        pid_state_map.insert({actor_id, initial_state});
-      }
-
-      // 检索先前状态
-      traffic_manager::StateEntry previous_state;
-      previous_state = pid_state_map.at(actor_id);
-
-      // 选择PID参数
-      std::vector<float> longitudinal_parameters;
-      std::vector<float> lateral_parameters;
-      if (vehicle_speed > HIGHWAY_SPEED) {
-        longitudinal_parameters = highway_longitudinal_parameters;
-        lateral_parameters = highway_lateral_parameters;
-      } else {
-        longitudinal_parameters = urban_longitudinal_parameters;
-        lateral_parameters = urban_lateral_parameters;
-      }
-
       //如果为车辆启用了物理效果，请使用PID控制器
-      // 车辆状态更新
-      current_state = {current_timestamp, angular_deviation, velocity_deviation, 0.0f};
-
-      // 控制器驱动
-      actuation_signal = PID::RunStep(current_state, previous_state,
-                                      longitudinal_parameters, lateral_parameters);
-
-      if (emergency_stop) {
-        actuation_signal.throttle = 0.0f;
-        actuation_signal.brake = 1.0f;
-      }
-
-      // 构建执行信号
-
-      carla::rpc::VehicleControl vehicle_control;
-      vehicle_control.throttle = actuation_signal.throttle;
-      vehicle_control.brake = actuation_signal.brake;
-      vehicle_control.steer = actuation_signal.steer;
-
-      output_array.at(index) = carla::rpc::Command::ApplyVehicleControl(actor_id, vehicle_control);
-
-      // 更新PID状态
-      current_state.steer = actuation_signal.steer;
-      StateEntry &state = pid_state_map.at(actor_id);
-      state = current_state;
+      // 车辆状态更新，PID 状态表在 CommitStep 中读取和初始化
+      plan.kind = PlanKind::Controller;
+      plan.current_state = {current_timestamp, angular_deviation, velocity_deviation, 0.0f};
+      plan.highway = vehicle_speed > HIGHWAY_SPEED;
+      plan.emergency_stop = emergency_stop;
     }
     // 对于无物理特性的载具，确定传送时的位置和方向
     else {
-      // 冲洗车辆的控制器状态
-      current_state = {current_timestamp,
-                      0.0f, 0.0f,
-                      0.0f};
-
-      // 如果不在表中，则将条目添加到传送持续时间时钟表中
-      if (teleportation_instance.find(actor_id) == teleportation_instance.end()) {
-        teleportation_instance.insert({actor_id, current_timestamp});
+      plan.kind = PlanKind::Hybrid;
+
+      // 测量车辆自上次传送以来的时间。不在表中的车辆在 CommitStep 中以当前时间加入表中，
+      // 因此经过的时间为0
+      double elapsed_time = 0.0;
+      const auto teleportation_it = teleportation_instance.find(actor_id);
+      if (teleportation_it == teleportation_instance.end()) {
+        plan.start_teleportation_clock = true;
+      } else {
+        elapsed_time = current_timestamp.elapsed_seconds - teleportation_it->second.elapsed_seconds;
       }
 
-      // 测量车辆自上次传送以来的时间
-      double elapsed_time = current_timestamp.elapsed_seconds - teleportation_instance.at(actor_id).elapsed_seconds;
-
       // 在车辆前方找到一个传送位置，以实现预期的速度
       if (!emergency_stop && (parameters.GetSynchronousMode() || elapsed_time > HYBRID_MODE_DT)) {
 
         // 目标位移量以达到目标速度
         const float target_displacement = dynamic_target_velocity * HYBRID_MODE_DT_FL;
-        SimpleWaypointPtr teleport_target = waypoint_buffer.front();
+        SimpleWaypoint *teleport_target = waypoint_buffer.front();
         cg::Transform target_base_transform = teleport_target->GetTransform();
         cg::Location target_base_location = target_base_transform.location;
         cg::Vector3D target_heading = target_base_transform.GetForwardVector();
@@ -268,13 +186,105 @@ void MotionPlanStage::Update(const unsigned long index) {
       } else {
         teleportation_transform = cg::Transform(vehicle_location, simulation_state.GetRotation(actor_id));
       }
-      // 构建执行信号
-      output_array.at(index) = carla::rpc::Command::ApplyTransform(actor_id, teleportation_transform);
+      // 构建执行信号：服务器在 HYBRID_MODE_DT 内把车辆匀速移到传送位置，而不是在一帧内跳过去
+      const cg::Vector3D kinematic_velocity = (teleportation_transform.location - vehicle_location) / HYBRID_MODE_DT_FL;
+      output_array.at(index) = carla::rpc::Command::ApplyKinematicTarget(actor_id, teleportation_transform, kinematic_velocity);
       simulation_state.UpdateKinematicHybridEndLocation(actor_id, teleportation_transform.location);
     }
   }
 }
 
+void MotionPlanStage::PrepareStep() {
+  current_timestamp = world.GetSnapshot().GetTimestamp();
+  plan_entries.assign(vehicle_id_list.size(), PlanEntry{});
+}
+
+void MotionPlanStage::CommitStep() {
+  for (unsigned long index = 0u; index < plan_entries.size(); ++index) {
+    const PlanEntry &plan = plan_entries[index];
+    const ActorId actor_id = vehicle_id_list.at(index);
+    switch (plan.kind) {
+      case PlanKind::Controller: {
+        // 如果未找到车辆的上一个状态，则初始化状态条目
+        if (pid_state_map.find(actor_id) == pid_state_map.end()) {
+          const auto initial_state = StateEntry{current_timestamp, 0.0f, 0.0f, 0.0f};
+          pid_state_map.insert({actor_id, initial_state});
+        }
+        // 检索先前状态。unordered_map 的元素地址在插入其他元素后仍然有效，
+        // 因此可以保存指针，待 RunControllers 中再写回新的状态
+        StateEntry &previous_state = pid_state_map.at(actor_id);
+        // 控制器驱动推迟到所有车辆的目标计算完成之后，在 RunControllers 中批量执行
+        controller_batch.Push(plan.current_state, previous_state, plan.highway, plan.emergency_stop);
+        controller_indices.push_back(index);
+        controller_states.push_back(&previous_state);
+        break;
+      }
+      case PlanKind::Hybrid:
+        if (plan.start_teleportation_clock) {
+          teleportation_instance.insert({actor_id, current_timestamp});
+        }
+        break;
+      case PlanKind::Respawn:
+        RespawnDormant(index);
+        break;
+      case PlanKind::None:
+        break;
+    }
+  }
+}
+
+void MotionPlanStage::RespawnDormant(const unsigned long index) {
+  const ActorId actor_id = vehicle_id_list.at(index);
+  const size_t slot = simulation_state.GetSlot(actor_id);
+  const cg::Location vehicle_location = simulation_state.GetLocations()[slot];
+  const cg::Rotation vehicle_rotation = simulation_state.GetRotations()[slot];
+  const cg::Vector3D vehicle_velocity = simulation_state.GetVelocities()[slot];
+  const bool vehicle_physics_enabled = (simulation_state.GetFlags()[slot] & PHYSICS_ENABLED) != 0u;
+  const float vehicle_speed_limit = simulation_state.GetSpeedLimits()[slot];
+  const cg::Location hero_location = track_traffic.GetHeroLocation();
+
+  cg::Transform teleportation_transform = cg::Transform(vehicle_location, vehicle_rotation);
+
+  // 如果表中不存在，则将条目添加到传送持续时间时钟表中
+  if (teleportation_instance.find(actor_id) == teleportation_instance.end()) {
+    teleportation_instance.insert({actor_id, current_timestamp});
+  }
+
+  // 获取传送载具的下限和上限
+  float lower_bound = parameters.GetLowerBoundaryRespawnDormantVehicles();
+  float upper_bound = parameters.GetUpperBoundaryRespawnDormantVehicles();
+  float dilate_factor = (upper_bound-lower_bound)/100.0f;
+
+  // 测量车辆自上次传送以来所经过的时间
+  double elapsed_time = current_timestamp.elapsed_seconds - teleportation_instance.at(actor_id).elapsed_seconds;
+
+  if (parameters.GetSynchronousMode() || elapsed_time > HYBRID_MODE_DT) {
+    RandomStream random_stream = random_device.GetStream(actor_id, RandomStreamId::MotionPlan);
+    float random_sample = (static_cast<float>(random_stream.next())*dilate_factor) + lower_bound;
+    NodeList teleport_waypoint_list = local_map->GetWaypointsInDelta(hero_location, ATTEMPTS_TO_TELEPORT, random_sample);
+    if (!teleport_waypoint_list.empty()) {
+      for (auto &teleport_waypoint : teleport_waypoint_list) {
+        GeoGridId geogrid_id = teleport_waypoint->GetGeodesicGridId();
+        if (track_traffic.IsGeoGridFree(geogrid_id)) {
+          teleportation_transform = teleport_waypoint->GetTransform();
+          teleportation_transform.location.z += 0.5f;
+          track_traffic.AddTakenGrid(geogrid_id, actor_id);
+          break;
+        }
+      }
+    }
+  }
+  output_array.at(index) = carla::rpc::Command::ApplyTransform(actor_id, teleportation_transform);
+
+  // 在传送车辆后，使用新的变换更新模拟状态
+  KinematicState kinematic_state{teleportation_transform.location,
+                                 teleportation_transform.rotation,
+                                 vehicle_velocity, vehicle_speed_limit,
+                                 vehicle_physics_enabled, simulation_state.IsDormant(actor_id),
+                                 teleportation_transform.location};
+  simulation_state.UpdateKinematicState(actor_id, kinematic_state);
+}
+
 bool MotionPlanStage::SafeAfterJunction(const LocalizationData &localization,
                                         const bool tl_hazard,
                                         const bool collision_emergency_stop) {// MotionPlanStage类中的成员函数SafeAfterJunction，用于判断车辆在经过路口后是否处于安全状态
@@ -436,9 +446,9 @@ float MotionPlanStage::GetTurnTargetVelocity(const Buffer &waypoint_buffer,// Mo
     return max_target_velocity;
   }
   else {
-    const SimpleWaypointPtr first_waypoint = waypoint_buffer.front();// 获取路点缓冲区中的第一个路点指针（SimpleWaypointPtr类型，指向表示路点的对象，可能包含路点位置、方向等相关信息）
-    const SimpleWaypointPtr last_waypoint = waypoint_buffer.back();  // 获取路点缓冲区中的最后一个路点指针
-    const SimpleWaypointPtr middle_waypoint = waypoint_buffer.at(static_cast<uint16_t>(waypoint_buffer.size() / 2)); 
+    const SimpleWaypoint *first_waypoint = waypoint_buffer.front();// 获取路点缓冲区中的第一个路点指针（指向表示路点的对象，可能包含路点位置、方向等相关信息）
+    const SimpleWaypoint *last_waypoint = waypoint_buffer.back();  // 获取路点缓冲区中的最后一个路点指针
+    const SimpleWaypoint *middle_waypoint = waypoint_buffer.at(static_cast<uint16_t>(waypoint_buffer.size() / 2)); 
 // 获取路点缓冲区中间位置的路点指针，通过将缓冲区大小除以2（转换为合适的无符号16位整数类型）并以此索引获取路点，
 
     float radius = GetThreePointCircleRadius(first_waypoint->GetLocation(),
@@ -495,6 +505,38 @@ float MotionPlanStage::GetThreePointCircleRadius(cg::Location first_location,//
   return std::sqrt(h * h + k * k - c);// 根据圆心坐标（h、k）以及中间变量c，按照圆的半径计算公式（基于圆的标准方程推导而来）计算并返回圆的半径
 }
 
+void MotionPlanStage::RunControllers() {
+  const size_t size = controller_batch.Size();
+  if (size > 0u) {
+    PID::RunBatch(controller_batch,
+                  urban_longitudinal_parameters, highway_longitudinal_parameters,
+                  urban_lateral_parameters, highway_lateral_parameters);
+
+    for (size_t i = 0u; i < size; ++i) {
+      const unsigned long index = controller_indices[i];
+      const ActorId actor_id = vehicle_id_list.at(index);
+
+      // 构建执行信号
+      carla::rpc::VehicleControl vehicle_control;
+      vehicle_control.throttle = controller_batch.throttle[i];
+      vehicle_control.brake = controller_batch.brake[i];
+      vehicle_control.steer = controller_batch.steer[i];
+      output_array.at(index) = carla::rpc::Command::ApplyVehicleControl(actor_id, vehicle_control);
+
+      // 更新PID状态
+      StateEntry &state = *controller_states[i];
+      state = {current_timestamp,
+               controller_batch.angular_deviation[i],
+               controller_batch.velocity_deviation[i],
+               controller_batch.steer[i]};
+    }
+  }
+
+  controller_batch.Clear();
+  controller_indices.clear();
+  controller_states.clear();
+}
+
 void MotionPlanStage::RemoveActor(const ActorId actor_id) {// MotionPlanStage类中的成员函数RemoveActor，用于从相关数据结构中移除指定ID的角色（actor，可能是车辆等模拟对象）信息
   pid_state_map.erase(actor_id); 
 // 从pid_state_map数据结构中删除与指定actor_id对应的元素，pid_state_map可能是一个存储了角色ID与某些状态（比如PID控制相关状态等，具体取决于项目定义）映射关系的容器
@@ -505,6 +547,10 @@ void MotionPlanStage::RemoveActor(const ActorId actor_id) {// MotionPlanStage类
 void MotionPlanStage::Reset() {// MotionPlanStage类中的成员函数Reset，用于重置（清空）相关的数据结构，通常在需要重新初始化或者开始新的模拟阶段等场景下使用
   pid_state_map.clear();
   teleportation_instance.clear();
+  controller_batch.Clear();
+  controller_indices.clear();
+  controller_states.clear();
+  plan_entries.clear();
 }
 
 } // namespace traffic_manager
@@ -8,6 +8,7 @@
 #include "carla/trafficmanager/InMemoryMap.h"
 #include "carla/trafficmanager/LocalizationUtils.h"
 #include "carla/trafficmanager/Parameters.h"
+#include "carla/trafficmanager/PIDController.h"
 #include "carla/trafficmanager/RandomGenerator.h"
 #include "carla/trafficmanager/SimulationState.h"
 #include "carla/trafficmanager/Stage.h"
@@ -38,6 +39,10 @@ private:
   const cc::World &world;//获取世界的快照等全局信息
   // Structure holding the controller state for registered vehicles.
   std::unordered_map<ActorId, StateEntry> pid_state_map;
+  // 本步中等待批量执行控制器的车辆：控制器输入、在输出帧中的索引以及对应的控制器状态。
+  PID::ControllerBatch controller_batch;
+  std::vector<unsigned long> controller_indices;
+  std::vector<StateEntry *> controller_states;
   // Structure to keep track of duration between teleportation
   // in hybrid physics mode.
   std::unordered_map<ActorId, cc::Timestamp> teleportation_instance;
@@ -45,6 +50,24 @@ private:
   cc::Timestamp current_timestamp;// 当前时间戳。
   RandomGenerator &random_device;// 引用随机数生成器对象。
   const LocalMapPtr &local_map;// 引用本地地图指针对象。
+  // Update 中每辆车的结果，需要修改共享状态的部分由 CommitStep 按索引顺序完成。
+  enum class PlanKind : uint8_t {
+    None,        // 本步未更新
+    Controller,  // 等待批量执行 PID 控制器
+    Hybrid,      // 混合物理模式下的运动学目标
+    Respawn      // 休眠车辆在英雄车辆附近重生
+  };
+  struct PlanEntry {
+    PlanKind kind = PlanKind::None;
+    StateEntry current_state;
+    bool highway = false;
+    bool emergency_stop = false;
+    // 车辆尚未在传送计时表中
+    bool start_teleportation_clock = false;
+  };
+  std::vector<PlanEntry> plan_entries;
+// 让休眠车辆在英雄车辆附近的空闲位置重生，占用共享的地理网格并修改仿真状态。
+  void RespawnDormant(const unsigned long index);
 // 处理碰撞的私有方法。
   std::pair<bool, float> CollisionHandling(const CollisionHazardData &collision_hazard,
                                            const bool tl_hazard,
@@ -89,7 +112,15 @@ public:
                   const LocalMapPtr &local_map);// 局部地图指针的引用，指向局部地图相关的数据结构，用于获取车辆周边更详细的地图环境信息辅助进行运动规划
  // 这里通常会放置函数具体的实现逻辑代码，来根据传入的这些参数进行运动规划计算，生成相应的控制输出存放在output_array中，但目前函数体内部代码缺失
  // 更新方法，根据给定的索引进行更新。
+// 只读取共享状态，可以在多个线程上对不同的索引并行调用，须在 PrepareStep 之后调用。
   void Update(const unsigned long index);
+// 在本步的 Update 之前调用，读取时间戳并为每辆车准备结果槽位。
+  void PrepareStep();
+// 在所有 Update 之后于同一线程中调用，按索引顺序更新 PID 状态表和传送计时表、
+// 执行休眠车辆的重生，并把控制器输入按索引顺序加入批中。
+  void CommitStep();
+// 对本步中所有启用物理的车辆批量执行PID控制器并写出控制命令，须在所有车辆的 Update 之后调用。
+  void RunControllers();
 // 移除指定 actor 的方法。
   void RemoveActor(const ActorId actor_id);
 // 重置方法。
@@ -6,7 +6,10 @@
 
 #pragma once
 
-##include <algorithm>  // 引入算法库
+#include <algorithm>  // 引入算法库
+#include <cmath>  // 引入数学函数库
+#include <cstdint>  // 引入定宽整数类型
+#include <vector>  // 引入动态数组
 
 #include "carla/trafficmanager/Constants.h"  // 引入常量定义
 #include "carla/trafficmanager/DataStructures.h"  // 引入数据结构定义
@@ -57,6 +60,119 @@ inline ActuationSignal RunStep(StateEntry present_state,  // 当前状态
   return ActuationSignal{throttle, brake, steer};  // 返回执行信号
 }
 
+/// 一步中所有启用物理的车辆的控制器输入和输出。
+/// 每个量按列连续存放，使 RunBatch 中的循环可以被编译器向量化。
+struct ControllerBatch {
+  std::vector<float> angular_deviation;  // 当前角度偏差
+  std::vector<float> velocity_deviation;  // 当前速度偏差
+  std::vector<float> previous_angular_deviation;  // 前一个角度偏差
+  std::vector<float> previous_velocity_deviation;  // 前一个速度偏差
+  std::vector<float> previous_steer;  // 前一个方向盘转角
+  std::vector<uint32_t> highway;  // 是否使用高速公路参数
+  std::vector<uint32_t> emergency_stop;  // 是否紧急停车
+  std::vector<float> throttle;  // 输出油门
+  std::vector<float> brake;  // 输出刹车
+  std::vector<float> steer;  // 输出方向盘转角
+
+  size_t Size() const {
+    return angular_deviation.size();
+  }
+
+  void Clear() {
+    angular_deviation.clear();
+    velocity_deviation.clear();
+    previous_angular_deviation.clear();
+    previous_velocity_deviation.clear();
+    previous_steer.clear();
+    highway.clear();
+    emergency_stop.clear();
+  }
+
+  void Push(const StateEntry &present_state, const StateEntry &previous_state,
+            const bool use_highway_parameters, const bool stop) {
+    angular_deviation.push_back(present_state.angular_deviation);
+    velocity_deviation.push_back(present_state.velocity_deviation);
+    previous_angular_deviation.push_back(previous_state.angular_deviation);
+    previous_velocity_deviation.push_back(previous_state.velocity_deviation);
+    previous_steer.push_back(previous_state.steer);
+    highway.push_back(use_highway_parameters ? 1u : 0u);
+    emergency_stop.push_back(stop ? 1u : 0u);
+  }
+};
+
+/// 对批中的所有车辆一次性执行与 RunStep 相同的计算，结果写入批的输出列。
+/// 循环体中没有分支和查表，参数按车辆选择为城市或高速公路参数。
+inline void RunBatch(ControllerBatch &batch,
+                     const std::vector<float> &urban_longitudinal_parameters,
+                     const std::vector<float> &highway_longitudinal_parameters,
+                     const std::vector<float> &urban_lateral_parameters,
+                     const std::vector<float> &highway_lateral_parameters) {
+
+  const size_t size = batch.Size();
+  batch.throttle.resize(size);
+  batch.brake.resize(size);
+  batch.steer.resize(size);
+
+  const float u_long_p = urban_longitudinal_parameters[0];
+  const float u_long_i = urban_longitudinal_parameters[1];
+  const float u_long_d = urban_longitudinal_parameters[2];
+  const float h_long_p = highway_longitudinal_parameters[0];
+  const float h_long_i = highway_longitudinal_parameters[1];
+  const float h_long_d = highway_longitudinal_parameters[2];
+  const float u_lat_p = urban_lateral_parameters[0];
+  const float u_lat_i = urban_lateral_parameters[1];
+  const float u_lat_d = urban_lateral_parameters[2];
+  const float h_lat_p = highway_lateral_parameters[0];
+  const float h_lat_i = highway_lateral_parameters[1];
+  const float h_lat_d = highway_lateral_parameters[2];
+
+  const float *ad = batch.angular_deviation.data();
+  const float *vd = batch.velocity_deviation.data();
+  const float *pad = batch.previous_angular_deviation.data();
+  const float *pvd = batch.previous_velocity_deviation.data();
+  const float *ps = batch.previous_steer.data();
+  const uint32_t *hw = batch.highway.data();
+  const uint32_t *es = batch.emergency_stop.data();
+  float *throttle = batch.throttle.data();
+  float *brake = batch.brake.data();
+  float *steer = batch.steer.data();
+
+  // 纵向和横向分成两个循环，减少编译器向量化时需要的运行时别名检查
+  for (size_t i = 0u; i < size; ++i) {
+    const bool highway = hw[i] != 0u;
+    const float long_p = highway ? h_long_p : u_long_p;
+    const float long_i = highway ? h_long_i : u_long_i;
+    const float long_d = highway ? h_long_d : u_long_d;
+
+    // 纵向 PID 计算。
+    const float expr_v =
+        long_p * vd[i] +
+        long_i * (vd[i] + pvd[i]) * DT +
+        long_d * (vd[i] - pvd[i]) * INV_DT;
+    const bool accelerate = expr_v > 0.0f;
+    const bool stop = es[i] != 0u;
+    const float t = accelerate ? std::min(expr_v, MAX_THROTTLE) : 0.0f;
+    const float b = accelerate ? 0.0f : std::min(std::abs(expr_v), MAX_BRAKE);
+    throttle[i] = stop ? 0.0f : t;
+    brake[i] = stop ? 1.0f : b;
+  }
+
+  for (size_t i = 0u; i < size; ++i) {
+    const bool highway = hw[i] != 0u;
+    const float lat_p = highway ? h_lat_p : u_lat_p;
+    const float lat_i = highway ? h_lat_i : u_lat_i;
+    const float lat_d = highway ? h_lat_d : u_lat_d;
+
+    // 横向 PID 计算。
+    float s =
+        lat_p * ad[i] +
+        lat_i * (ad[i] + pad[i]) * DT +
+        lat_d * (ad[i] - pad[i]) * INV_DT;
+    s = std::max(ps[i] - MAX_STEERING_DIFF, std::min(s, ps[i] + MAX_STEERING_DIFF));
+    steer[i] = std::max(-MAX_STEERING, std::min(s, MAX_STEERING));
+  }
+}
+
 } // namespace PID
 } // namespace traffic_manager
 } // namespace carla
@@ -10,7 +10,8 @@
 namespace carla {
 namespace traffic_manager {
 
-Parameters::Parameters() {  // 参数构造函数
+Parameters::Parameters()  // 参数构造函数
+  : snapshot(std::make_shared<const ParameterSnapshot>()) {
 
   /// 设置默认的同步模式超时。
   synchronous_time_out = std::chrono::duration<int, std::milli>(10);
@@ -18,6 +19,86 @@ Parameters::Parameters() {  // 参数构造函数
 
 Parameters::~Parameters() {}  // 参数析构函数
 
+void Parameters::PublishSnapshot() {
+  // 没有修改时继续使用当前快照，不产生任何复制
+  if (!pending_dirty.exchange(false)) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(pending_mutex);
+  snapshot = std::make_shared<const ParameterSnapshot>(pending);
+}
+
+void Parameters::ApplySettingsBatch(const VehicleSettingBatch &batch) {
+  if (batch.empty()) {
+    return;
+  }
+  // 整组命令在同一次加锁中写入，不会被某次发布拆开
+  std::lock_guard<std::mutex> lock(pending_mutex);
+  for (const VehicleSettingCommand &command : batch) {
+    ApplyCommand(pending.vehicles[command.actor_id], command);
+  }
+  pending_dirty.store(true);
+}
+
+void Parameters::ApplyCommand(VehicleSettings &settings, const VehicleSettingCommand &command) {
+  const float value = command.value;
+  const bool flag = value != 0.0f;
+  switch (command.setting) {
+    case VehicleSetting::PercentageSpeedDifference:
+      settings.has_percentage_difference_from_speed_limit = true;
+      settings.percentage_difference_from_speed_limit = std::min(100.0f, value);
+      settings.has_exact_desired_speed = false;
+      break;
+    case VehicleSetting::DesiredSpeed:
+      settings.has_exact_desired_speed = true;
+      settings.exact_desired_speed = std::max(0.0f, value);
+      settings.has_percentage_difference_from_speed_limit = false;
+      break;
+    case VehicleSetting::LaneOffset:
+      settings.has_lane_offset = true;
+      settings.lane_offset = value;
+      break;
+    case VehicleSetting::UpdateVehicleLights:
+      settings.auto_update_vehicle_lights = flag;
+      break;
+    case VehicleSetting::CollisionDetection:
+      if (flag) {
+        settings.ignore_collision.erase(command.other_actor_id);
+      } else {
+        settings.ignore_collision.insert(command.other_actor_id);
+      }
+      break;
+    case VehicleSetting::AutoLaneChange:
+      settings.auto_lane_change = flag;
+      break;
+    case VehicleSetting::DistanceToLeadingVehicle:
+      settings.has_distance_to_leading_vehicle = true;
+      settings.distance_to_leading_vehicle = std::max(0.0f, value);
+      break;
+    case VehicleSetting::PercentageIgnoreWalkers:
+      settings.perc_ignore_walkers = cg::Math::Clamp(value, 0.0f, 100.0f);
+      break;
+    case VehicleSetting::PercentageIgnoreVehicles:
+      settings.perc_ignore_vehicles = cg::Math::Clamp(value, 0.0f, 100.0f);
+      break;
+    case VehicleSetting::PercentageRunningLight:
+      settings.perc_run_traffic_light = cg::Math::Clamp(value, 0.0f, 100.0f);
+      break;
+    case VehicleSetting::PercentageRunningSign:
+      settings.perc_run_traffic_sign = cg::Math::Clamp(value, 0.0f, 100.0f);
+      break;
+    case VehicleSetting::KeepRightPercentage:
+      settings.perc_keep_right = value;
+      break;
+    case VehicleSetting::RandomLeftLaneChangePercentage:
+      settings.perc_random_left = value;
+      break;
+    case VehicleSetting::RandomRightLaneChangePercentage:
+      settings.perc_random_right = value;
+      break;
+  }
+}
+
 //////////////////////////////////// SETTERS //////////////////////////////////
 
 void Parameters::SetHybridPhysicsMode(const bool mode_switch) {  // 设置混合物理模式
@@ -40,58 +121,51 @@ void Parameters::SetBoundariesRespawnDormantVehicles(const float lower_bound, co
 
 void Parameters::SetPercentageSpeedDifference(const ActorPtr &actor, const float percentage) {  // 设置速度差百分比
   float new_percentage = std::min(100.0f, percentage);  // 限制最大百分比为100
-  percentage_difference_from_speed_limit.AddEntry({actor->GetId(), new_percentage});  // 添加速度差记录
-  if (exact_desired_speed.Contains(actor->GetId())) {  // 如果参与者的精确期望速度存在
-    exact_desired_speed.RemoveEntry(actor->GetId());  // 移除该参与者的精确期望速度
-  }
+  EditVehicleSettings(actor->GetId(), [&](VehicleSettings &settings) {
+    settings.has_percentage_difference_from_speed_limit = true;  // 添加速度差记录
+    settings.percentage_difference_from_speed_limit = new_percentage;
+    settings.has_exact_desired_speed = false;  // 移除该参与者的精确期望速度
+  });
 }
 
 void Parameters::SetLaneOffset(const ActorPtr &actor, const float offset) {  // 设置车道偏移
-  const auto entry = std::make_pair(actor->GetId(), offset);  // 创建参与者ID和偏移的条目
-  lane_offset.AddEntry(entry);  // 添加车道偏移记录
+  EditVehicleSettings(actor->GetId(), [&](VehicleSettings &settings) {
+    settings.has_lane_offset = true;  // 添加车道偏移记录
+    settings.lane_offset = offset;
+  });
 }
 
 void Parameters::SetDesiredSpeed(const ActorPtr &actor, const float value) {  // 设置期望速度
   float new_value = std::max(0.0f, value);  // 确保速度不小于0
-  exact_desired_speed.AddEntry({actor->GetId(), new_value});  // 添加参与者的精确期望速度
-  if (percentage_difference_from_speed_limit.Contains(actor->GetId())) {  // 如果速度差记录存在
-    percentage_difference_from_speed_limit.RemoveEntry(actor->GetId());  // 移除该参与者的速度差记录
-  }
+  EditVehicleSettings(actor->GetId(), [&](VehicleSettings &settings) {
+    settings.has_exact_desired_speed = true;  // 添加参与者的精确期望速度
+    settings.exact_desired_speed = new_value;
+    settings.has_percentage_difference_from_speed_limit = false;  // 移除该参与者的速度差记录
+  });
 }
 
 void Parameters::SetGlobalPercentageSpeedDifference(const float percentage) {  // 设置全局速度差百分比
   float new_percentage = std::min(100.0f, percentage);  // 限制最大百分比为100
-  global_percentage_difference_from_limit = new_percentage;  // 设置全局速度差
+  std::lock_guard<std::mutex> lock(pending_mutex);
+  pending.global_percentage_difference_from_limit = new_percentage;  // 设置全局速度差
+  pending_dirty.store(true);
 }
 
 void Parameters::SetGlobalLaneOffset(const float offset) {  // 设置全局车道偏移
-  global_lane_offset = offset;  // 设置全局偏移量
+  std::lock_guard<std::mutex> lock(pending_mutex);
+  pending.global_lane_offset = offset;  // 设置全局偏移量
+  pending_dirty.store(true);
 }
 
 void Parameters::SetCollisionDetection(const ActorPtr &reference_actor, const ActorPtr &other_actor, const bool detect_collision) {  // 设置碰撞检测
-  const ActorId reference_id = reference_actor->GetId();  // 获取参考参与者的ID
   const ActorId other_id = other_actor->GetId();  // 获取其他参与者的ID
-
-  if (detect_collision) {  // 如果需要检测碰撞
-    if (ignore_collision.Contains(reference_id)) {  // 如果参考参与者在忽略碰撞列表中
-      std::shared_ptr<AtomicActorSet> actor_set = ignore_collision.GetValue(reference_id);  // 获取该参与者的忽略集合
-      if (actor_set->Contains(other_id)) {  // 如果其他参与者在集合中
-        actor_set->Remove({other_id});  // 从集合中移除该参与者
-      }
+  EditVehicleSettings(reference_actor->GetId(), [&](VehicleSettings &settings) {
+    if (detect_collision) {  // 如果需要检测碰撞，从忽略集合中移除该参与者
+      settings.ignore_collision.erase(other_id);
+    } else {  // 如果不需要检测碰撞，将其他参与者加入忽略集合
+      settings.ignore_collision.insert(other_id);
     }
-  } else {  // 如果不需要检测碰撞
-    if (ignore_collision.Contains(reference_id)) {  // 如果参考参与者在忽略碰撞列表中
-      std::shared_ptr<AtomicActorSet> actor_set = ignore_collision.GetValue(reference_id);  // 获取该参与者的忽略集合
-      if (!actor_set->Contains(other_id)) {  // 如果其他参与者不在集合中
-        actor_set->Insert({other_actor});  // 将其他参与者加入集合
-      }
-    } else {  // 如果参考参与者不在列表中
-      std::shared_ptr<AtomicActorSet> actor_set = std::make_shared<AtomicActorSet>();  // 创建新的忽略集合
-      actor_set->Insert({other_actor});  // 将其他参与者加入集合
-      auto entry = std::make_pair(reference_id, actor_set);  // 创建条目
-      ignore_collision.AddEntry(entry);  // 添加条目到忽略碰撞列表
-    }
-  }
+  });
 }
 
 void Parameters::SetForceLaneChange(const ActorPtr &actor, const bool direction) {  // 设置强制变道
@@ -101,44 +175,45 @@ void Parameters::SetForceLaneChange(const ActorPtr &actor, const bool direction)
 }
 
 void Parameters::SetKeepRightPercentage(const ActorPtr &actor, const float percentage) {  // 设置保持右侧的百分比
-  const auto entry = std::make_pair(actor->GetId(), percentage);  // 创建参与者ID和保持右侧百分比的条目
-  perc_keep_right.AddEntry(entry);  // 添加保持右侧记录
+  EditVehicleSettings(actor->GetId(), [&](VehicleSettings &settings) {
+    settings.perc_keep_right = percentage;  // 添加保持右侧记录
+  });
 }
 
 void Parameters::SetRandomLeftLaneChangePercentage(const ActorPtr &actor, const float percentage) {  // 设置随机左变道的百分比
-  const auto entry = std::make_pair(actor->GetId(), percentage);  // 创建参与者ID和随机左变道百分比的条目
-  perc_random_left.AddEntry(entry);  // 添加随机左变道记录
+  EditVehicleSettings(actor->GetId(), [&](VehicleSettings &settings) {
+    settings.perc_random_left = percentage;  // 添加随机左变道记录
+  });
 }
 
 void Parameters::SetRandomRightLaneChangePercentage(const ActorPtr &actor, const float percentage) {  // 设置随机右变道的百分比
-  const auto entry = std::make_pair(actor->GetId(), percentage);  // 创建参与者ID和随机右变道百分比的条目
-  perc_random_right.AddEntry(entry);  // 添加随机右变道记录
+  EditVehicleSettings(actor->GetId(), [&](VehicleSettings &settings) {
+    settings.perc_random_right = percentage;  // 添加随机右变道记录
+  });
 }
 
 void Parameters::SetUpdateVehicleLights(const ActorPtr &actor, const bool do_update) {
     // 设置车辆灯光更新状态
-    const auto entry = std::make_pair(actor->GetId(), do_update);
-    // 创建参与者ID和更新状态的条目
-    auto_update_vehicle_lights.AddEntry(entry);
-    // 将条目添加到自动更新车辆灯光列表中
+    EditVehicleSettings(actor->GetId(), [&](VehicleSettings &settings) {
+      settings.auto_update_vehicle_lights = do_update;
+    });
 }
 
 void Parameters::SetAutoLaneChange(const ActorPtr &actor, const bool enable) {
     // 设置自动变道功能
-    const auto entry = std::make_pair(actor->GetId(), enable);
-    // 创建参与者ID和变道使能状态的条目
-    auto_lane_change.AddEntry(entry);
-    // 将条目添加到自动变道列表中
+    EditVehicleSettings(actor->GetId(), [&](VehicleSettings &settings) {
+      settings.auto_lane_change = enable;
+    });
 }
 
 void Parameters::SetDistanceToLeadingVehicle(const ActorPtr &actor, const float distance) {
     // 设置与前车的距离
     float new_distance = std::max(0.0f, distance);
     // 确保距离不小于0
-    const auto entry = std::make_pair(actor->GetId(), new_distance);
-    // 创建参与者ID和距离的条目
-    distance_to_leading_vehicle.AddEntry(entry);
-    // 将条目添加到前车距离列表中
+    EditVehicleSettings(actor->GetId(), [&](VehicleSettings &settings) {
+      settings.has_distance_to_leading_vehicle = true;
+      settings.distance_to_leading_vehicle = new_distance;
+    });
 }
 
 void Parameters::SetSynchronousMode(const bool mode_switch) {
@@ -153,38 +228,42 @@ void Parameters::SetSynchronousModeTimeOutInMiliSecond(const double time) {
 
 void Parameters::SetGlobalDistanceToLeadingVehicle(const float dist) {
     // 设置全局前车距离
-   distance_margin.store(dist);
+   std::lock_guard<std::mutex> lock(pending_mutex);
+   pending.distance_margin = dist;
+   pending_dirty.store(true);
 }
 
 void Parameters::SetPercentageRunningLight(const ActorPtr &actor, const float perc) {
     // 设置运行信号灯的百分比
     float new_perc = cg::Math::Clamp(perc, 0.0f, 100.0f);
     // 确保百分比在0到100之间
-    const auto entry = std::make_pair(actor->GetId(), new_perc);
-    // 创建参与者ID和百分比的条目
-    perc_run_traffic_light.AddEntry(entry);
-    // 将条目添加到运行信号灯百分比列表中
+    EditVehicleSettings(actor->GetId(), [&](VehicleSettings &settings) {
+      settings.perc_run_traffic_light = new_perc;
+    });
 }
 
 void Parameters::SetPercentageRunningSign(const ActorPtr &actor, const float perc) {
     // 设置运行标志的百分比
    float new_perc = cg::Math::Clamp(perc, 0.0f, 100.0f);
-   const auto entry = std::make_pair(actor->GetId(), new_perc);
-   perc_run_traffic_sign.AddEntry(entry);
+   EditVehicleSettings(actor->GetId(), [&](VehicleSettings &settings) {
+     settings.perc_run_traffic_sign = new_perc;
+   });
 }
 
 void Parameters::SetPercentageIgnoreVehicles(const ActorPtr &actor, const float perc) {
     // 设置忽略车辆的百分比
    float new_perc = cg::Math::Clamp(perc, 0.0f, 100.0f);
-   const auto entry = std::make_pair(actor->GetId(), new_perc);
-   perc_ignore_vehicles.AddEntry(entry);
+   EditVehicleSettings(actor->GetId(), [&](VehicleSettings &settings) {
+     settings.perc_ignore_vehicles = new_perc;
+   });
 }
 
 void Parameters::SetPercentageIgnoreWalkers(const ActorPtr &actor, const float perc) {
     // 设置忽略行人的百分比
    float new_perc = cg::Math::Clamp(perc, 0.0f, 100.0f);
-   const auto entry = std::make_pair(actor->GetId(), new_perc);
-   perc_ignore_walkers.AddEntry(entry);
+   EditVehicleSettings(actor->GetId(), [&](VehicleSettings &settings) {
+     settings.perc_ignore_walkers = new_perc;
+   });
 }
 
 void Parameters::SetHybridPhysicsRadius(const float radius) {
@@ -199,6 +278,27 @@ void Parameters::SetOSMMode(const bool mode_switch) {
     osm_mode.store(mode_switch);
 }
 
+void Parameters::SetStageThreads(const unsigned number_of_threads) {
+    // 线程数限制在 [1, MAX_STAGE_THREADS] 之间
+    const unsigned new_number_of_threads = std::min(std::max(number_of_threads, 1u),
+                                                    constants::StageExecution::MAX_STAGE_THREADS);
+    stage_threads.store(new_number_of_threads);
+}
+
+void Parameters::SetPipelinedControl(const bool enabled) {
+    // 设置流水线式发送控制命令的开关
+    pipelined_control.store(enabled);
+}
+
+void Parameters::SetLevelOfDetail(const float update_radius,
+                                  const float collision_radius,
+                                  const unsigned update_interval) {
+    // 设置细节层次的距离分段，半径不小于0，间隔至少为1步
+    lod_update_radius.store(std::max(update_radius, 0.0f));
+    lod_collision_radius.store(std::max(collision_radius, 0.0f));
+    lod_update_interval.store(std::max(update_interval, 1u));
+}
+
 void Parameters::SetCustomPath(const ActorPtr &actor, const Path path, const bool empty_buffer) {
     // 设置参与者的自定义路径
     const auto entry = std::make_pair(actor->GetId(), path);
@@ -272,15 +372,18 @@ double Parameters::GetSynchronousModeTimeOutInMiliSecond() const {
 
 float Parameters::GetVehicleTargetVelocity(const ActorId &actor_id, const float speed_limit) const {
     // 从全局获取参与者与速度限制的百分比差异
-    float percentage_difference = global_percentage_difference_from_limit;
-
-    // 如果参与者的速度限制包含在内，获取其特定的百分比差异
-    if (percentage_difference_from_speed_limit.Contains(actor_id)) {
-        percentage_difference = percentage_difference_from_speed_limit.GetValue(actor_id);
-    } 
-    // 如果参与者有精确的期望速度，直接返回该速度
-    else if (exact_desired_speed.Contains(actor_id)) {
-        return exact_desired_speed.GetValue(actor_id);
+    float percentage_difference = snapshot->global_percentage_difference_from_limit;
+
+    const VehicleSettings *settings = FindVehicleSettings(actor_id);
+    if (settings != nullptr) {
+        // 如果参与者设置了特定的百分比差异，使用该值
+        if (settings->has_percentage_difference_from_speed_limit) {
+            percentage_difference = settings->percentage_difference_from_speed_limit;
+        }
+        // 如果参与者有精确的期望速度，直接返回该速度
+        else if (settings->has_exact_desired_speed) {
+            return settings->exact_desired_speed;
+        }
     }
 
     // 根据速度限制和百分比差异计算目标速度
@@ -289,11 +392,12 @@ float Parameters::GetVehicleTargetVelocity(const ActorId &actor_id, const float
 
 float Parameters::GetLaneOffset(const ActorId &actor_id) const {
     // 从全局获取车道偏移
-    float offset = global_lane_offset;
+    float offset = snapshot->global_lane_offset;
 
     // 如果参与者的车道偏移存在，获取其特定的偏移值
-    if (lane_offset.Contains(actor_id)) {
-        offset = lane_offset.GetValue(actor_id);
+    const VehicleSettings *settings = FindVehicleSettings(actor_id);
+    if (settings != nullptr && settings->has_lane_offset) {
+        offset = settings->lane_offset;
     }
 
    return offset; // 返回车道偏移
@@ -303,9 +407,9 @@ bool Parameters::GetCollisionDetection(const ActorId &reference_actor_id, const
     // 默认设置为避免碰撞
     bool avoid_collision = true;
 
-    // 如果引用参与者被设置为忽略碰撞，并且其他参与者在其忽略列表中
-    if (ignore_collision.Contains(reference_actor_id) &&
-        ignore_collision.GetValue(reference_actor_id)->Contains(other_actor_id)) {
+    // 如果其他参与者在引用参与者的忽略列表中
+    const VehicleSettings *settings = FindVehicleSettings(reference_actor_id);
+    if (settings != nullptr && settings->ignore_collision.count(other_actor_id) > 0u) {
         avoid_collision = false; // 不避免碰撞
     }
 
@@ -329,61 +433,60 @@ ChangeLaneInfo Parameters::GetForceLaneChange(const ActorId &actor_id) {
 
 float Parameters::GetKeepRightPercentage(const ActorId &actor_id) {
     // 初始化保持右侧的百分比
-    float percentage = -1.0f;
+    float value = -1.0f;
 
-    // 如果参与者的保持右侧百分比存在，获取其值
-    if (perc_keep_right.Contains(actor_id)) {
-        percentage = perc_keep_right.GetValue(actor_id);
+    const VehicleSettings *settings = FindVehicleSettings(actor_id);
+    if (settings != nullptr) {
+        value = settings->perc_keep_right;
     }
 
-   return percentage; // 返回保持右侧的百分比
+   return value; // 返回保持右侧的百分比
 }
 
 float Parameters::GetRandomLeftLaneChangePercentage(const ActorId &actor_id) {
     // 初始化随机左侧车道变更的百分比
-    float percentage = -1.0f;
+    float value = -1.0f;
 
-    // 如果参与者的随机左侧车道变更百分比存在，获取其值
-    if (perc_random_left.Contains(actor_id)) {
-        percentage = perc_random_left.GetValue(actor_id);
+    const VehicleSettings *settings = FindVehicleSettings(actor_id);
+    if (settings != nullptr) {
+        value = settings->perc_random_left;
     }
 
-   return percentage; // 返回随机左侧车道变更的百分比
+   return value; // 返回随机左侧车道变更的百分比
 }
 
 float Parameters::GetRandomRightLaneChangePercentage(const ActorId &actor_id) {
     // 初始化随机右侧车道变更的百分比
-    float percentage = -1.0f;
+    float value = -1.0f;
 
-    // 如果参与者的随机右侧车道变更百分比存在，获取其值
-    if (perc_random_right.Contains(actor_id)) {
-        percentage = perc_random_right.GetValue(actor_id);
+    const VehicleSettings *settings = FindVehicleSettings(actor_id);
+    if (settings != nullptr) {
+        value = settings->perc_random_right;
     }
 
-   return percentage; // 返回随机右侧车道变更的百分比
+   return value; // 返回随机右侧车道变更的百分比
 }
 
 bool Parameters::GetAutoLaneChange(const ActorId &actor_id) const {
     // 默认自动车道变更政策为真
-    bool auto_lane_change_policy = true;
+    bool value = true;
 
-    // 如果参与者的自动车道变更设置存在，获取其值
-    if (auto_lane_change.Contains(actor_id)) {
-        auto_lane_change_policy = auto_lane_change.GetValue(actor_id);
+    const VehicleSettings *settings = FindVehicleSettings(actor_id);
+    if (settings != nullptr) {
+        value = settings->auto_lane_change;
     }
 
-   return auto_lane_change_policy; // 返回自动车道变更政策
+   return value; // 返回自动车道变更政策
 }
 
 float Parameters::GetDistanceToLeadingVehicle(const ActorId &actor_id) const {
-    // 初始化与前车的距离边际
-    float specific_distance_margin = 0.0f;
-    
+    // 默认使用全局的前车距离
+    float specific_distance_margin = snapshot->distance_margin;
+
     // 如果参与者的前车距离存在，获取其值
-    if (distance_to_leading_vehicle.Contains(actor_id)) {
-        specific_distance_margin = distance_to_leading_vehicle.GetValue(actor_id);
-    } else {
-        specific_distance_margin = distance_margin; // 否则使用全局默认值
+    const VehicleSettings *settings = FindVehicleSettings(actor_id);
+    if (settings != nullptr && settings->has_distance_to_leading_vehicle) {
+        specific_distance_margin = settings->distance_to_leading_vehicle;
     }
 
     return specific_distance_margin; // 返回与前车的距离
@@ -391,62 +494,62 @@ float Parameters::GetDistanceToLeadingVehicle(const ActorId &actor_id) const {
 
 float Parameters::GetPercentageRunningLight(const ActorId &actor_id) const {
     // 初始化红绿灯违规的百分比
-    float percentage = 0.0f;
+    float value = 0.0f;
 
-    // 如果参与者的红绿灯违规百分比存在，获取其值
-    if (perc_run_traffic_light.Contains(actor_id)) {
-        percentage = perc_run_traffic_light.GetValue(actor_id);
+    const VehicleSettings *settings = FindVehicleSettings(actor_id);
+    if (settings != nullptr) {
+        value = settings->perc_run_traffic_light;
     }
 
-   return percentage; // 返回红绿灯违规的百分比
+   return value; // 返回红绿灯违规的百分比
 }
 
 float Parameters::GetPercentageRunningSign(const ActorId &actor_id) const {
     // 初始化交通标志违规的百分比
-    float percentage = 0.0f;
+    float value = 0.0f;
 
-    // 如果参与者的交通标志违规百分比存在，获取其值
-    if (perc_run_traffic_sign.Contains(actor_id)) {
-        percentage = perc_run_traffic_sign.GetValue(actor_id);
+    const VehicleSettings *settings = FindVehicleSettings(actor_id);
+    if (settings != nullptr) {
+        value = settings->perc_run_traffic_sign;
     }
 
-   return percentage; // 返回交通标志违规的百分比
+   return value; // 返回交通标志违规的百分比
 }
 
 float Parameters::GetPercentageIgnoreWalkers(const ActorId &actor_id) const {
     // 初始化忽略行人的百分比
-    float percentage = 0.0f;
+    float value = 0.0f;
 
-    // 如果参与者的忽略行人百分比存在，获取其值
-    if (perc_ignore_walkers.Contains(actor_id)) {
-        percentage = perc_ignore_walkers.GetValue(actor_id);
+    const VehicleSettings *settings = FindVehicleSettings(actor_id);
+    if (settings != nullptr) {
+        value = settings->perc_ignore_walkers;
     }
 
-   return percentage; // 返回忽略行人的百分比
+   return value; // 返回忽略行人的百分比
 }
 
 bool Parameters::GetUpdateVehicleLights(const ActorId &actor_id) const {
     // 默认更新车辆灯光为假
-    bool do_update = false;
+    bool value = false;
 
-    // 如果参与者的灯光更新设置存在，获取其值
-    if (auto_update_vehicle_lights.Contains(actor_id)) {
-        do_update = auto_update_vehicle_lights.GetValue(actor_id);
+    const VehicleSettings *settings = FindVehicleSettings(actor_id);
+    if (settings != nullptr) {
+        value = settings->auto_update_vehicle_lights;
     }
 
-   return do_update; // 返回灯光更新设置
+   return value; // 返回灯光更新设置
 }
 
 float Parameters::GetPercentageIgnoreVehicles(const ActorId &actor_id) const {
     // 初始化忽略其他车辆的百分比
-    float percentage = 0.0f;
+    float value = 0.0f;
 
-    // 如果参与者的忽略车辆百分比存在，获取其值
-    if (perc_ignore_vehicles.Contains(actor_id)) {
-        percentage = perc_ignore_vehicles.GetValue(actor_id);
+    const VehicleSettings *settings = FindVehicleSettings(actor_id);
+    if (settings != nullptr) {
+        value = settings->perc_ignore_vehicles;
     }
 
-   return percentage; // 返回忽略车辆的百分比
+   return value; // 返回忽略其他车辆的百分比
 }
 
 bool Parameters::GetHybridPhysicsMode() const {
@@ -474,6 +577,31 @@ bool Parameters::GetOSMMode() const {
    return osm_mode.load();
 }
 
+unsigned Parameters::GetStageThreads() const {
+    // 返回并行执行各阶段时使用的线程数
+   return stage_threads.load();
+}
+
+bool Parameters::GetPipelinedControl() const {
+    // 返回是否流水线式发送控制命令的设置
+   return pipelined_control.load();
+}
+
+float Parameters::GetLODUpdateRadius() const {
+    // 返回降低更新频率的半径
+   return lod_update_radius.load();
+}
+
+float Parameters::GetLODCollisionRadius() const {
+    // 返回参与碰撞协商的半径
+   return lod_collision_radius.load();
+}
+
+unsigned Parameters::GetLODUpdateInterval() const {
+    // 返回远处车辆的更新间隔步数
+   return lod_update_interval.load();
+}
+
 bool Parameters::GetUploadPath(const ActorId &actor_id) const {
     // 初始化自定义路径标志
     bool custom_path_bool = false;
@@ -8,8 +8,11 @@
 
 #include <atomic>  /// 提供原子操作，确保线程安全
 #include <chrono>  /// 提供时间功能，用于时间计算
+#include <memory>  /// 提供智能指针，用于共享参数快照
+#include <mutex>  /// 提供互斥锁，用于保护待发布的参数
 #include <random>  /// 提供随机数生成功能
 #include <unordered_map> /// 提供无序映射容器，用于快速查找
+#include <unordered_set> /// 提供无序集合容器，用于存储忽略碰撞的参与者
 /// 包含Carla客户端相关的头文件
 #include "carla/client/Actor.h"
 #include "carla/client/Vehicle.h"
@@ -18,6 +21,7 @@
 
 #include "carla/trafficmanager/AtomicActorSet.h"/// 包含Carla交通管理器的相关头文件
 #include "carla/trafficmanager/AtomicMap.h"
+#include "carla/trafficmanager/VehicleSettingCommand.h"
 
 namespace carla {
     namespace traffic_manager {
@@ -33,48 +37,62 @@ namespace carla {
             bool change_lane = false;/// 是否换道
             bool direction = false;/// 换道方向
         };
+        /// 单个车辆的交通管理设置，未设置的项使用全局值或默认值
+        struct VehicleSettings {
+            /// 速度百分比差异与精确期望速度互斥，设置其中一个会清除另一个
+            bool has_percentage_difference_from_speed_limit = false;
+            float percentage_difference_from_speed_limit = 0.0f;
+            bool has_exact_desired_speed = false;
+            float exact_desired_speed = 0.0f;
+            bool has_lane_offset = false;
+            float lane_offset = 0.0f;
+            bool has_distance_to_leading_vehicle = false;
+            float distance_to_leading_vehicle = 0.0f;
+            bool auto_lane_change = true;
+            float perc_run_traffic_light = 0.0f;
+            float perc_run_traffic_sign = 0.0f;
+            float perc_ignore_walkers = 0.0f;
+            float perc_ignore_vehicles = 0.0f;
+            /// 以下三个百分比为负值时表示未设置
+            float perc_keep_right = -1.0f;
+            float perc_random_left = -1.0f;
+            float perc_random_right = -1.0f;
+            bool auto_update_vehicle_lights = false;
+            /// 碰撞检测时忽略的参与者
+            std::unordered_set<ActorId> ignore_collision;
+        };
+
+        /// 交通管理器每步发布一次的不可变参数快照
+        struct ParameterSnapshot {
+            std::unordered_map<ActorId, VehicleSettings> vehicles;
+            /// 全局目标速度限制差异百分比
+            float global_percentage_difference_from_limit = 0.0f;
+            /// 全局车道偏移
+            float global_lane_offset = 0.0f;
+            /// 全局与前车的距离
+            float distance_margin = 2.0f;
+        };
+
         /// 交通管理参数
+        ///
+        /// 各阶段每步对每辆车都要读取的设置保存在不可变的快照中。
+        /// 设置方法只修改受互斥锁保护的待发布副本，交通管理器在每步开始时调用
+        /// PublishSnapshot 将其发布为新的快照，因此各阶段读取时无需任何同步，
+        /// 设置方法也不会阻塞正在执行的步。新的设置从下一步开始生效。
         class Parameters {
 
         private:
-            /// 基于速度限制差异的单个车辆目标速度映射
-            AtomicMap<ActorId, float> percentage_difference_from_speed_limit;
-            /// 单个车辆的车道偏移映射
-            AtomicMap<ActorId, float> lane_offset;
-            /// 基于期望速度的单个车辆目标速度映射
-            AtomicMap<ActorId, float> exact_desired_speed;
-            /// 全局目标速度限制差异百分比
-            float global_percentage_difference_from_limit = 0;
-            /// 全局车道偏移
-            float global_lane_offset = 0;
-            /// 在碰撞检测期间要忽略的演员集合映射
-            AtomicMap<ActorId, std::shared_ptr<AtomicActorSet>> ignore_collision;
-            /// 到前导车辆的距离映射
-            AtomicMap<ActorId, float> distance_to_leading_vehicle;
-            /// 强制换道命令映射
+            /// 待发布的参数，由 pending_mutex 保护
+            ParameterSnapshot pending;
+            mutable std::mutex pending_mutex;
+            /// 待发布的参数自上次发布以来是否被修改过
+            std::atomic<bool> pending_dirty{ false };
+            /// 当前步使用的快照，只在交通管理器的工作线程上读写
+            std::shared_ptr<const ParameterSnapshot> snapshot;
+            /// 强制换道命令映射，读取后即被消耗，因此不放入快照
             AtomicMap<ActorId, ChangeLaneInfo> force_lane_change;
-            /// 自动换道命令映射
-            AtomicMap<ActorId, bool> auto_lane_change;
-            /// 闯交通信号灯百分比映射
-            AtomicMap<ActorId, float> perc_run_traffic_light;
-            /// 闯交通标志百分比映射
-            AtomicMap<ActorId, float> perc_run_traffic_sign;
-            /// 忽略行人百分比映射
-            AtomicMap<ActorId, float> perc_ignore_walkers;
-            /// 忽略车辆百分比映射
-            AtomicMap<ActorId, float> perc_ignore_vehicles;
-            /// 靠右行驶规则百分比映射
-            AtomicMap<ActorId, float> perc_keep_right;
-            /// 随机左换道百分比映射
-            AtomicMap<ActorId, float> perc_random_left;
-            /// 随机右换道百分比映射
-            AtomicMap<ActorId, float> perc_random_right;
-            /// 车辆灯光自动更新标志映射
-            AtomicMap<ActorId, bool> auto_update_vehicle_lights;
             /// 同步开关
             std::atomic<bool> synchronous_mode{ false };
-            /// 距离边距
-            std::atomic<float> distance_margin{ 2.0 };
             /// 混合物理模式开关
             std::atomic<bool> hybrid_physics_mode{ false };
             /// 自动重生模式开关
@@ -91,6 +109,16 @@ namespace carla {
             std::atomic<float> hybrid_physics_radius{ 70.0 };
             /// Open Street Map模式参数
             std::atomic<bool> osm_mode{ true };
+            /// 并行执行各阶段逐车辆计算时使用的线程数，1表示串行执行
+            std::atomic<unsigned> stage_threads{ 1u };
+            /// 是否在下一步计算的同时发送本步的控制命令，命令最多延迟一步生效
+            std::atomic<bool> pipelined_control{ false };
+            /// 距离所有英雄车辆超过该半径的车辆降低更新频率，0表示不降低
+            std::atomic<float> lod_update_radius{ 0.0f };
+            /// 距离所有英雄车辆超过该半径的车辆不参与碰撞协商，0表示全部参与
+            std::atomic<float> lod_collision_radius{ 0.0f };
+            /// 降低更新频率的车辆每隔多少步完整更新一次
+            std::atomic<unsigned> lod_update_interval{ 1u };
             /// 是否导入自定义路径的参数映射
             AtomicMap<ActorId, bool> upload_path;
             /// 存储所有自定义路径的结构
@@ -106,8 +134,14 @@ namespace carla {
             /// 析构函数
             ~Parameters();
 
+            /// 将自上次发布以来的修改发布为新的快照，由交通管理器在每步开始时调用
+            void PublishSnapshot();
+
             ////////////////////////////////// SETTERS /////////////////////////////////////
 
+            /// 一次性应用一组逐车辆参数修改，整组修改在同一步开始时一起生效
+            void ApplySettingsBatch(const VehicleSettingBatch &batch);
+
             /// 设置车辆相对于速度限制的速度降低百分比
             /// 如果小于0，则表示速度增加百分比
             void SetPercentageSpeedDifference(const ActorPtr& actor, const float percentage);
@@ -185,6 +219,17 @@ namespace carla {
             /// 设置Open Street Map模式的方法
             void SetOSMMode(const bool mode_switch);///< 是否启用OSM模式的布尔值
 
+            /// 设置并行执行各阶段逐车辆计算时使用的线程数的方法
+            void SetStageThreads(const unsigned number_of_threads);///< 线程数，1表示串行执行
+
+            /// 设置是否流水线式发送控制命令的方法
+            void SetPipelinedControl(const bool enabled);///< 是否启用的布尔值
+
+            /// 设置按与英雄车辆的距离降低远处车辆计算量的方法
+            void SetLevelOfDetail(const float update_radius,      ///< 降低更新频率的半径，0表示不降低
+                                  const float collision_radius,   ///< 参与碰撞协商的半径，0表示全部参与
+                                  const unsigned update_interval);///< 远处车辆的更新间隔步数
+
             /// 设置是否自动重生休眠车辆的方法
             void SetRespawnDormantVehicles(const bool mode_switch); ///< 是否启用的布尔值
 
@@ -280,6 +325,21 @@ namespace carla {
             /// 获取Open Street Map模式的方法
             bool GetOSMMode() const;
 
+            /// 获取并行执行各阶段时使用的线程数的方法
+            unsigned GetStageThreads() const;
+
+            /// 获取是否流水线式发送控制命令的方法
+            bool GetPipelinedControl() const;
+
+            /// 获取降低更新频率的半径的方法
+            float GetLODUpdateRadius() const;
+
+            /// 获取参与碰撞协商的半径的方法
+            float GetLODCollisionRadius() const;
+
+            /// 获取远处车辆更新间隔步数的方法
+            unsigned GetLODUpdateInterval() const;
+
             /// 获取是否正在上传路径的方法
             bool GetUploadPath(const ActorId& actor_id) const;
 
@@ -294,6 +354,24 @@ namespace carla {
 
             /// 同步模式超时变量
             std::chrono::duration<double, std::milli> synchronous_time_out;
+
+        private:
+            /// 将一条批量命令应用到车辆设置上，取值范围的限制与对应的单项设置方法一致
+            static void ApplyCommand(VehicleSettings &settings, const VehicleSettingCommand &command);
+
+            /// 在待发布的参数中修改某辆车的设置
+            template <typename Functor>
+            void EditVehicleSettings(const ActorId actor_id, Functor &&functor) {
+                std::lock_guard<std::mutex> lock(pending_mutex);
+                functor(pending.vehicles[actor_id]);
+                pending_dirty.store(true);
+            }
+
+            /// 在当前快照中查找某辆车的设置，未设置过时返回空指针
+            const VehicleSettings *FindVehicleSettings(const ActorId actor_id) const {
+                const auto it = snapshot->vehicles.find(actor_id);
+                return it != snapshot->vehicles.end() ? &it->second : nullptr;
+            }
         };
 
     } // namespace traffic_manager
@@ -1,32 +1,76 @@
 // 确保头文件只被包含一次，避免重复定义等问题
 #pragma once
 
-// 引入C++标准库中的随机数相关头文件，用于生成随机数相关功能
-#include <random>
-// 引入无序映射相关头文件，虽然在此代码片段中未体现其具体使用，但可能在更广泛的上下文中会涉及
-#include <unordered_map>
+// 引入固定宽度整数类型
+#include <cstdint>
 
-// 引入Carla项目中定义ActorId相关的头文件，此处代码未直接体现其使用，但可能与之相关联
+// 引入Carla项目中定义ActorId相关的头文件，用于按车辆划分随机数流
 #include "carla/rpc/ActorId.h"
 
 namespace carla {
 namespace traffic_manager {
 
-// 定义随机数生成器类，用于生成特定范围内的随机数
+// 随机数流的用途，同一车辆在不同阶段使用互不相关的流
+enum class RandomStreamId : uint8_t {
+    Localization,
+    Collision,
+    TrafficLight,
+    MotionPlan
+};
+
+// 单个车辆在某一步、某一阶段中使用的随机数流。
+// 基于计数器生成：第n个随机数只取决于(种子, 步序号, 车辆ID, 流用途, n)，
+// 与其他车辆的抽取次数和执行顺序无关，因此多线程执行时抽到的随机数与串行一致。
+// 这只保证随机决策本身与顺序无关；读写共享状态的阶段（如定位）仍须串行执行
+class RandomStream {
+public:
+    explicit RandomStream(const uint64_t key): key(key) {}
+
+    // 生成并返回下一个位于[0.0, 100.0)范围内均匀分布的随机数
+    double next() {
+        ++counter;
+        // 取高53位构造双精度小数
+        const uint64_t bits = Mix(key + counter * GOLDEN_GAMMA) >> 11;
+        return static_cast<double>(bits) * (100.0 / 9007199254740992.0);
+    }
+
+    // splitmix64的混合函数，将输入均匀地打散到64位
+    static uint64_t Mix(uint64_t x) {
+        x += GOLDEN_GAMMA;
+        x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+        x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+        return x ^ (x >> 31);
+    }
+
+private:
+    static constexpr uint64_t GOLDEN_GAMMA = 0x9E3779B97F4A7C15ull;
+
+    // 由种子、步序号、车辆ID和流用途导出的流标识
+    uint64_t key;
+    // 本流已生成的随机数个数
+    uint64_t counter = 0u;
+};
+
+// 随机数生成器类，为每辆车的每个阶段派生独立的随机数流
 class RandomGenerator {
 public:
     // 构造函数，接收一个无符号64位整数作为随机数生成器的种子
-    // 使用该种子初始化一个基于梅森旋转算法的伪随机数生成器（std::mt19937），并设定生成的随机数范围为0.0到100.0
-    RandomGenerator(const uint64_t seed): mt(std::mt19937(seed)), dist(0.0, 100.0) {}
-    
-    // 生成并返回下一个随机数，通过调用std::uniform_real_distribution的操作符，利用已初始化的随机数生成器（mt）来生成符合设定范围（0.0到100.0）的随机数
-    double next() { return dist(mt); }
+    RandomGenerator(const uint64_t seed): seed_key(RandomStream::Mix(seed)) {}
+
+    // 进入下一步，由交通管理器在每步开始、各阶段运行之前调用
+    void AdvanceStep() { ++step; }
+
+    // 返回车辆 @a actor_id 在当前步中用于 @a stream_id 的随机数流
+    RandomStream GetStream(const ActorId actor_id, const RandomStreamId stream_id) const {
+        const uint64_t stream = (static_cast<uint64_t>(actor_id) << 8) | static_cast<uint64_t>(stream_id);
+        return RandomStream(RandomStream::Mix(RandomStream::Mix(seed_key ^ step) ^ stream));
+    }
 
 private:
-    // 基于梅森旋转算法的伪随机数生成器对象，用于生成伪随机数序列的基础，其状态由传入的种子决定
-    std::mt19937 mt;
-    // 均匀分布的实数随机数分布对象，定义了生成随机数的范围（在此为0.0到100.0），与随机数生成器（mt）配合使用来生成符合该范围的随机数
-    std::uniform_real_distribution<double> dist;
+    // 打散后的种子
+    uint64_t seed_key;
+    // 自设置种子以来经过的步数
+    uint64_t step = 0u;
 };
 
 } // namespace traffic_manager
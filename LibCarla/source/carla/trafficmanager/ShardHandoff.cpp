@@ -0,0 +1,93 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include <algorithm>
+#include <exception>
+
+#include "carla/Logging.h"
+#include "carla/trafficmanager/Constants.h"
+
+#include "carla/trafficmanager/ShardHandoff.h"
+
+namespace carla {
+namespace traffic_manager {
+
+using namespace constants::Sharding;
+
+ShardHandoff::ShardHandoff(const uint16_t port)
+  : own_port(port) {}
+
+void ShardHandoff::SetShardMap(const ShardMap &shard_map) {
+  std::lock_guard<std::mutex> lock(mutex);
+  bool found = false;
+  peer_regions.clear();
+  for (const ShardRegion &region : shard_map) {
+    if (!found && region.port == own_port) {
+      own_region = region;
+      found = true;
+    } else {
+      peer_regions.push_back(region);
+    }
+  }
+  enabled.store(found);
+}
+
+std::vector<ShardHandoff::Departure> ShardHandoff::SelectDepartures(
+    const std::vector<ActorId> &vehicle_ids,
+    const SimulationState &simulation_state) const {
+
+  std::vector<Departure> departures;
+  std::lock_guard<std::mutex> lock(mutex);
+  if (!enabled.load()) {
+    return departures;
+  }
+
+  for (const ActorId actor_id : vehicle_ids) {
+    if (!simulation_state.ContainsActor(actor_id)) {
+      continue;
+    }
+    const cg::Location location = simulation_state.GetLocation(actor_id);
+    if (own_region.Contains(location, HANDOFF_MARGIN)) {
+      continue;
+    }
+    // 不在任何区域内的车辆（例如驶出了分区覆盖的范围）仍由本交通管理器控制
+    for (std::size_t i = 0u; i < peer_regions.size(); ++i) {
+      if (!peer_regions[i].Contains(location)) {
+        continue;
+      }
+      auto departure = std::find_if(departures.begin(), departures.end(), [&](const Departure &d) {
+        return d.destination.host == peer_regions[i].host && d.destination.port == peer_regions[i].port;
+      });
+      if (departure == departures.end()) {
+        departures.push_back({peer_regions[i], {}});
+        departure = departures.end() - 1;
+      }
+      departure->actor_ids.push_back(actor_id);
+      break;
+    }
+  }
+  return departures;
+}
+
+bool ShardHandoff::Send(const ShardRegion &destination, const std::vector<carla::rpc::Actor> &actors) {
+  const std::string key = destination.host + ":" + std::to_string(destination.port);
+  try {
+    auto &client = clients[key];
+    if (client == nullptr) {
+      client = std::make_unique<TrafficManagerClient>(destination.host, destination.port);
+    }
+    client->RegisterVehicle(actors);
+    return true;
+  } catch (const std::exception &e) {
+    // 连接可能已失效，下次移交时重新建立
+    clients.erase(key);
+    log_warning("Traffic Manager shard handoff to", key, "failed:", e.what());
+    return false;
+  }
+}
+
+} // namespace traffic_manager
+} // namespace carla
@@ -0,0 +1,81 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "carla/NonCopyable.h"
+#include "carla/rpc/Actor.h"
+#include "carla/rpc/ActorId.h"
+#include "carla/trafficmanager/ShardRegion.h"
+#include "carla/trafficmanager/SimulationState.h"
+#include "carla/trafficmanager/TrafficManagerBase.h"
+#include "carla/trafficmanager/TrafficManagerClient.h"
+
+namespace carla {
+namespace traffic_manager {
+
+  /**
+   * @class ShardHandoff
+   * @brief 按地图分区在多个交通管理器之间移交车辆。
+   *
+   * 每个交通管理器只控制位于自己区域内的车辆，车辆越过边界后被移交给
+   * 目标区域所属的交通管理器。其他区域的车辆对本交通管理器而言是未注册的参与者，
+   * 其运动状态仍由世界快照提供，因此碰撞检测能看到边界另一侧的车辆，
+   * 各交通管理器之间只需交换越界车辆的注册信息。
+   */
+  class ShardHandoff : private NonCopyable {
+  public:
+
+    /// 一次需要移交给同一个交通管理器的车辆。
+    struct Departure {
+      ShardRegion destination;
+      std::vector<ActorId> actor_ids;
+    };
+
+    /// @param own_port 本交通管理器的端口，用于在分区表中找到自己的区域。
+    explicit ShardHandoff(uint16_t own_port);
+
+    /// 设置分区表。表中没有本交通管理器的端口时关闭分区模式。
+    void SetShardMap(const ShardMap &shard_map);
+
+    bool IsEnabled() const {
+      return enabled.load();
+    }
+
+    /// 找出已离开本区域并进入其他区域的车辆，按目标交通管理器分组。
+    std::vector<Departure> SelectDepartures(
+        const std::vector<ActorId> &vehicle_ids,
+        const SimulationState &simulation_state) const;
+
+    /// 将车辆注册到目标交通管理器，失败时返回false。
+    bool Send(const ShardRegion &destination, const std::vector<carla::rpc::Actor> &actors);
+
+  private:
+
+    const uint16_t own_port;
+
+    std::atomic<bool> enabled{false};
+
+    mutable std::mutex mutex;
+
+    ShardRegion own_region;
+
+    /// 除本区域以外的其他区域。
+    ShardMap peer_regions;
+
+    /// 按"主机:端口"缓存的到其他交通管理器的连接，只在工作线程上访问。
+    std::unordered_map<std::string, std::unique_ptr<TrafficManagerClient>> clients;
+  };
+
+} // namespace traffic_manager
+} // namespace carla
@@ -0,0 +1,42 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "carla/MsgPack.h"
+#include "carla/geom/Location.h"
+
+namespace carla {
+namespace traffic_manager {
+
+  /// 地图分区中的一个区域及其所属交通管理器的地址。
+  /// 区域是水平面上的轴对齐矩形，不区分高度。
+  struct ShardRegion {
+    std::string host;
+    uint16_t port = 0u;
+    float min_x = 0.0f;
+    float min_y = 0.0f;
+    float max_x = 0.0f;
+    float max_y = 0.0f;
+
+    /// 判断 @a location 是否位于向外扩展 @a margin 米后的区域内。
+    bool Contains(const geom::Location &location, const float margin = 0.0f) const {
+      return location.x >= min_x - margin && location.x <= max_x + margin &&
+             location.y >= min_y - margin && location.y <= max_y + margin;
+    }
+
+    MSGPACK_DEFINE_ARRAY(host, port, min_x, min_y, max_x, max_y);
+  };
+
+  /// 所有参与分区的交通管理器共享的同一份分区表。
+  using ShardMap = std::vector<ShardRegion>;
+
+} // namespace traffic_manager
+} // namespace carla
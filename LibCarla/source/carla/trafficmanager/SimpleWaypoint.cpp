@@ -4,28 +4,47 @@
 // This work is licensed under the terms of the MIT license.
 // For a copy, see <https://opensource.org/licenses/MIT>.
 
+#include "carla/Debug.h"
 #include "carla/geom/Math.h"
 
 #include "carla/trafficmanager/SimpleWaypoint.h"
+#include "carla/trafficmanager/SimpleWaypointPool.h"
 
 namespace carla {
 namespace traffic_manager {
 
   using SimpleWaypointPtr = std::shared_ptr<SimpleWaypoint>; // 定义一个智能指针类型，指向SimpleWaypoint类的实例
 
-  SimpleWaypoint::SimpleWaypoint(WaypointPtr _waypoint) { // 构造函数，接受一个WaypointPtr类型的参数
-    waypoint = _waypoint; // 初始化成员waypoint
-    next_left_waypoint = nullptr; // 初始化左侧下一个路点为空
-    next_right_waypoint = nullptr; // 初始化右侧下一个路点为空
-  }
+  SimpleWaypoint::SimpleWaypoint(WaypointPtr _waypoint, SimpleWaypointPool *_pool, WaypointIndex _index)
+    : waypoint(_waypoint), // 初始化成员waypoint
+      pool(_pool), // 记录所属的内存池
+      index(_index) {} // 记录在内存池中的索引
   SimpleWaypoint::~SimpleWaypoint() {} // 析构函数
 
   std::vector<SimpleWaypointPtr> SimpleWaypoint::GetNextWaypoint() const { // 获取下一个路点
-    return next_waypoints; // 返回下一个路点的向量
+    std::vector<SimpleWaypointPtr> result;
+    result.reserve(next_waypoints.size());
+    for (const WaypointIndex next_index : next_waypoints) { // 将索引解析为路点
+      result.push_back(pool->Get(next_index));
+    }
+    return result; // 返回下一个路点的向量
   }
 
   std::vector<SimpleWaypointPtr> SimpleWaypoint::GetPreviousWaypoint() const { // 获取上一个路点
-    return previous_waypoints; // 返回上一个路点的向量
+    std::vector<SimpleWaypointPtr> result;
+    result.reserve(previous_waypoints.size());
+    for (const WaypointIndex previous_index : previous_waypoints) { // 将索引解析为路点
+      result.push_back(pool->Get(previous_index));
+    }
+    return result; // 返回上一个路点的向量
+  }
+
+  SimpleWaypoint *SimpleWaypoint::GetPooledWaypoint(const WaypointIndex pooled_index) const {
+    return &pool->At(pooled_index);
+  }
+
+  SimpleWaypointPtr SimpleWaypoint::GetSharedPtr() const {
+    return pool->Get(index);
   }
 
   WaypointPtr SimpleWaypoint::GetWaypoint() const { // 获取当前的Waypoint
@@ -37,11 +56,17 @@ namespace traffic_manager {
   }
 
   SimpleWaypointPtr SimpleWaypoint::GetLeftWaypoint() { // 获取左侧下一个路点
-    return next_left_waypoint; // 返回左侧下一个路点
+    if (next_left_waypoint == INVALID_WAYPOINT_INDEX) {
+      return nullptr; // 不存在左侧路点
+    }
+    return pool->Get(next_left_waypoint); // 返回左侧下一个路点
   }
 
   SimpleWaypointPtr SimpleWaypoint::GetRightWaypoint() { // 获取右侧下一个路点
-    return next_right_waypoint; // 返回右侧下一个路点
+    if (next_right_waypoint == INVALID_WAYPOINT_INDEX) {
+      return nullptr; // 不存在右侧路点
+    }
+    return pool->Get(next_right_waypoint); // 返回右侧下一个路点
   }
 
   cg::Location SimpleWaypoint::GetLocation() const { // 获取当前路点的位置
@@ -54,14 +79,16 @@ namespace traffic_manager {
 
   uint64_t SimpleWaypoint::SetNextWaypoint(const std::vector<SimpleWaypointPtr> &waypoints) { // 设置下一个路点
     for (auto &simple_waypoint: waypoints) { // 遍历给定的路点向量
-      next_waypoints.push_back(simple_waypoint); // 将每个路点添加到next_waypoints中
+      DEBUG_ASSERT(simple_waypoint->pool == pool);
+      next_waypoints.push_back(simple_waypoint->GetIndex()); // 将每个路点的索引添加到next_waypoints中
     }
     return static_cast<uint64_t>(waypoints.size()); // 返回设置的路点数量
   }
 
   uint64_t SimpleWaypoint::SetPreviousWaypoint(const std::vector<SimpleWaypointPtr> &waypoints) { // 设置上一个路点
     for (auto &simple_waypoint: waypoints) { // 遍历给定的路点向量
-      previous_waypoints.push_back(simple_waypoint); // 将每个路点添加到previous_waypoints中
+      DEBUG_ASSERT(simple_waypoint->pool == pool);
+      previous_waypoints.push_back(simple_waypoint->GetIndex()); // 将每个路点的索引添加到previous_waypoints中
     }
     return static_cast<uint64_t>(waypoints.size()); // 返回设置的路点数量
   }
@@ -70,7 +97,7 @@ namespace traffic_manager {
     const cg::Vector3D heading_vector = waypoint->GetTransform().GetForwardVector(); // 获取前进方向向量
     const cg::Vector3D relative_vector = GetLocation() - _waypoint->GetLocation(); // 计算相对位置向量
     if ((heading_vector.x * relative_vector.y - heading_vector.y * relative_vector.x) > 0.0f) { // 判断是否为左侧
-      next_left_waypoint = _waypoint; // 设置左侧下一个路点
+      next_left_waypoint = _waypoint->GetIndex(); // 设置左侧下一个路点
     }
   }
 
@@ -78,7 +105,7 @@ namespace traffic_manager {
     const cg::Vector3D heading_vector = waypoint->GetTransform().GetForwardVector(); // 获取前进方向向量
     const cg::Vector3D relative_vector = GetLocation() - _waypoint->GetLocation(); // 计算相对位置向量
     if ((heading_vector.x * relative_vector.y - heading_vector.y * relative_vector.x) < 0.0f) { // 判断是否为右侧
-      next_right_waypoint = _waypoint; // 设置右侧下一个路点
+      next_right_waypoint = _waypoint->GetIndex(); // 设置右侧下一个路点
     }
   }
 
@@ -90,6 +117,10 @@ namespace traffic_manager {
     return GetLocation().Distance(other->GetLocation()); // 返回距离
   }
 
+  float SimpleWaypoint::Distance(const SimpleWaypoint *other) const {
+    return GetLocation().Distance(other->GetLocation());
+  }
+
   float SimpleWaypoint::DistanceSquared(const cg::Location &location) const { // 计算与给定位置的平方距离
     return cg::Math::DistanceSquared(GetLocation(), location); // 返回平方距离
   }
@@ -98,6 +129,10 @@ namespace traffic_manager {
     return cg::Math::DistanceSquared(GetLocation(), other->GetLocation()); // 返回平方距离
   }
 
+  float SimpleWaypoint::DistanceSquared(const SimpleWaypoint *other) const {
+    return cg::Math::DistanceSquared(GetLocation(), other->GetLocation());
+  }
+
   bool SimpleWaypoint::CheckJunction() const { // 检查当前路点是否为交叉口
     return _is_junction; // 返回交叉口状态
   }
@@ -140,5 +175,10 @@ namespace traffic_manager {
     return road_option; // 返回道路选项
   }
 
+  void SimpleWaypoint::SetLookAheadJunctionId(GeoGridId junction_id) { // 设置前瞻交叉口ID
+    look_ahead_junction_id = junction_id;
+    has_look_ahead_junction_id = true;
+  }
+
 } // namespace traffic_manager
 } // namespace carla
\ No newline at end of file
@@ -6,7 +6,9 @@
 
 #pragma once
 
+#include <limits> // 引入数值极限相关的头文件
 #include <memory.h> // 引入内存操作相关的头文件
+#include <vector> // 引入向量容器相关的头文件
 
 #include "carla/client/Waypoint.h" // 引入Carla客户端的Waypoint类
 #include "carla/geom/Location.h" // 引入Carla几何位置类
@@ -22,6 +24,10 @@ namespace traffic_manager {
   namespace cg = carla::geom; // 简化命名空间cg为carla::geom
   using WaypointPtr = carla::SharedPtr<cc::Waypoint>; // 定义WaypointPtr为Waypoint的智能指针类型
   using GeoGridId = carla::road::JuncId; // 定义GeoGridId为交叉口ID类型
+  using WaypointIndex = uint32_t; // 定义WaypointIndex为路径点在内存池中的索引类型
+  static const WaypointIndex INVALID_WAYPOINT_INDEX = std::numeric_limits<WaypointIndex>::max(); // 表示不存在的路径点索引
+
+  class SimpleWaypointPool; // 前向声明路径点内存池
   enum class RoadOption : uint8_t { // 定义道路选项的枚举类
     Void = 0, // 无效选项
     Left = 1, // 向左
@@ -43,26 +49,56 @@ namespace traffic_manager {
 
     /// 指向Carla的Waypoint对象的指针，作为此类的封装对象。
     WaypointPtr waypoint;
-    /// 指向下一个连接waypoint的指针列表。
-    std::vector<SimpleWaypointPtr> next_waypoints;
-    /// 指向前一个连接waypoint的指针列表。
-    std::vector<SimpleWaypointPtr> previous_waypoints;
-    /// 指向左侧变道waypoint的指针。
-    SimpleWaypointPtr next_left_waypoint;
-    /// 指向右侧变道waypoint的指针。
-    SimpleWaypointPtr next_right_waypoint;
+    /// 存放此waypoint的内存池，用于将索引解析为waypoint。
+    SimpleWaypointPool *pool;
+    /// 此waypoint在内存池中的索引。
+    WaypointIndex index;
+    /// 下一个连接waypoint的索引列表。
+    std::vector<WaypointIndex> next_waypoints;
+    /// 前一个连接waypoint的索引列表。
+    std::vector<WaypointIndex> previous_waypoints;
+    /// 左侧变道waypoint的索引。
+    WaypointIndex next_left_waypoint = INVALID_WAYPOINT_INDEX;
+    /// 右侧变道waypoint的索引。
+    WaypointIndex next_right_waypoint = INVALID_WAYPOINT_INDEX;
     /// 当前waypoint的RoadOption。
     RoadOption road_option = RoadOption::Void; // 默认设置为无效选项
     /// 整数，用于将waypoint放置到地理网格中。
     GeoGridId geodesic_grid_id = 0; // 初始化为0
     // 布尔值，表示waypoint是否属于交叉口。
     bool _is_junction = false; // 默认设置为false
+    /// 沿后继方向前瞻一段距离处路径点的交叉口ID，建图时缓存。
+    GeoGridId look_ahead_junction_id = -1;
+    /// 前瞻交叉口ID是否有效；后继分叉且各分支结果不一致时为false。
+    bool has_look_ahead_junction_id = false;
 
   public:
 
-    SimpleWaypoint(WaypointPtr _waypoint); // 构造函数，初始化waypoint
+    /// 构造函数，仅由SimpleWaypointPool调用。
+    SimpleWaypoint(WaypointPtr _waypoint, SimpleWaypointPool *_pool, WaypointIndex _index);
     ~SimpleWaypoint(); // 析构函数
 
+    /// 返回此waypoint在内存池中的索引。
+    WaypointIndex GetIndex() const {
+      return index;
+    }
+
+    /// 返回下一个waypoint的索引列表，不产生引用计数操作。
+    const std::vector<WaypointIndex> &GetNextIndices() const {
+      return next_waypoints;
+    }
+
+    /// 返回前一个waypoint的索引列表，不产生引用计数操作。
+    const std::vector<WaypointIndex> &GetPreviousIndices() const {
+      return previous_waypoints;
+    }
+
+    /// 返回同一内存池中给定索引处的waypoint，不产生引用计数操作。
+    SimpleWaypoint *GetPooledWaypoint(WaypointIndex pooled_index) const;
+
+    /// 返回指向此waypoint的共享指针，共享内存池的引用计数。
+    SimpleWaypointPtr GetSharedPtr() const;
+
     /// 返回此waypoint的位置信息。
     cg::Location GetLocation() const;
 
@@ -113,12 +149,18 @@ namespace traffic_manager {
     /// 计算当前SimpleWaypoint对象与另一个SimpleWaypoint对象的距离。
     float Distance(const SimpleWaypointPtr &other) const;
 
+    /// 同上，用于路径点缓冲区中不持有引用计数的指针。
+    float Distance(const SimpleWaypoint *other) const;
+
     /// 计算到给定位置的距离的平方。
     float DistanceSquared(const cg::Location &location) const;
 
     /// 计算到其他waypoints的距离的平方。
     float DistanceSquared(const SimpleWaypointPtr &other) const;
 
+    /// 同上，用于路径点缓冲区中不持有引用计数的指针。
+    float DistanceSquared(const SimpleWaypoint *other) const;
+
     /// 如果对象的waypoint属于交叉口，则返回true。
     bool CheckJunction() const;
 
@@ -136,6 +178,19 @@ namespace traffic_manager {
     
     // 访问器方法，用于获取道路选项。
     RoadOption GetRoadOption();
+
+    /// 设置缓存的前瞻交叉口ID。
+    void SetLookAheadJunctionId(GeoGridId junction_id);
+
+    /// 如果缓存了前瞻交叉口ID，则返回true。
+    bool HasLookAheadJunctionId() const {
+      return has_look_ahead_junction_id;
+    }
+
+    /// 返回缓存的前瞻交叉口ID，不在交叉口时为-1。
+    GeoGridId GetLookAheadJunctionId() const {
+      return look_ahead_junction_id;
+    }
   };
 
 } // namespace traffic_manager
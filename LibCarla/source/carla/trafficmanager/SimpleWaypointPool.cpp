@@ -0,0 +1,32 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/Debug.h"
+
+#include "carla/trafficmanager/SimpleWaypointPool.h"
+
+namespace carla {
+namespace traffic_manager {
+
+  SimpleWaypointPtr SimpleWaypointPool::Create(WaypointPtr waypoint) {
+    DEBUG_ASSERT(_size < INVALID_WAYPOINT_INDEX);
+    if (_size % CHUNK_SIZE == 0u) {
+      _chunks.emplace_back();
+      _chunks.back().reserve(CHUNK_SIZE);
+    }
+    _chunks.back().emplace_back(waypoint, this, _size);
+    ++_size;
+    // 别名构造：共享内存池的引用计数，指向池中的路径点
+    return SimpleWaypointPtr(shared_from_this(), &_chunks.back().back());
+  }
+
+  SimpleWaypointPtr SimpleWaypointPool::Get(const WaypointIndex index) {
+    DEBUG_ASSERT(index < _size);
+    return SimpleWaypointPtr(shared_from_this(), &At(index));
+  }
+
+} // namespace traffic_manager
+} // namespace carla
@@ -0,0 +1,66 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "carla/NonCopyable.h"
+
+#include "carla/trafficmanager/SimpleWaypoint.h"
+
+namespace carla {
+namespace traffic_manager {
+
+  using SimpleWaypointPtr = std::shared_ptr<SimpleWaypoint>;
+
+  /// 集中存放一张地图所有SimpleWaypoint对象的内存池。
+  ///
+  /// 路径点按固定大小的块连续存放，一经创建地址便不再改变，并以32位索引寻址。
+  /// 路径点之间的连接只保存索引，对外提供的SimpleWaypointPtr均共享内存池的
+  /// 引用计数，因此只要仍有路径点被引用，整个内存池就保持有效。
+  /// 所有SimpleWaypointPtr共用同一个控制块，多线程下频繁复制会争用同一个原子计数，
+  /// 因此车辆路径点缓冲区等热点路径改用At()或裸指针，不经过共享指针。
+  /// 内存池必须通过 std::make_shared 创建。
+  class SimpleWaypointPool
+    : public std::enable_shared_from_this<SimpleWaypointPool>,
+      private NonCopyable {
+  public:
+
+    /// 在内存池中创建一个新的路径点。
+    SimpleWaypointPtr Create(WaypointPtr waypoint);
+
+    /// 返回给定索引处的路径点。
+    SimpleWaypointPtr Get(WaypointIndex index);
+
+    /// 返回给定索引处的路径点引用，不改变引用计数。
+    SimpleWaypoint &At(WaypointIndex index) {
+      return _chunks[index / CHUNK_SIZE][index % CHUNK_SIZE];
+    }
+
+    const SimpleWaypoint &At(WaypointIndex index) const {
+      return _chunks[index / CHUNK_SIZE][index % CHUNK_SIZE];
+    }
+
+    /// 内存池中路径点的数量。
+    WaypointIndex Size() const {
+      return _size;
+    }
+
+  private:
+
+    /// 每个存储块容纳的路径点数量。
+    static constexpr WaypointIndex CHUNK_SIZE = 1024u;
+
+    /// 每个存储块预留完整容量后不再扩容，保证路径点地址稳定。
+    std::vector<std::vector<SimpleWaypoint>> _chunks;
+
+    WaypointIndex _size = 0u;
+  };
+
+} // namespace traffic_manager
+} // namespace carla
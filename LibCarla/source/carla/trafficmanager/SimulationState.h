@@ -1,7 +1,9 @@
 
 #pragma once
 
+#include <unordered_map> // 引入无序映射头文件
 #include <unordered_set> // 引入无序集合头文件
+#include <vector> // 引入动态数组头文件
 
 #include "carla/trafficmanager/DataStructures.h" // 引入数据结构的头文件
 
@@ -44,17 +46,39 @@ struct StaticAttributes {
 using StaticAttributeMap = std::unordered_map<ActorId, StaticAttributes>; // 定义静态属性映射
 
 /// 该类保持了仿真中所有车辆的状态。
+// 参与者状态表中各标志位的掩码
+enum ActorStateFlags : uint8_t {
+  PHYSICS_ENABLED = 1u << 0, // 启用物理模拟
+  DORMANT = 1u << 1          // 处于休眠状态
+};
+
+// 以结构体数组（SoA）形式紧凑存储所有参与者状态的类
+//
+// 每个参与者在表中占据一个槽位，各列按槽位对齐存储，
+// 因此只需一次哈希查找即可得到槽位，随后的读取都是连续数组访问。
+// 槽位在添加或移除参与者时可能发生变化（移除时由最后一个槽位填补），
+// 只在两次修改之间有效。
 class SimulationState {
 
 private:
-  // 存储仿真中所有参与者的ID的结构
-  std::unordered_set<ActorId> actor_set; 
-  // 存储参与者动态运动相关状态的结构
-  KinematicStateMap kinematic_state_map; 
-  // 存储参与者静态属性的结构
-  StaticAttributeMap static_attribute_map; 
-  // 存储参与者动态交通灯相关状态的结构
-  TrafficLightStateMap tl_state_map; 
+  // 参与者ID到槽位的映射
+  std::unordered_map<ActorId, size_t> actor_slot;
+  // 以下各列按槽位对齐
+  std::vector<ActorId> actor_ids;
+  std::vector<cg::Location> locations;
+  std::vector<cg::Rotation> rotations;
+  // 由旋转预先计算的朝向，避免每次查询都重新计算三角函数
+  std::vector<cg::Vector3D> headings;
+  std::vector<cg::Vector3D> velocities;
+  std::vector<float> speed_limits;
+  std::vector<uint8_t> flags;
+  std::vector<cg::Location> hybrid_end_locations;
+  std::vector<ActorType> actor_types;
+  std::vector<cg::Vector3D> dimensions;
+  std::vector<TrafficLightState> tl_states;
+
+  // 将运动状态写入指定槽位
+  void SetKinematicState(size_t slot, const KinematicState &state);
 
 public :
   SimulationState(); // 构造函数
@@ -119,6 +143,26 @@ public :
   // 获取参与者尺寸的方法
   cg::Vector3D GetDimensions(const ActorId actor_id) const;
 
+  ////////////////////////////// 按槽位访问 //////////////////////////////
+
+  // 获取表中参与者的数量
+  size_t Size() const { return actor_ids.size(); }
+
+  // 获取参与者所在槽位的方法，参与者不存在时抛出 std::out_of_range
+  size_t GetSlot(const ActorId actor_id) const { return actor_slot.at(actor_id); }
+
+  // 以下方法返回按槽位对齐的整列数据，供各阶段在热点循环中直接读取
+  const std::vector<ActorId> &GetActorIds() const { return actor_ids; }
+  const std::vector<cg::Location> &GetLocations() const { return locations; }
+  const std::vector<cg::Rotation> &GetRotations() const { return rotations; }
+  const std::vector<cg::Vector3D> &GetHeadings() const { return headings; }
+  const std::vector<cg::Vector3D> &GetVelocities() const { return velocities; }
+  const std::vector<float> &GetSpeedLimits() const { return speed_limits; }
+  const std::vector<uint8_t> &GetFlags() const { return flags; }
+  const std::vector<ActorType> &GetTypes() const { return actor_types; }
+  const std::vector<cg::Vector3D> &GetAllDimensions() const { return dimensions; }
+  const std::vector<TrafficLightState> &GetTrafficLightStates() const { return tl_states; }
+
 };
 
 } // namespace traffic_manager
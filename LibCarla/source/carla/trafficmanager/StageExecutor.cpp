@@ -0,0 +1,46 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include <algorithm>
+
+#include "carla/TaskScheduler.h"
+#include "carla/trafficmanager/Constants.h"
+
+#include "carla/trafficmanager/StageExecutor.h"
+
+namespace carla {
+namespace traffic_manager {
+
+using namespace constants::StageExecution;
+
+StageExecutor::StageExecutor(const unsigned number_of_threads) {
+  SetNumberOfThreads(number_of_threads);
+}
+
+void StageExecutor::SetNumberOfThreads(const unsigned number_of_threads) {
+  _number_of_threads = std::min(std::max(number_of_threads, 1u), MAX_STAGE_THREADS);
+}
+
+void StageExecutor::ParallelFor(
+    const unsigned long size,
+    const std::function<void(unsigned long)> &functor) {
+
+  if (_number_of_threads <= 1u || size < MIN_PARALLEL_SIZE) {
+    for (unsigned long index = 0u; index < size; ++index) {
+      functor(index);
+    }
+    return;
+  }
+
+  TaskScheduler::Get().ParallelFor(
+      size,
+      [&functor](const size_t index) { functor(static_cast<unsigned long>(index)); },
+      1u,
+      _number_of_threads);
+}
+
+} // namespace traffic_manager
+} // namespace carla
@@ -0,0 +1,53 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <functional>
+
+#include "carla/NonCopyable.h"
+
+namespace carla {
+namespace traffic_manager {
+
+  /**
+   * @class StageExecutor
+   * @brief 用于在多个线程间分摊各阶段逐车辆计算的执行器。
+   *
+   * 调用线程本身也参与计算，因此线程数为1时所有工作都在调用线程上按索引顺序
+   * 串行执行，与原来的循环完全一致。
+   *
+   * 计算在共享的 TaskScheduler 中进行，不再单独创建线程；线程数只限制同时处理
+   * 同一阶段的线程数，实际并行度不超过调度器的工作线程数加一。索引区间被切分为
+   * 若干小块，空闲的线程接手剩余的块，从而平衡不同车辆之间计算量的差异。
+   */
+  class StageExecutor : private NonCopyable {
+  public:
+
+    /// 以给定的线程数（包括调用线程）构造执行器。
+    explicit StageExecutor(unsigned number_of_threads = 1u);
+
+    /// 修改线程数。不得在 ParallelFor 执行期间调用。
+    void SetNumberOfThreads(unsigned number_of_threads);
+
+    /// 获取当前的线程数（包括调用线程）。
+    unsigned GetNumberOfThreads() const {
+      return _number_of_threads;
+    }
+
+    /// 对区间 [0, size) 中的每个索引调用 @a functor。
+    ///
+    /// 函数返回时所有索引均已处理完毕，因此连续两次调用之间相当于一个屏障。
+    /// 若任一调用抛出异常，则在所有工作完成后于调用线程重新抛出第一个异常。
+    void ParallelFor(unsigned long size, const std::function<void(unsigned long)> &functor);
+
+  private:
+
+    unsigned _number_of_threads = 1u;
+  };
+
+} // namespace traffic_manager
+} // namespace carla
@@ -0,0 +1,193 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include <algorithm>
+#include <cmath>
+
+#include "carla/trafficmanager/Constants.h"
+
+#include "carla/trafficmanager/StageProfiler.h"
+
+namespace carla {
+namespace traffic_manager {
+
+using namespace constants::Profiling;
+
+StageProfiler::StageProfiler()
+  : window(PROFILE_WINDOW_STEPS) {
+  step_stage_costs.fill(0.0f);
+}
+
+void StageProfiler::SetEnabled(const bool enable) {
+  const bool was_enabled = enabled.exchange(enable);
+  if (enable && !was_enabled) {
+    Reset();
+  }
+}
+
+bool StageProfiler::BeginStep() {
+  step_active = enabled.load();
+  if (!step_active) {
+    return false;
+  }
+  step_begin = Clock::now();
+  step_stage_costs.fill(0.0f);
+  step_vehicle_costs.clear();
+  return true;
+}
+
+void StageProfiler::SetNumberOfVehicles(const unsigned long number_of_vehicles) {
+  if (!step_active) {
+    return;
+  }
+  StageCosts zero_costs;
+  zero_costs.fill(0.0f);
+  step_vehicle_costs.assign(number_of_vehicles, zero_costs);
+}
+
+void StageProfiler::EndStep(const std::vector<ActorId> &vehicle_ids, const uint64_t frame_allocations) {
+  if (!step_active) {
+    return;
+  }
+  step_active = false;
+  step_stage_costs[ToIndex(ProfiledStage::Step)] = ToMilliseconds(Clock::now() - step_begin);
+
+  std::lock_guard<std::mutex> lock(mutex);
+  StepSample &sample = window[window_head];
+  sample.stage_costs = step_stage_costs;
+  sample.frame_allocations = frame_allocations;
+  window_head = (window_head + 1u) % window.size();
+  window_size = std::min(window_size + 1u, window.size());
+  ++step_count;
+
+  CollectOutliers(vehicle_ids);
+}
+
+void StageProfiler::CollectOutliers(const std::vector<ActorId> &vehicle_ids) {
+  const std::size_t number_of_vehicles = std::min(vehicle_ids.size(), step_vehicle_costs.size());
+  if (number_of_vehicles == 0u) {
+    return;
+  }
+
+  vehicle_totals.resize(number_of_vehicles);
+  for (std::size_t i = 0u; i < number_of_vehicles; ++i) {
+    const StageCosts &costs = step_vehicle_costs[i];
+    float total = 0.0f;
+    for (const float cost : costs) {
+      total += cost;
+    }
+    vehicle_totals[i] = total;
+  }
+
+  // 以同步车辆耗时的中位数为基准，避免整体变慢时把所有车辆都记为离群
+  std::vector<float> sorted_totals(vehicle_totals);
+  auto median = sorted_totals.begin() + static_cast<long>(number_of_vehicles / 2u);
+  std::nth_element(sorted_totals.begin(), median, sorted_totals.end());
+  const float threshold = std::max(OUTLIER_COST_FACTOR * (*median), MIN_OUTLIER_COST);
+
+  for (std::size_t i = 0u; i < number_of_vehicles; ++i) {
+    if (vehicle_totals[i] <= threshold) {
+      continue;
+    }
+    const StageCosts &costs = step_vehicle_costs[i];
+    const std::size_t dominant = static_cast<std::size_t>(
+        std::max_element(costs.begin(), costs.end()) - costs.begin());
+
+    VehicleCost outlier;
+    outlier.actor_id = vehicle_ids[i];
+    outlier.step = step_count;
+    outlier.cost = vehicle_totals[i];
+    outlier.dominant_stage = GetStageName(dominant);
+    outliers.push_back(std::move(outlier));
+  }
+
+  while (outliers.size() > MAX_STORED_OUTLIERS) {
+    outliers.pop_front();
+  }
+}
+
+TrafficManagerProfile StageProfiler::GetProfile() const {
+  TrafficManagerProfile profile;
+  profile.enabled = enabled.load();
+
+  std::lock_guard<std::mutex> lock(mutex);
+  profile.window_steps = window_size;
+  if (window_size == 0u) {
+    return profile;
+  }
+
+  // 窗口未满时有效样本位于 [0, window_size)，已满时为整个数组，两种情况下顺序均不影响统计
+  std::vector<float> values(window_size);
+  for (std::size_t stage = 0u; stage < NUMBER_OF_STAGES; ++stage) {
+    float sum = 0.0f;
+    for (std::size_t i = 0u; i < window_size; ++i) {
+      values[i] = window[i].stage_costs[stage];
+      sum += values[i];
+    }
+    std::sort(values.begin(), values.end());
+
+    // 最近秩法：第p百分位取排序后第 ceil(p * n) 个样本
+    auto percentile = [&values](const float p) {
+      const std::size_t rank = static_cast<std::size_t>(std::ceil(p * static_cast<float>(values.size())));
+      return values[std::min(std::max(rank, std::size_t(1u)), values.size()) - 1u];
+    };
+
+    StageLatency latency;
+    latency.stage = GetStageName(stage);
+    latency.samples = window_size;
+    latency.mean = sum / static_cast<float>(window_size);
+    latency.p50 = percentile(0.50f);
+    latency.p95 = percentile(0.95f);
+    latency.p99 = percentile(0.99f);
+    latency.max = values.back();
+    profile.stages.push_back(std::move(latency));
+  }
+
+  for (std::size_t i = 0u; i < window_size; ++i) {
+    profile.frame_allocations += window[i].frame_allocations;
+  }
+
+  // 只报告仍在窗口内的离群记录
+  const uint64_t oldest_step = step_count - window_size;
+  for (const VehicleCost &outlier : outliers) {
+    if (outlier.step > oldest_step) {
+      profile.vehicle_outliers.push_back(outlier);
+    }
+  }
+  std::sort(profile.vehicle_outliers.begin(), profile.vehicle_outliers.end(),
+      [](const VehicleCost &a, const VehicleCost &b) { return a.cost > b.cost; });
+  if (profile.vehicle_outliers.size() > MAX_REPORTED_OUTLIERS) {
+    profile.vehicle_outliers.resize(MAX_REPORTED_OUTLIERS);
+  }
+
+  return profile;
+}
+
+void StageProfiler::Reset() {
+  std::lock_guard<std::mutex> lock(mutex);
+  window_head = 0u;
+  window_size = 0u;
+  step_count = 0u;
+  outliers.clear();
+}
+
+const char *StageProfiler::GetStageName(const std::size_t stage_index) {
+  static const char *const names[NUMBER_OF_STAGES] = {
+    "alsm",
+    "localization",
+    "collision_prepare",
+    "collision",
+    "traffic_light",
+    "motion_plan",
+    "vehicle_light",
+    "apply_batch",
+    "step"
+  };
+  return stage_index < NUMBER_OF_STAGES ? names[stage_index] : "unknown";
+}
+
+} // namespace traffic_manager
+} // namespace carla
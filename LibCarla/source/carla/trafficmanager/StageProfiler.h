@@ -0,0 +1,144 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+#include "carla/NonCopyable.h"
+#include "carla/rpc/ActorId.h"
+#include "carla/trafficmanager/TrafficManagerProfile.h"
+
+namespace carla {
+namespace traffic_manager {
+
+  /// 交通管理器每一步中被计时的阶段，按执行顺序排列。
+  enum class ProfiledStage : uint8_t {
+    ALSM,
+    Localization,
+    CollisionPrepare,
+    Collision,
+    TrafficLight,
+    MotionPlan,
+    VehicleLight,
+    ApplyBatch,
+    Step,
+    Count
+  };
+
+  /**
+   * @class StageProfiler
+   * @brief 统计交通管理器各阶段在最近若干步内的耗时分布。
+   *
+   * 计时只在工作线程上进行，每步结束时将结果提交到受互斥锁保护的滑动窗口中，
+   * 因此 GetProfile 可以在其他线程（例如RPC服务线程）上安全调用。
+   * 未启用时每步只读取一次原子标志，不产生任何计时开销。
+   */
+  class StageProfiler : private NonCopyable {
+  public:
+
+    using Clock = std::chrono::steady_clock;
+
+    StageProfiler();
+
+    /// 启用或停用统计。重新启用时会清空之前的窗口。
+    void SetEnabled(bool enabled);
+
+    bool IsEnabled() const {
+      return enabled.load();
+    }
+
+    /// 开始新的一步，返回这一步是否被统计。
+    bool BeginStep();
+
+    /// 设置本步参与逐车辆计时的车辆数，须在 MeasureVehicle 之前调用。
+    void SetNumberOfVehicles(unsigned long number_of_vehicles);
+
+    /// 结束当前步并将结果提交到窗口。@a vehicle_ids 与计时时使用的索引一一对应。
+    void EndStep(const std::vector<ActorId> &vehicle_ids, uint64_t frame_allocations);
+
+    /// 执行 @a functor 并将耗时计入 @a stage。
+    template <typename Functor>
+    void Measure(const ProfiledStage stage, Functor &&functor) {
+      if (!step_active) {
+        functor();
+        return;
+      }
+      const Clock::time_point begin = Clock::now();
+      functor();
+      step_stage_costs[ToIndex(stage)] += ToMilliseconds(Clock::now() - begin);
+    }
+
+    /// 执行 @a functor 并将耗时同时计入 @a stage 和索引为 @a index 的车辆。
+    template <typename Functor>
+    void MeasureVehicle(const unsigned long index, const ProfiledStage stage, Functor &&functor) {
+      if (!step_active) {
+        functor();
+        return;
+      }
+      const Clock::time_point begin = Clock::now();
+      functor();
+      const float cost = ToMilliseconds(Clock::now() - begin);
+      step_stage_costs[ToIndex(stage)] += cost;
+      step_vehicle_costs[index][ToIndex(stage)] += cost;
+    }
+
+    /// 获取当前窗口的统计结果。
+    TrafficManagerProfile GetProfile() const;
+
+    /// 清空窗口和离群记录。
+    void Reset();
+
+  private:
+
+    static constexpr std::size_t NUMBER_OF_STAGES = static_cast<std::size_t>(ProfiledStage::Count);
+
+    using StageCosts = std::array<float, NUMBER_OF_STAGES>;
+
+    struct StepSample {
+      StageCosts stage_costs;
+      uint64_t frame_allocations = 0u;
+    };
+
+    static std::size_t ToIndex(const ProfiledStage stage) {
+      return static_cast<std::size_t>(stage);
+    }
+
+    static float ToMilliseconds(const Clock::duration duration) {
+      return std::chrono::duration<float, std::milli>(duration).count();
+    }
+
+    static const char *GetStageName(std::size_t stage_index);
+
+    /// 找出本步中耗时明显高于其他车辆的车辆，调用时须持有 mutex。
+    void CollectOutliers(const std::vector<ActorId> &vehicle_ids);
+
+    std::atomic<bool> enabled{false};
+
+    /// 以下成员只在工作线程上访问。
+    bool step_active = false;
+    Clock::time_point step_begin;
+    StageCosts step_stage_costs;
+    std::vector<StageCosts> step_vehicle_costs;
+    std::vector<float> vehicle_totals;
+
+    /// 以下成员由 mutex 保护。
+    mutable std::mutex mutex;
+    /// 固定大小的环形窗口，window_head 指向下一个写入位置。
+    std::vector<StepSample> window;
+    std::size_t window_head = 0u;
+    std::size_t window_size = 0u;
+    uint64_t step_count = 0u;
+    std::deque<VehicleCost> outliers;
+  };
+
+} // namespace traffic_manager
+} // namespace carla
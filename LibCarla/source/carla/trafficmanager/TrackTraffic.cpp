@@ -1,4 +1,6 @@
 
+#include <algorithm>
+
 #include "carla/trafficmanager/Constants.h"
 
 #include "carla/trafficmanager/TrackTraffic.h"
@@ -13,93 +15,100 @@ TrackTraffic::TrackTraffic() {}
 
 void TrackTraffic::UpdateUnregisteredGridPosition(const ActorId actor_id,
                                                   const std::vector<SimpleWaypointPtr> waypoints) {
-// 删除指定参与者的现有信息
-    DeleteActor(actor_id);
+// 删除指定参与者的现有路点信息，网格信息在下面增量更新
+    RemovePassingWaypoints(actor_id);
 
-    std::unordered_set<GeoGridId> current_grids;
+    grid_scratch.clear();
     // Step through waypoints and update grid list for actor and actor list for grids.
     for (auto &waypoint : waypoints) {
     	 // 更新经过的车辆信息
         UpdatePassingVehicle(waypoint->GetId(), actor_id);
 // 获取路点的地理网格 ID
-        GeoGridId ggid = waypoint->GetGeodesicGridId();
-        // 将网格 ID 插入当前网格集合
-        current_grids.insert(ggid);
-// 如果网格到参与者的映射中存在该网格 ID
-        if (grid_to_actors.find(ggid) != grid_to_actors.end()) {
-        	// 获取对应网格的参与者集合
-            ActorIdSet &actor_ids = grid_to_actors.at(ggid);
-            // 如果参与者 ID 不在集合中，插入参与者 ID
-            if (actor_ids.find(actor_id) == actor_ids.end()) {
-                actor_ids.insert(actor_id);
-            }
-        } else {
-        	// 如果映射中不存在该网格 ID，创建新的映射关系
-            grid_to_actors.insert({ggid, {actor_id}});
-        }
+        grid_scratch.push_back(waypoint->GetGeodesicGridId());
     }
-// 将参与者 ID 和当前网格集合插入参与者到网格的映射中
-    actor_to_grids.insert({actor_id, current_grids});
+    SetActorGrids(actor_id, grid_scratch);
 }
 
 void TrackTraffic::UpdateGridPosition(const ActorId actor_id, const Buffer &buffer) {
 	// 如果缓冲区不为空
     if (!buffer.empty()) {
-
-        // Clear current actor from all grids containing itself.
-        if (actor_to_grids.find(actor_id) != actor_to_grids.end()) {
-            std::unordered_set<GeoGridId> &current_grids = actor_to_grids.at(actor_id);
-            // 遍历当前参与者所在的网格集合
-            for (auto &grid_id : current_grids) {
-            	// 如果网格到参与者的映射中存在该网格 ID
-                if (grid_to_actors.find(grid_id) != grid_to_actors.end()) {
-                	// 获取对应网格的参与者集合
-                    ActorIdSet &actor_ids = grid_to_actors.at(grid_id);
-                    // 从集合中删除该参与者 ID
-                    actor_ids.erase(actor_id);
-                }
+        // Step through buffer and collect the grids covered by the actor's path.
+        grid_scratch.clear();
+        uint64_t buffer_size = buffer.size();
+        // 遍历缓冲区中的路点，相邻路点通常位于同一网格，直接跳过重复项
+        for (uint64_t i = 0u; i < buffer_size; ++i) {
+            const GeoGridId ggid = buffer.at(i)->GetGeodesicGridId();
+            if (grid_scratch.empty() || grid_scratch.back() != ggid) {
+                grid_scratch.push_back(ggid);
             }
-// 从参与者到网格的映射中删除该参与者
-            actor_to_grids.erase(actor_id);
         }
+        SetActorGrids(actor_id, grid_scratch);
+    }
+}
 
-        // Step through buffer and update grid list for actor and actor list for grids.
-        std::unordered_set<GeoGridId> current_grids;
-        uint64_t buffer_size = buffer.size();
-        // 遍历缓冲区中的路点
-        for (uint64_t i = 0u; i <= buffer_size - 1u; ++i) {
-            auto waypoint = buffer.at(i);
-            GeoGridId ggid = waypoint->GetGeodesicGridId();
-            current_grids.insert(ggid);
-            // Add grid entry if not present.
-            if (grid_to_actors.find(ggid) == grid_to_actors.end()) {
-                grid_to_actors.insert({ggid, {}});
-            }
-// 获取对应网格的参与者集合
-            ActorIdSet &actor_ids = grid_to_actors.at(ggid);
-            // 如果参与者 ID 不在集合中，插入参与者 ID
-            if (actor_ids.find(actor_id) == actor_ids.end()) {
-                actor_ids.insert(actor_id);
-            }
+void TrackTraffic::SetActorGrids(const ActorId actor_id, GridList &new_grids) {
+    std::sort(new_grids.begin(), new_grids.end());
+    new_grids.erase(std::unique(new_grids.begin(), new_grids.end()), new_grids.end());
+
+    GridList &old_grids = actor_to_grids[actor_id];
+    // 两个列表均已排序，一次归并即可找出离开和进入的网格
+    auto old_it = old_grids.begin();
+    auto new_it = new_grids.begin();
+    while (old_it != old_grids.end() || new_it != new_grids.end()) {
+        if (new_it == new_grids.end() || (old_it != old_grids.end() && *old_it < *new_it)) {
+            RemoveActorFromGrid(*old_it++, actor_id);
+        } else if (old_it == old_grids.end() || *new_it < *old_it) {
+            AddActorToGrid(*new_it++, actor_id);
+        } else {
+            ++old_it;
+            ++new_it;
         }
-// 将参与者 ID 和当前网格集合插入参与者到网格的映射中
-        actor_to_grids.insert({actor_id, current_grids});
+    }
+    // 交换后旧列表的内存留作下一次的缓冲区
+    old_grids.swap(new_grids);
+}
+
+void TrackTraffic::AddActorToGrid(const GeoGridId grid_id, const ActorId actor_id) {
+    if (grid_id < 0) {
+        return;
+    }
+    const std::size_t cell_index = static_cast<std::size_t>(grid_id);
+    if (cell_index >= grid_to_actors.size()) {
+        grid_to_actors.resize(cell_index + 1u);
+    }
+    std::vector<ActorId> &cell = grid_to_actors[cell_index];
+    if (std::find(cell.begin(), cell.end(), actor_id) == cell.end()) {
+        cell.push_back(actor_id);
+    }
+}
+
+void TrackTraffic::RemoveActorFromGrid(const GeoGridId grid_id, const ActorId actor_id) {
+    if (grid_id < 0 || static_cast<std::size_t>(grid_id) >= grid_to_actors.size()) {
+        return;
+    }
+    std::vector<ActorId> &cell = grid_to_actors[static_cast<std::size_t>(grid_id)];
+    auto it = std::find(cell.begin(), cell.end(), actor_id);
+    if (it != cell.end()) {
+        // 网格内的顺序无关紧要，用末尾元素填补空位
+        *it = cell.back();
+        cell.pop_back();
     }
 }
 
 
 bool TrackTraffic::IsGeoGridFree(const GeoGridId geogrid_id) const {
-    if (grid_to_actors.find(geogrid_id) != grid_to_actors.end()) {
-        return grid_to_actors.at(geogrid_id).empty();
+    if (geogrid_id >= 0 && static_cast<std::size_t>(geogrid_id) < grid_to_actors.size()) {
+        return grid_to_actors[static_cast<std::size_t>(geogrid_id)].empty();
     }
     return true;
 }
 
 void TrackTraffic::AddTakenGrid(const GeoGridId geogrid_id, const ActorId actor_id) {
-	// 如果网格到参与者的映射中不存在该网格 ID
-    if (grid_to_actors.find(geogrid_id) == grid_to_actors.end()) {
-    	// 创建新的映射关系（网格 ID 到包含该演员 ID 的集合）
-        grid_to_actors.insert({geogrid_id, {actor_id}});
+	// 如果该网格当前空闲，则由该参与者占用，直到其下一次更新网格位置
+    if (IsGeoGridFree(geogrid_id)) {
+        AddActorToGrid(geogrid_id, actor_id);
+        GridList &grids = actor_to_grids[actor_id];
+        grids.insert(std::lower_bound(grids.begin(), grids.end(), geogrid_id), geogrid_id);
     }
 }
 
@@ -112,43 +121,41 @@ cg::Location TrackTraffic::GetHeroLocation() const {
     return hero_location;
 }
 
-ActorIdSet TrackTraffic::GetOverlappingVehicles(ActorId actor_id) const {
-    ActorIdSet actor_id_set;
+std::vector<ActorId> TrackTraffic::GetOverlappingVehicles(ActorId actor_id) const {
+    std::vector<ActorId> actor_ids;
 // 如果参与者在参与者到网格的映射中
-    if (actor_to_grids.find(actor_id) != actor_to_grids.end()) {
-        const std::unordered_set<GeoGridId> &grid_ids = actor_to_grids.at(actor_id);
-        // 遍历参与者所在的网格集合
-        for (auto &grid_id : grid_ids) {
-        	// 如果网格到参与者的映射中存在该网格 ID
-            if (grid_to_actors.find(grid_id) != grid_to_actors.end()) {
-            	 // 获取对应网格的参与者集合
-                const ActorIdSet &actor_ids = grid_to_actors.at(grid_id);
-                 // 将集合中的参与者 ID 插入结果集合
-                actor_id_set.insert(actor_ids.begin(), actor_ids.end());
+    const auto grids_it = actor_to_grids.find(actor_id);
+    if (grids_it != actor_to_grids.end()) {
+        // 遍历参与者所在的网格，收集其中的参与者
+        for (const GeoGridId grid_id : grids_it->second) {
+            if (grid_id >= 0 && static_cast<std::size_t>(grid_id) < grid_to_actors.size()) {
+                const std::vector<ActorId> &cell = grid_to_actors[static_cast<std::size_t>(grid_id)];
+                actor_ids.insert(actor_ids.end(), cell.begin(), cell.end());
             }
         }
+        // 排序去重，使结果与网格内的存放顺序无关
+        std::sort(actor_ids.begin(), actor_ids.end());
+        actor_ids.erase(std::unique(actor_ids.begin(), actor_ids.end()), actor_ids.end());
     }
 
-    return actor_id_set;
+    return actor_ids;
 }
 
 void TrackTraffic::DeleteActor(ActorId actor_id) {
 	// 如果参与者在参与者到网格的映射中
-    if (actor_to_grids.find(actor_id) != actor_to_grids.end()) {
-        std::unordered_set<GeoGridId> &grid_ids = actor_to_grids.at(actor_id);
-        // 遍历参与者所在的网格集合
-        for (auto &grid_id : grid_ids) {
-        	// 如果网格到参与者的映射中存在该网格 ID
-            if (grid_to_actors.find(grid_id) != grid_to_actors.end()) {
-            	// 获取对应网格的参与者集合
-                ActorIdSet &actor_ids = grid_to_actors.at(grid_id);
-                // 从集合中删除该参与者 ID
-                actor_ids.erase(actor_id);
-                }
-            }
-            // 从参与者到网格的映射中删除该参与者
-        actor_to_grids.erase(actor_id);
+    const auto grids_it = actor_to_grids.find(actor_id);
+    if (grids_it != actor_to_grids.end()) {
+        // 从参与者所在的每个网格中删除该参与者
+        for (const GeoGridId grid_id : grids_it->second) {
+            RemoveActorFromGrid(grid_id, actor_id);
+        }
+        // 从参与者到网格的映射中删除该参与者
+        actor_to_grids.erase(grids_it);
     }
+    RemovePassingWaypoints(actor_id);
+}
+
+void TrackTraffic::RemovePassingWaypoints(const ActorId actor_id) {
 // 如果参与者在路点占用的映射中
     if (waypoint_occupied.find(actor_id) != waypoint_occupied.end()) {
         WaypointIdSet waypoint_id_set = waypoint_occupied.at(actor_id);
@@ -216,6 +223,12 @@ ActorIdSet TrackTraffic::GetPassingVehicles(uint64_t waypoint_id) const {
         return ActorIdSet();
     }
 }
+
+bool TrackTraffic::HasPassingVehicles(uint64_t waypoint_id) const {
+
+    const auto it = waypoint_overlap_tracker.find(waypoint_id);
+    return it != waypoint_overlap_tracker.end() && !it->second.empty();
+}
 // 清空所有数据结构
 void TrackTraffic::Clear() {
     waypoint_overlap_tracker.clear();
@@ -1,10 +1,15 @@
 
 #pragma once
 
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
 #include "carla/road/RoadTypes.h"
 #include "carla/rpc/ActorId.h"
 
 #include "carla/trafficmanager/SimpleWaypoint.h"
+#include "carla/trafficmanager/WaypointBuffer.h"
 
 namespace carla {
 namespace traffic_manager {
@@ -12,7 +17,7 @@ namespace traffic_manager {
 using ActorId = carla::ActorId;
 using ActorIdSet = std::unordered_set<ActorId>;
 using SimpleWaypointPtr = std::shared_ptr<SimpleWaypoint>;
-using Buffer = std::deque<SimpleWaypointPtr>;
+using Buffer = WaypointBuffer;
 using GeoGridId = carla::road::JuncId;
 
 // 此类用于跟踪所有角色的航点占用情况
@@ -28,10 +33,14 @@ private:
     using WaypointOccupancyMap = std::unordered_map<ActorId, WaypointIdSet>;
     WaypointOccupancyMap waypoint_occupied;
 
-    /// 参与者路径所占据的测地线网格
-    std::unordered_map<ActorId, std::unordered_set<GeoGridId>> actor_to_grids;
-    /// 参与者当前经过的网格
-    std::unordered_map<GeoGridId, ActorIdSet> grid_to_actors;
+    /// 参与者路径所占据的测地线网格，按网格ID升序排列且不重复
+    using GridList = std::vector<GeoGridId>;
+    std::unordered_map<ActorId, GridList> actor_to_grids;
+    /// 以网格ID为下标的占用表，每个网格存放当前经过它的参与者。
+    /// 网格ID在建图时连续分配，因此直接用数组索引，各网格的容量在步与步之间保留
+    std::vector<std::vector<ActorId>> grid_to_actors;
+    /// 计算新网格列表时复用的缓冲区
+    GridList grid_scratch;
     /// 当前英雄位置
     cg::Location hero_location = cg::Location(0,0,0);
 
@@ -43,12 +52,15 @@ public:
     void UpdatePassingVehicle(uint64_t waypoint_id, ActorId actor_id);
     void RemovePassingVehicle(uint64_t waypoint_id, ActorId actor_id);
     ActorIdSet GetPassingVehicles(uint64_t waypoint_id) const;
+    /// 只判断是否有车辆经过某一路点，不复制车辆集合
+    bool HasPassingVehicles(uint64_t waypoint_id) const;
 
     void UpdateGridPosition(const ActorId actor_id, const Buffer &buffer);
     void UpdateUnregisteredGridPosition(const ActorId actor_id,
                                         const std::vector<SimpleWaypointPtr> waypoints);
 
-    ActorIdSet GetOverlappingVehicles(ActorId actor_id) const;
+    /// 返回与参与者路径网格重叠的所有参与者（包括其自身），按ID升序排列
+    std::vector<ActorId> GetOverlappingVehicles(ActorId actor_id) const;
     bool IsGeoGridFree(const GeoGridId geogrid_id) const;
     void AddTakenGrid(const GeoGridId geogrid_id, const ActorId actor_id);
 
@@ -60,6 +72,14 @@ public:
     void DeleteActor(ActorId actor_id);
 
     void Clear();
+
+private:
+    /// 将参与者的网格列表替换为 @a new_grids，只更新成员关系发生变化的网格
+    void SetActorGrids(const ActorId actor_id, GridList &new_grids);
+    void AddActorToGrid(const GeoGridId grid_id, const ActorId actor_id);
+    void RemoveActorFromGrid(const GeoGridId grid_id, const ActorId actor_id);
+    /// 移除参与者占用的所有路点记录
+    void RemovePassingWaypoints(const ActorId actor_id);
 };
 
 } // namespace traffic_manager
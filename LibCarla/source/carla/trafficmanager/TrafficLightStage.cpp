@@ -30,20 +30,27 @@ TrafficLightStage::TrafficLightStage(
     output_array(output_array), // 初始化输出数组
     random_device(random_device) {} // 初始化随机数生成器
 
-// 更新函数
+void TrafficLightStage::PrepareStep() {
+  current_timestamp = world.GetSnapshot().GetTimestamp(); // 获取当前时间戳
+  junction_decisions.assign(vehicle_id_list.size(), JunctionDecision{});
+}
+
+// 更新函数。路口队列只在 CommitStep 中修改，这里只记录要执行的操作
 void TrafficLightStage::Update(const unsigned long index) {
   bool traffic_light_hazard = false; // 交通信号灯危险标志
+  JunctionDecision &decision = junction_decisions.at(index);
 
   const ActorId ego_actor_id = vehicle_id_list.at(index); // 获取当前车辆 ID
   if (!simulation_state.IsDormant(ego_actor_id)) { // 如果车辆不处于休眠状态
+    // 本车在这一步的随机数流，抽取结果与其他车辆的处理顺序无关
+    RandomStream random_stream = random_device.GetStream(ego_actor_id, RandomStreamId::TrafficLight);
 
     JunctionID current_junction_id = -1; // 当前交叉口 ID 初始化为 -1
-    if (vehicle_last_junction.find(ego_actor_id) != vehicle_last_junction.end()) {
-      current_junction_id = vehicle_last_junction.at(ego_actor_id); // 获取上次的交叉口 ID
+    const auto last_junction_it = vehicle_last_junction.find(ego_actor_id);
+    if (last_junction_it != vehicle_last_junction.end()) {
+      current_junction_id = last_junction_it->second; // 获取上次的交叉口 ID
     }
-    auto affected_junction_id = GetAffectedJunctionId(ego_actor_id); // 获取受影响的交叉口 ID
-
-    current_timestamp = world.GetSnapshot().GetTimestamp(); // 获取当前时间戳
+    auto affected_junction_id = GetAffectedJunctionId(ego_actor_id, current_junction_id); // 获取受影响的交叉口 ID
 
     const TrafficLightState tl_state = simulation_state.GetTLS(ego_actor_id); // 获取交通信号灯状态
     const TLS traffic_light_state = tl_state.tl_state; // 交通信号灯当前状态
@@ -53,10 +60,10 @@ void TrafficLightStage::Update(const unsigned long index) {
     if (is_at_traffic_light &&
         traffic_light_state != TLS::Green &&
         traffic_light_state != TLS::Off &&
-        parameters.GetPercentageRunningLight(ego_actor_id) <= random_device.next()) {
+        parameters.GetPercentageRunningLight(ego_actor_id) <= random_stream.next()) {
       // 如果车辆在受交通信号灯影响的非信号交叉口，移除车辆
       if (current_junction_id != -1) {
-        RemoveActor(ego_actor_id);
+        decision.action = JunctionAction::Remove;
       }
       traffic_light_hazard = true; // 设置交通信号灯危险标志为真
     }
@@ -64,24 +71,47 @@ void TrafficLightStage::Update(const unsigned long index) {
     // 不要使用下一个条件，因为边界框可能会变为绿色
     else if (current_junction_id != -1) {
       if (affected_junction_id == -1 || affected_junction_id != current_junction_id) {
-        RemoveActor(ego_actor_id); // 移除车辆
+        decision.action = JunctionAction::Remove; // 移除车辆
       } else {
-        traffic_light_hazard = HandleNonSignalisedJunction(ego_actor_id, affected_junction_id, current_timestamp); // 处理非信号交叉口
+        // 能否进入取决于路口队列，在 CommitStep 中处理
+        decision.action = JunctionAction::Handle;
+        decision.junction_id = affected_junction_id;
       }
     }
     // 如果在受影响的交叉口且不在交通信号灯处
     else if (affected_junction_id != -1 &&
             !is_at_traffic_light &&
             traffic_light_state != TLS::Green &&
-            parameters.GetPercentageRunningSign(ego_actor_id) <= random_device.next()) {
+            parameters.GetPercentageRunningSign(ego_actor_id) <= random_stream.next()) {
 
-      AddActorToNonSignalisedJunction(ego_actor_id, affected_junction_id); // 将车辆添加到非信号交叉口
+      decision.action = JunctionAction::Enter; // 将车辆添加到非信号交叉口
+      decision.junction_id = affected_junction_id;
       traffic_light_hazard = true; // 设置交通信号灯危险标志为真
     }
   }
   output_array.at(index) = traffic_light_hazard; // 将结果输出到数组
 }
 
+void TrafficLightStage::CommitStep() {
+  for (unsigned long index = 0u; index < junction_decisions.size(); ++index) {
+    const JunctionDecision &decision = junction_decisions[index];
+    const ActorId ego_actor_id = vehicle_id_list.at(index);
+    switch (decision.action) {
+      case JunctionAction::Remove:
+        RemoveActor(ego_actor_id);
+        break;
+      case JunctionAction::Handle:
+        output_array.at(index) = HandleNonSignalisedJunction(ego_actor_id, decision.junction_id, current_timestamp);
+        break;
+      case JunctionAction::Enter:
+        AddActorToNonSignalisedJunction(ego_actor_id, decision.junction_id);
+        break;
+      case JunctionAction::None:
+        break;
+    }
+  }
+}
+
 // 将车辆添加到非信号交叉口的函数
 void TrafficLightStage::AddActorToNonSignalisedJunction(const ActorId ego_actor_id, const JunctionID junction_id) {
 
@@ -131,19 +161,18 @@ bool TrafficLightStage::HandleNonSignalisedJunction(const ActorId ego_actor_id,
   return traffic_light_hazard; // 返回交通信号危险标志
 }
 
-JunctionID TrafficLightStage::GetAffectedJunctionId(const ActorId ego_actor_id) {
+JunctionID TrafficLightStage::GetAffectedJunctionId(const ActorId ego_actor_id, const JunctionID current_junction_id) const {
     const Buffer &waypoint_buffer = buffer_map.at(ego_actor_id); // 获取车辆的路径缓冲区
-    const SimpleWaypointPtr look_ahead_point = GetTargetWaypoint(waypoint_buffer, JUNCTION_LOOK_AHEAD).first; // 获取前方目标路点
-    const auto front_point = waypoint_buffer.front(); // 获取路径中的第一个点
-
-    auto look_ahead_junction_id = look_ahead_point->GetJunctionId(); // 获取前方目标路点的交叉口ID
-    auto front_junction_id = front_point->GetJunctionId(); // 获取第一个点的交叉口ID
+    SimpleWaypoint *front_point = waypoint_buffer.front(); // 获取路径中的第一个点
 
-    // 检查车辆是否当前在一个非信号化的交叉口
-    JunctionID current_junction_id = -1; // 初始化当前交叉口ID为-1
-    if (vehicle_last_junction.find(ego_actor_id) != vehicle_last_junction.end()) { // 如果已记录该车辆的最后交叉口
-      current_junction_id = vehicle_last_junction.at(ego_actor_id); // 获取当前交叉口ID
+    // 前瞻点的交叉口ID在建图时已按路网缓存，只有后继分叉导致结果不确定时才沿缓冲区查找
+    JunctionID look_ahead_junction_id = -1;
+    if (front_point->HasLookAheadJunctionId()) {
+      look_ahead_junction_id = front_point->GetLookAheadJunctionId();
+    } else {
+      look_ahead_junction_id = GetTargetWaypoint(waypoint_buffer, JUNCTION_LOOK_AHEAD).first->GetJunctionId(); // 获取前方目标路点的交叉口ID
     }
+    auto front_junction_id = front_point->GetJunctionId(); // 获取第一个点的交叉口ID
 
     if (current_junction_id != -1) { // 如果正在处理一个交叉口
       if (current_junction_id == look_ahead_junction_id) { // 如果当前交叉口与前方交叉口相同
@@ -168,8 +197,9 @@ JunctionID TrafficLightStage::GetAffectedJunctionId(const ActorId ego_actor_id)
 }
 
 void TrafficLightStage::RemoveActor(const ActorId actor_id) {
-  if (vehicle_last_junction.find(actor_id) != vehicle_last_junction.end()) { // 检查车辆是否有记录的最后交叉口
-    auto junction_id = vehicle_last_junction.at(actor_id); // 获取该车辆的最后交叉口ID
+  const auto last_junction_it = vehicle_last_junction.find(actor_id);
+  if (last_junction_it != vehicle_last_junction.end()) { // 检查车辆是否有记录的最后交叉口
+    auto junction_id = last_junction_it->second; // 获取该车辆的最后交叉口ID
 
     auto& entering_vehicles = entering_vehicles_map.at(junction_id); // 获取进入该交叉口的车辆列表
     auto ent_index = std::find(entering_vehicles.begin(), entering_vehicles.end(), actor_id); // 查找该车辆在列表中的位置
@@ -177,11 +207,9 @@ void TrafficLightStage::RemoveActor(const ActorId actor_id) {
       entering_vehicles.erase(ent_index); // 从列表中移除该车辆
     }
 
-    if (vehicle_stop_time.find(actor_id) != vehicle_stop_time.end()) { // 检查车辆是否有停车时间记录
-      vehicle_stop_time.erase(actor_id); // 移除该车辆的停车时间记录
-    }
+    vehicle_stop_time.erase(actor_id); // 移除该车辆的停车时间记录（如有）
 
-    vehicle_last_junction.erase(actor_id); // 移除该车辆的最后交叉口记录
+    vehicle_last_junction.erase(last_junction_it); // 移除该车辆的最后交叉口记录
   }
 }
 
@@ -31,6 +31,19 @@ private:
   RandomGenerator &random_device;        // 随机数生成器的引用
   cc::Timestamp current_timestamp; // 当前时间戳
 
+  // Update 对无信号灯路口记录的操作，由 CommitStep 按索引顺序执行
+  enum class JunctionAction : uint8_t {
+    None,
+    Remove,   // 从登记的路口中移除车辆
+    Handle,   // 按到达顺序判断车辆能否进入路口
+    Enter     // 把车辆登记到路口
+  };
+  struct JunctionDecision {
+    JunctionAction action = JunctionAction::None;
+    JunctionID junction_id = -1;
+  };
+  std::vector<JunctionDecision> junction_decisions;
+
   // 这个函数控制所有车辆在无信号灯路口的交互。优先级按照到达顺序确定，并且没有两辆车会同时进入路口。只有当前一辆车离开后，下一辆车才能进入。此外，所有车辆在停车标志处总是会刹车一段时间。
   bool HandleNonSignalisedJunction(const ActorId ego_actor_id, const JunctionID junction_id,
                                    cc::Timestamp timestamp);
@@ -38,8 +51,8 @@ private:
   // 将车辆初始化为无信号灯路口映射
   void AddActorToNonSignalisedJunction(const ActorId ego_actor_id, const JunctionID junction_id);
 
-  // 获取车辆当前受影响的路口 ID
-  JunctionID GetAffectedJunctionId(const ActorId ego_actor_id);
+  // 获取车辆当前受影响的路口 ID，current_junction_id 为车辆当前登记的无信号灯路口
+  JunctionID GetAffectedJunctionId(const ActorId ego_actor_id, const JunctionID current_junction_id) const;
 
 public:
   TrafficLightStage(const std::vector<ActorId> &vehicle_id_list,
@@ -51,8 +64,16 @@ public:
                     RandomGenerator &random_device);
 // 构造函数
 
+  /// 在本步的 Update 之前调用，读取时间戳并为每辆车准备结果槽位。
+  void PrepareStep();
+
+  /// 只读取共享的路口状态，可以在多个线程上对不同的索引并行调用。
   void Update(const unsigned long index) override;     // 重写的更新函数
 
+  /// 在所有 Update 之后于同一线程中调用，按索引顺序修改无信号灯路口的队列，
+  /// 结果与逐辆车串行执行完全相同。
+  void CommitStep();
+
   void RemoveActor(const ActorId actor_id) override;      // 重写的移除参与者函数
 
   void Reset() override;   // 重写的重置函数
@@ -72,6 +72,93 @@ public:
     }
   }
 
+  /// \brief 设置并行执行各阶段逐车辆计算时使用的线程数。
+  /// \param number_of_threads 线程数，1表示串行执行
+  void SetStageThreads(const unsigned number_of_threads) {
+    TrafficManagerBase* tm_ptr = GetTM(_port);
+    if (tm_ptr != nullptr) {
+      tm_ptr->SetStageThreads(number_of_threads);
+    }
+  }
+
+  /// \brief 设置是否在计算下一步的同时发送本步的控制命令。
+  /// \param enabled 为true时RPC往返与下一步的计算重叠，命令最多延迟一步生效
+  void SetPipelinedControl(const bool enabled) {
+    TrafficManagerBase* tm_ptr = GetTM(_port);
+    if (tm_ptr != nullptr) {
+      tm_ptr->SetPipelinedControl(enabled);
+    }
+  }
+
+  /// \brief 设置按与英雄车辆的距离降低远处车辆计算量的距离分段。
+  /// \param update_radius 超出该半径的车辆每隔 update_interval 步才完整更新一次，0表示不降低
+  /// \param collision_radius 超出该半径的车辆不参与碰撞协商，0表示全部参与
+  /// \param update_interval 远处车辆的更新间隔步数
+  void SetLevelOfDetail(const float update_radius, const float collision_radius, const unsigned update_interval) {
+    TrafficManagerBase* tm_ptr = GetTM(_port);
+    if (tm_ptr != nullptr) {
+      tm_ptr->SetLevelOfDetail(update_radius, collision_radius, update_interval);
+    }
+  }
+
+  /// \brief 启用或停用各阶段的性能统计。
+  /// \param enabled 为true时开始统计，重新启用会清空之前的统计窗口
+  void SetProfiling(const bool enabled) {
+    TrafficManagerBase* tm_ptr = GetTM(_port);
+    if (tm_ptr != nullptr) {
+      tm_ptr->SetProfiling(enabled);
+    }
+  }
+
+  /// \brief 获取最近若干步内各阶段的耗时分布和离群车辆。
+  TrafficManagerProfile GetProfile() {
+    TrafficManagerBase* tm_ptr = GetTM(_port);
+    if (tm_ptr != nullptr) {
+      return tm_ptr->GetProfile();
+    }
+    return TrafficManagerProfile();
+  }
+
+  /// \brief 设置地图分区表，本交通管理器只控制位于自己区域内的车辆。
+  /// \param shard_map 所有参与分区的交通管理器共享的分区表，为空时关闭分区模式
+  void SetShardMap(const ShardMap &shard_map) {
+    TrafficManagerBase* tm_ptr = GetTM(_port);
+    if (tm_ptr != nullptr) {
+      tm_ptr->SetShardMap(shard_map);
+    }
+  }
+
+  /// \brief 在交通管理器所在的进程中加载驾驶策略插件。
+  /// \param path 导出 CARLA_TM_AGENT_PLUGIN_ENTRY 函数的共享库的路径
+  /// \return 插件注册的策略的名字，加载失败或连接的是远程交通管理器时为空
+  std::vector<std::string> LoadAgentPlugin(const std::string &path) {
+    TrafficManagerBase* tm_ptr = GetTM(_port);
+    if (tm_ptr != nullptr) {
+      return tm_ptr->LoadAgentPlugin(path);
+    }
+    return {};
+  }
+
+  /// \brief 指定车辆使用插件中的驾驶策略，策略在交通管理器的每一步中为该车计算控制命令。
+  /// \param policy 策略的名字，为空时恢复由交通管理器控制
+  /// \return 策略是否存在，不存在时车辆的策略不变
+  bool SetAgentPolicy(const ActorPtr &actor, const std::string &policy) {
+    TrafficManagerBase* tm_ptr = GetTM(_port);
+    if (tm_ptr != nullptr) {
+      return tm_ptr->SetAgentPolicy(actor, policy);
+    }
+    return false;
+  }
+
+  /// \brief 一次性应用一组逐车辆参数修改，整组修改在下一步开始时一起生效。
+  /// \param batch 参数修改命令列表
+  void ApplySettingsBatch(const VehicleSettingBatch &batch) {
+    TrafficManagerBase* tm_ptr = GetTM(_port);
+    if (tm_ptr != nullptr) {
+      tm_ptr->ApplySettingsBatch(batch);
+    }
+  }
+
   /// \brief 设置自定义路径。  
 /// \param actor 对应的Actor指针。  
 /// \param path 要设置的路径。  
@@ -9,6 +9,9 @@
 #include <memory>
 #include "carla/client/Actor.h"/// @brief 包含CARLA客户端中Actor类的定义
 #include "carla/trafficmanager/SimpleWaypoint.h"/// @brief 包含CARLA交通管理器中SimpleWaypoint类的定义
+#include "carla/trafficmanager/ShardRegion.h"/// @brief 包含CARLA交通管理器地图分区的定义
+#include "carla/trafficmanager/TrafficManagerProfile.h"/// @brief 包含CARLA交通管理器性能统计结果的定义
+#include "carla/trafficmanager/VehicleSettingCommand.h"/// @brief 包含CARLA交通管理器批量参数命令的定义
 /**
  * @namespace carla::traffic_manager
  * @brief CARLA交通管理器的命名空间。
@@ -294,6 +297,76 @@ public:
  */
   virtual void SetOSMMode(const bool mode_switch) = 0;
 
+  /**
+ * @brief 设置并行执行各阶段逐车辆计算时使用的线程数。
+ *
+ * @param number_of_threads 线程数，1表示串行执行。
+ */
+  virtual void SetStageThreads(const unsigned number_of_threads) = 0;
+
+  /**
+ * @brief 设置是否在计算下一步的同时发送本步的控制命令。
+ *
+ * @param enabled 为true时RPC往返与下一步的计算重叠，命令最多延迟一步生效。
+ */
+  virtual void SetPipelinedControl(const bool enabled) = 0;
+
+  /**
+ * @brief 设置按与英雄车辆的距离降低远处车辆计算量的距离分段。
+ *
+ * @param update_radius 超出该半径的车辆每隔 update_interval 步才完整更新一次，0表示不降低。
+ * @param collision_radius 超出该半径的车辆不参与碰撞协商，0表示全部参与。
+ * @param update_interval 远处车辆的更新间隔步数。
+ */
+  virtual void SetLevelOfDetail(const float update_radius, const float collision_radius, const unsigned update_interval) = 0;
+
+  /**
+ * @brief 启用或停用各阶段的性能统计。
+ *
+ * @param enabled 为true时开始统计，重新启用会清空之前的统计窗口。
+ */
+  virtual void SetProfiling(const bool enabled) = 0;
+
+  /**
+ * @brief 获取最近若干步内各阶段的耗时分布和离群车辆。
+ *
+ * @return 交通管理器的性能统计结果。
+ */
+  virtual TrafficManagerProfile GetProfile() const = 0;
+
+  /**
+ * @brief 设置地图分区表，本交通管理器只控制位于自己区域内的车辆。
+ *
+ * @param shard_map 所有参与分区的交通管理器共享的分区表，为空时关闭分区模式。
+ */
+  virtual void SetShardMap(const ShardMap &shard_map) = 0;
+
+  /**
+ * @brief 在交通管理器所在的进程中加载驾驶策略插件，连接远程交通管理器时不支持。
+ *
+ * @param path 导出 CARLA_TM_AGENT_PLUGIN_ENTRY 函数的共享库的路径。
+ * @return 插件注册的策略的名字，加载失败时为空。
+ */
+  virtual std::vector<std::string> LoadAgentPlugin(const std::string &path) = 0;
+
+  /**
+ * @brief 指定车辆使用插件中的驾驶策略。
+ *
+ * @param actor 车辆指针。
+ * @param policy 策略的名字，为空时恢复由交通管理器控制。
+ * @return 策略是否存在，不存在时车辆的策略不变。
+ */
+  virtual bool SetAgentPolicy(const ActorPtr &actor, const std::string &policy) = 0;
+
+  /**
+ * @brief 一次性应用一组逐车辆参数修改。
+ *
+ * 整组修改在下一步开始时一起生效，远程交通管理器只需一次RPC调用。
+ *
+ * @param batch 参数修改命令列表。
+ */
+  virtual void ApplySettingsBatch(const VehicleSettingBatch &batch) = 0;
+
   /**
    * @brief 设置自定义导入路径。
    *
@@ -8,6 +8,8 @@
 
 #include "carla/trafficmanager/Constants.h"// 引入常量定义
 #include "carla/rpc/Actor.h"// 引入Actor类的定义
+#include "carla/trafficmanager/ShardRegion.h"// 引入地图分区的定义
+#include "carla/trafficmanager/TrafficManagerProfile.h"// 引入性能统计结果的定义
 
 #include <rpc/client.h>// 引入RPC客户端库
 
@@ -290,6 +292,54 @@ public:
     _client->call("set_osm_mode", mode_switch);/// 调用_client的call方法设置Open Street Map模式
   }
 
+  /// 设置并行执行各阶段时使用的线程数
+  void SetStageThreads(const unsigned number_of_threads) {
+    DEBUG_ASSERT(_client != nullptr);/// 断言_client指针不为空
+    _client->call("set_stage_threads", number_of_threads);/// 调用_client的call方法设置阶段线程数
+  }
+
+  /// 设置是否流水线式发送控制命令
+  void SetPipelinedControl(const bool enabled) {
+    DEBUG_ASSERT(_client != nullptr);/// 断言_client指针不为空
+    _client->call("set_pipelined_control", enabled);/// 调用_client的call方法设置是否流水线式发送控制命令
+  }
+
+  /// 设置细节层次的距离分段
+  void SetLevelOfDetail(const float update_radius, const float collision_radius, const unsigned update_interval) {
+    DEBUG_ASSERT(_client != nullptr);/// 断言_client指针不为空
+    _client->call("set_level_of_detail", update_radius, collision_radius, update_interval);/// 调用_client的call方法设置细节层次
+  }
+
+  /// 启用或停用各阶段的性能统计
+  void SetProfiling(const bool enabled) {
+    DEBUG_ASSERT(_client != nullptr);/// 断言_client指针不为空
+    _client->call("set_profiling", enabled);/// 调用_client的call方法启用或停用性能统计
+  }
+
+  /// 获取性能统计结果
+  TrafficManagerProfile GetProfile() const {
+    DEBUG_ASSERT(_client != nullptr);/// 断言_client指针不为空
+    return _client->call("get_profile").as<TrafficManagerProfile>();/// 调用_client的call方法获取性能统计结果
+  }
+
+  /// 设置地图分区表
+  void SetShardMap(const ShardMap &shard_map) {
+    DEBUG_ASSERT(_client != nullptr);/// 断言_client指针不为空
+    _client->call("set_shard_map", shard_map);/// 调用_client的call方法设置地图分区表
+  }
+
+  /// 指定车辆的驾驶策略，返回策略是否存在
+  bool SetAgentPolicy(const carla::rpc::Actor &_actor, const std::string &policy) {
+    DEBUG_ASSERT(_client != nullptr);/// 断言_client指针不为空
+    return _client->call("set_agent_policy", std::move(_actor), policy).as<bool>();/// 调用_client的call方法指定车辆的驾驶策略
+  }
+
+  /// 批量设置逐车辆参数
+  void ApplySettingsBatch(const VehicleSettingBatch &batch) {
+    DEBUG_ASSERT(_client != nullptr);/// 断言_client指针不为空
+    _client->call("apply_settings_batch", batch);/// 调用_client的call方法在一条消息中发送整组参数修改
+  }
+
   /// 设置自定义路径
   void SetCustomPath(const carla::rpc::Actor &actor, const Path path, const bool empty_buffer) {
     DEBUG_ASSERT(_client != nullptr);/// 断言_client指针不为空
@@ -23,7 +23,7 @@ TrafficManagerLocal::TrafficManagerLocal(
   std::vector<float> longitudinal_PID_parameters,// 在高速公路场景下纵向PID控制的参数列表
   std::vector<float> longitudinal_highway_PID_parameters,//在普通道路场景下横向PID控制的参数列表
   std::vector<float> lateral_PID_parameters,//在普通道路场景下横向PID控制的参数列表
-  std::vector<float> lateral_highway_PID_parameters,。//在高速公路场景下横向PID控制的参数列表
+  std::vector<float> lateral_highway_PID_parameters,//在高速公路场景下横向PID控制的参数列表
   float perc_difference_from_limit,//控制车辆行驶速度相对速度限制
   cc::detail::EpisodeProxy &episode_proxy,//用于与模拟器中的某个情节进行交互，获取相关信息
   uint16_t &RPCportTM)//用于网络通信等相关操作
@@ -84,6 +84,15 @@ TrafficManagerLocal::TrafficManagerLocal(
                                           parameters,
                                           world,
                                           control_frame)),
+//运行插件提供的驾驶策略
+    agent_plugin_stage(vehicle_id_list,
+                       simulation_state,
+                       buffer_map,
+                       localization_frame,
+                       collision_frame,
+                       tl_frame,
+                       control_frame),
+    lod_scheduler(vehicle_id_list, simulation_state, parameters),
 //处理车道选择等更复杂的交通管理逻辑
     alsm(ALSM(registered_vehicles,
               buffer_map,
@@ -97,7 +106,9 @@ TrafficManagerLocal::TrafficManagerLocal(
               collision_stage,
               traffic_light_stage,
               motion_plan_stage,
-              vehicle_light_stage)),
+              vehicle_light_stage,
+              agent_plugin_stage)),
+    shard_handoff(RPCportTM),
 //用于网络通信
     server(TrafficManagerServer(RPCportTM, static_cast<carla::traffic_manager::TrafficManagerBase *>(this))) {
 //统一调整车辆相对速度限制的行驶速度
@@ -124,7 +135,11 @@ void TrafficManagerLocal::SetupLocalMap() {
   if (!files.empty()) {
     auto content = episode_proxy.Lock()->GetCacheFile(files[0], true);
     if (content.size() != 0) {
-      local_map->Load(content);
+      if (!local_map->Load(content)) {
+        log_warning("Invalid InMemoryMap cache. Setting up local map. This may take a while...");
+        local_map = std::make_shared<InMemoryMap>(world_map);
+        local_map->SetUp();
+      }
     } else {
       log_warning("No InMemoryMap cache found. Setting up local map. This may take a while...");
       local_map->SetUp();
@@ -153,6 +168,7 @@ void TrafficManagerLocal::Run() {
 
     bool synchronous_mode = parameters.GetSynchronousMode();
     bool hybrid_physics_mode = parameters.GetHybridPhysicsMode();
+    stage_executor.SetNumberOfThreads(parameters.GetStageThreads());
     parameters.SetMaxBoundaries(20.0f, episode_proxy.Lock()->GetEpisodeSettings().actor_active_distance);
 
        if (synchronous_mode) {   // 在同步模式下，等待外部触发以启动循环
@@ -182,8 +198,17 @@ void TrafficManagerLocal::Run() {
     }
 
     std::unique_lock<std::mutex> registration_lock(registration_mutex);
+    // 发布上一步以来的参数修改，本步内各阶段读取到的参数保持不变
+    parameters.PublishSnapshot();
+    // 各车辆的随机数流按步派生，须在各阶段运行之前推进
+    random_device.AdvanceStep();
+    const bool profiling = stage_profiler.BeginStep();
+    std::array<std::size_t, 4u> frame_capacities;
+    if (profiling) {
+      frame_capacities = GetFrameCapacities();
+    }
     // 更新模拟状态、角色生命周期并执行必要的清理
-    alsm.Update();
+    stage_profiler.Measure(ProfiledStage::ALSM, [this]() { alsm.Update(); });
 
     // 基于已注册车辆数量变化的阶段间通信帧重新分配
     int current_registered_vehicles_state = registered_vehicles.GetState();
@@ -200,6 +225,7 @@ void TrafficManagerLocal::Run() {
         collision_frame.reserve(new_frame_capacity);
         tl_frame.reserve(new_frame_capacity);
         control_frame.reserve(new_frame_capacity);
+        current_reserved_capacity = new_frame_capacity;
       }
 
       registered_vehicles_state = registered_vehicles.GetState();
@@ -219,33 +245,134 @@ void TrafficManagerLocal::Run() {
     // 调整大小以容纳至少所有 ApplyVehicleControl 命令
     // 这将在运动规划阶段插入
     control_frame.resize(number_of_vehicles);
+    stage_profiler.SetNumberOfVehicles(number_of_vehicles);
+
+    // 按与英雄车辆的距离决定各车辆本步运行哪些阶段
+    alsm.GetHeroLocations(hero_locations);
+    lod_scheduler.Update(hero_locations);
 
-    // 运行核心操作阶段
+    // 运行核心操作阶段，本步未更新的车辆沿用上一次的控制命令。
+    // 定位阶段的变道判断读取前面的车辆在本步刚更新的缓冲区和路点占用，
+    // 结果依赖处理顺序，因此按索引顺序串行执行
     for (unsigned long index = 0u; index < vehicle_id_list.size(); ++index) {
-      localization_stage.Update(index);
+      if (lod_scheduler.IsUpdated(index)) {
+        stage_profiler.MeasureVehicle(index, ProfiledStage::Localization, [&]() { localization_stage.Update(index); });
+      }
+    }
+    stage_profiler.Measure(ProfiledStage::Localization, [this]() { localization_stage.ClearStepCache(); });
+    // 碰撞候选的筛选只读取共享状态，可以在多个线程上并行预先计算；
+    // 碰撞协商会修改共享的碰撞锁，因此仍按索引顺序串行执行，
+    // 以保证输出与串行执行时完全一致
+    if (stage_executor.GetNumberOfThreads() > 1u) {
+      // 并行部分只统计整体耗时，逐车辆计时需要在各线程间同步，得不偿失
+      stage_profiler.Measure(ProfiledStage::CollisionPrepare, [this]() {
+        collision_stage.PrepareCycle();
+        stage_executor.ParallelFor(vehicle_id_list.size(), [this](const unsigned long index) {
+          if (lod_scheduler.NeedsCollision(index)) {
+            collision_stage.PrepareCandidates(index);
+          }
+        });
+      });
     }
     for (unsigned long index = 0u; index < vehicle_id_list.size(); ++index) {
-      collision_stage.Update(index);
+      if (lod_scheduler.NeedsCollision(index)) {
+        stage_profiler.MeasureVehicle(index, ProfiledStage::Collision, [&]() { collision_stage.Update(index); });
+      }
     }
-    collision_stage.ClearCycleCache();
-    vehicle_light_stage.UpdateWorldInfo();
+    stage_profiler.Measure(ProfiledStage::Collision, [this]() { collision_stage.ClearCycleCache(); });
+    stage_profiler.Measure(ProfiledStage::VehicleLight, [this]() { vehicle_light_stage.UpdateWorldInfo(); });
+    // 交通信号灯和运动规划阶段的 Update 只读取共享状态并写入本车的结果，
+    // 对共享状态的修改（无信号灯路口的队列、PID 状态表、休眠车辆的重生）
+    // 由 CommitStep 按索引顺序执行，因此结果与线程数无关
+    traffic_light_stage.PrepareStep();
+    motion_plan_stage.PrepareStep();
+    if (stage_executor.GetNumberOfThreads() > 1u) {
+      stage_profiler.Measure(ProfiledStage::TrafficLight, [this]() {
+        stage_executor.ParallelFor(vehicle_id_list.size(), [this](const unsigned long index) {
+          if (lod_scheduler.IsUpdated(index)) {
+            traffic_light_stage.Update(index);
+          }
+        });
+        traffic_light_stage.CommitStep();
+      });
+      stage_profiler.Measure(ProfiledStage::MotionPlan, [this]() {
+        stage_executor.ParallelFor(vehicle_id_list.size(), [this](const unsigned long index) {
+          if (lod_scheduler.IsUpdated(index)) {
+            motion_plan_stage.Update(index);
+          } else {
+            lod_scheduler.HoldControl(index, control_frame);
+          }
+        });
+        motion_plan_stage.CommitStep();
+      });
+    } else {
+      for (unsigned long index = 0u; index < vehicle_id_list.size(); ++index) {
+        if (lod_scheduler.IsUpdated(index)) {
+          stage_profiler.MeasureVehicle(index, ProfiledStage::TrafficLight, [&]() { traffic_light_stage.Update(index); });
+        }
+      }
+      stage_profiler.Measure(ProfiledStage::TrafficLight, [this]() { traffic_light_stage.CommitStep(); });
+      for (unsigned long index = 0u; index < vehicle_id_list.size(); ++index) {
+        if (lod_scheduler.IsUpdated(index)) {
+          stage_profiler.MeasureVehicle(index, ProfiledStage::MotionPlan, [&]() { motion_plan_stage.Update(index); });
+        } else {
+          lod_scheduler.HoldControl(index, control_frame);
+        }
+      }
+      stage_profiler.Measure(ProfiledStage::MotionPlan, [this]() { motion_plan_stage.CommitStep(); });
+    }
+    // 控制器在所有车辆的目标计算完成后一次性批量执行。
+    // 车辆灯光阶段依赖控制命令中的刹车值，因此放在批量控制之后
+    // 插件的驾驶策略在控制器之后修改本步更新的车辆的命令，
+    // 细节层次调度器保持的是策略修改后的命令
+    agent_plugin_stage.PrepareStep();
+    stage_profiler.Measure(ProfiledStage::MotionPlan, [this]() {
+      motion_plan_stage.RunControllers();
+      if (agent_plugin_stage.HasPolicies()) {
+        for (unsigned long index = 0u; index < vehicle_id_list.size(); ++index) {
+          if (lod_scheduler.IsUpdated(index)) {
+            agent_plugin_stage.Update(index);
+          }
+        }
+      }
+      lod_scheduler.RecordControl(control_frame);
+    });
     for (unsigned long index = 0u; index < vehicle_id_list.size(); ++index) {
-      traffic_light_stage.Update(index);
-      motion_plan_stage.Update(index);
-      vehicle_light_stage.Update(index);
+      stage_profiler.MeasureVehicle(index, ProfiledStage::VehicleLight, [&]() { vehicle_light_stage.Update(index); });
     }
 
     registration_lock.unlock();
 
     // 将当前周期的批处理命令发送给模拟器
+    // 流水线模式下只等待上一批次发送完毕，本批次在下一步的计算期间发送
+    stage_profiler.Measure(ProfiledStage::ApplyBatch, [&]() {
+      if (synchronous_mode || control_frame.size() > 0) {
+        if (parameters.GetPipelinedControl()) {
+          batch_sender.Submit(control_frame);
+        } else {
+          batch_sender.WaitIdle();
+          episode_proxy.Lock()->ApplyBatchSync(control_frame, false);
+        }
+      }
+    });
+
+    if (profiling) {
+      const std::array<std::size_t, 4u> new_frame_capacities = GetFrameCapacities();
+      uint64_t frame_allocations = 0u;
+      for (std::size_t i = 0u; i < frame_capacities.size(); ++i) {
+        frame_allocations += new_frame_capacities[i] != frame_capacities[i] ? 1u : 0u;
+      }
+      stage_profiler.EndStep(vehicle_id_list, frame_allocations);
+    }
+
     if (synchronous_mode) {
-      episode_proxy.Lock()->ApplyBatchSync(control_frame, false);
       step_end.store(true);
       step_end_trigger.notify_one();
-    } else {
-      if (control_frame.size() > 0){
-        episode_proxy.Lock()->ApplyBatchSync(control_frame, false);
-      }
+    }
+
+    // 移交需要与其他交通管理器通信，放在本步结束之后，不延长同步模式下的步长
+    if (shard_handoff.IsEnabled()) {
+      HandOffVehicles();
     }
   }
 }
@@ -275,6 +402,12 @@ void TrafficManagerLocal::Stop() {
     }
     worker_thread.release();// 释放工作线程资源
   }
+  // 等待流水线中最后一个批次发送完毕，发送失败时只记录警告
+  try {
+    batch_sender.WaitIdle();
+  } catch (const std::exception &e) {
+    log_warning("traffic manager failed to apply the last control batch:", e.what());
+  }
   // 清除所有车辆ID和注册车辆的状态
   vehicle_id_list.clear(); // 清空车辆ID列表
   registered_vehicles.Clear(); // 清除所有已注册的车辆
@@ -289,6 +422,8 @@ void TrafficManagerLocal::Stop() {
   collision_stage.Reset(); // 重置碰撞检测阶段
   traffic_light_stage.Reset(); // 重置交通灯阶段
   motion_plan_stage.Reset(); // 重置运动规划阶段
+  agent_plugin_stage.Reset(); // 重置驾驶策略中按车辆保存的状态
+  lod_scheduler.Reset(); // 重置细节层次调度器
   // 清空缓存数据
   buffer_map.clear();
   localization_frame.clear();
@@ -300,7 +435,6 @@ void TrafficManagerLocal::Stop() {
   step_begin.store(false);// 重置步开始标志
   step_end.store(false); // 重置步结束标志
 }
-}
 
 void TrafficManagerLocal::Release() {
 
@@ -342,7 +476,8 @@ void TrafficManagerLocal::SetLaneOffset(const ActorPtr &actor, const float offse
   parameters.SetLaneOffset(actor, offset);
 }
 
-void TrafficManagerLocal::SetGlobalLaneOffset(const float offset) // 设置全局车道偏移{  parameters.SetGlobalLaneOffset(offset);
+void TrafficManagerLocal::SetGlobalLaneOffset(const float offset) { // 设置全局车道偏移
+  parameters.SetGlobalLaneOffset(offset);
 }
 
 void TrafficManagerLocal::SetDesiredSpeed(const ActorPtr &actor, const float value) {// 设置车辆期望的行驶速度
@@ -413,6 +548,90 @@ void TrafficManagerLocal::SetHybridPhysicsRadius(const float radius) {
 void TrafficManagerLocal::SetOSMMode(const bool mode_switch) {
   parameters.SetOSMMode(mode_switch);
 }
+// 设置并行执行各阶段时使用的线程数
+void TrafficManagerLocal::SetStageThreads(const unsigned number_of_threads) {
+  parameters.SetStageThreads(number_of_threads);
+}
+// 设置是否流水线式发送控制命令
+void TrafficManagerLocal::SetPipelinedControl(const bool enabled) {
+  parameters.SetPipelinedControl(enabled);
+}
+// 设置细节层次的距离分段
+void TrafficManagerLocal::SetLevelOfDetail(const float update_radius,
+                                           const float collision_radius,
+                                           const unsigned update_interval) {
+  parameters.SetLevelOfDetail(update_radius, collision_radius, update_interval);
+}
+
+void TrafficManagerLocal::SetProfiling(const bool enabled) {
+  stage_profiler.SetEnabled(enabled);
+}
+
+TrafficManagerProfile TrafficManagerLocal::GetProfile() const {
+  return stage_profiler.GetProfile();
+}
+
+void TrafficManagerLocal::SetShardMap(const ShardMap &shard_map) {
+  shard_handoff.SetShardMap(shard_map);
+}
+// 加载驾驶策略插件
+std::vector<std::string> TrafficManagerLocal::LoadAgentPlugin(const std::string &path) {
+  return agent_plugin_stage.LoadPlugin(path);
+}
+// 指定车辆的驾驶策略
+bool TrafficManagerLocal::SetAgentPolicy(const ActorPtr &actor, const std::string &policy) {
+  return agent_plugin_stage.SetPolicy(actor->GetId(), policy);
+}
+// 批量设置逐车辆参数
+void TrafficManagerLocal::ApplySettingsBatch(const VehicleSettingBatch &batch) {
+  parameters.ApplySettingsBatch(batch);
+}
+
+void TrafficManagerLocal::HandOffVehicles() {
+  std::vector<ShardHandoff::Departure> departures;
+  std::vector<std::vector<ActorPtr>> departing_vehicles;
+  {
+    std::lock_guard<std::mutex> registration_lock(registration_mutex);
+    departures = shard_handoff.SelectDepartures(vehicle_id_list, simulation_state);
+    if (departures.empty()) {
+      return;
+    }
+    std::unordered_map<ActorId, ActorPtr> registered;
+    for (auto &actor : registered_vehicles.GetList()) {
+      registered.emplace(actor->GetId(), actor);
+    }
+    // 先在本地注销，保证同一辆车在任何时刻最多只被一个交通管理器控制
+    for (auto &departure : departures) {
+      std::vector<ActorPtr> vehicles;
+      for (const ActorId actor_id : departure.actor_ids) {
+        auto it = registered.find(actor_id);
+        if (it != registered.end()) {
+          vehicles.push_back(it->second);
+          alsm.RemoveActor(actor_id, true);
+        }
+      }
+      departing_vehicles.push_back(std::move(vehicles));
+    }
+  }
+
+  for (std::size_t i = 0u; i < departures.size(); ++i) {
+    if (departing_vehicles[i].empty()) {
+      continue;
+    }
+    std::vector<carla::rpc::Actor> actors;
+    for (auto &vehicle : departing_vehicles[i]) {
+      actors.emplace_back(vehicle->Serialize());
+    }
+    if (!shard_handoff.Send(departures[i].destination, actors)) {
+      RegisterVehicles(departing_vehicles[i]);
+    }
+  }
+}
+
+std::array<std::size_t, 4u> TrafficManagerLocal::GetFrameCapacities() const {
+  return {{localization_frame.capacity(), collision_frame.capacity(),
+           tl_frame.capacity(), control_frame.capacity()}};
+}
 // 设置自定义路径给车辆
 void TrafficManagerLocal::SetCustomPath(const ActorPtr &actor, const Path path, const bool empty_buffer) {
   parameters.SetCustomPath(actor, path, empty_buffer);
@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include <array>///@brief 包含C++定长数组库，用于记录各通信帧的容量
 #include <atomic>///@brief 包含C++原子操作库，用于线程安全的计数器和标志位
 #include <chrono>///@brief 包含C++时间库，用于时间测量和延迟
 #include <mutex>///@brief 包含C++互斥锁库，用于线程同步
@@ -18,11 +19,17 @@
 #include "carla/Memory.h"///@brief 包含CARLA的内存管理类，用于管理内存分配和释放
 #include "carla/rpc/Command.h"///@brief 包含CARLA的RPC命令处理类，用于远程过程调用
 
+#include "carla/trafficmanager/AgentPluginStage.h"///@brief 包含交通管理器的驾驶策略插件阶段类，用于运行共享库中的自定义驾驶策略
 #include "carla/trafficmanager/AtomicActorSet.h"///@brief 包含交通管理器中的原子参与者集合类，用于管理仿真中的参与者（如车辆、行人）
 #include "carla/trafficmanager/InMemoryMap.h"///@brief 包含交通管理器的内存地图类，用于在内存中存储地图数据
+#include "carla/trafficmanager/LODScheduler.h"///@brief 包含交通管理器的细节层次调度类，用于降低远处车辆的计算频率
 #include "carla/trafficmanager/Parameters.h"///@brief 包含交通管理器的参数配置类，用于配置交通管理器的各种参数
 #include "carla/trafficmanager/RandomGenerator.h"///@brief 包含交通管理器的随机数生成器类，用于生成随机数或随机序列
+#include "carla/trafficmanager/ShardHandoff.h"///@brief 包含交通管理器的分区移交类，用于按地图区域在多个交通管理器之间移交车辆
 #include "carla/trafficmanager/SimulationState.h"///@brief 包含交通管理器的仿真状态类，用于管理仿真的全局状态
+#include "carla/trafficmanager/BatchSender.h"///@brief 包含交通管理器的控制命令发送器类，用于在独立线程上发送命令批次
+#include "carla/trafficmanager/StageExecutor.h"///@brief 包含交通管理器的阶段执行器类，用于将逐车辆计算分摊到多个线程
+#include "carla/trafficmanager/StageProfiler.h"///@brief 包含交通管理器的阶段性能统计类，用于统计各阶段的耗时分布
 #include "carla/trafficmanager/TrackTraffic.h"///@brief 包含交通管理器的流量跟踪类，用于跟踪和管理仿真中的交通流量
 #include "carla/trafficmanager/TrafficManagerBase.h"///@brief 包含交通管理器的基类，定义了交通管理器的基本接口和功能
 #include "carla/trafficmanager/TrafficManagerServer.h"///@brief 包含交通管理器的服务器类，用于管理交通管理器的网络通信
@@ -145,6 +152,23 @@ private:
   TrafficLightStage traffic_light_stage;
   MotionPlanStage motion_plan_stage;
   VehicleLightStage vehicle_light_stage;
+  /// @brief 运行插件提供的驾驶策略的阶段
+  AgentPluginStage agent_plugin_stage;
+  /// @brief 按与英雄车辆的距离决定各车辆本步运行哪些阶段的调度器
+  LODScheduler lod_scheduler;
+  /// @brief 本步英雄车辆的位置，在各步之间复用以避免重复分配
+  std::vector<cg::Location> hero_locations;
+  /// @brief 将各阶段中可并行的逐车辆计算分摊到多个线程的执行器
+  /// 线程数由参数中的阶段线程数决定，为1时所有计算都在工作线程上串行执行
+  StageExecutor stage_executor;
+  /// @brief 统计各阶段耗时分布和逐车辆离群耗时的性能分析器
+  StageProfiler stage_profiler;
+  /// @brief 在独立线程上发送控制命令批次，流水线模式下与下一步的计算重叠
+  BatchSender batch_sender{[this](BatchSender::Commands &commands) {
+    episode_proxy.Lock()->ApplyBatchSync(commands, false);
+  }};
+  /// @brief 按地图分区与其他交通管理器之间移交车辆，须在server之前构造
+  ShardHandoff shard_handoff;
   /// @brief 自动驾驶局部路径规划模块（ALSM）  
   /// ALSM可能是一个用于生成局部路径规划算法的模块或对象
   ALSM alsm;
@@ -222,6 +246,12 @@ public:
   /// 此方法将创建一个新线程（如果尚未创建），并在该线程中顺序运行交通管理器的逻辑
   void Run();
 
+  /// @brief 获取各阶段间通信帧当前的容量，用于统计每步的内存重新分配次数
+  std::array<std::size_t, 4u> GetFrameCapacities() const;
+
+  /// @brief 将已驶入其他区域的车辆移交给对应的交通管理器，移交失败的车辆重新注册到本交通管理器
+  void HandOffVehicles();
+
   /// @brief 停止交通管理器  
   /// 此方法用于停止TrafficManagerLocal的运行，并可能进行必要的清理工作
   void Stop();
@@ -382,6 +412,47 @@ public:
 /// @param mode_switch 是否启用Open Street Map模式。如果为true，则启用；如果为false，则禁用.
   void SetOSMMode(const bool mode_switch);
 
+  /// @brief 设置并行执行各阶段逐车辆计算时使用的线程数。
+///
+/// @param number_of_threads 线程数，1表示串行执行
+  void SetStageThreads(const unsigned number_of_threads);
+
+  /// @brief 设置是否在计算下一步的同时发送本步的控制命令。
+///
+/// @param enabled 为true时RPC往返与下一步的计算重叠，命令最多延迟一步生效
+  void SetPipelinedControl(const bool enabled);
+
+  /// @brief 设置按与英雄车辆的距离降低远处车辆计算量的距离分段。
+///
+/// @param update_radius 超出该半径的车辆每隔 update_interval 步才完整更新一次，0表示不降低
+/// @param collision_radius 超出该半径的车辆不参与碰撞协商，0表示全部参与
+/// @param update_interval 远处车辆的更新间隔步数
+  void SetLevelOfDetail(const float update_radius, const float collision_radius, const unsigned update_interval);
+
+  /// @brief 启用或停用各阶段的性能统计。
+///
+/// @param enabled 为true时开始统计，重新启用会清空之前的统计窗口
+  void SetProfiling(const bool enabled);
+
+  /// @brief 获取最近若干步内各阶段的耗时分布和离群车辆。
+  TrafficManagerProfile GetProfile() const;
+
+  /// @brief 设置地图分区表，本交通管理器只控制位于自己区域内的车辆。
+///
+/// @param shard_map 所有参与分区的交通管理器共享的分区表，为空时关闭分区模式
+  void SetShardMap(const ShardMap &shard_map);
+
+  /// @brief 加载驾驶策略插件，返回插件注册的策略的名字。
+  std::vector<std::string> LoadAgentPlugin(const std::string &path);
+
+  /// @brief 指定车辆使用插件中的驾驶策略，为空时恢复由交通管理器控制；返回策略是否存在。
+  bool SetAgentPolicy(const ActorPtr &actor, const std::string &policy);
+
+  /// @brief 一次性应用一组逐车辆参数修改，整组修改在下一步开始时一起生效。
+///
+/// @param batch 参数修改命令列表
+  void ApplySettingsBatch(const VehicleSettingBatch &batch);
+
   /// @brief 设置自定义路径。  
 ///   
 /// @param actor 要设置路径的车辆指针。  
@@ -0,0 +1,62 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "carla/MsgPack.h"
+#include "carla/rpc/ActorId.h"
+
+namespace carla {
+namespace traffic_manager {
+
+  /// 单个阶段在统计窗口内的耗时分布，单位为毫秒。
+  struct StageLatency {
+    std::string stage;
+    /// 窗口内的样本（步）数。
+    uint64_t samples = 0u;
+    float mean = 0.0f;
+    float p50 = 0.0f;
+    float p95 = 0.0f;
+    float p99 = 0.0f;
+    float max = 0.0f;
+
+    MSGPACK_DEFINE_ARRAY(stage, samples, mean, p50, p95, p99, max);
+  };
+
+  /// 某一步中耗时明显高于同步其他车辆的车辆记录。
+  struct VehicleCost {
+    ActorId actor_id = 0u;
+    /// 记录时的步序号。
+    uint64_t step = 0u;
+    /// 该车辆在这一步所有阶段中的总耗时，单位为毫秒。
+    float cost = 0.0f;
+    /// 该车辆耗时最多的阶段。
+    std::string dominant_stage;
+
+    MSGPACK_DEFINE_ARRAY(actor_id, step, cost, dominant_stage);
+  };
+
+  /// 交通管理器在最近若干步内的性能统计。
+  struct TrafficManagerProfile {
+    bool enabled = false;
+    /// 统计窗口覆盖的步数。
+    uint64_t window_steps = 0u;
+    /// 按执行顺序排列的各阶段耗时，最后一项"step"为整步耗时。
+    std::vector<StageLatency> stages;
+    /// 按耗时从高到低排列的车辆离群记录。
+    std::vector<VehicleCost> vehicle_outliers;
+    /// 窗口内阶段间通信帧因容量不足而重新分配内存的次数。
+    uint64_t frame_allocations = 0u;
+
+    MSGPACK_DEFINE_ARRAY(enabled, window_steps, stages, vehicle_outliers, frame_allocations);
+  };
+
+} // namespace traffic_manager
+} // namespace carla
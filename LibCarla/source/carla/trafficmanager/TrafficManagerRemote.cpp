@@ -7,6 +7,7 @@
 #include <thread>
 // 引入线程库
 
+#include "carla/Logging.h"
 #include "carla/client/detail/Simulator.h"
 // 引入 Carla 客户端的模拟器实现细节头文件
 
@@ -287,6 +288,55 @@ void TrafficManagerRemote::SetOSMMode(const bool mode_switch) {
 // 通过客户端设置 OSM 模式开关
 }
 
+void TrafficManagerRemote::SetStageThreads(const unsigned number_of_threads) {
+  client.SetStageThreads(number_of_threads);
+// 通过客户端设置阶段线程数
+}
+
+void TrafficManagerRemote::SetPipelinedControl(const bool enabled) {
+  client.SetPipelinedControl(enabled);
+// 通过客户端设置是否流水线式发送控制命令
+}
+
+void TrafficManagerRemote::SetLevelOfDetail(const float update_radius,
+                                            const float collision_radius,
+                                            const unsigned update_interval) {
+  client.SetLevelOfDetail(update_radius, collision_radius, update_interval);
+// 通过客户端设置细节层次的距离分段
+}
+
+void TrafficManagerRemote::SetProfiling(const bool enabled) {
+  client.SetProfiling(enabled);
+// 通过客户端启用或停用性能统计
+}
+
+TrafficManagerProfile TrafficManagerRemote::GetProfile() const {
+  return client.GetProfile();
+// 通过客户端获取性能统计结果
+}
+
+void TrafficManagerRemote::SetShardMap(const ShardMap &shard_map) {
+  client.SetShardMap(shard_map);
+// 通过客户端设置地图分区表
+}
+
+std::vector<std::string> TrafficManagerRemote::LoadAgentPlugin(const std::string &path) {
+  // 加载插件会在远程进程中执行任意代码，不通过RPC提供
+  log_warning("traffic manager: agent plugin", path, "must be loaded in the process that runs the traffic manager");
+  return {};
+}
+
+bool TrafficManagerRemote::SetAgentPolicy(const ActorPtr &_actor, const std::string &policy) {
+  carla::rpc::Actor actor(_actor->Serialize());
+  return client.SetAgentPolicy(actor, policy);
+// 通过客户端指定车辆的驾驶策略
+}
+
+void TrafficManagerRemote::ApplySettingsBatch(const VehicleSettingBatch &batch) {
+  client.ApplySettingsBatch(batch);
+// 通过客户端一次性发送整组参数修改
+}
+
 void TrafficManagerRemote::SetCustomPath(const ActorPtr &_actor, const Path path, const bool empty_buffer) {
   carla::rpc::Actor actor(_actor->Serialize());
 // 将输入的车辆转换为 rpc 格式的车辆
@@ -293,6 +293,72 @@ public:
  */
   void SetOSMMode(const bool mode_switch);
 
+  /**
+ * @brief 设置并行执行各阶段逐车辆计算时使用的线程数。
+ *
+ * @param number_of_threads 线程数，1表示串行执行。
+ */
+  void SetStageThreads(const unsigned number_of_threads);
+
+  /**
+ * @brief 设置是否在计算下一步的同时发送本步的控制命令。
+ *
+ * @param enabled 为true时命令最多延迟一步生效。
+ */
+  void SetPipelinedControl(const bool enabled);
+
+  /**
+ * @brief 设置按与英雄车辆的距离降低远处车辆计算量的距离分段。
+ *
+ * @param update_radius 降低更新频率的半径。
+ * @param collision_radius 参与碰撞协商的半径。
+ * @param update_interval 远处车辆的更新间隔步数。
+ */
+  void SetLevelOfDetail(const float update_radius, const float collision_radius, const unsigned update_interval);
+
+  /**
+ * @brief 启用或停用各阶段的性能统计。
+ *
+ * @param enabled 为true时开始统计。
+ */
+  void SetProfiling(const bool enabled);
+
+  /**
+ * @brief 获取远程交通管理器最近若干步内的性能统计结果。
+ */
+  TrafficManagerProfile GetProfile() const;
+
+  /**
+ * @brief 设置远程交通管理器的地图分区表。
+ *
+ * @param shard_map 所有参与分区的交通管理器共享的分区表。
+ */
+  void SetShardMap(const ShardMap &shard_map);
+
+  /**
+ * @brief 插件只能在运行交通管理器的进程中加载，远程调用时记录警告。
+ *
+ * @param path 插件的路径。
+ * @return 总是为空。
+ */
+  std::vector<std::string> LoadAgentPlugin(const std::string &path);
+
+  /**
+ * @brief 指定车辆使用远程交通管理器中的驾驶策略。
+ *
+ * @param actor 车辆对象。
+ * @param policy 策略的名字，为空时恢复由交通管理器控制。
+ * @return 策略是否存在。
+ */
+  bool SetAgentPolicy(const ActorPtr &actor, const std::string &policy);
+
+  /**
+ * @brief 通过一次RPC调用应用一组逐车辆参数修改。
+ *
+ * @param batch 参数修改命令列表。
+ */
+  void ApplySettingsBatch(const VehicleSettingBatch &batch);
+
   /**
  * @brief 设置自定义路径。
  *
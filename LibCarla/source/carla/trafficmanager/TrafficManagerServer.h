@@ -299,6 +299,52 @@ public:
         tm->SetOSMMode(mode_switch);
       });
 
+      /// 设置并行执行各阶段时使用的线程数的方法
+      /// @param number_of_threads 线程数，1表示串行执行
+      server->bind("set_stage_threads", [=](const unsigned number_of_threads) {
+        tm->SetStageThreads(number_of_threads);
+      });
+
+      /// 设置是否流水线式发送控制命令的方法
+      /// @param enabled 为true时命令最多延迟一步生效
+      server->bind("set_pipelined_control", [=](const bool enabled) {
+        tm->SetPipelinedControl(enabled);
+      });
+
+      /// 设置细节层次的距离分段的方法
+      server->bind("set_level_of_detail", [=](const float update_radius, const float collision_radius, const unsigned update_interval) {
+        tm->SetLevelOfDetail(update_radius, collision_radius, update_interval);
+      });
+
+      /// 启用或停用各阶段性能统计的方法
+      /// @param enabled 为true时开始统计
+      server->bind("set_profiling", [=](const bool enabled) {
+        tm->SetProfiling(enabled);
+      });
+
+      /// 获取性能统计结果的方法
+      server->bind("get_profile", [=]() -> TrafficManagerProfile {
+        return tm->GetProfile();
+      });
+
+      /// 设置地图分区表的方法
+      /// @param shard_map 所有参与分区的交通管理器共享的分区表
+      server->bind("set_shard_map", [=](const ShardMap shard_map) {
+        tm->SetShardMap(shard_map);
+      });
+
+      /// 指定车辆的驾驶策略的方法，插件只能在交通管理器所在的进程中加载，不提供远程加载的方法
+      /// @param policy 策略的名字，为空时恢复由交通管理器控制
+      server->bind("set_agent_policy", [=](carla::rpc::Actor actor, const std::string policy) -> bool {
+        return tm->SetAgentPolicy(carla::client::detail::ActorVariant(actor).Get(tm->GetEpisodeProxy()), policy);
+      });
+
+      /// 批量设置逐车辆参数的方法
+      /// @param batch 参数修改命令列表，整组修改在下一步开始时一起生效
+      server->bind("apply_settings_batch", [=](const VehicleSettingBatch batch) {
+        tm->ApplySettingsBatch(batch);
+      });
+
       /// 设置自定义路径的方法  
       /// @param actor CARLA中的Actor对象  
       /// @param path 自定义的路径  
@@ -1,6 +1,8 @@
 
 #pragma once
 
+#include <unordered_map> // 引入无序映射头文件
+
 #include "carla/trafficmanager/DataStructures.h" // 引入交通管理模块的数据结构定义
 #include "carla/trafficmanager/Parameters.h" // 引入交通管理模块的参数定义
 #include "carla/trafficmanager/RandomGenerator.h" // 引入交通管理模块的随机数生成器定义
@@ -12,8 +14,31 @@ namespace traffic_manager {
 
 /// VehicleLightStage类负责根据车辆当前的状态和周围环境来开启或关闭车辆的灯光
 ///
+/// 灯光只取决于天气、刹车和转向灯三类输入，因此只有输入发生变化的车辆才会被重新计算，
+/// 只有灯光状态确实改变的车辆才会发送 SetVehicleLightState 命令。
+/// 车辆的当前灯光状态缓存在本地，只在出现新车辆时和每隔若干步才从服务器重新读取，
+/// 以便发现其他客户端对灯光的修改。
 class VehicleLightStage: Stage {
 private:
+  /// 每辆车的灯光计算输入
+  struct LightInputs {
+    bool brake_lights = false; // 刹车灯
+    bool left_turn_indicator = false; // 左转指示灯
+    bool right_turn_indicator = false; // 右转指示灯
+
+    bool operator==(const LightInputs &rhs) const {
+      return brake_lights == rhs.brake_lights
+          && left_turn_indicator == rhs.left_turn_indicator
+          && right_turn_indicator == rhs.right_turn_indicator;
+    }
+  };
+  /// 每辆车缓存的灯光状态和上一次计算时的输入
+  struct LightRecord {
+    rpc::VehicleLightState::flag_type light_states = 0u; // 车辆当前的灯光状态
+    LightInputs inputs; // 上一次计算时的输入
+    bool dirty = true; // 是否需要重新计算
+  };
+
   const std::vector<ActorId> &vehicle_id_list; // 车辆ID列表的引用
   const BufferMap &buffer_map;  // 一个常量引用，包含了交通管理模块的缓冲区映射
   const Parameters &parameters; // 一个常量引用，包含了交通管理模块的参数
@@ -21,8 +46,24 @@ private:
   ControlFrame& control_frame; // 一个引用，指向当前的控制帧，用于更新车辆控制信息
   /// 一个列表，包含了所有车辆的灯光状态，用于管理和更新车辆的灯光
   rpc::VehicleLightStateList all_light_states;
+  /// all_light_states 按车辆ID建立的索引，每次读取时重建
+  std::unordered_map<ActorId, rpc::VehicleLightState::flag_type> server_light_states;
   /// 当前的天气参数，用于根据天气情况调整车辆灯光
   rpc::WeatherParameters weather;
+  /// 由天气决定的灯光，所有车辆相同
+  rpc::VehicleLightState::flag_type environment_lights = 0u;
+  /// 本步由天气决定的灯光是否发生了变化
+  bool environment_changed = true;
+  /// 各车辆缓存的灯光状态
+  std::unordered_map<ActorId, LightRecord> light_records;
+  /// 自上次从服务器读取灯光状态以来经过的步数
+  uint64_t steps_since_refresh = 0u;
+
+  /// 根据天气计算所有车辆共同的灯光
+  rpc::VehicleLightState::flag_type ComputeEnvironmentLights() const;
+
+  /// 计算索引为 @a index 的车辆本步的刹车和转向灯输入
+  LightInputs ComputeInputs(const unsigned long index, const ActorId actor_id) const;
 
 public:
   VehicleLightStage(const std::vector<ActorId> &vehicle_id_list, // VehicleLightStage类的构造函数，初始化成员变量
@@ -0,0 +1,54 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "carla/MsgPack.h"
+#include "carla/rpc/ActorId.h"
+
+namespace carla {
+namespace traffic_manager {
+
+  /// 可以批量设置的逐车辆参数，每一项对应 TrafficManager 中同名的单项设置方法。
+  enum class VehicleSetting : uint8_t {
+    PercentageSpeedDifference,
+    DesiredSpeed,
+    LaneOffset,
+    UpdateVehicleLights,
+    CollisionDetection,
+    AutoLaneChange,
+    DistanceToLeadingVehicle,
+    PercentageIgnoreWalkers,
+    PercentageIgnoreVehicles,
+    PercentageRunningLight,
+    PercentageRunningSign,
+    KeepRightPercentage,
+    RandomLeftLaneChangePercentage,
+    RandomRightLaneChangePercentage
+  };
+
+  /// 一条逐车辆参数修改命令。
+  struct VehicleSettingCommand {
+    ActorId actor_id = 0u;
+    VehicleSetting setting = VehicleSetting::PercentageSpeedDifference;
+    /// 参数值，布尔类型的参数以非零表示true。
+    float value = 0.0f;
+    /// 仅用于 CollisionDetection，表示另一方参与者。
+    ActorId other_actor_id = 0u;
+
+    MSGPACK_DEFINE_ARRAY(actor_id, setting, value, other_actor_id);
+  };
+
+  /// 在同一步内一起生效的一组参数修改命令。
+  using VehicleSettingBatch = std::vector<VehicleSettingCommand>;
+
+} // namespace traffic_manager
+} // namespace carla
+
+MSGPACK_ADD_ENUM(carla::traffic_manager::VehicleSetting);
@@ -0,0 +1,193 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include "carla/trafficmanager/Constants.h"
+#include "carla/trafficmanager/SimpleWaypoint.h"
+
+namespace carla {
+namespace traffic_manager {
+
+  /// 车辆路径点缓冲区使用的环形缓冲区。
+  ///
+  /// 接口与原先使用的 std::deque 一致，但存储空间是一块容量为2的幂的连续数组，
+  /// 在首次插入时按 constants::PathBufferUpdate::WAYPOINT_BUFFER_CAPACITY 分配。
+  /// 视野范围内的路径点数量通常不会超过该容量，因此两端的插入与删除不再产生内存分配；
+  /// 在超长的交叉口等少见情况下容量不足时，存储空间会翻倍扩大，而不是丢弃路径点。
+  ///
+  /// 缓冲区只保存指向SimpleWaypointPool中路径点的裸指针，不持有引用计数：
+  /// 所有车辆共用内存池的同一个控制块，逐个路径点增减引用计数会在多线程间争用。
+  /// 路径点由InMemoryMap持有的内存池保证有效，缓冲区必须在地图释放前清空。
+  class WaypointBuffer {
+  public:
+
+    using value_type = SimpleWaypoint *;
+    using size_type = std::size_t;
+    using reference = value_type &;
+    using const_reference = const value_type &;
+
+    template <typename Buffer, typename Value>
+    class Iterator {
+    public:
+
+      using iterator_category = std::random_access_iterator_tag;
+      using value_type = WaypointBuffer::value_type;
+      using difference_type = std::ptrdiff_t;
+      using pointer = Value *;
+      using reference = Value &;
+
+      Iterator(Buffer *buffer, size_type position) : _buffer(buffer), _position(position) {}
+
+      reference operator*() const { return (*_buffer)[_position]; }
+      pointer operator->() const { return &(*_buffer)[_position]; }
+      reference operator[](difference_type offset) const { return (*_buffer)[_position + offset]; }
+
+      Iterator &operator++() { ++_position; return *this; }
+      Iterator operator++(int) { Iterator result = *this; ++_position; return result; }
+      Iterator &operator--() { --_position; return *this; }
+      Iterator operator--(int) { Iterator result = *this; --_position; return result; }
+      Iterator &operator+=(difference_type offset) { _position += offset; return *this; }
+      Iterator &operator-=(difference_type offset) { _position -= offset; return *this; }
+      Iterator operator+(difference_type offset) const { return Iterator(_buffer, _position + offset); }
+      Iterator operator-(difference_type offset) const { return Iterator(_buffer, _position - offset); }
+      difference_type operator-(const Iterator &rhs) const {
+        return static_cast<difference_type>(_position) - static_cast<difference_type>(rhs._position);
+      }
+
+      bool operator==(const Iterator &rhs) const { return _position == rhs._position; }
+      bool operator!=(const Iterator &rhs) const { return _position != rhs._position; }
+      bool operator<(const Iterator &rhs) const { return _position < rhs._position; }
+      bool operator>(const Iterator &rhs) const { return _position > rhs._position; }
+      bool operator<=(const Iterator &rhs) const { return _position <= rhs._position; }
+      bool operator>=(const Iterator &rhs) const { return _position >= rhs._position; }
+
+    private:
+
+      Buffer *_buffer;
+      size_type _position;
+    };
+
+    using iterator = Iterator<WaypointBuffer, value_type>;
+    using const_iterator = Iterator<const WaypointBuffer, const value_type>;
+
+    bool empty() const { return _size == 0u; }
+
+    size_type size() const { return _size; }
+
+    size_type capacity() const { return _storage.size(); }
+
+    reference operator[](size_type index) { return _storage[Slot(index)]; }
+    const_reference operator[](size_type index) const { return _storage[Slot(index)]; }
+
+    reference at(size_type index) {
+      CheckIndex(index);
+      return (*this)[index];
+    }
+
+    const_reference at(size_type index) const {
+      CheckIndex(index);
+      return (*this)[index];
+    }
+
+    reference front() { return _storage[_head]; }
+    const_reference front() const { return _storage[_head]; }
+
+    reference back() { return (*this)[_size - 1u]; }
+    const_reference back() const { return (*this)[_size - 1u]; }
+
+    void push_back(value_type waypoint) {
+      if (_size == _storage.size()) {
+        Grow();
+      }
+      _storage[Slot(_size)] = waypoint;
+      ++_size;
+    }
+
+    /// 只取出路径点地址，不复制共享指针。
+    void push_back(const std::shared_ptr<SimpleWaypoint> &waypoint) {
+      push_back(waypoint.get());
+    }
+
+    void push_front(value_type waypoint) {
+      if (_size == _storage.size()) {
+        Grow();
+      }
+      _head = (_head + _storage.size() - 1u) & Mask();
+      _storage[_head] = waypoint;
+      ++_size;
+    }
+
+    void push_front(const std::shared_ptr<SimpleWaypoint> &waypoint) {
+      push_front(waypoint.get());
+    }
+
+    void pop_front() {
+      _storage[_head] = nullptr;
+      _head = (_head + 1u) & Mask();
+      --_size;
+    }
+
+    void pop_back() {
+      back() = nullptr;
+      --_size;
+    }
+
+    /// 清空所有元素但保留已分配的存储空间。
+    void clear() {
+      while (!empty()) {
+        pop_back();
+      }
+      _head = 0u;
+    }
+
+    iterator begin() { return iterator(this, 0u); }
+    iterator end() { return iterator(this, _size); }
+    const_iterator begin() const { return const_iterator(this, 0u); }
+    const_iterator end() const { return const_iterator(this, _size); }
+    const_iterator cbegin() const { return begin(); }
+    const_iterator cend() const { return end(); }
+
+  private:
+
+    size_type Mask() const { return _storage.size() - 1u; }
+
+    size_type Slot(size_type index) const { return (_head + index) & Mask(); }
+
+    void CheckIndex(size_type index) const {
+      if (index >= _size) {
+        throw std::out_of_range("WaypointBuffer index out of range");
+      }
+    }
+
+    /// 按逻辑顺序把元素搬到新的存储空间，首个元素放在下标0处。
+    void Grow() {
+      const size_type new_capacity = _storage.empty()
+          ? constants::PathBufferUpdate::WAYPOINT_BUFFER_CAPACITY
+          : 2u * _storage.size();
+      std::vector<value_type> storage(new_capacity, nullptr);
+      for (size_type i = 0u; i < _size; ++i) {
+        storage[i] = (*this)[i];
+      }
+      _storage.swap(storage);
+      _head = 0u;
+    }
+
+    std::vector<value_type> _storage;
+
+    size_type _head = 0u;
+
+    size_type _size = 0u;
+  };
+
+} // namespace traffic_manager
+} // namespace carla
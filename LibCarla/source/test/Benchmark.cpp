@@ -0,0 +1,90 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "Benchmark.h"
+
+#include <carla/Logging.h>
+
+#include <cstdlib>
+#include <fstream>
+#include <vector>
+
+namespace util {
+
+  namespace {
+
+    struct Result {
+      std::string name;
+      size_t iterations;
+      double total_ms;
+    };
+
+    /// 测试程序退出时把结果写入文件。
+    class Report {
+    public:
+
+      Report() {
+        const char *path = std::getenv("LIBCARLA_BENCHMARK_OUTPUT");
+        if (path != nullptr) {
+          _path = path;
+        }
+      }
+
+      ~Report() {
+        if (_results.empty()) {
+          return;
+        }
+        std::ofstream out(_path);
+        if (!out.is_open()) {
+          carla::log_error("unable to write benchmark results to", _path);
+          return;
+        }
+        out << "{\n  \"benchmarks\": [";
+        for (size_t i = 0u; i < _results.size(); ++i) {
+          const Result &result = _results[i];
+          const double per_iteration_us =
+              result.iterations > 0u ? 1e3 * result.total_ms / result.iterations : 0.0;
+          out << (i == 0u ? "\n" : ",\n")
+              << "    {\"name\": \"" << result.name << "\""
+              << ", \"iterations\": " << result.iterations
+              << ", \"total_ms\": " << result.total_ms
+              << ", \"per_iteration_us\": " << per_iteration_us << "}";
+        }
+        out << "\n  ]\n}\n";
+      }
+
+      bool IsEnabled() const {
+        return !_path.empty();
+      }
+
+      void Add(Result result) {
+        carla::log_info("benchmark", result.name, ':', result.total_ms, "ms for", result.iterations, "iterations");
+        _results.emplace_back(std::move(result));
+      }
+
+    private:
+
+      std::string _path;
+
+      std::vector<Result> _results;
+    };
+
+    Report &GetReport() {
+      static Report report;
+      return report;
+    }
+
+  } // namespace
+
+  bool BenchmarkReport::IsEnabled() {
+    return GetReport().IsEnabled();
+  }
+
+  void BenchmarkReport::Add(const std::string &name, size_t iterations, double total_ms) {
+    GetReport().Add(Result{name, iterations, total_ms});
+  }
+
+} // namespace util
@@ -0,0 +1,42 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <carla/StopWatch.h>
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+
+namespace util {
+
+  /// 基准测试结果的记录。
+  ///
+  /// 只有设置了环境变量 LIBCARLA_BENCHMARK_OUTPUT 时基准测试才会运行，测试程序
+  /// 退出时所有结果以 JSON 格式写入该变量给出的文件，便于不同版本之间比较。
+  class BenchmarkReport {
+  public:
+
+    static bool IsEnabled();
+
+    /// 记录一项结果，@a total_ms 为 @a iterations 次迭代的总耗时（毫秒）。
+    static void Add(const std::string &name, size_t iterations, double total_ms);
+
+    /// 以迭代序号调用 @a func 共 @a iterations 次，记录总耗时。
+    template <typename F>
+    static void Measure(const std::string &name, size_t iterations, F &&func) {
+      carla::StopWatch stop_watch;
+      for (size_t i = 0u; i < iterations; ++i) {
+        func(i);
+      }
+      stop_watch.Stop();
+      const std::chrono::duration<double, std::milli> elapsed = stop_watch.GetDuration();
+      Add(name, iterations, elapsed.count());
+    }
+  };
+
+} // namespace util
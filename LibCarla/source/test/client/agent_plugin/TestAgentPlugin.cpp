@@ -0,0 +1,81 @@
+// Copyright (c) 2026 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+// test_agent_plugin.cpp 加载的驾驶策略插件，单独编译为共享库。
+
+#include <carla/trafficmanager/AgentPolicy.h>
+
+#include <mutex>
+#include <stdexcept>
+#include <unordered_set>
+
+namespace {
+
+  using namespace carla::traffic_manager;
+
+  /// 前方有碰撞危险或红灯时全力刹车，否则沿用交通管理器的命令
+  class StopOnHazard : public AgentPolicy {
+  public:
+
+    bool Update(const AgentPolicyInput &input, carla::rpc::Command &command) override {
+      if (!input.collision_hazard.hazard && !input.traffic_light_hazard) {
+        return false;
+      }
+      carla::rpc::VehicleControl control;
+      control.throttle = 0.0f;
+      control.brake = 1.0f;
+      command = carla::rpc::Command::ApplyVehicleControl(input.actor_id, control);
+      return true;
+    }
+  };
+
+  /// 总是抛出异常，交通管理器应沿用自己的命令
+  class Throwing : public AgentPolicy {
+  public:
+
+    bool Update(const AgentPolicyInput &, carla::rpc::Command &command) override {
+      command = carla::rpc::Command::DestroyActor(0u);
+      throw std::runtime_error("test policy failure");
+    }
+  };
+
+  /// 只在车辆第一次更新时刹车，RemoveActor 之后重新计算
+  class BrakeFirstStep : public AgentPolicy {
+  public:
+
+    bool Update(const AgentPolicyInput &input, carla::rpc::Command &command) override {
+      {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (!_seen.insert(input.actor_id).second) {
+          return false;
+        }
+      }
+      carla::rpc::VehicleControl control;
+      control.brake = 1.0f;
+      command = carla::rpc::Command::ApplyVehicleControl(input.actor_id, control);
+      return true;
+    }
+
+    void RemoveActor(const ActorId actor_id) override {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _seen.erase(actor_id);
+    }
+
+  private:
+
+    std::mutex _mutex;
+
+    std::unordered_set<ActorId> _seen;
+  };
+
+} // namespace
+
+CARLA_TM_AGENT_PLUGIN_EXPORT void carla_tm_register_agent_policies(
+    carla::traffic_manager::AgentPolicyRegistry &registry) {
+  registry.Register("stop_on_hazard", std::make_shared<StopOnHazard>());
+  registry.Register("throwing", std::make_shared<Throwing>());
+  registry.Register("brake_first_step", std::make_shared<BrakeFirstStep>());
+}
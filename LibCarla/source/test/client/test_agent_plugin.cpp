@@ -0,0 +1,134 @@
+// Copyright (c) 2026 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/trafficmanager/AgentPluginStage.h>
+
+#include <algorithm>
+
+using namespace carla::traffic_manager;
+
+static carla::rpc::VehicleControl GetControl(const carla::rpc::Command &command) {
+  auto *apply = boost::variant2::get_if<carla::rpc::Command::ApplyVehicleControl>(&command.command);
+  EXPECT_NE(apply, nullptr);
+  return apply != nullptr ? apply->control : carla::rpc::VehicleControl{};
+}
+
+TEST(agent_plugin, load_plugin) {
+  const std::vector<ActorId> vehicles;
+  SimulationState state;
+  BufferMap buffers;
+  LocalizationFrame localization;
+  CollisionFrame collisions;
+  TLFrame lights;
+  ControlFrame controls;
+  AgentPluginStage stage(vehicles, state, buffers, localization, collisions, lights, controls);
+
+  ASSERT_TRUE(stage.LoadPlugin("does_not_exist.so").empty());
+  ASSERT_FALSE(stage.SetPolicy(1u, "stop_on_hazard"));
+
+  auto names = stage.LoadPlugin(LIBCARLA_TEST_AGENT_PLUGIN);
+  std::sort(names.begin(), names.end());
+  ASSERT_EQ(names, (std::vector<std::string>{"brake_first_step", "stop_on_hazard", "throwing"}));
+  ASSERT_TRUE(stage.SetPolicy(1u, "stop_on_hazard"));
+  ASSERT_FALSE(stage.SetPolicy(1u, "unknown"));
+  ASSERT_TRUE(stage.SetPolicy(1u, ""));
+}
+
+TEST(agent_plugin, run_policies) {
+  const std::vector<ActorId> vehicles{1u, 2u, 3u};
+  SimulationState state;
+  BufferMap buffers;
+  for (auto id : vehicles) {
+    buffers[id];
+  }
+  LocalizationFrame localization(vehicles.size());
+  CollisionFrame collisions(vehicles.size());
+  TLFrame lights(vehicles.size(), false);
+  ControlFrame controls(vehicles.size());
+  AgentPluginStage stage(vehicles, state, buffers, localization, collisions, lights, controls);
+  ASSERT_FALSE(stage.LoadPlugin(LIBCARLA_TEST_AGENT_PLUGIN).empty());
+
+  carla::rpc::VehicleControl throttle;
+  throttle.throttle = 1.0f;
+  auto run_step = [&]() {
+    for (auto i = 0u; i < vehicles.size(); ++i) {
+      controls[i] = carla::rpc::Command::ApplyVehicleControl(vehicles[i], throttle);
+    }
+    stage.PrepareStep();
+    for (auto i = 0u; i < vehicles.size(); ++i) {
+      stage.Update(i);
+    }
+  };
+
+  // 1号车有碰撞危险，2号车的策略抛出异常，3号车没有指定策略
+  ASSERT_TRUE(stage.SetPolicy(1u, "stop_on_hazard"));
+  ASSERT_TRUE(stage.SetPolicy(2u, "throwing"));
+  collisions[0].hazard = true;
+  collisions[2].hazard = true;
+  run_step();
+  ASSERT_TRUE(stage.HasPolicies());
+  ASSERT_EQ(GetControl(controls[0]).brake, 1.0f);
+  ASSERT_EQ(GetControl(controls[0]).throttle, 0.0f);
+  ASSERT_EQ(GetControl(controls[1]).throttle, 1.0f);
+  ASSERT_EQ(GetControl(controls[2]).throttle, 1.0f);
+
+  // 策略返回false时沿用交通管理器的命令
+  collisions[0].hazard = false;
+  run_step();
+  ASSERT_EQ(GetControl(controls[0]).throttle, 1.0f);
+
+  // 车辆离开交通管理器后不再运行它的策略
+  collisions[0].hazard = true;
+  stage.RemoveActor(1u);
+  run_step();
+  ASSERT_EQ(GetControl(controls[0]).throttle, 1.0f);
+
+  stage.Reset();
+  stage.RemoveActor(2u);
+  run_step();
+  ASSERT_FALSE(stage.HasPolicies());
+}
+
+// 清除或更换策略时通知原来的策略
+TEST(agent_plugin, set_policy_removes_actor) {
+  const std::vector<ActorId> vehicles{1u};
+  SimulationState state;
+  BufferMap buffers;
+  buffers[1u];
+  LocalizationFrame localization(vehicles.size());
+  CollisionFrame collisions(vehicles.size());
+  TLFrame lights(vehicles.size(), false);
+  ControlFrame controls(vehicles.size());
+  AgentPluginStage stage(vehicles, state, buffers, localization, collisions, lights, controls);
+  ASSERT_FALSE(stage.LoadPlugin(LIBCARLA_TEST_AGENT_PLUGIN).empty());
+
+  carla::rpc::VehicleControl throttle;
+  throttle.throttle = 1.0f;
+  auto run_step = [&]() {
+    controls[0] = carla::rpc::Command::ApplyVehicleControl(1u, throttle);
+    stage.PrepareStep();
+    stage.Update(0u);
+    return GetControl(controls[0]).brake;
+  };
+
+  ASSERT_TRUE(stage.SetPolicy(1u, "brake_first_step"));
+  ASSERT_EQ(run_step(), 1.0f);
+  ASSERT_EQ(run_step(), 0.0f);
+
+  // 指定相同的策略不算更换
+  ASSERT_TRUE(stage.SetPolicy(1u, "brake_first_step"));
+  ASSERT_EQ(run_step(), 0.0f);
+
+  ASSERT_TRUE(stage.SetPolicy(1u, ""));
+  ASSERT_TRUE(stage.SetPolicy(1u, "brake_first_step"));
+  ASSERT_EQ(run_step(), 1.0f);
+
+  ASSERT_TRUE(stage.SetPolicy(1u, "stop_on_hazard"));
+  ASSERT_TRUE(stage.SetPolicy(1u, "brake_first_step"));
+  ASSERT_EQ(run_step(), 1.0f);
+}
@@ -0,0 +1,382 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+// 客户端各部分的基准测试，只在设置了 LIBCARLA_BENCHMARK_OUTPUT 时运行（见
+// Util/BuildTools/Check.sh --benchmark），结果写入该变量给出的 JSON 文件。
+
+#include "test.h"
+#include "Benchmark.h"
+#include "OpenDrive.h"
+
+#include <carla/MsgPack.h>
+#include <carla/client/Map.h>
+#include <carla/client/detail/EpisodeState.h>
+#include <carla/road/Map.h>
+#include <carla/rpc/Command.h>
+#include <carla/rpc/VehicleControl.h>
+#include <carla/sensor/Deserializer.h>
+#include <carla/sensor/SensorRegistry.h>
+#include <carla/sensor/data/LidarData.h>
+#include <carla/sensor/data/RadarData.h>
+#include <carla/sensor/data/RawEpisodeState.h>
+#include <carla/sensor/s11n/SensorHeaderSerializer.h>
+#include <carla/trafficmanager/CollisionStage.h>
+#include <carla/trafficmanager/InMemoryMap.h>
+
+#include <array>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <random>
+
+using util::BenchmarkReport;
+
+namespace cc = carla::client;
+namespace cg = carla::geom;
+namespace cs = carla::sensor;
+namespace ctm = carla::traffic_manager;
+
+// 固定的随机种子，使每次运行的查询相同
+static constexpr uint64_t BENCHMARK_SEED = 2024u;
+
+static std::vector<cg::Location> MakeLocations(size_t count) {
+  std::mt19937_64 engine(BENCHMARK_SEED);
+  std::uniform_real_distribution<float> distribution(-500.0f, 500.0f);
+  std::vector<cg::Location> locations;
+  locations.reserve(count);
+  for (auto i = 0u; i < count; ++i) {
+    const float x = distribution(engine);
+    const float y = distribution(engine);
+    locations.emplace_back(x, y, 0.0f);
+  }
+  return locations;
+}
+
+static carla::SharedPtr<const cc::Map> LoadMap(const std::string &file) {
+  return carla::MakeShared<cc::Map>(file, util::OpenDrive::Load(file));
+}
+
+// ============================================================================
+// -- road::Map ---------------------------------------------------------------
+// ============================================================================
+
+TEST(benchmark_libcarla, road_map) {
+  if (!BenchmarkReport::IsEnabled()) {
+    return;
+  }
+  const auto locations = MakeLocations(10'000u);
+  for (const auto &file : util::OpenDrive::GetAvailableFiles()) {
+    const auto world_map = LoadMap(file);
+    const carla::road::Map &map = world_map->GetMap();
+    size_t found = 0u;
+
+    BenchmarkReport::Measure(file + ".road_map.closest_waypoint", locations.size(), [&](size_t i) {
+      found += map.GetClosestWaypointOnRoad(locations[i]).has_value() ? 1u : 0u;
+    });
+    BenchmarkReport::Measure(file + ".road_map.waypoint", locations.size(), [&](size_t i) {
+      found += map.GetWaypoint(locations[i]).has_value() ? 1u : 0u;
+    });
+
+    std::vector<carla::road::element::Waypoint> waypoints;
+    BenchmarkReport::Measure(file + ".road_map.generate_waypoints", 10u, [&](size_t) {
+      waypoints = map.GenerateWaypoints(2.0);
+    });
+    ASSERT_FALSE(waypoints.empty());
+
+    std::vector<carla::road::element::Waypoint> next;
+    BenchmarkReport::Measure(file + ".road_map.get_next", waypoints.size(), [&](size_t i) {
+      map.GetNext(waypoints[i], 2.0, next);
+      found += next.size();
+    });
+    ASSERT_GT(found, 0u);
+  }
+}
+
+// ============================================================================
+// -- InMemoryMap -------------------------------------------------------------
+// ============================================================================
+
+TEST(benchmark_libcarla, in_memory_map) {
+  if (!BenchmarkReport::IsEnabled()) {
+    return;
+  }
+  for (const auto &file : util::OpenDrive::GetAvailableFiles()) {
+    const auto world_map = LoadMap(file);
+    const std::string path = file + ".benchmark.bin";
+
+    BenchmarkReport::Measure(file + ".in_memory_map.cook", 1u, [&](size_t) {
+      ctm::InMemoryMap::Cook(world_map, path);
+    });
+
+    std::ifstream in(path, std::ios::binary);
+    ASSERT_TRUE(in.is_open());
+    const std::vector<uint8_t> content(
+        (std::istreambuf_iterator<char>(in)),
+        std::istreambuf_iterator<char>());
+    in.close();
+    std::remove(path.c_str());
+
+    size_t nodes = 0u;
+    BenchmarkReport::Measure(file + ".in_memory_map.load", 10u, [&](size_t) {
+      ctm::InMemoryMap local_map(world_map);
+      ASSERT_TRUE(local_map.Load(content));
+      nodes += local_map.GetDenseTopology().size();
+    });
+    ASSERT_GT(nodes, 0u);
+  }
+}
+
+// ============================================================================
+// -- Traffic manager ---------------------------------------------------------
+// ============================================================================
+
+// 在稠密拓扑上均匀放置车辆，每辆车的路径缓冲沿拓扑向前延伸，与定位阶段的输出相似
+TEST(benchmark_libcarla, traffic_manager_collision_stage) {
+  if (!BenchmarkReport::IsEnabled()) {
+    return;
+  }
+  constexpr size_t number_of_vehicles = 500u;
+  constexpr size_t buffer_size = 40u;
+  constexpr size_t number_of_cycles = 100u;
+
+  for (const auto &file : util::OpenDrive::GetAvailableFiles()) {
+    const auto world_map = LoadMap(file);
+    ctm::InMemoryMap local_map(world_map);
+    local_map.SetUp();
+    const ctm::NodeList topology = local_map.GetDenseTopology();
+    ASSERT_FALSE(topology.empty());
+
+    std::vector<carla::ActorId> vehicle_id_list;
+    ctm::SimulationState simulation_state;
+    ctm::BufferMap buffer_map;
+    ctm::TrackTraffic track_traffic;
+    const size_t stride = std::max<size_t>(1u, topology.size() / number_of_vehicles);
+    for (size_t i = 0u; i < number_of_vehicles && i * stride < topology.size(); ++i) {
+      const carla::ActorId actor_id = static_cast<carla::ActorId>(i + 1u);
+      const ctm::SimpleWaypointPtr &start = topology[i * stride];
+      const cg::Transform transform = start->GetTransform();
+      vehicle_id_list.push_back(actor_id);
+      simulation_state.AddActor(
+          actor_id,
+          ctm::KinematicState{transform.location, transform.rotation,
+                             8.0f * transform.GetForwardVector(), 50.0f, true, false,
+                             transform.location},
+          ctm::StaticAttributes{ctm::ActorType::Vehicle, 2.4f, 1.0f, 0.8f},
+          ctm::TrafficLightState{carla::rpc::TrafficLightState::Green, false});
+
+      ctm::Buffer &buffer = buffer_map[actor_id];
+      ctm::SimpleWaypointPtr waypoint = start;
+      while (waypoint != nullptr && buffer.size() < buffer_size) {
+        buffer.push_back(waypoint);
+        const auto next = waypoint->GetNextWaypoint();
+        waypoint = next.empty() ? nullptr : next.front();
+      }
+      track_traffic.UpdateGridPosition(actor_id, buffer);
+    }
+
+    ctm::Parameters parameters;
+    ctm::CollisionFrame collision_frame(vehicle_id_list.size());
+    ctm::RandomGenerator random_device(BENCHMARK_SEED);
+    ctm::CollisionStage collision_stage(
+        vehicle_id_list,
+        simulation_state,
+        buffer_map,
+        track_traffic,
+        parameters,
+        collision_frame,
+        random_device);
+
+    // 每次迭代是所有车辆的一个周期
+    size_t hazards = 0u;
+    BenchmarkReport::Measure(file + ".traffic_manager.collision_stage", number_of_cycles, [&](size_t) {
+      for (unsigned long index = 0u; index < vehicle_id_list.size(); ++index) {
+        collision_stage.Update(index);
+      }
+      collision_stage.ClearCycleCache();
+      for (const auto &hazard : collision_frame) {
+        hazards += hazard.hazard ? 1u : 0u;
+      }
+    });
+    carla::logging::log(file, "collision hazards per cycle:", hazards / number_of_cycles);
+  }
+}
+
+// ============================================================================
+// -- Sensor deserialization --------------------------------------------------
+// ============================================================================
+
+// 在负载之前加上传感器消息头，与服务器发送的消息相同
+template <typename SensorT>
+static carla::Buffer MakeSensorMessage(const carla::Buffer &payload) {
+  using Registry = cs::SensorRegistry;
+  const carla::Buffer header = cs::s11n::SensorHeaderSerializer::Serialize(
+      Registry::template get<SensorT *>::index,
+      1u,
+      0.0,
+      carla::rpc::Transform{});
+  const std::array<boost::asio::const_buffer, 2u> sequence = {header.buffer(), payload.buffer()};
+  carla::Buffer message;
+  message.copy_from(sequence);
+  return message;
+}
+
+// 反序列化会接管缓冲区，消息的复制不计入耗时
+static void MeasureDeserialize(
+    const std::string &name,
+    const carla::Buffer &message,
+    size_t iterations) {
+  std::vector<carla::Buffer> messages;
+  messages.reserve(iterations);
+  for (auto i = 0u; i < iterations; ++i) {
+    messages.emplace_back(message.buffer());
+  }
+  size_t count = 0u;
+  BenchmarkReport::Measure("sensor.deserialize." + name, iterations, [&](size_t i) {
+    auto data = cs::Deserializer::Deserialize(std::move(messages[i]));
+    count += data != nullptr ? 1u : 0u;
+  });
+  ASSERT_EQ(count, iterations);
+}
+
+namespace {
+
+  struct FakeCamera {
+    uint32_t GetImageWidth() const { return 800u; }
+    uint32_t GetImageHeight() const { return 600u; }
+    float GetFOVAngle() const { return 90.0f; }
+  };
+
+  struct FakeSensor {};
+
+} // namespace
+
+TEST(benchmark_libcarla, sensor_deserialize) {
+  if (!BenchmarkReport::IsEnabled()) {
+    return;
+  }
+  using namespace cs::s11n;
+  const FakeSensor sensor;
+
+  {
+    const FakeCamera camera;
+    carla::Buffer bitmap(ImageSerializer::header_offset + 4u * 800u * 600u);
+    std::memset(bitmap.data(), 0x7f, bitmap.size());
+    const auto payload = ImageSerializer::Serialize(camera, std::move(bitmap));
+    MeasureDeserialize("image", MakeSensorMessage<ASceneCaptureCamera>(payload), 64u);
+  }
+  {
+    constexpr uint32_t channels = 32u;
+    constexpr uint32_t points_per_channel = 1'000u;
+    const std::vector<uint32_t> points(channels, points_per_channel);
+    cs::data::LidarData lidar(channels);
+    lidar.ResetMemory(points);
+    for (auto i = 0u; i < channels * points_per_channel; ++i) {
+      cs::data::LidarDetection detection(1.0f, 2.0f, 3.0f, 0.5f);
+      lidar.WritePointSync(detection);
+    }
+    lidar.WriteChannelCount(points);
+    const auto payload = LidarSerializer::Serialize(sensor, lidar, carla::Buffer{});
+    MeasureDeserialize("lidar", MakeSensorMessage<ARayCastLidar>(payload), 256u);
+  }
+  {
+    cs::data::RadarData radar;
+    radar.SetResolution(1'500u);
+    for (auto i = 0u; i < 1'500u; ++i) {
+      radar.WriteDetection({1.0f, 0.1f, 0.0f, 20.0f});
+    }
+    const auto payload = RadarSerializer::Serialize(sensor, radar, carla::Buffer{});
+    MeasureDeserialize("radar", MakeSensorMessage<ARadar>(payload), 10'000u);
+  }
+  {
+    const auto payload = IMUSerializer::Serialize(
+        sensor, cg::Vector3D{0.1f, 0.2f, 9.8f}, cg::Vector3D{0.0f, 0.0f, 0.1f}, 1.5f);
+    MeasureDeserialize("imu", MakeSensorMessage<AInertialMeasurementUnit>(payload), 10'000u);
+  }
+  {
+    const auto payload = GnssSerializer::Serialize(sensor, cg::GeoLocation{41.5, 2.1, 120.0});
+    MeasureDeserialize("gnss", MakeSensorMessage<AGnssSensor>(payload), 10'000u);
+  }
+  {
+    cs::data::VehicleTelemetryHeader header;
+    std::memset(&header, 0, sizeof(header));
+    header.speed = 10.0f;
+    header.wheel_count = 4u;
+    std::vector<cs::data::WheelTelemetry> wheels(4u);
+    std::memset(wheels.data(), 0, wheels.size() * sizeof(cs::data::WheelTelemetry));
+    const auto payload = VehicleTelemetrySerializer::Serialize(sensor, header, wheels, carla::Buffer{});
+    MeasureDeserialize("vehicle_telemetry", MakeSensorMessage<AVehicleTelemetrySensor>(payload), 10'000u);
+  }
+}
+
+// ============================================================================
+// -- MsgPack -----------------------------------------------------------------
+// ============================================================================
+
+TEST(benchmark_libcarla, msgpack_command_batch) {
+  if (!BenchmarkReport::IsEnabled()) {
+    return;
+  }
+  constexpr size_t batch_size = 1'000u;
+  std::vector<carla::rpc::Command> batch;
+  batch.reserve(2u * batch_size);
+  for (auto i = 0u; i < batch_size; ++i) {
+    const auto id = static_cast<carla::ActorId>(i + 1u);
+    batch.emplace_back(carla::rpc::Command::ApplyTransform(
+        id, cg::Transform{cg::Location{1.0f * i, 2.0f, 0.5f}, cg::Rotation{0.0f, 90.0f, 0.0f}}));
+    batch.emplace_back(carla::rpc::Command::ApplyVehicleControl(id, carla::rpc::VehicleControl{}));
+  }
+
+  carla::Buffer packed;
+  BenchmarkReport::Measure("msgpack.command_batch.pack", 100u, [&](size_t) {
+    packed = carla::MsgPack::Pack(batch);
+  });
+  size_t count = 0u;
+  BenchmarkReport::Measure("msgpack.command_batch.unpack", 100u, [&](size_t) {
+    count += carla::MsgPack::UnPack<std::vector<carla::rpc::Command>>(packed).size();
+  });
+  ASSERT_EQ(count, 100u * batch.size());
+}
+
+// ============================================================================
+// -- EpisodeState ------------------------------------------------------------
+// ============================================================================
+
+TEST(benchmark_libcarla, episode_state) {
+  if (!BenchmarkReport::IsEnabled()) {
+    return;
+  }
+  constexpr size_t number_of_actors = 2'000u;
+  cs::s11n::EpisodeStateSerializer::Header header;
+  std::memset(&header, 0, sizeof(header));
+  header.episode_id = 42u;
+  std::vector<cs::data::ActorDynamicState> actors(number_of_actors);
+  std::memset(actors.data(), 0, actors.size() * sizeof(cs::data::ActorDynamicState));
+  for (auto i = 0u; i < number_of_actors; ++i) {
+    actors[i].id = static_cast<carla::ActorId>(number_of_actors - i);
+    actors[i].actor_state = carla::rpc::ActorState::Active;
+    actors[i].transform = cg::Transform{cg::Location{1.0f * i, 0.0f, 0.0f}, cg::Rotation{}};
+  }
+  carla::Buffer payload;
+  const std::array<boost::asio::const_buffer, 2u> sequence = {
+      boost::asio::buffer(&header, sizeof(header)),
+      boost::asio::buffer(actors)};
+  payload.copy_from(sequence);
+  const auto message = MakeSensorMessage<FWorldObserver>(payload);
+
+  MeasureDeserialize("episode_state", message, 1'000u);
+
+  carla::Buffer copy(message.buffer());
+  const auto raw = boost::static_pointer_cast<const cs::data::RawEpisodeState>(
+      cs::Deserializer::Deserialize(std::move(copy)));
+  ASSERT_TRUE(raw != nullptr);
+  size_t count = 0u;
+  BenchmarkReport::Measure("episode_state.construct", 1'000u, [&](size_t) {
+    cc::detail::EpisodeState state(raw);
+    count += state.size();
+  });
+  ASSERT_EQ(count, 1'000u * number_of_actors);
+}
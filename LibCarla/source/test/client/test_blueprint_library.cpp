@@ -0,0 +1,64 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/client/BlueprintLibrary.h>
+
+#include <string>
+#include <vector>
+
+using carla::client::BlueprintLibrary;
+
+static carla::rpc::ActorDefinition MakeDefinition(std::string id, std::string tags) {
+  carla::rpc::ActorDefinition definition;
+  definition.id = std::move(id);
+  definition.tags = std::move(tags);
+  return definition;
+}
+
+static std::vector<std::string> GetIds(const BlueprintLibrary &library) {
+  std::vector<std::string> ids;
+  for (const auto &blueprint : library) {
+    ids.emplace_back(blueprint.GetId());
+  }
+  return ids;
+}
+
+// 按索引过滤的结果与逐个匹配 id 和标签相同
+TEST(blueprint_library, filter) {
+  BlueprintLibrary library({
+      MakeDefinition("walker.pedestrian.0001", "walker,pedestrian"),
+      MakeDefinition("vehicle.tesla.model3", "vehicle,car"),
+      MakeDefinition("vehicle.audi.a2", "vehicle,car"),
+      MakeDefinition("sensor.camera.rgb", "sensor,camera"),
+      MakeDefinition("vehicle.yamaha.yzf", "vehicle,motorcycle")});
+  ASSERT_EQ(library.size(), 5u);
+  // 蓝图按 id 排序
+  ASSERT_EQ(library[0u].GetId(), "sensor.camera.rgb");
+
+  auto vehicles = library.Filter("vehicle.*");
+  ASSERT_EQ(GetIds(*vehicles), (std::vector<std::string>{
+      "vehicle.audi.a2", "vehicle.tesla.model3", "vehicle.yamaha.yzf"}));
+  // 标签也参与匹配
+  ASSERT_EQ(GetIds(*library.Filter("car")), (std::vector<std::string>{
+      "vehicle.audi.a2", "vehicle.tesla.model3"}));
+  ASSERT_EQ(GetIds(*library.Filter("*camera*")), (std::vector<std::string>{"sensor.camera.rgb"}));
+  ASSERT_EQ(library.Filter("vehicle.audi.a2")->size(), 1u);
+  ASSERT_TRUE(library.Filter("none")->empty());
+
+  // 缓存的结果与第一次相同
+  ASSERT_EQ(GetIds(*library.Filter("vehicle.*")), GetIds(*vehicles));
+
+  // 过滤结果的过滤和查找只包含视图中的蓝图
+  auto motorcycles = vehicles->Filter("motorcycle");
+  ASSERT_EQ(GetIds(*motorcycles), (std::vector<std::string>{"vehicle.yamaha.yzf"}));
+  ASSERT_TRUE(vehicles->Filter("walker.*")->empty());
+  ASSERT_NE(vehicles->Find("vehicle.tesla.model3"), nullptr);
+  ASSERT_EQ(vehicles->Find("sensor.camera.rgb"), nullptr);
+  ASSERT_THROW(vehicles->at("sensor.camera.rgb"), std::out_of_range);
+  ASSERT_THROW(vehicles->at(3u), std::out_of_range);
+}
@@ -0,0 +1,144 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+#include "OpenDrive.h"
+
+#include <carla/geom/Math.h>
+#include <carla/headless/HeadlessServer.h>
+#include <carla/headless/KinematicWorld.h>
+#include <carla/opendrive/OpenDriveParser.h>
+#include <carla/rpc/Client.h>
+#include <carla/rpc/Response.h>
+
+#include <algorithm>
+#include <thread>
+#include <unordered_map>
+
+using namespace carla::headless;
+using namespace carla::opendrive;
+using namespace std::chrono_literals;
+
+static carla::rpc::ActorDescription MakeDescription(const std::string &id) {
+  carla::rpc::ActorDescription description;
+  description.id = id;
+  return description;
+}
+
+TEST(headless, spawn_and_drive) {
+  for (const auto &file : util::OpenDrive::GetAvailableFiles()) {
+    auto map = OpenDriveParser::Load(util::OpenDrive::Load(file));
+    ASSERT_TRUE(map.has_value());
+    KinematicWorld world(std::move(*map));
+    if (world.GetSpawnPoints().empty()) {
+      continue;
+    }
+    const auto spawn_point = world.GetSpawnPoints().front();
+
+    auto spawned = world.SpawnActor(MakeDescription("vehicle.headless.car"), spawn_point);
+    ASSERT_FALSE(spawned.HasError()) << file << ": " << spawned.GetError().What();
+    const auto id = spawned.Get().id;
+
+    // 同一位置再生成一辆车会碰撞
+    auto blocked = world.SpawnActor(MakeDescription("vehicle.headless.car"), spawn_point);
+    ASSERT_TRUE(blocked.HasError());
+    ASSERT_EQ(world.GetNumberOfVehicles(), 1u);
+
+    carla::rpc::VehicleControl control;
+    control.throttle = 1.0f;
+    ASSERT_FALSE(world.ApplyControlToVehicle(id, control).HasError());
+    for (auto i = 0; i < 20; ++i) {
+      world.Tick(0.05);
+    }
+    ASSERT_EQ(world.GetFrame(), 20u);
+
+    std::vector<carla::sensor::data::ActorDynamicState> states;
+    world.GetActorStates(states);
+    auto it = std::find_if(states.begin(), states.end(), [&](const auto &state) {
+      return state.id == id;
+    });
+    ASSERT_NE(it, states.end());
+    const auto forward = spawn_point.GetForwardVector();
+    const auto moved = it->transform.location - spawn_point.location;
+    ASSERT_GT(carla::geom::Math::Dot(moved, forward), 1.0f) << file;
+    ASSERT_GT(it->velocity.Length(), 1.0f) << file;
+
+    ASSERT_FALSE(world.DestroyActor(id).HasError());
+    ASSERT_EQ(world.GetNumberOfVehicles(), 0u);
+    ASSERT_TRUE(world.DestroyActor(id).HasError());
+  }
+}
+
+TEST(headless, traffic_light_cycle) {
+  for (const auto &file : util::OpenDrive::GetAvailableFiles()) {
+    auto map = OpenDriveParser::Load(util::OpenDrive::Load(file));
+    ASSERT_TRUE(map.has_value());
+    KinematicWorld world(std::move(*map));
+    auto &signals = world.GetTrafficSignals();
+
+    // 每个信号灯在几个完整的周期内都应该变过绿灯和红灯
+    std::unordered_map<carla::rpc::ActorId, int> seen;
+    for (auto i = 0; i < 600; ++i) {
+      world.Tick(0.5);
+      for (const auto &light : signals.GetTrafficLights()) {
+        if (light.state == carla::rpc::TrafficLightState::Green) {
+          seen[light.id] |= 1;
+        } else if (light.state == carla::rpc::TrafficLightState::Red) {
+          seen[light.id] |= 2;
+        }
+      }
+    }
+    for (const auto &light : signals.GetTrafficLights()) {
+      ASSERT_EQ(seen[light.id], 3) << file << ": traffic light " << light.id;
+    }
+  }
+}
+
+TEST(headless, rpc_episode_settings) {
+  const auto files = util::OpenDrive::GetAvailableFiles();
+  ASSERT_FALSE(files.empty());
+  const uint16_t port = (TESTING_PORT != 0u ? TESTING_PORT : 2027u);
+  HeadlessServer server("headless", util::OpenDrive::Load(files.front()), port);
+  server.AsyncRun(1u);
+
+  carla::rpc::Client client("localhost", port);
+  // set_episode_settings 返回当前的帧号
+  auto apply = [&](bool synchronous_mode, boost::optional<double> fixed_delta_seconds) {
+    carla::rpc::EpisodeSettings settings;
+    settings.synchronous_mode = synchronous_mode;
+    settings.fixed_delta_seconds = fixed_delta_seconds;
+    auto response = client.call("set_episode_settings", settings).as<carla::rpc::Response<uint64_t>>();
+    EXPECT_FALSE(response.HasError());
+    return response.Get();
+  };
+
+  // 固定步长的异步模式尽快推进
+  auto frame = apply(false, 0.01);
+  std::this_thread::sleep_for(100ms);
+  ASSERT_GT(apply(false, 0.01), frame);
+
+  // 在固定步长和可变步长之间反复切换，服务器在处理请求之后须按新的设置推进
+  for (auto i = 0; i < 50; ++i) {
+    apply(false, 0.01);
+    apply(false, boost::none);
+  }
+  frame = apply(false, boost::none);
+  std::this_thread::sleep_for(200ms);
+  ASSERT_GT(apply(false, boost::none), frame);
+
+  // 同步模式下只在收到 tick_cue 后推进
+  frame = apply(true, 0.05);
+  std::this_thread::sleep_for(50ms);
+  ASSERT_EQ(apply(true, 0.05), frame);
+  const auto next = client.call("tick_cue").as<carla::rpc::Response<uint64_t>>().Get();
+  ASSERT_EQ(next, frame + 1u);
+  for (auto i = 0; (i < 100) && (apply(true, 0.05) < next); ++i) {
+    std::this_thread::sleep_for(10ms);
+  }
+  ASSERT_EQ(apply(true, boost::none), next);
+
+  server.Stop();
+}
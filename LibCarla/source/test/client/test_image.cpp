@@ -6,11 +6,24 @@
 
 #include "test.h"
 
+#include <carla/image/AsyncImageWriter.h>
 #include <carla/image/ImageConverter.h>
 #include <carla/image/ImageIO.h>
 #include <carla/image/ImageView.h>
+#include <carla/image/PixelConverter.h>
+#include <carla/sensor/CompositeSerializer.h>
+#include <carla/sensor/data/InstanceSegmentationImage.h>
+#include <carla/sensor/s11n/InstanceSegmentationImageSerializer.h>
+#include <carla/sensor/s11n/SensorHeaderSerializer.h>
 
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
 #include <memory>
+#include <random>
+#include <thread>
+#include <vector>
 
 template <typename ViewT, typename PixelT>
 struct TestImage {
@@ -218,3 +231,177 @@ TEST(image, semantic_segmentation) {
     }
   }
 }
+
+// 后台写入的 PNG 与原图相同，回调收到写入的路径
+TEST(image, async_writer) {
+  using namespace boost::gil;
+  using namespace carla::image;
+  auto image = MakeTestImage<rgb8_pixel_t>(64u, 48u);
+  auto i = 0u;
+  for (auto &pixel : image.view) {
+    pixel = rgb8_pixel_t(i % 256u, (i / 3u) % 256u, 7u);
+    ++i;
+  }
+  std::atomic<int> written{0};
+  {
+    AsyncImageWriter writer(2u, 2u);
+    for (auto n = 0; n < 8; ++n) {
+      const auto path = "_images/async_writer_" + std::to_string(n) + ".png";
+      writer.Push([&, path]() {
+        return ImageIO::WriteView(path, image.view, io::write_options::fast());
+      }, [&, path](const std::string &result, const std::string &error) {
+        if (result == path && error.empty()) {
+          ++written;
+        }
+      });
+    }
+    writer.Push([]() -> std::string { throw std::runtime_error("failure"); },
+        [&](const std::string &result, const std::string &error) {
+      if (result.empty() && error == "failure") {
+        ++written;
+      }
+    });
+    writer.Wait();
+    ASSERT_EQ(writer.GetNumberOfPendingWrites(), 0u);
+  }
+  ASSERT_EQ(written.load(), 9);
+  for (auto n = 0; n < 8; ++n) {
+    const auto path = "_images/async_writer_" + std::to_string(n) + ".png";
+    rgb8_image_t result;
+    ImageIO::ReadImage(path, result);
+    ASSERT_TRUE(equal_pixels(const_view(result), image.view)) << path;
+    std::remove(path.c_str());
+  }
+}
+
+// Shutdown 等待共享实例中剩余的任务，之后 Get() 创建新的实例
+TEST(image, async_writer_shutdown) {
+  using namespace carla::image;
+  std::atomic<int> done{0};
+  for (auto n = 0; n < 4; ++n) {
+    AsyncImageWriter::Get()->Push([]() {
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      return std::string("path");
+    }, [&](const std::string &, const std::string &) { ++done; });
+  }
+  AsyncImageWriter::Shutdown();
+  ASSERT_EQ(done.load(), 4);
+  AsyncImageWriter::Get()->Push([]() { return std::string("path"); },
+      [&](const std::string &, const std::string &) { ++done; });
+  AsyncImageWriter::Get()->Wait();
+  ASSERT_EQ(done.load(), 5);
+  AsyncImageWriter::Shutdown();
+}
+
+// 其他线程取得实例后才 Push 时，Shutdown 等待它，回调在 Shutdown 返回之前执行
+TEST(image, async_writer_shutdown_concurrent_push) {
+  using namespace carla::image;
+  std::atomic<int> done{0};
+  std::atomic<bool> acquired{false};
+  std::thread producer([&]() {
+    auto writer = AsyncImageWriter::Get();
+    acquired = true;
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    writer->Push([]() { return std::string("path"); },
+        [&](const std::string &, const std::string &) { ++done; });
+  });
+  while (!acquired) {
+    std::this_thread::yield();
+  }
+  AsyncImageWriter::Shutdown();
+  ASSERT_EQ(done.load(), 1);
+  producer.join();
+}
+
+// 直接处理缓冲区的转换与 Boost.GIL 视图上的转换结果相同
+TEST(image, pixel_converter) {
+  using namespace boost::gil;
+  using namespace carla::image;
+  constexpr auto width = 512u;
+  constexpr auto height = 300u;
+  auto source = MakeTestImage<bgra8_pixel_t>(width, height);
+  std::mt19937 rng(42u);
+  std::uniform_int_distribution<int> byte(0, 255);
+  for (auto &pixel : source.view) {
+    pixel = bgra8_pixel_t(byte(rng), byte(rng), byte(rng), byte(rng));
+  }
+  auto *data = reinterpret_cast<uint8_t *>(source.data.get());
+  const auto make_copy = [&]() {
+    auto copy = MakeTestImage<bgra8_pixel_t>(width, height);
+    ImageConverter::CopyPixels(source.view, copy.view);
+    return copy;
+  };
+  const auto check = [&](auto converter, auto convert_buffer) {
+    auto expected = make_copy();
+    ImageConverter::ConvertInPlace(expected.view, converter);
+    auto result = make_copy();
+    convert_buffer(reinterpret_cast<uint8_t *>(result.data.get()), width * height);
+    ASSERT_TRUE(equal_pixels(expected.view, result.view));
+  };
+  check(ColorConverter::Depth(), &PixelConverter::DepthInPlace);
+  check(ColorConverter::LogarithmicDepth(), &PixelConverter::LogarithmicDepthInPlace);
+  check(ColorConverter::CityScapesPalette(), &PixelConverter::CityScapesPaletteInPlace);
+
+  std::vector<float> meters(width * height);
+  std::vector<uint8_t> labels(width * height);
+  PixelConverter::DepthToMeters(data, meters.size(), meters.data());
+  PixelConverter::ExtractLabels(data, labels.size(), labels.data());
+  auto i = 0u;
+  for (const auto &pixel : source.view) {
+    const auto depth = get_color(pixel, red_t()) + 256.0 * get_color(pixel, green_t()) +
+        65536.0 * get_color(pixel, blue_t());
+    ASSERT_NEAR(meters[i], 1000.0 * depth / 16777215.0, 1e-3);
+    ASSERT_EQ(labels[i], get_color(pixel, red_t()));
+    ++i;
+  }
+}
+
+namespace {
+
+  struct FakeInstanceSegmentationCamera {
+    uint32_t GetImageWidth() const { return 2u; }
+    uint32_t GetImageHeight() const { return 1u; }
+    float GetFOVAngle() const { return 90.0f; }
+    std::shared_ptr<const std::vector<carla::sensor::data::InstanceTableEntry>> GetInstanceTable() const {
+      return Table;
+    }
+    std::shared_ptr<const std::vector<carla::sensor::data::InstanceTableEntry>> Table;
+  };
+
+} // namespace
+
+// 像素之后的映射表随图像一起反序列化，且不计入图像的像素
+TEST(image, instance_segmentation_table) {
+  using namespace carla::sensor;
+  using Serializer = s11n::InstanceSegmentationImageSerializer;
+  using Registry = CompositeSerializer<std::pair<FakeInstanceSegmentationCamera *, Serializer>>;
+
+  FakeInstanceSegmentationCamera sensor;
+  sensor.Table = std::make_shared<std::vector<data::InstanceTableEntry>>(
+      std::vector<data::InstanceTableEntry>{{3u, 42u}, {0x50001u, 7u}});
+
+  // BGRA 像素。实例 id 0x50001：R = 标签 | (5 << 5)，G = 0x01，B = 0x00
+  const uint8_t label = 10u;
+  const uint8_t pixels[] = {
+    0x00u, 0x03u, label, 0xFFu,
+    0x00u, 0x01u, static_cast<uint8_t>(label | (5u << Serializer::label_bits)), 0xFFu};
+  carla::Buffer bitmap;
+  bitmap.copy_from(Serializer::header_offset, carla::Buffer(pixels, sizeof(pixels)));
+  carla::Buffer payload = Registry::Serialize(sensor, std::move(bitmap));
+
+  // 流在消息前面写入传感器头，这里类型 id 为 0
+  carla::Buffer message;
+  message.copy_from(s11n::SensorHeaderSerializer::header_offset, payload);
+  std::memset(message.data(), 0, s11n::SensorHeaderSerializer::header_offset);
+
+  auto image = boost::static_pointer_cast<data::InstanceSegmentationImage>(
+      Registry::Deserialize(std::move(message)));
+  ASSERT_EQ(image->size(), 2u);
+  ASSERT_EQ(data::InstanceSegmentationImage::GetInstanceId((*image)[0u]), 3u);
+  ASSERT_EQ(data::InstanceSegmentationImage::GetInstanceId((*image)[1u]), 0x50001u);
+  ASSERT_EQ(data::InstanceSegmentationImage::GetLabel((*image)[1u]), label);
+  ASSERT_EQ(image->GetInstanceTableSize(), 2u);
+  ASSERT_EQ(image->GetActorId(3u), 42u);
+  ASSERT_EQ(image->GetActorId(0x50001u), 7u);
+  ASSERT_EQ(image->GetActorId(4u), 0u);
+}
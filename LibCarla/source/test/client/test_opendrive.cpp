@@ -10,10 +10,14 @@
 
 #include <carla/StopWatch.h> /// @brief 包含CARLA的计时器类，用于性能测量。
 #include <carla/ThreadPool.h>/// @brief 包含CARLA的线程池类，用于并行处理任务。
+#include <carla/client/Map.h>/// @brief 包含客户端地图类。
 #include <carla/geom/Location.h>/// @brief 包含地理位置相关的类，如点、向量等。
 #include <carla/geom/Math.h>/// @brief 包含几何数学运算相关的函数和类。
 #include <carla/opendrive/OpenDriveParser.h>/// @brief 包含OpenDrive解析器类，用于解析OpenDrive格式的地图文件。
+#include <carla/road/element/Geometry.h>/// @brief 包含道路几何形状的类。
+#include <carla/road/element/LaneCrossingCalculator.h>/// @brief 包含车道标记跨越的计算。
 #include <carla/road/MapBuilder.h>/// @brief 包含CARLA的路网构建器类，用于构建路网。
+#include <carla/road/RoutePlanner.h>/// @brief 包含基于车道拓扑的路径规划器。
 #include <carla/road/element/RoadInfoElevation.h>/// @brief 包含道路高程信息相关的类。
 #include <carla/road/element/RoadInfoGeometry.h>/// @brief 包含道路几何信息相关的类。
 #include <carla/road/element/RoadInfoMarkRecord.h>/// @brief 包含道路标记记录信息相关的类
@@ -21,8 +25,10 @@
 
 #include <pugixml/pugixml.hpp>/// @brief 包含pugixml库的头文件，用于XML解析和生成。
 
+#include <cmath>/// @brief 包含C++标准库的数学函数。
 #include <fstream>/// @brief 包含C++标准库的文件流类，用于文件读写。
 #include <string>/// @brief 包含C++标准库的字符串类。
+#include <utility>/// @brief 包含std::pair。
 
 using namespace carla::road;/// 导入CARLA的路面相关命名空间，包括道路定义和元素。
 using namespace carla::road::element;/// 导入CARLA的路面元素相关的命名空间，包括具体的道路元素定义。
@@ -504,3 +510,213 @@ TEST(road, get_waypoint) {
     result.get();
   }
 }
+
+// 批量查询的结果与逐个查询的结果一致
+TEST(road, get_waypoints_batch) {
+  for (const auto& file : util::OpenDrive::GetAvailableFiles()) {
+    auto m = OpenDriveParser::Load(util::OpenDrive::Load(file));
+    ASSERT_TRUE(m.has_value());
+    auto &map = *m;
+    std::vector<carla::geom::Location> locations;
+    for (auto i = 0u; i < 2'000u; ++i) {
+      locations.emplace_back(Random::Location(-500.0f, 500.0f));
+    }
+    carla::StopWatch stop_watch;
+    const auto projected = map.GetClosestWaypointsOnRoad(locations);
+    const auto exact = map.GetWaypoints(locations);
+    carla::logging::log(file, "batch done in", stop_watch.GetElapsedTime(), "ms.");
+    ASSERT_EQ(projected.size(), locations.size());
+    ASSERT_EQ(exact.size(), locations.size());
+    for (auto i = 0u; i < locations.size(); ++i) {
+      ASSERT_TRUE(projected[i] == map.GetClosestWaypointOnRoad(locations[i]));
+      ASSERT_TRUE(exact[i] == map.GetWaypoint(locations[i]));
+    }
+  }
+}
+
+// 螺旋线插值得到的位置与沿精确切线方向数值积分得到的位置一致
+TEST(road, spiral_pos_from_dist) {
+  using namespace carla::road::element;
+  constexpr double length = 50.0;
+  const std::pair<double, double> curvatures[] = {{0.0, 0.1}, {0.02, 0.1}, {-0.05, 0.03}};
+  for (const auto &curvature : curvatures) {
+    const double curve_start = curvature.first;
+    const double curve_end = curvature.second;
+    const GeometrySpiral spiral(0.0, length, 0.3, carla::geom::Location(10.0f, -5.0f, 0.0f), curve_start, curve_end);
+    constexpr size_t steps = 50'000u;
+    constexpr double ds = length / steps;
+    const double curve_dot = (curve_end - curve_start) / length;
+    double x = 10.0;
+    double y = -5.0;
+    for (auto i = 0u; i <= steps; ++i) {
+      const double dist = i * ds;
+      if (i % 1'000u == 0u) {
+        const auto p = spiral.PosFromDist(dist);
+        ASSERT_NEAR(p.location.x, x, 1e-3) << "curve_start " << curve_start;
+        ASSERT_NEAR(p.location.y, y, 1e-3) << "curve_start " << curve_start;
+        ASSERT_NEAR(p.tangent, 0.3 + curve_start * dist + 0.5 * curve_dot * dist * dist, 1e-9);
+      }
+      // 中点法沿切线方向积分
+      const double mid = dist + 0.5 * ds;
+      const double t = 0.3 + curve_start * mid + 0.5 * curve_dot * mid * mid;
+      x += ds * std::cos(t);
+      y += ds * std::sin(t);
+    }
+  }
+}
+
+// 长度为零的螺旋线退化为起点
+TEST(road, spiral_zero_length) {
+  using namespace carla::road::element;
+  const carla::geom::Location start(10.0f, -5.0f, 0.0f);
+  for (const double length : {0.0, 1e-9}) {
+    const GeometrySpiral spiral(0.0, length, 0.3, start, 0.02, 0.1);
+    for (const double dist : {0.0, 1.0}) {
+      const auto p = spiral.PosFromDist(dist);
+      ASSERT_FALSE(std::isnan(p.location.x));
+      ASSERT_NEAR(p.location.x, start.x, 1e-6);
+      ASSERT_NEAR(p.location.y, start.y, 1e-6);
+      ASSERT_NEAR(p.tangent, 0.3, 1e-9);
+    }
+  }
+}
+
+// 测量各个地图的加载时间（解析、构建以及R树），并检查多线程构建的结果是确定的
+TEST(road, benchmark_load) {
+  for (const auto& file : util::OpenDrive::GetAvailableFiles()) {
+    const auto xodr = util::OpenDrive::Load(file);
+    carla::StopWatch stop_watch;
+    auto m0 = OpenDriveParser::Load(xodr);
+    stop_watch.Stop();
+    ASSERT_TRUE(m0.has_value());
+    carla::logging::log(file, "loaded in", stop_watch.GetElapsedTime(), "ms.");
+    auto m1 = OpenDriveParser::Load(xodr);
+    ASSERT_TRUE(m1.has_value());
+    for (auto i = 0u; i < 500u; ++i) {
+      const auto location = Random::Location(-500.0f, 500.0f);
+      ASSERT_TRUE(m0->GetClosestWaypointOnRoad(location) == m1->GetClosestWaypointOnRoad(location));
+    }
+  }
+}
+
+// 内容相同的OpenDRIVE在进程内只解析一次，由所有客户端地图共享
+TEST(road, client_map_shares_parsed_map) {
+  for (const auto& file : util::OpenDrive::GetAvailableFiles()) {
+    const auto xodr = util::OpenDrive::Load(file);
+    auto map0 = std::make_shared<carla::client::Map>(file, xodr);
+    carla::StopWatch stop_watch;
+    auto map1 = std::make_shared<carla::client::Map>(file, xodr);
+    carla::logging::log(file, "second map created in", stop_watch.GetElapsedTime(), "ms.");
+    ASSERT_EQ(&map0->GetMap(), &map1->GetMap());
+  }
+}
+
+// 写入调用者缓冲区的 GetNext/GetPrevious 与返回新向量的版本结果一致
+TEST(road, get_next_into_buffer) {
+  for (const auto& file : util::OpenDrive::GetAvailableFiles()) {
+    auto m = OpenDriveParser::Load(util::OpenDrive::Load(file));
+    ASSERT_TRUE(m.has_value());
+    auto &map = *m;
+    std::vector<carla::road::element::Waypoint> buffer;
+    for (const auto &waypoint : map.GenerateWaypoints(5.0)) {
+      for (const double distance : {0.5, 10.0, 50.0}) {
+        map.GetNext(waypoint, distance, buffer);
+        ASSERT_TRUE(buffer == map.GetNext(waypoint, distance));
+        map.GetPrevious(waypoint, distance, buffer);
+        ASSERT_TRUE(buffer == map.GetPrevious(waypoint, distance));
+      }
+    }
+  }
+}
+
+// 路径规划器的路线从起点所在车道出发并到达终点所在车道
+TEST(road, route_planner) {
+  for (const auto& file : util::OpenDrive::GetAvailableFiles()) {
+    auto m = OpenDriveParser::Load(util::OpenDrive::Load(file));
+    ASSERT_TRUE(m.has_value());
+    auto &map = *m;
+    carla::road::RoutePlanner planner(map);
+    std::vector<std::pair<carla::geom::Location, carla::geom::Location>> queries;
+    for (auto i = 0u; i < 1'000u; ++i) {
+      queries.emplace_back(Random::Location(-200.0f, 200.0f), Random::Location(-200.0f, 200.0f));
+    }
+    carla::StopWatch stop_watch;
+    const auto routes = planner.ComputeRoutes(queries);
+    carla::logging::log(file, planner.GetNumberOfLanes(), "lanes,", queries.size(), "routes in", stop_watch.GetElapsedTime(), "ms.");
+    ASSERT_EQ(routes.size(), queries.size());
+    for (auto i = 0u; i < routes.size(); ++i) {
+      const auto &route = routes[i];
+      if (route.waypoints.empty()) {
+        continue;
+      }
+      ASSERT_GE(route.waypoints.size(), 2u);
+      ASSERT_GE(route.length, 0.0);
+      ASSERT_TRUE(route.waypoints.front() == *map.GetClosestWaypointOnRoad(queries[i].first));
+      ASSERT_TRUE(route.waypoints.back() == *map.GetClosestWaypointOnRoad(queries[i].second));
+    }
+  }
+}
+
+// 批量搜索信号的结果与逐个搜索相同，并且沿行驶方向按累计距离排列
+TEST(road, get_signals_in_distance) {
+  for (const auto& file : util::OpenDrive::GetAvailableFiles()) {
+    auto m = OpenDriveParser::Load(util::OpenDrive::Load(file));
+    ASSERT_TRUE(m.has_value());
+    auto &map = *m;
+    const auto waypoints = map.GenerateWaypoints(5.0);
+    const auto batch = map.GetSignalsInDistance(waypoints, 50.0);
+    ASSERT_EQ(batch.size(), waypoints.size());
+    for (auto i = 0u; i < waypoints.size(); ++i) {
+      const auto signals = map.GetSignalsInDistance(waypoints[i], 50.0);
+      ASSERT_EQ(batch[i].size(), signals.size());
+      for (auto j = 0u; j < signals.size(); ++j) {
+        ASSERT_EQ(batch[i][j].signal, signals[j].signal);
+        ASSERT_TRUE(batch[i][j].waypoint == signals[j].waypoint);
+        ASSERT_EQ(batch[i][j].accumulated_s, signals[j].accumulated_s);
+        ASSERT_GE(signals[j].accumulated_s, 0.0);
+        ASSERT_LE(signals[j].accumulated_s, 50.0 + 1e-6);
+      }
+    }
+  }
+}
+
+// 缓存车道的压线计算在路口外与逐次查找路点的结果一致
+TEST(road, lane_crossing_context) {
+  for (const auto& file : util::OpenDrive::GetAvailableFiles()) {
+    auto m = OpenDriveParser::Load(util::OpenDrive::Load(file));
+    ASSERT_TRUE(m.has_value());
+    auto &map = *m;
+    size_t crossings = 0u;
+    const auto waypoints = map.GenerateWaypoints(20.0);
+    for (const auto &start : waypoints) {
+      if (map.IsJunction(start.road_id)) {
+        continue;
+      }
+      LaneCrossingContext context;
+      Location previous;
+      auto waypoint = start;
+      // 沿车道前进，同时左右摆动，使包围盒的角反复跨越车道标记
+      for (auto step = 0u; step < 40u; ++step) {
+        const auto transform = map.ComputeTransform(waypoint);
+        const double offset = 0.8 * map.GetLaneWidth(waypoint) * std::sin(0.4 * step);
+        const Location location = transform.location + Location(static_cast<float>(offset) * transform.GetRightVector());
+        const auto lanes = LaneCrossingCalculator::Calculate(map, context, location);
+        if (step > 0u) {
+          const auto expected = LaneCrossingCalculator::Calculate(map, previous, location);
+          ASSERT_EQ(lanes.size(), expected.size());
+          for (auto i = 0u; i < lanes.size(); ++i) {
+            ASSERT_EQ(lanes[i].type, expected[i].type);
+          }
+          crossings += lanes.size();
+        }
+        previous = location;
+        const auto next = map.GetNext(waypoint, 1.0);
+        if (next.empty() || map.IsJunction(next.front().road_id)) {
+          break;
+        }
+        waypoint = next.front();
+      }
+    }
+    carla::logging::log(file, waypoints.size(), "trajectories,", crossings, "lane markings crossed.");
+  }
+}
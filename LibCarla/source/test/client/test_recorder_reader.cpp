@@ -0,0 +1,187 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/recorder/RecorderReader.h>
+
+#include <zlib.h>
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+using namespace carla::recorder;
+
+// 按录制文件的格式拼接数据
+class RecorderWriter {
+public:
+
+  template <typename T>
+  void Write(const T &value) {
+    const auto *begin = reinterpret_cast<const char *>(&value);
+    data.insert(data.end(), begin, begin + sizeof(T));
+  }
+
+  void WriteString(const std::string &value) {
+    Write(static_cast<uint16_t>(value.size()));
+    data.insert(data.end(), value.begin(), value.end());
+  }
+
+  // 数据包：id、大小、内容
+  void WritePacket(uint8_t id, const std::vector<char> &payload) {
+    Write(id);
+    Write(static_cast<uint32_t>(payload.size()));
+    data.insert(data.end(), payload.begin(), payload.end());
+  }
+
+  std::vector<char> data;
+};
+
+static std::vector<char> MakeRecording() {
+  RecorderWriter file;
+  file.Write(uint16_t(1u));
+  file.WriteString("CARLA_RECORDER");
+  file.Write(int64_t(0));
+  file.WriteString("Town01");
+
+  for (uint64_t frame = 1u; frame <= 3u; ++frame) {
+    RecorderWriter packet;
+    packet.Write(frame);
+    packet.Write(0.05);
+    packet.Write(0.05 * static_cast<double>(frame));
+    file.WritePacket(0u, packet.data);
+
+    if (frame == 1u) {
+      RecorderWriter add;
+      add.Write(uint16_t(1u));
+      add.Write(uint32_t(7u));
+      add.Write(uint8_t(1u));
+      const float transform[6] = {1.0f, 2.0f, 3.0f, 0.0f, 90.0f, 0.0f};
+      add.Write(transform);
+      add.Write(uint32_t(42u));
+      add.WriteString("vehicle.tesla.model3");
+      add.Write(uint16_t(1u));
+      add.Write(uint8_t(0u));
+      add.WriteString("role_name");
+      add.WriteString("hero");
+      file.WritePacket(2u, add.data);
+    }
+
+    RecorderWriter position;
+    position.Write(uint16_t(1u));
+    position.Write(uint32_t(7u));
+    const float transform[6] = {static_cast<float>(frame), 0.0f, 0.0f, 0.0f, 0.0f, 0.0f};
+    position.Write(transform);
+    file.WritePacket(6u, position.data);
+
+    if (frame == 2u) {
+      RecorderWriter collision;
+      collision.Write(uint16_t(1u));
+      collision.Write(uint32_t(0u));
+      collision.Write(uint32_t(7u));
+      collision.Write(uint32_t(-1));
+      collision.Write(uint8_t(1u));
+      collision.Write(uint8_t(0u));
+      file.WritePacket(5u, collision.data);
+    }
+
+    file.WritePacket(1u, {});
+  }
+  return file.data;
+}
+
+static void WriteFile(const std::string &filename, const std::vector<char> &data) {
+  std::ofstream file(filename, std::ios::binary);
+  file.write(data.data(), static_cast<std::streamsize>(data.size()));
+}
+
+static void CheckRecording(const RecorderData &data) {
+  ASSERT_EQ(data.map, "Town01");
+
+  const auto *frames = data.Find("frames");
+  ASSERT_NE(frames, nullptr);
+  ASSERT_EQ(frames->size(), 3u);
+  const auto *elapsed = frames->Find("elapsed");
+  ASSERT_NE(elapsed, nullptr);
+  ASSERT_DOUBLE_EQ(reinterpret_cast<const double *>(elapsed->data.data())[2], 0.15);
+
+  const auto *actors = data.Find("actors");
+  ASSERT_NE(actors, nullptr);
+  ASSERT_EQ(actors->size(), 1u);
+  ASSERT_EQ(data.actor_type_ids.size(), 1u);
+  ASSERT_EQ(data.actor_type_ids[0], "vehicle.tesla.model3");
+
+  const auto *positions = data.Find("positions");
+  ASSERT_NE(positions, nullptr);
+  ASSERT_EQ(positions->size(), 3u);
+  const auto *location = positions->Find("location");
+  ASSERT_NE(location, nullptr);
+  ASSERT_EQ(location->width, 3u);
+  ASSERT_FLOAT_EQ(reinterpret_cast<const float *>(location->data.data())[6], 3.0f);
+
+  const auto *collisions = data.Find("collisions");
+  ASSERT_NE(collisions, nullptr);
+  ASSERT_EQ(collisions->size(), 1u);
+  const auto *frame = collisions->Find("frame");
+  ASSERT_EQ(reinterpret_cast<const uint64_t *>(frame->data.data())[0], 2u);
+}
+
+TEST(recorder, read_plain_file) {
+  const std::string filename = "test_recorder_plain.log";
+  WriteFile(filename, MakeRecording());
+  const auto data = ReadRecorderFile(filename);
+  std::remove(filename.c_str());
+  ASSERT_FALSE(data.compressed);
+  CheckRecording(data);
+}
+
+TEST(recorder, read_compressed_file_without_block_table) {
+  const auto plain = MakeRecording();
+  std::vector<char> compressed(compressBound(static_cast<uLong>(plain.size())));
+  uLongf compressed_size = static_cast<uLongf>(compressed.size());
+  ASSERT_EQ(compress(
+      reinterpret_cast<Bytef *>(compressed.data()),
+      &compressed_size,
+      reinterpret_cast<const Bytef *>(plain.data()),
+      static_cast<uLong>(plain.size())), Z_OK);
+  compressed.resize(compressed_size);
+
+  // 只有一块且没有块表，相当于录制时崩溃留下的文件
+  RecorderWriter file;
+  file.data = {'C', 'A', 'R', 'L', 'A', 'Z', '0', '1'};
+  file.Write(static_cast<uint32_t>(plain.size()));
+  file.Write(static_cast<uint32_t>(compressed.size()));
+  file.Write(static_cast<uint32_t>(crc32(0u,
+      reinterpret_cast<const Bytef *>(compressed.data()),
+      static_cast<uInt>(compressed.size()))));
+  file.data.insert(file.data.end(), compressed.begin(), compressed.end());
+
+  const std::string filename = "test_recorder_compressed.log";
+  WriteFile(filename, file.data);
+  const auto data = ReadRecorderFile(filename);
+  std::remove(filename.c_str());
+  ASSERT_TRUE(data.compressed);
+  CheckRecording(data);
+}
+
+TEST(recorder, truncated_file) {
+  auto plain = MakeRecording();
+  // 去掉最后一个数据包的一部分
+  plain.resize(plain.size() - 3u);
+  const std::string filename = "test_recorder_truncated.log";
+  WriteFile(filename, plain);
+  const auto data = ReadRecorderFile(filename);
+  std::remove(filename.c_str());
+  ASSERT_EQ(data.Find("frames")->size(), 3u);
+}
+
+TEST(recorder, not_a_recorder_file) {
+  const std::string filename = "test_recorder_invalid.log";
+  WriteFile(filename, {'n', 'o', 't'});
+  ASSERT_THROW(ReadRecorderFile(filename), std::runtime_error);
+  std::remove(filename.c_str());
+}
@@ -80,3 +80,62 @@ TEST(rpc, server_bind_sync_run_on_game_thread) {
   // 断言任务已完成
   ASSERT_TRUE(done);
 }
+// 测试绑定函数能够知道客户端是否会忽略其返回值
+TEST(rpc, server_response_ignored) {
+  const uint16_t port = (TESTING_PORT != 0u ? TESTING_PORT : 2017u);
+  Server server(port);
+  std::atomic_int ignored_calls{0};
+  std::atomic_int answered_calls{0};
+  server.BindSync("record", [&]() {
+    ++(Server::IsResponseIgnored() ? ignored_calls : answered_calls);
+  });
+  server.AsyncRun(1u);
+  std::atomic_bool done{false};
+  carla::ThreadGroup threads;
+  threads.CreateThread([&]() {
+    Client client("localhost", port);
+    client.async_call("record");
+    client.call("record");
+    done = true;
+  });
+  for (auto i = 0u; (i < 1'000'000u) && !done; ++i) {
+    server.SyncRunFor(2ms);
+  }
+  // 异步调用在同步调用之前发出，此时已经执行
+  ASSERT_TRUE(done);
+  ASSERT_EQ(ignored_calls, 1);
+  ASSERT_EQ(answered_calls, 1);
+  ASSERT_FALSE(Server::IsResponseIgnored());
+}
+// 测试 SyncWaitFor 在没有请求时阻塞，在请求到达或被唤醒时返回
+TEST(rpc, server_sync_wait_for) {
+  const uint16_t port = (TESTING_PORT != 0u ? TESTING_PORT : 2017u);
+  Server server(port);
+  server.BindSync("do_the_thing", [](int x) { return x; });
+  server.AsyncRun(1u);
+
+  auto start = std::chrono::steady_clock::now();
+  server.SyncWaitFor(50ms);
+  ASSERT_GE(std::chrono::steady_clock::now() - start, 40ms);
+
+  carla::ThreadGroup threads;
+  threads.CreateThread([&]() {
+    std::this_thread::sleep_for(20ms);
+    server.SyncWake();
+  });
+  start = std::chrono::steady_clock::now();
+  server.SyncWaitFor(10s);
+  ASSERT_LT(std::chrono::steady_clock::now() - start, 5s);
+
+  std::atomic_bool done{false};
+  threads.CreateThread([&]() {
+    Client client("localhost", port);
+    EXPECT_EQ(client.call("do_the_thing", 42).as<int>(), 42);
+    done = true;
+  });
+  start = std::chrono::steady_clock::now();
+  while (!done && (std::chrono::steady_clock::now() - start < 10s)) {
+    server.SyncWaitFor(10s);
+  }
+  ASSERT_TRUE(done);
+}
@@ -0,0 +1,113 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/trafficmanager/SimpleWaypointPool.h>
+#include <carla/trafficmanager/WaypointBuffer.h>
+
+#include <stdexcept>
+
+using namespace carla::traffic_manager;
+
+static constexpr size_t CAPACITY = constants::PathBufferUpdate::WAYPOINT_BUFFER_CAPACITY;
+
+/// 缓冲区只比较指针，路径点本身不需要对应真实的道路。
+static std::vector<SimpleWaypoint *> MakeWaypoints(SimpleWaypointPool &pool, size_t count) {
+  std::vector<SimpleWaypoint *> result;
+  for (size_t i = 0u; i < count; ++i) {
+    result.push_back(pool.Create(nullptr).get());
+  }
+  return result;
+}
+
+static void CheckContents(const WaypointBuffer &buffer, const std::vector<SimpleWaypoint *> &expected) {
+  ASSERT_EQ(buffer.size(), expected.size());
+  for (size_t i = 0u; i < expected.size(); ++i) {
+    ASSERT_EQ(buffer.at(i), expected[i]) << "index " << i;
+  }
+  size_t i = 0u;
+  for (const SimpleWaypoint *waypoint : buffer) {
+    ASSERT_EQ(waypoint, expected[i++]);
+  }
+}
+
+TEST(waypoint_buffer, push_and_pop) {
+  auto pool = std::make_shared<SimpleWaypointPool>();
+  const auto waypoints = MakeWaypoints(*pool, 4u);
+
+  WaypointBuffer buffer;
+  ASSERT_TRUE(buffer.empty());
+  ASSERT_EQ(buffer.capacity(), 0u);
+
+  buffer.push_back(waypoints[1]);
+  buffer.push_back(waypoints[2]);
+  buffer.push_front(waypoints[0]);
+  buffer.push_back(waypoints[3]);
+  ASSERT_EQ(buffer.capacity(), CAPACITY);
+  CheckContents(buffer, waypoints);
+  ASSERT_EQ(buffer.front(), waypoints[0]);
+  ASSERT_EQ(buffer.back(), waypoints[3]);
+  ASSERT_THROW(buffer.at(4u), std::out_of_range);
+
+  buffer.pop_front();
+  buffer.pop_back();
+  CheckContents(buffer, {waypoints[1], waypoints[2]});
+
+  buffer.clear();
+  ASSERT_TRUE(buffer.empty());
+  ASSERT_EQ(buffer.capacity(), CAPACITY);
+  ASSERT_THROW(buffer.at(0u), std::out_of_range);
+}
+
+TEST(waypoint_buffer, wraparound) {
+  auto pool = std::make_shared<SimpleWaypointPool>();
+  const auto waypoints = MakeWaypoints(*pool, 3u * CAPACITY);
+
+  // 像车辆沿路行驶一样从尾部推入、从头部弹出，头部会多次绕过存储空间的末尾
+  WaypointBuffer buffer;
+  std::vector<SimpleWaypoint *> expected;
+  const size_t window = CAPACITY / 2u + 3u;
+  for (size_t i = 0u; i < waypoints.size(); ++i) {
+    buffer.push_back(waypoints[i]);
+    expected.push_back(waypoints[i]);
+    if (buffer.size() > window) {
+      buffer.pop_front();
+      expected.erase(expected.begin());
+    }
+    ASSERT_EQ(buffer.front(), expected.front());
+    ASSERT_EQ(buffer.back(), expected.back());
+  }
+  CheckContents(buffer, expected);
+  ASSERT_EQ(buffer.capacity(), CAPACITY);
+
+  // push_front 在下标0处回绕到存储空间的末尾
+  buffer.clear();
+  for (size_t i = 0u; i < CAPACITY; ++i) {
+    buffer.push_front(waypoints[CAPACITY - 1u - i]);
+  }
+  CheckContents(buffer, std::vector<SimpleWaypoint *>(waypoints.begin(), waypoints.begin() + CAPACITY));
+  ASSERT_EQ(buffer.capacity(), CAPACITY);
+}
+
+TEST(waypoint_buffer, grow_keeps_order) {
+  auto pool = std::make_shared<SimpleWaypointPool>();
+  const auto waypoints = MakeWaypoints(*pool, 2u * CAPACITY + 1u);
+
+  // 先让头部离开下标0，扩容时必须按逻辑顺序搬移元素
+  WaypointBuffer buffer;
+  for (size_t i = 0u; i < 10u; ++i) {
+    buffer.push_back(waypoints[0]);
+  }
+  for (size_t i = 0u; i < 10u; ++i) {
+    buffer.pop_front();
+  }
+  for (const auto waypoint : waypoints) {
+    buffer.push_back(waypoint);
+  }
+  ASSERT_EQ(buffer.capacity(), 4u * CAPACITY);
+  CheckContents(buffer, waypoints);
+}
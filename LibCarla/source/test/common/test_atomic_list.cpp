@@ -0,0 +1,87 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/AtomicList.h>
+#include <carla/EpochReclaimer.h>
+#include <carla/ThreadGroup.h>
+#include <carla/client/detail/CallbackList.h>
+
+#include <atomic>
+#include <memory>
+
+using carla::EpochReclaimer;
+using carla::client::detail::AtomicList;
+using carla::client::detail::CallbackList;
+
+TEST(atomic_list, modify) {
+  AtomicList<int> list;
+  list.Modify([](std::vector<int> &values) {
+    for (auto i = 0; i < 10; ++i) {
+      values.push_back(i);
+    }
+  });
+  list.DeleteByValue(3);
+  list.DeleteByIndex(0u);
+  int sum = 0;
+  list.ForEach([&](int value) { sum += value; });
+  ASSERT_EQ(sum, 45 - 3 - 0);
+  ASSERT_EQ(list.Load()->size(), 8u);
+  list.Clear();
+  ASSERT_TRUE(list.Load()->empty());
+}
+
+// 读者仍在临界区中时退休的对象不会被释放
+TEST(atomic_list, retired_objects_outlive_readers) {
+  auto released = std::make_shared<std::atomic<bool>>(false);
+  {
+    EpochReclaimer::Guard guard;
+    EpochReclaimer::Retire([released]() { *released = true; });
+    EpochReclaimer::Collect();
+    ASSERT_FALSE(released->load());
+  }
+  EpochReclaimer::Collect();
+  ASSERT_TRUE(released->load());
+}
+
+// 回调可以在调用过程中移除自己
+TEST(atomic_list, callback_removes_itself) {
+  CallbackList<int> callbacks;
+  int count = 0;
+  size_t id = 0u;
+  id = callbacks.Push([&](int value) {
+    count += value;
+    callbacks.Remove(id);
+  });
+  callbacks.Call(1);
+  callbacks.Call(1);
+  ASSERT_EQ(count, 1);
+}
+
+TEST(atomic_list, concurrent_readers_and_writers) {
+  AtomicList<std::shared_ptr<int>> list;
+  std::atomic<bool> done{false};
+  std::atomic<size_t> reads{0u};
+  carla::ThreadGroup readers;
+  readers.CreateThreads(4u, [&]() {
+    while (!done) {
+      list.ForEach([&](const std::shared_ptr<int> &value) {
+        ASSERT_EQ(*value, 42);
+        ++reads;
+      });
+    }
+  });
+  for (auto i = 0; i < 2000; ++i) {
+    list.Push(std::make_shared<int>(42));
+    if (i % 2 == 1) {
+      list.DeleteByIndex(0u);
+    }
+  }
+  done = true;
+  readers.JoinAll();
+  ASSERT_EQ(list.Load()->size(), 1000u);
+}
@@ -127,7 +127,8 @@ TEST(buffer, message_too_big) {
 #endif // LIBCARLA_NO_EXCEPTIONS
 // 测试缓冲区池
 TEST(buffer, buffer_pool) {
-  const std::string str = "Hello buffer!";
+  // 比 Buffer::INLINE_CAPACITY 长，缓冲区需要分配内存
+  const std::string str(Buffer::INLINE_CAPACITY + 1u, 'x');
   auto pool = std::make_shared<carla::BufferPool>();
   {
     auto buff = pool->Pop();
@@ -140,3 +141,54 @@ TEST(buffer, buffer_pool) {
   // 现在清空缓存池来测试缓存里面的弱引用
   pool.reset();
 }
+// 测试缓冲区池的大小类别和上限
+TEST(buffer, buffer_pool_size_classes) {
+  auto pool = std::make_shared<carla::BufferPool>();
+  pool->SetLimits(2u, 1u << 20u);
+  {
+    auto big = pool->Pop(1u << 18u);
+    big.reset(1u << 18u);
+    auto small = pool->Pop(512u);
+    small.reset(512u);
+  }
+  // 小数据不会取到大缓冲区
+  auto small = pool->Pop(512u);
+  ASSERT_LT(small.capacity(), 1u << 18u);
+  auto big = pool->Pop(1u << 18u);
+  ASSERT_GE(big.capacity(), 1u << 18u);
+  ASSERT_EQ(pool->GetStats().hits, 2u);
+  {
+    // 超出每个类别的上限的缓冲区直接释放
+    std::vector<carla::Buffer> buffers;
+    for (auto i = 0u; i < 4u; ++i) {
+      buffers.emplace_back(pool->Pop(4096u));
+      buffers.back().reset(4096u);
+    }
+  }
+  ASSERT_EQ(pool->GetStats().discarded, 2u);
+  // 两次整理之间一直空闲的缓冲区被释放
+  pool->Trim();
+  pool->Trim();
+  ASSERT_EQ(pool->GetStats().idle_buffers, 0u);
+  ASSERT_EQ(pool->GetStats().idle_bytes, 0u);
+}
+// 测试小数据存放在缓冲区内部
+TEST(buffer, inline_storage) {
+  const std::string str = "Hello buffer!";
+  auto pool = std::make_shared<carla::BufferPool>();
+  {
+    auto buffer = pool->Pop(str.size());
+    buffer.copy_from(str);
+    ASSERT_EQ(buffer.capacity(), Buffer::INLINE_CAPACITY);
+    Buffer moved(std::move(buffer));
+    ASSERT_TRUE(buffer.empty());
+    ASSERT_EQ(as_string(moved), str);
+    // 增长时保留原有的数据
+    moved.resize(Buffer::INLINE_CAPACITY + 1u);
+    ASSERT_GT(moved.capacity(), Buffer::INLINE_CAPACITY);
+    ASSERT_EQ(std::memcmp(moved.data(), str.data(), str.size()), 0);
+  }
+  auto stats = pool->GetStats();
+  ASSERT_EQ(stats.hits + stats.misses, 0u);
+  ASSERT_EQ(stats.idle_buffers, 0u);
+}
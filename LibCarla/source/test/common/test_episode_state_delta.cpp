@@ -0,0 +1,119 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/sensor/s11n/EpisodeStateDelta.h>
+
+#include <cstring>
+#include <vector>
+
+using namespace carla::sensor;
+using namespace carla::sensor::s11n::episode_state_delta;
+
+static data::ActorDynamicState MakeActor(carla::ActorId id, float x) {
+  data::ActorDynamicState actor;
+  std::memset(&actor, 0, sizeof(actor));
+  actor.id = id;
+  actor.actor_state = carla::rpc::ActorState::Active;
+  actor.transform = carla::geom::Transform{
+      carla::geom::Location{x, 2.0f, 0.5f},
+      carla::geom::Rotation{0.0f, 90.0f, 0.0f}};
+  actor.velocity = carla::geom::Vector3D{1.0f, 0.0f, 0.0f};
+  return actor;
+}
+
+static s11n::EpisodeStateSerializer::Header MakeHeader() {
+  s11n::EpisodeStateSerializer::Header header;
+  std::memset(&header, 0, sizeof(header));
+  header.episode_id = 42u;
+  return header;
+}
+
+// 关键帧与普通的剧集状态格式相同，之后的帧只含变化的参与者
+TEST(episode_state_delta, keyframe_and_delta) {
+  using SimulationState = s11n::EpisodeStateSerializer::SimulationState;
+  constexpr size_t header_size = sizeof(s11n::EpisodeStateSerializer::Header);
+  Encoder encoder(10u);
+  ASSERT_TRUE(encoder.IsEnabled());
+
+  std::vector<data::ActorDynamicState> actors{MakeActor(1u, 0.0f), MakeActor(2u, 10.0f), MakeActor(3u, 20.0f)};
+  carla::Buffer keyframe;
+  encoder.Encode(1u, MakeHeader(), actors, keyframe);
+  ASSERT_EQ(keyframe.size(), header_size + 3u * sizeof(data::ActorDynamicState));
+  s11n::EpisodeStateSerializer::Header header;
+  std::memcpy(&header, keyframe.data(), sizeof(header));
+  ASSERT_EQ(header.simulation_state & SimulationState::DeltaEncoded, 0);
+
+  // 参与者1移动，参与者2不变，参与者3被销毁，参与者4新出现
+  actors = {MakeActor(1u, 0.25f), MakeActor(2u, 10.0f), MakeActor(4u, 30.0f)};
+  carla::Buffer delta;
+  encoder.Encode(2u, MakeHeader(), actors, delta);
+  ASSERT_LT(delta.size(), keyframe.size());
+  std::memcpy(&header, delta.data(), sizeof(header));
+  ASSERT_NE(header.simulation_state & SimulationState::DeltaEncoded, 0);
+
+  uint64_t keyframe_number = 0u;
+  std::vector<carla::ActorId> removed;
+  std::vector<ChangedActor> changed;
+  ASSERT_TRUE(Decode(delta.data() + header_size, delta.data() + delta.size(), keyframe_number, removed, changed));
+  ASSERT_EQ(keyframe_number, 1u);
+  ASSERT_EQ(removed, std::vector<carla::ActorId>{3u});
+  ASSERT_EQ(changed.size(), 2u);
+  ASSERT_EQ(changed[0u].state.id, 1u);
+  ASSERT_FALSE(changed[0u].has_type_dependent_state);
+  ASSERT_NEAR(changed[0u].state.transform.location.x, 0.25f, 1e-3f);
+  ASSERT_NEAR(changed[0u].state.transform.rotation.yaw, 90.0f, 1e-2f);
+  ASSERT_EQ(changed[1u].state.id, 4u);
+  ASSERT_TRUE(changed[1u].has_type_dependent_state);
+
+  // 截断的数据不能被解析
+  ASSERT_FALSE(Decode(delta.data() + header_size, delta.data() + delta.size() - 1u, keyframe_number, removed, changed));
+}
+
+// 扩展数据紧跟在消息头之后，关键帧和增量帧都完整地包含扩展数据
+TEST(episode_state_delta, extensions) {
+  using Serializer = s11n::EpisodeStateSerializer;
+  constexpr size_t header_size = sizeof(Serializer::Header);
+  constexpr size_t extensions_size = sizeof(Serializer::ExtensionHeader) + sizeof(data::ActorExtensionState);
+  Encoder encoder(10u);
+
+  std::vector<data::ActorDynamicState> actors{MakeActor(1u, 0.0f), MakeActor(2u, 10.0f)};
+  data::ActorExtensionState extension;
+  std::memset(&extension, 0, sizeof(extension));
+  extension.id = 2u;
+  extension.vehicle_light_state = 0x3u;
+  extension.wheel_steer_angles[0u] = 15.0f;
+  std::vector<data::ActorExtensionState> extensions{extension};
+
+  for (uint64_t frame : {1u, 2u}) {
+    carla::Buffer buffer;
+    encoder.Encode(frame, MakeHeader(), actors, &extensions, buffer);
+    Serializer::Header header;
+    std::memcpy(&header, buffer.data(), sizeof(header));
+    ASSERT_NE(header.simulation_state & Serializer::HasExtensions, 0);
+    Serializer::ExtensionHeader extension_header;
+    std::memcpy(&extension_header, buffer.data() + header_size, sizeof(extension_header));
+    ASSERT_EQ(extension_header.count, 1u);
+    data::ActorExtensionState decoded;
+    std::memcpy(&decoded, buffer.data() + header_size + sizeof(extension_header), sizeof(decoded));
+    ASSERT_EQ(decoded.id, 2u);
+    ASSERT_EQ(decoded.vehicle_light_state, 0x3u);
+    ASSERT_EQ(decoded.wheel_steer_angles[0u], 15.0f);
+    if (frame == 1u) {
+      ASSERT_EQ(buffer.size(), header_size + extensions_size + 2u * sizeof(data::ActorDynamicState));
+    } else {
+      // 没有参与者变化的增量帧
+      uint64_t keyframe_number = 0u;
+      std::vector<carla::ActorId> removed;
+      std::vector<ChangedActor> changed;
+      const auto *body = buffer.data() + header_size + extensions_size;
+      ASSERT_TRUE(Decode(body, buffer.data() + buffer.size(), keyframe_number, removed, changed));
+      ASSERT_EQ(keyframe_number, 1u);
+      ASSERT_TRUE(changed.empty());
+    }
+  }
+}
@@ -10,7 +10,9 @@
 #include <carla/geom/Math.h>
 #include <carla/geom/BoundingBox.h>
 #include <carla/geom/Transform.h>
+#include <carla/geom/Mesh.h>
 #include <limits>
+#include <vector>
 // 定义一个名为carla的命名空间，用于组织相关的代码和类型
 namespace carla {
 // 在carla命名空间内部，再定义一个名为geom的子命名空间
@@ -162,6 +164,40 @@ TEST(geom, single_point_translation_and_rotation) {
   ASSERT_NEAR(point.z, result_point.z, error);  // 检查 z 坐标
 }
 
+// 批量变换与逐点变换的结果一致，stride 跳过每个点的其他字段
+TEST(geom, transform_points) {
+  const Transform transform(Location(10.0f, -3.0f, 2.5f), Rotation(12.0f, -73.0f, 31.0f));
+  std::vector<Vector3D> points;
+  std::vector<float> strided;
+  for (auto i = 0; i < 100; ++i) {
+    points.emplace_back(0.5f * i, 10.0f - i, 0.1f * i * i);
+    strided.insert(strided.end(), {points.back().x, points.back().y, points.back().z, 42.0f});
+  }
+  // 启用 FMA 收缩时结果可能有舍入误差
+  const auto check_near = [](const Vector3D &a, const Vector3D &b) {
+    ASSERT_NEAR(a.x, b.x, 1e-3);
+    ASSERT_NEAR(a.y, b.y, 1e-3);
+    ASSERT_NEAR(a.z, b.z, 1e-3);
+  };
+  auto transformed = points;
+  transform.TransformPoints(transformed.data(), transformed.size());
+  transform.TransformPoints(strided.data(), points.size(), 4u);
+  for (auto i = 0u; i < points.size(); ++i) {
+    auto expected = points[i];
+    transform.TransformPoint(expected);
+    check_near(transformed[i], expected);
+    check_near(Vector3D(strided[4u * i], strided[4u * i + 1u], strided[4u * i + 2u]), expected);
+    ASSERT_EQ(strided[4u * i + 3u], 42.0f);
+  }
+  transform.InverseTransformPoints(transformed.data(), transformed.size());
+  for (auto i = 0u; i < points.size(); ++i) {
+    auto expected = points[i];
+    transform.TransformPoint(expected);
+    transform.InverseTransformPoint(expected);
+    check_near(transformed[i], expected);
+  }
+}
+
 TEST(geom, distance) {
   // 定义一个常量 error，用于在断言中指定容忍的误差范围
   constexpr double error = .01;
@@ -349,3 +385,34 @@ TEST(geom, nearest_point_arc) {
       1.0f,  // 预期的距离值
       0.01f);  // 容忍的误差范围
 }
+
+// 测试顶点合并：20x20个各自独立的四边形合并后共享顶点，三角形数量和材质范围保持不变
+TEST(geom, mesh_weld_vertices) {
+  using namespace carla::geom;
+  Mesh mesh;
+  mesh.AddMaterial("road");
+  for (int x = 0; x < 20; ++x) {
+    for (int y = 0; y < 20; ++y) {
+      const float fx = static_cast<float>(x);
+      const float fy = static_cast<float>(y);
+      mesh.AddTriangleStrip({{fx, fy, 0.0f}, {fx + 1.0f, fy, 0.0f}, {fx, fy + 1.0f, 0.0f}, {fx + 1.0f, fy + 1.0f, 0.0f}});
+    }
+  }
+  mesh.EndMaterial();
+  const size_t index_count = mesh.GetIndexesNum();
+  ASSERT_EQ(mesh.WeldVertices(), 4u * 20u * 20u - 21u * 21u);
+  ASSERT_EQ(mesh.GetVerticesNum(), 21u * 21u);
+  mesh.OptimizeTriangleOrder();
+  mesh.OptimizeVertexOrder();
+  ASSERT_EQ(mesh.GetIndexesNum(), index_count);
+  ASSERT_EQ(mesh.GetMaterials().front().index_start, 0u);
+  ASSERT_EQ(mesh.GetMaterials().front().index_end, index_count);
+  ASSERT_TRUE(mesh.IsValid());
+
+  ASSERT_TRUE(mesh.FitsIn16BitIndexes());
+  const auto indexes = mesh.GetIndexes16();
+  ASSERT_EQ(indexes.size(), index_count);
+  for (size_t i = 0u; i < indexes.size(); ++i) {
+    ASSERT_EQ(static_cast<size_t>(indexes[i]) + 1u, mesh.GetIndexes()[i]);
+  }
+}
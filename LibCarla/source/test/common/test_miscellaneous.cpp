@@ -7,7 +7,29 @@
 #include "test.h"
 
 #include <carla/Version.h>
+#include <carla/sensor/s11n/OpticalFlowImageSerializer.h>
+
+#include <cstring>
 
 TEST(miscellaneous, version) {
   std::cout << "LibCarla " << carla::version() << std::endl;
 }
+
+// 半精度光流分量按与服务器端相同的公式解码
+TEST(miscellaneous, optical_flow_half_precision) {
+  using Serializer = carla::sensor::s11n::OpticalFlowImageSerializer;
+  // 0x3800 = 0.5，0x3C00 = 1.0，0x0000 = 0.0，0x3A00 = 0.75
+  const uint16_t halves[] = {0x3800u, 0x3C00u, 0x0000u, 0x3A00u};
+  unsigned char source[sizeof(halves) + 1u];
+  // 数据不需要对齐
+  std::memcpy(source + 1u, halves, sizeof(halves));
+  float flow[4u];
+  Serializer::DecodeHalfPrecision(source + 1u, 4u, flow);
+  ASSERT_EQ(flow[0u], 0.0f);
+  ASSERT_EQ(flow[1u], 2.0f);
+  ASSERT_EQ(flow[2u], -2.0f);
+  ASSERT_EQ(flow[3u], 1.0f);
+  Serializer::ImageHeader header{4u, 2u, 90.0f};
+  ASSERT_TRUE(Serializer::IsHalfPrecision(header, 4u * 2u * 4u));
+  ASSERT_FALSE(Serializer::IsHalfPrecision(header, 4u * 2u * 8u));
+}
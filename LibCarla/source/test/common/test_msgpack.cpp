@@ -5,9 +5,14 @@
 // For a copy, see <https://opensource.org/licenses/MIT>.
 // 引入测试所需的头文件
 #include "test.h"
+#include <carla/StopWatch.h>
 #include <carla/MsgPackAdaptors.h>
 #include <carla/rpc/Actor.h>
+#include <carla/rpc/ActorQuery.h>
+#include <carla/rpc/CachedContent.h>
+#include <carla/rpc/Command.h>
 #include <carla/rpc/Response.h>
+#include <carla/rpc/SecondaryTelemetry.h>
 // 引入线程相关的头文件，可能在测试中用于模拟并发场景
 #include <thread>
 // 使用 carla::rpc 命名空间
@@ -74,6 +79,108 @@ TEST(msgpack, actor) {
   ASSERT_EQ(result.description.id, actor.description.id);
   ASSERT_EQ(result.bounding_box, actor.bounding_box);
 }
+// 测试按列的参与者查询结果以整块数据序列化，反序列化后数据不变
+TEST(msgpack, actor_query) {
+  namespace c = carla;
+  ActorQueryResult query;
+  query.columns.emplace_back("id", 'u', 4u, 1u);
+  query.columns.emplace_back("velocity", 'f', 4u, 3u);
+  for (uint32_t id = 1u; id <= 3u; ++id) {
+    query.columns[0u].Append(id);
+    for (uint32_t i = 0u; i < 3u; ++i) {
+      query.columns[1u].Append(static_cast<float>(10u * id + i));
+    }
+  }
+  ASSERT_EQ(query.size(), 3u);
+  auto buffer = c::MsgPack::Pack(query);
+  // 数据列以bin类型传输，每个元素不再单独编码
+  ASSERT_LT(buffer.size(), 3u * (4u + 3u * 4u) + 64u);
+  auto result = c::MsgPack::UnPack<ActorQueryResult>(buffer);
+  ASSERT_EQ(result.size(), 3u);
+  ASSERT_EQ(result.Find("missing"), nullptr);
+  const auto *velocity = result.Find("velocity");
+  ASSERT_NE(velocity, nullptr);
+  ASSERT_EQ(velocity->kind, 'f');
+  ASSERT_EQ(velocity->width, 3u);
+  ASSERT_EQ(velocity->data, query.columns[1u].data);
+  const auto *values = reinterpret_cast<const float *>(velocity->data.data());
+  ASSERT_EQ(values[3u * 2u + 1u], 31.0f);
+}
+// 测试按哈希有条件获取的内容：哈希与内容对应，未变化时不携带内容
+TEST(msgpack, cached_content) {
+  namespace c = carla;
+  const std::vector<uint8_t> empty;
+  ASSERT_EQ(CachedContent::ComputeHash(empty), "cbf29ce484222325");
+  const std::vector<uint8_t> data = {'a'};
+  ASSERT_EQ(CachedContent::ComputeHash(data), "af63dc4c8601ec8c");
+  CachedContent cached;
+  cached.hash = CachedContent::ComputeHash(data);
+  cached.not_modified = true;
+  auto result = c::MsgPack::UnPack<CachedContent>(c::MsgPack::Pack(cached));
+  ASSERT_EQ(result.hash, cached.hash);
+  ASSERT_TRUE(result.not_modified);
+  ASSERT_TRUE(result.content.empty());
+}
+// 测试次级服务器耗时直方图的分桶、分位数和编解码
+TEST(msgpack, secondary_telemetry) {
+  namespace c = carla;
+  SecondaryTelemetry telemetry;
+  telemetry.address = "10.0.0.2:2002";
+  for (int i = 0; i < 98; ++i) {
+    telemetry.frame_latency.Add(3.0f);
+  }
+  telemetry.frame_latency.Add(100.0f);
+  telemetry.frame_latency.Add(5000.0f);
+  const auto &histogram = telemetry.frame_latency;
+  ASSERT_EQ(histogram.count, 100u);
+  ASSERT_EQ(histogram.counts.size(), size_t(LatencyHistogram::BUCKETS));
+  ASSERT_EQ(histogram.counts[4u], 98u);   // (2, 4] 毫秒
+  ASSERT_EQ(histogram.counts[9u], 1u);    // (64, 128] 毫秒
+  ASSERT_EQ(histogram.counts.back(), 1u); // 最后一个桶没有上界
+  ASSERT_FLOAT_EQ(histogram.GetPercentile(0.5f), 4.0f);
+  ASSERT_FLOAT_EQ(histogram.GetPercentile(0.99f), 128.0f);
+  ASSERT_FLOAT_EQ(histogram.GetPercentile(1.0f), 5000.0f);
+  ASSERT_FLOAT_EQ(histogram.GetMean(), (98.0f * 3.0f + 5100.0f) / 100.0f);
+  auto result = c::MsgPack::UnPack<SecondaryTelemetry>(c::MsgPack::Pack(telemetry));
+  ASSERT_EQ(result.address, telemetry.address);
+  ASSERT_EQ(result.frame_latency.counts, histogram.counts);
+  ASSERT_FLOAT_EQ(result.frame_latency.maximum, 5000.0f);
+  ASSERT_EQ(result.apply_time.count, 0u);
+  ASSERT_FLOAT_EQ(result.apply_time.GetPercentile(0.5f), 0.0f);
+}
+// 测试批量命令的编解码，解码时按索引只构造实际的命令类型
+TEST(msgpack, benchmark_command_batch) {
+  namespace c = carla;
+  constexpr size_t number_of_commands = 100000u;
+  std::vector<Command> batch;
+  batch.reserve(number_of_commands);
+  for (auto i = 0u; i < number_of_commands; ++i) {
+    VehicleControl control;
+    control.throttle = 0.5f;
+    control.steer = static_cast<float>(i % 100u) / 100.0f;
+    batch.emplace_back(Command::ApplyVehicleControl{i, control});
+  }
+  c::StopWatch stop_watch;
+  auto buffer = c::MsgPack::Pack(batch);
+  const auto pack_time = stop_watch.GetElapsedTime<std::chrono::microseconds>();
+  stop_watch.Restart();
+  auto result = c::MsgPack::UnPack<std::vector<Command>>(buffer);
+  const auto unpack_time = stop_watch.GetElapsedTime<std::chrono::microseconds>();
+  c::log_info(number_of_commands, "commands,", buffer.size(), "bytes: pack", pack_time, "us, unpack", unpack_time, "us");
+  ASSERT_EQ(result.size(), number_of_commands);
+  const auto *last = boost::variant2::get_if<Command::ApplyVehicleControl>(&result.back().command);
+  ASSERT_NE(last, nullptr);
+  ASSERT_EQ(last->actor, number_of_commands - 1u);
+  ASSERT_EQ(last->control.steer, 0.99f);
+  ASSERT_EQ(last->control.throttle, 0.5f);
+}
+// 测试变体的索引超出范围时抛出异常，而不是保持原来的值
+TEST(msgpack, variant_invalid_index) {
+  using mp = carla::MsgPack;
+  boost::variant2::variant<bool, float> var = true;
+  auto buffer = mp::Pack(std::make_tuple(uint64_t(2u), 1.0f));
+  ASSERT_THROW(var = mp::UnPack<decltype(var)>(buffer), clmdep_msgpack::type_error);
+}
 // 测试 MsgPack 对 boost::variant 的序列化和反序列化功能
 TEST(msgpack, variant) {
   using mp = carla::MsgPack;
@@ -11,8 +11,12 @@
 #include <carla/streaming/Client.h>
 // 包含Carla流媒体服务器相关的头文件，用于实现流媒体服务端的相关功能，比如接收客户端连接、发送数据等
 #include <carla/streaming/Server.h>
+// 包含Carla流媒体数据压缩相关的头文件，用于测试压缩和解压
+#include <carla/streaming/detail/Codec.h>
 // 包含Carla流媒体细节相关的调度器头文件，可能涉及到对流媒体数据分发、处理等底层逻辑的实现
 #include <carla/streaming/detail/Dispatcher.h>
+
+#include <carla/streaming/detail/Multicast.h>
 // 包含Carla流媒体基于TCP协议客户端相关的详细实现头文件，提供了具体的TCP客户端功能实现细节
 #include <carla/streaming/detail/tcp/Client.h>
 // 包含Carla流媒体基于TCP协议服务器相关的详细实现头文件，提供了具体的TCP服务器功能实现细节
@@ -22,7 +26,11 @@
 // 包含Carla流媒体底层服务器相关的头文件，涉及更底层的服务器功能实现，同样可能侧重于基础的协议处理等方面
 #include <carla/streaming/low_level/Server.h>
 
+#include <boost/asio/read.hpp>
+#include <boost/asio/write.hpp>
+
 #include <atomic>
+#include <cstring>
 // 使用 std::chrono_literals 命名空间，这样可以方便地使用时间字面量
 using namespace std::chrono_literals;
 
@@ -111,6 +119,197 @@ TEST(streaming, low_level_sending_strings) {
   io.service.stop();
 }
 // 定义一个测试用例，测试名称为"streaming"，测试子项名称为"low_level_unsubscribing"，用于测试底层流媒体客户端取消订阅的相关功能
+TEST(streaming, low_level_shared_memory) {
+  using namespace util::buffer;
+  using namespace carla::streaming;
+  using namespace carla::streaming::detail;
+  using namespace carla::streaming::low_level;
+
+  constexpr auto number_of_messages = 100u;
+  const std::string message_text = "Hello client!";
+
+  std::atomic_size_t message_count{0u};
+
+  io_context_running io;
+
+  carla::streaming::low_level::Server<tcp::Server> srv(io.service, TESTING_PORT);
+  srv.SetTimeout(1s);
+  // 容量很小，使环形缓冲区多次回绕
+  srv.EnableSharedMemory(64u);
+
+  auto stream = srv.MakeStream();
+  ASSERT_TRUE(token_type(stream.token()).protocol_is_shared_memory());
+
+  carla::streaming::low_level::Client<tcp::Client> c;
+  c.Subscribe(io.service, stream.token(), [&](auto message) {
+    ++message_count;
+    ASSERT_EQ(message.size(), message_text.size());
+    const std::string msg = as_string(message);
+    ASSERT_EQ(msg, message_text);
+  });
+
+  carla::Buffer Buf(boost::asio::buffer(message_text.c_str(), message_text.size()));
+  carla::SharedBufferView BufView = carla::BufferView::CreateFrom(std::move(Buf));
+  for (auto i = 0u; i < number_of_messages; ++i) {
+    std::this_thread::sleep_for(2ms);
+    carla::SharedBufferView View = BufView;
+    stream.Write(View);
+  }
+  std::this_thread::sleep_for(2ms);
+  ASSERT_GE(message_count, number_of_messages - 3u);
+
+  io.service.stop();
+}
+
+TEST(streaming, low_level_send_queue_synchronous) {
+  using namespace util::buffer;
+  using namespace carla::streaming;
+  using namespace carla::streaming::detail;
+  using namespace carla::streaming::low_level;
+
+  constexpr auto number_of_messages = 1000u;
+  const std::string message_text = "Hello client!";
+
+  std::atomic_size_t message_count{0u};
+
+  io_context_running io;
+
+  carla::streaming::low_level::Server<tcp::Server> srv(io.service, TESTING_PORT);
+  srv.SetTimeout(1s);
+  srv.SetSynchronousMode(true);
+  srv.SetSendQueue(4u, tcp::SendQueuePolicy::DropNewest, 0ms);
+
+  auto stream = srv.MakeStream();
+
+  carla::streaming::low_level::Client<tcp::Client> c;
+  c.Subscribe(io.service, stream.token(), [&](auto message) {
+    ++message_count;
+    ASSERT_EQ(as_string(message), message_text);
+  });
+  // 等待会话建立后再连续写入
+  std::this_thread::sleep_for(100ms);
+
+  carla::Buffer Buf(boost::asio::buffer(message_text.c_str(), message_text.size()));
+  carla::SharedBufferView BufView = carla::BufferView::CreateFrom(std::move(Buf));
+  for (auto i = 0u; i < number_of_messages; ++i) {
+    carla::SharedBufferView View = BufView;
+    stream.Write(View);
+  }
+  // 同步模式下队列满时等待而不丢弃
+  for (auto i = 0u; (i < 100u) && (message_count < number_of_messages); ++i) {
+    std::this_thread::sleep_for(10ms);
+  }
+  ASSERT_EQ(message_count, number_of_messages);
+
+  io.service.stop();
+}
+
+TEST(streaming, codec_round_trip) {
+  using namespace carla::streaming::detail;
+
+  // 大片重复的数据，类似语义分割图
+  carla::Buffer input;
+  input.reset(64u * 1024u);
+  for (auto i = 0u; i < input.size(); ++i) {
+    input.data()[i] = static_cast<unsigned char>((i / 1024u) % 7u);
+  }
+
+  carla::Buffer compressed;
+  ASSERT_TRUE(codec::Compress(StreamCodec::LZ, input, compressed));
+  ASSERT_LT(compressed.size(), input.size() / 10u);
+
+  carla::Buffer output;
+  ASSERT_TRUE(codec::Decompress(compressed, output));
+  ASSERT_EQ(output.size(), input.size());
+  ASSERT_EQ(std::memcmp(output.data(), input.data(), input.size()), 0);
+
+  // 截断的数据解压失败
+  carla::Buffer truncated(compressed.data(), compressed.size() / 2u);
+  ASSERT_FALSE(codec::Decompress(truncated, output));
+
+  // 声明的原数据大小远超压缩数据可能展开的大小时，不分配内存直接失败
+  carla::Buffer oversized(compressed.data(), compressed.size());
+  const uint32_t huge_size = 0xFFFFFFF0u;
+  std::memcpy(oversized.data() + 1u, &huge_size, sizeof(huge_size));
+  output.reset(16u);
+  ASSERT_FALSE(codec::Decompress(oversized, output));
+  ASSERT_EQ(output.size(), 16u);
+
+  // 损坏的数据不会越界，也不会被当作正确的数据
+  compressed.data()[compressed.size() / 2u] ^= 0x5Au;
+  const bool decompressed = codec::Decompress(compressed, output);
+  ASSERT_FALSE(decompressed && (output.size() == input.size()) &&
+               (std::memcmp(output.data(), input.data(), input.size()) == 0));
+}
+
+TEST(streaming, multicast_reassembly) {
+  using namespace carla::streaming::detail;
+
+  constexpr stream_id_type stream_id = 42u;
+  constexpr size_t fragment_size = 4u;
+  const std::string message_text = "Hello multicast client!";
+
+  auto make_datagram = [&](uint32_t sequence, uint32_t index, stream_id_type id) {
+    multicast::DatagramHeader header;
+    header.stream_id = id;
+    header.sequence = sequence;
+    header.message_header = static_cast<message_size_type>(message_text.size());
+    header.offset = static_cast<uint32_t>(index * fragment_size);
+    header.fragment_index = index;
+    header.fragment_count = static_cast<uint32_t>((message_text.size() + fragment_size - 1u) / fragment_size);
+    std::string datagram(reinterpret_cast<const char *>(&header), sizeof(header));
+    datagram += message_text.substr(header.offset, fragment_size);
+    return datagram;
+  };
+  auto push = [](multicast::Reassembler &reassembler, const std::string &datagram) {
+    return reassembler.Push(reinterpret_cast<const unsigned char *>(datagram.data()), datagram.size());
+  };
+
+  const uint32_t fragment_count = static_cast<uint32_t>((message_text.size() + fragment_size - 1u) / fragment_size);
+  multicast::Reassembler reassembler(stream_id, std::make_shared<carla::BufferPool>());
+
+  // 第一条消息缺少分片，被更新的消息取代
+  ASSERT_FALSE(push(reassembler, make_datagram(1u, 0u, stream_id)));
+  // 其他流的数据报被忽略
+  ASSERT_FALSE(push(reassembler, make_datagram(2u, 0u, stream_id + 1u)));
+
+  // 分片乱序且有重复
+  for (uint32_t i = fragment_count; i > 1u; --i) {
+    ASSERT_FALSE(push(reassembler, make_datagram(2u, i - 1u, stream_id)));
+    ASSERT_FALSE(push(reassembler, make_datagram(2u, i - 1u, stream_id)));
+  }
+  // 被取代的消息迟到的分片被忽略
+  ASSERT_FALSE(push(reassembler, make_datagram(1u, 1u, stream_id)));
+  ASSERT_TRUE(push(reassembler, make_datagram(2u, 0u, stream_id)));
+  ASSERT_FALSE(reassembler.is_compressed());
+  ASSERT_EQ(util::buffer::as_string(reassembler.pop()), message_text);
+
+  // 已收齐的消息重复的分片不会产生新消息
+  ASSERT_FALSE(push(reassembler, make_datagram(2u, 0u, stream_id)));
+
+  // 消息大小超过上限或与分片的数量、位置不一致的数据报被丢弃
+  auto forge = [&](uint32_t index, message_size_type size, uint32_t count) {
+    std::string datagram = make_datagram(3u, index, stream_id);
+    multicast::DatagramHeader header;
+    std::memcpy(&header, datagram.data(), sizeof(header));
+    header.message_header = size;
+    header.fragment_count = count;
+    std::memcpy(&datagram[0u], &header, sizeof(header));
+    return datagram;
+  };
+  const auto size = static_cast<message_size_type>(message_text.size());
+  ASSERT_FALSE(push(reassembler, forge(0u, (1u << 30) - 1u, fragment_count)));
+  ASSERT_FALSE(push(reassembler, forge(0u, static_cast<message_size_type>(multicast::MAX_MESSAGE_SIZE + 1u), 1u << 26)));
+  ASSERT_FALSE(push(reassembler, forge(0u, size, fragment_count + 1u)));
+  ASSERT_FALSE(push(reassembler, forge(fragment_count - 1u, size + 4u, fragment_count)));
+  // 被丢弃的数据报不影响之后的消息
+  for (uint32_t i = 0u; i + 1u < fragment_count; ++i) {
+    ASSERT_FALSE(push(reassembler, make_datagram(3u, i, stream_id)));
+  }
+  ASSERT_TRUE(push(reassembler, make_datagram(3u, fragment_count - 1u, stream_id)));
+  ASSERT_EQ(util::buffer::as_string(reassembler.pop()), message_text);
+}
+
 TEST(streaming, low_level_unsubscribing) {
       // 使用 util::buffer 命名空间，可能其中包含了与缓冲区操作相关的函数、类型等定义，具体取决于该命名空间的实际内容
   using namespace util::buffer;
@@ -188,6 +387,242 @@ TEST(streaming, low_level_unsubscribing) {
   io.service.stop();
 }
 
+// 多个流通过一个多路复用连接接收，取消订阅一个流不影响其他流
+TEST(streaming, low_level_multiplexed) {
+  using namespace util::buffer;
+  using namespace carla::streaming;
+  using namespace carla::streaming::detail;
+  using namespace carla::streaming::low_level;
+
+  constexpr auto number_of_streams = 4u;
+  constexpr auto number_of_messages = 50u;
+
+  io_context_running io;
+
+  carla::streaming::low_level::Server<tcp::Server> srv(io.service, TESTING_PORT);
+  srv.SetTimeout(1s);
+
+  std::vector<carla::streaming::Stream> streams;
+  std::vector<std::string> texts;
+  std::vector<carla::SharedBufferView> views;
+  auto message_counts = std::make_unique<std::atomic_size_t[]>(number_of_streams);
+  for (auto n = 0u; n < number_of_streams; ++n) {
+    streams.emplace_back(srv.MakeStream());
+    texts.emplace_back("Hello stream " + std::to_string(n) + "!");
+    carla::Buffer buffer(boost::asio::buffer(texts.back()));
+    views.emplace_back(carla::BufferView::CreateFrom(std::move(buffer)));
+    message_counts[n] = 0u;
+  }
+
+  carla::streaming::low_level::Client<tcp::Client> c;
+  c.SetMultiplexing(true);
+  for (auto n = 0u; n < number_of_streams; ++n) {
+    c.Subscribe(io.service, streams[n].token(), [&, n](auto message) {
+      ++message_counts[n];
+      ASSERT_EQ(as_string(message), texts[n]);
+    });
+  }
+
+  auto write_all = [&]() {
+    for (auto i = 0u; i < number_of_messages; ++i) {
+      std::this_thread::sleep_for(2ms);
+      for (auto n = 0u; n < number_of_streams; ++n) {
+        carla::SharedBufferView view = views[n];
+        streams[n].Write(view);
+      }
+    }
+    std::this_thread::sleep_for(20ms);
+  };
+
+  write_all();
+  for (auto n = 0u; n < number_of_streams; ++n) {
+    ASSERT_GE(message_counts[n], number_of_messages - 3u);
+  }
+
+  c.UnSubscribe(streams[0u].token());
+  std::this_thread::sleep_for(20ms);
+  const size_t unsubscribed_count = message_counts[0u];
+  for (auto n = 1u; n < number_of_streams; ++n) {
+    message_counts[n] = 0u;
+  }
+  write_all();
+  ASSERT_EQ(message_counts[0u], unsubscribed_count);
+  for (auto n = 1u; n < number_of_streams; ++n) {
+    ASSERT_GE(message_counts[n], number_of_messages - 3u);
+  }
+
+  io.service.stop();
+}
+
+TEST(streaming, low_level_multiplexed_credits) {
+  using namespace util::buffer;
+  using namespace carla::streaming;
+  using namespace carla::streaming::detail;
+  using namespace carla::streaming::low_level;
+
+  constexpr auto credits = 3u;
+
+  io_context_running io;
+
+  carla::streaming::low_level::Server<tcp::Server> srv(io.service, TESTING_PORT);
+  srv.SetTimeout(1s);
+
+  auto stream = srv.MakeStream();
+  const std::string text = "Hello credits!";
+  carla::Buffer buffer(boost::asio::buffer(text));
+  carla::SharedBufferView view = carla::BufferView::CreateFrom(std::move(buffer));
+
+  std::atomic_size_t message_count{0u};
+
+  carla::streaming::low_level::Client<tcp::Client> c;
+  c.SetMultiplexing(true);
+  c.Subscribe(io.service, stream.token(), [&](auto message) {
+    ++message_count;
+    ASSERT_EQ(as_string(message), text);
+  }, {}, credits);
+  std::this_thread::sleep_for(20ms);
+
+  auto write_some = [&]() {
+    for (auto i = 0u; i < 10u; ++i) {
+      carla::SharedBufferView message = view;
+      stream.Write(message);
+      std::this_thread::sleep_for(2ms);
+    }
+    std::this_thread::sleep_for(20ms);
+  };
+
+  // 没有归还信用时服务器只发送授予的消息数
+  write_some();
+  ASSERT_EQ(message_count, credits);
+
+  c.GrantCredits(token_type(stream.token()).get_stream_id(), credits);
+  std::this_thread::sleep_for(20ms);
+  write_some();
+  ASSERT_EQ(message_count, 2u * credits);
+
+  io.service.stop();
+}
+
+TEST(streaming, low_level_multiplexed_credits_after_drop) {
+  using namespace util::buffer;
+  using namespace carla::streaming;
+  using namespace carla::streaming::detail;
+  using namespace carla::streaming::low_level;
+
+  constexpr auto credits = 8u;
+
+  io_context_running io;
+
+  // 队列只能放一条消息，连续写入时后面的消息会被丢弃
+  carla::streaming::low_level::Server<tcp::Server> srv(io.service, TESTING_PORT);
+  srv.SetTimeout(1s);
+  srv.SetSendQueue(1u, tcp::SendQueuePolicy::DropNewest, 0ms);
+
+  auto stream = srv.MakeStream();
+  const std::string text = "Hello credits!";
+  carla::Buffer buffer(boost::asio::buffer(text));
+  carla::SharedBufferView view = carla::BufferView::CreateFrom(std::move(buffer));
+
+  std::atomic_size_t message_count{0u};
+
+  carla::streaming::low_level::Client<tcp::Client> c;
+  c.SetMultiplexing(true);
+  c.Subscribe(io.service, stream.token(), [&](auto message) {
+    ++message_count;
+    ASSERT_EQ(as_string(message), text);
+  }, {}, credits);
+  std::this_thread::sleep_for(20ms);
+
+  // 丢弃的消息归还信用，每个信用最终都对应一条收到的消息
+  auto write_until = [&](size_t expected) {
+    for (auto i = 0u; (i < 100u) && (message_count < expected); ++i) {
+      for (auto j = 0u; j < 20u; ++j) {
+        carla::SharedBufferView message = view;
+        stream.Write(message);
+      }
+      std::this_thread::sleep_for(10ms);
+    }
+    ASSERT_EQ(message_count, expected);
+  };
+
+  write_until(credits);
+  c.GrantCredits(token_type(stream.token()).get_stream_id(), credits);
+  std::this_thread::sleep_for(20ms);
+  write_until(2u * credits);
+
+  io.service.stop();
+}
+
+// 不支持多路复用的服务器关闭连接后，流改用单独的连接接收数据
+TEST(streaming, low_level_multiplexed_fallback) {
+  using namespace util::buffer;
+  using namespace carla::streaming;
+  using namespace carla::streaming::detail;
+  using socket_type = boost::asio::ip::tcp::socket;
+
+  constexpr auto number_of_messages = 5u;
+  const std::string text = "Hola!";
+
+  io_context_running io;
+
+  // 像旧版本的服务器一样，把多路复用请求当作未知的流ID并关闭连接
+  boost::asio::io_context raw_io;
+  boost::asio::ip::tcp::acceptor acceptor(raw_io, boost::asio::ip::tcp::endpoint(boost::asio::ip::tcp::v4(), TESTING_PORT));
+  acceptor.non_blocking(true);
+  auto accept = [&](socket_type &socket) {
+    const auto deadline = std::chrono::steady_clock::now() + 2s;
+    while (std::chrono::steady_clock::now() < deadline) {
+      boost::system::error_code ec;
+      acceptor.accept(socket, ec);
+      if (!ec) {
+        socket.non_blocking(false);
+        return true;
+      }
+      std::this_thread::sleep_for(1ms);
+    }
+    return false;
+  };
+  std::atomic_bool refused{false};
+  std::thread server([&]() {
+    for (auto connection = 0; connection < 2; ++connection) {
+      socket_type socket(raw_io);
+      if (!accept(socket)) {
+        return;
+      }
+      stream_id_type word = 0u;
+      boost::asio::read(socket, boost::asio::buffer(&word, sizeof(word)));
+      if ((word & tcp::multiplex::REQUEST_FLAG) != 0u) {
+        refused = true;
+        continue;
+      }
+      const message_size_type size = static_cast<message_size_type>(text.size());
+      for (auto i = 0u; i < number_of_messages; ++i) {
+        boost::asio::write(socket, boost::asio::buffer(&size, sizeof(size)));
+        boost::asio::write(socket, boost::asio::buffer(text));
+      }
+      std::this_thread::sleep_for(100ms);
+    }
+  });
+
+  Dispatcher dispatcher{make_endpoint<tcp::Client::protocol_type>(acceptor.local_endpoint())};
+  auto stream = dispatcher.MakeStream();
+
+  std::atomic_size_t message_count{0u};
+  {
+    carla::streaming::low_level::Client<tcp::Client> c;
+    c.SetMultiplexing(true);
+    c.Subscribe(io.service, stream.token(), [&](auto message) {
+      ++message_count;
+      ASSERT_EQ(as_string(message), text);
+    });
+    server.join();
+  }
+  ASSERT_TRUE(refused);
+  ASSERT_EQ(message_count, number_of_messages);
+
+  io.service.stop();
+}
+
 // 这是一个测试用例，测试低级别TCP小消息流
 TEST(streaming, low_level_tcp_small_message) {
   using namespace carla::streaming;
@@ -197,7 +632,7 @@ TEST(streaming, low_level_tcp_small_message) {
   tcp::Server::endpoint ep(boost::asio::ip::tcp::v4(), TESTING_PORT);
 
   tcp::Server srv(io_context, ep);
-    / 设置服务器超时时间
+    // 设置服务器超时时间
   srv.SetTimeout(1s);
     // 初始化一个原子布尔变量，表示任务是否完成
   std::atomic_bool done{false};
@@ -309,6 +744,64 @@ TEST(streaming, stream_outlives_server) {
   done = true;
 } // stream dies here.
 
+// 测试一个流的回调很慢时不会延迟其他流，且每个流的回调保持顺序
+TEST(streaming, callback_executor) {
+  using namespace carla::streaming;
+  using namespace util::buffer;
+  constexpr size_t number_of_messages = 20u;
+
+  Server srv(TESTING_PORT);
+  srv.AsyncRun(2u);
+  auto slow_stream = srv.MakeStream();
+  auto fast_stream = srv.MakeStream();
+
+  Client c;
+  // 只有一个网络线程，回调直接在其上执行时快的流也要等待慢的回调
+  c.SetCallbackExecutor(2u);
+  c.AsyncRun(1u);
+
+  std::atomic_size_t slow_received{0u};
+  std::atomic_size_t fast_received{0u};
+  std::atomic_bool slow_in_order{true};
+  std::atomic_bool fast_in_order{true};
+  c.Subscribe(slow_stream.token(), [&](auto buffer) {
+    if (as_string(buffer) != std::to_string(slow_received)) {
+      slow_in_order = false;
+    }
+    std::this_thread::sleep_for(20ms);
+    ++slow_received;
+  });
+  c.Subscribe(fast_stream.token(), [&](auto buffer) {
+    if (as_string(buffer) != std::to_string(fast_received)) {
+      fast_in_order = false;
+    }
+    ++fast_received;
+  });
+
+  std::this_thread::sleep_for(20ms);
+  for (auto i = 0u; i < number_of_messages; ++i) {
+    const std::string message = std::to_string(i);
+    slow_stream.Write(carla::BufferView::CreateFrom(carla::Buffer(boost::asio::buffer(message))));
+    fast_stream.Write(carla::BufferView::CreateFrom(carla::Buffer(boost::asio::buffer(message))));
+    std::this_thread::sleep_for(2ms);
+  }
+  std::this_thread::sleep_for(20ms);
+
+  // 慢的回调共需 400ms，此时快的流应已全部收到
+  ASSERT_EQ(fast_received, number_of_messages);
+  ASSERT_LT(slow_received, number_of_messages);
+  ASSERT_GT(c.GetCallbackStats(slow_stream.token()).max_pending, 1u);
+  ASSERT_EQ(c.GetCallbackStats(fast_stream.token()).dropped, 0u);
+
+  for (auto i = 0u; i < 100u && slow_received < number_of_messages; ++i) {
+    std::this_thread::sleep_for(20ms);
+  }
+  ASSERT_EQ(slow_received, number_of_messages);
+  ASSERT_TRUE(slow_in_order);
+  ASSERT_TRUE(fast_in_order);
+  ASSERT_EQ(c.GetCallbackStats(slow_stream.token()).delivered, number_of_messages);
+}
+
 // 测试多个客户端订阅同一个流的情况
 TEST(streaming, multi_stream) {
   using namespace carla::streaming;// 使用carla流命名空间。
@@ -0,0 +1,124 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/ParallelFor.h>
+#include <carla/TaskScheduler.h>
+
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+using carla::TaskGraph;
+using carla::TaskGroup;
+using carla::TaskScheduler;
+
+// 每个索引恰好被处理一次
+TEST(task_scheduler, parallel_for_covers_range) {
+  TaskScheduler scheduler(3u);
+  for (size_t size : {0u, 1u, 7u, 1000u, 100'003u}) {
+    std::vector<std::atomic<int>> counts(size);
+    scheduler.ParallelFor(size, [&](size_t index) { ++counts[index]; });
+    for (auto &count : counts) {
+      ASSERT_EQ(count.load(), 1);
+    }
+  }
+}
+
+// 嵌套调用在所有工作线程都在等待时也能完成
+TEST(task_scheduler, nested_parallel_for) {
+  TaskScheduler scheduler(2u);
+  std::atomic<size_t> total{0u};
+  scheduler.ParallelFor(64u, [&](size_t) {
+    scheduler.ParallelFor(1'000u, [&](size_t) { ++total; });
+  });
+  ASSERT_EQ(total.load(), 64'000u);
+
+  total = 0u;
+  carla::ParallelForChunks(10'000u, [&](size_t begin, size_t end) {
+    carla::ParallelForChunks(end - begin, [&](size_t b, size_t e) { total += e - b; }, 1u);
+  }, 16u);
+  ASSERT_EQ(total.load(), 10'000u);
+}
+
+TEST(task_scheduler, parallel_for_rethrows) {
+  TaskScheduler scheduler(3u);
+  std::atomic<size_t> processed{0u};
+  ASSERT_THROW(
+      scheduler.ParallelForChunks(1'000u, [&](size_t begin, size_t end) {
+        processed += end - begin;
+        if (begin == 0u) {
+          throw std::runtime_error("failure");
+        }
+      }),
+      std::runtime_error);
+  // 其他块仍然执行完毕
+  ASSERT_EQ(processed.load(), 1'000u);
+}
+
+TEST(task_scheduler, task_group) {
+  TaskScheduler scheduler(3u);
+  std::atomic<int> count{0};
+  TaskGroup group(scheduler);
+  for (auto i = 0; i < 100; ++i) {
+    group.Run([&]() {
+      ++count;
+      // 任务可以向组中加入新任务
+      group.Run([&]() { ++count; });
+    });
+  }
+  group.Wait();
+  ASSERT_EQ(count.load(), 200);
+
+  group.Run([]() { throw std::runtime_error("failure"); });
+  ASSERT_THROW(group.Wait(), std::runtime_error);
+}
+
+// 没有工作线程时所有任务在调用线程中执行
+TEST(task_scheduler, without_workers) {
+  TaskScheduler scheduler(0u);
+  std::vector<int> values(100u, 0);
+  scheduler.ParallelFor(values.size(), [&](size_t index) { values[index] = static_cast<int>(index); });
+  for (auto i = 0u; i < values.size(); ++i) {
+    ASSERT_EQ(values[i], static_cast<int>(i));
+  }
+  TaskGroup group(scheduler);
+  int count = 0;
+  group.Run([&]() { ++count; });
+  group.Wait();
+  ASSERT_EQ(count, 1);
+}
+
+TEST(task_scheduler, task_graph_order) {
+  TaskScheduler scheduler(3u);
+  std::atomic<int> step{0};
+  std::vector<int> order(4u, -1);
+  TaskGraph graph;
+  // a -> (b, c) -> d
+  const auto a = graph.Add([&]() { order[0u] = step++; });
+  const auto b = graph.Add([&]() { order[1u] = step++; });
+  const auto c = graph.Add([&]() { order[2u] = step++; });
+  const auto d = graph.Add([&]() { order[3u] = step++; });
+  graph.Precede(a, b);
+  graph.Precede(a, c);
+  graph.Precede(b, d);
+  graph.Precede(c, d);
+  for (auto run = 0; run < 10; ++run) {
+    step = 0;
+    graph.Run(scheduler);
+    ASSERT_EQ(order[0u], 0);
+    ASSERT_EQ(order[3u], 3);
+    ASSERT_NE(order[1u], order[2u]);
+  }
+
+  TaskGraph cycle;
+  const auto x = cycle.Add([]() {});
+  const auto y = cycle.Add([]() {});
+  cycle.Precede(x, y);
+  cycle.Precede(y, x);
+  ASSERT_THROW(cycle.Run(scheduler), std::logic_error);
+}
@@ -59,7 +59,8 @@ static void AddActorForce(carla::client::Actor &self,
 
 // 获取与交通灯关联的组交通灯
 static auto GetGroupTrafficLights(carla::client::TrafficLight &self) {
-    auto values = self.GetGroupTrafficLights(); // 获取组交通灯
+    auto call = CALL_WITHOUT_GIL(carla::client::TrafficLight, GetGroupTrafficLights);
+    auto values = call(self); // 获取组交通灯
     return StdVectorToPyList(values); // 转换并返回为Python列表
 }
 
@@ -71,8 +72,9 @@ static void ApplyControl(carla::client::Walker &self, const ControlT &control) {
 
 // 获取交通灯的光源盒
 static auto GetLightBoxes(const carla::client::TrafficLight &self) {
+    auto call = CONST_CALL_WITHOUT_GIL(carla::client::TrafficLight, GetLightBoxes);
     boost::python::list result; // 创建一个新的Python列表用于结果
-    for (const auto &bb : self.GetLightBoxes()) { // 遍历每个边界框
+    for (const auto &bb : call(self)) { // 遍历每个边界框
         result.append(bb); // 将边界框添加到结果列表中
     }
     return result; // 返回填充好的光源盒列表
@@ -125,16 +127,16 @@ void export_actor() {
       .def("get_velocity", &cc::Actor::GetVelocity)
       .def("get_angular_velocity", &cc::Actor::GetAngularVelocity)
       .def("get_acceleration", &cc::Actor::GetAcceleration)
-      .def("get_component_world_transform", &cc::Actor::GetComponentWorldTransform, (arg("component_name")))
-      .def("get_component_relative_transform", &cc::Actor::GetComponentRelativeTransform, (arg("component_name")))
+      .def("get_component_world_transform", WITHOUT_GIL(&cc::Actor::GetComponentWorldTransform), (arg("component_name")))
+      .def("get_component_relative_transform", WITHOUT_GIL(&cc::Actor::GetComponentRelativeTransform), (arg("component_name")))
       // 将返回值转换为Python列表的const请求
-      .def("get_bone_world_transforms", CALL_RETURNING_LIST(cc::Actor,GetBoneWorldTransforms))
-      .def("get_bone_relative_transforms", CALL_RETURNING_LIST(cc::Actor,GetBoneRelativeTransforms))
-      .def("get_component_names", CALL_RETURNING_LIST(cc::Actor,GetComponentNames))
-      .def("get_bone_names", CALL_RETURNING_LIST(cc::Actor,GetBoneNames))
-      .def("get_socket_world_transforms", CALL_RETURNING_LIST(cc::Actor,GetSocketWorldTransforms))
-      .def("get_socket_relative_transforms", CALL_RETURNING_LIST(cc::Actor,GetSocketRelativeTransforms))   
-      .def("get_socket_names", CALL_RETURNING_LIST(cc::Actor,GetSocketNames))         
+      .def("get_bone_world_transforms", CALL_RETURNING_LIST_WITHOUT_GIL(cc::Actor, GetBoneWorldTransforms))
+      .def("get_bone_relative_transforms", CALL_RETURNING_LIST_WITHOUT_GIL(cc::Actor, GetBoneRelativeTransforms))
+      .def("get_component_names", CALL_RETURNING_LIST_WITHOUT_GIL(cc::Actor, GetComponentNames))
+      .def("get_bone_names", CALL_RETURNING_LIST_WITHOUT_GIL(cc::Actor, GetBoneNames))
+      .def("get_socket_world_transforms", CALL_RETURNING_LIST_WITHOUT_GIL(cc::Actor, GetSocketWorldTransforms))
+      .def("get_socket_relative_transforms", CALL_RETURNING_LIST_WITHOUT_GIL(cc::Actor, GetSocketRelativeTransforms))   
+      .def("get_socket_names", CALL_RETURNING_LIST_WITHOUT_GIL(cc::Actor, GetSocketNames))         
       .def("set_location", &cc::Actor::SetLocation, (arg("location")))
       // 将参与者传送到给定的变换（位置和旋转）
       .def("set_transform", &cc::Actor::SetTransform, (arg("transform")))
@@ -146,8 +148,8 @@ void export_actor() {
       .def("add_force", &AddActorForce, (arg("force")))
       .def("add_angular_impulse", &cc::Actor::AddAngularImpulse, (arg("angular_impulse")))
       .def("add_torque", &cc::Actor::AddTorque, (arg("torque")))
-      .def("set_simulate_physics", &cc::Actor::SetSimulatePhysics, (arg("enabled") = true))
-      .def("set_collisions", &cc::Actor::SetCollisions, (arg("enabled") = true))
+      .def("set_simulate_physics", WITHOUT_GIL(&cc::Actor::SetSimulatePhysics), (arg("enabled") = true))
+      .def("set_collisions", WITHOUT_GIL(&cc::Actor::SetCollisions), (arg("enabled") = true))
       .def("set_enable_gravity", &cc::Actor::SetEnableGravity, (arg("enabled") = true))
       .def("destroy", CALL_WITHOUT_GIL(cc::Actor, Destroy))
       .def(self_ns::str(self_ns::self))
@@ -207,7 +209,7 @@ void export_actor() {
       .def("open_door", &cc::Vehicle::OpenDoor, (arg("door_idx")))
       .def("close_door", &cc::Vehicle::CloseDoor, (arg("door_idx")))
       .def("set_wheel_steer_direction", &cc::Vehicle::SetWheelSteerDirection, (arg("wheel_location")), (arg("angle_in_deg")))
-      .def("get_wheel_steer_angle", &cc::Vehicle::GetWheelSteerAngle, (arg("wheel_location")))
+      .def("get_wheel_steer_angle", WITHOUT_GIL(&cc::Vehicle::GetWheelSteerAngle), (arg("wheel_location")))
       .def("get_light_state", CONST_CALL_WITHOUT_GIL(cc::Vehicle, GetLightState))
       .def("apply_physics_control", &cc::Vehicle::ApplyPhysicsControl, (arg("physics_control")))
       .def("get_physics_control", CONST_CALL_WITHOUT_GIL(cc::Vehicle, GetPhysicsControl))
@@ -232,7 +234,7 @@ void export_actor() {
     class_<cc::Walker, bases<cc::Actor>, boost::noncopyable, boost::shared_ptr<cc::Walker>>("Walker", no_init)
       .def("apply_control", &ApplyControl<cr::WalkerControl>, (arg("control")))
       .def("get_control", &cc::Walker::GetWalkerControl)
-      .def("get_bones", &cc::Walker::GetBonesTransform)
+      .def("get_bones", WITHOUT_GIL(&cc::Walker::GetBonesTransform))
       .def("set_bones", &cc::Walker::SetBonesTransform, (arg("bones")))
       .def("blend_pose", &cc::Walker::BlendPose, (arg("blend")))
       .def("show_pose", &cc::Walker::ShowPose)
@@ -243,10 +245,10 @@ void export_actor() {
 
     // 定义WalkerAIController类到Python的映射，继承自Actor类，设置相关特性，定义多个该类特有的方法的Python接口
     class_<cc::WalkerAIController, bases<cc::Actor>, boost::noncopyable, boost::shared_ptr<cc::WalkerAIController>>("WalkerAIController", no_init)
-    .def("start", &cc::WalkerAIController::Start)
-    .def("stop", &cc::WalkerAIController::Stop)
-    .def("go_to_location", &cc::WalkerAIController::GoToLocation, (arg("destination")))
-    .def("set_max_speed", &cc::WalkerAIController::SetMaxSpeed, (arg("speed")))
+    .def("start", WITHOUT_GIL(&cc::WalkerAIController::Start))
+    .def("stop", WITHOUT_GIL(&cc::WalkerAIController::Stop))
+    .def("go_to_location", WITHOUT_GIL(&cc::WalkerAIController::GoToLocation), (arg("destination")))
+    .def("set_max_speed", WITHOUT_GIL(&cc::WalkerAIController::SetMaxSpeed), (arg("speed")))
     .def(self_ns::str(self_ns::self))
   ;
 
@@ -303,13 +305,13 @@ class_<cc::TrafficLight, bases<cc::TrafficSign>, boost::noncopyable, boost::shar
       // 定义一个名为"reset_group"的函数，用于重置交通信号灯所在的组（可能将同组信号灯恢复到初始设置等操作），由cc::TrafficLight::ResetGroup函数实现
      .def("reset_group", &cc::TrafficLight::ResetGroup)
       // 定义一个名为"get_affected_lane_waypoints"的函数，用于获取受当前交通信号灯影响的车道上的路点列表，以列表形式返回，通过调用cc::TrafficLight::GetAffectedLaneWaypoints函数实现
-     .def("get_affected_lane_waypoints", CALL_RETURNING_LIST(cc::TrafficLight, GetAffectedLaneWaypoints))
+     .def("get_affected_lane_waypoints", CALL_RETURNING_LIST_WITHOUT_GIL(cc::TrafficLight, GetAffectedLaneWaypoints))
       // 定义一个名为"get_light_boxes"的函数，用于获取交通信号灯的灯箱相关信息（具体信息由GetLightBoxes函数定义）
      .def("get_light_boxes", &GetLightBoxes)
       // 定义一个名为"get_opendrive_id"的函数，用于获取交通信号灯对应的OpenDRIVE中的标识ID，由cc::TrafficLight::GetOpenDRIVEID函数实现
      .def("get_opendrive_id", &cc::TrafficLight::GetOpenDRIVEID)
       // 定义一个名为"get_stop_waypoints"的函数，用于获取需要在当前交通信号灯前停车的路点列表，以列表形式返回，通过调用cc::TrafficLight::GetStopWaypoints函数实现
-     .def("get_stop_waypoints", CALL_RETURNING_LIST(cc::TrafficLight, GetStopWaypoints))
+     .def("get_stop_waypoints", CALL_RETURNING_LIST_WITHOUT_GIL(cc::TrafficLight, GetStopWaypoints))
       // 定义一个用于将交通信号灯对象转换为字符串表示的函数，具体转换逻辑由对应的self_ns::str函数决定（可能用于输出调试等用途）
      .def(self_ns::str(self_ns::self))
   ;
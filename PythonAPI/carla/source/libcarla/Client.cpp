@@ -6,9 +6,13 @@
 #include "carla/client/Client.h"// 引入Client头文件，定义与CARLA服务器交互的客户端功能
 #include "carla/client/World.h"// 引入World头文件，定义操作CARLA世界的接口
 #include "carla/Logging.h"// 引入Logging头文件，用于日志记录
+#include "carla/NonCopyable.h"
 #include "carla/rpc/ActorId.h"// 引入ActorId头文件，定义与CARLA中Actor相关的ID操作
 #include "carla/trafficmanager/TrafficManager.h"// 引入TrafficManager头文件，用于管理和控制交通
 
+#include <cstring>
+#include <initializer_list>
+#include <string>
 #include <thread> // 引入thread头文件，用于多线程处理
 
 #include <boost/python/stl_iterator.hpp>// 引入boost::python::stl_iterator头文件，用于Python与C++ STL容器的交互
@@ -40,9 +44,63 @@ static auto GetAvailableMaps(const carla::client::Client &self) {
 }
 //该静态函数用于获取客户端可用的地图列表。首先创建一个boost::python::list类型的对象result用于存储最终要返回给 Python 的结果，以及一个std::vector<std::string>类型的maps用于临时存储从客户端获取到的地图名称字符串向量。
 //在获取地图名称列表时，先通过carla::PythonUtil::ReleaseGIL释放全局解释器锁（GIL），这是为了在执行可能耗时的self.GetAvailableMaps()操作时，允许其他 Python 线程继续执行，避免阻塞整个 Python 解释器。然后将获取到的地图名称逐个添加到result列表中，最后返回这个列表，以便在 Python 环境中可以方便地访问可用地图的名称。
+static auto GetSecondaryTelemetry(const carla::client::Client &self) {
+  boost::python::list result;
+  std::vector<carla::rpc::SecondaryTelemetry> telemetry;
+  {
+    carla::PythonUtil::ReleaseGIL unlock;
+    telemetry = self.GetSecondaryTelemetry();
+  }
+  for (const auto &item : telemetry) {
+    result.append(item);
+  }
+  return result;
+}
+
+static auto GetLatencyHistogramBounds(const carla::rpc::LatencyHistogram &) {
+  boost::python::list result;
+  for (size_t i = 0u; i + 1u < carla::rpc::LatencyHistogram::BUCKETS; ++i) {
+    result.append(carla::rpc::LatencyHistogram::GetUpperBound(i));
+  }
+  return result;
+}
+
+static auto GetLatencyHistogramCounts(const carla::rpc::LatencyHistogram &self) {
+  boost::python::list result;
+  for (size_t i = 0u; i < carla::rpc::LatencyHistogram::BUCKETS; ++i) {
+    result.append(i < self.counts.size() ? self.counts[i] : 0u);
+  }
+  return result;
+}
+
+static auto SpawnBatchCommands(
+    const carla::client::Client &self,
+    const boost::python::object &commands,
+    double time_budget) {
+  using CommandType = carla::rpc::Command;
+  std::vector<CommandType> cmds{
+    boost::python::stl_input_iterator<CommandType>(commands),
+        boost::python::stl_input_iterator<CommandType>()};
+  carla::PythonUtil::ReleaseGIL unlock;
+  return self.SpawnBatch(std::move(cmds), time_budget);
+}
+
+static auto GetSpawnBatchResponses(const carla::rpc::SpawnBatchStatus &self) {
+  boost::python::list result;
+  for (const auto &response : self.responses) {
+    result.append(response);
+  }
+  return result;
+}
+
 static auto GetRequiredFiles(const carla::client::Client &self, const std::string &folder, const bool download) {
   boost::python::list result;
-  for (const auto &str : self.GetRequiredFiles(folder, download)) {
+  std::vector<std::string> files;
+  {
+    carla::PythonUtil::ReleaseGIL unlock;
+    files = self.GetRequiredFiles(folder, download);
+  }
+  for (const auto &str : files) {
     result.append(str);
   }
   return result;
@@ -79,7 +137,11 @@ static auto ApplyBatchCommandsSync(
   boost::python::list result;
    // 调用 Carla 客户端的 ApplyBatchSync 方法，同步应用命令批次
   // 如果 do_tick 为 true，则在应用命令后模拟器会前进一个时间步
-  auto responses = self.ApplyBatchSync(cmds, do_tick);
+  std::vector<carla::rpc::CommandResponse> responses;
+  {
+    carla::PythonUtil::ReleaseGIL unlock;
+    responses = self.ApplyBatchSync(cmds, do_tick);
+  }
   // 遍历从 ApplyBatchSync 得到的所有响应，并将它们添加到 Python 列表中
   for (auto &response : responses) {
     result.append(std::move(response));
@@ -162,16 +224,20 @@ static auto ApplyBatchCommandsSync(
 
   std::vector<std::thread*> t(num_batches+1);
 
-  for(size_t n = 0; n < num_batches; n++) {
-    t[n] = new std::thread(ProcessCommand, n * TaskLimit, (n+1) * TaskLimit);
-  }
-  t[num_batches] = new std::thread(ProcessCommand, num_batches * TaskLimit, num_commands);
+  {
+    // 查询参与者需要等待服务器，等待期间释放 GIL
+    carla::PythonUtil::ReleaseGIL unlock;
+    for(size_t n = 0; n < num_batches; n++) {
+      t[n] = new std::thread(ProcessCommand, n * TaskLimit, (n+1) * TaskLimit);
+    }
+    t[num_batches] = new std::thread(ProcessCommand, num_batches * TaskLimit, num_commands);
 
-  for(size_t n = 0; n <= num_batches; n++) {
-    if(t[n]->joinable()){
-      t[n]->join();
+    for(size_t n = 0; n <= num_batches; n++) {
+      if(t[n]->joinable()){
+        t[n]->join();
+      }
+      delete t[n];
     }
-    delete t[n];
   }
 
   // 固定向量大小
@@ -190,6 +256,7 @@ static auto ApplyBatchCommandsSync(
 
   // 检查是否发送了任何 Autopilot 命令
   if (sorted_vehicle_to_enable.size() || sorted_vehicle_to_disable.size()) {
+    carla::PythonUtil::ReleaseGIL unlock;
     self.GetInstanceTM(tm_port).RegisterVehicles(sorted_vehicle_to_enable);
     self.GetInstanceTM(tm_port).UnregisterVehicles(sorted_vehicle_to_disable);
   }
@@ -206,6 +273,286 @@ static auto ApplyBatchCommandsSync(
 为了并行处理这些命令检查，将命令分成多个批次，每个批次最多处理TaskLimit个命令，创建相应数量的线程来并行执行ProcessCommand函数处理每个批次的命令。
 在所有线程执行完毕后，根据实际添加到vehicles_to_enable和vehicles_to_disable向量中的元素数量调整向量大小，并进行内存释放操作（通过shrink_to_fit）。
 最后，对要启用和禁用自动驾驶的车辆指针向量进行排序，确保按照演员 ID 从小到大的顺序排列，然后如果这两个向量中有元素，就通过客户端获取交通管理器实例，并分别注册要启用自动驾驶的车辆和注销要禁用自动驾驶的车辆。*/
+// 批量命令的数组参数：numpy 数组等支持缓冲区协议的对象按行读取，支持任意步长
+// 和常见的整数、浮点、布尔类型；Python 数值作为所有行共用的值；None 时使用默认值。
+class CommandArrayArgument : private carla::NonCopyable {
+public:
+
+  CommandArrayArgument(const boost::python::object &object, const char *name, size_t columns = 1u)
+    : _name(name) {
+    namespace py = boost::python;
+    if (object.is_none()) {
+      return;
+    }
+    if (PyObject_GetBuffer(object.ptr(), &_view, PyBUF_STRIDES | PyBUF_FORMAT) != 0) {
+      PyErr_Clear();
+      py::extract<double> scalar(object);
+      if (columns != 1u || !scalar.check()) {
+        Throw(PyExc_TypeError, columns == 1u ?
+            " must be a number or an array of shape (N,)" :
+            " must be an array of shape (N, " + std::to_string(columns) + ")");
+      }
+      _scalar = scalar();
+      _has_scalar = true;
+      return;
+    }
+    _has_buffer = true;
+    const bool has_shape = (columns == 1u) ?
+        (_view.ndim == 1) :
+        (_view.ndim == 2 && static_cast<size_t>(_view.shape[1]) == columns);
+    if (!has_shape) {
+      Release();
+      Throw(PyExc_ValueError, columns == 1u ?
+          " must be an array of shape (N,)" :
+          " must be an array of shape (N, " + std::to_string(columns) + ")");
+    }
+    std::string format = _view.format != nullptr ? _view.format : "B";
+    if (!format.empty() && (format[0u] == '@' || format[0u] == '=' || format[0u] == '<')) {
+      format.erase(0u, 1u);
+    }
+    if (format.size() != 1u || std::string("?bBhHiIlLqQfd").find(format[0u]) == std::string::npos) {
+      Release();
+      Throw(PyExc_ValueError, " must have a numeric type in native byte order");
+    }
+    _format = format[0u];
+  }
+
+  ~CommandArrayArgument() {
+    Release();
+  }
+
+  bool IsArray() const {
+    return _has_buffer;
+  }
+
+  size_t GetSize() const {
+    return _has_buffer ? static_cast<size_t>(_view.shape[0]) : 0u;
+  }
+
+  /// 数组和 @a size 行数不同时抛出 ValueError。
+  void CheckSize(size_t size) const {
+    if (_has_buffer && GetSize() != size) {
+      Throw(PyExc_ValueError, " must have as many rows as actor_ids");
+    }
+  }
+
+  /// 不需要 GIL，可以在释放 GIL 之后调用。
+  double Get(size_t row, size_t column = 0u, double default_value = 0.0) const {
+    if (!_has_buffer) {
+      return _has_scalar ? _scalar : default_value;
+    }
+    const char *item = static_cast<const char *>(_view.buf) + row * _view.strides[0];
+    if (_view.ndim == 2) {
+      item += column * _view.strides[1];
+    }
+    switch (_format) {
+      case '?': return Read<bool>(item);
+      case 'b': return Read<signed char>(item);
+      case 'B': return Read<unsigned char>(item);
+      case 'h': return Read<short>(item);
+      case 'H': return Read<unsigned short>(item);
+      case 'i': return Read<int>(item);
+      case 'I': return Read<unsigned int>(item);
+      case 'l': return Read<long>(item);
+      case 'L': return Read<unsigned long>(item);
+      case 'q': return Read<long long>(item);
+      case 'Q': return Read<unsigned long long>(item);
+      case 'f': return Read<float>(item);
+      default:  return Read<double>(item);
+    }
+  }
+
+private:
+
+  template <typename T>
+  static double Read(const char *item) {
+    T value;
+    std::memcpy(&value, item, sizeof(T));
+    return static_cast<double>(value);
+  }
+
+  void Release() {
+    if (_has_buffer) {
+      PyBuffer_Release(&_view);
+      _has_buffer = false;
+    }
+  }
+
+  void Throw(PyObject *type, const std::string &message) const {
+    PyErr_SetString(type, (_name + message).c_str());
+    boost::python::throw_error_already_set();
+  }
+
+  const std::string _name;
+
+  Py_buffer _view;
+
+  bool _has_buffer = false;
+
+  bool _has_scalar = false;
+
+  double _scalar = 0.0;
+
+  char _format = 'd';
+};
+
+// 由数组构建每个参与者的命令并一次发送，不需要为每辆车创建 Python 命令对象
+template <typename MakeCommandT>
+static void ApplyCommandArrays(
+    const carla::client::Client &self,
+    const CommandArrayArgument &actor_ids,
+    std::initializer_list<const CommandArrayArgument *> arguments,
+    bool do_tick,
+    MakeCommandT &&make_command) {
+  if (!actor_ids.IsArray()) {
+    PyErr_SetString(PyExc_TypeError, "actor_ids must be an array of shape (N,)");
+    boost::python::throw_error_already_set();
+  }
+  const size_t size = actor_ids.GetSize();
+  for (const auto *argument : arguments) {
+    argument->CheckSize(size);
+  }
+  carla::PythonUtil::ReleaseGIL unlock;
+  std::vector<carla::rpc::Command> commands;
+  commands.reserve(size);
+  for (size_t i = 0u; i < size; ++i) {
+    const auto id = static_cast<carla::rpc::ActorId>(actor_ids.Get(i));
+    commands.emplace_back(make_command(id, i));
+  }
+  self.ApplyBatch(std::move(commands), do_tick);
+}
+
+static void ApplyVehicleControls(
+    const carla::client::Client &self,
+    const boost::python::object &py_actor_ids,
+    const boost::python::object &py_throttle,
+    const boost::python::object &py_steer,
+    const boost::python::object &py_brake,
+    const boost::python::object &py_hand_brake,
+    const boost::python::object &py_reverse,
+    const boost::python::object &py_manual_gear_shift,
+    const boost::python::object &py_gear,
+    bool do_tick) {
+  const CommandArrayArgument actor_ids(py_actor_ids, "actor_ids");
+  const CommandArrayArgument throttle(py_throttle, "throttle");
+  const CommandArrayArgument steer(py_steer, "steer");
+  const CommandArrayArgument brake(py_brake, "brake");
+  const CommandArrayArgument hand_brake(py_hand_brake, "hand_brake");
+  const CommandArrayArgument reverse(py_reverse, "reverse");
+  const CommandArrayArgument manual_gear_shift(py_manual_gear_shift, "manual_gear_shift");
+  const CommandArrayArgument gear(py_gear, "gear");
+  ApplyCommandArrays(self, actor_ids,
+      {&throttle, &steer, &brake, &hand_brake, &reverse, &manual_gear_shift, &gear},
+      do_tick,
+      [&](carla::rpc::ActorId id, size_t i) {
+        carla::rpc::VehicleControl control;
+        control.throttle = static_cast<float>(throttle.Get(i, 0u, control.throttle));
+        control.steer = static_cast<float>(steer.Get(i, 0u, control.steer));
+        control.brake = static_cast<float>(brake.Get(i, 0u, control.brake));
+        control.hand_brake = hand_brake.Get(i, 0u, control.hand_brake) != 0.0;
+        control.reverse = reverse.Get(i, 0u, control.reverse) != 0.0;
+        control.manual_gear_shift = manual_gear_shift.Get(i, 0u, control.manual_gear_shift) != 0.0;
+        control.gear = static_cast<int32_t>(gear.Get(i, 0u, control.gear));
+        return carla::rpc::Command::ApplyVehicleControl{id, control};
+      });
+}
+
+static void ApplyTransforms(
+    const carla::client::Client &self,
+    const boost::python::object &py_actor_ids,
+    const boost::python::object &py_locations,
+    const boost::python::object &py_rotations,
+    bool do_tick) {
+  const CommandArrayArgument actor_ids(py_actor_ids, "actor_ids");
+  const CommandArrayArgument locations(py_locations, "locations", 3u);
+  const CommandArrayArgument rotations(py_rotations, "rotations", 3u);
+  if (!locations.IsArray()) {
+    PyErr_SetString(PyExc_TypeError, "locations must be an array of shape (N, 3)");
+    boost::python::throw_error_already_set();
+  }
+  ApplyCommandArrays(self, actor_ids, {&locations, &rotations}, do_tick,
+      [&](carla::rpc::ActorId id, size_t i) {
+        const carla::geom::Location location(
+            static_cast<float>(locations.Get(i, 0u)),
+            static_cast<float>(locations.Get(i, 1u)),
+            static_cast<float>(locations.Get(i, 2u)));
+        // 旋转的列依次为 pitch、yaw、roll
+        const carla::geom::Rotation rotation(
+            static_cast<float>(rotations.Get(i, 0u)),
+            static_cast<float>(rotations.Get(i, 1u)),
+            static_cast<float>(rotations.Get(i, 2u)));
+        return carla::rpc::Command::ApplyTransform{id, carla::geom::Transform(location, rotation)};
+      });
+}
+
+static void ApplyTargetVelocities(
+    const carla::client::Client &self,
+    const boost::python::object &py_actor_ids,
+    const boost::python::object &py_velocities,
+    bool do_tick) {
+  const CommandArrayArgument actor_ids(py_actor_ids, "actor_ids");
+  const CommandArrayArgument velocities(py_velocities, "velocities", 3u);
+  if (!velocities.IsArray()) {
+    PyErr_SetString(PyExc_TypeError, "velocities must be an array of shape (N, 3)");
+    boost::python::throw_error_already_set();
+  }
+  ApplyCommandArrays(self, actor_ids, {&velocities}, do_tick,
+      [&](carla::rpc::ActorId id, size_t i) {
+        const carla::geom::Vector3D velocity(
+            static_cast<float>(velocities.Get(i, 0u)),
+            static_cast<float>(velocities.Get(i, 1u)),
+            static_cast<float>(velocities.Get(i, 2u)));
+        return carla::rpc::Command::ApplyTargetVelocity{id, velocity};
+      });
+}
+
+// 开始录制，filter为None时录制所有参与者和数据包
+static std::string StartRecorder(
+    carla::client::Client &self,
+    const std::string &name,
+    bool additional_data,
+    const boost::python::object &filter) {
+  if (filter.is_none()) {
+    carla::PythonUtil::ReleaseGIL unlock;
+    return self.StartRecorder(name, additional_data);
+  }
+  const carla::rpc::RecorderFilter recorder_filter =
+      boost::python::extract<carla::rpc::RecorderFilter>(filter);
+  carla::PythonUtil::ReleaseGIL unlock;
+  return self.StartRecorder(name, additional_data, recorder_filter);
+}
+
+// 开始录制到流，callback 按顺序收到录制文件的内容（bytes）
+static void StartRecorderStream(
+    carla::client::Client &self,
+    boost::python::object callback,
+    bool additional_data,
+    const boost::python::object &filter) {
+  namespace py = boost::python;
+  if (!PyCallable_Check(callback.ptr())) {
+    PyErr_SetString(PyExc_TypeError, "callback argument must be callable!");
+    py::throw_error_already_set();
+  }
+  const carla::rpc::RecorderFilter recorder_filter = filter.is_none() ?
+      carla::rpc::RecorderFilter() :
+      py::extract<carla::rpc::RecorderFilter>(filter)();
+  // 需要在持有GIL的同时删除回调
+  using Deleter = carla::PythonUtil::AcquireGILDeleter;
+  auto callback_ptr = carla::SharedPtr<py::object>{new py::object(callback), Deleter()};
+  carla::PythonUtil::ReleaseGIL unlock;
+  self.StartRecorderStream([callback=std::move(callback_ptr)](carla::Buffer message) {
+    carla::PythonUtil::AcquireGIL lock;
+    try {
+      py::object data{py::handle<>(PyBytes_FromStringAndSize(
+          reinterpret_cast<const char *>(message.data()),
+          static_cast<Py_ssize_t>(message.size())))};
+      py::call<void>(callback->ptr(), data);
+    } catch (const py::error_already_set &) {
+      PyErr_Print();
+    }
+  }, additional_data, recorder_filter);
+}
+
 void export_client() {
   using namespace boost::python;
   namespace cc = carla::client;
@@ -222,34 +569,85 @@ void export_client() {
     .def_readwrite("enable_pedestrian_navigation", &rpc::OpendriveGenerationParameters::enable_pedestrian_navigation)
   ;
 
+  class_<rpc::LatencyHistogram>("LatencyHistogram", no_init)
+    .add_property("bounds", &GetLatencyHistogramBounds)
+    .add_property("counts", &GetLatencyHistogramCounts)
+    .def_readonly("count", &rpc::LatencyHistogram::count)
+    .def_readonly("max", &rpc::LatencyHistogram::maximum)
+    .def_readonly("last", &rpc::LatencyHistogram::last)
+    .add_property("mean", &rpc::LatencyHistogram::GetMean)
+    .def("percentile", &rpc::LatencyHistogram::GetPercentile, (arg("fraction")))
+  ;
+
+  class_<rpc::SecondaryTelemetry>("SecondaryTelemetry", no_init)
+    .def_readonly("address", &rpc::SecondaryTelemetry::address)
+    .def_readonly("last_frame", &rpc::SecondaryTelemetry::last_frame)
+    .def_readonly("frames_behind", &rpc::SecondaryTelemetry::frames_behind)
+    .def_readonly("apply_time", &rpc::SecondaryTelemetry::apply_time)
+    .def_readonly("render_time", &rpc::SecondaryTelemetry::render_time)
+    .def_readonly("frame_latency", &rpc::SecondaryTelemetry::frame_latency)
+    .def_readonly("network_latency", &rpc::SecondaryTelemetry::network_latency)
+  ;
+
+  class_<rpc::ServerProfile>("ServerProfile", no_init)
+    .def_readonly("frames", &rpc::ServerProfile::frames)
+    .def_readonly("batch_commands", &rpc::ServerProfile::batch_commands)
+    .def_readonly("max_batch_commands_per_frame", &rpc::ServerProfile::max_batch_commands_per_frame)
+    .def_readonly("frame_time", &rpc::ServerProfile::frame_time)
+    .def_readonly("tick_wait", &rpc::ServerProfile::tick_wait)
+    .def_readonly("rpc", &rpc::ServerProfile::rpc)
+    .def_readonly("world_tick", &rpc::ServerProfile::world_tick)
+    .def_readonly("recorder", &rpc::ServerProfile::recorder)
+    .def_readonly("broadcast", &rpc::ServerProfile::broadcast)
+    .def_readonly("sensors", &rpc::ServerProfile::sensors)
+  ;
+
+  class_<rpc::SpawnBatchStatus>("SpawnBatchStatus", no_init)
+    .def_readonly("done", &rpc::SpawnBatchStatus::done)
+    .def_readonly("processed", &rpc::SpawnBatchStatus::processed)
+    .def_readonly("total", &rpc::SpawnBatchStatus::total)
+    .add_property("responses", &GetSpawnBatchResponses)
+  ;
+
   class_<cc::Client>("Client",
       init<std::string, uint16_t, size_t>((arg("host")="127.0.0.1", arg("port")=2000, arg("worker_threads")=0u)))
     .def("set_timeout", &::SetTimeout, (arg("seconds")))
+    .def("set_sensor_credits", &cc::Client::SetSensorCredits, (arg("credits")))
+    .def("set_sensor_multiplexing", &cc::Client::SetSensorMultiplexing, (arg("enable")))
     .def("get_client_version", &cc::Client::GetClientVersion)
     .def("get_server_version", CONST_CALL_WITHOUT_GIL(cc::Client, GetServerVersion))
     .def("get_world", &cc::Client::GetWorld)
     .def("get_available_maps", &GetAvailableMaps)
+    .def("get_secondary_telemetry", &GetSecondaryTelemetry)
     .def("set_files_base_folder", &cc::Client::SetFilesBaseFolder, (arg("path")))
     .def("get_required_files", &GetRequiredFiles, (arg("folder")="", arg("download")=true))
-    .def("request_file", &cc::Client::RequestFile, (arg("name")))
+    .def("request_file", WITHOUT_GIL(&cc::Client::RequestFile), (arg("name")))
     .def("reload_world", CONST_CALL_WITHOUT_GIL_1(cc::Client, ReloadWorld, bool), (arg("reset_settings")=true))
     .def("load_world", CONST_CALL_WITHOUT_GIL_3(cc::Client, LoadWorld, std::string, bool, rpc::MapLayer), (arg("map_name"), arg("reset_settings")=true, arg("map_layers")=rpc::MapLayer::All))
-    .def("load_world_if_different", &cc::Client::LoadWorldIfDifferent, (arg("map_name"), arg("reset_settings")=true, arg("map_layers")=rpc::MapLayer::All))
+    .def("preload_map", CONST_CALL_WITHOUT_GIL_1(cc::Client, PreloadMap, std::string), (arg("map_name")))
+    .def("load_world_if_different", WITHOUT_GIL(&cc::Client::LoadWorldIfDifferent), (arg("map_name"), arg("reset_settings")=true, arg("map_layers")=rpc::MapLayer::All))
     .def("generate_opendrive_world", CONST_CALL_WITHOUT_GIL_3(cc::Client, GenerateOpenDriveWorld, std::string,
         rpc::OpendriveGenerationParameters, bool), (arg("opendrive"), arg("parameters")=rpc::OpendriveGenerationParameters(),
         arg("reset_settings")=true))
-    .def("start_recorder", CALL_WITHOUT_GIL_2(cc::Client, StartRecorder, std::string, bool), (arg("name"), arg("additional_data")=false))
+    .def("start_recorder", &StartRecorder, (arg("name"), arg("additional_data")=false, arg("filter")=object()))
+    .def("start_recorder_stream", &StartRecorderStream, (arg("callback"), arg("additional_data")=false, arg("filter")=object()))
     .def("stop_recorder", &cc::Client::StopRecorder)
     .def("show_recorder_file_info", CALL_WITHOUT_GIL_2(cc::Client, ShowRecorderFileInfo, std::string, bool), (arg("name"), arg("show_all")))
     .def("show_recorder_collisions", CALL_WITHOUT_GIL_3(cc::Client, ShowRecorderCollisions, std::string, char, char), (arg("name"), arg("type1"), arg("type2")))
     .def("show_recorder_actors_blocked", CALL_WITHOUT_GIL_3(cc::Client, ShowRecorderActorsBlocked, std::string, double, double), (arg("name"), arg("min_time"), arg("min_distance")))
     .def("replay_file", CALL_WITHOUT_GIL_5(cc::Client, ReplayFile, std::string, double, double, uint32_t, bool), (arg("name"), arg("time_start"), arg("duration"), arg("follow_id"), arg("replay_sensors")=false))
+    .def("benchmark_replayer", CALL_WITHOUT_GIL_2(cc::Client, BenchmarkReplayer, std::string, double), (arg("name"), arg("tolerance")=1.0))
     .def("stop_replayer", &cc::Client::StopReplayer, (arg("keep_actors")))
     .def("set_replayer_time_factor", &cc::Client::SetReplayerTimeFactor, (arg("time_factor")))
     .def("set_replayer_ignore_hero", &cc::Client::SetReplayerIgnoreHero, (arg("ignore_hero")))
     .def("set_replayer_ignore_spectator", &cc::Client::SetReplayerIgnoreSpectator, (arg("ignore_spectator")))
     .def("apply_batch", &ApplyBatchCommands, (arg("commands"), arg("do_tick")=false))
     .def("apply_batch_sync", &ApplyBatchCommandsSync, (arg("commands"), arg("do_tick")=false))
+    .def("apply_vehicle_controls", &ApplyVehicleControls, (arg("actor_ids"), arg("throttle")=object(), arg("steer")=object(), arg("brake")=object(), arg("hand_brake")=object(), arg("reverse")=object(), arg("manual_gear_shift")=object(), arg("gear")=object(), arg("do_tick")=false))
+    .def("apply_transforms", &ApplyTransforms, (arg("actor_ids"), arg("locations"), arg("rotations")=object(), arg("do_tick")=false))
+    .def("apply_target_velocities", &ApplyTargetVelocities, (arg("actor_ids"), arg("velocities"), arg("do_tick")=false))
+    .def("spawn_batch", &SpawnBatchCommands, (arg("commands"), arg("time_budget")=0.005))
+    .def("get_spawn_batch_status", CONST_CALL_WITHOUT_GIL_1(cc::Client, GetSpawnBatchStatus, uint64_t), (arg("ticket")))
     .def("get_trafficmanager", CONST_CALL_WITHOUT_GIL_1(cc::Client, GetInstanceTM, uint16_t), (arg("port")=ctm::TM_DEFAULT_PORT))
   ;
 }
@@ -173,6 +173,15 @@ void export_commands() {
    .def_readwrite("transform", &cr::Command::ApplyTransform::transform)
   ;
 
+  // 为 carla::rpc::Command::ApplyKinematicTarget 类添加 Python 绑定
+  class_<cr::Command::ApplyKinematicTarget>("ApplyKinematicTarget")
+   .def("__init__", &command_impl::CustomInit<ActorPtr, cg::Transform, cg::Vector3D>, (arg("actor"), arg("transform"), arg("velocity")))
+   .def(init<cr::ActorId, cg::Transform, cg::Vector3D>((arg("actor_id"), arg("transform"), arg("velocity"))))
+   .def_readwrite("actor_id", &cr::Command::ApplyKinematicTarget::actor)
+   .def_readwrite("transform", &cr::Command::ApplyKinematicTarget::transform)
+   .def_readwrite("velocity", &cr::Command::ApplyKinematicTarget::velocity)
+  ;
+
   // 为 carla::rpc::Command::ApplyWalkerState 类添加 Python 绑定
   class_<cr::Command::ApplyWalkerState>("ApplyWalkerState")
     // 定义不同参数列表的构造函数，使用 CustomInit 进行参数转换
@@ -305,6 +314,7 @@ void export_commands() {
   implicitly_convertible<cr::Command::ApplyWalkerControl, cr::Command>();
   implicitly_convertible<cr::Command::ApplyVehiclePhysicsControl, cr::Command>();
   implicitly_convertible<cr::Command::ApplyTransform, cr::Command>();
+  implicitly_convertible<cr::Command::ApplyKinematicTarget, cr::Command>();
   implicitly_convertible<cr::Command::ApplyWalkerState, cr::Command>();
   implicitly_convertible<cr::Command::ApplyTargetVelocity, cr::Command>();
   implicitly_convertible<cr::Command::ApplyTargetAngularVelocity, cr::Command>();
@@ -5,6 +5,8 @@
 // For a copy, see <https://opensource.org/licenses/MIT>.
 
 // 引入CARLA几何模块中的头文件，这些文件定义了各种几何类型，如向量、位置、旋转等。
+#include <carla/ParallelFor.h>
+#include <carla/PythonUtil.h>
 #include <carla/geom/BoundingBox.h>
 #include <carla/geom/GeoLocation.h>
 #include <carla/geom/Location.h>
@@ -102,6 +104,59 @@ static void TransformList(const carla::geom::Transform &self, boost::python::lis
     self.TransformPoint(boost::python::extract<carla::geom::Vector3D &>(list[i]));
   }
 }
+// 原地变换缓冲区（例如numpy数组）中的点。缓冲区的形状为 (N, M)，M >= 3，元素为
+// float32 或 float64，每行的前三个元素为 x、y、z；行之间可以有间隔，因此激光雷达的
+// (N, 4) 数组或结构化数组的视图都可以直接使用。大数组分块并行处理。
+template <typename FuncT>
+static boost::python::object TransformPointBuffer(boost::python::object points, FuncT &&apply) {
+  namespace py = boost::python;
+  Py_buffer view;
+  if (PyObject_GetBuffer(points.ptr(), &view, PyBUF_WRITABLE | PyBUF_STRIDES | PyBUF_FORMAT) != 0) {
+    py::throw_error_already_set();
+  }
+  const std::string format = view.format != nullptr ? view.format : "B";
+  const bool is_float = (format == "f" || format == "<f" || format == "=f");
+  const bool is_double = (format == "d" || format == "<d" || format == "=d");
+  const bool valid =
+      (is_float || is_double) &&
+      view.ndim == 2 &&
+      view.shape[1] >= 3 &&
+      view.strides[1] == view.itemsize &&
+      view.strides[0] >= 3 * view.itemsize &&
+      view.strides[0] % view.itemsize == 0;
+  if (!valid) {
+    PyBuffer_Release(&view);
+    PyErr_SetString(PyExc_ValueError, "points must be a writable array of shape (N, 3) or (N, M > 3) of float32 or float64");
+    py::throw_error_already_set();
+  }
+  const size_t count = static_cast<size_t>(view.shape[0]);
+  const size_t stride = static_cast<size_t>(view.strides[0] / view.itemsize);
+  {
+    carla::PythonUtil::ReleaseGIL unlock;
+    carla::ParallelForChunks(count, [&](size_t begin, size_t end) {
+      if (is_float) {
+        apply(reinterpret_cast<float *>(view.buf) + begin * stride, end - begin, stride);
+      } else {
+        apply(reinterpret_cast<double *>(view.buf) + begin * stride, end - begin, stride);
+      }
+    }, 16u * 1024u);
+  }
+  PyBuffer_Release(&view);
+  return points;
+}
+
+static boost::python::object TransformPoints(const carla::geom::Transform &self, boost::python::object points) {
+  return TransformPointBuffer(points, [&self](auto *data, size_t count, size_t stride) {
+    self.TransformPoints(data, count, stride);
+  });
+}
+
+static boost::python::object InverseTransformPoints(const carla::geom::Transform &self, boost::python::object points) {
+  return TransformPointBuffer(points, [&self](auto *data, size_t count, size_t stride) {
+    self.InverseTransformPoints(data, count, stride);
+  });
+}
+
 // 定义一个函数，用于将一个16元素的float数组转换为一个4x4的boost::python::list。
 static boost::python::list BuildMatrix(const std::array<float, 16> &m) {
   boost::python::list r_out;
@@ -269,6 +324,8 @@ void export_geom() {
       self.TransformVector(vector);
       return vector;
     }, arg("in_point"))
+    .def("transform_points", &TransformPoints, arg("points"))
+    .def("inverse_transform_points", &InverseTransformPoints, arg("points"))
 // 定义获取前方向向量的方法
     .def("get_forward_vector", &cg::Transform::GetForwardVector)
  // 定义获取右方向向量的方法
@@ -0,0 +1,32 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include <carla/headless/HeadlessServer.h>
+
+// Run 一直阻塞到 Stop，期间释放GIL
+static void RunHeadlessServer(carla::headless::HeadlessServer &self, size_t worker_threads) {
+  carla::PythonUtil::ReleaseGIL unlock;
+  self.Run(worker_threads);
+}
+
+// Stop 等待仿真线程结束，期间释放GIL
+static void StopHeadlessServer(carla::headless::HeadlessServer &self) {
+  carla::PythonUtil::ReleaseGIL unlock;
+  self.Stop();
+}
+
+void export_headless() {
+  using namespace boost::python;
+  namespace ch = carla::headless;
+
+  class_<ch::HeadlessServer, boost::noncopyable>("HeadlessServer",
+      init<std::string, std::string, uint16_t>((arg("map_name"), arg("opendrive"), arg("port")=2000u)))
+    .add_property("port", &ch::HeadlessServer::GetPort)
+    .def("start", &ch::HeadlessServer::AsyncRun, (arg("worker_threads")=2u))
+    .def("run", &RunHeadlessServer, (arg("worker_threads")=2u))
+    .def("stop", &StopHeadlessServer)
+  ;
+}
@@ -331,13 +331,13 @@ void export_lightmanager() {
     // get_all_lights(self, light_group=carla.LightGroup.None) 返回包含特定组中的灯光的列表。
     // turn_on(self, lights) 打开 lights 中的所有灯（参数：python中的函数名、C++中的函数指针、参数列表）
     class_<cc::LightManager, boost::shared_ptr<cc::LightManager>>("LightManager", no_init)
-      .def("get_all_lights", CALL_RETURNING_LIST_1(cc::LightManager, GetAllLights, cr::LightState::LightGroup), (args("light_group") = cr::LightState::LightGroup::None ))
+      .def("get_all_lights", CALL_RETURNING_LIST_WITHOUT_GIL_1(cc::LightManager, GetAllLights, cr::LightState::LightGroup), (args("light_group") = cr::LightState::LightGroup::None ))
       .def("turn_on", &LightManagerTurnOn, (arg("lights")))
       .def("turn_off", &LightManagerTurnOff, (arg("lights")))
       .def("set_active", &LightManagerSetActive, (arg("lights"), arg("active")))
       .def("is_active", &LightManagerIsActive, (arg("lights")))
-      .def("get_turned_on_lights", CALL_RETURNING_LIST_1(cc::LightManager, GetTurnedOnLights, cr::LightState::LightGroup), (args("light_group") = cr::LightState::LightGroup::None ))
-      .def("get_turned_off_lights", CALL_RETURNING_LIST_1(cc::LightManager, GetTurnedOffLights, cr::LightState::LightGroup), (args("light_group") = cr::LightState::LightGroup::None ))
+      .def("get_turned_on_lights", CALL_RETURNING_LIST_WITHOUT_GIL_1(cc::LightManager, GetTurnedOnLights, cr::LightState::LightGroup), (args("light_group") = cr::LightState::LightGroup::None ))
+      .def("get_turned_off_lights", CALL_RETURNING_LIST_WITHOUT_GIL_1(cc::LightManager, GetTurnedOffLights, cr::LightState::LightGroup), (args("light_group") = cr::LightState::LightGroup::None ))
       .def("set_color", &LightManagerSetColor, (arg("lights"), arg("color")))
       .def("set_colors", &LightManagerSetVectorColor, (arg("lights"), arg("colors")))
       .def("get_color", &LightManagerGetColor, (arg("lights")))
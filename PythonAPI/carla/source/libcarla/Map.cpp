@@ -16,8 +16,10 @@
 #include <carla/client/Landmark.h>
 #include <carla/road/SignalType.h>
 
+#include <cstring>
 #include <ostream>
 #include <fstream>
+#include <vector>
 
 //定义两个重载的输出流运算符（operator<<），用于将 Map 和 Waypoint 类型的对象以文本形式输出到标准输出流
 namespace carla {
@@ -109,6 +111,156 @@ static carla::geom::GeoLocation ToGeolocation(
   return self.GetGeoReference().Transform(location);
 }
 
+// get_waypoints 的每个结果在内存中的布局，与 PackedWaypoints 的 __array_interface__ 一致
+struct PackedWaypoint {
+  float location[3];
+  float rotation[3];
+  double s;
+  uint32_t road_id;
+  uint32_t section_id;
+  int32_t lane_id;
+  uint8_t valid;
+  uint8_t padding[3];
+};
+static_assert(sizeof(PackedWaypoint) == 48u, "Unexpected padding in PackedWaypoint");
+
+// get_waypoints 的结果，每个位置一条定长记录，numpy.asarray直接引用这块内存而不复制
+class PackedWaypoints {
+public:
+
+  std::vector<PackedWaypoint> records;
+
+  size_t size() const {
+    return records.size();
+  }
+};
+
+static boost::python::dict GetPackedWaypointsArrayInterface(const PackedWaypoints &self) {
+  namespace py = boost::python;
+  const uint16_t probe = 1u;
+  const char order = *reinterpret_cast<const uint8_t *>(&probe) == 1u ? '<' : '>';
+  auto typestr = [order](char kind, size_t size) {
+    return std::string{order, kind} + std::to_string(size);
+  };
+  py::list descr;
+  descr.append(py::make_tuple("location", typestr('f', 4u), py::make_tuple(3)));
+  descr.append(py::make_tuple("rotation", typestr('f', 4u), py::make_tuple(3)));
+  descr.append(py::make_tuple("s", typestr('f', 8u)));
+  descr.append(py::make_tuple("road_id", typestr('u', 4u)));
+  descr.append(py::make_tuple("section_id", typestr('u', 4u)));
+  descr.append(py::make_tuple("lane_id", typestr('i', 4u)));
+  descr.append(py::make_tuple("valid", "|b1"));
+  descr.append(py::make_tuple("", "|V3"));
+  py::dict interface;
+  interface["version"] = 3;
+  interface["data"] = py::make_tuple(reinterpret_cast<std::uintptr_t>(self.records.data()), true);
+  interface["shape"] = py::make_tuple(self.size());
+  interface["typestr"] = "|V" + std::to_string(sizeof(PackedWaypoint));
+  interface["descr"] = descr;
+  return interface;
+}
+
+// 从形状为 (N, 3) 的float32或float64缓冲区（例如numpy数组）或者carla.Location的序列中读取位置
+static std::vector<carla::geom::Location> ToLocations(const boost::python::object &locations) {
+  namespace py = boost::python;
+  std::vector<carla::geom::Location> result;
+  Py_buffer view;
+  if (PyObject_GetBuffer(locations.ptr(), &view, PyBUF_C_CONTIGUOUS | PyBUF_FORMAT) != 0) {
+    PyErr_Clear();
+    result.assign(
+        py::stl_input_iterator<carla::geom::Location>(locations),
+        py::stl_input_iterator<carla::geom::Location>());
+    return result;
+  }
+  const std::string format = view.format != nullptr ? view.format : "B";
+  const bool is_float = (format == "f" || format == "<f" || format == "=f");
+  const bool is_double = (format == "d" || format == "<d" || format == "=d");
+  if (view.ndim != 2 || view.shape[1] != 3 || !(is_float || is_double)) {
+    PyBuffer_Release(&view);
+    PyErr_SetString(PyExc_ValueError, "locations must be an array of shape (N, 3) of float32 or float64");
+    py::throw_error_already_set();
+  }
+  const size_t count = static_cast<size_t>(view.shape[0]);
+  result.reserve(count);
+  for (size_t i = 0u; i < count; ++i) {
+    if (is_float) {
+      const auto *xyz = reinterpret_cast<const float *>(view.buf) + 3u * i;
+      result.emplace_back(xyz[0u], xyz[1u], xyz[2u]);
+    } else {
+      const auto *xyz = reinterpret_cast<const double *>(view.buf) + 3u * i;
+      result.emplace_back(
+          static_cast<float>(xyz[0u]),
+          static_cast<float>(xyz[1u]),
+          static_cast<float>(xyz[2u]));
+    }
+  }
+  PyBuffer_Release(&view);
+  return result;
+}
+
+static PackedWaypoints GetWaypoints(
+    const carla::client::Map &self,
+    const boost::python::object &py_locations,
+    bool project_to_road,
+    int32_t lane_type) {
+  auto locations = ToLocations(py_locations);
+  carla::PythonUtil::ReleaseGIL unlock;
+  const auto waypoints = self.GetWaypoints(locations, project_to_road, lane_type);
+  PackedWaypoints result;
+  result.records.resize(waypoints.size());
+  std::memset(result.records.data(), 0, result.records.size() * sizeof(PackedWaypoint));
+  for (size_t i = 0u; i < waypoints.size(); ++i) {
+    if (!waypoints[i].has_value()) {
+      continue;
+    }
+    const auto &waypoint = *waypoints[i];
+    const auto transform = self.GetMap().ComputeTransform(waypoint);
+    auto &record = result.records[i];
+    record.location[0u] = transform.location.x;
+    record.location[1u] = transform.location.y;
+    record.location[2u] = transform.location.z;
+    record.rotation[0u] = transform.rotation.pitch;
+    record.rotation[1u] = transform.rotation.yaw;
+    record.rotation[2u] = transform.rotation.roll;
+    record.s = waypoint.s;
+    record.road_id = waypoint.road_id;
+    record.section_id = waypoint.section_id;
+    record.lane_id = waypoint.lane_id;
+    record.valid = 1u;
+  }
+  return result;
+}
+
+// 批量计算路线，queries 为 (起点, 终点) 的序列，返回每条路线的路点列表
+static boost::python::list ComputeRoutes(
+    const carla::client::Map &self,
+    const boost::python::object &py_queries) {
+  namespace py = boost::python;
+  std::vector<std::pair<carla::geom::Location, carla::geom::Location>> queries;
+  const auto size = py::len(py_queries);
+  queries.reserve(static_cast<size_t>(size));
+  for (auto i = 0; i < size; ++i) {
+    py::object query = py_queries[i];
+    queries.emplace_back(
+        py::extract<carla::geom::Location>(query[0])(),
+        py::extract<carla::geom::Location>(query[1])());
+  }
+  std::vector<std::vector<carla::SharedPtr<carla::client::Waypoint>>> routes;
+  {
+    carla::PythonUtil::ReleaseGIL unlock;
+    routes = self.ComputeRoutes(queries);
+  }
+  py::list result;
+  for (const auto &route : routes) {
+    py::list waypoints;
+    for (const auto &waypoint : route) {
+      waypoints.append(waypoint);
+    }
+    result.append(waypoints);
+  }
+  return result;
+}
+
 void export_map() {
   using namespace boost::python;
   namespace cc = carla::client;
@@ -200,6 +352,11 @@ enum_<cr::SignalOrientation>("LandmarkOrientation")
 
 // 定义了名为"Map"的类，该类不可复制，使用智能指针进行管理
 // 提供了多种初始化以及获取地图相关信息、操作地图的方法
+class_<PackedWaypoints>("PackedWaypoints", no_init)
+   .def("__len__", &PackedWaypoints::size)
+   .add_property("__array_interface__", &GetPackedWaypointsArrayInterface)
+  ;
+
 class_<cc::Map, boost::noncopyable, boost::shared_ptr<cc::Map>>("Map", no_init)
     // 使用给定的名称和OpenDRIVE内容初始化地图对象
    .def(init<std::string, std::string>((arg("name"), arg("xodr_content"))))
@@ -209,10 +366,14 @@ class_<cc::Map, boost::noncopyable, boost::shared_ptr<cc::Map>>("Map", no_init)
    .def("get_spawn_points", CALL_RETURNING_LIST(cc::Map, GetRecommendedSpawnPoints))
     // 根据位置获取路点，可指定是否投影到道路以及车道类型（默认是驾驶车道）
    .def("get_waypoint", &cc::Map::GetWaypoint, (arg("location"), arg("project_to_road")=true, arg("lane_type")=cr::Lane::LaneType::Driving))
+    // 批量获取路点，返回紧密排列的记录而不是Waypoint对象
+   .def("get_waypoints", &GetWaypoints, (arg("locations"), arg("project_to_road")=true, arg("lane_type")=cr::Lane::LaneType::Driving))
     // 根据道路ID、车道ID和距离获取路点（基于OpenDRIVE格式相关参数）
    .def("get_waypoint_xodr", &cc::Map::GetWaypointXODR, (arg("road_id"), arg("lane_id"), arg("s")))
     // 获取地图拓扑结构的相关方法（这里具体函数未给出完整定义，可能在别处实现）
    .def("get_topology", &GetTopology)
+    // 批量计算起点到终点的路线
+   .def("compute_routes", &ComputeRoutes, (arg("queries")))
     // 按照给定距离生成路点列表
    .def("generate_waypoints", CALL_RETURNING_LIST_1(cc::Map, GenerateWaypoints, double), (args("distance")))
     // 将给定位置转换为地理位置信息（具体转换逻辑在对应函数中实现）
@@ -8,6 +8,15 @@
 // 推测这里面包含了与将OpenStreetMap地图转换为OpenDRIVE格式相关的一些类型、函数等声明内容
 #include <OSM2ODR.h>  
 
+#include <carla/FileSystem.h>
+#include <carla/rpc/CachedContent.h>
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <sstream>
+
 // 定义一个空类OSM2ODR，这里可能是用于模拟PythonAPI中的命名空间概念，
 // 虽然类体为空，但通过它可以在C++代码里营造出类似Python中命名空间的组织结构，方便后续代码对相关功能进行分组管理
 class OSM2ODR {};
@@ -37,6 +46,63 @@ namespace osm2odr {
     void SetTLExcludedWayTypes(OSM2ODRSettings& self, boost::python::list input) {
         self.tl_excluded_highways_types = PythonLitstToVector<std::string>(input);
     }
+
+    // 缓存键：OSM内容和所有转换参数的哈希，任何一个变化都会重新转换。
+    std::string MakeCacheKey(const std::string &osm_file, const OSM2ODRSettings &settings) {
+        std::ostringstream out;
+        out << settings.use_offsets << ' ' << settings.offset_x << ' ' << settings.offset_y
+            << ' ' << settings.default_lane_width << ' ' << settings.elevation_layer_height
+            << ' ' << settings.proj_string << ' ' << settings.center_map
+            << ' ' << settings.generate_traffic_lights << ' ' << settings.all_junctions_traffic_lights;
+        for (const auto &type : settings.osm_highways_types) {
+            out << " w:" << type;
+        }
+        for (const auto &type : settings.tl_excluded_highways_types) {
+            out << " t:" << type;
+        }
+        const std::string parameters = out.str();
+        using carla::rpc::CachedContent;
+        return
+            CachedContent::ComputeHash(reinterpret_cast<const uint8_t *>(osm_file.data()), osm_file.size()) +
+            CachedContent::ComputeHash(reinterpret_cast<const uint8_t *>(parameters.data()), parameters.size());
+    }
+
+    // 转换时释放GIL。SUMO的转换使用进程内全局的选项表，同一时间只能进行一个转换。
+    // 给出 cache_folder 时，结果以缓存键为文件名保存，相同的输入和参数不再重新转换。
+    std::string ConvertCached(
+            const std::string &osm_file,
+            const OSM2ODRSettings &settings,
+            const std::string &cache_folder) {
+        static std::mutex conversion_mutex;
+        carla::PythonUtil::ReleaseGIL unlock;
+        if (cache_folder.empty()) {
+            std::lock_guard<std::mutex> lock(conversion_mutex);
+            return ConvertOSMToOpenDRIVE(osm_file, settings);
+        }
+        std::string path = cache_folder + "/" + MakeCacheKey(osm_file, settings) + ".xodr";
+        {
+            std::ifstream cached(path, std::ios::binary);
+            if (cached.good()) {
+                return std::string(std::istreambuf_iterator<char>(cached), {});
+            }
+        }
+        std::string result;
+        {
+            std::lock_guard<std::mutex> lock(conversion_mutex);
+            result = ConvertOSMToOpenDRIVE(osm_file, settings);
+        }
+        // 先写入临时文件再重命名，其他进程不会读到写了一半的缓存
+        carla::FileSystem::ValidateFilePath(path);
+        const std::string temp_path = path + ".tmp";
+        {
+            std::ofstream out(temp_path, std::ios::trunc | std::ios::binary);
+            out << result;
+        }
+        if (std::rename(temp_path.c_str(), path.c_str()) != 0) {
+            std::remove(temp_path.c_str());
+        }
+        return result;
+    }
 }
 
 // 定义一个名为export_osm2odr的函数，从函数名推测其功能可能是将与osm2odr相关的功能、类型等导出，
@@ -76,7 +142,7 @@ void export_osm2odr() {
         // 为Python类添加名为"convert"的静态方法，关联到C++中的ConvertOSMToOpenDRIVE函数，
         // 用于在Python中调用该方法实现将OpenStreetMap文件转换为OpenDRIVE格式的功能，
         // 参数"osm_file"表示要转换的OpenStreetMap文件路径，"settings"参数有默认值，默认使用OSM2ODRSettings类型的默认构造对象。
-       .def("convert", &ConvertOSMToOpenDRIVE, (arg("osm_file"), arg("settings") = OSM2ODRSettings()))
+       .def("convert", &ConvertCached, (arg("osm_file"), arg("settings") = OSM2ODRSettings(), arg("cache_folder") = std::string()))
         // 明确指定"convert"方法为静态方法，符合在Python中调用该方法时不需要先实例化类对象的预期行为。
        .staticmethod("convert")
     ;
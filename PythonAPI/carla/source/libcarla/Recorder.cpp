@@ -0,0 +1,188 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include <carla/recorder/RecorderReader.h>
+#include <carla/rpc/RecorderFilter.h>
+
+#include <boost/python/stl_iterator.hpp>
+
+// 空类，在Python中作为 carla.RecorderReader.read 的命名空间
+class RecorderReader {};
+
+// 按__array_interface__协议描述一列数据，numpy.asarray直接引用这块内存而不复制，
+// 每行只有一个元素时为一维数组
+static boost::python::dict GetRecorderColumnArrayInterface(const carla::recorder::RecorderColumn &self) {
+  const uint16_t probe = 1u;
+  const bool is_little_endian = *reinterpret_cast<const uint8_t *>(&probe) == 1u;
+  const char byte_order = self.element_size == 1u ? '|' : (is_little_endian ? '<' : '>');
+  boost::python::dict interface;
+  interface["version"] = 3;
+  interface["data"] = boost::python::make_tuple(
+      reinterpret_cast<std::uintptr_t>(self.data.data()),
+      true);
+  interface["shape"] = self.width == 1u ?
+      boost::python::make_tuple(self.size()) :
+      boost::python::make_tuple(self.size(), self.width);
+  interface["typestr"] =
+      std::string{byte_order, static_cast<char>(self.kind)} +
+      std::to_string(self.element_size);
+  return interface;
+}
+
+static const carla::recorder::RecorderColumn &GetRecorderColumn(
+    const carla::recorder::RecorderTable &self,
+    const std::string &field) {
+  const auto *column = self.Find(field);
+  if (column == nullptr) {
+    PyErr_SetString(PyExc_KeyError, field.c_str());
+    boost::python::throw_error_already_set();
+  }
+  return *column;
+}
+
+static const carla::recorder::RecorderTable &GetRecorderTable(
+    const carla::recorder::RecorderData &self,
+    const std::string &name) {
+  const auto *table = self.Find(name);
+  if (table == nullptr) {
+    PyErr_SetString(PyExc_KeyError, name.c_str());
+    boost::python::throw_error_already_set();
+  }
+  return *table;
+}
+
+// 解码整个文件可能需要一些时间，期间释放GIL
+static carla::recorder::RecorderData ReadRecorderFile(const std::string &filename) {
+  carla::PythonUtil::ReleaseGIL unlock;
+  return carla::recorder::ReadRecorderFile(filename);
+}
+
+static boost::python::list GetRecorderFilterActorTypes(const carla::rpc::RecorderFilter &self) {
+  boost::python::list result;
+  for (const auto &pattern : self.actor_types) {
+    result.append(pattern);
+  }
+  return result;
+}
+
+static void SetRecorderFilterActorTypes(carla::rpc::RecorderFilter &self, const boost::python::object &actor_types) {
+  self.actor_types = {
+      boost::python::stl_input_iterator<std::string>(actor_types),
+      boost::python::stl_input_iterator<std::string>()};
+}
+
+static boost::python::list GetRecorderFilterActorIds(const carla::rpc::RecorderFilter &self) {
+  boost::python::list result;
+  for (const auto id : self.actor_ids) {
+    result.append(id);
+  }
+  return result;
+}
+
+static void SetRecorderFilterActorIds(carla::rpc::RecorderFilter &self, const boost::python::object &actor_ids) {
+  self.actor_ids = {
+      boost::python::stl_input_iterator<carla::ActorId>(actor_ids),
+      boost::python::stl_input_iterator<carla::ActorId>()};
+}
+
+// 设置区域的同时启用区域过滤，设为None时关闭
+static void SetRecorderFilterRegion(carla::rpc::RecorderFilter &self, const boost::python::object &region) {
+  self.use_region = !region.is_none();
+  if (self.use_region) {
+    self.region = boost::python::extract<carla::geom::BoundingBox>(region);
+  }
+}
+
+static boost::python::object GetRecorderFilterRegion(const carla::rpc::RecorderFilter &self) {
+  return self.use_region ? boost::python::object(self.region) : boost::python::object();
+}
+
+void export_recorder() {
+  using namespace boost::python;
+  namespace crec = carla::recorder;
+  namespace cr = carla::rpc;
+
+  enum_<cr::RecorderPacket>("RecorderPacket")
+    .value("Collision", cr::RecorderPacket::Collision)
+    .value("Position", cr::RecorderPacket::Position)
+    .value("TrafficLightState", cr::RecorderPacket::TrafficLightState)
+    .value("VehicleAnimation", cr::RecorderPacket::VehicleAnimation)
+    .value("WalkerAnimation", cr::RecorderPacket::WalkerAnimation)
+    .value("VehicleLight", cr::RecorderPacket::VehicleLight)
+    .value("SceneLight", cr::RecorderPacket::SceneLight)
+    .value("Kinematics", cr::RecorderPacket::Kinematics)
+    .value("BoundingBox", cr::RecorderPacket::BoundingBox)
+    .value("PhysicsControl", cr::RecorderPacket::PhysicsControl)
+    .value("TrafficLightTime", cr::RecorderPacket::TrafficLightTime)
+    .value("TriggerVolume", cr::RecorderPacket::TriggerVolume)
+    .value("WalkerBones", cr::RecorderPacket::WalkerBones)
+    .value("VehicleDoor", cr::RecorderPacket::VehicleDoor)
+    .value("VehicleWheels", cr::RecorderPacket::VehicleWheels)
+    .value("BikerAnimation", cr::RecorderPacket::BikerAnimation)
+  ;
+
+  class_<cr::RecorderFilter>("RecorderFilter")
+    .add_property("actor_types", &GetRecorderFilterActorTypes, &SetRecorderFilterActorTypes)
+    .add_property("actor_ids", &GetRecorderFilterActorIds, &SetRecorderFilterActorIds)
+    .add_property("region", &GetRecorderFilterRegion, &SetRecorderFilterRegion)
+    .def_readwrite("packet_mask", &cr::RecorderFilter::packet_mask)
+    .def("is_packet_enabled", &cr::RecorderFilter::IsPacketEnabled, (arg("packet")))
+    .def("set_packet_enabled", &cr::RecorderFilter::SetPacketEnabled, (arg("packet"), arg("enabled")))
+  ;
+
+  class_<crec::RecorderColumn>("RecorderColumn", no_init)
+    .def_readonly("field", &crec::RecorderColumn::field)
+    .def_readonly("width", &crec::RecorderColumn::width)
+    .def("__len__", &crec::RecorderColumn::size)
+    .add_property("__array_interface__", &GetRecorderColumnArrayInterface)
+  ;
+
+  class_<crec::RecorderTable>("RecorderTable", no_init)
+    .def_readonly("name", &crec::RecorderTable::name)
+    .add_property("fields", +[](const crec::RecorderTable &self) {
+      boost::python::list result;
+      for (const auto &column : self.columns) {
+        result.append(column.field);
+      }
+      return result;
+    })
+    .def("__len__", &crec::RecorderTable::size)
+    .def("__contains__", +[](const crec::RecorderTable &self, const std::string &field) {
+      return self.Find(field) != nullptr;
+    })
+    .def("__getitem__", &GetRecorderColumn, return_internal_reference<>())
+  ;
+
+  class_<crec::RecorderData>("RecorderData", no_init)
+    .def_readonly("version", &crec::RecorderData::version)
+    .def_readonly("map", &crec::RecorderData::map)
+    .def_readonly("date", &crec::RecorderData::date)
+    .def_readonly("compressed", &crec::RecorderData::compressed)
+    .add_property("tables", +[](const crec::RecorderData &self) {
+      boost::python::list result;
+      for (const auto &table : self.tables) {
+        result.append(table.name);
+      }
+      return result;
+    })
+    .add_property("actor_type_ids", +[](const crec::RecorderData &self) {
+      boost::python::list result;
+      for (const auto &type_id : self.actor_type_ids) {
+        result.append(type_id);
+      }
+      return result;
+    })
+    .def("__contains__", +[](const crec::RecorderData &self, const std::string &name) {
+      return self.Find(name) != nullptr;
+    })
+    .def("__getitem__", &GetRecorderTable, return_internal_reference<>())
+  ;
+
+  class_<RecorderReader>("RecorderReader", no_init)
+    .def("read", &ReadRecorderFile, (arg("filename")))
+    .staticmethod("read")
+  ;
+}
@@ -7,6 +7,7 @@
 #include <carla/client/ClientSideSensor.h>
 #include <carla/client/LaneInvasionSensor.h>
 #include <carla/client/Sensor.h>
+#include <carla/client/SensorGroup.h>
 #include <carla/client/ServerSideSensor.h>
 
 // 定义一个静态函数 SubscribeToStream，用于让传感器订阅流并执行回调函数
@@ -15,6 +16,18 @@ static void SubscribeToStream(carla::client::Sensor &self, boost::python::object
     self.Listen(MakeCallback(std::move(callback)));
 }
 
+// 服务器端传感器的 listen，lazy 为 True 时回调收到尚未反序列化的 LazySensorData
+static void SubscribeToServerSideStream(
+    carla::client::ServerSideSensor &self,
+    boost::python::object callback,
+    bool lazy) {
+    if (lazy) {
+      self.ListenLazy(MakeCallback(std::move(callback)));
+    } else {
+      self.Listen(MakeCallback(std::move(callback)));
+    }
+}
+
 // 定义一个静态函数 SubscribeToGBuffer，用于让服务器端传感器订阅图形缓冲区（GBuffer）并执行回调函数
 static void SubscribeToGBuffer(
     carla::client::ServerSideSensor &self,
@@ -23,6 +36,51 @@ static void SubscribeToGBuffer(
     self.ListenToGBuffer(GBufferId, MakeCallback(std::move(callback)));
 }
 
+// 定义一个静态函数 SubscribeToGBuffers，一次订阅多个GBuffer纹理，它们每帧打包在一条消息中
+static void SubscribeToGBuffers(
+    carla::client::ServerSideSensor &self,
+    boost::python::object gbuffer_ids,
+    boost::python::object callback) {
+    uint64_t mask = 0u;
+    for (auto i = 0u; i < boost::python::len(gbuffer_ids); ++i) {
+      mask |= uint64_t(1) << boost::python::extract<uint32_t>(gbuffer_ids[i])();
+    }
+    self.ListenToGBuffers(mask, MakeCallback(std::move(callback)));
+}
+
+// 定义一个静态函数 SubscribeToSensorGroup，每帧以一个列表调用一次 Python 回调，缺失的数据为 None
+static void SubscribeToSensorGroup(carla::client::SensorGroup &self, boost::python::object callback) {
+    namespace py = boost::python;
+    if (!PyCallable_Check(callback.ptr())) {
+      PyErr_SetString(PyExc_TypeError, "callback argument must be callable!");
+      py::throw_error_already_set();
+    }
+    // 需要在持有GIL的同时删除回调
+    using Deleter = carla::PythonUtil::AcquireGILDeleter;
+    auto callback_ptr = carla::SharedPtr<py::object>{new py::object(callback), Deleter()};
+    // 各传感器的数据在C++中组装，每帧只获取一次GIL
+    self.Listen([callback=std::move(callback_ptr)](carla::client::SensorGroup::DataList data) {
+      carla::PythonUtil::AcquireGIL lock;
+      try {
+        py::list bundle;
+        for (auto &item : data) {
+          bundle.append(item != nullptr ? py::object(item) : py::object());
+        }
+        py::call<void>(callback->ptr(), bundle);
+      } catch (const py::error_already_set &) {
+        PyErr_Print();
+      }
+    });
+}
+
+static auto GetSensorGroupSensors(const carla::client::SensorGroup &self) {
+    boost::python::list result;
+    for (auto &sensor : self.GetSensors()) {
+      result.append(sensor);
+    }
+    return result;
+}
+
 // 定义一个名为 export_sensor 的函数，用于将 C++ 中的传感器类暴露给 Python
 void export_sensor() {
     using namespace boost::python;
@@ -39,9 +97,13 @@ void export_sensor() {
     // 定义一个名为 ServerSideSensor 的 Python 类，继承自 cc::Sensor，并设置为不可复制，使用智能指针管理
     class_<cc::ServerSideSensor, bases<cc::Sensor>, boost::noncopyable, boost::shared_ptr<cc::ServerSideSensor>>
         ("ServerSideSensor", no_init)  // 定义类名 "ServerSideSensor"，并指定其基类为 cc::Sensor，且不允许通过 Python 创建实例
+        .def("listen", &SubscribeToServerSideStream, (arg("callback"), arg("lazy")=false))
         .def("listen_to_gbuffer", &SubscribeToGBuffer, (arg("gbuffer_id"), arg("callback")))
         .def("is_listening_gbuffer", &cc::ServerSideSensor::IsListeningGBuffer, (arg("gbuffer_id")))
         .def("stop_gbuffer", &cc::ServerSideSensor::StopGBuffer, (arg("gbuffer_id")))
+        .def("listen_to_gbuffers", &SubscribeToGBuffers, (arg("gbuffer_ids"), arg("callback")))
+        .def("is_listening_gbuffers", &cc::ServerSideSensor::IsListeningGBuffers)
+        .def("stop_gbuffers", &cc::ServerSideSensor::StopGBuffers)
         .def("enable_for_ros", &cc::ServerSideSensor::EnableForROS)
         .def("disable_for_ros", &cc::ServerSideSensor::DisableForROS)
         .def("is_enabled_for_ros", &cc::ServerSideSensor::IsEnabledForROS)
@@ -56,6 +118,17 @@ void export_sensor() {
         .def(self_ns::str(self_ns::self))
     ;
 
+    // 定义一个名为 SensorGroup 的 Python 类，由 World.create_sensor_group 创建
+    class_<cc::SensorGroup, boost::noncopyable, boost::shared_ptr<cc::SensorGroup>>("SensorGroup", no_init)
+        .add_property("sensors", &GetSensorGroupSensors)
+        .add_property("timeout", +[](const cc::SensorGroup &self) {
+          return static_cast<double>(self.GetTimeout().milliseconds()) / 1000.0;
+        })
+        .def("listen", &SubscribeToSensorGroup, (arg("callback")))
+        .def("is_listening", &cc::SensorGroup::IsListening)
+        .def("stop", &cc::SensorGroup::Stop)
+    ;
+
     // 定义一个名为 LaneInvasionSensor 的 Python 类，继承自 cc::ClientSideSensor，并设置为不可复制，使用智能指针管理
     class_<cc::LaneInvasionSensor, bases<cc::ClientSideSensor>, boost::noncopyable, boost::shared_ptr<cc::LaneInvasionSensor>>
         ("LaneInvasionSensor", no_init)
@@ -5,21 +5,28 @@
 // For a copy, see <https://opensource.org/licenses/MIT>.
 
 #include <carla/PythonUtil.h>
+#include <carla/image/AsyncImageWriter.h>
 #include <carla/image/ImageConverter.h>
 #include <carla/image/ImageIO.h>
 #include <carla/image/ImageView.h>
+#include <carla/image/PixelConverter.h>
 #include <carla/pointcloud/PointCloudIO.h>
+#include <carla/sensor/LazySensorData.h>
 #include <carla/sensor/SensorData.h>
 #include <carla/sensor/data/CollisionEvent.h>
+#include <carla/sensor/data/CompressedImage.h>
 #include <carla/sensor/data/IMUMeasurement.h>
 #include <carla/sensor/data/ObstacleDetectionEvent.h>
 #include <carla/sensor/data/Image.h>
+#include <carla/sensor/data/InstanceSegmentationImage.h>
 #include <carla/sensor/data/LaneInvasionEvent.h>
 #include <carla/sensor/data/LidarMeasurement.h>
 #include <carla/sensor/data/SemanticLidarMeasurement.h>
 #include <carla/sensor/data/GnssMeasurement.h>
 #include <carla/sensor/data/RadarMeasurement.h>
+#include <carla/sensor/data/VehicleTelemetryMeasurement.h>
 #include <carla/sensor/data/DVSEventArray.h>
+#include <carla/sensor/data/GBufferMultipart.h>
 #include <carla/sensor/data/V2XEvent.h>
 #include <carla/sensor/data/V2XData.h>
 #include <carla/sensor/data/LibITS.h>
@@ -31,6 +38,8 @@
 #include <ostream>
 #include <iostream>
 #include <cmath>
+#include <cstdint>
+#include <string>
 #include <vector>
 #include <algorithm>
 #include <thread>
@@ -60,6 +69,24 @@ namespace data {
 
 // 为OpticalFlowImage类型重载输出流运算符，功能类似Image类型，用于输出光学流图像的信息。
 
+  std::ostream &operator<<(std::ostream &out, const CompressedImage &image) {
+    out << "CompressedImage(frame=" << std::to_string(image.GetFrame())
+        << ", timestamp=" << std::to_string(image.GetTimestamp())
+        << ", size=" << std::to_string(image.GetWidth()) << 'x' << std::to_string(image.GetHeight())
+        << ", bytes=" << std::to_string(image.size())
+        << ')';
+    return out;
+  }
+
+  std::ostream &operator<<(std::ostream &out, const GBufferMultipart &gbuffers) {
+    out << "GBufferMultipart(frame=" << std::to_string(gbuffers.GetFrame())
+        << ", timestamp=" << std::to_string(gbuffers.GetTimestamp())
+        << ", size=" << std::to_string(gbuffers.GetWidth()) << 'x' << std::to_string(gbuffers.GetHeight())
+        << ", textures=" << std::to_string(gbuffers.GetTextureCount())
+        << ')';
+    return out;
+  }
+
   std::ostream &operator<<(std::ostream &out, const LidarMeasurement &meas) {
     out << "LidarMeasurement(frame=" << std::to_string(meas.GetFrame())
         << ", timestamp=" << std::to_string(meas.GetTimestamp())
@@ -175,6 +202,27 @@ namespace data {
 
 // 为RadarDetection类型重载输出流运算符，输出雷达检测到的物体的信息，包括速度、方位角、高度和深度。
 
+  std::ostream &operator<<(std::ostream &out, const VehicleTelemetryMeasurement &meas) {
+    out << "VehicleTelemetryMeasurement(frame=" << std::to_string(meas.GetFrame())
+        << ", timestamp=" << std::to_string(meas.GetTimestamp())
+        << ", speed=" << std::to_string(meas.GetSpeed())
+        << ", engine_rpm=" << std::to_string(meas.GetEngineRPM())
+        << ", gear=" << std::to_string(meas.GetGear())
+        << ", wheel_count=" << std::to_string(meas.size())
+        << ')';
+    return out;
+  }
+
+  std::ostream &operator<<(std::ostream &out, const WheelTelemetry &wheel) {
+    out << "WheelTelemetry(tire_friction=" << std::to_string(wheel.tire_friction)
+        << ", lat_slip=" << std::to_string(wheel.lat_slip)
+        << ", long_slip=" << std::to_string(wheel.long_slip)
+        << ", omega=" << std::to_string(wheel.omega)
+        << ", tire_load=" << std::to_string(wheel.tire_load)
+        << ')';
+    return out;
+  }
+
   std::ostream &operator<<(std::ostream &out, const LidarDetection &det) {
     out << "LidarDetection(x=" << std::to_string(det.point.x)
         << ", y=" << std::to_string(det.point.y)
@@ -262,26 +310,121 @@ static auto GetRawDataAsBuffer(T &self) {
     // 返回boost::python::object对象，封装了内存视图  
     return boost::python::object(boost::python::handle<>(ptr));  
 }  
+
+// numpy的__array_interface__中描述基本类型的字符串，例如"<f4"
+template <typename T>
+static std::string GetArrayTypeStr(char kind) {
+  const uint16_t probe = 1u;
+  const bool is_little_endian = *reinterpret_cast<const uint8_t *>(&probe) == 1u;
+  const char byte_order = sizeof(T) == 1u ? '|' : (is_little_endian ? '<' : '>');
+  return std::string{byte_order, kind} + std::to_string(sizeof(T));
+}
+
+// 按__array_interface__协议描述传感器数据在内存中的布局。
+// numpy.asarray直接引用这块内存而不复制，并把数组的base设为传感器数据对象，
+// 因此数组存活期间持有数据的carla::Buffer不会被释放。
+template <typename T>
+static boost::python::dict MakeArrayInterface(
+    T &self,
+    boost::python::tuple shape,
+    boost::python::tuple strides,
+    std::string typestr,
+    boost::python::object descr = boost::python::object()) {
+  boost::python::dict interface;
+  interface["version"] = 3;
+  // 第二项表示是否只读，与__setitem__一致允许原地修改
+  interface["data"] = boost::python::make_tuple(
+      reinterpret_cast<std::uintptr_t>(self.data()),
+      false);
+  interface["shape"] = shape;
+  interface["strides"] = strides;
+  interface["typestr"] = typestr;
+  if (!descr.is_none()) {
+    interface["descr"] = descr;
+  }
+  return interface;
+}
+
+// 图像为 (height, width, channels) 的数组，每个像素由 channels 个 ChannelT 组成
+template <typename T, typename ChannelT>
+static boost::python::dict GetImageArrayInterface(T &self, char kind) {
+  constexpr size_t channels = sizeof(typename T::value_type) / sizeof(ChannelT);
+  static_assert(channels * sizeof(ChannelT) == sizeof(typename T::value_type), "Invalid pixel layout");
+  const size_t row_size = self.GetWidth() * sizeof(typename T::value_type);
+  return MakeArrayInterface(
+      self,
+      boost::python::make_tuple(self.GetHeight(), self.GetWidth(), channels),
+      boost::python::make_tuple(row_size, sizeof(typename T::value_type), sizeof(ChannelT)),
+      GetArrayTypeStr<ChannelT>(kind));
+}
+
+// 每个元素由若干个float组成时展开为 (size, fields) 的float32数组
+template <typename T>
+static boost::python::dict GetFloatArrayInterface(T &self) {
+  constexpr size_t fields = sizeof(typename T::value_type) / sizeof(float);
+  static_assert(fields * sizeof(float) == sizeof(typename T::value_type), "Invalid detection layout");
+  return MakeArrayInterface(
+      self,
+      boost::python::make_tuple(self.size(), fields),
+      boost::python::make_tuple(sizeof(typename T::value_type), sizeof(float)),
+      GetArrayTypeStr<float>('f'));
+}
+
+// 成员类型不同时作为结构化数组，@a descr 为 numpy 的字段描述列表
+template <typename T>
+static boost::python::dict GetStructuredArrayInterface(T &self, boost::python::list descr) {
+  return MakeArrayInterface(
+      self,
+      boost::python::make_tuple(self.size()),
+      boost::python::make_tuple(sizeof(typename T::value_type)),
+      "|V" + std::to_string(sizeof(typename T::value_type)),
+      descr);
+}
+
+static boost::python::dict GetSemanticLidarArrayInterface(carla::sensor::data::SemanticLidarMeasurement &self) {
+  using Detection = carla::sensor::data::SemanticLidarDetection;
+  static_assert(sizeof(Detection) == 4u * sizeof(float) + 2u * sizeof(uint32_t), "Invalid detection layout");
+  boost::python::list descr;
+  descr.append(boost::python::make_tuple("x", GetArrayTypeStr<float>('f')));
+  descr.append(boost::python::make_tuple("y", GetArrayTypeStr<float>('f')));
+  descr.append(boost::python::make_tuple("z", GetArrayTypeStr<float>('f')));
+  descr.append(boost::python::make_tuple("cos_inc_angle", GetArrayTypeStr<float>('f')));
+  descr.append(boost::python::make_tuple("object_idx", GetArrayTypeStr<uint32_t>('u')));
+  descr.append(boost::python::make_tuple("object_tag", GetArrayTypeStr<uint32_t>('u')));
+  return GetStructuredArrayInterface(self, descr);
+}
+
+static boost::python::dict GetDVSArrayInterface(carla::sensor::data::DVSEventArray &self) {
+  using Event = carla::sensor::data::DVSEvent;
+  static_assert(sizeof(Event) == 2u * sizeof(uint16_t) + sizeof(int64_t) + sizeof(bool), "Invalid event layout");
+  boost::python::list descr;
+  descr.append(boost::python::make_tuple("x", GetArrayTypeStr<uint16_t>('u')));
+  descr.append(boost::python::make_tuple("y", GetArrayTypeStr<uint16_t>('u')));
+  descr.append(boost::python::make_tuple("t", GetArrayTypeStr<int64_t>('i')));
+  descr.append(boost::python::make_tuple("pol", GetArrayTypeStr<bool>('b')));
+  return GetStructuredArrayInterface(self, descr);
+}
   
 // 模板函数ConvertImage，用于根据指定的颜色转换器类型转换图像数据  
 template <typename T>  
 static void ConvertImage(T &self, EColorConverter cc) {  
+    static_assert(sizeof(typename T::value_type) == 4u, "Expected BGRA8 pixels");
     // 释放全局解释器锁，以便在C++代码中执行耗时操作时不会阻塞Python线程  
     carla::PythonUtil::ReleaseGIL unlock;  
     // 使用carla::image命名空间  
     using namespace carla::image;  
-    // 创建ImageView对象，用于操作图像数据  
-    auto view = ImageView::MakeView(self);  
+    // 直接在像素缓冲区上转换，结果与 ImageConverter::ConvertInPlace 相同
+    auto *pixels = reinterpret_cast<uint8_t *>(self.data());
     // 根据颜色转换器类型执行相应的转换  
     switch (cc) {  
         case EColorConverter::Depth:  
-            ImageConverter::ConvertInPlace(view, ColorConverter::Depth());  
+            PixelConverter::DepthInPlace(pixels, self.size());
             break;  
         case EColorConverter::LogarithmicDepth:  
-            ImageConverter::ConvertInPlace(view, ColorConverter::LogarithmicDepth());  
+            PixelConverter::LogarithmicDepthInPlace(pixels, self.size());
             break;  
         case EColorConverter::CityScapesPalette:  
-            ImageConverter::ConvertInPlace(view, ColorConverter::CityScapesPalette());  
+            PixelConverter::CityScapesPaletteInPlace(pixels, self.size());
             break;  
         case EColorConverter::Raw:  
             break; // 忽略原始数据，不进行转换  
@@ -290,6 +433,78 @@ static void ConvertImage(T &self, EColorConverter cc) {
     }  
 }  
   
+// 由图像逐像素计算出的 (height, width) 数组，通过 __array_interface__ 提供给
+// numpy，numpy.asarray 不复制数据
+template <typename T>
+class ImageArray : public std::vector<T> {
+  public:
+    unsigned int Width = 0u;
+    unsigned int Height = 0u;
+};
+
+template <typename T>
+static boost::python::dict GetPlaneArrayInterface(ImageArray<T> &self, char kind) {
+  return MakeArrayInterface(
+      self,
+      boost::python::make_tuple(self.Height, self.Width),
+      boost::python::make_tuple(self.Width * sizeof(T), sizeof(T)),
+      GetArrayTypeStr<T>(kind));
+}
+
+// 深度相机图像中的深度（米）
+template <typename ImageT>
+static boost::shared_ptr<ImageArray<float>> GetDepthInMeters(const ImageT &self) {
+  static_assert(sizeof(typename ImageT::value_type) == 4u, "Expected BGRA8 pixels");
+  carla::PythonUtil::ReleaseGIL unlock;
+  auto result = boost::make_shared<ImageArray<float>>();
+  result->Width = self.GetWidth();
+  result->Height = self.GetHeight();
+  result->resize(self.size());
+  carla::image::PixelConverter::DepthToMeters(
+      reinterpret_cast<const uint8_t *>(self.data()), self.size(), result->data());
+  return result;
+}
+
+// 语义分割相机图像中的标签
+template <typename ImageT>
+static boost::shared_ptr<ImageArray<uint8_t>> GetSemanticLabels(const ImageT &self) {
+  static_assert(sizeof(typename ImageT::value_type) == 4u, "Expected BGRA8 pixels");
+  carla::PythonUtil::ReleaseGIL unlock;
+  auto result = boost::make_shared<ImageArray<uint8_t>>();
+  result->Width = self.GetWidth();
+  result->Height = self.GetHeight();
+  result->resize(self.size());
+  carla::image::PixelConverter::ExtractLabels(
+      reinterpret_cast<const uint8_t *>(self.data()), self.size(), result->data());
+  return result;
+}
+
+// 实例分割图像中每个像素的实例 id
+static boost::shared_ptr<ImageArray<uint32_t>> GetInstanceIds(const csd::InstanceSegmentationImage &self) {
+  carla::PythonUtil::ReleaseGIL unlock;
+  auto result = boost::make_shared<ImageArray<uint32_t>>();
+  result->Width = self.GetWidth();
+  result->Height = self.GetHeight();
+  result->resize(self.size());
+  std::transform(self.begin(), self.end(), result->begin(), [](const csd::Color &pixel) {
+    return csd::InstanceSegmentationImage::GetInstanceId(pixel);
+  });
+  return result;
+}
+
+// 实例分割图像的 R 通道高位是实例 id，只取其中的语义标签
+static boost::shared_ptr<ImageArray<uint8_t>> GetInstanceLabels(const csd::InstanceSegmentationImage &self) {
+  carla::PythonUtil::ReleaseGIL unlock;
+  auto result = boost::make_shared<ImageArray<uint8_t>>();
+  result->Width = self.GetWidth();
+  result->Height = self.GetHeight();
+  result->resize(self.size());
+  std::transform(self.begin(), self.end(), result->begin(), [](const csd::Color &pixel) {
+    return csd::InstanceSegmentationImage::GetLabel(pixel);
+  });
+  return result;
+}
+
 // FakeImage类，继承自std::vector<uint8_t>，用于表示从光学流转换为颜色后的图像  
 class FakeImage : public std::vector<uint8_t> {  
   public:  
@@ -422,11 +637,13 @@ static FakeImage ColorCodedFlow(
   }
   return result;
 }
-// 定义一个保存图像到磁盘的模板函数
+// 将图像按指定的颜色转换写入磁盘，返回写入的路径
 template <typename T>
-static std::string SaveImageToDisk(T &self, std::string path, EColorConverter cc) {
-  // 释放 Python GIL（全局解释器锁），以便在 C++ 中执行多线程操作
-  carla::PythonUtil::ReleaseGIL unlock;
+static std::string WriteImage(
+    T &self,
+    std::string path,
+    EColorConverter cc,
+    const carla::image::io::write_options &options) {
   using namespace carla::image;
   // 将图像数据转换为图像视图
   auto view = ImageView::MakeView(self);
@@ -435,29 +652,135 @@ static std::string SaveImageToDisk(T &self, std::string path, EColorConverter cc
     case EColorConverter::Raw:
       return ImageIO::WriteView(
           std::move(path),
-          view);
+          view,
+          options);
     case EColorConverter::Depth:
       return ImageIO::WriteView(
           std::move(path),
-          ImageView::MakeColorConvertedView(view, ColorConverter::Depth()));
+          ImageView::MakeColorConvertedView(view, ColorConverter::Depth()),
+          options);
     case EColorConverter::LogarithmicDepth:
       return ImageIO::WriteView(
           std::move(path),
-          ImageView::MakeColorConvertedView(view, ColorConverter::LogarithmicDepth()));
+          ImageView::MakeColorConvertedView(view, ColorConverter::LogarithmicDepth()),
+          options);
     case EColorConverter::CityScapesPalette:
       return ImageIO::WriteView(
           std::move(path),
-          ImageView::MakeColorConvertedView(view, ColorConverter::CityScapesPalette()));
+          ImageView::MakeColorConvertedView(view, ColorConverter::CityScapesPalette()),
+          options);
     default:
       throw std::invalid_argument("invalid color converter!");
   }
 }
 
+// ShutdownImageWriter() 调用之后为 true。只在持有 GIL 时读写，因此检查它和
+// 获取 AsyncImageWriter 实例之间不会插入 Shutdown()
+static bool IMAGE_WRITER_SHUT_DOWN = false;
+
+// 定义一个保存图像到磁盘的模板函数。asynchronous 为 true 时颜色转换和编码在
+// 后台线程中进行，立即返回；写入结束后以 (path, error) 调用 callback。解释器
+// 退出（ShutdownImageWriter）之后改为同步写入，callback 在当前线程中调用
+template <typename T>
+static std::string SaveImageToDisk(
+    T &self,
+    std::string path,
+    EColorConverter cc,
+    bool asynchronous,
+    boost::python::object callback,
+    bool fast_encoding) {
+  namespace py = boost::python;
+  using carla::image::AsyncImageWriter;
+  const auto options = fast_encoding ?
+      carla::image::io::write_options::fast() :
+      carla::image::io::write_options();
+  if (asynchronous && !callback.is_none() && !PyCallable_Check(callback.ptr())) {
+    PyErr_SetString(PyExc_TypeError, "callback argument must be callable!");
+    py::throw_error_already_set();
+  }
+  if (asynchronous && IMAGE_WRITER_SHUT_DOWN) {
+    std::string written;
+    std::string error;
+    {
+      carla::PythonUtil::ReleaseGIL unlock;
+      try {
+        written = WriteImage(self, path, cc, options);
+      } catch (const std::exception &e) {
+        error = e.what();
+      }
+    }
+    if (!callback.is_none()) {
+      try {
+        py::call<void>(callback.ptr(), written, error);
+      } catch (const py::error_already_set &) {
+        PyErr_Print();
+      }
+    }
+    return path;
+  }
+  if (!asynchronous) {
+    // 释放 Python GIL（全局解释器锁），以便在 C++ 中执行多线程操作
+    carla::PythonUtil::ReleaseGIL unlock;
+    return WriteImage(self, std::move(path), cc, options);
+  }
+  AsyncImageWriter::CallbackFunctionType on_written;
+  if (!callback.is_none()) {
+    // 回调在工作线程中调用和删除，两者都需要持有 GIL
+    using Deleter = carla::PythonUtil::AcquireGILDeleter;
+    auto callback_ptr = carla::SharedPtr<py::object>{new py::object(callback), Deleter()};
+    on_written = [callback=std::move(callback_ptr)](const std::string &written, const std::string &error) {
+      carla::PythonUtil::AcquireGIL lock;
+      try {
+        py::call<void>(callback->ptr(), written, error);
+      } catch (const py::error_already_set &) {
+        PyErr_Print();
+      }
+    };
+  }
+  // 任务持有图像直到写入结束
+  auto image = boost::static_pointer_cast<T>(self.shared_from_this());
+  // 在释放 GIL 之前获取实例，Shutdown() 会等待它的 Push() 完成
+  auto writer = AsyncImageWriter::Get();
+  carla::PythonUtil::ReleaseGIL unlock;
+  writer->Push([image, path, cc, options]() {
+    return WriteImage(*image, path, cc, options);
+  }, std::move(on_written));
+  return path;
+}
+
+// 等待 save_to_disk(asynchronous=True) 的所有后台写入及其回调完成
+static void WaitForImageWrites() {
+  if (IMAGE_WRITER_SHUT_DOWN) {
+    return;
+  }
+  auto writer = carla::image::AsyncImageWriter::Get();
+  carla::PythonUtil::ReleaseGIL unlock;
+  writer->Wait();
+}
+
+// 在解释器退出时调用，结束后台写入的工作线程，回调不会在解释器销毁之后执行
+static void ShutdownImageWriter() {
+  IMAGE_WRITER_SHUT_DOWN = true;
+  carla::PythonUtil::ReleaseGIL unlock;
+  carla::image::AsyncImageWriter::Shutdown();
+}
+
 template <typename T>
 // 定义一个静态函数 SavePointCloudToDisk，用于将点云数据保存到磁盘
-static std::string SavePointCloudToDisk(T &self, std::string path) {
+static std::string SavePointCloudToDisk(
+    T &self,
+    std::string path,
+    carla::pointcloud::PointCloudIO::Format format,
+    bool asynchronous) {
+  carla::PythonUtil::ReleaseGIL unlock;
+  return carla::pointcloud::PointCloudIO::SaveToDisk(
+      std::move(path), self.begin(), self.end(), format, asynchronous);
+}
+
+// 等待 save_to_disk(asynchronous=True) 的所有后台写入完成
+static void WaitForPointCloudWrites() {
   carla::PythonUtil::ReleaseGIL unlock;
-  return carla::pointcloud::PointCloudIO::SaveToDisk(std::move(path), self.begin(), self.end());
+  carla::pointcloud::PointCloudIO::WaitForPendingWrites();
 }
 
 static boost::python::dict GetCAMData(const carla::sensor::data::CAMData message)
@@ -510,6 +833,33 @@ void export_sensor_data() {
       .add_property("fov", &FakeImage::FOV)
       .add_property("raw_data", &GetRawDataAsBuffer<FakeImage>);
 
+  class_<ImageArray<float>, boost::shared_ptr<ImageArray<float>>>("ImageFloatArray", no_init)
+    .add_property("width", &ImageArray<float>::Width)
+    .add_property("height", &ImageArray<float>::Height)
+    .add_property("__array_interface__", +[](ImageArray<float> &self) {
+      return GetPlaneArrayInterface(self, 'f');
+    })
+    .def("__len__", &ImageArray<float>::size)
+  ;
+
+  class_<ImageArray<uint8_t>, boost::shared_ptr<ImageArray<uint8_t>>>("ImageUInt8Array", no_init)
+    .add_property("width", &ImageArray<uint8_t>::Width)
+    .add_property("height", &ImageArray<uint8_t>::Height)
+    .add_property("__array_interface__", +[](ImageArray<uint8_t> &self) {
+      return GetPlaneArrayInterface(self, 'u');
+    })
+    .def("__len__", &ImageArray<uint8_t>::size)
+  ;
+
+  class_<ImageArray<uint32_t>, boost::shared_ptr<ImageArray<uint32_t>>>("ImageUInt32Array", no_init)
+    .add_property("width", &ImageArray<uint32_t>::Width)
+    .add_property("height", &ImageArray<uint32_t>::Height)
+    .add_property("__array_interface__", +[](ImageArray<uint32_t> &self) {
+      return GetPlaneArrayInterface(self, 'u');
+    })
+    .def("__len__", &ImageArray<uint32_t>::size)
+  ;
+
   class_<cs::SensorData, boost::noncopyable, boost::shared_ptr<cs::SensorData>>("SensorData", no_init)
     .add_property("frame", &cs::SensorData::GetFrame)
     .add_property("frame_number", &cs::SensorData::GetFrame) // deprecated.
@@ -517,6 +867,22 @@ void export_sensor_data() {
     .add_property("transform", CALL_RETURNING_COPY(cs::SensorData, GetSensorTransform))
   ;
 
+  class_<cs::LazySensorData, boost::noncopyable, boost::shared_ptr<cs::LazySensorData>>("LazySensorData", no_init)
+    .add_property("frame", &cs::LazySensorData::GetFrame)
+    .add_property("timestamp", &cs::LazySensorData::GetTimestamp)
+    .add_property("transform", CALL_RETURNING_COPY(cs::LazySensorData, GetSensorTransform))
+    .add_property("is_materialized", &cs::LazySensorData::IsMaterialized)
+    .def("get", &cs::LazySensorData::Get)
+  ;
+
+  using PointCloudFormat = carla::pointcloud::PointCloudIO::Format;
+  enum_<PointCloudFormat>("PointCloudFormat")
+    .value("PlyAscii", PointCloudFormat::PlyAscii)
+    .value("PlyBinary", PointCloudFormat::PlyBinary)
+    .value("Npy", PointCloudFormat::Npy)
+    .value("Raw", PointCloudFormat::Raw)
+  ;
+
   enum_<EColorConverter>("ColorConverter")
     .value("Raw", EColorConverter::Raw)
     .value("Depth", EColorConverter::Depth)
@@ -542,13 +908,45 @@ void export_sensor_data() {
     .value("CustomStencil", 12)
   ;
 
+  class_<csd::GBufferMultipart, bases<cs::SensorData>, boost::noncopyable, boost::shared_ptr<csd::GBufferMultipart>>("GBufferMultipart", no_init)
+    .add_property("width", &csd::GBufferMultipart::GetWidth)
+    .add_property("height", &csd::GBufferMultipart::GetHeight)
+    .add_property("fov", &csd::GBufferMultipart::GetFOVAngle)
+    .add_property("raw_data", &GetRawDataAsBuffer<csd::GBufferMultipart>)
+    .def("has_texture", &csd::GBufferMultipart::HasTexture, (arg("gbuffer_id")))
+    .def("get_texture", +[](csd::GBufferMultipart &self, uint32_t id) -> boost::python::object {
+      // 不拷贝数据，返回的 memoryview 引用消息中该纹理的 BGRA 像素
+      const auto *texture = self.GetTexture(id);
+      if (texture == nullptr) {
+        return boost::python::object();
+      }
+      auto *data = reinterpret_cast<const char *>(texture);
+      auto size = static_cast<Py_ssize_t>(sizeof(csd::Color) * self.GetTextureSize());
+#if PY_MAJOR_VERSION >= 3
+      auto *ptr = PyMemoryView_FromMemory(const_cast<char *>(data), size, PyBUF_READ);
+#else
+      auto *ptr = PyBuffer_FromMemory(const_cast<char *>(data), size);
+#endif
+      return boost::python::object(boost::python::handle<>(ptr));
+    }, (arg("gbuffer_id")))
+    .def("__len__", &csd::GBufferMultipart::GetTextureCount)
+    .def(self_ns::str(self_ns::self))
+  ;
+
   class_<csd::Image, bases<cs::SensorData>, boost::noncopyable, boost::shared_ptr<csd::Image>>("Image", no_init)
     .add_property("width", &csd::Image::GetWidth)
     .add_property("height", &csd::Image::GetHeight)
     .add_property("fov", &csd::Image::GetFOVAngle)
     .add_property("raw_data", &GetRawDataAsBuffer<csd::Image>)
+    .add_property("__array_interface__", +[](csd::Image &self) {
+      return GetImageArrayInterface<csd::Image, uint8_t>(self, 'u');
+    })
     .def("convert", &ConvertImage<csd::Image>, (arg("color_converter")))
-    .def("save_to_disk", &SaveImageToDisk<csd::Image>, (arg("path"), arg("color_converter")=EColorConverter::Raw))
+    .def("get_depth_in_meters", &GetDepthInMeters<csd::Image>)
+    .def("get_semantic_labels", &GetSemanticLabels<csd::Image>)
+    .def("save_to_disk", &SaveImageToDisk<csd::Image>, (arg("path"), arg("color_converter")=EColorConverter::Raw, arg("asynchronous")=false, arg("callback")=object(), arg("fast_encoding")=false))
+    .def("wait_for_pending_writes", &WaitForImageWrites)
+    .staticmethod("wait_for_pending_writes")
     .def("__len__", &csd::Image::size)
     .def("__iter__", iterator<csd::Image>())
     .def("__getitem__", +[](const csd::Image &self, size_t pos) -> csd::Color {
@@ -560,11 +958,27 @@ void export_sensor_data() {
     .def(self_ns::str(self_ns::self))
   ;
 
+  class_<csd::InstanceSegmentationImage, bases<csd::Image>, boost::noncopyable, boost::shared_ptr<csd::InstanceSegmentationImage>>("InstanceSegmentationImage", no_init)
+    .add_property("instance_table", +[](const csd::InstanceSegmentationImage &self) {
+      boost::python::dict result;
+      for (const auto &entry : self.GetInstanceTable()) {
+        result[entry.instance_id] = entry.actor_id;
+      }
+      return result;
+    })
+    .def("get_actor_id", &csd::InstanceSegmentationImage::GetActorId, (arg("instance_id")))
+    .def("get_instance_ids", &GetInstanceIds)
+    .def("get_semantic_labels", &GetInstanceLabels)
+  ;
+
   class_<csd::OpticalFlowImage, bases<cs::SensorData>, boost::noncopyable, boost::shared_ptr<csd::OpticalFlowImage>>("OpticalFlowImage", no_init)
     .add_property("width", &csd::OpticalFlowImage::GetWidth)
     .add_property("height", &csd::OpticalFlowImage::GetHeight)
     .add_property("fov", &csd::OpticalFlowImage::GetFOVAngle)
     .add_property("raw_data", &GetRawDataAsBuffer<csd::OpticalFlowImage>)
+    .add_property("__array_interface__", +[](csd::OpticalFlowImage &self) {
+      return GetImageArrayInterface<csd::OpticalFlowImage, float>(self, 'f');
+    })
     .def("get_color_coded_flow", &ColorCodedFlow)
     .def("__len__", &csd::OpticalFlowImage::size)
     .def("__iter__", iterator<csd::OpticalFlowImage>())
@@ -577,12 +991,29 @@ void export_sensor_data() {
     .def(self_ns::str(self_ns::self))
   ;
 
+  enum_<csd::CompressedImage::Format>("CompressedImageFormat")
+    .value("JPEG", csd::CompressedImage::Format::JPEG)
+  ;
+
+  class_<csd::CompressedImage, bases<cs::SensorData>, boost::noncopyable, boost::shared_ptr<csd::CompressedImage>>("CompressedImage", no_init)
+    .add_property("width", &csd::CompressedImage::GetWidth)
+    .add_property("height", &csd::CompressedImage::GetHeight)
+    .add_property("fov", &csd::CompressedImage::GetFOVAngle)
+    .add_property("format", &csd::CompressedImage::GetFormat)
+    .add_property("raw_data", &GetRawDataAsBuffer<csd::CompressedImage>)
+    .def("__len__", &csd::CompressedImage::size)
+    .def(self_ns::str(self_ns::self))
+  ;
+
   class_<csd::LidarMeasurement, bases<cs::SensorData>, boost::noncopyable, boost::shared_ptr<csd::LidarMeasurement>>("LidarMeasurement", no_init)
     .add_property("horizontal_angle", &csd::LidarMeasurement::GetHorizontalAngle)
     .add_property("channels", &csd::LidarMeasurement::GetChannelCount)
     .add_property("raw_data", &GetRawDataAsBuffer<csd::LidarMeasurement>)
+    .add_property("__array_interface__", &GetFloatArrayInterface<csd::LidarMeasurement>)
     .def("get_point_count", &csd::LidarMeasurement::GetPointCount, (arg("channel")))
-    .def("save_to_disk", &SavePointCloudToDisk<csd::LidarMeasurement>, (arg("path")))
+    .def("save_to_disk", &SavePointCloudToDisk<csd::LidarMeasurement>, (arg("path"), arg("format")=PointCloudFormat::PlyAscii, arg("asynchronous")=false))
+    .def("wait_for_pending_writes", &WaitForPointCloudWrites)
+    .staticmethod("wait_for_pending_writes")
     .def("__len__", &csd::LidarMeasurement::size)
     .def("__iter__", iterator<csd::LidarMeasurement>())
     .def("__getitem__", +[](const csd::LidarMeasurement &self, size_t pos) -> csd::LidarDetection {
@@ -598,8 +1029,11 @@ void export_sensor_data() {
     .add_property("horizontal_angle", &csd::SemanticLidarMeasurement::GetHorizontalAngle)
     .add_property("channels", &csd::SemanticLidarMeasurement::GetChannelCount)
     .add_property("raw_data", &GetRawDataAsBuffer<csd::SemanticLidarMeasurement>)
+    .add_property("__array_interface__", &GetSemanticLidarArrayInterface)
     .def("get_point_count", &csd::SemanticLidarMeasurement::GetPointCount, (arg("channel")))
-    .def("save_to_disk", &SavePointCloudToDisk<csd::SemanticLidarMeasurement>, (arg("path")))
+    .def("save_to_disk", &SavePointCloudToDisk<csd::SemanticLidarMeasurement>, (arg("path"), arg("format")=PointCloudFormat::PlyAscii, arg("asynchronous")=false))
+    .def("wait_for_pending_writes", &WaitForPointCloudWrites)
+    .staticmethod("wait_for_pending_writes")
     .def("__len__", &csd::SemanticLidarMeasurement::size)
     .def("__iter__", iterator<csd::SemanticLidarMeasurement>())
     .def("__getitem__", +[](const csd::SemanticLidarMeasurement &self, size_t pos) -> csd::SemanticLidarDetection {
@@ -647,6 +1081,7 @@ void export_sensor_data() {
 
   class_<csd::RadarMeasurement, bases<cs::SensorData>, boost::noncopyable, boost::shared_ptr<csd::RadarMeasurement>>("RadarMeasurement", no_init)
     .add_property("raw_data", &GetRawDataAsBuffer<csd::RadarMeasurement>)
+    .add_property("__array_interface__", &GetFloatArrayInterface<csd::RadarMeasurement>)
     .def("get_detection_count", &csd::RadarMeasurement::GetDetectionAmount)
     .def("__len__", &csd::RadarMeasurement::size)
     .def("__iter__", iterator<csd::RadarMeasurement>())
@@ -667,6 +1102,38 @@ void export_sensor_data() {
     .def(self_ns::str(self_ns::self))
   ;
 
+  class_<csd::VehicleTelemetryMeasurement, bases<cs::SensorData>, boost::noncopyable, boost::shared_ptr<csd::VehicleTelemetryMeasurement>>("VehicleTelemetryMeasurement", no_init)
+    .add_property("speed", &csd::VehicleTelemetryMeasurement::GetSpeed)
+    .add_property("steer", &csd::VehicleTelemetryMeasurement::GetSteer)
+    .add_property("throttle", &csd::VehicleTelemetryMeasurement::GetThrottle)
+    .add_property("brake", &csd::VehicleTelemetryMeasurement::GetBrake)
+    .add_property("engine_rpm", &csd::VehicleTelemetryMeasurement::GetEngineRPM)
+    .add_property("gear", &csd::VehicleTelemetryMeasurement::GetGear)
+    .add_property("drag", &csd::VehicleTelemetryMeasurement::GetDrag)
+    .add_property("raw_data", &GetRawDataAsBuffer<csd::VehicleTelemetryMeasurement>)
+    .def("__len__", &csd::VehicleTelemetryMeasurement::size)
+    .def("__iter__", iterator<csd::VehicleTelemetryMeasurement>())
+    .def("__getitem__", +[](const csd::VehicleTelemetryMeasurement &self, size_t pos) -> csd::WheelTelemetry {
+      return self.at(pos);
+    })
+    .def(self_ns::str(self_ns::self))
+  ;
+
+  class_<csd::WheelTelemetry>("WheelTelemetry")
+    .def_readonly("tire_friction", &csd::WheelTelemetry::tire_friction)
+    .def_readonly("lat_slip", &csd::WheelTelemetry::lat_slip)
+    .def_readonly("long_slip", &csd::WheelTelemetry::long_slip)
+    .def_readonly("omega", &csd::WheelTelemetry::omega)
+    .def_readonly("tire_load", &csd::WheelTelemetry::tire_load)
+    .def_readonly("normalized_tire_load", &csd::WheelTelemetry::normalized_tire_load)
+    .def_readonly("torque", &csd::WheelTelemetry::torque)
+    .def_readonly("long_force", &csd::WheelTelemetry::long_force)
+    .def_readonly("lat_force", &csd::WheelTelemetry::lat_force)
+    .def_readonly("normalized_long_force", &csd::WheelTelemetry::normalized_long_force)
+    .def_readonly("normalized_lat_force", &csd::WheelTelemetry::normalized_lat_force)
+    .def(self_ns::str(self_ns::self))
+  ;
+
   class_<csd::LidarDetection>("LidarDetection")
     .def_readwrite("point", &csd::LidarDetection::point)
     .def_readwrite("intensity", &csd::LidarDetection::intensity)
@@ -694,6 +1161,7 @@ void export_sensor_data() {
     .add_property("height", &csd::DVSEventArray::GetHeight)
     .add_property("fov", &csd::DVSEventArray::GetFOVAngle)
     .add_property("raw_data", &GetRawDataAsBuffer<csd::DVSEventArray>)
+    .add_property("__array_interface__", &GetDVSArrayInterface)
     .def("__len__", &csd::DVSEventArray::size)
     .def("__iter__", iterator<csd::DVSEventArray>())
     .def("__getitem__", +[](const csd::DVSEventArray &self, size_t pos) -> csd::DVSEvent {
@@ -740,4 +1208,8 @@ void export_sensor_data() {
       return self.at(pos);
     })
   ;
+
+  // 解释器退出之前结束图像写入的后台线程，save_to_disk 的回调不会在解释器
+  // 销毁之后执行
+  import("atexit").attr("register")(make_function(&ShutdownImageWriter));
 }
@@ -7,6 +7,9 @@
 #include <chrono> // 包含处理时间的标准库
 #include <memory> // 包含智能指针等内存管理功能的标准库
 #include <stdio.h> // 包含标准输入输出功能的库
+#include <stdexcept> // 包含标准异常类型
+#include <string> // 包含字符串类型
+#include <unordered_map> // 包含无序映射容器，用于按名称查找批量设置项
 #include "carla/PythonUtil.h" // 可能是CARLA的Python工具头文件，用于Python与C++交互
 #include "boost/python/suite/indexing/vector_indexing_suite.hpp" // Boost.Python库，用于使C++ std::vector可在Python中索引
  
@@ -57,18 +60,23 @@ std::vector<uint8_t> RoadOptionToUint(boost::python::list input) {
  
 // 设置自定义路径
 void InterSetCustomPath(carla::traffic_manager::TrafficManager& self, const ActorPtr &actor, boost::python::list input, bool empty_buffer) {
-  self.SetCustomPath(actor, PythonLitstToVector<carla::geom::Location>(input), empty_buffer); // 调用TrafficManager的SetCustomPath方法，注意PythonLitstToVector函数未在代码中定义，可能是自定义的转换函数
+  auto path = PythonLitstToVector<carla::geom::Location>(input);
+  carla::PythonUtil::ReleaseGIL unlock;
+  self.SetCustomPath(actor, path, empty_buffer); // 调用TrafficManager的SetCustomPath方法，注意PythonLitstToVector函数未在代码中定义，可能是自定义的转换函数
 }
  
 // 设置导入的路线
 void InterSetImportedRoute(carla::traffic_manager::TrafficManager& self, const ActorPtr &actor, boost::python::list input, bool empty_buffer) {
-  self.SetImportedRoute(actor, RoadOptionToUint(input), empty_buffer); // 调用TrafficManager的SetImportedRoute方法，将Python列表转换为uint8_t的vector作为输入
+  auto route = RoadOptionToUint(input);
+  carla::PythonUtil::ReleaseGIL unlock;
+  self.SetImportedRoute(actor, route, empty_buffer); // 调用TrafficManager的SetImportedRoute方法，将Python列表转换为uint8_t的vector作为输入
 }
  
 // 获取下一个动作
 boost::python::list InterGetNextAction(carla::traffic_manager::TrafficManager& self, const ActorPtr &actor_ptr) {
   boost::python::list l; // 用于存储返回结果的Python列表
-  auto next_action = self.GetNextAction(actor_ptr->GetId()); // 调用TrafficManager的GetNextAction方法获取下一个动作
+  auto call = CALL_WITHOUT_GIL_1(carla::traffic_manager::TrafficManager, GetNextAction, ActorId);
+  auto next_action = call(self, actor_ptr->GetId()); // 调用TrafficManager的GetNextAction方法获取下一个动作
   l.append(RoadOptionToString(next_action.first)); // 将动作类型转换为字符串并添加到列表中
   l.append(next_action.second); // 将动作的第二个元素（可能是距离或时间）添加到列表中
   return l;
@@ -77,7 +85,8 @@ boost::python::list InterGetNextAction(carla::traffic_manager::TrafficManager& s
 // 获取动作缓冲区
 boost::python::list InterGetActionBuffer(carla::traffic_manager::TrafficManager& self, const ActorPtr &actor_ptr) {
   boost::python::list l; // 用于存储返回结果的Python列表
-  auto action_buffer = self.GetActionBuffer(actor_ptr->GetId()); // 调用TrafficManager的GetActionBuffer方法获取动作缓冲区
+  auto call = CALL_WITHOUT_GIL_1(carla::traffic_manager::TrafficManager, GetActionBuffer, ActorId);
+  auto action_buffer = call(self, actor_ptr->GetId()); // 调用TrafficManager的GetActionBuffer方法获取动作缓冲区
   for (auto &next_action : action_buffer) { // 遍历动作缓冲区
     boost::python::list temp; // 用于存储单个动作的临时列表
     temp.append(RoadOptionToString(next_action.first)); // 将动作类型转换为字符串并添加到临时列表中
@@ -87,6 +96,113 @@ boost::python::list InterGetActionBuffer(carla::traffic_manager::TrafficManager&
   return l;
 }
 
+// 设置地图分区表，每一项为 (host, port, min_x, min_y, max_x, max_y) 元组
+void InterSetShardMap(carla::traffic_manager::TrafficManager& self, boost::python::list input) {
+  carla::traffic_manager::ShardMap shard_map;
+  for (int i = 0; i < len(input); ++i) { // 遍历输入列表
+    boost::python::object item = input[i];
+    carla::traffic_manager::ShardRegion region;
+    region.host = boost::python::extract<std::string>(item[0]);
+    region.port = boost::python::extract<uint16_t>(item[1]);
+    region.min_x = boost::python::extract<float>(item[2]);
+    region.min_y = boost::python::extract<float>(item[3]);
+    region.max_x = boost::python::extract<float>(item[4]);
+    region.max_y = boost::python::extract<float>(item[5]);
+    shard_map.push_back(std::move(region));
+  }
+  carla::PythonUtil::ReleaseGIL unlock;
+  self.SetShardMap(shard_map);
+}
+
+// 从 carla.Actor 或整数id中取得参与者id
+ActorId ExtractActorId(boost::python::object input) {
+  boost::python::extract<ActorPtr> actor(input);
+  if (actor.check()) {
+    return actor()->GetId();
+  }
+  return boost::python::extract<ActorId>(input);
+}
+
+// 批量设置逐车辆参数，每一项为 (actor, setting, value) 元组，
+// setting 为对应单项设置方法的名称；collision_detection 的元组为 (actor, setting, other_actor, detect_collision)
+void InterApplySettingsBatch(carla::traffic_manager::TrafficManager& self, boost::python::list input) {
+  namespace ctm = carla::traffic_manager;
+  static const std::unordered_map<std::string, ctm::VehicleSetting> settings_by_name = {
+    {"vehicle_percentage_speed_difference", ctm::VehicleSetting::PercentageSpeedDifference},
+    {"set_desired_speed", ctm::VehicleSetting::DesiredSpeed},
+    {"vehicle_lane_offset", ctm::VehicleSetting::LaneOffset},
+    {"update_vehicle_lights", ctm::VehicleSetting::UpdateVehicleLights},
+    {"collision_detection", ctm::VehicleSetting::CollisionDetection},
+    {"auto_lane_change", ctm::VehicleSetting::AutoLaneChange},
+    {"distance_to_leading_vehicle", ctm::VehicleSetting::DistanceToLeadingVehicle},
+    {"ignore_walkers_percentage", ctm::VehicleSetting::PercentageIgnoreWalkers},
+    {"ignore_vehicles_percentage", ctm::VehicleSetting::PercentageIgnoreVehicles},
+    {"ignore_lights_percentage", ctm::VehicleSetting::PercentageRunningLight},
+    {"ignore_signs_percentage", ctm::VehicleSetting::PercentageRunningSign},
+    {"keep_right_rule_percentage", ctm::VehicleSetting::KeepRightPercentage},
+    {"random_left_lanechange_percentage", ctm::VehicleSetting::RandomLeftLaneChangePercentage},
+    {"random_right_lanechange_percentage", ctm::VehicleSetting::RandomRightLaneChangePercentage}
+  };
+
+  ctm::VehicleSettingBatch batch;
+  batch.reserve(static_cast<std::size_t>(len(input)));
+  for (int i = 0; i < len(input); ++i) { // 遍历输入列表
+    boost::python::object item = input[i];
+    const std::string name = boost::python::extract<std::string>(item[1]);
+    const auto it = settings_by_name.find(name);
+    if (it == settings_by_name.end()) {
+      throw std::invalid_argument("unknown traffic manager setting: " + name);
+    }
+    ctm::VehicleSettingCommand command;
+    command.actor_id = ExtractActorId(item[0]);
+    command.setting = it->second;
+    if (command.setting == ctm::VehicleSetting::CollisionDetection) {
+      command.other_actor_id = ExtractActorId(item[2]);
+      command.value = boost::python::extract<bool>(item[3]) ? 1.0f : 0.0f;
+    } else {
+      command.value = boost::python::extract<float>(item[2]);
+    }
+    batch.push_back(command);
+  }
+  carla::PythonUtil::ReleaseGIL unlock;
+  self.ApplySettingsBatch(batch);
+}
+
+// 获取性能统计结果，以字典形式返回，各阶段按名称索引
+boost::python::dict InterGetProfile(carla::traffic_manager::TrafficManager& self) {
+  boost::python::dict result;
+  auto call = CALL_WITHOUT_GIL(carla::traffic_manager::TrafficManager, GetProfile);
+  const auto profile = call(self);
+  result["enabled"] = profile.enabled;
+  result["window_steps"] = profile.window_steps;
+  result["frame_allocations"] = profile.frame_allocations;
+
+  boost::python::dict stages;
+  for (auto &latency : profile.stages) { // 每个阶段的耗时分布，单位为毫秒
+    boost::python::dict stage;
+    stage["samples"] = latency.samples;
+    stage["mean"] = latency.mean;
+    stage["p50"] = latency.p50;
+    stage["p95"] = latency.p95;
+    stage["p99"] = latency.p99;
+    stage["max"] = latency.max;
+    stages[latency.stage] = stage;
+  }
+  result["stages"] = stages;
+
+  boost::python::list outliers;
+  for (auto &outlier : profile.vehicle_outliers) { // 按耗时从高到低排列的离群车辆
+    boost::python::dict vehicle;
+    vehicle["actor_id"] = outlier.actor_id;
+    vehicle["step"] = outlier.step;
+    vehicle["cost"] = outlier.cost;
+    vehicle["dominant_stage"] = outlier.dominant_stage;
+    outliers.append(vehicle);
+  }
+  result["vehicle_outliers"] = outliers;
+  return result;
+}
+
 
 // 导出TrafficManager相关功能的函数
 void export_trafficmanager() {
@@ -96,34 +212,54 @@ void export_trafficmanager() {
 
   class_<ctm::TrafficManager>("TrafficManager", no_init)
     .def("get_port", &ctm::TrafficManager::Port)
-    .def("vehicle_percentage_speed_difference", &ctm::TrafficManager::SetPercentageSpeedDifference, (arg("actor"), arg("percentage")))
-    .def("vehicle_lane_offset", &ctm::TrafficManager::SetLaneOffset, (arg("actor"), arg("offset")))
-    .def("set_desired_speed", &ctm::TrafficManager::SetDesiredSpeed, (arg("actor"), arg("speed")))
-    .def("global_percentage_speed_difference", &ctm::TrafficManager::SetGlobalPercentageSpeedDifference, (arg("percentage")))
-    .def("global_lane_offset", &ctm::TrafficManager::SetGlobalLaneOffset, (arg("offset")))
-    .def("update_vehicle_lights", &ctm::TrafficManager::SetUpdateVehicleLights, (arg("actor"), arg("do_update")))
-    .def("collision_detection", &ctm::TrafficManager::SetCollisionDetection, (arg("reference_actor"), arg("other_actor"), arg("detect_collision")))
-    .def("force_lane_change", &ctm::TrafficManager::SetForceLaneChange, (arg("actor"), arg("direction")))
-    .def("auto_lane_change", &ctm::TrafficManager::SetAutoLaneChange, (arg("actor"), arg("enable")))
-    .def("distance_to_leading_vehicle", &ctm::TrafficManager::SetDistanceToLeadingVehicle, (arg("actor"), arg("distance")))
-    .def("ignore_walkers_percentage", &ctm::TrafficManager::SetPercentageIgnoreWalkers, (arg("actor"), arg("perc")))
-    .def("ignore_vehicles_percentage", &ctm::TrafficManager::SetPercentageIgnoreVehicles, (arg("actor"), arg("perc")))
-    .def("ignore_lights_percentage", &ctm::TrafficManager::SetPercentageRunningLight, (arg("actor"), arg("perc")))
-    .def("ignore_signs_percentage", &ctm::TrafficManager::SetPercentageRunningSign, (arg("actor"), arg("perc")))
-    .def("set_global_distance_to_leading_vehicle", &ctm::TrafficManager::SetGlobalDistanceToLeadingVehicle, (arg("distance")))
-    .def("keep_right_rule_percentage", &ctm::TrafficManager::SetKeepRightPercentage, (arg("actor"), arg("perc")))
-    .def("random_left_lanechange_percentage", &ctm::TrafficManager::SetRandomLeftLaneChangePercentage, (arg("actor"), arg("percentage")))
-    .def("random_right_lanechange_percentage", &ctm::TrafficManager::SetRandomRightLaneChangePercentage, (arg("actor"), arg("percentage")))
-    .def("set_synchronous_mode", &ctm::TrafficManager::SetSynchronousMode, (arg("mode_switch")))
-    .def("set_hybrid_physics_mode", &ctm::TrafficManager::SetHybridPhysicsMode, (arg("enabled")))
-    .def("set_hybrid_physics_radius", &ctm::TrafficManager::SetHybridPhysicsRadius, (arg("r")))
-    .def("set_random_device_seed", &ctm::TrafficManager::SetRandomDeviceSeed, (arg("value")))
-    .def("set_osm_mode", &carla::traffic_manager::TrafficManager::SetOSMMode, (arg("mode_switch")))
+    .def("vehicle_percentage_speed_difference", WITHOUT_GIL(&ctm::TrafficManager::SetPercentageSpeedDifference), (arg("actor"), arg("percentage")))
+    .def("vehicle_lane_offset", WITHOUT_GIL(&ctm::TrafficManager::SetLaneOffset), (arg("actor"), arg("offset")))
+    .def("set_desired_speed", WITHOUT_GIL(&ctm::TrafficManager::SetDesiredSpeed), (arg("actor"), arg("speed")))
+    .def("global_percentage_speed_difference", WITHOUT_GIL(&ctm::TrafficManager::SetGlobalPercentageSpeedDifference), (arg("percentage")))
+    .def("global_lane_offset", WITHOUT_GIL(&ctm::TrafficManager::SetGlobalLaneOffset), (arg("offset")))
+    .def("update_vehicle_lights", WITHOUT_GIL(&ctm::TrafficManager::SetUpdateVehicleLights), (arg("actor"), arg("do_update")))
+    .def("collision_detection", WITHOUT_GIL(&ctm::TrafficManager::SetCollisionDetection), (arg("reference_actor"), arg("other_actor"), arg("detect_collision")))
+    .def("force_lane_change", WITHOUT_GIL(&ctm::TrafficManager::SetForceLaneChange), (arg("actor"), arg("direction")))
+    .def("auto_lane_change", WITHOUT_GIL(&ctm::TrafficManager::SetAutoLaneChange), (arg("actor"), arg("enable")))
+    .def("distance_to_leading_vehicle", WITHOUT_GIL(&ctm::TrafficManager::SetDistanceToLeadingVehicle), (arg("actor"), arg("distance")))
+    .def("ignore_walkers_percentage", WITHOUT_GIL(&ctm::TrafficManager::SetPercentageIgnoreWalkers), (arg("actor"), arg("perc")))
+    .def("ignore_vehicles_percentage", WITHOUT_GIL(&ctm::TrafficManager::SetPercentageIgnoreVehicles), (arg("actor"), arg("perc")))
+    .def("ignore_lights_percentage", WITHOUT_GIL(&ctm::TrafficManager::SetPercentageRunningLight), (arg("actor"), arg("perc")))
+    .def("ignore_signs_percentage", WITHOUT_GIL(&ctm::TrafficManager::SetPercentageRunningSign), (arg("actor"), arg("perc")))
+    .def("set_global_distance_to_leading_vehicle", WITHOUT_GIL(&ctm::TrafficManager::SetGlobalDistanceToLeadingVehicle), (arg("distance")))
+    .def("keep_right_rule_percentage", WITHOUT_GIL(&ctm::TrafficManager::SetKeepRightPercentage), (arg("actor"), arg("perc")))
+    .def("random_left_lanechange_percentage", WITHOUT_GIL(&ctm::TrafficManager::SetRandomLeftLaneChangePercentage), (arg("actor"), arg("percentage")))
+    .def("random_right_lanechange_percentage", WITHOUT_GIL(&ctm::TrafficManager::SetRandomRightLaneChangePercentage), (arg("actor"), arg("percentage")))
+    .def("set_synchronous_mode", WITHOUT_GIL(&ctm::TrafficManager::SetSynchronousMode), (arg("mode_switch")))
+    .def("set_hybrid_physics_mode", WITHOUT_GIL(&ctm::TrafficManager::SetHybridPhysicsMode), (arg("enabled")))
+    .def("set_hybrid_physics_radius", WITHOUT_GIL(&ctm::TrafficManager::SetHybridPhysicsRadius), (arg("r")))
+    .def("set_random_device_seed", WITHOUT_GIL(&ctm::TrafficManager::SetRandomDeviceSeed), (arg("value")))
+    .def("set_osm_mode", WITHOUT_GIL(&carla::traffic_manager::TrafficManager::SetOSMMode), (arg("mode_switch")))
+    .def("set_stage_threads", WITHOUT_GIL(&carla::traffic_manager::TrafficManager::SetStageThreads), (arg("number_of_threads")))
+    .def("set_pipelined_control", WITHOUT_GIL(&carla::traffic_manager::TrafficManager::SetPipelinedControl), (arg("enabled")))
+    .def("load_agent_plugin", +[](ctm::TrafficManager &self, const std::string &path) {
+      std::vector<std::string> names;
+      {
+        carla::PythonUtil::ReleaseGIL unlock;
+        names = self.LoadAgentPlugin(path);
+      }
+      boost::python::list result;
+      for (const auto &name : names) {
+        result.append(name);
+      }
+      return result;
+    }, (arg("path")))
+    .def("set_agent_policy", WITHOUT_GIL(&ctm::TrafficManager::SetAgentPolicy), (arg("actor"), arg("policy")))
+    .def("set_level_of_detail", WITHOUT_GIL(&carla::traffic_manager::TrafficManager::SetLevelOfDetail), (arg("update_radius"), arg("collision_radius"), arg("update_interval")))
+    .def("set_profiling", WITHOUT_GIL(&carla::traffic_manager::TrafficManager::SetProfiling), (arg("enabled")))
+    .def("get_profile", &InterGetProfile)
+    .def("set_shard_map", &InterSetShardMap, (arg("shard_map")))
+    .def("apply_settings_batch", &InterApplySettingsBatch, (arg("settings")))
     .def("set_path", &InterSetCustomPath, (arg("actor"), arg("path"), arg("empty_buffer")=true))
     .def("set_route", &InterSetImportedRoute, (arg("actor"), arg("path"), arg("empty_buffer")=true))
-    .def("set_respawn_dormant_vehicles", &carla::traffic_manager::TrafficManager::SetRespawnDormantVehicles, (arg("mode_switch")))
-    .def("set_boundaries_respawn_dormant_vehicles", &carla::traffic_manager::TrafficManager::SetBoundariesRespawnDormantVehicles, (arg("lower_bound"), arg("upper_bound")))
+    .def("set_respawn_dormant_vehicles", WITHOUT_GIL(&carla::traffic_manager::TrafficManager::SetRespawnDormantVehicles), (arg("mode_switch")))
+    .def("set_boundaries_respawn_dormant_vehicles", WITHOUT_GIL(&carla::traffic_manager::TrafficManager::SetBoundariesRespawnDormantVehicles), (arg("lower_bound"), arg("upper_bound")))
     .def("get_next_action", &InterGetNextAction, (arg("actor")))
     .def("get_all_actions", &InterGetActionBuffer, (arg("actor")))
-    .def("shut_down", &ctm::TrafficManager::ShutDown);
+    .def("shut_down", WITHOUT_GIL(&ctm::TrafficManager::ShutDown));
 }
@@ -7,11 +7,18 @@
 #include <carla/PythonUtil.h>
 #include <carla/client/Actor.h>
 #include <carla/client/ActorList.h>
+#include <carla/client/SensorGroup.h>
 #include <carla/client/World.h>
+#include <carla/rpc/ActorQuery.h>
 #include <carla/rpc/EnvironmentObject.h>
+#include <carla/rpc/EpisodeInterest.h>
 #include <carla/rpc/ObjectLabel.h>
+#include <carla/rpc/TrafficLightPlan.h>
+#include <carla/rpc/WalkerBonePoses.h>
 
 // 引入标准库中的字符串处理功能
+#include <cstdint>
+#include <future>
 #include <string>
 
 // 引入Boost Python库中的vector容器相关的功能
@@ -55,7 +62,8 @@ namespace rpc {
         << ",max_substep_delta_time=" << settings.max_substep_delta_time
         << ",max_substeps=" << settings.max_substeps
         << ",max_culling_distance=" << settings.max_culling_distance
-        << ",deterministic_ragdolls=" << BoolToStr(settings.deterministic_ragdolls) << ')';
+        << ",deterministic_ragdolls=" << BoolToStr(settings.deterministic_ragdolls)
+        << ",max_physics_delta_time=" << settings.max_physics_delta_time << ')';
     return out;
   }
 
@@ -69,6 +77,14 @@ namespace rpc {
     return out;
   }
 
+  std::ostream &operator<<(std::ostream &out, const SignTriggerEvent &event) {
+    out << "SignTriggerEvent(vehicle_id=" << event.vehicle
+        << ", sign_id=" << event.sign
+        << ", opendrive_id=" << event.opendrive_id
+        << ", entered=" << (event.entered ? "True" : "False") << ')';
+    return out;
+  }
+
 } // namespace rpc
 } // namespace carla
 
@@ -91,12 +107,99 @@ static auto Tick(carla::client::World &world, double seconds) {
   return world.Tick(TimeDurationFromSeconds(seconds));
 }
 
+// 在持有GIL时兑现Python的future，调用者可能已经取消了它
+static void SetFutureResult(boost::python::object &future, const char *method, boost::python::object value) {
+  if (!boost::python::extract<bool>(future.attr("done")())) {
+    future.attr(method)(value);
+  }
+}
+
+static boost::python::object MakeRuntimeError(const std::string &message) {
+  namespace py = boost::python;
+  return py::object(py::handle<>(py::borrowed(PyExc_RuntimeError)))(message);
+}
+
+// 发送节拍命令后立即返回concurrent.futures.Future，收到该帧时以帧号兑现，
+// 可以用 asyncio.wrap_future 在事件循环中等待而无需额外的线程
+static boost::python::object TickAsync(carla::client::World &world) {
+  namespace py = boost::python;
+  py::object future = py::import("concurrent.futures").attr("Future")();
+  // 回调随剧集切换被丢弃时future尚未兑现，此时以异常兑现，避免等待者永远阻塞
+  auto future_ptr = carla::SharedPtr<py::object>{new py::object(future), [](py::object *ptr) {
+    carla::PythonUtil::AcquireGIL lock;
+    try {
+      SetFutureResult(*ptr, "set_exception", MakeRuntimeError("episode changed before the tick arrived"));
+    } catch (const py::error_already_set &) {
+      PyErr_Print();
+    }
+    delete ptr;
+  }};
+  {
+    carla::PythonUtil::ReleaseGIL unlock;
+    world.TickAsync([future_ptr](const std::shared_future<uint64_t> &result) {
+      carla::PythonUtil::AcquireGIL lock;
+      try {
+        try {
+          const uint64_t frame = result.get();
+          SetFutureResult(*future_ptr, "set_result", py::object(frame));
+        } catch (const std::exception &e) {
+          SetFutureResult(*future_ptr, "set_exception", MakeRuntimeError(e.what()));
+        }
+      } catch (const py::error_already_set &) {
+        PyErr_Print();
+      }
+    });
+  }
+  return future;
+}
+
 // 将给定的剧集设置应用到世界对象上，操作过程中释放全局解释器锁（GIL），并返回应用设置后的结果
 static auto ApplySettings(carla::client::World &world, carla::rpc::EpisodeSettings settings, double seconds) {
   carla::PythonUtil::ReleaseGIL unlock;
   return world.ApplySettings(settings, TimeDurationFromSeconds(seconds));
 }
 
+static auto CreateSensorGroup(
+    const carla::client::World &,
+    const boost::python::object &sensors,
+    double timeout) {
+  std::vector<carla::SharedPtr<carla::client::Sensor>> sensor_list{
+      boost::python::stl_input_iterator<carla::SharedPtr<carla::client::Sensor>>(sensors),
+      boost::python::stl_input_iterator<carla::SharedPtr<carla::client::Sensor>>()};
+  return carla::MakeShared<carla::client::SensorGroup>(
+      std::move(sensor_list),
+      TimeDurationFromSeconds(timeout));
+}
+
+// 只接收中心参与者周围、指定类型或指定ID的参与者的状态，中心参与者可以是Actor对象或ID
+static void SetEpisodeInterest(
+    carla::client::World &self,
+    const boost::python::object &center_actor,
+    float radius,
+    const boost::python::object &actor_types,
+    const boost::python::object &actor_ids,
+    bool vehicle_extension) {
+  carla::rpc::EpisodeInterest interest;
+  if (!center_actor.is_none()) {
+    boost::python::extract<carla::ActorId> id(center_actor);
+    interest.center_actor = id.check() ?
+        id() :
+        boost::python::extract<carla::client::Actor &>(center_actor)().GetId();
+  }
+  interest.radius = radius;
+  interest.actor_types = {
+      boost::python::stl_input_iterator<std::string>(actor_types),
+      boost::python::stl_input_iterator<std::string>()};
+  interest.actor_ids = {
+      boost::python::stl_input_iterator<carla::ActorId>(actor_ids),
+      boost::python::stl_input_iterator<carla::ActorId>()};
+  if (vehicle_extension) {
+    interest.extensions |= carla::rpc::EpisodeInterest::VehicleExtension;
+  }
+  carla::PythonUtil::ReleaseGIL unlock;
+  self.SetEpisodeInterest(interest);
+}
+
 // 根据给定的演员（Actor）ID列表，从世界对象中获取对应的演员列表，先将Python列表形式的ID转换为C++的向量形式，再获取演员，操作时释放GIL
 static auto GetActorsById(carla::client::World &self, const boost::python::list &actor_ids) {
   std::vector<carla::ActorId> ids{
@@ -106,10 +209,65 @@ static auto GetActorsById(carla::client::World &self, const boost::python::list
   return self.GetActors(ids);
 }
 
+// 发出获取参与者的请求但不等待，多个请求可以同时在途
+static auto GetActorsByIdAsync(carla::client::World &self, const boost::python::list &actor_ids) {
+  std::vector<carla::ActorId> ids{
+      boost::python::stl_input_iterator<carla::ActorId>(actor_ids),
+      boost::python::stl_input_iterator<carla::ActorId>()};
+  carla::PythonUtil::ReleaseGIL unlock;
+  return self.GetActorsAsync(ids);
+}
+
+// 一次调用按列获取多个参与者的属性，Python列表先转换为C++向量
+static auto QueryActors(
+    carla::client::World &self,
+    const boost::python::object &actor_ids,
+    const boost::python::object &fields) {
+  std::vector<carla::ActorId> ids{
+      boost::python::stl_input_iterator<carla::ActorId>(actor_ids),
+      boost::python::stl_input_iterator<carla::ActorId>()};
+  std::vector<std::string> field_names{
+      boost::python::stl_input_iterator<std::string>(fields),
+      boost::python::stl_input_iterator<std::string>()};
+  carla::PythonUtil::ReleaseGIL unlock;
+  return self.QueryActors(ids, field_names);
+}
+
+static const carla::rpc::ActorQueryColumn &GetActorQueryColumn(
+    const carla::rpc::ActorQueryResult &self,
+    const std::string &field) {
+  const auto *column = self.Find(field);
+  if (column == nullptr) {
+    PyErr_SetString(PyExc_KeyError, field.c_str());
+    boost::python::throw_error_already_set();
+  }
+  return *column;
+}
+
+// 按__array_interface__协议描述一列数据，numpy.asarray直接引用这块内存而不复制，
+// 每行只有一个元素时为一维数组
+static boost::python::dict GetActorQueryColumnArrayInterface(const carla::rpc::ActorQueryColumn &self) {
+  const uint16_t probe = 1u;
+  const bool is_little_endian = *reinterpret_cast<const uint8_t *>(&probe) == 1u;
+  boost::python::dict interface;
+  interface["version"] = 3;
+  interface["data"] = boost::python::make_tuple(
+      reinterpret_cast<std::uintptr_t>(self.data.data()),
+      true);
+  interface["shape"] = self.width == 1u ?
+      boost::python::make_tuple(self.size()) :
+      boost::python::make_tuple(self.size(), self.width);
+  interface["typestr"] =
+      std::string{is_little_endian ? '<' : '>', static_cast<char>(self.kind)} +
+      std::to_string(self.element_size);
+  return interface;
+}
+
 // 获取世界对象中所有车辆的灯光状态，并以Python字典形式返回，字典的键为车辆相关标识，值为对应的灯光状态
 static auto GetVehiclesLightStates(carla::client::World &self) {
   boost::python::dict dict;
-  auto list = self.GetVehiclesLightStates();
+  auto call = CALL_WITHOUT_GIL(carla::client::World, GetVehiclesLightStates);
+  auto list = call(self);
   for (auto &vehicle : list) {
     dict[vehicle.first] = vehicle.second;
   }
@@ -118,8 +276,9 @@ static auto GetVehiclesLightStates(carla::client::World &self) {
 
 // 获取世界对象中特定标签对应的关卡边界框（Bounding Boxes）信息，并以Python列表形式返回，方便在Python环境中使用这些数据
 static auto GetLevelBBs(const carla::client::World &self, uint8_t queried_tag) {
+  auto call = CONST_CALL_WITHOUT_GIL_1(carla::client::World, GetLevelBBs, uint8_t);
   boost::python::list result;
-  for (const auto &bb : self.GetLevelBBs(queried_tag)) {
+  for (const auto &bb : call(self, queried_tag)) {
     result.append(bb);
   }
   return result;
@@ -127,8 +286,9 @@ static auto GetLevelBBs(const carla::client::World &self, uint8_t queried_tag) {
 
 // 获取世界对象中特定标签对应的环境对象信息，并以Python列表形式返回，便于在Python中进一步处理这些环境对象相关数据
 static auto GetEnvironmentObjects(const carla::client::World &self, uint8_t queried_tag) {
+  auto call = CONST_CALL_WITHOUT_GIL_1(carla::client::World, GetEnvironmentObjects, uint8_t);
   boost::python::list result;
-  for (const auto &object : self.GetEnvironmentObjects(queried_tag)) {
+  for (const auto &object : call(self, queried_tag)) {
     result.append(object);
   }
   return result;
@@ -148,6 +308,158 @@ static void EnableEnvironmentObjects(
   self.EnableEnvironmentObjects(env_objects_ids, enable);
 }
 
+static boost::python::list GetTrafficLightPlanTimings(const carla::rpc::TrafficLightGroupPlan &self) {
+  boost::python::list result;
+  for (const auto &timing : self.timings) {
+    result.append(timing);
+  }
+  return result;
+}
+
+static void SetTrafficLightPlanTimings(carla::rpc::TrafficLightGroupPlan &self, const boost::python::object &timings) {
+  self.timings = {
+      boost::python::stl_input_iterator<carla::rpc::TrafficLightTiming>(timings),
+      boost::python::stl_input_iterator<carla::rpc::TrafficLightTiming>()};
+}
+
+// lines 为 (begin, end) 的序列，boxes 为 (box, rotation) 的序列
+static void DrawDebugBatch(
+    carla::client::DebugHelper &self,
+    uint64_t id,
+    const boost::python::object &py_lines,
+    const boost::python::object &py_points,
+    const boost::python::object &py_boxes,
+    float thickness,
+    float point_size,
+    carla::client::DebugHelper::Color color) {
+  namespace bp = boost::python;
+  std::vector<std::pair<carla::geom::Location, carla::geom::Location>> lines;
+  for (bp::stl_input_iterator<bp::object> it(py_lines), end; it != end; ++it) {
+    lines.emplace_back(
+        bp::extract<carla::geom::Location>((*it)[0]),
+        bp::extract<carla::geom::Location>((*it)[1]));
+  }
+  std::vector<carla::geom::Location> points {
+    bp::stl_input_iterator<carla::geom::Location>(py_points),
+    bp::stl_input_iterator<carla::geom::Location>()
+  };
+  std::vector<std::pair<carla::geom::BoundingBox, carla::geom::Rotation>> boxes;
+  for (bp::stl_input_iterator<bp::object> it(py_boxes), end; it != end; ++it) {
+    boxes.emplace_back(
+        bp::extract<carla::geom::BoundingBox>((*it)[0]),
+        bp::extract<carla::geom::Rotation>((*it)[1]));
+  }
+  carla::PythonUtil::ReleaseGIL unlock;
+  self.DrawBatch(id, lines, points, boxes, thickness, point_size, color);
+}
+
+static void ApplyTrafficLightPlans(carla::client::World &self, const boost::python::object &py_plans) {
+  std::vector<carla::rpc::TrafficLightGroupPlan> plans {
+    boost::python::stl_input_iterator<carla::rpc::TrafficLightGroupPlan>(py_plans),
+    boost::python::stl_input_iterator<carla::rpc::TrafficLightGroupPlan>()
+  };
+  carla::PythonUtil::ReleaseGIL unlock;
+  self.ApplyTrafficLightPlans(plans);
+}
+
+// 从float32缓冲区（例如numpy数组，形状任意）或者float序列中读取连续的float
+static std::vector<float> ToFloats(const boost::python::object &values) {
+  namespace py = boost::python;
+  Py_buffer view;
+  if (PyObject_GetBuffer(values.ptr(), &view, PyBUF_C_CONTIGUOUS | PyBUF_FORMAT) != 0) {
+    PyErr_Clear();
+    return {py::stl_input_iterator<float>(values), py::stl_input_iterator<float>()};
+  }
+  const std::string format = view.format != nullptr ? view.format : "B";
+  if (!(format == "f" || format == "<f" || format == "=f")) {
+    PyBuffer_Release(&view);
+    PyErr_SetString(PyExc_ValueError, "bone poses must be float32 arrays");
+    py::throw_error_already_set();
+  }
+  const auto *data = reinterpret_cast<const float *>(view.buf);
+  std::vector<float> result(data, data + view.len / sizeof(float));
+  PyBuffer_Release(&view);
+  return result;
+}
+
+// 把float数组作为只读的内存视图返回，可以用numpy.frombuffer(..., dtype=numpy.float32)读取
+static boost::python::object GetFloatsAsBuffer(const std::vector<float> &values) {
+  auto *data = reinterpret_cast<const char *>(values.data());
+  auto size = static_cast<Py_ssize_t>(sizeof(float) * values.size());
+  auto *ptr = PyMemoryView_FromMemory(const_cast<char *>(data), size, PyBUF_READ);
+  return boost::python::object(boost::python::handle<>(ptr));
+}
+
+static boost::python::list GetWalkerBoneNames(const carla::rpc::WalkerBonePoses &self) {
+  boost::python::list result;
+  for (const auto &name : self.bone_names) {
+    result.append(name);
+  }
+  return result;
+}
+
+// 改变骨骼名时清空已经添加的姿态
+static void SetWalkerBoneNames(carla::rpc::WalkerBonePoses &self, const boost::python::object &bone_names) {
+  self.bone_names = {
+      boost::python::stl_input_iterator<std::string>(bone_names),
+      boost::python::stl_input_iterator<std::string>()};
+  self.poses.clear();
+}
+
+static boost::python::list GetWalkerBonePoses(const carla::rpc::WalkerBonePoses &self) {
+  boost::python::list result;
+  for (const auto &pose : self.poses) {
+    result.append(pose);
+  }
+  return result;
+}
+
+static void AddWalkerBonePose(
+    carla::rpc::WalkerBonePoses &self,
+    carla::ActorId walker,
+    const boost::python::object &rotations,
+    const boost::python::object &locations) {
+  carla::rpc::WalkerBonePose pose{walker, ToFloats(rotations), ToFloats(locations)};
+  const size_t count = self.bone_names.size();
+  if (pose.rotations.size() != count * carla::rpc::WalkerBonePose::ROTATION_SIZE ||
+      pose.locations.size() != count * carla::rpc::WalkerBonePose::LOCATION_SIZE) {
+    PyErr_SetString(PyExc_ValueError, "rotations and locations must have 4 and 3 floats per bone name");
+    boost::python::throw_error_already_set();
+  }
+  self.poses.emplace_back(std::move(pose));
+}
+
+static boost::python::list SetWalkersBonesTransform(
+    carla::client::World &self,
+    const carla::rpc::WalkerBonePoses &poses) {
+  std::vector<carla::ActorId> failed;
+  {
+    carla::PythonUtil::ReleaseGIL unlock;
+    failed = self.SetWalkersBonesTransform(poses);
+  }
+  boost::python::list result;
+  for (auto id : failed) {
+    result.append(id);
+  }
+  return result;
+}
+
+static carla::rpc::WalkerBonePoses GetWalkersBonesTransform(
+    const carla::client::World &self,
+    const boost::python::object &py_walkers,
+    const boost::python::object &py_bone_names) {
+  std::vector<carla::ActorId> walkers {
+    boost::python::stl_input_iterator<carla::ActorId>(py_walkers),
+    boost::python::stl_input_iterator<carla::ActorId>()
+  };
+  std::vector<std::string> bone_names {
+    boost::python::stl_input_iterator<std::string>(py_bone_names),
+    boost::python::stl_input_iterator<std::string>()
+  };
+  carla::PythonUtil::ReleaseGIL unlock;
+  return self.GetWalkersBonesTransform(walkers, bone_names);
+}
+
 // 定义函数export_world，用于将Carla相关的一些C++类通过Boost.Python库导出到Python环境，使其能在Python中使用
 void export_world() {
   using namespace boost::python;
@@ -193,7 +505,7 @@ void export_world() {
   // 将cr::EpisodeSettings类型绑定到Python里名为"WorldSettings"的类
   // 定义构造函数及各参数默认值，方便Python中创建对象
   class_<cr::EpisodeSettings>("WorldSettings")
-    .def(init<bool, bool, double, bool, double, int, float, bool, float, float, bool>(
+    .def(init<bool, bool, double, bool, double, int, float, bool, float, float, bool, double>(
         (arg("synchronous_mode")=false,
          arg("no_rendering_mode")=false,
          arg("fixed_delta_seconds")=0.0,
@@ -204,7 +516,8 @@ void export_world() {
          arg("deterministic_ragdolls")=false,
          arg("tile_stream_distance")=3000.f,
          arg("actor_active_distance")=2000.f,
-         arg("spectator_as_ego")=true)))
+         arg("spectator_as_ego")=true,
+         arg("max_physics_delta_time")=1.0 / 3.0)))
     // 暴露C++类中的成员变量为Python类的可读写属性
     .def_readwrite("synchronous_mode", &cr::EpisodeSettings::synchronous_mode)
     .def_readwrite("no_rendering_mode", &cr::EpisodeSettings::no_rendering_mode)
@@ -225,6 +538,7 @@ void export_world() {
     .def_readwrite("tile_stream_distance", &cr::EpisodeSettings::tile_stream_distance)
     .def_readwrite("actor_active_distance", &cr::EpisodeSettings::actor_active_distance)
     .def_readwrite("spectator_as_ego", &cr::EpisodeSettings::spectator_as_ego)
+    .def_readwrite("max_physics_delta_time", &cr::EpisodeSettings::max_physics_delta_time)
      // 绑定相等比较（==）和不等比较（!=）的操作到Python类对应的方法
     .def("__eq__", &cr::EpisodeSettings::operator==)
     .def("__ne__", &cr::EpisodeSettings::operator!=)
@@ -287,6 +601,49 @@ void export_world() {
     .def_readonly("label", &cr::LabelledPoint::_label)
   ;
 
+  class_<cr::TrafficLightTiming>("TrafficLightTiming")
+    .def(init<carla::ActorId, float, float, float>(
+        (arg("traffic_light"), arg("green_time")=10.0f, arg("yellow_time")=3.0f, arg("red_time")=2.0f)))
+    .def_readwrite("traffic_light", &cr::TrafficLightTiming::traffic_light)
+    .def_readwrite("green_time", &cr::TrafficLightTiming::green_time)
+    .def_readwrite("yellow_time", &cr::TrafficLightTiming::yellow_time)
+    .def_readwrite("red_time", &cr::TrafficLightTiming::red_time)
+  ;
+
+  class_<cr::TrafficLightGroupPlan>("TrafficLightGroupPlan")
+    .def_readwrite("traffic_light", &cr::TrafficLightGroupPlan::traffic_light)
+    .add_property("timings", &GetTrafficLightPlanTimings, &SetTrafficLightPlanTimings)
+    .def_readwrite("restart", &cr::TrafficLightGroupPlan::restart)
+    .def_readwrite("offset", &cr::TrafficLightGroupPlan::offset)
+    .def_readwrite("frozen", &cr::TrafficLightGroupPlan::frozen)
+  ;
+
+  class_<cr::SignTriggerEvent>("SignTriggerEvent", no_init)
+    .def_readonly("vehicle_id", &cr::SignTriggerEvent::vehicle)
+    .def_readonly("sign_id", &cr::SignTriggerEvent::sign)
+    .def_readonly("opendrive_id", &cr::SignTriggerEvent::opendrive_id)
+    .def_readonly("entered", &cr::SignTriggerEvent::entered)
+    .def(self_ns::str(self_ns::self))
+  ;
+
+  class_<cr::WalkerBonePose>("WalkerBonePose")
+    .def_readonly("walker", &cr::WalkerBonePose::walker)
+    .add_property("raw_rotations", +[](const cr::WalkerBonePose &self) {
+      return GetFloatsAsBuffer(self.rotations);
+    })
+    .add_property("raw_locations", +[](const cr::WalkerBonePose &self) {
+      return GetFloatsAsBuffer(self.locations);
+    })
+    .def("__len__", &cr::WalkerBonePose::size)
+  ;
+
+  class_<cr::WalkerBonePoses>("WalkerBonePoses")
+    .add_property("bone_names", &GetWalkerBoneNames, &SetWalkerBoneNames)
+    .add_property("poses", &GetWalkerBonePoses)
+    .def("add", &AddWalkerBonePose, (arg("walker"), arg("rotations"), arg("locations")))
+    .def("__len__", +[](const cr::WalkerBonePoses &self) { return self.poses.size(); })
+  ;
+
   enum_<cr::MapLayer>("MapLayer")
     .value("NONE", cr::MapLayer::None)
     .value("Buildings", cr::MapLayer::Buildings)
@@ -351,6 +708,36 @@ void export_world() {
       arg("attachment_type")=cr::AttachmentType::Rigid, \
       arg("bone")=std::string())
 
+  class_<cr::ActorQueryColumn>("ActorQueryColumn", no_init)
+    .def_readonly("field", &cr::ActorQueryColumn::field)
+    .def_readonly("width", &cr::ActorQueryColumn::width)
+    .def("__len__", &cr::ActorQueryColumn::size)
+    .add_property("__array_interface__", &GetActorQueryColumnArrayInterface)
+  ;
+
+  class_<cr::ActorQueryResult>("ActorQueryResult", no_init)
+    .add_property("fields", +[](const cr::ActorQueryResult &self) {
+      boost::python::list result;
+      for (const auto &column : self.columns) {
+        result.append(column.field);
+      }
+      return result;
+    })
+    .def("__len__", &cr::ActorQueryResult::size)
+    .def("__contains__", +[](const cr::ActorQueryResult &self, const std::string &field) {
+      return self.Find(field) != nullptr;
+    })
+    .def("__getitem__", &GetActorQueryColumn, return_internal_reference<>())
+  ;
+
+  using ActorListFuture = std::shared_future<carla::SharedPtr<cc::ActorList>>;
+  class_<ActorListFuture>("ActorListFuture", no_init)
+    .def("get", +[](const ActorListFuture &self) {
+      carla::PythonUtil::ReleaseGIL unlock;
+      return self.get();
+    })
+  ;
+
   class_<cc::World>("World", no_init)
     .add_property("id", &cc::World::GetId)
     .add_property("debug", &cc::World::MakeDebugHelper)
@@ -371,40 +758,61 @@ void export_world() {
     .def("get_actor", CONST_CALL_WITHOUT_GIL_1(cc::World, GetActor, carla::ActorId), (arg("actor_id")))
     .def("get_actors", CONST_CALL_WITHOUT_GIL(cc::World, GetActors))
     .def("get_actors", &GetActorsById, (arg("actor_ids")))
+    .def("get_actors_async", &GetActorsByIdAsync, (arg("actor_ids")))
+    .def("query_actors", &QueryActors, (arg("actor_ids"), arg("fields")))
     .def("spawn_actor", SPAWN_ACTOR_WITHOUT_GIL(SpawnActor))
     .def("try_spawn_actor", SPAWN_ACTOR_WITHOUT_GIL(TrySpawnActor))
+    .def("create_sensor_group", &CreateSensorGroup, (arg("sensors"), arg("timeout")=1.0))
+    .def("set_episode_interest", &SetEpisodeInterest, (arg("center_actor")=object(), arg("radius")=0.0f, arg("actor_types")=list(), arg("actor_ids")=list(), arg("vehicle_extension")=false))
+    .def("clear_episode_interest", CALL_WITHOUT_GIL(cc::World, ClearEpisodeInterest))
     .def("wait_for_tick", &WaitForTick, (arg("seconds")=0.0))
     .def("on_tick", &OnTick, (arg("callback")))
     .def("remove_on_tick", &cc::World::RemoveOnTick, (arg("callback_id")))
     .def("tick", &Tick, (arg("seconds")=0.0))
+    .def("tick_async", &TickAsync)
     .def("set_pedestrians_cross_factor", CALL_WITHOUT_GIL_1(cc::World, SetPedestriansCrossFactor, float), (arg("percentage")))
     .def("set_pedestrians_seed", CALL_WITHOUT_GIL_1(cc::World, SetPedestriansSeed, unsigned int), (arg("seed")))
     .def("get_traffic_sign", CONST_CALL_WITHOUT_GIL_1(cc::World, GetTrafficSign, cc::Landmark), arg("landmark"))
     .def("get_traffic_light", CONST_CALL_WITHOUT_GIL_1(cc::World, GetTrafficLight, cc::Landmark), arg("landmark"))
     .def("get_traffic_light_from_opendrive_id", CONST_CALL_WITHOUT_GIL_1(cc::World, GetTrafficLightFromOpenDRIVE, const carla::road::SignId&), arg("traffic_light_id"))
-    .def("get_traffic_lights_from_waypoint", CALL_RETURNING_LIST_2(cc::World, GetTrafficLightsFromWaypoint, const cc::Waypoint&, double), (arg("waypoint"), arg("distance")))
-    .def("get_traffic_lights_in_junction", CALL_RETURNING_LIST_1(cc::World, GetTrafficLightsInJunction, carla::road::JuncId), (arg("junction_id")))
-    .def("reset_all_traffic_lights", &cc::World::ResetAllTrafficLights)
+    .def("get_traffic_lights_from_waypoint", CALL_RETURNING_LIST_WITHOUT_GIL_2(cc::World, GetTrafficLightsFromWaypoint, const cc::Waypoint&, double), (arg("waypoint"), arg("distance")))
+    .def("get_traffic_lights_in_junction", CALL_RETURNING_LIST_WITHOUT_GIL_1(cc::World, GetTrafficLightsInJunction, carla::road::JuncId), (arg("junction_id")))
+    .def("reset_all_traffic_lights", WITHOUT_GIL(&cc::World::ResetAllTrafficLights))
     .def("get_lightmanager", CONST_CALL_WITHOUT_GIL(cc::World, GetLightManager))
     .def("freeze_all_traffic_lights", &cc::World::FreezeAllTrafficLights, (arg("frozen")))
+    .def("apply_traffic_light_plans", &ApplyTrafficLightPlans, (arg("plans")))
+    .def("set_walkers_bones_transform", &SetWalkersBonesTransform, (arg("poses")))
+    .def("get_walkers_bones_transform", &GetWalkersBonesTransform, (arg("walkers"), arg("bone_names")=list()))
+    .def("get_sign_trigger_events", CALL_RETURNING_LIST_WITHOUT_GIL(cc::World, GetSignTriggerEvents))
+    .def("set_actor_pool_size", CALL_WITHOUT_GIL_1(cc::World, SetActorPoolSize, uint32_t), (arg("size")))
+    .def("save_snapshot", CALL_WITHOUT_GIL(cc::World, SaveSnapshot))
+    .def("restore_snapshot", CALL_WITHOUT_GIL_1(cc::World, RestoreSnapshot, uint64_t), (arg("snapshot_id")))
+    .def("remove_snapshot", CALL_WITHOUT_GIL_1(cc::World, RemoveSnapshot, uint64_t), (arg("snapshot_id")))
+    .def("get_server_profile", CONST_CALL_WITHOUT_GIL_1(cc::World, GetServerProfile, bool), (arg("reset")=false))
     .def("get_level_bbs", &GetLevelBBs, (arg("bb_type")=cr::CityObjectLabel::Any))
     .def("get_environment_objects", &GetEnvironmentObjects, (arg("object_type")=cr::CityObjectLabel::Any))
     .def("enable_environment_objects", &EnableEnvironmentObjects, (arg("env_objects_ids"), arg("enable")))
-    .def("cast_ray", CALL_RETURNING_LIST_2(cc::World, CastRay, cg::Location, cg::Location), (arg("initial_location"), arg("final_location")))
-    .def("project_point", CALL_RETURNING_OPTIONAL_3(cc::World, ProjectPoint, cg::Location, cg::Vector3D, float), (arg("location"), arg("direction"), arg("search_distance")=10000.f))
-    .def("ground_projection", CALL_RETURNING_OPTIONAL_2(cc::World, GroundProjection, cg::Location, float), (arg("location"), arg("search_distance")=10000.f))
-    .def("get_names_of_all_objects", CALL_RETURNING_LIST(cc::World, GetNamesOfAllObjects))
-    .def("apply_color_texture_to_object", &cc::World::ApplyColorTextureToObject, (arg("object_name"), arg("material_parameter"), arg("texture")))
-    .def("apply_float_color_texture_to_object", &cc::World::ApplyFloatColorTextureToObject, (arg("object_name"), arg("material_parameter"), arg("texture")))
-    .def("apply_textures_to_object", &cc::World::ApplyTexturesToObject, (arg("object_name"), arg("diffuse_texture"), arg("emissive_texture"), arg("normal_texture"), arg("ao_roughness_metallic_emissive_texture")))
+    .def("cast_ray", CALL_RETURNING_LIST_WITHOUT_GIL_2(cc::World, CastRay, cg::Location, cg::Location), (arg("initial_location"), arg("final_location")))
+    .def("project_point", CALL_RETURNING_OPTIONAL_WITHOUT_GIL_3(cc::World, ProjectPoint, cg::Location, cg::Vector3D, float), (arg("location"), arg("direction"), arg("search_distance")=10000.f))
+    .def("ground_projection", CALL_RETURNING_OPTIONAL_WITHOUT_GIL_2(cc::World, GroundProjection, cg::Location, float), (arg("location"), arg("search_distance")=10000.f))
+    .def("get_names_of_all_objects", CALL_RETURNING_LIST_WITHOUT_GIL(cc::World, GetNamesOfAllObjects))
+    .def("apply_color_texture_to_object", WITHOUT_GIL(&cc::World::ApplyColorTextureToObject), (arg("object_name"), arg("material_parameter"), arg("texture")))
+    .def("apply_float_color_texture_to_object", WITHOUT_GIL(&cc::World::ApplyFloatColorTextureToObject), (arg("object_name"), arg("material_parameter"), arg("texture")))
+    .def("apply_textures_to_object", WITHOUT_GIL(&cc::World::ApplyTexturesToObject), (arg("object_name"), arg("diffuse_texture"), arg("emissive_texture"), arg("normal_texture"), arg("ao_roughness_metallic_emissive_texture")))
     .def("apply_color_texture_to_objects", +[](cc::World &self, boost::python::list &list, const cr::MaterialParameter& parameter, const cr::TextureColor& Texture) {
-        self.ApplyColorTextureToObjects(PythonLitstToVector<std::string>(list), parameter, Texture);
+        auto names = PythonLitstToVector<std::string>(list);
+        carla::PythonUtil::ReleaseGIL unlock;
+        self.ApplyColorTextureToObjects(names, parameter, Texture);
       }, (arg("objects_name_list"), arg("material_parameter"), arg("texture")))
     .def("apply_float_color_texture_to_objects", +[](cc::World &self, boost::python::list &list, const cr::MaterialParameter& parameter, const cr::TextureFloatColor& Texture) {
-        self.ApplyFloatColorTextureToObjects(PythonLitstToVector<std::string>(list), parameter, Texture);
+        auto names = PythonLitstToVector<std::string>(list);
+        carla::PythonUtil::ReleaseGIL unlock;
+        self.ApplyFloatColorTextureToObjects(names, parameter, Texture);
       }, (arg("objects_name_list"), arg("material_parameter"), arg("texture")))
     .def("apply_textures_to_objects", +[](cc::World &self, boost::python::list &list, const cr::TextureColor& diffuse_texture, const cr::TextureFloatColor& emissive_texture, const cr::TextureFloatColor& normal_texture, const cr::TextureFloatColor& ao_roughness_metallic_emissive_texture) {
-        self.ApplyTexturesToObjects(PythonLitstToVector<std::string>(list), diffuse_texture, emissive_texture, normal_texture, ao_roughness_metallic_emissive_texture);
+        auto names = PythonLitstToVector<std::string>(list);
+        carla::PythonUtil::ReleaseGIL unlock;
+        self.ApplyTexturesToObjects(names, diffuse_texture, emissive_texture, normal_texture, ao_roughness_metallic_emissive_texture);
       }, (arg("objects_name_list"), arg("diffuse_texture"), arg("emissive_texture"), arg("normal_texture"), arg("ao_roughness_metallic_emissive_texture")))
     .def(self_ns::str(self_ns::self))
   ;
@@ -476,6 +884,16 @@ void export_world() {
          arg("color")=cc::DebugHelper::Color(255u, 0u, 0u),
          arg("life_time")=-1.0f,
          arg("persistent_lines")=true))
+    .def("draw_batch", &DrawDebugBatch,
+        (arg("batch_id"),
+         arg("lines")=list(),
+         arg("points")=list(),
+         arg("boxes")=list(),
+         arg("thickness")=0.1f,
+         arg("point_size")=0.1f,
+         arg("color")=cc::DebugHelper::Color(255u, 0u, 0u)))
+    .def("clear_batch", CALL_WITHOUT_GIL_1(cc::DebugHelper, ClearBatch, uint64_t), (arg("batch_id")))
+    .def("clear_all_batches", CALL_WITHOUT_GIL(cc::DebugHelper, ClearAllBatches))
   ;
   // scope HUD = class_<cc::DebugHelper>(
 
@@ -70,6 +70,30 @@ static boost::python::object OptionalToPythonObject(OptionalT &optional) {
 #define CONST_CALL_WITHOUT_GIL_3(cls, fn, T1_, T2_, T3_) CALL_WITHOUT_GIL_3(const cls, fn, T1_, T2_, T3_)
 #define CONST_CALL_WITHOUT_GIL_4(cls, fn, T1_, T2_, T3_, T4_) CALL_WITHOUT_GIL_4(const cls, fn, T1_, T2_, T3_, T4_)
 
+// 释放 GIL 调用成员函数，参数类型从成员函数指针推导，不需要像上面的宏那样
+// 逐个写出。成员函数有重载时不能使用。
+template <typename MemberFunctionT, MemberFunctionT Function>
+struct CallWithoutGIL;
+
+template <typename R, typename C, typename... Args, R (C::*Function)(Args...)>
+struct CallWithoutGIL<R (C::*)(Args...), Function> {
+  static R Invoke(C &self, Args... args) {
+    carla::PythonUtil::ReleaseGIL unlock;
+    return (self.*Function)(std::forward<Args>(args)...);
+  }
+};
+
+template <typename R, typename C, typename... Args, R (C::*Function)(Args...) const>
+struct CallWithoutGIL<R (C::*)(Args...) const, Function> {
+  static R Invoke(const C &self, Args... args) {
+    carla::PythonUtil::ReleaseGIL unlock;
+    return (self.*Function)(std::forward<Args>(args)...);
+  }
+};
+
+// 例如：.def("reset_all_traffic_lights", WITHOUT_GIL(&cc::World::ResetAllTrafficLights))
+#define WITHOUT_GIL(fn) &CallWithoutGIL<decltype(fn), fn>::Invoke
+
 // 方便用于需要复制返回值的const请求。 
 // cls：类名class
 // fn: 函数名function name
@@ -168,6 +192,46 @@ std::vector<T> PythonLitstToVector(boost::python::list &input) {
       return optional.has_value() ? boost::python::object(*optional) : boost::python::object(); \
     }
 
+#define CALL_RETURNING_OPTIONAL_WITHOUT_GIL_2(cls, fn, T1_, T2_) +[](const cls &self, T1_ t1, T2_ t2) { \
+      auto call = CONST_CALL_WITHOUT_GIL_2(cls, fn, T1_, T2_); \
+      auto optional = call(self, std::forward<T1_>(t1), std::forward<T2_>(t2)); \
+      return OptionalToPythonObject(optional); \
+    }
+
+#define CALL_RETURNING_OPTIONAL_WITHOUT_GIL_3(cls, fn, T1_, T2_, T3_) +[](const cls &self, T1_ t1, T2_ t2, T3_ t3) { \
+      auto call = CONST_CALL_WITHOUT_GIL_3(cls, fn, T1_, T2_, T3_); \
+      auto optional = call(self, std::forward<T1_>(t1), std::forward<T2_>(t2), std::forward<T3_>(t3)); \
+      return OptionalToPythonObject(optional); \
+    }
+
+// 与 CALL_RETURNING_LIST 相同，但请求期间释放 GIL，只在构建 Python 列表时持有。
+#define CALL_RETURNING_LIST_WITHOUT_GIL(cls, fn) +[](const cls &self) { \
+      auto call = CONST_CALL_WITHOUT_GIL(cls, fn); \
+      boost::python::list result; \
+      for (auto &&item : call(self)) { \
+        result.append(item); \
+      } \
+      return result; \
+    }
+
+#define CALL_RETURNING_LIST_WITHOUT_GIL_1(cls, fn, T1_) +[](const cls &self, T1_ t1) { \
+      auto call = CONST_CALL_WITHOUT_GIL_1(cls, fn, T1_); \
+      boost::python::list result; \
+      for (auto &&item : call(self, std::forward<T1_>(t1))) { \
+        result.append(item); \
+      } \
+      return result; \
+    }
+
+#define CALL_RETURNING_LIST_WITHOUT_GIL_2(cls, fn, T1_, T2_) +[](const cls &self, T1_ t1, T2_ t2) { \
+      auto call = CONST_CALL_WITHOUT_GIL_2(cls, fn, T1_, T2_); \
+      boost::python::list result; \
+      for (auto &&item : call(self, std::forward<T1_>(t1), std::forward<T2_>(t2))) { \
+        result.append(item); \
+      } \
+      return result; \
+    }
+
 template <typename T>
 static void PrintListItem_(std::ostream &out, const T &item) {
   out << item;
@@ -258,6 +322,8 @@ static auto MakeCallback(boost::python::object callback) {
 #include "TrafficManager.cpp"
 #include "LightManager.cpp"
 #include "OSM2ODR.cpp"
+#include "Recorder.cpp"
+#include "Headless.cpp"
 
 #ifdef LIBCARLA_RSS_ENABLED
 #include "AdRss.cpp"
@@ -288,4 +354,6 @@ BOOST_PYTHON_MODULE(libcarla) {
   export_ad_rss();
   #endif
   export_osm2odr();
+  export_recorder();
+  export_headless();
 }
@@ -7,6 +7,9 @@
 
 from . import SmokeTest
 
+import threading
+import time
+
 
 class TestClient(SmokeTest):  # 定义一个名为TestClient的类，它继承自SmokeTest类。
     def test_version(self):  # 定义一个名为test_version的测试方法。
@@ -21,3 +24,25 @@ class TestClient(SmokeTest):  # 定义一个名为TestClient的类，它继承
             self.client.get_client_version(),  # 获取客户端版本
             self.client.get_server_version()   # 获取服务器版本
         )
+
+    def test_blocking_calls_release_gil(self):
+        print("TestClient.test_blocking_calls_release_gil")
+        # 等待服务器应答期间 GIL 被释放，其他 Python 线程可以继续执行；
+        # 持有 GIL 时主线程至少要等待一整次请求。
+        calls = 20
+        def worker():
+            for _ in range(calls):
+                self.world.get_environment_objects()
+        progress = []
+        thread = threading.Thread(target=worker)
+        start = time.time()
+        thread.start()
+        while thread.is_alive():
+            progress.append(time.time())
+            time.sleep(0.001)
+        thread.join()
+        per_call = (time.time() - start) / calls
+        if per_call < 0.02:
+            self.skipTest("requests are too fast to measure the progress of other threads")
+        largest_gap = max(b - a for a, b in zip(progress, progress[1:]))
+        self.assertLess(largest_gap, 0.5 * per_call)
@@ -0,0 +1,340 @@
+#!/usr/bin/env python
+
+# Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma de
+# Barcelona (UAB).
+#
+# This work is licensed under the terms of the MIT license.
+# For a copy, see <https://opensource.org/licenses/MIT>.
+
+"""
+CARLA multi-GPU benchmark.
+
+Starts a primary server and N secondary servers (or connects to servers that
+are already running with --no-launch), spawns a synthetic load of cameras and
+LiDARs on a vehicle and ticks the simulation in synchronous mode. For each
+tick it waits until the data of every sensor has arrived, and prints the
+results as JSON:
+
+    * fps: end-to-end frames per second, tick included;
+    * tick/sensor latency: time from the tick to the data of each sensor;
+    * per-hop latency of each secondary (primary -> secondary, frame apply,
+      render, secondary -> primary), as reported by
+      client.get_secondary_telemetry();
+    * bandwidth: sensor bytes received per second, per sensor type.
+
+    python multigpu_benchmark.py --carla /opt/carla/CarlaUE4.sh --secondaries 2 \\
+        --cameras 4 --camera-size 1920x1080 --lidars 2 --frames 500 -o results.json
+"""
+
+from __future__ import print_function
+
+import glob
+import os
+import sys
+
+try:
+    sys.path.append(glob.glob('../carla/dist/carla-*%d.%d-%s.egg' % (
+        sys.version_info.major,
+        sys.version_info.minor,
+        'win-amd64' if os.name == 'nt' else 'linux-x86_64'))[0])
+except IndexError:
+    pass
+
+import carla
+
+import argparse
+import json
+import math
+import subprocess
+import time
+
+try:
+    import queue
+except ImportError:
+    import Queue as queue
+
+
+# ==============================================================================
+# -- servers -------------------------------------------------------------------
+# ==============================================================================
+
+
+def start_servers(args):
+    """Starts the primary and the secondaries, each secondary on its own GPU."""
+    common = ['-nosound', '-RenderOffScreen'] + args.server_args
+    processes = [subprocess.Popen(
+        [args.carla,
+         '-carla-rpc-port=%d' % args.port,
+         '-carla-streaming-port=%d' % (args.port + 1),
+         '-carla-secondary-port=%d' % args.secondary_port] + common)]
+    for i in range(args.secondaries):
+        gpu = args.gpus[i % len(args.gpus)] if args.gpus else i + 1
+        port = args.port + 10 * (i + 1)
+        processes.append(subprocess.Popen(
+            [args.carla,
+             '-carla-rpc-port=%d' % port,
+             '-carla-streaming-port=%d' % (port + 1),
+             '-carla-primary-host=127.0.0.1',
+             '-carla-primary-port=%d' % args.secondary_port,
+             '-graphicsadapter=%d' % gpu] + common))
+    return processes
+
+
+def stop_servers(processes):
+    for process in processes:
+        process.terminate()
+    for process in processes:
+        try:
+            process.wait(timeout=30)
+        except subprocess.TimeoutExpired:
+            process.kill()
+
+
+def connect(args):
+    """Waits until the primary answers and all the secondaries are connected."""
+    deadline = time.time() + args.startup_timeout
+    while True:
+        try:
+            client = carla.Client(args.host, args.port)
+            client.set_timeout(10.0)
+            client.get_server_version()
+            if len(client.get_secondary_telemetry()) >= args.secondaries:
+                return client
+        except RuntimeError:
+            pass
+        if time.time() > deadline:
+            raise RuntimeError('servers not ready after %d seconds' % args.startup_timeout)
+        time.sleep(2.0)
+
+
+# ==============================================================================
+# -- sensors -------------------------------------------------------------------
+# ==============================================================================
+
+
+def spawn_load(world, args):
+    """Spawns the vehicle and the synthetic sensor load attached to it."""
+    library = world.get_blueprint_library()
+    vehicle_bp = library.filter('vehicle.*')[0]
+    vehicle_bp.set_attribute('role_name', 'hero')
+    spawn_point = world.get_map().get_spawn_points()[0]
+    vehicle = world.spawn_actor(vehicle_bp, spawn_point)
+
+    width, height = args.camera_size
+    sensors = []
+    for i in range(args.cameras):
+        bp = library.find('sensor.camera.rgb')
+        bp.set_attribute('image_size_x', str(width))
+        bp.set_attribute('image_size_y', str(height))
+        yaw = 360.0 * i / max(args.cameras, 1)
+        transform = carla.Transform(carla.Location(z=2.0), carla.Rotation(yaw=yaw))
+        sensors.append(('camera', world.spawn_actor(bp, transform, attach_to=vehicle)))
+    for _ in range(args.lidars):
+        bp = library.find('sensor.lidar.ray_cast')
+        bp.set_attribute('points_per_second', str(args.lidar_points))
+        bp.set_attribute('rotation_frequency', str(1.0 / args.delta))
+        bp.set_attribute('channels', str(args.lidar_channels))
+        transform = carla.Transform(carla.Location(z=2.5))
+        sensors.append(('lidar', world.spawn_actor(bp, transform, attach_to=vehicle)))
+    return vehicle, sensors
+
+
+def listen(sensors):
+    """Puts (sensor index, frame, bytes, arrival time) in a queue for each measurement."""
+    measurements = queue.Queue()
+
+    def make_callback(index):
+        def callback(data):
+            measurements.put((index, data.frame, len(data.raw_data), time.time()))
+        return callback
+
+    for index, (_, sensor) in enumerate(sensors):
+        sensor.listen(make_callback(index))
+    return measurements
+
+
+# ==============================================================================
+# -- statistics ----------------------------------------------------------------
+# ==============================================================================
+
+
+def summarize(values):
+    if not values:
+        return None
+    values = sorted(values)
+
+    def percentile(fraction):
+        return values[max(0, int(math.ceil(fraction * len(values))) - 1)]
+
+    return {
+        'count': len(values),
+        'mean': sum(values) / len(values),
+        'p50': percentile(0.50),
+        'p90': percentile(0.90),
+        'p99': percentile(0.99),
+        'max': values[-1]}
+
+
+def summarize_histogram(histogram):
+    return {
+        'count': histogram.count,
+        'mean': histogram.mean,
+        'p50': histogram.percentile(0.50),
+        'p90': histogram.percentile(0.90),
+        'p99': histogram.percentile(0.99),
+        'max': histogram.max}
+
+
+def secondary_results(client):
+    results = []
+    for telemetry in client.get_secondary_telemetry():
+        results.append({
+            'address': telemetry.address,
+            'last_frame': telemetry.last_frame,
+            'frames_behind': telemetry.frames_behind,
+            'latency_ms': {
+                'frame': summarize_histogram(telemetry.frame_latency),
+                'network': summarize_histogram(telemetry.network_latency),
+                'apply': summarize_histogram(telemetry.apply_time),
+                'render': summarize_histogram(telemetry.render_time)}})
+    return results
+
+
+# ==============================================================================
+# -- benchmark -----------------------------------------------------------------
+# ==============================================================================
+
+
+def run(client, args):
+    world = client.get_world()
+    original_settings = world.get_settings()
+    settings = world.get_settings()
+    settings.synchronous_mode = True
+    settings.fixed_delta_seconds = args.delta
+    world.apply_settings(settings)
+
+    vehicle, sensors = spawn_load(world, args)
+    measurements = listen(sensors)
+    try:
+        tick_times = []
+        sensor_latency = []
+        received = {}
+        missing = 0
+        start = None
+        for i in range(args.warmup + args.frames):
+            if i == args.warmup:
+                start = time.time()
+                received = {}
+            tick_start = time.time()
+            frame = world.tick()
+            tick_end = time.time()
+            pending = len(sensors)
+            while pending > 0:
+                try:
+                    index, data_frame, size, arrival = measurements.get(timeout=args.sensor_timeout)
+                except queue.Empty:
+                    missing += pending
+                    break
+                if data_frame != frame:
+                    continue
+                pending -= 1
+                kind = sensors[index][0]
+                received[kind] = received.get(kind, 0) + size
+                if i >= args.warmup:
+                    sensor_latency.append((arrival - tick_start) * 1000.0)
+            if i >= args.warmup:
+                tick_times.append((tick_end - tick_start) * 1000.0)
+        elapsed = time.time() - start
+    finally:
+        for _, sensor in sensors:
+            sensor.stop()
+            sensor.destroy()
+        vehicle.destroy()
+        world.apply_settings(original_settings)
+
+    return {
+        'config': {
+            'secondaries': args.secondaries,
+            'cameras': args.cameras,
+            'camera_size': list(args.camera_size),
+            'lidars': args.lidars,
+            'lidar_points_per_second': args.lidar_points,
+            'lidar_channels': args.lidar_channels,
+            'frames': args.frames,
+            'delta_seconds': args.delta},
+        'fps': args.frames / elapsed if elapsed > 0.0 else 0.0,
+        'missing_measurements': missing,
+        'tick_ms': summarize(tick_times),
+        'sensor_latency_ms': summarize(sensor_latency),
+        'bandwidth_mbps': {
+            kind: 8.0 * size / elapsed / 1e6 for kind, size in received.items()},
+        'secondaries': secondary_results(client)}
+
+
+# ==============================================================================
+# -- main() --------------------------------------------------------------------
+# ==============================================================================
+
+
+def parse_size(text):
+    width, height = text.lower().split('x')
+    return int(width), int(height)
+
+
+def main():
+    argparser = argparse.ArgumentParser(
+        description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    argparser.add_argument(
+        '--carla', metavar='PATH',
+        help='CarlaUE4 executable used to start the servers')
+    argparser.add_argument(
+        '--no-launch', action='store_true',
+        help='connect to servers that are already running')
+    argparser.add_argument('--host', default='127.0.0.1', help='IP of the primary server')
+    argparser.add_argument('-p', '--port', type=int, default=2000, help='RPC port of the primary server')
+    argparser.add_argument(
+        '--secondary-port', type=int, default=2002,
+        help='port where the primary server waits for the secondaries')
+    argparser.add_argument('-n', '--secondaries', type=int, default=1, help='number of secondary servers')
+    argparser.add_argument(
+        '--gpus', type=int, nargs='+', default=None,
+        help='GPU index of each secondary (default: 1, 2, ...)')
+    argparser.add_argument('--server-args', nargs=argparse.REMAINDER, default=[],
+        help='extra arguments for every server, must be last')
+    argparser.add_argument('--cameras', type=int, default=4, help='RGB cameras')
+    argparser.add_argument('--camera-size', type=parse_size, default=(1280, 720), help='WIDTHxHEIGHT')
+    argparser.add_argument('--lidars', type=int, default=1, help='ray-cast LiDARs')
+    argparser.add_argument('--lidar-points', type=int, default=600000, help='LiDAR points per second')
+    argparser.add_argument('--lidar-channels', type=int, default=64, help='LiDAR channels')
+    argparser.add_argument('--frames', type=int, default=300, help='frames measured')
+    argparser.add_argument('--warmup', type=int, default=50, help='frames ignored at the start')
+    argparser.add_argument('--delta', type=float, default=0.05, help='fixed delta seconds')
+    argparser.add_argument(
+        '--sensor-timeout', type=float, default=10.0,
+        help='seconds to wait for the data of a frame')
+    argparser.add_argument(
+        '--startup-timeout', type=float, default=300.0,
+        help='seconds to wait for the servers to start')
+    argparser.add_argument('-o', '--output', help='write the results to this file instead of stdout')
+    args = argparser.parse_args()
+
+    if not args.no_launch and not args.carla:
+        argparser.error('--carla is required unless --no-launch is given')
+
+    processes = [] if args.no_launch else start_servers(args)
+    try:
+        results = run(connect(args), args)
+    finally:
+        stop_servers(processes)
+
+    if args.output:
+        with open(args.output, 'w') as output:
+            json.dump(results, output, indent=2)
+    else:
+        json.dump(results, sys.stdout, indent=2)
+        print()
+    return 0 if results['missing_measurements'] == 0 else 1
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,364 @@
+#!/usr/bin/env python
+
+# Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma de
+# Barcelona (UAB).
+#
+# This work is licensed under the terms of the MIT license.
+# For a copy, see <https://opensource.org/licenses/MIT>.
+
+"""
+CARLA recorder file query tool.
+
+Runs the same queries as client.show_recorder_file_info(),
+client.show_recorder_collisions() and client.show_recorder_actors_blocked()
+directly on .log files, without a running simulator. Several files are
+processed in parallel and the results are printed as JSON.
+
+    python recorder_query.py collisions -c1 v -c2 a recording01.log recording02.log
+    python recorder_query.py blocked --min-time 30 --min-distance 10 *.log
+"""
+
+from __future__ import print_function
+
+import argparse
+import json
+import math
+import multiprocessing
+import struct
+import sys
+import zlib
+
+
+# 与 CarlaRecorderPacketId 的顺序一致
+FRAME_START = 0
+FRAME_END = 1
+EVENT_ADD = 2
+EVENT_DEL = 3
+COLLISION = 5
+POSITION = 6
+KEYFRAME = 24
+FRAME_INDEX = 25
+FRAME_INDEX_OFFSET = 26
+
+# 碰撞查询中 actor 的类别，按 actor 类型排列
+CATEGORIES = ['o', 'v', 'w', 't', 'h', 'a']
+
+COMPRESSED_MAGIC = b'CARLAZ01'
+BLOCK_HEADER = struct.Struct('<III')
+BLOCK_TABLE_ENTRY = struct.Struct('<QII')
+COMPRESSED_FOOTER = struct.Struct('<QI8s')
+
+
+class RecorderError(Exception):
+    pass
+
+
+# ==============================================================================
+# -- file reading --------------------------------------------------------------
+# ==============================================================================
+
+
+def load_recorder_data(filename):
+    """返回录制文件解压后的内容以及文件是否压缩"""
+    with open(filename, 'rb') as f:
+        raw = f.read()
+    if not raw.startswith(COMPRESSED_MAGIC):
+        return raw, False
+
+    blocks = []
+    footer_offset = len(raw) - COMPRESSED_FOOTER.size
+    table_ok = False
+    if footer_offset >= len(COMPRESSED_MAGIC):
+        table, total, magic = COMPRESSED_FOOTER.unpack_from(raw, footer_offset)
+        if magic == COMPRESSED_MAGIC and table + total * BLOCK_TABLE_ENTRY.size == footer_offset:
+            for i in range(total):
+                blocks.append(BLOCK_TABLE_ENTRY.unpack_from(raw, table + i * BLOCK_TABLE_ENTRY.size))
+            table_ok = True
+    if not table_ok:
+        # 没有块表时按顺序扫描，用 CRC32 排除不完整的块
+        physical = len(COMPRESSED_MAGIC)
+        while physical + BLOCK_HEADER.size <= len(raw):
+            size, compressed, crc = BLOCK_HEADER.unpack_from(raw, physical)
+            stored = compressed if compressed > 0 else size
+            start = physical + BLOCK_HEADER.size
+            if size == 0 or start + stored > len(raw):
+                break
+            if zlib.crc32(raw[start:start + stored]) & 0xffffffff != crc:
+                break
+            blocks.append((start, size, compressed))
+            physical = start + stored
+
+    data = []
+    for physical, size, compressed in blocks:
+        if compressed == 0:
+            data.append(raw[physical:physical + size])
+        else:
+            data.append(zlib.decompress(raw[physical:physical + compressed]))
+    return b''.join(data), True
+
+
+class Reader(object):
+    def __init__(self, data, offset=0):
+        self.data = data
+        self.offset = offset
+
+    def eof(self):
+        return self.offset >= len(self.data)
+
+    def read(self, fmt):
+        values = struct.unpack_from('<' + fmt, self.data, self.offset)
+        self.offset += struct.calcsize('<' + fmt)
+        return values if len(values) > 1 else values[0]
+
+    def read_string(self):
+        length = self.read('H')
+        value = self.data[self.offset:self.offset + length].decode('utf-8', 'replace')
+        self.offset += length
+        return value
+
+    def skip(self, size):
+        self.offset += size
+
+
+def read_info(reader):
+    version = reader.read('H')
+    magic = reader.read_string()
+    date = reader.read('q')
+    mapfile = reader.read_string()
+    if magic != 'CARLA_RECORDER':
+        raise RecorderError('File is not a CARLA recorder')
+    return {'version': version, 'date': date, 'map': mapfile}
+
+
+def read_event_add(reader):
+    database_id, actor_type = reader.read('IB')
+    location = reader.read('fff')
+    reader.read('fff')
+    reader.read('I')
+    actor_id = reader.read_string()
+    for _ in range(reader.read('H')):
+        reader.read('B')
+        reader.read_string()
+        reader.read_string()
+    return database_id, actor_type, actor_id, location
+
+
+def read_frame_index(data):
+    """读取文件末尾的帧索引，返回 (总时长, [(开始时间, 位置), ...])，没有索引时返回 None"""
+    footer = 1 + 4 + 8
+    if len(data) < footer:
+        return None
+    packet_id, size, index_offset = struct.unpack_from('<bIQ', data, len(data) - footer)
+    if packet_id != FRAME_INDEX_OFFSET or size != 8 or index_offset + 5 > len(data) - footer:
+        return None
+    reader = Reader(data, index_offset)
+    packet_id, size = reader.read('bI')
+    if packet_id != FRAME_INDEX:
+        return None
+    total_time, total = reader.read('dI')
+    if size != 8 + 4 + total * 16:
+        return None
+    return total_time, [reader.read('dQ') for _ in range(total)]
+
+
+def packets(reader):
+    while reader.offset + 5 <= len(reader.data):
+        packet_id, size = reader.read('bI')
+        start = reader.offset
+        yield packet_id, size
+        # 处理函数没有读取的数据包直接跳过
+        if reader.offset == start:
+            reader.skip(size)
+
+
+# ==============================================================================
+# -- queries -------------------------------------------------------------------
+# ==============================================================================
+
+
+def query_info(filename):
+    data, compressed = load_recorder_data(filename)
+    reader = Reader(data)
+    info = read_info(reader)
+    frames = 0
+    duration = 0.0
+    for packet_id, _ in packets(reader):
+        if packet_id == FRAME_START:
+            frames, _, duration = reader.read('Qdd')
+    index = read_frame_index(data)
+    return {
+        'file': filename,
+        'info': info,
+        'compressed': compressed,
+        'keyframes': len(index[1]) if index else 0,
+        'frames': frames,
+        'duration': duration}
+
+
+def query_collisions(filename, category1='a', category2='a'):
+    data, compressed = load_recorder_data(filename)
+    reader = Reader(data)
+    info = read_info(reader)
+
+    def passes(category, actor_type, is_hero):
+        return category == 'a' or category == actor_type or (category == 'h' and is_hero)
+
+    actors = {}
+    old_collisions = set()
+    new_collisions = set()
+    frame = (0, 0.0, 0.0)
+    result = []
+    for packet_id, _ in packets(reader):
+        if packet_id == FRAME_START:
+            frame = reader.read('Qdd')
+            old_collisions, new_collisions = new_collisions, set()
+        elif packet_id == EVENT_ADD:
+            for _ in range(reader.read('H')):
+                database_id, actor_type, actor_id, _ = read_event_add(reader)
+                actors[database_id] = (actor_type, actor_id)
+        elif packet_id == EVENT_DEL:
+            for _ in range(reader.read('H')):
+                actors.pop(reader.read('I'), None)
+        elif packet_id == COLLISION:
+            for _ in range(reader.read('H')):
+                _, id1, id2, hero1, hero2 = reader.read('III??')
+                actor1 = actors.get(id1, (0, ''))
+                actor2 = actors.get(id2, (0, ''))
+                type1 = CATEGORIES[actor1[0]] if id1 != 0xffffffff else 'o'
+                type2 = CATEGORIES[actor2[0]] if id2 != 0xffffffff else 'o'
+                if not (passes(category1, type1, hero1) and passes(category2, type2, hero2)):
+                    continue
+                pair = (id1, id2)
+                if pair not in old_collisions:
+                    result.append({
+                        'time': frame[2],
+                        'types': [type1, type2],
+                        'ids': [id1, id2],
+                        'actors': [actor1[1], actor2[1]]})
+                new_collisions.add(pair)
+
+    return {
+        'file': filename,
+        'info': info,
+        'compressed': compressed,
+        'frames': frame[0],
+        'duration': frame[2],
+        'collisions': result}
+
+
+def query_blocked(filename, min_time=30.0, min_distance=10.0):
+    data, compressed = load_recorder_data(filename)
+    reader = Reader(data)
+    info = read_info(reader)
+
+    # 每个 actor：[类型 id, 上一个位置, 开始停止的时间, 停止的时长]
+    actors = {}
+    frame = (0, 0.0, 0.0)
+    result = []
+
+    def add_result(database_id, actor):
+        result.append({'time': actor[2], 'id': database_id, 'actor': actor[0], 'duration': actor[3]})
+
+    for packet_id, _ in packets(reader):
+        if packet_id == FRAME_START:
+            frame = reader.read('Qdd')
+        elif packet_id == EVENT_ADD:
+            for _ in range(reader.read('H')):
+                database_id, _, actor_id, _ = read_event_add(reader)
+                actors[database_id] = [actor_id, (0.0, 0.0, 0.0), 0.0, 0.0]
+        elif packet_id == EVENT_DEL:
+            for _ in range(reader.read('H')):
+                actors.pop(reader.read('I'), None)
+        elif packet_id == POSITION:
+            for _ in range(reader.read('H')):
+                database_id = reader.read('I')
+                location = reader.read('fff')
+                reader.read('fff')
+                actor = actors.setdefault(database_id, ['', (0.0, 0.0, 0.0), 0.0, 0.0])
+                distance = math.sqrt(sum((a - b) ** 2 for a, b in zip(actor[1], location)))
+                if distance < min_distance:
+                    if actor[3] == 0:
+                        actor[2] = frame[2]
+                    actor[3] += frame[1]
+                else:
+                    if actor[3] >= min_time:
+                        add_result(database_id, actor)
+                    actor[3] = 0.0
+                    actor[1] = location
+
+    for database_id, actor in actors.items():
+        if actor[3] >= min_time:
+            add_result(database_id, actor)
+    result.sort(key=lambda item: -item['duration'])
+
+    return {
+        'file': filename,
+        'info': info,
+        'compressed': compressed,
+        'frames': frame[0],
+        'duration': frame[2],
+        'blocked': result}
+
+
+def _run(job):
+    query, filename, args = job
+    try:
+        return query(filename, *args)
+    except (IOError, RecorderError, struct.error) as error:
+        return {'file': filename, 'error': str(error)}
+
+
+# ==============================================================================
+# -- main() --------------------------------------------------------------------
+# ==============================================================================
+
+
+def main():
+    argparser = argparse.ArgumentParser(description=__doc__)
+    subparsers = argparser.add_subparsers(dest='query')
+    subparsers.required = True
+
+    info = subparsers.add_parser('info', help='file header, frames and duration')
+    info.add_argument('files', nargs='+')
+
+    collisions = subparsers.add_parser('collisions', help='collisions between actors')
+    collisions.add_argument('files', nargs='+')
+    collisions.add_argument(
+        '-c1', '--category1', default='a', choices=CATEGORIES,
+        help='category of the first actor: (o)ther, (v)ehicle, (w)alker, (t)raffic light, (h)ero, (a)ny')
+    collisions.add_argument(
+        '-c2', '--category2', default='a', choices=CATEGORIES,
+        help='category of the second actor')
+
+    blocked = subparsers.add_parser('blocked', help='actors that stopped moving')
+    blocked.add_argument('files', nargs='+')
+    blocked.add_argument('--min-time', type=float, default=30.0, help='minimum time blocked (seconds)')
+    blocked.add_argument('--min-distance', type=float, default=10.0, help='minimum distance moved (cm)')
+
+    argparser.add_argument(
+        '-j', '--jobs', type=int, default=multiprocessing.cpu_count(),
+        help='number of files processed in parallel')
+    args = argparser.parse_args()
+
+    if args.query == 'info':
+        jobs = [(query_info, f, ()) for f in args.files]
+    elif args.query == 'collisions':
+        jobs = [(query_collisions, f, (args.category1, args.category2)) for f in args.files]
+    else:
+        jobs = [(query_blocked, f, (args.min_time, args.min_distance)) for f in args.files]
+
+    if args.jobs > 1 and len(jobs) > 1:
+        pool = multiprocessing.Pool(min(args.jobs, len(jobs)))
+        results = pool.map(_run, jobs)
+        pool.close()
+        pool.join()
+    else:
+        results = [_run(job) for job in jobs]
+
+    json.dump(results, sys.stdout, indent=2)
+    print()
+    return 0 if all('error' not in r for r in results) else 1
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -30,6 +30,13 @@ TArray<FActorDefinition> AAIControllerFactory::GetDefinitions()
       TEXT("walker")); 
   // 设置 WalkerController 的 Class 成员，指向 AWalkerAIController 类的类对象。
   WalkerController.Class = AWalkerAIController::StaticClass();
+  // 为 true 时行人由服务器上的人群模拟（见 FWalkerCrowd），而不是客户端的导航
+  FActorVariation SimulateOnServer;
+  SimulateOnServer.Id = TEXT("simulate_on_server");
+  SimulateOnServer.Type = EActorAttributeType::Bool;
+  SimulateOnServer.RecommendedValues = { TEXT("false") };
+  SimulateOnServer.bRestrictToRecommended = false;
+  WalkerController.Variations.Emplace(SimulateOnServer);
   // 返回包含 WalkerController 的数组。
   return { WalkerController }; 
 }
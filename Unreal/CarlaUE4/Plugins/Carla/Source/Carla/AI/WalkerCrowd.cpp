@@ -0,0 +1,520 @@
+// Copyright (c) 2019 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "Carla.h"
+#include "Carla/AI/WalkerCrowd.h"
+
+#include "Carla/Game/CarlaEpisode.h"
+#include "Carla/Util/NavigationMesh.h"
+
+#include <compiler/disable-ue4-macros.h>
+#include <carla/geom/Math.h>
+#include <carla/geom/Transform.h>
+#include <carla/nav/NavAreas.h>
+#include <carla/nav/ServerRecast.h>
+#include <carla/rpc/WalkerControl.h>
+#include <compiler/enable-ue4-macros.h>
+
+#include <algorithm>
+
+namespace cg = carla::geom;
+namespace cn = carla::nav;
+
+namespace WalkerCrowd_local_ns {
+
+  using namespace carla::nav::recast;
+
+  // 这些设置与 carla/nav/Navigation.cpp 中的相同
+  constexpr int   MAX_AGENTS = 1000;
+  constexpr int   MAX_QUERY_SEARCH_NODES = 2048;
+  constexpr float AGENT_HEIGHT = 1.8f;
+  constexpr float AGENT_RADIUS = 0.3f;
+  constexpr float AGENT_UNBLOCK_DISTANCE_SQUARED = 0.5f * 0.5f;
+  constexpr float AGENT_UNBLOCK_TIME = 4.0f;
+  constexpr float AGENT_ARRIVE_DISTANCE_SQUARED = 1.0f;
+  constexpr float AREA_GRASS_COST = 1.0f;
+  constexpr float AREA_ROAD_COST = 10.0f;
+
+  enum UpdateFlags {
+    DT_CROWD_ANTICIPATE_TURNS   = 1,
+    DT_CROWD_OBSTACLE_AVOIDANCE = 2,
+    DT_CROWD_SEPARATION         = 4
+  };
+
+  float RandomFloat()
+  {
+    return FMath::FRand();
+  }
+
+} // namespace WalkerCrowd_local_ns
+
+FWalkerCrowd::~FWalkerCrowd()
+{
+  Free();
+}
+
+void FWalkerCrowd::Free()
+{
+  using namespace WalkerCrowd_local_ns;
+  dtFreeCrowd(Crowd);
+  dtFreeNavMeshQuery(NavQuery);
+  dtFreeNavMesh(NavMesh);
+  Crowd = nullptr;
+  NavQuery = nullptr;
+  NavMesh = nullptr;
+  Walkers.clear();
+  Vehicles.clear();
+}
+
+bool FWalkerCrowd::Load(UCarlaEpisode &Episode)
+{
+  using namespace WalkerCrowd_local_ns;
+  if (Crowd != nullptr)
+  {
+    return true;
+  }
+  if (bLoadAttempted)
+  {
+    return false;
+  }
+  bLoadAttempted = true;
+
+  // 与 carla::nav::Navigation::Load 读取的格式相同
+  const int NAVMESHSET_MAGIC = 'M' << 24 | 'S' << 16 | 'E' << 8 | 'T';
+  const int NAVMESHSET_VERSION = 1;
+#pragma pack(push, 1)
+  struct NavMeshSetHeader {
+    int magic;
+    int version;
+    int num_tiles;
+    dtNavMeshParams params;
+  } Header;
+  struct NavMeshTileHeader {
+    dtTileRef tile_ref;
+    int data_size;
+  };
+#pragma pack(pop)
+
+  const TArray<uint8> Content = FNavigationMesh::Load(Episode.GetMapName());
+  if (Content.Num() < static_cast<int32>(sizeof(Header)))
+  {
+    UE_LOG(LogCarla, Warning, TEXT("FWalkerCrowd: no navigation mesh for map %s"), *Episode.GetMapName());
+    return false;
+  }
+  size_t Pos = 0u;
+  const size_t Size = static_cast<size_t>(Content.Num());
+  memcpy(&Header, Content.GetData(), sizeof(Header));
+  Pos += sizeof(Header);
+  if (Header.magic != NAVMESHSET_MAGIC || Header.version != NAVMESHSET_VERSION)
+  {
+    UE_LOG(LogCarla, Warning, TEXT("FWalkerCrowd: invalid navigation mesh"));
+    return false;
+  }
+
+  NavMesh = dtAllocNavMesh();
+  if (NavMesh == nullptr || dtStatusFailed(NavMesh->init(&Header.params)))
+  {
+    Free();
+    return false;
+  }
+  for (int i = 0; i < Header.num_tiles; ++i)
+  {
+    NavMeshTileHeader TileHeader;
+    if (Pos + sizeof(TileHeader) >= Size)
+    {
+      Free();
+      return false;
+    }
+    memcpy(&TileHeader, Content.GetData() + Pos, sizeof(TileHeader));
+    Pos += sizeof(TileHeader);
+    if (!TileHeader.tile_ref || !TileHeader.data_size)
+    {
+      break;
+    }
+    const size_t DataSize = static_cast<size_t>(TileHeader.data_size);
+    if (Pos + DataSize > Size)
+    {
+      Free();
+      return false;
+    }
+    unsigned char *Data = static_cast<unsigned char *>(dtAlloc(DataSize, DT_ALLOC_PERM));
+    if (Data == nullptr)
+    {
+      break;
+    }
+    memcpy(Data, Content.GetData() + Pos, DataSize);
+    Pos += DataSize;
+    NavMesh->addTile(Data, TileHeader.data_size, DT_TILE_FREE_DATA, TileHeader.tile_ref, 0);
+  }
+
+  NavQuery = dtAllocNavMeshQuery();
+  NavQuery->init(NavMesh, MAX_QUERY_SEARCH_NODES);
+
+  // 人群的设置与 carla::nav::Navigation::CreateCrowd 相同
+  Crowd = dtAllocCrowd();
+  if (!Crowd->init(MAX_AGENTS, AGENT_RADIUS * 20, NavMesh))
+  {
+    UE_LOG(LogCarla, Warning, TEXT("FWalkerCrowd: failed to create crowd"));
+    Free();
+    return false;
+  }
+  // 过滤器 0 不能在道路上行走，过滤器 1 可以
+  Crowd->getEditableFilter(0)->setIncludeFlags(cn::CARLA_TYPE_WALKABLE);
+  Crowd->getEditableFilter(0)->setExcludeFlags(cn::CARLA_TYPE_ROAD);
+  Crowd->getEditableFilter(0)->setAreaCost(cn::CARLA_AREA_ROAD, AREA_ROAD_COST);
+  Crowd->getEditableFilter(0)->setAreaCost(cn::CARLA_AREA_GRASS, AREA_GRASS_COST);
+  Crowd->getEditableFilter(1)->setIncludeFlags(cn::CARLA_TYPE_WALKABLE);
+  Crowd->getEditableFilter(1)->setExcludeFlags(cn::CARLA_TYPE_NONE);
+  Crowd->getEditableFilter(1)->setAreaCost(cn::CARLA_AREA_ROAD, AREA_ROAD_COST);
+  Crowd->getEditableFilter(1)->setAreaCost(cn::CARLA_AREA_GRASS, AREA_GRASS_COST);
+
+  dtObstacleAvoidanceParams Params;
+  memcpy(&Params, Crowd->getObstacleAvoidanceParams(0), sizeof(dtObstacleAvoidanceParams));
+  const unsigned char Quality[4][3] = {{5, 2, 1}, {5, 2, 2}, {7, 2, 3}, {7, 3, 3}};
+  for (int i = 0; i < 4; ++i)
+  {
+    Params.velBias = 0.5f;
+    Params.adaptiveDivs = Quality[i][0];
+    Params.adaptiveRings = Quality[i][1];
+    Params.adaptiveDepth = Quality[i][2];
+    Crowd->setObstacleAvoidanceParams(i, &Params);
+  }
+
+  UE_LOG(LogCarla, Log, TEXT("FWalkerCrowd: navigation mesh loaded (%d tiles)"), Header.num_tiles);
+  return true;
+}
+
+bool FWalkerCrowd::AddWalker(UCarlaEpisode &Episode, FCarlaActor &Walker)
+{
+  using namespace WalkerCrowd_local_ns;
+  if (Walker.GetActorType() != FCarlaActor::ActorType::Walker || !Load(Episode))
+  {
+    return false;
+  }
+  RemoveWalker(Walker.GetActorId());
+
+  dtCrowdAgentParams Params;
+  memset(&Params, 0, sizeof(Params));
+  Params.radius = AGENT_RADIUS;
+  Params.height = AGENT_HEIGHT;
+  Params.maxAcceleration = 160.0f;
+  Params.maxSpeed = 1.47f;
+  Params.collisionQueryRange = 10;
+  Params.obstacleAvoidanceType = 3;
+  Params.separationWeight = 0.5f;
+  Params.queryFilterType = static_cast<unsigned char>(RandomFloat() <= ProbabilityCrossing ? 1 : 0);
+  Params.updateFlags = DT_CROWD_ANTICIPATE_TURNS | DT_CROWD_OBSTACLE_AVOIDANCE | DT_CROWD_SEPARATION;
+
+  // 从虚幻的胶囊体中心移到 Recast 的底部
+  const cg::Location From(Walker.GetActorGlobalLocation());
+  const float Point[3] = { From.x, From.z - (AGENT_HEIGHT / 2.0f), From.y };
+  const int Agent = Crowd->addAgent(Point, &Params);
+  if (Agent == -1)
+  {
+    return false;
+  }
+
+  FWalkerAgent &Entry = Walkers[Walker.GetActorId()];
+  Entry.Agent = Agent;
+  Entry.Yaw = Walker.GetActorGlobalTransform().Rotator().Yaw;
+  Entry.BlockedPosition = cg::Location(Point[0], Point[1], Point[2]);
+
+  Walker.SetActorSimulatePhysics(false);
+  Walker.SetActorCollisions(false);
+  return true;
+}
+
+bool FWalkerCrowd::RemoveWalker(carla::rpc::ActorId WalkerId)
+{
+  auto It = Walkers.find(WalkerId);
+  if (It == Walkers.end())
+  {
+    return false;
+  }
+  Crowd->removeAgent(It->second.Agent);
+  Walkers.erase(It);
+  return true;
+}
+
+bool FWalkerCrowd::SetWalkerTarget(carla::rpc::ActorId WalkerId, const cg::Location &Target)
+{
+  auto It = Walkers.find(WalkerId);
+  return It != Walkers.end() && SetAgentTarget(It->second, Target);
+}
+
+bool FWalkerCrowd::SetAgentTarget(FWalkerAgent &Walker, const cg::Location &Target)
+{
+  using namespace WalkerCrowd_local_ns;
+  const float Point[3] = { Target.x, Target.z, Target.y };
+  float Nearest[3];
+  dtPolyRef TargetRef = 0;
+  NavQuery->findNearestPoly(
+      Point,
+      Crowd->getQueryHalfExtents(),
+      Crowd->getFilter(0),
+      &TargetRef,
+      Nearest);
+  if (!TargetRef || !Crowd->requestMoveTarget(Walker.Agent, TargetRef, Nearest))
+  {
+    return false;
+  }
+  Walker.bHasTarget = true;
+  Walker.Target = cg::Location(Nearest[0], Nearest[1], Nearest[2]);
+  return true;
+}
+
+void FWalkerCrowd::SetRandomTarget(FWalkerAgent &Walker)
+{
+  using namespace WalkerCrowd_local_ns;
+  dtCrowdAgent *Agent = Crowd->getEditableAgent(Walker.Agent);
+  Agent->params.queryFilterType = static_cast<unsigned char>(RandomFloat() <= ProbabilityCrossing ? 1 : 0);
+
+  dtQueryFilter Filter;
+  Filter.setIncludeFlags(cn::CARLA_TYPE_SIDEWALK);
+  Filter.setExcludeFlags(cn::CARLA_TYPE_NONE);
+  dtPolyRef RandomRef = 0;
+  float Point[3];
+  if (NavQuery->findRandomPoint(&Filter, RandomFloat, &RandomRef, Point) == DT_SUCCESS)
+  {
+    SetAgentTarget(Walker, cg::Location(Point[0], Point[2], Point[1]));
+  }
+}
+
+bool FWalkerCrowd::SetWalkerMaxSpeed(carla::rpc::ActorId WalkerId, float MaxSpeed)
+{
+  auto It = Walkers.find(WalkerId);
+  if (It == Walkers.end())
+  {
+    return false;
+  }
+  Crowd->getEditableAgent(It->second.Agent)->params.maxSpeed = MaxSpeed;
+  return true;
+}
+
+bool FWalkerCrowd::GetRandomLocation(UCarlaEpisode &Episode, cg::Location &Location)
+{
+  using namespace WalkerCrowd_local_ns;
+  if (!Load(Episode))
+  {
+    return false;
+  }
+  dtQueryFilter Filter;
+  Filter.setIncludeFlags(cn::CARLA_TYPE_SIDEWALK);
+  Filter.setExcludeFlags(cn::CARLA_TYPE_NONE);
+  dtPolyRef RandomRef = 0;
+  float Point[3];
+  // 与客户端相同，最多尝试 10 次
+  for (int Round = 0; Round < 10; ++Round)
+  {
+    if (NavQuery->findRandomPoint(&Filter, RandomFloat, &RandomRef, Point) == DT_SUCCESS)
+    {
+      Location = cg::Location(Point[0], Point[2], Point[1]);
+      return true;
+    }
+  }
+  return false;
+}
+
+void FWalkerCrowd::UpdateVehicle(carla::rpc::ActorId Id, const FCarlaActor &View)
+{
+  using namespace WalkerCrowd_local_ns;
+  const FTransform Transform = View.GetActorGlobalTransform();
+  const cg::Location Location(Transform.GetLocation());
+  auto It = Vehicles.find(Id);
+  if (It != Vehicles.end())
+  {
+    dtCrowdAgent *Agent = Crowd->getEditableAgent(It->second.Agent);
+    // 车辆没有移动时只恢复人群更新中可能被推开的位置
+    if (Transform.Equals(It->second.Transform, 1.0f))
+    {
+      const cg::Location Previous(It->second.Transform.GetLocation());
+      Agent->npos[0] = Previous.x;
+      Agent->npos[1] = Previous.z;
+      Agent->npos[2] = Previous.y;
+      return;
+    }
+  }
+
+  // 边界框加上周围的一些空间，转换为世界坐标的 4 个角
+  const FVector Extent = View.GetActorInfo()->BoundingBox.Extent / 100.0f;
+  const float Marge = 0.8f;
+  const float hx = Extent.X + Marge;
+  const float hy = Extent.Y + Marge;
+  cg::Vector3D Corners[4] {
+    {-hx, -hy, 0},
+    { hx + 0.2f, -hy, 0},
+    { hx + 0.2f,  hy, 0},
+    {-hx,  hy, 0}
+  };
+  const float Angle = cg::Math::ToRadians(Transform.Rotator().Yaw);
+  float Obb[12];
+  for (int i = 0; i < 4; ++i)
+  {
+    const cg::Vector3D Corner = cg::Math::RotatePointOnOrigin2D(Corners[i], Angle) + Location;
+    Obb[i * 3 + 0] = Corner.x;
+    Obb[i * 3 + 1] = Corner.z;
+    Obb[i * 3 + 2] = Corner.y;
+  }
+
+  if (It != Vehicles.end())
+  {
+    dtCrowdAgent *Agent = Crowd->getEditableAgent(It->second.Agent);
+    Agent->npos[0] = Location.x;
+    Agent->npos[1] = Location.z;
+    Agent->npos[2] = Location.y;
+    memcpy(Agent->params.obb, Obb, sizeof(Obb));
+    It->second.Transform = Transform;
+    return;
+  }
+
+  dtCrowdAgentParams Params;
+  memset(&Params, 0, sizeof(Params));
+  Params.radius = 2;
+  Params.height = AGENT_HEIGHT;
+  Params.maxAcceleration = 0.0f;
+  Params.maxSpeed = 1.47f;
+  Params.collisionQueryRange = 0;
+  Params.obstacleAvoidanceType = 0;
+  Params.separationWeight = 100.0f;
+  Params.updateFlags = DT_CROWD_SEPARATION;
+  Params.useObb = true;
+  memcpy(Params.obb, Obb, sizeof(Obb));
+
+  const float Point[3] = { Location.x, Location.z, Location.y };
+  const int Index = Crowd->addAgent(Point, &Params);
+  if (Index == -1)
+  {
+    return;
+  }
+  Crowd->getEditableAgent(Index)->state = DT_CROWDAGENT_STATE_WALKING;
+  FVehicleAgent &Entry = Vehicles[Id];
+  Entry.Agent = Index;
+  Entry.Transform = Transform;
+}
+
+void FWalkerCrowd::UpdateVehicles(UCarlaEpisode &Episode)
+{
+  std::vector<carla::rpc::ActorId> Updated;
+  Updated.reserve(Vehicles.size());
+  for (const auto &Item : Episode.GetActorRegistry())
+  {
+    const FCarlaActor *View = Item.Value.Get();
+    if (View == nullptr ||
+        View->GetActorType() != FCarlaActor::ActorType::Vehicle ||
+        View->IsDormant() ||
+        View->IsPendingKill())
+    {
+      continue;
+    }
+    UpdateVehicle(View->GetActorId(), *View);
+    Updated.emplace_back(View->GetActorId());
+  }
+
+  // 移除这一帧不存在的车辆
+  if (Updated.size() != Vehicles.size())
+  {
+    std::sort(Updated.begin(), Updated.end());
+    for (auto It = Vehicles.begin(); It != Vehicles.end();)
+    {
+      if (!std::binary_search(Updated.begin(), Updated.end(), It->first))
+      {
+        Crowd->removeAgent(It->second.Agent);
+        It = Vehicles.erase(It);
+      }
+      else
+      {
+        ++It;
+      }
+    }
+  }
+}
+
+void FWalkerCrowd::Tick(UCarlaEpisode &Episode, float DeltaSeconds)
+{
+  using namespace WalkerCrowd_local_ns;
+  TRACE_CPUPROFILER_EVENT_SCOPE(FWalkerCrowd::Tick);
+  if (Walkers.empty() || Crowd == nullptr || DeltaSeconds <= 0.0f)
+  {
+    return;
+  }
+
+  UpdateVehicles(Episode);
+  Crowd->update(DeltaSeconds, nullptr);
+
+  TimeToUnblock += DeltaSeconds;
+  const bool bCheckBlocked = TimeToUnblock >= AGENT_UNBLOCK_TIME;
+  if (bCheckBlocked)
+  {
+    TimeToUnblock = 0.0f;
+  }
+
+  for (auto It = Walkers.begin(); It != Walkers.end();)
+  {
+    FCarlaActor *View = Episode.FindCarlaActor(It->first);
+    if (View == nullptr || View->IsPendingKill())
+    {
+      Crowd->removeAgent(It->second.Agent);
+      It = Walkers.erase(It);
+      continue;
+    }
+    FWalkerAgent &Walker = It->second;
+    const dtCrowdAgent *Agent = Crowd->getAgent(Walker.Agent);
+
+    // 被车辆撞到的行人交给物理模拟
+    if (Agent->dead)
+    {
+      View->SetActorCollisions(true);
+      View->SetActorDead();
+      Crowd->removeAgent(Walker.Agent);
+      It = Walkers.erase(It);
+      continue;
+    }
+
+    // Recast 坐标：Y 轴向上
+    const cg::Location Position(Agent->npos[0], Agent->npos[1], Agent->npos[2]);
+    if (Walker.bHasTarget)
+    {
+      const float DX = Position.x - Walker.Target.x;
+      const float DZ = Position.z - Walker.Target.z;
+      if (DX * DX + DZ * DZ < AGENT_ARRIVE_DISTANCE_SQUARED)
+      {
+        SetRandomTarget(Walker);
+      }
+      else if (bCheckBlocked)
+      {
+        if ((Position - Walker.BlockedPosition).SquaredLength() < AGENT_UNBLOCK_DISTANCE_SQUARED)
+        {
+          SetRandomTarget(Walker);
+        }
+      }
+    }
+    if (bCheckBlocked)
+    {
+      Walker.BlockedPosition = Position;
+    }
+
+    // 朝向向速度方向插值，与 carla::nav::Navigation::GetWalkerTransform 相同
+    const float *Velocity = Agent->vel;
+    if (FMath::Abs(Velocity[0]) <= 0.1f && FMath::Abs(Velocity[2]) <= 0.1f)
+    {
+      Velocity = Agent->dvel;
+    }
+    const float Speed = FMath::Sqrt(
+        Velocity[0] * Velocity[0] + Velocity[1] * Velocity[1] + Velocity[2] * Velocity[2]);
+    const float TargetYaw = FMath::RadiansToDegrees(FMath::Atan2(Velocity[2], Velocity[0]));
+    const float ShortestAngle = FMath::Fmod(TargetYaw - Walker.Yaw + 540.0f, 360.0f) - 180.0f;
+    const float RotationSpeed = FMath::Min(Speed / 1.5f, 1.0f) * 6.0f;
+    Walker.Yaw += ShortestAngle * RotationSpeed * DeltaSeconds;
+
+    cg::Transform Transform;
+    Transform.location = cg::Location(Position.x, Position.z, Position.y);
+    Transform.rotation.yaw = Walker.Yaw;
+    View->SetWalkerState(
+        Transform,
+        carla::rpc::WalkerControl(Transform.GetForwardVector(), Speed, false));
+    ++It;
+  }
+}
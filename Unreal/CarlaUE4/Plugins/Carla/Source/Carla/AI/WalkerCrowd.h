@@ -0,0 +1,126 @@
+// Copyright (c) 2019 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "Carla/Actor/CarlaActor.h"
+
+#include <compiler/disable-ue4-macros.h>
+#include <carla/geom/Location.h>
+#include <carla/rpc/ActorId.h>
+#include <compiler/enable-ue4-macros.h>
+
+#include <unordered_map>
+#include <vector>
+
+class UCarlaEpisode;
+
+namespace carla {
+namespace nav {
+namespace recast {
+  class dtCrowd;
+  class dtNavMesh;
+  class dtNavMeshQuery;
+} // namespace recast
+} // namespace nav
+} // namespace carla
+
+/// 在服务器上模拟行人人群。
+///
+/// 行人 AI 控制器的 "simulate_on_server" 属性为 true 时，行人不再由客户端的
+/// carla::nav::Navigation 驱动，而是由这里的 Detour 人群驱动：客户端只通过 RPC
+/// 开始、停止行人和设置目标，每帧的变换直接应用到行人上，不再经过网络。
+/// 人群的参数（代理尺寸、过滤器、避让参数、车辆的 OBB 代理）与客户端相同。
+///
+/// 与客户端不同，路线上没有事件：行人不会在过马路前等待车辆或交通灯，
+/// 直接由人群的路径走廊前往目标。到达目标或被堵塞时选择新的随机目标。
+class FWalkerCrowd
+{
+public:
+
+  FWalkerCrowd() = default;
+
+  FWalkerCrowd(const FWalkerCrowd &) = delete;
+
+  FWalkerCrowd &operator=(const FWalkerCrowd &) = delete;
+
+  ~FWalkerCrowd();
+
+  /// 把行人加入人群，关闭它的物理模拟和碰撞。地图没有导航文件时返回 false。
+  bool AddWalker(UCarlaEpisode &Episode, FCarlaActor &Walker);
+
+  /// 把行人移出人群，不改变行人的状态。
+  bool RemoveWalker(carla::rpc::ActorId WalkerId);
+
+  /// 让行人前往 @a Target（单位为米）。
+  bool SetWalkerTarget(carla::rpc::ActorId WalkerId, const carla::geom::Location &Target);
+
+  bool SetWalkerMaxSpeed(carla::rpc::ActorId WalkerId, float MaxSpeed);
+
+  /// 人行道上的一个随机位置（单位为米）。
+  bool GetRandomLocation(UCarlaEpisode &Episode, carla::geom::Location &Location);
+
+  /// 新加入或选择新目标的行人可以过马路的概率。
+  void SetPedestriansCrossFactor(float Percentage)
+  {
+    ProbabilityCrossing = Percentage;
+  }
+
+  bool HasWalker(carla::rpc::ActorId WalkerId) const
+  {
+    return Walkers.find(WalkerId) != Walkers.end();
+  }
+
+  /// 更新人群中的车辆，推进人群并把行人的变换应用到场景中。
+  void Tick(UCarlaEpisode &Episode, float DeltaSeconds);
+
+private:
+
+  struct FWalkerAgent
+  {
+    int Agent = -1;
+    float Yaw = 0.0f;
+    bool bHasTarget = false;
+    carla::geom::Location Target;
+    /// 上次检查堵塞时的位置（Recast 坐标）
+    carla::geom::Location BlockedPosition;
+  };
+
+  struct FVehicleAgent
+  {
+    int Agent = -1;
+    FTransform Transform;
+  };
+
+  /// 第一次使用时加载当前地图的导航文件并创建人群。
+  bool Load(UCarlaEpisode &Episode);
+
+  bool SetAgentTarget(FWalkerAgent &Walker, const carla::geom::Location &Target);
+
+  void SetRandomTarget(FWalkerAgent &Walker);
+
+  void UpdateVehicles(UCarlaEpisode &Episode);
+
+  void UpdateVehicle(carla::rpc::ActorId Id, const FCarlaActor &View);
+
+  void Free();
+
+  bool bLoadAttempted = false;
+
+  carla::nav::recast::dtNavMesh *NavMesh = nullptr;
+
+  carla::nav::recast::dtNavMeshQuery *NavQuery = nullptr;
+
+  carla::nav::recast::dtCrowd *Crowd = nullptr;
+
+  std::unordered_map<carla::rpc::ActorId, FWalkerAgent> Walkers;
+
+  std::unordered_map<carla::rpc::ActorId, FVehicleAgent> Vehicles;
+
+  float ProbabilityCrossing = 0.0f;
+
+  float TimeToUnblock = 0.0f;
+};
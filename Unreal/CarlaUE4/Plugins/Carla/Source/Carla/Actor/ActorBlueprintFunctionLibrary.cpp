@@ -325,6 +325,22 @@ static void FillIdAndTags(FActorDefinition& Def, TStrs && ... Strings)
   Var.RecommendedValues = { Def.Id }; // 推荐值：参与者的ID
   Var.bRestrictToRecommended = false; // 是否限制为推荐值：否
   Def.Variations.Emplace(Var); // 将ROS2名称属性添加到参与者的属性列表中
+
+  // ROS2 发布者的传输：shm 用于同一台机器上的订阅者，udp 用于其它机器上的订阅者
+  FActorVariation Transport;
+  Transport.Id = TEXT("ros_transport"); // 属性ID：ros传输
+  Transport.Type = EActorAttributeType::String; // 属性类型：字符串
+  Transport.RecommendedValues = { TEXT("default"), TEXT("shm"), TEXT("udp") };
+  Transport.bRestrictToRecommended = true; // 只允许推荐值
+  Def.Variations.Emplace(Transport);
+
+  // ROS2 发布者的 QoS：auto 按传感器类型选择
+  FActorVariation Qos;
+  Qos.Id = TEXT("ros_qos"); // 属性ID：ros QoS
+  Qos.Type = EActorAttributeType::String; // 属性类型：字符串
+  Qos.RecommendedValues = { TEXT("default"), TEXT("auto"), TEXT("sensor_data"), TEXT("reliable") };
+  Qos.bRestrictToRecommended = true; // 只允许推荐值
+  Def.Variations.Emplace(Qos);
 }
 
 // 定义一个静态函数，用于为参与者名称属性添加推荐值
@@ -372,6 +388,14 @@ static void AddVariationsForSensor(FActorDefinition& Def)
 
     // 将变化对象添加到参与者定义的变化列表中
     Def.Variations.Emplace(Tick);
+
+    // 每隔多少帧运行一次传感器，相同频率的传感器会被错开到不同的帧上
+    FActorVariation TickDivisor;
+    TickDivisor.Id = TEXT("tick_divisor");
+    TickDivisor.Type = EActorAttributeType::Int;
+    TickDivisor.RecommendedValues = { TEXT("1") };
+    TickDivisor.bRestrictToRecommended = false;
+    Def.Variations.Emplace(TickDivisor);
 }
 
 // 定义一个函数，用于为触发器添加变化属性
@@ -656,6 +680,59 @@ void UActorBlueprintFunctionLibrary::MakeCameraDefinition(
     LensYSize.bRestrictToRecommended = false;
 
 
+ // 渲染开销：预设和单独的开关，只能在全局画质的基础上去掉渲染特性
+    FActorVariation RenderingProfile;
+    RenderingProfile.Id = TEXT("rendering_profile");
+    RenderingProfile.Type = EActorAttributeType::String;
+    // "low"关闭阴影、半透明、环境光遮蔽、反射和体积雾，并使用两倍的LOD距离缩放
+    RenderingProfile.RecommendedValues = { TEXT("default"), TEXT("low") };
+    RenderingProfile.bRestrictToRecommended = true;
+
+    // 以下开关与预设同时生效，任一方关闭时该特性即被关闭
+    FActorVariation EnableShadows;
+    EnableShadows.Id = TEXT("enable_shadows");
+    EnableShadows.Type = EActorAttributeType::Bool;
+    EnableShadows.RecommendedValues = { TEXT("true") };
+    EnableShadows.bRestrictToRecommended = false;
+
+    FActorVariation EnableTranslucency;
+    EnableTranslucency.Id = TEXT("enable_translucency");
+    EnableTranslucency.Type = EActorAttributeType::Bool;
+    EnableTranslucency.RecommendedValues = { TEXT("true") };
+    EnableTranslucency.bRestrictToRecommended = false;
+
+    FActorVariation EnableAmbientOcclusion;
+    EnableAmbientOcclusion.Id = TEXT("enable_ambient_occlusion");
+    EnableAmbientOcclusion.Type = EActorAttributeType::Bool;
+    EnableAmbientOcclusion.RecommendedValues = { TEXT("true") };
+    EnableAmbientOcclusion.bRestrictToRecommended = false;
+
+    FActorVariation EnableReflections;
+    EnableReflections.Id = TEXT("enable_reflections");
+    EnableReflections.Type = EActorAttributeType::Bool;
+    EnableReflections.RecommendedValues = { TEXT("true") };
+    EnableReflections.bRestrictToRecommended = false;
+
+    FActorVariation EnableVolumetricFog;
+    EnableVolumetricFog.Id = TEXT("enable_volumetric_fog");
+    EnableVolumetricFog.Type = EActorAttributeType::Bool;
+    EnableVolumetricFog.RecommendedValues = { TEXT("true") };
+    EnableVolumetricFog.bRestrictToRecommended = false;
+
+    // LOD距离缩放，与预设的缩放相乘，大于1时更早地切换到低精度的LOD
+    FActorVariation LODDistanceScale;
+    LODDistanceScale.Id = TEXT("lod_distance_scale");
+    LODDistanceScale.Type = EActorAttributeType::Float;
+    LODDistanceScale.RecommendedValues = { TEXT("1.0") };
+    LODDistanceScale.bRestrictToRecommended = false;
+
+    // 最大可视距离，单位为米，超出的物体不渲染，0表示使用关卡的设置
+    FActorVariation MaxViewDistance;
+    MaxViewDistance.Id = TEXT("max_view_distance");
+    MaxViewDistance.Type = EActorAttributeType::Float;
+    MaxViewDistance.RecommendedValues = { TEXT("0.0") };
+    MaxViewDistance.bRestrictToRecommended = false;
+
  // 将一系列变量（如分辨率、视野等）添加到定义的变化列表中
 Definition.Variations.Append({
     ResX,           // 分辨率X轴
@@ -666,7 +743,15 @@ Definition.Variations.Append({
     LensK,          // 镜头K值（一种镜头畸变参数）
     LensKcube,      // 镜头K立方值（另一种镜头畸变参数）
     LensXSize,      // 镜头X轴尺寸
-    LensYSize});    // 镜头Y轴尺寸
+    LensYSize,      // 镜头Y轴尺寸
+    RenderingProfile,       // 渲染预设
+    EnableShadows,          // 阴影
+    EnableTranslucency,     // 半透明
+    EnableAmbientOcclusion, // 环境光遮蔽
+    EnableReflections,      // 反射
+    EnableVolumetricFog,    // 体积雾
+    LODDistanceScale,       // LOD距离缩放
+    MaxViewDistance});      // 最大可视距离
  
 // 如果启用了修改后处理效果的功能
 if (bEnableModifyingPostProcessEffects)
@@ -1392,13 +1477,21 @@ void UActorBlueprintFunctionLibrary::MakeIMUDefinition(
 
       NoiseSeed.bRestrictToRecommended = false; 
 
-      // 将HorizontalFOV, VerticalFOV, Range, PointsPerSecond, NoiseSeed添加到Definition的Variations列表中
+      // 分层采样：把射线均匀地分到视场的各个网格中，用更少的射线达到相同的覆盖
+      FActorVariation StratifiedSampling;
+      StratifiedSampling.Id = TEXT("stratified_sampling");
+      StratifiedSampling.Type = EActorAttributeType::Bool;
+      StratifiedSampling.RecommendedValues = { TEXT("false") };
+      StratifiedSampling.bRestrictToRecommended = false;
+
+      // 将HorizontalFOV, VerticalFOV, Range, PointsPerSecond, NoiseSeed, StratifiedSampling添加到Definition的Variations列表中
       Definition.Variations.Append({
           HorizontalFOV, //水平视场角
           VerticalFOV, //垂直视场角
           Range, //范围
           PointsPerSecond, //每秒点数
-          NoiseSeed }); //噪声种子
+          NoiseSeed, //噪声种子
+          StratifiedSampling }); //分层采样
 
       // 调用CheckActorDefinition函数检查Definition的有效性，并将结果存储在Success变量中
       Success = CheckActorDefinition(Definition);
@@ -2453,6 +2546,29 @@ void UActorBlueprintFunctionLibrary::SetCamera(
       RetrieveActorAttributeToInt("image_size_y", Description.Variations, 600));
   Camera->SetFOVAngle(
       RetrieveActorAttributeToFloat("fov", Description.Variations, 90.0f));
+
+  // Rendering cost, the switches can only disable what the profile keeps.
+  auto Profile =
+      RetrieveActorAttributeToString("rendering_profile", Description.Variations, "default") == "low" ?
+      FSceneCaptureRenderingProfile::Low() :
+      FSceneCaptureRenderingProfile{};
+  Profile.bShadows &=
+      RetrieveActorAttributeToBool("enable_shadows", Description.Variations, true);
+  Profile.bTranslucency &=
+      RetrieveActorAttributeToBool("enable_translucency", Description.Variations, true);
+  Profile.bAmbientOcclusion &=
+      RetrieveActorAttributeToBool("enable_ambient_occlusion", Description.Variations, true);
+  Profile.bReflections &=
+      RetrieveActorAttributeToBool("enable_reflections", Description.Variations, true);
+  Profile.bVolumetricFog &=
+      RetrieveActorAttributeToBool("enable_volumetric_fog", Description.Variations, true);
+  Profile.LODDistanceScale *=
+      RetrieveActorAttributeToFloat("lod_distance_scale", Description.Variations, 1.0f);
+  constexpr float TO_CENTIMETERS = 1e2;
+  Profile.MaxViewDistance =
+      RetrieveActorAttributeToFloat("max_view_distance", Description.Variations, 0.0f) * TO_CENTIMETERS;
+  Camera->SetRenderingProfile(Profile);
+
   if (Description.Variations.Contains("enable_postprocess_effects"))
   {
     Camera->EnablePostProcessingEffects(
@@ -2671,6 +2787,8 @@ void UActorBlueprintFunctionLibrary::SetRadar(
       RetrieveActorAttributeToFloat("range", Description.Variations, 100.0f) * TO_CENTIMETERS);
   Radar->SetPointsPerSecond(
       RetrieveActorAttributeToInt("points_per_second", Description.Variations, 1500));
+  Radar->SetStratifiedSampling(
+      RetrieveActorAttributeToBool("stratified_sampling", Description.Variations, false));
 }
 
 void UActorBlueprintFunctionLibrary::SetV2X(
@@ -12,14 +12,135 @@
 #include "Carla/Actor/CarlaActorFactory.h"
 
 #include "Carla/Game/Tagger.h"
+#include "Carla/Vehicle/CarlaWheeledVehicle.h"
 #include "Carla/Vehicle/VehicleControl.h"
+#include "Carla/Vehicle/WheeledVehicleAIController.h"
+#include "Carla/Walker/WalkerBase.h"
+#include "Carla/Walker/WalkerController.h"
 
+#include "GameFramework/CharacterMovementComponent.h"
 #include "GameFramework/Controller.h"
 
 #include <compiler/disable-ue4-macros.h>
 #include "carla/ros2/ROS2.h"
 #include <compiler/enable-ue4-macros.h>
 
+// 只重用车辆和行人：它们的构造开销最大，重置状态后与新生成的参与者没有区别
+static bool ActorDispatcher_IsPoolable(const AActor &Actor)
+{
+  return Actor.IsA<ACarlaWheeledVehicle>() || Actor.IsA<AWalkerBase>();
+}
+
+// 属性相同的描述生成相同的参与者；role_name 和 ros_* 只影响注册，不比较
+static bool ActorDispatcher_IsSameSpawn(const FActorDescription &Lhs, const FActorDescription &Rhs)
+{
+  auto IsIgnored = [](const FString &Key) {
+    return Key == TEXT("role_name") || Key == TEXT("ros_name") ||
+        Key == TEXT("ros_transport") || Key == TEXT("ros_qos");
+  };
+  int32 Count = 0;
+  for (const auto &Item : Lhs.Variations)
+  {
+    if (IsIgnored(Item.Key))
+    {
+      continue;
+    }
+    const FActorAttribute *Other = Rhs.Variations.Find(Item.Key);
+    if (Other == nullptr || Other->Value != Item.Value.Value)
+    {
+      return false;
+    }
+    ++Count;
+  }
+  for (const auto &Item : Rhs.Variations)
+  {
+    if (!IsIgnored(Item.Key))
+    {
+      --Count;
+    }
+  }
+  return Count == 0;
+}
+
+// 休眠的参与者隐藏、不参与碰撞和物理模拟，也不更新
+static void ActorDispatcher_SetDormant(AActor &Actor, bool bDormant)
+{
+  Actor.SetActorHiddenInGame(bDormant);
+  Actor.SetActorEnableCollision(!bDormant);
+  Actor.SetActorTickEnabled(!bDormant);
+  if (ACarlaWheeledVehicle *Vehicle = Cast<ACarlaWheeledVehicle>(&Actor))
+  {
+    Vehicle->SetSimulatePhysics(!bDormant);
+  }
+  else if (ACharacter *Character = Cast<ACharacter>(&Actor))
+  {
+    UCharacterMovementComponent *Movement = Character->GetCharacterMovement();
+    if (Movement != nullptr)
+    {
+      if (bDormant)
+      {
+        Movement->DisableMovement();
+      }
+      else
+      {
+        Movement->SetMovementMode(MOVE_Walking);
+      }
+    }
+  }
+  APawn *Pawn = Cast<APawn>(&Actor);
+  UPawnMovementComponent *PawnMovement = Pawn != nullptr ? Pawn->GetMovementComponent() : nullptr;
+  if (PawnMovement != nullptr)
+  {
+    PawnMovement->SetComponentTickEnabled(!bDormant);
+  }
+}
+
+// 清除上一次使用时的控制、速度和灯光，使重用的参与者与新生成的一样
+static void ActorDispatcher_ResetState(AActor &Actor)
+{
+  if (ACarlaWheeledVehicle *Vehicle = Cast<ACarlaWheeledVehicle>(&Actor))
+  {
+    Vehicle->DeactivateVelocityControl();
+    Vehicle->ApplyVehicleControl(FVehicleControl{}, EVehicleInputPriority::Highest);
+    Vehicle->SetVehicleLightState(FVehicleLightState{});
+    AWheeledVehicleAIController *Controller = Cast<AWheeledVehicleAIController>(Vehicle->GetController());
+    if (Controller != nullptr)
+    {
+      Controller->SetAutopilot(false);
+    }
+  }
+  else if (APawn *Pawn = Cast<APawn>(&Actor))
+  {
+    AWalkerController *Controller = Cast<AWalkerController>(Pawn->GetController());
+    if (Controller != nullptr)
+    {
+      Controller->ApplyWalkerControl(FWalkerControl{});
+    }
+  }
+  UPrimitiveComponent *Root = Cast<UPrimitiveComponent>(Actor.GetRootComponent());
+  if (Root != nullptr)
+  {
+    Root->SetPhysicsLinearVelocity(FVector::ZeroVector);
+    Root->SetPhysicsAngularVelocityInDegrees(FVector::ZeroVector);
+  }
+}
+
+// 销毁参与者的控制器（如果有）
+static void ActorDispatcher_DestroyController(AActor &Actor, const FString &Id)
+{
+  APawn* Pawn = Cast<APawn>(&Actor);
+  AController* Controller = (Pawn != nullptr ? Pawn->GetController() : nullptr);
+  if (Controller != nullptr)
+  {
+    UE_LOG(LogCarla, Log, TEXT("Destroying actor's controller: '%s'"), *Id);
+    bool Success = Controller->Destroy();
+    if (!Success)
+    {
+      UE_LOG(LogCarla, Error, TEXT("Failed to destroy actor's controller: '%s'"), *Id);
+    }
+  }
+}
+
 // UActorDispatcher类中的Bind函数，用于绑定一个Actor定义和生成函数
 void UActorDispatcher::Bind(FActorDefinition Definition, SpawnFunctionType Functor)
 {
@@ -74,8 +195,11 @@ TPair<EActorSpawnResultStatus, FCarlaActor*> UActorDispatcher::SpawnActor(
 
   // 设置Actor描述中的类
   Description.Class = Classes[Description.UId - 1];
-  // 调用对应的生成函数生成Actor
-  FActorSpawnResult Result = SpawnFunctions[Description.UId - 1](Transform, Description);
+  // 优先重用参与者池中的参与者，否则调用对应的生成函数生成Actor
+  AActor *Recycled = TryRecycleActor(Transform, Description);
+  FActorSpawnResult Result = Recycled != nullptr ?
+      FActorSpawnResult(Recycled) :
+      SpawnFunctions[Description.UId - 1](Transform, Description);
 
   // 如果生成结果状态为成功但未返回Actor，记录警告日志并将状态设置为未知错误
   if ((Result.Status == EActorSpawnResultStatus::Success) && (Result.Actor == nullptr))
@@ -94,11 +218,6 @@ TPair<EActorSpawnResultStatus, FCarlaActor*> UActorDispatcher::SpawnActor(
     UE_LOG(LogCarla, Warning, TEXT("Failed to spawn actor '%s'"), *Description.Id);
     check(Result.Status != EActorSpawnResultStatus::Success);
   }
-  else
-  {
-    // 如果注册成功，对Actor进行标记
-    ATagger::TagActor(*View->GetActor(), true);
-  }
   // 返回生成结果状态和Actor指针
   return MakeTuple(Result.Status, View);
 }
@@ -155,32 +274,19 @@ bool UActorDispatcher::DestroyActor(FCarlaActor::IdType ActorId)
 
   const FString &Id = View->GetActorInfo()->Description.Id;
 
-  // 获取Actor的控制器，如果存在，则尝试销毁
   AActor* Actor = View->GetActor();
-  if(Actor)
+  if (Actor && TryPoolActor(*View))
   {
-    APawn* Pawn = Cast<APawn>(Actor);
-    AController* Controller = (Pawn != nullptr ? Pawn->GetController() : nullptr);
-    if (Controller != nullptr)
-    {
-      UE_LOG(LogCarla, Log, TEXT("Destroying actor's controller: '%s'"), *Id);
-      bool Success = Controller->Destroy();
-      if (!Success)
-      {
-        UE_LOG(LogCarla, Error, TEXT("Failed to destroy actor's controller: '%s'"), *Id);
-      }
-    }
-
-    // 销毁Actor
-    // ...（代码未完整，以下为注释）
-    // 如果Actor存在，调用Destroy函数尝试销毁
-    // 如果销毁失败，记录错误日志
-    // 返回true表示销毁操作已尝试执行
+    // 放入参与者池的参与者保留控制器，只从注册表中移除
+    UE_LOG(LogCarla, Log, TEXT("UActorDispatcher::Pooling actor: '%s'"), *Id);
+    Registry.Deregister(ActorId);
     return true;
   }
-  // 如果Actor不存在，返回false表示销毁操作未执行
-  return false;
-}
+
+  // 获取Actor的控制器，如果存在，则尝试销毁
+  if(Actor)
+  {
+    ActorDispatcher_DestroyController(*Actor, Id);
 
     UE_LOG(LogCarla, Log, TEXT("UActorDispatcher::Destroying actor: '%s' %x"), *Id, Actor);
     UE_LOG(LogCarla, Log, TEXT("            %s"), Actor?*Actor->GetName():*FString("None"));
@@ -203,23 +309,40 @@ FCarlaActor* UActorDispatcher::RegisterActor(
   FCarlaActor* View = Registry.Register(Actor, Description, DesiredId);
   if (View)
   {
+    // 注册后重新标记，实例分割的映射表记录刚分配的参与者 id
+    ATagger::TagActor(Actor, true);
+
     // 待办事项：支持外部角色销毁
-    Actor.OnDestroyed.AddDynamic(this, &UActorDispatcher::OnActorDestroyed);
+    // 重用的参与者已经绑定过
+    Actor.OnDestroyed.AddUniqueDynamic(this, &UActorDispatcher::OnActorDestroyed);
 
     // ROS2 中 actor 到 ros_name 的映射
     #if defined(WITH_ROS2)
     auto ROS2 = carla::ros2::ROS2::GetInstance();
     if (ROS2->IsEnabled())
     {
-      // 参与者 ros_name
+      // 参与者 ros_name、ros_transport 和 ros_qos
       std::string RosName;
+      std::string RosTransport;
+      std::string RosQos;
       for (auto &&Attr : Description.Variations)
       {
         if (Attr.Key == "ros_name")
         {
           RosName = std::string(TCHAR_TO_UTF8(*Attr.Value.Value));
         }
+        else if (Attr.Key == "ros_transport")
+        {
+          RosTransport = std::string(TCHAR_TO_UTF8(*Attr.Value.Value));
+        }
+        else if (Attr.Key == "ros_qos")
+        {
+          RosQos = std::string(TCHAR_TO_UTF8(*Attr.Value.Value));
+        }
       }
+      // 发布者在第一次发布数据时创建，在这之前设置
+      ROS2->AddActorRosQos(static_cast<void*>(&Actor),
+          carla::ros2::ROS2QosProfile::Parse(RosTransport, RosQos));
       const std::string id = std::string(TCHAR_TO_UTF8(*Description.Id));
       if (RosName == id) {
         if(RosName.find("vehicle") != std::string::npos)
@@ -258,6 +381,97 @@ FCarlaActor* UActorDispatcher::RegisterActor(
   return View;
 }
 
+void UActorDispatcher::SetActorPoolSize(int32 Size)
+{
+  ActorPoolSize = FMath::Max(Size, 0);
+  for (auto &Pair : ActorPool)
+  {
+    while (PooledActorCount > ActorPoolSize && Pair.Value.Num() > 0)
+    {
+      FPooledActor Pooled = Pair.Value.Pop();
+      --PooledActorCount;
+      AActor *Actor = Pooled.Actor.Get();
+      if (Actor != nullptr)
+      {
+        ActorDispatcher_DestroyController(*Actor, Pooled.Description.Id);
+        Actor->Destroy();
+      }
+    }
+  }
+}
+
+bool UActorDispatcher::TryPoolActor(FCarlaActor &View)
+{
+  AActor *Actor = View.GetActor();
+  if (PooledActorCount >= ActorPoolSize || Actor == nullptr || View.IsDormant() ||
+      !ActorDispatcher_IsPoolable(*Actor))
+  {
+    return false;
+  }
+  // 附着了其他参与者（例如传感器）的参与者直接销毁
+  TArray<AActor *> AttachedActors;
+  Actor->GetAttachedActors(AttachedActors);
+  if (AttachedActors.Num() > 0)
+  {
+    return false;
+  }
+  Actor->DetachFromActor(FDetachmentTransformRules::KeepWorldTransform);
+  ActorDispatcher_SetDormant(*Actor, true);
+  const FActorDescription &Description = View.GetActorInfo()->Description;
+  ActorPool.FindOrAdd(Description.UId).Add(FPooledActor{Actor, Description});
+  ++PooledActorCount;
+
+  #if defined(WITH_ROS2)
+  auto ROS2 = carla::ros2::ROS2::GetInstance();
+  if (ROS2->IsEnabled())
+  {
+    ROS2->RemoveActorRosName(reinterpret_cast<void *>(Actor));
+  }
+  #endif
+  return true;
+}
+
+AActor *UActorDispatcher::TryRecycleActor(
+    const FTransform &Transform,
+    const FActorDescription &Description)
+{
+  TArray<FPooledActor> *Pooled = ActorPool.Find(Description.UId);
+  if (Pooled == nullptr)
+  {
+    return nullptr;
+  }
+  for (int32 i = Pooled->Num() - 1; i >= 0; --i)
+  {
+    AActor *Actor = (*Pooled)[i].Actor.Get();
+    if (Actor == nullptr)
+    {
+      // 已经随关卡一起销毁
+      Pooled->RemoveAtSwap(i);
+      --PooledActorCount;
+      continue;
+    }
+    if (!ActorDispatcher_IsSameSpawn((*Pooled)[i].Description, Description))
+    {
+      continue;
+    }
+    // 与生成函数一样，目标位置被占用时不生成；检查前需要打开碰撞
+    Actor->SetActorEnableCollision(true);
+    if (Actor->GetWorld()->EncroachingBlockingGeometry(Actor, Transform.GetLocation(), Transform.Rotator()))
+    {
+      Actor->SetActorEnableCollision(false);
+      return nullptr;
+    }
+    Pooled->RemoveAtSwap(i);
+    --PooledActorCount;
+    Actor->SetActorTransform(Transform, false, nullptr, ETeleportType::ResetPhysics);
+    ActorDispatcher_SetDormant(*Actor, false);
+    ActorDispatcher_ResetState(*Actor);
+    UE_LOG(LogCarla, Log, TEXT("Recycling pooled actor for '%s'"), *Description.Id);
+    return Actor;
+  }
+  return nullptr;
+}
+
 void UActorDispatcher::PutActorToSleep(FCarlaActor::IdType Id, UCarlaEpisode* CarlaEpisode)
 {
   Registry.PutActorToSleep(Id, CarlaEpisode);
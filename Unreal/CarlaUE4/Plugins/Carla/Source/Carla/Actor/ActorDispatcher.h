@@ -78,6 +78,24 @@ public:
       FActorDescription ActorDescription,
       FActorRegistry::IdType DesiredId = 0);
 
+  /// 参与者池最多保留的休眠参与者数，为0时不使用参与者池。
+  ///
+  /// 启用后，销毁的车辆和行人不会真正销毁，而是隐藏并停止物理模拟，之后
+  /// 生成相同蓝图和属性的参与者时直接重置并重用，省去构造参与者和物理体的
+  /// 开销。缩小时多出的休眠参与者会被销毁。
+  void SetActorPoolSize(int32 Size);
+
+  int32 GetActorPoolSize() const
+  {
+    return ActorPoolSize;
+  }
+
+  /// 当前参与者池中的休眠参与者数
+  int32 GetPooledActorCount() const
+  {
+    return PooledActorCount;
+  }
+
   const TArray<FActorDefinition> &GetActorDefinitions() const
   {
     return Definitions;
@@ -98,6 +116,28 @@ private:
   UFUNCTION()
   void OnActorDestroyed(AActor *Actor);
 
+  /// 参与者池中的一个休眠参与者及生成它时的描述
+  struct FPooledActor
+  {
+    TWeakObjectPtr<AActor> Actor;
+
+    FActorDescription Description;
+  };
+
+  /// 参与者池未满且 @a View 可以重用时把它放入参与者池，返回是否放入
+  bool TryPoolActor(FCarlaActor &View);
+
+  /// 从参与者池中取出与 @a Description 相同的参与者并移动到 @a Transform，
+  /// 没有可用的参与者或者目标位置被占用时返回 nullptr
+  AActor *TryRecycleActor(const FTransform &Transform, const FActorDescription &Description);
+
+  /// 以蓝图 UId 分组的休眠参与者
+  TMap<uint32, TArray<FPooledActor>> ActorPool;
+
+  int32 ActorPoolSize = 0;
+
+  int32 PooledActorCount = 0;
+
   TArray<FActorDefinition> Definitions;
 
   TArray<SpawnFunctionType> SpawnFunctions;
@@ -111,8 +111,6 @@ FCarlaActor* FActorRegistry::Register(AActor &Actor, FActorDescription Descripti
     {
         // 将当前要注册的Actor关联到已有的CarlaActor对象上
         CarlaActor->TheActor = &Actor;  
-        // 在Actors映射中添加（或更新）Actor与指定ID的关联
-        Actors.Add(DesiredId, &Actor);  
         // 在Ids映射中添加（或更新）Actor指针与ID的反向关联
         Ids.Add(&Actor, DesiredId);  
         // 返回已处理好的CarlaActor指针，表示注册完成（复用已有的）
@@ -125,7 +123,7 @@ FCarlaActor* FActorRegistry::Register(AActor &Actor, FActorDescription Descripti
     // 如果传入了期望的ID（DesiredId）且新分配的ID与期望的ID不一致，则进行以下处理
     if (DesiredId!= 0 && Id!= DesiredId) {  
         // 检查期望的ID是否没有被其他Actor占用，如果没被占用则使用期望的ID
-        if (!Actors.Contains(DesiredId))  
+        if (!Contains(DesiredId))  
         {
             Id = DesiredId;  
             // 如果全局ID计数器的值小于期望使用的ID，更新全局ID计数器的值为期望的ID（保证计数器始终是最大的ID值）
@@ -134,8 +132,6 @@ FCarlaActor* FActorRegistry::Register(AActor &Actor, FActorDescription Descripti
         }
     }
 
-    // 在Actors映射中添加新的Actor与分配的ID的关联
-    Actors.Emplace(Id, &Actor);  
     // 检查是否已经存在当前Actor指针的注册记录，如果存在则输出警告日志（可能存在重复注册等异常情况）
     if (Ids.Contains(&Actor))  
     {
@@ -153,13 +149,8 @@ FCarlaActor* FActorRegistry::Register(AActor &Actor, FActorDescription Descripti
     TSharedPtr<FCarlaActor> View =
         MakeCarlaActor(Id, Actor, std::move(Description), crp::ActorState::Active);  
 
-    // 将新创建的FCarlaActor共享指针添加到ActorDatabase映射中，使用分配的ID作为键，并获取添加后的引用（Result）
-    TSharedPtr<FCarlaActor>& Result = ActorDatabase.Emplace(Id, MoveTemp(View));  
-
-    // 进行一致性检查，确保Actors映射中的元素数量和ActorDatabase映射中的元素数量相等（数据一致性校验）
-    check(static_cast<size_t>(Actors.Num()) == ActorDatabase.Num());  
-    // 返回注册后的FCarlaActor的指针，代表注册成功后的Actor对象在系统中的表示
-    return Result.Get();  
+    // 将新创建的FCarlaActor添加到注册表中，返回注册后的FCarlaActor的指针
+    return Add(Id, MoveTemp(View));  
 }
 
 // FActorRegistry类的成员函数Deregister，用于根据指定的ID注销一个已注册的Actor
@@ -175,18 +166,78 @@ void FActorRegistry::Deregister(IdType Id)
     // 获取要注销的Actor对应的AActor指针
     AActor *Actor = CarlaActor->GetActor();  
 
-    // 从ActorDatabase映射中移除指定ID对应的Actor记录
-    ActorDatabase.Remove(Id);  
-    // 从Actors映射中移除指定ID与Actor的关联
-    Actors.Remove(Id);  
+    // 将对应的FCarlaActor对象中的Actor指针置为空，表示已注销该Actor。
+    // 必须在移除之前，注册表可能持有它的最后一个引用
+    CarlaActor->TheActor = nullptr;  
+
     // 从Ids映射中移除Actor指针与ID的反向关联
     Ids.Remove(Actor);  
+    // 从注册表中移除指定ID对应的Actor记录
+    Remove(Id);  
+}
 
-    // 将对应的FCarlaActor对象中的Actor指针置为空，表示已注销该Actor
-    CarlaActor->TheActor = nullptr;  
+void FActorRegistry::SetIndex(IdType Id, int32 Index)
+{
+  if (Id >= MAX_DIRECT_ID)
+  {
+    if (Index == INDEX_NONE)
+    {
+      IndexOfLargeId.Remove(Id);
+    }
+    else
+    {
+      IndexOfLargeId.Add(Id, Index);
+    }
+    return;
+  }
+  const int32 OldNum = IndexOfId.Num();
+  if (static_cast<int32>(Id) >= OldNum)
+  {
+    if (Index == INDEX_NONE)
+    {
+      return;
+    }
+    IndexOfId.SetNumUninitialized(Id + 1);
+    for (int32 i = OldNum; i < IndexOfId.Num(); ++i)
+    {
+      IndexOfId[i] = INDEX_NONE;
+    }
+  }
+  IndexOfId[Id] = Index;
+}
 
-    // 进行一致性检查，确保Actors映射中的元素数量和ActorDatabase映射中的元素数量相等（数据一致性校验）
-    check(static_cast<size_t>(Actors.Num()) == ActorDatabase.Num());  
+FCarlaActor* FActorRegistry::Add(IdType Id, TSharedPtr<FCarlaActor> CarlaActor)
+{
+  // 与 TMap::Emplace 相同，已有的参与者被替换
+  Remove(Id);
+  const uint32 Slot = FreeSlots.Num() > 0 ? FreeSlots.Pop(false) : Slots.AddDefaulted();
+  const int32 Index = Entries.Add(FEntry{Id, MoveTemp(CarlaActor), Slot});
+  Slots[Slot].Index = Index;
+  SetIndex(Id, Index);
+  return Entries[Index].Value.Get();
+}
+
+void FActorRegistry::Remove(IdType Id)
+{
+  const int32 Index = FindIndex(Id);
+  if (Index == INDEX_NONE)
+  {
+    return;
+  }
+  // 使这个槽位的稳定引用失效
+  const uint32 Slot = Entries[Index].Slot;
+  Slots[Slot].Index = INDEX_NONE;
+  ++Slots[Slot].Generation;
+  FreeSlots.Add(Slot);
+  SetIndex(Id, INDEX_NONE);
+  // 用最后一个参与者填补空位
+  Entries.RemoveAtSwap(Index, 1, false);
+  if (Index < Entries.Num())
+  {
+    const FEntry &Moved = Entries[Index];
+    Slots[Moved.Slot].Index = Index;
+    SetIndex(Moved.Key, Index);
+  }
 }
 
 // FActorRegistry类的成员函数Deregister的重载版本，用于根据传入的AActor指针注销对应的Actor
@@ -265,6 +316,39 @@ TSharedPtr<FCarlaActor> FActorRegistry::MakeCarlaActor(
     return CarlaActor;  
 }
 
+// 按序列化数据中保存的数据流令牌查找传感器，休眠的传感器也能找到
+const FActorInfo *FActorRegistry::FindActorInfoFromStream(carla::streaming::detail::stream_id_type Id) const
+{
+  const FCarlaActor *CarlaActor = FindCarlaActorFromStream(Id);
+  return CarlaActor != nullptr ? CarlaActor->GetActorInfo() : nullptr;
+}
+
+FCarlaActor *FActorRegistry::FindCarlaActorFromStream(carla::streaming::detail::stream_id_type Id) const
+{
+  for (const auto &Item : Entries)
+  {
+    const FActorInfo *Info = Item.Value->GetActorInfo();
+    if (Info == nullptr ||
+        Info->SerializedData.stream_token.size() != sizeof(carla::streaming::detail::token_data))
+    {
+      continue;
+    }
+    const carla::streaming::detail::token_type Token(
+        *reinterpret_cast<const carla::streaming::detail::token_data *>(Info->SerializedData.stream_token.data()));
+    if (Token.get_stream_id() == Id)
+    {
+      return Item.Value.Get();
+    }
+  }
+  return nullptr;
+}
+
+FString FActorRegistry::GetDescriptionFromStream(carla::streaming::detail::stream_id_type Id)
+{
+  const FActorInfo *Info = FindActorInfoFromStream(Id);
+  return Info != nullptr ? Info->Description.Id : FString("");
+}
+
 // FActorRegistry类的成员函数PutActorToSleep，用于将指定ID的Actor及其子Actor设置为休眠状态
 // 参数Id是要设置为休眠状态的Actor的ID类型，通过这个ID来查找对应的Actor
 // 参数CarlaEpisode可能是和游戏场景、关卡等相关的对象指针，用于关联Actor与具体的游戏环境（具体依Carla架构而定）
@@ -273,8 +357,6 @@ void FActorRegistry::PutActorToSleep(FCarlaActor::IdType Id, UCarlaEpisode* Carl
     // 根据传入的ID查找对应的FCarlaActor对象
     FCarlaActor* CarlaActor = FindCarlaActor(Id);  
 
-    // 更新Actors映射中指定ID对应的Actor指针为nullptr，表示该Actor进入休眠状态（从活跃关联中移除）
-    Actors[Id] = nullptr;  
     // 获取对应的AActor指针
     AActor* Actor = CarlaActor->GetActor();  
     // 如果Actor指针不为空，从Ids映射中移除该Actor指针与ID的反向关联（解除关联）
@@ -292,3 +374,19 @@ void FActorRegistry::PutActorToSleep(FCarlaActor::IdType Id, UCarlaEpisode* Carl
     }
     // TODO：更新ID映射，这里可能是后续需要完善的部分，比如进一步处理休眠状态下ID映射的一些细节调整等（目前代码未完整实现这部分功能）
 }
+
+// 唤醒指定ID的Actor及其子Actor，恢复Actor指针与ID的反向关联
+void FActorRegistry::WakeActorUp(FCarlaActor::IdType Id, UCarlaEpisode* CarlaEpisode)
+{
+    FCarlaActor* CarlaActor = FindCarlaActor(Id);
+    CarlaActor->WakeActorUp(CarlaEpisode);
+    AActor* Actor = CarlaActor->GetActor();
+    if (Actor)
+    {
+        Ids.Add(Actor, Id);
+    }
+    for (const FCarlaActor::IdType& ChildId : CarlaActor->GetChildren())
+    {
+        WakeActorUp(ChildId, CarlaEpisode);
+    }
+}
@@ -7,23 +7,41 @@
 #pragma once // 指示此头文件被包含一次，防止重复包含
 
 #include "Carla/Actor/CarlaActor.h" // 包含CARLA中的Actor类定义
+#include "Containers/Array.h" // 包含Unreal Engine的Array容器定义
 #include "Containers/Map.h" // 包含Unreal Engine的Map容器定义
 #include <compiler/disable-ue4-macros.h> // 禁用UE4宏，防止与carla库的宏冲突
 #include <carla/Iterator.h> // 包含carla库的迭代器定义
+#include <carla/streaming/detail/Types.h>
 #include <compiler/enable-ue4-macros.h> // 启用UE4宏
 #include <unordered_map> // 包含C++标准库的unordered_map容器定义
 
 /// 所有Carla角色的注册表
+///
+/// 参与者连续存放在一个数组中，遍历注册表就是线性扫描这个数组。较小的 id
+/// 直接索引到数组中的位置，不需要哈希查找；注销参与者时用最后一个参与者填补
+/// 空位，因此遍历顺序不是注册顺序。
 class FActorRegistry
 {
 public:
   using IdType = FCarlaActor::IdType; // 使用FCarlaActor的IdType作为注册表的ID类型
   using ValueType = TSharedPtr<FCarlaActor>; // 使用TSharedPtr<FCarlaActor>作为注册表的值类型
 
-private:
-  // 使用TMap作为存储Actor的数据库类型，键为ID，值为TSharedPtr<FCarlaActor>
-  using DatabaseType = TMap<IdType, TSharedPtr<FCarlaActor>>;
-  
+  /// 注册表中的一项，成员名与 TMap 的键值对相同。
+  struct FEntry
+  {
+    IdType Key;
+    ValueType Value;
+    uint32 Slot;
+  };
+
+  /// 参与者的稳定引用。参与者注销后失效，即使它的槽位被新的参与者重用，
+  /// FindCarlaActor 也返回 nullptr。
+  struct FHandle
+  {
+    uint32 Slot = ~0u;
+    uint32 Generation = 0u;
+  };
+
   // ===========================================================================
   /// 名称 参与者注册函数
   // ===========================================================================
@@ -44,7 +62,7 @@ public:
   /// @{
   int32 Num() const // 返回当前管理的Actor数量
   {
-    return Actors.Num(); // 返回Map容器中的元素数量
+    return Entries.Num();
   }
   bool IsEmpty() const // 检查当前是否有任何Actor
   {
@@ -52,35 +70,61 @@ public:
   }
   bool Contains(uint32 Id) const // 检查是否包含指定ID的Actor
   {
-    return ActorDatabase.Find(Id) != nullptr; // 如果找到指定ID的Actor，则返回true
+    return FindIndex(Id) != INDEX_NONE;
   }
 
   // 四个FindCarlaActor函数是类的成员函数，用于在不同的上下文中查找FCarlaActor对象
   // 这些函数展示了如何在C++中处理const正确性，即如何编写不会修改对象状态的函数，并返回指向const对象的指针以防止调用者修改这些对象
   FCarlaActor* FindCarlaActor(IdType Id) // 通过ID查找FCarlaActor
   {
-    ValueType* CarlaActorPtr = ActorDatabase.Find(Id); // 在数据库中查找ID对应的Actor
-    return CarlaActorPtr ? CarlaActorPtr->Get() : nullptr; // 如果找到，则返回Actor指针，否则返回nullptr
+    const int32 Index = FindIndex(Id);
+    return Index != INDEX_NONE ? Entries[Index].Value.Get() : nullptr;
   }
   const FCarlaActor* FindCarlaActor(IdType Id) const // 通过ID查找FCarlaActor（const版本）
   {
-    const ValueType* CarlaActorPtr = ActorDatabase.Find(Id); // 在数据库中查找ID对应的Actor
-    return CarlaActorPtr ? CarlaActorPtr->Get() : nullptr; // 如果找到，则返回Actor指针，否则返回nullptr
+    const int32 Index = FindIndex(Id);
+    return Index != INDEX_NONE ? Entries[Index].Value.Get() : nullptr;
   }
   FCarlaActor* FindCarlaActor(const AActor *Actor) // 通过AActor指针查找FCarlaActor
   {
     IdType* PtrToId = Ids.Find(Actor); // 在Ids映射中查找Actor对应的ID
     return PtrToId ? FindCarlaActor(*PtrToId) : nullptr; // 如果找到ID，则通过ID查找对应的FCarlaActor，否则返回nullptr
   }
-  // @}
-};
-
   const FCarlaActor* FindCarlaActor(const AActor *Actor) const
   {
     const IdType* PtrToId = Ids.Find(Actor);
     return PtrToId ? FindCarlaActor(*PtrToId) : nullptr;
   }
+
+  /// 返回参与者 @a Id 的稳定引用，没有这个参与者时返回无效的引用。
+  FHandle GetHandle(IdType Id) const
+  {
+    const int32 Index = FindIndex(Id);
+    if (Index == INDEX_NONE)
+    {
+      return {};
+    }
+    const uint32 Slot = Entries[Index].Slot;
+    return {Slot, Slots[Slot].Generation};
+  }
+  /// 通过稳定引用查找参与者，不需要任何查找表。
+  FCarlaActor* FindCarlaActor(FHandle Handle) const
+  {
+    if (Handle.Slot >= static_cast<uint32>(Slots.Num()))
+    {
+      return nullptr;
+    }
+    const FSlot &Slot = Slots[Handle.Slot];
+    return (Slot.Generation == Handle.Generation && Slot.Index != INDEX_NONE) ?
+        Entries[Slot.Index].Value.Get() :
+        nullptr;
+  }
+
   FString GetDescriptionFromStream(carla::streaming::detail::stream_id_type Id);
+  // 查找主数据流为 Id 的传感器的信息，没有时返回 nullptr
+  const FActorInfo *FindActorInfoFromStream(carla::streaming::detail::stream_id_type Id) const;
+  // 查找主数据流为 Id 的传感器，没有时返回 nullptr
+  FCarlaActor *FindCarlaActorFromStream(carla::streaming::detail::stream_id_type Id) const;
   void PutActorToSleep(IdType Id, UCarlaEpisode* CarlaEpisode);//用于将指定ID的演员设置为“睡眠”状态。UCarlaEpisode参数用于指定这个操作是在哪个特定的情节或场景中进行的
   void WakeActorUp(IdType Id, UCarlaEpisode* CarlaEpisode);
   /// @}
@@ -91,14 +135,41 @@ public:
 public:
   auto begin() const noexcept
   {
-    return ActorDatabase.begin();
+    return Entries.begin();
   }
   auto end() const noexcept
   {
-    return ActorDatabase.end();
+    return Entries.end();
   }
   /// @}
 private://类的私有部分，用于管理CARLA模拟环境中的演员
+
+  /// 槽位指向参与者在 Entries 中的位置，每次被重用时 Generation 加一。
+  struct FSlot
+  {
+    int32 Index = INDEX_NONE;
+    uint32 Generation = 0u;
+  };
+
+  /// 小于该值的 id 直接索引 IndexOfId，更大的 id 放在 IndexOfLargeId 中。
+  static constexpr IdType MAX_DIRECT_ID = 1u << 20;
+
+  int32 FindIndex(IdType Id) const
+  {
+    if (Id < MAX_DIRECT_ID)
+    {
+      return Id < static_cast<IdType>(IndexOfId.Num()) ? IndexOfId[Id] : INDEX_NONE;
+    }
+    const int32 *Index = IndexOfLargeId.Find(Id);
+    return Index != nullptr ? *Index : INDEX_NONE;
+  }
+
+  void SetIndex(IdType Id, int32 Index);
+
+  FCarlaActor* Add(IdType Id, TSharedPtr<FCarlaActor> CarlaActor);
+
+  void Remove(IdType Id);
+
 //创建一个FCarlaActor对象，并返回一个智能指针指向它。它接受一个演员ID、一个AActor引用、一个描述对象和一个状态对象作为参数。
   TSharedPtr<FCarlaActor> MakeCarlaActor(
     IdType Id,
@@ -107,8 +178,11 @@ private://类的私有部分，用于管理CARLA模拟环境中的演员
     carla::rpc::ActorState InState) const;
   FCarlaActor MakeFakeActor(
     AActor &Actor) const;
-  TMap<IdType, AActor *> Actors;//一个映射，将演员ID映射到AActor指针。这允许通过ID快速查找演员对象
-  TMap<AActor *, IdType> Ids;//另一个映射，将AActor指针映射到演员ID。这允许通过演员对象快速查找其ID
-  DatabaseType ActorDatabase;//数据库类型的成员变量，用于存储演员信息
+  TArray<FEntry> Entries; // 所有参与者，连续存放
+  TArray<FSlot> Slots; // 稳定引用的槽位
+  TArray<uint32> FreeSlots; // 可以重用的槽位
+  TArray<int32> IndexOfId; // 较小的 id 在 Entries 中的位置，没有时为 INDEX_NONE
+  TMap<IdType, int32> IndexOfLargeId; // 较大的 id 在 Entries 中的位置
+  TMap<AActor *, IdType> Ids;//另一个映射，将演员指针映射到演员ID。这允许通过演员对象快速查找其ID
   static IdType ID_COUNTER;//一个静态成员变量，用于生成唯一的演员ID。每次创建新演员时，这个计数器可能会递增，以确保每个演员都有一个唯一的ID。
 };
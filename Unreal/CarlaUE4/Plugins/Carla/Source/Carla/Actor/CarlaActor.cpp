@@ -1470,6 +1470,53 @@ ECarlaServerResponse FWalkerActor::SetBonesTransform(const FWalkerBoneControlIn&
   return ECarlaServerResponse::Success;
 }
 
+ECarlaServerResponse FWalkerActor::GetBonesLocalTransforms(
+    TArray<FName>& BoneNames, TArray<FTransform>& Transforms)
+{
+  Transforms.Reset();
+  if (IsDormant())
+  {
+  }
+  else
+  {
+    auto Pawn = Cast<APawn>(GetActor());
+    if (Pawn == nullptr)
+    {
+      return ECarlaServerResponse::NotAWalker;
+    }
+    auto Controller = Cast<AWalkerController>(Pawn->GetController());
+    if (Controller == nullptr)
+    {
+      return ECarlaServerResponse::WalkerIncompatibleController;
+    }
+    Controller->GetBonesLocalTransforms(BoneNames, Transforms);
+  }
+  return ECarlaServerResponse::Success;
+}
+
+ECarlaServerResponse FWalkerActor::SetBonesLocalTransforms(
+    const TMap<FName, int32>& BoneIndices, const TArray<FTransform>& Transforms)
+{
+  if (IsDormant())
+  {
+  }
+  else
+  {
+    auto Pawn = Cast<APawn>(GetActor());
+    if (Pawn == nullptr)
+    {
+      return ECarlaServerResponse::NotAWalker;
+    }
+    auto Controller = Cast<AWalkerController>(Pawn->GetController());
+    if (Controller == nullptr)
+    {
+      return ECarlaServerResponse::WalkerIncompatibleController;
+    }
+    Controller->SetBonesLocalTransforms(BoneIndices, Transforms);
+  }
+  return ECarlaServerResponse::Success;
+}
+
 ECarlaServerResponse FWalkerActor::BlendPose(float Blend)
 {
   if (IsDormant())
@@ -376,6 +376,16 @@ public:
     return ECarlaServerResponse::ActorTypeMismatch;
   }
 
+  virtual ECarlaServerResponse GetBonesLocalTransforms(TArray<FName>&, TArray<FTransform>&)
+  {
+    return ECarlaServerResponse::ActorTypeMismatch;
+  }
+
+  virtual ECarlaServerResponse SetBonesLocalTransforms(const TMap<FName, int32>&, const TArray<FTransform>&)
+  {
+    return ECarlaServerResponse::ActorTypeMismatch;
+  }
+
   virtual ECarlaServerResponse BlendPose(float Blend)
   {
     return ECarlaServerResponse::ActorTypeMismatch;
@@ -586,6 +596,10 @@ public:
 
   virtual ECarlaServerResponse SetBonesTransform(const FWalkerBoneControlIn&) final;
 
+  virtual ECarlaServerResponse GetBonesLocalTransforms(TArray<FName>&, TArray<FTransform>&) final;
+
+  virtual ECarlaServerResponse SetBonesLocalTransforms(const TMap<FName, int32>&, const TArray<FTransform>&) final;
+
   virtual ECarlaServerResponse BlendPose(float Blend);
 
   virtual ECarlaServerResponse GetPoseFromAnimation();
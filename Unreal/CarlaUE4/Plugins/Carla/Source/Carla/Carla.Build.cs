@@ -100,6 +100,7 @@ public class Carla : ModuleRules
         "RenderCore",
         "RHI",
         "Renderer",
+        "CarlaShaders",
         "ProceduralMeshComponent",
         "MeshDescription"
         // ... add other public dependencies that you statically link with here ...
@@ -129,6 +130,7 @@ public class Carla : ModuleRules
         "Foliage",
         "HTTP",
         "StaticMeshDescription",
+        "ImageWrapper",
         "ImageWriteQueue",
         "Json",
         "JsonUtilities",
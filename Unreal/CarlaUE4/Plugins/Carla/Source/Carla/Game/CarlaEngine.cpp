@@ -14,9 +14,12 @@
 #include "Carla/Recorder/CarlaRecorder.h" // 包含CARLA录制器的头文件，用于记录和回放仿真
 #include "Carla/Settings/CarlaSettings.h" // 包含CARLA设置的头文件，定义仿真的配置参数
 #include "Carla/Settings/EpisodeSettings.h" // 包含CARLA游戏环节设置的头文件，定义环节特定的配置
+#include "Carla/Sensor/SceneCaptureSensor.h" // 按需渲染时统计每帧相机的采集次数
 
 #include "Runtime/Core/Public/Misc/App.h" // 包含Unreal Engine应用框架的头文件，提供应用程序接口
 #include "PhysicsEngine/PhysicsSettings.h" // 包含物理引擎设置的头文件，定义物理仿真参数
+#include "RenderCore.h" // 游戏线程和渲染线程的帧时间
+#include "RHI.h" // GPU 的帧时间
 #include "Carla/MapGen/LargeMapManager.h" // 包含CARLA大地图管理器的头文件，管理大型开放世界地图
 
 #include <compiler/disable-ue4-macros.h> // 禁用Unreal Engine的宏，防止与CARLA代码冲突
@@ -26,10 +29,12 @@
 #include <carla/multigpu/secondary.h> // 包含CARLA多GPU次要功能的头文件，用于跨GPU通信
 #include <carla/multigpu/secondaryCommands.h> // 包含CARLA多GPU次要命令的头文件，用于跨GPU通信
 #include <carla/ros2/ROS2.h> // 包含CARLA ROS 2接口的头文件，提供ROS 2集成功能
+#include <carla/rpc/Server.h> // 同步 RPC 的耗时
 #include <carla/streaming/EndPoint.h> // 包含CARLA流媒体端点的头文件，提供流媒体传输功能
 #include <carla/streaming/Server.h> // 包含CARLA流媒体服务器的头文件，提供流媒体传输服务
 #include <compiler/enable-ue4-macros.h> // 启用Unreal Engine的宏
 
+#include <algorithm>
 #include <thread> // 包含C++标准库线程的头文件，提供线程管理功能
 
 // =============================================================================
@@ -96,11 +101,24 @@ void FCarlaEngine::NotifyInitGame(const UCarlaSettings &Settings)
     const auto SecondaryPort = Settings.SecondaryPort;
     const auto PrimaryIP     = Settings.PrimaryIP;
     const auto PrimaryPort   = Settings.PrimaryPort;
-
-    auto BroadcastStream     = Server.Start(Settings.RPCPort, StreamingPort, SecondaryPort);
+    SecondaryFrameLag        = Settings.SecondaryFrameLag;
+    SecondaryCullDistance    = Settings.SecondaryCullDistance;
+    SynchronousSpinTime      = Settings.SynchronousSpinTime / 1000.0;
+    bRenderOnDemand          = Settings.bRenderOnDemand;
+    ActorPoolSize            = Settings.ActorPoolSize;
+
+    auto BroadcastStream     = Server.Start(
+        Settings.RPCPort, StreamingPort, SecondaryPort, Settings.ControlStreamingPort);
     Server.AsyncRun(FCarlaEngine_GetNumberOfThreadsForRPCServer());
 
+    if (Settings.bSharedMemory)
+    {
+      // 必须在创建传感器的流之前启用
+      Server.GetStreamingServer().EnableSharedMemory();
+    }
+
     WorldObserver.SetStream(BroadcastStream);
+    WorldObserver.SetKeyframeInterval(Settings.EpisodeStateKeyframeInterval);
 
     OnPreTickHandle = FWorldDelegates::OnWorldTickStart.AddRaw(
         this,
@@ -140,6 +158,7 @@ void FCarlaEngine::NotifyInitGame(const UCarlaSettings &Settings)
                 TRACE_CPUPROFILER_EVENT_SCOPE_STR("FramesToProcess.emplace_back");
                 std::lock_guard<std::mutex> Lock(FrameToProcessMutex);
                 FramesToProcess.emplace_back(GetCurrentEpisode()->GetFrameData());
+                FramesReceivedTime.emplace_back(FPlatformTime::Seconds());
               }
             }
             // 强制进行一次进行单位时间操作
@@ -148,12 +167,20 @@ void FCarlaEngine::NotifyInitGame(const UCarlaSettings &Settings)
           }
           case carla::multigpu::MultiGPUCommand::LOAD_MAP:
           {
-            FString FinalPath((char *) Data.data());
-            if(GetCurrentEpisode())
+            // 在游戏线程中打开地图，旧地图还没有处理的帧数据不再需要
             {
-              UGameplayStatics::OpenLevel(GetCurrentEpisode()->GetWorld(), *FinalPath, true);
+              std::lock_guard<std::mutex> Lock(FrameToProcessMutex);
+              MapToLoad = FString((char *) Data.data());
+              MapLoadStartTime = FPlatformTime::Seconds();
+              FramesToProcess.clear();
+              FramesReceivedTime.clear();
             }
-            
+            Server.Wake();
+            carla::multigpu::MapStatus Status;
+            Status.stage = carla::multigpu::MAP_LOAD_STARTED;
+            Status.elapsed = 0.0f;
+            carla::Buffer buf(reinterpret_cast<unsigned char *>(&Status), sizeof(Status));
+            Secondary->Write(carla::multigpu::MultiGPUCommand::MAP_STATUS, std::move(buf));
             break;
           }
           case carla::multigpu::MultiGPUCommand::GET_TOKEN:
@@ -164,7 +191,12 @@ void FCarlaEngine::NotifyInitGame(const UCarlaSettings &Settings)
             carla::streaming::detail::token_type token(Server.GetStreamingServer().GetToken(sensor_id));
             carla::Buffer buf(reinterpret_cast<unsigned char *>(&token), (size_t) sizeof(token));
             carla::log_info("responding with a token for port ", token.get_port());
-            Secondary->Write(std::move(buf));
+            Secondary->Write(Id, std::move(buf));
+            {
+              // 在游戏线程中把传感器加入大地图要考虑的参与者
+              std::lock_guard<std::mutex> Lock(FrameToProcessMutex);
+              SensorsToConsider.emplace_back(sensor_id);
+            }
             break;
           }
           case carla::multigpu::MultiGPUCommand::YOU_ALIVE:
@@ -172,7 +204,7 @@ void FCarlaEngine::NotifyInitGame(const UCarlaSettings &Settings)
             std::string msg("Yes, I'm alive");
             carla::Buffer buf((unsigned char *) msg.c_str(), (size_t) msg.size());
             carla::log_info("responding is alive command");
-            Secondary->Write(std::move(buf));
+            Secondary->Write(Id, std::move(buf));
             break;
           }
           case carla::multigpu::MultiGPUCommand::ENABLE_ROS:
@@ -185,7 +217,7 @@ void FCarlaEngine::NotifyInitGame(const UCarlaSettings &Settings)
             bool res = true;
             carla::Buffer buf(reinterpret_cast<unsigned char *>(&res), (size_t) sizeof(bool));
             carla::log_info("responding ENABLE_ROS with a true");
-            Secondary->Write(std::move(buf));
+            Secondary->Write(Id, std::move(buf));
             break;
           }
           case carla::multigpu::MultiGPUCommand::DISABLE_ROS:
@@ -198,7 +230,7 @@ void FCarlaEngine::NotifyInitGame(const UCarlaSettings &Settings)
             bool res = true;
             carla::Buffer buf(reinterpret_cast<unsigned char *>(&res), (size_t) sizeof(bool));
             carla::log_info("responding DISABLE_ROS with a true");
-            Secondary->Write(std::move(buf));
+            Secondary->Write(Id, std::move(buf));
             break;
           }
           case carla::multigpu::MultiGPUCommand::IS_ENABLED_ROS:
@@ -209,7 +241,17 @@ void FCarlaEngine::NotifyInitGame(const UCarlaSettings &Settings)
             bool res = Server.GetStreamingServer().IsEnabledForROS(sensor_id);
             carla::Buffer buf(reinterpret_cast<unsigned char *>(&res), (size_t) sizeof(bool));
             carla::log_info("responding IS_ENABLED_ROS with: ", res);
-            Secondary->Write(std::move(buf));
+            Secondary->Write(Id, std::move(buf));
+            break;
+          }
+          case carla::multigpu::MultiGPUCommand::GET_LOAD:
+          {
+            // 上一帧的耗时，主服务器据此放置新的传感器
+            carla::multigpu::SecondaryLoad Load;
+            Load.frame_time = FPlatformTime::ToMilliseconds(FMath::Max(GGameThreadTime, GRenderThreadTime));
+            Load.gpu_time = FPlatformTime::ToMilliseconds(RHIGetGPUFrameCycles());
+            carla::Buffer buf(reinterpret_cast<unsigned char *>(&Load), sizeof(Load));
+            Secondary->Write(Id, std::move(buf));
             break;
           }
         }
@@ -225,6 +267,10 @@ void FCarlaEngine::NotifyInitGame(const UCarlaSettings &Settings)
       // 我们是主服务器，正在启动服务器
       bIsPrimaryServer = true;
       SecondaryServer = Server.GetSecondaryServer();
+      if (Settings.bSharedMemory)
+      {
+        SecondaryServer->EnableSharedMemory(carla::streaming::detail::tcp::SharedMemoryRing::DEFAULT_CAPACITY);
+      }
       SecondaryServer->SetNewConnectionCallback([this]()
       {
         this->bNewConnection = true;
@@ -264,9 +310,41 @@ void FCarlaEngine::NotifyBeginEpisode(UCarlaEpisode &Episode)
   {
     // 将此次要服务器设置为无渲染模式
     CurrentSettings.bNoRenderingMode = true;
+    // 大地图中次级服务器只加载它负责的传感器周围的图块
+    if (LargeMapManager)
+    {
+      LargeMapManager->SetConsiderOnlyAddedActors(true);
+    }
+    std::lock_guard<std::mutex> Lock(FrameToProcessMutex);
+    SensorsToConsider.clear();
+    HostedSensors.clear();
+    FrameApplyCache.Reset();
+    // 回报主服务器请求的地图已加载
+    if (MapLoadStartTime > 0.0 && Secondary)
+    {
+      carla::multigpu::MapStatus Status;
+      Status.stage = carla::multigpu::MAP_LOAD_DONE;
+      Status.elapsed = static_cast<float>((FPlatformTime::Seconds() - MapLoadStartTime) * 1000.0);
+      MapLoadStartTime = 0.0;
+      carla::Buffer buf(reinterpret_cast<unsigned char *>(&Status), sizeof(Status));
+      Secondary->Write(carla::multigpu::MultiGPUCommand::MAP_STATUS, std::move(buf));
+    }
+  }
+  else if (MapLoadStartTime > 0.0)
+  {
+    // 次级服务器与主服务器同时加载，主服务器加载完后等待最慢的次级服务器
+    const double PrimaryTime = (FPlatformTime::Seconds() - MapLoadStartTime) * 1000.0;
+    MapLoadStartTime = 0.0;
+    const bool bLoaded = SecondaryServer->WaitForMapLoaded(std::chrono::seconds(120));
+    UE_LOG(LogCarla, Log, TEXT("Map loaded in the primary server in %.0f ms"), PrimaryTime);
+    if (!bLoaded)
+    {
+      UE_LOG(LogCarla, Warning, TEXT("Some secondary servers have not loaded the map yet"));
+    }
   }
 
   CurrentEpisode->ApplySettings(CurrentSettings);
+  CurrentEpisode->SetActorPoolSize(ActorPoolSize);
 
   ResetFrameCounter(GFrameNumber);
 
@@ -294,6 +372,13 @@ void FCarlaEngine::OnPreTick(UWorld *, ELevelTick TickType, float DeltaSeconds)
   TRACE_CPUPROFILER_EVENT_SCOPE_STR(__FUNCTION__);
   if (TickType == ELevelTick::LEVELTICK_All)
   {
+    const double PreTickStart = FPlatformTime::Seconds();
+    if (FrameStartTime > 0.0)
+    {
+      Profile.frame_time.Add(static_cast<float>((PreTickStart - FrameStartTime) * 1000.0));
+    }
+    FrameStartTime = PreTickStart;
+    double SpawnBatchTime = 0.0;
 
     if (bIsPrimaryServer)
     {
@@ -306,23 +391,49 @@ void FCarlaEngine::OnPreTick(UWorld *, ELevelTick TickType, float DeltaSeconds)
         CurrentEpisode->ApplySettings(CurrentSettings);
       }
 
-      // 处理RPC命令
-      do
+      // 处理RPC命令，同步模式下等待客户端的节拍提示
+      const double SpinEnd = FPlatformTime::Seconds() + SynchronousSpinTime;
+      Server.RunSome(1u);
+      while (bSynchronousMode && !Server.TickCueReceived())
       {
-        Server.RunSome(1u);
+        WaitForServer(SpinEnd);
       }
-      while (bSynchronousMode && !Server.TickCueReceived());
+
+      // 按时间预算执行 spawn_batch 排队的命令
+      const double SpawnBatchStart = FPlatformTime::Seconds();
+      Server.ProcessSpawnBatches();
+      SpawnBatchTime = FPlatformTime::Seconds() - SpawnBatchStart;
+
+      Server.IntegrateKinematicVehicles(DeltaSeconds);
     }
     else
     {
-      // 处理帧数据
-      do
+      // 处理帧数据，收到 LOAD_MAP 时不再等待
+      const double SpinEnd = FPlatformTime::Seconds() + SynchronousSpinTime;
+      Server.RunSome(1u);
+      while (!FramesToProcess.size() && MapToLoad.IsEmpty())
+      {
+        WaitForServer(SpinEnd);
+      }
+
+      FString Map;
+      {
+        std::lock_guard<std::mutex> Lock(FrameToProcessMutex);
+        Map = MoveTemp(MapToLoad);
+        MapToLoad.Empty();
+      }
+      if (!Map.IsEmpty() && CurrentEpisode)
       {
-        Server.RunSome(1u);
+        UE_LOG(LogCarla, Log, TEXT("Loading map %s requested by the primary server"), *Map);
+        UGameplayStatics::OpenLevel(CurrentEpisode->GetWorld(), *Map, true);
       }
-      while (!FramesToProcess.size());
     }
 
+    // 等待节拍提示（次级服务器等待帧数据）期间执行的同步 RPC 不算作等待
+    const double RPCTime = carla::rpc::Server::TakeSyncCallTime() + SpawnBatchTime;
+    Profile.rpc.Add(static_cast<float>(RPCTime * 1000.0));
+    Profile.tick_wait.Add(static_cast<float>((FPlatformTime::Seconds() - PreTickStart - RPCTime) * 1000.0));
+
     // 更新帧计数器
     UpdateFrameCounter();
 
@@ -330,24 +441,127 @@ void FCarlaEngine::OnPreTick(UWorld *, ELevelTick TickType, float DeltaSeconds)
     {
       CurrentEpisode->TickTimers(DeltaSeconds);
 
+      if (bIsPrimaryServer)
+      {
+        CurrentEpisode->GetWalkerCrowd().Tick(*CurrentEpisode, DeltaSeconds);
+      }
+
       if (!bIsPrimaryServer)
       {
         if (FramesToProcess.size())
         {
           TRACE_CPUPROFILER_EVENT_SCOPE_STR("FramesToProcess.PlayFrameData");
           std::lock_guard<std::mutex> Lock(FrameToProcessMutex);
-          FramesToProcess.front().PlayFrameData(CurrentEpisode, MappedId);
+          const double ApplyStart = FPlatformTime::Seconds();
+          UpdateFrameApplyView();
+          FramesToProcess.front().PlayFrameData(CurrentEpisode, MappedId, FrameApplyCache);
+          FrameApplyTime = static_cast<float>((FPlatformTime::Seconds() - ApplyStart) * 1000.0);
+          FrameReceivedTime = FramesReceivedTime.front();
           FramesToProcess.erase(FramesToProcess.begin()); // 移除第一个元素
+          FramesReceivedTime.erase(FramesReceivedTime.begin());
+          // 帧数据中带有主服务器的帧号，这一帧结束时回报给主服务器
+          bFrameToAcknowledge = true;
         }
+        ConsiderHostedSensors();
       }
     }
+    WorldTickStartTime = FPlatformTime::Seconds();
   }
 }
 
 
+void FCarlaEngine::WaitForServer(double SpinEnd)
+{
+  // 先空转以降低延迟，之后阻塞等待，不再占满一个核心
+  if (FPlatformTime::Seconds() < SpinEnd)
+  {
+    Server.RunSome(1u);
+  }
+  else
+  {
+    Server.WaitSome(100u);
+  }
+}
+
+void FCarlaEngine::LoadMapInSecondaries(const FString &MapPath)
+{
+  if (!bIsPrimaryServer || !SecondaryServer->HasClientsConnected())
+  {
+    return;
+  }
+  MapLoadStartTime = FPlatformTime::Seconds();
+  SecondaryServer->GetCommander().SendLoadMap(std::string(TCHAR_TO_UTF8(*MapPath)));
+}
+
+void FCarlaEngine::ConsiderHostedSensors()
+{
+  // 加载图块可能需要一些时间，不持有锁
+  std::vector<carla::streaming::detail::stream_id_type> Sensors;
+  {
+    std::lock_guard<std::mutex> Lock(FrameToProcessMutex);
+    Sensors.swap(SensorsToConsider);
+  }
+  if (Sensors.empty())
+  {
+    return;
+  }
+  ALargeMapManager* LargeMapManager = UCarlaStatics::GetLargeMapManager(CurrentEpisode->GetWorld());
+  // 传感器的帧数据还没有到达时留到下一帧
+  auto Pending = std::remove_if(Sensors.begin(), Sensors.end(),
+      [&](carla::streaming::detail::stream_id_type StreamId)
+      {
+        FCarlaActor* CarlaActor = CurrentEpisode->FindCarlaActorFromStream(StreamId);
+        if (CarlaActor == nullptr)
+        {
+          return false;
+        }
+        HostedSensors.emplace_back(CarlaActor->GetActorId());
+        if (LargeMapManager == nullptr)
+        {
+          return true;
+        }
+        // 加载传感器所附着的根参与者（通常是英雄车）周围的图块
+        while (CarlaActor->GetParent() != 0u)
+        {
+          FCarlaActor* Parent = CurrentEpisode->FindCarlaActor(CarlaActor->GetParent());
+          if (Parent == nullptr)
+          {
+            break;
+          }
+          CarlaActor = Parent;
+        }
+        LargeMapManager->AddActorToConsider(CarlaActor->GetActor());
+        return true;
+      });
+  std::lock_guard<std::mutex> Lock(FrameToProcessMutex);
+  SensorsToConsider.insert(SensorsToConsider.end(), Sensors.begin(), Pending);
+}
+
+void FCarlaEngine::UpdateFrameApplyView()
+{
+  FrameApplyCache.ViewLocations.Reset();
+  for (uint32_t SensorId : HostedSensors)
+  {
+    FCarlaActor* CarlaActor = CurrentEpisode->FindCarlaActor(SensorId);
+    if (CarlaActor != nullptr && CarlaActor->GetActor() != nullptr)
+    {
+      FrameApplyCache.ViewLocations.Add(CarlaActor->GetActor()->GetActorLocation());
+    }
+  }
+  // 还没有负责的传感器时不知道要看哪里，应用所有参与者
+  FrameApplyCache.CullDistance = FrameApplyCache.ViewLocations.Num() > 0 ?
+      SecondaryCullDistance * 100.0f : 0.0f;
+}
+
 void FCarlaEngine::OnPostTick(UWorld *World, ELevelTick TickType, float DeltaSeconds)
 {
   TRACE_CPUPROFILER_EVENT_SCOPE_STR(__FUNCTION__);
+  if ((TickType == ELevelTick::LEVELTICK_All) && (WorldTickStartTime > 0.0))
+  {
+    // 物理模拟和参与者的 Tick 在 OnPreTick 和 OnPostTick 之间
+    Profile.world_tick.Add(static_cast<float>((FPlatformTime::Seconds() - WorldTickStartTime) * 1000.0));
+    WorldTickStartTime = 0.0;
+  }
   // 标记录制/回放系统
   if (GetCurrentEpisode())
   {
@@ -356,21 +570,44 @@ void FCarlaEngine::OnPostTick(UWorld *World, ELevelTick TickType, float DeltaSec
       if (SecondaryServer->HasClientsConnected()) {
         GetCurrentEpisode()->GetFrameData().GetFrameData(GetCurrentEpisode(), true, bNewConnection);
         bNewConnection = false;
-        std::ostringstream OutStream;
-        GetCurrentEpisode()->GetFrameData().Write(OutStream);
 
         // 将帧数据发送到次级服务器
-        std::string Tmp(OutStream.str());
-        SecondaryServer->GetCommander().SendFrameData(carla::Buffer(std::move((unsigned char *) Tmp.c_str()), (size_t) Tmp.size()));
+        const uint64_t Frame = GetFrameCounter();
+        SecondaryServer->GetCommander().SendFrameData(GetCurrentEpisode()->GetFrameData().Write(), Frame);
 
         GetCurrentEpisode()->GetFrameData().Clear();
+
+        // 最多领先次级服务器 SecondaryFrameLag 帧：次级服务器渲染这一帧时主服务器已经开始模拟下一帧
+        if (SecondaryFrameLag > 0u && Frame > SecondaryFrameLag)
+        {
+          TRACE_CPUPROFILER_EVENT_SCOPE_STR("WaitForSecondaryFrame");
+          if (!SecondaryServer->WaitForFrame(Frame - SecondaryFrameLag, std::chrono::seconds(10)))
+          {
+            UE_LOG(LogCarla, Warning, TEXT("Secondary servers are more than %d frames behind"), SecondaryFrameLag);
+          }
+        }
       }
     }
+    else if (bFrameToAcknowledge && Secondary)
+    {
+      bFrameToAcknowledge = false;
+      // 帧号和耗时，主服务器据此统计次级服务器的延迟
+      carla::multigpu::FrameDone Done;
+      Done.frame = GetFrameCounter();
+      Done.apply_time = FrameApplyTime;
+      Done.render_time = FPlatformTime::ToMilliseconds(FMath::Max(GRenderThreadTime, RHIGetGPUFrameCycles()));
+      Done.busy_time = static_cast<float>((FPlatformTime::Seconds() - FrameReceivedTime) * 1000.0);
+      Done.reserved = 0.0f;
+      carla::Buffer buf(reinterpret_cast<const unsigned char *>(&Done), sizeof(Done));
+      Secondary->Write(carla::multigpu::MultiGPUCommand::FRAME_DONE, std::move(buf));
+    }
 
     auto* EpisodeRecorder = GetCurrentEpisode()->GetRecorder();
     if (EpisodeRecorder)
     {
+      const double RecorderStart = FPlatformTime::Seconds();
       EpisodeRecorder->Ticking(DeltaSeconds);
+      Profile.recorder.Add(static_cast<float>((FPlatformTime::Seconds() - RecorderStart) * 1000.0));
     }
   }
 
@@ -391,12 +628,45 @@ void FCarlaEngine::OnPostTick(UWorld *World, ELevelTick TickType, float DeltaSec
     //worldsnapshot:
     //1·游戏开发：在游戏中，"world snapshot" 可以用来记录游戏的状态，保存玩家的位置、状态、物品等信息，以便后续恢复。
     //2·虚拟现实和增强现实：在这些环境中，世界快照可以帮助记录用户的位置和交互，便于分析和重现体验。
+    CurrentEpisode->GetSignTriggerVolumes().Tick(*CurrentEpisode);
+
+    const double BroadcastStart = FPlatformTime::Seconds();
     WorldObserver.BroadcastTick(*CurrentEpisode, DeltaSeconds, bMapChanged, LightUpdatePending);
+    const double SensorsStart = FPlatformTime::Seconds();
     CurrentEpisode->GetSensorManager().PostPhysTick(World, TickType, DeltaSeconds);
+    Profile.broadcast.Add(static_cast<float>((SensorsStart - BroadcastStart) * 1000.0));
+    Profile.sensors.Add(static_cast<float>((FPlatformTime::Seconds() - SensorsStart) * 1000.0));
+
+    // 传感器的采集已经在上面排队，据此决定这一帧结束时是否渲染视窗
+    const uint32 SceneCaptures = ASceneCaptureSensor::TakeSceneCaptureCount();
+    if (bRenderOnDemand && GEngine && GEngine->GameViewport)
+    {
+      GEngine->GameViewport->bDisableWorldRendering =
+          CurrentSettings.bNoRenderingMode || (SceneCaptures == 0u);
+    }
+
+    // 只读的 RPC 在工作线程上读取这一帧结束时的状态
+    Server.PublishReadOnlyState();
+
+    const uint32 BatchCommands = Server.TakeBatchCommandCount();
+    Profile.batch_commands += BatchCommands;
+    Profile.max_batch_commands_per_frame = FMath::Max(Profile.max_batch_commands_per_frame, BatchCommands);
+    ++Profile.frames;
+
     ResetSimulationState();
   }
 }
 
+carla::rpc::ServerProfile FCarlaEngine::GetServerProfile(bool Reset)
+{
+  carla::rpc::ServerProfile Result = Profile;
+  if (Reset)
+  {
+    Profile = carla::rpc::ServerProfile{};
+  }
+  return Result;
+}
+
 void FCarlaEngine::OnEpisodeSettingsChanged(const FEpisodeSettings &Settings)
 {
   CurrentSettings = FEpisodeSettings(Settings);
@@ -414,7 +684,8 @@ void FCarlaEngine::OnEpisodeSettingsChanged(const FEpisodeSettings &Settings)
   UPhysicsSettings* PhysSett = UPhysicsSettings::Get();
   PhysSett->bSubstepping = Settings.bSubstepping;
   PhysSett->MaxSubstepDeltaTime = Settings.MaxSubstepDeltaTime;
-  PhysSett->MaxSubsteps = Settings.MaxSubsteps;
+  PhysSett->MaxSubsteps = FMath::Clamp(Settings.MaxSubsteps, 1, 16);
+  PhysSett->MaxPhysicsDeltaTime = Settings.MaxPhysicsDeltaTime;
 
   UWorld* World = CurrentEpisode->GetWorld();
   ALargeMapManager* LargeMapManager = UCarlaStatics::GetLargeMapManager(World);
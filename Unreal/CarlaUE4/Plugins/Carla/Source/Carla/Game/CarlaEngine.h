@@ -21,6 +21,7 @@
 #include <carla/multigpu/secondary.h>
 #include <carla/multigpu/secondaryCommands.h>
 #include <carla/ros2/ROS2.h>
+#include <carla/rpc/ServerProfile.h>
 #include <compiler/enable-ue4-macros.h>// 重新启用Unreal Engine 4的宏
 
 #include <mutex>// 包含C++标准库的mutex类，用于线程同步
@@ -51,6 +52,11 @@ public:
   {
     return Server;
   }
+
+  FWorldObserver &GetWorldObserver()// 获取发送剧集状态的世界观察者
+  {
+    return WorldObserver;
+  }
   // [获取当前剧情]
  // 获取当前的UCarlaEpisode实例
 UCarlaEpisode *GetCurrentEpisode()
@@ -99,6 +105,12 @@ std::shared_ptr<carla::multigpu::Router> GetSecondaryServer() // 获取次级服
   return SecondaryServer; // 返回次级服务器的共享指针
 }
 
+// 主服务器：在自己加载地图之前让次级服务器开始加载，新地图开始时等待它们加载完
+void LoadMapInSecondaries(const FString &MapPath);
+
+// 游戏线程每帧各阶段的耗时统计，@a Reset 为真时返回后重新开始统计
+carla::rpc::ServerProfile GetServerProfile(bool Reset);
+
 private:
 
 // 在每个Tick之前调用的函数
@@ -107,6 +119,15 @@ void OnPreTick(UWorld *World, ELevelTick TickType, float DeltaSeconds);
 // 在每个Tick之后调用的函数
 void OnPostTick(UWorld *World, ELevelTick TickType, float DeltaSeconds);
 
+// 次级服务器：把新负责的传感器附着的参与者加入大地图要考虑的参与者
+void ConsiderHostedSensors();
+
+// 次级服务器：用负责的传感器的位置更新应用帧数据时的剔除范围
+void UpdateFrameApplyView();
+
+// 处理RPC命令：SpinEnd 之前空转，之后阻塞等待请求
+void WaitForServer(double SpinEnd);
+
 // 当Episode设置发生变化时调用的函数
 void OnEpisodeSettingsChanged(const FEpisodeSettings &Settings);
 
@@ -137,14 +158,45 @@ FDelegateHandle OnEpisodeSettingsChangeHandle; // Episode设置更改事件的
 
 bool bIsPrimaryServer = true; // 标识是否为主服务器
 
+double SynchronousSpinTime = 0.0; // 等待节拍提示或帧数据时阻塞之前空转的时间，单位为秒
+
+bool bRenderOnDemand = false; // 只在有相机采集图像的帧上渲染世界的视窗
+
+uint32 ActorPoolSize = 0u; // 每个剧集开始时参与者池的大小
+
 bool bNewConnection = false; // 标识是否有新的连接
 
+uint32 SecondaryFrameLag = 0u; // 主服务器最多领先次级服务器的帧数，为0时不等待
+
+bool bFrameToAcknowledge = false; // 次级服务器：这一帧播放了主服务器的帧数据，需要回报
+
+double FrameReceivedTime = 0.0; // 次级服务器：要回报的帧数据的接收时间，单位为秒
+
+float FrameApplyTime = 0.0f; // 次级服务器：应用要回报的帧数据的时间，单位为毫秒
+
+float SecondaryCullDistance = 0.0f; // 次级服务器：只移动离负责的传感器这么近的参与者，单位为米，为0时移动全部
+
+FFrameApplyCache FrameApplyCache; // 次级服务器：应用帧数据时缓存的参与者和已应用的位置
+
+carla::rpc::ServerProfile Profile; // 每帧各阶段的耗时统计，总是开启
+
+double FrameStartTime = 0.0; // 这一帧 OnPreTick 开始的时间，单位为秒
+
+double WorldTickStartTime = 0.0; // 这一帧 OnPreTick 结束、引擎开始更新场景的时间，单位为秒
+
 std::unordered_map<uint32_t, uint32_t> MappedId; // 用于映射ID的哈希表
 
 std::shared_ptr<carla::multigpu::Router> SecondaryServer; // 次级服务器的共享指针
 std::shared_ptr<carla::multigpu::Secondary> Secondary; // 次级实例的共享指针
 
 std::vector<FFrameData> FramesToProcess; // 待处理帧数据的向量
+std::vector<double> FramesReceivedTime; // 每个待处理帧数据的接收时间
+FString MapToLoad; // 次级服务器：LOAD_MAP 请求的、还没有在游戏线程中打开的地图
+
+double MapLoadStartTime = 0.0; // 开始加载地图的时间，单位为秒，没有在加载时为0
+
+std::vector<carla::streaming::detail::stream_id_type> SensorsToConsider; // 次级服务器：新负责的、还没有加入大地图的传感器
+std::vector<uint32_t> HostedSensors; // 次级服务器：负责的传感器的参与者 id，只在游戏线程中使用
 std::mutex FrameToProcessMutex; // 帧数据处理的互斥锁
 };
 
@@ -116,24 +116,21 @@ bool UCarlaEpisode::LoadNewEpisode(const FString &MapString, bool ResetSettings)
   if (bIsFileFound)
   {
     UE_LOG(LogCarla, Warning, TEXT("Loading a new episode: %s"), *FinalPath);
-    UGameplayStatics::OpenLevel(GetWorld(), *FinalPath, true);
-    if (ResetSettings)
-      ApplySettings(FEpisodeSettings{});
 
-    // 向所有辅助服务器发送 'LOAD_MAP' 命令（如果有）
+    // 先向所有辅助服务器发送 'LOAD_MAP' 命令（如果有），与本服务器同时加载，
+    // 新地图开始时再等待最慢的辅助服务器
     if (bIsPrimaryServer)
     {
       UCarlaGameInstance *GameInstance = UCarlaStatics::GetGameInstance(GetWorld());
       if(GameInstance)
       {
-        FCarlaEngine *CarlaEngine = GameInstance->GetCarlaEngine();
-        auto SecondaryServer = CarlaEngine->GetSecondaryServer();
-        if (SecondaryServer->HasClientsConnected())
-        {
-          SecondaryServer->GetCommander().SendLoadMap(std::string(TCHAR_TO_UTF8(*FinalPath)));
-        }
+        GameInstance->GetCarlaEngine()->LoadMapInSecondaries(FinalPath);
       }
     }
+
+    UGameplayStatics::OpenLevel(GetWorld(), *FinalPath, true);
+    if (ResetSettings)
+      ApplySettings(FEpisodeSettings{});
   }
   return bIsFileFound;
 }
@@ -446,6 +443,49 @@ std::string UCarlaEpisode::StartRecorder(std::string Name, bool AdditionalData)
   return result;
 }
 
+std::string UCarlaEpisode::StartRecorder(
+    std::string Name,
+    bool AdditionalData,
+    const carla::rpc::RecorderFilter &Filter)
+{
+  if (!Recorder)
+  {
+    return "Recorder is not ready";
+  }
+  return Recorder->Start(Name, MapName, AdditionalData, &Filter);
+}
+
+bool UCarlaEpisode::StartRecorderStream(
+    carla::streaming::Stream Stream,
+    bool AdditionalData,
+    const carla::rpc::RecorderFilter &Filter)
+{
+  return Recorder != nullptr &&
+      Recorder->StartStream(std::move(Stream), MapName, AdditionalData, &Filter);
+}
+
+uint64 UCarlaEpisode::SaveSnapshot()
+{
+  TRACE_CPUPROFILER_EVENT_SCOPE_STR(__FUNCTION__);
+  auto Snapshot = std::make_unique<FFrameData>();
+  // 与新连接的次级服务器一样，包含所有参与者和运动学数据
+  Snapshot->GetFrameData(this, true, true);
+  const uint64 SnapshotId = NextSnapshotId++;
+  Snapshots.emplace(SnapshotId, std::move(Snapshot));
+  return SnapshotId;
+}
+
+bool UCarlaEpisode::RestoreSnapshot(uint64 SnapshotId)
+{
+  auto It = Snapshots.find(SnapshotId);
+  if (It == Snapshots.end())
+  {
+    return false;
+  }
+  It->second->RestoreFrameData(this);
+  return true;
+}
+
 TPair<EActorSpawnResultStatus, FCarlaActor*> UCarlaEpisode::SpawnActorWithInfo(
     const FTransform &Transform,
     FActorDescription thisActorDescription,
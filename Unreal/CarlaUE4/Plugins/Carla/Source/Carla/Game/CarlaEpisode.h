@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include "Carla/AI/WalkerCrowd.h"
 #include "Carla/Actor/ActorDispatcher.h"
 #include "Carla/Recorder/CarlaRecorder.h"
 #include "Carla/Sensor/WorldObserver.h"
@@ -15,6 +16,7 @@
 #include "Carla/Weather/Weather.h"
 #include "Carla/Game/FrameData.h"
 #include "Carla/Sensor/SensorManager.h"
+#include "Carla/Traffic/SignTriggerVolumes.h"
 
 #include "GameFramework/Pawn.h"
 #include "Materials/MaterialParameterCollectionInstance.h"
@@ -195,6 +197,16 @@ public:
     return ActorDispatcher->GetActorRegistry().GetDescriptionFromStream(StreamId);
   }
 
+  const FActorInfo *FindActorInfoFromStream(carla::streaming::detail::stream_id_type StreamId)
+  {
+    return ActorDispatcher->GetActorRegistry().FindActorInfoFromStream(StreamId);
+  }
+
+  FCarlaActor *FindCarlaActorFromStream(carla::streaming::detail::stream_id_type StreamId)
+  {
+    return ActorDispatcher->GetActorRegistry().FindCarlaActorFromStream(StreamId);
+  }
+
   // ===========================================================================
   // -- Actor处理方法相关部分 -------------------------------------------------
   // ===========================================================================
@@ -283,6 +295,24 @@ public:
 
     return ActorDispatcher->DestroyActor(ActorId);
   }
+  /// 保存当前剧集的动态状态（参与者及其位置、速度，交通灯和车灯的状态），
+  /// 返回用于 RestoreSnapshot 的编号。快照只在本剧集内有效
+  uint64 SaveSnapshot();
+
+  /// 在当前帧内把剧集恢复到快照时的状态，不重新加载地图。快照不存在时返回 false
+  bool RestoreSnapshot(uint64 SnapshotId);
+
+  /// 释放快照，快照不存在时返回 false
+  bool RemoveSnapshot(uint64 SnapshotId)
+  {
+    return Snapshots.erase(SnapshotId) > 0u;
+  }
+
+  /// 设置参与者池的大小，见 UActorDispatcher::SetActorPoolSize
+  void SetActorPoolSize(uint32 Size)
+  {
+    ActorDispatcher->SetActorPoolSize(static_cast<int32>(FMath::Min<uint32>(Size, MAX_int32)));
+  }
 // 函数用于将指定的Actor设置为睡眠状态
   void PutActorToSleep(carla::rpc::ActorId ActorId)
   {
@@ -325,6 +355,16 @@ public:
   }
 // 启动录制器
   std::string StartRecorder(std::string name, bool AdditionalData);
+// 启动录制器，只录制过滤器选中的参与者和数据包
+  std::string StartRecorder(
+      std::string name,
+      bool AdditionalData,
+      const carla::rpc::RecorderFilter &Filter);
+// 启动录制器，数据写入流媒体服务器的流而不是文件
+  bool StartRecorderStream(
+      carla::streaming::Stream Stream,
+      bool AdditionalData,
+      const carla::rpc::RecorderFilter &Filter);
 //获取当前地图的原点信息
   FIntVector GetCurrentMapOrigin() const { return CurrentMapOrigin; }
 //设置当前地图的原点信息
@@ -333,6 +373,10 @@ public:
   FFrameData& GetFrameData() { return FrameData; }
 //获取当前的传感器管理器
   FSensorManager& GetSensorManager() { return SensorManager; }
+//获取在服务器上模拟的行人人群
+  FWalkerCrowd& GetWalkerCrowd() { return WalkerCrowd; }
+//获取交通标志的触发框
+  FSignTriggerVolumes& GetSignTriggerVolumes() { return SignTriggerVolumes; }
 //表示当前对象是否是主服务器
   bool bIsPrimaryServer = true;
 
@@ -422,8 +466,19 @@ FIntVector CurrentMapOrigin;
 // 存储帧数据的结构
 FFrameData FrameData;
 
+// SaveSnapshot 保存的快照
+std::unordered_map<uint64, std::unique_ptr<FFrameData>> Snapshots;
+
+uint64 NextSnapshotId = 1u;
+
 // 传感器管理器，用于管理仿真中的传感器
 FSensorManager SensorManager;
 
+// 在服务器上模拟的行人人群
+FWalkerCrowd WalkerCrowd;
+
+// 交通标志的触发框，每帧检测车辆的进入和离开
+FSignTriggerVolumes SignTriggerVolumes;
+
 // 将语义标签转换为字符串的函数，用于获取相关的标签描述
 FString CarlaGetRelevantTagAsString(const TSet<crp::CityObjectLabel> &SemanticTags);
@@ -6,6 +6,8 @@
 #include "Carla.h"
 #include "Carla/Game/CarlaGameInstance.h"
 
+#include "Carla/Game/CarlaEpisode.h"
+#include "Carla/Sensor/ShaderBasedSensor.h"
 #include "Carla/Settings/CarlaSettings.h"
 
 // 定义UCarlaGameInstance类的构造函数
@@ -13,10 +15,30 @@ UCarlaGameInstance::UCarlaGameInstance() {
   CarlaSettings = CreateDefaultSubobject<UCarlaSettings>(TEXT("CarlaSettings"));// 创建一个UCarlaSettings的默认子对象，设置其名称为"CarlaSettings"
   Recorder = CreateDefaultSubobject<ACarlaRecorder>(TEXT("Recorder"));// 创建一个ACarlaRecorder的默认子对象，设置其名称为"Recorder"
   CarlaEngine.SetRecorder(Recorder);// 将Recorder对象设置为CarlaEngine的记录器
+  MapPreloader = CreateDefaultSubobject<UCarlaMapPreloader>(TEXT("MapPreloader"));
 
   check(CarlaSettings != nullptr);// 检查CarlaSettings是否成功创建，确保其指针不为空
   CarlaSettings->LoadSettings();// 加载设置，通常这会从配置文件或其他来源读取配置信息
   CarlaSettings->LogSettings();// 打印加载的设置，用于调试和验证设置是否正确
+  MapPreloader->SetCacheSize(static_cast<int32>(FMath::Min<uint32>(CarlaSettings->MapCacheSize, MAX_int32)));
+}
+
+void UCarlaGameInstance::NotifyBeginEpisode(UCarlaEpisode &Episode)
+{
+  CarlaEngine.NotifyBeginEpisode(Episode);
+  if (!bSensorShadersPrewarmed && !CarlaSettings->PrewarmSensorShaders.IsEmpty())
+  {
+    bSensorShadersPrewarmed = true;
+    TArray<FString> SensorIds;
+    CarlaSettings->PrewarmSensorShaders.ParseIntoArray(SensorIds, TEXT(","), true);
+    for (FString &Id : SensorIds)
+    {
+      Id.TrimStartAndEndInline();
+    }
+    AShaderBasedSensor::PrewarmShaders(Episode, SensorIds);
+  }
+  // 启用了地图缓存时保留当前地图的资源，之后切换回这张地图时不需要重新加载
+  MapPreloader->NotifyMapOpened(Episode.GetWorld()->GetOutermost()->GetName());
 }
 
 UCarlaGameInstance::~UCarlaGameInstance() = default;// 定义析构函数，C++中的析构函数通常用于清理资源
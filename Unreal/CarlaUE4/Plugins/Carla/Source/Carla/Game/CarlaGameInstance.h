@@ -9,6 +9,7 @@
 #include "Engine/GameInstance.h"
 
 #include "Carla/Game/CarlaEngine.h"
+#include "Carla/Game/MapPreloader.h"
 #include "Carla/Recorder/CarlaRecorder.h"
 #include "Carla/Server/CarlaServer.h"
 
@@ -72,10 +73,7 @@ public:
   }
 
   // 通知开始新的游戏章节，调用 CarlaEngine 的 NotifyBeginEpisode 函数
-  void NotifyBeginEpisode(UCarlaEpisode &Episode)
-  {
-    CarlaEngine.NotifyBeginEpisode(Episode);
-  }
+  void NotifyBeginEpisode(UCarlaEpisode &Episode);
 
   // 通知结束游戏章节，调用 CarlaEngine 的 NotifyEndEpisode 函数
   void NotifyEndEpisode()
@@ -129,6 +127,13 @@ public:
     return &CarlaEngine;
   }
 
+  // 获取在后台预加载地图的对象，它在切换地图时保持存在
+  UCarlaMapPreloader &GetMapPreloader()
+  {
+    check(MapPreloader != nullptr);
+    return *MapPreloader;
+  }
+
 private:
 
   // 一个可编辑的属性，存储 CarlaSettings 的指针，默认为 nullptr
@@ -142,6 +147,13 @@ private:
   UPROPERTY()
   ACarlaRecorder *Recorder = nullptr;
 
+  // 预加载地图并缓存最近使用的地图的资源
+  UPROPERTY()
+  UCarlaMapPreloader *MapPreloader = nullptr;
+
+  // 着色器的编译结果在整个进程中有效，只在第一个剧集开始时预热传感器
+  bool bSensorShadersPrewarmed = false;
+
   // 存储 OpendriveGenerationParameters 的对象
   carla::rpc::OpendriveGenerationParameters GenerationParameters;
 
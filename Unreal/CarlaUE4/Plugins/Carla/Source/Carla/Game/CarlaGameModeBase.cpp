@@ -22,6 +22,7 @@
 #include <compiler/disable-ue4-macros.h>
 #include "carla/opendrive/OpenDriveParser.h"
 #include "carla/road/element/RoadInfoSignal.h"
+#include <carla/rpc/CachedContent.h>
 #include <carla/rpc/EnvironmentObject.h>
 #include <carla/rpc/WeatherParameters.h>
 #include <carla/rpc/MapLayer.h>
@@ -29,6 +30,10 @@
 
 #include "Async/ParallelFor.h"
 #include "DynamicRHI.h"
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
 
 #include "DrawDebugHelpers.h"
 #include "Kismet/KismetSystemLibrary.h"
@@ -436,8 +441,35 @@ void ACarlaGameModeBase::StoreSpawnPoints()
   UE_LOG(LogCarla, Log, TEXT("There are %d SpawnPoints in the map"), SpawnPointsTransforms.Num());
 }
 
+/// 由 OpenDRIVE 生成的出生点在磁盘上的缓存，生成方式改变时增加版本号
+static FString GetSpawnPointsCachePath(const FString &MapName, const FString &OpenDriveHash)
+{
+  constexpr int32 Version = 1;
+  return FPaths::Combine(
+      FPaths::ProjectSavedDir(),
+      TEXT("Carla"),
+      TEXT("StartupCache"),
+      FString::Printf(TEXT("%s-%s-v%d.spawnpoints"), *FPaths::GetCleanFilename(MapName), *OpenDriveHash, Version));
+}
+
 void ACarlaGameModeBase::GenerateSpawnPoints()
 {
+  // 同一份 OpenDRIVE 生成的出生点相同，重启时直接读取上次生成的结果
+  const FString CachePath = GetSpawnPointsCachePath(Episode->GetMapName(), OpenDriveHash);
+  TArray<uint8> CachedData;
+  if (!OpenDriveHash.IsEmpty() && FFileHelper::LoadFileToArray(CachedData, *CachePath, FILEREAD_Silent))
+  {
+    FMemoryReader Reader(CachedData);
+    TArray<FTransform> CachedSpawnPoints;
+    Reader << CachedSpawnPoints;
+    if (!Reader.IsError())
+    {
+      UE_LOG(LogCarla, Log, TEXT("Loaded SpawnPoints from '%s'"), *CachePath);
+      SpawnPointsTransforms.Append(CachedSpawnPoints);
+      return;
+    }
+  }
+
   // 记录日志，表明正在生成出生点
   UE_LOG(LogCarla, Log, TEXT("Generating SpawnPoints ..."));
    // 从地图对象中获取拓扑结构，拓扑结构由一系列的路径点对（Waypoint pairs）组成
@@ -454,11 +486,27 @@ void ACarlaGameModeBase::GenerateSpawnPoints()
     Transform.AddToTranslation(FVector(0.f, 0.f, 50.0f));
     SpawnPointsTransforms.Add(Transform);
   }
+
+  if (!OpenDriveHash.IsEmpty())
+  {
+    // 先写入临时文件再改名，同时启动的多个服务器不会读到写了一半的文件
+    TArray<uint8> Data;
+    FMemoryWriter Writer(Data);
+    Writer << SpawnPointsTransforms;
+    const FString TempPath = CachePath + FString::Printf(TEXT(".%u.tmp"), FPlatformProcess::GetCurrentProcessId());
+    if (!FFileHelper::SaveArrayToFile(Data, *TempPath) || !IFileManager::Get().Move(*CachePath, *TempPath))
+    {
+      UE_LOG(LogCarla, Warning, TEXT("Unable to cache SpawnPoints in '%s'"), *CachePath);
+      IFileManager::Get().Delete(*TempPath, false, false, true);
+    }
+  }
 }
 
 void ACarlaGameModeBase::ParseOpenDrive()
 {
   std::string opendrive_xml = carla::rpc::FromLongFString(UOpenDrive::GetXODR(GetWorld()));
+  OpenDriveHash = opendrive_xml.empty() ? FString{} : carla::rpc::ToFString(
+      crp::CachedContent::ComputeHash(reinterpret_cast<const uint8_t *>(opendrive_xml.data()), opendrive_xml.size()));
 // 使用carla::opendrive::OpenDriveParser的Load方法来解析OpenDrive XML字符串
 // 并尝试创建一个地图对象
  // 如果解析失败，则std::optional将不包含值
@@ -640,18 +688,123 @@ void ACarlaGameModeBase::DebugShowSignals(bool enable)
 
 TArray<FBoundingBox> ACarlaGameModeBase::GetAllBBsOfLevel(uint8 TagQueried) const
 {
+  TRACE_CPUPROFILER_EVENT_SCOPE(ACarlaGameModeBase::GetAllBBsOfLevel);
   UWorld* World = GetWorld();
+  if (bBBCacheDirty)
+  {
+    RebuildBBCache();
+  }
 
-  // 获取该级别的所有 Actor
-  TArray<AActor*> FoundActors;
-  UGameplayStatics::GetAllActorsOfClass(World, AActor::StaticClass(), FoundActors);
+  const bool FilterByTagEnabled =
+      (TagQueried != static_cast<uint8>(carla::rpc::CityObjectLabel::Any));
 
   TArray<FBoundingBox> BoundingBoxes;
-  BoundingBoxes = UBoundingBoxCalculator::GetBoundingBoxOfActors(FoundActors, TagQueried);
+  for (const auto& LevelEntry : LevelBBCache)
+  {
+    if (!LevelEntry.Key.IsValid())
+    {
+      continue;
+    }
+    // 缓存之后大地图可能重设了世界原点
+    const FVector Offset = FVector(LevelEntry.Value.Origin - World->OriginLocation);
+    auto AppendBBs = [&](const TArray<FBoundingBox>& BBs)
+    {
+      const int32 First = BoundingBoxes.Num();
+      BoundingBoxes.Append(BBs);
+      if (!Offset.IsZero())
+      {
+        for (int32 i = First; i < BoundingBoxes.Num(); i++)
+        {
+          BoundingBoxes[i].Origin += Offset;
+        }
+      }
+    };
+    if (FilterByTagEnabled)
+    {
+      const TArray<FBoundingBox>* BBs = LevelEntry.Value.BBsByTag.Find(TagQueried);
+      if (BBs)
+      {
+        AppendBBs(*BBs);
+      }
+    }
+    else
+    {
+      for (const auto& TagEntry : LevelEntry.Value.BBsByTag)
+      {
+        AppendBBs(TagEntry.Value);
+      }
+    }
+  }
+
+  // 车辆、行人和通过 API 生成的 actor 会移动或被销毁，不缓存
+  if (Episode == nullptr)
+  {
+    return BoundingBoxes;
+  }
+  for (const auto& CarlaActorPair : Episode->GetActorRegistry())
+  {
+    const AActor* Actor = CarlaActorPair.Value->GetActor();
+    if (Actor)
+    {
+      BoundingBoxes.Append(UBoundingBoxCalculator::GetBBsOfActor(Actor, TagQueried));
+    }
+  }
 
   return BoundingBoxes;
 }
 
+void ACarlaGameModeBase::AddLevelToBBCache(ULevel* Level)
+{
+  if (Level && !bBBCacheDirty)
+  {
+    CacheBBsOfLevel(Level);
+  }
+}
+
+void ACarlaGameModeBase::RemoveLevelFromBBCache(ULevel* Level)
+{
+  LevelBBCache.Remove(Level);
+}
+
+void ACarlaGameModeBase::RebuildBBCache() const
+{
+  TRACE_CPUPROFILER_EVENT_SCOPE(ACarlaGameModeBase::RebuildBBCache);
+  LevelBBCache.Reset();
+  for (ULevel* Level : GetWorld()->GetLevels())
+  {
+    if (Level && Level->bIsVisible)
+    {
+      CacheBBsOfLevel(Level);
+    }
+  }
+  bBBCacheDirty = false;
+}
+
+void ACarlaGameModeBase::CacheBBsOfLevel(ULevel* Level) const
+{
+  TRACE_CPUPROFILER_EVENT_SCOPE(ACarlaGameModeBase::CacheBBsOfLevel);
+  FLevelBBCache& Cache = LevelBBCache.Add(Level);
+  Cache.Origin = GetWorld()->OriginLocation;
+
+  TArray<FBoundingBox> BBs;
+  TArray<uint8> Tags;
+  for (AActor* Actor : Level->Actors)
+  {
+    if (!Actor || Actor->IsPendingKill() || (Episode && Episode->FindCarlaActor(Actor)))
+    {
+      continue;
+    }
+    BBs.Reset();
+    Tags.Reset();
+    UBoundingBoxCalculator::GetBBsAndTagsOfActor(Actor, BBs, Tags);
+    check(BBs.Num() == Tags.Num());
+    for (int32 i = 0; i < BBs.Num(); i++)
+    {
+      Cache.BBsByTag.FindOrAdd(Tags[i]).Emplace(BBs[i]);
+    }
+  }
+}
+
 void ACarlaGameModeBase::RegisterEnvironmentObjects()
 {
   //获取该级别的所有 Actor
@@ -665,6 +818,8 @@ void ACarlaGameModeBase::EnableEnvironmentObjects(
   bool Enable)
 {
   ObjectRegister->EnableEnvironmentObjects(EnvObjectIds, Enable);
+  // 隐藏的组件没有边界框
+  bBBCacheDirty = true;
 }
 
 void ACarlaGameModeBase::LoadMapLayer(int32 MapLayers)
@@ -791,6 +946,7 @@ void ACarlaGameModeBase::OnLoadStreamLevel()
   {
     RegisterEnvironmentObjects();
     ATagger::TagActorsInLevel(*GetWorld(), true);
+    bBBCacheDirty = true;
   }
 }
 
@@ -801,6 +957,7 @@ void ACarlaGameModeBase::OnUnloadStreamLevel()
   if(ReadyToRegisterObjects && PendingLevelsToUnLoad == 0)
   {
     RegisterEnvironmentObjects();
+    bBBCacheDirty = true;
   }
 }
 
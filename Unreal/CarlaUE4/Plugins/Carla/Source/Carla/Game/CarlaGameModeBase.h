@@ -46,6 +46,12 @@ public:
     return *Episode;
   }
 
+  UCarlaEpisode &GetCarlaEpisode()
+  {
+    check(Episode != nullptr);
+    return *Episode;
+  }
+
   const boost::optional<carla::road::Map>& GetMap() const {
     return Map;
   }
@@ -66,9 +72,17 @@ public:
     return SpawnPointsTransforms;
   }
 
+  /// 关卡中静态物体的边界框在第一次查询时计算并缓存，按标签索引；
+  /// 在剧集中注册的 actor 每次查询时重新计算
   UFUNCTION(Category = "Carla Game Mode", BlueprintCallable, CallInEditor, Exec)
   TArray<FBoundingBox> GetAllBBsOfLevel(uint8 TagQueried = 0xFF) const;
 
+  /// 流式加载的关卡添加到世界后，把其中的边界框加入缓存
+  void AddLevelToBBCache(ULevel* Level);
+
+  /// 流式卸载的关卡从世界移除后，丢弃其边界框
+  void RemoveLevelFromBBCache(ULevel* Level);
+
   UFUNCTION(Category = "Carla Game Mode", BlueprintCallable, CallInEditor, Exec)
   TArray<FEnvironmentObject> GetEnvironmentObjects(uint8 QueriedTag = 0xFF) const
   {
@@ -142,6 +156,10 @@ private:
 
   void ConvertMapLayerMaskToMapNames(int32 MapLayer, TArray<FName>& OutLevelNames);
 
+  void RebuildBBCache() const;
+
+  void CacheBBsOfLevel(ULevel* Level) const;
+
   void OnEpisodeSettingsChanged(const FEpisodeSettings &Settings);
 
   UPROPERTY()
@@ -187,11 +205,27 @@ private:
 
   boost::optional<carla::road::Map> Map;
 
+  /// 解析的 OpenDRIVE 内容的哈希，用作磁盘上由地图生成的数据的缓存键
+  FString OpenDriveHash;
+
   int PendingLevelsToLoad = 0;
   int PendingLevelsToUnLoad = 0;
 
   bool ReadyToRegisterObjects = false;
 
+  /// 一个关卡中静态物体的边界框
+  struct FLevelBBCache
+  {
+    /// 计算边界框时的世界原点，大地图重设原点后用于平移边界框
+    FIntVector Origin;
+    TMap<uint8, TArray<FBoundingBox>> BBsByTag;
+  };
+
+  mutable TMap<TWeakObjectPtr<ULevel>, FLevelBBCache> LevelBBCache;
+
+  /// 加载或卸载地图层、启用或禁用环境物体后整个缓存需要重新计算
+  mutable bool bBBCacheDirty = true;
+
   // 我们保留一个全局 uuid 以允许调用 load/unload 层方法
   ///在同一个即时报价中
   int32 LatentInfoUUID = 0;
@@ -19,6 +19,10 @@
 #include "carla/rpc/VehicleLightState.h" // 包含Carla RPC车辆灯光状态的头文件，定义车辆灯光状态的RPC结构
 #include <compiler/enable-ue4-macros.h> // 启用Unreal Engine的宏
 
+#include <algorithm>
+#include <cstring>
+#include <unordered_set>
+
 // FFrameData::GetFrameData函数，用于收集当前帧的数据
 void FFrameData::GetFrameData(UCarlaEpisode *ThisEpisode, bool bAdditionalData, bool bIncludeActorsAgain)
 {
@@ -29,12 +33,13 @@ void FFrameData::GetFrameData(UCarlaEpisode *ThisEpisode, bool bAdditionalData,
   if (bIncludeActorsAgain) // 如果需要再次包括Actor
   {
     AddExistingActors(); // 添加已存在的Actor到帧数据中
+    PositionDelta->Reset(); // 新连接的副服务器没有基准，发送所有位置
   }
 
   // 遍历Actor注册表中的所有Actor
   for (auto It = Registry.begin(); It != Registry.end(); ++It)
   {
-    FCarlaActor* View = It.Value().Get(); // 获取Actor的指针
+    FCarlaActor* View = It->Value.Get(); // 获取Actor的指针
 
     // 根据Actor的类型进行不同的数据处理
     switch (View->GetActorType())
@@ -81,11 +86,23 @@ void FFrameData::PlayFrameData(
     UCarlaEpisode *ThisEpisode,
     std::unordered_map<uint32_t, uint32_t>& MappedId)
 {
-  // 此函数的具体实现未提供，可能包含将帧数据应用到游戏环节的逻辑
-  // ThisEpisode参数可能用于访问游戏环节的状态和功能
-  // MappedId参数可能用于处理Actor ID的映射，以确保数据的正确应用
+  FFrameApplyCache Cache;
+  PlayFrameData(ThisEpisode, MappedId, Cache);
 }
 
+// 把帧数据应用到游戏环节，MappedId 把主服务器的参与者 id 映射为本服务器的 id
+void FFrameData::PlayFrameData(
+    UCarlaEpisode *ThisEpisode,
+    std::unordered_map<uint32_t, uint32_t>& MappedId,
+    FFrameApplyCache &Cache)
+{
+  Episode = ThisEpisode;
+
+  // 创建或销毁参与者后映射的 id 可能变化
+  if (!EventsAdd.GetEvents().empty() || !EventsDel.GetEvents().empty())
+  {
+    Cache.Reset();
+  }
 
   for(const CarlaRecorderEventAdd &EventAdd : EventsAdd.GetEvents())
   {
@@ -128,16 +145,7 @@ void FFrameData::PlayFrameData(
     MappedId.erase(EventDel.DatabaseId);
   }
 
-  for (const CarlaRecorderPosition &Position : Positions.GetPositions())
-  {
-    CarlaRecorderPosition Pos = Position;
-    auto NewId = MappedId.find(Pos.DatabaseId);
-    if (NewId != MappedId.end())
-    {
-      Pos.DatabaseId = NewId->second;
-      ProcessReplayerPosition(Pos, Pos, 0.0, 0.0);
-    }
-  }
+  ApplyPositions(MappedId, Cache);
 
   for (const CarlaRecorderStateTrafficLight &State : States.GetStates())
   {
@@ -189,6 +197,113 @@ void FFrameData::PlayFrameData(
   SetFrameCounter();
 }
 
+void FFrameData::RestoreFrameData(UCarlaEpisode *ThisEpisode)
+{
+  TRACE_CPUPROFILER_EVENT_SCOPE_STR(__FUNCTION__);
+  Episode = ThisEpisode;
+
+  // 销毁保存之后生成的参与者，为重新生成的参与者腾出位置
+  std::unordered_set<uint32_t> SavedIds;
+  for (const CarlaRecorderEventAdd &EventAdd : EventsAdd.GetEvents())
+  {
+    SavedIds.insert(EventAdd.DatabaseId);
+  }
+  std::vector<uint32_t> ToDestroy;
+  for (const auto &Entry : Episode->GetActorRegistry())
+  {
+    if (SavedIds.count(Entry.Key) == 0u)
+    {
+      ToDestroy.push_back(Entry.Key);
+    }
+  }
+  for (uint32_t Id : ToDestroy)
+  {
+    Episode->DestroyActor(Id);
+  }
+
+  // 仍然存在的参与者原地重用，被销毁的以原来的 id 重新生成
+  std::unordered_map<uint32_t, uint32_t> MappedId;
+  for (const CarlaRecorderEventAdd &EventAdd : EventsAdd.GetEvents())
+  {
+    auto Result = ProcessReplayerEventAdd(
+        EventAdd.Location,
+        EventAdd.Rotation,
+        EventAdd.Description,
+        EventAdd.DatabaseId,
+        false,
+        false,
+        MappedId);
+    if (Result.first != 0)
+    {
+      MappedId[EventAdd.DatabaseId] = Result.second;
+    }
+  }
+  auto FindActor = [&](uint32_t Id) -> FCarlaActor* {
+    auto It = MappedId.find(Id);
+    return It != MappedId.end() ? Episode->FindCarlaActor(It->second) : nullptr;
+  };
+
+  for (const CarlaRecorderPosition &Position : Positions.GetPositions())
+  {
+    FCarlaActor *CarlaActor = FindActor(Position.DatabaseId);
+    if (CarlaActor != nullptr && CarlaActor->GetActorType() != FCarlaActor::ActorType::Sensor)
+    {
+      const FTransform Transform(FRotator::MakeFromEuler(Position.Rotation), Position.Location);
+      CarlaActor->SetActorGlobalTransform(Transform, ETeleportType::ResetPhysics);
+    }
+  }
+
+  // ProcessReplayerEventAdd 为回放关闭了车辆的物理模拟，恢复时重新打开并清除控制
+  for (const auto &Item : MappedId)
+  {
+    FCarlaActor *CarlaActor = Episode->FindCarlaActor(Item.second);
+    if (CarlaActor != nullptr && CarlaActor->GetActorType() == FCarlaActor::ActorType::Vehicle)
+    {
+      SetActorSimulatePhysics(CarlaActor, true);
+      CarlaActor->ApplyControlToVehicle(FVehicleControl{}, EVehicleInputPriority::User);
+    }
+  }
+
+  for (const CarlaRecorderKinematics &Kinematics : Kinematics.GetKinematics())
+  {
+    FCarlaActor *CarlaActor = FindActor(Kinematics.DatabaseId);
+    if (CarlaActor == nullptr)
+    {
+      continue;
+    }
+    // 保存的线速度单位为米每秒
+    if (CarlaActor->GetActorType() == FCarlaActor::ActorType::Walker)
+    {
+      FWalkerControl Control;
+      Control.Speed = Kinematics.LinearVelocity.Size();
+      if (Control.Speed > 0.0f)
+      {
+        Control.Direction = Kinematics.LinearVelocity.GetSafeNormal();
+      }
+      CarlaActor->ApplyControlToWalker(Control);
+    }
+    else
+    {
+      SetActorVelocity(CarlaActor, Kinematics.LinearVelocity * 100.0f);
+      CarlaActor->SetActorTargetAngularVelocity(Kinematics.AngularVelocity);
+    }
+  }
+
+  for (const CarlaRecorderStateTrafficLight &State : States.GetStates())
+  {
+    CarlaRecorderStateTrafficLight StateTrafficLight = State;
+    StateTrafficLight.DatabaseId = MappedId[StateTrafficLight.DatabaseId];
+    ProcessReplayerStateTrafficLight(StateTrafficLight);
+  }
+
+  for (const CarlaRecorderLightVehicle &LightVehicle : LightVehicles.GetLightVehicles())
+  {
+    CarlaRecorderLightVehicle Light = LightVehicle;
+    Light.DatabaseId = MappedId[Light.DatabaseId];
+    ProcessReplayerLightVehicle(Light);
+  }
+}
+
 void FFrameData::Clear()
 {
   EventsAdd.Clear();
@@ -216,7 +331,11 @@ void FFrameData::Write(std::ostream& OutStream)
   EventsAdd.Write(OutStream);
   EventsDel.Write(OutStream);
   EventsParent.Write(OutStream);
-  Positions.Write(OutStream);
+  PositionDelta->Write(OutStream, Positions.GetPositions());
+  for (const CarlaRecorderEventDel &EventDel : EventsDel.GetEvents())
+  {
+    PositionDelta->Remove(EventDel.DatabaseId);
+  }
   States.Write(OutStream);
   Vehicles.Write(OutStream);
   Wheels.Write(OutStream);
@@ -228,6 +347,102 @@ void FFrameData::Write(std::ostream& OutStream)
   FrameCounter.Write(OutStream);
 }
 
+carla::Buffer FFrameData::Write()
+{
+  FFrameDataWriteBuffer Buffer(*WritePool, LastWriteSize);
+  std::ostream OutStream(&Buffer);
+  Write(OutStream);
+  carla::Buffer Result = Buffer.Release();
+  LastWriteSize = std::max<size_t>(Result.size(), 4096u);
+  return Result;
+}
+
+FFrameDataWriteBuffer::FFrameDataWriteBuffer(carla::BufferPool &InPool, size_t Reserve)
+  : Pool(InPool),
+    Data(InPool.Pop(Reserve))
+{
+  Data.reset(Data.capacity());
+  setp(reinterpret_cast<char *>(Data.data()), reinterpret_cast<char *>(Data.data()) + Data.size());
+}
+
+carla::Buffer FFrameDataWriteBuffer::Release()
+{
+  Size = std::max(Size, GetPosition());
+  Data.reset(static_cast<carla::Buffer::size_type>(Size));
+  setp(nullptr, nullptr);
+  return std::move(Data);
+}
+
+void FFrameDataWriteBuffer::Grow(size_t MinCapacity)
+{
+  const size_t Position = GetPosition();
+  Size = std::max(Size, Position);
+  carla::Buffer Larger = Pool.Pop(std::max<size_t>(MinCapacity, 2u * Data.capacity()));
+  Larger.reset(Larger.capacity());
+  std::memcpy(Larger.data(), Data.data(), Size);
+  Data = std::move(Larger);
+  char *Begin = reinterpret_cast<char *>(Data.data());
+  setp(Begin, Begin + Data.size());
+  pbump(static_cast<int>(Position));
+}
+
+std::streamsize FFrameDataWriteBuffer::xsputn(const char *InData, std::streamsize Count)
+{
+  const size_t Needed = GetPosition() + static_cast<size_t>(Count);
+  if (Needed > Data.size())
+  {
+    Grow(Needed);
+  }
+  std::memcpy(pptr(), InData, static_cast<size_t>(Count));
+  pbump(static_cast<int>(Count));
+  return Count;
+}
+
+FFrameDataWriteBuffer::int_type FFrameDataWriteBuffer::overflow(int_type Char)
+{
+  if (traits_type::eq_int_type(Char, traits_type::eof()))
+  {
+    return traits_type::not_eof(Char);
+  }
+  Grow(GetPosition() + 1u);
+  *pptr() = traits_type::to_char_type(Char);
+  pbump(1);
+  return Char;
+}
+
+FFrameDataWriteBuffer::pos_type FFrameDataWriteBuffer::seekoff(
+    off_type Offset,
+    std::ios_base::seekdir Dir,
+    std::ios_base::openmode Mode)
+{
+  Size = std::max(Size, GetPosition());
+  off_type Base = 0;
+  if (Dir == std::ios_base::cur)
+  {
+    Base = static_cast<off_type>(GetPosition());
+  }
+  else if (Dir == std::ios_base::end)
+  {
+    Base = static_cast<off_type>(Size);
+  }
+  return seekpos(pos_type(Base + Offset), Mode);
+}
+
+FFrameDataWriteBuffer::pos_type FFrameDataWriteBuffer::seekpos(
+    pos_type Position,
+    std::ios_base::openmode Mode)
+{
+  const off_type Target = static_cast<off_type>(Position);
+  if (!(Mode & std::ios_base::out) || Target < 0 || static_cast<size_t>(Target) > std::max(Size, GetPosition()))
+  {
+    return pos_type(off_type(-1));
+  }
+  Size = std::max(Size, GetPosition());
+  setp(pbase(), epptr());
+  pbump(static_cast<int>(Target));
+  return Position;
+}
+
 void FFrameData::Read(std::istream& InStream)
 {
   Clear();
@@ -258,6 +473,11 @@ void FFrameData::Read(std::istream& InStream)
         Positions.Read(InStream);
         break;
 
+      // 相对上一帧的位置
+      case static_cast<char>(CarlaRecorderPacketId::PositionDelta):
+        PositionDelta->Read(InStream, Positions);
+        break;
+
       // states
       case static_cast<char>(CarlaRecorderPacketId::State):
         States.Read(InStream);
@@ -305,6 +525,11 @@ void FFrameData::Read(std::istream& InStream)
 
     }
   }
+
+  for (const CarlaRecorderEventDel &EventDel : EventsDel.GetEvents())
+  {
+    PositionDelta->Remove(EventDel.DatabaseId);
+  }
 }
 
 void FFrameData::CreateRecorderEventAdd(
@@ -913,6 +1138,76 @@ bool FFrameData::ProcessReplayerEventParent(uint32_t ChildId, uint32_t ParentId)
   return true;
 }
 
+// 成批重新定位参与者，跳过没有移动和离负责的传感器太远的参与者
+void FFrameData::ApplyPositions(
+    std::unordered_map<uint32_t, uint32_t>& MappedId,
+    FFrameApplyCache &Cache)
+{
+  check(Episode != nullptr);
+  static constexpr uint32_t NotApplied = ~0u;
+  const FActorRegistry &Registry = Episode->GetActorRegistry();
+  const std::vector<CarlaRecorderPosition> &List = Positions.GetPositions();
+  if (Cache.RecordedIds.size() != List.size())
+  {
+    Cache.Reset();
+    Cache.RecordedIds.resize(List.size(), NotApplied);
+    Cache.Actors.resize(List.size());
+    Cache.Applied.resize(List.size());
+  }
+
+  const float CullDistanceSquared = Cache.CullDistance * Cache.CullDistance;
+  auto IsVisible = [&](const FVector &Location)
+  {
+    if (Cache.CullDistance <= 0.0f)
+    {
+      return true;
+    }
+    for (const FVector &ViewLocation : Cache.ViewLocations)
+    {
+      if (FVector::DistSquared(Location, ViewLocation) <= CullDistanceSquared)
+      {
+        return true;
+      }
+    }
+    return false;
+  };
+
+  for (size_t i = 0u; i < List.size(); ++i)
+  {
+    const CarlaRecorderPosition &Pos = List[i];
+    if (Cache.RecordedIds[i] != Pos.DatabaseId)
+    {
+      // 参与者的顺序变了，重新查找这个下标的参与者
+      auto NewId = MappedId.find(Pos.DatabaseId);
+      Cache.RecordedIds[i] = Pos.DatabaseId;
+      Cache.Actors[i] = (NewId != MappedId.end()) ?
+          Registry.GetHandle(NewId->second) :
+          FActorRegistry::FHandle{};
+      Cache.Applied[i].DatabaseId = NotApplied;
+    }
+    FCarlaActor *CarlaActor = Registry.FindCarlaActor(Cache.Actors[i]);
+    if (CarlaActor == nullptr)
+    {
+      continue;
+    }
+    CarlaRecorderPosition &Applied = Cache.Applied[i];
+    if (Applied.DatabaseId == Pos.DatabaseId &&
+        Applied.Location == Pos.Location &&
+        Applied.Rotation == Pos.Rotation)
+    {
+      continue;
+    }
+    if (!IsVisible(FVector(Pos.Location)))
+    {
+      continue;
+    }
+    // 次级服务器不模拟物理，直接移动而不计算速度
+    const FTransform Trans(FRotator::MakeFromEuler(Pos.Rotation), FVector(Pos.Location), FVector(1, 1, 1));
+    CarlaActor->SetActorGlobalTransform(Trans, ETeleportType::TeleportPhysics);
+    Applied = Pos;
+  }
+}
+
 // reposition actors
 bool FFrameData::ProcessReplayerPosition(CarlaRecorderPosition Pos1, CarlaRecorderPosition Pos2, double Per, double DeltaTime)
 {
@@ -1189,7 +1484,7 @@ FCarlaActor *FFrameData::FindTrafficLightAt(FVector Location)
   // 通过 Registry 中的所有参与者
   for (auto It = Registry.begin(); It != Registry.end(); ++It)
   {
-    FCarlaActor* CarlaActor = It.Value().Get();
+    FCarlaActor* CarlaActor = It->Value.Get();
     if(CarlaActor->GetActorType() == FCarlaActor::ActorType::TrafficLight)
     {
       FVector vec = CarlaActor->GetActorGlobalLocation();
@@ -24,20 +24,89 @@
 #include "Carla/Recorder/CarlaRecorderFrames.h"
 #include "Carla/Recorder/CarlaRecorderInfo.h"
 #include "Carla/Recorder/CarlaRecorderPosition.h"
+#include "Carla/Recorder/CarlaRecorderPositionDelta.h"
 #include "Carla/Recorder/CarlaRecorderFrameCounter.h"
 #include "Carla/Recorder/CarlaRecorderState.h"
 #include "Carla/Actor/ActorDescription.h"
+#include "Carla/Actor/ActorRegistry.h"
 #include "Carla/Lights/CarlaLight.h"
 #include "Carla/Traffic/TrafficLightBase.h"
 #include "Carla/Traffic/TrafficSignBase.h"
 
 
+#include <compiler/disable-ue4-macros.h>
+#include <carla/Buffer.h>
+#include <carla/BufferPool.h>
+#include <compiler/enable-ue4-macros.h>
+
+#include <memory>
 #include <sstream>
+#include <vector>
+#include <streambuf>
 #include <unordered_map>
 
 class UCarlaEpisode;
 class FCarlaActor;
 
+// 把帧数据直接写入 carla::Buffer 的 streambuf，支持数据包回填大小时的 seekp。
+// 容量不够时按两倍扩大并保留已写入的内容
+class FFrameDataWriteBuffer : public std::streambuf
+{
+public:
+
+  FFrameDataWriteBuffer(carla::BufferPool &InPool, size_t Reserve);
+
+  // 结束写入，返回的缓冲区大小为写入的字节数
+  carla::Buffer Release();
+
+protected:
+
+  std::streamsize xsputn(const char *InData, std::streamsize Count) override;
+
+  int_type overflow(int_type Char) override;
+
+  pos_type seekoff(off_type Offset, std::ios_base::seekdir Dir, std::ios_base::openmode Mode) override;
+
+  pos_type seekpos(pos_type Position, std::ios_base::openmode Mode) override;
+
+private:
+
+  void Grow(size_t MinCapacity);
+
+  size_t GetPosition() const
+  {
+    return static_cast<size_t>(pptr() - pbase());
+  }
+
+  carla::BufferPool &Pool;
+  carla::Buffer Data;
+  // 写入过的最远位置
+  size_t Size = 0u;
+};
+
+// 次级服务器应用帧数据时在帧之间保留的数据。主服务器每帧按相同的顺序写入
+// 参与者的位置，所以按位置在数据包中的下标缓存本服务器上的参与者，不用每帧
+// 查找映射的 id 和参与者
+struct FFrameApplyCache
+{
+  std::vector<uint32_t> RecordedIds;          // 第 i 个位置的录制 id
+  std::vector<FActorRegistry::FHandle> Actors; // 对应的本服务器上的参与者，参与者被销毁后失效
+  std::vector<CarlaRecorderPosition> Applied; // 最近一次设置的位置，没有变化时不再设置
+
+  // 离所有这些位置（全局坐标，单位为厘米）都超过 CullDistance 的参与者不更新
+  // 位置，进入范围后再设置最新的位置。CullDistance 为 0 时不剔除
+  TArray<FVector> ViewLocations;
+  float CullDistance = 0.0f;
+
+  // 参与者被创建或销毁后映射的 id 可能变化
+  void Reset()
+  {
+    RecordedIds.clear();
+    Actors.clear();
+    Applied.clear();
+  }
+};
+
 class FFrameData
 {
   // 结构
@@ -62,6 +131,8 @@ class FFrameData
   CarlaRecorderPhysicsControls PhysicsControls;
   CarlaRecorderTrafficLightTimes TrafficLightTimes;
   CarlaRecorderFrameCounter FrameCounter;
+  // 副服务器处理的帧是复制出来的，所以两端的位置基准都是共享的
+  std::shared_ptr<CarlaRecorderPositionDelta> PositionDelta = std::make_shared<CarlaRecorderPositionDelta>();
 
   #pragma pack(push, 1)
   struct Header
@@ -79,11 +150,27 @@ public:
 
   void PlayFrameData(UCarlaEpisode *ThisEpisode, std::unordered_map<uint32_t, uint32_t>& MappedId);
 
+  // 与上面相同，位置按 Cache 批量设置：不查找映射、不模拟物理、跳过没有
+  // 变化和离传感器太远的参与者
+  void PlayFrameData(
+      UCarlaEpisode *ThisEpisode,
+      std::unordered_map<uint32_t, uint32_t>& MappedId,
+      FFrameApplyCache &Cache);
+
+  /// 把用 GetFrameData(Episode, true, true) 保存的完整状态原地恢复到 @a ThisEpisode：
+  /// 销毁之后生成的参与者，用原来的 id 重新生成被销毁的参与者，并恢复位置、
+  /// 速度、交通灯和车灯的状态。传感器不会重新生成。
+  void RestoreFrameData(UCarlaEpisode *ThisEpisode);
+
   void Clear();
 
   void Write(std::ostream& OutStream);
   void Read(std::istream& InStream);
 
+  // 与 Write 的内容相同，直接写入从池中取出的缓冲区，发送后缓冲区回到池中。
+  // 预留的大小取上一帧的大小，通常不需要再分配内存
+  carla::Buffer Write();
+
   // 记录函数
   void CreateRecorderEventAdd(
       uint32_t DatabaseId,
@@ -145,6 +232,9 @@ private:
   bool ProcessReplayerEventDel(uint32_t DatabaseId);
   // Replay 事件
   bool ProcessReplayerEventParent(uint32_t ChildId, uint32_t ParentId);
+  // 按缓存批量设置参与者的位置
+  void ApplyPositions(std::unordered_map<uint32_t, uint32_t>& MappedId, FFrameApplyCache &Cache);
+
   // 重新定位角色
   bool ProcessReplayerPosition(CarlaRecorderPosition Pos1, 
                                CarlaRecorderPosition Pos2, double Per, double DeltaTime);
@@ -181,4 +271,9 @@ private:
   void AddExistingActors(void);
 
   UCarlaEpisode *Episode;
+
+  // 发送给次级服务器的缓冲区，FFrameData 被复制时共用同一个池
+  std::shared_ptr<carla::BufferPool> WritePool = std::make_shared<carla::BufferPool>();
+
+  size_t LastWriteSize = 4096u;
 };
@@ -0,0 +1,174 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "Carla.h"
+#include "Carla/Game/MapPreloader.h"
+
+#include "AssetRegistry/AssetRegistryModule.h"
+#include "Engine/World.h"
+#include "HAL/PlatformTime.h"
+#include "UObject/Package.h"
+#include "UObject/UObjectHash.h"
+
+bool UCarlaMapPreloader::PreloadMap(const FString &MapName)
+{
+  const FString MapPackageName = FindMapPackage(MapName);
+  if (MapPackageName.IsEmpty())
+  {
+    return false;
+  }
+
+  FCarlaCachedMap *CachedMap = CachedMaps.Find(MapPackageName);
+  if (CachedMap != nullptr)
+  {
+    CachedMap->LastUsed = FPlatformTime::Seconds();
+    return true;
+  }
+
+  IAssetRegistry &AssetRegistry =
+      FModuleManager::LoadModuleChecked<FAssetRegistryModule>("AssetRegistry").Get();
+  TArray<FName> Dependencies;
+  AssetRegistry.GetDependencies(
+      FName(*MapPackageName),
+      Dependencies,
+      EAssetRegistryDependencyType::Hard);
+
+  FCarlaCachedMap &NewMap = CachedMaps.Add(MapPackageName);
+  NewMap.LastUsed = FPlatformTime::Seconds();
+  EvictMaps();
+
+  TArray<FString> Packages;
+  for (const FName &Dependency : Dependencies)
+  {
+    const FString PackageName = Dependency.ToString();
+    // 引擎的脚本包总是已经加载
+    if (!PackageName.StartsWith(TEXT("/Script/")) && PackageName != MapPackageName)
+    {
+      Packages.Add(PackageName);
+    }
+  }
+  UE_LOG(LogCarla, Log, TEXT("Preloading %d packages of map %s"), Packages.Num(), *MapPackageName);
+
+  CachedMaps[MapPackageName].PendingPackages = Packages.Num();
+  for (const FString &PackageName : Packages)
+  {
+    // 已经加载的包会立即调用回调，回调中可能访问 CachedMaps，所以先设置好 PendingPackages
+    LoadPackageAsync(
+        PackageName,
+        FLoadPackageAsyncDelegate::CreateUObject(
+            this,
+            &UCarlaMapPreloader::OnPackageLoaded,
+            MapPackageName));
+  }
+  return true;
+}
+
+void UCarlaMapPreloader::NotifyMapOpened(const FString &MapPackageName)
+{
+  if (CacheSize > 0)
+  {
+    PreloadMap(UWorld::RemovePIEPrefix(MapPackageName));
+  }
+}
+
+bool UCarlaMapPreloader::IsMapReady(const FString &MapPackageName) const
+{
+  const FCarlaCachedMap *CachedMap = CachedMaps.Find(MapPackageName);
+  return CachedMap != nullptr && CachedMap->PendingPackages == 0;
+}
+
+FString UCarlaMapPreloader::FindMapPackage(const FString &MapName) const
+{
+  FString Name = MapName;
+  Name.RemoveFromEnd(TEXT(".umap"));
+  if (Name.IsEmpty())
+  {
+    return {};
+  }
+
+  IAssetRegistry &AssetRegistry =
+      FModuleManager::LoadModuleChecked<FAssetRegistryModule>("AssetRegistry").Get();
+  if (Name.StartsWith(TEXT("/Game")))
+  {
+    TArray<FAssetData> Assets;
+    AssetRegistry.GetAssetsByPackageName(FName(*Name), Assets);
+    return Assets.Num() > 0 ? Name : FString{};
+  }
+  if (Name.Contains(TEXT("/")))
+  {
+    return {};
+  }
+
+  // 与 UCarlaEpisode::LoadNewEpisode 相同，地图名对应第一个同名的地图
+  TArray<FAssetData> Maps;
+  AssetRegistry.GetAssetsByClass(UWorld::StaticClass()->GetFName(), Maps);
+  for (const FAssetData &Map : Maps)
+  {
+    if (Map.AssetName.ToString() == Name)
+    {
+      return Map.PackageName.ToString();
+    }
+  }
+  return {};
+}
+
+void UCarlaMapPreloader::OnPackageLoaded(
+    const FName &PackageName,
+    UPackage *Package,
+    EAsyncLoadingResult::Type Result,
+    FString MapPackageName)
+{
+  FCarlaCachedMap *CachedMap = CachedMaps.Find(MapPackageName);
+  if (CachedMap == nullptr)
+  {
+    // 加载完成之前地图已经被淘汰
+    return;
+  }
+  --CachedMap->PendingPackages;
+
+  if (Result != EAsyncLoadingResult::Succeeded || Package == nullptr)
+  {
+    UE_LOG(LogCarla, Warning, TEXT("Failed to preload package %s"), *PackageName.ToString());
+  }
+  else
+  {
+    ForEachObjectWithOuter(Package, [CachedMap](UObject *Object)
+    {
+      if (Object->IsAsset())
+      {
+        CachedMap->Assets.Add(Object);
+      }
+    }, false);
+  }
+
+  if (CachedMap->PendingPackages == 0)
+  {
+    UE_LOG(LogCarla, Log, TEXT("Map %s preloaded (%d assets)"),
+        *MapPackageName, CachedMap->Assets.Num());
+  }
+}
+
+void UCarlaMapPreloader::EvictMaps()
+{
+  const int32 MaxMaps = FMath::Max(CacheSize, 1);
+  while (CachedMaps.Num() > MaxMaps)
+  {
+    const FString *Oldest = nullptr;
+    double OldestTime = 0.0;
+    for (const auto &Pair : CachedMaps)
+    {
+      if (Oldest == nullptr || Pair.Value.LastUsed < OldestTime)
+      {
+        Oldest = &Pair.Key;
+        OldestTime = Pair.Value.LastUsed;
+      }
+    }
+    // 资源不再被引用，下次垃圾回收（最迟在切换地图时）释放
+    UE_LOG(LogCarla, Log, TEXT("Map %s removed from the map cache"), **Oldest);
+    const FString Key = *Oldest;
+    CachedMaps.Remove(Key);
+  }
+}
@@ -0,0 +1,83 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "Containers/Map.h"
+#include "UObject/Object.h"
+
+#include "MapPreloader.generated.h"
+
+/// 缓存中的一张地图：地图依赖的资源，以及还在加载的包数。
+USTRUCT()
+struct FCarlaCachedMap
+{
+  GENERATED_BODY()
+
+  /// 保持加载状态的资源，缓存期间不会被垃圾回收。
+  UPROPERTY()
+  TArray<UObject *> Assets;
+
+  int32 PendingPackages = 0;
+
+  double LastUsed = 0.0;
+};
+
+/// 在后台异步加载地图依赖的包，之后 LoadNewEpisode 打开这张地图时不需要再从
+/// 磁盘读取它们。
+///
+/// 只缓存地图依赖的资源（网格、材质、纹理等），不缓存地图包本身：离开地图后
+/// 仍然保持旧的 UWorld 会触发引擎的世界泄漏检查。最多缓存 MapCacheSize 张地图
+/// （至少一张，即下一张预加载的地图），超出时淘汰最久没有使用的地图。
+UCLASS()
+class CARLA_API UCarlaMapPreloader : public UObject
+{
+  GENERATED_BODY()
+
+public:
+
+  /// 开始在后台加载地图 @a MapName 依赖的包，地图已经在缓存中时只更新它的
+  /// 使用时间。@a MapName 可以是地图名或 "/Game/..." 形式的完整路径，找不到
+  /// 地图时返回 false。
+  bool PreloadMap(const FString &MapName);
+
+  /// 通知一张地图已经打开。启用了地图缓存时把它加入缓存，之后切换回这张地图时
+  /// 不需要重新加载它的资源。
+  void NotifyMapOpened(const FString &MapPackageName);
+
+  /// 缓存的地图数上限，0表示只保留下一张预加载的地图。
+  void SetCacheSize(int32 Size)
+  {
+    CacheSize = FMath::Max(Size, 0);
+    EvictMaps();
+  }
+
+  int32 GetCacheSize() const
+  {
+    return CacheSize;
+  }
+
+  /// 地图 @a MapPackageName 依赖的包是否都已经加载完。
+  bool IsMapReady(const FString &MapPackageName) const;
+
+private:
+
+  /// 把地图名解析为地图包的路径，找不到时返回空字符串。
+  FString FindMapPackage(const FString &MapName) const;
+
+  void OnPackageLoaded(
+      const FName &PackageName,
+      UPackage *Package,
+      EAsyncLoadingResult::Type Result,
+      FString MapPackageName);
+
+  void EvictMaps();
+
+  UPROPERTY()
+  TMap<FString, FCarlaCachedMap> CachedMaps;
+
+  int32 CacheSize = 0;
+};
@@ -2,6 +2,9 @@
 #include "Carla.h"
 #include "Tagger.h"
 #include "TaggedComponent.h"
+#include "Carla/Game/CarlaEngine.h"
+#include "Carla/Game/CarlaEpisode.h"
+#include "Carla/Game/CarlaStatics.h"
 #include "Vehicle/CarlaWheeledVehicle.h"
 
 #include "Components/SkeletalMeshComponent.h"
@@ -10,6 +13,20 @@
 #include "Engine/StaticMesh.h"
 #include "EngineUtils.h"
 #include "PhysicsEngine/PhysicsAsset.h"
+#include "Runtime/Core/Public/Async/ParallelFor.h"
+#include "Misc/ScopeLock.h"
+#include "UObject/ObjectKey.h"
+#include "UObject/WeakObjectPtrTemplates.h"
+
+#include <compiler/disable-ue4-macros.h>
+#include <carla/sensor/s11n/InstanceSegmentationImageSerializer.h>
+#include <compiler/enable-ue4-macros.h>
+
+using FInstanceSerializer = carla::sensor::s11n::InstanceSegmentationImageSerializer;
+
+static_assert(
+    static_cast<uint8>(crp::CityObjectLabel::GuardRail) <= FInstanceSerializer::label_mask,
+    "Semantic tags do not fit in the instance segmentation colour");
 //为carla::rpc命名空间创建别名crp
 namespace crp = carla::rpc;
 //枚举类型转换模板函数
@@ -76,123 +93,236 @@ bool ATagger::IsThing(const crp::CityObjectLabel &Label)
           Label == crp::CityObjectLabel::TrafficLight);
 }
 
-/**
- * @brief 获得实例分割中参与者所标注的颜色
- * @param Actor 所需要判断显示颜色的参与者
- * @param Label 
- * @return 
-*/
-//获取参与者标签颜色函数
-FLinearColor ATagger::GetActorLabelColor(const AActor &Actor, const crp::CityObjectLabel &Label)
+// =============================================================================
+// -- 标记的辅助函数 -----------------------------------------------------------
+// =============================================================================
+
+// 需要标记的网格组件，以及决定其标签的资源
+struct FTaggerEntry
 {
-  uint32 id = Actor.GetUniqueID();
-  // TODO: Warn if id > 0xffff.
+  UPrimitiveComponent *Component;
+  const UObject *Asset;
+  crp::CityObjectLabel Label;
+  bool bSkeletal;
+};
 
-  // 像语义分割一样编码标签和 id
-  // TODO: 从红色R通道和可能的A通道借用比特？
-  FLinearColor Color(0.0f, 0.0f, 0.0f, 1.0f);
-  Color.R = CastEnum(Label) / 255.0f;
-  Color.G = ((id & 0x00ff) >> 0) / 255.0f;
-  Color.B = ((id & 0xff00) >> 8) / 255.0f;
+// 按资源缓存的标签。标签由资源的路径决定，同一资源只需要解析一次，
+// 大地图的每个图块都会复用前面图块解析过的资源。只在游戏线程中访问
+static TMap<FObjectKey, crp::CityObjectLabel> LabelCache;
 
-  return Color;
-}
+// 资源数量少于这个值时不使用其他线程解析路径
+static constexpr int32 ParallelLabelThreshold = 64;
 
+// 参与者销毁后，它的实例 id 要隔离这么多帧才能重用。图像比渲染晚几帧读回，
+// 这期间映射表中仍然保留原来的条目，延迟读回的图像也能找到原来的参与者
+static constexpr uint64 InstanceIdQuarantineFrames = 16u;
 
-// =============================================================================
-// -- ATagger类的静态函数 -------------------------------------------------
-// =============================================================================
+struct FReleasedInstanceId
+{
+  uint32 Id;
+  uint64 Frame;
+};
 
-void ATagger::TagActor(const AActor &Actor, bool bTagForSemanticSegmentation)
+// 实例 id 的分配，只在游戏线程中访问。id 0 表示没有实例，不分配
+struct FInstanceIds
 {
-#ifdef CARLA_TAGGER_EXTRA_LOG
-  UE_LOG(LogCarla, Log, TEXT("Actor: %s"), *Actor.GetName());
-#endif // CARLA_TAGGER_EXTRA_LOG
+  TMap<TWeakObjectPtr<const AActor>, uint32> Ids;
+  // 按实例 id 索引的参与者 id，0 表示没有注册的参与者
+  TArray<uint32> ActorIds;
+  TArray<uint32> FreeIds;
+  // 按释放的帧排序
+  TArray<FReleasedInstanceId> Released;
+  uint64 LastUpdateFrame = 0u;
+  bool bUpdated = false;
+  bool bTableDirty = true;
+  bool bExhausted = false;
+};
 
-  // 遍历静态网格.
-  //标记单个参与者函数
-  TArray<UStaticMeshComponent *> StaticMeshComponents;
-  Actor.GetComponents<UStaticMeshComponent>(StaticMeshComponents);
-  for (UStaticMeshComponent *Component : StaticMeshComponents) {
-    auto Label = GetLabelByPath(Component->GetStaticMesh());
-    if (Label == crp::CityObjectLabel::Pedestrians &&
-        Cast<ACarlaWheeledVehicle>(&Actor))
+static FInstanceIds InstanceIds;
+
+static FCriticalSection InstanceTableMutex;
+
+static std::shared_ptr<const ATagger::FInstanceTable> InstanceTable;
+
+// 释放已销毁参与者的 id，并回收隔离期已过的 id
+static void ReleaseInstanceIds(uint64 Frame, bool bSkipQuarantine)
+{
+  for (auto It = InstanceIds.Ids.CreateIterator(); It; ++It)
+  {
+    if (!It.Key().IsValid())
     {
-      Label = crp::CityObjectLabel::Rider;
+      InstanceIds.Released.Add({It.Value(), Frame});
+      It.RemoveCurrent();
     }
-    // 设置组件的模板值和渲染深度
-    SetStencilValue(*Component, Label, bTagForSemanticSegmentation);
-#ifdef CARLA_TAGGER_EXTRA_LOG
-    UE_LOG(LogCarla, Log, TEXT("  + StaticMeshComponent: %s"), *Component->GetName());
-    UE_LOG(LogCarla, Log, TEXT("    - Label: \"%s\""), *GetTagAsString(Label));
-#endif // CARLA_TAGGER_EXTRA_LOG
-
-    if(!Component->IsVisible() || !Component->GetStaticMesh())
+  }
+  int32 Expired = 0;
+  for (; Expired < InstanceIds.Released.Num(); ++Expired)
+  {
+    const FReleasedInstanceId &Released = InstanceIds.Released[Expired];
+    if (!bSkipQuarantine && Released.Frame + InstanceIdQuarantineFrames > Frame)
     {
-      continue;
-       // 查找或创建附加到该组件的带标签的组件，并设置其颜色
+      break;
+    }
+    if (InstanceIds.ActorIds[Released.Id] != 0u)
+    {
+      InstanceIds.ActorIds[Released.Id] = 0u;
+      InstanceIds.bTableDirty = true;
     }
+    InstanceIds.FreeIds.Add(Released.Id);
+  }
+  InstanceIds.Released.RemoveAt(0, Expired, false);
+}
 
-    // 查找附加到此组件上的带标签的组件
-    UTaggedComponent *TaggedComponent = NULL;
-     // 遍历骨骼网格组件，逻辑与静态网格组件类似
-    TArray<USceneComponent *> AttachedComponents = Component->GetAttachChildren();
-    for (USceneComponent *SceneComponent : AttachedComponents) {
-      UTaggedComponent *TaggedSceneComponent = Cast<UTaggedComponent>(SceneComponent);
-      if (IsValid(TaggedSceneComponent)) {
-          TaggedComponent = TaggedSceneComponent;
-#ifdef CARLA_TAGGER_EXTRA_LOG
-          UE_LOG(LogCarla, Log, TEXT("    - Found Tag"));
-#endif // CARLA_TAGGER_EXTRA_LOG
-          break;
+// 参与者的实例 id，第一次标记时分配。注册后会重新标记一次，这时记录参与者 id
+static uint32 GetInstanceId(const AActor &Actor)
+{
+  uint32 Id = 0u;
+  if (const uint32 *Found = InstanceIds.Ids.Find(&Actor))
+  {
+    Id = *Found;
+  }
+  else
+  {
+    if (InstanceIds.FreeIds.Num() == 0 &&
+        InstanceIds.ActorIds.Num() > static_cast<int32>(FInstanceSerializer::max_instance_id))
+    {
+      // 没有实例分割相机时不会有图像在读回，可以立即重用
+      const uint64 Frame = FCarlaEngine::GetFrameCounter();
+      ReleaseInstanceIds(Frame,
+          !InstanceIds.bUpdated || Frame >= InstanceIds.LastUpdateFrame + InstanceIdQuarantineFrames);
+    }
+    if (InstanceIds.FreeIds.Num() > 0)
+    {
+      Id = InstanceIds.FreeIds.Pop(false);
+    }
+    else if (InstanceIds.ActorIds.Num() <= static_cast<int32>(FInstanceSerializer::max_instance_id))
+    {
+      if (InstanceIds.ActorIds.Num() == 0)
+      {
+        InstanceIds.ActorIds.Add(0u);
       }
+      Id = InstanceIds.ActorIds.Add(0u);
     }
-
-    // 如果没有找到，则创建一个新的带标签的组件，并将其附加到此组件上
-    if (!TaggedComponent) {
-      TaggedComponent = NewObject<UTaggedComponent>(Component);
-      TaggedComponent->SetupAttachment(Component);
-      TaggedComponent->RegisterComponent();
-#ifdef CARLA_TAGGER_EXTRA_LOG
-      UE_LOG(LogCarla, Log, TEXT("    - Added Tag"));
-#endif // CARLA_TAGGER_EXTRA_LOG
+    else
+    {
+      UE_CLOG(!InstanceIds.bExhausted, LogCarla, Warning,
+          TEXT("Tagger: more than %u tagged actors, new actors have no instance id"),
+          FInstanceSerializer::max_instance_id);
+      InstanceIds.bExhausted = true;
+      return 0u;
     }
+    InstanceIds.Ids.Add(&Actor, Id);
+  }
 
-    // 设置带标签的组件颜色
-    FLinearColor Color = GetActorLabelColor(Actor, Label);
-#ifdef CARLA_TAGGER_EXTRA_LOG
-    UE_LOG(LogCarla, Log, TEXT("    - Color: %s"), *Color.ToString());
-#endif // CARLA_TAGGER_EXTRA_LOG
+  UCarlaEpisode *Episode = UCarlaStatics::GetCurrentEpisode(&Actor);
+  const FCarlaActor *View =
+      Episode != nullptr ? Episode->FindCarlaActor(const_cast<AActor *>(&Actor)) : nullptr;
+  const uint32 ActorId = View != nullptr ? View->GetActorId() : 0u;
+  if (InstanceIds.ActorIds[Id] != ActorId)
+  {
+    InstanceIds.ActorIds[Id] = ActorId;
+    InstanceIds.bTableDirty = true;
+  }
+  return Id;
+}
 
-    TaggedComponent->SetColor(Color);
-    TaggedComponent->MarkRenderStateDirty();
+// 像语义分割一样在 R 中编码标签，实例 id 的高位借用 R 的高 3 位
+static FLinearColor GetLabelColor(uint32 id, const crp::CityObjectLabel &Label)
+{
+  const uint32 R = CastEnum(Label) | ((id >> 16) << FInstanceSerializer::label_bits);
+  FLinearColor Color(0.0f, 0.0f, 0.0f, 1.0f);
+  Color.R = (R & 0xff) / 255.0f;
+  Color.G = ((id & 0x00ff) >> 0) / 255.0f;
+  Color.B = ((id & 0xff00) >> 8) / 255.0f;
+  return Color;
+}
+
+// 收集参与者的静态网格和骨骼网格组件
+static void GatherComponents(const AActor &Actor, TArray<FTaggerEntry> &Entries)
+{
+  TArray<UStaticMeshComponent *> StaticMeshComponents;
+  Actor.GetComponents<UStaticMeshComponent>(StaticMeshComponents);
+  for (UStaticMeshComponent *Component : StaticMeshComponents) {
+    Entries.Add({Component, Component->GetStaticMesh(), crp::CityObjectLabel::None, false});
   }
 
-  // 遍历骨骼网格
   TArray<USkeletalMeshComponent *> SkeletalMeshComponents;
   Actor.GetComponents<USkeletalMeshComponent>(SkeletalMeshComponents);
   for (USkeletalMeshComponent *Component : SkeletalMeshComponents) {
-    auto Label = GetLabelByPath(Component->GetPhysicsAsset());
-    if (Label == crp::CityObjectLabel::Pedestrians &&
-        Cast<ACarlaWheeledVehicle>(&Actor))
+    Entries.Add({Component, Component->GetPhysicsAsset(), crp::CityObjectLabel::None, true});
+  }
+}
+
+// 从缓存中查找标签，未缓存的资源在多个线程中解析路径
+static void ResolveLabels(TArray<FTaggerEntry> &Entries)
+{
+  TRACE_CPUPROFILER_EVENT_SCOPE(ATagger::ResolveLabels);
+  TArray<const UObject *> Missing;
+  TSet<const UObject *> MissingSet;
+  for (const FTaggerEntry &Entry : Entries) {
+    if (Entry.Asset != nullptr && !LabelCache.Contains(FObjectKey(Entry.Asset))) {
+      bool bAlreadyInSet = false;
+      MissingSet.Add(Entry.Asset, &bAlreadyInSet);
+      if (!bAlreadyInSet) {
+        Missing.Add(Entry.Asset);
+      }
+    }
+  }
+
+  // 路径解析只读取资源的名字，可以在其他线程中进行
+  TArray<crp::CityObjectLabel> MissingLabels;
+  MissingLabels.SetNumUninitialized(Missing.Num());
+  ParallelFor(Missing.Num(), [&](int32 Index) {
+    MissingLabels[Index] = ATagger::GetLabelByPath(Missing[Index]);
+  }, Missing.Num() < ParallelLabelThreshold);
+
+  for (int32 Index = 0; Index < Missing.Num(); ++Index) {
+    LabelCache.Add(FObjectKey(Missing[Index]), MissingLabels[Index]);
+  }
+
+  for (FTaggerEntry &Entry : Entries) {
+    Entry.Label = Entry.Asset != nullptr ?
+        LabelCache.FindChecked(FObjectKey(Entry.Asset)) :
+        crp::CityObjectLabel::None;
+  }
+}
+
+// 设置一个参与者的组件的模板值和实例分割的颜色，只能在游戏线程中调用
+static void ApplyTags(
+    const AActor &Actor,
+    TArrayView<FTaggerEntry> Entries,
+    bool bTagForSemanticSegmentation)
+{
+  const bool bIsVehicle = (Cast<ACarlaWheeledVehicle>(&Actor) != nullptr);
+  const uint32 InstanceId = GetInstanceId(Actor);
+
+  for (FTaggerEntry &Entry : Entries) {
+    auto Label = Entry.Label;
+    if (Label == crp::CityObjectLabel::Pedestrians && bIsVehicle)
     {
       Label = crp::CityObjectLabel::Rider;
     }
-    SetStencilValue(*Component, Label, bTagForSemanticSegmentation);
+    UPrimitiveComponent *Component = Entry.Component;
+    // 设置组件的模板值和渲染深度
+    ATagger::SetStencilValue(*Component, Label, bTagForSemanticSegmentation);
 #ifdef CARLA_TAGGER_EXTRA_LOG
-    UE_LOG(LogCarla, Log, TEXT("  + SkeletalMeshComponent: %s"), *Component->GetName());
-    UE_LOG(LogCarla, Log, TEXT("    - Label: \"%s\""), *GetTagAsString(Label));
+    UE_LOG(LogCarla, Log, TEXT("  + %s: %s"),
+        Entry.bSkeletal ? TEXT("SkeletalMeshComponent") : TEXT("StaticMeshComponent"),
+        *Component->GetName());
+    UE_LOG(LogCarla, Log, TEXT("    - Label: \"%s\""), *ATagger::GetTagAsString(Label));
 #endif // CARLA_TAGGER_EXTRA_LOG
 
-    if(!Component->IsVisible() || !Component->GetSkeletalMeshRenderData())
+    const bool bHasRenderData = Entry.bSkeletal ?
+        (static_cast<USkeletalMeshComponent *>(Component)->GetSkeletalMeshRenderData() != nullptr) :
+        (Entry.Asset != nullptr);
+    if (!Component->IsVisible() || !bHasRenderData)
     {
       continue;
     }
 
     // 查找附加到此组件上的带标签的组件
     UTaggedComponent *TaggedComponent = NULL;
-    TArray<USceneComponent *> AttachedComponents = Component->GetAttachChildren();
-    for (USceneComponent *SceneComponent : AttachedComponents) {
+    for (USceneComponent *SceneComponent : Component->GetAttachChildren()) {
       UTaggedComponent *TaggedSceneComponent = Cast<UTaggedComponent>(SceneComponent);
       if (IsValid(TaggedSceneComponent)) {
           TaggedComponent = TaggedSceneComponent;
@@ -203,7 +333,7 @@ void ATagger::TagActor(const AActor &Actor, bool bTagForSemanticSegmentation)
       }
     }
 
-    // 如果没有找到，则创建一个新的带标签的组件，并将其附加到此组件
+    // 如果没有找到，则创建一个新的带标签的组件，并将其附加到此组件上
     if (!TaggedComponent) {
       TaggedComponent = NewObject<UTaggedComponent>(Component);
       TaggedComponent->SetupAttachment(Component);
@@ -213,31 +343,123 @@ void ATagger::TagActor(const AActor &Actor, bool bTagForSemanticSegmentation)
 #endif // CARLA_TAGGER_EXTRA_LOG
     }
 
-    // 设置带标签组件的颜色
-    FLinearColor Color = GetActorLabelColor(Actor, Label);
+    // 设置带标签的组件颜色，颜色没有改变时不需要重建渲染状态
+    const FLinearColor Color = GetLabelColor(InstanceId, Label);
 #ifdef CARLA_TAGGER_EXTRA_LOG
     UE_LOG(LogCarla, Log, TEXT("    - Color: %s"), *Color.ToString());
 #endif // CARLA_TAGGER_EXTRA_LOG
+    if (TaggedComponent->GetColor() != Color)
+    {
+      TaggedComponent->SetColor(Color);
+      TaggedComponent->MarkRenderStateDirty();
+    }
+    if (Entry.bSkeletal)
+    {
+      TaggedComponent->SetComponentTickEnabled(true);
+    }
+  }
+}
+
+// 先收集所有参与者的组件，一起解析标签，再逐个参与者设置
+template <typename ActorRange>
+static void TagActors(const ActorRange &Actors, bool bTagForSemanticSegmentation)
+{
+  TRACE_CPUPROFILER_EVENT_SCOPE(ATagger::TagActors);
+  TArray<const AActor *> TaggedActors;
+  TArray<int32> FirstEntry;
+  TArray<FTaggerEntry> Entries;
+  for (const AActor *Actor : Actors) {
+    if (Actor == nullptr) {
+      continue;
+    }
+#ifdef CARLA_TAGGER_EXTRA_LOG
+    UE_LOG(LogCarla, Log, TEXT("Actor: %s"), *Actor->GetName());
+#endif // CARLA_TAGGER_EXTRA_LOG
+    TaggedActors.Add(Actor);
+    FirstEntry.Add(Entries.Num());
+    GatherComponents(*Actor, Entries);
+  }
+  FirstEntry.Add(Entries.Num());
+
+  ResolveLabels(Entries);
+
+  for (int32 Index = 0; Index < TaggedActors.Num(); ++Index) {
+    ApplyTags(
+        *TaggedActors[Index],
+        TArrayView<FTaggerEntry>(Entries.GetData() + FirstEntry[Index], FirstEntry[Index + 1] - FirstEntry[Index]),
+        bTagForSemanticSegmentation);
+  }
+}
 
-    TaggedComponent->SetColor(Color);
-    TaggedComponent->MarkRenderStateDirty();
-    TaggedComponent->SetComponentTickEnabled(true);
+/**
+ * @brief 获得实例分割中参与者所标注的颜色
+ * @param Actor 所需要判断显示颜色的参与者
+ * @param Label 
+ * @return 
+*/
+//获取参与者标签颜色函数
+FLinearColor ATagger::GetActorLabelColor(const AActor &Actor, const crp::CityObjectLabel &Label)
+{
+  return GetLabelColor(GetInstanceId(Actor), Label);
+}
+
+void ATagger::UpdateInstanceTable()
+{
+  const uint64 Frame = FCarlaEngine::GetFrameCounter();
+  if (InstanceIds.bUpdated && InstanceIds.LastUpdateFrame == Frame)
+  {
+    return;
+  }
+  InstanceIds.bUpdated = true;
+  InstanceIds.LastUpdateFrame = Frame;
+  ReleaseInstanceIds(Frame, false);
+  if (!InstanceIds.bTableDirty)
+  {
+    return;
+  }
+  InstanceIds.bTableDirty = false;
 
+  auto Table = std::make_shared<FInstanceTable>();
+  for (int32 Id = 1; Id < InstanceIds.ActorIds.Num(); ++Id)
+  {
+    if (InstanceIds.ActorIds[Id] != 0u)
+    {
+      Table->push_back({static_cast<uint32>(Id), InstanceIds.ActorIds[Id]});
+    }
   }
+  FScopeLock Lock(&InstanceTableMutex);
+  InstanceTable = std::move(Table);
+}
+
+std::shared_ptr<const ATagger::FInstanceTable> ATagger::GetInstanceTable()
+{
+  FScopeLock Lock(&InstanceTableMutex);
+  return InstanceTable;
 }
-//标记单个参与者函数
+
+
+// =============================================================================
+// -- ATagger类的静态函数 -------------------------------------------------
+// =============================================================================
+
+void ATagger::TagActor(const AActor &Actor, bool bTagForSemanticSegmentation)
+{
+  const AActor *Actors[] = {&Actor};
+  TagActors(Actors, bTagForSemanticSegmentation);
+}
+//标记世界中所有参与者函数
 void ATagger::TagActorsInLevel(UWorld &World, bool bTagForSemanticSegmentation)
 {
+  TArray<const AActor *> Actors;
   for (TActorIterator<AActor> it(&World); it; ++it) {
-    TagActor(**it, bTagForSemanticSegmentation);
+    Actors.Add(*it);
   }
+  TagActors(Actors, bTagForSemanticSegmentation);
 }
-//标记世界中所有参与者函数
+//标记关卡中所有参与者函数
 void ATagger::TagActorsInLevel(ULevel &Level, bool bTagForSemanticSegmentation)
 {
-  for (AActor * Actor : Level.Actors) {
-    TagActor(*Actor, bTagForSemanticSegmentation);
-  }
+  TagActors(Level.Actors, bTagForSemanticSegmentation);
 }
 //获取标记参与者的标签函数
 void ATagger::GetTagsOfTaggedActor(const AActor &Actor, TSet<crp::CityObjectLabel> &Tags)
@@ -308,6 +530,8 @@ void ATagger::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent
   Super::PostEditChangeProperty(PropertyChangedEvent);
   if (PropertyChangedEvent.Property) {
     if (bTriggerTagObjects && (GetWorld() != nullptr)) {
+      // 编辑器中资源可能被移动到其他文件夹
+      LabelCache.Empty();
       TagActorsInLevel(*GetWorld(), bTagForSemanticSegmentation);
     }
   }
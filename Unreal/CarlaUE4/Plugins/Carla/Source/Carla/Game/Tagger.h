@@ -11,8 +11,12 @@
 
 #include <compiler/disable-ue4-macros.h>
 #include <carla/rpc/ObjectLabel.h>
+#include <carla/sensor/data/InstanceTableEntry.h>
 #include <compiler/enable-ue4-macros.h>
 
+#include <memory>
+#include <vector>
+
 #include "Tagger.generated.h"
 
 namespace crp = carla::rpc;
@@ -84,8 +88,21 @@ public:
   static void SetStencilValue(UPrimitiveComponent &Component,
     const crp::CityObjectLabel &Label, const bool bSetRenderCustomDepth);
 
+  /// 实例分割的颜色，编码见 carla::sensor::s11n::InstanceSegmentationImageSerializer：
+  /// R 的低 5 位为语义标签，R 的高 3 位和 B、G 为 19 位的实例 id。实例 id 按参与者
+  /// 分配，参与者销毁后回收，与参与者 id 的对应关系见 GetInstanceTable。
   static FLinearColor GetActorLabelColor(const AActor &Actor, const crp::CityObjectLabel &Label);
 
+  /// 实例 id 到参与者 id 的映射表，按实例 id 排序，只包含已在剧集中注册的参与者。
+  using FInstanceTable = std::vector<carla::sensor::data::InstanceTableEntry>;
+
+  /// 回收已销毁参与者的实例 id，映射表有变化时发布新的映射表。实例分割相机
+  /// 每一帧调用一次，只能在游戏线程中调用。
+  static void UpdateInstanceTable();
+
+  /// 最近一次发布的映射表，发布后不会再修改，可以在任何线程中调用。
+  static std::shared_ptr<const FInstanceTable> GetInstanceTable();
+
   static bool IsThing(const crp::CityObjectLabel &Label);
 
   ATagger();
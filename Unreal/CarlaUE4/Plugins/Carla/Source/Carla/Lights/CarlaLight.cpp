@@ -81,6 +81,7 @@ void UCarlaLight::SetLightIntensity(float Intensity)
     LightIntensity = Intensity;
     // 根据新的强度值更新灯光的实际显示效果等（具体实现可能在UpdateLights函数内）
     UpdateLights();
+    RecordLightChange();
 }
 
 // 获取当前灯光强度的函数，返回一个表示强度的浮点数值
@@ -126,6 +127,7 @@ bool UCarlaLight::GetLightOn() const
 void UCarlaLight::SetLightType(ELightType Type)
 {
     LightType = Type;
+    RecordLightChange();
 }
 
 // 获取当前灯光类型的函数，返回一个ELightType类型的灯光类型值
@@ -201,6 +203,16 @@ void UCarlaLight::SetId(int InId)
 // 记录灯光发生改变的函数（通常用于一些日志记录、事件记录等相关逻辑），被标记为const表示不会修改类的成员变量（除了可能的mutable成员变量，如果有的话）
 void UCarlaLight::RecordLightChange() const
 {
+    // 通知灯光子系统，客户端只获取改变的灯光
+    UWorld* World = GetWorld();
+    if (World)
+    {
+        UCarlaLightSubsystem* CarlaLightSubsystem = World->GetSubsystem<UCarlaLightSubsystem>();
+        if (CarlaLightSubsystem)
+        {
+            CarlaLightSubsystem->OnLightChanged(this);
+        }
+    }
     // 获取当前游戏的剧情实例（可能用于记录游戏过程中的一些事件等，从命名推测），通过CarlaStatics工具类从世界中获取
     auto* Episode = UCarlaStatics::GetCurrentEpisode(GetWorld());
     if (Episode)
@@ -36,11 +36,10 @@ void UCarlaLightSubsystem::RegisterLight(UCarlaLight* CarlaLight)
       UE_LOG(LogCarla, Warning, TEXT("Light Id overlapping"));
       return;
     }
-    // 将灯光添加到集合中
+    // 将灯光添加到集合中，新的灯光作为一次改变发送给客户端
     Lights.Add(LightId, CarlaLight);
+    OnLightChanged(CarlaLight);
   }
-  // 设置客户端状态为脏，表示需要更新
-  SetClientStatesdirty("");
 }
 
 // UCarlaLightSubsystem类的成员函数，用于注销一个灯光组件
@@ -51,24 +50,30 @@ void UCarlaLightSubsystem::UnregisterLight(UCarlaLight* CarlaLight)
   {
     // 从集合中移除灯光
     Lights.Remove(CarlaLight->GetId());
+    LightVersions.Remove(CarlaLight->GetId());
+  }
+}
+
+// 记录灯光在新的版本中改变
+void UCarlaLightSubsystem::OnLightChanged(const UCarlaLight* CarlaLight)
+{
+  if(CarlaLight && Lights.Contains(CarlaLight->GetId()))
+  {
+    LightVersions.FindOrAdd(CarlaLight->GetId()) = ++LightsVersion;
   }
-  // 设置客户端状态为脏，表示需要更新
-  SetClientStatesdirty("");
 }
 
 // UCarlaLightSubsystem类的成员函数，用于检查是否有待更新的灯光
 bool UCarlaLightSubsystem::IsUpdatePending() const
 {
-  // 遍历客户端状态集合
-  for (auto ClientPair : ClientStates)
+  // 有客户端的版本落后于当前版本时，表示有更新待处理
+  for (auto ClientPair : ClientVersions)
   {
-    // 如果有任何客户端状态为真，表示有更新待处理
-    if(ClientPair.Value)
+    if(ClientPair.Value < LightsVersion)
     {
       return true;
     }
   }
-  // 如果所有客户端状态都为假，表示没有更新待处理
   return false;
 }
 
@@ -78,9 +83,10 @@ std::vector<carla::rpc::LightState> UCarlaLightSubsystem::GetLights(FString Clie
   // 创建一个用于存储结果的向量
   std::vector<carla::rpc::LightState> result;
 
-  // 为指定客户端设置状态为false
-  ClientStates.FindOrAdd(Client) = false;
+  // 客户端获取了当前版本的所有灯光
+  ClientVersions.FindOrAdd(Client) = LightsVersion;
 
+  result.reserve(Lights.Num());
   // 遍历所有灯光
   for(auto& Light : Lights)
   {
@@ -93,17 +99,66 @@ std::vector<carla::rpc::LightState> UCarlaLightSubsystem::GetLights(FString Clie
   return result;
 }
 
+// 返回 SinceVersion 之后改变的灯光状态，SinceVersion 为 0 时返回所有灯光
+carla::rpc::LightStateChanges UCarlaLightSubsystem::GetLightChanges(
+  FString Client,
+  uint64 SinceVersion)
+{
+  carla::rpc::LightStateChanges Result;
+  Result.version = LightsVersion;
+
+  // 客户端的版本比服务器新时（例如重新加载了地图），发送所有灯光
+  if(SinceVersion > LightsVersion)
+  {
+    SinceVersion = 0;
+  }
+
+  TArray<UCarlaLight*> ChangedLights;
+  GetChangedLights(SinceVersion, ChangedLights);
+  Result.lights.reserve(ChangedLights.Num());
+  for(UCarlaLight* CarlaLight : ChangedLights)
+  {
+    Result.lights.push_back(CarlaLight->GetLightState());
+  }
+
+  ClientVersions.FindOrAdd(Client) = LightsVersion;
+  return Result;
+}
+
+void UCarlaLightSubsystem::GetChangedLights(
+  uint64 SinceVersion,
+  TArray<UCarlaLight*>& OutLights) const
+{
+  if(SinceVersion >= LightsVersion)
+  {
+    return;
+  }
+  for(const auto& LightVersion : LightVersions)
+  {
+    if(LightVersion.Value > SinceVersion)
+    {
+      UCarlaLight* CarlaLight = Lights.FindRef(LightVersion.Key);
+      if(CarlaLight)
+      {
+        OutLights.Add(CarlaLight);
+      }
+    }
+  }
+}
+
 // UCarlaLightSubsystem类的成员函数，用于设置灯光状态
 void UCarlaLightSubsystem::SetLights(
   FString Client,
   std::vector<carla::rpc::LightState> LightsToSet,
   bool DiscardClient)
 {
-  // 查找指定客户端的状态
-  bool* ClientState = ClientStates.Find(Client);
+  // 查找指定客户端已获取的版本
+  uint64* ClientVersion = ClientVersions.Find(Client);
 
-  // 如果找到客户端状态
-  if(ClientState) {
+  // 如果找到客户端
+  if(ClientVersion) {
+    // 客户端已经知道自己设置的状态，之前没有落后时不需要再获取这些改变
+    const bool bClientUpToDate = (*ClientVersion == LightsVersion);
     // 遍历所有需要设置的灯光状态
     for(auto& LightState : LightsToSet) {
       // 查找对应的灯光组件
@@ -113,14 +168,16 @@ void UCarlaLightSubsystem::SetLights(
         CarlaLight->SetLightState(LightState);
       }
     }
-    // 更新客户端状态为已更新
-    *ClientState = true;
+    if(bClientUpToDate)
+    {
+      *ClientVersion = LightsVersion;
+    }
 
     // 如果需要丢弃客户端状态
     if(DiscardClient)
     {
-      // 从客户端状态集合中移除指定客户端
-      ClientStates.Remove(Client);
+      // 从客户端集合中移除指定客户端
+      ClientVersions.Remove(Client);
     }
   }
 
@@ -156,16 +213,3 @@ void UCarlaLightSubsystem::SetDayNightCycle(const bool active) {
   }
 }
 
-// UCarlaLightSubsystem类的成员函数，用于标记客户端状态为脏
-void UCarlaLightSubsystem::SetClientStatesdirty(FString ClientThatUpdate)
-{
-  for(auto& Client : ClientStates)
-  {
-    // 如果当前客户端不是更新的客户端
-    if(Client.Key != ClientThatUpdate)
-    {
-      Client.Value = true;
-    }
-
-  }
-}
@@ -50,6 +50,20 @@ public:
 
   std::vector<carla::rpc::LightState> GetLights(FString Client);
 
+  /// 返回 SinceVersion 之后改变的灯光和当前的版本，并记录 Client 已获取该版本
+  carla::rpc::LightStateChanges GetLightChanges(FString Client, uint64 SinceVersion);
+
+  /// SinceVersion 之后改变的灯光
+  void GetChangedLights(uint64 SinceVersion, TArray<UCarlaLight*>& OutLights) const;
+
+  uint64 GetLightsVersion() const
+  {
+    return LightsVersion;
+  }
+
+  /// 灯光状态改变时由 UCarlaLight 调用
+  void OnLightChanged(const UCarlaLight* CarlaLight);
+
   void SetLights(
       FString Client,
       std::vector<carla::rpc::LightState> LightsToSet,
@@ -66,12 +80,16 @@ public:
 
 private:
 
-  void SetClientStatesdirty(FString ClientThatUpdate);
-
   TMap<int, UCarlaLight* > Lights;
 
-  // 每个客户端的标志，用于指示是否需要进行更新
-  TMap<FString, bool> ClientStates;
+  // 灯光状态的版本，任何灯光改变时递增
+  uint64 LightsVersion = 0;
+
+  // 每个灯光最后一次改变时的版本
+  TMap<int, uint64> LightVersions;
+
+  // 每个客户端已经获取的灯光状态版本
+  TMap<FString, uint64> ClientVersions;
   // 由于客户端在模拟中没有正确的 ID，因此
   // 我使用 host ： 端口对。
 
@@ -139,6 +139,13 @@ void ALargeMapManager::OnLevelAddedToWorld(ULevel* InLevel, UWorld* InWorld)
   LM_LOG(Warning, "OnLevelAddedToWorld");
   ATagger::TagActorsInLevel(*InLevel, true);
 
+  // 标记之后才能按标签缓存边界框
+  ACarlaGameModeBase* GameMode = UCarlaStatics::GetGameMode(GetWorld());
+  if (GameMode)
+  {
+    GameMode->AddLevelToBBCache(InLevel);
+  }
+
 
   //FDebug::DumpStackTraceToLog(ELogVerbosity::Log);
 }
@@ -149,6 +156,12 @@ void ALargeMapManager::OnLevelRemovedFromWorld(ULevel* InLevel, UWorld* InWorld)
   //FDebug::DumpStackTraceToLog(ELogVerbosity::Log);
   FCarlaMapTile& Tile = GetCarlaMapTile(InLevel);
   Tile.TilesSpawned = false;
+
+  ACarlaGameModeBase* GameMode = UCarlaStatics::GetGameMode(GetWorld());
+  if (GameMode)
+  {
+    GameMode->RemoveLevelFromBBCache(InLevel);
+  }
 }
 
 void ALargeMapManager::RegisterInitialObjects()
@@ -190,19 +203,10 @@ void ALargeMapManager::OnActorSpawned(
     {
       LM_LOG(Log, "HERO VEHICLE DETECTED");
 
-      if (ActorsToConsider.Num() == 1 && ActorsToConsider.Contains(Spectator))
+      if (!bConsiderOnlyAddedActors)
       {
-        ActorsToConsider.Reset();
+        AddActorToConsider(Actor);
       }
-      ActorsToConsider.Add(Actor);
-
-      CheckIfRebaseIsNeeded();
-
-      UpdateTilesState();
-
-      // 等待等待的级别更改完成，以避免产卵
-      //下面没有地面的汽车
-      World->FlushLevelStreaming();
 
       IsHeroVehicle = true;
     }
@@ -231,7 +235,8 @@ void ALargeMapManager::OnActorSpawned(
       //       LM: Map<ActorId, TileID> , Tile: Map<ActorID, FDormantActor>
       //       In case of update: update Tile Map, update LM Map
       LM_LOG(Log, "DORMANT VEHICLE DETECTED");
-      DormantActors.Add(CarlaActor.GetActorId());
+      const FActorData* ActorData = CarlaActor.GetActorData();
+      AddDormantActor(CarlaActor.GetActorId(), ActorData ? ActorData->Location : FDVector());
     }
   }
 
@@ -358,9 +363,12 @@ void ALargeMapManager::Tick(float DeltaTime)
   // 从ActorToConsider向量中删除不再存在的英雄角色
   RemovePendingActorsToRemove();
 
-  ConvertActiveToDormantActors();
+  // 两种转换共用一帧的时间预算
+  const double ConversionDeadline = FPlatformTime::Seconds() + ActorConversionTimeBudget;
+
+  ConvertActiveToDormantActors(ConversionDeadline);
 
-  ConvertDormantToActiveActors();
+  ConvertDormantToActiveActors(ConversionDeadline);
 
   CheckIfRebaseIsNeeded();
 
@@ -464,6 +472,7 @@ void ALargeMapManager::GenerateMap(TArray<TPair<FString, FIntVector>> MapPathsId
 void ALargeMapManager::ClearWorldAndTiles()
 {
   MapTiles.Empty();
+  CurrentTilesPrefetched.Empty();
 }
 
 void ALargeMapManager::RegisterTilesInWorldComposition()
@@ -699,6 +708,7 @@ void ALargeMapManager::UpdateTilesState()
 {
   TRACE_CPUPROFILER_EVENT_SCOPE(ALargeMapManager::UpdateTilesState);
   TSet<TileID> TilesToConsider;
+  TMap<TileID, float> TilesToPrefetch;
 
   // 循环ActorToConsider以更新地图图块的状态
   //如果演员无效，将被删除
@@ -707,6 +717,7 @@ void ALargeMapManager::UpdateTilesState()
     if (IsValid(Actor))
     {
       GetTilesToConsider(Actor, TilesToConsider);
+      GetTilesToPrefetch(Actor, TilesToPrefetch);
     }
     else
     {
@@ -720,10 +731,27 @@ void ALargeMapManager::UpdateTilesState()
 
   UpdateTileState(TilesToBeVisible, true, true, true);
 
-  UpdateTileState(TilesToHidde, false, false, false);
+  // 离开流送距离但仍在预测路径上的图块只隐藏，保持加载
+  TSet<TileID> TilesToKeepLoaded;
+  for (const TileID TileID : TilesToHidde)
+  {
+    if (TilesToPrefetch.Contains(TileID))
+    {
+      TilesToKeepLoaded.Add(TileID);
+    }
+  }
+  UpdateTileState(TilesToHidde.Difference(TilesToKeepLoaded), false, false, false);
+  UpdateTileState(TilesToKeepLoaded, false, true, false);
+  CurrentTilesPrefetched.Append(TilesToKeepLoaded);
 
   UpdateCurrentTilesLoaded(TilesToBeVisible, TilesToHidde);
+  if (TilesToHidde.Num() > 0)
+  {
+    // 卸载的图块上的活动参与者必须立即休眠
+    bCheckAllActiveActors = true;
+  }
 
+  UpdatePrefetchedTiles(TilesToConsider, TilesToPrefetch);
 }
 
 void ALargeMapManager::RemovePendingActorsToRemove()
@@ -745,15 +773,18 @@ void ALargeMapManager::RemovePendingActorsToRemove()
   ActorsToRemove.Reset();
 
 
-  for (FCarlaActor::IdType ActorToRemove : ActivesToRemove)
+  if (ActivesToRemove.Num() > 0)
   {
-    ActiveActors.Remove(ActorToRemove);
+    ActiveActors.RemoveAll([this](FCarlaActor::IdType Id)
+    {
+      return ActivesToRemove.Contains(Id);
+    });
   }
   ActivesToRemove.Reset();
 
   for(FCarlaActor::IdType Id : DormantsToRemove)
   {
-    DormantActors.Remove(Id);
+    RemoveDormantActor(Id);
   }
   DormantsToRemove.Reset();
 }
@@ -763,9 +794,21 @@ void ALargeMapManager::CheckActiveActors()
   TRACE_CPUPROFILER_EVENT_SCOPE(ALargeMapManager::CheckActiveActors);
   UWorld* World = GetWorld();
   UCarlaEpisode* CarlaEpisode = UCarlaStatics::GetCurrentEpisode(World);
+
+  const int32 NumActors = ActiveActors.Num();
+  const int32 NumToCheck = bCheckAllActiveActors ?
+      NumActors :
+      FMath::Min(FMath::Max(ActiveActorsCheckedPerTick, 1), NumActors);
+  bCheckAllActiveActors = false;
+  if (NextActiveActorToCheck >= NumActors)
+  {
+    NextActiveActorToCheck = 0;
+  }
+
   // 检查是否必须销毁
-  for(FCarlaActor::IdType Id : ActiveActors)
+  for (int32 i = 0; i < NumToCheck; ++i)
   {
+    const FCarlaActor::IdType Id = ActiveActors[(NextActiveActorToCheck + i) % NumActors];
     FCarlaActor* View = CarlaEpisode->FindCarlaActor(Id);
     if (View)
     {
@@ -781,19 +824,31 @@ void ALargeMapManager::CheckActiveActors()
         continue;
       }
 
+      if (View->GetActorType() == FCarlaActor::ActorType::Sensor)
+      {
+        continue;
+      }
+
+      // 离所有自车都超过参与者流送距离时休眠
+      bool bIsNearAnyHero = ActorsToConsider.Num() == 0;
       for(AActor* HeroActor : ActorsToConsider)
       {
         FVector HeroLocation = HeroActor->GetActorLocation();
 
         float DistanceSquared = (RelativeLocation - HeroLocation).SizeSquared();
 
-        if (DistanceSquared > ActorStreamingDistanceSquared && View->GetActorType() != FCarlaActor::ActorType::Sensor)
+        if (DistanceSquared <= ActorStreamingDistanceSquared)
         {
-          // 保存到临时容器。稍后将转换为休眠状态
-          ActiveToDormantActors.Add(Id);
-          ActivesToRemove.Add(Id);
+          bIsNearAnyHero = true;
+          break;
         }
       }
+      if (!bIsNearAnyHero)
+      {
+        // 保存到临时容器。稍后将转换为休眠状态
+        ActiveToDormantActors.Add(Id);
+        ActivesToRemove.Add(Id);
+      }
     }
     else
     {
@@ -801,9 +856,10 @@ void ALargeMapManager::CheckActiveActors()
       ActivesToRemove.Add(Id);
     }
   }
+  NextActiveActorToCheck = NumActors > 0 ? (NextActiveActorToCheck + NumToCheck) % NumActors : 0;
 }
 
-void ALargeMapManager::ConvertActiveToDormantActors()
+void ALargeMapManager::ConvertActiveToDormantActors(double Deadline)
 {
   TRACE_CPUPROFILER_EVENT_SCOPE(ALargeMapManager::ConvertActiveToDormantActors);
   UWorld* World = GetWorld();
@@ -811,18 +867,32 @@ void ALargeMapManager::ConvertActiveToDormantActors()
 
   // 这些参与者处于休眠状态，因此将其从活动参与者中删除
   //但请先将它们保存在休眠阵列中
-  for(FCarlaActor::IdType Id : ActiveToDormantActors)
+  int32 Converted = 0;
+  for (auto It = ActiveToDormantActors.CreateIterator(); It; ++It)
   {
+    if (Converted > 0 && FPlatformTime::Seconds() > Deadline)
+    {
+      break;
+    }
+    const FCarlaActor::IdType Id = *It;
+    It.RemoveCurrent();
+
+    // 等待转换期间参与者可能已经被销毁
+    FCarlaActor* View = CarlaEpisode->FindCarlaActor(Id);
+    if (!View || View->IsDormant())
+    {
+      continue;
+    }
+
     // 进入休眠状态
     CarlaEpisode->PutActorToSleep(Id);
+    ++Converted;
 
     LM_LOG(Warning, "Converting Active To Dormant... %d", Id);
 
     // 需要休眠演员的ID并保存
-    DormantActors.Add(Id);
+    AddDormantActor(Id, View->GetActorData()->Location);
   }
-
-  ActiveToDormantActors.Reset();
 }
 
 void ALargeMapManager::CheckDormantActors()
@@ -831,65 +901,97 @@ void ALargeMapManager::CheckDormantActors()
   UWorld* World = GetWorld();
   UCarlaEpisode* CarlaEpisode = UCarlaStatics::GetCurrentEpisode(World);
 
-
-  for(FCarlaActor::IdType Id : DormantActors)
+  // 只有这些图块中的休眠参与者可能进入范围
+  TSet<TileID> TilesToCheck;
+  for(AActor* Actor : ActorsToConsider)
   {
-    FCarlaActor* CarlaActor = CarlaEpisode->FindCarlaActor(Id);
-
-    // 如果ID不匹配，则演员已被删除
-    if(!CarlaActor)
-    {
-      LM_LOG(Log, "CheckDormantActors Carla Actor %d not found", Id);
-      DormantsToRemove.Add(Id);
-      continue;
-    }
-    if(CarlaActor->GetActorId() != Id)
+    if (IsValid(Actor))
     {
-      LM_LOG(Warning, "CheckDormantActors IDs doesn't match!! Wanted = %d Received = %d", Id, CarlaActor->GetActorId());
-      DormantsToRemove.Add(Id);
-      continue;
+      GetTilesInDistance(CurrentOriginD + Actor->GetActorLocation(), ActorStreamingDistance, TilesToCheck);
     }
-    if (!CarlaActor->IsDormant())
+  }
+
+  for (const TileID TileID : TilesToCheck)
+  {
+    const TArray<FCarlaActor::IdType>* DormantActors = DormantActorsByTile.Find(TileID);
+    if (!DormantActors || !IsTileLoaded(TileID))
     {
-      LM_LOG(Warning, "CheckDormantActors Carla Actor %d is not dormant", Id);
-      DormantsToRemove.Add(Id);
       continue;
     }
 
-    const FActorData* ActorData = CarlaActor->GetActorData();
-
-    for(AActor* Actor : ActorsToConsider)
+    for(FCarlaActor::IdType Id : *DormantActors)
     {
-      FVector HeroLocation = Actor->GetActorLocation();
+      FCarlaActor* CarlaActor = CarlaEpisode->FindCarlaActor(Id);
 
-      FDVector WorldLocation = ActorData->Location;
-      FDVector RelativeLocation = WorldLocation - CurrentOriginD;
+      // 如果ID不匹配，则演员已被删除
+      if(!CarlaActor)
+      {
+        LM_LOG(Log, "CheckDormantActors Carla Actor %d not found", Id);
+        DormantsToRemove.Add(Id);
+        continue;
+      }
+      if(CarlaActor->GetActorId() != Id)
+      {
+        LM_LOG(Warning, "CheckDormantActors IDs doesn't match!! Wanted = %d Received = %d", Id, CarlaActor->GetActorId());
+        DormantsToRemove.Add(Id);
+        continue;
+      }
+      if (!CarlaActor->IsDormant())
+      {
+        LM_LOG(Warning, "CheckDormantActors Carla Actor %d is not dormant", Id);
+        DormantsToRemove.Add(Id);
+        continue;
+      }
 
-      float DistanceSquared = (RelativeLocation - HeroLocation).SizeSquared();
+      const FActorData* ActorData = CarlaActor->GetActorData();
 
-      if(DistanceSquared < ActorStreamingDistanceSquared && IsTileLoaded(WorldLocation))
+      for(AActor* Actor : ActorsToConsider)
       {
-        DormantToActiveActors.Add(Id);
-        DormantsToRemove.Add(Id);
-        break;
+        FVector HeroLocation = Actor->GetActorLocation();
+
+        FDVector WorldLocation = ActorData->Location;
+        FDVector RelativeLocation = WorldLocation - CurrentOriginD;
+
+        float DistanceSquared = (RelativeLocation - HeroLocation).SizeSquared();
+
+        if(DistanceSquared < ActorStreamingDistanceSquared)
+        {
+          DormantToActiveActors.Add(Id);
+          DormantsToRemove.Add(Id);
+          break;
+        }
       }
     }
   }
 }
 
-void ALargeMapManager::ConvertDormantToActiveActors()
+void ALargeMapManager::ConvertDormantToActiveActors(double Deadline)
 {
   TRACE_CPUPROFILER_EVENT_SCOPE(ALargeMapManager::ConvertDormantToActiveActors);
   UWorld* World = GetWorld();
   UCarlaEpisode* CarlaEpisode = UCarlaStatics::GetCurrentEpisode(World);
 
-  for(FCarlaActor::IdType Id : DormantToActiveActors)
+  int32 Converted = 0;
+  for (auto It = DormantToActiveActors.CreateIterator(); It; ++It)
   {
+    if (Converted > 0 && FPlatformTime::Seconds() > Deadline)
+    {
+      break;
+    }
+    const FCarlaActor::IdType Id = *It;
+    It.RemoveCurrent();
+
+    // 等待转换期间参与者可能已经被销毁
+    FCarlaActor* View = CarlaEpisode->FindCarlaActor(Id);
+    if (!View || !View->IsDormant())
+    {
+      continue;
+    }
+
     LM_LOG(Warning, "Converting %d Dormant To Active", Id);
 
     CarlaEpisode->WakeActorUp(Id);
-
-    FCarlaActor* View = CarlaEpisode->FindCarlaActor(Id);
+    ++Converted;
 
     if (View->IsActive()){
       LM_LOG(Warning, "Spawning dormant at %s\n\tOrigin: %s\n\tRel. location: %s", \
@@ -902,10 +1004,35 @@ void ALargeMapManager::ConvertDormantToActiveActors()
     else
     {
       LM_LOG(Warning, "Actor %d could not be woken up, keeping sleep state", Id);
-      DormantActors.Add(Id);
+      AddDormantActor(Id, View->GetActorData()->Location);
+    }
+  }
+}
+
+void ALargeMapManager::AddDormantActor(FCarlaActor::IdType Id, const FDVector& WorldLocation)
+{
+  RemoveDormantActor(Id);
+  const TileID TileID = GetTileID(WorldLocation);
+  DormantActorsByTile.FindOrAdd(TileID).Add(Id);
+  DormantActorTiles.Add(Id, TileID);
+}
+
+void ALargeMapManager::RemoveDormantActor(FCarlaActor::IdType Id)
+{
+  TileID TileID;
+  if (!DormantActorTiles.RemoveAndCopyValue(Id, TileID))
+  {
+    return;
+  }
+  TArray<FCarlaActor::IdType>* DormantActors = DormantActorsByTile.Find(TileID);
+  if (DormantActors)
+  {
+    DormantActors->RemoveSwap(Id);
+    if (DormantActors->Num() == 0)
+    {
+      DormantActorsByTile.Remove(TileID);
     }
   }
-  DormantToActiveActors.Reset();
 }
 
 void ALargeMapManager::CheckIfRebaseIsNeeded()
@@ -939,12 +1066,17 @@ void ALargeMapManager::GetTilesToConsider(const AActor* ActorToConsider,
   // 世界位置
   FDVector ActorLocation = CurrentOriginD + ActorToConsider->GetActorLocation();
 
-  // 计算当前磁贴
-  FIntVector CurrentTile = GetTileVectorID(ActorLocation);
+  GetTilesInDistance(ActorLocation, LayerStreamingDistance, OutTilesToConsider);
+}
 
+void ALargeMapManager::GetTilesInDistance(
+  const FDVector& Location,
+  float Distance,
+  TSet<TileID>& OutTiles) const
+{
   // 计算图块边界
-  FDVector UpperPos = ActorLocation + FDVector(LayerStreamingDistance,LayerStreamingDistance,0);
-  FDVector LowerPos = ActorLocation + FDVector(-LayerStreamingDistance,-LayerStreamingDistance,0);
+  FDVector UpperPos = Location + FDVector(Distance,Distance,0);
+  FDVector LowerPos = Location + FDVector(-Distance,-Distance,0);
   FIntVector UpperTileId = GetTileVectorID(UpperPos);
   FIntVector LowerTileId = GetTileVectorID(LowerPos);
   for (int Y = UpperTileId.Y; Y <= LowerTileId.Y; Y++)
@@ -956,18 +1088,129 @@ void ALargeMapManager::GetTilesToConsider(const AActor* ActorToConsider,
       FIntVector TileToCheck = FIntVector(X, Y, 0);
 
       TileID TileID = GetTileID(TileToCheck);
-      FCarlaMapTile* Tile = MapTiles.Find(TileID);
+      const FCarlaMapTile* Tile = MapTiles.Find(TileID);
       if (!Tile)
       {
         // LM_LOG(Warning, "Requested tile %d, %d  but tile was not found", TileToCheck.X, TileToCheck.Y);
         continue; // 磁贴不存在，丢弃
       }
 
-        OutTilesToConsider.Add(TileID);
+        OutTiles.Add(TileID);
+    }
+  }
+}
+
+void ALargeMapManager::GetTilesToPrefetch(
+  const AActor* ActorToConsider,
+  TMap<TileID, float>& OutTilesToPrefetch) const
+{
+  TRACE_CPUPROFILER_EVENT_SCOPE(ALargeMapManager::GetTilesToPrefetch);
+  FVector Velocity = ActorToConsider->GetVelocity();
+  Velocity.Z = 0.0f;
+  const float Speed = Velocity.Size();
+  if (TilePrefetchTime <= 0.0f || Speed < 100.0f)
+  {
+    return;
+  }
+  const FVector Direction = Velocity / Speed;
+  const FDVector ActorLocation = CurrentOriginD + ActorToConsider->GetActorLocation();
+
+  // 沿速度方向每半个图块取一个点，直到 TilePrefetchTime 秒后的位置
+  const float Lookahead = Speed * TilePrefetchTime;
+  const float Step = 0.5f * TileSide;
+  const int32 NumSteps = FMath::Min(FMath::CeilToInt(Lookahead / Step), 64);
+  for (int32 i = 1; i <= NumSteps; ++i)
+  {
+    const float Distance = FMath::Min(i * Step, Lookahead);
+    const float Time = Distance / Speed;
+    TSet<TileID> Tiles;
+    GetTilesInDistance(ActorLocation + Direction * Distance, LayerStreamingDistance, Tiles);
+    for (const TileID TileID : Tiles)
+    {
+      float* PreviousTime = OutTilesToPrefetch.Find(TileID);
+      if (PreviousTime == nullptr)
+      {
+        OutTilesToPrefetch.Add(TileID, Time);
+      }
+      else if (Time < *PreviousTime)
+      {
+        *PreviousTime = Time;
+      }
     }
   }
 }
 
+void ALargeMapManager::UpdatePrefetchedTiles(
+  const TSet<TileID>& InTilesToConsider,
+  const TMap<TileID, float>& InTilesToPrefetch)
+{
+  TRACE_CPUPROFILER_EVENT_SCOPE(ALargeMapManager::UpdatePrefetchedTiles);
+  // 已经可见的预取图块由 CurrentTilesLoaded 管理；不再在预测路径上的卸载
+  TSet<TileID> TilesToUnload;
+  int32 PendingPrefetches = 0;
+  for (auto It = CurrentTilesPrefetched.CreateIterator(); It; ++It)
+  {
+    const TileID TileID = *It;
+    if (InTilesToConsider.Contains(TileID))
+    {
+      It.RemoveCurrent();
+    }
+    else if (!InTilesToPrefetch.Contains(TileID))
+    {
+      TilesToUnload.Add(TileID);
+      It.RemoveCurrent();
+    }
+    else
+    {
+      const FCarlaMapTile* Tile = MapTiles.Find(TileID);
+      if (Tile && Tile->StreamingLevel && !Tile->StreamingLevel->GetLoadedLevel())
+      {
+        ++PendingPrefetches;
+      }
+    }
+  }
+  UpdateTileState(TilesToUnload, false, false, false);
+
+  // 先请求最早到达的图块
+  TArray<TPair<float, TileID>> Candidates;
+  for (const auto& Pair : InTilesToPrefetch)
+  {
+    if (!InTilesToConsider.Contains(Pair.Key) &&
+        !CurrentTilesLoaded.Contains(Pair.Key) &&
+        !CurrentTilesPrefetched.Contains(Pair.Key))
+    {
+      Candidates.Emplace(Pair.Value, Pair.Key);
+    }
+  }
+  Candidates.Sort([](const TPair<float, TileID>& A, const TPair<float, TileID>& B)
+  {
+    return A.Key < B.Key;
+  });
+
+  int32 Requests = 0;
+  for (const auto& Candidate : Candidates)
+  {
+    if (Requests >= MaxTilePrefetchRequestsPerTick ||
+        PendingPrefetches >= MaxPendingTilePrefetches)
+    {
+      break;
+    }
+    FCarlaMapTile* Tile = MapTiles.Find(Candidate.Value);
+    check(Tile);
+    ULevelStreamingDynamic* StreamingLevel = Tile->StreamingLevel;
+    // 优先级低于需要立即显示的图块，加载时不阻塞游戏线程
+    StreamingLevel->SetPriority(0);
+    StreamingLevel->bShouldBlockOnLoad = false;
+    StreamingLevel->SetShouldBeLoaded(true);
+    StreamingLevel->SetShouldBeVisible(false);
+    CurrentTilesPrefetched.Add(Candidate.Value);
+    LM_LOG(Log, "Prefetching tile %s, expected in %.1f s",
+        *GetTileVectorID(Candidate.Value).ToString(), Candidate.Key);
+    ++Requests;
+    ++PendingPrefetches;
+  }
+}
+
 void ALargeMapManager::GetTilesThatNeedToChangeState(
   const TSet<TileID>& InTilesToConsider,
   TSet<TileID>& OutTilesToBeVisible,
@@ -994,6 +1237,8 @@ void ALargeMapManager::UpdateTileState(
       FCarlaMapTile* CarlaTile = MapTiles.Find(TileID);
       check(CarlaTile); // 如果一个无效的ID到达这里，我们就做错了什么
       ULevelStreamingDynamic* StreamingLevel = CarlaTile->StreamingLevel;
+      // 需要立即显示的图块先于预取的图块加载
+      StreamingLevel->SetPriority(InShouldBeVisible ? 1 : 0);
       StreamingLevel->bShouldBlockOnLoad = InShouldBlockOnLoad;
       StreamingLevel->SetShouldBeLoaded(InShouldBeLoaded);
       StreamingLevel->SetShouldBeVisible(InShouldBeVisible);
@@ -1097,7 +1342,7 @@ void ALargeMapManager::PrintMapInfo()
   GEngine->AddOnScreenDebugMessage(LastMsgIndex++, MsgTime, FColor::White,
      FString::Printf(TEXT("Num active actors (%d)"), ActiveActors.Num()) );
   GEngine->AddOnScreenDebugMessage(LastMsgIndex++, MsgTime, FColor::White,
-     FString::Printf(TEXT("Num dormant actors (%d)"), DormantActors.Num()));
+     FString::Printf(TEXT("Num dormant actors (%d)"), DormantActorTiles.Num()));
   GEngine->AddOnScreenDebugMessage(LastMsgIndex++, MsgTime, FColor::White,
     FString::Printf(TEXT("Actors To Consider (%d)"), ActorsToConsider.Num()));
   for (const AActor* Actor : ActorsToConsider)
@@ -1119,6 +1364,46 @@ void ALargeMapManager::PrintMapInfo()
   }
 }
 
+void ALargeMapManager::SetConsiderOnlyAddedActors(bool bEnabled)
+{
+  if (bConsiderOnlyAddedActors == bEnabled)
+  {
+    return;
+  }
+  bConsiderOnlyAddedActors = bEnabled;
+  if (bEnabled)
+  {
+    // 之前自动加入的英雄车不再考虑，下一次更新时卸载它们周围的图块
+    ActorsToConsider.Reset();
+    if (SpectatorAsEgo && Spectator)
+    {
+      ActorsToConsider.Add(Spectator);
+    }
+    UpdateTilesState();
+  }
+}
+
+void ALargeMapManager::AddActorToConsider(AActor* Actor)
+{
+  if (!IsValid(Actor) || ActorsToConsider.Contains(Actor))
+  {
+    return;
+  }
+  if (ActorsToConsider.Num() == 1 && ActorsToConsider.Contains(Spectator))
+  {
+    ActorsToConsider.Reset();
+  }
+  ActorsToConsider.Add(Actor);
+
+  CheckIfRebaseIsNeeded();
+
+  UpdateTilesState();
+
+  // 等待等待的级别更改完成，以避免产卵
+  //下面没有地面的汽车
+  GetWorld()->FlushLevelStreaming();
+}
+
 void ALargeMapManager::ConsiderSpectatorAsEgo(bool _SpectatorAsEgo)
 {
   SpectatorAsEgo = _SpectatorAsEgo;
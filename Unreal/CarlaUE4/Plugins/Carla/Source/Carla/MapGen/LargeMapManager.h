@@ -208,6 +208,17 @@ public:
   bool SpectatorAsEgo = false;
   void ConsiderSpectatorAsEgo(bool _SpectatorAsEgo);
 
+  // 只加载 AddActorToConsider 添加的参与者周围的图块，英雄车不再自动加入。
+  // 多GPU模式下次级服务器只加载它负责的传感器周围的图块
+  void SetConsiderOnlyAddedActors(bool bEnabled);
+
+  void AddActorToConsider(AActor* Actor);
+
+  bool IsConsideringOnlyAddedActors() const
+  {
+    return bConsiderOnlyAddedActors;
+  }
+
 protected:
 
   void RemoveLandscapeCollisionIfHaveTerraMechanics(ULevel* InLevel);
@@ -218,19 +229,23 @@ protected:
 
   //检查是否有任何处于活动状态的参与者需要转换为休眠状态的参与者。
   //因为它超出了范围（参与者流送距离）
- // 仅存储所选参与者的数组
+  // 每帧轮流检查 ActiveActorsCheckedPerTick 个参与者，有图块卸载时检查全部
   void CheckActiveActors();
 
-  // 将超出范围的活动参与者转换为休眠参与者。
-  void ConvertActiveToDormantActors();
+  // 将超出范围的活动参与者转换为休眠参与者，超过 Deadline 后剩下的留到下一帧
+  void ConvertActiveToDormantActors(double Deadline);
 
   // 检查是否有任何休眠参与者需要转换为活动参与者。
-// 因为它进入了范围（参与者流送距离）
-// 仅存储所选参与者的数组
+  // 因为它进入了范围（参与者流送距离）
+  // 只检查离自车不超过参与者流送距离的图块中的休眠参与者
   void CheckDormantActors();
 
-  // 将超出范围的活动参与者转换为休眠参与者。
-  void ConvertDormantToActiveActors();
+  // 将进入范围的休眠参与者转换为活动参与者，超过 Deadline 后剩下的留到下一帧
+  void ConvertDormantToActiveActors(double Deadline);
+
+  void AddDormantActor(FCarlaActor::IdType Id, const FDVector& WorldLocation);
+
+  void RemoveDormantActor(FCarlaActor::IdType Id);
 
   void CheckIfRebaseIsNeeded();
 
@@ -238,6 +253,24 @@ protected:
     const AActor* ActorToConsider,
     TSet<TileID>& OutTilesToConsider);
 
+  // 离 Location 不超过 Distance 的图块
+  void GetTilesInDistance(
+    const FDVector& Location,
+    float Distance,
+    TSet<TileID>& OutTiles) const;
+
+  // 参与者按当前速度在 TilePrefetchTime 秒内将要进入流送距离的图块，
+  // 值为预计进入的时间（秒）
+  void GetTilesToPrefetch(
+    const AActor* ActorToConsider,
+    TMap<TileID, float>& OutTilesToPrefetch) const;
+
+  // 在后台加载（不显示）预测路径上的图块，按预计到达时间排序并限制同时加载的
+  // 图块数；卸载不再在预测路径上的预取图块
+  void UpdatePrefetchedTiles(
+    const TSet<TileID>& InTilesToConsider,
+    const TMap<TileID, float>& InTilesToPrefetch);
+
   void GetTilesThatNeedToChangeState(
     const TSet<TileID>& InTilesToConsider,
     TSet<TileID>& OutTilesToBeVisible,
@@ -262,24 +295,39 @@ protected:
   UPROPERTY(VisibleAnywhere, Category = "Large Map Manager")
   TArray<AActor*> ActorsToConsider;
 
+  bool bConsiderOnlyAddedActors = false;
+
   UPROPERTY(VisibleAnywhere, Category = "Large Map Manager")
   AActor* Spectator = nullptr;
   //UPROPERTY(VisibleAnywhere, Category = "Large Map Manager")
   TArray<FCarlaActor::IdType> ActiveActors;
-  TArray<FCarlaActor::IdType> DormantActors;
+
+  // 休眠参与者不会移动，按所在的图块分组
+  TMap<TileID, TArray<FCarlaActor::IdType>> DormantActorsByTile;
+  TMap<FCarlaActor::IdType, TileID> DormantActorTiles;
+
+  // CheckActiveActors 下一帧开始检查的位置
+  int32 NextActiveActorToCheck = 0;
+
+  // 图块卸载后需要检查全部活动参与者
+  bool bCheckAllActiveActors = true;
 
   //临时集合用于移除参与者。这样做只是为了避免在更新循环中移除它们。
   TSet<AActor*> ActorsToRemove;
   TSet<FCarlaActor::IdType> ActivesToRemove;
   TSet<FCarlaActor::IdType> DormantsToRemove;
 
-  // 用于将参与者从一个数组移动到另一个数组的辅助工具。.
+  // 等待转换的参与者，每帧在时间预算内转换一部分
   TSet<FCarlaActor::IdType> ActiveToDormantActors;
   TSet<FCarlaActor::IdType> DormantToActiveActors;
 
   UPROPERTY(VisibleAnywhere, Category = "Large Map Manager")
   TSet<uint64> CurrentTilesLoaded;
 
+  // 已加载或正在后台加载、但还不可见的预取图块
+  UPROPERTY(VisibleAnywhere, Category = "Large Map Manager")
+  TSet<uint64> CurrentTilesPrefetched;
+
   // 重新定基准后的当前原点。
   UPROPERTY(VisibleAnywhere, Category = "Large Map Manager")
   FIntVector CurrentOriginInt{ 0 };
@@ -301,6 +349,26 @@ protected:
   UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Large Map Manager")
   float RebaseOriginDistance = 2.0f * 1000.0f * 100.0f;
 
+  // 预取参与者按当前速度在这段时间（秒）内将要进入流送距离的图块，为0时不预取
+  UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Large Map Manager")
+  float TilePrefetchTime = 10.0f;
+
+  // 每帧最多发出的预取请求数
+  UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Large Map Manager")
+  int32 MaxTilePrefetchRequestsPerTick = 1;
+
+  // 最多同时在后台加载的预取图块数，限制加载对帧时间的影响
+  UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Large Map Manager")
+  int32 MaxPendingTilePrefetches = 2;
+
+  // 每帧检查的活动参与者数
+  UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Large Map Manager")
+  int32 ActiveActorsCheckedPerTick = 256;
+
+  // 每帧转换休眠/活动参与者的时间预算（秒），每帧每种转换至少进行一次
+  UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Large Map Manager")
+  float ActorConversionTimeBudget = 0.002f;
+
   float LayerStreamingDistanceSquared = LayerStreamingDistance * LayerStreamingDistance;
   float ActorStreamingDistanceSquared = ActorStreamingDistance * ActorStreamingDistance;
   float RebaseOriginDistanceSquared = RebaseOriginDistance * RebaseOriginDistance;
@@ -84,30 +84,57 @@ FString UOpenDrive::GetXODR(const UWorld *World)
   const auto FolderDir = MapDir + "/OpenDrive/";
   const auto FileName = MapDir.EndsWith(MapName) ? "*" : MapName;
 
-  // 查找地图中所有.xodr和.bin文件。
-  TArray<FString> Files;
-  // 递归查找指定文件夹下所有.xodr文件
-  IFileManager::Get().FindFilesRecursive(Files, *FolderDir, *FString(FileName + ".xodr"), true, false, false);
-
-  FString Content;
+  // 启动时和 get_map_data 多次读取同一张地图的文件，缓存找到的路径和读取的内容，
+  // 文件被修改（例如生成新的 OpenDRIVE 地图）后重新读取。只在游戏线程中调用。
+  static struct
+  {
+    FString Pattern;
+    FString Path;
+    FDateTime TimeStamp;
+    FString Content;
+  } Cache;
+
+  const FString Pattern = FolderDir + FileName;
+  if (Cache.Pattern != Pattern || Cache.Path.IsEmpty() || !FPaths::FileExists(Cache.Path))
+  {
+    // 查找地图中所有.xodr和.bin文件。
+    TArray<FString> Files;
+    // 递归查找指定文件夹下所有.xodr文件
+    IFileManager::Get().FindFilesRecursive(Files, *FolderDir, *FString(FileName + ".xodr"), true, false, false);
+    Cache.Pattern = Pattern;
+    Cache.Path = Files.Num() ? Files[0] : FString{};
+    Cache.TimeStamp = FDateTime::MinValue();
+    Cache.Content.Empty();
+  }
 
   // 如果没有找到文件
-  if (!Files.Num())
+  if (Cache.Path.IsEmpty())
   {
     // 记录错误日志，表示没有找到OpenDrive文件
     UE_LOG(LogTemp, Error, TEXT("Failed to find OpenDrive file for map '%s'"), *MapName);
+    return FString{};
+  }
+
+  const FDateTime TimeStamp = IFileManager::Get().GetTimeStamp(*Cache.Path);
+  if (TimeStamp == Cache.TimeStamp)
+  {
+    return Cache.Content;
   }
+
+  FString Content;
     // 如果成功加载了文件
-  else if (FFileHelper::LoadFileToString(Content, *Files[0]))
+  if (FFileHelper::LoadFileToString(Content, *Cache.Path))
   {
     // 记录日志，表示成功加载了OpenDrive文件
-    UE_LOG(LogTemp, Log, TEXT("Loaded OpenDrive file '%s'"), *Files[0]);
+    UE_LOG(LogTemp, Log, TEXT("Loaded OpenDrive file '%s'"), *Cache.Path);
+    Cache.TimeStamp = TimeStamp;
+    Cache.Content = Content;
   }
   // 如果加载文件失败
   else
   {
     // 记录错误日志，表示加载OpenDrive文件失败
-    UE_LOG(LogTemp, Error, TEXT("Failed to load OpenDrive file '%s'"), *Files[0]);
+    UE_LOG(LogTemp, Error, TEXT("Failed to load OpenDrive file '%s'"), *Cache.Path);
   }
 
   // 返回文件内容
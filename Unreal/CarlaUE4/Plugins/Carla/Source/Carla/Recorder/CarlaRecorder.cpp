@@ -18,6 +18,7 @@
 #include "Carla/Walker/WalkerController.h"
 #include "Components/BoxComponent.h"
 #include "Components/SkeletalMeshComponent.h"
+#include "HAL/IConsoleManager.h"
 #include "VehicleAnimInstance.h"
 
 #include <compiler/disable-ue4-macros.h>
@@ -30,6 +31,51 @@
 #include <ctime>
 #include <sstream>
 
+using RecorderPacket = carla::rpc::RecorderPacket;
+
+static TAutoConsoleVariable<float> CVarRecorderKeyframeInterval(
+    TEXT("carla.Recorder.KeyframeInterval"),
+    10.0f,
+    TEXT("Seconds of simulation between two keyframes of the recorder. The replayer ")
+    TEXT("seeks to the last keyframe before the start time. If 0, no keyframes are written."),
+    ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarRecorderStreamConnectTimeout(
+    TEXT("carla.Recorder.StreamConnectTimeout"),
+    10.0f,
+    TEXT("Seconds a recording to a stream waits for the client to subscribe before it gives up."),
+    ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarRecorderCompress(
+    TEXT("carla.Recorder.Compress"),
+    0,
+    TEXT("If 1, new recordings are written in zlib compressed blocks. The replayer and ")
+    TEXT("the query tools read both compressed and uncompressed files."),
+    ECVF_Default);
+
+static CarlaRecorderActorDescription MakeRecorderActorDescription(const FActorDescription &ActorDescription)
+{
+  CarlaRecorderActorDescription Description;
+  Description.UId = ActorDescription.UId;
+  Description.Id = ActorDescription.Id;
+
+  // 属性
+  Description.Attributes.reserve(ActorDescription.Variations.Num());
+  for (const auto &item : ActorDescription.Variations)
+  {
+    CarlaRecorderActorAttribute Attr;
+    Attr.Type = static_cast<uint8_t>(item.Value.Type);
+    Attr.Id = item.Value.Id;
+    Attr.Value = item.Value.Value;
+    // 检查空属性
+    if (!Attr.Id.IsEmpty())
+    {
+      Description.Attributes.emplace_back(std::move(Attr));
+    }
+  }
+  return Description;
+}
+
 ACarlaRecorder::ACarlaRecorder(void)
 {
   PrimaryActorTick.TickGroup = TG_PrePhysics;
@@ -65,6 +111,12 @@ std::string ACarlaRecorder::ReplayFile(std::string Name, double TimeStart, doubl
   return Replayer.ReplayFile(Name, TimeStart, Duration, FollowId, ReplaySensors);
 }
 
+std::string ACarlaRecorder::BenchmarkReplayer(std::string Name, double Tolerance)
+{
+  Stop();
+  return Replayer.Benchmark(Name, Tolerance);
+}
+
 void ACarlaRecorder::SetReplayerTimeFactor(double TimeFactor)
 {
   Replayer.SetTimeFactor(TimeFactor);
@@ -104,22 +156,34 @@ void ACarlaRecorder::Ticking(float DeltaSeconds)
       // 遍历注册表中的所有actors
       for (auto It = Registry.begin(); It != Registry.end(); ++It)
     {
-      FCarlaActor* View = It.Value().Get();
+      FCarlaActor* View = It->Value.Get();
+
+      // 跳过过滤器没有选中或者不在区域内的actor
+      if (Filter.IsActive() && !Filter.IsActorRecorded(*View))
+      {
+        continue;
+      }
 
       switch (View->GetActorType())
       {
           // 保存propos的变换数据
           case FCarlaActor::ActorType::Other:
-          AddActorPosition(View);
+          if (Filter.IsPacketEnabled(RecorderPacket::Position))
+            AddActorPosition(View);
           break;
 
           // 保存所有车辆的变换数据
           case FCarlaActor::ActorType::Vehicle:
-          AddActorPosition(View);
-          AddVehicleAnimation(View);
-          AddVehicleLight(View);
-          AddVehicleWheelsAnimation(View);
-          if (bAdditionalData)
+          if (Filter.IsPacketEnabled(RecorderPacket::Position))
+            AddActorPosition(View);
+          if (Filter.IsPacketEnabled(RecorderPacket::VehicleAnimation))
+            AddVehicleAnimation(View);
+          if (Filter.IsPacketEnabled(RecorderPacket::VehicleLight))
+            AddVehicleLight(View);
+          if (Filter.IsPacketEnabled(RecorderPacket::VehicleWheels) ||
+              Filter.IsPacketEnabled(RecorderPacket::BikerAnimation))
+            AddVehicleWheelsAnimation(View);
+          if (bAdditionalData && Filter.IsPacketEnabled(RecorderPacket::Kinematics))
           {
             AddActorKinematics(View);
           }
@@ -127,18 +191,23 @@ void ACarlaRecorder::Ticking(float DeltaSeconds)
 
           // 保存所有行人的变换数据
           case FCarlaActor::ActorType::Walker:
-          AddActorPosition(View);
-          AddWalkerAnimation(View);
+          if (Filter.IsPacketEnabled(RecorderPacket::Position))
+            AddActorPosition(View);
+          if (Filter.IsPacketEnabled(RecorderPacket::WalkerAnimation))
+            AddWalkerAnimation(View);
           if (bAdditionalData)
           {
-            AddActorKinematics(View);
-            AddActorBones(View);
+            if (Filter.IsPacketEnabled(RecorderPacket::Kinematics))
+              AddActorKinematics(View);
+            if (Filter.IsPacketEnabled(RecorderPacket::WalkerBones))
+              AddActorBones(View);
           }
           break;
 
         // 保存每个交通信号灯的状态
         case FCarlaActor::ActorType::TrafficLight:
-          AddTrafficLightState(View);
+          if (Filter.IsPacketEnabled(RecorderPacket::TrafficLightState))
+            AddTrafficLightState(View);
           break;
       }
     }
@@ -241,9 +310,12 @@ void ACarlaRecorder::AddVehicleWheelsAnimation(FCarlaActor *CarlaActor)
     ++i;
   }
 
-  AddAnimVehicleWheels(Record);
+  if (Filter.IsPacketEnabled(RecorderPacket::VehicleWheels))
+  {
+    AddAnimVehicleWheels(Record);
+  }
 
-  if (CarlaVehicle->IsTwoWheeledVehicle())
+  if (CarlaVehicle->IsTwoWheeledVehicle() && Filter.IsPacketEnabled(RecorderPacket::BikerAnimation))
   {
     AddAnimBiker(CarlaRecorderAnimBiker
     {
@@ -306,8 +378,16 @@ void ACarlaRecorder::AddVehicleLight(FCarlaActor *CarlaActor)
 
 void ACarlaRecorder::AddVehicleDoor(const ACarlaWheeledVehicle &Vehicle, const EVehicleDoor SDoors, bool bIsOpen)
 {
+  if (!Filter.IsPacketEnabled(RecorderPacket::VehicleDoor))
+  {
+    return;
+  }
   CarlaRecorderDoorVehicle DoorVehicle;
   DoorVehicle.DatabaseId = Episode->GetActorRegistry().FindCarlaActor(&Vehicle)->GetActorId();
+  if (!Filter.IsActorIncluded(DoorVehicle.DatabaseId))
+  {
+    return;
+  }
   DoorVehicle.Doors = static_cast<CarlaRecorderDoorVehicle::VehicleDoorType>(SDoors);
   DoorVehicle.bIsOpen = bIsOpen;
   AddDoorVehicle(DoorVehicle);
@@ -334,6 +414,11 @@ void ACarlaRecorder::AddActorBoundingBox(FCarlaActor *CarlaActor)
 {
   check(CarlaActor != nullptr);
 
+  if (!Filter.IsPacketEnabled(RecorderPacket::BoundingBox))
+  {
+    return;
+  }
+
   const auto &Box = CarlaActor->GetActorInfo()->BoundingBox;
   CarlaRecorderActorBoundingBox BoundingBox =
   {
@@ -346,7 +431,7 @@ void ACarlaRecorder::AddActorBoundingBox(FCarlaActor *CarlaActor)
 
 void ACarlaRecorder::AddTriggerVolume(const ATrafficSignBase &TrafficSign)
 {
-  if (bAdditionalData)
+  if (bAdditionalData && Filter.IsPacketEnabled(RecorderPacket::TriggerVolume))
   {
     TArray<UBoxComponent*> Triggers = TrafficSign.GetTriggerVolumes();
     if(!Triggers.Num())
@@ -361,16 +446,23 @@ void ACarlaRecorder::AddTriggerVolume(const ATrafficSignBase &TrafficSign)
       Episode->GetActorRegistry().FindCarlaActor(&TrafficSign)->GetActorId(),
       {VolumeOrigin, VolumeExtent}
     };
-    TriggerVolumes.Add(TriggerVolume);
+    if (Filter.IsActorIncluded(TriggerVolume.DatabaseId))
+    {
+      TriggerVolumes.Add(TriggerVolume);
+    }
   }
 }
 
 void ACarlaRecorder::AddPhysicsControl(const ACarlaWheeledVehicle& Vehicle)
 {
-  if (bAdditionalData)
+  if (bAdditionalData && Filter.IsPacketEnabled(RecorderPacket::PhysicsControl))
   {
     CarlaRecorderPhysicsControl Control;
     Control.DatabaseId = Episode->GetActorRegistry().FindCarlaActor(&Vehicle)->GetActorId();
+    if (!Filter.IsActorIncluded(Control.DatabaseId))
+    {
+      return;
+    }
     Control.VehiclePhysicsControl = Vehicle.GetVehiclePhysicsControl();
     PhysicsControls.Add(Control);
   }
@@ -378,9 +470,13 @@ void ACarlaRecorder::AddPhysicsControl(const ACarlaWheeledVehicle& Vehicle)
 
 void ACarlaRecorder::AddTrafficLightTime(const ATrafficLightBase& TrafficLight)
 {
-  if (bAdditionalData)
+  if (bAdditionalData && Filter.IsPacketEnabled(RecorderPacket::TrafficLightTime))
   {
     auto DatabaseId = Episode->GetActorRegistry().FindCarlaActor(&TrafficLight)->GetActorId();
+    if (!Filter.IsActorIncluded(DatabaseId))
+    {
+      return;
+    }
     CarlaRecorderTrafficLightTime TrafficLightTime{
       DatabaseId,
       TrafficLight.GetGreenTime(),
@@ -413,7 +509,40 @@ void ACarlaRecorder::AddActorBones(FCarlaActor *CarlaActor)
   WalkersBones.Add(std::move(Walker));
 }
 
-std::string ACarlaRecorder::Start(std::string Name, FString MapName, bool AdditionalData)
+std::string ACarlaRecorder::Start(std::string Name, FString MapName, bool AdditionalData,
+    const carla::rpc::RecorderFilter *InFilter)
+{
+  // 获取最终路径+文件名
+  std::string Filename = GetRecorderFilename(Name);
+
+  // 二进制文件
+  // 文件无法打开时仍然停止之前的录制和回放
+  std::unique_ptr<CarlaRecorderFileSink> FileSink = std::make_unique<CarlaRecorderFileSink>();
+  if (!FileSink->Open(Filename))
+  {
+    FileSink.reset();
+  }
+  if (!StartWithSink(std::move(FileSink), MapName, AdditionalData, InFilter))
+  {
+    return "";
+  }
+  return Filename;
+}
+
+bool ACarlaRecorder::StartStream(carla::streaming::Stream Stream, FString MapName,
+    bool AdditionalData, const carla::rpc::RecorderFilter *InFilter)
+{
+  return StartWithSink(
+      std::make_unique<CarlaRecorderStreamSink>(
+          std::move(Stream),
+          CVarRecorderStreamConnectTimeout.GetValueOnGameThread()),
+      MapName,
+      AdditionalData,
+      InFilter);
+}
+
+bool ACarlaRecorder::StartWithSink(std::unique_ptr<CarlaRecorderSink> Sink, FString MapName,
+    bool AdditionalData, const carla::rpc::RecorderFilter *InFilter)
 {
   // 如果在过程中，停止回放器
   if (Replayer.IsEnabled())
@@ -425,14 +554,10 @@ std::string ACarlaRecorder::Start(std::string Name, FString MapName, bool Additi
   // 重置CollisionId
   NextCollisionId = 0;
 
-  // 获取最终路径+文件名
-  std::string Filename = GetRecorderFilename(Name);
-
-  // 二进制文件
-  File.open(Filename, std::ios::binary);
-  if (!File.is_open())
+  File.Open(std::move(Sink), CVarRecorderCompress.GetValueOnGameThread() != 0);
+  if (!File.IsOpen())
   {
-    return "";
+    return false;
   }
 
   // 保存info
@@ -445,27 +570,43 @@ std::string ACarlaRecorder::Start(std::string Name, FString MapName, bool Additi
   Info.Write(File);
 
   Frames.Reset();
+  FrameIndex.Clear();
+  NextKeyframeTime = 0.0;
   PlatformTime.SetStartTime();
 
   Enable();
 
   bAdditionalData = AdditionalData;
 
+  // 过滤器要在添加现有的actors之前设置
+  if (InFilter != nullptr)
+  {
+    Filter.Set(*InFilter);
+  }
+
   // 添加所有现有的actors
   AddExistingActors();
 
-  return std::string(Filename);
+  return true;
 }
 
 void ACarlaRecorder::Stop(void)
 {
   Disable();
 
-  if (File)
+  if (File.IsOpen())
   {
-    File.close();
+    // 在文件末尾写入帧索引，回放时可以直接跳到关键帧
+    FrameIndex.SetTotalTime(Frames.GetFrame().Elapsed);
+    FrameIndex.Write(File);
+    if (!File.Close())
+    {
+      UE_LOG(LogCarla, Warning, TEXT("Recorder could not write all the data to the file"));
+    }
   }
 
+  FrameIndex.Clear();
+  Filter.Clear();
   Clear();
 }
 
@@ -498,13 +639,25 @@ void ACarlaRecorder::Write(double DeltaSeconds)
   Frames.SetFrame(DeltaSeconds);
 
   // 开始
+  std::streampos FrameOffset = File.tellp();
   Frames.WriteStart(File);
+
+  // 上一帧的时长已经回填，之前的数据交给写文件的线程
+  File.Commit(FrameOffset);
+
   VisualTime.Write(File);
 
   // events
   EventsAdd.Write(File);
   EventsDel.Write(File);
   EventsParent.Write(File);
+
+  // 关键帧记录的是这一帧事件之后的状态，所以写在事件之后
+  if (Frames.GetFrame().Elapsed >= NextKeyframeTime)
+  {
+    WriteKeyframe(FrameOffset);
+  }
+
   Collisions.Write(File);
   DoorVehicles.Write(File);
 
@@ -538,6 +691,49 @@ void ACarlaRecorder::Write(double DeltaSeconds)
   Clear();
 }
 
+void ACarlaRecorder::WriteKeyframe(std::streampos FrameOffset)
+{
+  const float Interval = CVarRecorderKeyframeInterval.GetValueOnGameThread();
+  if (Interval <= 0.0f)
+  {
+    NextKeyframeTime = Frames.GetFrame().Elapsed;
+    return;
+  }
+
+  // 保存所有仍然存在的 actor 及其当前的变换和父子关系
+  Keyframe.Clear();
+  const FActorRegistry &Registry = Episode->GetActorRegistry();
+  for (auto It = Registry.begin(); It != Registry.end(); ++It)
+  {
+    const FCarlaActor* View = It->Value.Get();
+    if (View == nullptr || View->GetActorInfo() == nullptr ||
+        !Filter.IsActorIncluded(View->GetActorId()))
+    {
+      continue;
+    }
+
+    FTransform Transform = View->GetActorGlobalTransform();
+    Keyframe.Add(CarlaRecorderEventAdd
+    {
+      View->GetActorId(),
+      static_cast<uint8_t>(View->GetActorType()),
+      Transform.GetTranslation(),
+      Transform.GetRotation().Euler(),
+      MakeRecorderActorDescription(View->GetActorInfo()->Description)
+    });
+
+    if (View->GetParent() != 0 && Filter.IsActorIncluded(View->GetParent()))
+    {
+      Keyframe.Add(CarlaRecorderEventParent{View->GetActorId(), View->GetParent()});
+    }
+  }
+  Keyframe.Write(File);
+  Keyframe.Clear();
+
+  FrameIndex.Add(Frames.GetFrame().Elapsed, FrameOffset);
+  NextKeyframeTime = Frames.GetFrame().Elapsed + Interval;
+}
+
 void ACarlaRecorder::AddPosition(const CarlaRecorderPosition &Position)
 {
   if (Enabled)
@@ -558,13 +754,20 @@ void ACarlaRecorder::AddEvent(const CarlaRecorderEventDel &Event)
 {
   if (Enabled)
   {
-    EventsDel.Add(std::move(Event));
+    // 没有录制生成事件的actor也不录制销毁事件
+    if (Filter.IsActorIncluded(Event.DatabaseId))
+    {
+      EventsDel.Add(std::move(Event));
+    }
+    Filter.RemoveActor(Event.DatabaseId);
   }
 }
 
 void ACarlaRecorder::AddEvent(const CarlaRecorderEventParent &Event)
 {
-  if (Enabled)
+  if (Enabled &&
+      Filter.IsActorIncluded(Event.DatabaseId) &&
+      Filter.IsActorIncluded(Event.DatabaseIdParent))
   {
     EventsParent.Add(std::move(Event));
   }
@@ -572,7 +775,7 @@ void ACarlaRecorder::AddEvent(const CarlaRecorderEventParent &Event)
 
 void ACarlaRecorder::AddCollision(AActor *Actor1, AActor *Actor2)
 {
-  if (Enabled)
+  if (Enabled && Filter.IsPacketEnabled(RecorderPacket::Collision))
   {
     CarlaRecorderCollision Collision;
 
@@ -611,6 +814,14 @@ void ACarlaRecorder::AddCollision(AActor *Actor1, AActor *Actor2)
       Collision.DatabaseId2 = uint32_t(-1); // actor2 不是已注册的 Carla actor
     }
 
+    // 只录制没有被过滤掉的actor之间的碰撞
+    if (!Filter.IsActorIncluded(Collision.DatabaseId1) ||
+        !Filter.IsActorIncluded(Collision.DatabaseId2))
+    {
+      --NextCollisionId;
+      return;
+    }
+
     Collisions.Add(std::move(Collision));
   }
 }
@@ -673,7 +884,7 @@ void ACarlaRecorder::AddDoorVehicle(const CarlaRecorderDoorVehicle &DoorVehicle)
 
 void ACarlaRecorder::AddEventLightSceneChanged(const UCarlaLight* Light)
 {
-  if (Enabled)
+  if (Enabled && Filter.IsPacketEnabled(RecorderPacket::SceneLight))
   {
     CarlaRecorderLightScene LightScene =
     {
@@ -742,23 +953,10 @@ void ACarlaRecorder::CreateRecorderEventAdd(
     const FTransform &Transform,
     FActorDescription ActorDescription)
 {
-  CarlaRecorderActorDescription Description;
-  Description.UId = ActorDescription.UId;
-  Description.Id = ActorDescription.Id;
-
-  // 属性
-  Description.Attributes.reserve(ActorDescription.Variations.Num());
-  for (const auto &item : ActorDescription.Variations)
+  // 过滤器没有选中的actor不记录任何事件
+  if (!Filter.AddActor(DatabaseId, ActorDescription.Id))
   {
-    CarlaRecorderActorAttribute Attr;
-    Attr.Type = static_cast<uint8_t>(item.Value.Type);
-    Attr.Id = item.Value.Id;
-    Attr.Value = item.Value.Value;
-    // 检查空属性
-    if (!Attr.Id.IsEmpty())
-    {
-      Description.Attributes.emplace_back(std::move(Attr));
-    }
+    return;
   }
 
   // 记录事件
@@ -768,7 +966,7 @@ void ACarlaRecorder::CreateRecorderEventAdd(
     Type,
     Transform.GetTranslation(),
     Transform.GetRotation().Euler(),
-    std::move(Description)
+    MakeRecorderActorDescription(ActorDescription)
   };
   AddEvent(std::move(RecEvent));
 
@@ -9,6 +9,8 @@
 // #include "GameFramework/Actor.h"
 #include <fstream>
 
+#include "CarlaRecorderFile.h"
+
 #include "Carla/Actor/ActorDescription.h"
 
 #include "CarlaRecorderTraficLightTime.h"
@@ -26,7 +28,9 @@
 #include "CarlaRecorderEventAdd.h"
 #include "CarlaRecorderEventDel.h"
 #include "CarlaRecorderEventParent.h"
+#include "CarlaRecorderFilter.h"
 #include "CarlaRecorderFrames.h"
+#include "CarlaRecorderFrameIndex.h"
 #include "CarlaRecorderInfo.h"
 #include "CarlaRecorderPosition.h"
 #include "CarlaRecorderQuery.h"
@@ -71,7 +75,12 @@ enum class CarlaRecorderPacketId : uint8_t
   VisualTime,
   VehicleDoor,
   AnimVehicleWheels,
-  AnimBiker
+  AnimBiker,
+  Keyframe,
+  FrameIndex,
+  FrameIndexOffset,
+  // 只在多 GPU 模式下发送给副服务器，不写入录制文件
+  PositionDelta
 };
 
 /// Recorder for the simulation
@@ -94,8 +103,13 @@ public:
 
   void Disable(void);
 
-  // start / stop
-  std::string Start(std::string Name, FString MapName, bool AdditionalData = false);
+  // start / stop (only the actors and packets selected by the filter are recorded)
+  std::string Start(std::string Name, FString MapName, bool AdditionalData = false,
+      const carla::rpc::RecorderFilter *InFilter = nullptr);
+
+  // start recording to a stream of the streaming server instead of a file
+  bool StartStream(carla::streaming::Stream Stream, FString MapName, bool AdditionalData = false,
+      const carla::rpc::RecorderFilter *InFilter = nullptr);
 
   void Stop(void);
 
@@ -171,6 +185,7 @@ public:
   // replayer
   std::string ReplayFile(std::string Name, double TimeStart, double Duration,
       uint32_t FollowId, bool ReplaySensors);
+  std::string BenchmarkReplayer(std::string Name, double Tolerance);
   void SetReplayerTimeFactor(double TimeFactor);
   void SetReplayerIgnoreHero(bool IgnoreHero);
   void SetReplayerIgnoreSpectator(bool IgnoreSpectator);
@@ -187,8 +202,11 @@ private:
 
   uint32_t NextCollisionId = 0;
 
-  // files
-  std::ofstream File;
+  // selects the actors and packets to record
+  CarlaRecorderFilter Filter;
+
+  // files (buffered in memory and written by a background thread)
+  CarlaRecorderFile File;
 
   UCarlaEpisode *Episode = nullptr;
 
@@ -217,12 +235,20 @@ private:
   CarlaRecorderVisualTime VisualTime;
   CarlaRecorderDoorVehicles DoorVehicles;
 
+  // keyframes and the frame index written at the end of the file
+  CarlaRecorderKeyframe Keyframe;
+  CarlaRecorderFrameIndex FrameIndex;
+  double NextKeyframeTime = 0.0;
+
   // replayer
   CarlaReplayer Replayer;
 
   // query tools
   CarlaRecorderQuery Query;
 
+  bool StartWithSink(std::unique_ptr<CarlaRecorderSink> Sink, FString MapName,
+      bool AdditionalData, const carla::rpc::RecorderFilter *InFilter);
+
   void AddExistingActors(void);
   void AddActorPosition(FCarlaActor *CarlaActor);
   void AddWalkerAnimation(FCarlaActor *CarlaActor);
@@ -233,4 +259,5 @@ private:
   void AddVehicleLight(FCarlaActor *CarlaActor);
   void AddActorKinematics(FCarlaActor *CarlaActor);
   void AddActorBoundingBox(FCarlaActor *CarlaActor);
+  void WriteKeyframe(std::streampos FrameOffset);
 };
@@ -0,0 +1,553 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "Carla.h"
+#include "CarlaRecorderFile.h"
+#include "CarlaRecorderHelpers.h"
+
+#include "Misc/Compression.h"
+#include "Misc/Crc.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <utility>
+
+// 每个数据块初始预留的大小，足够容纳大多数帧
+static constexpr size_t InitialBufferSize = 1024u * 1024u;
+
+// 压缩文件的格式：
+//   Magic
+//   每一块：解压后的大小 (uint32)、压缩后的大小 (uint32，0 表示没有压缩)、
+//           数据的 CRC32 (uint32)、数据
+//   块表：每一块的数据位置 (uint64)、解压后的大小、压缩后的大小
+//   块表的位置 (uint64)、块的数量 (uint32)、Magic
+// 没有块表（例如录制时崩溃）时按顺序扫描每一块，用 CRC32 排除不完整的块
+static constexpr char CompressedMagic[8] = {'C', 'A', 'R', 'L', 'A', 'Z', '0', '1'};
+
+// 压缩块解压后的大小，块越大压缩率越高，但跳转时需要解压的数据也越多
+static constexpr size_t CompressedBlockSize = 256u * 1024u;
+
+// 普通文件按这个大小分块读取
+static constexpr size_t PlainBlockSize = 64u * 1024u;
+
+static constexpr std::streamoff BlockHeaderSize = 3 * sizeof(uint32_t);
+static constexpr std::streamoff BlockTableEntrySize = sizeof(uint64_t) + 2 * sizeof(uint32_t);
+static constexpr std::streamoff FooterSize = sizeof(uint64_t) + sizeof(uint32_t) + sizeof(CompressedMagic);
+
+template <typename T>
+static void AppendValue(std::vector<char> &Buffer, const T &Value)
+{
+  const char *Begin = reinterpret_cast<const char *>(&Value);
+  Buffer.insert(Buffer.end(), Begin, Begin + sizeof(T));
+}
+
+CarlaRecorderFileBuffer::~CarlaRecorderFileBuffer()
+{
+  Close();
+}
+
+bool CarlaRecorderFileBuffer::Open(const std::string &Filename, bool bInCompress)
+{
+  Close();
+
+  auto FileSink = std::make_unique<CarlaRecorderFileSink>();
+  if (!FileSink->Open(Filename))
+  {
+    return false;
+  }
+  return Open(std::move(FileSink), bInCompress);
+}
+
+bool CarlaRecorderFileBuffer::Open(std::unique_ptr<CarlaRecorderSink> InSink, bool bInCompress)
+{
+  Close();
+
+  if (InSink == nullptr)
+  {
+    return false;
+  }
+  Sink = std::move(InSink);
+  Written = 0;
+
+  // Magic 在后台线程中写入，Sink 只在后台线程中使用
+  bCompress = bInCompress;
+  if (bCompress)
+  {
+    BlockData.clear();
+    BlockData.reserve(CompressedBlockSize + InitialBufferSize);
+    BlockTable.clear();
+    NumBlocks = 0;
+  }
+
+  Data.clear();
+  Data.reserve(InitialBufferSize);
+  Base = 0;
+  Cursor = 0;
+  bStop = false;
+  bFailed = false;
+  Thread = std::thread(&CarlaRecorderFileBuffer::Run, this);
+  return true;
+}
+
+void CarlaRecorderFileBuffer::Commit(std::streampos Position)
+{
+  const uint64_t End = static_cast<uint64_t>(Position);
+  if (!IsOpen() || End <= Base || End > Base + Data.size())
+  {
+    return;
+  }
+  const size_t Count = End - Base;
+
+  // 取一个空闲的数据块，只把未提交的尾部拷贝过去，然后交换，
+  // 这样整帧的数据不需要再拷贝一次
+  std::vector<char> Chunk;
+  {
+    std::lock_guard<std::mutex> Lock(Mutex);
+    if (!Free.empty())
+    {
+      Chunk = std::move(Free.back());
+      Free.pop_back();
+    }
+  }
+  if (Chunk.capacity() < InitialBufferSize)
+  {
+    Chunk.reserve(InitialBufferSize);
+  }
+  Chunk.assign(Data.begin() + Count, Data.end());
+  std::swap(Data, Chunk);
+  Chunk.resize(Count);
+
+  Base = End;
+  Cursor = Cursor > Count ? Cursor - Count : 0;
+
+  {
+    std::lock_guard<std::mutex> Lock(Mutex);
+    Pending.push_back(std::move(Chunk));
+  }
+  Condition.notify_one();
+}
+
+bool CarlaRecorderFileBuffer::Close()
+{
+  if (!IsOpen())
+  {
+    return true;
+  }
+
+  Commit(static_cast<std::streamoff>(Base + Data.size()));
+  {
+    std::lock_guard<std::mutex> Lock(Mutex);
+    bStop = true;
+  }
+  Condition.notify_one();
+  Thread.join();
+
+  Sink.reset();
+  Data.clear();
+  Base = 0;
+  Cursor = 0;
+  Free.clear();
+  return !bFailed;
+}
+
+void CarlaRecorderFileBuffer::Run()
+{
+  if (bCompress && !WriteToSink(CompressedMagic, sizeof(CompressedMagic)))
+  {
+    bFailed = true;
+  }
+
+  std::unique_lock<std::mutex> Lock(Mutex);
+  while (true)
+  {
+    Condition.wait(Lock, [this]() { return bStop || !Pending.empty(); });
+    if (Pending.empty())
+    {
+      // bStop 并且所有数据都已写入
+      break;
+    }
+
+    std::vector<char> Chunk = std::move(Pending.front());
+    Pending.pop_front();
+
+    // 写文件时不持有锁，游戏线程可以继续提交
+    Lock.unlock();
+    const bool bGood = WriteChunk(Chunk);
+    Chunk.clear();
+    Lock.lock();
+
+    bFailed = bFailed || !bGood;
+    Free.push_back(std::move(Chunk));
+  }
+
+  // 压缩模式下写入最后一块和块表
+  if (bCompress)
+  {
+    const bool bGood = WriteBlock() && WriteBlockTable();
+    bFailed = bFailed || !bGood;
+  }
+
+  const bool bClosed = Sink->Close();
+  bFailed = bFailed || !bClosed;
+}
+
+bool CarlaRecorderFileBuffer::WriteToSink(const char *InData, size_t Count)
+{
+  Written += Count;
+  return Sink->Write(InData, Count);
+}
+
+bool CarlaRecorderFileBuffer::WriteChunk(const std::vector<char> &Chunk)
+{
+  if (!bCompress)
+  {
+    return WriteToSink(Chunk.data(), Chunk.size());
+  }
+
+  BlockData.insert(BlockData.end(), Chunk.begin(), Chunk.end());
+  if (BlockData.size() < CompressedBlockSize)
+  {
+    return true;
+  }
+  return WriteBlock();
+}
+
+bool CarlaRecorderFileBuffer::WriteBlock()
+{
+  if (BlockData.empty())
+  {
+    return true;
+  }
+
+  const int32 Size = static_cast<int32>(BlockData.size());
+  int32 Compressed = FCompression::CompressMemoryBound(NAME_Zlib, Size);
+  CompressedData.resize(Compressed);
+  if (!FCompression::CompressMemory(NAME_Zlib, CompressedData.data(), Compressed, BlockData.data(), Size) ||
+      Compressed >= Size)
+  {
+    // 无法压缩的数据直接保存
+    Compressed = 0;
+  }
+
+  const char *Stored = Compressed > 0 ? CompressedData.data() : BlockData.data();
+  const int32 StoredSize = Compressed > 0 ? Compressed : Size;
+  const uint64_t Physical = Written + BlockHeaderSize;
+  std::vector<char> Header;
+  Header.reserve(BlockHeaderSize);
+  AppendValue<uint32_t>(Header, Size);
+  AppendValue<uint32_t>(Header, Compressed);
+  AppendValue<uint32_t>(Header, FCrc::MemCrc32(Stored, StoredSize));
+  const bool bGood = WriteToSink(Header.data(), Header.size()) && WriteToSink(Stored, StoredSize);
+  BlockData.clear();
+
+  // 记录到块表中，关闭文件时写入
+  AppendValue<uint64_t>(BlockTable, Physical);
+  AppendValue<uint32_t>(BlockTable, Size);
+  AppendValue<uint32_t>(BlockTable, Compressed);
+  ++NumBlocks;
+
+  return bGood;
+}
+
+bool CarlaRecorderFileBuffer::WriteBlockTable()
+{
+  const uint64_t TableOffset = Written;
+  AppendValue<uint64_t>(BlockTable, TableOffset);
+  AppendValue<uint32_t>(BlockTable, NumBlocks);
+  BlockTable.insert(BlockTable.end(), std::begin(CompressedMagic), std::end(CompressedMagic));
+  const bool bGood = WriteToSink(BlockTable.data(), BlockTable.size());
+  BlockTable.clear();
+  return bGood;
+}
+
+std::streamsize CarlaRecorderFileBuffer::xsputn(const char *InData, std::streamsize Count)
+{
+  const size_t End = Cursor + static_cast<size_t>(Count);
+  if (End > Data.size())
+  {
+    Data.resize(End);
+  }
+  std::memcpy(Data.data() + Cursor, InData, static_cast<size_t>(Count));
+  Cursor = End;
+  return Count;
+}
+
+CarlaRecorderFileBuffer::int_type CarlaRecorderFileBuffer::overflow(int_type Char)
+{
+  if (traits_type::eq_int_type(Char, traits_type::eof()))
+  {
+    return traits_type::not_eof(Char);
+  }
+  const char Value = traits_type::to_char_type(Char);
+  xsputn(&Value, 1);
+  return Char;
+}
+
+CarlaRecorderFileBuffer::pos_type CarlaRecorderFileBuffer::seekoff(
+    off_type Offset,
+    std::ios_base::seekdir Dir,
+    std::ios_base::openmode Mode)
+{
+  off_type Position = Offset;
+  if (Dir == std::ios_base::cur)
+  {
+    Position += static_cast<off_type>(Base + Cursor);
+  }
+  else if (Dir == std::ios_base::end)
+  {
+    Position += static_cast<off_type>(Base + Data.size());
+  }
+  return seekpos(pos_type(Position), Mode);
+}
+
+CarlaRecorderFileBuffer::pos_type CarlaRecorderFileBuffer::seekpos(
+    pos_type Position,
+    std::ios_base::openmode Mode)
+{
+  const off_type Target = static_cast<off_type>(Position);
+  // 已经提交的数据不能再修改
+  if (!(Mode & std::ios_base::out) ||
+      Target < static_cast<off_type>(Base) ||
+      Target > static_cast<off_type>(Base + Data.size()))
+  {
+    return pos_type(off_type(-1));
+  }
+  Cursor = static_cast<size_t>(Target - static_cast<off_type>(Base));
+  return Position;
+}
+
+bool CarlaRecorderFileReadBuffer::Open(const std::string &Filename)
+{
+  Close();
+
+  File.open(Filename, std::ios::binary);
+  if (!File.is_open())
+  {
+    return false;
+  }
+
+  File.seekg(0, std::ios::end);
+  const uint64_t FileSize = static_cast<uint64_t>(File.tellg());
+  File.seekg(0, std::ios::beg);
+
+  char Magic[sizeof(CompressedMagic)] = {0};
+  if (FileSize >= sizeof(CompressedMagic))
+  {
+    File.read(Magic, sizeof(Magic));
+  }
+  bCompressed = (std::memcmp(Magic, CompressedMagic, sizeof(Magic)) == 0);
+
+  if (bCompressed)
+  {
+    if (!ReadBlockTable(FileSize))
+    {
+      ScanBlocks(FileSize);
+    }
+  }
+  else
+  {
+    // 普通文件分成固定大小的块，每块都没有压缩
+    for (uint64_t Offset = 0; Offset < FileSize; Offset += PlainBlockSize)
+    {
+      const uint32_t Size = static_cast<uint32_t>(std::min<uint64_t>(PlainBlockSize, FileSize - Offset));
+      Blocks.push_back(Block{Offset, Offset, Size, 0});
+    }
+  }
+
+  TotalSize = Blocks.empty() ? 0 : Blocks.back().Logical + Blocks.back().Size;
+  File.clear();
+  return true;
+}
+
+void CarlaRecorderFileReadBuffer::Close()
+{
+  if (File.is_open())
+  {
+    File.close();
+  }
+  bCompressed = false;
+  Blocks.clear();
+  TotalSize = 0;
+  Current = NoBlock;
+  setg(nullptr, nullptr, nullptr);
+}
+
+bool CarlaRecorderFileReadBuffer::ReadBlockTable(uint64_t FileSize)
+{
+  if (FileSize < sizeof(CompressedMagic) + FooterSize)
+  {
+    return false;
+  }
+
+  uint64_t TableOffset = 0;
+  uint32_t Total = 0;
+  char Magic[sizeof(CompressedMagic)] = {0};
+  File.seekg(FileSize - FooterSize, std::ios::beg);
+  ReadValue<uint64_t>(File, TableOffset);
+  ReadValue<uint32_t>(File, Total);
+  File.read(Magic, sizeof(Magic));
+  if (!File ||
+      std::memcmp(Magic, CompressedMagic, sizeof(Magic)) != 0 ||
+      TableOffset + static_cast<uint64_t>(Total) * BlockTableEntrySize + FooterSize != FileSize)
+  {
+    File.clear();
+    return false;
+  }
+
+  File.seekg(TableOffset, std::ios::beg);
+  Blocks.resize(Total);
+  uint64_t Logical = 0;
+  for (auto &Item : Blocks)
+  {
+    Item.Logical = Logical;
+    ReadValue<uint64_t>(File, Item.Physical);
+    ReadValue<uint32_t>(File, Item.Size);
+    ReadValue<uint32_t>(File, Item.Compressed);
+    Logical += Item.Size;
+  }
+  if (!File)
+  {
+    Blocks.clear();
+    File.clear();
+    return false;
+  }
+  return true;
+}
+
+void CarlaRecorderFileReadBuffer::ScanBlocks(uint64_t FileSize)
+{
+  // 只保留完整的块，录制中断时最后一块可能不完整
+  uint64_t Physical = sizeof(CompressedMagic);
+  uint64_t Logical = 0;
+  File.clear();
+  while (Physical + BlockHeaderSize <= FileSize)
+  {
+    uint32_t Size = 0;
+    uint32_t Compressed = 0;
+    uint32_t Crc = 0;
+    File.seekg(Physical, std::ios::beg);
+    ReadValue<uint32_t>(File, Size);
+    ReadValue<uint32_t>(File, Compressed);
+    ReadValue<uint32_t>(File, Crc);
+    const uint64_t Stored = Compressed > 0 ? Compressed : Size;
+    if (!File || Size == 0 || Physical + BlockHeaderSize + Stored > FileSize)
+    {
+      break;
+    }
+    CompressedData.resize(Stored);
+    File.read(CompressedData.data(), Stored);
+    if (!File || FCrc::MemCrc32(CompressedData.data(), static_cast<int32>(Stored)) != Crc)
+    {
+      break;
+    }
+    Blocks.push_back(Block{Logical, Physical + BlockHeaderSize, Size, Compressed});
+    Logical += Size;
+    Physical += BlockHeaderSize + Stored;
+  }
+  File.clear();
+}
+
+bool CarlaRecorderFileReadBuffer::LoadBlock(size_t Index)
+{
+  if (Index >= Blocks.size())
+  {
+    return false;
+  }
+  if (Index != Current)
+  {
+    const Block &Item = Blocks[Index];
+    Data.resize(Item.Size);
+    File.clear();
+    File.seekg(Item.Physical, std::ios::beg);
+    if (Item.Compressed == 0)
+    {
+      File.read(Data.data(), Item.Size);
+    }
+    else
+    {
+      CompressedData.resize(Item.Compressed);
+      File.read(CompressedData.data(), Item.Compressed);
+      if (File && !FCompression::UncompressMemory(NAME_Zlib,
+          Data.data(), static_cast<int32>(Item.Size),
+          CompressedData.data(), static_cast<int32>(Item.Compressed)))
+      {
+        UE_LOG(LogCarla, Warning, TEXT("Recorder file has a corrupted block at %llu"), Item.Physical);
+        File.setstate(std::ios::failbit);
+      }
+    }
+    if (!File)
+    {
+      Current = NoBlock;
+      setg(nullptr, nullptr, nullptr);
+      return false;
+    }
+    Current = Index;
+  }
+  setg(Data.data(), Data.data(), Data.data() + Data.size());
+  return true;
+}
+
+CarlaRecorderFileReadBuffer::int_type CarlaRecorderFileReadBuffer::underflow()
+{
+  if (gptr() < egptr())
+  {
+    return traits_type::to_int_type(*gptr());
+  }
+  const size_t Next = (Current == NoBlock) ? 0 : Current + 1;
+  if (!LoadBlock(Next))
+  {
+    return traits_type::eof();
+  }
+  return traits_type::to_int_type(*gptr());
+}
+
+CarlaRecorderFileReadBuffer::pos_type CarlaRecorderFileReadBuffer::seekoff(
+    off_type Offset,
+    std::ios_base::seekdir Dir,
+    std::ios_base::openmode Mode)
+{
+  off_type Position = Offset;
+  if (Dir == std::ios_base::cur)
+  {
+    const uint64_t Start = (Current == NoBlock) ? 0 : Blocks[Current].Logical;
+    Position += static_cast<off_type>(Start + (gptr() - eback()));
+  }
+  else if (Dir == std::ios_base::end)
+  {
+    Position += static_cast<off_type>(TotalSize);
+  }
+  return seekpos(pos_type(Position), Mode);
+}
+
+CarlaRecorderFileReadBuffer::pos_type CarlaRecorderFileReadBuffer::seekpos(
+    pos_type Position,
+    std::ios_base::openmode Mode)
+{
+  const off_type Target = static_cast<off_type>(Position);
+  if (!(Mode & std::ios_base::in) || !File.is_open() ||
+      Target < 0 || Target > static_cast<off_type>(TotalSize))
+  {
+    return pos_type(off_type(-1));
+  }
+  if (Blocks.empty())
+  {
+    return Position;
+  }
+
+  // 找到包含 Target 的块，Target 等于文件大小时停在最后一块的末尾
+  auto It = std::upper_bound(Blocks.begin(), Blocks.end(), static_cast<uint64_t>(Target),
+      [](uint64_t Value, const Block &Item) {
+        return Value < Item.Logical;
+      });
+  const size_t Index = static_cast<size_t>(It - Blocks.begin()) - 1u;
+  if (!LoadBlock(Index))
+  {
+    return pos_type(off_type(-1));
+  }
+  setg(eback(), eback() + (static_cast<uint64_t>(Target) - Blocks[Index].Logical), egptr());
+  return Position;
+}
@@ -0,0 +1,229 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "CarlaRecorderSink.h"
+
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <streambuf>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 录制文件的缓冲区：写入只是拷贝到内存，提交的数据由后台线程整块交给
+// CarlaRecorderSink（本地文件或者网络流）。
+// 位置与文件中的位置一致，尚未提交的数据仍然可以通过 seekp 修改
+// （例如回填数据包的大小或上一帧的时长）。
+//
+// 压缩模式下后台线程把数据分成若干块，每块用 zlib 压缩后写入，文件末尾是块表。
+// 这里的位置是解压后的位置，读取时由 CarlaRecorderFileReadBuffer 透明地解压。
+class CarlaRecorderFileBuffer : public std::streambuf
+{
+public:
+
+  ~CarlaRecorderFileBuffer();
+
+  bool Open(const std::string &Filename, bool bCompress = false);
+
+  bool Open(std::unique_ptr<CarlaRecorderSink> InSink, bool bCompress = false);
+
+  bool IsOpen() const
+  {
+    return Thread.joinable();
+  }
+
+  // 把 Position 之前的数据交给后台线程，之后不能再修改
+  void Commit(std::streampos Position);
+
+  // 提交所有数据，等待写入完成并关闭 Sink；写入失败时返回 false
+  bool Close();
+
+protected:
+
+  std::streamsize xsputn(const char *InData, std::streamsize Count) override;
+
+  int_type overflow(int_type Char) override;
+
+  pos_type seekoff(off_type Offset, std::ios_base::seekdir Dir, std::ios_base::openmode Mode) override;
+
+  pos_type seekpos(pos_type Position, std::ios_base::openmode Mode) override;
+
+private:
+
+  void Run();
+
+  // 以下函数只在后台线程中调用
+  bool WriteChunk(const std::vector<char> &Chunk);
+  bool WriteBlock();
+  bool WriteBlockTable();
+  bool WriteToSink(const char *InData, size_t Count);
+
+  std::unique_ptr<CarlaRecorderSink> Sink;
+  // 已经交给 Sink 的字节数，即下一个字节在文件中的位置
+  uint64_t Written = 0;
+  bool bCompress = false;
+
+  // 压缩模式下尚未写入的块、压缩后的数据以及已经写入的块表
+  std::vector<char> BlockData;
+  std::vector<char> CompressedData;
+  std::vector<char> BlockTable;
+  uint32_t NumBlocks = 0;
+
+  // 尚未提交的数据，Data[0] 位于文件中的 Base 处
+  std::vector<char> Data;
+  uint64_t Base = 0;
+  size_t Cursor = 0;
+
+  std::thread Thread;
+  std::mutex Mutex;
+  std::condition_variable Condition;
+  // 等待写入的数据块，以及写完后可以重复使用的数据块
+  std::deque<std::vector<char>> Pending;
+  std::vector<std::vector<char>> Free;
+  bool bStop = false;
+  bool bFailed = false;
+};
+
+// 录制时代替 std::ofstream 的输出流
+class CarlaRecorderFile : public std::ostream
+{
+public:
+
+  CarlaRecorderFile() : std::ostream(nullptr)
+  {
+    rdbuf(&Buffer);
+  }
+
+  bool Open(const std::string &Filename, bool bCompress = false)
+  {
+    clear();
+    return Buffer.Open(Filename, bCompress);
+  }
+
+  bool Open(std::unique_ptr<CarlaRecorderSink> Sink, bool bCompress = false)
+  {
+    clear();
+    return Buffer.Open(std::move(Sink), bCompress);
+  }
+
+  bool IsOpen() const
+  {
+    return Buffer.IsOpen();
+  }
+
+  void Commit(std::streampos Position)
+  {
+    Buffer.Commit(Position);
+  }
+
+  bool Close()
+  {
+    return Buffer.Close();
+  }
+
+private:
+
+  CarlaRecorderFileBuffer Buffer;
+};
+
+// 读取录制文件的缓冲区，普通文件和压缩文件都以解压后的内容和位置呈现，
+// 所以回放器和查询工具不需要区分两种格式
+class CarlaRecorderFileReadBuffer : public std::streambuf
+{
+public:
+
+  bool Open(const std::string &Filename);
+
+  bool IsOpen() const
+  {
+    return File.is_open();
+  }
+
+  bool IsCompressed() const
+  {
+    return bCompressed;
+  }
+
+  void Close();
+
+protected:
+
+  int_type underflow() override;
+
+  pos_type seekoff(off_type Offset, std::ios_base::seekdir Dir, std::ios_base::openmode Mode) override;
+
+  pos_type seekpos(pos_type Position, std::ios_base::openmode Mode) override;
+
+private:
+
+  struct Block
+  {
+    uint64_t Logical;     // 解压后的位置
+    uint64_t Physical;    // 数据在文件中的位置
+    uint32_t Size;        // 解压后的大小
+    uint32_t Compressed;  // 压缩后的大小，0 表示没有压缩
+  };
+
+  bool ReadBlockTable(uint64_t FileSize);
+  void ScanBlocks(uint64_t FileSize);
+  bool LoadBlock(size_t Index);
+
+  static constexpr size_t NoBlock = static_cast<size_t>(-1);
+
+  std::ifstream File;
+  bool bCompressed = false;
+  std::vector<Block> Blocks;
+  uint64_t TotalSize = 0;
+  size_t Current = NoBlock;
+  std::vector<char> Data;
+  std::vector<char> CompressedData;
+};
+
+// 回放和查询时代替 std::ifstream 的输入流
+class CarlaRecorderInputFile : public std::istream
+{
+public:
+
+  CarlaRecorderInputFile() : std::istream(nullptr)
+  {
+    rdbuf(&Buffer);
+  }
+
+  bool Open(const std::string &Filename)
+  {
+    clear();
+    if (!Buffer.Open(Filename))
+    {
+      setstate(std::ios::failbit);
+      return false;
+    }
+    return true;
+  }
+
+  bool IsOpen() const
+  {
+    return Buffer.IsOpen();
+  }
+
+  bool IsCompressed() const
+  {
+    return Buffer.IsCompressed();
+  }
+
+  void Close()
+  {
+    Buffer.Close();
+  }
+
+private:
+
+  CarlaRecorderFileReadBuffer Buffer;
+};
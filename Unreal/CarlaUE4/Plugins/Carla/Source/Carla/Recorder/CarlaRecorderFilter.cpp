@@ -0,0 +1,89 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "Carla.h"
+#include "CarlaRecorderFilter.h"
+#include "Carla/Actor/CarlaActor.h"
+
+#include <compiler/disable-ue4-macros.h>
+#include <carla/rpc/String.h>
+#include <compiler/enable-ue4-macros.h>
+
+void CarlaRecorderFilter::Set(const carla::rpc::RecorderFilter &Filter)
+{
+  Clear();
+
+  bActorFilter = Filter.HasActorFilter();
+  for (const std::string &Pattern : Filter.actor_types)
+  {
+    TypePatterns.Emplace(carla::rpc::ToFString(Pattern));
+  }
+  ActorIds.insert(Filter.actor_ids.begin(), Filter.actor_ids.end());
+
+  bRegion = Filter.use_region;
+  if (bRegion)
+  {
+    // 位置和半尺寸从米转为厘米
+    RegionTransform = FTransform(
+        FRotator(Filter.region.rotation),
+        FVector(Filter.region.location));
+    RegionExtent = 1e2f * Filter.region.extent.ToFVector();
+  }
+
+  PacketMask = Filter.packet_mask;
+  bActive = !Filter.IsEmpty();
+}
+
+void CarlaRecorderFilter::Clear(void)
+{
+  bActive = false;
+  bActorFilter = false;
+  bRegion = false;
+  PacketMask = 0xFFFFFFFFu;
+  TypePatterns.Empty();
+  ActorIds.clear();
+  ExcludedActors.clear();
+}
+
+bool CarlaRecorderFilter::AddActor(uint32_t DatabaseId, const FString &TypeId)
+{
+  if (!bActorFilter || ActorIds.count(DatabaseId) > 0u)
+  {
+    return true;
+  }
+  for (const FString &Pattern : TypePatterns)
+  {
+    if (TypeId.MatchesWildcard(Pattern))
+    {
+      return true;
+    }
+  }
+  ExcludedActors.insert(DatabaseId);
+  return false;
+}
+
+void CarlaRecorderFilter::RemoveActor(uint32_t DatabaseId)
+{
+  ExcludedActors.erase(DatabaseId);
+}
+
+bool CarlaRecorderFilter::IsActorRecorded(const FCarlaActor &CarlaActor) const
+{
+  if (!IsActorIncluded(CarlaActor.GetActorId()))
+  {
+    return false;
+  }
+  if (!bRegion)
+  {
+    return true;
+  }
+  const FVector Local = RegionTransform.InverseTransformPosition(
+      CarlaActor.GetActorGlobalTransform().GetLocation());
+  return
+      FMath::Abs(Local.X) <= RegionExtent.X &&
+      FMath::Abs(Local.Y) <= RegionExtent.Y &&
+      FMath::Abs(Local.Z) <= RegionExtent.Z;
+}
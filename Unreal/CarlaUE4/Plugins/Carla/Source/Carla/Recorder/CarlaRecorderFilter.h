@@ -0,0 +1,65 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <compiler/disable-ue4-macros.h>
+#include <carla/rpc/RecorderFilter.h>
+#include <compiler/enable-ue4-macros.h>
+
+#include <unordered_set>
+
+class FCarlaActor;
+
+// 录制过滤器：开始录制时设置，决定哪些 actor 和数据包写入文件。
+// actor 是否被选中只在它生成时按类型和 id 判断一次，区域则每帧判断
+class CarlaRecorderFilter
+{
+public:
+
+  void Set(const carla::rpc::RecorderFilter &Filter);
+
+  void Clear(void);
+
+  bool IsActive(void) const
+  {
+    return bActive;
+  }
+
+  bool IsPacketEnabled(carla::rpc::RecorderPacket Packet) const
+  {
+    return (PacketMask & (1u << static_cast<uint8_t>(Packet))) != 0u;
+  }
+
+  // actor 生成时调用，返回是否录制它
+  bool AddActor(uint32_t DatabaseId, const FString &TypeId);
+
+  void RemoveActor(uint32_t DatabaseId);
+
+  // actor 是否被选中（不考虑区域），用于事件
+  bool IsActorIncluded(uint32_t DatabaseId) const
+  {
+    return ExcludedActors.count(DatabaseId) == 0u;
+  }
+
+  // actor 这一帧的数据是否录制：被选中并且位于区域内
+  bool IsActorRecorded(const FCarlaActor &CarlaActor) const;
+
+private:
+
+  bool bActive = false;
+  bool bActorFilter = false;
+  bool bRegion = false;
+  uint32_t PacketMask = 0xFFFFFFFFu;
+
+  TArray<FString> TypePatterns;
+  std::unordered_set<uint32_t> ActorIds;
+  std::unordered_set<uint32_t> ExcludedActors;
+
+  // 区域的中心和朝向，以及半尺寸（厘米）
+  FTransform RegionTransform;
+  FVector RegionExtent;
+};
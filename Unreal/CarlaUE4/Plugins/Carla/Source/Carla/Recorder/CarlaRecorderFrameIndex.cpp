@@ -0,0 +1,194 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "CarlaRecorder.h"
+#include "CarlaRecorderFrameIndex.h"
+#include "CarlaRecorderHelpers.h"
+
+#include <algorithm>
+
+void CarlaRecorderKeyframe::Add(const CarlaRecorderEventAdd &Actor)
+{
+  Actors.push_back(Actor);
+}
+
+void CarlaRecorderKeyframe::Add(const CarlaRecorderEventParent &Parent)
+{
+  Parents.push_back(Parent);
+}
+
+void CarlaRecorderKeyframe::Clear(void)
+{
+  Actors.clear();
+  Parents.clear();
+}
+
+void CarlaRecorderKeyframe::Write(std::ostream &OutFile)
+{
+  // write the packet id
+  WriteValue<char>(OutFile, static_cast<char>(CarlaRecorderPacketId::Keyframe));
+
+  std::streampos PosStart = OutFile.tellp();
+
+  // write a dummy packet size
+  uint32_t Total = 0;
+  WriteValue<uint32_t>(OutFile, Total);
+
+  // 关键帧中的 actor 数量可能超过一帧的事件数量，这里使用 32 位计数
+  Total = Actors.size();
+  WriteValue<uint32_t>(OutFile, Total);
+  for (const auto &Actor : Actors)
+  {
+    Actor.Write(OutFile);
+  }
+
+  Total = Parents.size();
+  WriteValue<uint32_t>(OutFile, Total);
+  for (const auto &Parent : Parents)
+  {
+    Parent.Write(OutFile);
+  }
+
+  // write the real packet size
+  std::streampos PosEnd = OutFile.tellp();
+  Total = PosEnd - PosStart - sizeof(uint32_t);
+  OutFile.seekp(PosStart, std::ios::beg);
+  WriteValue<uint32_t>(OutFile, Total);
+  OutFile.seekp(PosEnd, std::ios::beg);
+}
+
+void CarlaRecorderKeyframe::Read(std::istream &InFile)
+{
+  uint32_t i, Total;
+
+  Clear();
+
+  ReadValue<uint32_t>(InFile, Total);
+  Actors.resize(Total);
+  for (i = 0; i < Total; ++i)
+  {
+    Actors[i].Read(InFile);
+  }
+
+  ReadValue<uint32_t>(InFile, Total);
+  Parents.resize(Total);
+  for (i = 0; i < Total; ++i)
+  {
+    Parents[i].Read(InFile);
+  }
+}
+
+void CarlaRecorderFrameIndex::Clear(void)
+{
+  Entries.clear();
+  TotalTime = 0.0;
+  bValid = false;
+}
+
+void CarlaRecorderFrameIndex::Add(double Elapsed, std::streampos Offset)
+{
+  Entries.push_back(CarlaRecorderFrameIndexEntry{Elapsed, static_cast<uint64_t>(Offset)});
+}
+
+void CarlaRecorderFrameIndex::Write(std::ostream &OutFile)
+{
+  uint64_t IndexOffset = static_cast<uint64_t>(OutFile.tellp());
+
+  // 索引数据包：总时长、关键帧数量以及每个关键帧的位置
+  WriteValue<char>(OutFile, static_cast<char>(CarlaRecorderPacketId::FrameIndex));
+  uint32_t Total = Entries.size();
+  uint32_t Size = sizeof(double) + sizeof(uint32_t) + Total * sizeof(CarlaRecorderFrameIndexEntry);
+  WriteValue<uint32_t>(OutFile, Size);
+  WriteValue<double>(OutFile, TotalTime);
+  WriteValue<uint32_t>(OutFile, Total);
+  for (const auto &Entry : Entries)
+  {
+    WriteValue<CarlaRecorderFrameIndexEntry>(OutFile, Entry);
+  }
+
+  // 文件的最后一个数据包，指向索引数据包
+  WriteValue<char>(OutFile, static_cast<char>(CarlaRecorderPacketId::FrameIndexOffset));
+  WriteValue<uint32_t>(OutFile, sizeof(uint64_t));
+  WriteValue<uint64_t>(OutFile, IndexOffset);
+}
+
+bool CarlaRecorderFrameIndex::Read(std::istream &InFile)
+{
+  const std::streamoff FooterSize = sizeof(char) + sizeof(uint32_t) + sizeof(uint64_t);
+  const std::streamoff HeaderSize = sizeof(char) + sizeof(uint32_t);
+
+  Clear();
+
+  std::streampos Current = InFile.tellg();
+  InFile.clear();
+  InFile.seekg(0, std::ios::end);
+  std::streamoff End = InFile.tellg();
+
+  if (End >= FooterSize)
+  {
+    char Id = 0;
+    uint32_t Size = 0;
+    uint64_t IndexOffset = 0;
+
+    // 检查最后一个数据包是否指向帧索引
+    InFile.seekg(-FooterSize, std::ios::end);
+    ReadValue<char>(InFile, Id);
+    ReadValue<uint32_t>(InFile, Size);
+    ReadValue<uint64_t>(InFile, IndexOffset);
+
+    if (InFile &&
+        Id == static_cast<char>(CarlaRecorderPacketId::FrameIndexOffset) &&
+        Size == sizeof(uint64_t) &&
+        static_cast<std::streamoff>(IndexOffset) + HeaderSize <= End - FooterSize)
+    {
+      InFile.seekg(IndexOffset, std::ios::beg);
+      ReadValue<char>(InFile, Id);
+      ReadValue<uint32_t>(InFile, Size);
+
+      if (Id == static_cast<char>(CarlaRecorderPacketId::FrameIndex))
+      {
+        uint32_t Total = 0;
+        ReadValue<double>(InFile, TotalTime);
+        ReadValue<uint32_t>(InFile, Total);
+
+        // 数据包大小必须与关键帧数量一致，否则认为文件已损坏
+        if (InFile && Size == sizeof(double) + sizeof(uint32_t) +
+            static_cast<uint64_t>(Total) * sizeof(CarlaRecorderFrameIndexEntry))
+        {
+          Entries.resize(Total);
+          for (auto &Entry : Entries)
+          {
+            ReadValue<CarlaRecorderFrameIndexEntry>(InFile, Entry);
+          }
+          bValid = static_cast<bool>(InFile);
+        }
+      }
+    }
+  }
+
+  if (!bValid)
+  {
+    Clear();
+  }
+
+  InFile.clear();
+  InFile.seekg(Current, std::ios::beg);
+  return bValid;
+}
+
+const CarlaRecorderFrameIndexEntry *CarlaRecorderFrameIndex::FindKeyframe(double Time) const
+{
+  // 关键帧按时间顺序写入，二分查找第一个晚于 Time 的关键帧
+  auto It = std::upper_bound(Entries.begin(), Entries.end(), Time,
+      [](double Value, const CarlaRecorderFrameIndexEntry &Entry) {
+        return Value < Entry.Elapsed;
+      });
+  if (It == Entries.begin())
+  {
+    return nullptr;
+  }
+  return &*(It - 1);
+}
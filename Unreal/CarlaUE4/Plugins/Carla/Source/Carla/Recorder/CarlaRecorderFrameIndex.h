@@ -0,0 +1,100 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "CarlaRecorderEventAdd.h"
+#include "CarlaRecorderEventParent.h"
+
+#include <sstream>
+#include <vector>
+
+// 关键帧：写入关键帧时仍然存在的所有 actor 以及它们的父子关系。
+// 回放器从文件中间开始时用它代替之前所有的 add/del/parent 事件
+class CarlaRecorderKeyframe
+{
+public:
+
+  void Add(const CarlaRecorderEventAdd &Actor);
+
+  void Add(const CarlaRecorderEventParent &Parent);
+
+  void Clear(void);
+
+  void Write(std::ostream &OutFile);
+
+  void Read(std::istream &InFile);
+
+  const std::vector<CarlaRecorderEventAdd> &GetActors() const
+  {
+    return Actors;
+  }
+
+  const std::vector<CarlaRecorderEventParent> &GetParents() const
+  {
+    return Parents;
+  }
+
+private:
+
+  std::vector<CarlaRecorderEventAdd> Actors;
+  std::vector<CarlaRecorderEventParent> Parents;
+};
+
+#pragma pack(push, 1)
+struct CarlaRecorderFrameIndexEntry
+{
+  double Elapsed;     // 含有关键帧的那一帧的开始时间
+  uint64_t Offset;    // 这一帧的 FrameStart 数据包在文件中的位置
+};
+#pragma pack(pop)
+
+// 文件末尾的帧索引。
+// 索引数据包之后是一个固定大小的 FrameIndexOffset 数据包，记录索引数据包的位置，
+// 所以读取时只需要查看文件最后几个字节；旧版本的回放器会把两者当作未知数据包跳过
+class CarlaRecorderFrameIndex
+{
+public:
+
+  void Clear(void);
+
+  void Add(double Elapsed, std::streampos Offset);
+
+  void SetTotalTime(double Time)
+  {
+    TotalTime = Time;
+  }
+
+  // 写入索引数据包和 FrameIndexOffset 数据包，应该在文件的最后调用
+  void Write(std::ostream &OutFile);
+
+  // 从文件末尾读取索引，文件中没有索引时返回 false；不改变文件的读取位置
+  bool Read(std::istream &InFile);
+
+  bool IsValid() const
+  {
+    return bValid;
+  }
+
+  double GetTotalTime() const
+  {
+    return TotalTime;
+  }
+
+  // 开始时间不晚于 Time 的最后一个关键帧，没有时返回 nullptr
+  const CarlaRecorderFrameIndexEntry *FindKeyframe(double Time) const;
+
+  const std::vector<CarlaRecorderFrameIndexEntry> &GetEntries() const
+  {
+    return Entries;
+  }
+
+private:
+
+  std::vector<CarlaRecorderFrameIndexEntry> Entries;
+  double TotalTime = 0.0;
+  bool bValid = false;
+};
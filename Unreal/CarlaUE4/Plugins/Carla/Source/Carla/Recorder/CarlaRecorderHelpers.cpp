@@ -43,7 +43,7 @@ void WriteFVector(std::ostream &OutFile, const FVector &InObj)
 }
 
 // 将FTransform中的二进制数据写出
-void WriteFTransform(std::ofstream &OutFile, const FTransform &InObj)
+void WriteFTransform(std::ostream &OutFile, const FTransform &InObj)
 {
   WriteFVector(OutFile, InObj.GetTranslation());
   WriteFVector(OutFile, InObj.GetRotation().Euler());
@@ -73,7 +73,7 @@ void ReadFVector(std::istream &InFile, FVector &OutObj)
 }
 
 // 从二进制数据中读取到 FVector
-void ReadFTransform(std::ifstream &InFile, FTransform &OutObj)
+void ReadFTransform(std::istream &InFile, FTransform &OutObj)
 {
   FVector Vec;
   ReadFVector(InFile, Vec);
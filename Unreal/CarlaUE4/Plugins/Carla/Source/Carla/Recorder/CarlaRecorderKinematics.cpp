@@ -29,6 +29,11 @@ void CarlaRecorderActorsKinematics::Clear(void)
   Kinematics.clear();
 }
 
+const std::vector<CarlaRecorderKinematics>& CarlaRecorderActorsKinematics::GetKinematics()
+{
+  return Kinematics;
+}
+
 void CarlaRecorderActorsKinematics::Add(const CarlaRecorderKinematics &InObj)
 {
   Kinematics.push_back(InObj);
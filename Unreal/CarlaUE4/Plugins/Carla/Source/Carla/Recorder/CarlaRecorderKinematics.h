@@ -54,6 +54,8 @@ public:
     // 会调用每个CarlaRecorderKinematics对象的Write函数来完成具体的写入操作，确保数据能正确保存。
     void Write(std::ostream &OutFile);  
 
+    const std::vector<CarlaRecorderKinematics>& GetKinematics();
+
 private:
     // 使用vector容器来存储CarlaRecorderKinematics类型的结构体对象，
     // 这个容器就是用来管理所有相关的运动学数据信息的，类中的各个成员函数会对其进行相应的操作，
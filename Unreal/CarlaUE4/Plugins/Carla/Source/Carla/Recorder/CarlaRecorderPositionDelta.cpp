@@ -0,0 +1,182 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "CarlaRecorder.h"
+#include "CarlaRecorderPositionDelta.h"
+#include "CarlaRecorderHelpers.h"
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+// 厘米到毫米
+static constexpr float LocationScale = 10.0f;
+// 度到 1/65536 圈
+static constexpr float RotationScale = 65536.0f / 360.0f;
+
+static bool FitsInt16(int32_t Value)
+{
+  return Value >= std::numeric_limits<int16_t>::min() &&
+         Value <= std::numeric_limits<int16_t>::max();
+}
+
+CarlaRecorderPositionDelta::FQuantized CarlaRecorderPositionDelta::Quantize(
+    const CarlaRecorderPosition &Position)
+{
+  FQuantized Result;
+  const float Location[3] = {Position.Location.X, Position.Location.Y, Position.Location.Z};
+  const float Rotation[3] = {Position.Rotation.X, Position.Rotation.Y, Position.Rotation.Z};
+  for (int i = 0; i < 3; ++i)
+  {
+    Result.Location[i] = static_cast<int32_t>(std::lround(Location[i] * LocationScale));
+    // 超出 int16 的部分正好是整圈，截断即可
+    Result.Rotation[i] = static_cast<int16_t>(
+        static_cast<uint16_t>(std::lround(Rotation[i] * RotationScale)));
+  }
+  return Result;
+}
+
+CarlaRecorderPosition CarlaRecorderPositionDelta::Dequantize(
+    uint32_t DatabaseId,
+    const FQuantized &Value)
+{
+  CarlaRecorderPosition Position;
+  Position.DatabaseId = DatabaseId;
+  Position.Location = FVector(
+      Value.Location[0] / LocationScale,
+      Value.Location[1] / LocationScale,
+      Value.Location[2] / LocationScale);
+  Position.Rotation = FVector(
+      Value.Rotation[0] / RotationScale,
+      Value.Rotation[1] / RotationScale,
+      Value.Rotation[2] / RotationScale);
+  return Position;
+}
+
+void CarlaRecorderPositionDelta::Reset(void)
+{
+  Baseline.clear();
+}
+
+void CarlaRecorderPositionDelta::Remove(uint32_t DatabaseId)
+{
+  Baseline.erase(DatabaseId);
+}
+
+void CarlaRecorderPositionDelta::Write(
+    std::ostream &OutFile,
+    const std::vector<CarlaRecorderPosition> &Positions)
+{
+  // write the packet id
+  WriteValue<char>(OutFile, static_cast<char>(CarlaRecorderPacketId::PositionDelta));
+  std::streampos PosStart = OutFile.tellp();
+
+  // write a dummy packet size and total records
+  uint32_t Total = 0;
+  WriteValue<uint32_t>(OutFile, Total);
+  uint16_t Records = 0;
+  WriteValue<uint16_t>(OutFile, Records);
+
+  for (const CarlaRecorderPosition &Position : Positions)
+  {
+    const FQuantized Current = Quantize(Position);
+    uint8_t Flags = 0u;
+    int32_t Delta[3] = {0, 0, 0};
+    auto It = Baseline.find(Position.DatabaseId);
+    if (It == Baseline.end())
+    {
+      Flags = FullLocation | NewRotation;
+    }
+    else
+    {
+      bool bMoved = false;
+      bool bSmall = true;
+      for (int i = 0; i < 3; ++i)
+      {
+        Delta[i] = Current.Location[i] - It->second.Location[i];
+        bMoved = bMoved || (Delta[i] != 0);
+        bSmall = bSmall && FitsInt16(Delta[i]);
+      }
+      if (bMoved)
+      {
+        Flags |= bSmall ? DeltaLocation : FullLocation;
+      }
+      if (std::memcmp(Current.Rotation, It->second.Rotation, sizeof(Current.Rotation)) != 0)
+      {
+        Flags |= NewRotation;
+      }
+    }
+
+    // 没有变化的 actor 在副服务器上保持上一次的位置
+    if (Flags == 0u)
+    {
+      continue;
+    }
+
+    WriteValue<uint32_t>(OutFile, Position.DatabaseId);
+    WriteValue<uint8_t>(OutFile, Flags);
+    if (Flags & FullLocation)
+    {
+      for (int i = 0; i < 3; ++i)
+        WriteValue<int32_t>(OutFile, Current.Location[i]);
+    }
+    else if (Flags & DeltaLocation)
+    {
+      for (int i = 0; i < 3; ++i)
+        WriteValue<int16_t>(OutFile, static_cast<int16_t>(Delta[i]));
+    }
+    if (Flags & NewRotation)
+    {
+      for (int i = 0; i < 3; ++i)
+        WriteValue<int16_t>(OutFile, Current.Rotation[i]);
+    }
+    Baseline[Position.DatabaseId] = Current;
+    ++Records;
+  }
+
+  // write the real packet size and total records
+  std::streampos PosEnd = OutFile.tellp();
+  Total = PosEnd - PosStart - sizeof(uint32_t);
+  OutFile.seekp(PosStart, std::ios::beg);
+  WriteValue<uint32_t>(OutFile, Total);
+  WriteValue<uint16_t>(OutFile, Records);
+  OutFile.seekp(PosEnd, std::ios::beg);
+}
+
+void CarlaRecorderPositionDelta::Read(std::istream &InFile, CarlaRecorderPositions &Positions)
+{
+  uint16_t Total;
+  ReadValue<uint16_t>(InFile, Total);
+  for (uint16_t i = 0; i < Total; ++i)
+  {
+    uint32_t DatabaseId;
+    uint8_t Flags;
+    ReadValue<uint32_t>(InFile, DatabaseId);
+    ReadValue<uint8_t>(InFile, Flags);
+
+    FQuantized &Value = Baseline[DatabaseId];
+    if (Flags & FullLocation)
+    {
+      for (int j = 0; j < 3; ++j)
+        ReadValue<int32_t>(InFile, Value.Location[j]);
+    }
+    else if (Flags & DeltaLocation)
+    {
+      for (int j = 0; j < 3; ++j)
+      {
+        int16_t Delta;
+        ReadValue<int16_t>(InFile, Delta);
+        Value.Location[j] += Delta;
+      }
+    }
+    if (Flags & NewRotation)
+    {
+      for (int j = 0; j < 3; ++j)
+        ReadValue<int16_t>(InFile, Value.Rotation[j]);
+    }
+    Positions.Add(Dequantize(DatabaseId, Value));
+  }
+}
@@ -0,0 +1,56 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "CarlaRecorderPosition.h"
+
+#include <sstream>
+#include <unordered_map>
+#include <vector>
+
+// 多 GPU 模式下代替 Position 数据包发送给副服务器的位置。
+// 位置量化为毫米，旋转量化为 1/65536 圈；只写入量化后发生变化的 actor，
+// 位置的变化在 int16 范围内时只写入差值。
+// 编码和解码两端保存相同的量化值作为基准，所以误差不会累积。
+// 记录格式：uint32 id、uint8 标志，然后按标志依次是
+// 完整位置 (int32 x 3) 或位置差值 (int16 x 3)，以及旋转 (int16 x 3)
+class CarlaRecorderPositionDelta
+{
+public:
+
+  // 清空基准，下一次写入时发送所有 actor 的完整位置
+  void Reset(void);
+
+  // 删除 actor 的基准，两端都应该在处理完这一帧的位置后调用
+  void Remove(uint32_t DatabaseId);
+
+  void Write(std::ostream &OutFile, const std::vector<CarlaRecorderPosition> &Positions);
+
+  // 解码后的位置加入 Positions，与读取 Position 数据包的结果相同
+  void Read(std::istream &InFile, CarlaRecorderPositions &Positions);
+
+private:
+
+  enum : uint8_t
+  {
+    FullLocation  = 1u << 0,
+    DeltaLocation = 1u << 1,
+    NewRotation   = 1u << 2
+  };
+
+  struct FQuantized
+  {
+    int32_t Location[3];
+    int16_t Rotation[3];
+  };
+
+  static FQuantized Quantize(const CarlaRecorderPosition &Position);
+
+  static CarlaRecorderPosition Dequantize(uint32_t DatabaseId, const FQuantized &Value);
+
+  std::unordered_map<uint32_t, FQuantized> Baseline;
+};
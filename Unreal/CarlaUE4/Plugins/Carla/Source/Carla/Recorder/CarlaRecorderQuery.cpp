@@ -10,9 +10,15 @@
 
 #include "CarlaRecorder.h"
 
+#include "Runtime/Core/Public/Async/ParallelFor.h"
+
+#include <algorithm>
 #include <ctime>
+#include <limits>
 #include <sstream>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
 
 #include <compiler/disable-ue4-macros.h>
 #include <carla/rpc/VehicleLightState.h>
@@ -52,14 +58,23 @@ inline bool CarlaRecorderQuery::CheckFileInfo(std::stringstream &Info)
   }
 
   // show general Info
+  PrintFileInfo(Info, RecInfo, File.IsCompressed());
+
+  return true;
+}
+
+void CarlaRecorderQuery::PrintFileInfo(std::stringstream &Info, const CarlaRecorderInfo &RecInfo, bool bCompressed)
+{
   Info << "Version: " << RecInfo.Version << std::endl;
+  if (bCompressed)
+  {
+    Info << "Compressed: zlib blocks" << std::endl;
+  }
   Info << "Map: " << TCHAR_TO_UTF8(*RecInfo.Mapfile) << std::endl;
   tm *TimeInfo = localtime(&RecInfo.Date);
   char DateStr[100];
   strftime(DateStr, sizeof(DateStr), "%x %X", TimeInfo);
   Info << "Date: " << DateStr << std::endl << std::endl;
-
-  return true;
 }
 
 std::string CarlaRecorderQuery::QueryInfo(std::string Filename, bool bShowAll)
@@ -70,8 +85,8 @@ std::string CarlaRecorderQuery::QueryInfo(std::string Filename, bool bShowAll)
   std::string Filename2 = GetRecorderFilename(Filename);
 
   // try to open
-  File.open(Filename2, std::ios::binary);
-  if (!File.is_open())
+  File.Open(Filename2);
+  if (!File.IsOpen())
   {
     Info << "File " << Filename2 << " not found on server\n";
     return Info.str();
@@ -633,41 +648,27 @@ std::string CarlaRecorderQuery::QueryInfo(std::string Filename, bool bShowAll)
   Info << "\nFrames: " << Frame.Id << "\n";
   Info << "Duration: " << Frame.Elapsed << " seconds\n";
 
-  File.close();
+  File.Close();
 
   return Info.str();
 }
 
-std::string CarlaRecorderQuery::QueryCollisions(std::string Filename, char Category1, char Category2)
-{
-  std::stringstream Info;
 
-  // get the final path + filename
-  std::string Filename2 = GetRecorderFilename(Filename);
+namespace CarlaRecorderQuery_local_ns {
 
-  // try to open
-  File.open(Filename2, std::ios::binary);
-  if (!File.is_open())
+  #pragma pack(push, 1)
+  struct PacketHeader
   {
-    Info << "File " << Filename2 << " not found on server\n";
-    return Info.str();
-  }
+    char Id;
+    uint32_t Size;
+  };
+  #pragma pack(pop)
 
-  if (!CheckFileInfo(Info))
-    return Info.str();
+  using ActorPair = std::pair<uint32_t, uint32_t>;
 
-  // other, vehicle, walkers, trafficLight, hero, any
-  char Categories[] = { 'o', 'v', 'w', 't', 'h', 'a' };
-  uint16_t i, Total;
-  struct ReplayerActorInfo
-  {
-    uint8_t Type;
-    FString Id;
-  };
-  std::unordered_map<uint32_t, ReplayerActorInfo> Actors;
   struct PairHash
   {
-    std::size_t operator()(const std::pair<uint32_t, uint32_t>& P) const
+    std::size_t operator()(const ActorPair& P) const
     {
         std::size_t hash = P.first;
         hash <<= 32;
@@ -675,168 +676,307 @@ std::string CarlaRecorderQuery::QueryCollisions(std::string Filename, char Categ
         return hash;
     }
   };
-  std::unordered_set<std::pair<uint32_t, uint32_t>, PairHash > oldCollisions, newCollisions;
 
-  // header
-  Info << std::setw(8) << "Time";
-  Info << " " << std::setw(6) << "Types";
-  Info << " " << std::setw(6) << std::right << "Id";
-  Info << " " << std::setw(35) << std::left << "Actor 1";
-  Info << " " << std::setw(6) << std::right << "Id";
-  Info << " " << std::setw(35) << std::left << "Actor 2";
-  Info << std::endl;
+  using CollisionSet = std::unordered_set<ActorPair, PairHash>;
 
-  // parse only frames
-  while (File)
+  struct ActorInfo
   {
+    uint8_t Type;
+    FString Id;
+  };
 
-    // get header
-    if (!ReadHeader())
+  // 文件中一段（从一个关键帧到下一个关键帧）的碰撞
+  struct CollisionSegment
+  {
+    std::vector<CarlaRecorderQueryCollision> Items;
+    // 每条结果是否来自这一段的第一帧
+    std::vector<bool> InFirstFrame;
+    // 这一段最后一帧中的碰撞，用来判断下一段第一帧的碰撞是否是新的
+    CollisionSet LastFrame;
+    CarlaRecorderFrame Frame { 0u, 0.0, 0.0 };
+  };
+
+  // 打开文件并检查开始信息，成功时读取位置在开始信息之后
+  static bool OpenRecorderFile(
+      const std::string &Filename,
+      CarlaRecorderInputFile &File,
+      CarlaRecorderInfo &RecInfo,
+      std::string &Error)
+  {
+    File.Open(Filename);
+    if (!File.IsOpen())
     {
-      break;
+      Error = "File " + Filename + " not found on server\n";
+      return false;
+    }
+    RecInfo.Read(File);
+    if (RecInfo.Magic != "CARLA_RECORDER")
+    {
+      Error = "File is not a CARLA recorder\n";
+      return false;
     }
+    return true;
+  }
 
-    // check for a frame packet
-    switch (Header.Id)
+  // 查询 [Begin, End) 之间的碰撞。从关键帧开始时，actor 信息取自关键帧，
+  // 关键帧之前同一帧中的事件已经包含在关键帧中
+  static void ScanCollisions(
+      const std::string &Filename,
+      uint64_t Begin,
+      uint64_t End,
+      bool bFromKeyframe,
+      char Category1,
+      char Category2,
+      CollisionSegment &Segment)
+  {
+    // other, vehicle, walkers, trafficLight, hero, any
+    static const char Categories[] = { 'o', 'v', 'w', 't', 'h', 'a' };
+
+    CarlaRecorderInputFile File;
+    if (!File.Open(Filename))
     {
-      // frame
-      case static_cast<char>(CarlaRecorderPacketId::FrameStart):
-        Frame.Read(File);
-        // exchange sets of collisions (to know when a collision is new or continue from previous frame)
-        oldCollisions = std::move(newCollisions);
-        newCollisions.clear();
+      return;
+    }
+    File.seekg(Begin, std::ios::beg);
+
+    std::unordered_map<uint32_t, ActorInfo> Actors;
+    CollisionSet OldCollisions, NewCollisions;
+    PacketHeader Header;
+    CarlaRecorderEventAdd EventAdd;
+    CarlaRecorderEventDel EventDel;
+    CarlaRecorderCollision Collision;
+    CarlaRecorderKeyframe Keyframe;
+    bool bWaitKeyframe = bFromKeyframe;
+    uint64_t NumFrames = 0;
+    uint16_t i, Total;
+
+    while (File && static_cast<uint64_t>(File.tellg()) < End)
+    {
+      // get header
+      ReadValue<char>(File, Header.Id);
+      ReadValue<uint32_t>(File, Header.Size);
+      if (!File)
+      {
         break;
+      }
+
+      switch (Header.Id)
+      {
+        // frame
+        case static_cast<char>(CarlaRecorderPacketId::FrameStart):
+          Segment.Frame.Read(File);
+          ++NumFrames;
+          // exchange sets of collisions (to know when a collision is new or continue from previous frame)
+          OldCollisions = std::move(NewCollisions);
+          NewCollisions.clear();
+          break;
+
+        // events add
+        case static_cast<char>(CarlaRecorderPacketId::EventAdd):
+          if (bWaitKeyframe)
+          {
+            File.seekg(Header.Size, std::ios::cur);
+            break;
+          }
+          ReadValue<uint16_t>(File, Total);
+          for (i = 0; i < Total; ++i)
+          {
+            EventAdd.Read(File);
+            Actors[EventAdd.DatabaseId] = ActorInfo { EventAdd.Type, EventAdd.Description.Id };
+          }
+          break;
 
-      // events add
-      case static_cast<char>(CarlaRecorderPacketId::EventAdd):
-        ReadValue<uint16_t>(File, Total);
-        for (i = 0; i < Total; ++i)
-        {
-          // add
-          EventAdd.Read(File);
-          Actors[EventAdd.DatabaseId] = ReplayerActorInfo { EventAdd.Type, EventAdd.Description.Id };
-        }
-        break;
+        // events del
+        case static_cast<char>(CarlaRecorderPacketId::EventDel):
+          if (bWaitKeyframe)
+          {
+            File.seekg(Header.Size, std::ios::cur);
+            break;
+          }
+          ReadValue<uint16_t>(File, Total);
+          for (i = 0; i < Total; ++i)
+          {
+            EventDel.Read(File);
+            Actors.erase(EventDel.DatabaseId);
+          }
+          break;
 
-      // events del
-      case static_cast<char>(CarlaRecorderPacketId::EventDel):
-        ReadValue<uint16_t>(File, Total);
-        for (i = 0; i < Total; ++i)
-        {
-          EventDel.Read(File);
-          Actors.erase(EventAdd.DatabaseId);
-        }
-        break;
+        // all the actors alive at the keyframe
+        case static_cast<char>(CarlaRecorderPacketId::Keyframe):
+          if (!bWaitKeyframe)
+          {
+            File.seekg(Header.Size, std::ios::cur);
+            break;
+          }
+          Keyframe.Read(File);
+          for (const auto &Actor : Keyframe.GetActors())
+          {
+            Actors[Actor.DatabaseId] = ActorInfo { Actor.Type, Actor.Description.Id };
+          }
+          bWaitKeyframe = false;
+          break;
 
-      // events parenting
-      case static_cast<char>(CarlaRecorderPacketId::EventParent):
-        SkipPacket();
-        break;
+        // collisions
+        case static_cast<char>(CarlaRecorderPacketId::Collision):
+          ReadValue<uint16_t>(File, Total);
+          for (i = 0; i < Total; ++i)
+          {
+            Collision.Read(File);
 
-      // collisions
-      case static_cast<char>(CarlaRecorderPacketId::Collision):
-        ReadValue<uint16_t>(File, Total);
-        for (i = 0; i < Total; ++i)
-        {
-          Collision.Read(File);
+            int Valid = 0;
 
-          int Valid = 0;
+            // get categories for both actors
+            char Type1, Type2;
+            if (Collision.DatabaseId1 != uint32_t(-1))
+              Type1 = Categories[Actors[Collision.DatabaseId1].Type];
+            else
+              Type1 = 'o'; // other non-actor object
 
-          // get categories for both actors
-          uint8_t Type1, Type2;
-          if (Collision.DatabaseId1 != uint32_t(-1))
-            Type1 = Categories[Actors[Collision.DatabaseId1].Type];
-          else
-            Type1 = 'o'; // other non-actor object
-          
-          if (Collision.DatabaseId2 != uint32_t(-1))
-            Type2 = Categories[Actors[Collision.DatabaseId2].Type];
-          else
-            Type2 = 'o'; // other non-actor object
-
-          // filter actor 1
-          if (Category1 == 'a')
-            ++Valid;
-          else if (Category1 == Type1)
-            ++Valid;
-          else if (Category1 == 'h' && Collision.IsActor1Hero)
-            ++Valid;
-
-          // filter actor 2
-          if (Category2 == 'a')
-            ++Valid;
-          else if (Category2 == Type2)
-            ++Valid;
-          else if (Category2 == 'h' && Collision.IsActor2Hero)
-            ++Valid;
-
-          // only show if both actors has passed the filter
-          if (Valid == 2)
-          {
-            // check if we need to show as a starting collision or it is a continuation one
-            auto collisionPair = std::make_pair(Collision.DatabaseId1, Collision.DatabaseId2);
-            if (oldCollisions.count(collisionPair) == 0)
+            if (Collision.DatabaseId2 != uint32_t(-1))
+              Type2 = Categories[Actors[Collision.DatabaseId2].Type];
+            else
+              Type2 = 'o'; // other non-actor object
+
+            // filter actor 1
+            if (Category1 == 'a')
+              ++Valid;
+            else if (Category1 == Type1)
+              ++Valid;
+            else if (Category1 == 'h' && Collision.IsActor1Hero)
+              ++Valid;
+
+            // filter actor 2
+            if (Category2 == 'a')
+              ++Valid;
+            else if (Category2 == Type2)
+              ++Valid;
+            else if (Category2 == 'h' && Collision.IsActor2Hero)
+              ++Valid;
+
+            // only keep it if both actors has passed the filter
+            if (Valid == 2)
             {
-              Info << std::setw(8) << std::setprecision(0) << std::right << std::fixed << Frame.Elapsed;
-              Info << " " << "  " << Type1 << " " << Type2 << " ";
-              Info << " " << std::setw(6) << std::right << Collision.DatabaseId1;
-              Info << " " << std::setw(35) << std::left << TCHAR_TO_UTF8(*Actors[Collision.DatabaseId1].Id);
-              Info << " " << std::setw(6) << std::right << Collision.DatabaseId2;
-              Info << " " << std::setw(35) << std::left << TCHAR_TO_UTF8(*Actors[Collision.DatabaseId2].Id);
-              Info << std::endl;
+              // check if it is a starting collision or it is a continuation one
+              auto CollisionPair = std::make_pair(Collision.DatabaseId1, Collision.DatabaseId2);
+              if (OldCollisions.count(CollisionPair) == 0)
+              {
+                Segment.Items.push_back(CarlaRecorderQueryCollision {
+                    Segment.Frame.Elapsed,
+                    Type1,
+                    Type2,
+                    Collision.DatabaseId1,
+                    Actors[Collision.DatabaseId1].Id,
+                    Collision.DatabaseId2,
+                    Actors[Collision.DatabaseId2].Id });
+                Segment.InFirstFrame.push_back(NumFrames == 1);
+              }
+              // save current collision
+              NewCollisions.insert(CollisionPair);
             }
-            // save current collision
-            newCollisions.insert(collisionPair);
           }
-        }
-        break;
+          break;
 
-      case static_cast<char>(CarlaRecorderPacketId::Position):
-        SkipPacket();
-        break;
+        // frame end
+        case static_cast<char>(CarlaRecorderPacketId::FrameEnd):
+          // do nothing, it is empty
+          break;
+
+        default:
+          File.seekg(Header.Size, std::ios::cur);
+          break;
+      }
+    }
 
-      case static_cast<char>(CarlaRecorderPacketId::State):
-        SkipPacket();
-        break;
+    Segment.LastFrame = std::move(NewCollisions);
+  }
 
-      // frame end
-      case static_cast<char>(CarlaRecorderPacketId::FrameEnd):
-        // do nothing, it is empty
-        break;
+} // namespace CarlaRecorderQuery_local_ns
 
-      default:
-        SkipPacket();
-        break;
+CarlaRecorderQueryResult<CarlaRecorderQueryCollision> CarlaRecorderQuery::FindCollisions(
+    const std::string &Filename,
+    char Category1,
+    char Category2)
+{
+  using namespace CarlaRecorderQuery_local_ns;
+
+  CarlaRecorderQueryResult<CarlaRecorderQueryCollision> Result;
+
+  // get the final path + filename
+  std::string Filename2 = GetRecorderFilename(Filename);
+
+  CarlaRecorderInputFile File;
+  if (!OpenRecorderFile(Filename2, File, Result.Info, Result.Error))
+  {
+    return Result;
+  }
+  Result.bValid = true;
+  Result.bCompressed = File.IsCompressed();
+
+  // 每个关键帧开始一段，没有帧索引时整个文件是一段
+  const uint64_t Begin = static_cast<uint64_t>(File.tellg());
+  std::vector<uint64_t> Starts { Begin };
+  CarlaRecorderFrameIndex FrameIndex;
+  if (FrameIndex.Read(File))
+  {
+    for (const auto &Entry : FrameIndex.GetEntries())
+    {
+      if (Entry.Offset > Starts.back())
+      {
+        Starts.push_back(Entry.Offset);
+      }
     }
   }
+  File.Close();
 
-  Info << "\nFrames: " << Frame.Id << "\n";
-  Info << "Duration: " << Frame.Elapsed << " seconds\n";
+  std::vector<CollisionSegment> Segments(Starts.size());
+  ParallelFor(static_cast<int32>(Segments.size()), [&](int32 Index)
+  {
+    const uint64_t End = (Index + 1 < static_cast<int32>(Starts.size())) ?
+        Starts[Index + 1] : std::numeric_limits<uint64_t>::max();
+    ScanCollisions(Filename2, Starts[Index], End, Index > 0, Category1, Category2, Segments[Index]);
+  });
 
-  File.close();
+  // 合并各段的结果，一段中第一帧的碰撞如果在上一段的最后一帧中已经存在，就不是新的碰撞
+  for (size_t Index = 0; Index < Segments.size(); ++Index)
+  {
+    const CollisionSegment &Segment = Segments[Index];
+    for (size_t i = 0; i < Segment.Items.size(); ++i)
+    {
+      const auto &Item = Segment.Items[i];
+      if (Index > 0 && Segment.InFirstFrame[i] &&
+          Segments[Index - 1].LastFrame.count(std::make_pair(Item.DatabaseId1, Item.DatabaseId2)) > 0)
+      {
+        continue;
+      }
+      Result.Items.push_back(Item);
+    }
+  }
 
-  return Info.str();
+  Result.Frames = Segments.back().Frame.Id;
+  Result.Duration = Segments.back().Frame.Elapsed;
+  return Result;
 }
 
-std::string CarlaRecorderQuery::QueryBlocked(std::string Filename, double MinTime, double MinDistance)
+CarlaRecorderQueryResult<CarlaRecorderQueryBlocked> CarlaRecorderQuery::FindBlocked(
+    const std::string &Filename,
+    double MinTime,
+    double MinDistance)
 {
-  std::stringstream Info;
+  using namespace CarlaRecorderQuery_local_ns;
+
+  CarlaRecorderQueryResult<CarlaRecorderQueryBlocked> Result;
 
   // get the final path + filename
   std::string Filename2 = GetRecorderFilename(Filename);
 
-  // try to open
-  File.open(Filename2, std::ios::binary);
-  if (!File.is_open())
+  CarlaRecorderInputFile File;
+  if (!OpenRecorderFile(Filename2, File, Result.Info, Result.Error))
   {
-    Info << "File " << Filename2 << " not found on server\n";
-    return Info.str();
+    return Result;
   }
+  Result.bValid = true;
+  Result.bCompressed = File.IsCompressed();
 
-  if (!CheckFileInfo(Info))
-    return Info.str();
-
-  // other, vehicle, walkers, trafficLight, hero, any
   uint16_t i, Total;
   struct ReplayerActorInfo
   {
@@ -847,22 +987,24 @@ std::string CarlaRecorderQuery::QueryBlocked(std::string Filename, double MinTim
     double Duration;
   };
   std::unordered_map<uint32_t, ReplayerActorInfo> Actors;
-  // to be able to sort the results by the duration of each actor (decreasing order)
-  std::multimap<double, std::string, std::greater<double>> Results;
+  PacketHeader Header;
+  CarlaRecorderFrame Frame { 0u, 0.0, 0.0 };
+  CarlaRecorderEventAdd EventAdd;
+  CarlaRecorderEventDel EventDel;
+  CarlaRecorderPosition Position;
 
-  // header
-  Info << std::setw(8) << "Time";
-  Info << " " << std::setw(6) << "Id";
-  Info << " " << std::setw(35) << std::left << "Actor";
-  Info << " " << std::setw(10) << std::right << "Duration";
-  Info << std::endl;
+  auto AddResult = [&Result](uint32_t Id, const ReplayerActorInfo &Actor)
+  {
+    Result.Items.push_back(CarlaRecorderQueryBlocked { Actor.Time, Id, Actor.Id, Actor.Duration });
+  };
 
-  // parse only frames
+  // 每个 actor 的停止时间依赖之前所有帧中的位置，所以这里按顺序读取
   while (File)
   {
-
     // get header
-    if (!ReadHeader())
+    ReadValue<char>(File, Header.Id);
+    ReadValue<uint32_t>(File, Header.Size);
+    if (!File)
     {
       break;
     }
@@ -892,20 +1034,10 @@ std::string CarlaRecorderQuery::QueryBlocked(std::string Filename, double MinTim
         for (i = 0; i < Total; ++i)
         {
           EventDel.Read(File);
-          Actors.erase(EventAdd.DatabaseId);
+          Actors.erase(EventDel.DatabaseId);
         }
         break;
 
-      // events parenting
-      case static_cast<char>(CarlaRecorderPacketId::EventParent):
-        SkipPacket();
-        break;
-
-      // collisions
-      case static_cast<char>(CarlaRecorderPacketId::Collision):
-        SkipPacket();
-        break;
-
       // positions
       case static_cast<char>(CarlaRecorderPacketId::Position):
         // read all positions
@@ -913,76 +1045,130 @@ std::string CarlaRecorderQuery::QueryBlocked(std::string Filename, double MinTim
         for (i=0; i<Total; ++i)
         {
           Position.Read(File);
+          ReplayerActorInfo &Actor = Actors[Position.DatabaseId];
           // check if actor moved less than a distance
-          if (FVector::Distance(Actors[Position.DatabaseId].LastPosition, Position.Location) < MinDistance)
+          if (FVector::Distance(Actor.LastPosition, Position.Location) < MinDistance)
           {
             // actor stopped
-            if (Actors[Position.DatabaseId].Duration == 0)
-              Actors[Position.DatabaseId].Time = Frame.Elapsed;
-            Actors[Position.DatabaseId].Duration += Frame.DurationThis;
+            if (Actor.Duration == 0)
+              Actor.Time = Frame.Elapsed;
+            Actor.Duration += Frame.DurationThis;
           }
           else
           {
-            // check to show info
-            if (Actors[Position.DatabaseId].Duration >= MinTime)
+            // check to keep the result
+            if (Actor.Duration >= MinTime)
             {
-              std::stringstream Result;
-              Result << std::setw(8) << std::setprecision(0) << std::fixed << Actors[Position.DatabaseId].Time;
-              Result << " " << std::setw(6) << Position.DatabaseId;
-              Result << " " << std::setw(35) << std::left << TCHAR_TO_UTF8(*Actors[Position.DatabaseId].Id);
-              Result << " " << std::setw(10) << std::setprecision(0) << std::fixed << std::right << Actors[Position.DatabaseId].Duration;
-              Result << std::endl;
-              Results.insert(std::make_pair(Actors[Position.DatabaseId].Duration, Result.str()));
+              AddResult(Position.DatabaseId, Actor);
             }
             // actor moving
-            Actors[Position.DatabaseId].Duration = 0;
-            Actors[Position.DatabaseId].LastPosition = Position.Location;
+            Actor.Duration = 0;
+            Actor.LastPosition = Position.Location;
           }
         }
         break;
 
-      // traffic light
-      case static_cast<char>(CarlaRecorderPacketId::State):
-        SkipPacket();
-        break;
-
       // frame end
       case static_cast<char>(CarlaRecorderPacketId::FrameEnd):
         // do nothing, it is empty
         break;
 
       default:
-        SkipPacket();
+        File.seekg(Header.Size, std::ios::cur);
         break;
     }
   }
 
-  // show actors stopped that were not moving again
+  // actors stopped that were not moving again
   for (auto &Actor : Actors)
   {
-    // check to show info
     if (Actor.second.Duration >= MinTime)
     {
-      std::stringstream Result;
-      Result << std::setw(8) << std::setprecision(0) << std::fixed << Actor.second.Time;
-      Result << " " << std::setw(6) << Actor.first;
-      Result << " " << std::setw(35) << std::left << TCHAR_TO_UTF8(*Actor.second.Id);
-      Result << " " << std::setw(10) << std::setprecision(0) << std::fixed << std::right << Actor.second.Duration;
-      Result << std::endl;
-      Results.insert(std::make_pair(Actor.second.Duration, Result.str()));
+      AddResult(Actor.first, Actor.second);
     }
   }
 
-  // show the result
-  for (auto &Result : Results)
+  // sort the results by the duration of each actor (decreasing order)
+  std::stable_sort(Result.Items.begin(), Result.Items.end(),
+      [](const CarlaRecorderQueryBlocked &A, const CarlaRecorderQueryBlocked &B)
+      {
+        return A.Duration > B.Duration;
+      });
+
+  Result.Frames = Frame.Id;
+  Result.Duration = Frame.Elapsed;
+  File.Close();
+  return Result;
+}
+
+std::string CarlaRecorderQuery::QueryCollisions(std::string Filename, char Category1, char Category2)
+{
+  std::stringstream Info;
+
+  auto Result = FindCollisions(Filename, Category1, Category2);
+  if (!Result.bValid)
   {
-    Info << Result.second;
+    Info << Result.Error;
+    return Info.str();
   }
+  PrintFileInfo(Info, Result.Info, Result.bCompressed);
 
-  Info << "\nFrames: " << Frame.Id << "\n";
-  Info << "Duration: " << Frame.Elapsed << " seconds\n";
+  // header
+  Info << std::setw(8) << "Time";
+  Info << " " << std::setw(6) << "Types";
+  Info << " " << std::setw(6) << std::right << "Id";
+  Info << " " << std::setw(35) << std::left << "Actor 1";
+  Info << " " << std::setw(6) << std::right << "Id";
+  Info << " " << std::setw(35) << std::left << "Actor 2";
+  Info << std::endl;
+
+  for (const auto &Item : Result.Items)
+  {
+    Info << std::setw(8) << std::setprecision(0) << std::right << std::fixed << Item.Time;
+    Info << " " << "  " << Item.Type1 << " " << Item.Type2 << " ";
+    Info << " " << std::setw(6) << std::right << Item.DatabaseId1;
+    Info << " " << std::setw(35) << std::left << TCHAR_TO_UTF8(*Item.Actor1);
+    Info << " " << std::setw(6) << std::right << Item.DatabaseId2;
+    Info << " " << std::setw(35) << std::left << TCHAR_TO_UTF8(*Item.Actor2);
+    Info << std::endl;
+  }
+
+  Info << "\nFrames: " << Result.Frames << "\n";
+  Info << "Duration: " << Result.Duration << " seconds\n";
+
+  return Info.str();
+}
+
+std::string CarlaRecorderQuery::QueryBlocked(std::string Filename, double MinTime, double MinDistance)
+{
+  std::stringstream Info;
+
+  auto Result = FindBlocked(Filename, MinTime, MinDistance);
+  if (!Result.bValid)
+  {
+    Info << Result.Error;
+    return Info.str();
+  }
+  PrintFileInfo(Info, Result.Info, Result.bCompressed);
+
+  // header
+  Info << std::setw(8) << "Time";
+  Info << " " << std::setw(6) << "Id";
+  Info << " " << std::setw(35) << std::left << "Actor";
+  Info << " " << std::setw(10) << std::right << "Duration";
+  Info << std::endl;
+
+  for (const auto &Item : Result.Items)
+  {
+    Info << std::setw(8) << std::setprecision(0) << std::fixed << Item.Time;
+    Info << " " << std::setw(6) << Item.DatabaseId;
+    Info << " " << std::setw(35) << std::left << TCHAR_TO_UTF8(*Item.Actor);
+    Info << " " << std::setw(10) << std::setprecision(0) << std::fixed << std::right << Item.Duration;
+    Info << std::endl;
+  }
 
-  File.close();
+  Info << "\nFrames: " << Result.Frames << "\n";
+  Info << "Duration: " << Result.Duration << " seconds\n";
 
   return Info.str();
 }
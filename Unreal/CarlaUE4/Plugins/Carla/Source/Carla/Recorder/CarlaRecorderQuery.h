@@ -7,6 +7,8 @@
 #pragma once
 
 #include <fstream>
+#include <string>
+#include <vector>
 
 #include "CarlaRecorderTraficLightTime.h"
 #include "CarlaRecorderPhysicsControl.h"
@@ -21,6 +23,7 @@
 #include "CarlaRecorderEventAdd.h"
 #include "CarlaRecorderEventDel.h"
 #include "CarlaRecorderEventParent.h"
+#include "CarlaRecorderFile.h"
 #include "CarlaRecorderFrames.h"
 #include "CarlaRecorderInfo.h"
 #include "CarlaRecorderPosition.h"
@@ -28,6 +31,40 @@
 #include "CarlaRecorderWalkerBones.h"
 #include "CarlaRecorderDoorVehicle.h"
 
+// 碰撞查询的一条结果：两个 actor 开始碰撞的时间
+struct CarlaRecorderQueryCollision
+{
+  double Time;
+  char Type1;         // 类别：o 其他、v 车辆、w 行人、t 交通灯
+  char Type2;
+  uint32_t DatabaseId1;
+  FString Actor1;
+  uint32_t DatabaseId2;
+  FString Actor2;
+};
+
+// 阻塞查询的一条结果：actor 从 Time 开始在 Duration 秒内几乎没有移动
+struct CarlaRecorderQueryBlocked
+{
+  double Time;
+  uint32_t DatabaseId;
+  FString Actor;
+  double Duration;
+};
+
+// 结构化的查询结果，bValid 为 false 时 Error 中是原因
+template <typename T>
+struct CarlaRecorderQueryResult
+{
+  bool bValid = false;
+  std::string Error;
+  CarlaRecorderInfo Info;
+  bool bCompressed = false;
+  uint64_t Frames = 0;
+  double Duration = 0.0;
+  std::vector<T> Items;
+};
+
 class CarlaRecorderQuery
 {
 
@@ -48,9 +85,16 @@ public:
   //  获取被阻塞的演员信息
   std::string QueryBlocked(std::string Filename, double MinTime = 30, double MinDistance = 10);
 
+  // 与上面两个查询相同，但返回结构化的结果。
+  // 文件有帧索引时，碰撞查询按关键帧分段在多个线程中执行
+  static CarlaRecorderQueryResult<CarlaRecorderQueryCollision> FindCollisions(
+      const std::string &Filename, char Category1 = 'a', char Category2 = 'a');
+  static CarlaRecorderQueryResult<CarlaRecorderQueryBlocked> FindBlocked(
+      const std::string &Filename, double MinTime = 30, double MinDistance = 10);
+
 private:
 
-  std::ifstream File;
+  CarlaRecorderInputFile File;
   Header Header;
   CarlaRecorderInfo RecInfo;
   CarlaRecorderFrame Frame;
@@ -80,4 +124,7 @@ private:
 
   //  读取开始信息结构并检查魔法字符串
   bool CheckFileInfo(std::stringstream &Info);
+
+  // 输出文件的通用信息
+  static void PrintFileInfo(std::stringstream &Info, const CarlaRecorderInfo &RecInfo, bool bCompressed);
 };
@@ -0,0 +1,97 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "Carla.h"
+#include "CarlaRecorderSink.h"
+
+#include "HAL/PlatformProcess.h"
+#include "HAL/PlatformTime.h"
+
+bool CarlaRecorderFileSink::Open(const std::string &Filename)
+{
+  File.open(Filename, std::ios::binary);
+  return File.is_open();
+}
+
+bool CarlaRecorderFileSink::Write(const char *Data, size_t Size)
+{
+  File.write(Data, Size);
+  return static_cast<bool>(File);
+}
+
+bool CarlaRecorderFileSink::Close()
+{
+  File.close();
+  return !File.fail();
+}
+
+CarlaRecorderStreamSink::CarlaRecorderStreamSink(
+    carla::streaming::Stream InStream,
+    double InConnectTimeout)
+  : Stream(std::move(InStream)),
+    ConnectTimeout(InConnectTimeout) {}
+
+bool CarlaRecorderStreamSink::WaitForClient()
+{
+  // 客户端在 start_recorder_stream 返回之后才能订阅，在此之前流中的数据会被丢弃，
+  // 所以后台线程等待订阅，游戏线程提交的数据在内存中排队
+  if (!bConnected && !bFailed)
+  {
+    const double Deadline = FPlatformTime::Seconds() + ConnectTimeout;
+    while (!Stream.AreClientsListening())
+    {
+      if (FPlatformTime::Seconds() > Deadline)
+      {
+        UE_LOG(LogCarla, Warning, TEXT("Recorder stream: no client subscribed within %.1f s"), ConnectTimeout);
+        bFailed = true;
+        return false;
+      }
+      FPlatformProcess::Sleep(0.01f);
+    }
+    bConnected = true;
+  }
+  return bConnected;
+}
+
+void CarlaRecorderStreamSink::Send(const char *Data, size_t Size)
+{
+  auto Header = Stream.MakeBuffer();
+  Header.copy_from(reinterpret_cast<const unsigned char *>(&Offset), sizeof(Offset));
+  if (Size == 0u)
+  {
+    Stream.Write(std::move(Header));
+    return;
+  }
+  auto Payload = Stream.MakeBuffer();
+  Payload.copy_from(reinterpret_cast<const unsigned char *>(Data), Size);
+  Stream.Write(std::move(Header), std::move(Payload));
+  Offset += Size;
+}
+
+bool CarlaRecorderStreamSink::Write(const char *Data, size_t Size)
+{
+  if (!WaitForClient())
+  {
+    return false;
+  }
+  if (!Stream.AreClientsListening())
+  {
+    // 客户端已经断开
+    bFailed = true;
+    return false;
+  }
+  Send(Data, Size);
+  return true;
+}
+
+bool CarlaRecorderStreamSink::Close()
+{
+  if (bConnected)
+  {
+    Send(nullptr, 0u);
+  }
+  return bConnected && !bFailed;
+}
@@ -0,0 +1,73 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <compiler/disable-ue4-macros.h>
+#include <carla/streaming/Stream.h>
+#include <compiler/enable-ue4-macros.h>
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+
+// 录制数据的去向。CarlaRecorderFileBuffer 的后台线程按顺序把已经提交的数据
+// 交给 Sink，所有函数都只在后台线程中调用
+class CarlaRecorderSink
+{
+public:
+
+  virtual ~CarlaRecorderSink() = default;
+
+  // 写入失败时返回 false
+  virtual bool Write(const char *Data, size_t Size) = 0;
+
+  // 所有数据都已写入
+  virtual bool Close() = 0;
+};
+
+// 写入本地文件
+class CarlaRecorderFileSink : public CarlaRecorderSink
+{
+public:
+
+  bool Open(const std::string &Filename);
+
+  bool Write(const char *Data, size_t Size) override;
+
+  bool Close() override;
+
+private:
+
+  std::ofstream File;
+};
+
+// 通过流媒体服务器发送，客户端订阅流的 token 后收到与录制文件相同的字节。
+// 每条消息的开头是这条消息的数据在录制中的位置 (uint64)，客户端据此发现丢失的消息；
+// 只有位置没有数据的消息表示录制结束
+class CarlaRecorderStreamSink : public CarlaRecorderSink
+{
+public:
+
+  // ConnectTimeout 秒内没有客户端订阅时放弃发送
+  CarlaRecorderStreamSink(carla::streaming::Stream InStream, double InConnectTimeout);
+
+  bool Write(const char *Data, size_t Size) override;
+
+  bool Close() override;
+
+private:
+
+  bool WaitForClient();
+
+  void Send(const char *Data, size_t Size);
+
+  carla::streaming::Stream Stream;
+  double ConnectTimeout;
+  bool bConnected = false;
+  bool bFailed = false;
+  uint64_t Offset = 0;
+};
@@ -8,9 +8,55 @@
 #include "CarlaRecorder.h"
 #include "Carla/Game/CarlaEpisode.h"
 
+#include "Runtime/Core/Public/Async/ParallelFor.h"
+
+#include <algorithm>
 #include <ctime>
+#include <iomanip>
 #include <sstream>
 
+// 需要更新的 actor 少于这个数量时在当前线程中插值，避免任务调度的开销
+static constexpr size_t MinParallelPositions = 256u;
+
+// 基准测试报告中最多列出的不一致的位置
+static constexpr uint64_t MaxReportedMismatches = 10u;
+
+static const char *GetPacketName(uint8_t Id)
+{
+  switch (static_cast<CarlaRecorderPacketId>(Id))
+  {
+    case CarlaRecorderPacketId::FrameStart:        return "FrameStart";
+    case CarlaRecorderPacketId::FrameEnd:          return "FrameEnd";
+    case CarlaRecorderPacketId::EventAdd:          return "EventAdd";
+    case CarlaRecorderPacketId::EventDel:          return "EventDel";
+    case CarlaRecorderPacketId::EventParent:       return "EventParent";
+    case CarlaRecorderPacketId::Collision:         return "Collision";
+    case CarlaRecorderPacketId::Position:          return "Position";
+    case CarlaRecorderPacketId::State:             return "State";
+    case CarlaRecorderPacketId::AnimVehicle:       return "AnimVehicle";
+    case CarlaRecorderPacketId::AnimWalker:        return "AnimWalker";
+    case CarlaRecorderPacketId::VehicleLight:      return "VehicleLight";
+    case CarlaRecorderPacketId::SceneLight:        return "SceneLight";
+    case CarlaRecorderPacketId::Kinematics:        return "Kinematics";
+    case CarlaRecorderPacketId::BoundingBox:       return "BoundingBox";
+    case CarlaRecorderPacketId::PlatformTime:      return "PlatformTime";
+    case CarlaRecorderPacketId::PhysicsControl:    return "PhysicsControl";
+    case CarlaRecorderPacketId::TrafficLightTime:  return "TrafficLightTime";
+    case CarlaRecorderPacketId::TriggerVolume:     return "TriggerVolume";
+    case CarlaRecorderPacketId::FrameCounter:      return "FrameCounter";
+    case CarlaRecorderPacketId::WalkerBones:       return "WalkerBones";
+    case CarlaRecorderPacketId::VisualTime:        return "VisualTime";
+    case CarlaRecorderPacketId::VehicleDoor:       return "VehicleDoor";
+    case CarlaRecorderPacketId::AnimVehicleWheels: return "AnimVehicleWheels";
+    case CarlaRecorderPacketId::AnimBiker:         return "AnimBiker";
+    case CarlaRecorderPacketId::Keyframe:          return "Keyframe";
+    case CarlaRecorderPacketId::FrameIndex:        return "FrameIndex";
+    case CarlaRecorderPacketId::FrameIndexOffset:  return "FrameIndexOffset";
+    case CarlaRecorderPacketId::PositionDelta:     return "PositionDelta";
+    default:                                       return "Unknown";
+  }
+}
+
 // structure to save replaying info when need to load a new map (static member by now)
 CarlaReplayer::PlayAfterLoadMap CarlaReplayer::Autoplay { false, "", "", 0.0, 0.0, 0, 1.0, false };
 
@@ -30,8 +76,8 @@ void CarlaReplayer::Stop(bool bKeepActors)
     Helper.ProcessReplayerFinish(bKeepActors, IgnoreHero, IsHeroMap);
   }
 
-  if (File.is_open())
-    File.close();
+  if (File.IsOpen())
+    File.Close();
 }
 
 bool CarlaReplayer::ReadHeader()
@@ -67,14 +113,38 @@ void CarlaReplayer::Rewind(void)
 
   MappedId.clear();
   IsHeroMap.clear();
+  bSeekToKeyframe = false;
 
   // read geneal Info
   RecInfo.Read(File);
+
+  // read the frame index at the end of the file (if any)
+  FrameIndex.Read(File);
+}
+
+void CarlaReplayer::SeekToKeyframe(double Time)
+{
+  const CarlaRecorderFrameIndexEntry *Entry = FrameIndex.FindKeyframe(Time);
+  if (Entry == nullptr || static_cast<uint64_t>(File.tellg()) >= Entry->Offset)
+  {
+    return;
+  }
+
+  // jump to the frame with the keyframe, the actors are created from it
+  File.clear();
+  File.seekg(Entry->Offset, std::ios::beg);
+  bSeekToKeyframe = true;
 }
 
 // read last frame in File and return the Total time recorded
 double CarlaReplayer::GetTotalTime(void)
 {
+  // the index already knows the total time
+  if (FrameIndex.IsValid())
+  {
+    return FrameIndex.GetTotalTime();
+  }
+
   std::streampos Current = File.tellg();
 
   // parse only frames
@@ -121,8 +191,8 @@ std::string CarlaReplayer::ReplayFile(std::string Filename, double TimeStart, do
   Info << "Replaying File: " << Filename2 << std::endl;
 
   // try to open
-  File.open(Filename2, std::ios::binary);
-  if (!File.is_open())
+  File.Open(Filename2);
+  if (!File.IsOpen())
   {
     Info << "File " << Filename2 << " not found on server\n";
     Stop();
@@ -199,6 +269,113 @@ std::string CarlaReplayer::ReplayFile(std::string Filename, double TimeStart, do
   return Info.str();
 }
 
+std::string CarlaReplayer::Benchmark(std::string Filename, double Tolerance)
+{
+  std::stringstream Info;
+
+  // check to stop if we are replaying another
+  if (Enabled)
+  {
+    Stop();
+  }
+
+  std::string Filename2 = GetRecorderFilename(Filename);
+  Info << "Benchmarking File: " << Filename2 << std::endl;
+
+  File.Open(Filename2);
+  if (!File.IsOpen())
+  {
+    Info << "File " << Filename2 << " not found on server\n";
+    Stop();
+    return Info.str();
+  }
+
+  Rewind();
+
+  // the benchmark runs in a single call, so it can not wait for a new map
+  if (Episode->GetMapName() != RecInfo.Mapfile)
+  {
+    Info << "File recorded in map " << TCHAR_TO_UTF8(*RecInfo.Mapfile) <<
+        ", load it before running the benchmark" << std::endl;
+    Stop();
+    return Info.str();
+  }
+
+  TotalTime = GetTotalTime();
+  TimeToStop = TotalTime;
+  FollowId = 0;
+  bReplaySensors = false;
+
+  // reset the statistics
+  BenchmarkPackets.fill(BenchmarkPacket{0u, 0u, 0.0});
+  BenchmarkChecked = 0u;
+  BenchmarkMissing = 0u;
+  BenchmarkMismatches = 0u;
+  BenchmarkTolerance = Tolerance;
+  BenchmarkMaxLocationError = 0.0;
+  BenchmarkMaxRotationError = 0.0;
+  bBenchmark = true;
+
+  Helper.RemoveStaticProps();
+  Enabled = true;
+
+  const double StartTime = FPlatformTime::Seconds();
+  while (Enabled && !File.eof())
+  {
+    // 每次前进到当前帧的结尾，下一帧的所有数据包都会被处理；
+    // 基准测试模式下 UpdatePositions 直接使用录制的位置
+    ProcessToTime(Frame.Elapsed + Frame.DurationThis - CurrentTime, false);
+  }
+  const double Elapsed = FPlatformTime::Seconds() - StartTime;
+
+  if (Enabled)
+  {
+    Stop(true);
+  }
+  bBenchmark = false;
+
+  // report
+  const uint64_t Frames = BenchmarkPackets[static_cast<uint8_t>(CarlaRecorderPacketId::FrameStart)].Count;
+  Info << std::fixed << std::setprecision(3);
+  Info << "Frames: " << Frames << " (" << TotalTime << " s recorded) replayed in " << Elapsed << " s";
+  if (Elapsed > 0.0)
+  {
+    Info << ", " << std::setprecision(1) << (Frames / Elapsed) << " frames/s, " <<
+        (TotalTime / Elapsed) << "x real time" << std::setprecision(3);
+  }
+  Info << std::endl << std::endl;
+
+  Info << std::setw(20) << std::left << "Packet" << std::right <<
+      std::setw(10) << "Count" <<
+      std::setw(14) << "Bytes" <<
+      std::setw(12) << "Time (ms)" <<
+      std::setw(12) << "us/packet" << std::endl;
+  for (size_t Id = 0u; Id < BenchmarkPackets.size(); ++Id)
+  {
+    const BenchmarkPacket &Packet = BenchmarkPackets[Id];
+    if (Packet.Count == 0u)
+    {
+      continue;
+    }
+    Info << std::setw(20) << std::left << GetPacketName(static_cast<uint8_t>(Id)) << std::right <<
+        std::setw(10) << Packet.Count <<
+        std::setw(14) << Packet.Bytes <<
+        std::setw(12) << (Packet.Seconds * 1e3) <<
+        std::setw(12) << (Packet.Seconds * 1e6 / Packet.Count) << std::endl;
+  }
+  Info << std::endl;
+
+  Info << "Positions checked: " << BenchmarkChecked <<
+      ", actors not found: " << BenchmarkMissing <<
+      ", over " << Tolerance << " cm: " << BenchmarkMismatches << std::endl;
+  Info << "Max location error: " << BenchmarkMaxLocationError << " cm, max rotation error: " <<
+      BenchmarkMaxRotationError << " deg" << std::endl;
+  Info << ((BenchmarkMissing == 0u && BenchmarkMismatches == 0u) ? "Replay matches the recording" :
+      "Replay does NOT match the recording") << std::endl;
+
+  return Info.str();
+}
+
 void CarlaReplayer::CheckPlayAfterMapLoaded(void)
 {
 
@@ -216,8 +393,8 @@ void CarlaReplayer::CheckPlayAfterMapLoaded(void)
   }
 
   // try to open
-  File.open(Autoplay.Filename, std::ios::binary);
-  if (!File.is_open())
+  File.Open(Autoplay.Filename);
+  if (!File.IsOpen())
   {
     return;
   }
@@ -276,11 +453,18 @@ void CarlaReplayer::ProcessToTime(double Time, bool IsFirstTime)
     bExitLoop = true;
   }
 
+  // starting in the middle of the file, skip everything before the last keyframe
+  if (IsFirstTime && !bExitLoop)
+  {
+    SeekToKeyframe(NewTime);
+  }
+
   // process all frames until time we want or end
   while (!File.eof() && !bExitLoop)
   {
     // get header
     ReadHeader();
+    const double PacketStart = bBenchmark ? FPlatformTime::Seconds() : 0.0;
 
     // check for a frame packet
     switch (Header.Id)
@@ -304,17 +488,34 @@ void CarlaReplayer::ProcessToTime(double Time, bool IsFirstTime)
 
       // events add
       case static_cast<char>(CarlaRecorderPacketId::EventAdd):
-        ProcessEventsAdd();
+        if (bSeekToKeyframe)
+          SkipPacket();
+        else
+          ProcessEventsAdd();
         break;
 
       // events del
       case static_cast<char>(CarlaRecorderPacketId::EventDel):
-        ProcessEventsDel();
+        if (bSeekToKeyframe)
+          SkipPacket();
+        else
+          ProcessEventsDel();
         break;
 
       // events parent
       case static_cast<char>(CarlaRecorderPacketId::EventParent):
-        ProcessEventsParent();
+        if (bSeekToKeyframe)
+          SkipPacket();
+        else
+          ProcessEventsParent();
+        break;
+
+      // keyframe (only needed after seeking)
+      case static_cast<char>(CarlaRecorderPacketId::Keyframe):
+        if (bSeekToKeyframe)
+          ProcessKeyframe();
+        else
+          SkipPacket();
         break;
 
       // collisions
@@ -415,6 +616,14 @@ void CarlaReplayer::ProcessToTime(double Time, bool IsFirstTime)
         break;
 
     }
+
+    if (bBenchmark)
+    {
+      BenchmarkPacket &Packet = BenchmarkPackets[static_cast<uint8_t>(Header.Id)];
+      ++Packet.Count;
+      Packet.Bytes += Header.Size;
+      Packet.Seconds += FPlatformTime::Seconds() - PacketStart;
+    }
   }
 
   // update all positions
@@ -453,56 +662,60 @@ void CarlaReplayer::ProcessEventsAdd(void)
   for (i = 0; i < Total; ++i)
   {
     EventAdd.Read(File);
+    ProcessEventAdd(EventAdd);
+  }
+}
 
-    // auto Result = CallbackEventAdd(
-    auto Result = Helper.ProcessReplayerEventAdd(
-        EventAdd.Location,
-        EventAdd.Rotation,
-        EventAdd.Description,
-        EventAdd.DatabaseId,
-        IgnoreHero,
-        IgnoreSpectator,
-        bReplaySensors);
-
-    switch (Result.first)
-    {
-      // actor not created
-      case 0:
-        UE_LOG(LogCarla, Log, TEXT("actor could not be created"));
-        break;
+void CarlaReplayer::ProcessEventAdd(const CarlaRecorderEventAdd &EventAdd)
+{
+  // auto Result = CallbackEventAdd(
+  auto Result = Helper.ProcessReplayerEventAdd(
+      EventAdd.Location,
+      EventAdd.Rotation,
+      EventAdd.Description,
+      EventAdd.DatabaseId,
+      IgnoreHero,
+      IgnoreSpectator,
+      bReplaySensors);
+
+  switch (Result.first)
+  {
+    // actor not created
+    case 0:
+      UE_LOG(LogCarla, Log, TEXT("actor could not be created"));
+      break;
 
-      // actor created but with different id
-      case 1:
-        // mapping id (recorded Id is a new Id in replayer)
-        MappedId[EventAdd.DatabaseId] = Result.second;
-        break;
+    // actor created but with different id
+    case 1:
+      // mapping id (recorded Id is a new Id in replayer)
+      MappedId[EventAdd.DatabaseId] = Result.second;
+      break;
 
-      // actor reused from existing
-      case 2:
-        // mapping id (say desired Id is mapped to what)
-        MappedId[EventAdd.DatabaseId] = Result.second;
-        break;
+    // actor reused from existing
+    case 2:
+      // mapping id (say desired Id is mapped to what)
+      MappedId[EventAdd.DatabaseId] = Result.second;
+      break;
 
-      // actor ignored (either Hero or Spectator)
-      case 3:
-        UE_LOG(LogCarla, Log, TEXT("ignoring actor from replayer (Hero or Spectator)"));
-        break;
+    // actor ignored (either Hero or Spectator)
+    case 3:
+      UE_LOG(LogCarla, Log, TEXT("ignoring actor from replayer (Hero or Spectator)"));
+      break;
 
-    }
+  }
 
-    // check to mark if actor is a hero vehicle or not
-    if (Result.first > 0 && Result.first < 3)
+  // check to mark if actor is a hero vehicle or not
+  if (Result.first > 0 && Result.first < 3)
+  {
+    // init
+    IsHeroMap[Result.second] = false;
+    for (const auto &Item : EventAdd.Description.Attributes)
     {
-      // init
-      IsHeroMap[Result.second] = false;
-      for (const auto &Item : EventAdd.Description.Attributes)
+      if (Item.Id == "role_name" && Item.Value == "hero")
       {
-        if (Item.Id == "role_name" && Item.Value == "hero")
-        {
-          // mark as hero
-          IsHeroMap[Result.second] = true;
-          break;
-        }
+        // mark as hero
+        IsHeroMap[Result.second] = true;
+        break;
       }
     }
   }
@@ -538,6 +751,25 @@ void CarlaReplayer::ProcessEventsParent(void)
   }
 }
 
+void CarlaReplayer::ProcessKeyframe(void)
+{
+  CarlaRecorderKeyframe Keyframe;
+  Keyframe.Read(File);
+
+  // create all the actors alive at the keyframe, then attach them
+  for (const auto &EventAdd : Keyframe.GetActors())
+  {
+    ProcessEventAdd(EventAdd);
+  }
+  for (const auto &EventParent : Keyframe.GetParents())
+  {
+    Helper.ProcessReplayerEventParent(MappedId[EventParent.DatabaseId], MappedId[EventParent.DatabaseIdParent]);
+  }
+
+  // from here the events are applied as usual
+  bSeekToKeyframe = false;
+}
+
 void CarlaReplayer::ProcessStates(void)
 {
   uint16_t i, Total;
@@ -721,6 +953,34 @@ void CarlaReplayer::ProcessPositions(bool IsFirstTime)
   {
     PrevPos.clear();
   }
+
+  // 为每个位置找到上一帧中同一个 actor 的位置，每帧只计算一次，插值时直接使用。
+  // 录制时 actor 的顺序通常不变，所以先比较同一下标，不一致时才使用哈希表
+  PrevIndex.assign(CurrPos.size(), -1);
+  std::unordered_map<uint32_t, int32> TempMap;
+  for (i = 0; i < CurrPos.size(); ++i)
+  {
+    if (i < PrevPos.size() && PrevPos[i].DatabaseId == CurrPos[i].DatabaseId)
+    {
+      PrevIndex[i] = i;
+      continue;
+    }
+    // map the id of all previous positions to its index
+    if (TempMap.empty())
+    {
+      TempMap.reserve(PrevPos.size());
+      for (int32 j = 0; j < static_cast<int32>(PrevPos.size()); ++j)
+      {
+        TempMap[PrevPos[j].DatabaseId] = j;
+      }
+    }
+    auto Result = TempMap.find(CurrPos[i].DatabaseId);
+    if (Result != TempMap.end())
+    {
+      PrevIndex[i] = Result->second;
+    }
+  }
+}
 }
 
 void CarlaReplayer::ProcessWalkerBones(void)
@@ -745,15 +1005,8 @@ void CarlaReplayer::ProcessWalkerBones(void)
 
 void CarlaReplayer::UpdatePositions(double Per, double DeltaTime)
 {
-  unsigned int i;
+  TRACE_CPUPROFILER_EVENT_SCOPE(CarlaReplayer::UpdatePositions);
   uint32_t NewFollowId = 0;
-  std::unordered_map<int, int> TempMap;
-
-  // map the id of all previous positions to its index
-  for (i = 0; i < PrevPos.size(); ++i)
-  {
-    TempMap[PrevPos[i].DatabaseId] = i;
-  }
 
   // get the Id of the actor to follow
   if (FollowId != 0)
@@ -765,52 +1018,64 @@ void CarlaReplayer::UpdatePositions(double Per, double DeltaTime)
     }
   }
 
-  // go through each actor and update
-  for (auto &Pos : CurrPos)
+  // select the actors to update
+  UpdateItems.clear();
+  UpdateIds.clear();
+  for (size_t i = 0; i < CurrPos.size(); ++i)
   {
+    const CarlaRecorderPosition &Pos = CurrPos[i];
     // check if ignore this actor (hero) or the spectator (id == 1)
     if (!(IgnoreHero && IsHeroMap[Pos.DatabaseId]) &&
         !(IgnoreSpectator && Pos.DatabaseId == 1))
     {
-      // check if exist a previous position
-      auto Result = TempMap.find(Pos.DatabaseId);
-      if (Result != TempMap.end())
-      {
-        // check if time factor is high
-        if (TimeFactor >= 2.0)
-          // assign first position
-          InterpolatePosition(PrevPos[Result->second], Pos, 0.0, DeltaTime);
-        else
-          // interpolate
-          InterpolatePosition(PrevPos[Result->second], Pos, Per, DeltaTime);
-      }
-      else
-      {
-        // assign last position (we don't have previous one)
-        InterpolatePosition(Pos, Pos, 0.0, DeltaTime);
-      }
+      UpdateItems.push_back(static_cast<int32>(i));
+      UpdateIds.push_back(Pos.DatabaseId);
     }
+  }
+
+  // check if time factor is high (assign first position),
+  // the benchmark places the actors exactly at the recorded positions
+  const double Alpha = bBenchmark ? 1.0 : ((TimeFactor >= 2.0) ? 0.0 : Per);
 
-    // move the camera to follow this actor if required
-    if (NewFollowId != 0)
+  // 插值只读取位置数组，可以并行计算；设置变换必须在游戏线程中进行
+  UpdateTransforms.resize(UpdateItems.size());
+  ParallelFor(static_cast<int32>(UpdateItems.size()), [&](int32 i)
+  {
+    const int32 Item = UpdateItems[i];
+    const int32 Prev = PrevIndex[Item];
+    if (Prev >= 0)
+    {
+      // interpolate
+      UpdateTransforms[i] = CarlaReplayerHelper::InterpolatePosition(PrevPos[Prev], CurrPos[Item], Alpha);
+    }
+    else
+    {
+      // assign last position (we don't have previous one)
+      UpdateTransforms[i] = CarlaReplayerHelper::InterpolatePosition(CurrPos[Item], CurrPos[Item], 0.0);
+    }
+  }, UpdateItems.size() < MinParallelPositions);
+
+  Helper.ProcessReplayerPositions(UpdateIds, UpdateTransforms, IgnoreSpectator);
+
+  if (bBenchmark)
+  {
+    CheckBenchmarkPositions();
+  }
+
+  // move the camera to follow this actor if required
+  if (NewFollowId != 0)
+  {
+    for (const auto &Pos : CurrPos)
     {
       if (NewFollowId == Pos.DatabaseId)
+      {
         Helper.SetCameraPosition(NewFollowId, FVector(-1000, 0, 500), FQuat::MakeFromEuler({0, -25, 0}));
+        break;
+      }
     }
   }
 }
 
-// interpolate a position (transform, velocity...)
-void CarlaReplayer::InterpolatePosition(
-    const CarlaRecorderPosition &Pos1,
-    const CarlaRecorderPosition &Pos2,
-    double Per,
-    double DeltaTime)
-{
-  // call the callback
-  Helper.ProcessReplayerPosition(Pos1, Pos2, Per, DeltaTime, IgnoreSpectator);
-}
-
 // tick for the replayer
 void CarlaReplayer::Tick(float Delta)
 {
@@ -821,3 +1086,43 @@ void CarlaReplayer::Tick(float Delta)
     ProcessToTime(Delta * TimeFactor, false);
   }
 }
+
+void CarlaReplayer::CheckBenchmarkPositions(void)
+{
+  TRACE_CPUPROFILER_EVENT_SCOPE(CarlaReplayer::CheckBenchmarkPositions);
+  for (size_t i = 0; i < UpdateItems.size(); ++i)
+  {
+    const CarlaRecorderPosition &Pos = CurrPos[UpdateItems[i]];
+    FCarlaActor *CarlaActor = Episode->FindCarlaActor(UpdateIds[i]);
+    if (CarlaActor == nullptr)
+    {
+      ++BenchmarkMissing;
+      continue;
+    }
+    // the helper does not move the spectator either
+    if (IgnoreSpectator && CarlaActor->GetActor() != nullptr &&
+        CarlaActor->GetActor()->GetClass()->GetFName().ToString().Contains("Spectator"))
+    {
+      continue;
+    }
+
+    const FTransform Recorded = CarlaReplayerHelper::InterpolatePosition(Pos, Pos, 0.0);
+    const FTransform Replayed = CarlaActor->GetActorGlobalTransform();
+    const double LocationError = FVector::Dist(Recorded.GetLocation(), Replayed.GetLocation());
+    const double RotationError = FMath::RadiansToDegrees(
+        Recorded.GetRotation().AngularDistance(Replayed.GetRotation()));
+    BenchmarkMaxLocationError = std::max(BenchmarkMaxLocationError, LocationError);
+    BenchmarkMaxRotationError = std::max(BenchmarkMaxRotationError, RotationError);
+    ++BenchmarkChecked;
+
+    if (LocationError > BenchmarkTolerance)
+    {
+      if (BenchmarkMismatches < MaxReportedMismatches)
+      {
+        UE_LOG(LogCarla, Warning, TEXT("Replayer benchmark: actor %u at %.3f s is %.2f cm away from its recorded position"),
+            UpdateIds[i], Frame.Elapsed, LocationError);
+      }
+      ++BenchmarkMismatches;
+    }
+  }
+}
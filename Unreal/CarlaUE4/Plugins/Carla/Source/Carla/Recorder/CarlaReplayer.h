@@ -6,13 +6,16 @@
 
 #pragma once
 
+#include <array>
 #include <fstream>
 #include <sstream>
 #include <unordered_map>
 
 #include <functional>
+#include "CarlaRecorderFile.h"
 #include "CarlaRecorderInfo.h"
 #include "CarlaRecorderFrames.h"
+#include "CarlaRecorderFrameIndex.h"
 #include "CarlaRecorderEventAdd.h"
 #include "CarlaRecorderEventDel.h"
 #include "CarlaRecorderEventParent.h"
@@ -55,6 +58,11 @@ public:
   std::string ReplayFile(std::string Filename, double TimeStart = 0.0f, double Duration = 0.0f,
       uint32_t FollowId = 0, bool ReplaySensors = false);
 
+  // 以最快速度回放整个文件，不等待 Tick。返回每秒回放的帧数、每种数据包的处理
+  // 时间，以及每一帧回放后 actor 的位置与录制的位置的差异，超过 Tolerance（厘米）
+  // 的计为不一致。只能在录制时的地图中使用，结束时与普通回放一样保留 actor
+  std::string Benchmark(std::string Filename, double Tolerance = 1.0);
+
   // 启动重放（已注释）
   void Stop(bool KeepActors = false);
 
@@ -104,13 +112,23 @@ private:
   bool bReplaySensors = false;
   UCarlaEpisode *Episode = nullptr;
   // 二进制文件读取器
-  std::ifstream File;
+  CarlaRecorderInputFile File;
   Header Header;
   CarlaRecorderInfo RecInfo;
   CarlaRecorderFrame Frame;
+  //文件末尾的帧索引，旧文件没有索引
+  CarlaRecorderFrameIndex FrameIndex;
+  //跳到关键帧之后，直到读到关键帧为止都忽略事件
+  bool bSeekToKeyframe = false;
   //位置（用于插值）
   std::vector<CarlaRecorderPosition> CurrPos;
   std::vector<CarlaRecorderPosition> PrevPos;
+  //每个 CurrPos 在 PrevPos 中的下标，没有上一个位置时为 -1
+  std::vector<int32> PrevIndex;
+  //UpdatePositions 每次使用的缓冲区，保留以避免重复分配
+  std::vector<int32> UpdateItems;
+  std::vector<uint32_t> UpdateIds;
+  std::vector<FTransform> UpdateTransforms;
   //  映射 ID
   std::unordered_map<uint32_t, uint32_t> MappedId;
   //  时间相关
@@ -128,6 +146,22 @@ private:
   bool IgnoreSpectator { true };
   std::unordered_map<uint32_t, bool> IsHeroMap;
 
+  // benchmark mode
+  struct BenchmarkPacket
+  {
+    uint64_t Count;
+    uint64_t Bytes;
+    double Seconds;
+  };
+  bool bBenchmark { false };
+  std::array<BenchmarkPacket, 256> BenchmarkPackets;
+  uint64_t BenchmarkChecked { 0u };
+  uint64_t BenchmarkMissing { 0u };
+  uint64_t BenchmarkMismatches { 0u };
+  double BenchmarkTolerance { 1.0 };
+  double BenchmarkMaxLocationError { 0.0 };
+  double BenchmarkMaxRotationError { 0.0 };
+
   //实用工具函数
   bool ReadHeader();
 
@@ -137,14 +171,19 @@ private:
 
   void Rewind(void);
 
+  //跳到 Time 之前最近的关键帧
+  void SeekToKeyframe(double Time);
+
   //处理数据包
   void ProcessToTime(double Time, bool IsFirstTime = false);
 
   void ProcessVisualTime(void);
 
   void ProcessEventsAdd(void);
+  void ProcessEventAdd(const CarlaRecorderEventAdd &EventAdd);
   void ProcessEventsDel(void);
   void ProcessEventsParent(void);
+  void ProcessKeyframe(void);
 
   void ProcessPositions(bool IsFirstTime = false);
 
@@ -165,5 +204,6 @@ private:
   // 位置相关
   void UpdatePositions(double Per, double DeltaTime);
 
-  void InterpolatePosition(const CarlaRecorderPosition &Start, const CarlaRecorderPosition &End, double Per, double DeltaTime);
+  // 比较 actor 当前的位置与 CurrPos 中录制的位置
+  void CheckBenchmarkPositions(void);
 };
@@ -122,7 +122,7 @@ FCarlaActor *CarlaReplayerHelper::FindTrafficLightAt(FVector Location)
   // 通过 Registry 中的所有参与者
   for (auto It = Registry.begin(); It != Registry.end(); ++It)
   {
-    FCarlaActor* CarlaActor = It.Value().Get();
+    FCarlaActor* CarlaActor = It->Value.Get();
     if(CarlaActor->GetActorType() == FCarlaActor::ActorType::TrafficLight)
     {
       FVector vec = CarlaActor->GetActorGlobalLocation();
@@ -300,38 +300,63 @@ bool CarlaReplayerHelper::ProcessReplayerEventParent(uint32_t ChildId, uint32_t
 }
 
 // reposition actors
-bool CarlaReplayerHelper::ProcessReplayerPosition(CarlaRecorderPosition Pos1, CarlaRecorderPosition Pos2, double Per, double DeltaTime, bool bIgnoreSpectator)
+FTransform CarlaReplayerHelper::InterpolatePosition(const CarlaRecorderPosition &Pos1, const CarlaRecorderPosition &Pos2, double Per)
 {
-  check(Episode != nullptr);
-  FCarlaActor* CarlaActor = Episode->FindCarlaActor(Pos1.DatabaseId);
   FVector Location;
   FRotator Rotation;
-  if(CarlaActor)
+  // check to assign first position or interpolate between both
+  if (Per == 0.0)
   {
-    //为避免旁观者而修复，我们应该在这里调查为什么这种情况是可能的
-    if(bIgnoreSpectator && CarlaActor->GetActor()->GetClass()->GetFName().ToString().Contains("Spectator"))
-    {
-      return false;
-    }
-    // check to assign first position or interpolate between both
-    if (Per == 0.0)
-    {
-      // assign position 1
-      Location = FVector(Pos1.Location);
-      Rotation = FRotator::MakeFromEuler(Pos1.Rotation);
-    }
-    else
+    // assign position 1
+    Location = FVector(Pos1.Location);
+    Rotation = FRotator::MakeFromEuler(Pos1.Rotation);
+  }
+  else
+  {
+    // interpolate positions
+    Location = FMath::Lerp(FVector(Pos1.Location), FVector(Pos2.Location), Per);
+    Rotation = FMath::Lerp(FRotator::MakeFromEuler(Pos1.Rotation), FRotator::MakeFromEuler(Pos2.Rotation), Per);
+  }
+  return FTransform(Rotation, Location, FVector(1, 1, 1));
+}
+
+// 设置单个 actor 的变换，找不到 actor 或者是需要忽略的旁观者时返回 false
+static bool SetReplayerTransform(FCarlaActor *CarlaActor, const FTransform &Trans, bool bIgnoreSpectator)
+{
+  if (CarlaActor == nullptr)
+  {
+    return false;
+  }
+  //为避免旁观者而修复，我们应该在这里调查为什么这种情况是可能的
+  if (bIgnoreSpectator && CarlaActor->GetActor()->GetClass()->GetFName().ToString().Contains("Spectator"))
+  {
+    return false;
+  }
+  // set new transform
+  CarlaActor->SetActorGlobalTransform(Trans, ETeleportType::None);
+  return true;
+}
+
+bool CarlaReplayerHelper::ProcessReplayerPosition(CarlaRecorderPosition Pos1, CarlaRecorderPosition Pos2, double Per, double DeltaTime, bool bIgnoreSpectator)
+{
+  check(Episode != nullptr);
+  return SetReplayerTransform(Episode->FindCarlaActor(Pos1.DatabaseId), InterpolatePosition(Pos1, Pos2, Per), bIgnoreSpectator);
+}
+
+int CarlaReplayerHelper::ProcessReplayerPositions(const std::vector<uint32_t> &Ids, const std::vector<FTransform> &Transforms, bool bIgnoreSpectator)
+{
+  TRACE_CPUPROFILER_EVENT_SCOPE(CarlaReplayerHelper::ProcessReplayerPositions);
+  check(Episode != nullptr);
+  check(Ids.size() == Transforms.size());
+  int Total = 0;
+  for (size_t i = 0; i < Ids.size(); ++i)
+  {
+    if (SetReplayerTransform(Episode->FindCarlaActor(Ids[i]), Transforms[i], bIgnoreSpectator))
     {
-      // interpolate positions
-      Location = FMath::Lerp(FVector(Pos1.Location), FVector(Pos2.Location), Per);
-      Rotation = FMath::Lerp(FRotator::MakeFromEuler(Pos1.Rotation), FRotator::MakeFromEuler(Pos2.Rotation), Per);
+      ++Total;
     }
-    // set new transform
-    FTransform Trans(Rotation, Location, FVector(1, 1, 1));
-    CarlaActor->SetActorGlobalTransform(Trans, ETeleportType::None);
-    return true;
   }
-  return false;
+  return Total;
 }
 
 void CarlaReplayerHelper::ProcessReplayerAnimVehicleWheels(CarlaRecorderAnimWheels VehicleAnimWheels)
@@ -22,6 +22,7 @@
 
 // 引入标准库中的无序映射（unordered_map）头文件，无序映射可用于存储键值对形式的数据，在本类中可能用于存储如演员 ID 与某些状态等相关的映射关系
 #include <unordered_map>  
+#include <vector>
 
 // 前置声明 UCarlaEpisode 类，告诉编译器存在这样一个类，但其具体定义在其他地方（这样可以避免头文件循环包含等问题），这个类可能代表整个回放的一个剧集或场景相关内容
 class UCarlaEpisode;  
@@ -94,6 +95,12 @@ public:
         // 进行演员重定位的具体操作逻辑，根据传入的参数按照相应规则调整演员位置，并返回操作成功与否的布尔值（true 表示位置调整成功，false 表示失败），函数体内部代码暂未展示
     }
 
+    // 批量设置位置：Ids 与 Transforms 一一对应，返回成功设置位置的 actor 数量
+    int ProcessReplayerPositions(const std::vector<uint32_t> &Ids, const std::vector<FTransform> &Transforms, bool bIgnoreSpectator);
+
+    // 在两个记录的位置之间插值，Per 为 0 时直接使用 Pos1；只做计算，可以在任意线程中调用
+    static FTransform InterpolatePosition(const CarlaRecorderPosition &Pos1, const CarlaRecorderPosition &Pos2, double Per);
+
     // 函数功能注释：处理用于交通灯状态的回放事件，根据传入的交通灯状态信息（包含交通灯的具体状态数据，如红灯、绿灯等状态的表示），在回放场景中设置交通灯的相应状态，并返回一个布尔值表示是否成功设置交通灯状态。
     // 参数说明：
     // @param State 交通灯状态信息，类型为 CarlaRecorderStateTrafficLight，这里面封装了交通灯各种可能的状态以及相关属性，用于准确地还原交通灯在特定时刻的状态。
@@ -0,0 +1,109 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "Carla.h"
+#include "Carla/Sensor/CameraRig.h"
+
+#include "Carla/Game/CarlaEngine.h"
+#include "Carla/Sensor/SceneCaptureSensor.h"
+
+ACameraRig::ACameraRig(const FObjectInitializer &ObjectInitializer)
+  : Super(ObjectInitializer)
+{
+  PrimaryActorTick.bCanEverTick = false;
+}
+
+void ACameraRig::AddCamera(ASceneCaptureSensor *Camera)
+{
+  check(IsInGameThread());
+  if (!IsValid(Camera) || Cameras.Contains(Camera))
+  {
+    return;
+  }
+  if (Camera->Rig != nullptr && Camera->Rig != this)
+  {
+    Camera->Rig->RemoveCamera(Camera);
+  }
+  Camera->Rig = this;
+  Cameras.Add(Camera);
+  ResetReadbackRing();
+}
+
+void ACameraRig::RemoveCamera(ASceneCaptureSensor *Camera)
+{
+  check(IsInGameThread());
+  if (Camera == nullptr || Cameras.Remove(Camera) == 0)
+  {
+    return;
+  }
+  ResetReadbackRing();
+  if (IsValid(Camera))
+  {
+    Camera->Rig = nullptr;
+    Camera->ReadbackRing =
+        MakeShared<FPixelReadbackRing, ESPMode::ThreadSafe>(Camera->ReadbackBufferCount);
+  }
+}
+
+void ACameraRig::CaptureFrame()
+{
+  TRACE_CPUPROFILER_EVENT_SCOPE(ACameraRig::CaptureFrame);
+  check(IsInGameThread());
+  const uint64 Frame = FCarlaEngine::GetFrameCounter();
+  if (Frame == LastCapturedFrame)
+  {
+    return;
+  }
+  LastCapturedFrame = Frame;
+  for (ASceneCaptureSensor *Camera : Cameras)
+  {
+    if (!IsValid(Camera) || !Camera->HasActorBegunPlay())
+    {
+      continue;
+    }
+    if (Camera->IsMultipartGBufferRequested())
+    {
+      Camera->CaptureSceneExtended();
+    }
+    else
+    {
+      Camera->GetCaptureComponent2D()->CaptureScene();
+    }
+  }
+}
+
+void ACameraRig::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+  while (Cameras.Num() > 0)
+  {
+    RemoveCamera(Cameras.Last());
+  }
+  Super::EndPlay(EndPlayReason);
+}
+
+void ACameraRig::ResetReadbackRing()
+{
+  // Send the frames in flight before the cameras switch to the new ring.
+  if (ReadbackRing.IsValid())
+  {
+    FlushRenderingCommands();
+    ReadbackRing->Flush();
+    ReadbackRing.Reset();
+  }
+  if (Cameras.Num() == 0)
+  {
+    return;
+  }
+  ReadbackRing = MakeShared<FPixelReadbackRing, ESPMode::ThreadSafe>(
+      FMath::Max(ReadbackBuffersPerCamera, 1u) * Cameras.Num());
+  for (ASceneCaptureSensor *Camera : Cameras)
+  {
+    if (IsValid(Camera))
+    {
+      Camera->ReadbackRing = ReadbackRing;
+    }
+  }
+}
@@ -0,0 +1,78 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "Carla/Sensor/PixelReader.h"
+
+#include "GameFramework/Actor.h"
+
+#include "CameraRig.generated.h"
+
+class ASceneCaptureSensor;
+
+/// Groups co-located camera sensors, e.g. the surround cameras of a vehicle,
+/// so they are captured and read back together.
+///
+/// The first camera of the rig that ticks in a frame captures the scene for all
+/// of them, back to back, so the render thread processes the captures together
+/// before any of their readback copies. All the cameras share a single
+/// FPixelReadbackRing, so one worker maps the pixels of the whole rig in order.
+///
+/// @note Every capture still renders its own view family, UE4 scene captures do
+/// not share the scene traversal between views. The cameras of a rig should use
+/// the same sensor tick, otherwise cameras that do not send data in a frame are
+/// captured anyway.
+UCLASS(Blueprintable)
+class CARLA_API ACameraRig : public AActor
+{
+  GENERATED_BODY()
+
+public:
+
+  ACameraRig(const FObjectInitializer &ObjectInitializer);
+
+  /// Add @a Camera to the rig. A camera can only belong to one rig.
+  UFUNCTION(BlueprintCallable, Category = "CARLA|Sensor")
+  void AddCamera(ASceneCaptureSensor *Camera);
+
+  /// Remove @a Camera from the rig, it goes back to capturing on its own.
+  UFUNCTION(BlueprintCallable, Category = "CARLA|Sensor")
+  void RemoveCamera(ASceneCaptureSensor *Camera);
+
+  UFUNCTION(BlueprintCallable, Category = "CARLA|Sensor")
+  const TArray<ASceneCaptureSensor *> &GetCameras() const
+  {
+    return Cameras;
+  }
+
+  /// Capture the scene for all the cameras of the rig, only the first call in
+  /// each frame does anything.
+  ///
+  /// @pre To be called from game-thread.
+  void CaptureFrame();
+
+protected:
+
+  void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+  /// Number of readback buffers in flight per camera.
+  UPROPERTY(EditAnywhere, Category = "CARLA|Sensor")
+  uint32 ReadbackBuffersPerCamera = 2u;
+
+private:
+
+  /// Replace the readback ring of the cameras by a new one sized for the
+  /// current number of cameras.
+  void ResetReadbackRing();
+
+  UPROPERTY()
+  TArray<ASceneCaptureSensor *> Cameras;
+
+  TSharedPtr<FPixelReadbackRing, ESPMode::ThreadSafe> ReadbackRing;
+
+  uint64 LastCapturedFrame = TNumericLimits<uint64>::Max();
+};
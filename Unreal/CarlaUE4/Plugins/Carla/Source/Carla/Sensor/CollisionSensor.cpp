@@ -25,9 +25,26 @@ ACollisionSensor::ACollisionSensor(const FObjectInitializer& ObjectInitializer)
 
 FActorDefinition ACollisionSensor::GetSensorDefinition()
 {
-  return UActorBlueprintFunctionLibrary::MakeGenericSensorDefinition(
+  FActorDefinition Definition = UActorBlueprintFunctionLibrary::MakeGenericSensorDefinition(
       TEXT("other"),
       TEXT("collision"));
+  // 为真时每帧只发送冲量最大的碰撞
+  FActorVariation Summarize;
+  Summarize.Id = TEXT("summarize");
+  Summarize.Type = EActorAttributeType::Bool;
+  Summarize.RecommendedValues = { TEXT("false") };
+  Summarize.bRestrictToRecommended = false;
+  Definition.Variations.Emplace(Summarize);
+  return Definition;
+}
+
+void ACollisionSensor::Set(const FActorDescription &Description)
+{
+  Super::Set(Description);
+  bSummarize = UActorBlueprintFunctionLibrary::RetrieveActorAttributeToBool(
+      "summarize",
+      Description.Variations,
+      bSummarize);
 }
 
 void ACollisionSensor::SetOwner(AActor *NewOwner)
@@ -61,20 +78,43 @@ void ACollisionSensor::SetOwner(AActor *NewOwner)
   }
 }
 
-void ACollisionSensor::PrePhysTick(float DeltaSeconds) {
-  Super::PrePhysTick(DeltaSeconds);
+void ACollisionSensor::PostPhysTick(UWorld *World, ELevelTick TickType, float DeltaSeconds)
+{
+  TRACE_CPUPROFILER_EVENT_SCOPE(ACollisionSensor::PostPhysTick);
+  if (PendingCollisions.Num() == 0)
+  {
+    return;
+  }
 
-  // 删除前一帧中的所有项目
-  uint64_t CurrentFrame = FCarlaEngine::GetFrameCounter();
-  CollisionRegistry.erase(
-      std::remove_if(
-          CollisionRegistry.begin(),
-          CollisionRegistry.end(),
-          [CurrentFrame](std::tuple<uint64_t, AActor*, AActor*> Item)
-          {
-            return std::get<0>(Item) < CurrentFrame;
-          }),
-      CollisionRegistry.end());
+  if (bSummarize)
+  {
+    const FPendingCollision *Strongest = nullptr;
+    for (const FPendingCollision &Collision : PendingCollisions)
+    {
+      if (Collision.Actor.IsValid() && Collision.OtherActor.IsValid() &&
+          (Strongest == nullptr ||
+           Collision.NormalImpulse.SizeSquared() > Strongest->NormalImpulse.SizeSquared()))
+      {
+        Strongest = &Collision;
+      }
+    }
+    if (Strongest != nullptr)
+    {
+      SendCollision(*Strongest);
+    }
+  }
+  else
+  {
+    for (const FPendingCollision &Collision : PendingCollisions)
+    {
+      // 参与者可能在碰撞之后被销毁
+      if (Collision.Actor.IsValid() && Collision.OtherActor.IsValid())
+      {
+        SendCollision(Collision);
+      }
+    }
+  }
+  PendingCollisions.Reset();
 }
 
 void ACollisionSensor::OnCollisionEvent(
@@ -99,36 +139,44 @@ void ACollisionSensor::OnCollisionEvent(
 
   uint64_t CurrentFrame = FCarlaEngine::GetFrameCounter();
 
-  // 检查此帧中是否已处理此碰撞
-  for (auto& Collision: CollisionRegistry)
+  // 检查此帧中是否已处理此碰撞，是的话只保留最大的冲量
+  for (FPendingCollision &Collision : PendingCollisions)
   {
-    if (std::get<0>(Collision) == CurrentFrame &&
-        std::get<1>(Collision) == Actor &&
-        std::get<2>(Collision) == OtherActor)
+    if (Collision.Frame == CurrentFrame &&
+        Collision.Actor.Get() == Actor &&
+        Collision.OtherActor.Get() == OtherActor)
     {
+      if (NormalImpulse.SizeSquared() > Collision.NormalImpulse.SizeSquared())
+      {
+        Collision.NormalImpulse = NormalImpulse;
+      }
       return;
     }
   }
 
+  // 记录碰撞事件
+  const auto& CurrentEpisode = GetEpisode();
+  if (CurrentEpisode.GetRecorder()->IsEnabled()){
+      CurrentEpisode.GetRecorder()->AddCollision(Actor, OtherActor);
+  }
+
+  PendingCollisions.Add(FPendingCollision{CurrentFrame, Actor, OtherActor, NormalImpulse});
+}
+
+void ACollisionSensor::SendCollision(const FPendingCollision &Collision)
+{
   const auto& CurrentEpisode = GetEpisode();
   constexpr float TO_METERS = 1e-2;
-  NormalImpulse *= TO_METERS;
+  const FVector NormalImpulse = Collision.NormalImpulse * TO_METERS;
   GetDataStream(*this).SerializeAndSend(
       *this,
-      CurrentEpisode.SerializeActor(Actor),
-      CurrentEpisode.SerializeActor(OtherActor),
+      CurrentEpisode.SerializeActor(Collision.Actor.Get()),
+      CurrentEpisode.SerializeActor(Collision.OtherActor.Get()),
       carla::geom::Vector3D(
           (float)NormalImpulse.X,
           (float)NormalImpulse.Y,
           (float)NormalImpulse.Z));
 
-  // 记录碰撞事件
-  if (CurrentEpisode.GetRecorder()->IsEnabled()){
-      CurrentEpisode.GetRecorder()->AddCollision(Actor, OtherActor);
-  }
-
-  CollisionRegistry.emplace_back(CurrentFrame, Actor, OtherActor);
-
   // ROS2
 #if defined(WITH_ROS2)
   auto ROS2 = carla::ros2::ROS2::GetInstance();
@@ -140,11 +188,11 @@ void ACollisionSensor::OnCollisionEvent(
     if (ParentActor)
     {
       FTransform LocalTransformRelativeToParent = GetActorTransform().GetRelativeTransform(ParentActor->GetActorTransform());
-      ROS2->ProcessDataFromCollisionSensor(0, StreamId, LocalTransformRelativeToParent, OtherActor->GetUniqueID(), carla::geom::Vector3D{NormalImpulse.X, NormalImpulse.Y, NormalImpulse.Z}, this);
+      ROS2->ProcessDataFromCollisionSensor(0, StreamId, LocalTransformRelativeToParent, Collision.OtherActor->GetUniqueID(), carla::geom::Vector3D{NormalImpulse.X, NormalImpulse.Y, NormalImpulse.Z}, this);
     }
     else
     {
-      ROS2->ProcessDataFromCollisionSensor(0, StreamId, GetActorTransform(), OtherActor->GetUniqueID(), carla::geom::Vector3D{NormalImpulse.X, NormalImpulse.Y, NormalImpulse.Z}, this);
+      ROS2->ProcessDataFromCollisionSensor(0, StreamId, GetActorTransform(), Collision.OtherActor->GetUniqueID(), carla::geom::Vector3D{NormalImpulse.X, NormalImpulse.Y, NormalImpulse.Z}, this);
     }
   }
 #endif
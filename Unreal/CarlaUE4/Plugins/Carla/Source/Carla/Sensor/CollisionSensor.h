@@ -7,6 +7,7 @@
 #pragma once
 
 #include "Carla/Actor/ActorDefinition.h"
+#include "Carla/Actor/ActorDescription.h"
 #include "Carla/Sensor/Sensor.h"
 
 #include "CollisionSensor.generated.h"
@@ -26,7 +27,9 @@ public:
 
   ACollisionSensor(const FObjectInitializer& ObjectInitializer);
 
-  virtual void PrePhysTick(float DeltaSeconds) override;
+  void Set(const FActorDescription &Description) override;
+
+  virtual void PostPhysTick(UWorld *World, ELevelTick TickType, float DeltaSeconds) override;
   void SetOwner(AActor *NewOwner) override;
 
   UFUNCTION()
@@ -52,7 +55,25 @@ public:
       const FHitResult& Hit);
 
 private:
-  /// 保存所有碰撞的注册表。
-  /// 用于避免每帧发送多次相同的碰撞，因为碰撞传感器使用 PhysX 子步节拍信号。有助于传感器的使用和流过载。
-  std::vector<std::tuple<uint64_t, AActor*, AActor*>> CollisionRegistry;
+
+  struct FPendingCollision
+  {
+    uint64_t Frame;
+    /// 数组不是 UPROPERTY，垃圾回收不会清空裸指针，所以使用弱指针。
+    TWeakObjectPtr<AActor> Actor;
+    TWeakObjectPtr<AActor> OtherActor;
+    /// 所有接触中最大的法向冲量（厘米单位）。
+    FVector NormalImpulse;
+  };
+
+  /// 发送一个碰撞事件，两个参与者都必须仍然有效。
+  void SendCollision(const FPendingCollision &Collision);
+
+  /// 本帧尚未发送的碰撞，每一帧每对参与者只保留一项。
+  /// 碰撞传感器使用 PhysX 子步回调，摩擦接触每帧会触发很多次，
+  /// 合并后在 PostPhysTick 中统一发送，减少流的消息数量。
+  TArray<FPendingCollision> PendingCollisions;
+
+  /// 为真时每帧只发送冲量最大的一个碰撞。
+  bool bSummarize = false;
 };
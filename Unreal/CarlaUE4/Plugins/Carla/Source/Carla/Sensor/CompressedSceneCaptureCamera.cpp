@@ -0,0 +1,77 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "Carla.h"
+#include "Carla/Sensor/CompressedSceneCaptureCamera.h"
+
+#include "Actor/ActorBlueprintFunctionLibrary.h"
+#include "Carla/Sensor/PixelReader.h"
+
+#include "IImageWrapper.h"
+#include "IImageWrapperModule.h"
+#include "Modules/ModuleManager.h"
+
+FActorDefinition ACompressedSceneCaptureCamera::GetSensorDefinition()
+{
+  constexpr bool bEnableModifyingPostProcessEffects = true;
+  auto Definition = UActorBlueprintFunctionLibrary::MakeCameraDefinition(
+      TEXT("rgb_compressed"),
+      bEnableModifyingPostProcessEffects);
+
+  FActorVariation Quality;
+  Quality.Id = TEXT("compression_quality");  // JPEG 压缩质量，范围为 [1, 100]
+  Quality.Type = EActorAttributeType::Int;
+  Quality.RecommendedValues = { TEXT("90") };
+  Quality.bRestrictToRecommended = false;
+
+  Definition.Variations.Append({ Quality });
+  return Definition;
+}
+
+ACompressedSceneCaptureCamera::ACompressedSceneCaptureCamera(const FObjectInitializer &ObjectInitializer)
+  : Super(ObjectInitializer) {}
+
+void ACompressedSceneCaptureCamera::Set(const FActorDescription &Description)
+{
+  Super::Set(Description);
+
+  CompressionQuality = FMath::Clamp(
+      UActorBlueprintFunctionLibrary::RetrieveActorAttributeToInt(
+          "compression_quality",
+          Description.Variations,
+          CompressionQuality),
+      1,
+      100);
+}
+
+void ACompressedSceneCaptureCamera::BeginPlay()
+{
+  // The module has to be loaded from the game-thread, the encoding happens in
+  // the readback worker.
+  ImageWrapperModule = &FModuleManager::LoadModuleChecked<IImageWrapperModule>(TEXT("ImageWrapper"));
+  Super::BeginPlay();
+}
+
+void ACompressedSceneCaptureCamera::PostPhysTick(UWorld *World, ELevelTick TickType, float DeltaSeconds)
+{
+  TRACE_CPUPROFILER_EVENT_SCOPE(ACompressedSceneCaptureCamera::PostPhysTick);
+  check(ImageWrapperModule != nullptr);
+
+  std::function<TArray<uint8>(void *, uint32)> Conversor =
+      [Module = ImageWrapperModule, Width = GetImageWidth(), Height = GetImageHeight(), Quality = CompressionQuality](void *Data, uint32 Size)
+  {
+    TArray<uint8> Encoded;
+    TSharedPtr<IImageWrapper> ImageWrapper = Module->CreateImageWrapper(EImageFormat::JPEG);
+    if (ImageWrapper.IsValid() &&
+        ImageWrapper->SetRaw(Data, Size, Width, Height, ERGBFormat::BGRA, 8))
+    {
+      const TArray64<uint8> &Compressed = ImageWrapper->GetCompressed(Quality);
+      Encoded.Append(Compressed.GetData(), static_cast<int32>(Compressed.Num()));
+    }
+    return Encoded;
+  };
+  FPixelReader::SendPixelsInRenderThread<ACompressedSceneCaptureCamera, uint8>(*this, false, Conversor);
+}
@@ -0,0 +1,43 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "Carla/Sensor/SceneCaptureCamera.h"
+
+#include "CompressedSceneCaptureCamera.generated.h"
+
+class IImageWrapperModule;
+
+/// A RGB camera that encodes every image as JPEG before sending it, so remote
+/// clients receive a fraction of the raw BGRA bytes.
+UCLASS()
+class CARLA_API ACompressedSceneCaptureCamera : public ASceneCaptureCamera
+{
+  GENERATED_BODY()
+
+public:
+
+  static FActorDefinition GetSensorDefinition();
+
+  ACompressedSceneCaptureCamera(const FObjectInitializer &ObjectInitializer);
+
+  void Set(const FActorDescription &ActorDescription) override;
+
+protected:
+
+  void BeginPlay() override;
+
+  void PostPhysTick(UWorld *World, ELevelTick TickType, float DeltaSeconds) override;
+
+private:
+
+  /// JPEG quality, from 1 to 100.
+  UPROPERTY(EditAnywhere)
+  int32 CompressionQuality = 90;
+
+  IImageWrapperModule *ImageWrapperModule = nullptr;
+};
@@ -6,6 +6,7 @@
 
 #include "Carla.h"
 #include "Carla/Actor/ActorBlueprintFunctionLibrary.h"
+#include "Carla/Game/CarlaEngine.h"
 #include "Carla/Game/CarlaEpisode.h"
 #include "Carla/Vehicle/CarlaWheeledVehicle.h"
 #include <string>
@@ -16,6 +17,7 @@
 
 std::list<AActor *> ACustomV2XSensor::mV2XActorContainer;
 ACustomV2XSensor::ActorV2XDataMap ACustomV2XSensor::mActorV2XDataMap;
+V2XMedium ACustomV2XSensor::mMedium;
 
 ACustomV2XSensor::ACustomV2XSensor(const FObjectInitializer &ObjectInitializer)
     : Super(ObjectInitializer)
@@ -142,6 +144,18 @@ void ACustomV2XSensor::CreateITSPduHeader(CustomV2XM_t &message)
     header.stationID = mStationId;
 }
 
+/*
+*在任何自定义V2X传感器执行PostPhysTick之前，把当前参与者登记为本周期共享信道的接收者
+*/
+void ACustomV2XSensor::BeginPostPhysTick(UWorld *World, float DeltaSeconds)
+{
+    if (GetOwner())
+    {
+        ACustomV2XSensor::mMedium.BeginFrame(FCarlaEngine::GetFrameCounter());
+        ACustomV2XSensor::mMedium.AddReceiver(GetOwner(), PathLossModelObj->GetFilterDistance());
+    }
+}
+
 /*
 *函数负责向当前参与者发送消息。
 *首先通过调用LOSComm对象来模拟通信。
@@ -151,25 +165,35 @@ void ACustomV2XSensor::PostPhysTick(UWorld *World, ELevelTick TickType, float De
 {
     TRACE_CPUPROFILER_EVENT_SCOPE(ACustomV2XSensor::PostPhysTick);
 
-    //步骤1：创建一个参与者列表，其中包含要针对此v2x传感器实例发送的消息
-    std::vector<ActorPowerPair> ActorPowerList;
-    for (const auto &pair : ACustomV2XSensor::mActorV2XDataMap)
+    UCarlaEpisode *carla_episode = UCarlaStatics::GetCurrentEpisode(GetWorld());
+
+    //步骤0：本周期第一个执行的传感器为所有接收者计算共享信道
+    if (!ACustomV2XSensor::mMedium.IsUpdated())
     {
-        if (pair.first != GetOwner())
+        std::vector<AActor *> Senders;
+        Senders.reserve(ACustomV2XSensor::mActorV2XDataMap.size());
+        for (const auto &pair : ACustomV2XSensor::mActorV2XDataMap)
         {
-            ActorPowerPair actor_power_pair;
-            actor_power_pair.first = pair.first;
-            //以发射功率发送的演员
-            actor_power_pair.second = pair.second.Power;
-            ActorPowerList.push_back(actor_power_pair);
+            Senders.push_back(pair.first);
         }
+        ACustomV2XSensor::mMedium.Update(GetWorld(), carla_episode, Senders);
+    }
+
+    //步骤1：创建一个参与者列表，其中包含通信范围内要针对此v2x传感器实例发送的消息
+    std::vector<ActorPowerPair> ActorPowerList;
+    for (const FV2XLink &link : ACustomV2XSensor::mMedium.GetLinks(GetOwner()))
+    {
+        ActorPowerPair actor_power_pair;
+        actor_power_pair.first = link.Sender;
+        //以发射功率发送的演员
+        actor_power_pair.second = ACustomV2XSensor::mActorV2XDataMap.at(link.Sender).Power;
+        ActorPowerList.push_back(actor_power_pair);
     }
 
     //步骤2：模拟参与者列表中的参与者与当前参与者的通信。
     if (!ActorPowerList.empty())
     {
-        UCarlaEpisode *carla_episode = UCarlaStatics::GetCurrentEpisode(GetWorld());
-        PathLossModelObj->Simulate(ActorPowerList, carla_episode, GetWorld());
+        PathLossModelObj->Simulate(ActorPowerList, ACustomV2XSensor::mMedium, carla_episode, GetWorld());
         //步骤3：获取可以向当前参与者发送消息的参与者列表，以及他们的消息的接收能力。
         ActorPowerMap actor_receivepower_map = PathLossModelObj->GetReceiveActorPowerList();
         //步骤4：检索收到的参与者的消息
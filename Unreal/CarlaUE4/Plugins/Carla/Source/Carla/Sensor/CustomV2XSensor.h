@@ -11,6 +11,7 @@
 #include "Carla/Actor/ActorDescription.h"
 #include <carla/sensor/data/V2XData.h>
 #include "V2X/PathLossModel.h"
+#include "V2X/V2XMedium.h"
 #include <list>
 #include <map>
 #include "CustomV2XSensor.generated.h"
@@ -44,6 +45,7 @@ public:
     void SetPathLossModel(const EPathLossModel path_loss_model);
     
     virtual void PrePhysTick(float DeltaSeconds) override;
+    virtual void BeginPostPhysTick(UWorld *World, float DeltaSeconds) override;
     virtual void PostPhysTick(UWorld *World, ELevelTick TickType, float DeltaTime) override;
     void SetOwner(AActor *Owner) override;
 
@@ -55,6 +57,8 @@ private:
 
     //store data
     static ACustomV2XSensor::ActorV2XDataMap mActorV2XDataMap;
+    //本周期所有自定义V2X传感器共享的信道
+    static V2XMedium mMedium;
     FV2XData mV2XData;
 
     //write
@@ -13,6 +13,10 @@
 #include "Carla/Util/RandomEngine.h"
 #include "Carla/Sensor/DVSCamera.h"
 #include "Actor/ActorBlueprintFunctionLibrary.h"
+#include "PixelConversion.h"
+
+#include "HAL/IConsoleManager.h"
+#include "Runtime/Core/Public/Async/ParallelFor.h"
 
 #include <compiler/disable-ue4-macros.h>
 #include "carla/ros2/ROS2.h"
@@ -20,6 +24,14 @@
 #include <carla/BufferView.h>
 #include <compiler/enable-ue4-macros.h>
 
+static TAutoConsoleVariable<int32> CVarDVSOnGPU(
+    TEXT("carla.Sensor.DVSOnGPU"),
+    1,
+    TEXT("If 1, DVS cameras generate their events in a compute shader and read ")
+    TEXT("back only the events. If 0, or without SM5, the image is read back and ")
+    TEXT("the events are generated on the CPU."),
+    ECVF_Default);
+
 // RGB图像的灰度值：I = 0.2989*R + 0.5870*G + 0.1140*B
 static float FColorToGrayScaleFloat(FColor Color)
 {
@@ -144,23 +156,31 @@ void ADVSCamera::PostPhysTick(UWorld *World, ELevelTick TickType, float DeltaTim
   EnqueueRenderSceneImmediate();
   WaitForRenderThreadToFinish();
 
-  //Super (ASceneCaptureSensor) Capture the Scene in a (UTextureRenderTarget2D) CaptureRenderTarge from the CaptureComponent2D
-  /** 读取图像 **/
-  TArray<FColor> RawImage;
-  this->ReadPixels(RawImage);
-
-  /** 将图像转换为灰度图 **/
-  if (this->config.use_log)
+  ADVSCamera::DVSEventArray events;
+  if (CVarDVSOnGPU.GetValueOnGameThread() != 0 && IsCarlaPixelConversionSupported())
   {
-    this->ImageToLogGray(RawImage);
+    events = this->SimulationOnGPU();
   }
   else
   {
-    this->ImageToGray(RawImage);
-  }
+    //Super (ASceneCaptureSensor) Capture the Scene in a (UTextureRenderTarget2D) CaptureRenderTarge from the CaptureComponent2D
+    /** 读取图像 **/
+    TArray<FColor> RawImage;
+    this->ReadPixels(RawImage);
+
+    /** 将图像转换为灰度图 **/
+    if (this->config.use_log)
+    {
+      this->ImageToLogGray(RawImage);
+    }
+    else
+    {
+      this->ImageToGray(RawImage);
+    }
 
-  /** 动态视觉传感器仿真器 **/
-  ADVSCamera::DVSEventArray events = this->Simulation(DeltaTime);
+    /** 动态视觉传感器仿真器 **/
+    events = this->Simulation(DeltaTime);
+  }
 
   auto Stream = GetDataStream(*this);       // 获得数据流
   auto Buff = Stream.PopBufferFromPool();   // 从内存池中获取一个内存缓冲，用于存数据
@@ -278,68 +298,109 @@ ADVSCamera::DVSEventArray ADVSCamera::Simulation (float DeltaTime)
   const std::uint64_t delta_t_ns = dvs::secToNanosec(
       this->GetEpisode().GetElapsedGameTime()) - this->current_time;
 
-  /** 沿着图像大小循环 **/
-  for (uint32 y = 0; y < this->GetImageHeight(); ++y)
+  /** 先找出亮度有变化的像素，这个循环没有分支依赖，可以被编译器向量化 **/
+  const int32 num_pixels = this->last_image.Num();
+  changed_pixels.Reset(num_pixels);
   {
-    for (uint32 x = 0; x < this->GetImageWidth(); ++x)
+    const float *last = this->last_image.GetData();
+    const float *prev = this->prev_image.GetData();
+    for (int32 i = 0; i < num_pixels; ++i)
     {
-      const uint32 i = (this->GetImageWidth() * y) + x;  // 将2维中的索引转换为1维中的索引
+      if (std::fabs(prev[i] - last[i]) > tolerance)
+      {
+        changed_pixels.Add(i);
+      }
+    }
+  }
+  const int32 num_changed = changed_pixels.Num();
+
+  /** 阈值噪声整批生成，每个有变化的像素一个标准正态分布的随机数 **/
+  const bool use_noise = this->config.sigma_Cp > 0 || this->config.sigma_Cm > 0;
+  if (use_noise)
+  {
+    threshold_noise.SetNumUninitialized(num_changed);
+    RandomEngine->FillNormalFloat(threshold_noise.GetData(), num_changed, 0.0f, 1.0f);
+  }
+
+  /** 每个块的像素互相独立，并行生成事件后再按块的顺序合并 **/
+  constexpr int32 pixels_per_chunk = 4096;
+  const int32 num_chunks = (num_changed + pixels_per_chunk - 1) / pixels_per_chunk;
+  std::vector<ADVSCamera::DVSEventArray> chunk_events(num_chunks);
+  const uint32 width = this->GetImageWidth();
+
+  ParallelFor(num_chunks, [&](int32 chunk)
+  {
+    ADVSCamera::DVSEventArray &out = chunk_events[chunk];
+    const int32 end = std::min(num_changed, (chunk + 1) * pixels_per_chunk);
+    for (int32 k = chunk * pixels_per_chunk; k < end; ++k)
+    {
+      const uint32 i = changed_pixels[k];
+      const uint32 x = i % width;
+      const uint32 y = i / width;
       const float itdt = this->last_image[i];  // 先前图像过了时间增量dt后的图像（即最新的图像）在索引为i位置的像素值
       const float it = this->prev_image[i];  // 先前的图像 在索引为i的像素值
       const float prev_cross = this->ref_values[i];
 
-      if (std::fabs (it - itdt) > tolerance)  // 如果前后的像素亮度变化超过阈值
+      // 根据像素亮度变化的符号来判断事件的极性(polarity)。
+      // `+1`当亮度增加时极性为正，`-1`当亮度减少时极性为负。
+      const float pol = (itdt >= it) ? +1.0 : -1.0;
+      float C = (pol > 0) ? this->config.Cp : this->config.Cm;  // Cp正事件(positive)，Cm负事件。对比度门限值（C,contrast threshold）
+      const float sigma_C = (pol > 0) ? this->config.sigma_Cp : this->config.sigma_Cm;
+
+      if(sigma_C > 0)
       {
-        // 根据像素亮度变化的符号来判断事件的极性(polarity)。
-        // `+1`当亮度增加时极性为正，`-1`当亮度减少时极性为负。
-        const float pol = (itdt >= it) ? +1.0 : -1.0;
-        float C = (pol > 0) ? this->config.Cp : this->config.Cm;  // Cp正事件(positive)，Cm负事件。对比度门限值（C,contrast threshold）
-        const float sigma_C = (pol > 0) ? this->config.sigma_Cp : this->config.sigma_Cm;
+        C += sigma_C * threshold_noise[k];
+        constexpr float minimum_contrast_threshold = 0.01;
+        C = std::max(minimum_contrast_threshold, C);  // 返回两个值中的最大值
+      }
+      float curr_cross = prev_cross;
+      bool all_crossings = false;
 
-        if(sigma_C > 0)
-        {
-          C += RandomEngine->GetNormalDistribution(0, sigma_C);
-          constexpr float minimum_contrast_threshold = 0.01;
-          C = std::max(minimum_contrast_threshold, C);  // 返回两个值中的最大值
-        }
-        float curr_cross = prev_cross;
-        bool all_crossings = false;
+      do
+      {
+        curr_cross += pol * C;
 
-        do
+        if ((pol > 0 && curr_cross > it && curr_cross <= itdt)
+            || (pol < 0 && curr_cross < it && curr_cross >= itdt))
         {
-          curr_cross += pol * C;
+          const std::uint64_t edt = (curr_cross - it) * delta_t_ns / (itdt - it);
+          const std::int64_t t = this->current_time + edt;
 
-          if ((pol > 0 && curr_cross > it && curr_cross <= itdt)
-              || (pol < 0 && curr_cross < it && curr_cross >= itdt))
+          // 检查像素(x,y)当前不处于“不应”状态
+          // i.e. |t - that last_timestamp(x,y)| >= refractory_period
+          const std::int64_t last_stamp_at_xy = dvs::secToNanosec(this->last_event_timestamp[i]);
+          if (t >= last_stamp_at_xy)
           {
-            const std::uint64_t edt = (curr_cross - it) * delta_t_ns / (itdt - it);
-            const std::int64_t t = this->current_time + edt;
-
-            // 检查像素(x,y)当前不处于“不应”状态
-            // i.e. |t - that last_timestamp(x,y)| >= refractory_period
-            const std::int64_t last_stamp_at_xy = dvs::secToNanosec(this->last_event_timestamp[i]);
-            if (t >= last_stamp_at_xy)
+            const std::uint64_t dt = t - last_stamp_at_xy;
+            if(this->last_event_timestamp[i] == 0 || dt >= this->config.refractory_period_ns)
             {
-              const std::uint64_t dt = t - last_stamp_at_xy;
-              if(this->last_event_timestamp[i] == 0 || dt >= this->config.refractory_period_ns)
-              {
-                events.push_back(::carla::sensor::data::DVSEvent(x, y, t, pol > 0));
-                this->last_event_timestamp[i] = dvs::nanosecToSecTrunc(t);
-              }
-              else
-              {
-                /** 取消事件，因为距离上次事件的时间 小于 不应期refractory_period_ns **/
-              }
-              this->ref_values[i] = curr_cross;
+              out.push_back(::carla::sensor::data::DVSEvent(x, y, t, pol > 0));
+              this->last_event_timestamp[i] = dvs::nanosecToSecTrunc(t);
             }
+            else
+            {
+              /** 取消事件，因为距离上次事件的时间 小于 不应期refractory_period_ns **/
+            }
+            this->ref_values[i] = curr_cross;
           }
-          else
-          {
-            all_crossings = true;
-          }
-        } while (!all_crossings);
-      } // end tolerance
-    } // end for each pixel
+        }
+        else
+        {
+          all_crossings = true;
+        }
+      } while (!all_crossings);
+    } // end for each changed pixel
+  });
+
+  size_t num_events = 0u;
+  for (const auto &chunk : chunk_events)
+  {
+    num_events += chunk.size();
+  }
+  events.reserve(num_events);
+  for (const auto &chunk : chunk_events)
+  {
+    events.insert(events.end(), chunk.begin(), chunk.end());
   }
 
   /** 更新当前时间 **/
@@ -352,3 +413,78 @@ ADVSCamera::DVSEventArray ADVSCamera::Simulation (float DeltaTime)
 
   return events;
 }
+
+// 在GPU上执行仿真
+ADVSCamera::DVSEventArray ADVSCamera::SimulationOnGPU()
+{
+  TRACE_CPUPROFILER_EVENT_SCOPE(ADVSCamera::SimulationOnGPU);
+  ADVSCamera::DVSEventArray events;
+
+  if (!GPUState.IsValid())
+  {
+    GPUState = MakeShared<FCarlaDVSState, ESPMode::ThreadSafe>();
+  }
+
+  const std::int64_t now = dvs::secToNanosec(this->GetEpisode().GetElapsedGameTime());
+  // 着色器中的时间是32位的纳秒数，最长约4.29秒
+  const uint32 delta_t_ns = bGPUStateInitialized ?
+      static_cast<uint32>(FMath::Clamp<std::int64_t>(now - this->current_time, 0, MAX_uint32)) : 0u;
+
+  FCarlaDVSConfig Config;
+  Config.Cp = this->config.Cp;
+  Config.Cm = this->config.Cm;
+  Config.SigmaCp = this->config.sigma_Cp;
+  Config.SigmaCm = this->config.sigma_Cm;
+  Config.RefractoryPeriodNs = static_cast<uint32>(
+      std::min<std::uint64_t>(this->config.refractory_period_ns, MAX_uint32));
+  Config.bUseLog = this->config.use_log;
+  Config.LogEps = this->config.log_eps;
+
+  const bool use_noise = Config.SigmaCp > 0 || Config.SigmaCm > 0;
+  const uint32 noise_seed = use_noise ?
+      static_cast<uint32>(RandomEngine->GetUniformIntInRange(0, MAX_int32)) : 0u;
+
+  TArray<FCarlaDVSGPUEvent> gpu_events;
+  uint32 dropped = 0u;
+  ENQUEUE_RENDER_COMMAND(FDVSCamera_SimulateEvents)
+  (
+    [State = GPUState, Resource = CaptureRenderTarget->GameThread_GetRenderTargetResource(), Config, delta_t_ns, noise_seed, &gpu_events, &dropped](FRHICommandListImmediate &RHICmdList)
+    {
+      dropped = SimulateCarlaDVSEvents(
+          RHICmdList,
+          Resource->GetRenderTargetTexture(),
+          Config,
+          delta_t_ns,
+          noise_seed,
+          *State,
+          gpu_events);
+    }
+  );
+  FlushRenderingCommands();
+
+  if (dropped > 0u)
+  {
+    UE_LOG(LogCarla, Warning, TEXT("%s: %u events dropped, too many for the GPU event buffer."), *GetName(), dropped);
+  }
+
+  if (bGPUStateInitialized)
+  {
+    events.reserve(gpu_events.Num());
+    for (const FCarlaDVSGPUEvent &gpu_event : gpu_events)
+    {
+      events.emplace_back(
+          static_cast<std::uint16_t>(gpu_event.X & 0xFFFFu),
+          static_cast<std::uint16_t>(gpu_event.X >> 16),
+          this->current_time + static_cast<std::int64_t>(gpu_event.Y),
+          gpu_event.Z != 0u);
+    }
+    // 通过增加时间戳对事件进行排序，因为这是大多数事件处理算法所期望的
+    std::sort(events.begin(), events.end(), [](const ::carla::sensor::data::DVSEvent& it1, const ::carla::sensor::data::DVSEvent& it2){return it1.t < it2.t;});
+  }
+  bGPUStateInitialized = true;
+
+  /** 更新当前时间 **/
+  this->current_time = now;
+
+  return events;
+}
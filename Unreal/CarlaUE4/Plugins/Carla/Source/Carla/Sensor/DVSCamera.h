@@ -14,6 +14,7 @@
 
 #include "Carla/Sensor/SceneCaptureSensor.h"
 #include "Sensor/ShaderBasedSensor.h"
+#include "DVSEvents.h"
 #include <carla/sensor/data/DVSEvent.h>
 
 #include "DVSCamera.generated.h"
@@ -64,7 +65,20 @@ protected:
   void ImageToLogGray(const TArray<FColor> &image);
   ADVSCamera::DVSEventArray Simulation (float DeltaTime);
 
+  /// 在GPU上用计算着色器生成事件，只回读稀疏的事件数组而不是整幅图像
+  ADVSCamera::DVSEventArray SimulationOnGPU();
+
 private:
+  /// GPU上保存的每个像素的状态，只在渲染线程中使用
+  TSharedPtr<FCarlaDVSState, ESPMode::ThreadSafe> GPUState;
+
+  /// GPU状态是否已经保存了第一帧
+  bool bGPUStateInitialized = false;
+
+  /// 有亮度变化的像素的下标，以及它们的阈值噪声，在帧之间复用
+  TArray<int32> changed_pixels;
+  TArray<float> threshold_noise;
+
   /// 包含最新（当前）图像和先前图像的图像
   TArray<float> last_image, prev_image;
 
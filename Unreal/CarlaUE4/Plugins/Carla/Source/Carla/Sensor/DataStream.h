@@ -67,6 +67,13 @@ public:
     return Stream->AreClientsListening();
   }
 
+  /// 是否有客户端能够接收下一帧数据，所有客户端都用完了信用时返回 false。
+  bool HasCredit()
+  {
+    check(Stream.has_value());
+    return Stream->HasCredit();
+  }
+
 private:
 
   boost::optional<StreamType> Stream;
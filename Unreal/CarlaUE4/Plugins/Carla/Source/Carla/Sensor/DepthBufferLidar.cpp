@@ -0,0 +1,240 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "Carla.h"
+#include "Carla/Sensor/DepthBufferLidar.h"
+
+#include "Carla/Actor/ActorBlueprintFunctionLibrary.h"
+#include "Carla/Game/CarlaEngine.h"
+#include "Carla/Sensor/UE4_Overridden/SceneCaptureComponentCube_CARLA.h"
+
+#include "LidarResample.h"
+#include "PixelConversion.h"
+
+#include <compiler/disable-ue4-macros.h>
+#include "carla/geom/Math.h"
+#include <compiler/enable-ue4-macros.h>
+
+#include "Engine/TextureRenderTargetCube.h"
+
+#include <cmath>
+#include <random>
+
+bool ADepthBufferLidar::IsEnabled()
+{
+  return FParse::Param(FCommandLine::Get(), TEXT("-carla-depth-buffer-lidar"));
+}
+
+FActorDefinition ADepthBufferLidar::GetSensorDefinition()
+{
+  if (!IsEnabled())
+  {
+    return FActorDefinition{};
+  }
+  auto Definition = UActorBlueprintFunctionLibrary::MakeLidarDefinition(TEXT("depth_buffer"));
+
+  FActorVariation Resolution;
+  Resolution.Id = TEXT("cube_resolution");  // 深度立方体贴图每个面的像素数
+  Resolution.Type = EActorAttributeType::Int;
+  Resolution.RecommendedValues = { TEXT("1024") };
+  Resolution.bRestrictToRecommended = false;
+
+  Definition.Variations.Append({ Resolution });
+  return Definition;
+}
+
+ADepthBufferLidar::ADepthBufferLidar(const FObjectInitializer &ObjectInitializer)
+  : Super(ObjectInitializer)
+{
+  PrimaryActorTick.bCanEverTick = true;
+
+  CaptureRenderTarget = CreateDefaultSubobject<UTextureRenderTargetCube>(TEXT("CaptureRenderTargetCube"));
+  CaptureRenderTarget->bHDR = true;
+
+  CaptureComponentCube = CreateDefaultSubobject<USceneCaptureComponentCube_CARLA>(TEXT("SceneCaptureComponentCube_CARLA"));
+  CaptureComponentCube->ViewActor = this;
+  CaptureComponentCube->SetupAttachment(RootComponent);
+  CaptureComponentCube->bCaptureEveryFrame = false;
+  CaptureComponentCube->bCaptureOnMovement = false;
+  // The faces follow the sensor, so the beams are sampled in sensor space.
+  CaptureComponentCube->bCaptureRotation = true;
+}
+
+void ADepthBufferLidar::Set(const FActorDescription &ActorDescription)
+{
+  Super::Set(ActorDescription);
+  FLidarDescription LidarDescription;
+  UActorBlueprintFunctionLibrary::SetLidar(ActorDescription, LidarDescription);
+  CubeResolution = static_cast<uint32>(FMath::Clamp(
+      UActorBlueprintFunctionLibrary::RetrieveActorAttributeToInt(
+          "cube_resolution",
+          ActorDescription.Variations,
+          static_cast<int32>(CubeResolution)),
+      16,
+      4096));
+  Set(LidarDescription);
+}
+
+void ADepthBufferLidar::Set(const FLidarDescription &LidarDescription)
+{
+  Description = LidarDescription;
+
+  // Same drop off model as ARayCastLidar.
+  DropOffBeta = 1.0f - Description.DropOffAtZeroIntensity;
+  DropOffAlpha = Description.DropOffAtZeroIntensity / Description.DropOffIntensityLimit;
+  DropOffGenActive = Description.DropOffGenRate > std::numeric_limits<float>::epsilon();
+}
+
+void ADepthBufferLidar::BeginPlay()
+{
+  if (!IsCarlaPixelConversionSupported())
+  {
+    UE_LOG(LogCarla, Error, TEXT("%s: the depth buffer Lidar needs SM5, it will not send data."), *GetName());
+  }
+
+  // 32-bit float, half precision is not enough for the depth at long range.
+  CaptureRenderTarget->Init(CubeResolution, PF_A32B32G32R32F);
+  CaptureComponentCube->TextureTarget = CaptureRenderTarget;
+  // Scene depth in the alpha channel.
+  CaptureComponentCube->CaptureSource = ESceneCaptureSource::SCS_SceneColorSceneDepth;
+  CaptureComponentCube->ShowFlags.SetPostProcessing(false);
+  CaptureComponentCube->ShowFlags.SetFog(false);
+  CaptureComponentCube->ShowFlags.SetAtmosphere(false);
+  CaptureComponentCube->ShowFlags.SetParticles(false);
+  CaptureComponentCube->UpdateContent();
+
+  Super::BeginPlay();
+}
+
+void ADepthBufferLidar::EndPlay(EEndPlayReason::Type EndPlayReason)
+{
+  Super::EndPlay(EndPlayReason);
+  // The render commands use this sensor.
+  FlushRenderingCommands();
+}
+
+void ADepthBufferLidar::PostPhysTick(UWorld *World, ELevelTick TickType, float DeltaTime)
+{
+  TRACE_CPUPROFILER_EVENT_SCOPE(ADepthBufferLidar::PostPhysTick);
+  if (!IsCarlaPixelConversionSupported())
+  {
+    return;
+  }
+
+  const uint32 ChannelCount = Description.Channels;
+  const uint32 PointsToScanWithOneLaser =
+    FMath::RoundHalfFromZero(
+        Description.PointsPerSecond * DeltaTime / float(ChannelCount));
+
+  if (PointsToScanWithOneLaser <= 0)
+  {
+    UE_LOG(
+        LogCarla,
+        Warning,
+        TEXT("%s: no points requested this frame, try increasing the number of points per second."),
+        *GetName());
+    return;
+  }
+
+  const float AngleDistanceOfTick = Description.RotationFrequency * Description.HorizontalFov
+      * DeltaTime;
+
+  FCarlaLidarBeamParameters Beams;
+  Beams.Channels = ChannelCount;
+  Beams.PointsPerChannel = PointsToScanWithOneLaser;
+  Beams.UpperFovLimit = Description.UpperFovLimit;
+  Beams.VerticalStep = ChannelCount == 1u ? 0.f :
+      (Description.UpperFovLimit - Description.LowerFovLimit) /
+      static_cast<float>(ChannelCount - 1);
+  Beams.StartAngle = CurrentHorizontalAngle;
+  Beams.HorizontalStep = AngleDistanceOfTick / PointsToScanWithOneLaser;
+  Beams.HorizontalFov = Description.HorizontalFov;
+  Beams.Range = Description.Range;
+
+  CurrentHorizontalAngle = std::fmod(CurrentHorizontalAngle + AngleDistanceOfTick, Description.HorizontalFov);
+  const float HorizontalAngle = carla::geom::Math::ToRadians(CurrentHorizontalAngle);
+
+  CaptureComponentCube->CaptureScene();
+
+  ENQUEUE_RENDER_COMMAND(FDepthBufferLidar_SendPoints)
+  (
+    [this, Beams, HorizontalAngle, Frame = FCarlaEngine::GetFrameCounter(), DataStream = GetDataStream(*this)](FRHICommandListImmediate &RHICmdList) mutable
+    {
+      TRACE_CPUPROFILER_EVENT_SCOPE_STR("FDepthBufferLidar_SendPoints");
+      if (IsPendingKill())
+      {
+        return;
+      }
+      FTextureRenderTargetResource *Resource = CaptureRenderTarget->GetRenderTargetResource();
+      if (Resource == nullptr)
+      {
+        return;
+      }
+
+      TArray<FVector4> Points;
+      ResampleCarlaLidarBeams(RHICmdList, Resource->TextureRHI, Beams, Points);
+
+      FLidarData LidarData(Beams.Channels);
+      ComputeAndSaveDetections(Points, Beams.PointsPerChannel, Frame, LidarData);
+      LidarData.SetHorizontalAngle(HorizontalAngle);
+
+      DataStream.SetFrameNumber(Frame);
+      TRACE_CPUPROFILER_EVENT_SCOPE_STR("Send Stream");
+      DataStream.SerializeAndSend(*this, LidarData, DataStream.PopBufferFromPool());
+    }
+  );
+}
+
+void ADepthBufferLidar::ComputeAndSaveDetections(
+    const TArray<FVector4> &Points,
+    const uint32 PointsPerChannel,
+    const uint64 Frame,
+    FLidarData &Data) const
+{
+  TRACE_CPUPROFILER_EVENT_SCOPE_STR(__FUNCTION__);
+  std::minstd_rand Engine(static_cast<std::minstd_rand::result_type>(Seed + Frame));
+  std::uniform_real_distribution<float> Uniform(0.0f, 1.0f);
+  std::normal_distribution<float> Noise(0.0f, FMath::Max(Description.NoiseStdDev, 0.0f));
+  const bool bAddNoise = Description.NoiseStdDev > std::numeric_limits<float>::epsilon();
+
+  const uint32 Channels = Description.Channels;
+  std::vector<uint32_t> PointsPerChannelCount(Channels, PointsPerChannel);
+  Data.ResetMemory(PointsPerChannelCount);
+
+  for (auto idxChannel = 0u; idxChannel < Channels; ++idxChannel)
+  {
+    uint32_t Count = 0u;
+    for (auto idxPtsOneLaser = 0u; idxPtsOneLaser < PointsPerChannel; ++idxPtsOneLaser)
+    {
+      const FVector4 &Point = Points[idxChannel * PointsPerChannel + idxPtsOneLaser];
+      // Rays dropped before being traced in ARayCastLidar.
+      const bool bDropped = DropOffGenActive && Uniform(Engine) < Description.DropOffGenRate;
+      if (Point.W == 0.0f || bDropped)
+      {
+        continue;
+      }
+
+      FDetection Detection;
+      Detection.point = FVector(Point.X, Point.Y, Point.Z);
+      Detection.intensity = std::exp(-Description.AtmospAttenRate * Detection.point.Length());
+
+      if (bAddNoise)
+      {
+        Detection.point += Detection.point.MakeUnitVector() * Noise(Engine);
+      }
+      const bool bKeep = Detection.intensity > Description.DropOffIntensityLimit ||
+          Uniform(Engine) < DropOffAlpha * Detection.intensity + DropOffBeta;
+      if (bKeep)
+      {
+        Data.WritePointSync(Detection);
+        ++Count;
+      }
+    }
+    PointsPerChannelCount[idxChannel] = Count;
+  }
+
+  Data.WriteChannelCount(PointsPerChannelCount);
+}
@@ -0,0 +1,100 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "Carla/Sensor/Sensor.h"
+
+#include "Carla/Actor/ActorDefinition.h"
+#include "Carla/Sensor/LidarDescription.h"
+
+#include <compiler/disable-ue4-macros.h>
+#include <carla/sensor/data/LidarData.h>
+#include <compiler/enable-ue4-macros.h>
+
+#include "DepthBufferLidar.generated.h"
+
+class USceneCaptureComponentCube_CARLA;
+class UTextureRenderTargetCube;
+
+/// A Lidar sensor that renders the depth around it into a cube map and
+/// resamples it into beams on the GPU. Its cost depends on the resolution of
+/// the cube map instead of the number of points, and it sends the same data
+/// as ARayCastLidar.
+///
+/// Experimental: the hit points come from the scene depth that the cube
+/// capture writes to the alpha channel with SCS_SceneColorSceneDepth, which
+/// has not been verified against the engine build. The blueprint is only
+/// available when the server is started with --carla-depth-buffer-lidar.
+UCLASS()
+class CARLA_API ADepthBufferLidar : public ASensor
+{
+  GENERATED_BODY()
+
+  using FLidarData = carla::sensor::data::LidarData;
+  using FDetection = carla::sensor::data::LidarDetection;
+
+public:
+
+  /// Whether the server was started with --carla-depth-buffer-lidar.
+  static bool IsEnabled();
+
+  /// Returns an empty definition, so no blueprint is created, unless
+  /// IsEnabled().
+  static FActorDefinition GetSensorDefinition();
+
+  ADepthBufferLidar(const FObjectInitializer &ObjectInitializer);
+
+  virtual void Set(const FActorDescription &Description) override;
+
+  void Set(const FLidarDescription &LidarDescription);
+
+  double GetEstimatedTickCost() const override
+  {
+    return 0.5;
+  }
+
+protected:
+
+  virtual void BeginPlay() override;
+
+  virtual void PostPhysTick(UWorld *World, ELevelTick TickType, float DeltaTime) override;
+
+  virtual void EndPlay(EEndPlayReason::Type EndPlayReason) override;
+
+private:
+
+  /// Turn the points read back from the GPU into LidarData, applying the same
+  /// intensity, drop-off and noise models as ARayCastLidar. Runs in the
+  /// render thread, so it uses its own random engine seeded with the frame.
+  void ComputeAndSaveDetections(
+      const TArray<FVector4> &Points,
+      uint32 PointsPerChannel,
+      uint64 Frame,
+      FLidarData &Data) const;
+
+  UPROPERTY(EditAnywhere)
+  FLidarDescription Description;
+
+  /// Size in pixels of each face of the depth cube map.
+  UPROPERTY(EditAnywhere)
+  uint32 CubeResolution = 1024u;
+
+  UPROPERTY(EditAnywhere)
+  USceneCaptureComponentCube_CARLA *CaptureComponentCube = nullptr;
+
+  UPROPERTY(EditAnywhere)
+  UTextureRenderTargetCube *CaptureRenderTarget = nullptr;
+
+  /// Horizontal angle of the next scan, in degrees.
+  float CurrentHorizontalAngle = 0.f;
+
+  bool DropOffGenActive = false;
+
+  float DropOffAlpha = 0.f;
+
+  float DropOffBeta = 0.f;
+};
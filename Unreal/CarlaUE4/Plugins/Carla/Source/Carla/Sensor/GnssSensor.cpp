@@ -9,7 +9,6 @@
 #include "Carla/Sensor/GnssSensor.h"
 #include "Carla/Game/CarlaEpisode.h"
 #include "Carla/Game/CarlaStatics.h"
-#include "Carla/MapGen/LargeMapManager.h"
 
 #include <compiler/disable-ue4-macros.h>
 #include "carla/geom/Vector3D.h"
@@ -38,19 +37,18 @@ void AGnssSensor::PostPhysTick(UWorld *World, ELevelTick TickType, float DeltaSe
 {
   TRACE_CPUPROFILER_EVENT_SCOPE(AGnssSensor::PostPhysTick);
 
-  FVector ActorLocation = GetActorLocation();
-  ALargeMapManager * LargeMap = UCarlaStatics::GetLargeMapManager(GetWorld());
-  if (LargeMap)
-  {
-    ActorLocation = LargeMap->LocalToGlobalLocation(ActorLocation);
-  }
+  const FKinematicsSnapshot &Kinematics =
+      UCarlaStatics::GetCurrentEpisode(World)->GetSensorManager().GetKinematicsSnapshot();
+  const FVector ActorLocation = Kinematics.LocalToGlobalLocation(GetActorLocation());
   carla::geom::Location Location = ActorLocation;
   carla::geom::GeoLocation CurrentLocation = CurrentGeoReference.Transform(Location);
 
-  // Compute the noise for the sensor
-  const float LatError = RandomEngine->GetNormalDistribution(0.0f, LatitudeDeviation);
-  const float LonError = RandomEngine->GetNormalDistribution(0.0f, LongitudeDeviation);
-  const float AltError = RandomEngine->GetNormalDistribution(0.0f, AltitudeDeviation);
+  // Compute the noise for the sensor, the three samples are drawn in one call
+  float Noise[3];
+  RandomEngine->FillNormalFloat(Noise, 3, 0.0f, 1.0f);
+  const float LatError = LatitudeDeviation * Noise[0];
+  const float LonError = LongitudeDeviation * Noise[1];
+  const float AltError = AltitudeDeviation * Noise[2];
 
   // Apply the noise to the sensor
   double Latitude = CurrentLocation.latitude + LatitudeBias + LatError;
@@ -51,23 +51,10 @@ void AInertialMeasurementUnit::SetOwner(AActor *Owner)
   Super::SetOwner(Owner);
 }
 
-// Returns the angular velocity of Actor, expressed in the frame of Actor
-static FVector FIMU_GetActorAngularVelocityInRadians(
-    AActor &Actor)
+// Kinematic state of this frame, shared with the other sensors
+static FKinematicsSnapshot &FIMU_GetKinematicsSnapshot(UWorld *World)
 {
-  const auto RootComponent = Cast<UPrimitiveComponent>(Actor.GetRootComponent());
-
-  FVector AngularVelocity;
-
-  if (RootComponent != nullptr) {
-      const FQuat ActorGlobalRotation = RootComponent->GetComponentTransform().GetRotation();
-      const FVector GlobalAngularVelocity = RootComponent->GetPhysicsAngularVelocityInRadians();
-      AngularVelocity = ActorGlobalRotation.UnrotateVector(GlobalAngularVelocity);
-  } else {
-      AngularVelocity = FVector::ZeroVector;
-  }
-
-  return AngularVelocity;
+  return UCarlaStatics::GetCurrentEpisode(World)->GetSensorManager().GetKinematicsSnapshot();
 }
 
 const carla::geom::Vector3D AInertialMeasurementUnit::ComputeAccelerometerNoise(
@@ -75,12 +62,13 @@ const carla::geom::Vector3D AInertialMeasurementUnit::ComputeAccelerometerNoise(
 {
   // Normal (or Gaussian or Gauss) distribution will be used as noise function.
   // A mean of 0.0 is used as a first parameter, the standard deviation is
-  // determined by the client
-  constexpr float Mean = 0.0f;
+  // determined by the client. The three samples are drawn in one call.
+  float Noise[3];
+  RandomEngine->FillNormalFloat(Noise, 3, 0.0f, 1.0f);
   return carla::geom::Vector3D {
-      Accelerometer.X + RandomEngine->GetNormalDistribution(Mean, StdDevAccel.X),
-      Accelerometer.Y + RandomEngine->GetNormalDistribution(Mean, StdDevAccel.Y),
-      Accelerometer.Z + RandomEngine->GetNormalDistribution(Mean, StdDevAccel.Z)
+      Accelerometer.X + StdDevAccel.X * Noise[0],
+      Accelerometer.Y + StdDevAccel.Y * Noise[1],
+      Accelerometer.Z + StdDevAccel.Z * Noise[2]
   };
 }
 
@@ -90,12 +78,13 @@ const carla::geom::Vector3D AInertialMeasurementUnit::ComputeGyroscopeNoise(
   // Normal (or Gaussian or Gauss) distribution and a bias will be used as
   // noise function.
   // A mean of 0.0 is used as a first parameter.The standard deviation and the
-  // bias are determined by the client
-  constexpr float Mean = 0.0f;
+  // bias are determined by the client. The three samples are drawn in one call.
+  float Noise[3];
+  RandomEngine->FillNormalFloat(Noise, 3, 0.0f, 1.0f);
   return carla::geom::Vector3D {
-      Gyroscope.X + BiasGyro.X + RandomEngine->GetNormalDistribution(Mean, StdDevGyro.X),
-      Gyroscope.Y + BiasGyro.Y + RandomEngine->GetNormalDistribution(Mean, StdDevGyro.Y),
-      Gyroscope.Z + BiasGyro.Z + RandomEngine->GetNormalDistribution(Mean, StdDevGyro.Z)
+      Gyroscope.X + BiasGyro.X + StdDevGyro.X * Noise[0],
+      Gyroscope.Y + BiasGyro.Y + StdDevGyro.Y * Noise[1],
+      Gyroscope.Z + BiasGyro.Z + StdDevGyro.Z * Noise[2]
   };
 }
 
@@ -105,7 +94,7 @@ carla::geom::Vector3D AInertialMeasurementUnit::ComputeAccelerometer(
   // Used to convert from UE4's cm to meters
   constexpr float TO_METERS = 1e-2;
   // Gravity set by gamemode
-  const float GRAVITY = UCarlaStatics::GetGameMode(GetWorld())->IMUISensorGravity;
+  const float GRAVITY = FIMU_GetKinematicsSnapshot(GetWorld()).GetGravity();
 
   // 2nd derivative of the polynomic (quadratic) interpolation
   // using the point in current time and two previous steps:
@@ -148,7 +137,7 @@ carla::geom::Vector3D AInertialMeasurementUnit::ComputeGyroscope()
 {
   check(GetOwner() != nullptr);
   const FVector AngularVelocity =
-      FIMU_GetActorAngularVelocityInRadians(*GetOwner());
+      FIMU_GetKinematicsSnapshot(GetWorld()).GetActorKinematics(*GetOwner()).LocalAngularVelocity;
 
   const FQuat SensorLocalRotation =
       RootComponent->GetRelativeTransform().GetRotation();
@@ -45,7 +45,8 @@ public:
   const carla::geom::Vector3D ComputeGyroscopeNoise(
       const FVector &Gyroscope);
 
-// 计算加速度计的值，输入是时间间隔，结果以 m/s² 为单位  carla::geom::Vector3D ComputeAccelerometer(const float DeltaTime);
+// 计算加速度计的值，输入是时间间隔，结果以 m/s² 为单位
+  carla::geom::Vector3D ComputeAccelerometer(const float DeltaTime);
 
   // 计算陀螺仪的值，结果以 rad/sec 为单位
   carla::geom::Vector3D ComputeGyroscope();
@@ -23,7 +23,10 @@ FActorDefinition AInstanceSegmentationCamera::GetSensorDefinition()
 {
   // 通过调用UActorBlueprintFunctionLibrary中的MakeCameraDefinition函数来创建并返回相机的定义信息
   // 传入的参数"instance_segmentation"可能是用于标识该相机是实例分割相机的特定字符串，用于区分不同类型的相机定义
-  return UActorBlueprintFunctionLibrary::MakeCameraDefinition(TEXT("instance_segmentation"));
+  FActorDefinition Definition = UActorBlueprintFunctionLibrary::MakeCameraDefinition(TEXT("instance_segmentation"));
+  // 只渲染指定语义标签的物体
+  AddShowOnlyTagsVariation(Definition);
+  return Definition;
 }
 
 // AInstanceSegmentationCamera类的构造函数，接受一个FObjectInitializer类型的参数用于初始化对象
@@ -35,6 +38,9 @@ AInstanceSegmentationCamera::AInstanceSegmentationCamera(
   // 调用AddPostProcessingMaterial函数添加一个后处理材质，传入的字符串是材质的路径
   // 这里添加的材质路径对应的材质用于物理镜头畸变相关的后处理效果（具体功能取决于材质本身实现）
   AddPostProcessingMaterial(TEXT("Material'/Carla/PostProcessingMaterials/PhysicLensDistortion.PhysicLensDistortion'"));
+
+  // 指定了语义标签时，显示列表中放入附加在物体上的带有标签的组件
+  bShowOnlyTaggedComponents = true;
   
   // TODO注释表示此处有待办事项，计划是设置OnActorSpawnHandler，目的是能够在有Actor生成时刷新相关组件
   // 目前这行代码被注释掉了，可能还未完成相关功能的实现或者暂时不需要此功能开启
@@ -61,6 +67,12 @@ void AInstanceSegmentationCamera::SetUpSceneCaptureComponent(USceneCaptureCompon
   // 设置场景捕获组件的原始渲染模式，这里设置为使用仅显示列表（PRM_UseShowOnlyList）的模式
   // 表示只会渲染在显示列表中的组件，具体显示列表的内容后续应该会进行设置
   SceneCapture.PrimitiveRenderMode = ESceneCapturePrimitiveRenderMode::PRM_UseShowOnlyList;
+
+  // 指定了语义标签时，显示列表由基类在每一帧中按标签填充
+  if (HasShowOnlyTags())
+  {
+    return;
+  }
   
   // 创建一个UObject类型的数组，用于存储带有标签的组件（TaggedComponents）
   TArray<UObject *> TaggedComponents;
@@ -85,8 +97,18 @@ void AInstanceSegmentationCamera::PostPhysTick(UWorld *World, ELevelTick TickTyp
 {
   // 使用TRACE_CPUPROFILER_EVENT_SCOPE宏定义一个CPU性能分析的事件范围，用于标记该函数执行的范围，方便性能分析工具进行分析
   TRACE_CPUPROFILER_EVENT_SCOPE(AInstanceSegmentationCamera::PostPhysTick);
+
+  // 回收已销毁参与者的实例 id，并发布这一帧的映射表
+  ATagger::UpdateInstanceTable();
   
   // 获取二维场景捕获组件的指针，如果获取成功则后续可以对其进行相关操作
+  // 指定了语义标签时，显示列表已经由基类在 PrePhysTick 中按标签填充
+  if (HasShowOnlyTags())
+  {
+    FPixelReader::SendPixelsInRenderThread<AInstanceSegmentationCamera, FColor>(*this);
+    return;
+  }
+
   USceneCaptureComponent2D* SceneCapture = GetCaptureComponent2D();
   // 创建一个UObject类型的数组，用于存储带有标签的组件（TaggedComponents）
   TArray<UObject *> TaggedComponents;
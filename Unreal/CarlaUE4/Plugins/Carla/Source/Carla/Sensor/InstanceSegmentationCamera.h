@@ -9,6 +9,7 @@
 #include "Carla/Sensor/ShaderBasedSensor.h"
 
 #include "Carla/Actor/ActorDefinition.h"
+#include "Carla/Game/Tagger.h"
 
 #include "InstanceSegmentationCamera.generated.h"
 
@@ -24,6 +25,12 @@ public:
 
   AInstanceSegmentationCamera(const FObjectInitializer &ObjectInitializer);
 
+  /// 随图像发送的实例 id 到参与者 id 的映射表，在渲染线程中序列化时调用。
+  std::shared_ptr<const ATagger::FInstanceTable> GetInstanceTable() const
+  {
+    return ATagger::GetInstanceTable();
+  }
+
 protected:
 
   void SetUpSceneCaptureComponent(USceneCaptureComponent2D &SceneCapture) override;
@@ -0,0 +1,83 @@
+// Copyright (c) 2022 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "Carla.h"
+#include "Carla/Sensor/KinematicsSnapshot.h"
+
+#include "Carla/Game/CarlaStatics.h"
+#include "Carla/MapGen/LargeMapManager.h"
+
+void FKinematicsSnapshot::Reset(UWorld *World)
+{
+  Actors.Reset();
+  ActorBounds.Reset();
+  bActorBoundsValid = false;
+  const ACarlaGameModeBase *GameMode = UCarlaStatics::GetGameMode(World);
+  if (GameMode != nullptr)
+  {
+    Gravity = GameMode->IMUISensorGravity;
+  }
+  LargeMap = UCarlaStatics::GetLargeMapManager(World);
+}
+
+const FKinematicsSnapshot::FActorKinematics &FKinematicsSnapshot::GetActorKinematics(
+    const AActor &Actor)
+{
+  if (const FActorKinematics *Cached = Actors.Find(&Actor))
+  {
+    return *Cached;
+  }
+
+  FActorKinematics Kinematics;
+  Kinematics.Transform = Actor.GetActorTransform();
+  const auto RootComponent = Cast<UPrimitiveComponent>(Actor.GetRootComponent());
+  if (RootComponent != nullptr)
+  {
+    const FQuat GlobalRotation = RootComponent->GetComponentTransform().GetRotation();
+    const FVector GlobalAngularVelocity = RootComponent->GetPhysicsAngularVelocityInRadians();
+    Kinematics.LocalAngularVelocity = GlobalRotation.UnrotateVector(GlobalAngularVelocity);
+  }
+  else
+  {
+    Kinematics.LocalAngularVelocity = FVector::ZeroVector;
+  }
+  return Actors.Add(&Actor, Kinematics);
+}
+
+const TArray<TPair<const AActor *, FSphere>> &FKinematicsSnapshot::GetActorBounds(
+    const UCarlaEpisode &Episode)
+{
+  if (bActorBoundsValid)
+  {
+    return ActorBounds;
+  }
+  bActorBoundsValid = true;
+  for (const auto &Item : Episode.GetActorRegistry())
+  {
+    const FCarlaActor *View = Item.Value.Get();
+    if (View == nullptr ||
+        View->IsDormant() ||
+        View->GetActorType() == FCarlaActor::ActorType::Sensor)
+    {
+      continue;
+    }
+    const AActor *Actor = View->GetActor();
+    if (Actor == nullptr)
+    {
+      continue;
+    }
+    FVector Origin;
+    FVector Extent;
+    Actor->GetActorBounds(false, Origin, Extent);
+    ActorBounds.Emplace(Actor, FSphere(Origin, Extent.Size()));
+  }
+  return ActorBounds;
+}
+
+FVector FKinematicsSnapshot::LocalToGlobalLocation(const FVector &Location) const
+{
+  return LargeMap != nullptr ? LargeMap->LocalToGlobalLocation(Location) : Location;
+}
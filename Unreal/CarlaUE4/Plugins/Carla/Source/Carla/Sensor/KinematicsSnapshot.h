@@ -0,0 +1,63 @@
+// Copyright (c) 2022 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+class AActor;
+class ALargeMapManager;
+class UCarlaEpisode;
+class UWorld;
+
+/// Kinematic state shared by the cheap kinematic sensors (IMU, GNSS, obstacle
+/// detectors) in one frame. The state of each actor is computed the first time
+/// a sensor asks for it and reused by every other sensor attached to it.
+class FKinematicsSnapshot
+{
+
+public:
+
+  struct FActorKinematics
+  {
+    FTransform Transform;
+
+    /// Angular velocity of the root component, in the actor's local frame,
+    /// in rad/s.
+    FVector LocalAngularVelocity;
+  };
+
+  /// Drop the state of the previous frame.
+  void Reset(UWorld *World);
+
+  const FActorKinematics &GetActorKinematics(const AActor &Actor);
+
+  /// Bounding spheres of the non-sensor actors in the registry of @a Episode,
+  /// computed once per frame. Sensors use them as a broad phase to skip
+  /// physics queries that cannot hit any actor.
+  const TArray<TPair<const AActor *, FSphere>> &GetActorBounds(const UCarlaEpisode &Episode);
+
+  /// Gravity configured in the game mode for the IMU, in m/s^2.
+  float GetGravity() const
+  {
+    return Gravity;
+  }
+
+  /// @a Location in the global frame of a large map, or @a Location itself
+  /// in a regular map.
+  FVector LocalToGlobalLocation(const FVector &Location) const;
+
+private:
+
+  TMap<const AActor *, FActorKinematics> Actors;
+
+  TArray<TPair<const AActor *, FSphere>> ActorBounds;
+
+  bool bActorBoundsValid = false;
+
+  float Gravity = 9.81f;
+
+  ALargeMapManager *LargeMap = nullptr;
+
+};
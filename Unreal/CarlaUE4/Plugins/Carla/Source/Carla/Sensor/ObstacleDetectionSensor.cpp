@@ -4,6 +4,7 @@
 // This work is licensed under the terms of the MIT license.
 // For a copy, see <https://opensource.org/licenses/MIT>.
 
+#include <PxScene.h>
 #include "Carla.h"
 #include "Carla/Sensor/ObstacleDetectionSensor.h"
 
@@ -12,11 +13,24 @@
 #include "Carla/Game/CarlaEpisode.h"
 #include "Carla/Game/CarlaGameInstance.h"
 #include "Carla/Game/CarlaGameModeBase.h"
+#include "Carla/Game/CarlaStatics.h"
+
+#include "HAL/IConsoleManager.h"
+#include "Runtime/Core/Public/Async/ParallelFor.h"
 
 #include <compiler/disable-ue4-macros.h>
 #include "carla/ros2/ROS2.h"
 #include <compiler/enable-ue4-macros.h>
 
+static TAutoConsoleVariable<int32> CVarObstacleBatchSweeps(
+    TEXT("carla.Sensor.ObstacleBatchSweeps"),
+    1,
+    TEXT("If 1, the sweeps of all obstacle detectors are run together in parallel ")
+    TEXT("once per frame. If 0, each detector sweeps on its own."),
+    ECVF_Default);
+
+TArray<AObstacleDetectionSensor *> AObstacleDetectionSensor::QueuedSweeps;
+
 AObstacleDetectionSensor::AObstacleDetectionSensor(const FObjectInitializer &ObjectInitializer)
   : Super(ObjectInitializer)
 {
@@ -54,15 +68,96 @@ void AObstacleDetectionSensor::Set(const FActorDescription &Description)
 #endif
 }
 
+void AObstacleDetectionSensor::BeginPostPhysTick(UWorld *World, float DeltaSeconds)
+{
+  SweepStart = GetActorLocation();
+  SweepEnd = SweepStart + (GetActorForwardVector() * Distance);
+  bSweepHit = false;
+  bSweepQueued = false;
+  bSweepNeeded = !bOnlyDynamics || MayHitActors(World);
+
+  // 调试扫描需要在游戏线程中绘制，不参与批量扫描
+  if (bSweepNeeded && !bDebugLineTrace && CVarObstacleBatchSweeps.GetValueOnGameThread() != 0)
+  {
+    QueuedSweeps.Add(this);
+    bSweepQueued = true;
+  }
+}
+
 void AObstacleDetectionSensor::PostPhysTick(UWorld *World, ELevelTick TickType, float DeltaTime)
 {
   TRACE_CPUPROFILER_EVENT_SCOPE(AObstacleDetectionSensor::PostPhysTick);
-  const FVector &Start = GetActorLocation();
-  const FVector &End = Start + (GetActorForwardVector() * Distance);
-  UWorld* CurrentWorld = GetWorld();
+  if (bSweepQueued)
+  {
+    RunQueuedSweeps(World);
+  }
+  else if (bSweepNeeded)
+  {
+    Sweep(World);
+  }
+  bSweepNeeded = false;
+
+  if (bSweepHit)
+  {
+    OnObstacleDetectionEvent(this, SweepHit.Actor.Get(), SweepHit.Distance, SweepHit);
+  }
+}
+
+void AObstacleDetectionSensor::EndPlay(EEndPlayReason::Type EndPlayReason)
+{
+  QueuedSweeps.Remove(this);
+  Super::EndPlay(EndPlayReason);
+}
+
+bool AObstacleDetectionSensor::MayHitActors(UWorld *World) const
+{
+  UCarlaEpisode *Episode = UCarlaStatics::GetCurrentEpisode(World);
+  if (Episode == nullptr)
+  {
+    return true;
+  }
+  const AActor *Owner = GetOwner();
+  for (const auto &Bounds : Episode->GetSensorManager().GetKinematicsSnapshot().GetActorBounds(*Episode))
+  {
+    if (Bounds.Key == Owner || Bounds.Key == this)
+    {
+      continue;
+    }
+    const float Reach = Bounds.Value.W + HitRadius;
+    if (FMath::PointDistToSegmentSquared(Bounds.Value.Center, SweepStart, SweepEnd) <= Reach * Reach)
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+void AObstacleDetectionSensor::RunQueuedSweeps(UWorld *World)
+{
+  TRACE_CPUPROFILER_EVENT_SCOPE(AObstacleDetectionSensor::RunQueuedSweeps);
+  TArray<AObstacleDetectionSensor *> Sensors = MoveTemp(QueuedSweeps);
+  QueuedSweeps.Reset();
 
+  World->GetPhysicsScene()->GetPxScene()->lockRead();
+  {
+    TRACE_CPUPROFILER_EVENT_SCOPE(ParallelFor);
+    ParallelFor(Sensors.Num(), [&](int32 Index) {
+      Sensors[Index]->Sweep(World);
+    });
+  }
+  World->GetPhysicsScene()->GetPxScene()->unlockRead();
+
+  for (AObstacleDetectionSensor *Sensor : Sensors)
+  {
+    Sensor->bSweepQueued = false;
+    Sensor->bSweepNeeded = false;
+  }
+}
+
+void AObstacleDetectionSensor::Sweep(UWorld *World)
+{
   // 用于保存扫描结果的结构体
-  FHitResult HitOut = FHitResult();
+  SweepHit = FHitResult();
 
   // 查询参数的初始化
   FCollisionQueryParams TraceParams(FName(TEXT("ObstacleDetection Trace")), true, this);
@@ -72,7 +167,7 @@ void AObstacleDetectionSensor::PostPhysTick(UWorld *World, ELevelTick TickType,
   if (bDebugLineTrace)
   {
     const FName TraceTag("ObstacleDebugTrace");
-    CurrentWorld->DebugDrawTraceTag = TraceTag;
+    World->DebugDrawTraceTag = TraceTag;
     TraceParams.TraceTag = TraceTag;
   }
 #endif
@@ -91,7 +186,6 @@ void AObstacleDetectionSensor::PostPhysTick(UWorld *World, ELevelTick TickType,
   if(Super::GetOwner()!=nullptr)
     TraceParams.AddIgnoredActor(Super::GetOwner());
 
-  bool isHitReturned;
   // 选择一种扫描类型是一种权宜之计，直到所有事情都得到妥善处理
   // 根据正确的碰撞通道和对象类型进行组织
   if (bOnlyDynamics)
@@ -99,10 +193,10 @@ void AObstacleDetectionSensor::PostPhysTick(UWorld *World, ELevelTick TickType,
     // 如果我们只考虑动态物体，我们会检查对象类型“AllDynamicObjects”
     FCollisionObjectQueryParams TraceChannel = FCollisionObjectQueryParams(
         FCollisionObjectQueryParams::AllDynamicObjects);
-    isHitReturned = CurrentWorld->SweepSingleByObjectType(
-        HitOut,
-        Start,
-        End,
+    bSweepHit = World->SweepSingleByObjectType(
+        SweepHit,
+        SweepStart,
+        SweepEnd,
         FQuat(),
         TraceChannel,
         FCollisionShape::MakeSphere(HitRadius),
@@ -112,20 +206,15 @@ void AObstacleDetectionSensor::PostPhysTick(UWorld *World, ELevelTick TickType,
   {
     //否则，如果我们考虑所有物体，我们会获取与Pawn交互的所有物体
     ECollisionChannel TraceChannel = ECC_WorldStatic;
-    isHitReturned = CurrentWorld->SweepSingleByChannel(
-        HitOut,
-        Start,
-        End,
+    bSweepHit = World->SweepSingleByChannel(
+        SweepHit,
+        SweepStart,
+        SweepEnd,
         FQuat(),
         TraceChannel,
         FCollisionShape::MakeSphere(HitRadius),
         TraceParams);
   }
-
-  if (isHitReturned)
-  {
-    OnObstacleDetectionEvent(this, HitOut.Actor.Get(), HitOut.Distance, HitOut);
-  }
 }
 
 void AObstacleDetectionSensor::OnObstacleDetectionEvent(
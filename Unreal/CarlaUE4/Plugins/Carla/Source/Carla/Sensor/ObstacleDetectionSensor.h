@@ -27,10 +27,28 @@ public:
 
   void Set(const FActorDescription &Description) override;
 
+  virtual void BeginPostPhysTick(UWorld *World, float DeltaSeconds) override;
+
   virtual void PostPhysTick(UWorld *World, ELevelTick TickType, float DeltaSeconds) override;
 
+protected:
+
+  virtual void EndPlay(EEndPlayReason::Type EndPlayReason) override;
+
 private:
 
+  /// Whether the sweep of this frame can hit a registered actor, using their
+  /// bounding spheres as a broad phase. Only used with only_dynamics, static
+  /// geometry is not in the registry.
+  bool MayHitActors(UWorld *World) const;
+
+  /// Sweep from SweepStart to SweepEnd and store the result in SweepHit.
+  void Sweep(UWorld *World);
+
+  /// Run the sweeps of every obstacle detector queued this frame in parallel.
+  static void RunQueuedSweeps(UWorld *World);
+
+
   UFUNCTION()
   void OnObstacleDetectionEvent(
       AActor *Actor,
@@ -47,4 +65,19 @@ private:
   bool bOnlyDynamics = false;
 
   bool bDebugLineTrace = false;
+
+  FVector SweepStart;
+
+  FVector SweepEnd;
+
+  FHitResult SweepHit;
+
+  bool bSweepHit = false;
+
+  bool bSweepNeeded = false;
+
+  bool bSweepQueued = false;
+
+  /// Detectors waiting for the batched sweep of this frame.
+  static TArray<AObstacleDetectionSensor *> QueuedSweeps;
 };
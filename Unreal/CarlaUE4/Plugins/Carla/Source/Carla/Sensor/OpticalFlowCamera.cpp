@@ -8,7 +8,24 @@
 
 FActorDefinition AOpticalFlowCamera::GetSensorDefinition()
 {
-  return UActorBlueprintFunctionLibrary::MakeCameraDefinition(TEXT("optical_flow"));
+  FActorDefinition Definition = UActorBlueprintFunctionLibrary::MakeCameraDefinition(TEXT("optical_flow"));
+  // Halves the bandwidth, the shader output is already 16-bit.
+  FActorVariation HalfPrecision;
+  HalfPrecision.Id = TEXT("half_precision");
+  HalfPrecision.Type = EActorAttributeType::Bool;
+  HalfPrecision.RecommendedValues = { TEXT("false") };
+  HalfPrecision.bRestrictToRecommended = false;
+  Definition.Variations.Emplace(HalfPrecision);
+  return Definition;
+}
+
+void AOpticalFlowCamera::Set(const FActorDescription &Description)
+{
+  Super::Set(Description);
+  bHalfPrecision = UActorBlueprintFunctionLibrary::RetrieveActorAttributeToBool(
+      "half_precision",
+      Description.Variations,
+      bHalfPrecision);
 }
 
 AOpticalFlowCamera::AOpticalFlowCamera(const FObjectInitializer &ObjectInitializer)
@@ -27,24 +44,67 @@ void AOpticalFlowCamera::PostPhysTick(UWorld *World, ELevelTick TickType, float
   int32 OldValue = CVarForceOutputsVelocity->GetInt();
   CVarForceOutputsVelocity->Set(1);
 
-  std::function<TArray<float>(void *, uint32)> Conversor = [](void *Data, uint32 Size)
+  // Only the red and green channels are used, read back just those when the
+  // GPU can convert them.
+  const bool bGPUConversion = IsCarlaPixelConversionSupported();
+  const ECarlaPixelConversion GPUConversion =
+      bGPUConversion ? ECarlaPixelConversion::RedGreenToG16R16F : ECarlaPixelConversion::None;
+
+  if (bHalfPrecision)
+  {
+    // The GPU output is sent as is, otherwise drop the blue and alpha
+    // channels on the CPU.
+    std::function<TArray<FFloat16>(void *, uint32)> Conversor;
+    if (!bGPUConversion)
+    {
+      Conversor = [](void *Data, uint32 Size)
+      {
+        const int32 Count = Size / sizeof(FFloat16Color);
+        DEBUG_ASSERT(Count * sizeof(FFloat16Color) == Size);
+        const FFloat16Color *Pixels = reinterpret_cast<const FFloat16Color *>(Data);
+        TArray<FFloat16> Flow;
+        Flow.SetNumUninitialized(Count * 2);
+        for (int32 i = 0; i < Count; ++i)
+        {
+          Flow[2 * i] = Pixels[i].R;
+          Flow[2 * i + 1] = Pixels[i].G;
+        }
+        return Flow;
+      };
+    }
+    FPixelReader::SendPixelsInRenderThread<AOpticalFlowCamera, FFloat16>(
+        *this,
+        true,
+        Conversor,
+        GPUConversion);
+    CVarForceOutputsVelocity->Set(OldValue);
+    return;
+  }
+
+  std::function<TArray<float>(void *, uint32)> Conversor = [bGPUConversion](void *Data, uint32 Size)
   {
     TArray<float> IntermediateBuffer;
-    int32 Count = Size / sizeof(FFloat16Color);
-    DEBUG_ASSERT(Count * sizeof(FFloat16Color) == Size);
-    FFloat16Color *Buf = reinterpret_cast<FFloat16Color *>(Data);
+    const uint32 Stride = bGPUConversion ? 2u * sizeof(FFloat16) : sizeof(FFloat16Color);
+    int32 Count = Size / Stride;
+    DEBUG_ASSERT(Count * Stride == Size);
+    const uint8 *Buf = reinterpret_cast<const uint8 *>(Data);
     IntermediateBuffer.Reserve(Count * 2);
     for (int i=0; i<Count; ++i)
     {
-      float x = (Buf->R.GetFloat() - 0.5f) * 4.f;
-      float y = (Buf->G.GetFloat() - 0.5f) * 4.f;
+      const FFloat16 *Pixel = reinterpret_cast<const FFloat16 *>(Buf);
+      float x = (Pixel[0].GetFloat() - 0.5f) * 4.f;
+      float y = (Pixel[1].GetFloat() - 0.5f) * 4.f;
       IntermediateBuffer.Add(x);
       IntermediateBuffer.Add(y);
-      ++Buf;
+      Buf += Stride;
     }
     return IntermediateBuffer;
   };
-  FPixelReader::SendPixelsInRenderThread<AOpticalFlowCamera, float>(*this, true, Conversor);
-  
+  FPixelReader::SendPixelsInRenderThread<AOpticalFlowCamera, float>(
+      *this,
+      true,
+      Conversor,
+      GPUConversion);
+
   CVarForceOutputsVelocity->Set(OldValue);
 }
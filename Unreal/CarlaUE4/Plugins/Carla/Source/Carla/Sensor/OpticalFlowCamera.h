@@ -18,7 +18,15 @@ public:
 
   AOpticalFlowCamera(const FObjectInitializer &ObjectInitializer);
 
+  void Set(const FActorDescription &ActorDescription) override;
+
 protected:
 
   void PostPhysTick(UWorld *World, ELevelTick TickType, float DeltaSeconds) override;
+
+private:
+
+  /// Send the two flow components as the 16-bit floats written by the
+  /// shader, the client expands them to 32-bit floats.
+  bool bHalfPrecision = false;
 };
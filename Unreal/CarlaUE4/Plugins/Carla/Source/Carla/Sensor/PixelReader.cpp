@@ -12,6 +12,8 @@
 #include "HighResScreenshot.h"
 #include "Runtime/ImageWriteQueue/Public/ImageWriteQueue.h"
 
+#include <chrono>
+
 // =============================================================================
 // -- FPixelReader -------------------------------------------------------------
 // =============================================================================
@@ -27,7 +29,16 @@ void FPixelReader::WritePixelsToBuffer(
 
   auto RenderResource =
       static_cast<const FTextureRenderTarget2DResource *>(RenderTarget.Resource);
-  FTexture2DRHIRef Texture = RenderResource->GetRenderTargetTexture();
+  WritePixelsToBuffer(RenderResource->GetRenderTargetTexture(), Offset, RHICmdList, std::move(FuncForSending));
+}
+
+void FPixelReader::WritePixelsToBuffer(
+    FTexture2DRHIRef Texture,
+    uint32 Offset,
+    FRHICommandListImmediate &RHICmdList,
+    FPixelReader::Payload FuncForSending)
+{
+  check(IsInRenderingThread());
   if (!Texture)
   {
     return;
@@ -44,16 +55,7 @@ void FPixelReader::WritePixelsToBuffer(
   }
 
   // workaround to force RHI with Vulkan to refresh the fences state in the middle of frame
-  {
-    FRenderQueryRHIRef Query = RHICreateRenderQuery(RQT_AbsoluteTime);
-    TRACE_CPUPROFILER_EVENT_SCOPE_STR("create query");
-    RHICmdList.EndRenderQuery(Query);
-    TRACE_CPUPROFILER_EVENT_SCOPE_STR("Flush");
-    RHICmdList.ImmediateFlush(EImmediateFlushType::FlushRHIThread);
-    TRACE_CPUPROFILER_EVENT_SCOPE_STR("query result");
-    uint64 OldAbsTime = 0;
-    RHICmdList.GetRenderQueryResult(Query, OldAbsTime, true);
-  }
+  RefreshGPUFences(RHICmdList);
 
   AsyncTask(ENamedThreads::HighTaskPriority, [=, Readback=std::move(BackBufferReadback)]() mutable {
     {
@@ -80,6 +82,20 @@ void FPixelReader::WritePixelsToBuffer(
   });
 }
 
+void FPixelReader::RefreshGPUFences(FRHICommandListImmediate &RHICmdList)
+{
+  TRACE_CPUPROFILER_EVENT_SCOPE_STR("RefreshGPUFences");
+  check(IsInRenderingThread());
+  FRenderQueryRHIRef Query = RHICreateRenderQuery(RQT_AbsoluteTime);
+  TRACE_CPUPROFILER_EVENT_SCOPE_STR("create query");
+  RHICmdList.EndRenderQuery(Query);
+  TRACE_CPUPROFILER_EVENT_SCOPE_STR("Flush");
+  RHICmdList.ImmediateFlush(EImmediateFlushType::FlushRHIThread);
+  TRACE_CPUPROFILER_EVENT_SCOPE_STR("query result");
+  uint64 OldAbsTime = 0;
+  RHICmdList.GetRenderQueryResult(Query, OldAbsTime, true);
+}
+
 bool FPixelReader::WritePixelsToArray(
     UTextureRenderTarget2D &RenderTarget,
     TArray<FColor> &BitMap)
@@ -133,3 +149,145 @@ TFuture<bool> FPixelReader::SavePixelsToDisk(
   FHighResScreenshotConfig &HighResScreenshotConfig = GetHighResScreenshotConfig();
   return HighResScreenshotConfig.ImageWriteQueue->Enqueue(MoveTemp(ImageTask));
 }
+
+// =============================================================================
+// -- FPixelReadbackRing -------------------------------------------------------
+// =============================================================================
+
+FPixelReadbackRing::FPixelReadbackRing(uint32 NumBuffers)
+{
+  Buffers.SetNum(FMath::Max(NumBuffers, 1u));
+}
+
+void FPixelReadbackRing::EnqueueCopy(
+    FRHICommandListImmediate &RHICmdList,
+    FTexture2DRHIRef Texture,
+    uint32 Offset,
+    FPixelReader::Payload FuncForSending)
+{
+  TRACE_CPUPROFILER_EVENT_SCOPE_STR("FPixelReadbackRing::EnqueueCopy");
+  check(IsInRenderingThread());
+  if (!Texture)
+  {
+    return;
+  }
+
+  const uint32 NumBuffers = Buffers.Num();
+  uint32 Index = 0u;
+  {
+    // Wait for a free buffer. If the GPU is behind, refresh the fences from
+    // here because the worker cannot enqueue render commands while we block.
+    TRACE_CPUPROFILER_EVENT_SCOPE_STR("Wait free buffer");
+    std::unique_lock<std::mutex> Lock(Mutex);
+    while (NumPending == NumBuffers)
+    {
+      if (!Condition.wait_for(Lock, std::chrono::milliseconds(5), [&]() { return NumPending < NumBuffers; }))
+      {
+        Lock.unlock();
+        FPixelReader::RefreshGPUFences(RHICmdList);
+        Lock.lock();
+      }
+    }
+    Index = (Head + NumPending) % NumBuffers;
+  }
+
+  // The buffer is not pending, so the worker does not touch it.
+  FBuffer &Buffer = Buffers[Index];
+  if (!Buffer.Readback.IsValid())
+  {
+    Buffer.Readback = MakeUnique<FRHIGPUTextureReadback>(TEXT("CameraBufferReadback"));
+  }
+  Buffer.Size = Texture->GetSizeXY();
+  Buffer.Format = Texture->GetFormat();
+  Buffer.Offset = Offset;
+  Buffer.FuncForSending = std::move(FuncForSending);
+  {
+    TRACE_CPUPROFILER_EVENT_SCOPE_STR("EnqueueCopy");
+    Buffer.Readback->EnqueueCopy(RHICmdList, Texture, FResolveRect(0, 0, Buffer.Size.X, Buffer.Size.Y));
+  }
+  // Submit the copy without waiting for it.
+  RHICmdList.ImmediateFlush(EImmediateFlushType::DispatchToRHIThread);
+
+  bool bStartDraining = false;
+  {
+    std::lock_guard<std::mutex> Lock(Mutex);
+    ++NumPending;
+    bStartDraining = !bDraining;
+    bDraining = true;
+  }
+  if (bStartDraining)
+  {
+    AsyncTask(ENamedThreads::HighTaskPriority, [Self = AsShared()]() { Self->Drain(); });
+  }
+}
+
+void FPixelReadbackRing::Flush()
+{
+  TRACE_CPUPROFILER_EVENT_SCOPE_STR("FPixelReadbackRing::Flush");
+  std::unique_lock<std::mutex> Lock(Mutex);
+  Condition.wait(Lock, [this]() { return NumPending == 0u && !bDraining; });
+}
+
+void FPixelReadbackRing::Drain()
+{
+  TRACE_CPUPROFILER_EVENT_SCOPE_STR("FPixelReadbackRing::Drain");
+  for (;;)
+  {
+    FBuffer *Buffer = nullptr;
+    {
+      std::lock_guard<std::mutex> Lock(Mutex);
+      if (NumPending == 0u)
+      {
+        bDraining = false;
+        Condition.notify_all();
+        return;
+      }
+      Buffer = &Buffers[Head];
+    }
+
+    WaitUntilReady(*Buffer->Readback);
+
+    {
+      TRACE_CPUPROFILER_EVENT_SCOPE_STR("Readback data");
+      FPixelFormatInfo PixelFormat = GPixelFormats[Buffer->Format];
+      uint32 ExpectedRowBytes = Buffer->Size.X * PixelFormat.BlockBytes;
+      int32 Size = (Buffer->Size.Y * (PixelFormat.BlockBytes * Buffer->Size.X));
+      void* LockedData = Buffer->Readback->Lock(Size);
+      if (LockedData)
+      {
+        Buffer->FuncForSending(LockedData, Size, Buffer->Offset, ExpectedRowBytes);
+      }
+      Buffer->Readback->Unlock();
+      Buffer->FuncForSending = nullptr;
+    }
+
+    {
+      std::lock_guard<std::mutex> Lock(Mutex);
+      Head = (Head + 1u) % Buffers.Num();
+      --NumPending;
+      Condition.notify_all();
+    }
+  }
+}
+
+void FPixelReadbackRing::WaitUntilReady(FRHIGPUTextureReadback &Readback)
+{
+  TRACE_CPUPROFILER_EVENT_SCOPE_STR("Wait GPU transfer");
+  constexpr double RefreshInterval = 0.005;
+  double NextRefresh = FPlatformTime::Seconds() + RefreshInterval;
+  while (!Readback.IsReady())
+  {
+    if (FPlatformTime::Seconds() > NextRefresh)
+    {
+      ENQUEUE_RENDER_COMMAND(FPixelReadbackRing_RefreshGPUFences)
+      (
+        [](FRHICommandListImmediate &InRHICmdList)
+        {
+          FPixelReader::RefreshGPUFences(InRHICmdList);
+        }
+      );
+      NextRefresh = FPlatformTime::Seconds() + 20.0 * RefreshInterval;
+    }
+    std::this_thread::yield();
+  }
+}
@@ -17,6 +17,11 @@
 
 #include "Carla/Game/CarlaEngine.h"
 
+#include "PixelConversion.h"
+
+#include <condition_variable>
+#include <mutex>
+
 #include <compiler/disable-ue4-macros.h>
 #include <carla/Logging.h>
 #include <carla/Buffer.h>
@@ -71,9 +76,17 @@ public:
   /// Note that the serializer needs to define a "header_offset" that it's
   /// allocated in front of the buffer.
   ///
+  /// If @a GPUConversion is not None the render target is converted on the GPU
+  /// before reading it back, and @a Conversor receives the converted pixels.
+  /// Callers must check IsCarlaPixelConversionSupported() first.
+  ///
   /// @pre To be called from game-thread.
   template <typename TSensor, typename TPixel>
-  static void SendPixelsInRenderThread(TSensor &Sensor, bool use16BitFormat = false, std::function<TArray<TPixel>(void *, uint32)> Conversor = {});
+  static void SendPixelsInRenderThread(
+      TSensor &Sensor,
+      bool use16BitFormat = false,
+      std::function<TArray<TPixel>(void *, uint32)> Conversor = {},
+      ECarlaPixelConversion GPUConversion = ECarlaPixelConversion::None);
 
   /// Copy the pixels in @a RenderTarget into @a Buffer.
   ///
@@ -84,6 +97,103 @@ public:
       FRHICommandListImmediate &InRHICmdList,
       FPixelReader::Payload FuncForSending);
 
+  /// Copy the pixels in @a Texture into @a Buffer.
+  ///
+  /// @pre To be called from render-thread.
+  static void WritePixelsToBuffer(
+      FTexture2DRHIRef Texture,
+      uint32 Offset,
+      FRHICommandListImmediate &InRHICmdList,
+      FPixelReader::Payload FuncForSending);
+
+  /// Force the RHI to refresh the state of its fences. Some RHIs (Vulkan) do
+  /// not update them until the end of the frame otherwise.
+  ///
+  /// @pre To be called from render-thread.
+  static void RefreshGPUFences(FRHICommandListImmediate &InRHICmdList);
+
+};
+
+// =============================================================================
+// -- FPixelReadbackRing -------------------------------------------------------
+// =============================================================================
+
+/// Ring of GPU readback staging buffers owned by a camera sensor.
+///
+/// Every frame the render thread copies the render target into the next free
+/// buffer and returns without waiting for the GPU. A single worker task maps
+/// the buffers in frame order as soon as they are ready, usually one or two
+/// frames later, and calls the payload that was captured together with the
+/// frame number. The render thread only waits when all the buffers are still
+/// in flight.
+class FPixelReadbackRing : public TSharedFromThis<FPixelReadbackRing, ESPMode::ThreadSafe>
+{
+public:
+
+  explicit FPixelReadbackRing(uint32 NumBuffers = 3u);
+
+  /// Copy the pixels of @a Texture into the next free buffer, @a FuncForSending
+  /// is called from a worker thread once the pixels are available.
+  ///
+  /// @pre To be called from render-thread.
+  void EnqueueCopy(
+      FRHICommandListImmediate &InRHICmdList,
+      FTexture2DRHIRef Texture,
+      uint32 Offset,
+      FPixelReader::Payload FuncForSending);
+
+  /// Blocks until all the pending buffers have been sent.
+  ///
+  /// @pre The render commands using this ring must have been flushed.
+  void Flush();
+
+  /// Texture the sensor converts its render target into before reading it
+  /// back, kept here so it is not created again every frame.
+  ///
+  /// @pre To be called from render-thread.
+  FTexture2DRHIRef &GetConversionTarget()
+  {
+    check(IsInRenderingThread());
+    return ConversionTarget;
+  }
+
+private:
+
+  struct FBuffer
+  {
+    TUniquePtr<FRHIGPUTextureReadback> Readback;
+
+    FIntPoint Size;
+
+    EPixelFormat Format = PF_Unknown;
+
+    uint32 Offset = 0u;
+
+    FPixelReader::Payload FuncForSending;
+  };
+
+  /// Send the pending buffers in order until there are none left.
+  void Drain();
+
+  /// Spin until @a Readback is ready, asking the render thread to refresh the
+  /// fences if it takes too long (e.g. the render thread is idle waiting for
+  /// the next tick in synchronous mode).
+  static void WaitUntilReady(FRHIGPUTextureReadback &Readback);
+
+  std::mutex Mutex;
+
+  std::condition_variable Condition;
+
+  TArray<FBuffer> Buffers;
+
+  FTexture2DRHIRef ConversionTarget;
+
+  /// Index of the oldest pending buffer.
+  uint32 Head = 0u;
+
+  uint32 NumPending = 0u;
+
+  bool bDraining = false;
 };
 
 // =============================================================================
@@ -91,7 +201,11 @@ public:
 // =============================================================================
 
 template <typename TSensor, typename TPixel>
-void FPixelReader::SendPixelsInRenderThread(TSensor &Sensor, bool use16BitFormat, std::function<TArray<TPixel>(void *, uint32)> Conversor)
+void FPixelReader::SendPixelsInRenderThread(
+    TSensor &Sensor,
+    bool use16BitFormat,
+    std::function<TArray<TPixel>(void *, uint32)> Conversor,
+    ECarlaPixelConversion GPUConversion)
 {
   TRACE_CPUPROFILER_EVENT_SCOPE(FPixelReader::SendPixelsInRenderThread);
   check(Sensor.CaptureRenderTarget != nullptr);
@@ -101,7 +215,7 @@ void FPixelReader::SendPixelsInRenderThread(TSensor &Sensor, bool use16BitFormat
     return;
   }
 
-  /// Blocks until the render thread has finished all it's tasks.
+  // Enqueues the capture of the scene in the render thread.
   Sensor.EnqueueRenderSceneImmediate();
 
   // Enqueue a command in the render-thread that will write the image buffer to
@@ -109,7 +223,7 @@ void FPixelReader::SendPixelsInRenderThread(TSensor &Sensor, bool use16BitFormat
   // game-thread.
   ENQUEUE_RENDER_COMMAND(FWritePixels_SendPixelsInRenderThread)
   (
-    [&Sensor, use16BitFormat, Conversor = std::move(Conversor)](auto &InRHICmdList) mutable
+    [&Sensor, Ring = Sensor.ReadbackRing, use16BitFormat, GPUConversion, Conversor = std::move(Conversor)](auto &InRHICmdList) mutable
     {
       TRACE_CPUPROFILER_EVENT_SCOPE_STR("FWritePixels_SendPixelsInRenderThread");
 
@@ -121,34 +235,20 @@ void FPixelReader::SendPixelsInRenderThread(TSensor &Sensor, bool use16BitFormat
           {
             if (Sensor.IsPendingKill()) return;
 
-            TArray<TPixel> Converted;
-
-            // optional conversion of data
-            if (Conversor)
-            {
-              TRACE_CPUPROFILER_EVENT_SCOPE_STR("Data conversion");
-              Converted = Conversor(LockedData, Size);
-              LockedData = reinterpret_cast<void *>(Converted.GetData());
-              Size = Converted.Num() * Converted.GetTypeSize();
-            }
-
-            auto Stream = Sensor.GetDataStream(Sensor);
-            Stream.SetFrameNumber(Frame);
-            auto Buffer = Stream.PopBufferFromPool();
-
             uint32 CurrentRowBytes = ExpectedRowBytes;
+            TArray<uint8> Unpadded;
 
 #ifdef _WIN32
             // DirectX uses additional bytes to align each row to 256 boundry,
-            // so we need to remove that extra data
+            // so we need to remove that extra data before converting it
             if (IsD3DPlatform(GMaxRHIShaderPlatform, false))
             {
               CurrentRowBytes = Align(ExpectedRowBytes, D3D12_TEXTURE_DATA_PITCH_ALIGNMENT);
               if (ExpectedRowBytes != CurrentRowBytes)
               {
                 TRACE_CPUPROFILER_EVENT_SCOPE_STR("Buffer Copy (windows, row by row)");
-                Buffer.reset(Offset + Size);
-                auto DstRow = Buffer.begin() + Offset;
+                Unpadded.SetNumUninitialized(Size);
+                uint8 *DstRow = Unpadded.GetData();
                 const uint8 *SrcRow = reinterpret_cast<uint8 *>(LockedData);
                 uint32 i = 0;
                 while (i < Size)
@@ -158,13 +258,27 @@ void FPixelReader::SendPixelsInRenderThread(TSensor &Sensor, bool use16BitFormat
                   SrcRow += CurrentRowBytes;
                   i += ExpectedRowBytes;
                 }
+                LockedData = Unpadded.GetData();
               }
             }
 #endif // _WIN32
 
-            if (ExpectedRowBytes == CurrentRowBytes)
+            TArray<TPixel> Converted;
+
+            // optional conversion of data
+            if (Conversor)
+            {
+              TRACE_CPUPROFILER_EVENT_SCOPE_STR("Data conversion");
+              Converted = Conversor(LockedData, Size);
+              LockedData = reinterpret_cast<void *>(Converted.GetData());
+              Size = Converted.Num() * Converted.GetTypeSize();
+            }
+
+            auto Stream = Sensor.GetDataStream(Sensor);
+            Stream.SetFrameNumber(Frame);
+            auto Buffer = Stream.PopBufferFromPool();
+
             {
-              check(ExpectedRowBytes == CurrentRowBytes);
               TRACE_CPUPROFILER_EVENT_SCOPE_STR("Buffer Copy");
               Buffer.copy_from(Offset, boost::asio::buffer(LockedData, Size));
             }
@@ -222,11 +336,26 @@ void FPixelReader::SendPixelsInRenderThread(TSensor &Sensor, bool use16BitFormat
             }
           };
 
-          WritePixelsToBuffer(
-              *Sensor.CaptureRenderTarget,
-              carla::sensor::SensorRegistry::get<TSensor *>::type::header_offset,
-              InRHICmdList,
-              std::move(FuncForSending));
+          const uint32 Offset = carla::sensor::SensorRegistry::get<TSensor *>::type::header_offset;
+          auto RenderResource =
+              static_cast<const FTextureRenderTarget2DResource *>(Sensor.CaptureRenderTarget->Resource);
+          FTexture2DRHIRef Texture = RenderResource->GetRenderTargetTexture();
+          if (Texture && GPUConversion != ECarlaPixelConversion::None)
+          {
+            // Without a ring the target is created again every frame.
+            FTexture2DRHIRef LocalTarget;
+            FTexture2DRHIRef &Target = Ring.IsValid() ? Ring->GetConversionTarget() : LocalTarget;
+            ConvertCarlaPixels(InRHICmdList, Texture, GPUConversion, Target);
+            Texture = Target;
+          }
+          if (Ring.IsValid())
+          {
+            Ring->EnqueueCopy(InRHICmdList, Texture, Offset, std::move(FuncForSending));
+          }
+          else
+          {
+            WritePixelsToBuffer(Texture, Offset, InRHICmdList, std::move(FuncForSending));
+          }
         }
       }
     );
@@ -62,6 +62,11 @@ void ARadar::SetPointsPerSecond(int NewPointsPerSecond)
   RadarData.SetResolution(PointsPerSecond);
 }
 
+void ARadar::SetStratifiedSampling(bool bNewStratifiedSampling)
+{
+  bStratifiedSampling = bNewStratifiedSampling;
+}
+
 void ARadar::BeginPlay()
 {
   Super::BeginPlay();
@@ -129,14 +134,7 @@ void ARadar::SendLineTraces(float DeltaTime)
   const float MaxRy = FMath::Tan(FMath::DegreesToRadians(VerticalFOV * 0.5f)) * Range;
   const int NumPoints = (int)(PointsPerSecond * DeltaTime);
 
-  // Generate the parameters of the rays in a deterministic way
-  Rays.clear();
-  Rays.resize(NumPoints);
-  for (int i = 0; i < Rays.size(); i++) {
-    Rays[i].Radius = RandomEngine->GetUniformFloat();
-    Rays[i].Angle = RandomEngine->GetUniformFloatInRange(0.0f, carla::geom::Math::Pi2<float>());
-    Rays[i].Hitted = false;
-  }
+  GenerateRays(NumPoints);
 
   FCriticalSection Mutex;
   GetWorld()->GetPhysicsScene()->GetPxScene()->lockRead();
@@ -166,11 +164,11 @@ void ARadar::SendLineTraces(float DeltaTime)
         FCollisionResponseParams::DefaultResponseParam
       );
 
-      const TWeakObjectPtr<AActor> HittedActor = OutHit.Actor;
-      if (Hitted && HittedActor.Get()) {
+      const AActor *HittedActor = OutHit.Actor.Get();
+      if (Hitted && HittedActor) {
         Rays[idx].Hitted = true;
-
-        Rays[idx].RelativeVelocity = CalculateRelativeVelocity(OutHit, RadarLocation);
+        Rays[idx].HittedActor = HittedActor;
+        Rays[idx].Direction = (OutHit.ImpactPoint - RadarLocation).GetSafeNormal();
 
         Rays[idx].AzimuthAndElevation = FMath::GetAzimuthAndElevation (
           (EndLocation - RadarLocation).GetSafeNormal() * Range,
@@ -185,6 +183,8 @@ void ARadar::SendLineTraces(float DeltaTime)
   }
   GetWorld()->GetPhysicsScene()->GetPxScene()->unlockRead();
 
+  CalculateRelativeVelocities();
+
   // Write the detections in the output structure
   for (auto& ray : Rays) {
     if (ray.Hitted) {
@@ -199,16 +199,66 @@ void ARadar::SendLineTraces(float DeltaTime)
 
 }
 
-float ARadar::CalculateRelativeVelocity(const FHitResult& OutHit, const FVector& RadarLocation)
+void ARadar::GenerateRays(int NumPoints)
 {
+  // Generate the parameters of the rays in a deterministic way
+  Rays.clear();
+  Rays.resize(NumPoints);
+  if (!bStratifiedSampling) {
+    for (int i = 0; i < Rays.size(); i++) {
+      Rays[i].Radius = RandomEngine->GetUniformFloat();
+      Rays[i].Angle = RandomEngine->GetUniformFloatInRange(0.0f, carla::geom::Math::Pi2<float>());
+      Rays[i].Hitted = false;
+    }
+    return;
+  }
+
+  // Latin hypercube: each of the NumPoints bands of radius and each of the
+  // NumPoints sectors of angle gets exactly one ray, paired at random.
+  TArray<int32> Sectors;
+  Sectors.SetNumUninitialized(NumPoints);
+  for (int i = 0; i < NumPoints; i++) {
+    Sectors[i] = i;
+  }
+  RandomEngine->Shuffle(Sectors);
+  const float Step = 1.0f / static_cast<float>(NumPoints);
+  for (int i = 0; i < NumPoints; i++) {
+    Rays[i].Radius = (i + RandomEngine->GetUniformFloat()) * Step;
+    Rays[i].Angle = (Sectors[i] + RandomEngine->GetUniformFloat()) * Step * carla::geom::Math::Pi2<float>();
+    Rays[i].Hitted = false;
+  }
+}
+
+void ARadar::CalculateRelativeVelocities()
+{
+  TRACE_CPUPROFILER_EVENT_SCOPE(ARadar::CalculateRelativeVelocities);
   constexpr float TO_METERS = 1e-2;
 
-  const TWeakObjectPtr<AActor> HittedActor = OutHit.Actor;
-  const FVector TargetVelocity = HittedActor->GetVelocity();
-  const FVector TargetLocation = OutHit.ImpactPoint;
-  const FVector Direction = (TargetLocation - RadarLocation).GetSafeNormal();
-  const FVector DeltaVelocity = (TargetVelocity - CurrentVelocity);
-  const float V = TO_METERS * FVector::DotProduct(DeltaVelocity, Direction);
+  ActorSlots.Reset();
+  ActorVelocities.Reset();
+  HitRays.Reset();
+  HitSlots.Reset();
+
+  for (int32 i = 0; i < static_cast<int32>(Rays.size()); ++i) {
+    if (!Rays[i].Hitted) {
+      continue;
+    }
+    const AActor *Actor = Rays[i].HittedActor;
+    int32 *Slot = ActorSlots.Find(Actor);
+    if (Slot == nullptr) {
+      Slot = &ActorSlots.Add(Actor, ActorVelocities.Num());
+      ActorVelocities.Add(Actor->GetVelocity() - CurrentVelocity);
+    }
+    HitRays.Add(i);
+    HitSlots.Add(*Slot);
+  }
 
-  return V;
+  for (int32 k = 0; k < HitRays.Num(); ++k) {
+    RayData &Ray = Rays[HitRays[k]];
+    const FVector &DeltaVelocity = ActorVelocities[HitSlots[k]];
+    Ray.RelativeVelocity = TO_METERS * (
+        DeltaVelocity.X * Ray.Direction.X +
+        DeltaVelocity.Y * Ray.Direction.Y +
+        DeltaVelocity.Z * Ray.Direction.Z);
+  }
 }
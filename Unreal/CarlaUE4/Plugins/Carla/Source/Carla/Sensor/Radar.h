@@ -44,6 +44,11 @@ public:
   UFUNCTION(BlueprintCallable, Category = "Radar")
   void SetPointsPerSecond(int NewPointsPerSecond);
 
+  /// Spread the rays of each frame over a grid of the field of view, one per
+  /// cell, instead of drawing them independently.
+  UFUNCTION(BlueprintCallable, Category = "Radar")
+  void SetStratifiedSampling(bool bNewStratifiedSampling);
+
 protected:
 
   void BeginPlay() override;
@@ -63,13 +68,22 @@ protected:
   UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Detection")
   int PointsPerSecond;
 
+  UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Detection")
+  bool bStratifiedSampling = false;
+
 private:
 
   void CalculateCurrentVelocity(const float DeltaTime);
 
+  /// Radius and angle of every ray of this frame, drawn in a deterministic
+  /// way from the random engine.
+  void GenerateRays(int NumPoints);
+
   void SendLineTraces(float DeltaTime);
 
-  float CalculateRelativeVelocity(const FHitResult& OutHit, const FVector& RadarLocation);
+  /// Fill the relative velocity of every ray that hit something. The velocity
+  /// of each hit actor is queried only once per frame.
+  void CalculateRelativeVelocities();
 
   FRadarData RadarData;
 
@@ -87,7 +101,22 @@ private:
     float RelativeVelocity;
     FVector2D AzimuthAndElevation;
     float Distance;
+    /// Unit vector from the radar to the hit point.
+    FVector Direction;
+    /// Actor hit by the ray, only valid during the frame.
+    const AActor *HittedActor;
   };
 
   std::vector<RayData> Rays;
+
+  /// Slot in ActorVelocities of each actor hit this frame.
+  TMap<const AActor *, int32> ActorSlots;
+
+  /// Velocity of each actor hit this frame, relative to the radar.
+  TArray<FVector> ActorVelocities;
+
+  /// Index in Rays and slot in ActorVelocities of each hit, flat so the
+  /// radial velocities are computed in one loop.
+  TArray<int32> HitRays;
+  TArray<int32> HitSlots;
 };
@@ -88,77 +88,77 @@ void ARayCastLidar::PostPhysTick(UWorld *World, ELevelTick TickType, float Delta
   #endif
 
 
-}
-
-float ARayCastLidar::ComputeIntensity(const FSemanticDetection& RawDetection) const
-{
-  const carla::geom::Location HitPoint = RawDetection.point;
-  const float Distance = HitPoint.Length();
-
-  const float AttenAtm = Description.AtmospAttenRate;
-  const float AbsAtm = exp(-AttenAtm * Distance);
-
-  const float IntRec = AbsAtm;
-
-  return IntRec;
-}
-
-ARayCastLidar::FDetection ARayCastLidar::ComputeDetection(const FHitResult& HitInfo, const FTransform& SensorTransf) const
-{
-  FDetection Detection;
-  const FVector HitPoint = HitInfo.ImpactPoint;
-  Detection.point = SensorTransf.Inverse().TransformPosition(HitPoint);
-
-  const float Distance = Detection.point.Length();
-
-  const float AttenAtm = Description.AtmospAttenRate;
-  const float AbsAtm = exp(-AttenAtm * Distance);
-
-  const float IntRec = AbsAtm;
-
-  Detection.intensity = IntRec;
-
-  return Detection;
 }
 
   void ARayCastLidar::PreprocessRays(uint32_t Channels, uint32_t MaxPointsPerChannel) {
     Super::PreprocessRays(Channels, MaxPointsPerChannel);
 
+    if (!DropOffGenActive)
+      return;
+
+    Uniforms.SetNumUninitialized(MaxPointsPerChannel, false);
     for (auto ch = 0u; ch < Channels; ch++) {
+      RandomEngine->FillUniformFloat(Uniforms.GetData(), MaxPointsPerChannel);
       for (auto p = 0u; p < MaxPointsPerChannel; p++) {
-        RayPreprocessCondition[ch][p] = !(DropOffGenActive && RandomEngine->GetUniformFloat() < Description.DropOffGenRate);
+        RayPreprocessCondition[ch][p] = !(Uniforms[p] < Description.DropOffGenRate);
       }
     }
   }
 
-  bool ARayCastLidar::PostprocessDetection(FDetection& Detection) const
-  {
-    if (Description.NoiseStdDev > std::numeric_limits<float>::epsilon()) {
-      const auto ForwardVector = Detection.point.MakeUnitVector();
-      const auto Noise = ForwardVector * RandomEngine->GetNormalDistribution(0.0f, Description.NoiseStdDev);
-      Detection.point += Noise;
+  void ARayCastLidar::ComputeAndSaveDetections(const FTransform& SensorTransform) {
+    TRACE_CPUPROFILER_EVENT_SCOPE_STR(__FUNCTION__);
+    int32 Total = 0;
+    for (auto idxChannel = 0u; idxChannel < Description.Channels; ++idxChannel)
+      Total += static_cast<int32>(RecordedDetections[idxChannel].size());
+
+    Distances.SetNumUninitialized(Total, false);
+    Intensities.SetNumUninitialized(Total, false);
+    Uniforms.SetNumUninitialized(Total, false);
+    Keep.SetNumUninitialized(Total, false);
+
+    // Distances of every point, channel after channel.
+    {
+      int32 i = 0;
+      for (auto idxChannel = 0u; idxChannel < Description.Channels; ++idxChannel)
+        for (const auto& RawDetection : RecordedDetections[idxChannel])
+          Distances[i++] = RawDetection.point.Length();
     }
 
-    const float Intensity = Detection.intensity;
-    if(Intensity > Description.DropOffIntensityLimit)
-      return true;
-    else
-      return RandomEngine->GetUniformFloat() < DropOffAlpha * Intensity + DropOffBeta;
-  }
+    // Atmospheric attenuation.
+    const float AttenAtm = Description.AtmospAttenRate;
+    for (int32 i = 0; i < Total; ++i)
+      Intensities[i] = std::exp(-AttenAtm * Distances[i]);
 
-  void ARayCastLidar::ComputeAndSaveDetections(const FTransform& SensorTransform) {
-    for (auto idxChannel = 0u; idxChannel < Description.Channels; ++idxChannel)
-      PointsPerChannel[idxChannel] = RecordedHits[idxChannel].size();
+    // Noise along the ray.
+    const bool bAddNoise = Description.NoiseStdDev > std::numeric_limits<float>::epsilon();
+    if (bAddNoise) {
+      Noises.SetNumUninitialized(Total, false);
+      RandomEngine->FillNormalFloat(Noises.GetData(), Total, 0.0f, Description.NoiseStdDev);
+    }
+
+    // Drop-off, a point survives with probability alpha * intensity + beta
+    // unless its intensity is over the limit.
+    RandomEngine->FillUniformFloat(Uniforms.GetData(), Total);
+    const float Limit = Description.DropOffIntensityLimit;
+    for (int32 i = 0; i < Total; ++i)
+      Keep[i] = Intensities[i] > Limit || Uniforms[i] < DropOffAlpha * Intensities[i] + DropOffBeta;
 
+    for (auto idxChannel = 0u; idxChannel < Description.Channels; ++idxChannel)
+      PointsPerChannel[idxChannel] = RecordedDetections[idxChannel].size();
     LidarData.ResetMemory(PointsPerChannel);
 
+    int32 i = 0;
     for (auto idxChannel = 0u; idxChannel < Description.Channels; ++idxChannel) {
-      for (auto& hit : RecordedHits[idxChannel]) {
-        FDetection Detection = ComputeDetection(hit, SensorTransform);
-        if (PostprocessDetection(Detection))
+      for (const auto& RawDetection : RecordedDetections[idxChannel]) {
+        if (Keep[i]) {
+          FDetection Detection(RawDetection.point, Intensities[i]);
+          if (bAddNoise && Distances[i] > 0.0f)
+            Detection.point += RawDetection.point * (Noises[i] / Distances[i]);
           LidarData.WritePointSync(Detection);
-        else
+        } else {
           PointsPerChannel[idxChannel]--;
+        }
+        ++i;
       }
     }
 
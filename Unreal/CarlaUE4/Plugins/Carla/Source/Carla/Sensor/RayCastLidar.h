@@ -38,17 +38,21 @@ public:
   virtual void PostPhysTick(UWorld *World, ELevelTick TickType, float DeltaTime);
 
 private:
-  /// 计算激光点的接收强度
-  float ComputeIntensity(const FSemanticDetection& RawDetection) const;
-  FDetection ComputeDetection(const FHitResult& HitInfo, const FTransform& SensorTransf) const;
-
   void PreprocessRays(uint32_t Channels, uint32_t MaxPointsPerChannel) override;
-  bool PostprocessDetection(FDetection& Detection) const;
 
+  /// 对本帧所有的点批量计算强度、噪声和掉落，再写入 LidarData。
+  /// 每一步都是对连续数组的一次循环，随机数也是整批生成的。
   void ComputeAndSaveDetections(const FTransform& SensorTransform) override;
 
   FLidarData LidarData;
 
+  /// 批量后处理用的临时数组，在帧之间复用以避免重复分配
+  TArray<float> Distances;
+  TArray<float> Intensities;
+  TArray<float> Noises;
+  TArray<float> Uniforms;
+  TArray<uint8> Keep;
+
   /// 启用/禁用激光雷达点的掉落效果
   bool DropOffGenActive;
 
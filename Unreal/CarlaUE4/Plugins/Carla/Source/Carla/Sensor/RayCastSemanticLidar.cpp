@@ -18,6 +18,7 @@
 #include "DrawDebugHelpers.h"
 #include "Engine/CollisionProfile.h"
 #include "Runtime/Engine/Classes/Kismet/KismetMathLibrary.h"
+#include "Runtime/Core/Public/Async/Async.h"
 #include "Runtime/Core/Public/Async/ParallelFor.h"
 
 namespace crp = carla::rpc;
@@ -46,6 +47,7 @@ void ARayCastSemanticLidar::Set(const FLidarDescription &LidarDescription)
   Description = LidarDescription;
   SemanticLidarData = FSemanticLidarData(Description.Channels);
   CreateLasers();
+  RayBatch = FRayBatch{};
   PointsPerChannel.resize(Description.Channels);
 }
 
@@ -65,6 +67,11 @@ void ARayCastSemanticLidar::CreateLasers()
   }
 }
 
+void ARayCastSemanticLidar::BeginPostPhysTick(UWorld *World, float DeltaSeconds)
+{
+  BeginSimulateLidar(DeltaSeconds);
+}
+
 void ARayCastSemanticLidar::PostPhysTick(UWorld *World, ELevelTick TickType, float DeltaTime)
 {
   TRACE_CPUPROFILER_EVENT_SCOPE(ARayCastSemanticLidar::PostPhysTick);
@@ -97,9 +104,24 @@ void ARayCastSemanticLidar::PostPhysTick(UWorld *World, ELevelTick TickType, flo
   #endif
 }
 
-void ARayCastSemanticLidar::SimulateLidar(const float DeltaTime)
+void ARayCastSemanticLidar::EndPlay(EEndPlayReason::Type EndPlayReason)
 {
-  TRACE_CPUPROFILER_EVENT_SCOPE(ARayCastSemanticLidar::SimulateLidar);
+  // The trace task uses this actor, it must finish before it goes away.
+  if (PendingTraces.IsValid())
+  {
+    PendingTraces.Wait();
+    PendingTraces = {};
+  }
+  Super::EndPlay(EndPlayReason);
+}
+
+void ARayCastSemanticLidar::BeginSimulateLidar(const float DeltaTime)
+{
+  TRACE_CPUPROFILER_EVENT_SCOPE(ARayCastSemanticLidar::BeginSimulateLidar);
+  if (PendingTraces.IsValid())
+  {
+    return;
+  }
   const uint32 ChannelCount = Description.Channels;
   const uint32 PointsToScanWithOneLaser =
     FMath::RoundHalfFromZero(
@@ -123,48 +145,134 @@ void ARayCastSemanticLidar::SimulateLidar(const float DeltaTime)
       * DeltaTime;
   const float AngleDistanceOfLaserMeasure = AngleDistanceOfTick / PointsToScanWithOneLaser;
 
-  ResetRecordedHits(ChannelCount, PointsToScanWithOneLaser);
+  UpdateRayBatch(PointsToScanWithOneLaser, CurrentHorizontalAngle, AngleDistanceOfLaserMeasure);
+  ResetRecordedDetections(ChannelCount, PointsToScanWithOneLaser);
   PreprocessRays(ChannelCount, PointsToScanWithOneLaser);
 
-  GetWorld()->GetPhysicsScene()->GetPxScene()->lockRead();
+  PendingTransform = GetTransform();
+  PendingHorizontalAngle = carla::geom::Math::ToRadians(
+      std::fmod(CurrentHorizontalAngle + AngleDistanceOfTick, Description.HorizontalFov));
+  PendingTraces = Async(EAsyncExecution::TaskGraph, [this]() {
+    TraceRays(PendingTransform);
+  });
+}
+
+void ARayCastSemanticLidar::SimulateLidar(const float DeltaTime)
+{
+  TRACE_CPUPROFILER_EVENT_SCOPE(ARayCastSemanticLidar::SimulateLidar);
+  BeginSimulateLidar(DeltaTime);
+  if (!PendingTraces.IsValid())
+  {
+    return;
+  }
+  {
+    TRACE_CPUPROFILER_EVENT_SCOPE_STR("Wait Traces");
+    PendingTraces.Wait();
+    PendingTraces = {};
+  }
+
+  ComputeAndSaveDetections(PendingTransform);
+  SemanticLidarData.SetHorizontalAngle(PendingHorizontalAngle);
+}
+
+void ARayCastSemanticLidar::UpdateRayBatch(
+    uint32_t PointsToScanWithOneLaser,
+    float StartAngle,
+    float AngleStep)
+{
+  if (RayBatch.PointsPerChannel == PointsToScanWithOneLaser &&
+      RayBatch.StartAngle == StartAngle &&
+      RayBatch.AngleStep == AngleStep)
+  {
+    return;
+  }
+  TRACE_CPUPROFILER_EVENT_SCOPE(ARayCastSemanticLidar::UpdateRayBatch);
+  RayBatch.PointsPerChannel = PointsToScanWithOneLaser;
+  RayBatch.StartAngle = StartAngle;
+  RayBatch.AngleStep = AngleStep;
+  RayBatch.Directions.SetNumUninitialized(LaserAngles.Num() * PointsToScanWithOneLaser);
+  for (auto idxChannel = 0; idxChannel < LaserAngles.Num(); ++idxChannel) {
+    const float VertAngle = LaserAngles[idxChannel];
+    for (auto idxPtsOneLaser = 0u; idxPtsOneLaser < PointsToScanWithOneLaser; ++idxPtsOneLaser) {
+      const float HorizAngle = std::fmod(StartAngle + AngleStep * idxPtsOneLaser,
+          Description.HorizontalFov) - Description.HorizontalFov / 2;
+      RayBatch.Directions[idxChannel * PointsToScanWithOneLaser + idxPtsOneLaser] =
+          FRotator(VertAngle, HorizAngle, 0.f).Vector();
+    }
+  }
+}
+
+void ARayCastSemanticLidar::TraceRays(const FTransform &SensorTransform)
+{
+  TRACE_CPUPROFILER_EVENT_SCOPE(ARayCastSemanticLidar::TraceRays);
+  UWorld *World = GetWorld();
+  const uint32 PointsToScanWithOneLaser = RayBatch.PointsPerChannel;
+  const FVector LidarBodyLoc = SensorTransform.GetLocation();
+  const FQuat LidarBodyRot = SensorTransform.GetRotation();
+  const float Range = Description.Range;
+
+  World->GetPhysicsScene()->GetPxScene()->lockRead();
   {
     TRACE_CPUPROFILER_EVENT_SCOPE(ParallelFor);
-    ParallelFor(ChannelCount, [&](int32 idxChannel) {
+    ParallelFor(LaserAngles.Num(), [&](int32 idxChannel) {
       TRACE_CPUPROFILER_EVENT_SCOPE(ParallelForTask);
 
       FCollisionQueryParams TraceParams = FCollisionQueryParams(FName(TEXT("Laser_Trace")), true, this);
       TraceParams.bTraceComplex = true;
       TraceParams.bReturnPhysicalMaterial = false;
 
+      const FVector *Directions =
+          RayBatch.Directions.GetData() + idxChannel * PointsToScanWithOneLaser;
+      auto &Detections = RecordedDetections[idxChannel];
+      auto &Actors = RecordedActors[idxChannel];
+      auto &ActorIndices = RecordedActorIndices[idxChannel];
+      // Consecutive points mostly hit the same actor, check the last one first.
+      TMap<TWeakObjectPtr<AActor>, uint32_t> ActorIndexMap;
       for (auto idxPtsOneLaser = 0u; idxPtsOneLaser < PointsToScanWithOneLaser; idxPtsOneLaser++) {
-        FHitResult HitResult;
-        const float VertAngle = LaserAngles[idxChannel];
-        const float HorizAngle = std::fmod(CurrentHorizontalAngle + AngleDistanceOfLaserMeasure
-            * idxPtsOneLaser, Description.HorizontalFov) - Description.HorizontalFov / 2;
-        const bool PreprocessResult = RayPreprocessCondition[idxChannel][idxPtsOneLaser];
-
-        if (PreprocessResult && ShootLaser(VertAngle, HorizAngle, HitResult, TraceParams)) {
-          WritePointAsync(idxChannel, HitResult);
+        if (!RayPreprocessCondition[idxChannel][idxPtsOneLaser]) {
+          continue;
+        }
+        const FVector EndTrace = LidarBodyLoc + Range * LidarBodyRot.RotateVector(Directions[idxPtsOneLaser]);
+        FHitResult HitInfo(ForceInit);
+        World->ParallelLineTraceSingleByChannel(
+          HitInfo,
+          LidarBodyLoc,
+          EndTrace,
+          ECC_GameTraceChannel2,
+          TraceParams,
+          FCollisionResponseParams::DefaultResponseParam
+        );
+        if (HitInfo.bBlockingHit) {
+          Detections.emplace_back();
+          ComputeRawDetection(HitInfo, SensorTransform, Detections.back());
+          if (Actors.empty() || Actors.back() != HitInfo.Actor) {
+            const uint32_t *Index = ActorIndexMap.Find(HitInfo.Actor);
+            if (Index == nullptr) {
+              Index = &ActorIndexMap.Add(HitInfo.Actor, static_cast<uint32_t>(Actors.size()));
+              Actors.emplace_back(HitInfo.Actor);
+            }
+            ActorIndices.emplace_back(*Index);
+          } else {
+            ActorIndices.emplace_back(static_cast<uint32_t>(Actors.size() - 1u));
+          }
         }
-      };
+      }
     });
   }
-  GetWorld()->GetPhysicsScene()->GetPxScene()->unlockRead();
-
-  FTransform ActorTransf = GetTransform();
-  ComputeAndSaveDetections(ActorTransf);
-
-  const float HorizontalAngle = carla::geom::Math::ToRadians(
-      std::fmod(CurrentHorizontalAngle + AngleDistanceOfTick, Description.HorizontalFov));
-  SemanticLidarData.SetHorizontalAngle(HorizontalAngle);
+  World->GetPhysicsScene()->GetPxScene()->unlockRead();
 }
 
-void ARayCastSemanticLidar::ResetRecordedHits(uint32_t Channels, uint32_t MaxPointsPerChannel) {
-  RecordedHits.resize(Channels);
-
-  for (auto& hits : RecordedHits) {
-    hits.clear();
-    hits.reserve(MaxPointsPerChannel);
+void ARayCastSemanticLidar::ResetRecordedDetections(uint32_t Channels, uint32_t MaxPointsPerChannel) {
+  RecordedDetections.resize(Channels);
+  RecordedActors.resize(Channels);
+  RecordedActorIndices.resize(Channels);
+
+  for (auto idxChannel = 0u; idxChannel < Channels; ++idxChannel) {
+    RecordedDetections[idxChannel].clear();
+    RecordedDetections[idxChannel].reserve(MaxPointsPerChannel);
+    RecordedActors[idxChannel].clear();
+    RecordedActorIndices[idxChannel].clear();
+    RecordedActorIndices[idxChannel].reserve(MaxPointsPerChannel);
   }
 }
 
@@ -178,23 +286,31 @@ void ARayCastSemanticLidar::PreprocessRays(uint32_t Channels, uint32_t MaxPoints
   }
 }
 
-void ARayCastSemanticLidar::WritePointAsync(uint32_t channel, FHitResult &detection) {
-	TRACE_CPUPROFILER_EVENT_SCOPE_STR(__FUNCTION__);
-  DEBUG_ASSERT(GetChannelCount() > channel);
-  RecordedHits[channel].emplace_back(detection);
-}
-
 void ARayCastSemanticLidar::ComputeAndSaveDetections(const FTransform& SensorTransform) {
 	TRACE_CPUPROFILER_EVENT_SCOPE_STR(__FUNCTION__);
   for (auto idxChannel = 0u; idxChannel < Description.Channels; ++idxChannel)
-    PointsPerChannel[idxChannel] = RecordedHits[idxChannel].size();
+    PointsPerChannel[idxChannel] = RecordedDetections[idxChannel].size();
   SemanticLidarData.ResetMemory(PointsPerChannel);
 
+  const FActorRegistry &Registry = GetEpisode().GetActorRegistry();
+  std::vector<uint32_t> ActorIds;
   for (auto idxChannel = 0u; idxChannel < Description.Channels; ++idxChannel) {
-    for (auto& hit : RecordedHits[idxChannel]) {
-      FSemanticDetection detection;
-      ComputeRawDetection(hit, SensorTransform, detection);
-      SemanticLidarData.WritePointSync(detection);
+    // Resolve each distinct actor of the channel once.
+    const auto &Actors = RecordedActors[idxChannel];
+    ActorIds.assign(Actors.size(), 0u);
+    for (auto a = 0u; a < Actors.size(); ++a) {
+      const AActor *Actor = Actors[a].Get();
+      if (Actor != nullptr) {
+        const FCarlaActor* View = Registry.FindCarlaActor(Actor);
+        if (View)
+          ActorIds[a] = View->GetActorId();
+      }
+    }
+    auto &Detections = RecordedDetections[idxChannel];
+    const auto &ActorIndices = RecordedActorIndices[idxChannel];
+    for (auto i = 0u; i < Detections.size(); ++i) {
+      Detections[i].object_idx = ActorIds[ActorIndices[i]];
+      SemanticLidarData.WritePointSync(Detections[i]);
     }
   }
 
@@ -204,62 +320,11 @@ void ARayCastSemanticLidar::ComputeAndSaveDetections(const FTransform& SensorTra
 void ARayCastSemanticLidar::ComputeRawDetection(const FHitResult& HitInfo, const FTransform& SensorTransf, FSemanticDetection& Detection) const
 {
     const FVector HitPoint = HitInfo.ImpactPoint;
-    Detection.point = SensorTransf.Inverse().TransformPosition(HitPoint);
+    Detection.point = SensorTransf.InverseTransformPosition(HitPoint);
 
     const FVector VecInc = - (HitPoint - SensorTransf.GetLocation()).GetSafeNormal();
     Detection.cos_inc_angle = FVector::DotProduct(VecInc, HitInfo.ImpactNormal);
 
-    const FActorRegistry &Registry = GetEpisode().GetActorRegistry();
-
-    const AActor* actor = HitInfo.Actor.Get();
     Detection.object_idx = 0;
     Detection.object_tag = static_cast<uint32_t>(HitInfo.Component->CustomDepthStencilValue);
-
-    if (actor != nullptr) {
-
-      const FCarlaActor* view = Registry.FindCarlaActor(actor);
-      if(view)
-        Detection.object_idx = view->GetActorId();
-
-    }
-    else {
-      UE_LOG(LogCarla, Warning, TEXT("Actor not valid %p!!!!"), actor);
-    }
-}
-
-
-bool ARayCastSemanticLidar::ShootLaser(const float VerticalAngle, const float HorizontalAngle, FHitResult& HitResult, FCollisionQueryParams& TraceParams) const
-{
-  TRACE_CPUPROFILER_EVENT_SCOPE_STR(__FUNCTION__);
-
-  FHitResult HitInfo(ForceInit);
-
-  FTransform ActorTransf = GetTransform();
-  FVector LidarBodyLoc = ActorTransf.GetLocation();
-  FRotator LidarBodyRot = ActorTransf.Rotator();
-
-  FRotator LaserRot (VerticalAngle, HorizontalAngle, 0);  // float InPitch, float InYaw, float InRoll
-  FRotator ResultRot = UKismetMathLibrary::ComposeRotators(
-    LaserRot,
-    LidarBodyRot
-  );
-
-  const auto Range = Description.Range;
-  FVector EndTrace = Range * UKismetMathLibrary::GetForwardVector(ResultRot) + LidarBodyLoc;
-
-  GetWorld()->ParallelLineTraceSingleByChannel(
-    HitInfo,
-    LidarBodyLoc,
-    EndTrace,
-    ECC_GameTraceChannel2,
-    TraceParams,
-    FCollisionResponseParams::DefaultResponseParam
-  );
-
-  if (HitInfo.bBlockingHit) {
-    HitResult = HitInfo;
-    return true;
-  } else {
-    return false;
-  }
 }
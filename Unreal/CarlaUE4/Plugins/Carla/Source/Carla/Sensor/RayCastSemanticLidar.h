@@ -13,6 +13,7 @@
 #include "Carla/Actor/ActorDefinition.h"
 #include "Carla/Sensor/LidarDescription.h"
 #include "Carla/Actor/ActorBlueprintFunctionLibrary.h"
+#include "Async/Future.h"
 
 #include <compiler/disable-ue4-macros.h>
 #include <carla/sensor/data/SemanticLidarData.h>
@@ -40,31 +41,41 @@ public:
   virtual void Set(const FLidarDescription &LidarDescription);
 
 protected:
+  virtual void BeginPostPhysTick(UWorld *World, float DeltaSeconds) override;
+
   virtual void PostPhysTick(UWorld *World, ELevelTick TickType, float DeltaTime) override;
 
+  virtual void EndPlay(EEndPlayReason::Type EndPlayReason) override;
+
   /// Creates a Laser for each channel.
   void CreateLasers();
 
+  /// Starts tracing the rays of this frame in the background, if they are not
+  /// being traced already.
+  void BeginSimulateLidar(const float DeltaTime);
+
   /// Updates LidarMeasurement with the points read in DeltaTime.
   void SimulateLidar(const float DeltaTime);
 
-  /// Shoot a laser ray-trace, return whether the laser hit something.
-  bool ShootLaser(const float VerticalAngle, float HorizontalAngle, FHitResult &HitResult, FCollisionQueryParams& TraceParams) const;
+  /// Rebuilds the sensor-local ray directions if the scan pattern changed.
+  void UpdateRayBatch(uint32_t PointsPerChannel, float StartAngle, float AngleStep);
+
+  /// Traces every enabled ray of the batch from @a SensorTransform and stores
+  /// the hits in RecordedDetections. Runs outside the game thread.
+  void TraceRays(const FTransform &SensorTransform);
 
   /// Method that allow to preprocess if the rays will be traced.
   virtual void PreprocessRays(uint32_t Channels, uint32_t MaxPointsPerChannel);
 
-  /// Compute all raw detection information
+  /// Compute all raw detection information except the actor id, which is
+  /// resolved later on the game thread.
   void ComputeRawDetection(const FHitResult &HitInfo, const FTransform &SensorTransf, FSemanticDetection &Detection) const;
 
-  /// Saving the hits the raycast returns per channel
-  void WritePointAsync(uint32_t Channel, FHitResult &Detection);
-
   /// Clear the recorded data structure
-  void ResetRecordedHits(uint32_t Channels, uint32_t MaxPointsPerChannel);
+  void ResetRecordedDetections(uint32_t Channels, uint32_t MaxPointsPerChannel);
 
-  /// This method uses all the saved FHitResults, compute the
-  /// RawDetections and then send it to the LidarData structure.
+  /// This method uses all the recorded detections, resolves the ids of the
+  /// hit actors and then send them to the LidarData structure.
   virtual void ComputeAndSaveDetections(const FTransform &SensorTransform);
 
   UPROPERTY(EditAnywhere)
@@ -72,10 +83,35 @@ protected:
 
   TArray<float> LaserAngles;
 
-  std::vector<std::vector<FHitResult>> RecordedHits;
+  /// Sensor-local unit direction of every ray, reused while the number of
+  /// points and the horizontal angles of the scan stay the same.
+  struct FRayBatch
+  {
+    uint32_t PointsPerChannel = 0u;
+    float StartAngle = 0.f;
+    float AngleStep = 0.f;
+    /// Direction of point P of channel C at [C * PointsPerChannel + P].
+    TArray<FVector> Directions;
+  };
+
+  FRayBatch RayBatch;
+
+  /// Detections per channel, written by the trace task.
+  std::vector<std::vector<FSemanticDetection>> RecordedDetections;
+  /// Distinct actors hit in each channel. Resolving the actor id once per
+  /// actor instead of once per point avoids a weak pointer resolution and a
+  /// registry lookup for every detection.
+  std::vector<std::vector<TWeakObjectPtr<AActor>>> RecordedActors;
+  /// Index in RecordedActors of the actor hit by each of RecordedDetections.
+  std::vector<std::vector<uint32_t>> RecordedActorIndices;
   std::vector<std::vector<bool>> RayPreprocessCondition;
   std::vector<uint32_t> PointsPerChannel;
 
+  /// Rays of this frame being traced in the background.
+  TFuture<void> PendingTraces;
+  FTransform PendingTransform;
+  float PendingHorizontalAngle = 0.f;
+
 private:
   FSemanticLidarData SemanticLidarData;
 
@@ -6,6 +6,7 @@
 
 #include "Carla.h"
 #include "Carla/Sensor/SceneCaptureSensor.h"
+#include "Carla/Sensor/CameraRig.h"
 #include "Carla/Game/CarlaStatics.h"
 #include "Actor/ActorBlueprintFunctionLibrary.h"
 
@@ -15,6 +16,9 @@
 
 static auto SCENE_CAPTURE_COUNTER = 0u;
 
+// Scene captures enqueued since the last call to TakeSceneCaptureCount.
+static uint32 SCENE_CAPTURES_THIS_FRAME = 0u;
+
 // =============================================================================
 // -- Local static methods -----------------------------------------------------
 // =============================================================================
@@ -26,6 +30,10 @@ namespace SceneCaptureSensor_local_ns {
 
   static void ConfigureShowFlags(FEngineShowFlags &ShowFlags, bool bPostProcessing = true);
 
+  static void ApplyRenderingProfile(
+      USceneCaptureComponent2D &CaptureComponent2D,
+      const FSceneCaptureRenderingProfile &Profile);
+
   static auto GetQualitySettings(UWorld *World)
   {
     auto Settings = UCarlaStatics::GetCarlaSettings(World);
@@ -449,11 +457,38 @@ float ASceneCaptureSensor::GetChromAberrOffset() const
 
 void ASceneCaptureSensor::EnqueueRenderSceneImmediate() {
   TRACE_CPUPROFILER_EVENT_SCOPE(ASceneCaptureSensor::EnqueueRenderSceneImmediate);
+  ++SCENE_CAPTURES_THIS_FRAME;
+  // Cameras in a rig are captured together by the rig.
+  if (IsValid(Rig))
+  {
+    Rig->CaptureFrame();
+    return;
+  }
+  // The GBuffer extraction is only used while a client listens to the
+  // multipart GBuffer stream, the per-texture GBuffer streams are not opened.
+  if (IsMultipartGBufferRequested())
+  {
+    // Equivalent to "CaptureComponent2D->CaptureScene" + GBuffer extraction.
+    CaptureSceneExtended();
+    return;
+  }
   // Creates an snapshot of the scene, requieres bCaptureEveryFrame = false.
   GetCaptureComponent2D()->CaptureScene();
+}
 
-  // // Equivalent to "CaptureComponent2D->CaptureScene" + (optional) GBuffer extraction.
-  // CaptureSceneExtended();
+bool ASceneCaptureSensor::IsMultipartGBufferRequested()
+{
+  auto &Multipart = CameraGBuffers.Multipart;
+  return Multipart.TextureMask.load() != 0u &&
+      Multipart.Stream.IsStreamReady() &&
+      Multipart.Stream.AreClientsListening();
+}
+
+uint32 ASceneCaptureSensor::TakeSceneCaptureCount()
+{
+  const uint32 Count = SCENE_CAPTURES_THIS_FRAME;
+  SCENE_CAPTURES_THIS_FRAME = 0u;
+  return Count;
 }
 
 constexpr const TCHAR* GBufferNames[] =
@@ -476,7 +511,9 @@ constexpr const TCHAR* GBufferNames[] =
 template <EGBufferTextureID ID, typename T>
 static void CheckGBufferStream(T& GBufferStream, FGBufferRequest& GBuffer)
 {
-  GBufferStream.bIsUsed = GBufferStream.Stream.AreClientsListening();
+  GBufferStream.bIsUsed =
+      GBufferStream.Stream.IsStreamReady() &&
+      GBufferStream.Stream.AreClientsListening();
   if (GBufferStream.bIsUsed)
     GBuffer.MarkAsRequested(ID);
 }
@@ -502,6 +539,18 @@ void ASceneCaptureSensor::CaptureSceneExtended()
   CheckGBufferStream<EGBufferTextureID::CustomDepth>(CameraGBuffers.CustomDepth, GBuffer);
   CheckGBufferStream<EGBufferTextureID::CustomStencil>(CameraGBuffers.CustomStencil, GBuffer);
 
+  // Textures requested through the multipart stream.
+  if (IsMultipartGBufferRequested())
+  {
+    const uint64 MultipartMask = CameraGBuffers.Multipart.TextureMask.load();
+    for (uint32 i = 0; i != FGBufferRequest::TextureCount; ++i)
+    {
+      if ((MultipartMask & (UINT64_C(1) << i)) != 0)
+        GBuffer.MarkAsRequested((EGBufferTextureID)i);
+    }
+    CameraGBuffers.Multipart.SensorTransform = GetActorTransform();
+  }
+
   if (GBufferPtr->DesiredTexturesMask == 0)
   {
     // Creates an snapshot of the scene, requieres bCaptureEveryFrame = false.
@@ -579,11 +628,18 @@ void ASceneCaptureSensor::BeginPlay()
 
   SceneCaptureSensor_local_ns::ConfigureShowFlags(CaptureComponent2D->ShowFlags,
       bEnablePostProcessingEffects);
+  SceneCaptureSensor_local_ns::ApplyRenderingProfile(*CaptureComponent2D, RenderingProfile);
 
   // This ensures the camera is always spawning the raindrops in case the
   // weather was previously set to have rain.
   GetEpisode().GetWeather()->NotifyWeather(this);
 
+  // The rig may have set a shared ring before BeginPlay.
+  if (!ReadbackRing.IsValid())
+  {
+    ReadbackRing = MakeShared<FPixelReadbackRing, ESPMode::ThreadSafe>(ReadbackBufferCount);
+  }
+
   Super::BeginPlay();
 }
 
@@ -608,6 +664,16 @@ void ASceneCaptureSensor::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
   Super::EndPlay(EndPlayReason);
   FlushRenderingCommands();
+  if (IsValid(Rig))
+  {
+    Rig->RemoveCamera(this);
+  }
+  // Send the frames still in flight before the sensor goes away.
+  if (ReadbackRing.IsValid())
+  {
+    ReadbackRing->Flush();
+    ReadbackRing.Reset();
+  }
   SCENE_CAPTURE_COUNTER = 0u;
 }
 
@@ -857,4 +923,38 @@ namespace SceneCaptureSensor_local_ns {
     // ShowFlags.SetWireframe(false);
   }
 
+  static void ApplyRenderingProfile(
+      USceneCaptureComponent2D &CaptureComponent2D,
+      const FSceneCaptureRenderingProfile &Profile)
+  {
+    auto &ShowFlags = CaptureComponent2D.ShowFlags;
+    if (!Profile.bShadows)
+    {
+      ShowFlags.SetDynamicShadows(false);
+      ShowFlags.SetContactShadows(false);
+      ShowFlags.SetCapsuleShadows(false);
+    }
+    if (!Profile.bTranslucency)
+    {
+      ShowFlags.SetTranslucency(false);
+    }
+    if (!Profile.bAmbientOcclusion)
+    {
+      ShowFlags.SetAmbientOcclusion(false);
+      ShowFlags.SetDistanceFieldAO(false);
+    }
+    if (!Profile.bReflections)
+    {
+      ShowFlags.SetScreenSpaceReflections(false);
+      ShowFlags.SetReflectionEnvironment(false);
+    }
+    if (!Profile.bVolumetricFog)
+    {
+      ShowFlags.SetVolumetricFog(false);
+    }
+    CaptureComponent2D.LODDistanceFactor = FMath::Max(Profile.LODDistanceScale, 0.01f);
+    CaptureComponent2D.MaxViewDistanceOverride =
+        Profile.MaxViewDistance > 0.0f ? Profile.MaxViewDistance : -1.0f;
+  }
+
 } // namespace SceneCaptureSensor_local_ns
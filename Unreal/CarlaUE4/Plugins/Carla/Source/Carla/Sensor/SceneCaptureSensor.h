@@ -14,12 +14,14 @@
 #include "Async/Async.h"
 #include "Renderer/Public/GBufferView.h"
 
+#include <atomic>
 #include <type_traits>
 
 #include "SceneCaptureSensor.generated.h"
 
 
 
+class ACameraRig;
 class UDrawFrustumComponent;
 class UStaticMeshComponent;
 class UTextureRenderTarget2D;
@@ -111,6 +113,87 @@ struct FCameraGBufferFloat
 
 
 
+/// Stream that packs every requested GBuffer texture of a frame into a single
+/// message, see carla::sensor::s11n::GBufferMultipartSerializer.
+struct FCameraGBufferMultipart
+{
+  /// Prevent this sensor to be spawned by users.
+  using not_spawnable = void;
+
+  void SetDataStream(FDataStream InStream)
+  {
+    Stream = std::move(InStream);
+  }
+
+  /// Return the token that allows subscribing to this sensor's stream.
+  auto GetToken() const
+  {
+    return Stream.GetToken();
+  }
+
+  /// Transform of the camera at the time of the capture.
+  FTransform GetActorTransform() const
+  {
+    return SensorTransform;
+  }
+
+  /// Unlike the other GBuffer streams the header identifies this struct, so the
+  /// client decodes the message as a multipart GBuffer.
+  template <typename SensorT>
+  FAsyncDataStream GetDataStream(const SensorT &Self)
+  {
+    return Stream.MakeAsyncDataStream(*this, Self.GetEpisode().GetElapsedGameTime());
+  }
+
+  /// Bit i requests the texture with EGBufferTextureID i, zero disables the
+  /// stream. Set by the client through "get_gbuffer_multipart_token".
+  std::atomic<uint64> TextureMask{0u};
+
+  FTransform SensorTransform;
+
+  FDataStream Stream;
+};
+
+/// Per-sensor rendering settings that reduce the cost of a scene capture
+/// independently of the global quality level. Applied on top of the show
+/// flags configured for the post-processing mode, they can only remove
+/// features from the capture.
+struct FSceneCaptureRenderingProfile
+{
+  bool bShadows = true;
+
+  bool bTranslucency = true;
+
+  bool bAmbientOcclusion = true;
+
+  /// Screen space reflections and reflection captures.
+  bool bReflections = true;
+
+  bool bVolumetricFog = true;
+
+  /// Scales the distance used to select the LOD of the meshes, values above
+  /// one switch to the coarser LODs sooner.
+  float LODDistanceScale = 1.0f;
+
+  /// Primitives further than this distance, in centimeters, are culled. Zero
+  /// or less keeps the distance of the level.
+  float MaxViewDistance = 0.0f;
+
+  /// Profile with shadows, translucency, ambient occlusion, reflections and
+  /// volumetric fog disabled and twice the LOD distance scale, meant for
+  /// auxiliary cameras where image quality matters little.
+  static FSceneCaptureRenderingProfile Low()
+  {
+    FSceneCaptureRenderingProfile Profile;
+    Profile.bShadows = false;
+    Profile.bTranslucency = false;
+    Profile.bAmbientOcclusion = false;
+    Profile.bReflections = false;
+    Profile.bVolumetricFog = false;
+    Profile.LODDistanceScale = 2.0f;
+    return Profile;
+  }
+};
 
 
 
@@ -128,6 +211,7 @@ class CARLA_API ASceneCaptureSensor : public ASensor
   GENERATED_BODY()
 
   friend class ACarlaGameModeBase;
+  friend class ACameraRig;
   friend class FPixelReader;
   friend class FPixelReader2;
 
@@ -149,6 +233,22 @@ public:
     return ImageHeight;
   }
 
+  void SetRenderingProfile(const FSceneCaptureRenderingProfile &InProfile)
+  {
+    RenderingProfile = InProfile;
+  }
+
+  const FSceneCaptureRenderingProfile &GetRenderingProfile() const
+  {
+    return RenderingProfile;
+  }
+
+  /// Cameras are scheduled by their resolution until their cost is measured.
+  double GetEstimatedTickCost() const override
+  {
+    return 0.5 + 1e-6 * ImageWidth * ImageHeight;
+  }
+
   UFUNCTION(BlueprintCallable)
   void EnablePostProcessingEffects(bool Enable = true)
   {
@@ -396,6 +496,10 @@ public:
   /// Immediate enqueues render commands of the scene at the current time.
   void EnqueueRenderSceneImmediate();
 
+  /// Returns the number of scene captures enqueued since the last call and
+  /// resets it. Called once per frame, game thread only.
+  static uint32 TakeSceneCaptureCount();
+
   /// Blocks until the render thread has finished all it's tasks.
   void WaitForRenderThreadToFinish() {
     TRACE_CPUPROFILER_EVENT_SCOPE(ASceneCaptureSensor::WaitForRenderThreadToFinish);
@@ -417,10 +521,15 @@ public:
     FCameraGBufferUint8 SSAO;
     FCameraGBufferUint8 CustomDepth;
     FCameraGBufferUint8 CustomStencil;
+    FCameraGBufferMultipart Multipart;
   } CameraGBuffers;
 
 protected:
 
+  /// Whether a client listens to the multipart GBuffer stream with a non-empty
+  /// texture mask.
+  bool IsMultipartGBufferRequested();
+
   void CaptureSceneExtended();
 
   virtual void SendGBufferTextures(FGBufferRequest& GBuffer);
@@ -461,23 +570,34 @@ protected:
   UPROPERTY(EditAnywhere)
   bool bEnable16BitFormat = false;
 
+  /// Show flags, LOD and view distance settings applied in BeginPlay.
+  FSceneCaptureRenderingProfile RenderingProfile;
+
+  /// Number of GPU readback buffers in flight. The pixels of a frame are sent
+  /// when its buffer is ready, so the game and render threads do not wait for
+  /// the GPU unless all of them are still in use.
+  UPROPERTY(EditAnywhere)
+  uint32 ReadbackBufferCount = 3u;
+
+  /// Readback buffers used by FPixelReader::SendPixelsInRenderThread, created
+  /// in BeginPlay. Shared by all the cameras of the rig, if any.
+  TSharedPtr<FPixelReadbackRing, ESPMode::ThreadSafe> ReadbackRing;
+
+  /// Rig this camera belongs to, it captures the scene for all its cameras.
+  UPROPERTY()
+  ACameraRig *Rig = nullptr;
+
 private:
 
-  template <
-    typename SensorT,
-    typename CameraGBufferT>
-  static void SendGBuffer(
-      SensorT& Self,
-      CameraGBufferT& CameraGBuffer,
+  /// Decode the texture @a TextureID of @a GBufferData into @a Pixels, black
+  /// if the transfer failed. Returns the size of the view.
+  template <typename PixelType>
+  static FIntPoint DecodeGBuffer(
       FGBufferRequest& GBufferData,
-      EGBufferTextureID TextureID)
-  {
-      using PixelType = typename std::conditional<
-        std::is_same<std::remove_reference_t<CameraGBufferT>, FCameraGBufferUint8>::value,
-        FColor,
-        FLinearColor>::type;
-      FIntPoint ViewSize;
-      TArray<PixelType> Pixels;
+      EGBufferTextureID TextureID,
+      TArray<PixelType>& Pixels)
+  {
+      const FIntPoint ViewSize = GBufferData.ViewRect.Size();
       if (GBufferData.WaitForTextureTransfer(TextureID))
       {
         TRACE_CPUPROFILER_EVENT_SCOPE_STR("GBuffer Decode");
@@ -490,7 +610,6 @@ private:
           SourcePitch,
           SourceExtent);
         auto Format = GBufferData.Readbacks[(size_t)TextureID]->GetFormat();
-        ViewSize = GBufferData.ViewRect.Size();
         Pixels.AddUninitialized(ViewSize.X * ViewSize.Y);
         FReadSurfaceDataFlags Flags = {};
         Flags.SetLinearToGamma(true);
@@ -506,11 +625,23 @@ private:
       }
       else
       {
-        ViewSize = GBufferData.ViewRect.Size();
         Pixels.SetNum(ViewSize.X * ViewSize.Y);
         for (auto& Pixel : Pixels)
           Pixel = PixelType::Black;
       }
+      return ViewSize;
+  }
+
+  template <
+    typename SensorT,
+    typename CameraGBufferT,
+    typename PixelType>
+  static void SendGBuffer(
+      SensorT& Self,
+      CameraGBufferT& CameraGBuffer,
+      const TArray<PixelType>& Pixels,
+      FIntPoint ViewSize)
+  {
       auto GBufferStream = CameraGBuffer.GetDataStream(Self);
       auto Buffer = GBufferStream.PopBufferFromPool();
       Buffer.copy_from(
@@ -534,57 +665,71 @@ protected:
   template <typename T>
   void SendGBufferTexturesInternal(T& Self, FGBufferRequest& GBufferData)
   {
+    auto& C = CameraGBuffers;
+    // In the order of EGBufferTextureID.
+    FCameraGBufferUint8* const Streams[] =
+    {
+      &C.SceneColor,
+      &C.SceneDepth,
+      &C.SceneStencil,
+      &C.GBufferA,
+      &C.GBufferB,
+      &C.GBufferC,
+      &C.GBufferD,
+      &C.GBufferE,
+      &C.GBufferF,
+      &C.Velocity,
+      &C.SSAO,
+      &C.CustomDepth,
+      &C.CustomStencil,
+    };
+    static_assert(UE_ARRAY_COUNT(Streams) == FGBufferRequest::TextureCount, "Missing GBuffer stream");
+
+    // Textures requested through the multipart stream are appended, in ID
+    // order, to a single buffer and sent together.
+    const uint64 MultipartMask = C.Multipart.TextureMask.load() & GBufferData.DesiredTexturesMask;
+    carla::Buffer MultipartBuffer;
+    size_t MultipartSize = carla::sensor::SensorRegistry::get<FCameraGBufferMultipart*>::type::header_offset;
+    FIntPoint ViewSize = GBufferData.ViewRect.Size();
+    if (MultipartMask != 0u)
+    {
+      const size_t TextureBytes = sizeof(FColor) * ViewSize.X * ViewSize.Y;
+      MultipartBuffer.reset(MultipartSize + FMath::CountBits(MultipartMask) * TextureBytes);
+    }
+
     for (size_t i = 0; i != FGBufferRequest::TextureCount; ++i)
     {
-      if ((GBufferData.DesiredTexturesMask & (UINT64_C(1) << i)) == 0) {
+      const uint64 Bit = UINT64_C(1) << i;
+      if ((GBufferData.DesiredTexturesMask & Bit) == 0) {
         continue;
       }
-      auto& C = CameraGBuffers;
-      EGBufferTextureID ID = (EGBufferTextureID)i;
-      switch (ID)
+      TArray<FColor> Pixels;
+      ViewSize = DecodeGBuffer(GBufferData, (EGBufferTextureID)i, Pixels);
+      if (Streams[i]->bIsUsed)
       {
-      case EGBufferTextureID::SceneColor:
-        SendGBuffer(Self, C.SceneColor, GBufferData, ID);
-        break;
-      case EGBufferTextureID::SceneDepth:
-        SendGBuffer(Self, C.SceneDepth, GBufferData, ID);
-        break;
-      case EGBufferTextureID::SceneStencil:
-        SendGBuffer(Self, C.SceneStencil, GBufferData, ID);
-        break;
-      case EGBufferTextureID::GBufferA:
-        SendGBuffer(Self, C.GBufferA, GBufferData, ID);
-        break;
-      case EGBufferTextureID::GBufferB:
-        SendGBuffer(Self, C.GBufferB, GBufferData, ID);
-        break;
-      case EGBufferTextureID::GBufferC:
-        SendGBuffer(Self, C.GBufferC, GBufferData, ID);
-        break;
-      case EGBufferTextureID::GBufferD:
-        SendGBuffer(Self, C.GBufferD, GBufferData, ID);
-        break;
-      case EGBufferTextureID::GBufferE:
-        SendGBuffer(Self, C.GBufferE, GBufferData, ID);
-        break;
-      case EGBufferTextureID::GBufferF:
-        SendGBuffer(Self, C.GBufferF, GBufferData, ID);
-        break;
-      case EGBufferTextureID::Velocity:
-        SendGBuffer(Self, C.Velocity, GBufferData, ID);
-        break;
-      case EGBufferTextureID::SSAO:
-        SendGBuffer(Self, C.SSAO, GBufferData, ID);
-        break;
-      case EGBufferTextureID::CustomDepth:
-        SendGBuffer(Self, C.CustomDepth, GBufferData, ID);
-        break;
-      case EGBufferTextureID::CustomStencil:
-        SendGBuffer(Self, C.CustomStencil, GBufferData, ID);
-        break;
-      default:
-          abort();
+        SendGBuffer(Self, *Streams[i], Pixels, ViewSize);
       }
+      if ((MultipartMask & Bit) != 0)
+      {
+        const size_t Bytes = Pixels.Num() * sizeof(FColor);
+        FMemory::Memcpy(MultipartBuffer.data() + MultipartSize, Pixels.GetData(), Bytes);
+        MultipartSize += Bytes;
+      }
+    }
+
+    if (MultipartMask != 0u)
+    {
+      SCOPE_CYCLE_COUNTER(STAT_CarlaSensorStreamSend);
+      TRACE_CPUPROFILER_EVENT_SCOPE_STR("Stream Send (multipart GBuffer)");
+      check(MultipartSize == MultipartBuffer.size());
+      auto MultipartStream = C.Multipart.GetDataStream(Self);
+      MultipartStream.SerializeAndSend(
+        C.Multipart,
+        std::move(MultipartBuffer),
+        ViewSize.X,
+        ViewSize.Y,
+        Self.GetFOVAngle(),
+        MultipartMask);
     }
   }
 
@@ -12,9 +12,21 @@
 
 #include "Carla/Sensor/PixelReader.h"
 
+#include "HAL/IConsoleManager.h"
+
+static TAutoConsoleVariable<int32> CVarCompactSemanticReadback(
+    TEXT("carla.Sensor.CompactSemanticReadback"),
+    0,
+    TEXT("If 1, semantic segmentation cameras read back only the label channel ")
+    TEXT("(1 byte per pixel) and expand it to BGRA on the CPU."),
+    ECVF_Default);
+
 FActorDefinition ASemanticSegmentationCamera::GetSensorDefinition()
 {
-  return UActorBlueprintFunctionLibrary::MakeCameraDefinition(TEXT("semantic_segmentation"));
+  FActorDefinition Definition = UActorBlueprintFunctionLibrary::MakeCameraDefinition(TEXT("semantic_segmentation"));
+  // 只渲染指定语义标签的物体，其余像素为未标注
+  AddShowOnlyTagsVariation(Definition);
+  return Definition;
 }
 
 ASemanticSegmentationCamera::ASemanticSegmentationCamera(
@@ -31,5 +43,25 @@ ASemanticSegmentationCamera::ASemanticSegmentationCamera(
 void ASemanticSegmentationCamera::PostPhysTick(UWorld *World, ELevelTick TickType, float DeltaSeconds)
 {
   TRACE_CPUPROFILER_EVENT_SCOPE(ASemanticSegmentationCamera::PostPhysTick);
-  FPixelReader::SendPixelsInRenderThread<ASemanticSegmentationCamera, FColor>(*this);
+  if (CVarCompactSemanticReadback.GetValueOnGameThread() != 0 && IsCarlaPixelConversionSupported())
+  {
+    // 只回读标签所在的红色通道，再在CPU上还原成BGRA格式
+    std::function<TArray<FColor>(void *, uint32)> Conversor = [](void *Data, uint32 Size)
+    {
+      TArray<FColor> Pixels;
+      Pixels.SetNumUninitialized(Size);
+      const uint8 *Labels = reinterpret_cast<const uint8 *>(Data);
+      for (uint32 i = 0u; i < Size; ++i)
+      {
+        Pixels[i] = FColor(Labels[i], 0u, 0u, 255u);
+      }
+      return Pixels;
+    };
+    FPixelReader::SendPixelsInRenderThread<ASemanticSegmentationCamera, FColor>(
+        *this, false, Conversor, ECarlaPixelConversion::RedToR8);
+  }
+  else
+  {
+    FPixelReader::SendPixelsInRenderThread<ASemanticSegmentationCamera, FColor>(*this);
+  }
 }
@@ -44,6 +44,14 @@ void ASensor::Set(const FActorDescription &Description)
         UActorBlueprintFunctionLibrary::ActorAttributeToFloat(Description.Variations["sensor_tick"],
         0.0f));
   }
+
+  // tick only every N frames, the phase is chosen when registering the sensor
+  if (Description.Variations.Contains("tick_divisor"))
+  {
+    TickDivisor = static_cast<uint32>(FMath::Max(1,
+        UActorBlueprintFunctionLibrary::ActorAttributeToInt(Description.Variations["tick_divisor"],
+        1)));
+  }
 }
 
 boost::optional<FActorAttribute> ASensor::GetAttribute(const FString Name)
@@ -80,6 +88,15 @@ void ASensor::Tick(const float DeltaTime)
   {
     return;
   }
+  if(!Stream.HasCredit())
+  {
+    // 客户端还没有处理完之前的数据，跳过这一帧而不是渲染没有人读取的数据
+    return;
+  }
+  if(!ShouldTickOnFrame(FCarlaEngine::GetFrameCounter()))
+  {
+    return;
+  }
   ReadyToTick = true;
   PrePhysTick(DeltaTime);
 }
@@ -128,12 +145,22 @@ void ASensor::EndPlay(EEndPlayReason::Type EndPlayReason)
   }
 }
 
-void ASensor::PostPhysTickInternal(UWorld *World, ELevelTick TickType, float DeltaSeconds)
+void ASensor::BeginPostPhysTickInternal(UWorld *World, float DeltaSeconds)
+{
+  if(ReadyToTick)
+  {
+    BeginPostPhysTick(World, DeltaSeconds);
+  }
+}
+
+bool ASensor::PostPhysTickInternal(UWorld *World, ELevelTick TickType, float DeltaSeconds)
 {
   TRACE_CPUPROFILER_EVENT_SCOPE(ASensor::PostPhysTickInternal);
   if(ReadyToTick)
   {
     PostPhysTick(World, TickType, DeltaSeconds);
     ReadyToTick = false;
+    return true;
   }
+  return false;
 }
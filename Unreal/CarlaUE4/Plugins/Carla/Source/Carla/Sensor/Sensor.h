@@ -67,13 +67,44 @@ public:
 
   virtual void PrePhysTick(float DeltaSeconds) {}
   virtual void PostPhysTick(UWorld *World, ELevelTick TickType, float DeltaSeconds) {}
+
+  /// Called on every sensor that ticks this frame before any of them runs
+  /// PostPhysTick. Work started here runs while the other sensors tick.
+  virtual void BeginPostPhysTick(UWorld *World, float DeltaSeconds) {}
   // Small interface to notify sensors when clients are listening
   virtual void OnFirstClientConnected() {};
   // Small interface to notify sensors when no clients are listening
   virtual void OnLastClientDisconnected() {};
 
 
-  void PostPhysTickInternal(UWorld *World, ELevelTick TickType, float DeltaSeconds);
+  void BeginPostPhysTickInternal(UWorld *World, float DeltaSeconds);
+
+  /// Returns whether the sensor ticked.
+  bool PostPhysTickInternal(UWorld *World, ELevelTick TickType, float DeltaSeconds);
+
+  /// The sensor ticks once every this many frames.
+  uint32 GetTickDivisor() const
+  {
+    return TickDivisor;
+  }
+
+  /// Frames the ticks of the sensor are shifted by, chosen by FSensorManager.
+  uint32 GetTickPhase() const
+  {
+    return TickPhase;
+  }
+
+  bool ShouldTickOnFrame(uint64 Frame) const
+  {
+    return (Frame + TickPhase) % TickDivisor == 0u;
+  }
+
+  /// Rough cost of a tick in milliseconds, used to schedule the sensor until
+  /// its cost has been measured.
+  virtual double GetEstimatedTickCost() const
+  {
+    return 0.1;
+  }
 
   UFUNCTION(BlueprintCallable)
   URandomEngine *GetRandomEngine()
@@ -125,6 +156,8 @@ protected:
 
 private:
 
+  friend class FSensorManager;
+
   FDataStream Stream;
 
   FDelegateHandle OnPostTickDelegate;
@@ -138,4 +171,8 @@ private:
 
   bool bClientsListening = false;
 
+  uint32 TickDivisor = 1u;
+
+  uint32 TickPhase = 0u;
+
 };
@@ -67,6 +67,11 @@ private:
   AppendDefinitions(TArray<FActorDefinition> &Definitions)
   {
     auto Def = SensorType::GetSensorDefinition();
+    // Sensors that are disabled in this server return an empty definition.
+    if (Def.Id.IsEmpty())
+    {
+      return;
+    }
     // Make sure the class matches the sensor type.
     Def.Class = SensorType::StaticClass();
     Definitions.Emplace(Def);
@@ -138,6 +143,13 @@ FActorSpawnResult ASensorFactory::SpawnActor(
     Sensor->SetEpisode(*Episode);
     Sensor->Set(Description);
     Sensor->SetDataStream(GameInstance->GetServer().OpenStream());
+    // The multipart GBuffer stream only costs a GBuffer capture while a client
+    // has requested textures through "get_gbuffer_multipart_token".
+    ASceneCaptureSensor *GBufferSensor = Cast<ASceneCaptureSensor>(Sensor);
+    if (GBufferSensor != nullptr)
+    {
+      GBufferSensor->CameraGBuffers.Multipart.SetDataStream(GameInstance->GetServer().OpenStream());
+    }
     // ASceneCaptureSensor * SceneCaptureSensor = Cast<ASceneCaptureSensor>(Sensor);
     // if(SceneCaptureSensor)
     // {
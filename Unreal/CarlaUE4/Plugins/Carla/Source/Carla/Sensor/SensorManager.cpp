@@ -7,20 +7,155 @@
 #include "SensorManager.h"
 #include "Sensor.h"
 
+#include "Carla/Game/CarlaEngine.h"
+
+namespace SensorManager_local_ns {
+
+  /// Frames looked ahead when choosing a phase, enough for the common divisors.
+  constexpr uint32 MaxHorizon = 720u;
+
+  /// Weight of the last measure in the average cost.
+  constexpr double CostSmoothing = 0.1;
+
+} // namespace SensorManager_local_ns
+
 void FSensorManager::RegisterSensor(ASensor* Sensor)
 {
+  Sensor->TickPhase = ChoosePhase(Sensor->TickDivisor, GetTickCost(Sensor), Sensor);
   SensorList.Emplace(Sensor);
 }
 
 void FSensorManager::DeRegisterSensor(ASensor* Sensor)
 {
   SensorList.Remove(Sensor);
+  AverageCost.Remove(Sensor);
 }
 
 void FSensorManager::PostPhysTick(UWorld *World, ELevelTick TickType, float DeltaSeconds)
 {
+  using namespace SensorManager_local_ns;
+  Kinematics.Reset(World);
   for(ASensor* Sensor : SensorList)
   {
-    Sensor->PostPhysTickInternal(World, TickType, DeltaSeconds);
+    Sensor->BeginPostPhysTickInternal(World, DeltaSeconds);
+  }
+  for(ASensor* Sensor : SensorList)
+  {
+    const double Start = FPlatformTime::Seconds();
+    if (Sensor->PostPhysTickInternal(World, TickType, DeltaSeconds))
+    {
+      const double Cost = 1e3 * (FPlatformTime::Seconds() - Start);
+      double *Average = AverageCost.Find(Sensor);
+      if (Average == nullptr)
+      {
+        AverageCost.Add(Sensor, Cost);
+      }
+      else
+      {
+        *Average += CostSmoothing * (Cost - *Average);
+      }
+    }
+  }
+}
+
+void FSensorManager::SetTickDivisor(ASensor* Sensor, uint32 Divisor)
+{
+  Sensor->TickDivisor = FMath::Max(Divisor, 1u);
+  Sensor->TickPhase = ChoosePhase(Sensor->TickDivisor, GetTickCost(Sensor), Sensor);
+}
+
+TArray<double> FSensorManager::GetProjectedFrameCost(uint32 NumFrames) const
+{
+  TArray<double> Result;
+  Result.SetNumZeroed(NumFrames);
+  const uint64 Frame = FCarlaEngine::GetFrameCounter();
+  for (const ASensor* Sensor : SensorList)
+  {
+    const double Cost = GetTickCost(Sensor);
+    for (uint32 i = 0u; i < NumFrames; ++i)
+    {
+      if (Sensor->ShouldTickOnFrame(Frame + i))
+      {
+        Result[i] += Cost;
+      }
+    }
+  }
+  return Result;
+}
+
+double FSensorManager::GetTickCost(const ASensor* Sensor) const
+{
+  const double *Average = AverageCost.Find(Sensor);
+  return Average != nullptr ? *Average : Sensor->GetEstimatedTickCost();
+}
+
+uint32 FSensorManager::ChoosePhase(uint32 Divisor, double Cost, const ASensor* Ignore) const
+{
+  using namespace SensorManager_local_ns;
+  if (Divisor <= 1u)
+  {
+    return 0u;
+  }
+
+  // Look ahead a common multiple of the divisors in use, so every phase sees
+  // the same pattern of the other sensors.
+  uint32 Horizon = Divisor;
+  for (const ASensor* Sensor : SensorList)
+  {
+    const uint32 Other = Sensor->TickDivisor;
+    uint32 A = Horizon, B = Other;
+    while (B != 0u)
+    {
+      const uint32 T = A % B;
+      A = B;
+      B = T;
+    }
+    const uint64 Lcm = static_cast<uint64>(Horizon) / A * Other;
+    Horizon = static_cast<uint32>(FMath::Min<uint64>(Lcm, FMath::Max(MaxHorizon, Divisor)));
+  }
+
+  TArray<double> Load;
+  Load.SetNumZeroed(Horizon);
+  const uint64 Frame = FCarlaEngine::GetFrameCounter();
+  for (const ASensor* Sensor : SensorList)
+  {
+    if (Sensor == Ignore)
+    {
+      continue;
+    }
+    const double SensorCost = GetTickCost(Sensor);
+    for (uint32 i = 0u; i < Horizon; ++i)
+    {
+      if (Sensor->ShouldTickOnFrame(Frame + i))
+      {
+        Load[i] += SensorCost;
+      }
+    }
+  }
+
+  // Minimize the worst frame, then the total, then prefer the lowest phase so
+  // the result is deterministic.
+  uint32 BestPhase = 0u;
+  double BestPeak = TNumericLimits<double>::Max();
+  double BestTotal = TNumericLimits<double>::Max();
+  for (uint32 Phase = 0u; Phase < Divisor; ++Phase)
+  {
+    double Peak = 0.0;
+    double Total = 0.0;
+    for (uint32 i = 0u; i < Horizon; ++i)
+    {
+      if ((Frame + i + Phase) % Divisor == 0u)
+      {
+        Peak = FMath::Max(Peak, Load[i] + Cost);
+        Total += Load[i];
+      }
+    }
+    if (Peak < BestPeak || (Peak == BestPeak && Total < BestTotal))
+    {
+      BestPhase = Phase;
+      BestPeak = Peak;
+      BestTotal = Total;
+    }
   }
+  return BestPhase;
 }
@@ -6,8 +6,15 @@
 
 #pragma once
 
+#include "Carla/Sensor/KinematicsSnapshot.h"
+
 class ASensor;
 
+/// Ticks the registered sensors after the physics step.
+///
+/// Sensors with a tick divisor N run once every N frames. Each one gets a phase
+/// offset when registered, chosen so that the sensors running at the same rate
+/// do not all fire on the same frame. This spreads their cost evenly.
 class FSensorManager
 {
 
@@ -19,8 +26,35 @@ public:
 
   void PostPhysTick(UWorld *World, ELevelTick TickType, float DeltaSeconds);
 
+  /// Make @a Sensor tick once every @a Divisor frames and choose a new phase
+  /// for it.
+  void SetTickDivisor(ASensor* Sensor, uint32 Divisor);
+
+  /// Projected game-thread cost, in milliseconds, of the sensors on each of
+  /// the next @a NumFrames frames. It uses the measured average cost of each
+  /// sensor, or its estimate if it has not ticked yet.
+  TArray<double> GetProjectedFrameCost(uint32 NumFrames) const;
+
+  /// Kinematic state of this frame, shared by the IMU and GNSS sensors.
+  FKinematicsSnapshot &GetKinematicsSnapshot()
+  {
+    return Kinematics;
+  }
+
 private:
 
+  /// Average or estimated cost of a tick of @a Sensor in milliseconds.
+  double GetTickCost(const ASensor* Sensor) const;
+
+  /// Phase for a sensor with @a Divisor and @a Cost that minimizes the
+  /// highest projected cost of the frames it ticks in.
+  uint32 ChoosePhase(uint32 Divisor, double Cost, const ASensor* Ignore) const;
+
   TArray<ASensor*> SensorList;
 
+  /// Exponential moving average of the cost of PostPhysTick, per sensor.
+  TMap<const ASensor*, double> AverageCost;
+
+  FKinematicsSnapshot Kinematics;
+
 };
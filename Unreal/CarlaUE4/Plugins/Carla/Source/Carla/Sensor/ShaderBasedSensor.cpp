@@ -7,10 +7,104 @@
 #include "Carla.h"
 #include "Carla/Sensor/ShaderBasedSensor.h"
 
+#include "Carla/Game/CarlaEngine.h"
+#include "Carla/Game/CarlaEpisode.h"
+#include "Carla/Game/TaggedComponent.h"
+#include "Carla/Game/Tagger.h"
+
 #include "ConstructorHelpers.h"
+#include "EngineUtils.h"
 #include "Materials/MaterialInstanceDynamic.h"
 #include "Components/SceneCaptureComponent2D.h"
 #include "Actor/ActorBlueprintFunctionLibrary.h"
+#include "ShaderPipelineCache.h"
+
+#include <limits>
+
+// =============================================================================
+// -- Local static functions ---------------------------------------------------
+// =============================================================================
+
+namespace ShaderBasedSensor_local_ns {
+
+  /// Primitive components of the world grouped by semantic tag. Built at most
+  /// once per frame and shared by all the sensors using a show-only list.
+  struct FTaggedPrimitives
+  {
+    uint64 Frame = std::numeric_limits<uint64>::max();
+    const UWorld *World = nullptr;
+    TArray<UPrimitiveComponent *> Meshes[256];
+    TArray<UPrimitiveComponent *> TaggedComponents[256];
+  };
+
+  static const FTaggedPrimitives &GetTaggedPrimitives(UWorld &World)
+  {
+    static FTaggedPrimitives Index;
+    const uint64 Frame = FCarlaEngine::GetFrameCounter();
+    if (Index.Frame == Frame && Index.World == &World)
+    {
+      return Index;
+    }
+    TRACE_CPUPROFILER_EVENT_SCOPE(ShaderBasedSensor::GetTaggedPrimitives);
+    Index.Frame = Frame;
+    Index.World = &World;
+    for (int32 Tag = 0; Tag < 256; ++Tag)
+    {
+      Index.Meshes[Tag].Reset();
+      Index.TaggedComponents[Tag].Reset();
+    }
+    for (AActor *Actor : TActorRange<AActor>(&World))
+    {
+      TInlineComponentArray<UPrimitiveComponent *> Components(Actor);
+      for (UPrimitiveComponent *Component : Components)
+      {
+        if (!Component->IsRegistered())
+        {
+          continue;
+        }
+        // The overlays used by instance segmentation carry the tag of the
+        // mesh they are attached to.
+        if (Cast<UTaggedComponent>(Component) != nullptr)
+        {
+          const auto *Parent = Cast<UPrimitiveComponent>(Component->GetAttachParent());
+          if (Parent != nullptr)
+          {
+            Index.TaggedComponents[Parent->CustomDepthStencilValue].Add(Component);
+          }
+        }
+        else
+        {
+          Index.Meshes[Component->CustomDepthStencilValue].Add(Component);
+        }
+      }
+    }
+    return Index;
+  }
+
+  static bool ParseSemanticTag(const FString &String, uint8 &Tag)
+  {
+    if (String.IsNumeric())
+    {
+      const int32 Value = FCString::Atoi(*String);
+      Tag = static_cast<uint8>(Value);
+      return Value >= 0 && Value < 256;
+    }
+    for (int32 Value = 0; Value < 256; ++Value)
+    {
+      if (ATagger::GetTagAsString(static_cast<crp::CityObjectLabel>(Value)).Equals(String, ESearchCase::IgnoreCase))
+      {
+        Tag = static_cast<uint8>(Value);
+        return true;
+      }
+    }
+    return false;
+  }
+
+} // namespace ShaderBasedSensor_local_ns
+
+// =============================================================================
+// -- AShaderBasedSensor -------------------------------------------------------
+// =============================================================================
 
 bool AShaderBasedSensor::AddPostProcessingMaterial(const FString &Path)
 {
@@ -43,12 +137,121 @@ void AShaderBasedSensor::SetUpSceneCaptureComponent(USceneCaptureComponent2D &Sc
         ParameterValue.ParameterName,
         ParameterValue.Value);
   }
+
+  // Skip everything but the requested tags, the list is filled every tick.
+  if (HasShowOnlyTags())
+  {
+    SceneCapture.PrimitiveRenderMode = ESceneCapturePrimitiveRenderMode::PRM_UseShowOnlyList;
+  }
 }
 
 void AShaderBasedSensor::Set(const FActorDescription &Description)
 {
   Super::Set(Description);
   UActorBlueprintFunctionLibrary::SetCamera(Description, this);
+
+  ShowOnlyTags.Reset();
+  const FString Tags = UActorBlueprintFunctionLibrary::RetrieveActorAttributeToString(
+      "semantic_tags",
+      Description.Variations,
+      TEXT(""));
+  TArray<FString> Names;
+  Tags.ParseIntoArray(Names, TEXT(","), true);
+  for (const FString &Name : Names)
+  {
+    uint8 Tag;
+    if (ShaderBasedSensor_local_ns::ParseSemanticTag(Name.TrimStartAndEnd(), Tag))
+    {
+      ShowOnlyTags.AddUnique(Tag);
+    }
+    else
+    {
+      UE_LOG(LogCarla, Warning, TEXT("%s: unknown semantic tag \"%s\""), *GetName(), *Name);
+    }
+  }
+}
+
+void AShaderBasedSensor::PrewarmShaders(UCarlaEpisode &Episode, const TArray<FString> &SensorIds)
+{
+  TRACE_CPUPROFILER_EVENT_SCOPE(AShaderBasedSensor::PrewarmShaders);
+  const double StartTime = FPlatformTime::Seconds();
+  const bool bAll = SensorIds.Contains(TEXT("all"));
+
+  // Copy the definitions, spawning goes through the same dispatcher.
+  const TArray<FActorDefinition> Definitions = Episode.GetActorDefinitions();
+  TArray<AActor *> Sensors;
+  for (const FActorDefinition &Definition : Definitions)
+  {
+    if ((Definition.Class == nullptr) ||
+        !Definition.Class->IsChildOf(AShaderBasedSensor::StaticClass()) ||
+        !(bAll || SensorIds.Contains(Definition.Id)))
+    {
+      continue;
+    }
+    // Spawned with the default attributes; the materials and the render
+    // target format do not depend on them.
+    FActorDescription Description;
+    Description.UId = Definition.UId;
+    Description.Id = Definition.Id;
+    Description.Class = Definition.Class;
+    const auto Result = Episode.SpawnActorWithInfo(FTransform(), std::move(Description));
+    auto *Sensor = (Result.Value != nullptr) ? Cast<AShaderBasedSensor>(Result.Value->GetActor()) : nullptr;
+    if ((Result.Key != EActorSpawnResultStatus::Success) || (Sensor == nullptr))
+    {
+      UE_LOG(LogCarla, Warning, TEXT("Unable to pre-warm the shaders of '%s'"), *Definition.Id);
+      continue;
+    }
+    Sensor->EnqueueRenderSceneImmediate();
+    Sensors.Add(Sensor);
+  }
+
+  // Wait for the captures, this is where the shaders and pipeline states are
+  // compiled.
+  FlushRenderingCommands();
+  for (AActor *Sensor : Sensors)
+  {
+    Episode.DestroyActor(Sensor);
+  }
+  // Keep the pipeline states for the next runs when the project has the
+  // shader pipeline cache enabled, no-op otherwise.
+  FShaderPipelineCache::SavePipelineFileCache(FPipelineFileCache::SaveMode::Incremental);
+
+  UE_LOG(LogCarla, Log, TEXT("Pre-warmed the shaders of %d sensors in %.2f s"),
+      Sensors.Num(), FPlatformTime::Seconds() - StartTime);
+}
+
+void AShaderBasedSensor::AddShowOnlyTagsVariation(FActorDefinition &Definition)
+{
+  FActorVariation SemanticTags;
+  SemanticTags.Id = TEXT("semantic_tags");
+  SemanticTags.Type = EActorAttributeType::String;
+  SemanticTags.RecommendedValues = { TEXT("") };
+  SemanticTags.bRestrictToRecommended = false;
+  Definition.Variations.Emplace(SemanticTags);
+}
+
+void AShaderBasedSensor::PrePhysTick(float DeltaSeconds)
+{
+  Super::PrePhysTick(DeltaSeconds);
+  if (HasShowOnlyTags())
+  {
+    UpdateShowOnlyComponents(*GetCaptureComponent2D());
+  }
+}
+
+void AShaderBasedSensor::UpdateShowOnlyComponents(USceneCaptureComponent2D &SceneCapture)
+{
+  TRACE_CPUPROFILER_EVENT_SCOPE(AShaderBasedSensor::UpdateShowOnlyComponents);
+  const auto &Index = ShaderBasedSensor_local_ns::GetTaggedPrimitives(*GetWorld());
+  SceneCapture.ShowOnlyComponents.Reset();
+  for (const uint8 Tag : ShowOnlyTags)
+  {
+    const auto &Components = bShowOnlyTaggedComponents ? Index.TaggedComponents[Tag] : Index.Meshes[Tag];
+    for (UPrimitiveComponent *Component : Components)
+    {
+      SceneCapture.ShowOnlyComponents.Emplace(Component);
+    }
+  }
 }
 
 void AShaderBasedSensor::SetFloatShaderParameter(
@@ -6,10 +6,13 @@
 
 #pragma once
 
+#include "Carla/Actor/ActorDefinition.h"
 #include "Carla/Sensor/SceneCaptureSensor.h"
 
 #include "ShaderBasedSensor.generated.h"
 
+class UCarlaEpisode;
+
 /// A shader parameter value to change when the material
 /// instance is available.
 USTRUCT(BlueprintType)
@@ -76,12 +79,39 @@ public:
 
   void SetFloatShaderParameter(uint8_t ShaderIndex, const FName &ParameterName, float Value);
 
+  /// Spawn once every shader-based sensor of @a Episode whose blueprint id is
+  /// in @a SensorIds ("all" for every one), capture a frame and destroy it,
+  /// so that the first sensor spawned by a client does not stall compiling
+  /// its post-process materials and pipeline states.
+  static void PrewarmShaders(UCarlaEpisode &Episode, const TArray<FString> &SensorIds);
+
+  /// Add the "semantic_tags" attribute to @a Definition. It takes a comma
+  /// separated list of semantic tags, by number or by name; when set, only
+  /// the components with one of these tags are rendered.
+  static void AddShowOnlyTagsVariation(FActorDefinition &Definition);
+
 protected:
 
   void SetUpSceneCaptureComponent(USceneCaptureComponent2D &SceneCapture) override;
 
+  void PrePhysTick(float DeltaSeconds) override;
+
+  bool HasShowOnlyTags() const
+  {
+    return ShowOnlyTags.Num() > 0;
+  }
+
+  /// Whether the show-only list holds the UTaggedComponent overlays attached
+  /// to the tagged meshes instead of the meshes themselves.
+  bool bShowOnlyTaggedComponents = false;
+
 private:
 
+  /// Restrict the capture to the components tagged with ShowOnlyTags.
+  void UpdateShowOnlyComponents(USceneCaptureComponent2D &SceneCapture);
+
+  TArray<uint8> ShowOnlyTags;
+
   UPROPERTY()
   TArray<UMaterial*> MaterialsFound;
 
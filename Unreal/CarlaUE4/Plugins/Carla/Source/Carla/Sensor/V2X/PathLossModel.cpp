@@ -11,6 +11,7 @@
 #include "Math/UnrealMathUtility.h"
 
 #include "PathLossModel.h"
+#include "V2XMedium.h"
 #include <random>
 #include <limits>
 
@@ -63,7 +64,7 @@ std::map<AActor *, float> PathLossModel::GetReceiveActorPowerList()
     return mReceiveActorPowerList;
 }
 
-void PathLossModel::Simulate(const std::vector<ActorPowerPair> ActorList, UCarlaEpisode *CarlaEpisode, UWorld *World)
+void PathLossModel::Simulate(const std::vector<ActorPowerPair> ActorList, const V2XMedium &Medium, UCarlaEpisode *CarlaEpisode, UWorld *World)
 {
     // 设置当前世界和事件
     mWorld = World;
@@ -88,6 +89,12 @@ void PathLossModel::Simulate(const std::vector<ActorPowerPair> ActorList, UCarla
         {
             continue;
         }
+        // 不在共享信道中的发送者超出了通信范围
+        const FV2XPath *Path = Medium.FindPath(mActorOwner, actor_power_pair.first);
+        if (Path == nullptr)
+        {
+            continue;
+        }
         OtherActorLocation = actor_power_pair.first->GetTransform().GetLocation();
         double rx_height_local = (actor_power_pair.first->GetSimpleCollisionHalfHeight() * 2.0) + 2.0;
 
@@ -112,7 +119,7 @@ void PathLossModel::Simulate(const std::vector<ActorPowerPair> ActorList, UCarla
         if (Distance3d < filter_distance) // maybe change this for highway
         {
             float OtherTransmitPower = actor_power_pair.second;
-            ReceivedPower = CalculateReceivedPower(actor_power_pair.first,
+            ReceivedPower = CalculateReceivedPower(*Path,
                                                    OtherTransmitPower,
                                                    CurrentActorLocation,
                                                    OtherActorLocation,
@@ -120,8 +127,7 @@ void PathLossModel::Simulate(const std::vector<ActorPowerPair> ActorList, UCarla
                                                    ht,
                                                    tx_height_local,
                                                    hr,
-                                                   rx_height_local,
-                                                   ref0);
+                                                   rx_height_local);
             if (ReceivedPower > -1.0 * std::numeric_limits<float>::max())
             {
                 mReceiveActorPowerList.insert(std::make_pair(actor_power_pair.first, ReceivedPower));
@@ -130,7 +136,7 @@ void PathLossModel::Simulate(const std::vector<ActorPowerPair> ActorList, UCarla
     }
 }
 
-float PathLossModel::CalculateReceivedPower(AActor *OtherActor,
+float PathLossModel::CalculateReceivedPower(const FV2XPath &Path,
                                             const float OtherTransmitPower,
                                             const FVector Source,
                                             const FVector Destination,
@@ -138,30 +144,20 @@ float PathLossModel::CalculateReceivedPower(AActor *OtherActor,
                                             const double ht,
                                             const double ht_local,
                                             const double hr,
-                                            const double hr_local,
-                                            const double reference_z)
+                                            const double hr_local)
 {
     // hr in m
     // ht in m
-    // reference_z in cm
     // distance3d in m
     bool ret = false;
-    FCollisionObjectQueryParams ObjectParams;
-    // Channels to check for collision with different object types
-    ObjectParams.AddObjectTypesToQuery(ECollisionChannel::ECC_WorldStatic);
-    ObjectParams.AddObjectTypesToQuery(ECollisionChannel::ECC_PhysicsBody);
-    ObjectParams.AddObjectTypesToQuery(ECollisionChannel::ECC_Vehicle);
-    ObjectParams.AddObjectTypesToQuery(ECollisionChannel::ECC_WorldDynamic);
-    HitResult.Reset();
 
     FVector tx = Source;
     tx.Z += ht_local;
     FVector rx = Destination;
     rx.Z += hr_local;
-    mWorld->LineTraceMultiByObjectType(HitResult, tx, rx, ObjectParams);
 
     // all losses
-    float loss = ComputeLoss(OtherActor, Source, Destination, Distance3d, ht, hr, reference_z);
+    float loss = ComputeLoss(Path, Source, Destination, Distance3d, ht, hr);
 
     // we incorporate the tx power of the sender (the other actor), not our own
     // NOTE: combined antenna gain is parametrized for each sensor. Better solution would be to parametrize individual antenna gain
@@ -223,61 +219,6 @@ float PathLossModel::CalculateReceivedPower(AActor *OtherActor,
     }
 }
 
-void PathLossModel::EstimatePathStateAndVehicleObstacles(AActor *OtherActor,
-                                                         FVector CurrentActorLocation,
-                                                         double TxHeight,
-                                                         double RxHeight,
-                                                         double reference_z,
-                                                         EPathState &state,
-                                                         std::vector<FVector> &vehicle_obstacles)
-{
-    // CurrentActorLocation in cm original
-    // TxHeight in m
-    // RxHeight in m
-    // reference_z in cm
-
-    // init with LOS
-    state = EPathState::LOS;
-    if (HitResult.Num() == 0)
-    {
-        // no hits --> LOS
-        return;
-    }
-
-    // check all hits
-    for (const FHitResult &HitInfo : HitResult)
-    {
-
-        FVector location;
-        if (HitIsSelfOrOther(HitInfo, OtherActor))
-        {
-            // the current hit is either Tx or Rx, so we can skip it, no obstacle
-            continue;
-        }
-
-        // cal by ref
-        if (GetLocationIfVehicle(CurrentActorLocation, HitInfo, reference_z, location))
-        {
-            // we found a vehicle
-            // Note: we may set this several times if we have several vehicles in between
-            state = EPathState::NLOSv;
-            // z (height) is gonna be in m in relation to reference height
-            // x,y also in meters
-            //  call by reference
-            vehicle_obstacles.emplace_back(location);
-
-            // alternative (cf Etsi): statistical model
-            //  vehicle_blockage_loss += MakeVehicleBlockageLoss(TxHeight, RxHeight, obj_height, obj_dist);
-        }
-        // but if we hit a building, we stop and switch to NLOSb
-        else
-        {
-            state = EPathState::NLOSb;
-            break;
-        }
-    }
-}
-
 double PathLossModel::CalcVehicleLoss(const double d1, const double d2, const double h)
 {
     double V = h * sqrt(2.0 * (d1 + d2) / (lambda * d1 * d2));
@@ -293,7 +234,7 @@ double PathLossModel::CalculateNLOSvLoss(const FVector Source,
                                          const double TxHeight,
                                          const double RxHeight,
                                          const double RxDistance3d,
-                                         std::vector<FVector> &vehicle_obstacles)
+                                         const std::vector<FVector> &vehicle_obstacles)
 {
 
     // convert all positions to meters
@@ -327,22 +268,18 @@ void PathLossModel::SetPathLossModel(const EPathLossModel path_loss_model)
     model = path_loss_model;
 }
 
-float PathLossModel::ComputeLoss(AActor *OtherActor, FVector Source, FVector Destination, double Distance3d, double TxHeight, double RxHeight, double reference_z)
+float PathLossModel::ComputeLoss(const FV2XPath &Path, FVector Source, FVector Destination, double Distance3d, double TxHeight, double RxHeight)
 {
     // TxHeight in m
     // RxHeight in m
-    // reference_z in cm
     // distance3d in m
-    EPathState state;
+    // path state and vehicle obstacles come from the shared medium
+    const EPathState state = Path.State;
+    const std::vector<FVector> &vehicle_obstacles = Path.VehicleObstacles;
 
     float PathLoss = 0.0;
-    double VehicleBlockageLoss = 0.0;
     float ShadowFadingLoss = 0.0;
 
-    // state and vehicle obstacles are call-by-reference
-    std::vector<FVector> vehicle_obstacles;
-    EstimatePathStateAndVehicleObstacles(OtherActor, Source, TxHeight, RxHeight, reference_z, state, vehicle_obstacles);
-
     if (model == EPathLossModel::Winner)
     {
         // calculate pure path loss depending on state and scenario
@@ -380,74 +317,6 @@ float PathLossModel::ComputeLoss(AActor *OtherActor, FVector Source, FVector Des
     return PathLoss + ShadowFadingLoss;
 }
 
-bool PathLossModel::IsVehicle(const FHitResult &HitInfo)
-{
-    bool Vehicle = false;
-    const FActorRegistry &Registry = mCarlaEpisode->GetActorRegistry();
-
-    const AActor *actor = HitInfo.Actor.Get();
-
-    if (actor != nullptr)
-    {
-
-        const FCarlaActor *view = Registry.FindCarlaActor(actor);
-        if (view)
-        {
-            if (view->GetActorType() == FCarlaActor::ActorType::Vehicle)
-            {
-                Vehicle = true;
-            }
-        }
-    }
-    return Vehicle;
-}
-
-bool PathLossModel::HitIsSelfOrOther(const FHitResult &HitInfo, AActor *OtherActor)
-{
-    const AActor *actor = HitInfo.Actor.Get();
-    if (actor != nullptr)
-    {
-        if (actor == mActorOwner)
-        {
-            return true;
-        }
-        else if (actor == OtherActor)
-        {
-            return true;
-        }
-    }
-    return false;
-}
-
-bool PathLossModel::GetLocationIfVehicle(const FVector CurrentActorLocation, const FHitResult &HitInfo, const double reference_z, FVector &location)
-{
-    // reference_z in cm
-    bool Vehicle = false;
-    const FActorRegistry &Registry = mCarlaEpisode->GetActorRegistry();
-
-    const AActor *actor = HitInfo.Actor.Get();
-
-    if (actor != nullptr)
-    {
-
-        const FCarlaActor *view = Registry.FindCarlaActor(actor);
-        if (view)
-        {
-            if (view->GetActorType() == FCarlaActor::ActorType::Vehicle)
-            {
-                Vehicle = true;
-                location = actor->GetTransform().GetLocation();
-                location.Z = location.Z - reference_z + (actor->GetSimpleCollisionHalfHeight() * 2.0) + 2.0;
-                location.Z = location.Z / 100.0f;
-                // cm to m
-                location.X /= 100.0f;
-                location.Y /= 100.0f;
-            }
-        }
-    }
-    return Vehicle;
-}
-
 void PathLossModel::CalculateFSPL_d0()
 {
     m_fspl_d0 = 20.0 * log10(reference_distance_fspl) + 20.0 * log10(Frequency) + 20.0 * log10(4.0 * PI / c_speedoflight);
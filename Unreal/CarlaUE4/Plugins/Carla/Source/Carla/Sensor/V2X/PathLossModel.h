@@ -11,6 +11,9 @@
 #include <vector>
 
 
+class V2XMedium;
+struct FV2XPath;
+
 using ActorPowerMap = std::map<AActor *, float>;
 using ActorPowerPair = std::pair<AActor *, float>;
 
@@ -40,7 +43,8 @@ public:
     PathLossModel(URandomEngine *random_engine);
     void SetOwner(AActor *Owner);
     void SetScenario(EScenario scenario);
-    void Simulate(const std::vector<ActorPowerPair> ActorList, UCarlaEpisode *CarlaEpisode, UWorld *World);
+    // 遮挡路径取自本周期的共享信道 Medium，不在通信范围内的发送者会被跳过
+    void Simulate(const std::vector<ActorPowerPair> ActorList, const V2XMedium &Medium, UCarlaEpisode *CarlaEpisode, UWorld *World);
     ActorPowerMap GetReceiveActorPowerList();
     void SetParams(const float TransmitPower,
                    const float ReceiverSensitivity,
@@ -52,13 +56,14 @@ public:
                    const bool use_etsi_fading,
                    const float custom_fading_stddev);
     float GetTransmitPower() { return TransmitPower; }
+    float GetFilterDistance() const { return filter_distance; }
     void SetPathLossModel(const EPathLossModel path_loss_model);
 
 private:
     // 非视距(NLOSv,non-line-of-sight) 衍射
     double CalcVehicleLoss(const double d1, const double d2, const double h);
     // 计算接收功率
-    float CalculateReceivedPower(AActor *OtherActor,
+    float CalculateReceivedPower(const FV2XPath &Path,
                                  const float OtherTransmitPower,
                                  const FVector Source,
                                  const FVector Destination,
@@ -66,9 +71,7 @@ private:
                                  const double ht,
                                  const double ht_local,
                                  const double hr,
-                                 const double hr_local,
-                                 const double reference_z);
-    void EstimatePathStateAndVehicleObstacles(AActor *OtherActor, FVector Source, double TxHeight, double RxHeight, double reference_z, EPathState &state, std::vector<FVector> &vehicle_obstacles);
+                                 const double hr_local);
     double MakeVehicleBlockageLoss(double TxHeight, double RxHeight, double obj_height, double obj_distance);
     // 变量
     AActor *mActorOwner;
@@ -106,12 +109,9 @@ private:
 protected:
     /// 如果要追踪光线，则允许预处理的方法。
 
-    float ComputeLoss(AActor *OtherActor, FVector Source, FVector Destination, double Distance3d, double TxHeight, double RxHeight, double reference_z);
-    bool IsVehicle(const FHitResult &HitInfo);
-    bool GetLocationIfVehicle(const FVector CurrentActorLocation, const FHitResult &HitInfo, const double reference_z, FVector &location);
-    bool HitIsSelfOrOther(const FHitResult &HitInfo, AActor *OtherActor);
+    float ComputeLoss(const FV2XPath &Path, FVector Source, FVector Destination, double Distance3d, double TxHeight, double RxHeight);
     float CalculatePathLoss_WINNER(EPathState state, double Distance);
-    double CalculateNLOSvLoss(const FVector Source, const FVector Destination, const double TxHeight, const double RxHeight, const double RxDistance3d, std::vector<FVector> &vehicle_obstacles);
+    double CalculateNLOSvLoss(const FVector Source, const FVector Destination, const double TxHeight, const double RxHeight, const double RxDistance3d, const std::vector<FVector> &vehicle_obstacles);
 
     float CalculateShadowFading(EPathState state);
 
@@ -122,5 +122,4 @@ protected:
 
     // 预计算功能
     void CalculateFSPL_d0();
-    TArray<FHitResult> HitResult;
 };
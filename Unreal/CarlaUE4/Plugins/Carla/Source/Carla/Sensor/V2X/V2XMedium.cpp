@@ -0,0 +1,220 @@
+// Copyright (c) 2024 Institut fuer Technik der Informationsverarbeitung (ITIV) at the
+// Karlsruhe Institute of Technology
+//
+// V2X 共享信道
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include <PxScene.h>
+#include "Carla.h"
+#include "Carla/Game/CarlaEpisode.h"
+
+#include "V2XMedium.h"
+
+#include "Runtime/Core/Public/Async/ParallelFor.h"
+
+#include <algorithm>
+#include <limits>
+
+void V2XMedium::BeginFrame(uint64_t Frame)
+{
+    if (Frame == mFrame && !mReceivers.empty())
+    {
+        return;
+    }
+    mFrame = Frame;
+    bUpdated = false;
+    mReceivers.clear();
+    mPaths.clear();
+    mPathIndex.clear();
+    mLinks.clear();
+}
+
+void V2XMedium::AddReceiver(AActor *Receiver, float Range)
+{
+    mReceivers.emplace_back(Receiver, Range);
+}
+
+FVector V2XMedium::GetAntennaLocation(const AActor *Actor)
+{
+    FVector Location = Actor->GetTransform().GetLocation();
+    Location.Z += (Actor->GetSimpleCollisionHalfHeight() * 2.0f) + 2.0f;
+    return Location;
+}
+
+const std::vector<FV2XLink> &V2XMedium::GetLinks(AActor *Receiver) const
+{
+    static const std::vector<FV2XLink> NoLinks;
+    auto it = mLinks.find(Receiver);
+    return it != mLinks.end() ? it->second : NoLinks;
+}
+
+const FV2XPath *V2XMedium::FindPath(AActor *A, AActor *B) const
+{
+    auto it = mPathIndex.find(MakePair(A, B));
+    return it != mPathIndex.end() ? &mPaths[it->second] : nullptr;
+}
+
+void V2XMedium::Update(UWorld *World, UCarlaEpisode *Episode, const std::vector<AActor *> &Senders)
+{
+    TRACE_CPUPROFILER_EVENT_SCOPE(V2XMedium::Update);
+    bUpdated = true;
+    if (mReceivers.empty() || Senders.empty())
+    {
+        return;
+    }
+
+    // 网格的边长取最大通信距离（厘米），每个接收者只需要检查相邻的 3x3 个网格
+    float MaxRange = 0.0f;
+    for (const auto &Receiver : mReceivers)
+    {
+        MaxRange = std::max(MaxRange, Receiver.second);
+    }
+    const double CellSize = std::max(100.0 * MaxRange, 100.0);
+    auto MakeCellKey = [](int64 X, int64 Y) {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(X)) << 32) | static_cast<uint32_t>(Y);
+    };
+
+    // 第 1 步：把仍然存活的发送者放入网格
+    const FActorRegistry &Registry = Episode->GetActorRegistry();
+    std::vector<AActor *> LiveSenders;
+    std::vector<FVector> SenderLocations;
+    LiveSenders.reserve(Senders.size());
+    SenderLocations.reserve(Senders.size());
+    std::unordered_map<uint64_t, std::vector<size_t>> Grid;
+    for (AActor *Sender : Senders)
+    {
+        if (Registry.FindCarlaActor(Sender) == nullptr)
+        {
+            continue;
+        }
+        const FVector Location = GetAntennaLocation(Sender);
+        const int64 X = FMath::FloorToInt(Location.X / CellSize);
+        const int64 Y = FMath::FloorToInt(Location.Y / CellSize);
+        Grid[MakeCellKey(X, Y)].push_back(LiveSenders.size());
+        LiveSenders.push_back(Sender);
+        SenderLocations.push_back(Location);
+    }
+
+    // 第 2 步：为每个接收者找出通信范围内的发送者，每对车辆只保留一条路径
+    std::vector<ActorPair> Pairs;
+    std::vector<std::vector<std::pair<AActor *, size_t>>> ReceiverLinks(mReceivers.size());
+    for (size_t r = 0u; r < mReceivers.size(); ++r)
+    {
+        AActor *Receiver = mReceivers[r].first;
+        const FVector Location = GetAntennaLocation(Receiver);
+        const double Range = 100.0 * mReceivers[r].second;
+        const int64 X = FMath::FloorToInt(Location.X / CellSize);
+        const int64 Y = FMath::FloorToInt(Location.Y / CellSize);
+        for (int64 dx = -1; dx <= 1; ++dx)
+        {
+            for (int64 dy = -1; dy <= 1; ++dy)
+            {
+                auto Cell = Grid.find(MakeCellKey(X + dx, Y + dy));
+                if (Cell == Grid.end())
+                {
+                    continue;
+                }
+                for (size_t s : Cell->second)
+                {
+                    AActor *Sender = LiveSenders[s];
+                    if (Sender == Receiver ||
+                        FVector::DistSquared(Location, SenderLocations[s]) >= Range * Range)
+                    {
+                        continue;
+                    }
+                    auto Inserted = mPathIndex.emplace(MakePair(Receiver, Sender), Pairs.size());
+                    if (Inserted.second)
+                    {
+                        Pairs.push_back(Inserted.first->first);
+                    }
+                    ReceiverLinks[r].emplace_back(Sender, Inserted.first->second);
+                }
+            }
+        }
+    }
+
+    // 第 3 步：批量追踪所有路径上的遮挡
+    TracePaths(World, Episode, Pairs);
+
+    for (size_t r = 0u; r < mReceivers.size(); ++r)
+    {
+        std::vector<FV2XLink> &Links = mLinks[mReceivers[r].first];
+        Links.reserve(ReceiverLinks[r].size());
+        for (const auto &Link : ReceiverLinks[r])
+        {
+            Links.push_back(FV2XLink{Link.first, &mPaths[Link.second]});
+        }
+    }
+}
+
+void V2XMedium::TracePaths(UWorld *World, UCarlaEpisode *Episode, const std::vector<ActorPair> &Pairs)
+{
+    TRACE_CPUPROFILER_EVENT_SCOPE(V2XMedium::TracePaths);
+    mPaths.resize(Pairs.size());
+    if (Pairs.empty())
+    {
+        return;
+    }
+
+    std::vector<FVector> Starts(Pairs.size());
+    std::vector<FVector> Ends(Pairs.size());
+    for (size_t i = 0u; i < Pairs.size(); ++i)
+    {
+        Starts[i] = GetAntennaLocation(Pairs[i].first);
+        Ends[i] = GetAntennaLocation(Pairs[i].second);
+    }
+
+    FCollisionObjectQueryParams ObjectParams;
+    // 检测与不同对象类型碰撞的通道
+    ObjectParams.AddObjectTypesToQuery(ECollisionChannel::ECC_WorldStatic);
+    ObjectParams.AddObjectTypesToQuery(ECollisionChannel::ECC_PhysicsBody);
+    ObjectParams.AddObjectTypesToQuery(ECollisionChannel::ECC_Vehicle);
+    ObjectParams.AddObjectTypesToQuery(ECollisionChannel::ECC_WorldDynamic);
+
+    std::vector<TArray<FHitResult>> Hits(Pairs.size());
+    World->GetPhysicsScene()->GetPxScene()->lockRead();
+    {
+        TRACE_CPUPROFILER_EVENT_SCOPE(ParallelFor);
+        ParallelFor(static_cast<int32>(Pairs.size()), [&](int32 i) {
+            World->LineTraceMultiByObjectType(Hits[i], Starts[i], Ends[i], ObjectParams);
+        });
+    }
+    World->GetPhysicsScene()->GetPxScene()->unlockRead();
+
+    // 根据命中结果确定路径状态：没有遮挡为 LOS，只有车辆遮挡为 NLOSv，遇到建筑物为 NLOSb
+    const FActorRegistry &Registry = Episode->GetActorRegistry();
+    for (size_t i = 0u; i < Pairs.size(); ++i)
+    {
+        FV2XPath &Path = mPaths[i];
+        // 两端在斜坡上时，以较低的一端作为计算高度的参考（厘米）
+        const double reference_z = std::min(
+            Pairs[i].first->GetTransform().GetLocation().Z,
+            Pairs[i].second->GetTransform().GetLocation().Z);
+        for (const FHitResult &HitInfo : Hits[i])
+        {
+            const AActor *actor = HitInfo.Actor.Get();
+            if (actor != nullptr && (actor == Pairs[i].first || actor == Pairs[i].second))
+            {
+                // 命中的是收发双方自己，不是障碍物
+                continue;
+            }
+            const FCarlaActor *view = actor != nullptr ? Registry.FindCarlaActor(actor) : nullptr;
+            if (view != nullptr && view->GetActorType() == FCarlaActor::ActorType::Vehicle)
+            {
+                // 车辆遮挡，位置换算为米，高度相对于参考高度
+                FVector location = actor->GetTransform().GetLocation();
+                location.Z = location.Z - reference_z + (actor->GetSimpleCollisionHalfHeight() * 2.0) + 2.0;
+                Path.VehicleObstacles.emplace_back(location / 100.0f);
+                Path.State = EPathState::NLOSv;
+            }
+            else
+            {
+                // 被建筑物遮挡
+                Path.State = EPathState::NLOSb;
+                break;
+            }
+        }
+    }
+}
@@ -0,0 +1,80 @@
+// Copyright (c) 2024 Institut fuer Technik der Informationsverarbeitung (ITIV) at the
+// Karlsruhe Institute of Technology
+//
+// V2X 共享信道
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "PathLossModel.h"
+
+#include <cstdint>
+#include <map>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// 发送者与接收者之间的传播路径，只取决于几何关系，两个方向共用
+struct FV2XPath
+{
+    EPathState State = EPathState::LOS;
+    // 遮挡车辆的位置（米），高度相对于两端中较低的一端
+    std::vector<FVector> VehicleObstacles;
+};
+
+// 接收者通信范围内的一个发送者
+struct FV2XLink
+{
+    AActor *Sender;
+    const FV2XPath *Path;
+};
+
+/*
+ * 一个仿真周期内同一类 V2X 传感器共享的信道。
+ * 发送者按通信范围放入二维网格，每个接收者只和相邻网格中的发送者配对；
+ * 每对车辆之间的遮挡射线只追踪一次，并在多个线程中批量执行。
+ * 路径损耗仍由各接收者的 PathLossModel 按自己的参数计算。
+ */
+class V2XMedium
+{
+public:
+    // 进入新的仿真周期时清空上一周期的数据，同一周期内重复调用没有影响
+    void BeginFrame(uint64_t Frame);
+
+    // 登记本周期的接收者，Range 为最大通信距离（米）
+    void AddReceiver(AActor *Receiver, float Range);
+
+    // 计算所有接收者的候选发送者以及它们之间的路径，每个周期只计算一次
+    void Update(UWorld *World, UCarlaEpisode *Episode, const std::vector<AActor *> &Senders);
+
+    bool IsUpdated() const { return bUpdated; }
+
+    // 通信范围内的发送者，不包括接收者自己
+    const std::vector<FV2XLink> &GetLinks(AActor *Receiver) const;
+
+    // 两个参与者之间的路径，不在通信范围内时返回 nullptr
+    const FV2XPath *FindPath(AActor *A, AActor *B) const;
+
+private:
+    using ActorPair = std::pair<AActor *, AActor *>;
+
+    static ActorPair MakePair(AActor *A, AActor *B)
+    {
+        return A < B ? ActorPair{A, B} : ActorPair{B, A};
+    }
+
+    // 天线位置：车顶上方 2 厘米，与 PathLossModel 中的高度一致
+    static FVector GetAntennaLocation(const AActor *Actor);
+
+    void TracePaths(UWorld *World, UCarlaEpisode *Episode, const std::vector<ActorPair> &Pairs);
+
+    uint64_t mFrame = 0u;
+    bool bUpdated = false;
+
+    std::vector<std::pair<AActor *, float>> mReceivers;
+    std::vector<FV2XPath> mPaths;
+    std::map<ActorPair, size_t> mPathIndex;
+    std::unordered_map<AActor *, std::vector<FV2XLink>> mLinks;
+};
@@ -7,6 +7,7 @@
 #include "Carla.h"
 #include "Carla/Sensor/V2XSensor.h"
 #include "Carla/Actor/ActorBlueprintFunctionLibrary.h"
+#include "Carla/Game/CarlaEngine.h"
 #include "Carla/Game/CarlaEpisode.h"
 #include "Carla/Vehicle/CarlaWheeledVehicle.h"
 #include <string.h>
@@ -16,6 +17,7 @@
 #include "V2X/PathLossModel.h"
 std::list<AActor *> AV2XSensor::mV2XActorContainer;
 AV2XSensor::ActorV2XDataMap AV2XSensor::mActorV2XDataMap;
+V2XMedium AV2XSensor::mMedium;
 
 AV2XSensor::AV2XSensor(const FObjectInitializer &ObjectInitializer)
     : Super(ObjectInitializer)
@@ -159,6 +161,18 @@ void AV2XSensor::SetYawrateDeviation(const float noise_yawrate_stddev, const flo
     CaServiceObj->SetYawrateDeviation(noise_yawrate_stddev, noise_yawrate_bias);
 }
 
+/*
+ * 在任何 V2X 传感器执行 PostPhysTick 之前，把当前 actor 登记为本周期共享信道的接收者
+ */
+void AV2XSensor::BeginPostPhysTick(UWorld *World, float DeltaSeconds)
+{
+    if (GetOwner())
+    {
+        AV2XSensor::mMedium.BeginFrame(FCarlaEngine::GetFrameCounter());
+        AV2XSensor::mMedium.AddReceiver(GetOwner(), PathLossModelObj->GetFilterDistance());
+    }
+}
+
 /*
  * Function 负责向当前 actor 发送消息。
  * First simulates the communication by calling LOSComm object.
@@ -169,25 +183,35 @@ void AV2XSensor::PostPhysTick(UWorld *World, ELevelTick TickType, float DeltaTim
     TRACE_CPUPROFILER_EVENT_SCOPE(AV2XSensor::PostPhysTick);
     if (GetOwner())
     {
-        // 第 1 步：创建一个参与者列表，其中包含要针对此 v2x 传感器实例发送的消息
-        std::vector<ActorPowerPair> ActorPowerList;
-        for (const auto &pair : AV2XSensor::mActorV2XDataMap)
+        UCarlaEpisode *carla_episode = UCarlaStatics::GetCurrentEpisode(GetWorld());
+
+        // 第 0 步：本周期第一个执行的传感器为所有接收者计算共享信道
+        if (!AV2XSensor::mMedium.IsUpdated())
         {
-            if (pair.first != GetOwner())
+            std::vector<AActor *> Senders;
+            Senders.reserve(AV2XSensor::mActorV2XDataMap.size());
+            for (const auto &pair : AV2XSensor::mActorV2XDataMap)
             {
-                ActorPowerPair actor_power_pair;
-                actor_power_pair.first = pair.first;
-                // actor sending with transmit power
-                actor_power_pair.second = pair.second.Power;
-                ActorPowerList.push_back(actor_power_pair);
+                Senders.push_back(pair.first);
             }
+            AV2XSensor::mMedium.Update(GetWorld(), carla_episode, Senders);
+        }
+
+        // 第 1 步：创建一个参与者列表，其中包含通信范围内要针对此 v2x 传感器实例发送的消息
+        std::vector<ActorPowerPair> ActorPowerList;
+        for (const FV2XLink &link : AV2XSensor::mMedium.GetLinks(GetOwner()))
+        {
+            ActorPowerPair actor_power_pair;
+            actor_power_pair.first = link.Sender;
+            // actor sending with transmit power
+            actor_power_pair.second = AV2XSensor::mActorV2XDataMap.at(link.Sender).Power;
+            ActorPowerList.push_back(actor_power_pair);
         }
 
         // 第 2 步：模拟 actor 列表中的 actor 与当前 actor 的通信。
         if (!ActorPowerList.empty())
         {
-            UCarlaEpisode *carla_episode = UCarlaStatics::GetCurrentEpisode(GetWorld());
-            PathLossModelObj->Simulate(ActorPowerList, carla_episode, GetWorld());
+            PathLossModelObj->Simulate(ActorPowerList, AV2XSensor::mMedium, carla_episode, GetWorld());
             // 第 3 步：获取可以向当前参与者发送消息的参与者列表，以及对他们消息的接收能力。
             ActorPowerMap actor_receivepower_map = PathLossModelObj->GetReceiveActorPowerList();
             // 第 4 步：检索收到的 actor 的消息
@@ -13,6 +13,7 @@
 #include <carla/sensor/data/V2XData.h>
 #include "V2X/CaService.h"
 #include "V2X/PathLossModel.h"
+#include "V2X/V2XMedium.h"
 #include <list>
 #include <map>
 #include "V2XSensor.generated.h"
@@ -60,6 +61,7 @@ public:
     void SetPathLossModel(const EPathLossModel path_loss_model);
 
     virtual void PrePhysTick(float DeltaSeconds) override;
+    virtual void BeginPostPhysTick(UWorld *World, float DeltaSeconds) override;
     virtual void PostPhysTick(UWorld *World, ELevelTick TickType, float DeltaTime) override;
     void SetOwner(AActor *Owner) override;
 
@@ -70,6 +72,8 @@ private:
 
     // store data
     static ActorV2XDataMap mActorV2XDataMap;
+    // 本周期所有 V2X 传感器共享的信道
+    static V2XMedium mMedium;
     FV2XData mV2XData;
 
     // write
@@ -0,0 +1,90 @@
+// Copyright (c) 2024 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "Carla.h"
+#include "Carla/Sensor/VehicleTelemetrySensor.h"
+#include "Carla/Actor/ActorBlueprintFunctionLibrary.h"
+#include "Carla/Vehicle/CarlaWheeledVehicle.h"
+
+#include "WheeledVehicleMovementComponent.h"
+
+#include <compiler/disable-ue4-macros.h>
+#include "carla/sensor/data/VehicleTelemetry.h"
+#include <compiler/enable-ue4-macros.h>
+
+#include <vector>
+
+AVehicleTelemetrySensor::AVehicleTelemetrySensor(const FObjectInitializer &ObjectInitializer)
+  : Super(ObjectInitializer)
+{
+  PrimaryActorTick.bCanEverTick = true;
+  PrimaryActorTick.TickGroup = TG_PostPhysics;
+}
+
+FActorDefinition AVehicleTelemetrySensor::GetSensorDefinition()
+{
+  return UActorBlueprintFunctionLibrary::MakeGenericSensorDefinition(
+      TEXT("other"),
+      TEXT("vehicle_telemetry"));
+}
+
+void AVehicleTelemetrySensor::SetOwner(AActor *NewOwner)
+{
+  Super::SetOwner(NewOwner);
+  Vehicle = Cast<ACarlaWheeledVehicle>(NewOwner);
+  if (!IsValid(Vehicle))
+  {
+    UE_LOG(LogCarla, Warning, TEXT("AVehicleTelemetrySensor: the sensor must be attached to a vehicle"));
+  }
+}
+
+void AVehicleTelemetrySensor::PostPhysTick(UWorld *World, ELevelTick TickType, float DeltaTime)
+{
+  TRACE_CPUPROFILER_EVENT_SCOPE(AVehicleTelemetrySensor::PostPhysTick);
+  if (!IsValid(Vehicle) || !Vehicle->GetMesh()->IsSimulatingPhysics())
+  {
+    return;
+  }
+  // 运动学车辆（例如混合物理模式）没有 PhysX 车辆，读取车轮状态会失败
+  UWheeledVehicleMovementComponent *Movement = Vehicle->GetVehicleMovement();
+  if (Movement == nullptr || Movement->PVehicle == nullptr)
+  {
+    return;
+  }
+
+  const FVehicleTelemetryData Telemetry = Vehicle->GetVehicleTelemetryData();
+
+  carla::sensor::data::VehicleTelemetryHeader Header;
+  Header.speed = Telemetry.Speed;
+  Header.steer = Telemetry.Steer;
+  Header.throttle = Telemetry.Throttle;
+  Header.brake = Telemetry.Brake;
+  Header.engine_rpm = Telemetry.EngineRPM;
+  Header.gear = Telemetry.Gear;
+  Header.drag = Telemetry.Drag;
+  Header.wheel_count = static_cast<uint32_t>(Telemetry.Wheels.Num());
+
+  std::vector<carla::sensor::data::WheelTelemetry> Wheels;
+  Wheels.reserve(Telemetry.Wheels.Num());
+  for (const FWheelTelemetryData &Wheel : Telemetry.Wheels)
+  {
+    Wheels.push_back({
+        Wheel.TireFriction,
+        Wheel.LatSlip,
+        Wheel.LongSlip,
+        Wheel.Omega,
+        Wheel.TireLoad,
+        Wheel.NormalizedTireLoad,
+        Wheel.Torque,
+        Wheel.LongForce,
+        Wheel.LatForce,
+        Wheel.NormalizedLongForce,
+        Wheel.NormalizedLatForce});
+  }
+
+  auto DataStream = GetDataStream(*this);
+  DataStream.SerializeAndSend(*this, Header, Wheels, DataStream.PopBufferFromPool());
+}
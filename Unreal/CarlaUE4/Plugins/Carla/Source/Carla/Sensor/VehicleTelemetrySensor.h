@@ -0,0 +1,38 @@
+// Copyright (c) 2024 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "Carla/Sensor/Sensor.h"
+
+#include "Carla/Actor/ActorDefinition.h"
+
+#include "VehicleTelemetrySensor.generated.h"
+
+class ACarlaWheeledVehicle;
+
+/// 附着在车辆上，每帧物理模拟之后把车辆和各车轮的遥测数据以紧凑的二进制格式发送给客户端，
+/// 客户端不再需要每帧调用 get_telemetry_data 轮询。车辆不模拟物理时不发送。
+UCLASS()
+class CARLA_API AVehicleTelemetrySensor : public ASensor
+{
+  GENERATED_BODY()
+
+public:
+
+  AVehicleTelemetrySensor(const FObjectInitializer &ObjectInitializer);
+
+  static FActorDefinition GetSensorDefinition();
+
+  void SetOwner(AActor *NewOwner) override;
+
+  virtual void PostPhysTick(UWorld *World, ELevelTick TickType, float DeltaTime) override;
+
+private:
+
+  UPROPERTY()
+  ACarlaWheeledVehicle *Vehicle = nullptr;
+};
@@ -20,11 +20,16 @@
 #include "Carla/Walker/WalkerController.h"
 
 #include "CoreGlobals.h"
+#include "Runtime/Core/Public/Async/ParallelFor.h"
 
 #include <compiler/disable-ue4-macros.h>
 #include <carla/rpc/String.h>
+#include <carla/rpc/EpisodeInterest.h>
+#include <carla/rpc/VehicleLightState.h>
 #include <carla/sensor/SensorRegistry.h>
 #include <carla/sensor/data/ActorDynamicState.h>
+#include <carla/sensor/data/ActorExtensionState.h>
+#include <carla/sensor/s11n/EpisodeStateDelta.h>
 #include <compiler/enable-ue4-macros.h>
 
 static auto FWorldObserver_GetActorState(const FCarlaActor &View, const FActorRegistry &Registry)
@@ -244,14 +249,15 @@ static auto FWorldObserver_GetDormantActorState(const FCarlaActor &View, const F
   return state;
 }
 
-static carla::geom::Vector3D FWorldObserver_GetAngularVelocity(const AActor &Actor)
+/// Below this amount of actors the work is not worth splitting in tasks.
+static constexpr int32 FWorldObserver_MinActorsPerTask = 256;
+
+static FVector FWorldObserver_GetAngularVelocity(const AActor &Actor)
 {
   const auto RootComponent = Cast<UPrimitiveComponent>(Actor.GetRootComponent());
-  const FVector AngularVelocity =
-      RootComponent != nullptr ?
-          RootComponent->GetPhysicsAngularVelocityInDegrees() :
-          FVector{0.0f, 0.0f, 0.0f};
-  return {AngularVelocity.X, AngularVelocity.Y, AngularVelocity.Z};
+  return RootComponent != nullptr ?
+      RootComponent->GetPhysicsAngularVelocityInDegrees() :
+      FVector{0.0f, 0.0f, 0.0f};
 }
 
 static carla::geom::Vector3D FWorldObserver_GetAcceleration(
@@ -265,36 +271,85 @@ static carla::geom::Vector3D FWorldObserver_GetAcceleration(
   return {Acceleration.X, Acceleration.Y, Acceleration.Z};
 }
 
-static carla::Buffer FWorldObserver_Serialize(
-    carla::Buffer &&buffer,
-    const UCarlaEpisode &Episode,
-    float DeltaSeconds,
-    bool MapChange,
-    bool PendingLightUpdates)
+/// Read everything that touches the actor and its components. Must run on
+/// the game thread.
+static void FWorldObserver_GetActorSnapshot(
+    const FCarlaActor &View,
+    const FActorRegistry &Registry,
+    FWorldObserver::FActorSnapshot &Snapshot)
 {
-  TRACE_CPUPROFILER_EVENT_SCOPE_STR(__FUNCTION__);
-  using Serializer = carla::sensor::s11n::EpisodeStateSerializer;
-  using SimulationState = carla::sensor::s11n::EpisodeStateSerializer::SimulationState;
-  using ActorDynamicState = carla::sensor::data::ActorDynamicState;
+  Snapshot.View = &View;
+  if(View.IsDormant())
+  {
+    const FActorData* ActorData = View.GetActorData();
+    Snapshot.Velocity = ActorData->Velocity;
+    Snapshot.AngularVelocity = ActorData->AngularVelocity;
+    Snapshot.State = FWorldObserver_GetDormantActorState(View, Registry);
+  }
+  else
+  {
+    Snapshot.Velocity = View.GetActor()->GetVelocity();
+    Snapshot.AngularVelocity = FWorldObserver_GetAngularVelocity(*View.GetActor());
+    Snapshot.State = FWorldObserver_GetActorState(View, Registry);
+  }
+  Snapshot.Transform = View.GetActorGlobalTransform();
+}
 
+/// Read the extension of a vehicle, the values that otherwise need one RPC per
+/// getter. Must run on the game thread.
+static carla::sensor::data::ActorExtensionState FWorldObserver_GetActorExtension(FCarlaActor &View)
+{
+  carla::sensor::data::ActorExtensionState Extension;
+  Extension.id = View.GetActorId();
+  FVehicleLightState LightState;
+  Extension.vehicle_light_state =
+      View.GetVehicleLightState(LightState) == ECarlaServerResponse::Success ?
+      carla::rpc::VehicleLightState(LightState).GetLightStateAsValue() :
+      0u;
+  for (uint8 Wheel = 0u; Wheel < 4u; ++Wheel)
+  {
+    float Angle = 0.0f;
+    if (View.GetWheelSteerAngle(static_cast<EVehicleWheelLocation>(Wheel), Angle) != ECarlaServerResponse::Success)
+    {
+      Angle = 0.0f;
+    }
+    Extension.wheel_steer_angles[Wheel] = Angle;
+  }
+  return Extension;
+}
 
-  const FActorRegistry &Registry = Episode.GetActorRegistry();
+/// Convert a snapshot, it only touches the snapshot and the previous velocity
+/// of its own actor so it can run in any thread.
+static carla::sensor::data::ActorDynamicState FWorldObserver_GetActorDynamicState(
+    const FWorldObserver::FActorSnapshot &Snapshot,
+    float DeltaSeconds)
+{
+  constexpr float TO_METERS = 1e-2;
 
-  auto total_size = sizeof(Serializer::Header) + sizeof(ActorDynamicState) * Registry.Num();
-  auto current_size = 0;
-  // Set up buffer for writing.
-  buffer.reset(total_size);
-  auto write_data = [&current_size, &buffer](const auto &data)
-  {
-    auto begin = buffer.begin() + current_size;
-    std::memcpy(begin, &data, sizeof(data));
-    current_size += sizeof(data);
+  const FCarlaActor &View = *Snapshot.View;
+  const FVector Velocity = TO_METERS * Snapshot.Velocity;
+  const FVector &AngularVelocity = Snapshot.AngularVelocity;
+
+  return {
+    View.GetActorId(),
+    View.GetActorState(),
+    carla::geom::Transform(Snapshot.Transform),
+    carla::geom::Vector3D(Velocity.X, Velocity.Y, Velocity.Z),
+    carla::geom::Vector3D(AngularVelocity.X, AngularVelocity.Y, AngularVelocity.Z),
+    FWorldObserver_GetAcceleration(View, Velocity, DeltaSeconds),
+    Snapshot.State,
   };
+}
 
-  constexpr float TO_METERS = 1e-2;
+static carla::sensor::s11n::EpisodeStateSerializer::Header FWorldObserver_MakeHeader(
+    const UCarlaEpisode &Episode,
+    float DeltaSeconds,
+    bool MapChange,
+    bool PendingLightUpdates)
+{
+  using SimulationState = carla::sensor::s11n::EpisodeStateSerializer::SimulationState;
 
-  // Write header.
-  Serializer::Header header;
+  carla::sensor::s11n::EpisodeStateSerializer::Header header;
   header.episode_id = Episode.GetId();
   header.platform_timestamp = FPlatformTime::Seconds();
   header.delta_seconds = DeltaSeconds;
@@ -306,62 +361,149 @@ static carla::Buffer FWorldObserver_Serialize(
   simulation_state |= (SimulationState::PendingLightUpdate * PendingLightUpdates);
 
   header.simulation_state = static_cast<SimulationState>(simulation_state);
+  return header;
+}
 
-  write_data(header);
-
-  // Write every actor.
-  for (auto& It : Registry)
+/// Gather the state of every actor. This must run exactly once per tick, the
+/// acceleration is computed from the velocity of the previous call.
+///
+/// The actors are read on the game thread into @a Snapshots, and converted
+/// to @a Actors in parallel. The extensions of the vehicles are only read if
+/// @a Extensions is not null.
+static void FWorldObserver_GetActors(
+    const UCarlaEpisode &Episode,
+    float DeltaSeconds,
+    std::vector<FWorldObserver::FActorSnapshot> &Snapshots,
+    std::vector<carla::sensor::data::ActorDynamicState> &Actors,
+    std::vector<carla::sensor::data::ActorExtensionState> *Extensions)
+{
+  TRACE_CPUPROFILER_EVENT_SCOPE_STR(__FUNCTION__);
+  const FActorRegistry &Registry = Episode.GetActorRegistry();
+  Snapshots.resize(Registry.Num());
   {
-    const FCarlaActor* View = It.Value.Get();
-    const FActorInfo* ActorInfo = View->GetActorInfo();
-
-    FTransform ActorTransform;
-    FVector Velocity(0.0f);
-    carla::geom::Vector3D AngularVelocity(0.0f, 0.0f, 0.0f);
-    carla::geom::Vector3D Acceleration(0.0f, 0.0f, 0.0f);
-    carla::sensor::data::ActorDynamicState::TypeDependentState State{};
-
-
-    check(View);
+    TRACE_CPUPROFILER_EVENT_SCOPE_STR("FWorldObserver_GetActors::Snapshot");
+    size_t Index = 0u;
+    for (auto& It : Registry)
+    {
+      FCarlaActor* View = It.Value.Get();
+      check(View);
+      FWorldObserver::FActorSnapshot &Snapshot = Snapshots[Index++];
+      FWorldObserver_GetActorSnapshot(*View, Registry, Snapshot);
+      Snapshot.ExtensionIndex = INDEX_NONE;
+      if (Extensions != nullptr && View->GetActorType() == FCarlaActor::ActorType::Vehicle)
+      {
+        Snapshot.ExtensionIndex = static_cast<int32>(Extensions->size());
+        Extensions->emplace_back(FWorldObserver_GetActorExtension(*View));
+      }
+    }
+  }
+  const int32 Num = static_cast<int32>(Snapshots.size());
+  Actors.resize(Snapshots.size());
+  ParallelFor(FMath::DivideAndRoundUp(Num, FWorldObserver_MinActorsPerTask), [&](int32 Task)
+  {
+    const int32 End = FMath::Min(Num, (Task + 1) * FWorldObserver_MinActorsPerTask);
+    for (int32 Index = Task * FWorldObserver_MinActorsPerTask; Index < End; ++Index)
+    {
+      Actors[Index] = FWorldObserver_GetActorDynamicState(Snapshots[Index], DeltaSeconds);
+    }
+  }, Num <= FWorldObserver_MinActorsPerTask);
+}
 
-    if(View->IsDormant())
+static bool FWorldObserver_IsInterested(
+    const FWorldObserver::FInterestStream &Interest,
+    const carla::sensor::data::ActorDynamicState &Actor,
+    const FCarlaActor &View,
+    const carla::sensor::data::ActorDynamicState *Center)
+{
+  if ((Actor.id == Interest.Interest.center_actor) || Interest.ActorIds.count(Actor.id) > 0u)
+  {
+    return true;
+  }
+  const bool bHasRadius = Interest.Interest.HasRadiusFilter();
+  if (!bHasRadius && Interest.TypePatterns.Num() == 0)
+  {
+    return false;
+  }
+  if (bHasRadius)
+  {
+    if (Center == nullptr)
     {
-      const FActorData* ActorData = View->GetActorData();
-      Velocity = TO_METERS * ActorData->Velocity;
-      AngularVelocity = carla::geom::Vector3D
-                        {ActorData->AngularVelocity.X,
-                         ActorData->AngularVelocity.Y,
-                         ActorData->AngularVelocity.Z};
-      Acceleration = FWorldObserver_GetAcceleration(*View, Velocity, DeltaSeconds);
-      State = FWorldObserver_GetDormantActorState(*View, Registry);
+      return false;
     }
-    else
+    const auto Offset = Actor.transform.location - Center->transform.location;
+    if (Offset.SquaredLength() > Interest.Interest.radius * Interest.Interest.radius)
+    {
+      return false;
+    }
+  }
+  if (Interest.TypePatterns.Num() > 0)
+  {
+    const FString &TypeId = View.GetActorInfo()->Description.Id;
+    for (const FString &Pattern : Interest.TypePatterns)
     {
-      Velocity = TO_METERS * View->GetActor()->GetVelocity();
-      AngularVelocity = FWorldObserver_GetAngularVelocity(*View->GetActor());
-      Acceleration = FWorldObserver_GetAcceleration(*View, Velocity, DeltaSeconds);
-      State = FWorldObserver_GetActorState(*View, Registry);
+      if (TypeId.MatchesWildcard(Pattern))
+      {
+        return true;
+      }
     }
-    ActorTransform = View->GetActorGlobalTransform();
-
-    ActorDynamicState info = {
-      View->GetActorId(),
-      View->GetActorState(),
-      carla::geom::Transform(ActorTransform),
-      carla::geom::Vector3D(Velocity.X, Velocity.Y, Velocity.Z),
-      AngularVelocity,
-      Acceleration,
-      State,
-    };
-    write_data(info);
+    return false;
   }
+  return true;
+}
 
-  // Shrink buffer
-  buffer.resize(current_size);
+static void FWorldObserver_Send(
+    FWorldObserver &Observer,
+    FDataMultiStream &Stream,
+    carla::sensor::s11n::episode_state_delta::Encoder &DeltaEncoder,
+    const UCarlaEpisode &Episode,
+    const carla::sensor::s11n::EpisodeStateSerializer::Header &Header,
+    const std::vector<carla::sensor::data::ActorDynamicState> &Actors,
+    const std::vector<carla::sensor::data::ActorExtensionState> *Extensions = nullptr)
+{
+  TRACE_CPUPROFILER_EVENT_SCOPE_STR(__FUNCTION__);
+  auto AsyncStream = Stream.MakeAsyncDataStream(Observer, Episode.GetElapsedGameTime());
+  carla::Buffer buffer = AsyncStream.PopBufferFromPool();
+  DeltaEncoder.Encode(FCarlaEngine::GetFrameCounter(), Header, Actors, Extensions, buffer);
+  AsyncStream.SerializeAndSend(Observer, std::move(buffer));
+}
 
-  check(buffer.size() == current_size);
+void FWorldObserver::SetKeyframeInterval(uint32 Interval)
+{
+  KeyframeInterval = Interval;
+  DeltaEncoder.SetKeyframeInterval(Interval);
+  for (auto &Interest : InterestStreams)
+  {
+    Interest->DeltaEncoder.SetKeyframeInterval(Interval);
+  }
+}
 
-  return std::move(buffer);
+carla::streaming::Token FWorldObserver::GetInterestToken(
+    const carla::rpc::EpisodeInterest &Interest,
+    const std::function<FDataMultiStream()> &MakeStream)
+{
+  const double Now = FPlatformTime::Seconds();
+  for (auto &Existing : InterestStreams)
+  {
+    if (Existing->Interest == Interest)
+    {
+      // Give the new subscriber the same grace period as a new stream.
+      Existing->CreationTime = Now;
+      Existing->bHadClients = false;
+      return Existing->Stream.GetToken();
+    }
+  }
+  auto NewInterest = std::make_unique<FInterestStream>();
+  NewInterest->Interest = Interest;
+  NewInterest->ActorIds.insert(Interest.actor_ids.begin(), Interest.actor_ids.end());
+  for (const std::string &Pattern : Interest.actor_types)
+  {
+    NewInterest->TypePatterns.Emplace(carla::rpc::ToFString(Pattern));
+  }
+  NewInterest->Stream = MakeStream();
+  NewInterest->DeltaEncoder.SetKeyframeInterval(KeyframeInterval);
+  NewInterest->CreationTime = Now;
+  InterestStreams.emplace_back(std::move(NewInterest));
+  return InterestStreams.back()->Stream.GetToken();
 }
 
 void FWorldObserver::BroadcastTick(
@@ -371,18 +513,91 @@ void FWorldObserver::BroadcastTick(
     bool PendingLightUpdates)
 {
   TRACE_CPUPROFILER_EVENT_SCOPE_STR(__FUNCTION__);
+  using ActorDynamicState = carla::sensor::data::ActorDynamicState;
 
   if (!Stream.IsStreamReady())
     return;
 
-  auto AsyncStream = Stream.MakeAsyncDataStream(*this, Episode.GetElapsedGameTime());
+  const auto Header = FWorldObserver_MakeHeader(Episode, DeltaSecond, MapChange, PendingLightUpdates);
 
-  carla::Buffer buffer = FWorldObserver_Serialize(
-      AsyncStream.PopBufferFromPool(),
-      Episode,
-      DeltaSecond,
-      MapChange,
-      PendingLightUpdates);
+  const double Now = FPlatformTime::Seconds();
+  for (auto It = InterestStreams.begin(); It != InterestStreams.end();)
+  {
+    FInterestStream &Interest = **It;
+    if (!Interest.Stream.AreClientsListening())
+    {
+      // Drop the stream once its clients are gone, or if nobody subscribed
+      // to it in time.
+      if (Interest.bHadClients || (Now - Interest.CreationTime > INTEREST_SUBSCRIPTION_TIMEOUT))
+      {
+        It = InterestStreams.erase(It);
+      }
+      else
+      {
+        ++It;
+      }
+      continue;
+    }
+    Interest.bHadClients = true;
+    ActiveInterests.emplace_back(&Interest);
+    ++It;
+  }
 
-  AsyncStream.SerializeAndSend(*this, std::move(buffer));
+  // The extensions are only read if a listening stream asked for them.
+  bool bNeedsExtensions = false;
+  for (const FInterestStream *Interest : ActiveInterests)
+  {
+    bNeedsExtensions |= Interest->Interest.HasExtension(carla::rpc::EpisodeInterest::VehicleExtension);
+  }
+  Extensions.clear();
+  FWorldObserver_GetActors(Episode, DeltaSecond, Snapshots, Actors, bNeedsExtensions ? &Extensions : nullptr);
+
+  // Every stream has its own encoder, the full stream and each interest
+  // stream are filtered and encoded in parallel.
+  const bool bSendAll = Stream.AreClientsListening();
+  const int32 Tasks = static_cast<int32>(ActiveInterests.size()) + (bSendAll ? 1 : 0);
+  ParallelFor(Tasks, [&](int32 Task)
+  {
+    if (bSendAll && Task == 0)
+    {
+      FWorldObserver_Send(*this, Stream, DeltaEncoder, Episode, Header, Actors);
+      return;
+    }
+    FInterestStream &Interest = *ActiveInterests[Task - (bSendAll ? 1 : 0)];
+    const ActorDynamicState *Center = nullptr;
+    if (Interest.Interest.HasRadiusFilter())
+    {
+      for (const ActorDynamicState &Actor : Actors)
+      {
+        if (Actor.id == Interest.Interest.center_actor)
+        {
+          Center = &Actor;
+          break;
+        }
+      }
+    }
+    const bool bWithExtensions = Interest.Interest.HasExtension(carla::rpc::EpisodeInterest::VehicleExtension);
+    Interest.FilteredActors.clear();
+    Interest.FilteredExtensions.clear();
+    for (size_t Index = 0u; Index < Actors.size(); ++Index)
+    {
+      if (FWorldObserver_IsInterested(Interest, Actors[Index], *Snapshots[Index].View, Center))
+      {
+        Interest.FilteredActors.emplace_back(Actors[Index]);
+        if (bWithExtensions && Snapshots[Index].ExtensionIndex != INDEX_NONE)
+        {
+          Interest.FilteredExtensions.emplace_back(Extensions[Snapshots[Index].ExtensionIndex]);
+        }
+      }
+    }
+    FWorldObserver_Send(
+        *this,
+        Interest.Stream,
+        Interest.DeltaEncoder,
+        Episode,
+        Header,
+        Interest.FilteredActors,
+        bWithExtensions ? &Interest.FilteredExtensions : nullptr);
+  }, Tasks < 2);
+  ActiveInterests.clear();
 }
@@ -8,6 +8,20 @@
 
 #include "Carla/Sensor/DataStream.h"
 
+#include <compiler/disable-ue4-macros.h>
+#include <carla/rpc/EpisodeInterest.h>
+#include <carla/sensor/data/ActorDynamicState.h>
+#include <carla/sensor/data/ActorExtensionState.h>
+#include <carla/sensor/s11n/EpisodeStateDelta.h>
+#include <compiler/enable-ue4-macros.h>
+
+#include <functional>
+#include <memory>
+#include <unordered_set>
+#include <vector>
+
+class FCarlaActor;
+
 class UCarlaEpisode;
 
 /// Serializes and sends all the actors in the current UCarlaEpisode.
@@ -38,13 +52,84 @@ public:
     bool MapChange,
     bool PendingLightUpdate);
 
+  /// Send a full keyframe every @a Interval frames and only the actors that
+  /// changed in between. 0 or 1 disables delta encoding.
+  void SetKeyframeInterval(uint32 Interval);
+
+  /// Return the token of a stream that only contains the actors in @a
+  /// Interest, creating it with @a MakeStream if no client asked for the same
+  /// interest set before. The stream is dropped once its clients unsubscribe.
+  carla::streaming::Token GetInterestToken(
+    const carla::rpc::EpisodeInterest &Interest,
+    const std::function<FDataMultiStream()> &MakeStream);
+
   /// Dummy. Required for compatibility with other sensors only.
   FTransform GetActorTransform() const
   {
     return {};
   }
 
+  /// A stream serialized for the clients that registered an interest set.
+  struct FInterestStream
+  {
+    carla::rpc::EpisodeInterest Interest;
+
+    std::unordered_set<carla::ActorId> ActorIds;
+
+    TArray<FString> TypePatterns;
+
+    FDataMultiStream Stream;
+
+    carla::sensor::s11n::episode_state_delta::Encoder DeltaEncoder;
+
+    bool bHadClients = false;
+
+    double CreationTime = 0.0;
+
+    /// Scratch buffers, each stream is filtered and encoded in its own task.
+    std::vector<carla::sensor::data::ActorDynamicState> FilteredActors;
+
+    std::vector<carla::sensor::data::ActorExtensionState> FilteredExtensions;
+  };
+
+  /// The data of an actor that has to be read on the game thread. It is
+  /// converted to an ActorDynamicState afterwards, in parallel.
+  struct FActorSnapshot
+  {
+    const FCarlaActor *View = nullptr;
+
+    FTransform Transform;
+
+    FVector Velocity;
+
+    FVector AngularVelocity;
+
+    carla::sensor::data::ActorDynamicState::TypeDependentState State;
+
+    /// Index of the actor's extension, INDEX_NONE if the actor has none or no
+    /// stream asked for extensions this tick.
+    int32 ExtensionIndex = INDEX_NONE;
+  };
+
 private:
 
+  /// Seconds a client has to subscribe to a new interest stream.
+  static constexpr double INTEREST_SUBSCRIPTION_TIMEOUT = 60.0;
+
   FDataMultiStream Stream;
+
+  uint32 KeyframeInterval = 0u;
+
+  std::vector<std::unique_ptr<FInterestStream>> InterestStreams;
+
+  /// Scratch buffers reused every tick.
+  std::vector<FActorSnapshot> Snapshots;
+
+  std::vector<carla::sensor::data::ActorDynamicState> Actors;
+
+  std::vector<carla::sensor::data::ActorExtensionState> Extensions;
+
+  std::vector<FInterestStream *> ActiveInterests;
+
+  carla::sensor::s11n::episode_state_delta::Encoder DeltaEncoder;
 };
@@ -15,11 +15,13 @@
 #include "Engine/SkeletalMesh.h"
 #include "Engine/SkeletalMeshSocket.h"
 
+#include "Carla/Actor/ActorBlueprintFunctionLibrary.h"
 #include "Carla/OpenDrive/OpenDrive.h"
 #include "Carla/Util/DebugShapeDrawer.h"
 #include "Carla/Util/NavigationMesh.h"
 #include "Carla/Util/RayTracer.h"
 #include "Carla/Vehicle/CarlaWheeledVehicle.h"
+#include "Carla/Vehicle/KinematicVehicles.h"
 #include "Carla/Sensor/CustomV2XSensor.h"
 #include "Carla/Walker/WalkerController.h"
 #include "Carla/Walker/WalkerBase.h"
@@ -32,30 +34,42 @@
 #include "Carla/Actor/ActorData.h"
 #include "CarlaServerResponse.h"
 #include "Carla/Util/BoundingBoxCalculator.h"
+#include "HAL/PlatformFilemanager.h"
 #include "Misc/FileHelper.h"
 
 #include <compiler/disable-ue4-macros.h>
 #include <carla/Functional.h>
+#include <carla/ThreadAffinity.h>
 #include <carla/multigpu/router.h>
 #include <carla/Version.h>
 #include <carla/rpc/AckermannControllerSettings.h>
 #include <carla/rpc/Actor.h>
 #include <carla/rpc/ActorDefinition.h>
 #include <carla/rpc/ActorDescription.h>
+#include <carla/rpc/ActorQuery.h>
 #include <carla/rpc/BoneTransformDataIn.h>
+#include <carla/rpc/CachedContent.h>
 #include <carla/rpc/Command.h>
 #include <carla/rpc/CommandResponse.h>
 #include <carla/rpc/DebugShape.h>
 #include <carla/rpc/EnvironmentObject.h>
 #include <carla/rpc/EpisodeInfo.h>
+#include <carla/rpc/EpisodeInterest.h>
 #include <carla/rpc/EpisodeSettings.h>
+#include <carla/rpc/FileInfo.h>
 #include <carla/rpc/LabelledPoint.h>
 #include <carla/rpc/LightState.h>
 #include <carla/rpc/MapInfo.h>
 #include <carla/rpc/MapLayer.h>
+#include <carla/rpc/RecorderFilter.h>
 #include <carla/rpc/Response.h>
+#include <carla/rpc/SecondaryTelemetry.h>
+#include <carla/rpc/SpawnBatchStatus.h>
 #include <carla/rpc/Server.h>
+#include <carla/rpc/ServerProfile.h>
+#include <carla/rpc/SignTriggerEvent.h>
 #include <carla/rpc/String.h>
+#include <carla/rpc/TrafficLightPlan.h>
 #include <carla/rpc/Transform.h>
 #include <carla/rpc/Vector2D.h>
 #include <carla/rpc/Vector3D.h>
@@ -68,6 +82,7 @@
 #include <carla/rpc/VehicleTelemetryData.h>
 #include <carla/rpc/WalkerBoneControlIn.h>
 #include <carla/rpc/WalkerBoneControlOut.h>
+#include <carla/rpc/WalkerBonePoses.h>
 #include <carla/rpc/WalkerControl.h>
 #include <carla/rpc/VehicleWheels.h>
 #include <carla/rpc/WeatherParameters.h>
@@ -78,8 +93,14 @@
 
 #include <vector>
 #include <atomic>
+#include <cmath>
+#include <deque>
+#include <functional>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <tuple>
+#include <unordered_map>
 
 template <typename T>
 using R = carla::rpc::Response<T>;
@@ -95,6 +116,202 @@ static std::vector<T> MakeVectorFromTArray(const TArray<Other> &Array)
   return {Array.GetData(), Array.GetData() + Array.Num()};
 }
 
+// 从命令行读取形如"0-3,8"的处理器列表，未指定时返回空列表
+static std::vector<size_t> ParseCpuListArgument(const TCHAR *Argument)
+{
+  FString Value;
+  if (!FParse::Value(FCommandLine::Get(), Argument, Value))
+  {
+    return {};
+  }
+  auto Cpus = carla::ParseCpuList(TCHAR_TO_UTF8(*Value));
+  if (Cpus.empty())
+  {
+    UE_LOG(LogCarla, Warning, TEXT("Invalid CPU list %s%s, threads will not be pinned"), Argument, *Value);
+  }
+  return Cpus;
+}
+
+// 控制流端口为0时不创建独立的流媒体服务器
+static std::unique_ptr<carla::streaming::Server> MakeControlStreamingServer(uint16_t Port)
+{
+  if (Port == 0u)
+  {
+    return nullptr;
+  }
+  return std::make_unique<carla::streaming::Server>(Port);
+}
+
+// 多 GPU 模式下放置传感器时使用的估计开销，单位约为每帧渲染一百万像素。
+// 激光雷达按每秒的点数估计，其他传感器的开销很小
+static constexpr float LidarPointsPerSecondPerCost = 500000.0f;
+static constexpr float MinSensorCost = 0.1f;
+
+static float GetSensorCost(const FActorDescription &Description)
+{
+  using ABFL = UActorBlueprintFunctionLibrary;
+  if (Description.Id.StartsWith("sensor.camera."))
+  {
+    const float Width = ABFL::RetrieveActorAttributeToInt("image_size_x", Description.Variations, 800);
+    const float Height = ABFL::RetrieveActorAttributeToInt("image_size_y", Description.Variations, 600);
+    return FMath::Max(Width * Height / 1e6f, MinSensorCost);
+  }
+  if (Description.Id.StartsWith("sensor.lidar.") || Description.Id.StartsWith("sensor.other.radar"))
+  {
+    const float PointsPerSecond = ABFL::RetrieveActorAttributeToFloat("points_per_second", Description.Variations, 56000.0f);
+    return FMath::Max(PointsPerSecond / LidarPointsPerSecondPerCost, MinSensorCost);
+  }
+  return MinSensorCost;
+}
+
+// 多 GPU 模式下放在同一台次级服务器上的传感器分组，只用于大地图：附着在
+// 其他参与者上的传感器按根参与者（通常是英雄车）分组，其余的按所在的图块
+// 分组，这样每台次级服务器只需要加载少数区域的图块。不是大地图时返回 0，
+// 即只按开销放置
+static uint64_t GetSensorGroup(UCarlaEpisode &Episode, carla::streaming::detail::stream_id_type StreamId)
+{
+  ALargeMapManager* LargeMap = UCarlaStatics::GetLargeMapManager(Episode.GetWorld());
+  FCarlaActor* CarlaActor = Episode.FindCarlaActorFromStream(StreamId);
+  if (LargeMap == nullptr || CarlaActor == nullptr)
+  {
+    return 0u;
+  }
+  FCarlaActor* Root = CarlaActor;
+  while (Root->GetParent() != 0u)
+  {
+    FCarlaActor* Parent = Episode.FindCarlaActor(Root->GetParent());
+    if (Parent == nullptr)
+    {
+      break;
+    }
+    Root = Parent;
+  }
+  if (Root != CarlaActor)
+  {
+    return Root->GetActorId();
+  }
+  // 图块的分组放在高位，与参与者 id 区分
+  const FVector Location = CarlaActor->GetActorGlobalLocation();
+  const uint64_t Tile = static_cast<uint64_t>(LargeMap->GetTileID(Location));
+  return (1ull << 63u) | (Tile & ~(1ull << 63u));
+}
+
+/// Absolute path of a file under the content folder, false if @a Name tries
+/// to leave it.
+static bool GetContentFilePath(const std::string &Name, FString &Path)
+{
+  if (Name.empty() || Name.find("..") != std::string::npos)
+  {
+    return false;
+  }
+  Path = FPaths::ConvertRelativePathToFull(FPaths::ProjectContentDir());
+  Path.Append(UTF8_TO_TCHAR(Name.c_str()));
+  return true;
+}
+
+/// Chunk hashes of the files served to the clients. They are computed once
+/// per file and only again if the file changes. Safe to call from the RPC
+/// worker threads.
+static bool GetContentFileInfo(const FString &Path, carla::rpc::FileInfo &Info)
+{
+  struct FCachedFileInfo
+  {
+    int64 Size;
+    FDateTime TimeStamp;
+    carla::rpc::FileInfo Info;
+  };
+  static std::mutex Mutex;
+  static TMap<FString, FCachedFileInfo> Cache;
+
+  IPlatformFile &PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+  const int64 Size = PlatformFile.FileSize(*Path);
+  if (Size < 0)
+  {
+    return false;
+  }
+  const FDateTime TimeStamp = PlatformFile.GetTimeStamp(*Path);
+  {
+    std::lock_guard<std::mutex> Lock(Mutex);
+    const FCachedFileInfo *Cached = Cache.Find(Path);
+    if (Cached != nullptr && Cached->Size == Size && Cached->TimeStamp == TimeStamp)
+    {
+      Info = Cached->Info;
+      return true;
+    }
+  }
+  TArray<uint8> Content;
+  if (!FFileHelper::LoadFileToArray(Content, *Path, 0))
+  {
+    return false;
+  }
+  Info = carla::rpc::FileInfo::Make(Content.GetData(), static_cast<uint64_t>(Content.Num()));
+  std::lock_guard<std::mutex> Lock(Mutex);
+  Cache.Add(Path, FCachedFileInfo{Content.Num(), TimeStamp, Info});
+  return true;
+}
+
+// 同一批命令中生成位置几乎重合的车辆和行人一定会碰撞，不需要尝试生成就可以
+// 拒绝。返回每个命令是否被拒绝；附着在其他参与者上的和其他类型的参与者不检查。
+// 位置按网格哈希，每个位置只和相邻网格中的位置比较
+static std::vector<bool> FindOverlappingSpawns(const std::vector<carla::rpc::Command> &Commands)
+{
+  constexpr float MinDistance = 0.5f; // 米
+  constexpr float MinHeight = 2.0f;
+  std::vector<bool> Rejected(Commands.size(), false);
+  std::unordered_map<uint64_t, std::vector<carla::geom::Location>> Cells;
+  auto CellKey = [](int64_t X, int64_t Y) {
+    return (static_cast<uint64_t>(X) << 32u) ^ (static_cast<uint64_t>(Y) & 0xffffffffull);
+  };
+  for (size_t i = 0u; i < Commands.size(); ++i)
+  {
+    const auto *Spawn = boost::variant2::get_if<carla::rpc::Command::SpawnActor>(&Commands[i].command);
+    if (Spawn == nullptr || Spawn->parent.has_value())
+    {
+      continue;
+    }
+    const std::string &Id = Spawn->description.id;
+    if (Id.rfind("vehicle.", 0) != 0 && Id.rfind("walker.", 0) != 0)
+    {
+      continue;
+    }
+    const carla::geom::Location &Location = Spawn->transform.location;
+    const int64_t X = static_cast<int64_t>(std::floor(Location.x / MinDistance));
+    const int64_t Y = static_cast<int64_t>(std::floor(Location.y / MinDistance));
+    bool Overlaps = false;
+    for (int64_t DX = -1; DX <= 1 && !Overlaps; ++DX)
+    {
+      for (int64_t DY = -1; DY <= 1 && !Overlaps; ++DY)
+      {
+        auto Cell = Cells.find(CellKey(X + DX, Y + DY));
+        if (Cell == Cells.end())
+        {
+          continue;
+        }
+        for (const auto &Other : Cell->second)
+        {
+          const float DistX = Other.x - Location.x;
+          const float DistY = Other.y - Location.y;
+          if (DistX * DistX + DistY * DistY < MinDistance * MinDistance &&
+              std::abs(Other.z - Location.z) < MinHeight)
+          {
+            Overlaps = true;
+            break;
+          }
+        }
+      }
+    }
+    if (Overlaps)
+    {
+      Rejected[i] = true;
+    }
+    else
+    {
+      Cells[CellKey(X, Y)].emplace_back(Location);
+    }
+  }
+  return Rejected;
+}
+
 // =============================================================================
 // -- FCarlaServer::FPimpl -----------------------------------------------
 // =============================================================================
@@ -103,10 +320,11 @@ class FCarlaServer::FPimpl
 {
 public:
 
-  FPimpl(uint16_t RPCPort, uint16_t StreamingPort, uint16_t SecondaryPort)
+  FPimpl(uint16_t RPCPort, uint16_t StreamingPort, uint16_t SecondaryPort, uint16_t ControlStreamingPort)
     : Server(RPCPort),
       StreamingServer(StreamingPort),
-      BroadcastStream(StreamingServer.MakeStream())
+      ControlStreamingServer(MakeControlStreamingServer(ControlStreamingPort)),
+      BroadcastStream(GetControlStreamingServer().MakeStream())
   {
     // 我们需要从路由中创建指向 carla::multigpu::Router 类型的智能指针 shared_ptr，以便一些处理程序能够存活
     // 使用make_shared函数可以减少内存分配的次数，因为它会在一次内存分配中同时分配智能指针对象和指向的对象。
@@ -120,6 +338,11 @@ public:
     return SecondaryServer;
   }
 
+  /// 发送剧集状态的流媒体服务器，未启用独立的控制流服务器时即传感器的流媒体服务器
+  carla::streaming::Server &GetControlStreamingServer() {
+    return ControlStreamingServer ? *ControlStreamingServer : StreamingServer;
+  }
+
   /// 仿真中所有活动的交通管理器对 < port, ip > 的映射
   std::map<uint16_t, std::string> TrafficManagerInfo;
 
@@ -127,14 +350,91 @@ public:
 
   carla::streaming::Server StreamingServer;
 
+  /// 剧集状态专用的流媒体服务器，拥有独立的线程池，可以为空
+  std::unique_ptr<carla::streaming::Server> ControlStreamingServer;
+
   carla::streaming::Stream BroadcastStream;
 
   std::shared_ptr<carla::multigpu::Router> SecondaryServer;
 
   UCarlaEpisode *Episode = nullptr;
 
+  // 客户端按 id 替换的持久调试形状
+  FDebugShapeBatches DebugShapeBatches;
+
+  // 服务器每帧移动的运动学车辆
+  FKinematicVehicles KinematicVehicles;
+
   std::atomic_size_t TickCuesReceived { 0u };  // 收到的节拍提示
 
+  /// 分多帧执行的一批命令，执行完后保留到客户端取走结果为止
+  struct FSpawnBatch
+  {
+    uint64_t Ticket = 0u;
+    std::vector<carla::rpc::Command> Commands;
+    std::vector<carla::rpc::CommandResponse> Responses;
+    std::vector<bool> Rejected;
+    size_t Next = 0u;
+    double TimeBudget = 0.0; // 每帧最多用于这批命令的时间，单位为秒
+
+    bool IsDone() const
+    {
+      return Next >= Commands.size();
+    }
+  };
+
+  std::deque<FSpawnBatch> SpawnBatches;
+
+  uint64_t NextSpawnBatch = 1u;
+
+  /// 上次 TakeBatchCommandCount 以来 apply_batch 执行的命令数
+  uint32 BatchCommandCount = 0u;
+
+  /// 执行一条批处理命令，与 apply_batch 相同
+  std::function<carla::rpc::CommandResponse(const carla::rpc::Command &)> ApplyCommand;
+
+  /// 在游戏线程上按各批的时间预算执行排队的命令，每帧至少执行一条
+  void ProcessSpawnBatches();
+
+  /// 剧集结束时，没有执行的命令都以 @a Reason 失败
+  void AbortSpawnBatches(const std::string &Reason);
+
+  /// 只读 RPC 在工作线程上读取的剧集状态，在游戏线程上生成，发布后不再修改
+  struct FReadOnlyState
+  {
+    /// 整个剧集中不变的部分，新的剧集开始时才重新生成
+    struct FEpisodeConstants
+    {
+      uint64_t EpisodeId = 0u;
+      carla::rpc::MapInfo MapInfo;
+      std::vector<carla::rpc::ActorDefinition> ActorDefinitions;
+      /// msgpack 编码后的 ActorDefinitions 的哈希，客户端缓存的也是这些字节
+      std::string ActorDefinitionsHash;
+      std::vector<uint8_t> PackedActorDefinitions;
+    };
+
+    std::shared_ptr<const FEpisodeConstants> Constants;
+    carla::rpc::EpisodeInfo EpisodeInfo;
+    carla::rpc::EpisodeSettings Settings;
+    carla::rpc::WeatherParameters Weather;
+    bool bHasWeather = false;
+  };
+
+  /// 当前剧集的只读状态，第一个剧集开始之前为空；剧集结束后保留上一个剧集的状态，
+  /// 直到新的剧集发布自己的状态。只在持有 ReadOnlyStateMutex 时替换指针
+  std::shared_ptr<const FReadOnlyState> ReadOnlyState;
+
+  std::mutex ReadOnlyStateMutex;
+
+  /// 在游戏线程上重新生成只读状态，每帧以及修改了其中的状态的同步 RPC 之后调用
+  void PublishReadOnlyState();
+
+  std::shared_ptr<const FReadOnlyState> GetReadOnlyState()
+  {
+    std::lock_guard<std::mutex> Lock(ReadOnlyStateMutex);
+    return ReadOnlyState;
+  }
+
 private:
 
   void BindActions();
@@ -218,6 +518,13 @@ private:
 
 #define BIND_SYNC(name)   auto name = ServerBinder(# name, Server, true)
 #define BIND_ASYNC(name)  auto name = ServerBinder(# name, Server, false)
+// 只读的调用在 RPC 工作线程上执行，只能访问 GetReadOnlyState 返回的状态，不等待游戏线程
+#define BIND_READ_ONLY(name)  BIND_ASYNC(name)
+
+// 在 BIND_READ_ONLY 的处理函数中获取只读状态，第一个剧集开始之前返回错误
+#define REQUIRE_READ_ONLY_STATE(state)      \
+    const auto state = GetReadOnlyState(); \
+    if (state == nullptr) { RESPOND_ERROR("episode not ready"); }
 
 // =============================================================================
 // -- 绑定操作 -------------------------------------------------------------
@@ -335,6 +642,17 @@ void FCarlaServer::FPimpl::BindActions()
 
     return R<void>::Success();
   };
+
+  BIND_SYNC(preload_map) << [this](const std::string &map_name) -> R<bool>
+  {
+    REQUIRE_CARLA_EPISODE();
+    UCarlaGameInstance* GameInstance = UCarlaStatics::GetGameInstance(Episode->GetWorld());
+    if (!GameInstance)
+    {
+      RESPOND_ERROR("unable to find CARLA game instance");
+    }
+    return GameInstance->GetMapPreloader().PreloadMap(cr::ToFString(map_name));
+  };
 // 使用宏或模板函数绑定同步函数load_map_layer到下面的lambda表达式
   BIND_SYNC(load_map_layer) << [this](cr::MapLayer MapLayers) -> R<void>
   {
@@ -479,23 +797,31 @@ void FCarlaServer::FPimpl::BindActions()
 
   // ~~ 章节设置与信息 ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
-  BIND_SYNC(get_episode_info) << [this]() -> R<cr::EpisodeInfo>
+  BIND_READ_ONLY(get_episode_info) << [this]() -> R<cr::EpisodeInfo>
   {
-    REQUIRE_CARLA_EPISODE();
-    return cr::EpisodeInfo{Episode->GetId(), BroadcastStream.token()};
+    REQUIRE_READ_ONLY_STATE(State);
+    return State->EpisodeInfo;
   };
 
-  BIND_SYNC(get_map_info) << [this]() -> R<cr::MapInfo>
+  BIND_SYNC(get_episode_interest_token) << [this](
+      cr::EpisodeInterest Interest) -> R<carla::streaming::Token>
   {
     REQUIRE_CARLA_EPISODE();
-    ACarlaGameModeBase* GameMode = UCarlaStatics::GetGameMode(Episode->GetWorld());
-    const auto &SpawnPoints = Episode->GetRecommendedSpawnPoints();
-    FString FullMapPath = GameMode->GetFullMapPath();
-    FString MapDir = FullMapPath.RightChop(FullMapPath.Find("Content/", ESearchCase::CaseSensitive) + 8);
-    MapDir += "/" + Episode->GetMapName();
-    return cr::MapInfo{
-      cr::FromFString(MapDir),
-      MakeVectorFromTArray<cg::Transform>(SpawnPoints)};
+    UCarlaGameInstance *GameInstance = UCarlaStatics::GetGameInstance(Episode->GetWorld());
+    if (GameInstance == nullptr || GameInstance->GetCarlaEngine() == nullptr)
+    {
+      RESPOND_ERROR("unable to find CARLA engine");
+    }
+    // 与完整的剧集状态使用同一个流媒体服务器
+    return GameInstance->GetCarlaEngine()->GetWorldObserver().GetInterestToken(
+        Interest,
+        [this]() { return FDataMultiStream(GetControlStreamingServer().MakeStream()); });
+  };
+
+  BIND_READ_ONLY(get_map_info) << [this]() -> R<cr::MapInfo>
+  {
+    REQUIRE_READ_ONLY_STATE(State);
+    return State->Constants->MapInfo;
   };
 
   BIND_SYNC(get_map_data) << [this]() -> R<std::string>
@@ -504,6 +830,21 @@ void FCarlaServer::FPimpl::BindActions()
     return cr::FromLongFString(UOpenDrive::GetXODR(Episode->GetWorld()));
   };
 
+  BIND_SYNC(get_map_data_if_none_match) << [this](const std::string &hash) -> R<cr::CachedContent>
+  {
+    REQUIRE_CARLA_EPISODE();
+    const std::string XODR = cr::FromLongFString(UOpenDrive::GetXODR(Episode->GetWorld()));
+    const auto *Begin = reinterpret_cast<const uint8_t *>(XODR.data());
+    cr::CachedContent Result;
+    Result.hash = cr::CachedContent::ComputeHash(Begin, XODR.size());
+    Result.not_modified = (Result.hash == hash);
+    if (!Result.not_modified)
+    {
+      Result.content.assign(Begin, Begin + XODR.size());
+    }
+    return Result;
+  };
+
   BIND_SYNC(get_navigation_mesh) << [this]() -> R<std::vector<uint8_t>>
   {
     REQUIRE_CARLA_EPISODE();
@@ -560,10 +901,46 @@ void FCarlaServer::FPimpl::BindActions()
     return Result;
   };
 
-  BIND_SYNC(get_episode_settings) << [this]() -> R<cr::EpisodeSettings>
+  // 文件的大小和分块哈希，客户端据此分块下载。只读文件，不在游戏线程上执行
+  BIND_ASYNC(get_file_info) << [](const std::string &name) -> R<cr::FileInfo>
   {
-    REQUIRE_CARLA_EPISODE();
-    return cr::EpisodeSettings{Episode->GetSettings()};
+    FString Path;
+    cr::FileInfo Info;
+    if (!GetContentFilePath(name, Path) || !GetContentFileInfo(Path, Info))
+    {
+      RESPOND_ERROR_FSTRING(FString::Printf(TEXT("unable to read file %s"), UTF8_TO_TCHAR(name.c_str())));
+    }
+    return Info;
+  };
+
+  // 文件中从 offset 开始的 length 个字节，每个请求只读取这一块
+  BIND_ASYNC(request_file_chunk) << [](
+      const std::string &name,
+      uint64_t offset,
+      uint32_t length) -> R<std::vector<uint8_t>>
+  {
+    FString Path;
+    if (!GetContentFilePath(name, Path) || length > 16u * cr::FileInfo::DEFAULT_CHUNK_SIZE)
+    {
+      RESPOND_ERROR("invalid file chunk request");
+    }
+    TUniquePtr<IFileHandle> Handle(FPlatformFileManager::Get().GetPlatformFile().OpenRead(*Path));
+    if (!Handle.IsValid() || offset + length > static_cast<uint64_t>(Handle->Size()))
+    {
+      RESPOND_ERROR_FSTRING(FString::Printf(TEXT("unable to read file %s"), UTF8_TO_TCHAR(name.c_str())));
+    }
+    std::vector<uint8_t> Result(length);
+    if (!Handle->Seek(static_cast<int64>(offset)) || (length > 0u && !Handle->Read(Result.data(), length)))
+    {
+      RESPOND_ERROR_FSTRING(FString::Printf(TEXT("unable to read file %s"), UTF8_TO_TCHAR(name.c_str())));
+    }
+    return Result;
+  };
+
+  BIND_READ_ONLY(get_episode_settings) << [this]() -> R<cr::EpisodeSettings>
+  {
+    REQUIRE_READ_ONLY_STATE(State);
+    return State->Settings;
   };
 
   BIND_SYNC(set_episode_settings) << [this](
@@ -572,6 +949,10 @@ void FCarlaServer::FPimpl::BindActions()
     REQUIRE_CARLA_EPISODE();
     Episode->ApplySettings(settings);
     StreamingServer.SetSynchronousMode(settings.synchronous_mode);
+    if (ControlStreamingServer)
+    {
+      ControlStreamingServer->SetSynchronousMode(settings.synchronous_mode);
+    }
 
     ACarlaGameModeBase* GameMode = UCarlaStatics::GetGameMode(Episode->GetWorld());
     if (!GameMode)
@@ -584,13 +965,28 @@ void FCarlaServer::FPimpl::BindActions()
       LargeMap->ConsiderSpectatorAsEgo(settings.spectator_as_ego);
     }
 
+    // 之后的 get_episode_settings 不等到下一帧就能读到新的设置
+    PublishReadOnlyState();
     return FCarlaEngine::GetFrameCounter();
   };
 
-  BIND_SYNC(get_actor_definitions) << [this]() -> R<std::vector<cr::ActorDefinition>>
+  BIND_READ_ONLY(get_actor_definitions) << [this]() -> R<std::vector<cr::ActorDefinition>>
   {
-    REQUIRE_CARLA_EPISODE();
-    return MakeVectorFromTArray<cr::ActorDefinition>(Episode->GetActorDefinitions());
+    REQUIRE_READ_ONLY_STATE(State);
+    return State->Constants->ActorDefinitions;
+  };
+
+  BIND_READ_ONLY(get_actor_definitions_if_none_match) << [this](const std::string &hash) -> R<cr::CachedContent>
+  {
+    REQUIRE_READ_ONLY_STATE(State);
+    cr::CachedContent Result;
+    Result.hash = State->Constants->ActorDefinitionsHash;
+    Result.not_modified = (Result.hash == hash);
+    if (!Result.not_modified)
+    {
+      Result.content = State->Constants->PackedActorDefinitions;
+    }
+    return Result;
   };
 
   BIND_SYNC(get_spectator) << [this]() -> R<cr::Actor>
@@ -666,15 +1062,14 @@ void FCarlaServer::FPimpl::BindActions()
 
   // ~~ Weather ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
-  BIND_SYNC(get_weather_parameters) << [this]() -> R<cr::WeatherParameters>
+  BIND_READ_ONLY(get_weather_parameters) << [this]() -> R<cr::WeatherParameters>
   {
-    REQUIRE_CARLA_EPISODE();
-    auto *Weather = Episode->GetWeather();
-    if (Weather == nullptr)
+    REQUIRE_READ_ONLY_STATE(State);
+    if (!State->bHasWeather)
     {
       RESPOND_ERROR("internal error: unable to find weather");
     }
-    return Weather->GetCurrentWeather();
+    return State->Weather;
   };
 
   BIND_SYNC(set_weather_parameters) << [this](
@@ -687,6 +1082,7 @@ void FCarlaServer::FPimpl::BindActions()
       RESPOND_ERROR("internal error: unable to find weather");
     }
     Weather->ApplyWeather(weather);
+    PublishReadOnlyState();
     return R<void>::Success();
   };
   
@@ -735,6 +1131,122 @@ void FCarlaServer::FPimpl::BindActions()
     }
     return Result;
   };
+
+  // 按列返回多个参与者的属性，每列是一整块紧密排列的数据，客户端可以直接转为数组
+  BIND_SYNC(query_actors) << [this](
+      const std::vector<FCarlaActor::IdType> &ids,
+      const std::vector<std::string> &fields) -> R<cr::ActorQueryResult>
+  {
+    REQUIRE_CARLA_EPISODE();
+    constexpr float TO_METERS = 1e-2;
+    std::vector<FCarlaActor*> Actors;
+    Actors.reserve(ids.size());
+    for (auto &&Id : ids)
+    {
+      FCarlaActor* View = Episode->FindCarlaActor(Id);
+      if (View)
+      {
+        Actors.emplace_back(View);
+      }
+    }
+
+    cr::ActorQueryResult Result;
+    // 先预留空间，添加列时引用不会失效
+    Result.columns.reserve(fields.size() + 1u);
+    // 所有字段的元素都是4字节的float或uint32
+    auto AddColumn = [&](const std::string &Field, char Kind, uint32_t Width) -> cr::ActorQueryColumn &
+    {
+      Result.columns.emplace_back(Field, Kind, 4u, Width);
+      auto &Column = Result.columns.back();
+      Column.data.reserve(Actors.size() * Column.element_size * Width);
+      return Column;
+    };
+
+    static_assert(sizeof(FCarlaActor::IdType) == sizeof(uint32_t), "Invalid actor id size");
+    auto &IdColumn = AddColumn("id", 'u', 1u);
+    for (FCarlaActor* View : Actors)
+    {
+      IdColumn.Append(static_cast<uint32_t>(View->GetActorId()));
+    }
+
+    for (const auto &Field : fields)
+    {
+      if (Field == "transform")
+      {
+        auto &Column = AddColumn(Field, 'f', 6u);
+        for (FCarlaActor* View : Actors)
+        {
+          const cr::Transform Transform(View->GetActorGlobalTransform());
+          Column.Append(Transform.location.x);
+          Column.Append(Transform.location.y);
+          Column.Append(Transform.location.z);
+          Column.Append(Transform.rotation.pitch);
+          Column.Append(Transform.rotation.yaw);
+          Column.Append(Transform.rotation.roll);
+        }
+      }
+      else if (Field == "velocity")
+      {
+        auto &Column = AddColumn(Field, 'f', 3u);
+        for (FCarlaActor* View : Actors)
+        {
+          const FVector Velocity = TO_METERS * View->GetActorVelocity();
+          Column.Append(Velocity.X);
+          Column.Append(Velocity.Y);
+          Column.Append(Velocity.Z);
+        }
+      }
+      else if (Field == "angular_velocity")
+      {
+        auto &Column = AddColumn(Field, 'f', 3u);
+        for (FCarlaActor* View : Actors)
+        {
+          const FVector AngularVelocity = View->GetActorAngularVelocity();
+          Column.Append(AngularVelocity.X);
+          Column.Append(AngularVelocity.Y);
+          Column.Append(AngularVelocity.Z);
+        }
+      }
+      else if (Field == "bbox")
+      {
+        auto &Column = AddColumn(Field, 'f', 9u);
+        for (FCarlaActor* View : Actors)
+        {
+          const carla::geom::BoundingBox BoundingBox(View->GetActorInfo()->BoundingBox);
+          Column.Append(BoundingBox.location.x);
+          Column.Append(BoundingBox.location.y);
+          Column.Append(BoundingBox.location.z);
+          Column.Append(BoundingBox.extent.x);
+          Column.Append(BoundingBox.extent.y);
+          Column.Append(BoundingBox.extent.z);
+          Column.Append(BoundingBox.rotation.pitch);
+          Column.Append(BoundingBox.rotation.yaw);
+          Column.Append(BoundingBox.rotation.roll);
+        }
+      }
+      else if (Field == "light_state")
+      {
+        auto &Column = AddColumn(Field, 'u', 1u);
+        for (FCarlaActor* View : Actors)
+        {
+          FVehicleLightState LightState;
+          const uint32_t Flags =
+              View->GetVehicleLightState(LightState) == ECarlaServerResponse::Success ?
+              cr::VehicleLightState(LightState).GetLightStateAsValue() :
+              0u;
+          Column.Append(Flags);
+        }
+      }
+      else
+      {
+        return RespondError(
+            "query_actors",
+            "unknown field",
+            " Field: " + cr::ToFString(Field));
+      }
+    }
+    return Result;
+  };
 // 绑定同步函数spawn_actor到下面的lambda表达式
   BIND_SYNC(spawn_actor) << [this](
       cr::ActorDescription Description,// 对象描述，包含类型、属性等信息
@@ -850,6 +1362,35 @@ void FCarlaServer::FPimpl::BindActions()
     return true;
   };
 
+  BIND_SYNC(set_actor_pool_size) << [this](uint32_t size) -> R<void>
+  {
+    REQUIRE_CARLA_EPISODE();
+    Episode->SetActorPoolSize(size);
+    return R<void>::Success();
+  };
+
+  BIND_SYNC(save_snapshot) << [this]() -> R<uint64_t>
+  {
+    REQUIRE_CARLA_EPISODE();
+    return Episode->SaveSnapshot();
+  };
+
+  BIND_SYNC(restore_snapshot) << [this](uint64_t snapshot_id) -> R<void>
+  {
+    REQUIRE_CARLA_EPISODE();
+    if (!Episode->RestoreSnapshot(snapshot_id))
+    {
+      RESPOND_ERROR("unable to restore snapshot: not found");
+    }
+    return R<void>::Success();
+  };
+
+  BIND_SYNC(remove_snapshot) << [this](uint64_t snapshot_id) -> R<bool>
+  {
+    REQUIRE_CARLA_EPISODE();
+    return Episode->RemoveSnapshot(snapshot_id);
+  };
+
   BIND_SYNC(console_command) << [this](std::string cmd) -> R<bool>
   {
     REQUIRE_CARLA_EPISODE();
@@ -878,7 +1419,8 @@ void FCarlaServer::FPimpl::BindActions()
     }
 
     // collision sensor always in primary server in multi-gpu
-    FString Desc = Episode->GetActorDescriptionFromStream(sensor_id);
+    const FActorInfo *Info = Episode->FindActorInfoFromStream(sensor_id);
+    FString Desc = Info != nullptr ? Info->Description.Id : FString("");
     if (Desc == "" || Desc == "sensor.other.collision")
     {
       ForceInPrimary = true;
@@ -886,9 +1428,10 @@ void FCarlaServer::FPimpl::BindActions()
 
     if (SecondaryServer->HasClientsConnected() && !ForceInPrimary)
     {
-      // multi-gpu
-      UE_LOG(LogCarla, Log, TEXT("Sensor %d '%s' created in secondary server"), sensor_id, *Desc);
-      return SecondaryServer->GetCommander().GetToken(sensor_id);
+      // multi-gpu, placed by cost and load of the secondary servers
+      const float Cost = GetSensorCost(Info->Description);
+      UE_LOG(LogCarla, Log, TEXT("Sensor %d '%s' (cost %.2f) created in secondary server"), sensor_id, *Desc, Cost);
+      return SecondaryServer->GetCommander().GetToken(sensor_id, Cost, GetSensorGroup(*Episode, sensor_id));
     }
     else
     {
@@ -898,6 +1441,27 @@ void FCarlaServer::FPimpl::BindActions()
     }
   };
 
+  BIND_SYNC(get_secondary_telemetry) << [this]() -> R<std::vector<cr::SecondaryTelemetry>>
+  {
+    // 不是多GPU模式时没有次级服务器，返回空列表
+    if (SecondaryServer == nullptr)
+    {
+      return std::vector<cr::SecondaryTelemetry>{};
+    }
+    return SecondaryServer->GetTelemetry();
+  };
+
+  BIND_SYNC(get_server_profile) << [this](bool reset) -> R<cr::ServerProfile>
+  {
+    REQUIRE_CARLA_EPISODE();
+    UCarlaGameInstance* GameInstance = UCarlaStatics::GetGameInstance(Episode->GetWorld());
+    if (!GameInstance)
+    {
+      RESPOND_ERROR("unable to find CARLA game instance");
+    }
+    return GameInstance->GetCarlaEngine()->GetServerProfile(reset);
+  };
+
   BIND_SYNC(enable_sensor_for_ros) << [this](carla::streaming::detail::stream_id_type sensor_id) ->
                                  R<void>
   {
@@ -1046,6 +1610,7 @@ BIND_SYNC(is_sensor_enabled_for_ros) << [this](carla::streaming::detail::stream_
 
     CarlaActor->SetActorGlobalLocation(
         Location, ETeleportType::TeleportPhysics);
+    KinematicVehicles.Teleport(ActorId, CarlaActor->GetActorGlobalTransform());
     return R<void>::Success();
   };
 
@@ -1065,6 +1630,28 @@ BIND_SYNC(is_sensor_enabled_for_ros) << [this](carla::streaming::detail::stream_
 
     CarlaActor->SetActorGlobalTransform(
         Transform, ETeleportType::TeleportPhysics);
+    KinematicVehicles.Teleport(ActorId, CarlaActor->GetActorGlobalTransform());
+    return R<void>::Success();
+  };
+
+  BIND_SYNC(set_vehicle_kinematic_target) << [this](
+      cr::ActorId ActorId,
+      cr::Transform Transform,
+      cr::Vector3D Velocity) -> R<void>
+  {
+    REQUIRE_CARLA_EPISODE();
+    ECarlaServerResponse Response = KinematicVehicles.SetTarget(
+        *Episode,
+        ActorId,
+        Transform,
+        Velocity.ToCentimeters().ToFVector());
+    if (Response != ECarlaServerResponse::Success)
+    {
+      return RespondError(
+          "set_vehicle_kinematic_target",
+          Response,
+          " Actor Id: " + FString::FromInt(ActorId));
+    }
     return R<void>::Success();
   };
 
@@ -1098,6 +1685,71 @@ BIND_SYNC(is_sensor_enabled_for_ros) << [this](carla::streaming::detail::stream_
     }
     return R<void>::Success();
   };
+
+  // 服务器上的行人人群，见 FWalkerCrowd
+  BIND_SYNC(start_server_walker) << [this](cr::ActorId ActorId) -> R<void>
+  {
+    REQUIRE_CARLA_EPISODE();
+    FCarlaActor* CarlaActor = Episode->FindCarlaActor(ActorId);
+    if (!CarlaActor)
+    {
+      return RespondError(
+          "start_server_walker",
+          ECarlaServerResponse::ActorNotFound,
+          " Actor Id: " + FString::FromInt(ActorId));
+    }
+    if (CarlaActor->GetActorType() != FCarlaActor::ActorType::Walker)
+    {
+      return RespondError(
+          "start_server_walker",
+          ECarlaServerResponse::NotAWalker,
+          " Actor Id: " + FString::FromInt(ActorId));
+    }
+    if (!Episode->GetWalkerCrowd().AddWalker(*Episode, *CarlaActor))
+    {
+      RESPOND_ERROR("start_server_walker: unable to add the walker to the crowd, the map may have no navigation mesh");
+    }
+    return R<void>::Success();
+  };
+
+  BIND_SYNC(stop_server_walker) << [this](cr::ActorId ActorId) -> R<void>
+  {
+    REQUIRE_CARLA_EPISODE();
+    Episode->GetWalkerCrowd().RemoveWalker(ActorId);
+    return R<void>::Success();
+  };
+
+  BIND_SYNC(set_server_walker_target) << [this](
+      cr::ActorId ActorId,
+      cr::Location Target) -> R<bool>
+  {
+    REQUIRE_CARLA_EPISODE();
+    return Episode->GetWalkerCrowd().SetWalkerTarget(ActorId, Target);
+  };
+
+  BIND_SYNC(set_server_walker_max_speed) << [this](
+      cr::ActorId ActorId,
+      float MaxSpeed) -> R<bool>
+  {
+    REQUIRE_CARLA_EPISODE();
+    return Episode->GetWalkerCrowd().SetWalkerMaxSpeed(ActorId, MaxSpeed);
+  };
+
+  // 返回值中的 bool 表示是否找到了位置
+  BIND_SYNC(get_server_walker_random_location) << [this]() -> R<std::pair<bool, cr::Location>>
+  {
+    REQUIRE_CARLA_EPISODE();
+    cr::Location Location;
+    const bool Found = Episode->GetWalkerCrowd().GetRandomLocation(*Episode, Location);
+    return std::make_pair(Found, Location);
+  };
+
+  BIND_SYNC(set_server_pedestrians_cross_factor) << [this](float Percentage) -> R<void>
+  {
+    REQUIRE_CARLA_EPISODE();
+    Episode->GetWalkerCrowd().SetPedestriansCrossFactor(Percentage);
+    return R<void>::Success();
+  };
 // 使用BIND_SYNC宏绑定一个名为set_actor_target_velocity的同步操作
 // 该操作接受一个actor的ID（cr::ActorId）和一个三维向量（cr::Vector3D）作为参数
 // 并返回一个R<void>类型的响应对象，表示操作的结果
@@ -1923,6 +2575,10 @@ BIND_SYNC(is_sensor_enabled_for_ros) << [this](carla::streaming::detail::stream_
           ECarlaServerResponse::ActorNotFound,
           " Actor Id: " + FString::FromInt(ActorId));
     }
+    if (bEnabled)
+    {
+      KinematicVehicles.Remove(*Episode, ActorId);
+    }
     ECarlaServerResponse Response =
         CarlaActor->SetActorSimulatePhysics(bEnabled);
     if (Response != ECarlaServerResponse::Success)
@@ -2251,6 +2907,111 @@ BIND_SYNC(is_sensor_enabled_for_ros) << [this](carla::streaming::detail::stream_
     return R<void>::Success();
   };
 
+  // 一次调用设置多个行人的骨骼姿态，返回没有应用的行人（不存在或不是行人）
+  BIND_SYNC(set_walkers_bones_transform) << [this](
+      const cr::WalkerBonePoses &Poses) -> R<std::vector<cr::ActorId>>
+  {
+    REQUIRE_CARLA_EPISODE();
+    const size_t BoneCount = Poses.bone_names.size();
+    for (const auto &Pose : Poses.poses)
+    {
+      if (Pose.rotations.size() != BoneCount * cr::WalkerBonePose::ROTATION_SIZE ||
+          Pose.locations.size() != BoneCount * cr::WalkerBonePose::LOCATION_SIZE)
+      {
+        RESPOND_ERROR_FSTRING(FString::Printf(
+            TEXT("unable to set bones transform: pose of walker %u does not have %d bones"),
+            Pose.walker,
+            static_cast<int32>(BoneCount)));
+      }
+    }
+
+    // 所有行人共用骨骼名到索引的映射
+    TMap<FName, int32> BoneIndices;
+    BoneIndices.Reserve(BoneCount);
+    for (size_t i = 0u; i < BoneCount; ++i)
+    {
+      BoneIndices.Add(FName(*cr::ToFString(Poses.bone_names[i])), static_cast<int32>(i));
+    }
+
+    std::vector<cr::ActorId> Failed;
+    TArray<FTransform> Transforms;
+    Transforms.SetNum(BoneCount);
+    for (const auto &Pose : Poses.poses)
+    {
+      FCarlaActor* CarlaActor = Episode->FindCarlaActor(Pose.walker);
+      if (!CarlaActor)
+      {
+        Failed.emplace_back(Pose.walker);
+        continue;
+      }
+      const float *Rotation = Pose.rotations.data();
+      const float *Location = Pose.locations.data();
+      for (size_t i = 0u; i < BoneCount; ++i)
+      {
+        // 位置从米转换为厘米
+        Transforms[i] = FTransform(
+            FQuat(Rotation[0], Rotation[1], Rotation[2], Rotation[3]),
+            FVector(Location[0], Location[1], Location[2]) * 100.0f);
+        Rotation += cr::WalkerBonePose::ROTATION_SIZE;
+        Location += cr::WalkerBonePose::LOCATION_SIZE;
+      }
+      if (CarlaActor->SetBonesLocalTransforms(BoneIndices, Transforms) != ECarlaServerResponse::Success)
+      {
+        Failed.emplace_back(Pose.walker);
+      }
+    }
+    return Failed;
+  };
+
+  // 一次调用取得多个行人的骨骼姿态，@a BoneNames 为空时使用第一个行人的所有骨骼；
+  // 不存在或不是行人的参与者的姿态为空
+  BIND_SYNC(get_walkers_bones_transform) << [this](
+      const std::vector<cr::ActorId> &Walkers,
+      const std::vector<std::string> &BoneNames) -> R<cr::WalkerBonePoses>
+  {
+    REQUIRE_CARLA_EPISODE();
+    TArray<FName> Names;
+    Names.Reserve(BoneNames.size());
+    for (const auto &BoneName : BoneNames)
+    {
+      Names.Add(FName(*cr::ToFString(BoneName)));
+    }
+
+    cr::WalkerBonePoses Result;
+    Result.poses.reserve(Walkers.size());
+    TArray<FTransform> Transforms;
+    for (cr::ActorId Walker : Walkers)
+    {
+      Result.poses.emplace_back();
+      auto &Pose = Result.poses.back();
+      Pose.walker = Walker;
+      FCarlaActor* CarlaActor = Episode->FindCarlaActor(Walker);
+      if (!CarlaActor ||
+          CarlaActor->GetBonesLocalTransforms(Names, Transforms) != ECarlaServerResponse::Success ||
+          Transforms.Num() != Names.Num())
+      {
+        continue;
+      }
+      Pose.rotations.reserve(Transforms.Num() * cr::WalkerBonePose::ROTATION_SIZE);
+      Pose.locations.reserve(Transforms.Num() * cr::WalkerBonePose::LOCATION_SIZE);
+      for (const FTransform &Transform : Transforms)
+      {
+        const FQuat Rotation = Transform.GetRotation();
+        // 位置从厘米转换为米
+        const FVector Location = Transform.GetLocation() / 100.0f;
+        Pose.rotations.insert(Pose.rotations.end(), {Rotation.X, Rotation.Y, Rotation.Z, Rotation.W});
+        Pose.locations.insert(Pose.locations.end(), {Location.X, Location.Y, Location.Z});
+      }
+    }
+
+    Result.bone_names.reserve(Names.Num());
+    for (const FName &Name : Names)
+    {
+      Result.bone_names.emplace_back(cr::FromFString(Name.ToString()));
+    }
+    return Result;
+  };
+
   BIND_SYNC(set_actor_autopilot) << [this](
       cr::ActorId ActorId,
       bool bEnabled) -> R<void>
@@ -2611,6 +3372,86 @@ BIND_SYNC(is_sensor_enabled_for_ros) << [this](carla::streaming::detail::stream_
     return R<void>::Success();
   };
 
+  BIND_SYNC(apply_traffic_light_plans) << [this]
+      (const std::vector<cr::TrafficLightGroupPlan> &Plans) -> R<void>
+  {
+    REQUIRE_CARLA_EPISODE();
+    auto* GameMode = UCarlaStatics::GetGameMode(Episode->GetWorld());
+    if (!GameMode)
+    {
+      RESPOND_ERROR("unable to find CARLA game mode");
+    }
+
+    // 先检查所有方案，任一无效时不应用任何方案
+    auto FindController = [this](cr::ActorId ActorId, ECarlaServerResponse &Response)
+        -> UTrafficLightController*
+    {
+      FCarlaActor* CarlaActor = Episode->FindCarlaActor(ActorId);
+      if (!CarlaActor)
+      {
+        Response = ECarlaServerResponse::ActorNotFound;
+        return nullptr;
+      }
+      if (CarlaActor->IsDormant())
+      {
+        Response = ECarlaServerResponse::FunctionNotAvailiableWhenDormant;
+        return nullptr;
+      }
+      auto* TrafficLight = Cast<ATrafficLightBase>(CarlaActor->GetActor());
+      auto* Component = TrafficLight ? TrafficLight->GetTrafficLightComponent() : nullptr;
+      auto* Controller = Component ? Component->GetController() : nullptr;
+      if (!Controller || !Controller->GetGroup())
+      {
+        Response = ECarlaServerResponse::NotATrafficLight;
+        return nullptr;
+      }
+      return Controller;
+    };
+
+    TArray<FTrafficLightGroupPlan> GroupPlans;
+    GroupPlans.Reserve(Plans.size());
+    for (const auto &Plan : Plans)
+    {
+      ECarlaServerResponse Response = ECarlaServerResponse::Success;
+      UTrafficLightController* GroupController = FindController(Plan.traffic_light, Response);
+      if (!GroupController)
+      {
+        return RespondError(
+            "apply_traffic_light_plans",
+            Response,
+            " Actor Id: " + FString::FromInt(Plan.traffic_light));
+      }
+      FTrafficLightGroupPlan GroupPlan;
+      GroupPlan.Group = GroupController->GetGroup();
+      GroupPlan.bRestart = Plan.restart;
+      GroupPlan.Offset = Plan.offset;
+      GroupPlan.bFrozen = Plan.frozen;
+      for (const auto &Timing : Plan.timings)
+      {
+        UTrafficLightController* Controller = FindController(Timing.traffic_light, Response);
+        if (!Controller)
+        {
+          return RespondError(
+              "apply_traffic_light_plans",
+              Response,
+              " Actor Id: " + FString::FromInt(Timing.traffic_light));
+        }
+        if (Controller->GetGroup() != GroupPlan.Group)
+        {
+          RESPOND_ERROR_FSTRING(FString::Printf(
+              TEXT("unable to apply traffic light plan: traffic light %u is not in the group of traffic light %u"),
+              Timing.traffic_light,
+              Plan.traffic_light));
+        }
+        GroupPlan.Timings.Add({Controller, Timing.green_time, Timing.yellow_time, Timing.red_time});
+      }
+      GroupPlans.Add(MoveTemp(GroupPlan));
+    }
+
+    GameMode->GetTrafficLightManager()->ApplyGroupPlans(GroupPlans);
+    return R<void>::Success();
+  };
+
   BIND_SYNC(get_vehicle_light_states) << [this]() -> R<cr::VehicleLightStateList>
   {
     REQUIRE_CARLA_EPISODE();
@@ -2619,7 +3460,7 @@ BIND_SYNC(is_sensor_enabled_for_ros) << [this](carla::streaming::detail::stream_
     auto It = Episode->GetActorRegistry().begin();
     for (; It != Episode->GetActorRegistry().end(); ++It)
     {
-      const FCarlaActor& View = *(It.Value().Get());
+      const FCarlaActor& View = *(It->Value.Get());
       if (View.GetActorType() == FCarlaActor::ActorType::Vehicle)
       {
         if(View.IsDormant())
@@ -2714,6 +3555,13 @@ BIND_SYNC(is_sensor_enabled_for_ros) << [this](carla::streaming::detail::stream_
     }
   };
 
+  // 上一帧车辆进入和离开交通标志触发框的事件，见 FSignTriggerVolumes
+  BIND_SYNC(get_sign_trigger_events) << [this]() -> R<std::vector<cr::SignTriggerEvent>>
+  {
+    REQUIRE_CARLA_EPISODE();
+    return Episode->GetSignTriggerVolumes().GetEvents();
+  };
+
   // ~~ GBuffer tokens ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
   BIND_SYNC(get_gbuffer_token) << [this](const cr::ActorId ActorId, uint32_t GBufferId) -> R<std::vector<unsigned char>>
   {
@@ -2815,6 +3663,51 @@ BIND_SYNC(is_sensor_enabled_for_ros) << [this](carla::streaming::detail::stream_
     }
   };
 
+  BIND_SYNC(get_gbuffer_multipart_token) << [this](const cr::ActorId ActorId, uint64_t TextureMask) -> R<std::vector<unsigned char>>
+  {
+    REQUIRE_CARLA_EPISODE();
+    FCarlaActor* CarlaActor = Episode->FindCarlaActor(ActorId);
+    if(!CarlaActor)
+    {
+      return RespondError(
+          "get_gbuffer_multipart_token",
+          ECarlaServerResponse::ActorNotFound,
+          " Actor Id: " + FString::FromInt(ActorId));
+    }
+    if (CarlaActor->IsDormant())
+    {
+      return RespondError(
+          "get_gbuffer_multipart_token",
+          ECarlaServerResponse::FunctionNotAvailiableWhenDormant,
+          " Actor Id: " + FString::FromInt(ActorId));
+    }
+    ASceneCaptureSensor* Sensor = Cast<ASceneCaptureSensor>(CarlaActor->GetActor());
+    if (!Sensor)
+    {
+      return RespondError(
+        "get_gbuffer_multipart_token",
+        ECarlaServerResponse::ActorTypeMismatch,
+        " Actor Id: " + FString::FromInt(ActorId));
+    }
+    if ((TextureMask >> FGBufferRequest::TextureCount) != 0u)
+    {
+      UE_LOG(LogCarla, Error, TEXT("Requested invalid GBuffer mask %llu"), TextureMask);
+      return {};
+    }
+    if (!Sensor->CameraGBuffers.Multipart.Stream.IsStreamReady())
+    {
+      return RespondError(
+        "get_gbuffer_multipart_token",
+        ECarlaServerResponse::FunctionNotSupported,
+        " Actor Id: " + FString::FromInt(ActorId));
+    }
+
+    // A zero mask stops packing the textures of this sensor.
+    Sensor->CameraGBuffers.Multipart.TextureMask = TextureMask;
+    const auto &Token = Sensor->CameraGBuffers.Multipart.GetToken();
+    return std::vector<unsigned char>(std::begin(Token.data), std::end(Token.data));
+  };
+
   // ~~ Logging and playback ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
   BIND_SYNC(start_recorder) << [this](std::string name, bool AdditionalData) -> R<std::string>
@@ -2823,6 +3716,30 @@ BIND_SYNC(is_sensor_enabled_for_ros) << [this](carla::streaming::detail::stream_
     return R<std::string>(Episode->StartRecorder(name, AdditionalData));
   };
 
+  BIND_SYNC(start_recorder_with_filter) << [this](
+      std::string name,
+      bool AdditionalData,
+      cr::RecorderFilter Filter) -> R<std::string>
+  {
+    REQUIRE_CARLA_EPISODE();
+    return R<std::string>(Episode->StartRecorder(name, AdditionalData, Filter));
+  };
+
+  BIND_SYNC(start_recorder_stream) << [this](
+      bool AdditionalData,
+      cr::RecorderFilter Filter) -> R<carla::streaming::Token>
+  {
+    REQUIRE_CARLA_EPISODE();
+    // 与剧集状态使用同一个流媒体服务器，客户端收到token后订阅
+    auto Stream = GetControlStreamingServer().MakeStream();
+    const auto Token = Stream.token();
+    if (!Episode->StartRecorderStream(std::move(Stream), AdditionalData, Filter))
+    {
+      RESPOND_ERROR("unable to start the recorder");
+    }
+    return Token;
+  };
+
   BIND_SYNC(stop_recorder) << [this]() -> R<void>
   {
     REQUIRE_CARLA_EPISODE();
@@ -2880,6 +3797,16 @@ BIND_SYNC(is_sensor_enabled_for_ros) << [this](carla::streaming::detail::stream_
         replay_sensors));
   };
 
+  BIND_SYNC(benchmark_replayer) << [this](
+      std::string name,
+      double tolerance) -> R<std::string>
+  {
+    REQUIRE_CARLA_EPISODE();
+    return R<std::string>(Episode->GetRecorder()->BenchmarkReplayer(
+        name,
+        tolerance));
+  };
+
   BIND_SYNC(set_replayer_time_factor) << [this](double time_factor) -> R<void>
   {
     REQUIRE_CARLA_EPISODE();
@@ -2920,20 +3847,48 @@ BIND_SYNC(is_sensor_enabled_for_ros) << [this](carla::streaming::detail::stream_
     return R<void>::Success();
   };
 
+  BIND_SYNC(draw_debug_shape_batches) << [this](
+      std::string client,
+      const std::vector<cr::DebugShapeBatch> &batches) -> R<void>
+  {
+    REQUIRE_CARLA_EPISODE();
+    auto *World = Episode->GetWorld();
+    check(World != nullptr);
+    DebugShapeBatches.Draw(*World, FString(client.c_str()), batches);
+    return R<void>::Success();
+  };
+
+  BIND_SYNC(clear_debug_shape_batches) << [this](std::string client) -> R<void>
+  {
+    REQUIRE_CARLA_EPISODE();
+    DebugShapeBatches.Clear(FString(client.c_str()));
+    return R<void>::Success();
+  };
+
   // ~~ Apply commands in batch ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
   using C = cr::Command;
   using CR = cr::CommandResponse;
   using ActorId = carla::ActorId;
 
-  auto parse_result = [](ActorId id, const auto &response) {
-    return response.HasError() ? CR{response.GetError()} : CR{id};
-  };
+  // 把每条命令的执行结果转换为 CommandResponse
+  auto build_response = carla::Functional::MakeOverload(
+      [](ActorId id, const auto &response) -> CR {
+        return response.HasError() ? CR{response.GetError()} : CR{id};
+      },
+      [](const auto &response) -> CR { return response; });
 
-#define MAKE_RESULT(operation) return parse_result(c.actor, operation);
+  // apply_batch 的响应被客户端忽略时只执行命令，不构造 CommandResponse
+  auto ignore_response = [](const auto &...) {};
 
-  auto command_visitor = carla::Functional::MakeRecursiveOverload(
-      [=](auto self, const C::SpawnActor &c) -> CR {
+#define MAKE_RESULT(operation) return parse(c.actor, operation);
+
+  // 执行批处理命令的访问器，@a parse 决定每条命令返回的结果
+  auto make_command_visitor = [=](auto parse) {
+    // SpawnActor 递归地执行 do_after 中的命令，返回类型必须显式给出
+    using result_type = decltype(parse(ActorId{0u}, R<void>::Success()));
+    return carla::Functional::MakeRecursiveOverload(
+      [=](auto self, const C::SpawnActor &c) -> result_type {
         auto result = c.parent.has_value() ?
         spawn_actor_with_parent(
             c.description,
@@ -2942,9 +3897,10 @@ BIND_SYNC(is_sensor_enabled_for_ros) << [this](carla::streaming::detail::stream_
             cr::AttachmentType::Rigid,
             c.socket_name) :
         spawn_actor(c.description, c.transform);
+        ActorId id = 0u;
         if (!result.HasError())
         {
-          ActorId id = result.Get().id;
+          id = result.Get().id;
           auto set_id = carla::Functional::MakeOverload(
               [](C::SpawnActor &) {},
               [](C::ConsoleCommand &) {},
@@ -2954,9 +3910,8 @@ BIND_SYNC(is_sensor_enabled_for_ros) << [this](carla::streaming::detail::stream_
             boost::variant2::visit(set_id, command.command);
             boost::variant2::visit(self, command.command);
           }
-          return id;
         }
-        return result.GetError();
+        return parse(id, result);
       },
       [=](auto, const C::DestroyActor &c) {         MAKE_RESULT(destroy_actor(c.actor)); },
       [=](auto, const C::ApplyVehicleControl &c) {  MAKE_RESULT(apply_control_to_vehicle(c.actor, c.control)); },
@@ -2979,10 +3934,15 @@ BIND_SYNC(is_sensor_enabled_for_ros) << [this](carla::streaming::detail::stream_
 //      [=](auto, const C::OpenVehicleDoor &c) {      MAKE_RESULT(open_vehicle_door(c.actor, c.door_idx)); },
 //      [=](auto, const C::CloseVehicleDoor &c) {     MAKE_RESULT(close_vehicle_door(c.actor, c.door_idx)); },
       [=](auto, const C::ApplyWalkerState &c) {     MAKE_RESULT(set_walker_state(c.actor, c.transform, c.speed)); },
-      [=](auto, const C::ConsoleCommand& c) -> CR {       return console_command(c.cmd); },
+      [=](auto, const C::ConsoleCommand& c) {       return parse(console_command(c.cmd)); },
       [=](auto, const C::SetTrafficLightState& c) { MAKE_RESULT(set_traffic_light_state(c.actor, c.traffic_light_state)); },
-      [=](auto, const C::ApplyLocation& c)        { MAKE_RESULT(set_actor_location(c.actor, c.location)); }
-  );
+      [=](auto, const C::ApplyLocation& c)        { MAKE_RESULT(set_actor_location(c.actor, c.location)); },
+      [=](auto, const C::ApplyKinematicTarget& c) { MAKE_RESULT(set_vehicle_kinematic_target(c.actor, c.transform, c.velocity)); }
+    );
+  };
+
+  auto command_visitor = make_command_visitor(build_response);
+  auto command_visitor_ignoring_response = make_command_visitor(ignore_response);
 
 #undef MAKE_RESULT
 
@@ -2990,11 +3950,25 @@ BIND_SYNC(is_sensor_enabled_for_ros) << [this](carla::streaming::detail::stream_
       const std::vector<cr::Command> &commands,
       bool do_tick_cue)
   {
+    TRACE_CPUPROFILER_EVENT_SCOPE(ApplyBatch);
+    BatchCommandCount += static_cast<uint32>(commands.size());
     std::vector<CR> result;
-    result.reserve(commands.size());
-    for (const auto &command : commands)
+    // 客户端用 apply_batch 而非 apply_batch_sync 时不需要响应，
+    // 只执行命令而不构造响应
+    if (carla::rpc::Server::IsResponseIgnored())
+    {
+      for (const auto &command : commands)
+      {
+        boost::variant2::visit(command_visitor_ignoring_response, command.command);
+      }
+    }
+    else
     {
-      result.emplace_back(boost::variant2::visit(command_visitor, command.command));
+      result.reserve(commands.size());
+      for (const auto &command : commands)
+      {
+        result.emplace_back(boost::variant2::visit(command_visitor, command.command));
+      }
     }
     if (do_tick_cue)
     {
@@ -3003,6 +3977,57 @@ BIND_SYNC(is_sensor_enabled_for_ros) << [this](carla::streaming::detail::stream_
     return result;
   };
 
+  ApplyCommand = [=](const cr::Command &command) -> CR {
+    return boost::variant2::visit(command_visitor, command.command);
+  };
+
+  // 命令不在这次调用中执行，而是排队后由游戏线程每帧按 time_budget（秒）执行
+  // 一部分，避免大量生成参与者时卡住一帧。返回的编号用于查询进度和结果
+  BIND_SYNC(spawn_batch) << [this](
+      std::vector<cr::Command> commands,
+      double time_budget) -> R<uint64_t>
+  {
+    REQUIRE_CARLA_EPISODE();
+    FSpawnBatch Batch;
+    Batch.Ticket = NextSpawnBatch++;
+    Batch.TimeBudget = std::max(time_budget, 0.0);
+    Batch.Rejected = FindOverlappingSpawns(commands);
+    Batch.Responses.resize(commands.size());
+    const CR Collision{cr::ResponseError(carla::rpc::FromFString(
+        FActorSpawnResult::StatusToString(EActorSpawnResultStatus::Collision)))};
+    for (size_t i = 0u; i < commands.size(); ++i)
+    {
+      if (Batch.Rejected[i])
+      {
+        Batch.Responses[i] = Collision;
+      }
+    }
+    Batch.Commands = std::move(commands);
+    const uint64_t Ticket = Batch.Ticket;
+    SpawnBatches.emplace_back(std::move(Batch));
+    return Ticket;
+  };
+
+  BIND_SYNC(get_spawn_batch_status) << [this](uint64_t ticket) -> R<cr::SpawnBatchStatus>
+  {
+    auto It = std::find_if(SpawnBatches.begin(), SpawnBatches.end(),
+        [ticket](const FSpawnBatch &Batch) { return Batch.Ticket == ticket; });
+    if (It == SpawnBatches.end())
+    {
+      RESPOND_ERROR("unknown spawn batch");
+    }
+    cr::SpawnBatchStatus Status;
+    Status.processed = static_cast<uint32_t>(std::min(It->Next, It->Commands.size()));
+    Status.total = static_cast<uint32_t>(It->Commands.size());
+    Status.done = It->IsDone();
+    if (Status.done)
+    {
+      Status.responses = std::move(It->Responses);
+      SpawnBatches.erase(It);
+    }
+    return Status;
+  };
+
   // ~~ Light Subsystem ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
   BIND_SYNC(query_lights_state) << [this](std::string client) -> R<std::vector<cr::LightState>>
@@ -3017,6 +4042,19 @@ BIND_SYNC(is_sensor_enabled_for_ros) << [this](carla::streaming::detail::stream_
     return result;
   };
 
+  BIND_SYNC(query_lights_state_changes) << [this]
+    (std::string client, uint64_t since_version) -> R<cr::LightStateChanges>
+  {
+    REQUIRE_CARLA_EPISODE();
+    cr::LightStateChanges result;
+    auto *World = Episode->GetWorld();
+    if(World) {
+      UCarlaLightSubsystem* CarlaLightSubsystem = World->GetSubsystem<UCarlaLightSubsystem>();
+      result = CarlaLightSubsystem->GetLightChanges(FString(client.c_str()), since_version);
+    }
+    return result;
+  };
+
   BIND_SYNC(update_lights_state) << [this]
     (std::string client, const std::vector<cr::LightState>& lights, bool discard_client) -> R<void>
   {
@@ -3093,6 +4131,98 @@ BIND_SYNC(is_sensor_enabled_for_ros) << [this](carla::streaming::detail::stream_
 #undef RESPOND_ERROR
 #undef CARLA_ENSURE_GAME_THREAD
 
+void FCarlaServer::FPimpl::ProcessSpawnBatches()
+{
+  if (Episode == nullptr || !ApplyCommand)
+  {
+    return;
+  }
+  TRACE_CPUPROFILER_EVENT_SCOPE_STR(__FUNCTION__);
+  const double Start = FPlatformTime::Seconds();
+  bool bAnyApplied = false;
+  for (FSpawnBatch &Batch : SpawnBatches)
+  {
+    while (!Batch.IsDone())
+    {
+      if (bAnyApplied && FPlatformTime::Seconds() - Start >= Batch.TimeBudget)
+      {
+        return;
+      }
+      const size_t Index = Batch.Next++;
+      if (!Batch.Rejected[Index])
+      {
+        Batch.Responses[Index] = ApplyCommand(Batch.Commands[Index]);
+        bAnyApplied = true;
+      }
+    }
+  }
+}
+
+void FCarlaServer::FPimpl::AbortSpawnBatches(const std::string &Reason)
+{
+  for (FSpawnBatch &Batch : SpawnBatches)
+  {
+    for (; !Batch.IsDone(); ++Batch.Next)
+    {
+      Batch.Responses[Batch.Next] = carla::rpc::CommandResponse{carla::rpc::ResponseError(Reason)};
+    }
+  }
+}
+
+void FCarlaServer::FPimpl::PublishReadOnlyState()
+{
+  TRACE_CPUPROFILER_EVENT_SCOPE_STR(__FUNCTION__);
+  CARLA_ENSURE_GAME_THREAD();
+  namespace cr = carla::rpc;
+  if (Episode == nullptr)
+  {
+    // 加载地图期间保留上一个剧集的状态，客户端轮询 get_episode_info 时读到旧的剧集ID，
+    // 直到新的剧集开始，而不是收到错误
+    return;
+  }
+
+  auto State = std::make_shared<FReadOnlyState>();
+  {
+    std::lock_guard<std::mutex> Lock(ReadOnlyStateMutex);
+    if ((ReadOnlyState != nullptr) && (ReadOnlyState->Constants->EpisodeId == Episode->GetId()))
+    {
+      State->Constants = ReadOnlyState->Constants;
+    }
+  }
+  if (State->Constants == nullptr)
+  {
+    auto Constants = std::make_shared<FReadOnlyState::FEpisodeConstants>();
+    Constants->EpisodeId = Episode->GetId();
+    FString MapDir;
+    ACarlaGameModeBase* GameMode = UCarlaStatics::GetGameMode(Episode->GetWorld());
+    if (GameMode != nullptr)
+    {
+      FString FullMapPath = GameMode->GetFullMapPath();
+      MapDir = FullMapPath.RightChop(FullMapPath.Find("Content/", ESearchCase::CaseSensitive) + 8);
+    }
+    MapDir += "/" + Episode->GetMapName();
+    Constants->MapInfo = cr::MapInfo{
+      cr::FromFString(MapDir),
+      MakeVectorFromTArray<carla::geom::Transform>(Episode->GetRecommendedSpawnPoints())};
+    Constants->ActorDefinitions = MakeVectorFromTArray<cr::ActorDefinition>(Episode->GetActorDefinitions());
+    const auto Packed = carla::MsgPack::Pack(Constants->ActorDefinitions);
+    Constants->ActorDefinitionsHash = cr::CachedContent::ComputeHash(Packed.data(), Packed.size());
+    Constants->PackedActorDefinitions.assign(Packed.begin(), Packed.end());
+    State->Constants = std::move(Constants);
+  }
+
+  State->EpisodeInfo = cr::EpisodeInfo{Episode->GetId(), BroadcastStream.token()};
+  State->Settings = cr::EpisodeSettings{Episode->GetSettings()};
+  if (auto *Weather = Episode->GetWeather())
+  {
+    State->Weather = Weather->GetCurrentWeather();
+    State->bHasWeather = true;
+  }
+
+  std::lock_guard<std::mutex> Lock(ReadOnlyStateMutex);
+  ReadOnlyState = std::move(State);
+}
+
 // =============================================================================
 // -- FCarlaServer -------------------------------------------------------
 // =============================================================================
@@ -3103,19 +4233,24 @@ FCarlaServer::~FCarlaServer() {
   Stop();
 }
 
-FDataMultiStream FCarlaServer::Start(uint16_t RPCPort, uint16_t StreamingPort, uint16_t SecondaryPort)
+FDataMultiStream FCarlaServer::Start(
+    uint16_t RPCPort,
+    uint16_t StreamingPort,
+    uint16_t SecondaryPort,
+    uint16_t ControlStreamingPort)
 {
-  Pimpl = MakeUnique<FPimpl>(RPCPort, StreamingPort, SecondaryPort);
+  Pimpl = MakeUnique<FPimpl>(RPCPort, StreamingPort, SecondaryPort, ControlStreamingPort);
   StreamingPort = Pimpl->StreamingServer.GetLocalEndpoint().port();
   SecondaryPort = Pimpl->SecondaryServer->GetLocalEndpoint().port();
 
   UE_LOG(
       LogCarlaServer,
       Log,
-      TEXT("Initialized CarlaServer: Ports(rpc=%d, streaming=%d, secondary=%d)"),
+      TEXT("Initialized CarlaServer: Ports(rpc=%d, streaming=%d, secondary=%d, control-streaming=%d)"),
       RPCPort,
       StreamingPort,
-      SecondaryPort);
+      SecondaryPort,
+      ControlStreamingPort);
   return Pimpl->BroadcastStream;
 }
 
@@ -3124,11 +4259,15 @@ void FCarlaServer::NotifyBeginEpisode(UCarlaEpisode &Episode)
   check(Pimpl != nullptr);
   UE_LOG(LogCarlaServer, Log, TEXT("New episode '%s' started"), *Episode.GetMapName());
   Pimpl->Episode = &Episode;
+  Pimpl->PublishReadOnlyState();
 }
 
 void FCarlaServer::NotifyEndEpisode()
 {
   check(Pimpl != nullptr);
+  Pimpl->AbortSpawnBatches("episode ended before the command was applied");
+  Pimpl->KinematicVehicles.Reset();
+  // 只读状态保留到下一个剧集开始
   Pimpl->Episode = nullptr;
 }
 
@@ -3156,12 +4295,29 @@ void FCarlaServer::AsyncRun(uint32 NumberOfWorkerThreads)
     SecondaryThreads = ThreadsPerServer;
   }
 
+  // 流媒体的工作线程可以绑定到指定的处理器上，避免与游戏线程、渲染线程争用同一个核心
+  const auto StreamingCpus = ParseCpuListArgument(TEXT("-StreamingCPUs="));
+
   UE_LOG(LogCarla, Log, TEXT("FCarlaServer AsyncRun %d, RPCThreads %d, StreamingThreads %d, SecondaryThreads %d"),
         NumberOfWorkerThreads, RPCThreads, StreamingThreads, SecondaryThreads);
 
   Pimpl->Server.AsyncRun(RPCThreads);
-  Pimpl->StreamingServer.AsyncRun(StreamingThreads);
+  Pimpl->StreamingServer.AsyncRun(StreamingThreads, StreamingCpus);
   Pimpl->SecondaryServer->AsyncRun(SecondaryThreads);
+
+  if (Pimpl->ControlStreamingServer)
+  {
+    // 剧集状态的数据量很小，默认一个线程即可，不会被大量的传感器数据阻塞
+    int32_t ControlStreamingThreads;
+    if(!FParse::Value(FCommandLine::Get(), TEXT("-ControlStreamingThreads="), ControlStreamingThreads))
+    {
+      ControlStreamingThreads = 1;
+    }
+    ControlStreamingThreads = std::max(1, ControlStreamingThreads);
+    const auto ControlStreamingCpus = ParseCpuListArgument(TEXT("-ControlStreamingCPUs="));
+    UE_LOG(LogCarla, Log, TEXT("FCarlaServer ControlStreamingThreads %d"), ControlStreamingThreads);
+    Pimpl->ControlStreamingServer->AsyncRun(ControlStreamingThreads, ControlStreamingCpus);
+  }
 }
 
 void FCarlaServer::RunSome(uint32 Milliseconds)
@@ -3170,9 +4326,50 @@ void FCarlaServer::RunSome(uint32 Milliseconds)
   Pimpl->Server.SyncRunFor(carla::time_duration::milliseconds(Milliseconds));
 }
 
+void FCarlaServer::WaitSome(uint32 Milliseconds)
+{
+  TRACE_CPUPROFILER_EVENT_SCOPE_STR(__FUNCTION__);
+  Pimpl->Server.SyncWaitFor(carla::time_duration::milliseconds(Milliseconds));
+}
+
+void FCarlaServer::Wake()
+{
+  Pimpl->Server.SyncWake();
+}
+
+void FCarlaServer::ProcessSpawnBatches()
+{
+  check(Pimpl != nullptr);
+  Pimpl->ProcessSpawnBatches();
+}
+
+void FCarlaServer::IntegrateKinematicVehicles(float DeltaSeconds)
+{
+  check(Pimpl != nullptr);
+  if (Pimpl->Episode != nullptr)
+  {
+    Pimpl->KinematicVehicles.Integrate(*Pimpl->Episode, DeltaSeconds);
+  }
+}
+
+void FCarlaServer::PublishReadOnlyState()
+{
+  check(Pimpl != nullptr);
+  Pimpl->PublishReadOnlyState();
+}
+
+uint32 FCarlaServer::TakeBatchCommandCount()
+{
+  check(Pimpl != nullptr);
+  const uint32 Count = Pimpl->BatchCommandCount;
+  Pimpl->BatchCommandCount = 0u;
+  return Count;
+}
+
 void FCarlaServer::Tick()
 {
   (void)Pimpl->TickCuesReceived.fetch_add(1, std::memory_order_release);
+  Pimpl->Server.SyncWake();
 }
 
 bool FCarlaServer::TickCueReceived()
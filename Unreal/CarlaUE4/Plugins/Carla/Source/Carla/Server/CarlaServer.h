@@ -35,7 +35,12 @@ public:
     ~FCarlaServer();
 
     // 启动服务器相关功能，传入RPC端口号（RPCPort）、流数据端口号（StreamingPort）以及备用端口号（SecondaryPort），返回一个多数据流对象（FDataMultiStream），可能用于后续的多种数据传输交互场景
-    FDataMultiStream Start(uint16_t RPCPort, uint16_t StreamingPort, uint16_t SecondaryPort);
+    // ControlStreamingPort 不为0时，剧集状态通过该端口上独立的流媒体服务器发送，不与传感器数据争用工作线程
+    FDataMultiStream Start(
+        uint16_t RPCPort,
+        uint16_t StreamingPort,
+        uint16_t SecondaryPort,
+        uint16_t ControlStreamingPort = 0u);
 
     // 用于通知服务器开始一个Carla Episode（可能是一个模拟场景、任务等的阶段），传入对应的UCarlaEpisode对象引用，以便服务器知晓相关信息进行对应处理
     void NotifyBeginEpisode(UCarlaEpisode &Episode);
@@ -49,6 +54,23 @@ public:
     // 运行服务器一段时间，传入时间（以毫秒为单位，Milliseconds）参数，在指定时长内执行服务器相关的逻辑，比如处理数据、更新状态等
     void RunSome(uint32 Milliseconds);
 
+    // 与 RunSome 相同，但没有请求时阻塞等待而不占用CPU，处理了请求或者被 Wake 唤醒后返回
+    void WaitSome(uint32 Milliseconds);
+
+    // 唤醒在 WaitSome 中等待的游戏线程，可以从任意线程调用
+    void Wake();
+
+    // 在游戏线程上执行 spawn_batch 排队的命令，每帧调用一次，用时受每批的时间预算限制
+    void ProcessSpawnBatches();
+
+    // 把运动学车辆向各自的目标移动 DeltaSeconds，每帧在物理模拟之前调用一次
+    void IntegrateKinematicVehicles(float DeltaSeconds);
+
+    // 返回上次调用以来 apply_batch 执行的命令数并清零，每帧调用一次用于统计
+    uint32 TakeBatchCommandCount();
+    // 更新只读 RPC（剧集设置、蓝图、地图信息、天气等）在工作线程上读取的快照，每帧调用一次
+    void PublishReadOnlyState();
+
     // 执行服务器的一次“滴答”操作，通常用于周期性地更新服务器状态、处理数据等，类似于游戏循环里的每一帧更新逻辑
     void Tick();
     
@@ -86,13 +86,23 @@ static void LoadSettingsFromConfig(
     Settings.SecondaryPort = Settings.RPCPort + 2u;
     ConfigFile.GetInt(S_CARLA_SERVER,    TEXT("StreamingPort"), Settings.StreamingPort);
     ConfigFile.GetInt(S_CARLA_SERVER,    TEXT("SecondaryPort"), Settings.SecondaryPort);
+    ConfigFile.GetInt(S_CARLA_SERVER,    TEXT("ControlStreamingPort"), Settings.ControlStreamingPort);
+    ConfigFile.GetInt(S_CARLA_SERVER,    TEXT("EpisodeStateKeyframeInterval"), Settings.EpisodeStateKeyframeInterval);
     FString Tmp;
     ConfigFile.GetString(S_CARLA_SERVER, TEXT("PrimaryIP"), Tmp);
     Settings.PrimaryIP = TCHAR_TO_UTF8(*Tmp);
     ConfigFile.GetInt(S_CARLA_SERVER,    TEXT("PrimaryPort"), Settings.PrimaryPort);
+    ConfigFile.GetInt(S_CARLA_SERVER,    TEXT("SecondaryFrameLag"), Settings.SecondaryFrameLag);
+    ConfigFile.GetFloat(S_CARLA_SERVER,  TEXT("SecondaryCullDistance"), Settings.SecondaryCullDistance);
+    ConfigFile.GetBool(S_CARLA_SERVER,   TEXT("SharedMemory"), Settings.bSharedMemory);
   }
   ConfigFile.GetBool(S_CARLA_SERVER, TEXT("SynchronousMode"), Settings.bSynchronousMode);
+  ConfigFile.GetFloat(S_CARLA_SERVER, TEXT("SynchronousSpinTime"), Settings.SynchronousSpinTime);
+  ConfigFile.GetInt(S_CARLA_SERVER, TEXT("ActorPoolSize"), Settings.ActorPoolSize);
+  ConfigFile.GetInt(S_CARLA_SERVER, TEXT("MapCacheSize"), Settings.MapCacheSize);
   ConfigFile.GetBool(S_CARLA_SERVER, TEXT("DisableRendering"), Settings.bDisableRendering);
+  ConfigFile.GetBool(S_CARLA_SERVER, TEXT("RenderOnDemand"), Settings.bRenderOnDemand);
+  ConfigFile.GetString(S_CARLA_SERVER, TEXT("PrewarmSensorShaders"), Settings.PrewarmSensorShaders);
   // 画质配置 QualitySettings.
   FString sQualityLevel;
   ConfigFile.GetString(S_CARLA_QUALITYSETTINGS, TEXT("QualityLevel"), sQualityLevel);
@@ -150,6 +160,14 @@ void UCarlaSettings::LoadSettings()
     {
       SecondaryPort = Value;
     }
+    if (FParse::Value(FCommandLine::Get(), TEXT("-carla-control-streaming-port="), Value))
+    {
+      ControlStreamingPort = Value;
+    }
+    if (FParse::Value(FCommandLine::Get(), TEXT("-episode-state-keyframe-interval="), Value))
+    {
+      EpisodeStateKeyframeInterval = Value;
+    }
     FString Tmp;
     if (FParse::Value(FCommandLine::Get(), TEXT("-carla-primary-host="), Tmp))
     {
@@ -159,15 +177,49 @@ void UCarlaSettings::LoadSettings()
     {
       PrimaryPort = Value;
     }
+    if (FParse::Value(FCommandLine::Get(), TEXT("-carla-secondary-frame-lag="), Value))
+    {
+      SecondaryFrameLag = Value;
+    }
+    float SpinTime = 0.0f;
+    if (FParse::Value(FCommandLine::Get(), TEXT("-carla-sync-spin-time="), SpinTime))
+    {
+      SynchronousSpinTime = SpinTime;
+    }
+    if (FParse::Value(FCommandLine::Get(), TEXT("-carla-actor-pool-size="), Value))
+    {
+      ActorPoolSize = Value;
+    }
+    if (FParse::Value(FCommandLine::Get(), TEXT("-carla-map-cache-size="), Value))
+    {
+      MapCacheSize = Value;
+    }
+    float CullDistance = 0.0f;
+    if (FParse::Value(FCommandLine::Get(), TEXT("-carla-secondary-cull-distance="), CullDistance))
+    {
+      SecondaryCullDistance = CullDistance;
+    }
     FString StringQualityLevel;
     if (FParse::Value(FCommandLine::Get(), TEXT("-quality-level="), StringQualityLevel))
     {
       QualityLevel = QualityLevelFromString(StringQualityLevel, EQualityLevel::Epic);
     }
+    if (FParse::Param(FCommandLine::Get(), TEXT("-carla-shared-memory")))
+    {
+      bSharedMemory = true;
+    }
     if (FParse::Param(FCommandLine::Get(), TEXT("-no-rendering")))
     {
       bDisableRendering = true;
     }
+    if (FParse::Param(FCommandLine::Get(), TEXT("-render-on-demand")))
+    {
+      bRenderOnDemand = true;
+    }
+    if (FParse::Value(FCommandLine::Get(), TEXT("-carla-prewarm-sensor-shaders="), Tmp))
+    {
+      PrewarmSensorShaders = Tmp;
+    }
     if (FParse::Param(FCommandLine::Get(), TEXT("-ros2")))
     {
       ROS2 = true;
@@ -203,8 +255,18 @@ void UCarlaSettings::LogSettings() const
   UE_LOG(LogCarla, Log, TEXT("RPC Port = %d"), RPCPort);
   UE_LOG(LogCarla, Log, TEXT("Streaming Port = %d"), StreamingPort);
   UE_LOG(LogCarla, Log, TEXT("Secondary Port = %d"), SecondaryPort);
+  UE_LOG(LogCarla, Log, TEXT("Control Streaming Port = %d"), ControlStreamingPort);
+  UE_LOG(LogCarla, Log, TEXT("Episode State Keyframe Interval = %d"), EpisodeStateKeyframeInterval);
+  UE_LOG(LogCarla, Log, TEXT("Secondary Frame Lag = %d"), SecondaryFrameLag);
+  UE_LOG(LogCarla, Log, TEXT("Secondary Cull Distance = %.1f m"), SecondaryCullDistance);
+  UE_LOG(LogCarla, Log, TEXT("Shared Memory = %s"), EnabledDisabled(bSharedMemory));
   UE_LOG(LogCarla, Log, TEXT("Synchronous Mode = %s"), EnabledDisabled(bSynchronousMode));
+  UE_LOG(LogCarla, Log, TEXT("Synchronous Spin Time = %.1f ms"), SynchronousSpinTime);
+  UE_LOG(LogCarla, Log, TEXT("Actor Pool Size = %d"), ActorPoolSize);
+  UE_LOG(LogCarla, Log, TEXT("Map Cache Size = %d"), MapCacheSize);
   UE_LOG(LogCarla, Log, TEXT("Rendering = %s"), EnabledDisabled(!bDisableRendering));
+  UE_LOG(LogCarla, Log, TEXT("Render On Demand = %s"), EnabledDisabled(bRenderOnDemand));
+  UE_LOG(LogCarla, Log, TEXT("Prewarm Sensor Shaders = %s"), *PrewarmSensorShaders);
   UE_LOG(LogCarla, Log, TEXT("[%s]"), S_CARLA_QUALITYSETTINGS);
   UE_LOG(LogCarla, Log, TEXT("Quality Level = %s"), *QualityLevelToString(QualityLevel));
   UE_LOG(LogCarla, Log,
@@ -81,10 +81,41 @@ public:
   /// 辅助服务器端口的设置。
   uint32 SecondaryPort = 2002u;
 
+  /// 控制流（剧集状态）使用的独立流媒体端口，为0时与传感器共用流媒体服务器。
+  uint32 ControlStreamingPort = 0u;
+
+  /// 剧集状态每隔多少帧发送一个完整的关键帧，其间只发送变化的参与者。
+  /// 为0或1时每帧都发送完整的状态，不理解增量帧的旧客户端需要保持该值。
+  uint32 EpisodeStateKeyframeInterval = 0u;
+
   /// 设置要连接的主服务器的IP和端口。
   std::string PrimaryIP = "";
   uint32      PrimaryPort = 2002u;
 
+  /// 多 GPU 模式下主服务器最多领先次级服务器的帧数。为1时主服务器模拟第 N+1 帧的同时
+  /// 次级服务器渲染第 N 帧；为0时主服务器不等待次级服务器。
+  uint32 SecondaryFrameLag = 0u;
+
+  /// 同步模式下等待节拍提示（次级服务器等待帧数据）时，阻塞之前空转的时间，单位为毫秒。
+  /// 空转延迟更低但占满一个核心，为0时立即阻塞。
+  float SynchronousSpinTime = 2.0f;
+
+  /// 参与者池最多保留的已销毁车辆和行人数，之后生成相同的参与者时重用它们，
+  /// 为0时不使用参与者池。
+  uint32 ActorPoolSize = 0u;
+
+  /// 内存中缓存资源的最近使用的地图数，切换回这些地图时不需要从磁盘重新加载。
+  /// 为0时只保留用 preload_map 预加载的下一张地图。
+  uint32 MapCacheSize = 0u;
+
+  /// 多 GPU 模式下次级服务器只移动离它负责的传感器不超过该距离（米）的参与者，
+  /// 为0时移动全部参与者。
+  float SecondaryCullDistance = 0.0f;
+
+  /// 同一主机上的客户端和次级服务器经共享内存接收传感器数据和多 GPU 命令，
+  /// 无法打开共享内存时仍然使用TCP。
+  bool bSharedMemory = false;
+
   /// 在同步模式下，CARLA 会等待每个节拍信号，直到收到来自客户端的控制。
   UPROPERTY(Category = "CARLA Server", VisibleAnywhere, meta = (EditCondition = bUseNetworking))
   bool bSynchronousMode = false;
@@ -93,6 +124,16 @@ public:
   UPROPERTY(Category = "CARLA Server", VisibleAnywhere)
   bool bDisableRendering = false;
 
+  /// 只在有相机采集图像的帧上渲染世界的视窗，其余的帧只进行物理模拟。
+  /// 视窗的画面因此只按相机的频率更新。
+  UPROPERTY(Category = "CARLA Server", VisibleAnywhere)
+  bool bRenderOnDemand = false;
+
+  /// 第一个剧集开始时预热的基于着色器的传感器蓝图，以逗号分隔，"all" 表示全部；
+  /// 为空时不预热。预热后第一次生成这些传感器时不再需要编译材质和管线状态。
+  UPROPERTY(Category = "CARLA Server", VisibleAnywhere)
+  FString PrewarmSensorShaders;
+
   // ===========================================================================
   /// @name 画质设置
   // ===========================================================================
@@ -45,6 +45,10 @@ struct CARLA_API FEpisodeSettings
     // 即在一次完整的更新操作中，最多允许划分的子步数量，这里默认设置为10步。
     int MaxSubsteps = 10;
 
+    // MaxPhysicsDeltaTime是一帧交给物理引擎的最长时间，单位是秒，在划分子步之前生效。
+    // 帧的时间间隔大于这个值时物理只模拟这么长的时间，默认值与 DefaultEngine.ini 一致。
+    double MaxPhysicsDeltaTime = 1.0 / 3.0;
+
     // MaxCullingDistance用于指定最大的剔除距离，单位是米（这里是float类型，推测是距离相关，通常用于场景裁剪等操作）。
     // 超出这个距离的物体等可能会被从渲染或其他处理流程中剔除，以节省性能开销，初始值为0.0f表示默认不进行剔除或者还未设置具体的剔除距离。
     float MaxCullingDistance = 0.0f;
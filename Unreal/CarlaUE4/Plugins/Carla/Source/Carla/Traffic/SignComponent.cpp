@@ -6,6 +6,7 @@
 
 
 #include "SignComponent.h"
+#include "Carla/Game/CarlaStatics.h"
 
 #include <compiler/disable-ue4-macros.h>
 #include "carla/opendrive/OpenDriveParser.h"
@@ -100,6 +101,7 @@ UBoxComponent* USignComponent::GenerateTriggerBox(const FTransform &BoxTransform
       FAttachmentTransformRules::KeepRelativeTransform);
   BoxComponent->SetWorldTransform(BoxTransform);
   BoxComponent->SetBoxExtent(FVector(BoxSize, BoxSize, BoxSize), true);
+  RegisterTriggerBox(*BoxComponent);
   return BoxComponent;
 }
 
@@ -114,9 +116,20 @@ UBoxComponent* USignComponent::GenerateTriggerBox(const FTransform &BoxTransform
       FAttachmentTransformRules::KeepRelativeTransform);
   BoxComponent->SetWorldTransform(BoxTransform);
   BoxComponent->SetBoxExtent(BoxSize, true);
+  RegisterTriggerBox(*BoxComponent);
   return BoxComponent;
 }
 
+// 没有 CARLA 游戏模式时（例如在编辑器中）触发框保留重叠事件
+void USignComponent::RegisterTriggerBox(UBoxComponent &BoxComponent)
+{
+  ACarlaGameModeBase *GameMode = UCarlaStatics::GetGameMode(GetWorld());
+  if (GameMode != nullptr)
+  {
+    GameMode->GetCarlaEpisode().GetSignTriggerVolumes().Add(*this, BoxComponent);
+  }
+}
+
 void USignComponent::AddEffectTriggerVolume(UBoxComponent* TriggerVolume)
 {
   EffectTriggerVolumes.Add(TriggerVolume);
@@ -72,6 +72,9 @@ protected:
 
 private:
 
+  /// 把触发框交给剧集的 FSignTriggerVolumes，由它代替重叠事件检测车辆
+  void RegisterTriggerBox(UBoxComponent &BoxComponent);
+
   UPROPERTY(Category = "Traffic Sign", EditAnywhere)
   FString SignId = "";
 
@@ -0,0 +1,271 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "Carla.h"
+#include "Carla/Traffic/SignTriggerVolumes.h"
+
+#include "Carla/Game/CarlaEpisode.h"
+#include "Carla/Traffic/SignComponent.h"
+#include "Carla/Vehicle/CarlaWheeledVehicle.h"
+
+#include "Components/BoxComponent.h"
+
+#include <compiler/disable-ue4-macros.h>
+#include <carla/rpc/String.h>
+#include <compiler/enable-ue4-macros.h>
+
+// 网格的边长（cm），触发框和车辆通常只覆盖一到四个网格
+static constexpr float SignTriggerGridCellSize = 2000.0f;
+
+void FSignTriggerVolumes::Add(USignComponent &Sign, UBoxComponent &Box)
+{
+  Box.SetGenerateOverlapEvents(false);
+  FVolume Volume;
+  Volume.Box = &Box;
+  Volume.Sign = &Sign;
+  Volumes.Add(NextVolumeId++, Volume);
+  bGridDirty = true;
+}
+
+void FSignTriggerVolumes::Tick(UCarlaEpisode &Episode)
+{
+  Events.clear();
+  if (Volumes.Num() == 0)
+  {
+    Vehicles.Reset();
+    return;
+  }
+  TRACE_CPUPROFILER_EVENT_SCOPE(FSignTriggerVolumes::Tick);
+
+  UWorld *World = Episode.GetWorld();
+  const bool bUpdateAll = bGridDirty || World->OriginLocation != GridOrigin;
+  if (bUpdateAll)
+  {
+    RebuildGrid(*World);
+  }
+
+  for (auto &Item : Vehicles)
+  {
+    Item.Value.bSeen = false;
+  }
+  for (const auto &Item : Episode.GetActorRegistry())
+  {
+    const FCarlaActor *View = Item.Value.Get();
+    if (View == nullptr ||
+        View->GetActorType() != FCarlaActor::ActorType::Vehicle ||
+        View->IsDormant() ||
+        View->IsPendingKill())
+    {
+      continue;
+    }
+    auto *Actor = Cast<ACarlaWheeledVehicle>(View->GetActor());
+    if (Actor == nullptr)
+    {
+      continue;
+    }
+    FVehicle &Vehicle = Vehicles.FindOrAdd(View->GetActorId());
+    Vehicle.bSeen = true;
+    const FTransform Transform = Actor->GetActorTransform();
+    if (Vehicle.Actor.Get() == Actor && !bUpdateAll && Transform.Equals(Vehicle.Transform))
+    {
+      // 车辆和触发框都没有移动
+      continue;
+    }
+    if (Vehicle.Actor.Get() != Actor)
+    {
+      // 从休眠中唤醒的车辆是新的参与者
+      Vehicle.Actor = Actor;
+      Vehicle.Inside.Reset();
+    }
+    Vehicle.Transform = Transform;
+    UpdateVehicle(Episode, View->GetActorId(), Vehicle);
+  }
+
+  // 销毁或休眠的车辆离开所有触发框，与重叠事件在参与者销毁时的行为相同
+  for (auto It = Vehicles.CreateIterator(); It; ++It)
+  {
+    if (It->Value.bSeen)
+    {
+      continue;
+    }
+    if (ACarlaWheeledVehicle *Actor = It->Value.Actor.Get(true))
+    {
+      for (const int32 VolumeId : It->Value.Inside)
+      {
+        Dispatch(Episode, It->Key, *Actor, VolumeId, false);
+      }
+    }
+    It.RemoveCurrent();
+  }
+}
+
+FSignTriggerVolumes::FOrientedBox FSignTriggerVolumes::MakeOrientedBox(
+    const FTransform &Transform,
+    const FVector &Extent)
+{
+  FOrientedBox Box;
+  Box.Center = Transform.GetLocation();
+  const FVector Forward = Transform.GetUnitAxis(EAxis::X);
+  Box.AxisX = FVector2D(Forward.X, Forward.Y).GetSafeNormal();
+  if (Box.AxisX.IsNearlyZero())
+  {
+    Box.AxisX = FVector2D(1.0f, 0.0f);
+  }
+  Box.AxisY = FVector2D(-Box.AxisX.Y, Box.AxisX.X);
+  Box.Extent = Extent;
+  return Box;
+}
+
+bool FSignTriggerVolumes::Overlap(const FOrientedBox &A, const FOrientedBox &B)
+{
+  if (FMath::Abs(A.Center.Z - B.Center.Z) > A.Extent.Z + B.Extent.Z)
+  {
+    return false;
+  }
+  const FVector2D Delta(B.Center.X - A.Center.X, B.Center.Y - A.Center.Y);
+  const FVector2D Axes[] = {A.AxisX, A.AxisY, B.AxisX, B.AxisY};
+  for (const FVector2D &Axis : Axes)
+  {
+    const float RadiusA =
+        A.Extent.X * FMath::Abs(A.AxisX | Axis) + A.Extent.Y * FMath::Abs(A.AxisY | Axis);
+    const float RadiusB =
+        B.Extent.X * FMath::Abs(B.AxisX | Axis) + B.Extent.Y * FMath::Abs(B.AxisY | Axis);
+    if (FMath::Abs(Delta | Axis) > RadiusA + RadiusB)
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+void FSignTriggerVolumes::GetCells(const FOrientedBox &Box, FIntPoint &Min, FIntPoint &Max)
+{
+  const float HalfX =
+      Box.Extent.X * FMath::Abs(Box.AxisX.X) + Box.Extent.Y * FMath::Abs(Box.AxisY.X);
+  const float HalfY =
+      Box.Extent.X * FMath::Abs(Box.AxisX.Y) + Box.Extent.Y * FMath::Abs(Box.AxisY.Y);
+  Min.X = FMath::FloorToInt((Box.Center.X - HalfX) / SignTriggerGridCellSize);
+  Min.Y = FMath::FloorToInt((Box.Center.Y - HalfY) / SignTriggerGridCellSize);
+  Max.X = FMath::FloorToInt((Box.Center.X + HalfX) / SignTriggerGridCellSize);
+  Max.Y = FMath::FloorToInt((Box.Center.Y + HalfY) / SignTriggerGridCellSize);
+}
+
+void FSignTriggerVolumes::RebuildGrid(UWorld &World)
+{
+  Grid.Reset();
+  for (auto It = Volumes.CreateIterator(); It; ++It)
+  {
+    UBoxComponent *Box = It->Value.Box.Get();
+    if (Box == nullptr)
+    {
+      It.RemoveCurrent();
+      continue;
+    }
+    It->Value.Bounds = MakeOrientedBox(Box->GetComponentTransform(), Box->GetScaledBoxExtent());
+    FIntPoint Min, Max;
+    GetCells(It->Value.Bounds, Min, Max);
+    for (int32 X = Min.X; X <= Max.X; ++X)
+    {
+      for (int32 Y = Min.Y; Y <= Max.Y; ++Y)
+      {
+        Grid.FindOrAdd(FIntPoint(X, Y)).Add(It->Key);
+      }
+    }
+  }
+  GridOrigin = World.OriginLocation;
+  bGridDirty = false;
+}
+
+void FSignTriggerVolumes::UpdateVehicle(
+    UCarlaEpisode &Episode,
+    carla::rpc::ActorId Id,
+    FVehicle &Vehicle)
+{
+  ACarlaWheeledVehicle *Actor = Vehicle.Actor.Get();
+  const FOrientedBox Bounds = MakeOrientedBox(
+      Actor->GetVehicleBoundingBoxTransform() * Vehicle.Transform,
+      Actor->GetVehicleBoundingBoxExtent());
+
+  TArray<int32> Inside;
+  FIntPoint Min, Max;
+  GetCells(Bounds, Min, Max);
+  for (int32 X = Min.X; X <= Max.X; ++X)
+  {
+    for (int32 Y = Min.Y; Y <= Max.Y; ++Y)
+    {
+      const TArray<int32> *Cell = Grid.Find(FIntPoint(X, Y));
+      if (Cell == nullptr)
+      {
+        continue;
+      }
+      for (const int32 VolumeId : *Cell)
+      {
+        if (Inside.Contains(VolumeId))
+        {
+          continue;
+        }
+        const FVolume &Volume = Volumes[VolumeId];
+        if (!Volume.Box.IsValid())
+        {
+          // 标志被移除，下一帧重新建立网格
+          bGridDirty = true;
+          continue;
+        }
+        if (Overlap(Volume.Bounds, Bounds))
+        {
+          Inside.Add(VolumeId);
+        }
+      }
+    }
+  }
+
+  for (const int32 VolumeId : Vehicle.Inside)
+  {
+    if (!Inside.Contains(VolumeId))
+    {
+      Dispatch(Episode, Id, *Actor, VolumeId, false);
+    }
+  }
+  for (const int32 VolumeId : Inside)
+  {
+    if (!Vehicle.Inside.Contains(VolumeId))
+    {
+      Dispatch(Episode, Id, *Actor, VolumeId, true);
+    }
+  }
+  Vehicle.Inside = MoveTemp(Inside);
+}
+
+void FSignTriggerVolumes::Dispatch(
+    UCarlaEpisode &Episode,
+    carla::rpc::ActorId VehicleId,
+    ACarlaWheeledVehicle &Vehicle,
+    int32 VolumeId,
+    bool bEntered)
+{
+  const FVolume *Volume = Volumes.Find(VolumeId);
+  UBoxComponent *Box = Volume != nullptr ? Volume->Box.Get() : nullptr;
+  if (Box == nullptr)
+  {
+    return;
+  }
+  if (bEntered)
+  {
+    Box->OnComponentBeginOverlap.Broadcast(Box, &Vehicle, Vehicle.GetMesh(), 0, false, FHitResult());
+  }
+  else
+  {
+    Box->OnComponentEndOverlap.Broadcast(Box, &Vehicle, Vehicle.GetMesh(), 0);
+  }
+
+  const FCarlaActor *SignActor = Episode.FindCarlaActor(Box->GetOwner());
+  const USignComponent *Sign = Volume->Sign.Get();
+  Events.emplace_back(
+      VehicleId,
+      SignActor != nullptr ? SignActor->GetActorId() : 0u,
+      Sign != nullptr ? carla::rpc::FromFString(Sign->GetSignId()) : std::string(),
+      bEntered);
+}
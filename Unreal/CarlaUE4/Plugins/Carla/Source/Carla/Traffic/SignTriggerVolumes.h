@@ -0,0 +1,115 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include <compiler/disable-ue4-macros.h>
+#include <carla/rpc/ActorId.h>
+#include <carla/rpc/SignTriggerEvent.h>
+#include <compiler/enable-ue4-macros.h>
+
+#include <vector>
+
+class ACarlaWheeledVehicle;
+class UBoxComponent;
+class UCarlaEpisode;
+class USignComponent;
+
+/// 交通标志（停车、让行、限速标志和交通灯）的所有触发框。
+///
+/// 触发框不再生成重叠事件，每帧物理模拟之后在这里对移动过的车辆做一次检测：
+/// 触发框按位置放入均匀网格，车辆只与所在网格中的触发框比较。车辆进入或离开
+/// 触发框时广播触发框的 OnComponentBeginOverlap / OnComponentEndOverlap，
+/// 标志组件原来的处理函数不需要改变。这一帧的事件同时保留给客户端查询。
+///
+/// 检测使用车辆的边界框而不是碰撞网格，只考虑偏航角：水平面上是有向矩形的
+/// 分离轴检测，高度上是区间的重叠。
+class FSignTriggerVolumes
+{
+public:
+
+  /// 注册标志 @a Sign 生成的触发框 @a Box，关闭它的重叠事件。
+  void Add(USignComponent &Sign, UBoxComponent &Box);
+
+  /// 检测车辆进入和离开的触发框并广播事件。每帧物理模拟之后调用一次。
+  void Tick(UCarlaEpisode &Episode);
+
+  /// 上一次 Tick 中车辆进入和离开触发框的事件。
+  const std::vector<carla::rpc::SignTriggerEvent> &GetEvents() const
+  {
+    return Events;
+  }
+
+  int32 Num() const
+  {
+    return Volumes.Num();
+  }
+
+private:
+
+  /// 只有偏航角的有向边界框，Extent 为半尺寸
+  struct FOrientedBox
+  {
+    FVector Center;
+    FVector2D AxisX;
+    FVector2D AxisY;
+    FVector Extent;
+  };
+
+  struct FVolume
+  {
+    TWeakObjectPtr<UBoxComponent> Box;
+    TWeakObjectPtr<USignComponent> Sign;
+    FOrientedBox Bounds;
+  };
+
+  struct FVehicle
+  {
+    TWeakObjectPtr<ACarlaWheeledVehicle> Actor;
+    FTransform Transform;
+    /// 车辆所在的触发框
+    TArray<int32> Inside;
+    /// 这一帧仍然存在
+    bool bSeen = false;
+  };
+
+  static FOrientedBox MakeOrientedBox(const FTransform &Transform, const FVector &Extent);
+
+  static bool Overlap(const FOrientedBox &A, const FOrientedBox &B);
+
+  /// @a Box 在水平面上覆盖的网格
+  static void GetCells(const FOrientedBox &Box, FIntPoint &Min, FIntPoint &Max);
+
+  /// 移除已销毁的触发框，按当前的位置重新建立网格。
+  void RebuildGrid(UWorld &World);
+
+  void UpdateVehicle(UCarlaEpisode &Episode, carla::rpc::ActorId Id, FVehicle &Vehicle);
+
+  void Dispatch(
+      UCarlaEpisode &Episode,
+      carla::rpc::ActorId VehicleId,
+      ACarlaWheeledVehicle &Vehicle,
+      int32 VolumeId,
+      bool bEntered);
+
+  TMap<int32, FVolume> Volumes;
+
+  int32 NextVolumeId = 0;
+
+  /// 网格坐标到其中触发框的映射
+  TMap<FIntPoint, TArray<int32>> Grid;
+
+  /// 有新的或已销毁的触发框，或者大地图的原点移动了
+  bool bGridDirty = false;
+
+  FIntVector GridOrigin = FIntVector::ZeroValue;
+
+  TMap<carla::rpc::ActorId, FVehicle> Vehicles;
+
+  std::vector<carla::rpc::SignTriggerEvent> Events;
+};
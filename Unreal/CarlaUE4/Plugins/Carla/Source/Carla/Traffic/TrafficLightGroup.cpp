@@ -88,3 +88,53 @@ void ATrafficLightGroup::AddController(UTrafficLightController* Controller)
   Controllers.Add(Controller);
   Controller->SetGroup(this);
 }
+
+void ATrafficLightGroup::ApplyPlan(const FTrafficLightGroupPlan& Plan)
+{
+  check(Plan.Group == this);
+  for (const FTrafficLightControllerTiming& Timing : Plan.Timings)
+  {
+    Timing.Controller->SetGreenTime(Timing.GreenTime);
+    Timing.Controller->SetYellowTime(Timing.YellowTime);
+    Timing.Controller->SetRedTime(Timing.RedTime);
+  }
+  if (Plan.bRestart && Controllers.Num())
+  {
+    ResetGroup();
+    AdvanceTime(Plan.Offset);
+  }
+  SetFrozenGroup(Plan.bFrozen);
+}
+
+void ATrafficLightGroup::AdvanceTime(float Seconds)
+{
+  float CycleTime = 0.0f;
+  for (auto* Controller : Controllers)
+  {
+    CycleTime += Controller->GetGreenTime() + Controller->GetYellowTime() + Controller->GetRedTime();
+  }
+  if (CycleTime <= 0.0f || Seconds <= 0.0f)
+  {
+    return;
+  }
+  // 完整的循环不改变相位
+  Seconds = FMath::Fmod(Seconds, CycleTime);
+
+  while (Seconds > 0.0f)
+  {
+    UTrafficLightController* Controller = Controllers[CurrentController];
+    const float Remaining =
+        Controller->GetCurrentState().Time - Controller->GetElapsedTime();
+    if (Seconds <= Remaining)
+    {
+      Controller->SetElapsedTime(Controller->GetElapsedTime() + Seconds);
+      return;
+    }
+    Seconds -= FMath::Max(Remaining, 0.0f);
+    // 与 Tick 相同，超过当前状态的时间后切换到下一个状态或控制器
+    if (Controller->AdvanceTimeAndCycleFinished(FMath::Max(Remaining, 0.0f) + KINDA_SMALL_NUMBER))
+    {
+      NextController();
+    }
+  }
+}
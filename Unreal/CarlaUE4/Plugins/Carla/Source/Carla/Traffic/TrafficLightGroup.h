@@ -15,6 +15,35 @@
 
 class ATrafficLightManager;
 
+/// 控制器的配时，单位为秒
+struct FTrafficLightControllerTiming
+{
+  UTrafficLightController* Controller = nullptr;
+
+  float GreenTime = 0.0f;
+
+  float YellowTime = 0.0f;
+
+  float RedTime = 0.0f;
+};
+
+/// 交通灯组的配时方案，由 ATrafficLightManager::ApplyGroupPlans 在帧开始前应用
+struct FTrafficLightGroupPlan
+{
+  ATrafficLightGroup* Group = nullptr;
+
+  // 组中控制器的新配时，未列出的控制器不变
+  TArray<FTrafficLightControllerTiming> Timings;
+
+  // 从第一个控制器重新开始循环
+  bool bRestart = true;
+
+  // 重新开始循环后快进的时间
+  float Offset = 0.0f;
+
+  bool bFrozen = false;
+};
+
 /// 如果你的类继承自UObject，你的类名上方需要加入 UCLASS() 宏
 /// 实现交通信号灯状态改变的类
 UCLASS()
@@ -47,6 +76,13 @@ public:
   UFUNCTION(Category = "Traffic Group", BlueprintCallable)
   void AddController(UTrafficLightController* Controller);
 
+  // 应用配时方案，Plan.Group 必须是这个组
+  void ApplyPlan(const FTrafficLightGroupPlan& Plan);
+
+  // 按 Tick 的规则快进循环，可以跨越多个状态和控制器
+  UFUNCTION(Category = "Traffic Group", BlueprintCallable)
+  void AdvanceTime(float Seconds);
+
 protected:
   // 每帧调用
   virtual void Tick(float DeltaTime) override;
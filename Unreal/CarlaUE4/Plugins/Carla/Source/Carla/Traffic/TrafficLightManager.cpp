@@ -296,8 +296,8 @@ void ATrafficLightManager::MatchTrafficLightActorsWithOpenDriveSignals()
   TArray<AActor*> Actors;
   UGameplayStatics::GetAllActorsOfClass(GetWorld(), ATrafficLightBase::StaticClass(), Actors);
 
-  std::string opendrive_xml = carla::rpc::FromFString(UOpenDrive::GetXODR(GetWorld()));
-  auto Map = carla::opendrive::OpenDriveParser::Load(opendrive_xml);
+  // 使用游戏模式启动时已经解析的地图，不再重新解析 OpenDRIVE 文件
+  const auto &Map = GetMap();
 
   if (!Map)
   {
@@ -785,6 +785,35 @@ bool ATrafficLightManager::GetFrozen()
   return bTrafficLightsFrozen;
 }
 
+void ATrafficLightManager::ApplyGroupPlans(const TArray<FTrafficLightGroupPlan>& Plans)
+{
+  TRACE_CPUPROFILER_EVENT_SCOPE(ATrafficLightManager::ApplyGroupPlans);
+  for (const FTrafficLightGroupPlan& Plan : Plans)
+  {
+    Plan.Group->ApplyPlan(Plan);
+  }
+
+  // 与单独设置时间相同，记录新的配时
+  auto* Recorder = UCarlaStatics::GetRecorder(GetWorld());
+  if (Recorder && Recorder->IsEnabled())
+  {
+    for (const FTrafficLightGroupPlan& Plan : Plans)
+    {
+      for (auto* Controller : Plan.Group->GetControllers())
+      {
+        for (auto* TrafficLight : Controller->GetTrafficLights())
+        {
+          auto* TrafficLightActor = Cast<ATrafficLightBase>(TrafficLight->GetOwner());
+          if (TrafficLightActor)
+          {
+            TrafficLightActor->AddTimeToRecorder();
+          }
+        }
+      }
+    }
+  }
+}
+
 ATrafficLightGroup* ATrafficLightManager::GetTrafficGroup(carla::road::JuncId JunctionId)
 {
   if (TrafficGroups.Contains(JunctionId))
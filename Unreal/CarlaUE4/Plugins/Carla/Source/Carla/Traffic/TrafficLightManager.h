@@ -46,6 +46,9 @@ public:
   UFUNCTION(BlueprintCallable, Category = "Traffic Light Manager")
   bool GetFrozen();
 
+  // 一起应用多个组的配时方案。服务器在帧开始前处理 RPC，方案在同一帧生效
+  void ApplyGroupPlans(const TArray<FTrafficLightGroupPlan>& Plans);
+
   UFUNCTION(CallInEditor, Category = "Traffic Light Manager")
   void GenerateSignalsAndTrafficLights();
 
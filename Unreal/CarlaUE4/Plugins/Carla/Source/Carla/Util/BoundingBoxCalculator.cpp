@@ -425,6 +425,16 @@ TArray<FBoundingBox> UBoundingBoxCalculator::GetBBsOfActor(
 {
   TArray<FBoundingBox> Result;
   TArray<uint8> Tags;
+  GetBBsAndTagsOfActor(Actor, Result, Tags, InTagQueried);
+  return Result;
+}
+
+void UBoundingBoxCalculator::GetBBsAndTagsOfActor(
+  const AActor* Actor,
+  TArray<FBoundingBox>& OutBB,
+  TArray<uint8>& OutTag,
+  uint8 InTagQueried)
+{
   crp::CityObjectLabel TagQueried = (crp::CityObjectLabel)InTagQueried;
   bool FilterByTagEnabled = (TagQueried != crp::CityObjectLabel::Any);
 
@@ -433,7 +443,7 @@ TArray<FBoundingBox> UBoundingBoxCalculator::GetBBsOfActor(
   // 避免处理BP_Procedural_Building类的Actor，以避免与其子Actor重复
   //当改进BP_Procedural_Building时，这个检查可能应该移除
   //注意：这里没有使用类型转换，因为基类是蓝图（BP），这种方式更简单，不需要通过获取UClass来进行类型转换。
-  if( ClassName.Contains("Procedural_Bulding") ) return Result;
+  if( ClassName.Contains("Procedural_Bulding") ) return;
 
   // 车辆的蓝图使用了低多边形静态网格进行碰撞检测，我们应该避免处理它
   const ACarlaWheeledVehicle* Vehicle = Cast<ACarlaWheeledVehicle>(Actor);
@@ -442,9 +452,10 @@ TArray<FBoundingBox> UBoundingBoxCalculator::GetBBsOfActor(
     FBoundingBox BoundingBox = GetVehicleBoundingBox(Vehicle, InTagQueried);
     if(!BoundingBox.Extent.IsZero())
     {
-      Result.Add(BoundingBox);
+      OutBB.Add(BoundingBox);
+      OutTag.Add(static_cast<uint8>(ATagger::GetTagOfTaggedComponent(*Vehicle->GetMesh())));
     }
-    return Result;;
+    return;
   }
 
   // 行人，我们目前仅使用胶囊组件
@@ -454,17 +465,18 @@ TArray<FBoundingBox> UBoundingBoxCalculator::GetBBsOfActor(
     FBoundingBox BoundingBox = GetCharacterBoundingBox(Character, InTagQueried);
     if(!BoundingBox.Extent.IsZero())
     {
-      Result.Add(BoundingBox);
+      OutBB.Add(BoundingBox);
+      OutTag.Add(static_cast<uint8>(crp::CityObjectLabel::Pedestrians));
     }
-    return Result;
+    return;
   }
 
   // 对于交通信号灯，我们需要将所有信号灯的边界框合并为一个
   const ATrafficLightBase* TrafficLight = Cast<ATrafficLightBase>(Actor);
   if(TrafficLight)
   {
-    GetTrafficLightBoundingBox(TrafficLight, Result, Tags, InTagQueried);
-    return Result;
+    GetTrafficLightBoundingBox(TrafficLight, OutBB, OutTag, InTagQueried);
+    return;
   }
 
   // 计算实例化静态网格组件（ISM）的边界框
@@ -476,22 +488,23 @@ TArray<FBoundingBox> UBoundingBoxCalculator::GetBBsOfActor(
     crp::CityObjectLabel Tag = ATagger::GetTagOfTaggedComponent(*Comp);
     if(FilterByTagEnabled && Tag != TagQueried) continue;
 
-    GetISMBoundingBox(Comp, Result);
+    const int32 FirstInstance = OutBB.Num();
+    GetISMBoundingBox(Comp, OutBB);
+    for(int32 i = FirstInstance; i < OutBB.Num(); i++)
+    {
+      OutTag.Add(static_cast<uint8>(Tag));
+    }
   }
 
   // 计算静态网格组件（SM）的边界框
   TArray<UStaticMeshComponent*> StaticMeshComps;
-  Tags.Reset();
   Actor->GetComponents<UStaticMeshComponent>(StaticMeshComps);
-  GetBBsOfStaticMeshComponents(StaticMeshComps, Result, Tags, InTagQueried);
+  GetBBsOfStaticMeshComponents(StaticMeshComps, OutBB, OutTag, InTagQueried);
 
   //计算骨骼网格组件（SK_M）的边界框
   TArray<USkeletalMeshComponent*> SkeletalMeshComps;
-  Tags.Reset();
   Actor->GetComponents<USkeletalMeshComponent>(SkeletalMeshComps);
-  GetBBsOfSkeletalMeshComponents(SkeletalMeshComps, Result, Tags, InTagQueried);
-
-  return Result;
+  GetBBsOfSkeletalMeshComponents(SkeletalMeshComps, OutBB, OutTag, InTagQueried);
 }
 
 void UBoundingBoxCalculator::CombineBBsOfActor(
@@ -84,6 +84,14 @@ public:
     const AActor* Actor,
     uint8 InTagQueried = 0xFF);
 
+  // 与 GetBBsOfActor 相同，同时在 OutTag 中返回每个边界框的标签
+  UFUNCTION(Category = "Carla Util", BlueprintCallable)
+  static void GetBBsAndTagsOfActor(
+    const AActor* Actor,
+    TArray<FBoundingBox>& OutBB,
+    TArray<uint8>& OutTag,
+    uint8 InTagQueried = 0xFF);
+
   // 根据 BB 的距离和类型组合对象的 BB
   // 未组合的 BB 也包括在内（即：TL BB 和极点）
   // DistanceThreshold 为 BB 之间要组合的最大距离，如果为 0.0，则忽略该距离
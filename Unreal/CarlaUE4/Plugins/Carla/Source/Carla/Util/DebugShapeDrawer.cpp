@@ -33,6 +33,15 @@ struct FShapeVisitor
     World->PersistentLineBatcher->SetCollisionEnabled(ECollisionEnabled::NoCollision);
   }
 
+  // 把线和点加入数组而不是绘制，用于持久的形状组
+  FShapeVisitor(UWorld &InWorld, FColor InColor, TArray<FBatchedLine> &InOutLines, TArray<FBatchedPoint> &InOutPoints)
+    : World(&InWorld),
+      Color(InColor.ReinterpretAsLinear() * BrightMultiplier),
+      LifeTime(0.0f),
+      bPersistentLines(true),
+      OutLines(&InOutLines),
+      OutPoints(&InOutPoints) {}
+
   ACarlaHUD * GetHUD() const {
     auto PlayerController = UGameplayStatics::GetPlayerController(World, 0);
     if (PlayerController == nullptr)
@@ -52,6 +61,11 @@ struct FShapeVisitor
     {
       Location = LargeMap->GlobalToLocalLocation(Location);
     }
+    if (OutPoints)
+    {
+      OutPoints->Emplace(Location, Color, 1e2f * Point.size, LifeTime, DepthPriority);
+      return;
+    }
     World->PersistentLineBatcher->DrawPoint(
         Location,
         Color,
@@ -84,13 +98,7 @@ struct FShapeVisitor
       Begin = LargeMap->GlobalToLocalLocation(Begin);
       End = LargeMap->GlobalToLocalLocation(End);
     }
-    World->PersistentLineBatcher->DrawLine(
-        Begin,
-        End,
-        Color,
-        DepthPriority,
-        1e2f * Line.thickness,
-        LifeTime);
+    DrawLine(Begin, End, 1e2f * Line.thickness);
   }
 
   void operator()(const Shape::HUDLine &Line) const {
@@ -127,21 +135,11 @@ struct FShapeVisitor
     const auto ArrowTipDist = Dist - ArrowSize;
     const auto Thickness = 1e2f * Arrow.line.thickness;
 
-    World->PersistentLineBatcher->DrawLines(TArray<FBatchedLine>({
-        FBatchedLine(
-            Begin, End, Color, LifeTime, Thickness, DepthPriority),
-        FBatchedLine(
-            Transform.TransformPosition(FVector(ArrowTipDist, +ArrowSize, +ArrowSize)),
-            End, Color, LifeTime, Thickness, DepthPriority),
-        FBatchedLine(
-            Transform.TransformPosition(FVector(ArrowTipDist, +ArrowSize, -ArrowSize)),
-            End, Color, LifeTime, Thickness, DepthPriority),
-        FBatchedLine(
-            Transform.TransformPosition(FVector(ArrowTipDist, -ArrowSize, +ArrowSize)),
-            End, Color, LifeTime, Thickness, DepthPriority),
-        FBatchedLine(
-            Transform.TransformPosition(FVector(ArrowTipDist, -ArrowSize, -ArrowSize)),
-            End, Color, LifeTime, Thickness, DepthPriority)}));
+    DrawLine(Begin, End, Thickness);
+    DrawLine(Transform.TransformPosition(FVector(ArrowTipDist, +ArrowSize, +ArrowSize)), End, Thickness);
+    DrawLine(Transform.TransformPosition(FVector(ArrowTipDist, +ArrowSize, -ArrowSize)), End, Thickness);
+    DrawLine(Transform.TransformPosition(FVector(ArrowTipDist, -ArrowSize, +ArrowSize)), End, Thickness);
+    DrawLine(Transform.TransformPosition(FVector(ArrowTipDist, -ArrowSize, -ArrowSize)), End, Thickness);
   }
 
   void operator()(const Shape::HUDArrow &Arrow) const {
@@ -202,21 +200,15 @@ struct FShapeVisitor
       {
         P.X=B[i].X; Q.X=B[i].X; P.Y=B[j].Y;
         Q.Y=B[j].Y; P.Z=B[0].Z; Q.Z=B[1].Z;
-        World->PersistentLineBatcher->DrawLine(
-            Transform.TransformPosition(P), Transform.TransformPosition(Q),
-            Color, DepthPriority, Thickness, LifeTime);
+        DrawLine(Transform.TransformPosition(P), Transform.TransformPosition(Q), Thickness);
 
         P.Y=B[i].Y; Q.Y=B[i].Y; P.Z=B[j].Z;
         Q.Z=B[j].Z; P.X=B[0].X; Q.X=B[1].X;
-        World->PersistentLineBatcher->DrawLine(
-            Transform.TransformPosition(P), Transform.TransformPosition(Q),
-            Color, DepthPriority, Thickness, LifeTime);
+        DrawLine(Transform.TransformPosition(P), Transform.TransformPosition(Q), Thickness);
 
         P.Z=B[i].Z; Q.Z=B[i].Z; P.X=B[j].X;
         Q.X=B[j].X; P.Y=B[0].Y; Q.Y=B[1].Y;
-        World->PersistentLineBatcher->DrawLine(
-            Transform.TransformPosition(P), Transform.TransformPosition(Q),
-            Color, DepthPriority, Thickness, LifeTime);
+        DrawLine(Transform.TransformPosition(P), Transform.TransformPosition(Q), Thickness);
       }
     }
   }
@@ -278,6 +270,17 @@ struct FShapeVisitor
 
 private:
 
+  void DrawLine(const FVector &Begin, const FVector &End, float Thickness) const
+  {
+    if (OutLines)
+    {
+      OutLines->Emplace(Begin, End, Color, LifeTime, Thickness, DepthPriority);
+      return;
+    }
+    World->PersistentLineBatcher->DrawLine(
+        Begin, End, Color, DepthPriority, Thickness, LifeTime);
+  }
+
   UWorld *World;
 
   FLinearColor Color;
@@ -286,6 +289,10 @@ private:
 
   bool bPersistentLines;
 
+  TArray<FBatchedLine> *OutLines = nullptr;
+
+  TArray<FBatchedPoint> *OutPoints = nullptr;
+
   uint8 DepthPriority = SDPG_World;
 
   // Debug 行在封装中要隐秘得多，这就是需要这个
@@ -305,3 +312,97 @@ void FDebugShapeDrawer::Draw(const carla::rpc::DebugShape &Shape)
   auto Visitor = FShapeVisitor(World, Shape.color, Shape.life_time, Shape.persistent_lines);
   boost::variant2::visit(Visitor, Shape.primitive);
 }
+
+void FDebugShapeBatches::Draw(
+    UWorld &World,
+    const FString &Client,
+    const std::vector<carla::rpc::DebugShapeBatch> &Batches)
+{
+  TRACE_CPUPROFILER_EVENT_SCOPE(FDebugShapeBatches::Draw);
+  FClientShapes &ClientShapes = Clients.FindOrAdd(Client);
+  ULineBatchComponent *LineBatcher = GetLineBatcher(World, ClientShapes);
+  if (LineBatcher == nullptr)
+  {
+    return;
+  }
+
+  for (const auto &Batch : Batches)
+  {
+    if (Batch.IsEmpty())
+    {
+      ClientShapes.Groups.Remove(Batch.id);
+      continue;
+    }
+    FShapeGroup &Group = ClientShapes.Groups.FindOrAdd(Batch.id);
+    Group.Lines.Reset(Batch.lines.size() + 12u * Batch.boxes.size());
+    Group.Points.Reset(Batch.points.size());
+    FShapeVisitor Visitor(World, Batch.color, Group.Lines, Group.Points);
+    for (const auto &Line : Batch.lines)
+    {
+      Visitor(Line);
+    }
+    for (const auto &Point : Batch.points)
+    {
+      Visitor(Point);
+    }
+    for (const auto &Box : Batch.boxes)
+    {
+      Visitor(Box);
+    }
+  }
+
+  Rebuild(ClientShapes);
+}
+
+void FDebugShapeBatches::Clear(const FString &Client)
+{
+  FClientShapes *ClientShapes = Clients.Find(Client);
+  if (ClientShapes == nullptr)
+  {
+    return;
+  }
+  ULineBatchComponent *LineBatcher = ClientShapes->LineBatcher.Get();
+  if (LineBatcher != nullptr)
+  {
+    LineBatcher->DestroyComponent();
+  }
+  Clients.Remove(Client);
+}
+
+ULineBatchComponent *FDebugShapeBatches::GetLineBatcher(UWorld &World, FClientShapes &ClientShapes) const
+{
+  ULineBatchComponent *LineBatcher = ClientShapes.LineBatcher.Get();
+  if (LineBatcher != nullptr && LineBatcher->GetWorld() == &World)
+  {
+    return LineBatcher;
+  }
+
+  // 加载了新的地图，之前的形状已经随旧的世界销毁
+  ClientShapes.Groups.Empty();
+  AWorldSettings *WorldSettings = World.GetWorldSettings();
+  if (WorldSettings == nullptr)
+  {
+    return nullptr;
+  }
+  // 由世界设置拥有，随世界一起销毁
+  LineBatcher = NewObject<ULineBatchComponent>(WorldSettings);
+  LineBatcher->bCalculateAccurateBounds = false;
+  LineBatcher->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+  LineBatcher->RegisterComponent();
+  ClientShapes.LineBatcher = LineBatcher;
+  return LineBatcher;
+}
+
+void FDebugShapeBatches::Rebuild(FClientShapes &ClientShapes) const
+{
+  ULineBatchComponent *LineBatcher = ClientShapes.LineBatcher.Get();
+  check(LineBatcher != nullptr);
+  LineBatcher->BatchedLines.Reset();
+  LineBatcher->BatchedPoints.Reset();
+  for (const auto &Group : ClientShapes.Groups)
+  {
+    LineBatcher->BatchedLines.Append(Group.Value.Lines);
+    LineBatcher->BatchedPoints.Append(Group.Value.Points);
+  }
+  LineBatcher->MarkRenderStateDirty();
+}
@@ -6,9 +6,13 @@
 
 #pragma once
 
+#include "Components/LineBatchComponent.h"
+
+#include <vector>
+
 class UWorld;
 
-namespace carla { namespace rpc { class DebugShape; }}
+namespace carla { namespace rpc { class DebugShape; class DebugShapeBatch; }}
 
 class FDebugShapeDrawer
 {
@@ -22,3 +26,39 @@ private:
 
   UWorld &World;
 };
+
+/// 客户端按 id 替换的持久调试形状。每个客户端的形状绘制在自己的
+/// ULineBatchComponent 中，一次调用只重建一次这个组件。
+class FDebugShapeBatches
+{
+public:
+
+  /// 替换客户端 @a Client 在 @a Batches 中各 id 的形状，没有形状的 id 被删除。
+  void Draw(
+      UWorld &World,
+      const FString &Client,
+      const std::vector<carla::rpc::DebugShapeBatch> &Batches);
+
+  /// 删除客户端 @a Client 的所有形状。
+  void Clear(const FString &Client);
+
+private:
+
+  struct FShapeGroup
+  {
+    TArray<FBatchedLine> Lines;
+    TArray<FBatchedPoint> Points;
+  };
+
+  struct FClientShapes
+  {
+    TWeakObjectPtr<ULineBatchComponent> LineBatcher;
+    TMap<uint64, FShapeGroup> Groups;
+  };
+
+  ULineBatchComponent *GetLineBatcher(UWorld &World, FClientShapes &ClientShapes) const;
+
+  void Rebuild(FClientShapes &ClientShapes) const;
+
+  TMap<FString, FClientShapes> Clients;
+};
@@ -27,11 +27,18 @@ TArray<FEnvironmentObject> UObjectRegister::GetEnvironmentObjects(uint8 InTagQue
   crp::CityObjectLabel TagQueried = (crp::CityObjectLabel)InTagQueried;
   bool FilterByTagEnabled = (TagQueried != crp::CityObjectLabel::Any);
 
-  for(const FEnvironmentObject& It : EnvironmentObjects)
+  if(!FilterByTagEnabled)
   {
-    if(!FilterByTagEnabled || (It.ObjectLabel == TagQueried))
+    return EnvironmentObjects;
+  }
+
+  const TArray<int32>* Indices = ObjectIndicesByLabel.Find(InTagQueried);
+  if(Indices)
+  {
+    Result.Reserve(Indices->Num());
+    for(int32 Index : *Indices)
     {
-      Result.Emplace(It);
+      Result.Emplace(EnvironmentObjects[Index]);
     }
   }
 
@@ -78,6 +85,8 @@ void UObjectRegister::RegisterObjects(TArray<AActor*> Actors)
     RegisterSKMComponents(Actor);
   }
 
+  BuildIndices();
+
 #if WITH_EDITOR
   // To help debug
   FString FileContent;
@@ -109,17 +118,12 @@ void UObjectRegister::EnableEnvironmentObjects(const TSet<uint64>& EnvObjectIds,
 {
   for(uint64 It : EnvObjectIds)
   {
-    bool found = false;
-    for(FEnvironmentObject& EnvironmentObject : EnvironmentObjects)
+    const int32* Index = ObjectIndexById.Find(It);
+    if(Index)
     {
-      if(It == EnvironmentObject.Id)
-      {
-        EnableEnvironmentObject(EnvironmentObject, Enable);
-        found = true;
-        break;
-      }
+      EnableEnvironmentObject(EnvironmentObjects[*Index], Enable);
     }
-    if(!found)
+    else
     {
       UE_LOG(LogCarla, Error, TEXT("EnableEnvironmentObjects id not found %llu"), It);
     }
@@ -127,6 +131,23 @@ void UObjectRegister::EnableEnvironmentObjects(const TSet<uint64>& EnvObjectIds,
 
 }
 
+void UObjectRegister::BuildIndices()
+{
+  ObjectIndicesByLabel.Reset();
+  ObjectIndexById.Reset();
+  ObjectIndexById.Reserve(EnvironmentObjects.Num());
+  for(int32 i = 0; i < EnvironmentObjects.Num(); i++)
+  {
+    const FEnvironmentObject& Object = EnvironmentObjects[i];
+    ObjectIndicesByLabel.FindOrAdd(static_cast<uint8>(Object.ObjectLabel)).Add(i);
+    // 与之前的线性查找一致，Id 重复时使用第一个物体
+    if(!ObjectIndexById.Contains(Object.Id))
+    {
+      ObjectIndexById.Add(Object.Id, i);
+    }
+  }
+}
+
 void UObjectRegister::RegisterEnvironmentObject(
     AActor* Actor,
     FBoundingBox& BoundingBox,
@@ -62,11 +62,18 @@ private:
 
   void EnableISMComp(FEnvironmentObject& EnvironmentObject, bool Enable);
 
+  void BuildIndices();
+
   TMultiMap<uint64, const UStaticMeshComponent*> ObjectIdToComp;
 
   UPROPERTY(Category = "Carla Object Register", EditAnywhere)
   TArray<FEnvironmentObject> EnvironmentObjects;
 
+  // EnvironmentObjects 中按标签和 Id 索引的位置，注册时重新建立
+  TMap<uint8, TArray<int32>> ObjectIndicesByLabel;
+
+  TMap<uint64, int32> ObjectIndexById;
+
   int FoliageActorInstanceCount = 0;
 
 };
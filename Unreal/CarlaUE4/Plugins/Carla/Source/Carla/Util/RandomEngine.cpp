@@ -52,3 +52,44 @@ int32 URandomEngine::GenerateSeed()
             std::numeric_limits<int32>::lowest(),
             std::numeric_limits<int32>::max());
 }
+
+// 由密钥和下标得到一个32位的随机整数（lowbias32 哈希），只用整数乘法、异或和移位
+static FORCEINLINE uint32 HashCounter(const uint32 Key, const uint32 Counter)
+{
+    uint32 X = Counter * 0x9E3779B9u + Key;
+    X ^= X >> 16;
+    X *= 0x7FEB352Du;
+    X ^= X >> 15;
+    X *= 0x846CA68Bu;
+    X ^= X >> 16;
+    return X;
+}
+
+// 批量生成 [0, 1) 之间均匀分布的随机数，高24位正好是 float 的精度
+void URandomEngine::FillUniformFloat(float *Out, const int32 Count)
+{
+    const uint32 Key = static_cast<uint32>(Engine());
+    for (int32 i = 0; i < Count; ++i)
+    {
+        Out[i] = static_cast<float>(HashCounter(Key, static_cast<uint32>(i)) >> 8) * (1.0f / 16777216.0f);
+    }
+}
+
+// 批量生成正态分布的随机数，每两个均匀分布的随机数通过 Box-Muller 变换得到两个结果
+void URandomEngine::FillNormalFloat(float *Out, const int32 Count, const float Mean, const float StandardDeviation)
+{
+    const uint32 Key = static_cast<uint32>(Engine());
+    for (int32 i = 0; i < Count; i += 2)
+    {
+        // 1 - U 在 (0, 1] 之间，避免对0取对数
+        const float U1 = 1.0f - static_cast<float>(HashCounter(Key, static_cast<uint32>(i)) >> 8) * (1.0f / 16777216.0f);
+        const float U2 = static_cast<float>(HashCounter(Key, static_cast<uint32>(i + 1)) >> 8) * (1.0f / 16777216.0f);
+        const float Radius = StandardDeviation * FMath::Sqrt(-2.0f * FMath::Loge(U1));
+        const float Angle = 2.0f * PI * U2;
+        Out[i] = Mean + Radius * FMath::Cos(Angle);
+        if (i + 1 < Count)
+        {
+            Out[i + 1] = Mean + Radius * FMath::Sin(Angle);
+        }
+    }
+}
@@ -112,6 +112,20 @@ public:
     return std::normal_distribution<float>(Mean, StandardDeviation)(Engine);
   }
 
+  /// @}
+  // ===========================================================================
+  /// @name Bulk generation
+  // ===========================================================================
+  /// @{
+
+  /// 用 [0, 1) 之间均匀分布的随机数填充 @a Out 的前 @a Count 个元素。
+  /// 每次调用只从引擎取一个密钥，每个元素由密钥和下标的哈希独立生成，
+  /// 循环没有依赖，可以被编译器向量化。
+  void FillUniformFloat(float *Out, int32 Count);
+
+  /// 用正态分布的随机数填充 @a Out 的前 @a Count 个元素（Box-Muller）。
+  void FillNormalFloat(float *Out, int32 Count, float Mean, float StandardDeviation);
+
   /// @}
   // ===========================================================================
   /// @name Sampling distributions
@@ -168,6 +168,10 @@ FDenseTile::FDenseTile(FDenseTile&& Origin){
   TilePosition = Origin.TilePosition;
   SavePath = Origin.SavePath;
   bHeightmapNeedToUpdate = false;
+  bParticlesZOrderedInitialized = Origin.bParticlesZOrderedInitialized;
+  PartialHeightMapSize = Origin.PartialHeightMapSize;
+  TileSize = Origin.TileSize;
+  LastUsed = Origin.LastUsed;
   Particles = std::move(Origin.Particles);
   ParticlesHeightMap = std::move(Origin.ParticlesHeightMap);
   ParticlesZOrdered = std::move(Origin.ParticlesZOrdered);
@@ -178,6 +182,10 @@ FDenseTile& FDenseTile::operator=(FDenseTile&& Origin)
   TilePosition = Origin.TilePosition;
   SavePath = Origin.SavePath;
   bHeightmapNeedToUpdate = false;
+  bParticlesZOrderedInitialized = Origin.bParticlesZOrderedInitialized;
+  PartialHeightMapSize = Origin.PartialHeightMapSize;
+  TileSize = Origin.TileSize;
+  LastUsed = Origin.LastUsed;
   Particles = std::move(Origin.Particles);
   ParticlesHeightMap = std::move(Origin.ParticlesHeightMap);
   ParticlesZOrdered = std::move(Origin.ParticlesZOrdered);
@@ -194,15 +202,8 @@ void FDenseTile::InitializeTile(uint32_t TextureSize, float AffectedRadius, floa
   std::string FileName = std::string(TCHAR_TO_UTF8(*( SavePath + TileOrigin.ToString() + ".tile" ) ) );
   
   //UE_LOG(LogCarla, Log, TEXT("Tile origin %s"), *TileOrigin.ToString() );
-  if( FPaths::FileExists(FString(FileName.c_str())) )
+  if( FPaths::FileExists(FString(FileName.c_str())) && ReadFromFile(FileName) )
   {
-    
-    TRACE_CPUPROFILER_EVENT_SCOPE(DenseTile::InitializeTile::Read);
-    std::ifstream ReadStream(FileName);
-    FVector VectorToRead;
-    ReadFVector(ReadStream, VectorToRead );
-    TilePosition = FDVector(VectorToRead);
-    ReadStdVector<FParticle> (ReadStream, Particles);
     //UE_LOG(LogCarla, Log, TEXT("Reading data, got %d particles"), Particles.size());
   }
   else
@@ -248,6 +249,110 @@ void FDenseTile::InitializeTile(uint32_t TextureSize, float AffectedRadius, floa
   bHeightmapNeedToUpdate = true;
 }
 
+// "TILE", followed by the format version
+static constexpr uint32_t CustomTerrain_TileFileMagic = 0x454C4954;
+static constexpr uint32_t CustomTerrain_TileFileVersion = 2;
+
+bool FDenseTile::ReadFromFile(const std::string& FileName)
+{
+  TRACE_CPUPROFILER_EVENT_SCOPE(DenseTile::InitializeTile::Read);
+  std::ifstream ReadStream(FileName, std::ios::binary);
+  if (!ReadStream.good())
+  {
+    return false;
+  }
+  uint32_t Magic = 0;
+  uint32_t Version = 0;
+  ReadValue<uint32_t>(ReadStream, Magic);
+  ReadValue<uint32_t>(ReadStream, Version);
+  if (Magic != CustomTerrain_TileFileMagic)
+  {
+    // Tile saved by an older version: the whole FParticle, in a stream
+    // opened in text mode
+    std::ifstream LegacyStream(FileName);
+    FVector VectorToRead;
+    ReadFVector(LegacyStream, VectorToRead);
+    TilePosition = FDVector(VectorToRead);
+    ReadStdVector<FParticle>(LegacyStream, Particles);
+    return LegacyStream.good();
+  }
+  if (Version != CustomTerrain_TileFileVersion)
+  {
+    UE_LOG(LogCarla, Warning, TEXT("Unknown tile file version %u in %s"),
+        Version, UTF8_TO_TCHAR(FileName.c_str()));
+    return false;
+  }
+  float Radius = 0.f;
+  uint32_t NumParticles = 0;
+  ReadValue<double>(ReadStream, TilePosition.X);
+  ReadValue<double>(ReadStream, TilePosition.Y);
+  ReadValue<double>(ReadStream, TilePosition.Z);
+  ReadValue<float>(ReadStream, Radius);
+  ReadValue<uint32_t>(ReadStream, NumParticles);
+  std::vector<float> Offsets(3 * NumParticles);
+  std::vector<float> Velocities(3 * NumParticles);
+  ReadStream.read(reinterpret_cast<char*>(Offsets.data()), Offsets.size() * sizeof(float));
+  ReadStream.read(reinterpret_cast<char*>(Velocities.data()), Velocities.size() * sizeof(float));
+  if (!ReadStream.good())
+  {
+    return false;
+  }
+  Particles.resize(NumParticles);
+  for (uint32_t i = 0; i < NumParticles; ++i)
+  {
+    FParticle& Particle = Particles[i];
+    Particle.Position = TilePosition +
+        FDVector(Offsets[3*i], Offsets[3*i + 1], Offsets[3*i + 2]);
+    Particle.Velocity = FVector(Velocities[3*i], Velocities[3*i + 1], Velocities[3*i + 2]);
+    Particle.Radius = Radius;
+  }
+  return true;
+}
+
+void FDenseTile::WriteToFile(const std::string& FileName) const
+{
+  TRACE_CPUPROFILER_EVENT_SCOPE(DenseTile::WriteToFile);
+  // Particles are stored relative to the tile origin, a float offset keeps
+  // sub-millimetre precision within a tile
+  const uint32_t NumParticles = static_cast<uint32_t>(Particles.size());
+  std::vector<float> Offsets(3 * NumParticles);
+  std::vector<float> Velocities(3 * NumParticles);
+  for (uint32_t i = 0; i < NumParticles; ++i)
+  {
+    const FParticle& Particle = Particles[i];
+    Offsets[3*i]     = static_cast<float>(Particle.Position.X - TilePosition.X);
+    Offsets[3*i + 1] = static_cast<float>(Particle.Position.Y - TilePosition.Y);
+    Offsets[3*i + 2] = static_cast<float>(Particle.Position.Z - TilePosition.Z);
+    Velocities[3*i]     = Particle.Velocity.X;
+    Velocities[3*i + 1] = Particle.Velocity.Y;
+    Velocities[3*i + 2] = Particle.Velocity.Z;
+  }
+  const float Radius = Particles.empty() ? 0.f : Particles.front().Radius;
+
+  std::ofstream OutputStream(FileName, std::ios::binary | std::ios::trunc);
+  WriteValue<uint32_t>(OutputStream, CustomTerrain_TileFileMagic);
+  WriteValue<uint32_t>(OutputStream, CustomTerrain_TileFileVersion);
+  WriteValue<double>(OutputStream, TilePosition.X);
+  WriteValue<double>(OutputStream, TilePosition.Y);
+  WriteValue<double>(OutputStream, TilePosition.Z);
+  WriteValue<float>(OutputStream, Radius);
+  WriteValue<uint32_t>(OutputStream, NumParticles);
+  OutputStream.write(reinterpret_cast<const char*>(Offsets.data()), Offsets.size() * sizeof(float));
+  OutputStream.write(reinterpret_cast<const char*>(Velocities.data()), Velocities.size() * sizeof(float));
+  OutputStream.close();
+}
+
+size_t FDenseTile::GetMemoryUsage() const
+{
+  // Once ordered, every particle height is a node of a multiset, roughly a
+  // float plus three pointers and the node colour
+  const size_t ZOrderedNodeSize = sizeof(float) + 4 * sizeof(void*);
+  return Particles.capacity() * sizeof(FParticle) +
+      ParticlesHeightMap.capacity() * sizeof(float) +
+      ParticlesZOrdered.capacity() * sizeof(std::multiset<float,std::greater<float>>) +
+      (bParticlesZOrderedInitialized ? Particles.size() * ZOrderedNodeSize : 0);
+}
+
 void FDenseTile::InitializeDataStructure()
 {
   {
@@ -282,9 +387,10 @@ void FDenseTile::InitializeDataStructure()
 void FDenseTile::GetParticlesInRadius(FDVector Position, float Radius, std::vector<FParticle*> &ParticlesInRadius)
 {
   TRACE_CPUPROFILER_EVENT_SCOPE(FDenseTile::GetParticlesInRadius);
+  const float RadiusSquared = Radius*Radius;
   for (FParticle& particle : Particles)
   {
-    if((particle.Position - Position).SizeSquared() < Radius*Radius)
+    if((particle.Position - Position).SizeSquared() < RadiusSquared)
     {
       ParticlesInRadius.emplace_back(&particle);
     }
@@ -347,6 +453,14 @@ void FDenseTile::UpdateLocalHeightmap()
 // revise coordinates
 std::vector<FParticle*> FSparseHighDetailMap::
     GetParticlesInRadius(FDVector Position, float Radius)
+{
+  std::vector<FParticle*> ParticlesInRadius;
+  GetParticlesInRadius(Position, Radius, ParticlesInRadius);
+  return ParticlesInRadius;
+}
+
+void FSparseHighDetailMap::GetParticlesInRadius(
+    FDVector Position, float Radius, std::vector<FParticle*> &ParticlesOut)
 {
   TRACE_CPUPROFILER_EVENT_SCOPE(FSparseHighDetailMap::GetParticlesInRadius);
  
@@ -354,21 +468,15 @@ std::vector<FParticle*> FSparseHighDetailMap::
   uint32_t Tile_X = (uint32_t)(TileId >> 32);
   uint32_t Tile_Y = (uint32_t)(TileId & (uint32_t)(~0));
 
-  // FDenseTile& Tile = GetTile(TileId);
-  // return Tile.GetParticlesInRadius(Position, Radius);
-  std::vector<FParticle*> ParticlesInRadius;
-
-  GetTile(Tile_X-1, Tile_Y-1).GetParticlesInRadius(Position, Radius, ParticlesInRadius);
-  GetTile(Tile_X, Tile_Y-1).GetParticlesInRadius(Position, Radius, ParticlesInRadius);
-  GetTile(Tile_X+1, Tile_Y-1).GetParticlesInRadius(Position, Radius, ParticlesInRadius);
-  GetTile(Tile_X-1, Tile_Y).GetParticlesInRadius(Position, Radius, ParticlesInRadius);
-  GetTile(Tile_X, Tile_Y).GetParticlesInRadius(Position, Radius, ParticlesInRadius);
-  GetTile(Tile_X+1, Tile_Y).GetParticlesInRadius(Position, Radius, ParticlesInRadius);
-  GetTile(Tile_X-1, Tile_Y+1).GetParticlesInRadius(Position, Radius, ParticlesInRadius);
-  GetTile(Tile_X, Tile_Y+1).GetParticlesInRadius(Position, Radius, ParticlesInRadius);
-  GetTile(Tile_X+1, Tile_Y+1).GetParticlesInRadius(Position, Radius, ParticlesInRadius);
-
-  return ParticlesInRadius;
+  // The 3x3 tiles around the position
+  ParticlesOut.clear();
+  for (uint32_t Y = Tile_Y - 1; Y != Tile_Y + 2; ++Y)
+  {
+    for (uint32_t X = Tile_X - 1; X != Tile_X + 2; ++X)
+    {
+      GetTile(X, Y).GetParticlesInRadius(Position, Radius, ParticlesOut);
+    }
+  }
 }
 
 std::vector<FParticle*> FSparseHighDetailMap::
@@ -436,16 +544,23 @@ std::vector<FParticle*> FSparseHighDetailMap::
 
 std::vector<FParticle*> FSparseHighDetailMap::
     GetParticlesInBox(const FOrientedBox& OBox)
+{
+  std::vector<FParticle*> ParticlesInRadius;
+  GetParticlesInBox(OBox, ParticlesInRadius);
+  return ParticlesInRadius;
+}
+
+void FSparseHighDetailMap::GetParticlesInBox(
+    const FOrientedBox& OBox, std::vector<FParticle*> &ParticlesOut)
 {
   TRACE_CPUPROFILER_EVENT_SCOPE(FSparseHighDetailMap::GetParticlesInBox);
   std::vector<uint64_t> TilesToCheck = GetIntersectingTiles(OBox);
   
-  std::vector<FParticle*> ParticlesInRadius;
+  ParticlesOut.clear();
   for(uint64_t TileId : TilesToCheck)
   {
-    GetTile(TileId).GetParticlesInBox(OBox, ParticlesInRadius);
+    GetTile(TileId).GetParticlesInBox(OBox, ParticlesOut);
   }
-  return ParticlesInRadius;
 }
 
 std::vector<uint64_t> FSparseHighDetailMap::GetIntersectingTiles(
@@ -696,6 +811,8 @@ FDenseTile& FSparseHighDetailMap::InitializeRegion(uint64_t TileId)
   FDenseTile& Tile = Map[TileId]; 
   //UE_LOG(LogCarla, Log, TEXT("InitializeRegion Tile with (%f,%f,%f)"), 
   //  TileCenter.X,TileCenter.Y,TileCenter.Z);
+  // The tile may be evicted and still being written by the tiles thread
+  FScopeLock SaveLock(&Lock_Save);
   Tile.InitializeTile(
       TextureSize, AffectedRadius,
       ParticleSize, TerrainDepth,
@@ -791,7 +908,10 @@ void FSparseHighDetailMap::UpdateMaps(
       FIntVector VectorTileId = GetVectorTileId(TileId);
       if (!IsInMapRange(VectorTileId.X, VectorTileId.Y))
       {
-        CacheMap.emplace(TileId, std::move(Element.second));
+        // Overwrite any stale copy, the tile in Map has the latest deformation
+        FDenseTile& CachedTile = CacheMap[TileId];
+        CachedTile = std::move(Element.second);
+        CachedTile.LastUsed = ++CacheStamp;
         TilesToErase.emplace_back(TileId);
       }
     }
@@ -800,6 +920,9 @@ void FSparseHighDetailMap::UpdateMaps(
       Map.erase(TileId);
     }
   }
+  // Evicted tiles are moved out of the cache and written without holding
+  // Lock_CacheMap, so the game thread can keep pulling tiles from the cache
+  std::vector<FDenseTile> TilesToSave;
   {
     FScopeLock ScopeCacheLock(&Lock_CacheMap);
     TRACE_CPUPROFILER_EVENT_SCOPE(UpdateCache);
@@ -808,6 +931,8 @@ void FSparseHighDetailMap::UpdateMaps(
     std::vector<uint64_t> TilesToErase;
     {
       TRACE_CPUPROFILER_EVENT_SCOPE(GetTilesToErase);
+      std::vector<std::pair<uint64_t, uint64_t>> TilesByAge;
+      uint64_t CacheMemory = 0;
       for (auto &Element : CacheMap)
       {
         uint64_t TileId = Element.first;
@@ -816,33 +941,122 @@ void FSparseHighDetailMap::UpdateMaps(
         {
           TilesToErase.emplace_back(TileId);
         }
+        else if (CacheMemoryBudget > 0)
+        {
+          CacheMemory += Element.second.GetMemoryUsage();
+          TilesByAge.emplace_back(Element.second.LastUsed, TileId);
+        }
+      }
+      if (CacheMemory > CacheMemoryBudget)
+      {
+        // Least recently used tiles go first until the cache fits the budget
+        std::sort(TilesByAge.begin(), TilesByAge.end());
+        for (auto &Element : TilesByAge)
+        {
+          if (CacheMemory <= CacheMemoryBudget)
+          {
+            break;
+          }
+          CacheMemory -= std::min<uint64_t>(
+              CacheMemory, CacheMap[Element.second].GetMemoryUsage());
+          TilesToErase.emplace_back(Element.second);
+        }
       }
     }
 
     {
-      TRACE_CPUPROFILER_EVENT_SCOPE(EraseTiles);
-      ParallelFor(TilesToErase.size(), [&](int32 Idx)
+      TRACE_CPUPROFILER_EVENT_SCOPE(CacheMap.erase);
+      TilesToSave.reserve(TilesToErase.size());
+      for (uint64_t TileId : TilesToErase)
       {
-        TRACE_CPUPROFILER_EVENT_SCOPE(SaveData);
-        uint64_t TileId = TilesToErase[Idx];
-        auto& Tile = CacheMap[TileId];
-        std::string FileToSavePath = std::string(
-              TCHAR_TO_UTF8(*( SavePath + Tile.TilePosition.ToString() + ".tile")));
-        std::ofstream OutputStream(FileToSavePath.c_str());
-        WriteFVector(OutputStream, Tile.TilePosition.ToFVector());
-        WriteStdVector<FParticle> (OutputStream, Tile.Particles);
-        OutputStream.close();
-      });
+        auto Iterator = CacheMap.find(TileId);
+        TilesToSave.emplace_back(std::move(Iterator->second));
+        CacheMap.erase(Iterator);
+      }
+    }
+    // Taken before releasing the cache so no one reads these tiles from
+    // disk until they are written
+    Lock_Save.Lock();
+  }
+  SaveTiles(TilesToSave);
+  Lock_Save.Unlock();
+}
+
+void FSparseHighDetailMap::PrefetchTiles(
+    FDVector Position, float RadiusX, float RadiusY, uint32_t MaxTiles)
+{
+  TRACE_CPUPROFILER_EVENT_SCOPE(FSparseHighDetailMap::PrefetchTiles);
+  FIntVector MinVector = GetVectorTileId(
+      FDVector(Position.X - RadiusX, Position.Y - RadiusY, 0));
+  FIntVector MaxVector = GetVectorTileId(
+      FDVector(Position.X + RadiusX, Position.Y + RadiusY, 0));
+
+  std::vector<uint64_t> TilesToLoad;
+  {
+    FScopeLock ScopeLock(&Lock_Map);
+    FScopeLock ScopeCacheLock(&Lock_CacheMap);
+    for (int32_t X = MinVector.X; X <= MaxVector.X; X++)
+    {
+      for (int32_t Y = MinVector.Y; Y <= MaxVector.Y; Y++)
       {
-        TRACE_CPUPROFILER_EVENT_SCOPE(CacheMap.erase);
-        for (uint64_t TileId : TilesToErase)
+        uint64_t TileId = GetTileId(X, Y);
+        if (TilesToLoad.size() < MaxTiles &&
+            Map.find(TileId) == Map.end() &&
+            CacheMap.find(TileId) == CacheMap.end())
         {
-          CacheMap.erase(TileId); 
+          TilesToLoad.emplace_back(TileId);
         }
       }
     }
   }
+  if (TilesToLoad.empty())
+  {
+    return;
+  }
 
+  // Reading and generating the tiles happens without any map lock
+  std::vector<FDenseTile> LoadedTiles(TilesToLoad.size());
+  {
+    FScopeLock SaveLock(&Lock_Save);
+    ParallelFor(TilesToLoad.size(), [&](int32 Idx)
+    {
+      FDVector TileCenter = GetTilePosition(TilesToLoad[Idx]);
+      LoadedTiles[Idx].InitializeTile(
+          TextureSize, AffectedRadius,
+          ParticleSize, TerrainDepth,
+          TileCenter, TileCenter + FDVector(TileSize, TileSize, 0.f),
+          SavePath, Heightmap);
+    });
+  }
+
+  FScopeLock ScopeLock(&Lock_Map);
+  FScopeLock ScopeCacheLock(&Lock_CacheMap);
+  for (size_t i = 0; i < TilesToLoad.size(); ++i)
+  {
+    uint64_t TileId = TilesToLoad[i];
+    // The game thread may have loaded the tile itself in the meantime
+    if (Map.find(TileId) == Map.end() && CacheMap.find(TileId) == CacheMap.end())
+    {
+      LoadedTiles[i].LastUsed = ++CacheStamp;
+      CacheMap.emplace(TileId, std::move(LoadedTiles[i]));
+    }
+  }
+}
+
+std::string FSparseHighDetailMap::GetTileFileName(const FDVector& TilePosition) const
+{
+  return std::string(TCHAR_TO_UTF8(*( SavePath + TilePosition.ToString() + ".tile")));
+}
+
+void FSparseHighDetailMap::SaveTiles(const std::vector<FDenseTile>& Tiles)
+{
+  TRACE_CPUPROFILER_EVENT_SCOPE(FSparseHighDetailMap::SaveTiles);
+  ParallelFor(Tiles.size(), [&](int32 Idx)
+  {
+    TRACE_CPUPROFILER_EVENT_SCOPE(SaveData);
+    const FDenseTile& Tile = Tiles[Idx];
+    Tile.WriteToFile(GetTileFileName(Tile.TilePosition));
+  });
 }
 
 void FSparseHighDetailMap::Update(FVector Position, float RadiusX, float RadiusY)
@@ -890,26 +1104,21 @@ void FSparseHighDetailMap::SaveMap()
 {
   UE_LOG(LogCarla, Warning, TEXT("Save directory %s"), *SavePath );
   TRACE_CPUPROFILER_EVENT_SCOPE(FSparseHighDetailMap::SaveMap);
-  ParallelFor(Map.size(), [this](int32 Idx)
-  {
-    std::pair<uint64_t, FDenseTile> it = *(std::next(this->Map.begin(), Idx) );
-    std::string FileToSavePath = std::string(TCHAR_TO_UTF8(*( this->SavePath + it.second.TilePosition.ToString() + ".tile")));
-    std::ofstream OutputStream(FileToSavePath.c_str());
-    WriteFVector(OutputStream, it.second.TilePosition.ToFVector());
-    WriteStdVector<FParticle> (OutputStream, it.second.Particles);
-    OutputStream.close();
-  });
-  
-  ParallelFor(CacheMap.size(), [this](int32 Idx)
-  {
-    std::pair<uint64_t, FDenseTile> it = *(std::next(this->CacheMap.begin(), Idx) );
-    std::string FileToSavePath = std::string(TCHAR_TO_UTF8(*( this->SavePath + it.second.TilePosition.ToString() + ".tile")));
-    std::ofstream OutputStream(FileToSavePath.c_str());
-    WriteFVector(OutputStream, it.second.TilePosition.ToFVector());
-    WriteStdVector<FParticle> (OutputStream, it.second.Particles);
-    OutputStream.close();
+  std::vector<const FDenseTile*> TilesToSave;
+  TilesToSave.reserve(Map.size() + CacheMap.size());
+  for (auto &Element : Map)
+  {
+    TilesToSave.emplace_back(&Element.second);
+  }
+  for (auto &Element : CacheMap)
+  {
+    TilesToSave.emplace_back(&Element.second);
+  }
+  ParallelFor(TilesToSave.size(), [&](int32 Idx)
+  {
+    const FDenseTile* Tile = TilesToSave[Idx];
+    Tile->WriteToFile(GetTileFileName(Tile->TilePosition));
   });
-
 }
 
 void UCustomTerrainPhysicsComponent::UpdateTexture()
@@ -1300,6 +1509,10 @@ void UCustomTerrainPhysicsComponent::BeginPlay()
     TRACE_CPUPROFILER_EVENT_SCOPE(LoadNNModel);
     carla::learning::test_learning();
     TerramechanicsModel.LoadModel(TCHAR_TO_ANSI(*NeuralModelFile), CUDADevice);
+    if (bUseCUDAModel && bUseAsyncCUDAStream)
+    {
+      TerramechanicsModel.SetAsyncCUDAStream(true);
+    }
   }
 #endif
 
@@ -1334,6 +1547,8 @@ void UCustomTerrainPhysicsComponent::BeginPlay()
   UE_LOG(LogCarla, Log, TEXT("MainThread Data ArraySize %d "), Data.Num());
   UE_LOG(LogCarla, Log, TEXT("Map Size %d "), SparseMap.Map.size() );
 
+  SparseMap.SetCacheMemoryBudget(
+      static_cast<uint64_t>(FMath::Max(TileCacheBudgetMB, 0)) * 1024u * 1024u);
   if (TilesWorker == nullptr)
   {
     TilesWorker = new FTilesWorker(this, GetOwner()->GetActorLocation(), TileRadius.X, TileRadius.Y);
@@ -1777,6 +1992,32 @@ void UCustomTerrainPhysicsComponent::GenerateBenchmarkParticles(std::vector<FPar
   UE_LOG(LogCarla, Log, TEXT("Generated %d particles"), BenchParticles.size());
 }
 
+#ifdef WITH_PYTORCH
+// The wheel boxes of a vehicle share its axes, so two of them are disjoint
+// when their projections on any of those axes do not overlap
+static bool CustomTerrain_AreBoxesDisjoint(const FOrientedBox* const* Boxes, int Count)
+{
+  for (int i = 0; i < Count; ++i)
+  {
+    for (int j = i + 1; j < Count; ++j)
+    {
+      const FOrientedBox& A = *Boxes[i];
+      const FOrientedBox& B = *Boxes[j];
+      const FVector Delta = B.Center - A.Center;
+      const bool bSeparated =
+          FMath::Abs(FVector::DotProduct(Delta, A.AxisX)) >= A.ExtentX + B.ExtentX ||
+          FMath::Abs(FVector::DotProduct(Delta, A.AxisY)) >= A.ExtentY + B.ExtentY ||
+          FMath::Abs(FVector::DotProduct(Delta, A.AxisZ)) >= A.ExtentZ + B.ExtentZ;
+      if (!bSeparated)
+      {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+#endif
+
 void UCustomTerrainPhysicsComponent::RunNNPhysicsSimulation(
     ACarlaWheeledVehicle *Vehicle, float DeltaTime)
 {
@@ -1821,29 +2062,22 @@ void UCustomTerrainPhysicsComponent::RunNNPhysicsSimulation(
     DrawOrientedBox(GetWorld(), {BboxWheel0, BboxWheel1, BboxWheel2, BboxWheel3});
   }
 
-  std::vector<FParticle*> ParticlesWheel0, ParticlesWheel1, ParticlesWheel2, ParticlesWheel3;
+  const FOrientedBox* WheelBoxes[4] = {&BboxWheel0, &BboxWheel1, &BboxWheel2, &BboxWheel3};
+  const FTransform* WheelTransforms[4] = {
+      &WheelTransform0, &WheelTransform1, &WheelTransform2, &WheelTransform3};
+
+  std::vector<FParticle*> &ParticlesWheel0 = WheelScratch[0].Particles;
+  std::vector<FParticle*> &ParticlesWheel1 = WheelScratch[1].Particles;
+  std::vector<FParticle*> &ParticlesWheel2 = WheelScratch[2].Particles;
+  std::vector<FParticle*> &ParticlesWheel3 = WheelScratch[3].Particles;
   {
     TRACE_CPUPROFILER_EVENT_SCOPE(ParticleSearch);
-    auto GetAndFilterParticlesInBox = 
-        [&] (FOrientedBox& OBox) -> std::vector<FParticle*>
+    ParallelFor(4, [&](int32 WheelIdx)
     {
-      std::vector<FParticle*> Particles;
-      Particles = SparseMap.GetParticlesInBox(OBox);
+      std::vector<FParticle*> &Particles = WheelScratch[WheelIdx].Particles;
+      SparseMap.GetParticlesInBox(*WheelBoxes[WheelIdx], Particles);
       LimitParticlesPerWheel(Particles);
-      return Particles;
-    };
-    auto FutureParticles0 = Async(EAsyncExecution::ThreadPool, 
-        [&]() {return GetAndFilterParticlesInBox(BboxWheel0);});
-    auto FutureParticles2 = Async(EAsyncExecution::ThreadPool, 
-        [&]() {return GetAndFilterParticlesInBox(BboxWheel2);});
-    auto FutureParticles1 = Async(EAsyncExecution::ThreadPool, 
-        [&]() {return GetAndFilterParticlesInBox(BboxWheel1);});
-    auto FutureParticles3 = Async(EAsyncExecution::ThreadPool, 
-        [&]() {return GetAndFilterParticlesInBox(BboxWheel3);});
-    ParticlesWheel0 = FutureParticles0.Get();
-    ParticlesWheel2 = FutureParticles2.Get();
-    ParticlesWheel1 = FutureParticles1.Get();
-    ParticlesWheel3 = FutureParticles3.Get();
+    });
   }
 
   std::vector<FParticle> BenchParticles;
@@ -1867,45 +2101,37 @@ void UCustomTerrainPhysicsComponent::RunNNPhysicsSimulation(
     DrawTiles(GetWorld(), SparseMap.GetIntersectingTiles(BboxWheel3), BboxWheel3.Center.Z);
   }
 
-  TArray<float> ParticlePos0, ParticleVel0, ParticlePos1, ParticleVel1,
-                ParticlePos2, ParticleVel2, ParticlePos3, ParticleVel3;
-  TArray<float> WheelPos0, WheelOrient0, WheelLinVel0, WheelAngVel0;
-  TArray<float> WheelPos1, WheelOrient1, WheelLinVel1, WheelAngVel1;
-  TArray<float> WheelPos2, WheelOrient2, WheelLinVel2, WheelAngVel2;
-  TArray<float> WheelPos3, WheelOrient3, WheelLinVel3, WheelAngVel3;
   {
     TRACE_CPUPROFILER_EVENT_SCOPE(SetUpArrays);
-    SetUpParticleArrays(ParticlesWheel0, ParticlePos0, ParticleVel0, WheelTransform0);
-    SetUpParticleArrays(ParticlesWheel1, ParticlePos1, ParticleVel1, WheelTransform1);
-    SetUpParticleArrays(ParticlesWheel2, ParticlePos2, ParticleVel2, WheelTransform2);
-    SetUpParticleArrays(ParticlesWheel3, ParticlePos3, ParticleVel3, WheelTransform3);
-
-    SetUpWheelArrays(Vehicle, 0, WheelPos0, WheelOrient0, WheelLinVel0, WheelAngVel0);
-    SetUpWheelArrays(Vehicle, 1, WheelPos1, WheelOrient1, WheelLinVel1, WheelAngVel1);
-    SetUpWheelArrays(Vehicle, 2, WheelPos2, WheelOrient2, WheelLinVel2, WheelAngVel2);
-    SetUpWheelArrays(Vehicle, 3, WheelPos3, WheelOrient3, WheelLinVel3, WheelAngVel3);
-  }
-
-  carla::learning::WheelInput Wheel0 {
-      static_cast<int>(ParticlesWheel0.size()), 
-      ParticlePos0.GetData(), ParticleVel0.GetData(),
-      WheelPos0.GetData(), WheelOrient0.GetData(),
-      WheelLinVel0.GetData(), WheelAngVel0.GetData()};
-  carla::learning::WheelInput Wheel1 {
-      static_cast<int>(ParticlesWheel1.size()), 
-      ParticlePos1.GetData(), ParticleVel1.GetData(),
-      WheelPos1.GetData(), WheelOrient1.GetData(),
-      WheelLinVel1.GetData(), WheelAngVel1.GetData()};
-  carla::learning::WheelInput Wheel2 {
-      static_cast<int>(ParticlesWheel2.size()), 
-      ParticlePos2.GetData(), ParticleVel2.GetData(),
-      WheelPos2.GetData(), WheelOrient2.GetData(),
-      WheelLinVel2.GetData(), WheelAngVel2.GetData()};
-  carla::learning::WheelInput Wheel3 {
-      static_cast<int>(ParticlesWheel3.size()), 
-      ParticlePos3.GetData(), ParticleVel3.GetData(),
-      WheelPos3.GetData(), WheelOrient3.GetData(),
-      WheelLinVel3.GetData(), WheelAngVel3.GetData()};
+    ParallelFor(4, [&](int32 WheelIdx)
+    {
+      FWheelScratch &Scratch = WheelScratch[WheelIdx];
+      SetUpParticleArrays(Scratch.Particles, Scratch.ParticlePos, Scratch.ParticleVel,
+          *WheelTransforms[WheelIdx]);
+    });
+
+    // Reads the vehicle's physics state, stays on the game thread
+    for (int WheelIdx = 0; WheelIdx < 4; ++WheelIdx)
+    {
+      FWheelScratch &Scratch = WheelScratch[WheelIdx];
+      SetUpWheelArrays(Vehicle, WheelIdx, Scratch.WheelPos, Scratch.WheelOrientation,
+          Scratch.WheelLinearVelocity, Scratch.WheelAngularVelocity);
+    }
+  }
+
+  auto MakeWheelInput = [&](int WheelIdx) -> carla::learning::WheelInput
+  {
+    FWheelScratch &Scratch = WheelScratch[WheelIdx];
+    return carla::learning::WheelInput {
+        static_cast<int>(Scratch.Particles.size()),
+        Scratch.ParticlePos.GetData(), Scratch.ParticleVel.GetData(),
+        Scratch.WheelPos.GetData(), Scratch.WheelOrientation.GetData(),
+        Scratch.WheelLinearVelocity.GetData(), Scratch.WheelAngularVelocity.GetData()};
+  };
+  carla::learning::WheelInput Wheel0 = MakeWheelInput(0);
+  carla::learning::WheelInput Wheel1 = MakeWheelInput(1);
+  carla::learning::WheelInput Wheel2 = MakeWheelInput(2);
+  carla::learning::WheelInput Wheel3 = MakeWheelInput(3);
 
   const FVehicleControl& VehicleControl = Vehicle->GetVehicleControl();
   ASoilTypeManager* SoilTypeManagerActor =  Cast<ASoilTypeManager>(UGameplayStatics::GetActorOfClass(GetWorld(), ASoilTypeManager::StaticClass()));
@@ -1960,20 +2186,16 @@ void UCustomTerrainPhysicsComponent::RunNNPhysicsSimulation(
     {
       TRACE_CPUPROFILER_EVENT_SCOPE(UpdateParticles);
       FScopeLock ScopeLock(&SparseMap.Lock_Particles);
-      auto UpdateFutureParticles = 
-      [&] (std::vector<FParticle*>& Particles, std::vector<float>& Forces, float DeltaTime,
-          const FTransform& WheelTransform)
+      const std::vector<float>* WheelForces[4] = {
+          &Output.wheel0._particle_forces, &Output.wheel1._particle_forces,
+          &Output.wheel2._particle_forces, &Output.wheel3._particle_forces};
+      // A particle inside two boxes would be integrated by two tasks at once
+      const bool bBoxesDisjoint = CustomTerrain_AreBoxesDisjoint(WheelBoxes, 4);
+      ParallelFor(4, [&](int32 WheelIdx)
       {
-        UpdateParticles( Particles, Forces, DeltaTime, WheelTransform );
-      };
-      UpdateFutureParticles(
-          ParticlesWheel0, Output.wheel0._particle_forces, DeltaTime, WheelTransform0);
-      UpdateFutureParticles(
-          ParticlesWheel1, Output.wheel1._particle_forces, DeltaTime, WheelTransform1);
-      UpdateFutureParticles(
-          ParticlesWheel2, Output.wheel2._particle_forces, DeltaTime, WheelTransform2);
-      UpdateFutureParticles(
-          ParticlesWheel3, Output.wheel3._particle_forces, DeltaTime, WheelTransform3);
+        UpdateParticles(WheelScratch[WheelIdx].Particles, *WheelForces[WheelIdx], DeltaTime,
+            *WheelTransforms[WheelIdx]);
+      }, !bBoxesDisjoint);
     }
     if (DrawDebugInfo)
     {
@@ -2045,7 +2267,7 @@ void UCustomTerrainPhysicsComponent::RunNNPhysicsSimulation(
 }
 
 void UCustomTerrainPhysicsComponent::UpdateParticles(
-    std::vector<FParticle*> Particles, std::vector<float> Forces,
+    const std::vector<FParticle*>& Particles, const std::vector<float>& Forces,
     float DeltaTime, const FTransform& WheelTransform)
 {
   TRACE_CPUPROFILER_EVENT_SCOPE(UpdateParticles);
@@ -2463,67 +2685,57 @@ FVector UCustomTerrainPhysicsComponent::GetTileCenter(FVector Position)
               UEFrameToSI(Position))).ToFVector());
 }
 
-void UCustomTerrainPhysicsComponent::SetUpParticleArrays(std::vector<FParticle*>& ParticlesIn, 
+void UCustomTerrainPhysicsComponent::SetUpParticleArrays(const std::vector<FParticle*>& ParticlesIn, 
     TArray<float>& ParticlePosOut, 
     TArray<float>& ParticleVelOut,
     const FTransform &WheelTransform)
 {
-  ParticlePosOut.Empty();
-  ParticleVelOut.Empty();
-  ParticlePosOut.Reserve(ParticlesIn.size()*3);
-  ParticleVelOut.Reserve(ParticlesIn.size()*3);
+  // The network always takes MaxParticlesPerWheel particles, the missing
+  // ones are padded. The arrays keep their allocation between ticks.
+  const int32 NumParticles = static_cast<int32>(ParticlesIn.size());
+  const int32 NumTotal = FMath::Max(NumParticles, MaxParticlesPerWheel);
+  ParticlePosOut.SetNumUninitialized(NumTotal*3, false);
+  ParticleVelOut.SetNumUninitialized(NumTotal*3, false);
+  float* Pos = ParticlePosOut.GetData();
+  float* Vel = ParticleVelOut.GetData();
+  FVector Padding(0.f);
   if(bUseLocalFrame)
   {
     const FTransform InverseTransform = WheelTransform.Inverse();
-    for(FParticle* Particle : ParticlesIn)
+    for(const FParticle* Particle : ParticlesIn)
     {
       FVector UEPosition = SIToUEFrame(Particle->Position.ToFVector());
       FVector UELocalPosition = InverseTransform.TransformPosition(UEPosition);
       FVector Position = UEFrameToSI(UELocalPosition);
-      ParticlePosOut.Add(static_cast<float>(Position.X));
-      ParticlePosOut.Add(static_cast<float>(Position.Y));
-      ParticlePosOut.Add(static_cast<float>(Position.Z));
-      ParticleVelOut.Add(Particle->Velocity.X);
-      ParticleVelOut.Add(Particle->Velocity.Y);
-      ParticleVelOut.Add(Particle->Velocity.Z);
-    }
-    if(ParticlesIn.size() < MaxParticlesPerWheel)
-    {
-      for (int i = 0; i < (MaxParticlesPerWheel - ParticlesIn.size()); ++i)
-      {
-        ParticlePosOut.Add(0.f);
-        ParticlePosOut.Add(0.f);
-        ParticlePosOut.Add(0.f);
-        ParticleVelOut.Add(0.f);
-        ParticleVelOut.Add(0.f);
-        ParticleVelOut.Add(0.f);
-      }
+      *Pos++ = static_cast<float>(Position.X);
+      *Pos++ = static_cast<float>(Position.Y);
+      *Pos++ = static_cast<float>(Position.Z);
+      *Vel++ = Particle->Velocity.X;
+      *Vel++ = Particle->Velocity.Y;
+      *Vel++ = Particle->Velocity.Z;
     }
   }
   else
   {
-    for(FParticle* Particle : ParticlesIn)
+    for(const FParticle* Particle : ParticlesIn)
     {
-      ParticlePosOut.Add(static_cast<float>(Particle->Position.X));
-      ParticlePosOut.Add(static_cast<float>(Particle->Position.Y));
-      ParticlePosOut.Add(static_cast<float>(Particle->Position.Z));
-      ParticleVelOut.Add(Particle->Velocity.X);
-      ParticleVelOut.Add(Particle->Velocity.Y);
-      ParticleVelOut.Add(Particle->Velocity.Z);
-    }
-    if(ParticlesIn.size() < MaxParticlesPerWheel)
-    {
-      FVector WheelPosition = UEFrameToSI(WheelTransform.GetLocation());
-      for (int i = 0; i < (MaxParticlesPerWheel - ParticlesIn.size()); ++i)
-      {
-        ParticlePosOut.Add(WheelPosition.X);
-        ParticlePosOut.Add(WheelPosition.Y);
-        ParticlePosOut.Add(WheelPosition.Z);
-        ParticleVelOut.Add(0.f);
-        ParticleVelOut.Add(0.f);
-        ParticleVelOut.Add(0.f);
-      }
+      *Pos++ = static_cast<float>(Particle->Position.X);
+      *Pos++ = static_cast<float>(Particle->Position.Y);
+      *Pos++ = static_cast<float>(Particle->Position.Z);
+      *Vel++ = Particle->Velocity.X;
+      *Vel++ = Particle->Velocity.Y;
+      *Vel++ = Particle->Velocity.Z;
     }
+    Padding = UEFrameToSI(WheelTransform.GetLocation());
+  }
+  for (int32 i = NumParticles; i < NumTotal; ++i)
+  {
+    *Pos++ = Padding.X;
+    *Pos++ = Padding.Y;
+    *Pos++ = Padding.Z;
+    *Vel++ = 0.f;
+    *Vel++ = 0.f;
+    *Vel++ = 0.f;
   }
 }
 
@@ -2626,6 +2838,12 @@ void UCustomTerrainPhysicsComponent::UpdateMaps(
       UEFrameToSI(CacheRadiusX), UEFrameToSI(CacheRadiusY));
 }
 
+void UCustomTerrainPhysicsComponent::PrefetchTiles(FVector Position, float RadiusX, float RadiusY)
+{
+  SparseMap.PrefetchTiles(UEFrameToSI(Position), UEFrameToSI(RadiusX), UEFrameToSI(RadiusY),
+      static_cast<uint32_t>(FMath::Max(MaxPrefetchTiles, 0)));
+}
+
 FTilesWorker::FTilesWorker(UCustomTerrainPhysicsComponent* TerrainComp, FVector NewPosition, float NewRadiusX, float NewRadiusY )
 {
   CustomTerrainComp = TerrainComp;
@@ -2650,10 +2868,22 @@ uint32 FTilesWorker::Run(){
     FVector LastPosition = CustomTerrainComp->LastUpdatedPosition;
     if(Position != LastPosition)
     {
+      FVector Motion = LastPosition - Position;
+      Motion.Z = 0.f;
       Position = LastPosition;
-      CustomTerrainComp->UpdateMaps(CustomTerrainComp->LastUpdatedPosition,
+      CustomTerrainComp->UpdateMaps(Position,
           CustomTerrainComp->TileRadius.X, CustomTerrainComp->TileRadius.Y,
           CustomTerrainComp->CacheRadius.X, CustomTerrainComp->CacheRadius.Y);
+      // Load the tiles the vehicle is heading to before GetTile needs them
+      CustomTerrainComp->PrefetchTiles(Position,
+          CustomTerrainComp->TileRadius.X, CustomTerrainComp->TileRadius.Y);
+      CustomTerrainComp->PrefetchTiles(
+          Position + Motion.GetSafeNormal() * CustomTerrainComp->PrefetchDistance,
+          CustomTerrainComp->TileRadius.X, CustomTerrainComp->TileRadius.Y);
+    }
+    else
+    {
+      FPlatformProcess::Sleep(0.001f);
     }
     if(!bShouldContinue)
     {
@@ -96,6 +96,13 @@ struct FDenseTile
   void GetAllParticles(std::vector<FParticle*> &ParticlesInRadius);
   void InitializeDataStructure();
 
+  // Tile files store the origin once and the particles as float offsets
+  // and velocities. Files from older versions are still read.
+  bool ReadFromFile(const std::string& FileName);
+  void WriteToFile(const std::string& FileName) const;
+  // Approximate heap memory held by the tile
+  size_t GetMemoryUsage() const;
+
   void UpdateLocalHeightmap();
   std::vector<FParticle> Particles;
   std::vector<float> ParticlesHeightMap;
@@ -106,6 +113,8 @@ struct FDenseTile
   bool bHeightmapNeedToUpdate = false;
   uint32_t PartialHeightMapSize = 0;
   uint32_t TileSize = 0;
+  // Order in which the tile entered the cache, for LRU eviction
+  uint64_t LastUsed = 0;
 };
 
 class FSparseHighDetailMap
@@ -133,8 +142,12 @@ public:
   }
 
   std::vector<FParticle*> GetParticlesInRadius(FDVector Position, float Radius);
+  // Clears and fills ParticlesOut, reusing its capacity
+  void GetParticlesInRadius(FDVector Position, float Radius, std::vector<FParticle*> &ParticlesOut);
   std::vector<FParticle*> GetParticlesInTileRadius(FDVector Position, float Radius);
   std::vector<FParticle*> GetParticlesInBox(const FOrientedBox& OBox);
+  // Clears and fills ParticlesOut, reusing its capacity
+  void GetParticlesInBox(const FOrientedBox& OBox, std::vector<FParticle*> &ParticlesOut);
   std::vector<uint64_t> GetIntersectingTiles(const FOrientedBox& OBox);
   std::vector<uint64_t> GetLoadedTilesInRange(FDVector Position, float Radius);
 
@@ -167,6 +180,17 @@ public:
 
   void UpdateMaps(FDVector Position, float RadiusX, float RadiusY, float CacheRadiusX, float CacheRadiusY);
 
+  // Loads up to MaxTiles missing tiles around Position into the cache. Meant
+  // for the tiles thread, the locks are only held while checking and inserting.
+  void PrefetchTiles(FDVector Position, float RadiusX, float RadiusY, uint32_t MaxTiles);
+
+  // Cache size above which least recently used tiles are saved and unloaded,
+  // 0 keeps every tile in the cache range
+  void SetCacheMemoryBudget(uint64_t Bytes)
+  {
+    CacheMemoryBudget = Bytes;
+  }
+
   void Update(FVector Position, float RadiusX, float RadiusY);
 
   void SaveMap();
@@ -207,6 +231,9 @@ public:
   FString SavePath;
   FCriticalSection Lock_Particles;
 private:
+  std::string GetTileFileName(const FDVector& TilePosition) const;
+  void SaveTiles(const std::vector<FDenseTile>& Tiles);
+
   std::unordered_map<uint64_t, FDenseTile> TilesToWrite;
   FDVector Tile0Position;
   FDVector Extension;
@@ -222,6 +249,10 @@ private:
   FCriticalSection Lock_CacheMap; // UE4 Mutex
   FCriticalSection Lock_GetTile;
   FCriticalSection Lock_Position; // UE4 Mutex
+  // Held while evicted tiles are written, loading a tile from disk waits for it
+  FCriticalSection Lock_Save;
+  uint64_t CacheStamp = 0;
+  uint64_t CacheMemoryBudget = 0;
 
 };
 
@@ -276,6 +307,9 @@ public:
   UFUNCTION(BlueprintCallable, Category="Tiles")
   void UpdateMaps(FVector Position, float RadiusX, float RadiusY, float CacheRadiusX, float CacheRadiusY);
 
+  UFUNCTION(BlueprintCallable, Category="Tiles")
+  void PrefetchTiles(FVector Position, float RadiusX, float RadiusY);
+
   UFUNCTION(BlueprintCallable, Category="Texture")
   void InitTexture();
 
@@ -335,7 +369,7 @@ private:
   void RunNNPhysicsSimulation(
       ACarlaWheeledVehicle *Vehicle, float DeltaTime);
   // TArray<FParticle*> GetParticlesInRange(...);
-  void SetUpParticleArrays(std::vector<FParticle*>& ParticlesIn, 
+  void SetUpParticleArrays(const std::vector<FParticle*>& ParticlesIn, 
       TArray<float>& ParticlePosOut, 
       TArray<float>& ParticleVelOut,
       const FTransform &WheelTransform);
@@ -345,7 +379,7 @@ private:
       TArray<float>& WheelLinearVelocity, 
       TArray<float>& WheelAngularVelocity);
   void UpdateParticles(
-      std::vector<FParticle*> Particles, std::vector<float> Forces,
+      const std::vector<FParticle*>& Particles, const std::vector<float>& Forces,
       float DeltaTime, const FTransform& WheelTransform);
   void ApplyForcesToVehicle(
       ACarlaWheeledVehicle *Vehicle,
@@ -419,6 +453,17 @@ private:
   // TimeToTriggerLoadTiles in MS
   UPROPERTY(EditAnywhere, Category="Tiles")
   float TimeToTriggerLoadTiles = 1.0f;
+  // Distance ahead of the vehicle, along its motion, whose tiles are loaded
+  // in the background before it gets there (cm)
+  UPROPERTY(EditAnywhere, Category="Tiles")
+  float PrefetchDistance = 300.0f;
+  // Maximum tiles loaded by each prefetch pass of the tiles thread
+  UPROPERTY(EditAnywhere, Category="Tiles")
+  int32 MaxPrefetchTiles = 16;
+  // Memory budget of the tile cache (MB). Past it the least recently used
+  // tiles are saved and unloaded. 0 disables the budget
+  UPROPERTY(EditAnywhere, Category="Tiles")
+  int32 TileCacheBudgetMB = 2048;
   UPROPERTY(EditAnywhere, Category="Tiles")
   float TimeToTriggerUnLoadTiles = 5.0f;
   // Radius of the data collected by the texture in METERS
@@ -465,6 +510,9 @@ private:
   bool bUseDynamicModel = false;
   UPROPERTY(EditAnywhere)
   bool bUseCUDAModel = false;
+  // Run the CUDA model on its own stream instead of the default one
+  UPROPERTY(EditAnywhere)
+  bool bUseAsyncCUDAStream = false;
 
   UPROPERTY(EditAnywhere)
   float TireRadius = 33.0229f;
@@ -523,6 +571,21 @@ private:
 
   TArray<ACarlaWheeledVehicle*> Vehicles;
   FSparseHighDetailMap SparseMap;
+
+  // Per-wheel particle lists and network input arrays, kept between ticks
+  // so the simulation does not reallocate them for every vehicle. Each wheel
+  // is only touched by one task at a time.
+  struct FWheelScratch
+  {
+    std::vector<FParticle*> Particles;
+    TArray<float> ParticlePos;
+    TArray<float> ParticleVel;
+    TArray<float> WheelPos;
+    TArray<float> WheelOrientation;
+    TArray<float> WheelLinearVelocity;
+    TArray<float> WheelAngularVelocity;
+  };
+  FWheelScratch WheelScratch[4];
   TArray<uint8> Data;
   TArray<uint8> LargeData;
   #ifdef WITH_PYTORCH
@@ -0,0 +1,166 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "Carla.h"
+#include "Carla/Vehicle/KinematicVehicles.h"
+#include "Carla/Game/CarlaEpisode.h"
+#include "Carla/Vehicle/CarlaWheeledVehicle.h"
+
+#include "GameFramework/Controller.h"
+#include "Runtime/Core/Public/Async/ParallelFor.h"
+#include "WheeledVehicleMovementComponent.h"
+
+// 车辆较少时在游戏线程中积分，省去分发任务的开销
+static constexpr int32 ParallelIntegrationThreshold = 256;
+
+ECarlaServerResponse FKinematicVehicles::SetTarget(
+    UCarlaEpisode &Episode,
+    FCarlaActor::IdType ActorId,
+    const FTransform &Target,
+    const FVector &Velocity)
+{
+  if (const int32 *Index = Indices.Find(ActorId))
+  {
+    FKinematicVehicle &Vehicle = Vehicles[*Index];
+    Vehicle.Target = Target;
+    Vehicle.Velocity = Velocity;
+    return ECarlaServerResponse::Success;
+  }
+
+  FCarlaActor *CarlaActor = Episode.FindCarlaActor(ActorId);
+  if (CarlaActor == nullptr)
+  {
+    return ECarlaServerResponse::ActorNotFound;
+  }
+  if (CarlaActor->GetActorType() != FCarlaActor::ActorType::Vehicle)
+  {
+    return ECarlaServerResponse::NotAVehicle;
+  }
+  const ECarlaServerResponse Response = CarlaActor->SetActorSimulatePhysics(false);
+  if (Response != ECarlaServerResponse::Success)
+  {
+    return Response;
+  }
+
+  FKinematicVehicle Vehicle;
+  Vehicle.ActorId = ActorId;
+  Vehicle.Current = CarlaActor->GetActorGlobalTransform();
+  Vehicle.Target = Target;
+  Vehicle.Velocity = Velocity;
+  Vehicle.Displacement = FVector::ZeroVector;
+  Vehicle.bTickDisabled = false;
+  Indices.Add(ActorId, Vehicles.Add(Vehicle));
+  return ECarlaServerResponse::Success;
+}
+
+void FKinematicVehicles::Teleport(FCarlaActor::IdType ActorId, const FTransform &Transform)
+{
+  if (const int32 *Index = Indices.Find(ActorId))
+  {
+    FKinematicVehicle &Vehicle = Vehicles[*Index];
+    Vehicle.Current = Transform;
+    Vehicle.Target = Transform;
+  }
+}
+
+void FKinematicVehicles::Remove(UCarlaEpisode &Episode, FCarlaActor::IdType ActorId)
+{
+  const int32 *Index = Indices.Find(ActorId);
+  if (Index == nullptr)
+  {
+    return;
+  }
+  FCarlaActor *CarlaActor = Episode.FindCarlaActor(ActorId);
+  if (CarlaActor != nullptr && !CarlaActor->IsDormant() && Vehicles[*Index].bTickDisabled)
+  {
+    SetTickEnabled(*CarlaActor, true);
+  }
+  RemoveAt(*Index);
+}
+
+void FKinematicVehicles::Integrate(UCarlaEpisode &Episode, float DeltaSeconds)
+{
+  if (Vehicles.Num() == 0 || DeltaSeconds <= 0.0f)
+  {
+    return;
+  }
+  TRACE_CPUPROFILER_EVENT_SCOPE_STR(__FUNCTION__);
+
+  // 只有向量运算，可以在其他线程中进行。车辆以给定的速率向目标移动，到达后停在目标处
+  ParallelFor(Vehicles.Num(), [&](int32 Index) {
+    FKinematicVehicle &Vehicle = Vehicles[Index];
+    const FVector ToTarget = Vehicle.Target.GetLocation() - Vehicle.Current.GetLocation();
+    const float Distance = ToTarget.Size();
+    const float Step = Vehicle.Velocity.Size() * DeltaSeconds;
+    const float Alpha = Distance <= Step ? 1.0f : Step / Distance;
+    Vehicle.Displacement = Alpha * ToTarget;
+    Vehicle.Current.SetLocation(Vehicle.Current.GetLocation() + Vehicle.Displacement);
+    Vehicle.Current.SetRotation(
+        FQuat::Slerp(Vehicle.Current.GetRotation(), Vehicle.Target.GetRotation(), Alpha));
+  }, Vehicles.Num() < ParallelIntegrationThreshold);
+
+  // 移动参与者须在游戏线程中进行。倒序遍历，移除的位置由末尾已处理过的车辆填补
+  for (int32 Index = Vehicles.Num() - 1; Index >= 0; --Index)
+  {
+    FKinematicVehicle &Vehicle = Vehicles[Index];
+    FCarlaActor *CarlaActor = Episode.FindCarlaActor(Vehicle.ActorId);
+    if (CarlaActor == nullptr || CarlaActor->IsPendingKill())
+    {
+      RemoveAt(Index);
+      continue;
+    }
+    CarlaActor->SetActorGlobalTransform(Vehicle.Current, ETeleportType::TeleportPhysics);
+    if (CarlaActor->IsDormant())
+    {
+      // 唤醒时重新创建的车辆的 Tick 是开启的
+      Vehicle.bTickDisabled = false;
+      continue;
+    }
+    if (!Vehicle.bTickDisabled)
+    {
+      SetTickEnabled(*CarlaActor, false);
+      Vehicle.bTickDisabled = true;
+    }
+    // 不模拟物理的组件报告 ComponentVelocity，快照和传感器由此得到车辆的速度
+    if (USceneComponent *Root = CarlaActor->GetActor()->GetRootComponent())
+    {
+      Root->ComponentVelocity = Vehicle.Displacement / DeltaSeconds;
+    }
+  }
+}
+
+void FKinematicVehicles::Reset()
+{
+  Vehicles.Reset();
+  Indices.Reset();
+}
+
+void FKinematicVehicles::SetTickEnabled(FCarlaActor &CarlaActor, bool bEnabled)
+{
+  auto *Vehicle = Cast<ACarlaWheeledVehicle>(CarlaActor.GetActor());
+  if (Vehicle == nullptr)
+  {
+    return;
+  }
+  if (UWheeledVehicleMovementComponent *Movement = Vehicle->GetVehicleMovement())
+  {
+    Movement->SetComponentTickEnabled(bEnabled);
+  }
+  if (AController *Controller = Vehicle->GetController())
+  {
+    Controller->SetActorTickEnabled(bEnabled);
+  }
+}
+
+void FKinematicVehicles::RemoveAt(int32 Index)
+{
+  Indices.Remove(Vehicles[Index].ActorId);
+  Vehicles.RemoveAtSwap(Index);
+  if (Index < Vehicles.Num())
+  {
+    Indices[Vehicles[Index].ActorId] = Index;
+  }
+}
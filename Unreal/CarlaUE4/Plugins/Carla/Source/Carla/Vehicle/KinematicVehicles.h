@@ -0,0 +1,70 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "Carla/Actor/CarlaActor.h"
+#include "Carla/Server/CarlaServerResponse.h"
+
+class UCarlaEpisode;
+
+/// 不模拟物理的运动学车辆，例如交通管理器混合物理模式中远离英雄车辆的车辆。
+///
+/// 客户端只给出每辆车的目标变换和速度，服务器每帧在物理模拟之前把所有运动学车辆
+/// 一起向各自的目标移动，不需要客户端每帧为每辆车发送传送命令。运动学车辆的移动组件
+/// 和控制器不再 Tick，车辆恢复物理或被销毁时移出。
+class FKinematicVehicles
+{
+public:
+
+  /// 设置车辆 @a ActorId 的目标变换和速度（cm/s），车辆第一次设置时进入运动学模式。
+  ECarlaServerResponse SetTarget(
+      UCarlaEpisode &Episode,
+      FCarlaActor::IdType ActorId,
+      const FTransform &Target,
+      const FVector &Velocity);
+
+  /// 车辆 @a ActorId 被直接传送到 @a Transform（全局坐标）时调用，不再向原来的目标移动。
+  void Teleport(FCarlaActor::IdType ActorId, const FTransform &Transform);
+
+  /// 车辆 @a ActorId 退出运动学模式，恢复移动组件和控制器的 Tick。
+  void Remove(UCarlaEpisode &Episode, FCarlaActor::IdType ActorId);
+
+  /// 把所有运动学车辆向目标移动 @a DeltaSeconds，每帧在物理模拟之前调用一次。
+  void Integrate(UCarlaEpisode &Episode, float DeltaSeconds);
+
+  /// 剧集结束时丢弃所有车辆。
+  void Reset();
+
+  int32 Num() const
+  {
+    return Vehicles.Num();
+  }
+
+private:
+
+  struct FKinematicVehicle
+  {
+    FCarlaActor::IdType ActorId;
+    /// 全局坐标中的当前变换，大地图中不受原点平移影响
+    FTransform Current;
+    FTransform Target;
+    FVector Velocity;
+    /// 上一次积分的位移，用于报告车辆的速度
+    FVector Displacement;
+    /// 移动组件和控制器的 Tick 已关闭，休眠后唤醒的车辆需要重新关闭
+    bool bTickDisabled;
+  };
+
+  static void SetTickEnabled(FCarlaActor &CarlaActor, bool bEnabled);
+
+  void RemoveAt(int32 Index);
+
+  TArray<FKinematicVehicle> Vehicles;
+
+  /// 车辆 id 到 Vehicles 中索引的映射
+  TMap<FCarlaActor::IdType, int32> Indices;
+};
@@ -125,6 +125,67 @@ void AWalkerController::SetBonesTransform(const FWalkerBoneControlIn &WalkerBone
   }
 }
 
+USkeletalMeshComponent *AWalkerController::GetWalkerSkeletalMesh() const
+{
+  auto *Character = GetCharacter();
+  if (!Character) return nullptr;
+
+  TArray<USkeletalMeshComponent *> SkeletalMeshes;
+  Character->GetComponents<USkeletalMeshComponent>(SkeletalMeshes, false);
+  USkeletalMeshComponent *SkeletalMesh = SkeletalMeshes.IsValidIndex(0) ? SkeletalMeshes[0] : nullptr;
+  if (!SkeletalMesh) return nullptr;
+
+  return Cast<UWalkerAnim>(SkeletalMesh->GetAnimInstance()) != nullptr ? SkeletalMesh : nullptr;
+}
+
+void AWalkerController::SetBonesLocalTransforms(
+    const TMap<FName, int32> &BoneIndices,
+    const TArray<FTransform> &Transforms)
+{
+  USkeletalMeshComponent *SkeletalMesh = GetWalkerSkeletalMesh();
+  if (!SkeletalMesh) return;
+  UWalkerAnim *WalkerAnim = Cast<UWalkerAnim>(SkeletalMesh->GetAnimInstance());
+
+  // 与 SetBonesTransform 相同，姿势为空时先获得当前的姿势
+  if (WalkerAnim->Snap.BoneNames.Num() == 0)
+  {
+    SkeletalMesh->SnapshotPose(WalkerAnim->Snap);
+  }
+
+  // 只遍历一次姿势中的骨骼，每个骨骼查找一次映射
+  for (int i=0; i<WalkerAnim->Snap.BoneNames.Num(); ++i)
+  {
+    const int32 *Index = BoneIndices.Find(WalkerAnim->Snap.BoneNames[i]);
+    if (Index && Transforms.IsValidIndex(*Index))
+    {
+      WalkerAnim->Snap.LocalTransforms[i] = Transforms[*Index];
+    }
+  }
+}
+
+void AWalkerController::GetBonesLocalTransforms(
+    TArray<FName> &BoneNames,
+    TArray<FTransform> &Transforms)
+{
+  Transforms.Reset();
+  USkeletalMeshComponent *SkeletalMesh = GetWalkerSkeletalMesh();
+  if (!SkeletalMesh) return;
+
+  if (BoneNames.Num() == 0)
+  {
+    SkeletalMesh->GetBoneNames(BoneNames);
+  }
+
+  Transforms.Reserve(BoneNames.Num());
+  for (const FName &BoneName : BoneNames)
+  {
+    // 与 GetBonesTransform 的 Relative 相同
+    Transforms.Add(SkeletalMesh->GetBoneIndex(BoneName) != INDEX_NONE ?
+        SkeletalMesh->GetSocketTransform(BoneName, ERelativeTransformSpace::RTS_ParentBoneSpace) :
+        FTransform::Identity);
+  }
+}
+
 void AWalkerController::BlendPose(float Blend)
 {
   auto *Character = GetCharacter();
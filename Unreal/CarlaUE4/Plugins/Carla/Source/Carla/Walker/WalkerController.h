@@ -19,6 +19,8 @@
 
 #include "WalkerController.generated.h"
 
+class USkeletalMeshComponent;
+
 UCLASS()
 class CARLA_API AWalkerController : public AController
 {
@@ -60,7 +62,18 @@ public:
   UFUNCTION(BlueprintCallable)
   void GetPoseFromAnimation();//用于从动画中获取当前的行走者姿态。这意味着它会根据当前播放的动画更新行走者的姿态
 
+  /// 批量设置骨骼在父骨骼空间中的变换。@a BoneIndices 把骨骼名映射到 @a Transforms
+  /// 中的索引，可以在多个行人之间共用；没有列出的骨骼保持不变。
+  void SetBonesLocalTransforms(const TMap<FName, int32> &BoneIndices, const TArray<FTransform> &Transforms);
+
+  /// 按 @a BoneNames 的顺序取得骨骼在父骨骼空间中的变换，行人没有的骨骼为单位变换。
+  /// @a BoneNames 为空时先填入行人的所有骨骼。
+  void GetBonesLocalTransforms(TArray<FName> &BoneNames, TArray<FTransform> &Transforms);
+
 private:
 
+  /// 行人的骨骼网格体，没有行人动画时返回nullptr。
+  USkeletalMeshComponent *GetWalkerSkeletalMesh() const;
+
   FWalkerControl Control;
 };
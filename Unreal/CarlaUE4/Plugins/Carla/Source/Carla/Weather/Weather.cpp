@@ -6,10 +6,14 @@
 
 #include "Carla.h"
 #include "Carla/Weather/Weather.h"
+#include "Carla/Game/CarlaStatics.h"
 #include "Carla/Sensor/SceneCaptureCamera.h"
 #include "Components/SceneCaptureComponent2D.h"
-#include "Kismet/GameplayStatics.h"
 #include "ConstructorHelpers.h"
+#include "EngineUtils.h"
+
+// 异步模式下每帧最多更新后处理效果的相机数量，其余的在之后的帧中更新
+static constexpr int32 MaxCamerasPerFrame = 16;
 
 // AWeather类的构造函数,接受一个FObjectInitializer对象用于初始化类成员
 AWeather::AWeather(const FObjectInitializer& ObjectInitializer)
@@ -25,8 +29,9 @@ AWeather::AWeather(const FObjectInitializer& ObjectInitializer)
     DustStormPostProcessMaterial = ConstructorHelpers::FObjectFinder<UMaterial>(
         TEXT("Material'/Game/Carla/Static/GenericMaterials/00_MastersOpt/Screen_posProcess/M_screenDust_wind.M_screenDust_wind'")).Object;
 
-    // 设置该Actor的Tick函数是否可被调用,这里设置为false,表示不需要每帧更新
-    PrimaryActorTick.bCanEverTick = false;
+    // 只在有相机等待更新后处理效果时 Tick
+    PrimaryActorTick.bCanEverTick = true;
+    PrimaryActorTick.bStartWithTickEnabled = false;
     // 使用传入的ObjectInitializer创建一个默认的场景组件作为根组件,并将其命名为"RootComponent"
     RootComponent = ObjectInitializer.CreateDefaultSubobject<USceneComponent>(this, TEXT("RootComponent"));
 }
@@ -34,43 +39,69 @@ AWeather::AWeather(const FObjectInitializer& ObjectInitializer)
 // 检查并应用与天气相关的后处理效果的函数
 void AWeather::CheckWeatherPostProcessEffects()
 {
-    // 如果天气的降水参数大于0.0f
+    TMap<UMaterial*, float> Blendables;
+    // 降水和沙尘暴的强度（除以100.0f进行归一化）作为后处理材质的权重
     if (Weather.Precipitation > 0.0f)
-        // 将降水效果的后处理材质和降水强度（除以100.0f进行归一化）组成一个元组，添加到ActiveBlendables列表中
-        ActiveBlendables.Add(MakeTuple(PrecipitationPostProcessMaterial, Weather.Precipitation / 100.0f));
-    else
-        // 如果降水参数不大于0.0f，从ActiveBlendables列表中移除降水效果的后处理材质
-        ActiveBlendables.Remove(PrecipitationPostProcessMaterial);
-
-    // 如果天气的沙尘暴参数大于0.0f
+        Blendables.Add(PrecipitationPostProcessMaterial, Weather.Precipitation / 100.0f);
     if (Weather.DustStorm > 0.0f)
-        // 将沙尘暴效果的后处理材质和沙尘暴强度（除以100.0f进行归一化）组成一个元组，添加到ActiveBlendables列表
-        ActiveBlendables.Add(MakeTuple(DustStormPostProcessMaterial, Weather.DustStorm / 100.0f));
-    else
-        // 如果沙尘暴参数不大于0.0f，从ActiveBlendables列表中移除沙尘暴效果的后处理材质
-        ActiveBlendables.Remove(DustStormPostProcessMaterial);
-
-    // 创建一个数组用于存储场景中所有的传感器Actor
-    TArray<AActor*> SensorActors;
-    // 使用UGameplayStatics的GetAllActorsOfClass函数获取场景中所有ASceneCaptureCamera类的Actor，并存储到SensorActors数组中
-    UGameplayStatics::GetAllActorsOfClass(GetWorld(), ASceneCaptureCamera::StaticClass(), SensorActors);
-    // 遍历传感器Actor数组
-    for (AActor* SensorActor : SensorActors)
+        Blendables.Add(DustStormPostProcessMaterial, Weather.DustStorm / 100.0f);
+
+    // 只改变其它天气参数时相机的后处理设置不变
+    if (Blendables.OrderIndependentCompareEqual(ActiveBlendables))
+        return;
+    ActiveBlendables = MoveTemp(Blendables);
+
+    PendingCameras.Reset();
+    for (TActorIterator<ASceneCaptureCamera> It(GetWorld()); It; ++It)
+        PendingCameras.Add(*It);
+
+    // 同步模式下客户端期望下一帧所有相机都使用新的天气
+    UCarlaEpisode *Episode = UCarlaStatics::GetCurrentEpisode(GetWorld());
+    const bool bSynchronous = Episode != nullptr && Episode->GetSettings().bSynchronousMode;
+    ApplyPendingCameras(bSynchronous ? PendingCameras.Num() : MaxCamerasPerFrame);
+}
+
+void AWeather::ApplyPostProcessEffects(ASceneCaptureCamera &Camera) const
+{
+    FPostProcessSettings &Settings = Camera.GetCaptureComponent2D()->PostProcessSettings;
+    // 强度降为零的效果从相机中移除，已有的材质只更新权重
+    for (UMaterial *Material : {PrecipitationPostProcessMaterial, DustStormPostProcessMaterial})
+        if (!ActiveBlendables.Contains(Material))
+            Settings.RemoveBlendable(Material);
+    for (const auto &ActiveBlendable : ActiveBlendables)
+        Settings.AddBlendable(ActiveBlendable.Key, ActiveBlendable.Value);
+}
+
+void AWeather::ApplyPendingCameras(int32 MaxCameras)
+{
+    const int32 Count = FMath::Min(MaxCameras, PendingCameras.Num());
+    for (int32 Index = 0; Index < Count; ++Index)
     {
-        // 将当前遍历到的Actor转换为ASceneCaptureCamera类型的指针
-        ASceneCaptureCamera* Sensor = Cast<ASceneCaptureCamera>(SensorActor);
-        // 遍历ActiveBlendables列表中的每个元素（即每个后处理材质和强度的元组）
-        for (auto& ActiveBlendable : ActiveBlendables)
-            // 将当前元组中的后处理材质和强度添加到传感器的场景捕获组件2D的后处理设置中
-            Sensor->GetCaptureComponent2D()->PostProcessSettings.AddBlendable(ActiveBlendable.Key, ActiveBlendable.Value);
+        if (ASceneCaptureCamera *Camera = PendingCameras[Index].Get())
+            ApplyPostProcessEffects(*Camera);
     }
+    PendingCameras.RemoveAt(0, Count, false);
+    SetActorTickEnabled(PendingCameras.Num() > 0);
+}
+
+void AWeather::Tick(float DeltaSeconds)
+{
+    Super::Tick(DeltaSeconds);
+    ApplyPendingCameras(MaxCamerasPerFrame);
 }
 
 // 应用指定天气参数的函数
 void AWeather::ApplyWeather(const FWeatherParameters& InWeather)
 {
+    // 蓝图更新天气的代价较高，参数没有变化时（例如客户端每帧设置相同的天气）跳过
+    if (bWeatherApplied &&
+        FWeatherParameters::StaticStruct()->CompareScriptStruct(&Weather, &InWeather, PPF_None))
+    {
+        return;
+    }
     // 设置当前天气参数为传入的天气参数
     SetWeather(InWeather);
+    bWeatherApplied = true;
     // 检查并应用与天气相关的后处理效果
     CheckWeatherPostProcessEffects();
 
@@ -100,6 +131,14 @@ void AWeather::ApplyWeather(const FWeatherParameters& InWeather)
 // 通知天气相关变化给传感器的函数
 void AWeather::NotifyWeather(ASensor* Sensor)
 {
+    // 新生成的传感器只需要当前的后处理效果，不需要重新应用到其它相机和蓝图
+    if (Sensor != nullptr)
+    {
+        if (ASceneCaptureCamera *Camera = Cast<ASceneCaptureCamera>(Sensor))
+            ApplyPostProcessEffects(*Camera);
+        return;
+    }
+
     // 检查并应用与天气相关的后处理效果
     CheckWeatherPostProcessEffects();
 
@@ -111,6 +150,8 @@ void AWeather::NotifyWeather(ASensor* Sensor)
 void AWeather::SetWeather(const FWeatherParameters& InWeather)
 {
     Weather = InWeather;
+    // 蓝图还没有应用这些参数，下一次 ApplyWeather 不能跳过
+    bWeatherApplied = false;
 }
 
 // 设置日夜循环状态的函数
@@ -27,7 +27,7 @@ public:
   UFUNCTION(BlueprintCallable)
   void ApplyWeather(const FWeatherParameters &WeatherParameters);
 
-  /// 将天气通知到蓝图的事件
+  /// 将天气通知到蓝图的事件。给出 @a Sensor 时只把当前的后处理效果应用到这个传感器
   void NotifyWeather(ASensor* Sensor = nullptr);
 
   /// 在不通知蓝图事件的情况下更新天气参数
@@ -58,11 +58,19 @@ protected:
 // 刷新天气参数
   void RefreshWeather(const FWeatherParameters &WeatherParameters);
 
+  virtual void Tick(float DeltaSeconds) override;
+
 private:
 
-// 检查天气后处理效果
+// 检查天气后处理效果，材质或权重有变化时把差异应用到所有相机
   void CheckWeatherPostProcessEffects();
 
+// 把当前的后处理材质应用到相机上，并移除不再使用的材质
+  void ApplyPostProcessEffects(ASceneCaptureCamera &Camera) const;
+
+// 应用 PendingCameras 中最多 MaxCameras 个相机，全部完成后关闭 Tick
+  void ApplyPendingCameras(int32 MaxCameras);
+
 // 这是一个在任何地方都可见的属性
 // 天气参数
   UPROPERTY(VisibleAnywhere)
@@ -79,6 +87,12 @@ private:
 // 活动混合
   TMap<UMaterial*, float> ActiveBlendables;
 
+// 还没有应用当前后处理效果的相机，异步模式下相机很多时分散到之后的几帧
+  TArray<TWeakObjectPtr<ASceneCaptureCamera>> PendingCameras;
+
+// 蓝图已经至少应用过一次天气
+  bool bWeatherApplied = false;
+
   UPROPERTY(EditAnywhere, Category = "Weather")
 // 这是一个在任何地方都可编辑的属性，分类为"Weather"
 // 日夜循环是否启用
@@ -0,0 +1,39 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+using UnrealBuildTool;
+
+// Global shaders of the CARLA plugin. They live in their own module because
+// shader types must be registered before the engine compiles the global shader
+// map, i.e. in the PostConfigInit loading phase.
+public class CarlaShaders : ModuleRules
+{
+  public CarlaShaders(ReadOnlyTargetRules Target) : base(Target)
+  {
+    PCHUsage = PCHUsageMode.UseExplicitOrSharedPCHs;
+
+    PublicIncludePaths.Add(ModuleDirectory);
+
+    PublicDependencyModuleNames.AddRange(
+      new string[]
+      {
+        "Core",
+        "RenderCore",
+        "RHI"
+      }
+      );
+
+    PrivateDependencyModuleNames.AddRange(
+      new string[]
+      {
+        "CoreUObject",
+        "Engine",
+        "Projects",
+        "Renderer"
+      }
+      );
+  }
+}
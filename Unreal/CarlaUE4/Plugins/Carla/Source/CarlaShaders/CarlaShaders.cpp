@@ -0,0 +1,27 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "CoreMinimal.h"
+#include "Interfaces/IPluginManager.h"
+#include "Misc/Paths.h"
+#include "Modules/ModuleManager.h"
+#include "ShaderCore.h"
+
+class FCarlaShadersModule : public IModuleInterface
+{
+public:
+
+  void StartupModule() override
+  {
+    // Shaders of the plugin are referenced as "/Plugin/Carla/Private/...".
+    const FString ShaderDir = FPaths::Combine(
+        IPluginManager::Get().FindPlugin(TEXT("Carla"))->GetBaseDir(),
+        TEXT("Shaders"));
+    AddShaderSourceDirectoryMapping(TEXT("/Plugin/Carla"), ShaderDir);
+  }
+};
+
+IMPLEMENT_MODULE(FCarlaShadersModule, CarlaShaders)
@@ -0,0 +1,199 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "DVSEvents.h"
+
+#include "PixelConversion.h"
+
+#include "GlobalShader.h"
+#include "RenderGraphUtils.h"
+#include "ShaderParameterStruct.h"
+
+// =============================================================================
+// -- FCarlaDVSEventsCS --------------------------------------------------------
+// =============================================================================
+
+class FCarlaDVSEventsCS : public FGlobalShader
+{
+public:
+
+  DECLARE_GLOBAL_SHADER(FCarlaDVSEventsCS);
+  SHADER_USE_PARAMETER_STRUCT(FCarlaDVSEventsCS, FGlobalShader);
+
+  static constexpr int32 ThreadGroupSize = 8;
+
+  BEGIN_SHADER_PARAMETER_STRUCT(FParameters, )
+    SHADER_PARAMETER_SRV(Texture2D<float4>, InputImage)
+    SHADER_PARAMETER_UAV(RWTexture2D<float>, Previous)
+    SHADER_PARAMETER_UAV(RWTexture2D<float>, Reference)
+    SHADER_PARAMETER_UAV(RWTexture2D<uint>, LastEventAge)
+    SHADER_PARAMETER_UAV(RWStructuredBuffer<uint4>, Events)
+    SHADER_PARAMETER_UAV(RWStructuredBuffer<uint>, Counter)
+    SHADER_PARAMETER(FIntPoint, Size)
+    SHADER_PARAMETER(uint32, MaxEvents)
+    SHADER_PARAMETER(uint32, bInitialize)
+    SHADER_PARAMETER(uint32, bUseLog)
+    SHADER_PARAMETER(float, LogEps)
+    SHADER_PARAMETER(float, Cp)
+    SHADER_PARAMETER(float, Cm)
+    SHADER_PARAMETER(float, SigmaCp)
+    SHADER_PARAMETER(float, SigmaCm)
+    SHADER_PARAMETER(uint32, RefractoryPeriodNs)
+    SHADER_PARAMETER(uint32, DeltaTimeNs)
+    SHADER_PARAMETER(uint32, NoiseSeed)
+  END_SHADER_PARAMETER_STRUCT()
+
+  static bool ShouldCompilePermutation(const FGlobalShaderPermutationParameters &Parameters)
+  {
+    return IsFeatureLevelSupported(Parameters.Platform, ERHIFeatureLevel::SM5);
+  }
+
+  static void ModifyCompilationEnvironment(
+      const FGlobalShaderPermutationParameters &Parameters,
+      FShaderCompilerEnvironment &OutEnvironment)
+  {
+    FGlobalShader::ModifyCompilationEnvironment(Parameters, OutEnvironment);
+    OutEnvironment.SetDefine(TEXT("THREADGROUP_SIZE"), ThreadGroupSize);
+  }
+};
+
+IMPLEMENT_GLOBAL_SHADER(FCarlaDVSEventsCS, "/Plugin/Carla/Private/DVSEvents.usf", "MainCS", SF_Compute);
+
+// =============================================================================
+// -- Event simulation ---------------------------------------------------------
+// =============================================================================
+
+// Local namespace to avoid name collisions on unit builds.
+namespace DVSEvents_local_ns {
+
+  /// Room for this many events per pixel and frame before dropping them.
+  constexpr uint32 EventsPerPixel = 2u;
+
+  static FTexture2DRHIRef CreateStateTexture(
+      const FIntPoint Size,
+      const EPixelFormat Format,
+      const TCHAR *Name)
+  {
+    FRHIResourceCreateInfo CreateInfo(Name);
+    return RHICreateTexture2D(
+        Size.X, Size.Y, Format, 1, 1,
+        TexCreate_ShaderResource | TexCreate_UAV,
+        ERHIAccess::UAVCompute,
+        CreateInfo);
+  }
+
+} // namespace DVSEvents_local_ns
+
+uint32 SimulateCarlaDVSEvents(
+    FRHICommandListImmediate &RHICmdList,
+    FRHITexture2D *Image,
+    const FCarlaDVSConfig &Config,
+    const uint32 DeltaTimeNs,
+    const uint32 NoiseSeed,
+    FCarlaDVSState &State,
+    TArray<FCarlaDVSGPUEvent> &OutEvents)
+{
+  using namespace DVSEvents_local_ns;
+  TRACE_CPUPROFILER_EVENT_SCOPE_STR("SimulateCarlaDVSEvents");
+  check(IsInRenderingThread());
+  check(Image != nullptr);
+  check(IsCarlaPixelConversionSupported());
+
+  OutEvents.Reset();
+
+  const FIntPoint Size = Image->GetSizeXY();
+  if (!State.Previous.IsValid() || State.Previous->GetSizeXY() != Size)
+  {
+    State.Previous = CreateStateTexture(Size, PF_R32_FLOAT, TEXT("CarlaDVSPrevious"));
+    State.Reference = CreateStateTexture(Size, PF_R32_FLOAT, TEXT("CarlaDVSReference"));
+    State.LastEventAge = CreateStateTexture(Size, PF_R32_UINT, TEXT("CarlaDVSLastEventAge"));
+    State.MaxEvents = static_cast<uint32>(Size.X * Size.Y) * EventsPerPixel;
+    FRHIResourceCreateInfo EventsInfo(TEXT("CarlaDVSEvents"));
+    State.Events = RHICreateStructuredBuffer(
+        sizeof(FCarlaDVSGPUEvent),
+        State.MaxEvents * sizeof(FCarlaDVSGPUEvent),
+        BUF_UnorderedAccess | BUF_ShaderResource | BUF_SourceCopy,
+        ERHIAccess::UAVCompute,
+        EventsInfo);
+    FRHIResourceCreateInfo CounterInfo(TEXT("CarlaDVSCounter"));
+    State.Counter = RHICreateStructuredBuffer(
+        sizeof(uint32),
+        sizeof(uint32),
+        BUF_UnorderedAccess | BUF_ShaderResource | BUF_SourceCopy,
+        ERHIAccess::UAVCompute,
+        CounterInfo);
+    State.bInitialized = false;
+  }
+
+  FRHITextureSRVCreateInfo SRVCreateInfo(0u, 1u, Image->GetFormat());
+  SRVCreateInfo.SRGBOverride = SRGBO_ForceDisable;
+  FShaderResourceViewRHIRef InputSRV = RHICreateShaderResourceView(Image, SRVCreateInfo);
+  FUnorderedAccessViewRHIRef EventsUAV = RHICreateUnorderedAccessView(State.Events, false, false);
+  FUnorderedAccessViewRHIRef CounterUAV = RHICreateUnorderedAccessView(State.Counter, false, false);
+
+  FCarlaDVSEventsCS::FParameters Parameters;
+  Parameters.InputImage = InputSRV;
+  Parameters.Previous = RHICreateUnorderedAccessView(State.Previous, 0u);
+  Parameters.Reference = RHICreateUnorderedAccessView(State.Reference, 0u);
+  Parameters.LastEventAge = RHICreateUnorderedAccessView(State.LastEventAge, 0u);
+  Parameters.Events = EventsUAV;
+  Parameters.Counter = CounterUAV;
+  Parameters.Size = Size;
+  Parameters.MaxEvents = State.MaxEvents;
+  Parameters.bInitialize = State.bInitialized ? 0u : 1u;
+  Parameters.bUseLog = Config.bUseLog ? 1u : 0u;
+  Parameters.LogEps = Config.LogEps;
+  Parameters.Cp = Config.Cp;
+  Parameters.Cm = Config.Cm;
+  Parameters.SigmaCp = Config.SigmaCp;
+  Parameters.SigmaCm = Config.SigmaCm;
+  Parameters.RefractoryPeriodNs = Config.RefractoryPeriodNs;
+  Parameters.DeltaTimeNs = DeltaTimeNs;
+  Parameters.NoiseSeed = NoiseSeed;
+
+  TShaderMapRef<FCarlaDVSEventsCS> ComputeShader(GetGlobalShaderMap(GMaxRHIFeatureLevel));
+
+  RHICmdList.Transition({
+      FRHITransitionInfo(Image, ERHIAccess::Unknown, ERHIAccess::SRVCompute),
+      FRHITransitionInfo(State.Previous, ERHIAccess::Unknown, ERHIAccess::UAVCompute),
+      FRHITransitionInfo(State.Reference, ERHIAccess::Unknown, ERHIAccess::UAVCompute),
+      FRHITransitionInfo(State.LastEventAge, ERHIAccess::Unknown, ERHIAccess::UAVCompute),
+      FRHITransitionInfo(EventsUAV, ERHIAccess::Unknown, ERHIAccess::UAVCompute),
+      FRHITransitionInfo(CounterUAV, ERHIAccess::Unknown, ERHIAccess::UAVCompute)});
+  RHICmdList.ClearUAVUint(CounterUAV, FUintVector4(0u, 0u, 0u, 0u));
+  FComputeShaderUtils::Dispatch(
+      RHICmdList,
+      ComputeShader,
+      Parameters,
+      FComputeShaderUtils::GetGroupCount(Size, FCarlaDVSEventsCS::ThreadGroupSize));
+  RHICmdList.Transition({
+      FRHITransitionInfo(EventsUAV, ERHIAccess::UAVCompute, ERHIAccess::CPURead),
+      FRHITransitionInfo(CounterUAV, ERHIAccess::UAVCompute, ERHIAccess::CPURead)});
+
+  if (!State.bInitialized)
+  {
+    State.bInitialized = true;
+    return 0u;
+  }
+
+  // Read the counter first so only the events written are copied.
+  uint32 Count = 0u;
+  {
+    const void *Data = RHILockStructuredBuffer(State.Counter, 0u, sizeof(uint32), RLM_ReadOnly);
+    FMemory::Memcpy(&Count, Data, sizeof(uint32));
+    RHIUnlockStructuredBuffer(State.Counter);
+  }
+  const uint32 Written = FMath::Min(Count, State.MaxEvents);
+  if (Written > 0u)
+  {
+    const uint32 Bytes = Written * sizeof(FCarlaDVSGPUEvent);
+    OutEvents.SetNumUninitialized(Written);
+    const void *Data = RHILockStructuredBuffer(State.Events, 0u, Bytes, RLM_ReadOnly);
+    FMemory::Memcpy(OutEvents.GetData(), Data, Bytes);
+    RHIUnlockStructuredBuffer(State.Events);
+  }
+  return Count - Written;
+}
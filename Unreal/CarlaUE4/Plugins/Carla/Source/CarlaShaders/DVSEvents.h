@@ -0,0 +1,70 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "RHI.h"
+#include "RHICommandList.h"
+
+/// Thresholds of the event simulation, see dvs::Config in DVSCamera.h.
+struct FCarlaDVSConfig
+{
+  float Cp = 0.5f;
+
+  float Cm = 0.5f;
+
+  float SigmaCp = 0.f;
+
+  float SigmaCm = 0.f;
+
+  uint32 RefractoryPeriodNs = 0u;
+
+  bool bUseLog = true;
+
+  float LogEps = 1e-3f;
+};
+
+/// Event as read back from the GPU: x | (y << 16), time since the start of the
+/// frame in nanoseconds, polarity (1 positive, 0 negative) and padding.
+using FCarlaDVSGPUEvent = FUintVector4;
+
+/// Per-pixel state of the simulation kept on the GPU between frames: the
+/// previous intensity, the last crossed reference and the time since the last
+/// event of each pixel. Only to be used from the render-thread.
+struct CARLASHADERS_API FCarlaDVSState
+{
+  FTexture2DRHIRef Previous;
+
+  FTexture2DRHIRef Reference;
+
+  FTexture2DRHIRef LastEventAge;
+
+  FStructuredBufferRHIRef Events;
+
+  FStructuredBufferRHIRef Counter;
+
+  /// Events that fit in Events, the rest of a frame are dropped.
+  uint32 MaxEvents = 0u;
+
+  /// Whether the state holds a previous frame.
+  bool bInitialized = false;
+};
+
+/// Simulate the events between the previous frame in @a State and @a Image in
+/// a compute shader, and read back only the events. @a OutEvents is not
+/// sorted. Returns the number of events dropped because the buffer was full.
+/// The first call only initializes @a State.
+///
+/// @pre To be called from render-thread. IsCarlaPixelConversionSupported().
+CARLASHADERS_API uint32 SimulateCarlaDVSEvents(
+    FRHICommandListImmediate &RHICmdList,
+    FRHITexture2D *Image,
+    const FCarlaDVSConfig &Config,
+    uint32 DeltaTimeNs,
+    uint32 NoiseSeed,
+    FCarlaDVSState &State,
+    TArray<FCarlaDVSGPUEvent> &OutEvents);
@@ -0,0 +1,118 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "LidarResample.h"
+
+#include "PixelConversion.h"
+
+#include "GlobalShader.h"
+#include "RenderGraphUtils.h"
+#include "ShaderParameterStruct.h"
+
+// =============================================================================
+// -- FCarlaLidarResampleCS ----------------------------------------------------
+// =============================================================================
+
+class FCarlaLidarResampleCS : public FGlobalShader
+{
+public:
+
+  DECLARE_GLOBAL_SHADER(FCarlaLidarResampleCS);
+  SHADER_USE_PARAMETER_STRUCT(FCarlaLidarResampleCS, FGlobalShader);
+
+  static constexpr int32 ThreadGroupSize = 64;
+
+  BEGIN_SHADER_PARAMETER_STRUCT(FParameters, )
+    SHADER_PARAMETER_TEXTURE(TextureCube, DepthCube)
+    SHADER_PARAMETER_SAMPLER(SamplerState, DepthSampler)
+    SHADER_PARAMETER_UAV(RWStructuredBuffer<float4>, OutputPoints)
+    SHADER_PARAMETER(uint32, Channels)
+    SHADER_PARAMETER(uint32, PointsPerChannel)
+    SHADER_PARAMETER(float, UpperFovLimit)
+    SHADER_PARAMETER(float, VerticalStep)
+    SHADER_PARAMETER(float, StartAngle)
+    SHADER_PARAMETER(float, HorizontalStep)
+    SHADER_PARAMETER(float, HorizontalFov)
+    SHADER_PARAMETER(float, Range)
+  END_SHADER_PARAMETER_STRUCT()
+
+  static bool ShouldCompilePermutation(const FGlobalShaderPermutationParameters &Parameters)
+  {
+    return IsFeatureLevelSupported(Parameters.Platform, ERHIFeatureLevel::SM5);
+  }
+
+  static void ModifyCompilationEnvironment(
+      const FGlobalShaderPermutationParameters &Parameters,
+      FShaderCompilerEnvironment &OutEnvironment)
+  {
+    FGlobalShader::ModifyCompilationEnvironment(Parameters, OutEnvironment);
+    OutEnvironment.SetDefine(TEXT("THREADGROUP_SIZE"), ThreadGroupSize);
+  }
+};
+
+IMPLEMENT_GLOBAL_SHADER(FCarlaLidarResampleCS, "/Plugin/Carla/Private/LidarResample.usf", "MainCS", SF_Compute);
+
+// =============================================================================
+// -- Resampling functions -----------------------------------------------------
+// =============================================================================
+
+void ResampleCarlaLidarBeams(
+    FRHICommandListImmediate &RHICmdList,
+    FRHITexture *DepthCube,
+    const FCarlaLidarBeamParameters &Beams,
+    TArray<FVector4> &OutPoints)
+{
+  TRACE_CPUPROFILER_EVENT_SCOPE_STR("ResampleCarlaLidarBeams");
+  check(IsInRenderingThread());
+  check(DepthCube != nullptr);
+  check(IsCarlaPixelConversionSupported());
+
+  const uint32 BeamCount = Beams.Channels * Beams.PointsPerChannel;
+  OutPoints.SetNumUninitialized(BeamCount);
+  if (BeamCount == 0u)
+  {
+    return;
+  }
+
+  const uint32 BufferSize = BeamCount * sizeof(FVector4);
+  FRHIResourceCreateInfo CreateInfo(TEXT("CarlaLidarBeams"));
+  FStructuredBufferRHIRef Points = RHICreateStructuredBuffer(
+      sizeof(FVector4),
+      BufferSize,
+      BUF_UnorderedAccess | BUF_ShaderResource | BUF_SourceCopy,
+      ERHIAccess::UAVCompute,
+      CreateInfo);
+  FUnorderedAccessViewRHIRef PointsUAV = RHICreateUnorderedAccessView(Points, false, false);
+
+  TShaderMapRef<FCarlaLidarResampleCS> ComputeShader(GetGlobalShaderMap(GMaxRHIFeatureLevel));
+
+  FCarlaLidarResampleCS::FParameters Parameters;
+  Parameters.DepthCube = DepthCube;
+  // Point sampling, filtering would blend the depth across object edges.
+  Parameters.DepthSampler = TStaticSamplerState<SF_Point, AM_Clamp, AM_Clamp, AM_Clamp>::GetRHI();
+  Parameters.OutputPoints = PointsUAV;
+  Parameters.Channels = Beams.Channels;
+  Parameters.PointsPerChannel = Beams.PointsPerChannel;
+  Parameters.UpperFovLimit = Beams.UpperFovLimit;
+  Parameters.VerticalStep = Beams.VerticalStep;
+  Parameters.StartAngle = Beams.StartAngle;
+  Parameters.HorizontalStep = Beams.HorizontalStep;
+  Parameters.HorizontalFov = Beams.HorizontalFov;
+  Parameters.Range = Beams.Range;
+
+  RHICmdList.Transition(FRHITransitionInfo(DepthCube, ERHIAccess::Unknown, ERHIAccess::SRVCompute));
+  FComputeShaderUtils::Dispatch(
+      RHICmdList,
+      ComputeShader,
+      Parameters,
+      FIntVector(FMath::DivideAndRoundUp<int32>(BeamCount, FCarlaLidarResampleCS::ThreadGroupSize), 1, 1));
+  RHICmdList.Transition(FRHITransitionInfo(PointsUAV, ERHIAccess::UAVCompute, ERHIAccess::CPURead));
+
+  // The points are a few megabytes at most, locking waits for the dispatch.
+  const void *Data = RHILockStructuredBuffer(Points, 0u, BufferSize, RLM_ReadOnly);
+  FMemory::Memcpy(OutPoints.GetData(), Data, BufferSize);
+  RHIUnlockStructuredBuffer(Points);
+}
@@ -0,0 +1,48 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "RHI.h"
+#include "RHICommandList.h"
+
+/// Scan pattern of a LiDAR resampled from a depth cube map. Angles are in
+/// degrees and distances in centimeters, in the frame of the cube capture.
+struct FCarlaLidarBeamParameters
+{
+  uint32 Channels = 0u;
+
+  uint32 PointsPerChannel = 0u;
+
+  /// Vertical angle of the first channel, the others go down by
+  /// VerticalStep.
+  float UpperFovLimit = 0.f;
+
+  float VerticalStep = 0.f;
+
+  /// Horizontal angle of the first point of every channel before wrapping it
+  /// to HorizontalFov, the others go on by HorizontalStep.
+  float StartAngle = 0.f;
+
+  float HorizontalStep = 0.f;
+
+  float HorizontalFov = 360.f;
+
+  float Range = 0.f;
+};
+
+/// Intersect every beam of @a Beams with the depth stored in the alpha channel
+/// of @a DepthCube and read the result back. @a OutPoints gets one entry per
+/// beam, channel after channel: the hit point in the capture frame in XYZ and
+/// 1 in W, or W = 0 if the beam hits nothing within range.
+///
+/// @pre To be called from render-thread. IsCarlaPixelConversionSupported().
+CARLASHADERS_API void ResampleCarlaLidarBeams(
+    FRHICommandListImmediate &RHICmdList,
+    FRHITexture *DepthCube,
+    const FCarlaLidarBeamParameters &Beams,
+    TArray<FVector4> &OutPoints);
@@ -0,0 +1,124 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "PixelConversion.h"
+
+#include "GlobalShader.h"
+#include "RenderGraphUtils.h"
+#include "ShaderParameterStruct.h"
+
+// =============================================================================
+// -- FCarlaPixelConversionCS --------------------------------------------------
+// =============================================================================
+
+class FCarlaPixelConversionCS : public FGlobalShader
+{
+public:
+
+  DECLARE_GLOBAL_SHADER(FCarlaPixelConversionCS);
+  SHADER_USE_PARAMETER_STRUCT(FCarlaPixelConversionCS, FGlobalShader);
+
+  static constexpr int32 ThreadGroupSize = 8;
+
+  class FConversionDim : SHADER_PERMUTATION_INT("PIXEL_CONVERSION", 3);
+  using FPermutationDomain = TShaderPermutationDomain<FConversionDim>;
+
+  BEGIN_SHADER_PARAMETER_STRUCT(FParameters, )
+    SHADER_PARAMETER_SRV(Texture2D<float4>, InputTexture)
+    SHADER_PARAMETER_UAV(RWTexture2D<float4>, OutputTexture)
+    SHADER_PARAMETER(FIntPoint, Size)
+  END_SHADER_PARAMETER_STRUCT()
+
+  static bool ShouldCompilePermutation(const FGlobalShaderPermutationParameters &Parameters)
+  {
+    FPermutationDomain PermutationVector(Parameters.PermutationId);
+    return PermutationVector.Get<FConversionDim>() != static_cast<int32>(ECarlaPixelConversion::None) &&
+        IsFeatureLevelSupported(Parameters.Platform, ERHIFeatureLevel::SM5);
+  }
+
+  static void ModifyCompilationEnvironment(
+      const FGlobalShaderPermutationParameters &Parameters,
+      FShaderCompilerEnvironment &OutEnvironment)
+  {
+    FGlobalShader::ModifyCompilationEnvironment(Parameters, OutEnvironment);
+    OutEnvironment.SetDefine(TEXT("THREADGROUP_SIZE"), ThreadGroupSize);
+  }
+};
+
+IMPLEMENT_GLOBAL_SHADER(FCarlaPixelConversionCS, "/Plugin/Carla/Private/PixelConversion.usf", "MainCS", SF_Compute);
+
+// =============================================================================
+// -- Conversion functions -----------------------------------------------------
+// =============================================================================
+
+bool IsCarlaPixelConversionSupported()
+{
+  return GMaxRHIFeatureLevel >= ERHIFeatureLevel::SM5;
+}
+
+EPixelFormat GetCarlaPixelConversionFormat(ECarlaPixelConversion Conversion)
+{
+  switch (Conversion)
+  {
+    case ECarlaPixelConversion::RedToR8:
+      return PF_R8;
+    case ECarlaPixelConversion::RedGreenToG16R16F:
+      return PF_G16R16F;
+    default:
+      return PF_Unknown;
+  }
+}
+
+void ConvertCarlaPixels(
+    FRHICommandListImmediate &RHICmdList,
+    FRHITexture2D *Source,
+    ECarlaPixelConversion Conversion,
+    FTexture2DRHIRef &Target)
+{
+  TRACE_CPUPROFILER_EVENT_SCOPE_STR("ConvertCarlaPixels");
+  check(IsInRenderingThread());
+  check(Source != nullptr);
+  check(Conversion != ECarlaPixelConversion::None);
+  check(IsCarlaPixelConversionSupported());
+
+  const FIntPoint Size = Source->GetSizeXY();
+  const EPixelFormat Format = GetCarlaPixelConversionFormat(Conversion);
+  if (!Target.IsValid() || Target->GetSizeXY() != Size || Target->GetFormat() != Format)
+  {
+    FRHIResourceCreateInfo CreateInfo(TEXT("CarlaPixelConversion"));
+    Target = RHICreateTexture2D(
+        Size.X, Size.Y, Format, 1, 1,
+        TexCreate_ShaderResource | TexCreate_UAV,
+        ERHIAccess::UAVCompute,
+        CreateInfo);
+  }
+
+  // Read the raw values, without sRGB conversion.
+  FRHITextureSRVCreateInfo SRVCreateInfo(0u, 1u, Source->GetFormat());
+  SRVCreateInfo.SRGBOverride = SRGBO_ForceDisable;
+  FShaderResourceViewRHIRef InputSRV = RHICreateShaderResourceView(Source, SRVCreateInfo);
+  FUnorderedAccessViewRHIRef OutputUAV = RHICreateUnorderedAccessView(Target, 0u);
+
+  FCarlaPixelConversionCS::FPermutationDomain PermutationVector;
+  PermutationVector.Set<FCarlaPixelConversionCS::FConversionDim>(static_cast<int32>(Conversion));
+  TShaderMapRef<FCarlaPixelConversionCS> ComputeShader(
+      GetGlobalShaderMap(GMaxRHIFeatureLevel), PermutationVector);
+
+  FCarlaPixelConversionCS::FParameters Parameters;
+  Parameters.InputTexture = InputSRV;
+  Parameters.OutputTexture = OutputUAV;
+  Parameters.Size = Size;
+
+  RHICmdList.Transition({
+      FRHITransitionInfo(Source, ERHIAccess::Unknown, ERHIAccess::SRVCompute),
+      FRHITransitionInfo(Target, ERHIAccess::Unknown, ERHIAccess::UAVCompute)});
+  FComputeShaderUtils::Dispatch(
+      RHICmdList,
+      ComputeShader,
+      Parameters,
+      FComputeShaderUtils::GetGroupCount(Size, FCarlaPixelConversionCS::ThreadGroupSize));
+  RHICmdList.Transition(FRHITransitionInfo(Target, ERHIAccess::UAVCompute, ERHIAccess::CopySrc));
+}
@@ -0,0 +1,43 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "RHI.h"
+#include "RHICommandList.h"
+
+/// Conversions applied on the GPU to the render target of a sensor before
+/// reading it back, so only the channels the sensor uses cross PCIe.
+enum class ECarlaPixelConversion : uint8
+{
+  /// No conversion, the render target is read back as it is.
+  None,
+
+  /// Red channel of a 8-bit render target to PF_R8 (1 byte per pixel).
+  RedToR8,
+
+  /// Red and green channels of a half-float render target to PF_G16R16F
+  /// (4 bytes per pixel).
+  RedGreenToG16R16F
+};
+
+/// Whether the conversion shaders can run on the current RHI (SM5 or above).
+CARLASHADERS_API bool IsCarlaPixelConversionSupported();
+
+/// Pixel format of the result of @a Conversion.
+CARLASHADERS_API EPixelFormat GetCarlaPixelConversionFormat(ECarlaPixelConversion Conversion);
+
+/// Convert @a Source into @a Target with a compute shader. @a Target is created
+/// again only when its size or format do not match, so keep it between frames.
+/// When this returns @a Target is ready to be copied from.
+///
+/// @pre To be called from render-thread. @a Conversion is not None.
+CARLASHADERS_API void ConvertCarlaPixels(
+    FRHICommandListImmediate &RHICmdList,
+    FRHITexture2D *Source,
+    ECarlaPixelConversion Conversion,
+    FTexture2DRHIRef &Target);
@@ -24,6 +24,7 @@
 #include "PhysicsPublic.h" // 引入PhysicsPublic头文件，提供物理引擎公共的物理学功能
 #include "PhysXIncludes.h"// 引入PhysXIncludes头文件，用于包含PhysX物理引擎的相关文件
 #include "PxSimpleTypes.h" // 引入PxSimpleTypes头文件，提供PhysX物理引擎的简单类型
+#include "Async/ParallelFor.h"
 #include <fstream>// 引入fstream头文件，用于文件读写操作
 #include <sstream>// 引入sstream头文件，用于字符串流处理
 
@@ -91,130 +92,168 @@ void FCarlaExporterModule::PluginButtonClicked()
       BP_Actors.Add(Cast<UObject>(*it));
   }
 
-  // 得到目标路径
-  FString Path = FPaths::ConvertRelativePathToFull(FPaths::ProjectSavedDir());
-  //构建最终名称。
-  std::ostringstream name;
-  name << TCHAR_TO_UTF8(*Path) << "/" << TCHAR_TO_UTF8(*World->GetMapName()) << ".obj";
-  //创建文件。
-  std::ofstream f(name.str());
+  // 在游戏线程中收集要导出的几何体，每个参与者的区域类型只判断一次
+  TArray<FExportItem> Items[AREA_TYPE_COUNT];
+  for (UObject* SelectedObject : BP_Actors)
+  {
+    AActor* TempActor = Cast<AActor>(SelectedObject);
+    if (!TempActor) continue;
 
-  // 定义回合数
-  int rounds;
-  rounds = 5;
+    //检查标签（“NoExport”）
+    if (TempActor->ActorHasTag(FName("NoExport"))) continue;
 
-  // 我们需要缩放网格（虚幻引擎使用 “厘米”，Recast 使用 “米”）
-  constexpr float TO_METERS = 0.01f;
+    FString ActorName = TempActor->GetName();
+    const AreaType areaType = GetAreaType(ActorName);
+    TArray<FExportItem> &AreaItems = Items[areaType];
 
-  int offset = 1;
-  AreaType areaType;
-  for (int round = 0; round < rounds; ++round)
-  {
-    for (UObject* SelectedObject : BP_Actors)
-    {
-      AActor* TempActor = Cast<AActor>(SelectedObject);
-      if (!TempActor) continue;
-
-      //检查标签（“NoExport”）
-      if (TempActor->ActorHasTag(FName("NoExport"))) continue;
-
-      FString ActorName = TempActor->GetName();
-
-      // 通过命名规则检查类型
-      // 这段代码主要是根据给定的字符串 `ActorName` 的内容来确定 `areaType` 的值，通过一系列的字符串查找判断，将不同命名模式的 `ActorName` 归类到对应的 `AreaType` 枚举值中。
-
-// 首先判断 `ActorName` 中是否包含 "Road_Road" 或者 "Roads_Road" 字符串，如果包含其中任意一个，说明该 `Actor` 与道路相关，就将 `areaType` 设置为 `AreaType::ROAD`。
-if (ActorName.Find("Road_Road")!= -1 || ActorName.Find("Roads_Road")!= -1)
-    areaType = AreaType::ROAD;
-// 如果不包含上述字符串，接着判断是否包含 "Road_Marking" 或者 "Roads_Marking" 字符串，若包含，则同样认为该 `Actor` 与道路相关（比如道路标线等也算道路部分），将 `areaType` 也设置为 `AreaType::ROAD`。
-else if (ActorName.Find("Road_Marking")!= -1 || ActorName.Find("Roads_Marking")!= -1)
-    areaType = AreaType::ROAD;
-// 再判断 `ActorName` 是否包含 "Road_Curb" 或者 "Roads_Curb" 字符串，若包含，表示该 `Actor` 与道路边缘的路缘石相关，同样归为道路相关类别，将 `areaType` 设置为 `AreaType::ROAD`。
-else if (ActorName.Find("Road_Curb")!= -1 || ActorName.Find("Roads_Curb")!= -1)
-    areaType = AreaType::ROAD;
-// 继续判断 `ActorName` 中是否有 "Road_Gutter" 或者 "Roads_Gutter" 字符串，若存在，意味着该 `Actor` 与道路的排水沟等相关元素有关，也属于道路相关部分，所以 `areaType` 赋值为 `AreaType::ROAD`。
-else if (ActorName.Find("Road_Gutter")!= -1 || ActorName.Find("Roads_Gutter")!= -1)
-    areaType = AreaType::ROAD;
-// 然后判断 `ActorName` 是否包含 "Road_Sidewalk" 或者 "Roads_Sidewalk" 字符串，若包含，说明该 `Actor` 与人行道相关，此时将 `areaType` 设置为 `AreaType::SIDEWALK`，将其归类为人行道类别。
-else if (ActorName.Find("Road_Sidewalk")!= -1 || ActorName.Find("Roads_Sidewalk")!= -1)
-    areaType = AreaType::SIDEWALK;
-// 接着判断 `ActorName` 中是否存在 "Road_Crosswalk" 或者 "Roads_Crosswalk" 字符串，若有，则表明该 `Actor` 与人行横道相关，把 `areaType` 赋值为 `AreaType::CROSSWALK`，将其归到人行横道类别。
-else if (ActorName.Find("Road_Crosswalk")!= -1 || ActorName.Find("Roads_Crosswalk")!= -1)
-    areaType = AreaType::CROSSWALK;
-// 再判断 `ActorName` 是否包含 "Road_Grass" 或者 "Roads_Grass" 字符串，若包含，意味着该 `Actor` 与草地相关，将 `areaType` 设置为 `AreaType::GRASS`，将其归类到草地类别。
-else if (ActorName.Find("Road_Grass")!= -1 || ActorName.Find("Roads_Grass")!= -1)
-    areaType = AreaType::GRASS;
-// 如果以上所有包含特定字符串的条件都不满足，说明该 `Actor` 不属于前面所列举的明确分类情况，那么将 `areaType` 设置为 `AreaType::BLOCK`，可以理解为其他未分类的块状区域之类的默认类别。
-else
-    areaType = AreaType::BLOCK;
-
-      // 检查是否在这一回合中导出
-      if (rounds > 1)
-      {
-        if (areaType == AreaType::BLOCK && round != 0)
-          continue;
-        else if (areaType == AreaType::ROAD && round != 1)
-          continue;
-        else if (areaType == AreaType::GRASS && round != 2)
-          continue;
-        else if (areaType == AreaType::SIDEWALK && round != 3)
-          continue;
-        else if (areaType == AreaType::CROSSWALK && round != 4)
-          continue;
-      }
+    // 每个参与者一个组，没有几何体时也写出组名
+    FExportItem Group;
+    Group.GroupName = ActorName;
+    Group.Area = areaType;
+    AreaItems.Add(Group);
 
-      f << "g " << TCHAR_TO_ANSI(*(ActorName)) << "\n";
+    TArray<UActorComponent*> Components = TempActor->GetComponentsByClass(UStaticMeshComponent::StaticClass());
+    for (auto *Component : Components)
+    {
+      UPrimitiveComponent* Primitive = Cast<UPrimitiveComponent>(Component);
+      // 没有碰撞的网格不会阻挡行人，不用于生成导航网格
+      if (!Primitive || !Primitive->IsCollisionEnabled()) continue;
 
-      TArray<UActorComponent*> Components = TempActor->GetComponentsByClass(UStaticMeshComponent::StaticClass());
-      for (auto *Component : Components)
+      // 检查是否是实例化静态网格。
+      UInstancedStaticMeshComponent* comp2 = Cast<UInstancedStaticMeshComponent>(Component);
+      if (comp2)
       {
+        UBodySetup *body = comp2->GetBodySetup();
+        if (!body) continue;
 
-        // 检查是否是实例化静态网格。
-        UInstancedStaticMeshComponent* comp2 = Cast<UInstancedStaticMeshComponent>(Component);
-        if (comp2)
+        for (int i=0; i<comp2->GetInstanceCount(); ++i)
         {
-          UBodySetup *body = comp2->GetBodySetup();
-          if (!body) continue;
-
-          for (int i=0; i<comp2->GetInstanceCount(); ++i)
-          {
-            //将“instance_”加上索引值 i 写入文件并换行。
-            FString ObjectName = ActorName +"_"+FString::FromInt(i);
-
-            // 获取组件的位置和变换
-            FTransform InstanceTransform;
-            comp2->GetInstanceTransform(i, InstanceTransform, true);
-            FVector InstanceLocation = InstanceTransform.GetTranslation();
-
-            offset += WriteObjectGeom(f, ObjectName, body, InstanceTransform, areaType, offset);
-          }
+          FExportItem Item;
+          Item.ObjectName = ActorName +"_"+FString::FromInt(i);
+          Item.Body = body;
+          // 获取实例的变换
+          comp2->GetInstanceTransform(i, Item.Transform, true);
+          Item.Area = areaType;
+          AreaItems.Add(Item);
         }
-        else
-        {
-          // 尝试作为静态网格。
-          UStaticMeshComponent* comp = Cast<UStaticMeshComponent>(Component);
-          if (!comp) continue;
+      }
+      else
+      {
+        // 尝试作为静态网格。
+        UStaticMeshComponent* comp = Cast<UStaticMeshComponent>(Component);
+        if (!comp) continue;
 
-          UBodySetup *body = comp->GetBodySetup();
-          if (!body)
-            continue;
+        UBodySetup *body = comp->GetBodySetup();
+        if (!body)
+          continue;
 
-          //将字母“o”以及经过转换后的组件名称写入文件并换行。
-          FString ObjectName = ActorName +"_"+comp->GetName();
+        FExportItem Item;
+        Item.ObjectName = ActorName +"_"+comp->GetName();
+        Item.Body = body;
+        // 获取组件的变换。
+        Item.Transform = comp->GetComponentTransform();
+        Item.Area = areaType;
+        AreaItems.Add(Item);
+      }
+    }
+  }
 
-          // 获取组件的位置和变换。
-          FTransform CompTransform = comp->GetComponentTransform();
-          FVector CompLocation = CompTransform.GetTranslation();
+  // 按区域类型的顺序导出（BLOCK、ROAD、GRASS、SIDEWALK、CROSSWALK），
+  // 并预先计算每个对象第一个顶点的全局索引，使各对象可以独立格式化
+  const AreaType Order[] = { AreaType::BLOCK, AreaType::ROAD, AreaType::GRASS, AreaType::SIDEWALK, AreaType::CROSSWALK };
+  TArray<FExportItem> Sorted;
+  for (AreaType Area : Order)
+  {
+    Sorted.Append(MoveTemp(Items[Area]));
+  }
+  int32 offset = 1;
+  for (FExportItem &Item : Sorted)
+  {
+    Item.Offset = offset;
+    offset += CountObjectVertices(Item.Body);
+  }
 
-          offset += WriteObjectGeom(f, ObjectName, body, CompTransform, areaType, offset);
-        }
+  // 得到目标路径
+  FString Path = FPaths::ConvertRelativePathToFull(FPaths::ProjectSavedDir());
+  //构建最终名称。
+  std::ostringstream name;
+  name << TCHAR_TO_UTF8(*Path) << "/" << TCHAR_TO_UTF8(*World->GetMapName()) << ".obj";
+  //创建文件。
+  std::ofstream f(name.str());
+
+  // 分批并行生成文本并按顺序写入文件，内存中只保留一批对象的文本
+  constexpr int32 BatchSize = 1024;
+  TArray<std::string> Texts;
+  for (int32 BatchStart = 0; BatchStart < Sorted.Num(); BatchStart += BatchSize)
+  {
+    const int32 Count = FMath::Min(BatchSize, Sorted.Num() - BatchStart);
+    Texts.SetNum(Count);
+    ParallelFor(Count, [&](int32 Index)
+    {
+      FExportItem &Item = Sorted[BatchStart + Index];
+      std::ostringstream out;
+      if (!Item.GroupName.IsEmpty())
+      {
+        out << "g " << TCHAR_TO_ANSI(*(Item.GroupName)) << "\n";
       }
+      WriteObjectGeom(out, Item.ObjectName, Item.Body, Item.Transform, Item.Area, Item.Offset);
+      Texts[Index] = out.str();
+    });
+    for (std::string &Text : Texts)
+    {
+      f << Text;
+      std::string().swap(Text);
     }
   }
   f.close();
 }
+
+AreaType FCarlaExporterModule::GetAreaType(const FString &ActorName)
+{
+  // 通过命名规则检查类型
+  if (ActorName.Find("Road_Road")!= -1 || ActorName.Find("Roads_Road")!= -1)
+    return AreaType::ROAD;
+  else if (ActorName.Find("Road_Marking")!= -1 || ActorName.Find("Roads_Marking")!= -1)
+    return AreaType::ROAD;
+  else if (ActorName.Find("Road_Curb")!= -1 || ActorName.Find("Roads_Curb")!= -1)
+    return AreaType::ROAD;
+  else if (ActorName.Find("Road_Gutter")!= -1 || ActorName.Find("Roads_Gutter")!= -1)
+    return AreaType::ROAD;
+  else if (ActorName.Find("Road_Sidewalk")!= -1 || ActorName.Find("Roads_Sidewalk")!= -1)
+    return AreaType::SIDEWALK;
+  else if (ActorName.Find("Road_Crosswalk")!= -1 || ActorName.Find("Roads_Crosswalk")!= -1)
+    return AreaType::CROSSWALK;
+  else if (ActorName.Find("Road_Grass")!= -1 || ActorName.Find("Roads_Grass")!= -1)
+    return AreaType::GRASS;
+  // 其他未分类的块状区域
+  return AreaType::BLOCK;
+}
+
+// 计算 WriteObjectGeom 为 body 写入的顶点数
+int32 FCarlaExporterModule::CountObjectVertices(UBodySetup *body)
+{
+  if (!body) return 0;
+  int32 Total = 8 * body->AggGeom.BoxElems.Num();
+  bool Written = body->AggGeom.BoxElems.Num() > 0;
+  for (const auto &convex : body->AggGeom.ConvexElems)
+  {
+    PxConvexMesh *mesh = convex.GetConvexMesh();
+    if (!mesh) continue;
+    Total += mesh->getNbVertices();
+    Written = true;
+  }
+  if (!Written)
+  {
+    for (const auto &mesh : body->TriMeshes)
+    {
+      Total += mesh->getNbVertices();
+    }
+  }
+  return Total;
+}
+
 // 写入对象几何体到文件
-int32 FCarlaExporterModule::WriteObjectGeom(std::ofstream &f, FString ObjectName, UBodySetup *body, FTransform &CompTransform, AreaType Area, int32 Offset)
+int32 FCarlaExporterModule::WriteObjectGeom(std::ostream &f, const FString &ObjectName, UBodySetup *body, const FTransform &CompTransform, AreaType Area, int32 Offset)
 {
   // 如果传入的 UBodySetup 指针为空，则直接返回 0，表示没有添加任何顶点
   if (!body) return 0;
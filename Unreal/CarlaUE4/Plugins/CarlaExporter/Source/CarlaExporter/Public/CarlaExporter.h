@@ -8,11 +8,13 @@
 //程序预处理
 #include "CoreMinimal.h"
 #include "Modules/ModuleManager.h"
+#include <iosfwd>
 #include <string>
 
 //用于构建工具栏和菜单。
 class FToolBarBuilder;
 class FMenuBuilder;
+class UBodySetup;
 
 //定义一个枚举类型AreaType，用于表示不同的区域类型。
 enum AreaType
@@ -24,6 +26,8 @@ enum AreaType
   BLOCK
 };
 
+constexpr int32 AREA_TYPE_COUNT = AreaType::BLOCK + 1;
+
 //定义一个类FCarlaExporterModule，它继承自IModuleInterface，用于实现模块的接口。
 class FCarlaExporterModule : public IModuleInterface
 {
@@ -42,8 +46,25 @@ private://声明私有成员和函数，仅在类内部可见。
 
   //定义一个私有函数AddMenuExtension，用于向菜单添加扩展。
   void AddMenuExtension(FMenuBuilder& Builder);
-  //定义一个私有函数WriteObjectGeom，用于写入对象的几何信息到文件。
-  int32 WriteObjectGeom(std::ofstream &f, FString ObjectName, UBodySetup *body, FTransform &CompTransform, AreaType Area, int32 Offset);
+  // 一个要导出的对象，在游戏线程中收集，在工作线程中格式化。
+  // GroupName 不为空时先写出参与者的组名；Body 为空时只写组名。
+  struct FExportItem
+  {
+    FString GroupName;
+    FString ObjectName;
+    UBodySetup *Body = nullptr;
+    FTransform Transform;
+    AreaType Area = AreaType::BLOCK;
+    // 第一个顶点在 OBJ 文件中的全局索引
+    int32 Offset = 0;
+  };
+
+  // 根据参与者的命名规则判断区域类型
+  static AreaType GetAreaType(const FString &ActorName);
+  // WriteObjectGeom 为 body 写入的顶点数，用于预先计算各对象的顶点索引
+  static int32 CountObjectVertices(UBodySetup *body);
+  //定义一个私有函数WriteObjectGeom，用于写入对象的几何信息到流中。只读取物理网格，可以在工作线程中调用。
+  static int32 WriteObjectGeom(std::ostream &f, const FString &ObjectName, UBodySetup *body, const FTransform &CompTransform, AreaType Area, int32 Offset);
 
 //声明一个私有成员PluginCommands，用于存储插件的UI命令列表。
 private:
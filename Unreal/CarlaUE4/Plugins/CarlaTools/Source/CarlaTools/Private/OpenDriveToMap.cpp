@@ -202,51 +202,71 @@ void UOpenDriveToMap::CreateTerrain( const int MeshGridSize, const float MeshGri
   // 纵向瓦片数 = 地图纵向长度 / 网格大小
   int NumJ = BoxExtent.Y  / MeshGridSize;
 
+  // 偏移每个程序化网格以容纳所有的地图瓦片
+  TArray<FVector2D> Offsets;
   for( int i = 0; i <= NumI; i++ )
   {
     for( int j = 0; j <= NumJ; j++ )
     {
-      // 偏移每个程序化网格以容纳所有的地图瓦片
-      FVector2D Offset( MinBox.X + i * MeshGridSize, MinBox.Y + j * MeshGridSize);
-      CreateTerrainMesh(i * NumJ + j, Offset, MeshGridSize, MeshGridSectionSize );  // 创建地面的一个小网格
+      Offsets.Add(FVector2D( MinBox.X + i * MeshGridSize, MinBox.Y + j * MeshGridSize));
     }
   }
+
+  // 各块网格的高度采样和切线计算相互独立，并行进行；这一阶段不生成参与者，
+  // 物理场景只被查询，与引擎的异步射线检测相同。
+  UWorld* World = UEditorLevelLibrary::GetEditorWorld();
+  TArray<FProceduralCustomMesh> MeshData;
+  TArray<TArray<FProcMeshTangent>> Tangents;
+  MeshData.SetNum(Offsets.Num());
+  Tangents.SetNum(Offsets.Num());
+  const FColor* HeightmapData = LockHeightmap();
+  ParallelFor(Offsets.Num(), [&](int32 Index)
+  {
+    BuildTerrainMeshData(Offsets[Index], MeshGridSize, MeshGridSectionSize, World, HeightmapData, MeshData[Index], Tangents[Index]);
+  });
+  UnlockHeightmap();
+
+  // 资产和参与者只能在游戏线程中按原来的顺序创建
+  for( int Index = 0; Index < Offsets.Num(); ++Index )
+  {
+    SpawnTerrainMesh(Offsets[Index], MeshData[Index], Tangents[Index]);  // 创建地面的一个小网格
+  }
 }
 
 // 创建地面网格
 void UOpenDriveToMap::CreateTerrainMesh(const int MeshIndex, const FVector2D Offset, const int GridSize, const float GridSectionSize)
 {
-  // const float GridSectionSize = 100.0f; // In cm
-  const float HeightScale = 3.0f;
-
-  UWorld* World = UEditorLevelLibrary::GetEditorWorld();
-  // 程序化网格的创建
-  AStaticMeshActor* MeshActor = World->SpawnActor<AStaticMeshActor>();
-  MeshActor->SetActorLocation(FVector(Offset.X, Offset.Y, 0));
-  UStaticMeshComponent* Mesh = MeshActor->GetStaticMeshComponent();  // 得到静态网格组件
+  FProceduralCustomMesh MeshData;
+  TArray<FProcMeshTangent> Tangents;
+  const FColor* HeightmapData = LockHeightmap();
+  BuildTerrainMeshData(Offset, GridSize, GridSectionSize, UEditorLevelLibrary::GetEditorWorld(), HeightmapData, MeshData, Tangents);
+  UnlockHeightmap();
+  SpawnTerrainMesh(Offset, MeshData, Tangents);
+}
 
+// 计算地面网格的数据
+void UOpenDriveToMap::BuildTerrainMeshData(const FVector2D Offset, const int GridSize, const float GridSectionSize,
+    UWorld* World, const FColor* HeightmapData,
+    FProceduralCustomMesh& MeshData, TArray<FProcMeshTangent>& Tangents) const
+{
   TArray<FVector> Vertices;
   TArray<int32> Triangles;
 
   TArray<FVector> Normals;  // 法线
-  TArray<FLinearColor> Colors;
-  TArray<FProcMeshTangent> Tangents;
   TArray<FVector2D> UVs;
 
   int VerticesInLine = (GridSize / GridSectionSize) + 1.0f;
-  static int StaticMeshIndex = 0;
   for( int i = 0; i < VerticesInLine; i++ )  // 横向线上的顶点数
   {
     float X = (i * GridSectionSize);
-    const int RoadMapX = i * 255 / VerticesInLine;
     for( int j = 0; j < VerticesInLine; j++ )  // 纵向线上的顶点数
     {
       float Y = (j * GridSectionSize);
-      const int RoadMapY = j * 255 / VerticesInLine;
-      const int CellIndex = RoadMapY + 255 * RoadMapX;
-      float HeightValue = GetHeightForLandscape( FVector( (Offset.X + X),
+      float HeightValue = GetHeightForLandscape( World,
+                                                 FVector( (Offset.X + X),
                                                           (Offset.Y + Y),
-                                                          0));
+                                                          0),
+                                                 HeightmapData );
       Vertices.Add(FVector( X, Y, HeightValue));
       UVs.Add(FVector2D(i, j));
     }
@@ -275,11 +295,22 @@ void UOpenDriveToMap::CreateTerrainMesh(const int MeshIndex, const FVector2D Off
     Tangents
   );
 
-  FProceduralCustomMesh MeshData;
   MeshData.Vertices = Vertices;
   MeshData.Triangles = Triangles;
   MeshData.Normals = Normals;
   MeshData.UV0 = UVs;
+}
+
+// 创建地面网格资产和参与者
+void UOpenDriveToMap::SpawnTerrainMesh(const FVector2D Offset, const FProceduralCustomMesh& MeshData, const TArray<FProcMeshTangent>& Tangents)
+{
+  static int StaticMeshIndex = 0;
+  UWorld* World = UEditorLevelLibrary::GetEditorWorld();
+  // 程序化网格的创建
+  AStaticMeshActor* MeshActor = World->SpawnActor<AStaticMeshActor>();
+  MeshActor->SetActorLocation(FVector(Offset.X, Offset.Y, 0));
+  UStaticMeshComponent* Mesh = MeshActor->GetStaticMeshComponent();  // 得到静态网格组件
+
   UStaticMesh* MeshToSet = UMapGenFunctionLibrary::CreateMesh(MeshData,  Tangents, DefaultLandscapeMaterial, MapName, "Terrain", FName(TEXT("SM_LandscapeMesh" + FString::FromInt(StaticMeshIndex) + GetStringForCurrentTile() )));
   Mesh->SetStaticMesh(MeshToSet);
   MeshActor->SetActorLabel("SM_LandscapeActor" + FString::FromInt(StaticMeshIndex) + GetStringForCurrentTile() );
@@ -486,9 +517,16 @@ void UOpenDriveToMap::LoadMap()
       CurrentTilesInXY = FIntVector(0,0,0);
       ULevel* PersistantLevel = UEditorLevelLibrary::GetEditorWorld()->PersistentLevel;  // 持久关卡
       BaseLevelName = LargeMapManager->LargeMapTilePath + "/" + LargeMapManager->LargeMapName;
+      const int32 NumTiles = NumTilesInXY.X * NumTilesInXY.Y;
+      int32 TileIndex = 0;
+      const double Start = FPlatformTime::Seconds();
       do{
+        UE_LOG(LogCarlaToolsMapGenerator, Log, TEXT("Generating tile %d of %d%s, %f seconds elapsed"),
+            TileIndex + 1, NumTiles, *GetStringForCurrentTile(), FPlatformTime::Seconds() - Start);
         GenerateTileStandalone();  // 循环独立生成地图瓦片
+        ++TileIndex;
       }while(GoNextTile());
+      UE_LOG(LogCarlaToolsMapGenerator, Log, TEXT("Generated %d tiles in %f seconds"), TileIndex, FPlatformTime::Seconds() - Start);
       ReturnToMainLevel();  // 返回主关卡
     }
   }
@@ -533,12 +571,23 @@ void UOpenDriveToMap::GenerateAll(const boost::optional<carla::road::Map>& Param
     UE_LOG(LogCarlaToolsMapGenerator, Error, TEXT("Invalid Map"));
   }else
   {
-    GenerateRoadMesh(ParamCarlaMap, MinLocation, MaxLocation);  // 生成道路网格
-    GenerateLaneMarks(ParamCarlaMap, MinLocation, MaxLocation);  // 生成车道线
-    GenerateSpawnPoints(ParamCarlaMap, MinLocation, MaxLocation);  // 产生生成点
-    CreateTerrain(12800, 256);  // 创建地面
-    GenerateTreePositions(ParamCarlaMap, MinLocation, MaxLocation);  // 生成树的位置
-    GenerationFinished(MinLocation, MaxLocation);  // 完成地图生成的一些后续操作
+    // 记录每个阶段的耗时，方便找出大地图转换中最慢的部分
+    const double TileStart = FPlatformTime::Seconds();
+    auto RunStage = [&](const TCHAR* StageName, TFunctionRef<void()> Stage)
+    {
+      const double StageStart = FPlatformTime::Seconds();
+      Stage();
+      UE_LOG(LogCarlaToolsMapGenerator, Log, TEXT("Tile%s: %s finished in %f seconds"),
+          *GetStringForCurrentTile(), StageName, FPlatformTime::Seconds() - StageStart);
+    };
+    RunStage(TEXT("RoadMesh"), [&](){ GenerateRoadMesh(ParamCarlaMap, MinLocation, MaxLocation); });  // 生成道路网格
+    RunStage(TEXT("LaneMarks"), [&](){ GenerateLaneMarks(ParamCarlaMap, MinLocation, MaxLocation); });  // 生成车道线
+    RunStage(TEXT("SpawnPoints"), [&](){ GenerateSpawnPoints(ParamCarlaMap, MinLocation, MaxLocation); });  // 产生生成点
+    RunStage(TEXT("Terrain"), [&](){ CreateTerrain(12800, 256); });  // 创建地面
+    RunStage(TEXT("TreePositions"), [&](){ GenerateTreePositions(ParamCarlaMap, MinLocation, MaxLocation); });  // 生成树的位置
+    RunStage(TEXT("GenerationFinished"), [&](){ GenerationFinished(MinLocation, MaxLocation); });  // 完成地图生成的一些后续操作
+    UE_LOG(LogCarlaToolsMapGenerator, Log, TEXT("Tile%s generated in %f seconds"),
+        *GetStringForCurrentTile(), FPlatformTime::Seconds() - TileStart);
   }
 }
 
@@ -564,8 +613,17 @@ void UOpenDriveToMap::GenerateRoadMesh( const boost::optional<carla::road::Map>&
   UE_LOG(LogCarlaToolsMapGenerator, Log, TEXT(" GenerateOrderedChunkedMesh code executed in %f seconds. Simplification percentage is %f"), end - start, opg_parameters.simplification_percentage);
 
   start = FPlatformTime::Seconds();
-  // 定义一个静态变量index，用于给创建的静态网格演员设置唯一标签
-  static int index = 0;
+
+  // 每个网格的贴地、简化和切线计算相互独立，并行进行
+  struct FLaneMeshJob
+  {
+    carla::road::Lane::LaneType LaneType;
+    const std::unique_ptr<carla::geom::Mesh>* Mesh;
+    FVector MeshCentroid;
+    FProceduralCustomMesh MeshData;
+    TArray<FProcMeshTangent> Tangents;
+  };
+  TArray<FLaneMeshJob> Jobs;
   for (const auto &PairMap : Meshes)
   {
     // 遍历每个键值对中的网格数据（Mesh）
@@ -580,100 +638,125 @@ void UOpenDriveToMap::GenerateRoadMesh( const boost::optional<carla::road::Map>&
       if (!Mesh->IsValid()) {
         continue;
       }
+      FLaneMeshJob Job;
+      Job.LaneType = PairMap.first;
+      Job.Mesh = &Mesh;
+      Jobs.Add(MoveTemp(Job));
+    }
+  }
 
-      if(PairMap.first == carla::road::Lane::LaneType::Driving)
+  const FColor* HeightmapData = LockHeightmap();
+  ParallelFor(Jobs.Num(), [&](int32 JobIndex)
+  {
+    FLaneMeshJob& Job = Jobs[JobIndex];
+    const std::unique_ptr<carla::geom::Mesh>& Mesh = *Job.Mesh;
+    if(Job.LaneType == carla::road::Lane::LaneType::Driving)
+    {
+      for( auto& Vertex : Mesh->GetVertices() )
       {
-        for( auto& Vertex : Mesh->GetVertices() )
-        {
-          FVector VertexFVector = Vertex.ToFVector();
-          Vertex.z += GetHeight(Vertex.x, Vertex.y, DistanceToLaneBorder(ParamCarlaMap,VertexFVector) > 65.0f );
-        }
-        carla::geom::Simplification Simplify(0.15);
-        Simplify.Simplificate(Mesh);
-      }else{
-        for( auto& Vertex : Mesh->GetVertices() )
-        {
-          Vertex.z += GetHeight(Vertex.x, Vertex.y, false) + 0.15f;
-        }
+        FVector VertexFVector = Vertex.ToFVector();
+        Vertex.z += GetHeight(Vertex.x, Vertex.y, DistanceToLaneBorder(ParamCarlaMap,VertexFVector) > 65.0f, HeightmapData );
       }
+      carla::geom::Simplification Simplify(0.15);
+      Simplify.Simplificate(Mesh);
+    }else{
+      for( auto& Vertex : Mesh->GetVertices() )
+      {
+        Vertex.z += GetHeight(Vertex.x, Vertex.y, false, HeightmapData) + 0.15f;
+      }
+    }
 
-      AStaticMeshActor* TempActor = UEditorLevelLibrary::GetEditorWorld()->SpawnActor<AStaticMeshActor>();
-      UStaticMeshComponent* StaticMeshComponent = TempActor->GetStaticMeshComponent();
-      TempActor->SetActorLabel(FString("SM_Lane_") + FString::FromInt(index));
+    FVector MeshCentroid = FVector(0,0,0);
+    for( auto Vertex : Mesh->GetVertices() )
+    {
+      MeshCentroid += Vertex.ToFVector();
+    }
 
-      StaticMeshComponent->SetCollisionEnabled(ECollisionEnabled::QueryAndPhysics);
+    MeshCentroid /= Mesh->GetVertices().size();
 
-      if(DefaultRoadMaterial && PairMap.first == carla::road::Lane::LaneType::Driving)
-      {
-        StaticMeshComponent->SetMaterial(0, DefaultRoadMaterial);
-        StaticMeshComponent->CastShadow = false;
-        TempActor->SetActorLabel(FString("SM_DrivingLane_") + FString::FromInt(index));
-      }
-      if(DefaultSidewalksMaterial && PairMap.first == carla::road::Lane::LaneType::Sidewalk)
-      {
-        StaticMeshComponent->SetMaterial(0, DefaultSidewalksMaterial);
-        TempActor->SetActorLabel(FString("SM_Sidewalk_") + FString::FromInt(index));
-      }
-      FVector MeshCentroid = FVector(0,0,0);
-      for( auto Vertex : Mesh->GetVertices() )
-      {
-        MeshCentroid += Vertex.ToFVector();
-      }
+    for( auto& Vertex : Mesh->GetVertices() )
+    {
+     Vertex.x -= MeshCentroid.X;
+     Vertex.y -= MeshCentroid.Y;
+     Vertex.z -= MeshCentroid.Z;
+    }
 
-      MeshCentroid /= Mesh->GetVertices().size();
+    Job.MeshCentroid = MeshCentroid;
+    Job.MeshData = *Mesh;
+    TArray<FVector> Normals;
+    UKismetProceduralMeshLibrary::CalculateTangentsForMesh(
+      Job.MeshData.Vertices,
+      Job.MeshData.Triangles,
+      Job.MeshData.UV0,
+      Normals,
+      Job.Tangents
+    );
+  });
+  UnlockHeightmap();
 
-      for( auto& Vertex : Mesh->GetVertices() )
-      {
-       Vertex.x -= MeshCentroid.X;
-       Vertex.y -= MeshCentroid.Y;
-       Vertex.z -= MeshCentroid.Z;
-      }
+  end = FPlatformTime::Seconds();
+  UE_LOG(LogCarlaToolsMapGenerator, Log, TEXT("Mesh height and tangent computation for %d meshes executed in %f seconds."), Jobs.Num(), end - start);
 
-      const FProceduralCustomMesh MeshData = *Mesh;
-      TArray<FVector> Normals;
-      TArray<FProcMeshTangent> Tangents;
-
-      #调用UKismetProceduralMeshLibrary类中的CalculateTangentsForMesh函数
-      UKismetProceduralMeshLibrary::CalculateTangentsForMesh(
-        MeshData.Vertices,
-        MeshData.Triangles,
-        MeshData.UV0,
-        Normals,
-        Tangents
-      );
-
-      #条件判断，检查PairMap 中的第一个元素是否等于carla::road::Lane::LaneType::Sidewalk
-      if(PairMap.first == carla::road::Lane::LaneType::Sidewalk)
-      {
-        #构建一个静态网格对象
-        UStaticMesh* MeshToSet = UMapGenFunctionLibrary::CreateMesh(MeshData,  Tangents, DefaultSidewalksMaterial, MapName, "DrivingLane", FName(TEXT("SM_SidewalkMesh" + FString::FromInt(index) + GetStringForCurrentTile() )));
-        StaticMeshComponent->SetStaticMesh(MeshToSet);
-      }
+  // 资产和参与者只能在游戏线程中创建
+  start = FPlatformTime::Seconds();
+  // 定义一个静态变量index，用于给创建的静态网格演员设置唯一标签
+  static int index = 0;
+  for (const FLaneMeshJob& Job : Jobs)
+  {
+    const auto LaneType = Job.LaneType;
+    const FVector& MeshCentroid = Job.MeshCentroid;
+    const FProceduralCustomMesh& MeshData = Job.MeshData;
+    const TArray<FProcMeshTangent>& Tangents = Job.Tangents;
 
-      #条件判断检查
-      if(PairMap.first == carla::road::Lane::LaneType::Driving)
-      {
-        UStaticMesh* MeshToSet = UMapGenFunctionLibrary::CreateMesh(MeshData,  Tangents, DefaultRoadMaterial, MapName, "DrivingLane", FName(TEXT("SM_DrivingLaneMesh" + FString::FromInt(index) + GetStringForCurrentTile() )));
-        StaticMeshComponent->SetStaticMesh(MeshToSet);
-      }
-      #设置临时演员TempActor的位置
-      TempActor->SetActorLocation(MeshCentroid * 100);
-      #给临时演员添加一个RoadLane
-      TempActor->Tags.Add(FName("RoadLane"));
-      #用于将一个TempActor添加到ActorMeshList中
-      // ActorMeshList.Add(TempActor);
-      #设置静态网格组件的碰撞属性
-      StaticMeshComponent->SetCollisionEnabled(ECollisionEnabled::QueryAndPhysics);
-      #设置一个TempActor的启用碰撞
-      TempActor->SetActorEnableCollision(true);
-      #计数器自增操作
-      index++;
+    AStaticMeshActor* TempActor = UEditorLevelLibrary::GetEditorWorld()->SpawnActor<AStaticMeshActor>();
+    UStaticMeshComponent* StaticMeshComponent = TempActor->GetStaticMeshComponent();
+    TempActor->SetActorLabel(FString("SM_Lane_") + FString::FromInt(index));
+
+    StaticMeshComponent->SetCollisionEnabled(ECollisionEnabled::QueryAndPhysics);
+
+    if(DefaultRoadMaterial && LaneType == carla::road::Lane::LaneType::Driving)
+    {
+      StaticMeshComponent->SetMaterial(0, DefaultRoadMaterial);
+      StaticMeshComponent->CastShadow = false;
+      TempActor->SetActorLabel(FString("SM_DrivingLane_") + FString::FromInt(index));
     }
+    if(DefaultSidewalksMaterial && LaneType == carla::road::Lane::LaneType::Sidewalk)
+    {
+      StaticMeshComponent->SetMaterial(0, DefaultSidewalksMaterial);
+      TempActor->SetActorLabel(FString("SM_Sidewalk_") + FString::FromInt(index));
+    }
+
+    // 条件判断，检查车道类型是否为人行道
+    if(LaneType == carla::road::Lane::LaneType::Sidewalk)
+    {
+      // 构建一个静态网格对象
+      UStaticMesh* MeshToSet = UMapGenFunctionLibrary::CreateMesh(MeshData,  Tangents, DefaultSidewalksMaterial, MapName, "DrivingLane", FName(TEXT("SM_SidewalkMesh" + FString::FromInt(index) + GetStringForCurrentTile() )));
+      StaticMeshComponent->SetStaticMesh(MeshToSet);
+    }
+
+    // 条件判断检查
+    if(LaneType == carla::road::Lane::LaneType::Driving)
+    {
+      UStaticMesh* MeshToSet = UMapGenFunctionLibrary::CreateMesh(MeshData,  Tangents, DefaultRoadMaterial, MapName, "DrivingLane", FName(TEXT("SM_DrivingLaneMesh" + FString::FromInt(index) + GetStringForCurrentTile() )));
+      StaticMeshComponent->SetStaticMesh(MeshToSet);
+    }
+    // 设置临时演员TempActor的位置
+    TempActor->SetActorLocation(MeshCentroid * 100);
+    // 给临时演员添加一个RoadLane
+    TempActor->Tags.Add(FName("RoadLane"));
+    // 用于将一个TempActor添加到ActorMeshList中
+    // ActorMeshList.Add(TempActor);
+    // 设置静态网格组件的碰撞属性
+    StaticMeshComponent->SetCollisionEnabled(ECollisionEnabled::QueryAndPhysics);
+    // 设置一个TempActor的启用碰撞
+    TempActor->SetActorEnableCollision(true);
+    // 计数器自增操作
+    index++;
   }
 
-  #获取当前平台时间
+  // 获取当前平台时间
   end = FPlatformTime::Seconds();
-  #输出一条日志信息
+  // 输出一条日志信息
   UE_LOG(LogCarlaToolsMapGenerator, Log, TEXT("Mesh spawnning and translation code executed in %f seconds."), end - start);
 }
 
@@ -820,8 +903,28 @@ void UOpenDriveToMap::GenerateTreePositions( const boost::optional<carla::road::
 }
 
 float UOpenDriveToMap::GetHeight(float PosX, float PosY, bool bDrivingLane){
+  const FColor* HeightmapData = LockHeightmap();
+  const float Height = GetHeight(PosX, PosY, bDrivingLane, HeightmapData);
+  UnlockHeightmap();
+  return Height;
+}
+
+const FColor* UOpenDriveToMap::LockHeightmap() const {
   if( DefaultHeightmap ){
-    const FColor* FormatedImageData = static_cast<const FColor*>( DefaultHeightmap->PlatformData->Mips[0].BulkData.LockReadOnly());
+    return static_cast<const FColor*>( DefaultHeightmap->PlatformData->Mips[0].BulkData.LockReadOnly());
+  }
+  return nullptr;
+}
+
+void UOpenDriveToMap::UnlockHeightmap() const {
+  if( DefaultHeightmap ){
+    DefaultHeightmap->PlatformData->Mips[0].BulkData.Unlock();
+  }
+}
+
+float UOpenDriveToMap::GetHeight(float PosX, float PosY, bool bDrivingLane, const FColor* HeightmapData) const {
+  if( HeightmapData ){
+    const FColor* FormatedImageData = HeightmapData;
 
     int32 TextureSizeX = DefaultHeightmap->GetSizeX();
     int32 TextureSizeY = DefaultHeightmap->GetSizeY();
@@ -853,8 +956,6 @@ float UOpenDriveToMap::GetHeight(float PosX, float PosY, bool bDrivingLane){
     //UE_LOG(LogCarlaToolsMapGenerator, Error, TEXT("PixelColor %s "), *WorldEndPosition.ToString() );
     //UE_LOG(LogCarlaToolsMapGenerator, Error, TEXT("Reading Pixel X: %d Y %d Total Size X %d Y %d"), PixelX, PixelY, TextureSizeX, TextureSizeY );
 
-    DefaultHeightmap->PlatformData->Mips[0].BulkData.Unlock();
-
     float LandscapeHeight = ( (PixelColor.R/255.0f ) * ( MaxHeight - MinHeight ) ) + MinHeight;
 
     if( bDrivingLane ){
@@ -898,6 +999,13 @@ FTransform UOpenDriveToMap::GetSnappedPosition( FTransform Origin ){
 }
 
 float UOpenDriveToMap::GetHeightForLandscape( FVector Origin ){
+  const FColor* HeightmapData = LockHeightmap();
+  const float Height = GetHeightForLandscape(UEditorLevelLibrary::GetEditorWorld(), Origin, HeightmapData);
+  UnlockHeightmap();
+  return Height;
+}
+
+float UOpenDriveToMap::GetHeightForLandscape( UWorld* World, FVector Origin, const FColor* HeightmapData ) const {
   FVector Start = Origin + FVector( 0, 0, 10000);
   FVector End = Origin - FVector( 0, 0, 10000);
   FHitResult HitResult;
@@ -905,7 +1013,7 @@ float UOpenDriveToMap::GetHeightForLandscape( FVector Origin ){
   CollisionQuery.AddIgnoredActors(Landscapes);
   FCollisionResponseParams CollisionParams;
 
-  if( UEditorLevelLibrary::GetEditorWorld()->LineTraceSingleByChannel(
+  if( World->LineTraceSingleByChannel(
     HitResult,
     Start,
     End,
@@ -913,9 +1021,9 @@ float UOpenDriveToMap::GetHeightForLandscape( FVector Origin ){
     CollisionQuery,
     CollisionParams) )
   {
-    return GetHeight(Origin.X * 0.01f, Origin.Y * 0.01f, true) * 100.0f - 80.0f;
+    return GetHeight(Origin.X * 0.01f, Origin.Y * 0.01f, true, HeightmapData) * 100.0f - 80.0f;
   }else{
-    return GetHeight(Origin.X * 0.01f, Origin.Y * 0.01f, true) * 100.0f - 1.0f;
+    return GetHeight(Origin.X * 0.01f, Origin.Y * 0.01f, true, HeightmapData) * 100.0f - 1.0f;
   }
   return 0.0f;
 }
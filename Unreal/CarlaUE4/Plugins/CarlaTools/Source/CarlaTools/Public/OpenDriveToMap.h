@@ -29,6 +29,7 @@ class UProceduralMeshComponent;
 class UMeshComponent;
 class UCustomFileDownloader;
 class UMaterialInstance;
+struct FProceduralCustomMesh;
 // UCLASS宏用于将此类注册到UE4的反射系统中，使其可以在蓝图中使用、进行序列化等操作
 // Blueprintable表示此类可以在蓝图中继承扩展，BlueprintType表示此类的实例可以作为蓝图中的变量类型
 /**	
@@ -233,6 +234,19 @@ private:
   FTransform GetSnappedPosition(FTransform Origin);
 // 获取地形高度相关值，参数指定原点位置
   float GetHeightForLandscape(FVector Origin);
+// 与上面相同，但不访问编辑器状态，可以在工作线程中调用；HeightmapData 为 LockHeightmap 的结果
+  float GetHeightForLandscape(UWorld* World, FVector Origin, const FColor* HeightmapData) const;
+// 与 GetHeight 相同，HeightmapData 为 LockHeightmap 的结果，可以在工作线程中调用
+  float GetHeight(float PosX, float PosY, bool bDrivingLane, const FColor* HeightmapData) const;
+// 锁定默认高度图的像素供多个线程读取，没有高度图时返回 nullptr
+  const FColor* LockHeightmap() const;
+  void UnlockHeightmap() const;
+// 计算一块地面网格的顶点、三角形和切线，不创建任何 UObject，可以在工作线程中调用
+  void BuildTerrainMeshData(const FVector2D Offset, const int GridSize, const float GridSectionSize,
+      UWorld* World, const FColor* HeightmapData,
+      FProceduralCustomMesh& MeshData, TArray<FProcMeshTangent>& Tangents) const;
+// 在游戏线程中根据计算好的数据创建地面网格资产和参与者
+  void SpawnTerrainMesh(const FVector2D Offset, const FProceduralCustomMesh& MeshData, const TArray<FProcMeshTangent>& Tangents);
 // 计算到车道边界距离，参数指定地图和位置，可选车道类型
   float DistanceToLaneBorder(const boost::optional<carla::road::Map>& CarlaMap,
       FVector &location,
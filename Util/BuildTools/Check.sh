@@ -165,6 +165,17 @@ if ${LIBCARLA_RELEASE} ; then
     echo "Running: ${GDB} libcarla_test_client_debug ${GTEST_ARGS} ${EXTRA_ARGS}"
     ${GDB} ${LIBCARLA_INSTALL_CLIENT_FOLDER}/test/libcarla_test_client_release ${GTEST_ARGS} ${EXTRA_ARGS}
 
+  else
+
+    # 客户端的基准测试只在设置了结果文件时运行，结果以 JSON 格式写入该文件
+    mkdir -p "${CARLA_TEST_RESULTS_FOLDER}"
+    BENCHMARK_OUTPUT=${CARLA_TEST_RESULTS_FOLDER}/libcarla-benchmark.json
+
+    log "Running LibCarla.client benchmarks (release)."
+    echo "Running: ${GDB} libcarla_test_client_release ${GTEST_ARGS} ${EXTRA_ARGS}"
+    LIBCARLA_BENCHMARK_OUTPUT=${BENCHMARK_OUTPUT} ${GDB} ${LIBCARLA_INSTALL_CLIENT_FOLDER}/test/libcarla_test_client_release ${GTEST_ARGS} ${EXTRA_ARGS}
+    log "Benchmark results written to ${BENCHMARK_OUTPUT}."
+
   fi
 
 fi
@@ -311,8 +311,10 @@ RECAST_BASENAME=recast-${CXX_TAG}
 
 RECAST_INCLUDE=${PWD}/${RECAST_BASENAME}-install/include
 RECAST_LIBPATH=${PWD}/${RECAST_BASENAME}-install/lib
+RECAST_SRCPATH=${PWD}/${RECAST_BASENAME}-install/src
 
 if [[ -d "${RECAST_BASENAME}-install" &&
+      -d "${RECAST_BASENAME}-install/src" &&
       -f "${RECAST_BASENAME}-install/bin/RecastBuilder" ]] ; then
   log "${RECAST_BASENAME} already installed."
 else
@@ -353,6 +355,12 @@ else
 
   popd >/dev/null
 
+  # The server compiles Detour and DetourCrowd itself (see carla/nav/ServerRecast.h).
+  mkdir -p ${RECAST_BASENAME}-install/src
+  cp ${RECAST_BASENAME}-source/Detour/Source/*.cpp \
+     ${RECAST_BASENAME}-source/DetourCrowd/Source/*.cpp \
+     ${RECAST_BASENAME}-install/src/
+
   rm -Rf ${RECAST_BASENAME}-source ${RECAST_BASENAME}-build
 
 fi
@@ -1064,6 +1072,8 @@ if (CMAKE_BUILD_TYPE STREQUAL "Server")
   set(RPCLIB_LIB_PATH "${RPCLIB_LIBCXX_LIBPATH}")
   set(GTEST_INCLUDE_PATH "${GTEST_LIBCXX_INCLUDE}")
   set(GTEST_LIB_PATH "${GTEST_LIBCXX_LIBPATH}")
+  set(RECAST_INCLUDE_PATH "${RECAST_INCLUDE}")
+  set(RECAST_SRC_PATH "${RECAST_SRCPATH}")
 elseif (CMAKE_BUILD_TYPE STREQUAL "ros2")
   list(APPEND CMAKE_PREFIX_PATH "${FASTDDS_INSTALL_DIR}")
 elseif (CMAKE_BUILD_TYPE STREQUAL "Pytorch")
@@ -107,6 +107,11 @@ cmake --build. --config Release --target install
 rem 如果构建安装过程出现错误（errorlevel非0），跳转到error_install标签处处理安装错误情况
 if errorlevel  neq 0 goto error_install
 
+rem 服务器自己编译 Detour 和 DetourCrowd 的源码（见 carla/nav/ServerRecast.h）
+if not exist "%RECAST_INSTALL_DIR%src" mkdir "%RECAST_INSTALL_DIR%src"
+copy /Y "%RECAST_SRC_DIR%Detour\Source\*.cpp" "%RECAST_INSTALL_DIR%src\" >nul
+copy /Y "%RECAST_SRC_DIR%DetourCrowd\Source\*.cpp" "%RECAST_INSTALL_DIR%src\" >nul
+
 rem 根据DEL_SRC变量的值判断是否删除下载的Recast & Detour源码，如果为true则删除源码目录
 rem 因为源码在安装完成后可能不再需要，可节省磁盘空间
 if %DEL_SRC% == true (